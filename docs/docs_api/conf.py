@@ -153,7 +153,7 @@ excluded_api = [
 
 # Define the structure of the generated reference pages for the different libraries.
 api_doc_structure = {
-    'Core': ['mitsuba.render', 'mitsuba.set_variant', 'mitsuba.variant',
+    'Core': ['mitsuba.render', 'mitsuba.render_concurrent', 'mitsuba.prewarm', 'mitsuba.set_variant', 'mitsuba.variant',
              'mitsuba.traverse', 'mitsuba.SceneParameters',
              'mitsuba.variants', 'mitsuba.set_log_level',
              'mitsuba.ArgParser', 'mitsuba.AtomicFloat',
@@ -199,7 +199,7 @@ api_doc_structure = {
               r'mitsuba.Color([\w]+)',
               r'mitsuba.Ray([\w]+)'],
     'Constants': [r'mitsuba.MI_([\w]+)', r'mitsuba.is_([\w]+)', 'mitsuba.DEBUG'],
-    'Denoiser': ['mitsuba.OptixDenoiser'],
+    'Denoiser': ['mitsuba.OptixDenoiser', 'mitsuba.WaveletDenoiser'],
     'BSDF': [r'mitsuba.BSDF([\w]*)', 'mitsuba.TransportMode',
              r'mitsuba.Microfacet([\w]+)'],
     'Integrator': [r'mitsuba.(.*)Integrator([\w]*)', 'mitsuba.ad.common.mis_weight'],
@@ -214,7 +214,7 @@ api_doc_structure = {
     'Film': ['mitsuba.Film([\w]+|)', 'mitsuba.ImageBlock'],
     'Filter': [r'mitsuba.([\w]*)Filter([\w]*)'],
     'Sampler': ['mitsuba.Sampler'],
-    'Scene': ['mitsuba.Scene', 'mitsuba.ShapeKDTree', 'mitsuba.cornell_box'],
+    'Scene': ['mitsuba.Scene', 'mitsuba.ShapeKDTree', 'mitsuba.ShapeBVH', 'mitsuba.cornell_box'],
     'Record': ['mitsuba.PositionSample3f', 'mitsuba.DirectionSample3f',
                r'mitsuba.([\w]+)Interaction([\w]+)',
                r'mitsuba.([\w]+)Intersection([\w]+)', ],
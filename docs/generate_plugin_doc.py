@@ -20,7 +20,12 @@ SHAPE_ORDERING = [
     'linearcurve',
     'rectangle',
     'shapegroup',
-    'instance'
+    'instance',
+    'meshlets',
+    'scatter',
+    'subdivision',
+    'displace',
+    'particles'
 ]
 
 BSDF_ORDERING = [
@@ -82,7 +87,9 @@ SAMPLER_ORDERING = [
     'stratified',
     'multijitter',
     'orthogonal',
-    'ldsampler'
+    'ldsampler',
+    'sobol',
+    'halton'
 ]
 
 INTEGRATOR_ORDERING = [
@@ -91,6 +98,10 @@ INTEGRATOR_ORDERING = [
     'aov',
     'volpath',
     'volpathmis',
+    'ppm',
+    'irrcache',
+    'restir',
+    'bdpt',
     '../src/python/python/ad/integrators/prb.py',
     '../src/python/python/ad/integrators/prb_basic.py',
     '../src/python/python/ad/integrators/direct_reparam.py',
@@ -126,7 +137,8 @@ PHASE_ORDERING = [
 
 VOLUME_ORDERING = [
     'constvolume',
-    'gridvolume'
+    'gridvolume',
+    'sparsegridvolume'
 ]
 
 
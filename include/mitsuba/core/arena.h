@@ -0,0 +1,140 @@
+#pragma once
+
+#include <mitsuba/core/platform.h>
+#include <mitsuba/core/fwd.h>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Bump allocator for short-lived scratch memory
+ *
+ * An arena hands out memory from a list of large chunks by advancing a
+ * pointer, and releases all of it at once via \ref reset() or \ref rewind().
+ * No destructors are run, hence only trivially destructible types may be
+ * allocated with \ref allocate_array().
+ *
+ * When \ref reset() is called on an arena that spilled into several chunks,
+ * they are replaced by a single chunk covering their combined size. After a
+ * short warm-up phase, an arena that is reset at regular intervals (e.g. once
+ * per image block) therefore no longer touches the heap.
+ *
+ * Each thread owns an arena that is accessible via \ref thread(). The
+ * scalar rendering loops reset it before rendering a range of image blocks
+ * and rewind it after every block, which makes it usable by integrators and
+ * plugins for temporaries whose lifetime does not exceed the current block.
+ * Nested users should wrap their allocations in a \ref Scope.
+ *
+ * Arenas are not thread-safe.
+ */
+class MI_EXPORT_LIB ScratchArena {
+public:
+    /// Position of an arena, see \ref mark() and \ref rewind()
+    struct Marker {
+        size_t chunk  = 0;
+        size_t offset = 0;
+    };
+
+    /// Rewinds an arena to its state at construction time upon destruction
+    class Scope {
+    public:
+        Scope(ScratchArena &arena) : m_arena(arena), m_marker(arena.mark()) { }
+        ~Scope() { m_arena.rewind(m_marker); }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    private:
+        ScratchArena &m_arena;
+        Marker m_marker;
+    };
+
+    /**
+     * \brief Create an empty arena
+     *
+     * \param chunk_size
+     *     Minimum size of the chunks that are requested from the heap. No
+     *     memory is allocated until the first call to \ref allocate().
+     */
+    ScratchArena(size_t chunk_size = 1 << 16);
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena &) = delete;
+    ScratchArena &operator=(const ScratchArena &) = delete;
+
+    /// Allocate \c size bytes with the given alignment (a power of two)
+    void *allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        uintptr_t ptr = (m_ptr + (align - 1)) & ~(uintptr_t) (align - 1);
+        if (likely(ptr + size <= m_end && m_end != 0)) {
+            m_ptr = ptr + size;
+            return (void *) ptr;
+        }
+        return allocate_slow(size, align);
+    }
+
+    /// Allocate an array of \c count value-initialized instances of \c T
+    template <typename T> T *allocate_array(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "ScratchArena::allocate_array(): the arena never runs "
+                      "destructors!");
+        T *ptr = (T *) allocate(sizeof(T) * count, alignof(T));
+        for (size_t i = 0; i < count; ++i)
+            new (ptr + i) T();
+        return ptr;
+    }
+
+    /// Release all allocations, and merge the chunks (see the class description)
+    void reset();
+
+    /// Return the current position of the arena
+    Marker mark() const;
+
+    /**
+     * \brief Release the allocations that were made since \c marker was
+     * obtained via \ref mark()
+     *
+     * The chunks are kept for subsequent allocations.
+     */
+    void rewind(const Marker &marker);
+
+    /// Return the number of bytes handed out since the last reset (incl. padding)
+    size_t bytes_used() const;
+
+    /// Return the total size of the chunks owned by the arena
+    size_t capacity() const;
+
+    /// Return the number of chunks owned by the arena
+    size_t chunk_count() const { return m_chunks.size(); }
+
+    /// Return the scratch arena of the calling thread
+    static ScratchArena &thread();
+
+    /**
+     * \brief Return the number of chunks that were requested from the heap
+     * by all arenas since the program started
+     *
+     * This counter makes it possible to check that a loop which uses the
+     * thread arenas no longer allocates memory after a warm-up phase.
+     */
+    static size_t heap_allocations();
+
+private:
+    struct Chunk {
+        std::unique_ptr<uint8_t[]> data;
+        size_t size;
+    };
+
+    void *allocate_slow(size_t size, size_t align);
+    Chunk new_chunk(size_t size);
+    void activate(size_t chunk, size_t offset);
+
+private:
+    std::vector<Chunk> m_chunks;
+    size_t m_chunk_size;
+    size_t m_chunk;
+    uintptr_t m_ptr, m_end;
+};
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/object.h>
+#include <functional>
+#include <memory>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Process-wide cache of assets that were loaded from disk
+ *
+ * Scenes frequently reference the same file from several plugin instances,
+ * e.g. a texture used with different wrap modes or a mesh instantiated with
+ * different BSDFs. Plugins such as \c bitmap, \c ply, \c obj, and \c
+ * gridvolume use this cache to load and convert such a file only once and to
+ * share the resulting buffers between all instances.
+ *
+ * Entries are identified by the resolved path, the modification time and
+ * size of the file, and a plugin-specific string that must describe every
+ * parameter affecting the converted data (including the variant). The cache
+ * holds a reference to every entry and releases it once no other object
+ * refers to it anymore. Unused entries are removed whenever the cache is
+ * accessed and by \ref clear().
+ *
+ * Concurrent requests for the same entry are serialized: the first caller
+ * obtains a \ref Ticket and loads the asset, while the others wait until it
+ * is available.
+ *
+ * Processes running on the same machine can additionally share assets
+ * through a directory that is backed by shared memory (e.g. a subdirectory
+ * of <tt>/dev/shm</tt> on Linux), see \ref get_shared(). It is set by the
+ * \c MI_SHARED_ASSET_DIR environment variable or \ref
+ * set_shared_directory().
+ */
+class MI_EXPORT_LIB AssetCache {
+public:
+    /**
+     * \brief Handle to an entry that the caller is responsible for loading
+     *
+     * If the handle is released without a call to \ref put(), e.g. because
+     * loading failed, another waiting caller takes over.
+     */
+    using Ticket = std::shared_ptr<void>;
+
+    /**
+     * \brief Look up the entry for \c path and \c key
+     *
+     * \return The cached object, if available. Otherwise, \c ticket is
+     * set and the caller should load the asset and pass it to \ref put().
+     * Both are \c nullptr when the cache is disabled.
+     */
+    static ref<Object> get(const fs::path &path, const std::string &key,
+                           Ticket &ticket);
+
+    /// Store the asset loaded for an entry returned missing by \ref get()
+    static void put(Ticket &ticket, Object *value);
+
+    /**
+     * \brief Look up the entry for \c path and \c key, and invoke \c load to
+     * create it if it is missing
+     */
+    static ref<Object> get(const fs::path &path, const std::string &key,
+                           const std::function<ref<Object>()> &load);
+
+    /**
+     * \brief Look up an entry of the node-local shared asset directory
+     *
+     * Entries are identified like those of the process-wide cache and hold
+     * the asset in a layout that can be accessed in place. When the entry is
+     * missing, \c write is invoked to serialize the asset into a stream,
+     * which is published atomically so that other processes never observe a
+     * partially written entry.
+     *
+     * \return A read-only mapping of the entry, or \c nullptr when the
+     * shared directory is not set, when \c path does not refer to a file, or
+     * when the entry could not be created (the caller should then load the
+     * asset itself).
+     */
+    static ref<MemoryMappedFile> get_shared(const fs::path &path,
+                                            const std::string &key,
+                                            const std::function<void(Stream *)> &write);
+
+    /**
+     * \brief Set the node-local shared asset directory
+     *
+     * An empty path disables the sharing of assets between processes.
+     */
+    static void set_shared_directory(const fs::path &path);
+
+    /// Return the node-local shared asset directory (empty if disabled)
+    static fs::path shared_directory();
+
+    /// Release all entries that are no longer used
+    static void prune();
+
+    /// Release all entries
+    static void clear();
+
+    /// Return the number of entries
+    static size_t size();
+
+    /// Enable or disable the cache (it is enabled by default)
+    static void set_enabled(bool enabled);
+
+    /// Is the cache enabled?
+    static bool enabled();
+};
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <mitsuba/core/fstream.h>
+#include <exception>
+#include <memory>
+
+extern "C" { struct Task; };
+
+NAMESPACE_BEGIN(mitsuba)
+
+/** \brief Read-only \ref Stream implementation that reads a file with
+ * positional reads and asynchronous read-ahead
+ *
+ * In contrast to \ref FileStream, this class bypasses the buffering of
+ * <tt>std::fstream</tt>. It reads the file in large blocks that start at a
+ * multiple of the block size (using <tt>pread()</tt> on Linux and macOS).
+ * When the stream is read sequentially, the next block is read in the
+ * background on the thread pool, which overlaps the I/O with the decoding of
+ * the previous block. Reads that span at least one block bypass the internal
+ * buffers and go directly to the destination.
+ *
+ * In addition, \ref read_at() reads data at an arbitrary position without
+ * changing the position of the stream. It may be called concurrently from
+ * multiple threads.
+ *
+ * This stream is designed for large files on network file systems, where the
+ * latency of individual requests dominates the cost of reading.
+ */
+class MI_EXPORT_LIB AsyncFileStream : public Stream {
+public:
+    using Stream::read;
+    using Stream::write;
+
+    /** \brief Opens the file pointed by <tt>p</tt> for reading
+     *
+     * \param block_size
+     *     Size of the blocks that are read from the file in bytes
+     *
+     * \param read_ahead
+     *     Read the next block in the background when reading sequentially
+     *
+     * Throws an exception if the file cannot be opened.
+     */
+    AsyncFileStream(const fs::path &p, size_t block_size = 1 << 20,
+                    bool read_ahead = true);
+
+    /** \brief Closes the stream and the underlying file.
+     * No further read operations are permitted.
+     *
+     * This function is idempotent.
+     * It is called automatically by the destructor.
+     */
+    virtual void close() override;
+
+    /// Whether the stream is closed (no read or write are then permitted).
+    virtual bool is_closed() const override;
+
+    /**
+     * \brief Read \c size bytes at position \c pos of the file
+     *
+     * This function does not change the position of the stream and is
+     * thread-safe. Throws an \ref EOFException when the file ends before
+     * \c size bytes were read.
+     */
+    void read_at(size_t pos, void *p, size_t size) const;
+
+    /// Return the path descriptor associated with this stream
+    const fs::path &path() const { return m_path; }
+
+    /// Return the size of the blocks that are read from the file
+    size_t block_size() const { return m_block_size; }
+
+    /// Is the next block read in the background?
+    bool read_ahead() const { return m_read_ahead; }
+
+    // =========================================================================
+    //! @{ \name Implementation of the Stream interface
+    // =========================================================================
+
+    /**
+     * \brief Reads a specified amount of data from the stream.
+     * Throws an exception when the stream ended prematurely.
+     */
+    virtual void read(void *p, size_t size) override;
+
+    /// Always throws, since this stream is read-only
+    virtual void write(const void *p, size_t size) override;
+
+    /// Seeks to a position inside the stream. Seeking beyond the end is allowed.
+    virtual void seek(size_t pos) override;
+
+    /// Always throws, since this stream is read-only
+    virtual void truncate(size_t size) override;
+
+    /// Gets the current position inside the file
+    virtual size_t tell() const override { return m_pos; }
+
+    /// Returns the size of the file when it was opened
+    virtual size_t size() const override { return m_size; }
+
+    /// No-op, since this stream is read-only
+    virtual void flush() override { }
+
+    /// Always false, since this stream is read-only
+    virtual bool can_write() const override { return false; }
+
+    /// True except if the stream was closed.
+    virtual bool can_read() const override { return !is_closed(); }
+
+    /// Returns a string representation
+    virtual std::string to_string() const override;
+
+    //! @}
+    // =========================================================================
+
+    MI_DECLARE_CLASS()
+protected:
+
+    /// Protected destructor
+    virtual ~AsyncFileStream();
+
+private:
+    /// Block of the file held in memory
+    struct Buffer {
+        std::unique_ptr<uint8_t[]> data;
+        /// Index of the block, or <tt>(size_t) -1</tt> if the buffer is empty
+        size_t block = (size_t) -1;
+        /// Number of valid bytes
+        size_t size = 0;
+        /// Pending read-ahead task (if any)
+        Task *task = nullptr;
+        /// Exception raised by the read-ahead task
+        std::exception_ptr error;
+    };
+
+    /// Read up to \c size bytes at position \c pos, returns the number of bytes read
+    size_t read_some(size_t pos, void *p, size_t size) const;
+
+    /// Wait for the read-ahead task of a buffer, rethrows its errors
+    void wait(Buffer &buffer);
+
+    /// Return the buffer holding the given block, and start the read-ahead
+    const Buffer &fetch(size_t block);
+
+private:
+    fs::path m_path;
+#if defined(_WIN32)
+    void *m_handle;
+#else
+    int m_fd;
+#endif
+    size_t m_size;
+    size_t m_pos;
+    size_t m_block_size;
+    bool m_read_ahead;
+    /// Block that is currently read, and the block that is read ahead
+    Buffer m_current, m_next;
+    /// Statistics for the \ref TraceRecorder (start time is negative if inactive)
+    size_t m_bytes_read;
+    double m_trace_start;
+};
+
+NAMESPACE_END(mitsuba)
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/struct.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/properties.h>
@@ -179,6 +180,36 @@ public:
         Unpremultiply
     };
 
+    /// Compression codecs that can be used when writing OpenEXR files
+    enum class EXRCompression : uint32_t {
+        /// PIZ, or DWAB when a quality level is specified (default)
+        Auto,
+
+        /// No compression
+        None,
+
+        /// Run-length encoding (lossless, fast)
+        RLE,
+
+        /// Zlib compression of individual scanlines (lossless, fast)
+        ZIPS,
+
+        /// Zlib compression of blocks of 16 scanlines (lossless)
+        ZIP,
+
+        /// Wavelet compression (lossless, good ratio on noisy images)
+        PIZ,
+
+        /// Lossy conversion of 32 bit floats to 24 bits followed by zlib
+        PXR24,
+
+        /// Lossy compression of blocks of 32 scanlines using a DCT (fast)
+        DWAA,
+
+        /// Lossy compression of blocks of 256 scanlines using a DCT
+        DWAB
+    };
+
 
     // ======================================================================
     //! @{ \name Constructors
@@ -265,6 +296,17 @@ public:
     /// Return a pointer to the underlying data (const)
     const uint8_t *uint8_data() const { return m_data.get(); }
 
+    /// Does the bitmap own its storage (vs. wrapping an external pointer)?
+    bool owns_data() const { return m_owns_data; }
+
+    /**
+     * \brief Keep the owner of the external storage alive
+     *
+     * When the bitmap wraps memory that it does not own (e.g. a NumPy array),
+     * this reference is released along with the bitmap.
+     */
+    void set_data_owner(std::shared_ptr<void> owner) { m_data_owner = std::move(owner); }
+
     /// Return the bitmap dimensions in pixels
     const Vector2u &size() const { return m_size; }
 
@@ -349,10 +391,16 @@ public:
      *            A value of 45 is recommended as the default for lossy compression.
      *            The default argument (-1) causes the implementation to switch
      *            to the lossless PIZ compressor.</li>
-     *    </ul>
+     *    </ul>     *
+     * \param compression
+     *    Compression codec used for OpenEXR images (ignored otherwise). The
+     *    DWAA/DWAB compressors use \c quality as their compression level if it
+     *    is positive. OpenEXR files are encoded in parallel using the thread
+     *    count specified via \ref Thread::set_thread_count().
      */
     void write(Stream *stream, FileFormat format = FileFormat::Auto,
-               int quality = -1) const;
+               int quality = -1,
+               EXRCompression compression = EXRCompression::Auto) const;
 
     /**
      * Write an encoded form of the bitmap to a file using the specified file format
@@ -379,14 +427,45 @@ public:
      *            A value of 45 is recommended as the default for lossy compression.
      *            The default argument (-1) causes the implementation to switch
      *            to the lossless PIZ compressor.</li>
-     *    </ul>
+     *    </ul>     *
+     * \param compression
+     *    Compression codec used for OpenEXR images (ignored otherwise). The
+     *    DWAA/DWAB compressors use \c quality as their compression level if it
+     *    is positive. OpenEXR files are encoded in parallel using the thread
+     *    count specified via \ref Thread::set_thread_count().
      */
     void write(const fs::path &path, FileFormat format = FileFormat::Auto,
-               int quality = -1) const;
+               int quality = -1,
+               EXRCompression compression = EXRCompression::Auto) const;
+
+    /**
+     * \brief Write the pixels of the bitmap in an uncompressed layout that
+     * can later be mapped into memory (see \ref map_raw())
+     *
+     * Metadata other than the gamma and alpha flags is not stored.
+     */
+    void write_raw(Stream *stream) const;
+
+    /**
+     * \brief Create a bitmap that references the pixels of a file written by
+     * \ref write_raw() without copying them
+     *
+     * The bitmap keeps the mapping alive. When the mapping is read-only (e.g.
+     * when it is shared with other processes), the pixels must not be
+     * modified.
+     */
+    static ref<Bitmap> map_raw(MemoryMappedFile *mmap);
 
-    /// Equivalent to \ref write(), but executes asynchronously on a different thread
+    /**
+     * \brief Equivalent to \ref write(), but executes asynchronously on a
+     * different thread
+     *
+     * The bitmap must not be modified until the write has finished. Pending
+     * writes are completed by \ref Thread::wait_for_tasks() and at shutdown.
+     */
     void write_async(const fs::path &path, FileFormat format = FileFormat::Auto,
-                     int quality = -1) const;
+                     int quality = -1,
+                     EXRCompression compression = EXRCompression::Auto) const;
 
     /**
      * \brief Up- or down-sample this image to a different resolution
@@ -581,6 +660,9 @@ public:
     /// Inequality comparison operator
     bool operator!=(const Bitmap &bitmap) const { return !operator==(bitmap); }
 
+    /// Return the size of the pixel buffer if it is owned by the bitmap
+    size_t memory_footprint() const override;
+
     /// Return a human-readable summary of this bitmap
     virtual std::string to_string() const override;
 
@@ -605,7 +687,8 @@ public:
      void read_exr(Stream *stream);
 
      /// Write a file using the OpenEXR file format
-     void write_exr(Stream *stream, int compression = -1) const;
+     void write_exr(Stream *stream, int quality = -1,
+                    EXRCompression compression = EXRCompression::Auto) const;
 
      /// Read a file encoded using the JPEG file format
      void read_jpeg(Stream *stream);
@@ -651,9 +734,101 @@ public:
      bool m_srgb_gamma;
      bool m_premultiplied_alpha;
      bool m_owns_data;
+     std::shared_ptr<void> m_data_owner;
      Properties m_metadata;
 };
 
+/**
+ * \brief Incrementally write a tiled OpenEXR file
+ *
+ * In contrast to \ref Bitmap::write(), which requires the complete image to
+ * reside in memory, this class creates the file upfront and then accepts
+ * the image one tile at a time, in any order. This bounds the memory
+ * needed to produce very large images, since a tile can be released as soon
+ * as it has been written.
+ *
+ * The channel layout of the file is specified by a \ref Struct instance
+ * (e.g. the one of a bitmap developed from part of the image), and every
+ * tile passed to \ref write_tile() must use the same layout. The writer is
+ * thread-safe.
+ */
+class MI_EXPORT_LIB TiledEXRWriter : public Object {
+public:
+    using Float = float;
+    MI_IMPORT_CORE_TYPES()
+
+    /**
+     * \brief Create a tiled OpenEXR file
+     *
+     * \param path
+     *     Path of the output file
+     *
+     * \param pixel_format
+     *     Pixel format of the image (used to annotate XYZ images)
+     *
+     * \param struct_
+     *     Channel names and component formats of the image
+     *
+     * \param size
+     *     Size of the complete image in pixels
+     *
+     * \param tile_size
+     *     Size of the square tiles in pixels
+     *
+     * \param compression
+     *     Compression codec of the file
+     */
+    TiledEXRWriter(const fs::path &path, Bitmap::PixelFormat pixel_format,
+                   const Struct *struct_, const Vector2u &size,
+                   uint32_t tile_size,
+                   Bitmap::EXRCompression compression = Bitmap::EXRCompression::Auto);
+
+    /**
+     * \brief Write the tile with index \c tile
+     *
+     * The bitmap must match the channel layout of the file, and its size
+     * must be equal to the tile size (smaller along the right and bottom
+     * edges of the image).
+     */
+    void write_tile(const Point2u &tile, const Bitmap *bitmap);
+
+    /// Finish writing the file. Tiles that were never written remain empty.
+    void close();
+
+    /// Return the path of the output file
+    const fs::path &path() const { return m_path; }
+
+    /// Return the size of the complete image in pixels
+    const Vector2u &size() const { return m_size; }
+
+    /// Return the size of the square tiles in pixels
+    uint32_t tile_size() const { return m_tile_size; }
+
+    /// Return the number of tiles along each axis
+    Vector2u tile_count() const {
+        return (m_size + (m_tile_size - 1)) / m_tile_size;
+    }
+
+    /// Return the number of tiles written so far
+    size_t tiles_written() const { return m_tiles_written; }
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    /// Virtual destructor, closes the file if needed
+    virtual ~TiledEXRWriter();
+
+protected:
+    struct TiledEXRWriterPrivate;
+    std::unique_ptr<TiledEXRWriterPrivate> d;
+    fs::path m_path;
+    ref<const Struct> m_struct;
+    Vector2u m_size;
+    uint32_t m_tile_size;
+    size_t m_tiles_written = 0;
+};
+
 
 /**
  * \brief Accumulate the contents of a source bitmap into a
@@ -727,5 +902,6 @@ void accumulate_2d(ConstT source,
 extern MI_EXPORT_LIB std::ostream &operator<<(std::ostream &os, Bitmap::PixelFormat value);
 extern MI_EXPORT_LIB std::ostream &operator<<(std::ostream &os, Bitmap::FileFormat value);
 extern MI_EXPORT_LIB std::ostream &operator<<(std::ostream &os, Bitmap::AlphaTransform value);
+extern MI_EXPORT_LIB std::ostream &operator<<(std::ostream &os, Bitmap::EXRCompression value);
 
 NAMESPACE_END(mitsuba)
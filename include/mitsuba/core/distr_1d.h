@@ -4,6 +4,9 @@
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/math.h>
 #include <drjit/dynamic.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
+#include <vector>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -16,11 +19,22 @@ NAMESPACE_BEGIN(mitsuba)
  * probability mass functions (PMFs) will automatically be normalized during
  * initialization. The associated scale factor can be retrieved using the
  * function \ref normalization().
+ *
+ * By default, samples are generated by a binary search over the cumulative
+ * distribution function, which costs \f$\log_2 N\f$ dependent memory lookups
+ * per sample. The \c alias_table parameter of the constructors additionally
+ * builds an alias table (Walker's alias method, using Vose's construction)
+ * that generates samples in constant time with two independent lookups. The
+ * alias table maps the samples differently to the entries, hence the
+ * \c sample*() functions no longer preserve the stratification of their
+ * inputs.
  */
 template <typename Value> struct DiscreteDistribution {
     using Float = std::conditional_t<dr::is_static_array_v<Value>,
                                      dr::value_t<Value>, Value>;
     using FloatStorage   = DynamicBuffer<Float>;
+    using UInt32         = dr::uint32_array_t<Float>;
+    using UInt32Storage  = DynamicBuffer<UInt32>;
     using Index          = dr::uint32_array_t<Value>;
     using Mask           = dr::mask_t<Value>;
 
@@ -32,20 +46,22 @@ public:
     DiscreteDistribution() { }
 
     /// Initialize from a given probability mass function
-    DiscreteDistribution(const FloatStorage &pmf)
-        : m_pmf(pmf) {
+    DiscreteDistribution(const FloatStorage &pmf, bool alias_table = false)
+        : m_pmf(pmf), m_alias_table(alias_table) {
         update();
     }
 
     /// Initialize from a given probability mass function (rvalue version)
-    DiscreteDistribution(FloatStorage &&pmf)
-        : m_pmf(std::move(pmf)) {
+    DiscreteDistribution(FloatStorage &&pmf, bool alias_table = false)
+        : m_pmf(std::move(pmf)), m_alias_table(alias_table) {
         update();
     }
 
     /// Initialize from a given floating point array
-    DiscreteDistribution(const ScalarFloat *values, size_t size)
-        : m_pmf(dr::load<FloatStorage>(values, size)) {
+    DiscreteDistribution(const ScalarFloat *values, size_t size,
+                         bool alias_table = false)
+        : m_pmf(dr::load<FloatStorage>(values, size)),
+          m_alias_table(alias_table) {
         compute_cdf(values, size);
     }
 
@@ -84,6 +100,22 @@ public:
     /// Is the distribution object empty/uninitialized?
     bool empty() const { return m_pmf.empty(); }
 
+    /// Are samples generated using an alias table?
+    bool has_alias_table() const { return m_alias_table; }
+
+    /**
+     * \brief Return the probabilities of the alias table, i.e. the fraction
+     * of every column of the table that samples its own entry (empty unless
+     * \ref has_alias_table())
+     */
+    const FloatStorage &alias_probability() const { return m_alias_prob; }
+
+    /**
+     * \brief Return the aliases of the alias table, i.e. the entry sampled by
+     * the remainder of every column (empty unless \ref has_alias_table())
+     */
+    const UInt32Storage &alias_index() const { return m_alias_index; }
+
     /// Evaluate the unnormalized probability mass function (PMF) at index \c index
     Value eval_pmf(Index index, Mask active = true) const {
         return dr::gather<Value>(m_pmf, index, active);
@@ -117,6 +149,9 @@ public:
     Index sample(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        if (m_alias_table)
+            return sample_alias(value, active).first;
+
         value *= m_sum;
 
         return dr::binary_search<Index>(
@@ -167,6 +202,9 @@ public:
     sample_reuse(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        if (m_alias_table)
+            return sample_alias(value, active);
+
         Index index = sample(value, active);
 
         Value pmf = eval_pmf_normalized(index, active),
@@ -196,6 +234,11 @@ public:
     sample_reuse_pmf(Value value, Mask active = true) const {
         MI_MASK_ARGUMENT(active);
 
+        if (m_alias_table) {
+            auto [index, reused] = sample_alias(value, active);
+            return { index, reused, eval_pmf_normalized(index, active) };
+        }
+
         auto [index, pdf] = sample_pmf(value, active);
 
         Value pmf = eval_pmf_normalized(index, active),
@@ -209,35 +252,156 @@ public:
     }
 
 private:
+    /**
+     * \brief Sample the alias table: the sample selects a column and then
+     * either its entry or its alias. Returns the index and the re-scaled
+     * sample value.
+     */
+    std::pair<Index, Value> sample_alias(Value value, Mask active) const {
+        Value scaled = dr::clamp(value, 0.f, 1.f) * m_alias_size;
+        Index column = dr::minimum(Index(scaled), m_alias_last);
+        Value offset = dr::minimum(scaled - Value(column),
+                                   dr::OneMinusEpsilon<Float>);
+
+        // Both lookups only depend on the column
+        Value prob  = dr::gather<Value>(m_alias_prob, column, active);
+        Index alias = dr::gather<Index>(m_alias_index, column, active);
+
+        Mask own = offset < prob;
+        return { dr::select(own, column, alias),
+                 dr::select(own, offset / prob,
+                            (offset - prob) / (1.f - prob)) };
+    }
+
+    /// Build the alias table using Vose's algorithm
+    void compute_alias_table(const ScalarFloat *pmf, size_t size, double sum) {
+        std::vector<ScalarFloat> prob(size);
+        std::vector<uint32_t> alias(size);
+        std::vector<double> scaled(size);
+        std::vector<uint32_t> small, large;
+        small.reserve(size);
+        large.reserve(size);
+
+        // Entries below the average probability are filled up by larger ones
+        double scale = (double) size / sum;
+        for (uint32_t i = 0; i < size; ++i) {
+            scaled[i] = (double) pmf[i] * scale;
+            alias[i] = i;
+            (scaled[i] < 1.0 ? small : large).push_back(i);
+        }
+
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back(), l = large.back();
+            small.pop_back();
+            prob[s] = (ScalarFloat) scaled[s];
+            alias[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+
+        /* The remaining columns are full up to rounding errors. Entries
+           without probability mass must never be sampled, though. */
+        for (uint32_t i : large)
+            prob[i] = 1.f;
+        for (uint32_t i : small) {
+            prob[i] = pmf[i] > 0.f ? 1.f : 0.f;
+            alias[i] = m_valid.x();
+        }
+
+        m_alias_prob = dr::load<FloatStorage>(prob.data(), size);
+        m_alias_index = dr::load<UInt32Storage>(alias.data(), size);
+        m_alias_size = dr::opaque<Float>((ScalarFloat) size);
+        m_alias_last = dr::opaque<UInt32>((uint32_t) size - 1);
+    }
+
     void compute_cdf(const ScalarFloat *pmf, size_t size) {
         if (size == 0)
             Throw("DiscreteDistribution: empty distribution!");
 
+        /* The prefix sum is computed in blocks of a fixed size: the sums of
+           the blocks are computed in parallel, and each block is then scanned
+           starting from the total of the preceding ones. The result therefore
+           does not depend on the number of threads. */
+        constexpr size_t BlockSize = 1 << 16;
+        struct Block {
+            double sum = 0.0;
+            uint32_t first = (uint32_t) -1, last = (uint32_t) -1;
+            bool negative = false;
+        };
+
+        size_t block_count = (size + BlockSize - 1) / BlockSize;
+        std::vector<Block> blocks(block_count);
         std::vector<ScalarFloat> cdf(size);
-        m_valid = (uint32_t) -1;
 
-        double sum = 0.0;
-        for (uint32_t i = 0; i < size; ++i) {
-            double value = (double) *pmf++;
-            sum += value;
-            cdf[i] = (ScalarFloat) sum;
+        auto for_each_block = [&](auto &&func) {
+            if (block_count == 1) {
+                func((size_t) 0);
+                return;
+            }
+            dr::parallel_for(
+                dr::blocked_range<size_t>(0, block_count, 1),
+                [&](const dr::blocked_range<size_t> &range) {
+                    for (size_t b = range.begin(); b != range.end(); ++b)
+                        func(b);
+                }
+            );
+        };
+
+        for_each_block([&](size_t b) {
+            Block &block = blocks[b];
+            size_t end = std::min(size, (b + 1) * BlockSize);
+            for (size_t i = b * BlockSize; i < end; ++i) {
+                double value = (double) pmf[i];
+                block.sum += value;
+
+                if (value < 0.0) {
+                    block.negative = true;
+                } else if (value > 0.0) {
+                    // Determine the first and last bin with nonzero density
+                    if (block.first == (uint32_t) -1)
+                        block.first = (uint32_t) i;
+                    block.last = (uint32_t) i;
+                }
+            }
+        });
 
-            if (value < 0.0) {
+        m_valid = (uint32_t) -1;
+        std::vector<double> block_offset(block_count);
+        double sum = 0.0;
+        for (size_t b = 0; b < block_count; ++b) {
+            const Block &block = blocks[b];
+            if (block.negative)
                 Throw("DiscreteDistribution: entries must be non-negative!");
-            } else if (value > 0.0) {
-                // Determine the first and last wavelength bin with nonzero density
+            if (block.first != (uint32_t) -1) {
                 if (m_valid.x() == (uint32_t) -1)
-                    m_valid.x() = i;
-                m_valid.y() = i;
+                    m_valid.x() = block.first;
+                m_valid.y() = block.last;
             }
+            block_offset[b] = sum;
+            sum += block.sum;
         }
 
+        for_each_block([&](size_t b) {
+            double partial = block_offset[b];
+            size_t end = std::min(size, (b + 1) * BlockSize);
+            for (size_t i = b * BlockSize; i < end; ++i) {
+                partial += (double) pmf[i];
+                cdf[i] = (ScalarFloat) partial;
+            }
+        });
+
         if (dr::any(dr::eq(m_valid, (uint32_t) -1)))
             Throw("DiscreteDistribution: no probability mass found!");
 
         m_sum = dr::opaque<Float>(sum);
         m_normalization = dr::opaque<Float>(1.0 / sum);
         m_cdf = dr::load<FloatStorage>(cdf.data(), size);
+
+        if (m_alias_table)
+            compute_alias_table(pmf, size, sum);
     }
 
 private:
@@ -246,6 +410,11 @@ private:
     Float m_sum = 0.f;
     Float m_normalization = 0.f;
     ScalarVector2u m_valid;
+    bool m_alias_table = false;
+    FloatStorage m_alias_prob;
+    UInt32Storage m_alias_index;
+    Float m_alias_size = 0.f;
+    UInt32 m_alias_last = 0;
 };
 
 /**
@@ -264,6 +433,8 @@ template <typename Value> struct ContinuousDistribution {
     using Float = std::conditional_t<dr::is_static_array_v<Value>,
                                      dr::value_t<Value>, Value>;
     using FloatStorage = DynamicBuffer<Float>;
+    using UInt32 = dr::uint32_array_t<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
     using Index = dr::uint32_array_t<Value>;
     using Mask = dr::mask_t<Value>;
 
@@ -403,12 +574,7 @@ public:
 
         value *= m_integral;
 
-        Index index = dr::binary_search<Index>(
-            m_valid.x(), m_valid.y(),
-            [&](Index index) DRJIT_INLINE_LAMBDA {
-                return dr::gather<Value>(m_cdf, index, active) < value;
-            }
-        );
+        Index index = find_interval(value, active);
 
         Value y0 = dr::gather<Value>(m_pdf, index,      active),
               y1 = dr::gather<Value>(m_pdf, index + 1u, active),
@@ -441,12 +607,7 @@ public:
 
         value *= m_integral;
 
-        Index index = dr::binary_search<Index>(
-            m_valid.x(), m_valid.y(),
-            [&](Index index) DRJIT_INLINE_LAMBDA {
-                return dr::gather<Value>(m_cdf, index, active) < value;
-            }
-        );
+        Index index = find_interval(value, active);
 
         Value y0 = dr::gather<Value>(m_pdf, index,      active),
               y1 = dr::gather<Value>(m_pdf, index + 1u, active),
@@ -471,7 +632,70 @@ public:
         return m_max;
     }
 
+    /**
+     * \brief Return the guide table used to accelerate sampling
+     *
+     * Entry \c j is the first interval that can contain a sample whose
+     * (unnormalized) CDF value falls into the \c j-th of \ref size() - 1
+     * uniform cells of the sample domain.
+     */
+    const UInt32Storage &guide() const { return m_guide; }
+
 private:
+    /**
+     * \brief Find the interval containing the unnormalized CDF value \c value
+     *
+     * The guide table brackets the interval, which leaves a binary search over
+     * a handful of entries instead of the entire CDF. For reasonably smooth
+     * densities this takes a constant number of steps.
+     */
+    Index find_interval(Value value, Mask active) const {
+        Index cell = dr::minimum(Index(value * m_guide_scale),
+                                 uint32_t(m_guide.size() - 2));
+
+        Index start = dr::gather<Index>(m_guide, cell, active),
+              end   = dr::gather<Index>(m_guide, cell + 1u, active);
+
+        for (uint32_t i = 0; i < m_guide_steps; ++i) {
+            Index middle = dr::sr<1>(start + end);
+            Mask cond = dr::gather<Value>(m_cdf, middle, active) < value;
+            dr::masked(start, cond) = dr::minimum(middle + 1u, end);
+            dr::masked(end, !cond) = middle;
+        }
+
+        return start;
+    }
+
+    /**
+     * Build the guide table. The cell of every CDF entry is computed with the
+     * same floating point arithmetic as in \ref find_interval(), hence the
+     * bracketing is exact despite rounding.
+     */
+    void compute_guide(const std::vector<ScalarFloat> &cdf) {
+        uint32_t cells = (uint32_t) cdf.size();
+        ScalarFloat scale = ScalarFloat(cells) / (ScalarFloat) cdf.back();
+
+        std::vector<uint32_t> guide(cells + 1);
+        uint32_t index = m_valid.x();
+        for (uint32_t j = 0; j < cells; ++j) {
+            while (index < m_valid.y() &&
+                   std::min((uint32_t) (cdf[index] * scale), cells) < j)
+                ++index;
+            guide[j] = index;
+        }
+        guide[cells] = m_valid.y();
+
+        m_guide_steps = 0;
+        for (uint32_t j = 0; j < cells; ++j) {
+            uint32_t span = guide[j + 1] - guide[j];
+            if (span > 0)
+                m_guide_steps = std::max(m_guide_steps, dr::log2i(span) + 1);
+        }
+
+        m_guide_scale = dr::opaque<Float>(scale);
+        m_guide = dr::load<UInt32Storage>(guide.data(), cells + 1);
+    }
+
     void compute_cdf(const ScalarFloat *pdf, size_t size) {
         if (size < 2)
             Throw("ContinuousDistribution: needs at least two entries!");
@@ -518,6 +742,7 @@ private:
         m_interval_size_scalar = (ScalarFloat) interval_size;
         m_inv_interval_size = dr::opaque<Float>(1. / interval_size);
         m_cdf = dr::load<FloatStorage>(cdf.data(), size - 1);
+        compute_guide(cdf);
     }
 
 private:
@@ -531,6 +756,9 @@ private:
     ScalarVector2f m_range { 0.f, 0.f };
     ScalarVector2u m_valid;
     ScalarFloat m_max = 0.f;
+    UInt32Storage m_guide;
+    Float m_guide_scale = 0.f;
+    uint32_t m_guide_steps = 0;
 };
 
 /**
@@ -11,6 +11,7 @@
 
 #include <mitsuba/core/warp.h>
 #include <mitsuba/core/util.h>
+#include <mitsuba/core/parallel.h>
 #include <drjit/dynamic.h>
 #include <array>
 
@@ -179,6 +180,12 @@ public:
         return { Point2u(col, row), (col_cdf_1 - col_cdf_0) * m_normalization, sample };
     }
 
+    /// Return the memory footprint of the density and CDFs in bytes
+    size_t nbytes() const {
+        return (m_data.size() + m_marg_cdf.size() + m_cond_cdf.size()) *
+               sizeof(ScalarFloat);
+    }
+
     std::string to_string() const {
         std::ostringstream oss;
         oss << "DiscreteDistribution2D" << "[" << std::endl
@@ -203,6 +210,19 @@ protected:
     ScalarFloat m_normalization;
 };
 
+NAMESPACE_BEGIN(detail)
+
+/**
+ * \brief Grain size of the parallel loops (see \ref blocked_parallel_for())
+ * that construct large distributions, where each item costs about \c cost
+ * operations
+ */
+inline size_t distr_2d_grain_size(uint32_t cost) {
+    return std::max(16384u / std::max(cost, 1u), 1u);
+}
+
+NAMESPACE_END(detail)
+
 /// Base class of Hierarchical2D and Marginal2D with common functionality
 template <typename Float_, size_t Dimension_ = 0> class Distribution2D {
 public:
@@ -392,93 +412,47 @@ public:
         if (!enable_sampling) {
             m_levels.reserve(1);
             m_levels.emplace_back(size, m_slices);
+        } else {
+            // Allocate memory for input array and MIP hierarchy
+            m_levels.reserve(max_level + 2);
+            m_levels.emplace_back(size, m_slices);
 
-            for (uint32_t slice = 0; slice < m_slices; ++slice) {
-                ScalarFloat *p = m_levels[0].data.data();
-                uint32_t offset = m_levels[0].size * slice;
-
-                ScalarFloat scale = 1.f;
-                if (normalize) {
-                    double sum = 0.0;
-                    for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                        sum += (double) data[offset + i];
-                    scale = dr::prod(n_patches) / (ScalarFloat) sum;
-                }
-
-                for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                    p[offset + i] = data[offset + i] * scale;
-
-                m_levels[0].ready();
+            ScalarVector2u level_size = n_patches;
+            for (int level = max_level; level >= 0; --level) {
+                level_size += level_size & 1u; // zero-pad
+                m_levels.emplace_back(level_size, m_slices);
+                level_size = dr::sr<1>(level_size);
             }
-
-            return;
-        }
-
-        // Allocate memory for input array and MIP hierarchy
-        m_levels.reserve(max_level + 2);
-        m_levels.emplace_back(size, m_slices);
-
-        ScalarVector2u level_size = n_patches;
-        for (int level = max_level; level >= 0; --level) {
-            level_size += level_size & 1u; // zero-pad
-            m_levels.emplace_back(level_size, m_slices);
-            level_size = dr::sr<1>(level_size);
         }
 
-        ScalarFloat *l0p = m_levels[0].data.data(),
-                    *l1p = m_levels[1].data.data();
-
-        for (uint32_t slice = 0; slice < m_slices; ++slice) {
-            uint32_t offset0 = m_levels[0].size * slice,
-                     offset1 = m_levels[1].size * slice;
-
-            // Integrate linear interpolant
-            const ScalarFloat *in = data + offset0;
-
-            double sum = 0.0;
-            for (uint32_t y = 0; y < n_patches.y(); ++y) {
-                for (uint32_t x = 0; x < n_patches.x(); ++x) {
-                    ScalarFloat avg = .25f * (in[0] + in[1] + in[size.x()] +
-                                              in[size.x() + 1]);
-                    sum += (double) avg;
-                    *(l1p + m_levels[1].index(ScalarVector2u(x, y)) + offset1) = avg;
-                    ++in;
-                }
-                ++in;
-            }
-
-            // Copy and normalize fine resolution interpolant
-            ScalarFloat scale = normalize ? (ScalarFloat) (dr::prod(n_patches) / sum) : 1.f;
-            for (uint32_t i = 0; i < m_levels[0].size; ++i)
-                l0p[offset0 + i] = data[offset0 + i] * scale;
-            for (uint32_t i = 0; i < m_levels[1].size; ++i)
-                l1p[offset1 + i] *= scale;
+        build(data, normalize);
+    }
 
-            // Build a MIP hierarchy
-            level_size = n_patches;
-            for (uint32_t level = 2; level <= max_level + 1; ++level) {
-                const Level &l0 = m_levels[level - 1];
-                Level &l1 = m_levels[level];
-                offset0 = l0.size * slice;
-                offset1 = l1.size * slice;
-                level_size = dr::sr<1>(level_size + 1u);
+    /**
+     * \brief Replace the values of the distribution, while keeping its
+     * resolution and level structure
+     *
+     * This is cheaper than constructing a new instance, e.g. when the values
+     * change during every iteration of an optimization. \c data must have the
+     * resolution returned by \ref resolution() and the same number of slices
+     * as the data passed to the constructor.
+     */
+    void update(const ScalarFloat *data, bool normalize = true) {
+        if (m_levels.empty())
+            Throw("Hierarchical2D::update(): the distribution is uninitialized!");
 
-                const ScalarFloat *l0p_ = l0.data.data();
-                ScalarFloat *l1p_ = l1.data.data();
+        for (Level &level : m_levels)
+            level.reset(m_slices);
 
-                // Downsample
-                for (uint32_t y = 0; y < level_size.y(); ++y) {
-                    for (uint32_t x = 0; x < level_size.x(); ++x) {
-                        ScalarFloat *d1 = l1p_ + l1.index(ScalarVector2u(x, y)) + offset1;
-                        const ScalarFloat *d0 = l0p_ + l0.index(ScalarVector2u(x*2, y*2)) + offset0;
-                        *d1 = d0[0] + d0[1] + d0[2] + d0[3];
-                    }
-                }
-            }
-        }
+        build(data, normalize);
+    }
 
-        for (auto& level : m_levels)
-            level.ready();
+    /// Return the resolution of the data passed to the constructor
+    ScalarVector2u resolution() const {
+        if (m_levels.empty())
+            return ScalarVector2u(0u);
+        return ScalarVector2u(m_levels[0].width,
+                              m_levels[0].size / m_levels[0].width);
     }
 
     /**
@@ -731,6 +705,117 @@ public:
     }
 
 protected:
+    /**
+     * \brief Fill the allocated levels with the given data
+     *
+     * Rows are processed in parallel for large inputs. The normalization
+     * constant is accumulated per row and then summed up in a fixed order,
+     * hence the result does not depend on the number of threads.
+     */
+    void build(const ScalarFloat *data, bool normalize) {
+        ScalarVector2u size = resolution(),
+                       n_patches = size - 1;
+
+        if (m_levels.size() == 1) {
+            // Only the interpolant is needed (sampling was disabled)
+            Level &level0 = m_levels[0];
+            ScalarFloat *p = level0.data.data();
+
+            for (uint32_t slice = 0; slice < m_slices; ++slice) {
+                uint32_t offset = level0.size * slice;
+
+                ScalarFloat scale = 1.f;
+                if (normalize) {
+                    double sum = 0.0;
+                    for (uint32_t i = 0; i < level0.size; ++i)
+                        sum += (double) data[offset + i];
+                    scale = dr::prod(n_patches) / (ScalarFloat) sum;
+                }
+
+                blocked_parallel_for(level0.size, detail::distr_2d_grain_size(1u),
+                    [&](uint32_t begin, uint32_t end) {
+                        for (uint32_t i = begin; i < end; ++i)
+                            p[offset + i] = data[offset + i] * scale;
+                    });
+            }
+
+            level0.ready();
+            return;
+        }
+
+        uint32_t max_level = (uint32_t) m_levels.size() - 2;
+        ScalarFloat *l0p = m_levels[0].data.data(),
+                    *l1p = m_levels[1].data.data();
+        std::unique_ptr<double[]> row_sum(new double[n_patches.y()]);
+
+        for (uint32_t slice = 0; slice < m_slices; ++slice) {
+            uint32_t offset0 = m_levels[0].size * slice,
+                     offset1 = m_levels[1].size * slice;
+
+            // Integrate linear interpolant
+            blocked_parallel_for(n_patches.y(), detail::distr_2d_grain_size(n_patches.x()),
+                [&](uint32_t y_begin, uint32_t y_end) {
+                    for (uint32_t y = y_begin; y < y_end; ++y) {
+                        const ScalarFloat *in = data + offset0 + y * size.x();
+                        double sum = 0.0;
+                        for (uint32_t x = 0; x < n_patches.x(); ++x) {
+                            ScalarFloat avg = .25f * (in[0] + in[1] + in[size.x()] +
+                                                      in[size.x() + 1]);
+                            sum += (double) avg;
+                            *(l1p + m_levels[1].index(ScalarVector2u(x, y)) + offset1) = avg;
+                            ++in;
+                        }
+                        row_sum[y] = sum;
+                    }
+                });
+
+            double sum = 0.0;
+            for (uint32_t y = 0; y < n_patches.y(); ++y)
+                sum += row_sum[y];
+
+            // Copy and normalize fine resolution interpolant
+            ScalarFloat scale = normalize ? (ScalarFloat) (dr::prod(n_patches) / sum) : 1.f;
+            blocked_parallel_for(m_levels[0].size, detail::distr_2d_grain_size(1u),
+                [&](uint32_t begin, uint32_t end) {
+                    for (uint32_t i = begin; i < end; ++i)
+                        l0p[offset0 + i] = data[offset0 + i] * scale;
+                });
+            blocked_parallel_for(m_levels[1].size, detail::distr_2d_grain_size(1u),
+                [&](uint32_t begin, uint32_t end) {
+                    for (uint32_t i = begin; i < end; ++i)
+                        l1p[offset1 + i] *= scale;
+                });
+
+            // Build a MIP hierarchy
+            ScalarVector2u level_size = n_patches;
+            for (uint32_t level = 2; level <= max_level + 1; ++level) {
+                const Level &l0 = m_levels[level - 1];
+                Level &l1 = m_levels[level];
+                uint32_t offset0_ = l0.size * slice,
+                         offset1_ = l1.size * slice;
+                level_size = dr::sr<1>(level_size + 1u);
+
+                const ScalarFloat *l0p_ = l0.data.data();
+                ScalarFloat *l1p_ = l1.data.data();
+
+                // Downsample
+                blocked_parallel_for(level_size.y(), detail::distr_2d_grain_size(level_size.x() * 4),
+                    [&](uint32_t y_begin, uint32_t y_end) {
+                        for (uint32_t y = y_begin; y < y_end; ++y) {
+                            for (uint32_t x = 0; x < level_size.x(); ++x) {
+                                ScalarFloat *d1 = l1p_ + l1.index(ScalarVector2u(x, y)) + offset1_;
+                                const ScalarFloat *d0 = l0p_ + l0.index(ScalarVector2u(x*2, y*2)) + offset0_;
+                                *d1 = d0[0] + d0[1] + d0[2] + d0[3];
+                            }
+                        }
+                    });
+            }
+        }
+
+        for (auto& level : m_levels)
+            level.ready();
+    }
+
     struct Level {
         uint32_t size;
         uint32_t width;
@@ -756,6 +841,16 @@ protected:
                 data = dr::migrate(data, AllocType::Device);
         }
 
+        /// Prepare the level for new values (zero-initialized host storage)
+        void reset(uint32_t slices) {
+            if constexpr (dr::is_jit_v<Float>) {
+                // Never modify arrays that may still be referenced by kernels
+                *this = Level(ScalarVector2u(width, size / width), slices);
+            } else {
+                memset(data.data(), 0, size * slices * sizeof(ScalarFloat));
+            }
+        }
+
         /**
          * \brief Convert from 2D pixel coordinates to an index indicating how the
          * data is laid out in memory.
@@ -902,17 +997,19 @@ public:
                 /* The marginal/probability distribution computation
                    differs for the Continuous=false/true cases */
                 if constexpr (Continuous) {
-                    // Construct conditional CDF
-                    for (uint32_t y = 0; y < h; ++y) {
-                        double accum = 0.0;
-                        uint32_t i = y * w, j = y * (w - 1);
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale_x * ((double) data[i] +
-                                                (double) data[i + 1]);
-                            cond_cdf_ptr[j] = (ScalarFloat) accum;
+                    // Construct conditional CDF (rows are independent)
+                    blocked_parallel_for(h, detail::distr_2d_grain_size(w), [&](uint32_t y0, uint32_t y1) {
+                        for (uint32_t y = y0; y < y1; ++y) {
+                            double accum = 0.0;
+                            uint32_t i = y * w, j = y * (w - 1);
+                            for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
+                                accum += scale_x * ((double) data[i] +
+                                                    (double) data[i + 1]);
+                                cond_cdf_ptr[j] = (ScalarFloat) accum;
+                            }
+                            cond_cdf_sum[y] = accum;
                         }
-                        cond_cdf_sum[y] = accum;
-                    }
+                    });
 
                     // Construct marginal CDF
                     double accum = 0.0;
@@ -926,19 +1023,21 @@ public:
                 } else {
                     double scale = scale_x * scale_y;
 
-                    // Construct conditional CDF
-                    for (uint32_t y = 0; y < h - 1; ++y) {
-                        double accum = 0.0;
-                        uint32_t i = y * w, j = y * (w - 1);
-                        for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
-                            accum += scale * ((double) data[i] +
-                                              (double) data[i + 1] +
-                                              (double) data[i + w] +
-                                              (double) data[i + w + 1]);
-                            cond_cdf_ptr[j] = (ScalarFloat) accum;
+                    // Construct conditional CDF (rows are independent)
+                    blocked_parallel_for(h - 1, detail::distr_2d_grain_size(w), [&](uint32_t y0, uint32_t y1) {
+                        for (uint32_t y = y0; y < y1; ++y) {
+                            double accum = 0.0;
+                            uint32_t i = y * w, j = y * (w - 1);
+                            for (uint32_t x = 0; x < w - 1; ++x, ++i, ++j) {
+                                accum += scale * ((double) data[i] +
+                                                  (double) data[i + 1] +
+                                                  (double) data[i + w] +
+                                                  (double) data[i + w + 1]);
+                                cond_cdf_ptr[j] = (ScalarFloat) accum;
+                            }
+                            cond_cdf_sum[y] = accum;
                         }
-                        cond_cdf_sum[y] = accum;
-                    }
+                    });
 
                     // Construct marginal CDF
                     double accum = 0.0;
@@ -951,12 +1050,21 @@ public:
                         norm = ScalarFloat(1.0 / accum);
                 }
 
-                for (size_t i = 0; i < n_cond; ++i)
-                    *cond_cdf_ptr++ *= norm;
+                blocked_parallel_for(n_cond, detail::distr_2d_grain_size(1u), [&](uint32_t i0, uint32_t i1) {
+                    for (uint32_t i = i0; i < i1; ++i)
+                        cond_cdf_ptr[i] *= norm;
+                });
                 for (size_t i = 0; i < n_marg; ++i)
-                    *marg_cdf_ptr++ *= norm;
-                for (size_t i = 0; i < n_data; ++i)
-                    *data_out_ptr++ = *data++ * norm;
+                    marg_cdf_ptr[i] *= norm;
+                blocked_parallel_for(n_data, detail::distr_2d_grain_size(1u), [&](uint32_t i0, uint32_t i1) {
+                    for (uint32_t i = i0; i < i1; ++i)
+                        data_out_ptr[i] = data[i] * norm;
+                });
+
+                cond_cdf_ptr += n_cond;
+                marg_cdf_ptr += n_marg;
+                data_out_ptr += n_data;
+                data += n_data;
             }
 
             m_marg_cdf = dr::load<FloatStorage>(marg_cdf.get(), m_slices * n_marg);
@@ -15,6 +15,7 @@
  */
 
 #include <mitsuba/core/fwd.h>
+#include <functional>
 #include <iosfwd>
 #include <string>
 
@@ -208,12 +209,25 @@ extern MI_EXPORT_LIB bool exists(const path& p) noexcept;
  */
 extern MI_EXPORT_LIB size_t file_size(const path& p);
 
+/** \brief Returns the time of the last modification of the file system
+ * object at <tt>p</tt> (in nanoseconds since the epoch). The resolution
+ * depends on the platform and file system.
+ */
+extern MI_EXPORT_LIB int64_t last_write_time(const path& p);
+
 /** \brief Checks whether two paths refer to the same file system object.
  * Both must refer to an existing file or directory.
  * Symlinks are followed to determine equivalence.
  */
 extern MI_EXPORT_LIB bool equivalent(const path& p1, const path& p2);
 
+/** \brief Appends the names of the entries of the directory at <tt>p</tt>
+ * (excluding '.' and '..') to <tt>names</tt>. Returns false if <tt>p</tt>
+ * could not be opened as a directory.
+ */
+extern MI_EXPORT_LIB bool directory_entries(const path& p,
+                                            std::vector<string_type> &names);
+
 /** \brief Creates a directory at <tt>p</tt> as if <tt>mkdir</tt> was used.
  * Returns true if directory creation was successful, false otherwise.
  * If <tt>p</tt> already exists and is already a directory, the function
@@ -237,6 +251,15 @@ extern MI_EXPORT_LIB bool remove(const path& p);
  */
 extern MI_EXPORT_LIB bool rename(const path& src, const path &dst);
 
+/** \brief Atomically creates or replaces the file <tt>p</tt>.
+ * The callback <tt>write</tt> receives the name of a temporary file in the
+ * same directory, which is then renamed to <tt>p</tt>. Other processes thus
+ * never observe a partially written file. If the callback or the rename
+ * fails, the temporary file is removed and the exception is rethrown.
+ */
+extern MI_EXPORT_LIB void write_atomic(const path &p,
+                                       const std::function<void(const path &)> &write);
+
 NAMESPACE_END(filesystem)
 
 NAMESPACE_END(mitsuba)
@@ -3,6 +3,9 @@
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/object.h>
 #include <iosfwd>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -12,6 +15,13 @@ NAMESPACE_BEGIN(mitsuba)
  * This convenience class looks for a file or directory given its name
  * and a set of search paths. The implementation walks through the
  * search paths in order and stops once the file is found.
+ *
+ * To avoid issuing a file system query per search path and lookup (which is
+ * costly on network file systems), the resolver caches the listing of every
+ * directory it looks into. Hence, files created after a directory was first
+ * searched may not be found until the cache is cleared, which happens
+ * whenever the list of search paths is modified or upon \ref clear_cache().
+ * Copies of a resolver start with an empty cache.
  */
 class MI_EXPORT_LIB FileResolver : public Object {
 public:
@@ -31,10 +41,10 @@ public:
     size_t size() const { return m_paths.size(); }
 
     /// Return an iterator at the beginning of the list of search paths
-    iterator begin() { return m_paths.begin(); }
+    iterator begin() { clear_cache(); return m_paths.begin(); }
 
     /// Return an iterator at the end of the list of search paths
-    iterator end()   { return m_paths.end(); }
+    iterator end()   { clear_cache(); return m_paths.end(); }
 
     /// Return an iterator at the beginning of the list of search paths (const)
     const_iterator begin() const { return m_paths.begin(); }
@@ -46,32 +56,57 @@ public:
     bool contains(const fs::path &p) const;
 
     /// Erase the entry at the given iterator position
-    void erase(iterator it) { m_paths.erase(it); }
+    void erase(iterator it) { clear_cache(); m_paths.erase(it); }
 
     /// Erase the search path from the list
     void erase(const fs::path &p);
 
     /// Clear the list of search paths
-    void clear() { m_paths.clear(); }
+    void clear() { clear_cache(); m_paths.clear(); }
 
     /// Prepend an entry at the beginning of the list of search paths
-    void prepend(const fs::path &path) { m_paths.insert(m_paths.begin(), path); }
+    void prepend(const fs::path &path) {
+        clear_cache();
+        m_paths.insert(m_paths.begin(), path);
+    }
 
     /// Append an entry to the end of the list of search paths
-    void append(const fs::path &path) { m_paths.push_back(path); }
+    void append(const fs::path &path) {
+        clear_cache();
+        m_paths.push_back(path);
+    }
 
     /// Return an entry from the list of search paths
-    fs::path &operator[](size_t index) { return m_paths[index]; }
+    fs::path &operator[](size_t index) { clear_cache(); return m_paths[index]; }
 
     /// Return an entry from the list of search paths (const)
     const fs::path &operator[](size_t index) const { return m_paths[index]; }
 
+    /// Discard the cached directory listings
+    void clear_cache();
+
+    /// Return the number of directories whose listing is cached
+    size_t cache_size() const;
+
     /// Return a human-readable representation of this instance
     std::string to_string() const override;
 
     MI_DECLARE_CLASS()
 private:
+    /// Check whether \c path exists using the cached directory listings
+    bool exists_cached(const fs::path &path) const;
+
+private:
+    /// Cached entry names of a directory
+    struct Listing {
+        /// Could the directory be listed? Otherwise, its files are queried
+        bool valid = false;
+        std::unordered_set<fs::string_type> names;
+    };
+
     std::vector<fs::path> m_paths;
+    mutable std::unordered_map<fs::string_type, Listing> m_cache;
+    mutable std::mutex m_cache_mutex;
 };
 
 NAMESPACE_END(mitsuba)
@@ -132,6 +132,9 @@ private:
     EMode m_mode;
     fs::path m_path;
     mutable std::unique_ptr<std::fstream> m_file;
+    /// Statistics for the \ref TraceRecorder (start time is negative if inactive)
+    size_t m_bytes_read, m_bytes_written;
+    double m_trace_start;
 };
 
 NAMESPACE_END(mitsuba)
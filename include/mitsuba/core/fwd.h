@@ -29,11 +29,14 @@ class FileResolver;
 class FileStream;
 class Formatter;
 class Logger;
+class MemoryMappedFile;
 class MemoryStream;
 class Mutex;
 class PluginManager;
 class Properties;
 class ScopedThreadEnvironment;
+class SocketListener;
+class SocketStream;
 class Stream;
 class StreamAppender;
 class Struct;
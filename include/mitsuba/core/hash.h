@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/object.h>
+#include <cstring>
 #include <functional>
 #include <tuple>
 #include <iostream>
@@ -11,6 +12,48 @@ inline size_t hash_combine(size_t hash1, size_t hash2) {
     return hash2 ^ (hash1 + 0x9e3779b9 + (hash2 << 6) + (hash2 >> 2));
 }
 
+/**
+ * \brief Compute a 64 bit hash of a memory region (MurmurHash64A)
+ *
+ * This is not a cryptographic hash, but it is fast enough to checksum the
+ * contents of large files. Hashes of adjacent regions can be chained by
+ * passing the previous value as \c seed.
+ */
+inline uint64_t hash_bytes(const void *ptr, size_t size, uint64_t seed = 0) {
+    const uint64_t m = 0xc6a4a7935bd1e995ull;
+    const int r = 47;
+
+    const uint8_t *data = (const uint8_t *) ptr;
+    uint64_t h = seed ^ (size * m);
+
+    for (size_t i = 0; i < size / 8; ++i) {
+        uint64_t k;
+        memcpy(&k, data + 8 * i, sizeof(uint64_t));
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    const uint8_t *tail = data + (size & ~(size_t) 7);
+    switch (size & 7) {
+        case 7: h ^= uint64_t(tail[6]) << 48; [[fallthrough]];
+        case 6: h ^= uint64_t(tail[5]) << 40; [[fallthrough]];
+        case 5: h ^= uint64_t(tail[4]) << 32; [[fallthrough]];
+        case 4: h ^= uint64_t(tail[3]) << 24; [[fallthrough]];
+        case 3: h ^= uint64_t(tail[2]) << 16; [[fallthrough]];
+        case 2: h ^= uint64_t(tail[1]) << 8;  [[fallthrough]];
+        case 1: h ^= uint64_t(tail[0]);
+                h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
 template <typename T, std::enable_if_t<!std::is_enum_v<T>, int> = 0> size_t hash(const T &t) {
     return std::hash<T>()(t);
 }
@@ -57,6 +57,30 @@ public:
         const std::string &formatted, const std::string &eta,
         const void *ptr = nullptr);
 
+    /**
+     * \brief Enable or disable asynchronous logging
+     *
+     * In asynchronous mode, \ref log() and \ref log_progress() format the
+     * message on the calling thread and append it to a lock-free buffer
+     * owned by that thread. A background thread then forwards the buffered
+     * messages to the appenders, which preserves the order of the messages
+     * of every thread (but not across threads). Slow appenders hence no
+     * longer stall the threads that produce log messages.
+     *
+     * Disabling asynchronous mode stops the background thread and flushes
+     * all pending messages. Errors are still raised immediately.
+     */
+    void set_async(bool value);
+
+    /// Is asynchronous logging enabled?
+    bool is_async() const;
+
+    /**
+     * \brief Forward all messages that are pending in asynchronous mode to
+     * the appenders
+     */
+    void flush();
+
     /// Set the log level (everything below will be ignored)
     void set_log_level(LogLevel level);
 
@@ -26,6 +26,15 @@ NAMESPACE_BEGIN(mitsuba)
  * In contrast, the ``Object`` class allows for a highly efficient
  * implementation that only adds 32 bits to the base object (for the counter)
  * and has no overhead for references.
+ *
+ * Increasing the reference count uses relaxed memory ordering, since a new
+ * reference can only be created from an existing one. Decreasing it releases
+ * prior writes to the object, and the thread that deletes the object
+ * acquires them. Nevertheless, every change of the count is an atomic
+ * operation on a cache line that is shared by all threads using the object.
+ * Code that is executed for every sample should therefore pass plain (i.e.
+ * borrowed) pointers to objects that are kept alive by the caller, e.g. the
+ * scene, instead of copying \ref ref instances.
  */
 class MI_EXPORT_LIB Object {
 public:
@@ -36,10 +45,10 @@ public:
     Object(const Object &) { }
 
     /// Return the current reference count
-    int ref_count() const { return m_ref_count; };
+    int ref_count() const { return m_ref_count.load(std::memory_order_relaxed); };
 
     /// Increase the object's reference count by one
-    void inc_ref() const { ++m_ref_count; }
+    void inc_ref() const { m_ref_count.fetch_add(1, std::memory_order_relaxed); }
 
     /** \brief Decrease the reference count of the object and possibly
      * deallocate it.
@@ -94,6 +103,20 @@ public:
      */
     virtual void parameters_changed(const std::vector<std::string> &/*keys*/ = {});
 
+    /**
+     * \brief Return the memory footprint of the storage owned by this
+     * instance in bytes
+     *
+     * This covers the buffers of the object (e.g. vertex buffers, texels, or
+     * the nodes of an acceleration data structure), but not the Mitsuba
+     * objects it references. Storage that is shared with other instances
+     * (e.g. via the \ref AssetCache) is included in the footprint of each of
+     * them. The result is an estimate that neglects small allocations.
+     *
+     * \remark The default implementation returns zero.
+     */
+    virtual size_t memory_footprint() const;
+
     /**
      * \brief Return a \ref Class instance containing run-time type information
      * about this Object
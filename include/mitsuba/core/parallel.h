@@ -0,0 +1,33 @@
+#pragma once
+
+#include <mitsuba/mitsuba.h>
+#include <nanothread/nanothread.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Invoke <tt>func(begin, end)</tt> on blocks of the range <tt>[0,
+ * count)</tt> in parallel
+ *
+ * The blocks contain about \c grain_size items and are processed on the
+ * thread pool. Ranges that fit into a single block are processed on the
+ * calling thread, which avoids the overhead of scheduling a task for small
+ * inputs.
+ */
+template <typename Size, typename Func>
+void blocked_parallel_for(Size count, size_t grain_size, Func &&func) {
+    if ((size_t) count <= grain_size) {
+        if (count > 0)
+            func((Size) 0, count);
+        return;
+    }
+
+    dr::parallel_for(
+        dr::blocked_range<Size>((Size) 0, count, (uint32_t) grain_size),
+        [&](const dr::blocked_range<Size> &range) {
+            func(range.begin(), range.end());
+        }
+    );
+}
+
+NAMESPACE_END(mitsuba)
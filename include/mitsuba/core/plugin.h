@@ -25,6 +25,16 @@ public:
     /// Ensure that a plugin is loaded and ready
     void ensure_plugin_loaded(const std::string &name);
 
+    /**
+     * \brief Load a set of plugins concurrently
+     *
+     * This reduces start-up latency when many plugins must be loaded from a
+     * slow file system. Plugins that were already loaded or that cannot be
+     * found are skipped, and errors are only reported as warnings: the
+     * subsequent \ref create_object() call will report them.
+     */
+    void preload(const std::vector<std::string> &names);
+
     /// Return the class corresponding to a plugin for a specific variant
     const Class *get_plugin_class(const std::string &name,
                                   const std::string &variant);
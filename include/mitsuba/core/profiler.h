@@ -78,14 +78,37 @@ constexpr const char
         "Texture::eval()"
     };
 
+static_assert((int) ProfilerPhase::ProfilerPhaseCount <= 64,
+              "The sampling profiler stores one bit per phase in a 64-bit word");
+
 #if defined(MI_ENABLE_ITTNOTIFY)
 extern MI_EXPORT_LIB __itt_domain *mitsuba_itt_domain;
 extern MI_EXPORT_LIB __itt_string_handle *
     mitsuba_itt_phase[int(ProfilerPhase::ProfilerPhaseCount)];
 #endif
 
+#if defined(MI_ENABLE_PROFILER)
+/**
+ * \brief Phases that are currently active on the calling thread
+ *
+ * Bit \c i is set while the thread is inside of a \ref ScopedPhase of
+ * phase \c i. Thanks to the partial order of \ref ProfilerPhase, the highest
+ * set bit identifies the innermost phase, hence this word serves as a compact
+ * phase stack that the sampling \ref Profiler can read from a signal handler.
+ */
+extern MI_EXPORT_LIB thread_local uint64_t profiler_flags;
+#endif
+
 struct ScopedPhase {
     ScopedPhase(ProfilerPhase phase) {
+#if defined(MI_ENABLE_PROFILER)
+        // Recursive phases are only tracked by the outermost scope
+        m_flag = uint64_t(1) << (int) phase;
+        if (profiler_flags & m_flag)
+            m_flag = 0;
+        profiler_flags |= m_flag;
+#endif
+
         /// Interface with various external visual profilers
 #if defined(MI_ENABLE_ITTNOTIFY)
         __itt_task_begin(mitsuba_itt_domain, __itt_null, __itt_null,
@@ -99,6 +122,10 @@ struct ScopedPhase {
     }
 
     ~ScopedPhase() {
+#if defined(MI_ENABLE_PROFILER)
+        profiler_flags &= ~m_flag;
+#endif
+
 #if defined(MI_ENABLE_ITTNOTIFY)
         __itt_task_end(mitsuba_itt_domain);
 #endif
@@ -110,12 +137,59 @@ struct ScopedPhase {
 
     ScopedPhase(const ScopedPhase &) = delete;
     ScopedPhase &operator=(const ScopedPhase &) = delete;
+
+#if defined(MI_ENABLE_PROFILER)
+private:
+    uint64_t m_flag;
+#endif
 };
 
+/**
+ * \brief Built-in statistical profiler
+ *
+ * While running, the profiler is interrupted in regular intervals of consumed
+ * CPU time (via \c SIGPROF). Each interruption records the phases that are
+ * active on the interrupted thread, which are then aggregated into the
+ * fraction of time spent inside of each phase (\a inclusive) and inside of
+ * each phase but not in one of its nested phases (\a exclusive).
+ *
+ * Phases are only recorded when Mitsuba is compiled with the
+ * \c MI_PROFILER_SAMPLING CMake option, which is enabled by default on Linux
+ * and macOS. Since vectorized variants only run the instrumented C++ code
+ * while tracing kernels, the reports are mainly meaningful for the scalar
+ * variants.
+ */
 class MI_EXPORT_LIB Profiler {
 public:
     static void static_initialization();
     static void static_shutdown();
+
+    /// Is the sampling profiler available in this build?
+    static bool enabled();
+
+    /// Start sampling, once every \c interval milliseconds of CPU time
+    static void start(float interval = 1.f);
+
+    /// Stop sampling. Collected samples remain available to \ref report()
+    static void stop();
+
+    /// Is the profiler currently sampling?
+    static bool running();
+
+    /// Discard all collected samples
+    static void reset();
+
+    /// Number of samples collected since the last call to \ref reset()
+    static size_t sample_count();
+
+    /**
+     * \brief Return a report of the time spent in the profiler phases
+     *
+     * \param json
+     *     Format the report as a JSON object instead of a human-readable
+     *     table.
+     */
+    static std::string report(bool json = false);
 };
 
 NAMESPACE_END(mitsuba)
@@ -80,6 +80,17 @@ public:
     /// Verify if a value with the specified name exists
     bool has_property(const std::string &name) const;
 
+    /// Return the number of stored properties
+    size_t size() const;
+
+    /**
+     * \brief Reserve memory for the given number of properties
+     *
+     * This avoids repeated reallocations when the number of properties is
+     * known in advance, e.g. when converting a Python dictionary.
+     */
+    void reserve(size_t size);
+
     /** \brief Returns the type of an existing property.
      * If no property exists under that name, an error is logged
      * and type <tt>void</tt> is returned.
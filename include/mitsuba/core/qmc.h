@@ -69,22 +69,43 @@ public:
         if (unlikely(base_index >= m_base_count))
             Throw("eval(): out of bounds (prime base too large)");
 
-        const PrimeBase base = m_base[base_index];
-
-        UInt64 value(0),
-               divisor((uint64_t) base.value);
-        Float factor = Float(1.f),
-              recip(base.recip);
+        UInt64 value(0);
+        Float factor = Float(1.f);
 
         auto active = dr::neq(index, 0u);
 
-        while (dr::any(active)) {
-            auto active_f = dr::reinterpret_array<dr::mask_t<Float>>(active);
-            UInt64 next = dr::idiv(index, base.divisor);
-            dr::masked(factor, active_f) = factor * recip;
-            dr::masked(value, active) = (value - next) * divisor + index;
-            index = next;
-            active = dr::neq(index, 0u);
+        if (base_index < m_table_count) {
+            /* Resolve several digits per iteration using a lookup table */
+            const DigitTable &table = m_tables[base_index];
+
+            UInt64 size((uint64_t) table.size),
+                   mask(0xffffu);
+            Float recip(table.recip);
+
+            while (dr::any(active)) {
+                auto active_f = dr::reinterpret_array<dr::mask_t<Float>>(active);
+                UInt64 next = dr::idiv(index, table.divisor);
+                dr::masked(factor, active_f) = factor * recip;
+                UInt64 block = index - next * size;
+                dr::masked(value, active) =
+                    value * size + (dr::gather<UInt64, 2>(table.values, block, active) & mask);
+                index = next;
+                active = dr::neq(index, 0u);
+            }
+        } else {
+            const PrimeBase base = m_base[base_index];
+
+            UInt64 divisor((uint64_t) base.value);
+            Float recip(base.recip);
+
+            while (dr::any(active)) {
+                auto active_f = dr::reinterpret_array<dr::mask_t<Float>>(active);
+                UInt64 next = dr::idiv(index, base.divisor);
+                dr::masked(factor, active_f) = factor * recip;
+                dr::masked(value, active) = (value - next) * divisor + index;
+                index = next;
+                active = dr::neq(index, 0u);
+            }
         }
 
         return dr::minimum(dr::OneMinusEpsilon<Float>, Float(value) * factor);
@@ -107,22 +128,44 @@ public:
         const uint16_t *perm = m_permutations[base_index];
 
         UInt64 value(0),
-               divisor((uint64_t) base.value),
                mask(0xffffu);
-        Float factor(1.f),
-              recip(base.recip);
+        Float factor(1.f);
 
         auto active = dr::neq(index, 0);
 
-        while (dr::any(active)) {
-            auto active_f = dr::reinterpret_array<dr::mask_t<Float>>(active);
-            UInt64 next = dr::idiv(index, base.divisor);
-            dr::masked(factor, active_f) = factor * recip;
-            UInt64 digit = index - next * divisor;
-            dr::masked(value, active) =
-                value * divisor + (dr::gather<UInt64, 2>(perm, digit, active) & mask);
-            index = next;
-            active = dr::neq(index, 0);
+        if (base_index < m_table_count) {
+            /* Resolve several (permuted) digits per iteration using a lookup
+               table. Zero-valued leading digits of the last block map to
+               perm[0], which is consistent with the correction term below. */
+            const DigitTable &table = m_tables[base_index];
+
+            UInt64 size((uint64_t) table.size);
+            Float recip(table.recip);
+
+            while (dr::any(active)) {
+                auto active_f = dr::reinterpret_array<dr::mask_t<Float>>(active);
+                UInt64 next = dr::idiv(index, table.divisor);
+                dr::masked(factor, active_f) = factor * recip;
+                UInt64 block = index - next * size;
+                dr::masked(value, active) =
+                    value * size + (dr::gather<UInt64, 2>(table.scrambled, block, active) & mask);
+                index = next;
+                active = dr::neq(index, 0);
+            }
+        } else {
+            UInt64 divisor((uint64_t) base.value);
+            Float recip(base.recip);
+
+            while (dr::any(active)) {
+                auto active_f = dr::reinterpret_array<dr::mask_t<Float>>(active);
+                UInt64 next = dr::idiv(index, base.divisor);
+                dr::masked(factor, active_f) = factor * recip;
+                UInt64 digit = index - next * divisor;
+                dr::masked(value, active) =
+                    value * divisor + (dr::gather<UInt64, 2>(perm, digit, active) & mask);
+                index = next;
+                active = dr::neq(index, 0);
+            }
         }
 
         Float correction(base.recip * (Float) perm[0] / ((Float) 1 - base.recip));
@@ -139,6 +182,29 @@ public:
         return m_inv_permutations[basis];
     }
 
+    /**
+     * \brief Return the number of digits that are resolved by a single lookup
+     * into the table returned by \ref digit_table()
+     *
+     * Tables are only available for small bases, whose blocks of several
+     * digits fit into 4096 table entries. The function returns 1 for all
+     * other bases.
+     */
+    size_t digits_per_lookup(size_t base_index) const;
+
+    /**
+     * \brief Return a lookup table that reverses blocks of several digits in
+     * the given prime number basis
+     *
+     * Entry \c i of the table stores the \ref digits_per_lookup() least
+     * significant digits of \c i in reversed order, i.e., the radical
+     * inverse of \c i scaled by <tt>base^digits</tt>. When \c scrambled is
+     * set, every digit is additionally run through the scrambling
+     * permutation. Returns \c nullptr when no table is available for
+     * the base.
+     */
+    const uint16_t *digit_table(size_t base_index, bool scrambled = false) const;
+
     /// Return a human-readable string representation
     virtual std::string to_string() const override;
 private:
@@ -174,12 +240,25 @@ private:
 #  pragma pack(pop)
 #endif
 
+    /* Lookup tables that resolve multiple digits of a small base at once */
+    struct DigitTable {
+        dr::divisor<uint64_t> divisor;
+        uint32_t size;
+        uint32_t digits;
+        float recip;
+        uint16_t *values;
+        uint16_t *scrambled;
+    };
+
     size_t m_base_count = 0;
     std::unique_ptr<PrimeBase[]> m_base;
     std::unique_ptr<uint16_t[]> m_permutation_storage;
     std::unique_ptr<uint16_t*[]> m_permutations;
     std::unique_ptr<uint16_t[]> m_inv_permutation_storage;
     std::unique_ptr<uint16_t*[]> m_inv_permutations;
+    size_t m_table_count = 0;
+    std::unique_ptr<DigitTable[]> m_tables;
+    std::unique_ptr<uint16_t[]> m_table_storage;
     int m_scramble;
 };
 
@@ -236,4 +315,52 @@ Float sobol_2(UInt index, UInt scramble = 0) {
     }
 }
 
+/// Reverse the order of the bits of a 32 bit unsigned integer
+template <typename UInt32> UInt32 reverse_bits_32(UInt32 x) {
+    x = (x << 16) | (x >> 16);
+    x = ((x & 0x00ff00ff) << 8) | ((x & 0xff00ff00) >> 8);
+    x = ((x & 0x0f0f0f0f) << 4) | ((x & 0xf0f0f0f0) >> 4);
+    x = ((x & 0x33333333) << 2) | ((x & 0xcccccccc) >> 2);
+    x = ((x & 0x55555555) << 1) | ((x & 0xaaaaaaaa) >> 1);
+    return x;
+}
+
+/**
+ * \brief Multiply an index with the generator matrix of the second dimension
+ * of the Sobol' sequence
+ *
+ * Together with the van der Corput sequence (\ref reverse_bits_32()), this
+ * dimension forms a (0, 2)-sequence in base 2. The columns of the matrix are
+ * generated on the fly, which unrolls into a fixed sequence of bit operations
+ * without any loop or table lookup.
+ */
+template <typename UInt32> UInt32 sobol_matrix_2(UInt32 index) {
+    UInt32 result = 0;
+    uint32_t column = 1u << 31;
+    for (uint32_t i = 0; i < 32; ++i) {
+        result ^= (UInt32(0u) - ((index >> i) & 1u)) & column;
+        column ^= column >> 1;
+    }
+    return result;
+}
+
+/**
+ * \brief Owen-scramble the bits of a 32 bit fixed point number in [0, 1)
+ *
+ * Uses the hash-based nested uniform scrambling of Burley
+ * ("Practical Hash-based Owen Scrambling", JCGT 2020): every bit is
+ * flipped depending on the seed and on all more significant bits. Applied to
+ * the index of a (0, m, 2)-sequence, the scramble permutes the index while
+ * keeping every aligned power-of-two block of samples stratified.
+ */
+template <typename UInt32> UInt32 owen_scramble(UInt32 x, UInt32 seed) {
+    x = reverse_bits_32(x);
+    x ^= x * 0x3d20adeau;
+    x += seed;
+    x *= (seed >> 16) | 1u;
+    x ^= x * 0x05526c56u;
+    x ^= x * 0x53a22864u;
+    return reverse_bits_32(x);
+}
+
 NAMESPACE_END(mitsuba)
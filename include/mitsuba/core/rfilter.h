@@ -291,6 +291,78 @@ template <typename Scalar_> struct Resampler {
         (this->*f)(source, source_stride, target, target_stride, channels);
     }
 
+    /**
+     * \brief Compute output sample \c i of many interleaved signals at once
+     *
+     * This is equivalent to calling \ref resample() for \c count signals with
+     * a single channel each, but it processes adjacent values with packets.
+     * This is much faster when resampling the columns of a bitmap, since
+     * entire rows are processed at once.
+     *
+     * \param source
+     *     Source array. Sample \c k of signal \c l is stored at
+     *     <tt>source[k * source_stride + l]</tt>.
+     * \param source_stride
+     *     Offset between successive samples of a signal in the source array
+     * \param target
+     *     Array that receives output sample \c i of the \c count signals
+     * \param count
+     *     Number of signals
+     * \param i
+     *     Index of the output sample
+     */
+    void resample_lanes(const Scalar *source, size_t source_stride,
+                        Scalar *target, size_t count, uint32_t i) const {
+        const uint32_t taps = m_taps;
+        const Scalar *weights =
+            m_weights.get() + (m_start ? (size_t) i * taps : 0);
+        const int32_t offset =
+            m_start ? m_start[i] : ((int32_t) i - (int32_t) (taps / 2));
+        const Scalar min = std::get<0>(m_clamp);
+        const Scalar max = std::get<1>(m_clamp);
+        const bool clamp =
+            m_clamp != std::make_pair(-std::numeric_limits<Scalar>::infinity(),
+                                       std::numeric_limits<Scalar>::infinity());
+
+        size_t l = 0;
+
+        if constexpr (std::is_same_v<Scalar, float> ||
+                      std::is_same_v<Scalar, double>) {
+            using ScalarP = dr::Packet<Scalar>;
+
+            for (; l + ScalarP::Size <= count; l += ScalarP::Size) {
+                ScalarP result = 0;
+                for (uint32_t j = 0; j < taps; ++j) {
+                    int32_t pos = offset + (int32_t) j;
+                    Scalar value;
+                    ScalarP values = resolve(pos, value)
+                        ? dr::load<ScalarP>(source + pos * source_stride + l)
+                        : ScalarP(value);
+                    result += values * weights[j];
+                }
+
+                if (clamp)
+                    result = dr::clamp(result, min, max);
+
+                dr::store(target + l, result);
+            }
+        }
+
+        // Remaining signals, or all of them for other component types
+        for (; l < count; ++l) {
+            Scalar result = 0;
+            for (uint32_t j = 0; j < taps; ++j) {
+                int32_t pos = offset + (int32_t) j;
+                Scalar value;
+                if (resolve(pos, value))
+                    value = source[pos * source_stride + l];
+                result += value * weights[j];
+            }
+
+            target[l] = clamp ? dr::template clamp<Scalar>(result, min, max) : result;
+        }
+    }
+
 
     /// Return a human-readable summary
     std::string to_string() const {
@@ -375,6 +447,19 @@ private:
     }
 
     Scalar lookup(const Scalar *source, int32_t pos, uint32_t stride, uint32_t ch) const {
+        Scalar value;
+        if (resolve(pos, value))
+            value = source[pos * stride + ch];
+        return value;
+    }
+
+    /**
+     * \brief Apply the boundary condition to the sample position \c pos
+     *
+     * Returns \c false and sets \c value if the boundary condition instead
+     * specifies a constant value.
+     */
+    bool resolve(int32_t &pos, Scalar &value) const {
         if (unlikely(pos < 0 || pos >= (int32_t) m_source_res)) {
             switch (m_bc) {
                 case FilterBoundaryCondition::Clamp:
@@ -392,14 +477,16 @@ private:
                     break;
 
                 case FilterBoundaryCondition::One:
-                    return Scalar(1);
+                    value = Scalar(1);
+                    return false;
 
                 case FilterBoundaryCondition::Zero:
-                    return Scalar(0);
+                    value = Scalar(0);
+                    return false;
             }
         }
 
-        return source[pos * stride + ch];
+        return true;
     }
 
 private:
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <mitsuba/core/stream.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/** \brief \ref Stream implementation that reads and writes data over a TCP
+ * connection.
+ *
+ * Connections are either established to a remote host, or accepted on a
+ * local port via \ref SocketListener::accept(). The stream is not seekable:
+ * \ref tell() and \ref size() report the number of bytes that were received
+ * and sent, respectively.
+ *
+ * Since both ends of a connection may run on machines with a different
+ * endianness, the stream uses the network byte order (big endian) by default.
+ */
+class MI_EXPORT_LIB SocketStream : public Stream {
+public:
+    /// Connect to the given remote host and port
+    SocketStream(const std::string &host, uint16_t port);
+
+    /// Return a string describing the remote end of the connection
+    const std::string &peer() const { return m_peer; }
+
+    /** \brief Closes the stream and the underlying connection.
+     * No further read or write operations are permitted.
+     *
+     * This function is idempotent.
+     * It is called automatically by the destructor.
+     */
+    virtual void close() override;
+
+    /// Whether the stream is closed (no read or write are then permitted).
+    virtual bool is_closed() const override;
+
+    // =========================================================================
+    //! @{ \name Implementation of the Stream interface
+    // =========================================================================
+
+    /**
+     * \brief Reads exactly \c size bytes, waiting for them as necessary
+     *
+     * Throws an \ref EOFException when the remote end closes the connection.
+     */
+    virtual void read(void *p, size_t size) override;
+    virtual void write(const void *p, size_t size) override;
+    virtual void seek(size_t pos) override;
+    virtual void truncate(size_t size) override;
+    virtual size_t tell() const override;
+    virtual size_t size() const override;
+    virtual void flush() override;
+    virtual bool can_write() const override;
+    virtual bool can_read() const override;
+
+    //! @}
+    // =========================================================================
+
+    virtual std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    friend class SocketListener;
+
+    /// Wrap an existing connected socket
+    SocketStream(int64_t socket, const std::string &peer);
+
+    /// Protected destructor.
+    virtual ~SocketStream();
+
+private:
+    /// Platform-specific socket handle (-1 when closed)
+    int64_t m_socket;
+    /// Description of the remote end
+    std::string m_peer;
+    /// Number of bytes received so far
+    size_t m_received;
+    /// Number of bytes sent so far
+    size_t m_sent;
+};
+
+/** \brief Listening TCP socket that accepts incoming \ref SocketStream
+ * connections
+ *
+ * The socket stays open until the listener is closed or destroyed, such that
+ * a server can accept any number of connections on the same port. Pending
+ * connections are queued by the operating system in the meantime.
+ */
+class MI_EXPORT_LIB SocketListener : public Object {
+public:
+    /**
+     * \brief Listen on the given local port
+     *
+     * \param port
+     *     Port to listen on. When set to zero, the operating system picks an
+     *     unused port, which can be queried via \ref port().
+     *
+     * \param address
+     *     Local address to bind to. The default only accepts connections from
+     *     the same machine; \c "0.0.0.0" or \c "::" accept connections on
+     *     all network interfaces.
+     */
+    SocketListener(uint16_t port, const std::string &address = "127.0.0.1");
+
+    /// Wait for the next incoming connection
+    ref<SocketStream> accept();
+
+    /// Return the local port of the listening socket
+    uint16_t port() const { return m_port; }
+
+    /// Return the local address of the listening socket
+    const std::string &address() const { return m_address; }
+
+    /// Close the listening socket (idempotent)
+    void close();
+
+    /// Whether the listening socket is closed
+    bool is_closed() const { return m_socket == -1; }
+
+    virtual std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    /// Protected destructor.
+    virtual ~SocketListener();
+
+private:
+    /// Platform-specific socket handle (-1 when closed)
+    int64_t m_socket;
+    std::string m_address;
+    uint16_t m_port;
+};
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mitsuba/mitsuba.h>
+#include <cstdint>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Counter of events on rendering hot paths (ray intersections, BSDF
+ * calls, texture lookups, ..)
+ *
+ * Every thread increments its own copy of the counter with plain loads and
+ * stores, and \ref value() adds up the copies of all threads (including ones
+ * that have exited). This keeps atomic read-modify-write operations out of
+ * the hot paths, at the cost of a value that is only exact once the counting
+ * threads are idle.
+ *
+ * Counting is only enabled when Mitsuba is compiled with the \c
+ * MI_STATISTICS CMake option. Otherwise, \ref increment() is a no-op and
+ * \ref value() always returns zero.
+ */
+class MI_EXPORT_LIB StatisticsCounter {
+public:
+    StatisticsCounter();
+    ~StatisticsCounter();
+
+    StatisticsCounter(const StatisticsCounter &) = delete;
+    StatisticsCounter &operator=(const StatisticsCounter &) = delete;
+
+    /// Add \c amount to the counter of the calling thread
+#if defined(MI_ENABLE_STATISTICS)
+    void increment(uint64_t amount = 1) const;
+#else
+    void increment(uint64_t /* amount */ = 1) const { }
+#endif
+
+    /// Return the sum of the counters of all threads
+    uint64_t value() const;
+
+    /// Reset the counter (should not be called while other threads count)
+    void reset();
+
+private:
+    uint32_t m_id;
+};
+
+NAMESPACE_END(mitsuba)
@@ -360,18 +360,37 @@ MI_DECLARE_ENUM_OPERATORS(Struct::Flags)
  * this reason, the implementation of this class relies on a JIT compiler that
  * generates fast conversion code on demand for each specific conversion. The
  * function is cached and reused in case the same conversion is needed later
- * on. Note that JIT compilation only works on x86_64 processors; other
- * platforms use a slow generic fallback implementation.
+ * on.
+ *
+ * JIT compilation only works on x86_64 processors. Other platforms (e.g.
+ * AArch64), and converters that are created with <tt>jit=false</tt>, use a
+ * portable implementation instead. It resolves the fields of both records
+ * once when the converter is created. Fields that only need to be copied are
+ * merged into blocks of \c memcpy() calls, and 8-bit fields that must be
+ * converted to floating point are looked up in a precomputed table.
  */
 class MI_EXPORT_LIB StructConverter : public Object {
     using FuncType = bool (*) (size_t, size_t, const void *, void *);
 public:
     using Float = float;
 
-    /// Construct an optimized conversion routine going from \c source to \c target
-    StructConverter(const Struct *source, const Struct *target, bool dither = false);
+    /**
+     * \brief Construct an optimized conversion routine going from \c source
+     * to \c target
+     *
+     * \param jit
+     *     Compile the conversion routine if supported by the platform.
+     *     Otherwise, the portable implementation is used.
+     */
+    StructConverter(const Struct *source, const Struct *target,
+                    bool dither = false, bool jit = true);
 
-    /// Convert \c count elements. Returns \c true upon success
+    /**
+     * \brief Convert \c count elements. Returns \c true upon success
+     *
+     * Large conversions (at least \ref parallel_threshold() elements) are
+     * split into blocks that are converted in parallel on the thread pool.
+     */
     bool convert(size_t count, const void *src, void *dest) const {
         return convert_2d(count, 1, src, dest);
     }
@@ -386,17 +405,29 @@ public:
      * performs dithering to avoid banding artifacts (if enabled in the
      * constructor).
      *
+     * Large images are split into bands of rows that are converted in
+     * parallel. When dithering, the bands are aligned to the period of the
+     * dither matrix, hence the result does not depend on the split.
+     *
      * \return \c true upon success
      */
-#if MI_STRUCTCONVERTER_USE_JIT == 1
-    bool convert_2d(size_t width, size_t height, const void *src,
-                    void *dest) const {
-        return m_func(width, height, src, dest);
-    }
-#else
     bool convert_2d(size_t width, size_t height, const void *src,
                     void *dest) const;
+
+    /// Return the number of elements above which conversions run in parallel
+    static size_t parallel_threshold() { return m_parallel_threshold; }
+
+    /// Set the number of elements above which conversions run in parallel
+    static void set_parallel_threshold(size_t value) { m_parallel_threshold = value; }
+
+    /// Does this converter use a JIT-compiled conversion routine?
+    bool uses_jit() const {
+#if MI_STRUCTCONVERTER_USE_JIT == 1
+        return m_func != nullptr;
+#else
+        return false;
 #endif
+    }
 
     /// Return the source \c Struct descriptor
     const Struct *source() const { return m_source.get(); }
@@ -409,9 +440,7 @@ public:
 
     MI_DECLARE_CLASS()
 protected:
-
-#if MI_STRUCTCONVERTER_USE_JIT == 0
-    // Support data structures/functions for non-accelerated conversion backend
+    // Support data structures/functions for the portable conversion backend
 
     struct Value {
         Struct::Type type;
@@ -425,19 +454,74 @@ protected:
         };
     };
 
+    /// Block of bytes that is copied from the source to the target record
+    struct CopyStep {
+        size_t source_offset;
+        size_t target_offset;
+        size_t size;
+    };
+
+    /// Precomputed conversion of one field of the target record
+    struct FieldStep {
+        enum class Kind : uint8_t { Load, Default, Blend };
+
+        /// Treatment of premultiplied alpha
+        enum class Alpha : uint8_t { None, Premultiply, Unpremultiply };
+
+        Kind kind;
+        Alpha alpha;
+        /// Should the loaded value be converted to linear floating point?
+        bool linearize;
+        Struct::Field target;
+        Struct::Field source;
+        std::vector<std::pair<double, Struct::Field>> blend;
+        /// Linearized values of all 8-bit source values (may be empty)
+        std::vector<Float> table;
+    };
+
+#if MI_STRUCTCONVERTER_USE_JIT == 1
+    /// JIT-compile the conversion routine
+    void compile();
+#endif
+
+    /// Resolve the fields of the portable conversion routine
+    void prepare();
+
+    /// Convert a 2D image on the calling thread
+    bool convert_2d_serial(size_t width, size_t height, const void *src,
+                           void *dest) const {
+#if MI_STRUCTCONVERTER_USE_JIT == 1
+        if (m_func)
+            return m_func(width, height, src, dest);
+#endif
+        return convert_2d_portable(width, height, src, dest);
+    }
+
+    bool convert_2d_portable(size_t width, size_t height, const void *src,
+                             void *dest) const;
     bool load(const uint8_t *src, const Struct::Field &f, Value &value) const;
     void linearize(Value &value) const;
     void save(uint8_t *dst, const Struct::Field &f, Value value, size_t x, size_t y) const;
-#endif
 
 protected:
     ref<const Struct> m_source;
     ref<const Struct> m_target;
 #if MI_STRUCTCONVERTER_USE_JIT == 1
-    FuncType m_func;
-#else
-    bool m_dither;
+    FuncType m_func = nullptr;
 #endif
+    bool m_dither;
+
+    // State of the portable conversion routine
+    std::vector<CopyStep> m_copy_steps;
+    std::vector<FieldStep> m_field_steps;
+    std::vector<Struct::Field> m_assert_fields;
+    Struct::Field m_weight_field, m_alpha_field;
+    bool m_has_weight = false, m_has_alpha = false;
+    bool m_has_multiple_alpha_channels = false;
+    /// Are the records identical, such that whole buffers can be copied?
+    bool m_copy_records = false;
+
+    static size_t m_parallel_threshold;
 };
 
 extern MI_EXPORT_LIB std::ostream &operator<<(std::ostream &os, Struct::Type value);
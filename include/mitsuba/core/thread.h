@@ -64,6 +64,16 @@ public:
     /// Return the core affinity
     int core_affinity() const;
 
+    /**
+     * \brief Restrict the thread to the cores of a NUMA node
+     *
+     * Passing -1 removes the restriction. Only supported on Linux.
+     */
+    void set_numa_node(int node);
+
+    /// Return the NUMA node that the thread is restricted to (-1 if none)
+    int numa_node() const;
+
     /**
      * \brief Specify whether or not this thread is critical
      *
@@ -138,12 +148,36 @@ public:
     /// Shut down the threading system
     static void static_shutdown();
 
-    /// Return the global thread count
+    /**
+     * \brief Return the global thread count
+     *
+     * This defaults to \ref util::core_count(), limited by the value of the
+     * \c MI_MAX_THREADS environment variable. The same thread pool runs
+     * Mitsuba's parallel loops, the LLVM kernels of Dr.Jit, the Embree builds
+     * and the OpenEXR I/O.
+     */
     static size_t thread_count();
 
     /// Set the global thread count (e.g. spawn new threads in thread pool if > 1)
     static void set_thread_count(size_t);
 
+    /**
+     * \brief Enable or disable NUMA-aware scheduling of the thread pool
+     *
+     * When enabled on a machine with several NUMA nodes, the worker threads
+     * of the pool are assigned to the nodes in round-robin order and only run
+     * on the cores of their node. Memory that a worker touches first (e.g.
+     * its private film buffer) then stays local to its node, and read-mostly
+     * scene data (acceleration data structures, meshes and textures) is
+     * interleaved across the nodes via \ref util::numa_interleave(). The
+     * thread pool is restarted so that the setting applies to all workers.
+     * Disabled by default.
+     */
+    static void set_numa_aware(bool value);
+
+    /// Is NUMA-aware scheduling of the thread pool enabled?
+    static bool numa_aware();
+
     /**
      * \brief Register a new thread (e.g. Dr.Jit, Python) with Mitsuba thread system.
      * Returns true upon success.
@@ -195,6 +229,8 @@ public:
 private:
     ref<Logger> m_logger;
     ref<FileResolver> m_file_resolver;
+    /// Active profiler phases, which are inherited by worker threads
+    uint64_t m_profiler_flags;
 };
 
 /// RAII-style class to temporarily switch to another thread's logger/file resolver
@@ -209,6 +245,7 @@ public:
 private:
     ref<Logger> m_logger;
     ref<FileResolver> m_file_resolver;
+    uint64_t m_profiler_flags;
 };
 
 NAMESPACE_END(mitsuba)
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/object.h>
+#include <cstdio>
+#include <mutex>
+
+/// Default width and height of the tiles of a \ref TiledImage
+#define MI_TILE_SIZE 64u
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Image pyramid that is split into square tiles, which are paged in
+ * on demand
+ *
+ * The constructor copies the pixels of every level into an anonymous
+ * temporary page file and keeps no image data in memory. Afterwards, tiles are
+ * read from this file when they are first accessed and stored in the \ref
+ * TileCache, which is shared by all images and bounded by a global memory
+ * budget. This is used by the \c bitmap texture (<tt>tiled=true</tt>) so that
+ * scenes can reference more texture data than fits into memory, as long as
+ * the set of tiles accessed around the same time does. The page file is
+ * removed automatically when the image is destroyed.
+ *
+ * The pixels are stored as single precision floating point values, tiles at
+ * the right and bottom boundary of a level are padded with zeros.
+ */
+class MI_EXPORT_LIB TiledImage : public Object {
+public:
+    using Float = float;
+    MI_IMPORT_CORE_TYPES()
+
+    /**
+     * \brief Create a tiled image from a list of levels
+     *
+     * \param levels
+     *     The full resolution image, optionally followed by coarser MIP map
+     *     levels. All levels must have the same number of channels.
+     *
+     * \param tile_size
+     *     Width and height of a tile in pixels
+     */
+    TiledImage(const std::vector<ref<Bitmap>> &levels,
+               uint32_t tile_size = MI_TILE_SIZE);
+
+    /// Return the number of levels
+    uint32_t level_count() const { return (uint32_t) m_levels.size(); }
+
+    /// Return the resolution of the given level
+    const ScalarVector2u &size(uint32_t level = 0) const {
+        return m_levels[level].size;
+    }
+
+    /// Return the number of channels
+    uint32_t channel_count() const { return m_channel_count; }
+
+    /// Return the width and height of a tile
+    uint32_t tile_size() const { return m_tile_size; }
+
+    /**
+     * \brief Copy the channels of pixel <tt>(x, y)</tt> of the given level
+     * to \c out
+     *
+     * The coordinates must lie within the level. Loads the surrounding tile
+     * if it isn't resident. Safe to call from multiple threads.
+     */
+    void fetch(uint32_t level, uint32_t x, uint32_t y, float *out) const;
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    virtual ~TiledImage();
+
+    /// Read a tile from the page file
+    std::shared_ptr<const std::vector<float>> load_tile(uint32_t index) const;
+
+protected:
+    struct Level {
+        ScalarVector2u size;
+        ScalarVector2u tile_count;
+        /// Index of the first tile of this level
+        uint32_t tile_offset;
+    };
+
+    std::vector<Level> m_levels;
+    uint32_t m_channel_count;
+    uint32_t m_tile_size;
+    /// Unique identifier of this image within the tile cache
+    uint64_t m_id;
+
+    std::FILE *m_file;
+    mutable std::mutex m_file_mutex;
+};
+
+/**
+ * \brief Process-wide cache of the resident tiles of all \ref TiledImage
+ * instances
+ *
+ * When the memory used by the cached tiles exceeds the budget, the least
+ * recently loaded or accessed tiles are evicted. Worker threads briefly keep
+ * handles to a few recently used tiles, so the actual memory usage can
+ * exceed the budget by a small number of tiles per thread.
+ */
+class MI_EXPORT_LIB TileCache {
+public:
+    /// Set the memory budget in bytes (default: 1 GiB)
+    static void set_budget(size_t bytes);
+
+    /// Return the memory budget in bytes
+    static size_t budget();
+
+    /// Return the memory used by the cached tiles in bytes
+    static size_t usage();
+
+    /// Return the number of tiles that were read from page files so far
+    static size_t load_count();
+
+    /// Evict all tiles
+    static void clear();
+};
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/filesystem.h>
+#include <type_traits>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Recorder of timed events in the Chrome trace event format
+ *
+ * While the recorder is running, instrumented code reports time spans (via
+ * \ref ScopedTraceEvent) and values over time (via \ref add_counter()). Scene
+ * loading is instrumented in this way, i.e. the parsing of XML files, the
+ * instantiation of every object, the loading of plugins, file I/O, the
+ * evaluation of JIT kernels after the creation of objects, and the
+ * construction of acceleration data structures. Sampling integrators
+ * additionally report their render passes, the image blocks rendered by every
+ * worker thread, the time spent waiting for the film in
+ * <tt>put_block()</tt>, and the compilation and launch of JIT kernels.
+ *
+ * \ref json() formats the recorded events as a Chrome trace event JSON
+ * document, which can be opened with Perfetto (https://ui.perfetto.dev) or
+ * <tt>chrome://tracing</tt>. Events are grouped by thread, hence the trace
+ * also shows how well the worker threads are utilized.
+ *
+ * Recording is meant for coarse events that take at least a few microseconds.
+ * While the recorder is not running, the instrumented code only checks an
+ * atomic flag.
+ */
+class MI_EXPORT_LIB TraceRecorder {
+public:
+    /// Discard previously recorded events and start recording
+    static void start();
+
+    /// Stop recording. The recorded events remain available to \ref json()
+    static void stop();
+
+    /// Is the recorder currently running?
+    static bool running();
+
+    /// Discard all recorded events
+    static void clear();
+
+    /// Return the number of recorded events
+    static size_t event_count();
+
+    /// Return the time in microseconds since recording was started
+    static double timestamp();
+
+    /**
+     * \brief Record a span of time on the calling thread
+     *
+     * \param category
+     *     Category of the event (e.g. \c "io")
+     *
+     * \param name
+     *     Name of the event
+     *
+     * \param start
+     *     Start time returned by \ref timestamp()
+     *
+     * \param duration
+     *     Duration in microseconds
+     *
+     * \param args
+     *     Members of the JSON object with the arguments of the event, e.g.
+     *     <tt>"bytes": 12</tt> (optional)
+     */
+    static void add_event(const std::string &category, const std::string &name,
+                          double start, double duration,
+                          const std::string &args = "");
+
+    /// Record the current value of a counter (e.g. the number of active tasks)
+    static void add_counter(const std::string &category,
+                            const std::string &name, double value);
+
+    /// Return the recorded events as a Chrome trace event JSON document
+    static std::string json();
+
+    /// Write the recorded events as a Chrome trace event JSON file
+    static void write(const fs::path &filename);
+};
+
+/**
+ * \brief Records the lifetime of this object as an event of the \ref
+ * TraceRecorder
+ *
+ * Nothing is recorded unless the recorder was running when the object was
+ * created.
+ */
+class MI_EXPORT_LIB ScopedTraceEvent {
+public:
+    ScopedTraceEvent(const char *category, const std::string &name);
+    ~ScopedTraceEvent();
+
+    ScopedTraceEvent(const ScopedTraceEvent &) = delete;
+    ScopedTraceEvent &operator=(const ScopedTraceEvent &) = delete;
+
+    /// Is this event being recorded?
+    bool active() const { return m_active; }
+
+    /// Attach a string argument to the event
+    void set_arg(const char *key, const std::string &value);
+
+    /// Attach a numerical argument to the event
+    template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, int> = 0>
+    void set_arg(const char *key, T value) {
+        if (m_active)
+            set_arg_number(key, (double) value);
+    }
+
+private:
+    void set_arg_number(const char *key, double value);
+
+private:
+    bool m_active;
+    const char *m_category;
+    std::string m_name;
+    std::string m_args;
+    double m_start;
+};
+
+NAMESPACE_END(mitsuba)
@@ -4,6 +4,7 @@
 #include <tinyformat.h>
 #include <sstream>
 #include <string>
+#include <vector>
 
 NAMESPACE_BEGIN(mitsuba)
 NAMESPACE_BEGIN(util)
@@ -13,9 +14,32 @@ NAMESPACE_BEGIN(util)
     extern std::string MI_EXPORT_LIB last_error();
 #endif
 
-/// Determine the number of available CPU cores (including virtual cores)
+/**
+ * \brief Determine the number of available CPU cores (including virtual cores)
+ *
+ * On Linux, this accounts for the CPU affinity mask of the process and for
+ * the CPU quota of its cgroup (e.g. when running inside a container).
+ */
 extern MI_EXPORT_LIB int core_count();
 
+/// Determine the number of NUMA nodes of the machine (1 if unknown)
+extern MI_EXPORT_LIB int numa_node_count();
+
+/// Return the logical cores (as numbered by the OS) of the given NUMA node
+extern MI_EXPORT_LIB std::vector<int> numa_node_cores(int node);
+
+/**
+ * \brief Spread the pages of a memory region over all NUMA nodes
+ *
+ * Memory pages are placed on the NUMA node of the thread that first writes
+ * them. Read-mostly data that all worker threads access (e.g. acceleration
+ * data structures and textures) is therefore better interleaved across the
+ * nodes, such that no single memory controller becomes a bottleneck. Pages
+ * that are already resident are migrated. This function does nothing on
+ * machines with a single NUMA node and on platforms other than Linux.
+ */
+extern MI_EXPORT_LIB void numa_interleave(const void *ptr, size_t size);
+
 /**
  * \brief Convert a time difference (in seconds) to a string representation
  * \param time Time difference in (fractional) sections
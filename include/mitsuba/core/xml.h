@@ -52,20 +52,27 @@ using ParameterList = std::vector<std::tuple<std::string, std::string, bool>>;
  *
  * \param parallel
  *     Whether the loading should be executed on multiple threads in parallel
+ *
+ * \param skip_unreferenced
+ *     Whether top-level objects of a scene with an explicit ID (e.g. libraries
+ *     of BSDFs or textures) are skipped when no shape, emitter, sensor,
+ *     integrator or nested scene references them
  */
 extern MI_EXPORT_LIB std::vector<ref<Object>> load_file(
                                         const fs::path &path,
                                         const std::string &variant,
                                         ParameterList parameters = ParameterList(),
                                         bool update_scene = false,
-                                        bool parallel = true);
+                                        bool parallel = true,
+                                        bool skip_unreferenced = false);
 
 /// Load a Mitsuba scene from an XML string
 extern MI_EXPORT_LIB std::vector<ref<Object>> load_string(
                                         const std::string &string,
                                         const std::string &variant,
                                         ParameterList parameters = ParameterList(),
-                                        bool parallel = true);
+                                        bool parallel = true,
+                                        bool skip_unreferenced = false);
 
 
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/stream.h>
+#include <vector>
 
 extern "C" {
     struct z_stream_s;
@@ -19,6 +20,15 @@ NAMESPACE_END(detail)
  *
  * This class transparently decompresses and compresses reads and writes
  * to a nested stream, respectively.
+ *
+ * Small reads and writes are served from internal buffers, such that a
+ * sequence of small values (e.g. the fields of a file header) does not
+ * invoke \c zlib for each of them. When the child stream is a \ref
+ * MemoryStream wrapping an external buffer (such as a memory-mapped file),
+ * the compressed data is directly decompressed from that buffer.
+ *
+ * For data that is available as a whole, the static \ref compress() and
+ * \ref decompress() functions avoid the overheads of streaming altogether.
  */
 class MI_EXPORT_LIB ZStream : public Stream {
 public:
@@ -62,6 +72,51 @@ public:
     /// Returns the child stream of this compression stream
     Stream *child_stream() { return m_child_stream; }
 
+    /**
+     * \brief Compress a buffer in one go
+     *
+     * When \c block_size is nonzero and smaller than the buffer, the buffer
+     * is split into blocks of this size that are compressed in parallel.
+     * Every block is primed with the last 32 KiB of the preceding block, and
+     * the compressed blocks are joined into a single stream that can be
+     * decompressed by any \c zlib-compatible decoder (including this class).
+     * The result is only marginally larger than that of a sequential
+     * compression.
+     *
+     * \param data
+     *     Data to be compressed
+     *
+     * \param size
+     *     Size of the data in bytes
+     *
+     * \param stream_type
+     *     Format of the compressed stream
+     *
+     * \param level
+     *     Compression level between 0 and 9, or -1 for the default level
+     *
+     * \param block_size
+     *     Size of the blocks that are compressed in parallel in bytes, or 0
+     *     to compress the data sequentially
+     */
+    static std::vector<uint8_t> compress(const void *data, size_t size,
+                                         EStreamType stream_type = EDeflateStream,
+                                         int level = -1, size_t block_size = 0);
+
+    /**
+     * \brief Decompress a buffer in one go
+     *
+     * Throws an exception when the stream is invalid, or when it does not
+     * decompress to exactly \c dst_size bytes.
+     *
+     * \return
+     *     The number of consumed bytes of \c src, which may be followed by
+     *     unrelated data
+     */
+    static size_t decompress(const void *src, size_t src_size, void *dst,
+                             size_t dst_size,
+                             EStreamType stream_type = EDeflateStream);
+
     //! @}
     // =========================================================================
 
@@ -126,12 +181,33 @@ protected:
     /// Protected destructor
     virtual ~ZStream();
 
+private:
+    /// Compress data and write it to the child stream using the given flush mode
+    void deflate_data(const uint8_t *p, size_t size, int flush);
+
+    /**
+     * Decompress up to \c size bytes. Unless \c partial is set, throws an
+     * exception when the stream ends before producing all of them.
+     */
+    size_t inflate_data(uint8_t *p, size_t size, bool partial);
+
 private:
     ref<Stream> m_child_stream;
     std::unique_ptr<z_stream> m_deflate_stream, m_inflate_stream;
     uint8_t m_deflate_buffer[detail::kZStreamBufferSize];
     uint8_t m_inflate_buffer[detail::kZStreamBufferSize];
     bool m_did_write;
+
+    /// Uncompressed data of small writes that was not yet compressed
+    uint8_t m_write_buffer[detail::kZStreamBufferSize];
+    size_t m_write_size = 0;
+
+    /// Decompressed data that was not yet returned by \ref read()
+    uint8_t m_read_buffer[detail::kZStreamBufferSize];
+    size_t m_read_pos = 0, m_read_size = 0;
+
+    /// Child stream, if its external buffer can be decompressed in place
+    MemoryStream *m_memory_stream = nullptr;
 };
 
 NAMESPACE_END(mitsuba)
@@ -543,6 +543,207 @@ static const char *__doc_mitsuba_ArgParser_parse = R"doc(Parse the given set of
 
 static const char *__doc_mitsuba_ArgParser_parse_2 = R"doc(Parse the given set of command line arguments)doc";
 
+static const char *__doc_mitsuba_AssetCache =
+R"doc(Process-wide cache of assets that were loaded from disk
+
+Scenes frequently reference the same file from several plugin
+instances, e.g. a texture used with different wrap modes or a mesh
+instantiated with different BSDFs. Plugins such as ``bitmap``,
+``ply``, ``obj``, and ``gridvolume`` use this cache to load and
+convert such a file only once and to share the resulting buffers
+between all instances.
+
+Entries are identified by the resolved path, the modification time and
+size of the file, and a plugin-specific string that must describe
+every parameter affecting the converted data (including the variant).
+The cache holds a reference to every entry and releases it once no
+other object refers to it anymore. Unused entries are removed whenever
+the cache is accessed and by clear().
+
+Concurrent requests for the same entry are serialized: the first
+caller obtains a Ticket and loads the asset, while the others wait
+until it is available.
+
+Processes running on the same machine can additionally share assets
+through a directory that is backed by shared memory (e.g. a
+subdirectory of ``/dev/shm`` on Linux), see get_shared(). It is set by
+the ``MI_SHARED_ASSET_DIR`` environment variable or
+set_shared_directory().)doc";
+
+static const char *__doc_mitsuba_AssetCache_clear = R"doc(Release all entries)doc";
+
+static const char *__doc_mitsuba_AssetCache_enabled = R"doc(Is the cache enabled?)doc";
+
+static const char *__doc_mitsuba_AssetCache_get =
+R"doc(Look up the entry for ``path`` and ``key``
+
+Returns:
+    The cached object, if available. Otherwise, ``ticket`` is set and
+    the caller should load the asset and pass it to put(). Both are
+    ``nullptr`` when the cache is disabled.)doc";
+
+static const char *__doc_mitsuba_AssetCache_get_2 =
+R"doc(Look up the entry for ``path`` and ``key``, and invoke ``load`` to
+create it if it is missing)doc";
+
+static const char *__doc_mitsuba_AssetCache_get_shared =
+R"doc(Look up an entry of the node-local shared asset directory
+
+Entries are identified like those of the process-wide cache and hold
+the asset in a layout that can be accessed in place. When the entry is
+missing, ``write`` is invoked to serialize the asset into a stream,
+which is published atomically so that other processes never observe a
+partially written entry.
+
+Returns:
+    A read-only mapping of the entry, or ``nullptr`` when the shared
+    directory is not set, when ``path`` does not refer to a file, or
+    when the entry could not be created (the caller should then load
+    the asset itself).)doc";
+
+static const char *__doc_mitsuba_AssetCache_prune = R"doc(Release all entries that are no longer used)doc";
+
+static const char *__doc_mitsuba_AssetCache_put = R"doc(Store the asset loaded for an entry returned missing by get())doc";
+
+static const char *__doc_mitsuba_AssetCache_set_enabled = R"doc(Enable or disable the cache (it is enabled by default))doc";
+
+static const char *__doc_mitsuba_AssetCache_set_shared_directory =
+R"doc(Set the node-local shared asset directory
+
+An empty path disables the sharing of assets between processes.)doc";
+
+static const char *__doc_mitsuba_AssetCache_shared_directory =
+R"doc(Return the node-local shared asset directory (empty if disabled))doc";
+
+static const char *__doc_mitsuba_AssetCache_size = R"doc(Return the number of entries)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream =
+R"doc(Read-only Stream implementation that reads a file with positional
+reads and asynchronous read-ahead
+
+In contrast to FileStream, this class bypasses the buffering of
+``std::fstream``. It reads the file in large blocks that start at a
+multiple of the block size (using ``pread()`` on Linux and macOS).
+When the stream is read sequentially, the next block is read in the
+background on the thread pool, which overlaps the I/O with the
+decoding of the previous block. Reads that span at least one block
+bypass the internal buffers and go directly to the destination.
+
+In addition, read_at() reads data at an arbitrary position without
+changing the position of the stream. It may be called concurrently
+from multiple threads.
+
+This stream is designed for large files on network file systems,
+where the latency of individual requests dominates the cost of
+reading.)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_AsyncFileStream =
+R"doc(Opens the file pointed by ``p`` for reading
+
+Parameter ``block_size``:
+    Size of the blocks that are read from the file in bytes
+
+Parameter ``read_ahead``:
+    Read the next block in the background when reading sequentially
+
+Throws an exception if the file cannot be opened.)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_Buffer = R"doc(Block of the file held in memory)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_Buffer_block =
+R"doc(Index of the block, or ``(size_t) -1`` if the buffer is empty)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_Buffer_data = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_Buffer_error = R"doc(Exception raised by the read-ahead task)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_Buffer_size = R"doc(Number of valid bytes)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_Buffer_task = R"doc(Pending read-ahead task (if any))doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_block_size = R"doc(Return the size of the blocks that are read from the file)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_can_read = R"doc(True except if the stream was closed.)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_can_write = R"doc(Always false, since this stream is read-only)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_class = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_close =
+R"doc(Closes the stream and the underlying file. No further read operations
+are permitted.
+
+This function is idempotent. It is called automatically by the
+destructor.)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_fetch =
+R"doc(Return the buffer holding the given block, and start the read-ahead)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_flush = R"doc(No-op, since this stream is read-only)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_is_closed =
+R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_block_size = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_bytes_read =
+R"doc(Statistics for the TraceRecorder (start time is negative if inactive))doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_current =
+R"doc(Block that is currently read, and the block that is read ahead)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_fd = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_handle = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_next = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_path = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_pos = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_read_ahead = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_size = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_m_trace_start = R"doc()doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_path = R"doc(Return the path descriptor associated with this stream)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_read =
+R"doc(Reads a specified amount of data from the stream. Throws an exception
+when the stream ended prematurely.)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_read_ahead = R"doc(Is the next block read in the background?)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_read_at =
+R"doc(Read ``size`` bytes at position ``pos`` of the file
+
+This function does not change the position of the stream and is
+thread-safe. Throws an EOFException when the file ends before ``size``
+bytes were read.)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_read_some =
+R"doc(Read up to ``size`` bytes at position ``pos``, returns the number of
+bytes read)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_seek =
+R"doc(Seeks to a position inside the stream. Seeking beyond the end is
+allowed.)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_size = R"doc(Returns the size of the file when it was opened)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_tell = R"doc(Gets the current position inside the file)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_to_string = R"doc(Returns a string representation)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_truncate = R"doc(Always throws, since this stream is read-only)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_wait =
+R"doc(Wait for the read-ahead task of a buffer, rethrows its errors)doc";
+
+static const char *__doc_mitsuba_AsyncFileStream_write = R"doc(Always throws, since this stream is read-only)doc";
+
 static const char *__doc_mitsuba_AtomicFloat =
 R"doc(Atomic floating point data type
 
@@ -604,6 +805,10 @@ See also:
 See also:
     mitsuba.BSDFSample3f)doc";
 
+static const char *__doc_mitsuba_BSDFFlags_Subsurface =
+R"doc(Transmitted light is scattered below the surface (see
+BSDF::eval_subsurface()))doc";
+
 static const char *__doc_mitsuba_BSDF_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_BSDF_3 = R"doc()doc";
@@ -760,6 +965,18 @@ static const char *__doc_mitsuba_BSDFSample3_wo = R"doc(Normalized outgoing dire
 
 static const char *__doc_mitsuba_BSDF_BSDF = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_BSDF_alpha_test =
+R"doc(Evaluate the alpha test of a cutout surface
+
+Returns ``False`` where the surface is fully transparent. The ray
+tracing backends skip such intersections during the traversal instead
+of reporting them, which avoids continuation rays through the cutouts.
+This function is only called for BSDFs that enable it (see
+has_alpha_test()), and the surface interaction only provides the
+position, geometric normal, and UV coordinates.
+
+The default implementation accepts every intersection.)doc";
+
 static const char *__doc_mitsuba_BSDF_class = R"doc()doc";
 
 static const char *__doc_mitsuba_BSDF_component_count = R"doc(Number of components this BSDF is comprised of.)doc";
@@ -789,6 +1006,11 @@ Parameter ``si``:
 Parameter ``wo``:
     The outgoing direction)doc";
 
+static const char *__doc_mitsuba_BSDF_eval_counter =
+R"doc(Counts the evaluations (eval(), pdf() and eval_pdf()) of this BSDF by
+the path tracers (requires the ``MI_STATISTICS`` build option, scalar
+variants only))doc";
+
 static const char *__doc_mitsuba_BSDF_eval_diffuse_reflectance =
 R"doc(Evaluate the diffuse reflectance
 
@@ -878,18 +1100,40 @@ Parameter ``sample2``:
     A uniformly distributed sample on :math:`[0,1]^2`. It is used to
     generate the sampled direction.)doc";
 
+static const char *__doc_mitsuba_BSDF_eval_subsurface =
+R"doc(Evaluate the subsurface scattering parameters
+
+BSDFs with the BSDFFlags::Subsurface flag describe the boundary of a
+translucent material. Light that is transmitted by their
+BSDFFlags::DeltaTransmission lobe does not continue into the interior,
+instead the path tracers sample the position where it leaves the
+surface again from a diffusion profile (see the ``path`` integrator).
+This function returns the albedo (the total diffuse reflectance due to
+subsurface scattering) and the mean free path of the interior at the
+entry point.
+
+The default implementation returns zero for both.)doc";
+
 static const char *__doc_mitsuba_BSDF_flags = R"doc(Flags for all components combined.)doc";
 
 static const char *__doc_mitsuba_BSDF_flags_2 = R"doc(Flags for a specific component of this BSDF.)doc";
 
+static const char *__doc_mitsuba_BSDF_has_alpha_test = R"doc(Does alpha_test() reject some intersections with this BSDF?)doc";
+
 static const char *__doc_mitsuba_BSDF_id = R"doc(Return a string identifier)doc";
 
+static const char *__doc_mitsuba_BSDF_m_alpha_test = R"doc(Is alpha_test() evaluated during the traversal?)doc";
+
 static const char *__doc_mitsuba_BSDF_m_components = R"doc(Flags for each component of this BSDF.)doc";
 
+static const char *__doc_mitsuba_BSDF_m_eval_counter = R"doc()doc";
+
 static const char *__doc_mitsuba_BSDF_m_flags = R"doc(Combined flags for all components of this BSDF.)doc";
 
 static const char *__doc_mitsuba_BSDF_m_id = R"doc(Identifier (if available))doc";
 
+static const char *__doc_mitsuba_BSDF_m_sample_counter = R"doc()doc";
+
 static const char *__doc_mitsuba_BSDF_needs_differentials = R"doc(Does the implementation require access to texture-space differentials?)doc";
 
 static const char *__doc_mitsuba_BSDF_operator_delete = R"doc()doc";
@@ -926,6 +1170,18 @@ Parameter ``si``:
 Parameter ``wo``:
     The outgoing direction)doc";
 
+static const char *__doc_mitsuba_BSDF_ray_flags =
+R"doc(Return the fields of the surface interaction (as a combination of
+RayFlags) that this BSDF reads in addition to the position, normals
+and shading frame
+
+The textures of the BSDF report their needs separately, and the scene
+gathers both once for all of its shapes (see Scene::ray_flags()). The
+default implementation requests the position partials of anisotropic
+BSDFs, whose lobes are aligned with the tangent of the shading frame,
+and the UV coordinates and their partials of BSDFs that need texture
+differentials.)doc";
+
 static const char *__doc_mitsuba_BSDF_sample =
 R"doc(Importance sample the BSDF model
 
@@ -971,6 +1227,8 @@ value: The BSDF value divided by the probability (multiplied by the
 cosine foreshortening factor when a non-delta component is sampled). A
 zero spectrum indicates that sampling failed.)doc";
 
+static const char *__doc_mitsuba_BSDF_sample_counter = R"doc(Counts the calls of sample(), see eval_counter())doc";
+
 static const char *__doc_mitsuba_BSDF_set_id = R"doc(Set a string identifier)doc";
 
 static const char *__doc_mitsuba_BSDF_to_string = R"doc(Return a human-readable representation of the BSDF)doc";
@@ -1044,6 +1302,26 @@ static const char *__doc_mitsuba_Bitmap_Bitmap_4 = R"doc(Copy constructor (copie
 
 static const char *__doc_mitsuba_Bitmap_Bitmap_5 = R"doc(Move constructor)doc";
 
+static const char *__doc_mitsuba_Bitmap_EXRCompression = R"doc(Compression codecs that can be used when writing OpenEXR files)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_Auto = R"doc(PIZ, or DWAB when a quality level is specified (default))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_DWAA = R"doc(Lossy compression of blocks of 32 scanlines using a DCT (fast))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_DWAB = R"doc(Lossy compression of blocks of 256 scanlines using a DCT)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_None = R"doc(No compression)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_PIZ = R"doc(Wavelet compression (lossless, good ratio on noisy images))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_PXR24 = R"doc(Lossy conversion of 32 bit floats to 24 bits followed by zlib)doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_RLE = R"doc(Run-length encoding (lossless, fast))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_ZIP = R"doc(Zlib compression of blocks of 16 scanlines (lossless))doc";
+
+static const char *__doc_mitsuba_Bitmap_EXRCompression_ZIPS = R"doc(Zlib compression of individual scanlines (lossless, fast))doc";
+
 static const char *__doc_mitsuba_Bitmap_FileFormat = R"doc(Supported image file formats)doc";
 
 static const char *__doc_mitsuba_Bitmap_FileFormat_Auto =
@@ -1262,6 +1540,8 @@ static const char *__doc_mitsuba_Bitmap_m_component_format = R"doc()doc";
 
 static const char *__doc_mitsuba_Bitmap_m_data = R"doc()doc";
 
+static const char *__doc_mitsuba_Bitmap_m_data_owner = R"doc()doc";
+
 static const char *__doc_mitsuba_Bitmap_m_metadata = R"doc()doc";
 
 static const char *__doc_mitsuba_Bitmap_m_owns_data = R"doc()doc";
@@ -1276,6 +1556,17 @@ static const char *__doc_mitsuba_Bitmap_m_srgb_gamma = R"doc()doc";
 
 static const char *__doc_mitsuba_Bitmap_m_struct = R"doc()doc";
 
+static const char *__doc_mitsuba_Bitmap_map_raw =
+R"doc(Create a bitmap that references the pixels of a file written by
+write_raw() without copying them
+
+The bitmap keeps the mapping alive. When the mapping is read-only
+(e.g. when it is shared with other processes), the pixels must not be
+modified.)doc";
+
+static const char *__doc_mitsuba_Bitmap_memory_footprint =
+R"doc(Return the size of the pixel buffer if it is owned by the bitmap)doc";
+
 static const char *__doc_mitsuba_Bitmap_metadata = R"doc(Return a Properties object containing the image metadata)doc";
 
 static const char *__doc_mitsuba_Bitmap_metadata_2 =
@@ -1286,6 +1577,9 @@ static const char *__doc_mitsuba_Bitmap_operator_eq = R"doc(Equality comparison
 
 static const char *__doc_mitsuba_Bitmap_operator_ne = R"doc(Inequality comparison operator)doc";
 
+static const char *__doc_mitsuba_Bitmap_owns_data =
+R"doc(Does the bitmap own its storage (vs. wrapping an external pointer)?)doc";
+
 static const char *__doc_mitsuba_Bitmap_pixel_count = R"doc(Return the total number of pixels)doc";
 
 static const char *__doc_mitsuba_Bitmap_pixel_format = R"doc(Return the pixel format of this bitmap)doc";
@@ -1373,6 +1667,12 @@ Parameter ``clamp``:
     Filtered image pixels will be clamped to the following range.
     Default: -infinity..infinity (i.e. no clamping is used))doc";
 
+static const char *__doc_mitsuba_Bitmap_set_data_owner =
+R"doc(Keep the owner of the external storage alive
+
+When the bitmap wraps memory that it does not own (e.g. a NumPy
+array), this reference is released along with the bitmap.)doc";
+
 static const char *__doc_mitsuba_Bitmap_set_metadata = R"doc(Set the a Properties object containing the image metadata)doc";
 
 static const char *__doc_mitsuba_Bitmap_set_premultiplied_alpha = R"doc(Specify whether the bitmap uses premultiplied alpha)doc";
@@ -1435,7 +1735,13 @@ default argument (-1) uses the highest quality (100).
 with higher values corresponding to a lower quality. A value of 45 is
 recommended as the default for lossy compression. The default argument
 (-1) causes the implementation to switch to the lossless PIZ
-compressor.)doc";
+compressor.
+
+Parameter ``compression``:
+    Compression codec used for OpenEXR images (ignored otherwise). The
+    DWAA/DWAB compressors use ``quality`` as their compression level if
+    it is positive. OpenEXR files are encoded in parallel using the
+    thread count specified via Thread::set_thread_count().)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_2 =
 R"doc(Write an encoded form of the bitmap to a file using the specified file
@@ -1463,11 +1769,20 @@ default argument (-1) uses the highest quality (100).
 with higher values corresponding to a lower quality. A value of 45 is
 recommended as the default for lossy compression. The default argument
 (-1) causes the implementation to switch to the lossless PIZ
-compressor.)doc";
+compressor.
+
+Parameter ``compression``:
+    Compression codec used for OpenEXR images (ignored otherwise). The
+    DWAA/DWAB compressors use ``quality`` as their compression level if
+    it is positive. OpenEXR files are encoded in parallel using the
+    thread count specified via Thread::set_thread_count().)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_async =
 R"doc(Equivalent to write(), but executes asynchronously on a different
-thread)doc";
+thread
+
+The bitmap must not be modified until the write has finished. Pending
+writes are completed by Thread::wait_for_tasks() and at shutdown.)doc";
 
 static const char *__doc_mitsuba_Bitmap_write_exr = R"doc(Write a file using the OpenEXR file format)doc";
 
@@ -1479,8 +1794,24 @@ static const char *__doc_mitsuba_Bitmap_write_png = R"doc(Save a file using the
 
 static const char *__doc_mitsuba_Bitmap_write_ppm = R"doc(Save a file using the PPM file format)doc";
 
+static const char *__doc_mitsuba_Bitmap_write_raw =
+R"doc(Write the pixels of the bitmap in an uncompressed layout that can
+later be mapped into memory (see map_raw())
+
+Metadata other than the gamma and alpha flags is not stored.)doc";
+
 static const char *__doc_mitsuba_Bitmap_write_rgbe = R"doc(Save a file using the RGBE file format)doc";
 
+static const char *__doc_mitsuba_BlockOrder =
+R"doc(Traversal order of the blocks generated by a Spiral instance)doc";
+
+static const char *__doc_mitsuba_BlockOrder_Hilbert = R"doc(Hilbert curve starting at the top left corner of the image)doc";
+
+static const char *__doc_mitsuba_BlockOrder_Morton =
+R"doc(Morton (Z-order) curve starting at the top left corner of the image)doc";
+
+static const char *__doc_mitsuba_BlockOrder_Spiral = R"doc(Spiral outward from the center of the image)doc";
+
 static const char *__doc_mitsuba_BoundingBox =
 R"doc(Generic n-dimensional bounding box data structure
 
@@ -1829,6 +2160,11 @@ intervals (const version))doc";
 
 static const char *__doc_mitsuba_ContinuousDistribution_compute_cdf = R"doc()doc";
 
+static const char *__doc_mitsuba_ContinuousDistribution_compute_guide =
+R"doc(Build the guide table. The cell of every CDF entry is computed with
+the same floating point arithmetic as in find_interval(), hence the
+bracketing is exact despite rounding.)doc";
+
 static const char *__doc_mitsuba_ContinuousDistribution_empty = R"doc(Is the distribution object empty/uninitialized?)doc";
 
 static const char *__doc_mitsuba_ContinuousDistribution_eval_cdf =
@@ -1847,12 +2183,32 @@ static const char *__doc_mitsuba_ContinuousDistribution_eval_pdf_normalized =
 R"doc(Evaluate the normalized probability mass function (PDF) at position
 ``x``)doc";
 
+static const char *__doc_mitsuba_ContinuousDistribution_find_interval =
+R"doc(Find the interval containing the unnormalized CDF value ``value``
+
+The guide table brackets the interval, which leaves a binary search
+over a handful of entries instead of the entire CDF. For reasonably
+smooth densities this takes a constant number of steps.)doc";
+
+static const char *__doc_mitsuba_ContinuousDistribution_guide =
+R"doc(Return the guide table used to accelerate sampling
+
+Entry ``j`` is the first interval that can contain a sample whose
+(unnormalized) CDF value falls into the ``j``-th of size() - 1 uniform
+cells of the sample domain.)doc";
+
 static const char *__doc_mitsuba_ContinuousDistribution_integral = R"doc(Return the original integral of PDF entries before normalization)doc";
 
 static const char *__doc_mitsuba_ContinuousDistribution_interval_resolution = R"doc(Return the minimum resolution of the discretization)doc";
 
 static const char *__doc_mitsuba_ContinuousDistribution_m_cdf = R"doc()doc";
 
+static const char *__doc_mitsuba_ContinuousDistribution_m_guide = R"doc()doc";
+
+static const char *__doc_mitsuba_ContinuousDistribution_m_guide_scale = R"doc()doc";
+
+static const char *__doc_mitsuba_ContinuousDistribution_m_guide_steps = R"doc()doc";
+
 static const char *__doc_mitsuba_ContinuousDistribution_m_integral = R"doc()doc";
 
 static const char *__doc_mitsuba_ContinuousDistribution_m_interval_size = R"doc()doc";
@@ -2039,7 +2395,16 @@ and provides various routines for transforming uniformly distributed
 samples so that they follow the stored distribution. Note that
 unnormalized probability mass functions (PMFs) will automatically be
 normalized during initialization. The associated scale factor can be
-retrieved using the function normalization().)doc";
+retrieved using the function normalization().
+
+By default, samples are generated by a binary search over the
+cumulative distribution function, which costs :math:`\log_2 N`
+dependent memory lookups per sample. The ``alias_table`` parameter of
+the constructors additionally builds an alias table (Walker's alias
+method, using Vose's construction) that generates samples in constant
+time with two independent lookups. The alias table maps the samples
+differently to the entries, hence the ``sample*()`` functions no
+longer preserve the stratification of their inputs.)doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution2D =
 R"doc(======================================================================
@@ -2122,6 +2487,9 @@ static const char *__doc_mitsuba_DiscreteDistribution2D_m_normalization = R"doc(
 
 static const char *__doc_mitsuba_DiscreteDistribution2D_m_size = R"doc(Resolution of the discretized density function)doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution2D_nbytes =
+R"doc(Return the memory footprint of the density and CDFs in bytes)doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution2D_pdf = R"doc(Evaluate the normalized function value at the given integer position)doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution2D_sample =
@@ -2142,12 +2510,23 @@ static const char *__doc_mitsuba_DiscreteDistribution_DiscreteDistribution_3 = R
 
 static const char *__doc_mitsuba_DiscreteDistribution_DiscreteDistribution_4 = R"doc(Initialize from a given floating point array)doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution_alias_index =
+R"doc(Return the aliases of the alias table, i.e. the entry sampled by the
+remainder of every column (empty unless has_alias_table()))doc";
+
+static const char *__doc_mitsuba_DiscreteDistribution_alias_probability =
+R"doc(Return the probabilities of the alias table, i.e. the fraction of
+every column of the table that samples its own entry (empty unless
+has_alias_table()))doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution_cdf = R"doc(Return the unnormalized cumulative distribution function)doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_cdf_2 =
 R"doc(Return the unnormalized cumulative distribution function (const
 version))doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution_compute_alias_table = R"doc(Build the alias table using Vose's algorithm)doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution_compute_cdf = R"doc()doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_empty = R"doc(Is the distribution object empty/uninitialized?)doc";
@@ -2168,6 +2547,18 @@ static const char *__doc_mitsuba_DiscreteDistribution_eval_pmf_normalized =
 R"doc(Evaluate the normalized probability mass function (PMF) at index
 ``index``)doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution_has_alias_table = R"doc(Are samples generated using an alias table?)doc";
+
+static const char *__doc_mitsuba_DiscreteDistribution_m_alias_index = R"doc()doc";
+
+static const char *__doc_mitsuba_DiscreteDistribution_m_alias_last = R"doc()doc";
+
+static const char *__doc_mitsuba_DiscreteDistribution_m_alias_prob = R"doc()doc";
+
+static const char *__doc_mitsuba_DiscreteDistribution_m_alias_size = R"doc()doc";
+
+static const char *__doc_mitsuba_DiscreteDistribution_m_alias_table = R"doc()doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution_m_cdf = R"doc()doc";
 
 static const char *__doc_mitsuba_DiscreteDistribution_m_normalization = R"doc()doc";
@@ -2193,6 +2584,11 @@ Parameter ``value``:
 Returns:
     The discrete index associated with the sample)doc";
 
+static const char *__doc_mitsuba_DiscreteDistribution_sample_alias =
+R"doc(Sample the alias table: the sample selects a column and then either
+its entry or its alias. Returns the index and the re-scaled sample
+value.)doc";
+
 static const char *__doc_mitsuba_DiscreteDistribution_sample_pmf =
 R"doc(%Transform a uniformly distributed sample to the stored distribution
 
@@ -2313,6 +2709,9 @@ static const char *__doc_mitsuba_EOFException_m_gcount = R"doc()doc";
 
 static const char *__doc_mitsuba_Emitter = R"doc()doc";
 
+static const char *__doc_mitsuba_EmitterFlags_Volume =
+R"doc(The emitter samples the emission of a medium (e.g. volume emitters))doc";
+
 static const char *__doc_mitsuba_Emitter_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Emitter_3 = R"doc()doc";
@@ -2345,14 +2744,36 @@ static const char *__doc_mitsuba_Emitter_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Emitter_dirty = R"doc(Return whether the emitter parameters have changed)doc";
 
+static const char *__doc_mitsuba_Emitter_emission_cone =
+R"doc(Return a cone that bounds the directions into which this emitter
+emits light
+
+Returns the axis of the cone and the cosine of its half-angle. The
+LightGrid uses it to skip the regions of the scene that a spot light
+does not illuminate. The default implementation returns a cosine of
+-1, i.e. light is emitted into all directions.)doc";
+
 static const char *__doc_mitsuba_Emitter_flags = R"doc(Flags for all components combined.)doc";
 
+static const char *__doc_mitsuba_Emitter_flux = R"doc(Return the flux estimate cached by the last call to update_flux())doc";
+
+static const char *__doc_mitsuba_Emitter_flux_estimate =
+R"doc(Return a rough estimate of the total power emitted by this emitter
+(e.g. area times radiance for area emitters)
+
+The scene uses this estimate to choose emitters proportional to their
+power when its ``emitter_sampling`` parameter is set to ``"power"`` or
+``"light_tree"``. The estimate of emitters that surround the scene
+depends on its bounding sphere. The default implementation returns 1.)doc";
+
 static const char *__doc_mitsuba_Emitter_is_environment = R"doc(Is this an environment map light emitter?)doc";
 
 static const char *__doc_mitsuba_Emitter_m_dirty = R"doc(True if the emitters's parameters have changed)doc";
 
 static const char *__doc_mitsuba_Emitter_m_flags = R"doc(Combined flags for all properties of this emitter.)doc";
 
+static const char *__doc_mitsuba_Emitter_m_flux = R"doc(Cached flux estimate)doc";
+
 static const char *__doc_mitsuba_Emitter_m_sampling_weight = R"doc(Sampling weight)doc";
 
 static const char *__doc_mitsuba_Emitter_operator_delete = R"doc()doc";
@@ -2371,6 +2792,8 @@ static const char *__doc_mitsuba_Emitter_set_dirty = R"doc(Modify the emitter's
 
 static const char *__doc_mitsuba_Emitter_traverse = R"doc()doc";
 
+static const char *__doc_mitsuba_Emitter_update_flux = R"doc(Re-evaluate flux_estimate() and cache its value)doc";
+
 static const char *__doc_mitsuba_Endpoint =
 R"doc(Abstract interface subsuming emitters and sensors in Mitsuba.
 
@@ -2698,12 +3121,26 @@ R"doc(Simple class for resolving paths on Linux/Windows/Mac OS
 
 This convenience class looks for a file or directory given its name
 and a set of search paths. The implementation walks through the search
-paths in order and stops once the file is found.)doc";
+paths in order and stops once the file is found.
+
+To avoid issuing a file system query per search path and lookup (which
+is costly on network file systems), the resolver caches the listing of
+every directory it looks into. Hence, files created after a directory
+was first searched may not be found until the cache is cleared, which
+happens whenever the list of search paths is modified or upon
+clear_cache(). Copies of a resolver start with an empty cache.)doc";
 
 static const char *__doc_mitsuba_FileResolver_FileResolver = R"doc(Initialize a new file resolver with the current working directory)doc";
 
 static const char *__doc_mitsuba_FileResolver_FileResolver_2 = R"doc(Copy constructor)doc";
 
+static const char *__doc_mitsuba_FileResolver_Listing = R"doc(Cached entry names of a directory)doc";
+
+static const char *__doc_mitsuba_FileResolver_Listing_names = R"doc()doc";
+
+static const char *__doc_mitsuba_FileResolver_Listing_valid =
+R"doc(Could the directory be listed? Otherwise, its files are queried)doc";
+
 static const char *__doc_mitsuba_FileResolver_append = R"doc(Append an entry to the end of the list of search paths)doc";
 
 static const char *__doc_mitsuba_FileResolver_begin = R"doc(Return an iterator at the beginning of the list of search paths)doc";
@@ -2712,10 +3149,14 @@ static const char *__doc_mitsuba_FileResolver_begin_2 =
 R"doc(Return an iterator at the beginning of the list of search paths
 (const))doc";
 
+static const char *__doc_mitsuba_FileResolver_cache_size = R"doc(Return the number of directories whose listing is cached)doc";
+
 static const char *__doc_mitsuba_FileResolver_class = R"doc()doc";
 
 static const char *__doc_mitsuba_FileResolver_clear = R"doc(Clear the list of search paths)doc";
 
+static const char *__doc_mitsuba_FileResolver_clear_cache = R"doc(Discard the cached directory listings)doc";
+
 static const char *__doc_mitsuba_FileResolver_contains = R"doc(Check if a given path is included in the search path list)doc";
 
 static const char *__doc_mitsuba_FileResolver_end = R"doc(Return an iterator at the end of the list of search paths)doc";
@@ -2726,6 +3167,13 @@ static const char *__doc_mitsuba_FileResolver_erase = R"doc(Erase the entry at t
 
 static const char *__doc_mitsuba_FileResolver_erase_2 = R"doc(Erase the search path from the list)doc";
 
+static const char *__doc_mitsuba_FileResolver_exists_cached =
+R"doc(Check whether ``path`` exists using the cached directory listings)doc";
+
+static const char *__doc_mitsuba_FileResolver_m_cache = R"doc()doc";
+
+static const char *__doc_mitsuba_FileResolver_m_cache_mutex = R"doc()doc";
+
 static const char *__doc_mitsuba_FileResolver_m_paths = R"doc()doc";
 
 static const char *__doc_mitsuba_FileResolver_operator_array = R"doc(Return an entry from the list of search paths)doc";
@@ -2782,12 +3230,19 @@ static const char *__doc_mitsuba_FileStream_flush = R"doc(Flushes any buffered o
 
 static const char *__doc_mitsuba_FileStream_is_closed = R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
 
+static const char *__doc_mitsuba_FileStream_m_bytes_read =
+R"doc(Statistics for the TraceRecorder (start time is negative if inactive))doc";
+
+static const char *__doc_mitsuba_FileStream_m_bytes_written = R"doc()doc";
+
 static const char *__doc_mitsuba_FileStream_m_file = R"doc()doc";
 
 static const char *__doc_mitsuba_FileStream_m_mode = R"doc()doc";
 
 static const char *__doc_mitsuba_FileStream_m_path = R"doc()doc";
 
+static const char *__doc_mitsuba_FileStream_m_trace_start = R"doc()doc";
+
 static const char *__doc_mitsuba_FileStream_native = R"doc(Return the "native" std::fstream associated with this FileStream)doc";
 
 static const char *__doc_mitsuba_FileStream_path = R"doc(Return the path descriptor associated with this FileStream)doc";
@@ -2829,6 +3284,9 @@ To avoid lock-related bottlenecks when rendering with many cores,
 rendering threads first store results in an "image block", which is
 then committed to the film using the put() method.)doc";
 
+static const char *__doc_mitsuba_FilmFlags_Variance =
+R"doc(The film accumulates per-pixel variance estimates, see Film::variance())doc";
+
 static const char *__doc_mitsuba_Film_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Film_3 = R"doc()doc";
@@ -2854,6 +3312,12 @@ static const char *__doc_mitsuba_Film_Film = R"doc(Create a film)doc";
 
 static const char *__doc_mitsuba_Film_bitmap = R"doc(Return a bitmap object storing the developed contents of the film)doc";
 
+static const char *__doc_mitsuba_Film_channel_count =
+R"doc(Return the number of channels that prepare() configures for the given
+AOVs (without allocating any storage)
+
+The default implementation assumes RGB, alpha, and weight channels.)doc";
+
 static const char *__doc_mitsuba_Film_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Film_clear = R"doc(Clear the film contents to zero.)doc";
@@ -2899,6 +3363,12 @@ static const char *__doc_mitsuba_Film_m_size = R"doc()doc";
 
 static const char *__doc_mitsuba_Film_m_srf = R"doc()doc";
 
+static const char *__doc_mitsuba_Film_output_path =
+R"doc(Return the name of the file that write() creates for the given path
+
+Films that only support certain file formats replace the extension of
+the path. The default implementation returns the path unchanged.)doc";
+
 static const char *__doc_mitsuba_Film_parameters_changed = R"doc()doc";
 
 static const char *__doc_mitsuba_Film_prepare =
@@ -2983,10 +3453,21 @@ static const char *__doc_mitsuba_Film_size =
 R"doc(Ignoring the crop window, return the resolution of the underlying
 sensor)doc";
 
+static const char *__doc_mitsuba_Film_storage_footprint =
+R"doc(Return the memory footprint of the storage that prepare() allocates
+for the given AOVs in bytes)doc";
+
 static const char *__doc_mitsuba_Film_to_string = R"doc(//! @})doc";
 
 static const char *__doc_mitsuba_Film_traverse = R"doc()doc";
 
+static const char *__doc_mitsuba_Film_variance =
+R"doc(Return the estimated variance of the luminance of every pixel
+
+The result is a tensor of shape <tt>(height, width, 1)</tt>. Only
+films with the FilmFlags::Variance flag implement this method, e.g. to
+let integrators distribute samples based on the current error.)doc";
+
 static const char *__doc_mitsuba_Film_write = R"doc(Write the developed contents of the film to a file on disk)doc";
 
 static const char *__doc_mitsuba_FilterBoundaryCondition =
@@ -3157,6 +3638,88 @@ textures from mitsuba::Bitmap instances.)doc";
 
 static const char *__doc_mitsuba_GPUTexture_GPUTexture = R"doc()doc";
 
+static const char *__doc_mitsuba_GuidingField =
+R"doc(Spatio-directional distribution of incident radiance that is learned
+online to guide the directions sampled by path tracers
+
+This class implements the SD-tree of "Practical Path Guiding for
+Efficient Light-Transport Simulation" by Müller et al. A binary tree
+subdivides the bounding box of the scene (alternating between the x, y
+and z axes), and every leaf stores a quadtree over the square of
+cylindrical coordinates ``((cos(theta) + 1) / 2, phi / (2 pi))``,
+which maps uniform samples to uniform directions. The quadtrees are
+refined adaptively, so that every node holds at most a fraction of the
+radiance recorded at the leaf.
+
+The field is trained in iterations. During an iteration, directions
+are sampled from the distribution learned so far while record()
+gathers new radiance estimates. refine() then makes these estimates
+the new sampling distribution, splits spatial leaves that received
+many records, and adapts the quadtrees. Recording only updates atomic
+counters of a tree whose structure doesn't change during the
+iteration, hence sample(), pdf() and record() are lock-free and may be
+called from any number of worker threads. refine() must not run
+concurrently with them.
+
+The learned field can be written to a stream and loaded again, e.g. to
+reuse it for the following frames of an animation.)doc";
+
+static const char *__doc_mitsuba_GuidingField_GuidingField =
+R"doc(Create an untrained field
+
+Parameter ``bbox``:
+    Region of space covered by the field, points outside are clamped
+
+Parameter ``spatial_threshold``:
+    Number of records that a spatial leaf receives in the first
+    iteration before it is split. The threshold grows with the square
+    root of the number of samples per pixel, which doubles in every
+    training iteration.
+
+Parameter ``directional_threshold``:
+    Fraction of the radiance of a leaf above which a quadtree node is
+    subdivided
+
+Parameter ``max_depth``:
+    Maximum depth of the quadtrees)doc";
+
+static const char *__doc_mitsuba_GuidingField_GuidingField_2 = R"doc(Load a field that was previously written with write())doc";
+
+static const char *__doc_mitsuba_GuidingField_bbox = R"doc(Return the region of space covered by the field)doc";
+
+static const char *__doc_mitsuba_GuidingField_iteration = R"doc(Return the number of completed training iterations)doc";
+
+static const char *__doc_mitsuba_GuidingField_leaf_count = R"doc(Return the number of spatial leaves)doc";
+
+static const char *__doc_mitsuba_GuidingField_nbytes = R"doc(Return the memory footprint of the field in bytes)doc";
+
+static const char *__doc_mitsuba_GuidingField_node_count = R"doc(Return the total number of quadtree nodes used for sampling)doc";
+
+static const char *__doc_mitsuba_GuidingField_pdf = R"doc(Evaluate the density per unit solid angle of sample())doc";
+
+static const char *__doc_mitsuba_GuidingField_record =
+R"doc(Record an estimate of the radiance arriving at ``p`` from direction
+``d``
+
+The estimate should be divided by the density of sampling ``d``.
+Invalid and negative values are ignored.)doc";
+
+static const char *__doc_mitsuba_GuidingField_refine = R"doc(Finish the current training iteration (see the class description))doc";
+
+static const char *__doc_mitsuba_GuidingField_sample =
+R"doc(Sample a direction from the distribution learned at ``p``
+
+Returns:
+    The sampled direction and its density per unit solid angle.
+    Directions are distributed uniformly over the sphere if nothing
+    was learned at ``p`` yet.)doc";
+
+static const char *__doc_mitsuba_GuidingField_to_string = R"doc()doc";
+
+static const char *__doc_mitsuba_GuidingField_trained = R"doc(Has the field completed at least one training iteration?)doc";
+
+static const char *__doc_mitsuba_GuidingField_write = R"doc(Write the field to a stream)doc";
+
 static const char *__doc_mitsuba_Hierarchical2D =
 R"doc(Implements a hierarchical sample warping scheme for 2D distributions
 with linear interpolation and an optional dependence on additional
@@ -3230,10 +3793,20 @@ static const char *__doc_mitsuba_Hierarchical2D_Level_lookup = R"doc()doc";
 
 static const char *__doc_mitsuba_Hierarchical2D_Level_ready = R"doc()doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_Level_reset =
+R"doc(Prepare the level for new values (zero-initialized host storage))doc";
+
 static const char *__doc_mitsuba_Hierarchical2D_Level_size = R"doc()doc";
 
 static const char *__doc_mitsuba_Hierarchical2D_Level_width = R"doc()doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_build =
+R"doc(Fill the allocated levels with the given data
+
+Rows are processed in parallel for large inputs. The normalization
+constant is accumulated per row and then summed up in a fixed order,
+hence the result does not depend on the number of threads.)doc";
+
 static const char *__doc_mitsuba_Hierarchical2D_eval =
 R"doc(Evaluate the density at position ``pos``. The distribution is
 parameterized by ``param`` if applicable.)doc";
@@ -3244,6 +3817,8 @@ static const char *__doc_mitsuba_Hierarchical2D_m_levels = R"doc(MIP hierarchy o
 
 static const char *__doc_mitsuba_Hierarchical2D_m_max_patch_index = R"doc(Number of bilinear patches in the X/Y dimension - 1)doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_resolution = R"doc(Return the resolution of the data passed to the constructor)doc";
+
 static const char *__doc_mitsuba_Hierarchical2D_sample =
 R"doc(Given a uniformly distributed 2D sample, draw a sample from the
 distribution (parameterized by ``param`` if applicable)
@@ -3252,6 +3827,15 @@ Returns the warped sample and associated probability density.)doc";
 
 static const char *__doc_mitsuba_Hierarchical2D_to_string = R"doc()doc";
 
+static const char *__doc_mitsuba_Hierarchical2D_update =
+R"doc(Replace the values of the distribution, while keeping its resolution
+and level structure
+
+This is cheaper than constructing a new instance, e.g. when the values
+change during every iteration of an optimization. ``data`` must have
+the resolution returned by resolution() and the same number of slices
+as the data passed to the constructor.)doc";
+
 static const char *__doc_mitsuba_IOREntry = R"doc()doc";
 
 static const char *__doc_mitsuba_IOREntry_name = R"doc()doc";
@@ -3402,6 +3986,10 @@ static const char *__doc_mitsuba_ImageBlock_coalesce = R"doc(Try to coalesce rea
 
 static const char *__doc_mitsuba_ImageBlock_compensate = R"doc(Use Kahan-style error-compensated floating point accumulation?)doc";
 
+static const char *__doc_mitsuba_ImageBlock_deferred = R"doc(Defer calls to put() and accumulate them in batches?)doc";
+
+static const char *__doc_mitsuba_ImageBlock_flush_deferred = R"doc(Accumulate all samples recorded by deferred calls to put())doc";
+
 static const char *__doc_mitsuba_ImageBlock_has_border = R"doc(Does the image block have a border region?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_height = R"doc(Return the bitmap's height in pixels)doc";
@@ -3414,6 +4002,12 @@ static const char *__doc_mitsuba_ImageBlock_m_coalesce = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_compensate = R"doc()doc";
 
+static const char *__doc_mitsuba_ImageBlock_m_deferred = R"doc()doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_deferred_pos = R"doc()doc";
+
+static const char *__doc_mitsuba_ImageBlock_m_deferred_values = R"doc()doc";
+
 static const char *__doc_mitsuba_ImageBlock_m_normalize = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_offset = R"doc()doc";
@@ -3430,6 +4024,9 @@ static const char *__doc_mitsuba_ImageBlock_m_warn_invalid = R"doc()doc";
 
 static const char *__doc_mitsuba_ImageBlock_m_warn_negative = R"doc()doc";
 
+static const char *__doc_mitsuba_ImageBlock_memory_footprint =
+R"doc(Return the size of the image tensor (and the compensation terms))doc";
+
 static const char *__doc_mitsuba_ImageBlock_normalize = R"doc(Re-normalize filter weights in put() and read())doc";
 
 static const char *__doc_mitsuba_ImageBlock_offset = R"doc(Return the current block offset)doc";
@@ -3486,10 +4083,27 @@ Parameter ``values``:
 
 static const char *__doc_mitsuba_ImageBlock_rfilter = R"doc(Return the image reconstruction filter underlying the ImageBlock)doc";
 
+static const char *__doc_mitsuba_ImageBlock_second_moment =
+R"doc(Accumulate the second moment of the sample luminance in the last
+channel?)doc";
+
 static const char *__doc_mitsuba_ImageBlock_set_coalesce = R"doc(Try to coalesce reads/writes in JIT modes?)doc";
 
 static const char *__doc_mitsuba_ImageBlock_set_compensate = R"doc(Use Kahan-style error-compensated floating point accumulation?)doc";
 
+static const char *__doc_mitsuba_ImageBlock_set_deferred =
+R"doc(Defer calls to put() and accumulate them in batches
+
+When enabled, put() merely records the sample position and channel
+values. Once enough samples have been recorded, or when the block
+contents are accessed, the recorded samples are sorted by image tile
+and accumulated in a single pass with coherent memory accesses. This
+is useful for methods like particle tracing that splat samples to
+random image positions.
+
+Only scalar variants defer samples. In JIT variants, this setting has
+no effect. Disabled by default.)doc";
+
 static const char *__doc_mitsuba_ImageBlock_set_normalize = R"doc(Re-normalize filter weights in put() and read())doc";
 
 static const char *__doc_mitsuba_ImageBlock_set_offset =
@@ -3499,6 +4113,15 @@ This corresponds to the offset from the top-left corner of a larger
 image (e.g. a Film) to the top-left corner of this ImageBlock
 instance.)doc";
 
+static const char *__doc_mitsuba_ImageBlock_set_second_moment =
+R"doc(Accumulate the second moment of the sample luminance
+
+When enabled, put() ignores the value that is provided for the last
+channel and instead accumulates the squared luminance of the first
+three (RGB) channels of each sample. Together with the color and
+weight channels, this provides a per-pixel variance estimate. Disabled
+by default.)doc";
+
 static const char *__doc_mitsuba_ImageBlock_set_size = R"doc(Set the block size. This potentially destroys the block's content.)doc";
 
 static const char *__doc_mitsuba_ImageBlock_set_warn_invalid = R"doc(Warn when writing invalid (NaN, +/- infinity) sample values?)doc";
@@ -3546,6 +4169,11 @@ static const char *__doc_mitsuba_Integrator_5 = R"doc()doc";
 
 static const char *__doc_mitsuba_Integrator_Integrator = R"doc(Create an integrator)doc";
 
+static const char *__doc_mitsuba_Integrator_PassCallback =
+R"doc(Callback that is invoked after every rendering pass with the number of
+completed passes and the total number of passes. Rendering is
+cancelled when it returns ``False``.)doc";
+
 static const char *__doc_mitsuba_Integrator_aov_names =
 R"doc(For integrators that return one or more arbitrary output variables
 (AOVs), this function specifies a list of associated channel names.
@@ -3557,6 +4185,10 @@ static const char *__doc_mitsuba_Integrator_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Integrator_m_hide_emitters = R"doc(Flag for disabling direct visibility of emitters)doc";
 
+static const char *__doc_mitsuba_Integrator_m_pass_callback = R"doc(Callback invoked after every rendering pass (may be empty))doc";
+
+static const char *__doc_mitsuba_Integrator_m_pass_sample_count = R"doc(Samples per pixel of every pass of the current render job)doc";
+
 static const char *__doc_mitsuba_Integrator_m_render_timer = R"doc(Timer used to enforce the timeout.)doc";
 
 static const char *__doc_mitsuba_Integrator_m_stop = R"doc(Integrators should stop all work when this flag is set to true.)doc";
@@ -3566,6 +4198,16 @@ R"doc(Maximum amount of time to spend rendering (excluding scene parsing).
 
 Specified in seconds. A negative values indicates no timeout.)doc";
 
+static const char *__doc_mitsuba_Integrator_pass_callback = R"doc(Return the callback invoked after every rendering pass)doc";
+
+static const char *__doc_mitsuba_Integrator_pass_sample_count =
+R"doc(Return the number of samples per pixel rendered by every pass of the
+current (or last) render job
+
+This accounts for passes that were split further to fit into the
+device memory, such that the pass callback can determine how many
+samples the film holds.)doc";
+
 static const char *__doc_mitsuba_Integrator_render =
 R"doc(Render the scene
 
@@ -3606,6 +4248,44 @@ This function is just a thin wrapper around the previous render()
 overload. It accepts a sensor *index* instead and renders the scene
 using sensor 0 by default.)doc";
 
+static const char *__doc_mitsuba_Integrator_render_memory_footprint =
+R"doc(Estimate the memory in bytes that render() allocates to render the
+given sensor, in addition to the scene itself
+
+This can be used to decide whether a render job fits into the memory
+of a machine before it is started (see Scene::predicted_peak_memory()).
+The default implementation accounts for the film storage and the
+developed image.
+
+Parameter ``spp``:
+    Optional parameter to override the number of samples per pixel of
+    the sensor's sampler (as in render()).)doc";
+
+static const char *__doc_mitsuba_Integrator_render_sensors =
+R"doc(Render the scene from the viewpoints of several sensors
+
+This function is equivalent to calling render() for every element of
+``sensors`` and returns one tensor per sensor (empty tensors when
+``develop=false``). Integrators may process all sensors in the same
+rendering job, which avoids the overheads of many small jobs, e.g.
+when rendering a turntable sequence: a single parallel loop and
+progress bar in scalar variants, and a single wavefront (and thus a
+single kernel launch) in JIT variants. The default implementation
+renders the sensors one after another.
+
+The remaining parameters have the same meaning as in render().)doc";
+
+static const char *__doc_mitsuba_Integrator_set_pass_callback =
+R"doc(Register a callback that is invoked after every rendering pass
+
+The render jobs of SamplingIntegrator split the samples of every pixel
+into passes (see the ``samples_per_pass`` parameter) and invoke the
+callback once the film contains the samples of all completed passes.
+This enables progressive and interactive applications to develop the
+film while rendering continues. The callback receives the number of
+completed passes and the total number of passes, and rendering stops
+early when it returns ``False``. Pass an empty callback to remove it.)doc";
+
 static const char *__doc_mitsuba_Integrator_should_stop =
 R"doc(Indicates whether cancel() or a timeout have occurred. Should be
 checked regularly in the integrator's main loop so that timeouts are
@@ -3813,6 +4493,86 @@ time. If not, the application is terminated via ``abort()``.)doc";
 
 static const char *__doc_mitsuba_Jit_static_shutdown = R"doc(Release all memory used by JIT-compiled routines)doc";
 
+static const char *__doc_mitsuba_KDTraversalCounters =
+R"doc(Counters of a kd-tree traversal, see ShapeKDTree::measure_traversal())doc";
+
+static const char *__doc_mitsuba_KDTraversalCounters_inner_nodes = R"doc()doc";
+
+static const char *__doc_mitsuba_KDTraversalCounters_leaves = R"doc()doc";
+
+static const char *__doc_mitsuba_KDTraversalCounters_primitives = R"doc()doc";
+
+static const char *__doc_mitsuba_KDTraversalStatistics =
+R"doc(Traversal cost of a kd-tree measured by
+ShapeKDTree::measure_traversal())doc";
+
+static const char *__doc_mitsuba_KDTraversalStatistics_hit_count = R"doc(Number of rays that hit a primitive)doc";
+
+static const char *__doc_mitsuba_KDTraversalStatistics_inner_nodes_per_ray = R"doc(Average number of inner nodes traversed per ray)doc";
+
+static const char *__doc_mitsuba_KDTraversalStatistics_leaves_per_ray = R"doc(Average number of (non-empty) leaves visited per ray)doc";
+
+static const char *__doc_mitsuba_KDTraversalStatistics_primitives_per_ray = R"doc(Average number of primitive intersection tests per ray)doc";
+
+static const char *__doc_mitsuba_KDTraversalStatistics_ray_count = R"doc(Number of traced rays)doc";
+
+static const char *__doc_mitsuba_KDTraversalStatistics_time =
+R"doc(Time taken to trace all rays in seconds (best of several passes))doc";
+
+static const char *__doc_mitsuba_KDTraversalStatistics_to_string = R"doc()doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics =
+R"doc(Quality statistics of a kd-tree, which are gathered by
+TShapeKDTree::build()
+
+The expected number of traversal steps, leaf visits and primitive
+visits per query are computed from the cost model (e.g. the surface
+areas of the nodes relative to the root), hence they describe a query
+that is distributed according to the cost model rather than an actual
+workload. See ShapeKDTree::measure_traversal() for measurements on
+sampled rays.)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_build_time =
+R"doc(Time taken by the build in seconds (excluding the compaction))doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_depth_inner_nodes = R"doc(Number of inner nodes per depth)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_depth_leaf_nodes = R"doc(Number of leaf nodes per depth)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_depth_primitives = R"doc(Number of primitive references per depth)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_empty_leaf_count = R"doc(Number of leaf nodes without primitives)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_empty_space_ratio = R"doc(Fraction of the volume of the tree covered by empty leaves)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_expected_leaf_visits = R"doc(Expected number of leaves visited per query)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_expected_primitive_visits = R"doc(Expected number of primitives tested per query)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_expected_traversal_steps = R"doc(Expected number of inner nodes traversed per query)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_index_count = R"doc(Number of primitive references stored in the leaves)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_inner_node_count = R"doc(Number of reachable inner nodes)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_leaf_count = R"doc(Number of reachable leaf nodes)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_leaf_size_histogram =
+R"doc(Number of leaves per primitive count. The last entry counts all leaves
+with at least ``leaf_size_histogram.size() - 1`` primitives.)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_max_depth = R"doc(Depth of the deepest leaf)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_max_leaf_size = R"doc(Number of primitives of the largest leaf)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_node_count =
+R"doc(Number of stored nodes. This can exceed the number of reachable inner
+and leaf nodes, since retracted splits leave unused nodes behind.)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_sah_cost = R"doc(Cost of the tree according to the cost model of the build)doc";
+
+static const char *__doc_mitsuba_KDTreeStatistics_to_string = R"doc()doc";
+
 static const char *__doc_mitsuba_LogLevel = R"doc(Available Log message types)doc";
 
 static const char *__doc_mitsuba_LogLevel_Debug = R"doc(Trace message, for extremely verbose debugging)doc";
@@ -3852,10 +4612,16 @@ static const char *__doc_mitsuba_Logger_d = R"doc()doc";
 
 static const char *__doc_mitsuba_Logger_error_level = R"doc(Return the current error level)doc";
 
+static const char *__doc_mitsuba_Logger_flush =
+R"doc(Forward all messages that are pending in asynchronous mode to the
+appenders)doc";
+
 static const char *__doc_mitsuba_Logger_formatter = R"doc(Return the logger's formatter implementation)doc";
 
 static const char *__doc_mitsuba_Logger_formatter_2 = R"doc(Return the logger's formatter implementation (const))doc";
 
+static const char *__doc_mitsuba_Logger_is_async = R"doc(Is asynchronous logging enabled?)doc";
+
 static const char *__doc_mitsuba_Logger_log =
 R"doc(Process a log message
 
@@ -3908,6 +4674,19 @@ Throws a runtime exception upon failure)doc";
 
 static const char *__doc_mitsuba_Logger_remove_appender = R"doc(Remove an appender from this logger)doc";
 
+static const char *__doc_mitsuba_Logger_set_async =
+R"doc(Enable or disable asynchronous logging
+
+In asynchronous mode, log() and log_progress() format the message on
+the calling thread and append it to a lock-free buffer owned by that
+thread. A background thread then forwards the buffered messages to the
+appenders, which preserves the order of the messages of every thread
+(but not across threads). Slow appenders hence no longer stall the
+threads that produce log messages.
+
+Disabling asynchronous mode stops the background thread and flushes
+all pending messages. Errors are still raised immediately.)doc";
+
 static const char *__doc_mitsuba_Logger_set_error_level =
 R"doc(Set the error log level (this level and anything above will throw
 exceptions).
@@ -4088,11 +4867,37 @@ static const char *__doc_mitsuba_Medium_Medium_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Medium_class = R"doc()doc";
 
-static const char *__doc_mitsuba_Medium_transmittance_eval_pdf =
-R"doc(Compute the transmittance and PDF
+static const char *__doc_mitsuba_Medium_emitter =
+R"doc(Return the emitter that samples the emission of the medium
 
-This function evaluates the transmittance and PDF of sampling a
-certain free-flight distance The returned PDF takes into account if a
+When it is set, integrators account for the emission on paths that
+perform next event estimation through this emitter only.)doc";
+
+static const char *__doc_mitsuba_Medium_get_radiance =
+R"doc(Returns the radiance emitted by the medium at a given
+MediumInteraction mi
+
+The emission term of the radiative transfer equation is the product of
+this radiance and the absorption coefficient ``sigma_t - sigma_s``.
+The radiance vanishes outside of the unit cube of the radiance volume,
+and everywhere if the medium has none.)doc";
+
+static const char *__doc_mitsuba_Medium_is_emitter = R"doc(Returns whether this medium emits light)doc";
+
+static const char *__doc_mitsuba_Medium_m_emitter = R"doc(Emitter that samples the emission (not owned by the medium))doc";
+
+static const char *__doc_mitsuba_Medium_m_radiance = R"doc(Emitted radiance (optional))doc";
+
+static const char *__doc_mitsuba_Medium_radiance =
+R"doc(Return the volume of radiance emitted by the medium (if any))doc";
+
+static const char *__doc_mitsuba_Medium_set_emitter = R"doc(Set the emitter that samples the emission of the medium)doc";
+
+static const char *__doc_mitsuba_Medium_transmittance_eval_pdf =
+R"doc(Compute the transmittance and PDF
+
+This function evaluates the transmittance and PDF of sampling a
+certain free-flight distance The returned PDF takes into account if a
 medium interaction occurred (mi.t <= si.t) or the ray left the medium
 (mi.t > si.t)
 
@@ -4103,6 +4908,16 @@ depend on the wavelength.
 Returns:
     This method returns a pair of (Transmittance, PDF).)doc";
 
+static const char *__doc_mitsuba_Medium_get_control_extinction =
+R"doc(Returns the control extinction used by residual ratio tracking
+
+The control extinction is constant within the bounding box of the
+medium and should not exceed the extinction coefficient anywhere, so
+that the transmittance due to the control can be computed analytically
+and only the residual extinction has to be estimated stochastically.
+The default implementation returns zero, which reduces residual ratio
+tracking to ratio tracking.)doc";
+
 static const char *__doc_mitsuba_Medium_get_majorant = R"doc(Returns the medium's majorant used for delta tracking)doc";
 
 static const char *__doc_mitsuba_Medium_get_scattering_coefficients =
@@ -4160,6 +4975,22 @@ Returns:
     will always be valid, except if the ray missed the Medium's
     bounding box.)doc";
 
+static const char *__doc_mitsuba_Medium_sample_residual_interaction =
+R"doc(Sample a free-flight distance for residual ratio tracking
+
+This function behaves like sample_interaction(), except that tentative
+collisions are sampled according to the residual majorant, i.e. the
+majorant minus the control extinction returned by
+get_control_extinction(). The ``combined_extinction`` field of the
+returned MediumInteraction stores the residual majorant, and
+``sigma_n`` remains the difference between the majorant and the
+extinction, which is also the difference between the residual majorant
+and the residual extinction. The transmittance due to the control
+extinction must be accounted for analytically by the caller.
+
+Media whose control extinction equals their extinction (e.g.
+homogeneous media) never produce tentative collisions.)doc";
+
 static const char *__doc_mitsuba_Medium_set_id = R"doc(Set a string identifier)doc";
 
 static const char *__doc_mitsuba_Medium_to_string = R"doc(Return a human-readable representation of the Medium)doc";
@@ -4352,11 +5183,12 @@ static const char *__doc_mitsuba_Mesh_bbox_2 = R"doc()doc";
 static const char *__doc_mitsuba_Mesh_bbox_3 = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_build_parameterization =
-R"doc(Initialize the ``m_parameterization`` field for mapping UV coordinates
-to positions
+R"doc(Build the uniform grid over the UV triangles that
+eval_parameterization() uses to map UV coordinates to positions
 
-Internally, the function creates a nested scene to leverage optimized
-ray tracing functionality in eval_parameterization())doc";
+The grid has about one cell per triangle, and every cell lists the
+triangles whose UV bounding box overlaps it. Thread-safe, since it uses
+a mutex.)doc";
 
 static const char *__doc_mitsuba_Mesh_build_pmf =
 R"doc(Build internal tables for sampling uniformly wrt. area.
@@ -4394,8 +5226,12 @@ static const char *__doc_mitsuba_Mesh_has_attribute = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_has_face_normals = R"doc(Does this mesh use face normals?)doc";
 
+static const char *__doc_mitsuba_Mesh_has_flipped_normals = R"doc(Are the normals of this mesh flipped?)doc";
+
 static const char *__doc_mitsuba_Mesh_has_mesh_attributes = R"doc(Does this mesh have additional mesh attributes?)doc";
 
+static const char *__doc_mitsuba_Mesh_has_vertex_motion = R"doc(Does this mesh move its vertices during the shutter interval?)doc";
+
 static const char *__doc_mitsuba_Mesh_has_vertex_normals = R"doc(Does this mesh have per-vertex normals?)doc";
 
 static const char *__doc_mitsuba_Mesh_has_vertex_texcoords = R"doc(Does this mesh have per-vertex texture coordinates?)doc";
@@ -4404,6 +5240,11 @@ static const char *__doc_mitsuba_Mesh_initialize = R"doc(Must be called at the e
 
 static const char *__doc_mitsuba_Mesh_interpolate_attribute = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_is_memory_mapped = R"doc(Is the storage of this mesh backed by a memory-mapped file?)doc";
+
+static const char *__doc_mitsuba_Mesh_m_area_alias_table =
+R"doc(Sample faces using an alias table instead of a binary search?)doc";
+
 static const char *__doc_mitsuba_Mesh_m_area_pmf = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_bbox = R"doc()doc";
@@ -4436,10 +5277,45 @@ static const char *__doc_mitsuba_Mesh_m_vertex_normals = R"doc()doc";
 
 static const char *__doc_mitsuba_Mesh_m_vertex_positions = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_m_vertex_positions_end = R"doc(Vertex positions at time 1 for meshes with vertex motion (empty otherwise))doc";
+
 static const char *__doc_mitsuba_Mesh_m_vertex_texcoords = R"doc()doc";
 
+static const char *__doc_mitsuba_Mesh_memory_footprint =
+R"doc(Return the size of the vertex, face, and attribute buffers and of the
+surface area distribution
+
+Buffers that are backed by a memory-mapped file (see move_to_mmap())
+are paged by the operating system and not included.)doc";
+
 static const char *__doc_mitsuba_Mesh_merge = R"doc(Merge two meshes into one)doc";
 
+static const char *__doc_mitsuba_Mesh_merge_2 =
+R"doc(Merge a list of meshes into one
+
+The meshes must reference the same BSDF, media, emitter and sensor,
+and provide the same set of vertex data and mesh attributes. The
+buffers of the merged mesh are allocated once, and the inputs are
+copied to their offsets in parallel, which makes the cost linear in
+the total size.)doc";
+
+static const char *__doc_mitsuba_Mesh_mesh_attribute_dims =
+R"doc(Return the names and dimensions of the mesh attributes, sorted by
+name)doc";
+
+static const char *__doc_mitsuba_Mesh_move_to_mmap =
+R"doc(Move the vertex, face, and attribute buffers of the mesh into a
+memory-mapped file
+
+The buffers are written into a native storage file and subsequently
+reference the mapped memory, which lets the operating system page the
+geometry in on demand and evict it under memory pressure. This is only
+supported in scalar variants.
+
+Parameter ``filename``:
+    Target file path on disk. When empty, a temporary file is created
+    that is deleted once the mesh is destroyed.)doc";
+
 static const char *__doc_mitsuba_Mesh_moeller_trumbore =
 R"doc(Moeller and Trumbore algorithm for computing ray-triangle intersection
 
@@ -4532,10 +5408,22 @@ static const char *__doc_mitsuba_Mesh_vertex_normals_buffer_2 = R"doc(Const vari
 
 static const char *__doc_mitsuba_Mesh_vertex_position = R"doc(Returns the world-space position of the vertex with index ``index``)doc";
 
+static const char *__doc_mitsuba_Mesh_vertex_position_at =
+R"doc(Returns the world-space position of the vertex with index ``index`` at
+the given time
+
+The positions of meshes with vertex motion (see has_vertex_motion())
+are interpolated linearly between the key at time 0 and the key at
+time 1.)doc";
+
 static const char *__doc_mitsuba_Mesh_vertex_positions_buffer = R"doc(Return vertex positions buffer)doc";
 
 static const char *__doc_mitsuba_Mesh_vertex_positions_buffer_2 = R"doc(Const variant of vertex_positions_buffer.)doc";
 
+static const char *__doc_mitsuba_Mesh_vertex_positions_end_buffer = R"doc(Return vertex positions buffer at the end of the motion (empty for static meshes))doc";
+
+static const char *__doc_mitsuba_Mesh_vertex_positions_end_buffer_2 = R"doc(Const variant of vertex_positions_end_buffer.)doc";
+
 static const char *__doc_mitsuba_Mesh_vertex_texcoord = R"doc(Returns the UV texture coordinates of the vertex with index ``index``)doc";
 
 static const char *__doc_mitsuba_Mesh_vertex_texcoords_buffer = R"doc(Return vertex texcoords buffer)doc";
@@ -4545,15 +5433,24 @@ static const char *__doc_mitsuba_Mesh_vertex_texcoords_buffer_2 = R"doc(Const va
 static const char *__doc_mitsuba_Mesh_write_ply =
 R"doc(Write the mesh to a binary PLY file
 
+The file is memory-mapped at its final size, and the vertex and face
+records are assembled into it in parallel.
+
 Parameter ``filename``:
     Target file path on disk)doc";
 
 static const char *__doc_mitsuba_Mesh_write_ply_2 =
 R"doc(Write the mesh encoded in binary PLY format to a stream
 
+The records are assembled in large batches in parallel, and each batch
+is written with a single call while the next one is assembled.
+
 Parameter ``stream``:
     Target stream that will receive the encoded output)doc";
 
+static const char *__doc_mitsuba_Mesh_write_ply_impl =
+R"doc(Collect the PLY header and buffers of the mesh and pass them to ``func``)doc";
+
 static const char *__doc_mitsuba_MicrofacetDistribution =
 R"doc(Implementation of the Beckman and GGX / Trowbridge-Reitz microfacet
 distributions and various useful sampling routines
@@ -4640,6 +5537,21 @@ Parameter ``wi``:
 Parameter ``m``:
     The microfacet normal)doc";
 
+static const char *__doc_mitsuba_MicrofacetDistribution_pdf_2 =
+R"doc(Variant of pdf() that reuses the values of eval() and smith_g1() that
+were already computed by the caller
+
+Microfacet BSDFs need both quantities to evaluate the model, hence
+their combined evaluation and sampling density queries can avoid
+recomputing them.
+
+Parameter ``D``:
+    The value of eval(m)
+
+Parameter ``smith_g1_wi``:
+    The value of smith_g1(wi, m) (only relevant if visible normal
+    sampling is used))doc";
+
 static const char *__doc_mitsuba_MicrofacetDistribution_project_roughness_2 = R"doc(Compute the squared 1D roughness along direction ``v``)doc";
 
 static const char *__doc_mitsuba_MicrofacetDistribution_sample =
@@ -4720,6 +5632,26 @@ static const char *__doc_mitsuba_MitsubaViewer_m_view = R"doc()doc";
 
 static const char *__doc_mitsuba_MitsubaViewer_perform_layout = R"doc()doc";
 
+static const char *__doc_mitsuba_MonteCarloEvent =
+R"doc(Sampling events counted by MonteCarloIntegrator::event_counts())doc";
+
+static const char *__doc_mitsuba_MonteCarloEvent_Count = R"doc(Number of event kinds)doc";
+
+static const char *__doc_mitsuba_MonteCarloEvent_EmitterSample = R"doc(Emitter samples of next event estimation)doc";
+
+static const char *__doc_mitsuba_MonteCarloEvent_EmitterSampleOccluded = R"doc(Emitter samples whose shadow ray was occluded)doc";
+
+static const char *__doc_mitsuba_MonteCarloEvent_EmitterSampleZero =
+R"doc(Emitter samples without contribution (zero density or radiance))doc";
+
+static const char *__doc_mitsuba_MonteCarloEvent_MediumInteraction = R"doc(Real scattering events in participating media)doc";
+
+static const char *__doc_mitsuba_MonteCarloEvent_NullCollision =
+R"doc(Null collisions in participating media, including those along shadow
+rays)doc";
+
+static const char *__doc_mitsuba_MonteCarloEvent_RussianRoulette = R"doc(Paths terminated by Russian roulette)doc";
+
 static const char *__doc_mitsuba_MonteCarloIntegrator =
 R"doc(Abstract integrator that performs *recursive* Monte Carlo sampling
 starting from the sensor
@@ -4741,10 +5673,44 @@ static const char *__doc_mitsuba_MonteCarloIntegrator_MonteCarloIntegrator = R"d
 
 static const char *__doc_mitsuba_MonteCarloIntegrator_class = R"doc()doc";
 
+static const char *__doc_mitsuba_MonteCarloIntegrator_event_counts =
+R"doc(Return how often the sampling events of MonteCarloEvent occurred so
+far, indexed by name
+
+The names are ``rr_terminations``, ``emitter_samples``,
+``emitter_samples_occluded``, ``emitter_samples_zero``,
+``medium_interactions`` and ``null_collisions``. Like
+path_length_histogram(), the events are only counted by the ``path``
+and ``volpath`` integrators in the scalar variants when Mitsuba is
+compiled with the ``MI_STATISTICS`` build option.)doc";
+
+static const char *__doc_mitsuba_MonteCarloIntegrator_m_events = R"doc()doc";
+
 static const char *__doc_mitsuba_MonteCarloIntegrator_m_max_depth = R"doc()doc";
 
+static const char *__doc_mitsuba_MonteCarloIntegrator_m_path_lengths = R"doc()doc";
+
 static const char *__doc_mitsuba_MonteCarloIntegrator_m_rr_depth = R"doc()doc";
 
+static const char *__doc_mitsuba_MonteCarloIntegrator_path_length_histogram =
+R"doc(Return how many of the paths traced so far had a given number of
+bounces
+
+Bin ``i`` counts the paths with ``i`` bounces, and the last bin also
+counts longer paths. Only the ``path`` integrator in the scalar
+variants records path lengths, and only when Mitsuba is compiled with
+the ``MI_STATISTICS`` build option.)doc";
+
+static const char *__doc_mitsuba_MonteCarloIntegrator_record_event =
+R"doc(Record ``amount`` occurrences of a sampling event in event_counts())doc";
+
+static const char *__doc_mitsuba_MonteCarloIntegrator_record_path_length =
+R"doc(Record a path with ``depth`` bounces in path_length_histogram())doc";
+
+static const char *__doc_mitsuba_MonteCarloIntegrator_reset_path_length_histogram = R"doc(Reset the counts of path_length_histogram())doc";
+
+static const char *__doc_mitsuba_MonteCarloIntegrator_reset_statistics = R"doc(Reset path_length_histogram() and event_counts())doc";
+
 static const char *__doc_mitsuba_NamedReference = R"doc(Wrapper object used to represent named references to Object instances)doc";
 
 static const char *__doc_mitsuba_NamedReference_NamedReference = R"doc()doc";
@@ -4790,7 +5756,16 @@ in Mitsuba.
 
 In contrast, the ``Object`` class allows for a highly efficient
 implementation that only adds 32 bits to the base object (for the
-counter) and has no overhead for references.)doc";
+counter) and has no overhead for references.
+
+Increasing the reference count uses relaxed memory ordering, since a
+new reference can only be created from an existing one. Decreasing it
+releases prior writes to the object, and the thread that deletes the
+object acquires them. Nevertheless, every change of the count is an
+atomic operation on a cache line that is shared by all threads using
+the object. Code that is executed for every sample should therefore
+pass plain (i.e. borrowed) pointers to objects that are kept alive by
+the caller, e.g. the scene, instead of copying ref instances.)doc";
 
 static const char *__doc_mitsuba_Object_Object = R"doc(Default constructor)doc";
 
@@ -4824,6 +5799,19 @@ static const char *__doc_mitsuba_Object_inc_ref = R"doc(Increase the object's re
 
 static const char *__doc_mitsuba_Object_m_ref_count = R"doc()doc";
 
+static const char *__doc_mitsuba_Object_memory_footprint =
+R"doc(Return the memory footprint of the storage owned by this instance in
+bytes
+
+This covers the buffers of the object (e.g. vertex buffers, texels, or
+the nodes of an acceleration data structure), but not the Mitsuba
+objects it references. Storage that is shared with other instances
+(e.g. via the AssetCache) is included in the footprint of each of
+them. The result is an estimate that neglects small allocations.
+
+Remark:
+    The default implementation returns zero.)doc";
+
 static const char *__doc_mitsuba_Object_parameters_changed =
 R"doc(Update internal state after applying changes to parameters
 
@@ -4922,6 +5910,19 @@ Parameter ``normals``:
     Whether or not shading normals information will also be given to
     the Denoiser.
 
+Parameter ``temporal``:
+    Whether or not temporal denoising will be used (which requires the
+    optical flow and the previous denoised frame).
+
+Parameter ``tile_size``:
+    Resolution of the tiles that are denoised one after the other. The
+    memory used by the denoiser is proportional to the tile size
+    rather than to the image size, which makes it possible to denoise
+    images that are too large to be processed at once. Neighboring
+    tiles overlap by the number of pixels that the denoiser needs to
+    avoid seams. This parameter is optional, by default (zero) the
+    whole image is denoised at once.
+
 Returns:
     A callable object which will apply the OptiX denoiser.)doc";
 
@@ -4937,6 +5938,8 @@ static const char *__doc_mitsuba_OptixDenoiser_m_input_size = R"doc()doc";
 
 static const char *__doc_mitsuba_OptixDenoiser_m_options = R"doc()doc";
 
+static const char *__doc_mitsuba_OptixDenoiser_m_overlap = R"doc(Number of pixels by which neighboring tiles overlap)doc";
+
 static const char *__doc_mitsuba_OptixDenoiser_m_scratch = R"doc()doc";
 
 static const char *__doc_mitsuba_OptixDenoiser_m_scratch_size = R"doc()doc";
@@ -4947,6 +5950,10 @@ static const char *__doc_mitsuba_OptixDenoiser_m_state_size = R"doc()doc";
 
 static const char *__doc_mitsuba_OptixDenoiser_m_temporal = R"doc()doc";
 
+static const char *__doc_mitsuba_OptixDenoiser_m_tile_size = R"doc()doc";
+
+static const char *__doc_mitsuba_OptixDenoiser_m_tiled = R"doc()doc";
+
 static const char *__doc_mitsuba_OptixDenoiser_operator_assign = R"doc()doc";
 
 static const char *__doc_mitsuba_OptixDenoiser_operator_call =
@@ -5310,6 +6317,14 @@ static const char *__doc_mitsuba_PluginManager_instance = R"doc(Return the globa
 
 static const char *__doc_mitsuba_PluginManager_loaded_plugins = R"doc(Return the list of loaded plugins)doc";
 
+static const char *__doc_mitsuba_PluginManager_preload =
+R"doc(Load a set of plugins concurrently
+
+This reduces start-up latency when many plugins must be loaded from a
+slow file system. Plugins that were already loaded or that cannot be
+found are skipped, and errors are only reported as warnings: the
+subsequent create_object() call will report them.)doc";
+
 static const char *__doc_mitsuba_PluginManager_register_python_plugin = R"doc(Register a Python plugin)doc";
 
 static const char *__doc_mitsuba_Point = R"doc()doc";
@@ -5477,7 +6492,78 @@ fields that deviate from the standard zero-initialization convention.
 In this particular class, the ``t`` field should be set to an infinite
 value to mark invalid intersection records.)doc";
 
-static const char *__doc_mitsuba_Profiler = R"doc()doc";
+static const char *__doc_mitsuba_PrimitiveBVH =
+R"doc(Binary bounding volume hierarchy over the primitives of a shape
+
+Shape plugins whose primitives are intersected by the plugin itself
+(e.g. clusters of compressed triangles, displaced patches, or
+instances) use this class to trace rays in scalar variants. In
+contrast to ShapeBVH, which uses the surface area heuristic, this
+hierarchy is cheap to build: the primitives are expected to be ordered
+along a Morton curve (see morton_order()), and every node splits its
+range of primitives at the median. Leaves hence reference contiguous
+ranges of primitives.)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_Node = R"doc(Node: leaves (count > 0) reference primitives, inner nodes their right child)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_bbox = R"doc(Return the bounding box of the hierarchy)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_build =
+R"doc(Build the hierarchy over ``count`` primitives
+
+Parameter ``leaf_size``:
+    Maximum number of primitives per leaf
+
+Parameter ``bbox``:
+    Callback returning the bounding box of the i-th primitive
+
+Parameter ``leaf``:
+    Callback that receives the range ``[begin, end)`` of primitives of
+    a leaf and returns the pair ``(offset, count)`` stored in it, e.g.
+    to repack the primitives into groups. The count must be positive.)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_build_2 = R"doc(Build the hierarchy, every leaf references its range of primitives)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_clear = R"doc(Release the nodes)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_intersect_bbox =
+R"doc(Slab test of a ray against the box stored in ``bounds`` (minimum
+followed by maximum) up to the distance ``maxt``)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_memory_footprint = R"doc(Return the memory used by the nodes in bytes)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_morton_order =
+R"doc(Return the permutation that orders ``count`` points along a Morton
+curve through their bounding box
+
+``point(i)`` returns the i-th point (e.g. the center of a primitive).)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_node_bbox = R"doc(Return the bounding box of a node)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_node_count = R"doc(Return the number of nodes)doc";
+
+static const char *__doc_mitsuba_PrimitiveBVH_traverse =
+R"doc(Traverse the hierarchy
+
+The callback receives the index of every leaf entry whose leaf is hit
+by the ray along with the current maximum distance, and returns the
+new maximum distance (or a negative value to stop the traversal).)doc";
+
+static const char *__doc_mitsuba_Profiler =
+R"doc(Built-in statistical profiler
+
+While running, the profiler is interrupted in regular intervals of
+consumed CPU time (via ``SIGPROF``). Each interruption records the
+phases that are active on the interrupted thread, which are then
+aggregated into the fraction of time spent inside of each phase
+(*inclusive*) and inside of each phase but not in one of its nested
+phases (*exclusive*).
+
+Phases are only recorded when Mitsuba is compiled with the
+``MI_PROFILER_SAMPLING`` CMake option, which is enabled by default on
+Linux and macOS. Since vectorized variants only run the instrumented
+C++ code while tracing kernels, the reports are mainly meaningful for
+the scalar variants.)doc";
 
 static const char *__doc_mitsuba_ProfilerPhase =
 R"doc(List of 'phases' that are handled by the profiler. Note that a partial
@@ -5538,10 +6624,29 @@ static const char *__doc_mitsuba_ProfilerPhase_TextureEvaluate = R"doc()doc";
 
 static const char *__doc_mitsuba_ProfilerPhase_TextureSample = R"doc()doc";
 
+static const char *__doc_mitsuba_Profiler_enabled = R"doc(Is the sampling profiler available in this build?)doc";
+
+static const char *__doc_mitsuba_Profiler_report =
+R"doc(Return a report of the time spent in the profiler phases
+
+Parameter ``json``:
+    Format the report as a JSON object instead of a human-readable
+    table.)doc";
+
+static const char *__doc_mitsuba_Profiler_reset = R"doc(Discard all collected samples)doc";
+
+static const char *__doc_mitsuba_Profiler_running = R"doc(Is the profiler currently sampling?)doc";
+
+static const char *__doc_mitsuba_Profiler_sample_count = R"doc(Number of samples collected since the last call to reset())doc";
+
+static const char *__doc_mitsuba_Profiler_start = R"doc(Start sampling, once every ``interval`` milliseconds of CPU time)doc";
+
 static const char *__doc_mitsuba_Profiler_static_initialization = R"doc()doc";
 
 static const char *__doc_mitsuba_Profiler_static_shutdown = R"doc()doc";
 
+static const char *__doc_mitsuba_Profiler_stop = R"doc(Stop sampling. Collected samples remain available to report())doc";
+
 static const char *__doc_mitsuba_ProgressReporter =
 R"doc(General-purpose progress reporter
 
@@ -5750,6 +6855,12 @@ R"doc(Remove a property with the specified name
 Returns:
     ``True`` upon success)doc";
 
+static const char *__doc_mitsuba_Properties_reserve =
+R"doc(Reserve memory for the given number of properties
+
+This avoids repeated reallocations when the number of properties is
+known in advance, e.g. when converting a Python dictionary.)doc";
+
 static const char *__doc_mitsuba_Properties_set_array3f = R"doc(Store a 3D array in the Properties instance)doc";
 
 static const char *__doc_mitsuba_Properties_set_bool = R"doc(Store a boolean value in the Properties instance)doc";
@@ -5778,6 +6889,8 @@ static const char *__doc_mitsuba_Properties_set_transform =
 R"doc(Store a 4x4 homogeneous coordinate transformation in the Properties
 instance)doc";
 
+static const char *__doc_mitsuba_Properties_size = R"doc(Return the number of stored properties)doc";
+
 static const char *__doc_mitsuba_Properties_string = R"doc(Retrieve a string value)doc";
 
 static const char *__doc_mitsuba_Properties_string_2 = R"doc(Retrieve a string value (use default value if no entry exists))doc";
@@ -5823,6 +6936,20 @@ bases including scrambled versions.
 This class is used to implement Halton and Hammersley sequences for
 QMC integration in Mitsuba.)doc";
 
+static const char *__doc_mitsuba_RadicalInverse_DigitTable = R"doc()doc";
+
+static const char *__doc_mitsuba_RadicalInverse_DigitTable_digits = R"doc()doc";
+
+static const char *__doc_mitsuba_RadicalInverse_DigitTable_divisor = R"doc()doc";
+
+static const char *__doc_mitsuba_RadicalInverse_DigitTable_recip = R"doc()doc";
+
+static const char *__doc_mitsuba_RadicalInverse_DigitTable_scrambled = R"doc()doc";
+
+static const char *__doc_mitsuba_RadicalInverse_DigitTable_size = R"doc()doc";
+
+static const char *__doc_mitsuba_RadicalInverse_DigitTable_values = R"doc()doc";
+
 static const char *__doc_mitsuba_RadicalInverse_PrimeBase = R"doc()doc";
 
 static const char *__doc_mitsuba_RadicalInverse_PrimeBase_divisor = R"doc()doc";
@@ -5862,6 +6989,24 @@ R"doc(Compute the Faure permutations using dynamic programming
 For reference, see "Good permutations for extreme discrepancy" by
 Henri Faure, Journal of Number Theory, Vol. 42, 1, 1992.)doc";
 
+static const char *__doc_mitsuba_RadicalInverse_digit_table =
+R"doc(Return a lookup table that reverses blocks of several digits in the
+given prime number basis
+
+Entry ``i`` of the table stores the digits_per_lookup() least
+significant digits of ``i`` in reversed order, i.e., the radical
+inverse of ``i`` scaled by ``base^digits``. When ``scrambled`` is set,
+every digit is additionally run through the scrambling permutation.
+Returns ``nullptr`` when no table is available for the base.)doc";
+
+static const char *__doc_mitsuba_RadicalInverse_digits_per_lookup =
+R"doc(Return the number of digits that are resolved by a single lookup into
+the table returned by digit_table()
+
+Tables are only available for small bases, whose blocks of several
+digits fit into 4096 table entries. The function returns 1 for all
+other bases.)doc";
+
 static const char *__doc_mitsuba_RadicalInverse_eval =
 R"doc(Calculate the radical inverse function
 
@@ -5908,6 +7053,12 @@ static const char *__doc_mitsuba_RadicalInverse_m_permutations = R"doc()doc";
 
 static const char *__doc_mitsuba_RadicalInverse_m_scramble = R"doc()doc";
 
+static const char *__doc_mitsuba_RadicalInverse_m_table_count = R"doc()doc";
+
+static const char *__doc_mitsuba_RadicalInverse_m_table_storage = R"doc()doc";
+
+static const char *__doc_mitsuba_RadicalInverse_m_tables = R"doc()doc";
+
 static const char *__doc_mitsuba_RadicalInverse_permutation = R"doc(Return the permutation corresponding to the given prime number basis)doc";
 
 static const char *__doc_mitsuba_RadicalInverse_scramble = R"doc(Return the original scramble value)doc";
@@ -5921,6 +7072,108 @@ Along with the ray origin and direction, this data structure
 additionally stores a maximum ray position ``maxt``, a time value
 ``time`` as well a the wavelength information associated with the ray.)doc";
 
+static const char *__doc_mitsuba_RayBenchmark =
+R"doc(Harness that measures the ray tracing throughput of a scene
+
+This class generates batches of primary, diffuse and shadow rays for a
+scene and traces them with Scene::ray_intersect_preliminary() (primary
+and diffuse rays) or Scene::ray_test() (shadow rays), which allows
+comparing acceleration data structures and their build parameters
+(e.g. ``kd_intersection_cost``, ``kd_stop_prims``,
+``kd_min_max_bins``) independently of the cost of shading.
+
+Primary rays are sampled from the first sensor of the scene, or from a
+sphere around the scene if it doesn't have a sensor. Diffuse and
+shadow rays start on the surfaces hit by primary rays. All rays are
+determined by the seed and their index, hence consecutive runs trace
+the same rays.
+
+The rays of a batch are generated before the timed passes. The first
+pass over a batch measures cold caches (and includes the kernel
+compilation of JIT variants, unless the kernel was cached by an
+earlier run), while the following passes trace the same batch again
+with warm caches. Scalar variants trace the rays of a batch in
+parallel on all worker threads.)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult = R"doc(Measurements of one RayBenchmark::run())doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_batch_size = R"doc(Maximal number of rays traced at once)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_cold_rays_per_second = R"doc(Ray throughput of the first pass)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_cold_time = R"doc(Time of the first pass over all batches in seconds)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_hit_count = R"doc(Number of traced rays that hit a surface (or were occluded))doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_ray_count = R"doc(Number of generated rays)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_to_string = R"doc()doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_traced_count =
+R"doc(Number of traced rays. Diffuse and shadow rays are only traced from
+primary rays that hit a surface, hence this can be smaller than
+ray_count.)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_type = R"doc(Kind of the traced rays)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_warm_passes =
+R"doc(Number of passes over each batch that were averaged in warm_time)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_warm_rays_per_second = R"doc(Ray throughput of the following passes)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkResult_warm_time =
+R"doc(Average time of the following passes over all batches in seconds)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkType = R"doc(Kind of rays that are traced by a RayBenchmark)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkType_Diffuse =
+R"doc(Cosine-distributed rays leaving the surfaces hit by primary rays)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkType_Primary =
+R"doc(Camera rays through uniformly distributed positions on the film)doc";
+
+static const char *__doc_mitsuba_RayBenchmarkType_Shadow =
+R"doc(Rays from the surfaces hit by primary rays towards points on emitters)doc";
+
+static const char *__doc_mitsuba_RayBenchmark_RayBenchmark =
+R"doc(Create a benchmark for the given scene
+
+Parameter ``batch_size``:
+    Maximal number of rays that are generated and traced at once
+
+Parameter ``seed``:
+    Seed of the generated rays)doc";
+
+static const char *__doc_mitsuba_RayBenchmark_batch_size = R"doc(Return the maximal number of rays that are traced at once)doc";
+
+static const char *__doc_mitsuba_RayBenchmark_class = R"doc()doc";
+
+static const char *__doc_mitsuba_RayBenchmark_generate =
+R"doc(Generate the rays with the given global indices
+
+Returns:
+    The rays and a mask of the ones that should be traced)doc";
+
+static const char *__doc_mitsuba_RayBenchmark_m_batch_size = R"doc()doc";
+
+static const char *__doc_mitsuba_RayBenchmark_m_scene = R"doc()doc";
+
+static const char *__doc_mitsuba_RayBenchmark_m_seed = R"doc()doc";
+
+static const char *__doc_mitsuba_RayBenchmark_run =
+R"doc(Trace ``ray_count`` rays of the given kind and measure the time
+
+Parameter ``warm_passes``:
+    Number of passes over each batch after the first (cold) one)doc";
+
+static const char *__doc_mitsuba_RayBenchmark_scene = R"doc(Return the scene whose rays are traced)doc";
+
+static const char *__doc_mitsuba_RayBenchmark_seed = R"doc(Return the seed of the generated rays)doc";
+
+static const char *__doc_mitsuba_RayBenchmark_set_batch_size = R"doc(Set the maximal number of rays that are traced at once)doc";
+
+static const char *__doc_mitsuba_RayBenchmark_to_string = R"doc()doc";
+
 static const char *__doc_mitsuba_RayDifferential =
 R"doc(Ray differential -- enhances the basic ray class with offset rays for
 two adjacent pixels on the view plane)doc";
@@ -6272,7 +7525,10 @@ static const char *__doc_mitsuba_Sampler_compute_per_sequence_seed =
 R"doc(Generates a array of seeds where the seed values are unique per
 sequence)doc";
 
-static const char *__doc_mitsuba_Sampler_current_sample_index = R"doc(Return the index of the current sample)doc";
+static const char *__doc_mitsuba_Sampler_current_sample_index =
+R"doc(Return the index of the current sample within its pixel
+
+The index counts the samples taken since the sampler was last seeded.)doc";
 
 static const char *__doc_mitsuba_Sampler_fork =
 R"doc(Create a fork of this sampler.
@@ -6311,6 +7567,17 @@ In the context of wavefront ray tracing & dynamic arrays, this
 function must be called with ``wavefront_size`` matching the size of
 the wavefront.)doc";
 
+static const char *__doc_mitsuba_Sampler_seed_pass =
+R"doc(Seed the sampler for one pass of a progressive render
+
+Renderers that split the samples of every pixel into several passes
+call this function instead of seed(). The default implementation
+forwards ``seed``, which differs between passes. Samplers generating a
+single sequence per pixel instead use ``sequence_seed``, which is the
+same in every pass, and skip the ``sample_offset`` samples taken by
+the previous passes. This preserves the stratification of the complete
+sequence for any split into passes.)doc";
+
 static const char *__doc_mitsuba_Sampler_seeded = R"doc(Return whether the sampler was seeded)doc";
 
 static const char *__doc_mitsuba_Sampler_set_sample_count = R"doc(Set the number of samples per pixel)doc";
@@ -6340,24 +7607,160 @@ static const char *__doc_mitsuba_SamplingIntegrator_4 = R"doc()doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_5 = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_PrimaryHitCache = R"doc(State of the primary hit cache during a render job)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_PrimaryHitCache_active = R"doc(Is the cache used by the current render job?)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_PrimaryHitCache_offset = R"doc(Stratified subpixel positions of the lanes of the wavefront)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_PrimaryHitCache_pi = R"doc(Primary intersections of the lanes of the wavefront)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_PrimaryHitCache_valid = R"doc(Were the intersections recorded by the first pass?)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_SamplingIntegrator = R"doc(//! @})doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_calibrate_sample_memory =
+R"doc(Render a calibration wavefront and return the device memory per sample)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_class = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_m_block_order =
+R"doc(Order in which the image blocks are rendered (in scalar mode)
+
+Set via the ``block_order`` parameter (``"spiral"``, ``"hilbert"`` or
+``"morton"``, see BlockOrder). Every worker renders contiguous runs of
+blocks along this order. The Hilbert and Morton curves keep those runs
+compact, which improves the reuse of the acceleration data structure
+and textures in the caches of the worker.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_m_block_size = R"doc(Size of (square) image blocks to render in parallel (in scalar mode))doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_m_cache_primary =
+R"doc(Reuse the primary intersections across passes (JIT variants).
+
+When rendering several passes with a sensor that has neither an
+aperture nor a shutter interval, and with a box filter, the first pass
+records the primary intersections of its wavefront, and later passes
+only trace the subsequent bounces. To this end, every pass places the
+samples of a pixel at the same stratified subpixel positions, hence
+the antialiasing is limited to the samples of a single pass. Set via
+the ``cache_primary`` parameter and only used by integrators that call
+primary_intersection(). Disabled by default.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_m_measured_sample_memory = R"doc(Memory per sample measured by calibrate_sample_memory())doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_m_memory_budget =
+R"doc(Memory budget of the wavefront of a pass in bytes.
+
+Replaces the fraction of the free device memory (m_memory_fraction)
+when nonzero. This also enables the split in the LLVM variants. Zero
+by default.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_m_memory_fraction =
+R"doc(Fraction of the free device memory that the wavefront of a pass may
+occupy (CUDA variants).
+
+When m_samples_per_pass is unspecified, the samples per pixel are
+split into as few passes as needed for the wavefront of every pass to
+fit into this fraction of the free memory of the device. Without this,
+large films with many samples per pixel run out of memory long before
+reaching the limit of 2^32 samples per pass. Zero disables the split.
+Defaults to 0.8.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_m_packet_size =
+R"doc(Number of neighboring pixels whose camera rays are traced together (in
+scalar mode).
+
+When larger than one, render_block() processes the pixels of a block
+in groups of this size along the Morton curve. Every pixel of a group
+keeps its own sampler, and the camera rays of a sample index are
+traced as a packet (see Scene::ray_intersect_preliminary_packet())
+before the samples are shaded one by one. The images thus match those
+of the default mode up to the order in which samples are accumulated.
+Must be a power of two up to 16 and is only used by integrators whose
+uses_primary_intersection() returns ``True``. Disabled (one) by
+default.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_m_primary_cache = R"doc(Primary hit cache, see m_cache_primary)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_m_sample_memory =
+R"doc(Memory per sample of the wavefront in bytes.
+
+When zero (the default), the larger of a rough estimate of the path
+state and the value measured by a calibration wavefront is used.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_m_samples_per_pass =
 R"doc(Number of samples to compute for each pass over the image blocks.
 
 Must be a multiple of the total sample count per pixel. If set to
 (uint32_t) -1, all the work is done in a single pass (default).)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_memory_limited_spp =
+R"doc(Number of samples per pixel of a pass whose wavefront fits into the
+device memory budget (JIT variants)
+
+Returns the largest divisor of ``spp`` that does not exceed
+``spp_per_pass`` and whose wavefront over ``pixel_count`` pixels fits
+into the budget (see m_memory_fraction). When the wavefront may not
+fit and the memory per sample is unknown, a calibration wavefront of
+``sensor`` is rendered first, and the device memory it allocates is
+recorded in m_measured_sample_memory.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_primary_cache_active =
+R"doc(Does primary_intersection() return recorded intersections?
+
+This is the case while the primary hit cache is active (JIT variants),
+and while render_block() shades the samples of a ray packet (see
+m_packet_size).)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_primary_intersection =
+R"doc(Return the primary intersection of a camera ray
+
+Integrators may call this function instead of tracing the camera ray
+passed to sample(). While the primary hit cache is active (see
+m_cache_primary), the first call of a render job traces the ray and
+records the intersection, and later passes return the recorded
+intersection instead of tracing the ray again.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_render = R"doc(//! @{ \name Integrator interface implementation)doc";
 
 static const char *__doc_mitsuba_SamplingIntegrator_render_block = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_render_memory_footprint =
+R"doc(Estimate the memory in bytes that render() allocates to render the
+given sensor, in addition to the scene itself
+
+On top of the film storage, this includes the per-thread image blocks
+of scalar variants, and the wavefront state of JIT variants, which
+grows with the number of samples per pass.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_render_ray =
+R"doc(Estimate the radiance along a camera ray and splat it into ``block``
+(second half of render_sample()))doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_render_sample = R"doc()doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_render_sample_2 =
+R"doc(Variant of render_sample() that handles a wavefront containing the
+samples of several sensors (JIT variants)
+
+Lane ``i`` belongs to sensor ``j`` when ``masks[j][i]`` is set and is
+splatted into ``blocks[j]``. The films of all sensors must have the
+same flags.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_render_sensors =
+R"doc(Render the scene from the viewpoints of several sensors
+
+In scalar variants, the image blocks of all sensors are distributed
+over the worker threads by a single parallel loop. Every sensor keeps
+its own sampler, sample count, and film.
+
+In JIT variants, the samples of all sensors form a single wavefront
+that draws its random numbers from the sampler of the first sensor.
+This requires the sensors to use the same sample count, medium, and
+film type (channels and flags). Otherwise, and when adaptive sampling
+is enabled, the sensors are rendered one after another.)doc";
+
 static const char *__doc_mitsuba_SamplingIntegrator_sample =
 R"doc(Sample the incident radiance along a ray.
 
@@ -6401,6 +7804,20 @@ Remark:
 (spec, mask, aov) = integrator.sample(scene, sampler, ray, medium, active)
 ```)doc";
 
+static const char *__doc_mitsuba_SamplingIntegrator_sample_camera_ray =
+R"doc(Sample the camera ray of a sample at the pixel ``pos`` (first half of
+render_sample())
+
+Returns the ray, its importance weight and the position of the sample
+on the film.)doc";
+
+static const char *__doc_mitsuba_SamplingIntegrator_uses_primary_intersection =
+R"doc(Does sample() obtain the intersection of the camera ray via
+primary_intersection()?
+
+The packet mode of render_block() is only used by integrators that
+return ``True``, since others would trace the camera rays again.)doc";
+
 static const char *__doc_mitsuba_Scene =
 R"doc(Central scene data structure
 
@@ -6431,12 +7848,24 @@ static const char *__doc_mitsuba_Scene_4 = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_5 = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_PassthroughRayMask =
+R"doc(Ray mask of passthrough shapes in the CPU backends
+
+All other shapes have the ray mask ``(uint32_t) -1``.
+ray_intersect_occluder() traces rays with the complementary mask,
+which skips passthrough shapes during the traversal.)doc";
+
 static const char *__doc_mitsuba_Scene_Scene = R"doc(Instantiate a scene from a Properties object)doc";
 
 static const char *__doc_mitsuba_Scene_accel_init_cpu = R"doc(Create the ray-intersection acceleration data structure)doc";
 
 static const char *__doc_mitsuba_Scene_accel_init_gpu = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_accel_memory_footprint_cpu =
+R"doc(Return the size of the ray-intersection acceleration data structure)doc";
+
+static const char *__doc_mitsuba_Scene_accel_memory_footprint_gpu = R"doc()doc";
+
 static const char *__doc_mitsuba_Scene_accel_parameters_changed_cpu = R"doc(Updates the ray-intersection acceleration data structure)doc";
 
 static const char *__doc_mitsuba_Scene_accel_parameters_changed_gpu = R"doc()doc";
@@ -6445,6 +7874,24 @@ static const char *__doc_mitsuba_Scene_accel_release_cpu = R"doc(Release the ray
 
 static const char *__doc_mitsuba_Scene_accel_release_gpu = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_accel_shapes_changed_cpu =
+R"doc(Update backend-specific state after shapes were added or removed)doc";
+
+static const char *__doc_mitsuba_Scene_accel_shapes_changed_gpu = R"doc()doc";
+
+static const char *__doc_mitsuba_Scene_add_emitter =
+R"doc(Insert an emitter that is not attached to a shape (e.g. a point light
+or an environment map) into the scene (see add_shape()))doc";
+
+static const char *__doc_mitsuba_Scene_add_shape =
+R"doc(Insert a shape into the scene
+
+Area emitters attached to the shape are inserted along with it. Like
+other scene modifications, this change only takes effect after the
+next call to parameters_changed(), which updates the acceleration data
+structure and the emitter sampling data structures of the existing
+scene. Several modifications can therefore be applied at once.)doc";
+
 static const char *__doc_mitsuba_Scene_bbox = R"doc(Return a bounding box surrounding the scene)doc";
 
 static const char *__doc_mitsuba_Scene_class = R"doc()doc";
@@ -6494,18 +7941,54 @@ Returns:
     The incident radiance and discrete or solid angle density of the
     sample.)doc";
 
+static const char *__doc_mitsuba_Scene_has_alpha_tested_shapes =
+R"doc(Does the scene contain shapes whose BSDF performs an alpha test?)doc";
+
+static const char *__doc_mitsuba_Scene_has_passthrough_shapes =
+R"doc(Does the scene contain surfaces skipped by ray_intersect_occluder()?)doc";
+
 static const char *__doc_mitsuba_Scene_integrator = R"doc(Return the scene's integrator)doc";
 
 static const char *__doc_mitsuba_Scene_integrator_2 = R"doc(Return the scene's integrator)doc";
 
+static const char *__doc_mitsuba_Scene_is_alpha_tested_shape =
+R"doc(Are intersections with ``shape`` alpha-tested (see
+Shape::alpha_test())?
+
+Area emitters and sensors and shapes separating different media are
+never alpha-tested, since their surfaces must not be skipped.)doc";
+
+static const char *__doc_mitsuba_Scene_is_passthrough_shape = R"doc(Is ``shape`` skipped by ray_intersect_occluder()?)doc";
+
+static const char *__doc_mitsuba_Scene_kernel_signature =
+R"doc(Return a signature of the JIT kernels that rendering the scene with
+the given sensor compiles
+
+The signature is a hash of the variant, the Dr.Jit compilation flags,
+the classes of all objects of the scene (e.g. the types of BSDFs and
+textures), the number of emitters (none, one, or several), the film
+resolution, the sample count, and the configuration of the integrator
+(e.g. its maximum path depth, see Integrator::to_string()). Values of
+the parameters of the objects (colors, vertex positions, ..) are not
+part of it. Scenes with the same signature usually reuse the kernels
+of each other from the kernel cache of Dr.Jit, which allows warming up
+the cache with a representative scene of every signature.)doc";
+
 static const char *__doc_mitsuba_Scene_m_accel = R"doc(Acceleration data structure (IAS) (type depends on implementation))doc";
 
 static const char *__doc_mitsuba_Scene_m_accel_handle = R"doc(Handle to the IAS used to ensure its lifetime in jit variants)doc";
 
+static const char *__doc_mitsuba_Scene_m_alpha_test_continuation =
+R"doc(Must rays be continued past alpha-tested intersections by the scene?)doc";
+
+static const char *__doc_mitsuba_Scene_m_alpha_tested_shapes = R"doc(Does the scene contain alpha-tested shapes?)doc";
+
 static const char *__doc_mitsuba_Scene_m_bbox = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_children = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_m_emitter_alias_table = R"doc(Should m_emitter_distr use an alias table?)doc";
+
 static const char *__doc_mitsuba_Scene_m_emitter_distr = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_emitter_pmf = R"doc()doc";
@@ -6518,6 +8001,11 @@ static const char *__doc_mitsuba_Scene_m_environment = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_integrator = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_m_passthrough_shapes = R"doc()doc";
+
+static const char *__doc_mitsuba_Scene_m_ray_flags =
+R"doc(Surface interaction fields read by the shapes, see ray_flags())doc";
+
 static const char *__doc_mitsuba_Scene_m_sensors = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_shapegroups = R"doc()doc";
@@ -6528,6 +8016,20 @@ static const char *__doc_mitsuba_Scene_m_shapes_dr = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_m_shapes_grad_enabled = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_memory_footprint =
+R"doc(Return the size of the acceleration data structure of the scene)doc";
+
+static const char *__doc_mitsuba_Scene_memory_usage =
+R"doc(Return the memory footprint of the scene in bytes, broken down by the
+kind of object
+
+Visits every object that can be reached from the scene once and sums
+up the values of Object::memory_footprint() by the name of the
+interface the objects implement (e.g. ``"Shape"``, ``"Texture"``,
+``"Volume"``, or ``"Film"``). The entry ``"Accel"`` refers to the
+acceleration data structure of the scene. A summary is logged after
+the scene was created.)doc";
+
 static const char *__doc_mitsuba_Scene_parameters_changed = R"doc(Update internal state following a parameter update)doc";
 
 static const char *__doc_mitsuba_Scene_pdf_emitter =
@@ -6553,6 +8055,35 @@ Parameter ``ds``:
 Returns:
     The solid angle density of the sample)doc";
 
+static const char *__doc_mitsuba_Scene_predicted_peak_memory =
+R"doc(Predict the peak memory usage of rendering the scene in bytes
+
+This is the footprint of the scene (see memory_usage()) without the
+films, whose storage is allocated anew by every render, plus the
+estimate of Integrator::render_memory_footprint() for the given
+sensor. The prediction is meant for admission control before a render
+job starts, and does not include memory allocated by the JIT compiler
+or the temporary storage of acceleration data structure builds.
+
+Parameter ``sensor_index``:
+    Index of the sensor in sensors()
+
+Parameter ``spp``:
+    Optional parameter to override the number of samples per pixel of
+    the sensor's sampler (as in Integrator::render()).)doc";
+
+static const char *__doc_mitsuba_Scene_ray_flags =
+R"doc(Return the fields of the surface interaction (as a combination of
+RayFlags) that the BSDFs, textures and emitters of the shapes read
+
+Always includes RayFlags::Minimal and RayFlags::ShadingFrame. The UV
+coordinates are only requested when a texture is not uniform, and the
+position partials when a BSDF asks for them (see BSDF::ray_flags()).
+Integrators that only pass their surface interactions on to the
+plugins of the scene can intersect rays with these flags instead of
+RayFlags::All, which skips the remaining fields. The flags are
+gathered whenever the shapes change.)doc";
+
 static const char *__doc_mitsuba_Scene_ray_intersect =
 R"doc(Intersect a ray with the shapes comprising the scene and return a
 detailed data structure describing the intersection, if one is found.
@@ -6655,6 +8186,22 @@ Remark:
 
 static const char *__doc_mitsuba_Scene_ray_intersect_naive_cpu = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_ray_intersect_occluder =
+R"doc(Find the first surface along a shadow ray that can change its
+transmittance
+
+Intersections with *passthrough* surfaces, whose BSDF is a pure
+``null`` BSDF and which do not separate different media, are skipped
+without computing their full surface interaction or evaluating their
+BSDF. The returned record describes the first other surface (e.g. an
+opaque occluder, or a null interface of a participating medium), and
+its distance ``t`` is measured from the origin of ``ray``. Hence, it
+also provides the distance to the nearest occluder, which is infinite
+when the ray is unoccluded.
+
+When the scene contains no passthrough surfaces, this function is
+equivalent to ray_intersect().)doc";
+
 static const char *__doc_mitsuba_Scene_ray_intersect_preliminary =
 R"doc(Intersect a ray with the shapes comprising the scene and return
 preliminary information, if one is found
@@ -6680,6 +8227,12 @@ backend is not reflected in Dr.Jit's computation graph. The
 ray_intersect() method will re-evaluate certain parts of the
 computation with derivative tracking to rectify this.
 
+Like the other ray tracing functions, this function skips
+intersections with alpha-tested shapes that fail their alpha test (see
+BSDF::alpha_test()). The scalar variants evaluate the test within the
+traversal of the acceleration data structure, while the JIT variants
+continue the ray past rejected intersections.
+
 In vectorized variants of Mitsuba (``cuda_*`` or ``llvm_*``), the
 function processes arrays of rays and returns arrays of preliminary
 intersection records following the usual conventions.
@@ -6706,10 +8259,34 @@ Returns:
     method should be queried to check if an intersection was actually
     found.)doc";
 
-static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_cpu = R"doc(Trace a ray and only return a preliminary intersection data structure)doc";
+static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_alpha_tested =
+R"doc(Trace a ray and continue it past the intersections that fail their
+alpha test
+
+This is used by the backends that cannot evaluate the alpha test of
+some shapes within the traversal. The distance of the returned record
+is measured from the origin of ``ray``.)doc";
+
+static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_cpu =
+R"doc(Trace a ray and only return a preliminary intersection data structure
+
+The CPU backends only report intersections with shapes whose ray mask
+(see PassthroughRayMask) shares a bit with ``ray_mask``.)doc";
 
 static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_gpu = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_packet =
+R"doc(Intersect a group of coherent rays (scalar variants only)
+
+Equivalent to calling ray_intersect_preliminary() for each of the
+``count`` rays, but the CPU backends trace up to 16 rays at a time as
+a packet (the kd-tree via ShapeKDTree::ray_intersect_packet(), Embree
+via ``rtcIntersect16()``), which shares the traversal of rays that
+visit the same nodes, e.g. the primary rays of neighboring pixels.
+Scenes with alpha-tested shapes and the BVH trace the rays one by one.)doc";
+
+static const char *__doc_mitsuba_Scene_ray_intersect_preliminary_packet_cpu = R"doc(Trace up to 16 rays as a packet (scalar variants only))doc";
+
 static const char *__doc_mitsuba_Scene_ray_test =
 R"doc(Intersect a ray with the shapes comprising the scene and return a
 boolean specifying whether or not an intersection was found.
@@ -6772,6 +8349,23 @@ static const char *__doc_mitsuba_Scene_ray_test_cpu = R"doc(Trace a shadow ray)d
 
 static const char *__doc_mitsuba_Scene_ray_test_gpu = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_remove_emitter = R"doc(Remove an emitter from the scene (see add_shape()))doc";
+
+static const char *__doc_mitsuba_Scene_remove_shape =
+R"doc(Remove a shape and its area emitter from the scene (see add_shape()))doc";
+
+static const char *__doc_mitsuba_Scene_replace_bsdf =
+R"doc(Replace a BSDF by another one on all shapes of the scene that
+reference it, and return the number of affected shapes
+
+Shapes within shape groups are included. The change takes effect
+immediately, since the acceleration data structure does not depend on
+the BSDFs.)doc";
+
+static const char *__doc_mitsuba_Scene_reset_statistics =
+R"doc(Reset the statistics counters of the objects returned by
+statistics_objects() and the path length histogram of the integrator)doc";
+
 static const char *__doc_mitsuba_Scene_sample_emitter =
 R"doc(Sample one emitter in the scene and rescale the input sample for
 reuse.
@@ -6898,12 +8492,31 @@ static const char *__doc_mitsuba_Scene_static_accel_shutdown_cpu = R"doc()doc";
 
 static const char *__doc_mitsuba_Scene_static_accel_shutdown_gpu = R"doc()doc";
 
+static const char *__doc_mitsuba_Scene_statistics_objects =
+R"doc(Collect the distinct shapes, BSDFs and textures that can be reached
+from the scene
+
+These objects carry the hot-path statistics counters (see
+StatisticsCounter, Shape::intersection_counter(),
+BSDF::eval_counter() and Texture::eval_counter()).)doc";
+
 static const char *__doc_mitsuba_Scene_to_string = R"doc(Return a human-readable string representation of the scene contents.)doc";
 
 static const char *__doc_mitsuba_Scene_traverse = R"doc(Traverse the scene graph and invoke the given callback for each object)doc";
 
 static const char *__doc_mitsuba_Scene_update_emitter_sampling_distribution = R"doc(Updates the discrete distribution used to select an emitter)doc";
 
+static const char *__doc_mitsuba_Scene_update_passthrough_shapes =
+R"doc(Check whether any shape is skipped by ray_intersect_occluder() or
+alpha-tested)doc";
+
+static const char *__doc_mitsuba_Scene_update_ray_flags =
+R"doc(Gather the surface interaction fields read by the shapes, see
+ray_flags())doc";
+
+static const char *__doc_mitsuba_Scene_update_scene_structure =
+R"doc(Apply the modifications of add_shape() and related functions)doc";
+
 static const char *__doc_mitsuba_ScopedPhase = R"doc()doc";
 
 static const char *__doc_mitsuba_ScopedPhase_ScopedPhase = R"doc()doc";
@@ -6912,6 +8525,8 @@ static const char *__doc_mitsuba_ScopedPhase_ScopedPhase_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_ScopedPhase_operator_assign = R"doc()doc";
 
+static const char *__doc_mitsuba_ScopedPhase_m_flag = R"doc()doc";
+
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment =
 R"doc(RAII-style class to temporarily switch to another thread's logger/file
 resolver)doc";
@@ -6924,8 +8539,121 @@ static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_file_resolver = R"
 
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_logger = R"doc()doc";
 
+static const char *__doc_mitsuba_ScopedSetThreadEnvironment_m_profiler_flags = R"doc()doc";
+
 static const char *__doc_mitsuba_ScopedSetThreadEnvironment_operator_assign = R"doc()doc";
 
+static const char *__doc_mitsuba_ScopedTraceEvent =
+R"doc(Records the lifetime of this object as an event of the TraceRecorder
+
+Nothing is recorded unless the recorder was running when the object
+was created.)doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_ScopedTraceEvent = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_ScopedTraceEvent_2 = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_active = R"doc(Is this event being recorded?)doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_m_active = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_m_args = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_m_category = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_m_name = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_m_start = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_operator_assign = R"doc()doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_set_arg = R"doc(Attach a string argument to the event)doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_set_arg_2 = R"doc(Attach a numerical argument to the event)doc";
+
+static const char *__doc_mitsuba_ScopedTraceEvent_set_arg_number = R"doc()doc";
+
+static const char *__doc_mitsuba_ScratchArena =
+R"doc(Bump allocator for short-lived scratch memory
+
+An arena hands out memory from a list of large chunks by advancing a
+pointer, and releases all of it at once via reset() or rewind(). No
+destructors are run, hence only trivially destructible types may be
+allocated with allocate_array().
+
+When reset() is called on an arena that spilled into several chunks,
+they are replaced by a single chunk covering their combined size.
+After a short warm-up phase, an arena that is reset at regular
+intervals (e.g. once per image block) therefore no longer touches the
+heap.
+
+Each thread owns an arena that is accessible via thread(). The scalar
+rendering loops reset it before rendering a range of image blocks and
+rewind it after every block, which makes it usable by integrators and
+plugins for temporaries whose lifetime does not exceed the current
+block. Nested users should wrap their allocations in a Scope.
+
+Arenas are not thread-safe.)doc";
+
+static const char *__doc_mitsuba_ScratchArena_Chunk = R"doc()doc";
+
+static const char *__doc_mitsuba_ScratchArena_Marker = R"doc(Position of an arena, see mark() and rewind())doc";
+
+static const char *__doc_mitsuba_ScratchArena_Scope =
+R"doc(Rewinds an arena to its state at construction time upon destruction)doc";
+
+static const char *__doc_mitsuba_ScratchArena_ScratchArena =
+R"doc(Create an empty arena
+
+Parameter ``chunk_size``:
+    Minimum size of the chunks that are requested from the heap. No
+    memory is allocated until the first call to allocate().)doc";
+
+static const char *__doc_mitsuba_ScratchArena_ScratchArena_2 = R"doc()doc";
+
+static const char *__doc_mitsuba_ScratchArena_activate = R"doc()doc";
+
+static const char *__doc_mitsuba_ScratchArena_allocate =
+R"doc(Allocate ``size`` bytes with the given alignment (a power of two))doc";
+
+static const char *__doc_mitsuba_ScratchArena_allocate_array =
+R"doc(Allocate an array of ``count`` value-initialized instances of ``T``)doc";
+
+static const char *__doc_mitsuba_ScratchArena_allocate_slow = R"doc()doc";
+
+static const char *__doc_mitsuba_ScratchArena_bytes_used =
+R"doc(Return the number of bytes handed out since the last reset (incl.
+padding))doc";
+
+static const char *__doc_mitsuba_ScratchArena_capacity = R"doc(Return the total size of the chunks owned by the arena)doc";
+
+static const char *__doc_mitsuba_ScratchArena_chunk_count = R"doc(Return the number of chunks owned by the arena)doc";
+
+static const char *__doc_mitsuba_ScratchArena_heap_allocations =
+R"doc(Return the number of chunks that were requested from the heap by all
+arenas since the program started
+
+This counter makes it possible to check that a loop which uses the
+thread arenas no longer allocates memory after a warm-up phase.)doc";
+
+static const char *__doc_mitsuba_ScratchArena_mark = R"doc(Return the current position of the arena)doc";
+
+static const char *__doc_mitsuba_ScratchArena_new_chunk = R"doc()doc";
+
+static const char *__doc_mitsuba_ScratchArena_operator_assign = R"doc()doc";
+
+static const char *__doc_mitsuba_ScratchArena_reset =
+R"doc(Release all allocations, and merge the chunks (see the class
+description))doc";
+
+static const char *__doc_mitsuba_ScratchArena_rewind =
+R"doc(Release the allocations that were made since ``marker`` was obtained
+via mark()
+
+The chunks are kept for subsequent allocations.)doc";
+
+static const char *__doc_mitsuba_ScratchArena_thread = R"doc(Return the scratch arena of the calling thread)doc";
+
 static const char *__doc_mitsuba_Sensor = R"doc()doc";
 
 static const char *__doc_mitsuba_Sensor_2 = R"doc()doc";
@@ -6938,6 +8666,15 @@ static const char *__doc_mitsuba_Sensor_5 = R"doc()doc";
 
 static const char *__doc_mitsuba_Sensor_Sensor = R"doc()doc";
 
+static const char *__doc_mitsuba_Sensor_circle_of_confusion =
+R"doc(Return the radius of the circle of confusion of a world-space point in
+pixels
+
+Sensors with a finite aperture image points outside of the focal plane
+as disks. Adaptive sampling uses their radius to give defocused image
+regions more samples. The default implementation returns zero, i.e. a
+pinhole sensor.)doc";
+
 static const char *__doc_mitsuba_Sensor_class = R"doc()doc";
 
 static const char *__doc_mitsuba_Sensor_film = R"doc(Return the Film instance associated with this sensor)doc";
@@ -7058,6 +8795,231 @@ This class provides core functionality for sampling positions on
 surfaces, computing ray intersections, and bounding shapes within ray
 intersection acceleration data structures.)doc";
 
+static const char *__doc_mitsuba_ShapeBVH_alpha_test =
+R"doc(Evaluate the alpha test of an intersection with an alpha-tested shape)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_m_shape_alpha_tests =
+R"doc(Alpha tests of the registered shapes, see set_shape_alpha_test())doc";
+
+static const char *__doc_mitsuba_ShapeBVH_memory_footprint = R"doc(Return the size of the nodes and primitive references)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_ray_intersect_scalar =
+R"doc(Intersect a ray against the BVH
+
+Shapes whose mask (see set_shape_mask()) does not share a bit with
+``ray_mask`` are ignored.)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_set_shape_alpha_test =
+R"doc(Enable the alpha test (see Shape::alpha_test()) of the i-th shape
+
+The traversal then skips intersections with the shape that fail the
+test. The alpha test is only evaluated by the scalar variants.)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_set_shape_mask =
+R"doc(Set the (nonzero) ray mask of the i-th shape
+
+The traversal ignores the shape for rays whose mask does not share a
+bit with it. Shapes initially have the mask ``(uint32_t) -1``.)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_shape_alpha_test =
+R"doc(Is the alpha test of the i-th shape evaluated during the traversal?)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_shape_mask = R"doc(Return the ray mask of the i-th shape)doc";
+
+static const char *__doc_mitsuba_ShapeGroup_add_instance_reference = R"doc(Register an instance that references this shape group)doc";
+
+static const char *__doc_mitsuba_ShapeGroup_add_lod_candidate =
+R"doc(Register this shape group as a level of detail of an instance)doc";
+
+static const char *__doc_mitsuba_ShapeGroup_embree_build =
+R"doc(Build the Embree scene of the shape group if it is dirty
+
+This otherwise happens on demand when the first instance requests its
+geometry. Building all groups upfront allows the scene to build them
+concurrently, with the given build quality.)doc";
+
+static const char *__doc_mitsuba_ShapeGroup_memory_footprint =
+R"doc(Return the size of the acceleration data structure of the group)doc";
+
+static const char *__doc_mitsuba_ShapeGroup_unused_lod =
+R"doc(Return whether this shape group is a level of detail that no instance
+selected
+
+The scene does not build the acceleration data structures of such
+groups and releases them.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PacketIntersection =
+R"doc(Intersection record of a ray packet, see ray_intersect_packet())doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PacketIntersection_instance_index =
+R"doc(Index of the hit instance in the kd-tree, or ``(uint32_t) -1``)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PacketIntersection_is_valid = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PacketIntersection_prim_index = R"doc(Primitive index within the hit shape)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PacketIntersection_prim_uv = R"doc(Primitive-specific coordinates of the hit)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PacketIntersection_shape_index = R"doc(Index of the hit shape (within the instance, if any))doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PacketIntersection_t = R"doc(Distance to the hit (infinite for lanes without a hit))doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PrecomputedTriangle =
+R"doc(Triangle record for intersection tests without indirections
+
+Stores the affine transformation of Baldwin and Weber ("Fast
+Ray-Triangle Intersections by Coordinate Transformation", JCGT 2016),
+which maps the vertices of the triangle onto (0, 0, 0), (1, 0, 0) and
+(0, 1, 0). The first two rows give the barycentric coordinates of a
+point, and the last row its (scaled) distance to the triangle plane.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PrecomputedTriangle_fallback =
+R"doc(Does this record refer to a primitive that isn't a static triangle?)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_PrecomputedTriangle_m = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_alpha_test =
+R"doc(Evaluate the alpha test of an intersection with an alpha-tested shape)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_auto_tune = R"doc(Is auto-tuning of the cost model enabled?)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_build_auto_tuned =
+R"doc(Build the tree with several cost models and keep the fastest one)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_build_temp_storage =
+R"doc(Return the temporary storage used by the last build in bytes
+
+This includes the chunks of the OrderedChunkAllocator instances and
+the node and index lists before they were compacted.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_build_triangles =
+R"doc(Compute the triangle records (if enabled) in the order of ``m_indices``)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_cache_dir = R"doc(Return the directory of the build cache (empty if disabled))doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_cache_key =
+R"doc(Return the key of the tree in the build cache
+
+This is a hash of the build parameters and of the registered shapes
+(the vertex positions and faces of static meshes, and the bounding
+boxes of the primitives of other shapes).)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_intersect_triangle =
+R"doc(Intersect a ray against a precomputed triangle record
+
+Equivalent to intersect_prim() for static triangles, but only
+accesses the shape data when the triangle is hit.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_intersect_triangle_impl =
+R"doc(Intersect a ray (or a packet of rays) against a precomputed
+triangle record
+
+Returns the distance, the barycentric coordinates of the 2nd and 3rd
+vertex, and whether the triangle was hit within ``[0, ray.maxt]``.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_load_cache =
+R"doc(Load the tree from a file of the build cache (if it matches ``key``))doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_alpha_tests = R"doc(Is the alpha test of any shape enabled?)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_auto_tune = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_auto_tune_rays = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_cache_dir = R"doc(Directory of the build cache, see set_cache_dir())doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_packet_traversal = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_packet_utilization = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_precompute_triangles = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_shape_alpha_tests =
+R"doc(Alpha tests of the registered shapes, see set_shape_alpha_test())doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_shape_masks = R"doc(Ray masks of the registered shapes, see set_shape_mask())doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_m_triangles = R"doc()doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_measure_traversal =
+R"doc(Measure the traversal cost of the kd-tree on sampled rays
+
+The rays start on a sphere enclosing the tree and point towards
+uniformly distributed positions within its bounding box. They only
+depend on ``ray_count`` and ``seed``, hence different trees of the
+same shapes are measured on the same workload. The rays are first
+traced once to count the visited nodes and tested primitives, and then
+``passes`` times (on the calling thread) to measure the time.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_memory_footprint =
+R"doc(Return the size of the node and primitive lists and triangle records)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_packet_traversal = R"doc(Are packets of rays traced together by the LLVM backend?)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_packet_utilization =
+R"doc(Return the minimum fraction of active lanes, below which
+ray_intersect_packet() traces the remaining rays one by one)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_precompute_triangles = R"doc(Are triangles precomputed in leaf order for the traversal?)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_ray_intersect_packet =
+R"doc(Intersect a packet of rays against the kd-tree
+
+All lanes share the traversal of the upper levels of the tree, where
+rays of a coherent packet visit the same nodes. Once the fraction of
+active lanes drops below packet_utilization(), the remaining lanes
+are finished separately with ray_intersect_scalar(), hence a diverged
+packet costs at most as much as tracing its rays one by one (plus the
+shared work done so far).
+
+When the lanes disagree on the order of two children, closest hit
+queries visit the child that most lanes reach first. Shadow rays may
+terminate at any hit, hence they visit the child that the most lanes
+overlap first, which terminates the largest number of lanes early.
+
+The packet width must be 4, 8, or 16.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_set_auto_tune = R"doc(Enable or disable auto-tuning of the cost model in build())doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_set_cache_dir =
+R"doc(Set the directory of the build cache (empty to disable it)
+
+Every file of the directory stores the nodes and primitive indices of
+a built tree in a layout that is loaded via a memory mapping. Files
+are identified by cache_key(), and they are published atomically,
+which allows several processes to share the directory.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_set_packet_traversal = R"doc(Enable or disable the packet traversal of the LLVM backend)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_set_packet_utilization =
+R"doc(Set the minimum fraction of active lanes of the packet traversal)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_set_precompute_triangles =
+R"doc(Enable or disable the precomputed triangle records
+
+Takes effect upon the next call to build().)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_set_shape_alpha_test =
+R"doc(Enable the alpha test (see Shape::alpha_test()) of the i-th shape
+
+The traversal then skips intersections with the shape that fail the
+test. The alpha test is only evaluated by the scalar variants.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_set_shape_mask =
+R"doc(Set the (nonzero) ray mask of the i-th shape
+
+The traversal ignores the shape for rays whose mask does not share a
+bit with it. Shapes initially have the mask ``(uint32_t) -1``.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_shape_alpha_test =
+R"doc(Is the alpha test of the i-th shape evaluated during the traversal?)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_shape_mask = R"doc(Return the ray mask of the i-th shape)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_statistics = R"doc(Return the quality statistics of the last build)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_store_cache = R"doc(Store the built tree in a file of the build cache)doc";
+
 static const char *__doc_mitsuba_Shape_2 = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_3 = R"doc()doc";
@@ -7066,6 +9028,61 @@ static const char *__doc_mitsuba_Shape_4 = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_5 = R"doc()doc";
 
+static const char *__doc_mitsuba_ShapeBVH =
+R"doc(Wide bounding volume hierarchy over a set of shapes
+
+This class provides an alternative to ShapeKDTree for the native (i.e.
+non-Embree) CPU ray tracing backend. It is selected by setting the
+``accel`` parameter of the scene to ``"bvh"``.
+
+The hierarchy is built top-down using the binned surface area heuristic
+(SAH). Each node directly splits into up to 4 or 8 children
+(``bvh_width``), which are tested against the ray in a single SIMD
+operation.)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_PrimRef = R"doc(Reference to a primitive of one of the registered shapes)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_ShapeBVH = R"doc(Create an empty BVH and take build-related parameters from ``props``.)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_add_shape = R"doc(Register a new shape with the BVH (to be called before build()))doc";
+
+static const char *__doc_mitsuba_ShapeBVH_bbox = R"doc(Return the bounding box of the entire BVH)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_build = R"doc(Build the BVH)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_clear = R"doc(Clear the BVH (build-related parameters remain))doc";
+
+static const char *__doc_mitsuba_ShapeBVH_node_count = R"doc(Return the number of nodes of the hierarchy)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_primitive_count = R"doc(Return the number of registered primitives)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_ray_intersect_naive = R"doc(Brute force intersection routine for debugging purposes)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_ready = R"doc(Has the BVH been built?)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_refit =
+R"doc(Update the bounding boxes of the hierarchy after the geometry of the
+registered shapes changed, while keeping its topology
+
+This is much cheaper than a full rebuild, but the quality of the
+hierarchy degrades when the geometry moves significantly. The shapes
+must still have the same number of primitives as during the last call
+to build().
+
+Returns:
+    The SAH cost of the refitted hierarchy relative to the cost right
+    after the last full build.)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_shape = R"doc(Return the i-th shape (const version))doc";
+
+static const char *__doc_mitsuba_ShapeBVH_shape_2 = R"doc(Return the i-th shape)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_shape_count = R"doc(Return the number of registered shapes)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_to_string = R"doc(Return a human-readable string representation of the scene contents.)doc";
+
+static const char *__doc_mitsuba_ShapeBVH_width = R"doc(Return the number of children per node)doc";
+
 static const char *__doc_mitsuba_ShapeGroup = R"doc()doc";
 
 static const char *__doc_mitsuba_ShapeGroup_2 = R"doc()doc";
@@ -7118,6 +9135,8 @@ static const char *__doc_mitsuba_ShapeGroup_m_shapes = R"doc()doc";
 
 static const char *__doc_mitsuba_ShapeGroup_m_shapes_registry_ids = R"doc()doc";
 
+static const char *__doc_mitsuba_ShapeGroup_optix_accel = R"doc(Return the OptiX geometry acceleration structures of the group)doc";
+
 static const char *__doc_mitsuba_ShapeGroup_optix_build_gas = R"doc(Build OptiX geometry acceleration structures)doc";
 
 static const char *__doc_mitsuba_ShapeGroup_optix_fill_hitgroup_records = R"doc()doc";
@@ -7158,7 +9177,16 @@ static const char *__doc_mitsuba_ShapeKDTree_bbox = R"doc(Return the bounding bo
 
 static const char *__doc_mitsuba_ShapeKDTree_bbox_2 = R"doc(Return the (clipped) bounding box of the i-th primitive)doc";
 
-static const char *__doc_mitsuba_ShapeKDTree_build = R"doc(Build the kd-tree)doc";
+static const char *__doc_mitsuba_ShapeKDTree_build =
+R"doc(Build the kd-tree
+
+When auto-tuning is enabled (via the ``kd_auto_tune`` parameter), the
+tree is built with several cost model parameters, and the one that
+traces the rays of measure_traversal() the fastest is kept.
+
+When a build cache is set (see set_cache_dir()), a tree that was
+previously built for the same geometry and parameters is loaded from
+the cache instead, and newly built trees are added to it.)doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_class = R"doc()doc";
 
@@ -7181,13 +9209,28 @@ static const char *__doc_mitsuba_ShapeKDTree_m_primitive_map = R"doc()doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_m_shapes = R"doc()doc";
 
+static const char *__doc_mitsuba_ShapeKDTree_parallel_subtree_threshold =
+R"doc(Return the number of primitives, above which the O(n log n) builder
+constructs the left subtree of a node in a separate task (0 == never
+split the O(n log n) build into tasks).)doc";
+
 static const char *__doc_mitsuba_ShapeKDTree_primitive_count = R"doc(Return the number of registered primitives)doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_ray_intersect_naive = R"doc(Brute force intersection routine for debugging purposes)doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_ray_intersect_preliminary = R"doc()doc";
 
-static const char *__doc_mitsuba_ShapeKDTree_ray_intersect_scalar = R"doc()doc";
+static const char *__doc_mitsuba_ShapeKDTree_ray_intersect_scalar =
+R"doc(Intersect a ray against the kd-tree
+
+When ``Count`` is set, the visited nodes and tested primitives are
+accumulated in ``counters``. Shapes whose mask (see set_shape_mask())
+does not share a bit with ``ray_mask`` are ignored.)doc";
+
+static const char *__doc_mitsuba_ShapeKDTree_set_parallel_subtree_threshold =
+R"doc(Set the number of primitives, above which the O(n log n) builder
+constructs the left subtree of a node in a separate task (0 == never
+split the O(n log n) build into tasks).)doc";
 
 static const char *__doc_mitsuba_ShapeKDTree_shape = R"doc(Return the i-th shape (const version))doc";
 
@@ -7201,6 +9244,13 @@ static const char *__doc_mitsuba_Shape_Shape = R"doc(//! @})doc";
 
 static const char *__doc_mitsuba_Shape_Shape_2 = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_alpha_test =
+R"doc(Evaluate the alpha test of the shape's BSDF (see BSDF::alpha_test())
+at a preliminary intersection with this shape
+
+Returns ``False`` when the intersection should be skipped by the
+traversal, and ``True`` when the BSDF does not perform an alpha test.)doc";
+
 static const char *__doc_mitsuba_Shape_bbox =
 R"doc(Return an axis aligned box that bounds all shape primitives (including
 any transformations that may have been applied to them))doc";
@@ -7339,12 +9389,19 @@ R"doc(Returns whether this shape contains the specified attribute.
 Parameter ``name``:
     Name of the attribute)doc";
 
+static const char *__doc_mitsuba_Shape_has_motion = R"doc(Does the geometry of this shape move during the shutter interval?)doc";
+
 static const char *__doc_mitsuba_Shape_id = R"doc(Return a string identifier)doc";
 
 static const char *__doc_mitsuba_Shape_initialize = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_interior_medium = R"doc(Return the medium that lies on the interior of this shape)doc";
 
+static const char *__doc_mitsuba_Shape_intersection_counter =
+R"doc(Counts the closest-hit ray intersection queries of the scene that
+found this shape (requires the ``MI_STATISTICS`` build option, scalar
+variants only))doc";
+
 static const char *__doc_mitsuba_Shape_is_bspline_curve = R"doc(Is this shape a b-spline curve ?)doc";
 
 static const char *__doc_mitsuba_Shape_is_emitter = R"doc(Is this shape also an area emitter?)doc";
@@ -7373,6 +9430,8 @@ static const char *__doc_mitsuba_Shape_m_id = R"doc()doc";
 
 static const char *__doc_mitsuba_Shape_m_interior_medium = R"doc()doc";
 
+static const char *__doc_mitsuba_Shape_m_intersection_counter = R"doc()doc";
+
 static const char *__doc_mitsuba_Shape_m_is_instance = R"doc(True if the shape is used in a ``ShapeGroup``)doc";
 
 static const char *__doc_mitsuba_Shape_m_optix_data_ptr = R"doc(OptiX hitgroup data buffer)doc";
@@ -7616,6 +9675,14 @@ Parameter ``sample``:
 Returns:
     A PositionSample instance describing the generated sample)doc";
 
+static const char *__doc_mitsuba_Shape_select_lod =
+R"doc(Select the level of detail of the shape for a sensor
+
+The scene invokes this function on all of its shapes before building
+its acceleration data structure, with its first sensor (or ``nullptr``
+if it has none). The default implementation does nothing, instances
+use it to pick one of several shape groups by their projected size.)doc";
+
 static const char *__doc_mitsuba_Shape_sensor = R"doc(Return the area sensor associated with this shape (if any))doc";
 
 static const char *__doc_mitsuba_Shape_sensor_2 = R"doc(Return the area sensor associated with this shape (if any))doc";
@@ -7632,6 +9699,56 @@ The default implementation throws an exception.)doc";
 
 static const char *__doc_mitsuba_Shape_traverse = R"doc()doc";
 
+static const char *__doc_mitsuba_SocketListener =
+R"doc(Listening TCP socket that accepts incoming SocketStream connections
+
+The socket stays open until the listener is closed or destroyed, such
+that a server can accept any number of connections on the same port.
+Pending connections are queued by the operating system in the
+meantime.)doc";
+
+static const char *__doc_mitsuba_SocketListener_SocketListener =
+R"doc(Listen on the given local port
+
+Parameter ``port``:
+    Port to listen on. When set to zero, the operating system picks an
+    unused port, which can be queried via port().
+
+Parameter ``address``:
+    Local address to bind to. The default only accepts connections
+    from the same machine; ``"0.0.0.0"`` or ``"::"`` accept
+    connections on all network interfaces.)doc";
+
+static const char *__doc_mitsuba_SocketListener_accept = R"doc(Wait for the next incoming connection)doc";
+
+static const char *__doc_mitsuba_SocketListener_address = R"doc(Return the local address of the listening socket)doc";
+
+static const char *__doc_mitsuba_SocketListener_close = R"doc(Close the listening socket (idempotent))doc";
+
+static const char *__doc_mitsuba_SocketListener_is_closed = R"doc(Whether the listening socket is closed)doc";
+
+static const char *__doc_mitsuba_SocketListener_port = R"doc(Return the local port of the listening socket)doc";
+
+static const char *__doc_mitsuba_SocketStream =
+R"doc(Stream implementation that reads and writes data over a TCP
+connection.
+
+Connections are either established to a remote host, or accepted on a
+local port via SocketListener::accept(). The stream is not seekable:
+tell() and size() report the number of bytes that were received and
+sent, respectively.
+
+Since both ends of a connection may run on machines with a different
+endianness, the stream uses the network byte order (big endian) by
+default.)doc";
+
+static const char *__doc_mitsuba_SocketStream_SocketStream = R"doc(Connect to the given remote host and port)doc";
+
+static const char *__doc_mitsuba_SocketStream_is_closed =
+R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
+
+static const char *__doc_mitsuba_SocketStream_peer = R"doc(Return a string describing the remote end of the connection)doc";
+
 static const char *__doc_mitsuba_Spectrum =
 R"doc(//! @{ \name Data types for spectral quantities with sampled
 wavelengths)doc";
@@ -7667,45 +9784,91 @@ static const char *__doc_mitsuba_Spiral_Spiral =
 R"doc(Create a new spiral generator for the given size, offset into a larger
 frame, and block size)doc";
 
+static const char *__doc_mitsuba_Spiral_block =
+R"doc(Return the offset, size, and unique identifier of a claimed block)doc";
+
 static const char *__doc_mitsuba_Spiral_block_count = R"doc(Return the total number of blocks)doc";
 
 static const char *__doc_mitsuba_Spiral_class = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_direction = R"doc()doc";
+static const char *__doc_mitsuba_Spiral_compute_block_order = R"doc(Precompute the traversal order of all blocks in a single pass)doc";
+
+static const char *__doc_mitsuba_Spiral_compute_curve_order =
+R"doc(Precompute the order of the blocks along a Hilbert or Morton curve)doc";
 
 static const char *__doc_mitsuba_Spiral_m_block_count = R"doc()doc";
 
+static const char *__doc_mitsuba_Spiral_m_block_order = R"doc()doc";
+
 static const char *__doc_mitsuba_Spiral_m_block_counter = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_m_block_size = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_m_blocks = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_mutex = R"doc()doc";
-
 static const char *__doc_mitsuba_Spiral_m_offset = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_passes_left = R"doc()doc";
+static const char *__doc_mitsuba_Spiral_m_order = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_position = R"doc()doc";
+static const char *__doc_mitsuba_Spiral_m_passes = R"doc()doc";
 
 static const char *__doc_mitsuba_Spiral_m_size = R"doc()doc";
 
-static const char *__doc_mitsuba_Spiral_m_spiral_size = R"doc()doc";
-
-static const char *__doc_mitsuba_Spiral_m_steps_left = R"doc()doc";
-
 static const char *__doc_mitsuba_Spiral_max_block_size = R"doc(Return the maximum block size)doc";
 
 static const char *__doc_mitsuba_Spiral_next_block =
 R"doc(Return the offset, size, and unique identifier of the next block.
 
-A size of zero indicates that the spiral traversal is done.)doc";
+A size of zero indicates that the spiral traversal is done. This
+function is lock-free and can safely be called from multiple threads.)doc";
+
+static const char *__doc_mitsuba_Spiral_next_blocks =
+R"doc(Claim a contiguous run of up to ``count`` blocks
+
+Returns the half-open range of block indices that were claimed, which
+is empty once the traversal is done. The blocks are then looked up via
+block(). This function is lock-free and can safely be called from
+multiple threads.)doc";
+
+static const char *__doc_mitsuba_Spiral_order = R"doc(Return the traversal order of the blocks)doc";
+
+static const char *__doc_mitsuba_Spiral_pass_count = R"doc(Return the total number of passes)doc";
 
 static const char *__doc_mitsuba_Spiral_reset =
 R"doc(Reset the spiral to its initial state. Does not affect the number of
 passes.)doc";
 
+static const char *__doc_mitsuba_StatisticsCounter =
+R"doc(Counter of events on rendering hot paths (ray intersections, BSDF
+calls, texture lookups, ..)
+
+Every thread increments its own copy of the counter with plain loads
+and stores, and value() adds up the copies of all threads (including
+ones that have exited). This keeps atomic read-modify-write operations
+out of the hot paths, at the cost of a value that is only exact once
+the counting threads are idle.
+
+Counting is only enabled when Mitsuba is compiled with the
+``MI_STATISTICS`` CMake option. Otherwise, increment() is a no-op and
+value() always returns zero.)doc";
+
+static const char *__doc_mitsuba_StatisticsCounter_StatisticsCounter = R"doc()doc";
+
+static const char *__doc_mitsuba_StatisticsCounter_StatisticsCounter_2 = R"doc()doc";
+
+static const char *__doc_mitsuba_StatisticsCounter_increment = R"doc(Add ``amount`` to the counter of the calling thread)doc";
+
+static const char *__doc_mitsuba_StatisticsCounter_increment_2 = R"doc()doc";
+
+static const char *__doc_mitsuba_StatisticsCounter_m_id = R"doc()doc";
+
+static const char *__doc_mitsuba_StatisticsCounter_operator_assign = R"doc()doc";
+
+static const char *__doc_mitsuba_StatisticsCounter_reset =
+R"doc(Reset the counter (should not be called while other threads count))doc";
+
+static const char *__doc_mitsuba_StatisticsCounter_value = R"doc(Return the sum of the counters of all threads)doc";
+
 static const char *__doc_mitsuba_Stream =
 R"doc(Abstract seekable stream class
 
@@ -7922,28 +10085,68 @@ This class provides a routine convert() which <ol>
 
 * optionally checks that certain entries have expected default values
 
-* substitutes missing values with specified defaults
+* substitutes missing values with specified defaults
+
+* performs linear transformations of groups of fields (e.g. between
+different RGB color spaces)
+
+* applies dithering to avoid banding artifacts when converting 2D
+images
+
+</ol>
+
+The above operations can be arranged in countless ways, which makes it
+hard to provide an efficient generic implementation of this
+functionality. For this reason, the implementation of this class
+relies on a JIT compiler that generates fast conversion code on demand
+for each specific conversion. The function is cached and reused in
+case the same conversion is needed later on.
+
+JIT compilation only works on x86_64 processors. Other platforms (e.g.
+AArch64), and converters that are created with ``jit=false``, use a
+portable implementation instead. It resolves the fields of both
+records once when the converter is created. Fields that only need to
+be copied are merged into blocks of ``memcpy()`` calls, and 8-bit
+fields that must be converted to floating point are looked up in a
+precomputed table.)doc";
+
+static const char *__doc_mitsuba_StructConverter_CopyStep =
+R"doc(Block of bytes that is copied from the source to the target record)doc";
+
+static const char *__doc_mitsuba_StructConverter_CopyStep_size = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_CopyStep_source_offset = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_CopyStep_target_offset = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FieldStep = R"doc(Precomputed conversion of one field of the target record)doc";
+
+static const char *__doc_mitsuba_StructConverter_FieldStep_Alpha = R"doc(Treatment of premultiplied alpha)doc";
+
+static const char *__doc_mitsuba_StructConverter_FieldStep_Kind = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FieldStep_alpha = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FieldStep_blend = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_FieldStep_kind = R"doc()doc";
 
-* performs linear transformations of groups of fields (e.g. between
-different RGB color spaces)
+static const char *__doc_mitsuba_StructConverter_FieldStep_linearize =
+R"doc(Should the loaded value be converted to linear floating point?)doc";
 
-* applies dithering to avoid banding artifacts when converting 2D
-images
+static const char *__doc_mitsuba_StructConverter_FieldStep_source = R"doc()doc";
 
-</ol>
+static const char *__doc_mitsuba_StructConverter_FieldStep_table = R"doc(Linearized values of all 8-bit source values (may be empty))doc";
 
-The above operations can be arranged in countless ways, which makes it
-hard to provide an efficient generic implementation of this
-functionality. For this reason, the implementation of this class
-relies on a JIT compiler that generates fast conversion code on demand
-for each specific conversion. The function is cached and reused in
-case the same conversion is needed later on. Note that JIT compilation
-only works on x86_64 processors; other platforms use a slow generic
-fallback implementation.)doc";
+static const char *__doc_mitsuba_StructConverter_FieldStep_target = R"doc()doc";
 
 static const char *__doc_mitsuba_StructConverter_StructConverter =
 R"doc(Construct an optimized conversion routine going from ``source`` to
-``target``)doc";
+``target``
+
+Parameter ``jit``:
+    Compile the conversion routine if supported by the platform.
+    Otherwise, the portable implementation is used.)doc";
 
 static const char *__doc_mitsuba_StructConverter_Value = R"doc()doc";
 
@@ -7953,28 +10156,71 @@ static const char *__doc_mitsuba_StructConverter_Value_type = R"doc()doc";
 
 static const char *__doc_mitsuba_StructConverter_class = R"doc()doc";
 
-static const char *__doc_mitsuba_StructConverter_convert = R"doc(Convert ``count`` elements. Returns ``True`` upon success)doc";
+static const char *__doc_mitsuba_StructConverter_compile = R"doc(JIT-compile the conversion routine)doc";
+
+static const char *__doc_mitsuba_StructConverter_convert =
+R"doc(Convert ``count`` elements. Returns ``True`` upon success
+
+Large conversions (at least parallel_threshold() elements) are split
+into blocks that are converted in parallel on the thread pool.)doc";
 
 static const char *__doc_mitsuba_StructConverter_convert_2d = R"doc()doc";
 
+static const char *__doc_mitsuba_StructConverter_convert_2d_portable = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_convert_2d_serial = R"doc(Convert a 2D image on the calling thread)doc";
+
 static const char *__doc_mitsuba_StructConverter_linearize = R"doc()doc";
 
 static const char *__doc_mitsuba_StructConverter_load = R"doc()doc";
 
+static const char *__doc_mitsuba_StructConverter_m_alpha_field = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_m_assert_fields = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_m_copy_records =
+R"doc(Are the records identical, such that whole buffers can be copied?)doc";
+
+static const char *__doc_mitsuba_StructConverter_m_copy_steps = R"doc()doc";
+
 static const char *__doc_mitsuba_StructConverter_m_dither = R"doc()doc";
 
+static const char *__doc_mitsuba_StructConverter_m_field_steps = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_m_func = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_m_has_alpha = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_m_has_multiple_alpha_channels = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_m_has_weight = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_m_parallel_threshold = R"doc()doc";
+
 static const char *__doc_mitsuba_StructConverter_m_source = R"doc()doc";
 
 static const char *__doc_mitsuba_StructConverter_m_target = R"doc()doc";
 
+static const char *__doc_mitsuba_StructConverter_m_weight_field = R"doc()doc";
+
+static const char *__doc_mitsuba_StructConverter_parallel_threshold =
+R"doc(Return the number of elements above which conversions run in parallel)doc";
+
+static const char *__doc_mitsuba_StructConverter_prepare = R"doc(Resolve the fields of the portable conversion routine)doc";
+
 static const char *__doc_mitsuba_StructConverter_save = R"doc()doc";
 
+static const char *__doc_mitsuba_StructConverter_set_parallel_threshold =
+R"doc(Set the number of elements above which conversions run in parallel)doc";
+
 static const char *__doc_mitsuba_StructConverter_source = R"doc(Return the source ``Struct`` descriptor)doc";
 
 static const char *__doc_mitsuba_StructConverter_target = R"doc(Return the target ``Struct`` descriptor)doc";
 
 static const char *__doc_mitsuba_StructConverter_to_string = R"doc(Return a string representation)doc";
 
+static const char *__doc_mitsuba_StructConverter_uses_jit = R"doc(Does this converter use a JIT-compiled conversion routine?)doc";
+
 static const char *__doc_mitsuba_Struct_ByteOrder = R"doc(Byte order of the fields in the ``Struct``)doc";
 
 static const char *__doc_mitsuba_Struct_ByteOrder_BigEndian = R"doc()doc";
@@ -8360,6 +10606,17 @@ Returns:
     Equivalent Mueller matrix that operates in world-space
     coordinates.)doc";
 
+static const char *__doc_mitsuba_SurfaceInteraction_to_world_mueller_stokes =
+R"doc(Applies a Mueller matrix defined in a local frame to a Stokes vector
+defined on world-space directions
+
+Equivalent to ``to_world_mueller(M_local, in_forward_local,
+out_forward_local) * stokes`` for a Stokes vector stored in the first
+column of a Mueller matrix (see mueller::apply_stokes()), but only
+performs matrix-vector products.
+
+This expands to a multiplication in non-polarized modes.)doc";
+
 static const char *__doc_mitsuba_SurfaceInteraction_uv = R"doc(UV surface coordinates)doc";
 
 static const char *__doc_mitsuba_SurfaceInteraction_wi = R"doc(Incident direction in the local shading frame)doc";
@@ -8442,6 +10699,8 @@ static const char *__doc_mitsuba_TShapeKDTree_BuildContext_bad_refines = R"doc()
 
 static const char *__doc_mitsuba_TShapeKDTree_BuildContext_derived = R"doc()doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_BuildContext_empty_volume = R"doc()doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_BuildContext_env = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_BuildContext_exp_leaves_visited = R"doc()doc";
@@ -8452,6 +10711,8 @@ static const char *__doc_mitsuba_TShapeKDTree_BuildContext_exp_traversal_steps =
 
 static const char *__doc_mitsuba_TShapeKDTree_BuildContext_index_storage = R"doc()doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_BuildContext_leaf_count = R"doc()doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_BuildContext_max_depth = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_BuildContext_max_prims_in_leaf = R"doc()doc";
@@ -8698,6 +10959,12 @@ static const char *__doc_mitsuba_TShapeKDTree_bbox = R"doc(Return the bounding b
 
 static const char *__doc_mitsuba_TShapeKDTree_build = R"doc()doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_build_temp_storage =
+R"doc(Return the temporary storage used by the last build in bytes
+
+This includes the chunks of the OrderedChunkAllocator instances and
+the node and index lists before they were compacted.)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_class = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_clip_primitives = R"doc(Return whether primitive clipping is used during tree construction)doc";
@@ -8743,6 +11010,8 @@ static const char *__doc_mitsuba_TShapeKDTree_m_nodes = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_m_retract_bad_splits = R"doc()doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_m_statistics = R"doc()doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_m_stop_primitives = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_max_bad_refines =
@@ -8751,8 +11020,15 @@ before a leaf node will be created.)doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_max_depth = R"doc(Return the maximum tree depth (0 == use heuristic))doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_memory_footprint = R"doc(Return the size of the node and primitive index lists)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_min_max_bins = R"doc(Return the number of bins used for Min-Max binning)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_parallel_subtree_threshold =
+R"doc(Return the number of primitives, above which the O(n log n) builder
+constructs the left subtree of a node in a separate task (0 == never
+split the O(n log n) build into tasks).)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_ready = R"doc()doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_retract_bad_splits = R"doc(Return whether or not bad splits can be "retracted".)doc";
@@ -8774,12 +11050,19 @@ static const char *__doc_mitsuba_TShapeKDTree_set_max_depth = R"doc(Set the maxi
 
 static const char *__doc_mitsuba_TShapeKDTree_set_min_max_bins = R"doc(Set the number of bins used for Min-Max binning)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_set_parallel_subtree_threshold =
+R"doc(Set the number of primitives, above which the O(n log n) builder
+constructs the left subtree of a node in a separate task (0 == never
+split the O(n log n) build into tasks).)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_set_retract_bad_splits = R"doc(Specify whether or not bad splits can be "retracted".)doc";
 
 static const char *__doc_mitsuba_TShapeKDTree_set_stop_primitives =
 R"doc(Set the number of primitives, at which recursion will stop when
 building the tree.)doc";
 
+static const char *__doc_mitsuba_TShapeKDTree_statistics = R"doc(Return the quality statistics of the last build)doc";
+
 static const char *__doc_mitsuba_TShapeKDTree_stop_primitives =
 R"doc(Return the number of primitives, at which recursion will stop when
 building the tree.)doc";
@@ -8893,10 +11176,34 @@ Parameter ``si``:
 Returns:
     An trichromatic intensity or reflectance value)doc";
 
+static const char *__doc_mitsuba_Texture_eval_counter =
+R"doc(Counts the lookups of this texture (requires the ``MI_STATISTICS``
+build option, scalar variants only)
+
+Currently, only the ``bitmap`` texture counts its lookups.)doc";
+
 static const char *__doc_mitsuba_Texture_id = R"doc(Return a string identifier)doc";
 
 static const char *__doc_mitsuba_Texture_is_spatially_varying = R"doc(Does this texture evaluation depend on the UV coordinates)doc";
 
+static const char *__doc_mitsuba_Texture_is_spectrally_varying =
+R"doc(Can eval() return different values for different wavelengths (or color
+channels) of the same interaction?
+
+Media use this to detect a wavelength-independent extinction, which
+allows for a cheaper sampling of the free-flight distance. The default
+implementation conservatively returns ``True``.)doc";
+
+static const char *__doc_mitsuba_Texture_is_uniform =
+R"doc(Does eval() return the same value for every surface interaction and
+wavelength?
+
+The value of a uniform texture can be obtained once by evaluating it
+at an arbitrary interaction, which lets BSDFs skip the per-lookup
+call.)doc";
+
+static const char *__doc_mitsuba_Texture_m_eval_counter = R"doc()doc";
+
 static const char *__doc_mitsuba_Texture_m_id = R"doc()doc";
 
 static const char *__doc_mitsuba_Texture_max =
@@ -8918,6 +11225,14 @@ default implementation throws an exception.
 Even if the operation is provided, it may only return an
 approximation.)doc";
 
+static const char *__doc_mitsuba_Texture_needs_differentials =
+R"doc(Does the texture evaluation use the UV partials (``duv_dx`` and
+``duv_dy``) of the surface interaction, e.g. to filter its contents?
+
+BSDFs set BSDFFlags::NeedsDifferentials when one of their textures
+requires them, so that the partials are computed from the ray
+differentials before the BSDF is evaluated.)doc";
+
 static const char *__doc_mitsuba_Texture_pdf_position = R"doc(Returns the probability per unit area of sample_position())doc";
 
 static const char *__doc_mitsuba_Texture_pdf_spectrum =
@@ -9012,6 +11327,8 @@ static const char *__doc_mitsuba_ThreadEnvironment_m_file_resolver = R"doc()doc"
 
 static const char *__doc_mitsuba_ThreadEnvironment_m_logger = R"doc()doc";
 
+static const char *__doc_mitsuba_ThreadEnvironment_m_profiler_flags = R"doc(Active profiler phases, which are inherited by worker threads)doc";
+
 static const char *__doc_mitsuba_ThreadEnvironment_operator_assign = R"doc()doc";
 
 static const char *__doc_mitsuba_Thread_EPriority = R"doc(Possible priority values for Thread::set_priority())doc";
@@ -9070,6 +11387,10 @@ static const char *__doc_mitsuba_Thread_logger = R"doc(Return the thread's logge
 
 static const char *__doc_mitsuba_Thread_name = R"doc(Return the name of this thread)doc";
 
+static const char *__doc_mitsuba_Thread_numa_aware = R"doc(Is NUMA-aware scheduling of the thread pool enabled?)doc";
+
+static const char *__doc_mitsuba_Thread_numa_node = R"doc(Return the NUMA node that the thread is restricted to (-1 if none))doc";
+
 static const char *__doc_mitsuba_Thread_parent = R"doc(Return the parent thread)doc";
 
 static const char *__doc_mitsuba_Thread_parent_2 = R"doc(Return the parent thread (const version))doc";
@@ -9104,6 +11425,23 @@ static const char *__doc_mitsuba_Thread_set_logger = R"doc(Set the logger instan
 
 static const char *__doc_mitsuba_Thread_set_name = R"doc(Set the name of this thread)doc";
 
+static const char *__doc_mitsuba_Thread_set_numa_aware =
+R"doc(Enable or disable NUMA-aware scheduling of the thread pool
+
+When enabled on a machine with several NUMA nodes, the worker threads
+of the pool are assigned to the nodes in round-robin order and only
+run on the cores of their node. Memory that a worker touches first
+(e.g. its private film buffer) then stays local to its node, and read-
+mostly scene data (acceleration data structures, meshes and textures)
+is interleaved across the nodes via util::numa_interleave(). The
+thread pool is restarted so that the setting applies to all workers.
+Disabled by default.)doc";
+
+static const char *__doc_mitsuba_Thread_set_numa_node =
+R"doc(Restrict the thread to the cores of a NUMA node
+
+Passing -1 removes the restriction. Only supported on Linux.)doc";
+
 static const char *__doc_mitsuba_Thread_set_priority =
 R"doc(Set the thread priority
 
@@ -9127,7 +11465,13 @@ static const char *__doc_mitsuba_Thread_static_shutdown = R"doc(Shut down the th
 
 static const char *__doc_mitsuba_Thread_thread = R"doc(Return the current thread)doc";
 
-static const char *__doc_mitsuba_Thread_thread_count = R"doc(Return the global thread count)doc";
+static const char *__doc_mitsuba_Thread_thread_count =
+R"doc(Return the global thread count
+
+This defaults to util::core_count(), limited by the value of the
+``MI_MAX_THREADS`` environment variable. The same thread pool runs
+Mitsuba's parallel loops, the LLVM kernels of Dr.Jit, the Embree
+builds and the OpenEXR I/O.)doc";
 
 static const char *__doc_mitsuba_Thread_thread_id = R"doc(Return a unique ID that is associated with this thread)doc";
 
@@ -9141,6 +11485,146 @@ static const char *__doc_mitsuba_Thread_wait_for_tasks = R"doc(Wait for previous
 
 static const char *__doc_mitsuba_Thread_yield = R"doc(Yield to another processor)doc";
 
+static const char *__doc_mitsuba_TileCache =
+R"doc(Process-wide cache of the resident tiles of all TiledImage instances
+
+When the memory used by the cached tiles exceeds the budget, the least
+recently loaded or accessed tiles are evicted. Worker threads briefly
+keep handles to a few recently used tiles, so the actual memory usage
+can exceed the budget by a small number of tiles per thread.)doc";
+
+static const char *__doc_mitsuba_TileCache_budget = R"doc(Return the memory budget in bytes)doc";
+
+static const char *__doc_mitsuba_TileCache_clear = R"doc(Evict all tiles)doc";
+
+static const char *__doc_mitsuba_TileCache_load_count = R"doc(Return the number of tiles that were read from page files so far)doc";
+
+static const char *__doc_mitsuba_TileCache_set_budget = R"doc(Set the memory budget in bytes (default: 1 GiB))doc";
+
+static const char *__doc_mitsuba_TileCache_usage = R"doc(Return the memory used by the cached tiles in bytes)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter =
+R"doc(Incrementally write a tiled OpenEXR file
+
+In contrast to Bitmap::write(), which requires the complete image to
+reside in memory, this class creates the file upfront and then accepts
+the image one tile at a time, in any order. This bounds the memory
+needed to produce very large images, since a tile can be released as
+soon as it has been written.
+
+The channel layout of the file is specified by a Struct instance (e.g.
+the one of a bitmap developed from part of the image), and every tile
+passed to write_tile() must use the same layout. The writer is thread-
+safe.)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_TiledEXRWriter =
+R"doc(Create a tiled OpenEXR file
+
+Parameter ``path``:
+    Path of the output file
+
+Parameter ``pixel_format``:
+    Pixel format of the image (used to annotate XYZ images)
+
+Parameter ``struct_``:
+    Channel names and component formats of the image
+
+Parameter ``size``:
+    Size of the complete image in pixels
+
+Parameter ``tile_size``:
+    Size of the square tiles in pixels
+
+Parameter ``compression``:
+    Compression codec of the file)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_TiledEXRWriterPrivate = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_class = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_close =
+R"doc(Finish writing the file. Tiles that were never written remain empty.)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_d = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_m_path = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_m_size = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_m_struct = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_m_tile_size = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_m_tiles_written = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_path = R"doc(Return the path of the output file)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_size = R"doc(Return the size of the complete image in pixels)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_tile_count = R"doc(Return the number of tiles along each axis)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_tile_size = R"doc(Return the size of the square tiles in pixels)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_tiles_written = R"doc(Return the number of tiles written so far)doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_to_string = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledEXRWriter_write_tile =
+R"doc(Write the tile with index ``tile``
+
+The bitmap must match the channel layout of the file, and its size
+must be equal to the tile size (smaller along the right and bottom
+edges of the image).)doc";
+
+static const char *__doc_mitsuba_TiledImage =
+R"doc(Image pyramid that is split into square tiles, which are paged in on
+demand
+
+The constructor copies the pixels of every level into an anonymous
+temporary page file and keeps no image data in memory. Afterwards,
+tiles are read from this file when they are first accessed and stored
+in the TileCache, which is shared by all images and bounded by a
+global memory budget. This is used by the ``bitmap`` texture
+(``tiled=true``) so that scenes can reference more texture data than
+fits into memory, as long as the set of tiles accessed around the same
+time does. The page file is removed automatically when the image is
+destroyed.
+
+The pixels are stored as single precision floating point values, tiles
+at the right and bottom boundary of a level are padded with zeros.)doc";
+
+static const char *__doc_mitsuba_TiledImage_Level = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledImage_TiledImage =
+R"doc(Create a tiled image from a list of levels
+
+Parameter ``levels``:
+    The full resolution image, optionally followed by coarser MIP map
+    levels. All levels must have the same number of channels.
+
+Parameter ``tile_size``:
+    Width and height of a tile in pixels)doc";
+
+static const char *__doc_mitsuba_TiledImage_channel_count = R"doc(Return the number of channels)doc";
+
+static const char *__doc_mitsuba_TiledImage_class = R"doc()doc";
+
+static const char *__doc_mitsuba_TiledImage_fetch =
+R"doc(Copy the channels of pixel ``(x, y)`` of the given level to ``out``
+
+The coordinates must lie within the level. Loads the surrounding tile
+if it isn't resident. Safe to call from multiple threads.)doc";
+
+static const char *__doc_mitsuba_TiledImage_level_count = R"doc(Return the number of levels)doc";
+
+static const char *__doc_mitsuba_TiledImage_load_tile = R"doc(Read a tile from the page file)doc";
+
+static const char *__doc_mitsuba_TiledImage_size = R"doc(Return the resolution of the given level)doc";
+
+static const char *__doc_mitsuba_TiledImage_tile_size = R"doc(Return the width and height of a tile)doc";
+
+static const char *__doc_mitsuba_TiledImage_to_string = R"doc()doc";
+
 static const char *__doc_mitsuba_Timer = R"doc()doc";
 
 static const char *__doc_mitsuba_Timer_Timer = R"doc()doc";
@@ -9155,6 +11639,69 @@ static const char *__doc_mitsuba_Timer_start = R"doc()doc";
 
 static const char *__doc_mitsuba_Timer_value = R"doc()doc";
 
+static const char *__doc_mitsuba_TraceRecorder =
+R"doc(Recorder of timed events in the Chrome trace event format
+
+While the recorder is running, instrumented code reports time spans
+(via ScopedTraceEvent) and values over time (via add_counter()). Scene
+loading is instrumented in this way, i.e. the parsing of XML files,
+the instantiation of every object, the loading of plugins, file I/O,
+the evaluation of JIT kernels after the creation of objects, and the
+construction of acceleration data structures. Sampling integrators
+additionally report their render passes, the image blocks rendered by
+every worker thread, the time spent waiting for the film in
+``put_block()``, and the compilation and launch of JIT kernels.
+
+json() formats the recorded events as a Chrome trace event JSON
+document, which can be opened with Perfetto (https://ui.perfetto.dev)
+or ``chrome://tracing``. Events are grouped by thread, hence the trace
+also shows how well the worker threads are utilized.
+
+Recording is meant for coarse events that take at least a few
+microseconds. While the recorder is not running, the instrumented code
+only checks an atomic flag.)doc";
+
+static const char *__doc_mitsuba_TraceRecorder_add_counter =
+R"doc(Record the current value of a counter (e.g. the number of active
+tasks))doc";
+
+static const char *__doc_mitsuba_TraceRecorder_add_event =
+R"doc(Record a span of time on the calling thread
+
+Parameter ``category``:
+    Category of the event (e.g. ``"io"``)
+
+Parameter ``name``:
+    Name of the event
+
+Parameter ``start``:
+    Start time returned by timestamp()
+
+Parameter ``duration``:
+    Duration in microseconds
+
+Parameter ``args``:
+    Members of the JSON object with the arguments of the event, e.g.
+    ``"bytes": 12`` (optional))doc";
+
+static const char *__doc_mitsuba_TraceRecorder_clear = R"doc(Discard all recorded events)doc";
+
+static const char *__doc_mitsuba_TraceRecorder_event_count = R"doc(Return the number of recorded events)doc";
+
+static const char *__doc_mitsuba_TraceRecorder_json =
+R"doc(Return the recorded events as a Chrome trace event JSON document)doc";
+
+static const char *__doc_mitsuba_TraceRecorder_running = R"doc(Is the recorder currently running?)doc";
+
+static const char *__doc_mitsuba_TraceRecorder_start = R"doc(Discard previously recorded events and start recording)doc";
+
+static const char *__doc_mitsuba_TraceRecorder_stop =
+R"doc(Stop recording. The recorded events remain available to json())doc";
+
+static const char *__doc_mitsuba_TraceRecorder_timestamp = R"doc(Return the time in microseconds since recording was started)doc";
+
+static const char *__doc_mitsuba_TraceRecorder_write = R"doc(Write the recorded events as a Chrome trace event JSON file)doc";
+
 static const char *__doc_mitsuba_Transform =
 R"doc(Encapsulates a 4x4 homogeneous coordinate transformation along with
 its inverse transpose
@@ -9432,6 +11979,12 @@ static const char *__doc_mitsuba_VolumeGrid_size = R"doc(Return the resolution o
 
 static const char *__doc_mitsuba_VolumeGrid_to_string = R"doc(Return a human-readable summary of this volume grid)doc";
 
+static const char *__doc_mitsuba_VolumeGrid_update_max =
+R"doc(Recompute the maximum over the volume grid and per channel from the
+voxel data
+
+The reduction is parallelized over blocks of voxels.)doc";
+
 static const char *__doc_mitsuba_VolumeGrid_write =
 R"doc(Write an encoded form of the bitmap to a binary volume file
 
@@ -9482,6 +12035,12 @@ This interface is specifically intended to encode a variable number of
 parameters. Pointer allocation/deallocation must be performed by the
 caller.)doc";
 
+static const char *__doc_mitsuba_Volume_is_spectrally_varying =
+R"doc(Can eval() return different values for different wavelengths (or color
+channels) at the same point?
+
+The default implementation conservatively returns ``True``.)doc";
+
 static const char *__doc_mitsuba_Volume_m_bbox = R"doc(Bounding box)doc";
 
 static const char *__doc_mitsuba_Volume_m_channel_count = R"doc(Number of channels stored in the volume)doc";
@@ -9506,11 +12065,140 @@ static const char *__doc_mitsuba_Volume_to_string = R"doc(Returns a human-reable
 
 static const char *__doc_mitsuba_Volume_update_bbox = R"doc()doc";
 
+static const char *__doc_mitsuba_WaveletDenoiser =
+R"doc(Edge-avoiding wavelet denoiser that runs on the CPU
+
+This denoiser implements the edge-avoiding *à-trous* wavelet transform
+of "Edge-Avoiding À-Trous Wavelet Transform for fast Global
+Illumination Filtering" by Dammertz et al. It is a counterpart of the
+OptixDenoiser with the same interface that is available in every
+variant and runs multithreaded on the CPU (inputs of GPU variants are
+copied to the host). The noisy image is repeatedly filtered with a 5x5
+B3-spline kernel whose taps are spread twice as far apart in every
+iteration, while the weights of the taps are reduced across edges of
+the color, albedo and shading normal images.
+
+When an albedo is given, the noisy image is divided by it before
+filtering and multiplied by it afterwards, such that textures are
+preserved. As with the OptixDenoiser, these guiding images are best
+obtained with the ``aov`` integrator, and a Film using the ``box``
+ReconstructionFilter gives the best results.)doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_WaveletDenoiser =
+R"doc(Constructs a wavelet denoiser
+
+Parameter ``input_size``:
+    Resolution of noisy images that will be fed to the denoiser.
+
+Parameter ``albedo``:
+    Whether or not albedo information will also be given to the
+    denoiser.
+
+Parameter ``normals``:
+    Whether or not shading normals information will also be given to
+    the denoiser.
+
+Parameter ``iterations``:
+    Number of filtering iterations. The filter footprint is ``4 *
+    2^iterations + 1`` pixels wide.
+
+Parameter ``color_sigma``:
+    Tolerance of the filter to color differences, which are measured
+    on tone mapped colors in [0, 1]. It is halved in every iteration.
+
+Returns:
+    A callable object which will apply the denoiser.)doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_class = R"doc()doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_denoise =
+R"doc(Denoise host-side images of size m_input_size
+
+The ``albedo`` and ``normals`` images have three channels and may be
+``nullptr`` when the denoiser was built without them.)doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_m_albedo = R"doc()doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_m_color_sigma = R"doc()doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_m_input_size = R"doc()doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_m_iterations = R"doc()doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_m_normals = R"doc()doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_operator_call =
+R"doc(Apply denoiser on inputs which are TensorXf objects.
+
+Parameter ``noisy``:
+    The noisy input. (tensor shape: (height, width, 3 | 4))
+
+Parameter ``denoise_alpha``:
+    Whether or not the alpha channel (if specified in the noisy input)
+    should be denoised too. This parameter is optional, by default it
+    is true.
+
+Parameter ``albedo``:
+    Albedo information of the noisy rendering. This parameter is
+    optional unless the denoiser was built with albedo support.
+    (tensor shape: (height, width, 3))
+
+Parameter ``normals``:
+    Shading normal information of the noisy rendering. The filter only
+    compares neighboring normals, hence they can be given in any
+    coordinate frame. This parameter is optional unless the denoiser
+    was built with normals support. (tensor shape: (height, width, 3))
+
+Returns:
+    The denoised input.)doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_operator_call_2 =
+R"doc(Apply denoiser on inputs which are Bitmap objects.
+
+Parameter ``noisy``:
+    The noisy input. When passing additional information like albedo
+    or normals to the denoiser, this Bitmap object must be a
+    MultiChannel bitmap.
+
+Parameter ``denoise_alpha``:
+    Whether or not the alpha channel (if specified in the noisy input)
+    should be denoised too. This parameter is optional, by default it
+    is true.
+
+Parameter ``albedo_ch``:
+    The name of the channel in the ``noisy`` parameter which contains
+    the albedo information of the noisy rendering. This parameter is
+    optional unless the denoiser was built with albedo support.
+
+Parameter ``normals_ch``:
+    The name of the channel in the ``noisy`` parameter which contains
+    the shading normal information of the noisy rendering. This
+    parameter is optional unless the denoiser was built with normals
+    support.
+
+Parameter ``noisy_ch``:
+    The name of the channel in the ``noisy`` parameter which contains
+    the noisy rendering.
+
+Returns:
+    The denoised input.)doc";
+
+static const char *__doc_mitsuba_WaveletDenoiser_to_string = R"doc()doc";
+
 static const char *__doc_mitsuba_ZStream =
 R"doc(Transparent compression/decompression stream based on ``zlib``.
 
 This class transparently decompresses and compresses reads and writes
-to a nested stream, respectively.)doc";
+to a nested stream, respectively.
+
+Small reads and writes are served from internal buffers, such that a
+sequence of small values (e.g. the fields of a file header) does not
+invoke ``zlib`` for each of them. When the child stream is a
+MemoryStream wrapping an external buffer (such as a memory-mapped
+file), the compressed data is directly decompressed from that buffer.
+
+For data that is available as a whole, the static compress() and
+decompress() functions avoid the overheads of streaming altogether.)doc";
 
 static const char *__doc_mitsuba_ZStream_EStreamType = R"doc()doc";
 
@@ -9540,8 +12228,52 @@ read or write operations are permitted.
 This function is idempotent. It is called automatically by the
 destructor.)doc";
 
+static const char *__doc_mitsuba_ZStream_compress =
+R"doc(Compress a buffer in one go
+
+When ``block_size`` is nonzero and smaller than the buffer, the buffer
+is split into blocks of this size that are compressed in parallel.
+Every block is primed with the last 32 KiB of the preceding block, and
+the compressed blocks are joined into a single stream that can be
+decompressed by any ``zlib``-compatible decoder (including this
+class). The result is only marginally larger than that of a sequential
+compression.
+
+Parameter ``data``:
+    Data to be compressed
+
+Parameter ``size``:
+    Size of the data in bytes
+
+Parameter ``stream_type``:
+    Format of the compressed stream
+
+Parameter ``level``:
+    Compression level between 0 and 9, or -1 for the default level
+
+Parameter ``block_size``:
+    Size of the blocks that are compressed in parallel in bytes, or 0
+    to compress the data sequentially)doc";
+
+static const char *__doc_mitsuba_ZStream_decompress =
+R"doc(Decompress a buffer in one go
+
+Throws an exception when the stream is invalid, or when it does not
+decompress to exactly ``dst_size`` bytes.
+
+Returns:
+    The number of consumed bytes of ``src``, which may be followed by
+    unrelated data)doc";
+
+static const char *__doc_mitsuba_ZStream_deflate_data =
+R"doc(Compress data and write it to the child stream using the given flush mode)doc";
+
 static const char *__doc_mitsuba_ZStream_flush = R"doc(Flushes any buffered data)doc";
 
+static const char *__doc_mitsuba_ZStream_inflate_data =
+R"doc(Decompress up to ``size`` bytes. Unless ``partial`` is set, throws an
+exception when the stream ends before producing all of them.)doc";
+
 static const char *__doc_mitsuba_ZStream_is_closed = R"doc(Whether the stream is closed (no read or write are then permitted).)doc";
 
 static const char *__doc_mitsuba_ZStream_m_child_stream = R"doc()doc";
@@ -9556,6 +12288,20 @@ static const char *__doc_mitsuba_ZStream_m_inflate_buffer = R"doc()doc";
 
 static const char *__doc_mitsuba_ZStream_m_inflate_stream = R"doc()doc";
 
+static const char *__doc_mitsuba_ZStream_m_memory_stream =
+R"doc(Child stream, if its external buffer can be decompressed in place)doc";
+
+static const char *__doc_mitsuba_ZStream_m_read_buffer = R"doc(Decompressed data that was not yet returned by read())doc";
+
+static const char *__doc_mitsuba_ZStream_m_read_pos = R"doc()doc";
+
+static const char *__doc_mitsuba_ZStream_m_read_size = R"doc()doc";
+
+static const char *__doc_mitsuba_ZStream_m_write_buffer =
+R"doc(Uncompressed data of small writes that was not yet compressed)doc";
+
+static const char *__doc_mitsuba_ZStream_m_write_size = R"doc()doc";
+
 static const char *__doc_mitsuba_ZStream_read =
 R"doc(Reads a specified amount of data from the stream, decompressing it
 first using ZLib. Throws an exception when the stream ended
@@ -9586,6 +12332,20 @@ Out-of-bounds regions are safely ignored. It is assumed that ``source
 The function supports `T` being a raw pointer or an arbitrary Dr.Jit
 array that can potentially live on the GPU and/or be differentiable.)doc";
 
+static const char *__doc_mitsuba_block_order =
+R"doc(Parse the ``block_order`` parameter of an integrator
+
+Supported values are ``"spiral"``, ``"hilbert"`` and ``"morton"``.)doc";
+
+static const char *__doc_mitsuba_blocked_parallel_for =
+R"doc(Invoke ``func(begin, end)`` on blocks of the range ``[0, count)`` in
+parallel
+
+The blocks contain about ``grain_size`` items and are processed on the
+thread pool. Ranges that fit into a single block are processed on the
+calling thread, which avoids the overhead of scheduling a task for
+small inputs.)doc";
+
 static const char *__doc_mitsuba_bsdf =
 R"doc(Returns the BSDF of the intersected shape.
 
@@ -9747,6 +12507,11 @@ static const char *__doc_mitsuba_detail_OrderedChunkAllocator_used = R"doc(Retur
 
 static const char *__doc_mitsuba_detail_Throw = R"doc()doc";
 
+static const char *__doc_mitsuba_detail_distr_2d_grain_size =
+R"doc(Grain size of the parallel loops (see blocked_parallel_for()) that
+construct large distributions, where each item costs about ``cost``
+operations)doc";
+
 static const char *__doc_mitsuba_detail_get_color_space_tables = R"doc()doc";
 
 static const char *__doc_mitsuba_detail_get_construct_functor = R"doc()doc";
@@ -9903,6 +12668,11 @@ condition is not treated as an error).)doc";
 
 static const char *__doc_mitsuba_filesystem_current_path = R"doc(Returns the current working directory (equivalent to getcwd))doc";
 
+static const char *__doc_mitsuba_filesystem_directory_entries =
+R"doc(Appends the names of the entries of the directory at ``p`` (excluding
+'.' and '..') to ``names``. Returns false if ``p`` could not be opened
+as a directory.)doc";
+
 static const char *__doc_mitsuba_filesystem_equivalent =
 R"doc(Checks whether two paths refer to the same file system object. Both
 must refer to an existing file or directory. Symlinks are followed to
@@ -9921,6 +12691,11 @@ static const char *__doc_mitsuba_filesystem_is_regular_file =
 R"doc(Checks if ``p`` points to a regular file, as opposed to a directory or
 symlink.)doc";
 
+static const char *__doc_mitsuba_filesystem_last_write_time =
+R"doc(Returns the time of the last modification of the file system object
+at ``p`` (in nanoseconds since the epoch). The resolution depends on
+the platform and file system.)doc";
+
 static const char *__doc_mitsuba_filesystem_path =
 R"doc(Represents a path to a filesystem resource. On construction, the path
 is parsed and stored in a system-agnostic representation. The path can
@@ -10027,6 +12802,13 @@ R"doc(Changes the size of the regular file named by ``p`` as if ``truncate``
 was called. If the file was larger than ``target_length``, the
 remainder is discarded. The file must exist.)doc";
 
+static const char *__doc_mitsuba_filesystem_write_atomic =
+R"doc(Atomically creates or replaces the file ``p``. The callback ``write``
+receives the name of a temporary file in the same directory, which is
+then renamed to ``p``. Other processes thus never observe a partially
+written file. If the callback or the rename fails, the temporary file
+is removed and the exception is rethrown.)doc";
+
 static const char *__doc_mitsuba_fill_hitgroup_records = R"doc(Creates and appends the HitGroupSbtRecord for a given list of shapes)doc";
 
 static const char *__doc_mitsuba_fresnel =
@@ -10338,6 +13120,15 @@ R"doc(Constructs the Mueller matrix of an ideal absorber
 Parameter ``value``:
     The amount of absorption.)doc";
 
+static const char *__doc_mitsuba_mueller_apply_stokes =
+R"doc(Apply a Mueller matrix to a Stokes vector
+
+The Stokes vector ``s`` is stored in the first column of a Mueller
+matrix (see above), whose other columns are ignored. Hence, this is
+equivalent to ``M * s`` for such vectors, but only computes the first
+column of the product (16 instead of 64 multiply-adds per spectral
+sample). The other columns of the result are zero.)doc";
+
 static const char *__doc_mitsuba_mueller_depolarizer =
 R"doc(Constructs the Mueller matrix of an ideal depolarizer
 
@@ -10753,6 +13544,14 @@ static const char *__doc_mitsuba_prepare_ias =
 R"doc(Prepares and fills the OptixInstance array associated with a given
 list of shapes.)doc";
 
+static const char *__doc_mitsuba_profiler_flags =
+R"doc(Phases that are currently active on the calling thread
+
+Bit ``i`` is set while the thread is inside of a ScopedPhase of phase
+``i``. Thanks to the partial order of ProfilerPhase, the highest set
+bit identifies the innermost phase, hence this word serves as a compact
+phase stack that the sampling Profiler can read from a signal handler.)doc";
+
 static const char *__doc_mitsuba_quad_chebyshev =
 R"doc(Computes the Chebyshev nodes, i.e. the roots of the Chebyshev
 polynomials of the first kind
@@ -11607,6 +14406,25 @@ Parameter ``c``:
 Returns:
     Coefficients for use with srgb_model_eval)doc";
 
+static const char *__doc_mitsuba_srgb_model_fetch_2 =
+R"doc(Look up the model coefficients for an array of sRGB color values
+
+This function converts ``count`` colors stored as consecutive RGB
+triplets. Large arrays are converted in parallel. The input and output
+may refer to the same memory, in which case the conversion happens in
+place.
+
+Parameter ``rgb``:
+    Pointer to ``3 * count`` color components in [0, 1]
+
+Parameter ``coeff``:
+    Pointer to ``3 * count`` output coefficients
+
+Parameter ``count``:
+    Number of colors)doc";
+
+static const char *__doc_mitsuba_srgb_model_fetch_3 = R"doc(Double precision version of the above function)doc";
+
 static const char *__doc_mitsuba_srgb_model_mean = R"doc()doc";
 
 static const char *__doc_mitsuba_srgb_to_xyz = R"doc(Convert ITU-R Rec. BT.709 linear RGB to XYZ tristimulus values)doc";
@@ -11684,7 +14502,12 @@ the additional information tracked by the Mueller matrix. For instance
 when performing Russian Roulette based on the path throughput or when
 writing a final RGB pixel value to the image block.)doc";
 
-static const char *__doc_mitsuba_util_core_count = R"doc(Determine the number of available CPU cores (including virtual cores))doc";
+static const char *__doc_mitsuba_util_core_count =
+R"doc(Determine the number of available CPU cores (including virtual cores)
+
+On Linux, this accounts for the CPU affinity mask of the process and
+for the CPU quota of its cgroup (e.g. when running inside a
+container).)doc";
 
 static const char *__doc_mitsuba_util_detect_debugger = R"doc(Returns 'true' if the application is running inside a debugger)doc";
 
@@ -11698,6 +14521,21 @@ static const char *__doc_mitsuba_util_library_path = R"doc(Return the absolute p
 
 static const char *__doc_mitsuba_util_mem_string = R"doc(Turn a memory size into a human-readable string)doc";
 
+static const char *__doc_mitsuba_util_numa_interleave =
+R"doc(Spread the pages of a memory region over all NUMA nodes
+
+Memory pages are placed on the NUMA node of the thread that first
+writes them. Read-mostly data that all worker threads access (e.g.
+acceleration data structures and textures) is therefore better
+interleaved across the nodes, such that no single memory controller
+becomes a bottleneck. Pages that are already resident are migrated.
+This function does nothing on machines with a single NUMA node and on
+platforms other than Linux.)doc";
+
+static const char *__doc_mitsuba_util_numa_node_cores = R"doc(Return the logical cores (as numbered by the OS) of the given NUMA node)doc";
+
+static const char *__doc_mitsuba_util_numa_node_count = R"doc(Determine the number of NUMA nodes of the machine (1 if unknown))doc";
+
 static const char *__doc_mitsuba_util_terminal_width = R"doc(Determine the width of the terminal window that is used to run Mitsuba)doc";
 
 static const char *__doc_mitsuba_util_time_string =
@@ -11933,7 +14771,12 @@ Parameter ``update_scene``:
 
 Parameter ``parallel``:
     Whether the loading should be executed on multiple threads in
-    parallel)doc";
+    parallel
+
+Parameter ``skip_unreferenced``:
+    Whether top-level objects of a scene with an explicit ID (e.g.
+    libraries of BSDFs or textures) are skipped when no shape, emitter,
+    sensor, integrator or nested scene references them)doc";
 
 static const char *__doc_mitsuba_xml_load_string = R"doc(Load a Mitsuba scene from an XML string)doc";
 
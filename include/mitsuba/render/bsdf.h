@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/render/interaction.h>
 #include <drjit/vcall.h>
 
@@ -85,6 +86,9 @@ enum class BSDFFlags : uint32_t {
     /// Does the implementation require access to texture-space differentials
     NeedsDifferentials   = 0x20000,
 
+    /// Transmitted light is scattered below the surface (see \ref BSDF::eval_subsurface())
+    Subsurface           = 0x40000,
+
     // =============================================================
     //!                 Compound lobe attributes
     // =============================================================
@@ -491,6 +495,20 @@ public:
         return has_flag(m_flags, BSDFFlags::NeedsDifferentials);
     }
 
+    /**
+     * \brief Return the fields of the surface interaction (as a combination
+     * of \ref RayFlags) that this BSDF reads in addition to the position,
+     * normals and shading frame
+     *
+     * The textures of the BSDF report their needs separately, and the scene
+     * gathers both once for all of its shapes (see \ref Scene::ray_flags()).
+     * The default implementation requests the position partials of
+     * anisotropic BSDFs, whose lobes are aligned with the tangent of the
+     * shading frame, and the UV coordinates and their partials of BSDFs
+     * that need texture differentials.
+     */
+    virtual uint32_t ray_flags() const;
+
     /// Number of components this BSDF is comprised of.
     size_t component_count(Mask /*active*/ = true) const {
         return m_components.size();
@@ -519,6 +537,66 @@ public:
     virtual Spectrum eval_diffuse_reflectance(const SurfaceInteraction3f &si,
                                               Mask active = true) const;
 
+    /**
+     * \brief Evaluate the alpha test of a cutout surface
+     *
+     * Returns \c false where the surface is fully transparent. The ray
+     * tracing backends skip such intersections during the traversal instead
+     * of reporting them, which avoids continuation rays through the cutouts.
+     * This function is only called for BSDFs that enable it (see \ref
+     * has_alpha_test()), and the surface interaction only provides the
+     * position, geometric normal, and UV coordinates.
+     *
+     * The default implementation accepts every intersection.
+     */
+    virtual Mask alpha_test(const SurfaceInteraction3f &si,
+                            Mask active = true) const;
+
+    /// Does \ref alpha_test() reject some intersections with this BSDF?
+    bool has_alpha_test() const { return m_alpha_test; }
+
+    /**
+     * \brief Evaluate the subsurface scattering parameters
+     *
+     * BSDFs with the \ref BSDFFlags::Subsurface flag describe the boundary
+     * of a translucent material. Light that is transmitted by their
+     * \ref BSDFFlags::DeltaTransmission lobe does not continue into the
+     * interior, instead the path tracers sample the position where it leaves
+     * the surface again from a diffusion profile (see the \c path
+     * integrator). This function returns the albedo (the total diffuse
+     * reflectance due to subsurface scattering) and the mean free path of
+     * the interior at the entry point.
+     *
+     * The default implementation returns zero for both.
+     */
+    virtual std::pair<UnpolarizedSpectrum, UnpolarizedSpectrum>
+    eval_subsurface(const SurfaceInteraction3f &si, Mask active = true) const;
+
+    /**
+     * \brief Return a simplified BSDF that produces the same results
+     *
+     * This function is called when the \c simplify_bsdfs parameter of the
+     * scene is enabled. Layers that have no effect given the values of their
+     * parameters at this point (e.g. a blend whose weight is constant and
+     * equal to zero or one, or a fully opaque mask) return their simplified
+     * nested BSDF instead, which removes a level of nested (virtual) function
+     * calls from every evaluation. Other layers simplify their nested BSDFs
+     * in place.
+     *
+     * The default implementation returns the BSDF itself.
+     */
+    virtual ref<BSDF> simplify();
+
+    /**
+     * \brief Counts the evaluations (\ref eval(), \ref pdf() and \ref
+     * eval_pdf()) of this BSDF by the path tracers (requires the \c
+     * MI_STATISTICS build option, scalar variants only)
+     */
+    StatisticsCounter &eval_counter() const { return m_eval_counter; }
+
+    /// Counts the calls of \ref sample(), see \ref eval_counter()
+    StatisticsCounter &sample_counter() const { return m_sample_counter; }
+
     /// Return a human-readable representation of the BSDF
     std::string to_string() const override = 0;
 
@@ -539,8 +617,14 @@ protected:
     /// Flags for each component of this BSDF.
     std::vector<uint32_t> m_components;
 
+    /// Is \ref alpha_test() evaluated during the traversal?
+    bool m_alpha_test;
+
     /// Identifier (if available)
     std::string m_id;
+
+    mutable StatisticsCounter m_eval_counter;
+    mutable StatisticsCounter m_sample_counter;
 };
 
 // -----------------------------------------------------------------------
@@ -600,6 +684,8 @@ DRJIT_VCALL_TEMPLATE_BEGIN(mitsuba::BSDF)
     DRJIT_VCALL_METHOD(eval_pdf)
     DRJIT_VCALL_METHOD(eval_pdf_sample)
     DRJIT_VCALL_METHOD(eval_diffuse_reflectance)
+    DRJIT_VCALL_METHOD(alpha_test)
+    DRJIT_VCALL_METHOD(eval_subsurface)
     DRJIT_VCALL_GETTER(flags, uint32_t)
     auto needs_differentials() const {
         return has_flag(flags(), mitsuba::BSDFFlags::NeedsDifferentials);
@@ -0,0 +1,472 @@
+#pragma once
+
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/vector.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/mesh.h>
+#include <memory>
+
+/// Maximum number of wide BVH levels (bounds the size of the traversal stack)
+#define MI_BVH_MAXDEPTH 64u
+
+/**
+ * Depth, below which the builder only uses object median splits. This
+ * guarantees that the tree depth never exceeds \ref MI_BVH_MAXDEPTH
+ * for primitive counts below 2^32.
+ */
+#define MI_BVH_MEDIAN_DEPTH 32u
+
+/// Number of primitives, above which the SAH binning pass runs in parallel
+#define MI_BVH_PARALLEL_BINNING 65536u
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Compressed node of a wide bounding volume hierarchy
+ *
+ * The bounding boxes of the (up to \c Width) children are stored relative
+ * to the node's lower corner and quantized to 8 bits per coordinate using a
+ * power-of-two step size per axis. Rounding is conservative so that the
+ * decoded boxes always contain the original ones. The coordinates are laid
+ * out in structure-of-arrays form so that all children can be tested
+ * against a ray at once using SIMD instructions.
+ */
+template <typename Float, size_t Width> struct alignas(64) BVHNode {
+    /// Origin of the quantization grid (lower corner of the node bounds)
+    Float origin[3];
+
+    /// Quantization step size per axis (as a power-of-two exponent)
+    int8_t exponent[3];
+
+    /// Number of valid children
+    uint8_t child_count;
+
+    /// Number of primitives of each child (0 == inner node)
+    uint8_t prim_count[Width];
+
+    /// Quantized lower child bounds (one row per axis)
+    uint8_t q_min[3][Width];
+
+    /// Quantized upper child bounds (one row per axis)
+    uint8_t q_max[3][Width];
+
+    /// Node index (inner child) or index of the first primitive (leaf child)
+    uint32_t child[Width];
+
+    /// Return the quantization step size along the given axis
+    MI_INLINE Float scale(size_t axis) const {
+        if constexpr (std::is_same_v<Float, float>)
+            return dr::memcpy_cast<float>(uint32_t(exponent[axis] + 127) << 23);
+        else
+            return dr::memcpy_cast<double>(uint64_t(exponent[axis] + 1023) << 52);
+    }
+};
+
+/**
+ * \brief Wide bounding volume hierarchy over a set of shapes
+ *
+ * This class provides an alternative to \ref ShapeKDTree for the native
+ * (i.e. non-Embree) CPU ray tracing backend. It is selected by setting the
+ * \c accel parameter of the scene to \c "bvh".
+ *
+ * The hierarchy is built top-down using the binned surface area heuristic
+ * (SAH). Each node directly splits into up to 4 or 8 children (\c
+ * bvh_width), which are tested against the ray in a single SIMD operation.
+ * In comparison to the kd-tree, every primitive is referenced exactly once,
+ * which keeps the memory footprint low and makes the build significantly
+ * faster. Large subtrees are constructed in parallel.
+ *
+ * The following construction parameters are taken from the scene's
+ * properties:
+ *
+ * - \c bvh_width: number of children per node (4 or 8, default: 4)
+ * - \c bvh_max_leaf_size: maximum number of primitives per leaf (default: 4)
+ * - \c bvh_bins: number of bins used by the SAH builder (default: 16)
+ * - \c bvh_intersection_cost: relative cost of a primitive intersection
+ *   in the SAH (default: 1)
+ * - \c bvh_traversal_cost: relative cost of a node traversal step in the
+ *   SAH (default: 1)
+ * - \c bvh_parallel_threshold: subtrees with more primitives than this are
+ *   built in a separate task (default: 4096)
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB ShapeBVH : public Object {
+public:
+    MI_IMPORT_TYPES(Shape, Mesh)
+
+    using ScalarRay3f = Ray<ScalarPoint3f, Spectrum>;
+    using Size        = uint32_t;
+    using Index       = uint32_t;
+
+    /// Reference to a primitive of one of the registered shapes
+    struct PrimRef {
+        Index shape_index;
+        Index prim_index;
+    };
+
+    /// Create an empty BVH and take build-related parameters from \c props.
+    ShapeBVH(const Properties &props);
+
+    /// Clear the BVH (build-related parameters remain)
+    void clear();
+
+    /// Register a new shape with the BVH (to be called before \ref build())
+    void add_shape(Shape *shape);
+
+    /// Build the BVH
+    void build();
+
+    /**
+     * \brief Update the bounding boxes of the hierarchy after the geometry of
+     * the registered shapes changed, while keeping its topology
+     *
+     * This is much cheaper than a full rebuild, but the quality of the
+     * hierarchy degrades when the geometry moves significantly. The shapes
+     * must still have the same number of primitives as during the last call
+     * to \ref build().
+     *
+     * \return The SAH cost of the refitted hierarchy relative to the cost
+     * right after the last full build.
+     */
+    ScalarFloat refit();
+
+    /// Has the BVH been built?
+    bool ready() const { return m_node_count > 0; }
+
+    /// Return the number of children per node
+    Size width() const { return m_width; }
+
+    /// Return the number of registered shapes
+    Size shape_count() const { return Size(m_shapes.size()); }
+
+    /// Return the number of registered primitives
+    Size primitive_count() const { return m_primitive_count; }
+
+    /// Return the number of nodes of the hierarchy
+    Size node_count() const { return m_node_count; }
+
+    /// Return the i-th shape (const version)
+    const Shape *shape(size_t i) const { Assert(i < m_shapes.size()); return m_shapes[i]; }
+
+    /// Return the i-th shape
+    Shape *shape(size_t i) { Assert(i < m_shapes.size()); return m_shapes[i]; }
+
+    /// Return the ray mask of the i-th shape
+    uint32_t shape_mask(size_t i) const { Assert(i < m_shape_masks.size()); return m_shape_masks[i]; }
+
+    /**
+     * \brief Set the (nonzero) ray mask of the i-th shape
+     *
+     * The traversal ignores the shape for rays whose mask does not share a
+     * bit with it. Shapes initially have the mask <tt>(uint32_t) -1</tt>.
+     */
+    void set_shape_mask(size_t i, uint32_t mask) {
+        Assert(i < m_shape_masks.size() && mask != 0);
+        m_shape_masks[i] = mask;
+    }
+
+    /// Is the alpha test of the i-th shape evaluated during the traversal?
+    bool shape_alpha_test(size_t i) const { Assert(i < m_shape_alpha_tests.size()); return m_shape_alpha_tests[i]; }
+
+    /**
+     * \brief Enable the alpha test (see \ref Shape::alpha_test()) of the
+     * i-th shape
+     *
+     * The traversal then skips intersections with the shape that fail the
+     * test. The alpha test is only evaluated by the scalar variants.
+     */
+    void set_shape_alpha_test(size_t i, bool value) {
+        Assert(i < m_shape_alpha_tests.size());
+        m_shape_alpha_tests[i] = value;
+    }
+
+    /// Return the bounding box of the entire BVH
+    const ScalarBoundingBox3f &bbox() const { return m_bbox; }
+
+    template <bool ShadowRay>
+    MI_INLINE PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray,
+                                                                   Mask active) const {
+        DRJIT_MARK_USED(active);
+        if constexpr (!dr::is_array_v<Float>)
+            return ray_intersect_scalar<ShadowRay>(ray);
+        else
+            Throw("BVH should only be used in scalar mode");
+    }
+
+    /**
+     * \brief Intersect a ray against the BVH
+     *
+     * Shapes whose mask (see \ref set_shape_mask()) does not share a bit
+     * with \c ray_mask are ignored.
+     */
+    template <bool ShadowRay>
+    MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
+    ray_intersect_scalar(const ScalarRay3f &ray,
+                         uint32_t ray_mask = (uint32_t) -1) const {
+        if (m_width == 8)
+            return traverse<8, ShadowRay>(ray, m_nodes8.get(), ray_mask);
+        else
+            return traverse<4, ShadowRay>(ray, m_nodes4.get(), ray_mask);
+    }
+
+    /// Brute force intersection routine for debugging purposes
+    template <bool ShadowRay>
+    MI_INLINE PreliminaryIntersection3f
+    ray_intersect_naive(Ray3f ray, Mask active) const {
+        if constexpr (!dr::is_array_v<Float>) {
+            PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+
+            for (Size i = 0; i < m_primitive_count; ++i) {
+                PreliminaryIntersection3f prim_pi =
+                    intersect_prim<ShadowRay>(m_prims[i], ray);
+
+                if (prim_pi.is_valid()) {
+                    pi = prim_pi;
+                    ray.maxt = prim_pi.t;
+                    if constexpr (ShadowRay)
+                        break;
+                }
+            }
+
+            DRJIT_MARK_USED(active);
+            return pi;
+        } else {
+            DRJIT_MARK_USED(ray);
+            DRJIT_MARK_USED(active);
+            Throw("BVH should only be used in scalar mode");
+        }
+    }
+
+    /// Return the size of the nodes and primitive references
+    size_t memory_footprint() const override;
+
+    /// Return a human-readable string representation of the scene contents.
+    virtual std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    struct BuildRange;
+    template <size_t Width> struct BuildContext;
+    template <size_t Width> struct RefitContext;
+
+    template <size_t Width> void build_impl();
+    template <size_t Width> ScalarFloat refit_impl();
+
+    /**
+     * \brief Traverse the hierarchy and return the closest intersection
+     * (or any intersection in the case of shadow rays)
+     */
+    template <size_t Width, bool ShadowRay>
+    MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
+    traverse(ScalarRay3f ray, const BVHNode<ScalarFloat, Width> *nodes,
+             uint32_t ray_mask) const {
+        using FloatP = dr::Array<ScalarFloat, Width>;
+        using UInt8P = dr::Array<uint8_t, Width>;
+
+        /// Ray traversal stack entry
+        struct BVHStackEntry {
+            // Ray distance to the entry point of the node
+            ScalarFloat mint;
+            // Index of the node
+            Index node;
+        };
+
+        PreliminaryIntersection<ScalarFloat, Shape> pi;
+        if (unlikely(!nodes))
+            return pi;
+
+        auto [hit, mint, maxt] = m_bbox.ray_intersect(ray);
+        if (!hit || maxt < 0.f || mint > ray.maxt)
+            return pi;
+
+        /* Avoid NaNs in the slab test for axis-aligned rays */
+        ScalarVector3f d_rcp;
+        for (size_t i = 0; i < 3; ++i) {
+            ScalarFloat r = dr::rcp(ray.d[i]);
+            d_rcp[i] = dr::isfinite(r) ? r : dr::copysign(dr::Largest<ScalarFloat>, ray.d[i]);
+        }
+
+        /* Conservative factor that accounts for rounding errors in the slab
+           test (Ize, "Robust BVH Ray Traversal") */
+        const ScalarFloat robust_scale =
+            1.f + 2.f * 3.f * dr::Epsilon<ScalarFloat> /
+                            (1.f - 3.f * dr::Epsilon<ScalarFloat>);
+
+        BVHStackEntry stack[MI_BVH_MAXDEPTH * (Width - 1) + 1];
+        uint32_t stack_size = 0;
+        stack[stack_size++] = { std::max(mint, ScalarFloat(0)), 0 };
+
+        const FloatP lane = dr::arange<FloatP>();
+
+        while (stack_size > 0) {
+            BVHStackEntry entry = stack[--stack_size];
+            if (entry.mint > ray.maxt)
+                continue;
+
+            const BVHNode<ScalarFloat, Width> &node = nodes[entry.node];
+
+            /* Test the ray against all child bounding boxes at once */
+            FloatP t_near = 0.f, t_far = ray.maxt;
+            for (size_t i = 0; i < 3; ++i) {
+                ScalarFloat scale  = node.scale(i),
+                            origin = node.origin[i] - ray.o[i];
+
+                FloatP t0 = dr::fmadd(FloatP(dr::load<UInt8P>(node.q_min[i])), scale, origin) * d_rcp[i],
+                       t1 = dr::fmadd(FloatP(dr::load<UInt8P>(node.q_max[i])), scale, origin) * d_rcp[i];
+
+                t_near = dr::maximum(t_near, dr::minimum(t0, t1));
+                t_far  = dr::minimum(t_far,  dr::maximum(t0, t1));
+            }
+
+            FloatP dist = dr::select(
+                (t_near <= t_far * robust_scale) && (lane < ScalarFloat(node.child_count)),
+                t_near, dr::Infinity<ScalarFloat>);
+
+            /* Intersect leaf children right away and collect inner children
+               sorted by decreasing distance */
+            Index inner_node[Width];
+            ScalarFloat inner_dist[Width];
+            uint32_t inner_count = 0;
+
+            for (size_t i = 0; i < Width; ++i) {
+                ScalarFloat d = dist[i];
+                if (d == dr::Infinity<ScalarFloat>)
+                    continue;
+
+                uint32_t prim_count = node.prim_count[i];
+                if (prim_count > 0) {
+                    Index prim_start = node.child[i],
+                          prim_end   = prim_start + prim_count;
+
+                    for (Index j = prim_start; j < prim_end; ++j) {
+                        PreliminaryIntersection<ScalarFloat, Shape> prim_pi =
+                            intersect_prim<ShadowRay>(m_prims[j], ray, ray_mask);
+
+                        if (unlikely(prim_pi.is_valid())) {
+                            if constexpr (ShadowRay)
+                                return prim_pi;
+
+                            Assert(prim_pi.t >= 0.f && prim_pi.t <= ray.maxt);
+                            pi = prim_pi;
+                            ray.maxt = pi.t;
+                        }
+                    }
+                } else {
+                    uint32_t k = inner_count++;
+                    while (k > 0 && inner_dist[k - 1] < d) {
+                        inner_dist[k] = inner_dist[k - 1];
+                        inner_node[k] = inner_node[k - 1];
+                        --k;
+                    }
+                    inner_dist[k] = d;
+                    inner_node[k] = node.child[i];
+                }
+            }
+
+            /* Push the farthest child first so that the closest one is
+               visited next */
+            for (uint32_t i = 0; i < inner_count; ++i) {
+                if (inner_dist[i] <= ray.maxt)
+                    stack[stack_size++] = { inner_dist[i], inner_node[i] };
+            }
+        }
+
+        return pi;
+    }
+
+    /**
+     * \brief Check whether a primitive is intersected by the given ray.
+     *
+     * In contrast to \ref ShapeKDTree, the shape index is stored alongside
+     * every primitive reference, hence no search is needed to find it.
+     */
+    template <bool ShadowRay = false>
+    MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
+    intersect_prim(const PrimRef &ref, const ScalarRay3f &ray,
+                   uint32_t ray_mask = (uint32_t) -1) const {
+        Index shape_index  = ref.shape_index,
+              prim_index   = ref.prim_index;
+        const Shape *shape = m_shapes[shape_index];
+        const Mesh *mesh   = (const Mesh *) shape;
+
+        PreliminaryIntersection<ScalarFloat, Shape> pi;
+        if (unlikely(!(m_shape_masks[shape_index] & ray_mask)))
+            return pi;
+
+        if constexpr (ShadowRay) {
+            // The alpha test requires the complete intersection record
+            if (unlikely(m_shape_alpha_tests[shape_index])) {
+                pi = intersect_prim<false>(ref, ray, ray_mask);
+                pi.t = dr::select(pi.t != dr::Infinity<ScalarFloat>, 0.f, pi.t);
+                return pi;
+            }
+
+            bool hit;
+            if (shape->is_mesh())
+                hit = mesh->ray_intersect_triangle_scalar(prim_index, ray).first != dr::Infinity<ScalarFloat>;
+            else
+                hit = shape->ray_test_scalar(ray);
+            pi.t = dr::select(hit, 0.f , pi.t);
+        } else {
+            uint32_t inst_index = (uint32_t) -1;
+            if (shape->is_mesh())
+                std::tie(pi.t, pi.prim_uv) = mesh->ray_intersect_triangle_scalar(prim_index, ray);
+            else
+                std::tie(pi.t, pi.prim_uv, inst_index, prim_index) =
+                    shape->ray_intersect_preliminary_scalar(ray);
+            pi.prim_index = prim_index;
+
+            bool hit_inst  = (inst_index != (uint32_t) -1);
+            pi.shape       = hit_inst ? (const Shape *) (size_t) shape_index : shape; // shape_index for LLVM + BVH
+            pi.instance    = hit_inst ? shape : nullptr;
+            pi.shape_index = hit_inst ? inst_index : shape_index;
+
+            if (unlikely(m_shape_alpha_tests[shape_index]) &&
+                pi.t != dr::Infinity<ScalarFloat> && !alpha_test(pi, ray))
+                return PreliminaryIntersection<ScalarFloat, Shape>();
+        }
+
+        return pi;
+    }
+
+    /// Evaluate the alpha test of an intersection with an alpha-tested shape
+    MI_INLINE bool alpha_test(const PreliminaryIntersection<ScalarFloat, Shape> &pi,
+                              const ScalarRay3f &ray) const {
+        if constexpr (!dr::is_jit_v<Float>) {
+            return pi.shape->alpha_test(ray, pi);
+        } else {
+            DRJIT_MARK_USED(pi);
+            DRJIT_MARK_USED(ray);
+            return true;
+        }
+    }
+
+protected:
+    std::vector<ref<Shape>> m_shapes;
+    /// Ray masks of the registered shapes, see \ref set_shape_mask()
+    std::vector<uint32_t> m_shape_masks;
+    /// Alpha tests of the registered shapes, see \ref set_shape_alpha_test()
+    std::vector<bool> m_shape_alpha_tests;
+    std::unique_ptr<PrimRef[]> m_prims;
+    std::unique_ptr<BVHNode<ScalarFloat, 4>[]> m_nodes4;
+    std::unique_ptr<BVHNode<ScalarFloat, 8>[]> m_nodes8;
+    ScalarBoundingBox3f m_bbox;
+    Size m_primitive_count = 0;
+    Size m_node_count = 0;
+    Size m_leaf_count = 0;
+    std::vector<Size> m_shape_prim_count;
+    ScalarFloat m_build_cost = 0.f;
+
+    Size m_width;
+    Size m_max_leaf_size;
+    Size m_bin_count;
+    ScalarFloat m_intersection_cost;
+    ScalarFloat m_traversal_cost;
+    Size m_parallel_threshold;
+};
+
+MI_EXTERN_CLASS(ShapeBVH)
+NAMESPACE_END(mitsuba)
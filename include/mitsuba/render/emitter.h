@@ -32,6 +32,9 @@ enum class EmitterFlags : uint32_t {
     /// The emitter is attached to a surface (e.g. area emitters)
     Surface              = 0x00008,
 
+    /// The emitter samples the emission of a medium (e.g. volume emitters)
+    Volume               = 0x00020,
+
     // =============================================================
     //!                   Other lobe attributes
     // =============================================================
@@ -64,6 +67,34 @@ public:
     /// The emitter's sampling weight.
     ScalarFloat sampling_weight() const { return m_sampling_weight; }
 
+    /**
+     * \brief Return a rough estimate of the total power emitted by this
+     * emitter (e.g. area times radiance for area emitters)
+     *
+     * The scene uses this estimate to choose emitters proportional to their
+     * power when its \c emitter_sampling parameter is set to \c "power" or
+     * \c "light_tree". The estimate of emitters that surround the scene
+     * depends on its bounding sphere. The default implementation returns 1.
+     */
+    virtual ScalarFloat flux_estimate() const;
+
+    /**
+     * \brief Return a cone that bounds the directions into which this
+     * emitter emits light
+     *
+     * Returns the axis of the cone and the cosine of its half-angle. The
+     * \ref LightGrid uses it to skip the regions of the scene that a spot
+     * light does not illuminate. The default implementation returns a cosine
+     * of -1, i.e. light is emitted into all directions.
+     */
+    virtual std::pair<ScalarVector3f, ScalarFloat> emission_cone() const;
+
+    /// Return the flux estimate cached by the last call to \ref update_flux()
+    ScalarFloat flux() const { return m_flux; }
+
+    /// Re-evaluate \ref flux_estimate() and cache its value
+    void update_flux() { m_flux = flux_estimate(); }
+
     /// Flags for all components combined.
     uint32_t flags(dr::mask_t<Float> /*active*/ = true) const { return m_flags; }
 
@@ -92,6 +123,9 @@ protected:
     /// Sampling weight
     ScalarFloat m_sampling_weight;
 
+    /// Cached flux estimate
+    ScalarFloat m_flux = 1.f;
+
     /// True if the emitters's parameters have changed
     bool m_dirty = false;
 };
@@ -117,6 +151,7 @@ DRJIT_VCALL_TEMPLATE_BEGIN(mitsuba::Emitter)
     DRJIT_VCALL_GETTER(shape, const typename Class::Shape *)
     DRJIT_VCALL_GETTER(medium, const typename Class::Medium *)
     DRJIT_VCALL_GETTER(sampling_weight, float)
+    DRJIT_VCALL_GETTER(flux, float)
 DRJIT_VCALL_TEMPLATE_END(mitsuba::Emitter)
 
 //! @}
@@ -34,6 +34,9 @@ enum class FilmFlags : uint32_t {
      * a special treatment of the samples before storing them in the Image Block.
      */
     Special              = 0x4,
+
+    /// The film accumulates per-pixel variance estimates, see \ref Film::variance()
+    Variance             = 0x8,
 };
 
 MI_DECLARE_ENUM_OPERATORS(FilmFlags)
@@ -57,6 +60,20 @@ public:
      */
     virtual size_t prepare(const std::vector<std::string> &aovs) = 0;
 
+    /**
+     * \brief Return the number of channels that \ref prepare() configures
+     * for the given AOVs (without allocating any storage)
+     *
+     * The default implementation assumes RGB, alpha, and weight channels.
+     */
+    virtual size_t channel_count(const std::vector<std::string> &aovs) const;
+
+    /**
+     * \brief Return the memory footprint of the storage that \ref prepare()
+     * allocates for the given AOVs in bytes
+     */
+    virtual size_t storage_footprint(const std::vector<std::string> &aovs) const;
+
     /// Merge an image block into the film. This methods should be thread-safe.
     virtual void put_block(const ImageBlock *block) = 0;
 
@@ -72,6 +89,24 @@ public:
     /// Write the developed contents of the film to a file on disk
     virtual void write(const fs::path &path) const = 0;
 
+    /**
+     * \brief Return the name of the file that \ref write() creates for the
+     * given path
+     *
+     * Films that only support certain file formats replace the extension of
+     * the path. The default implementation returns the path unchanged.
+     */
+    virtual fs::path output_path(const fs::path &path) const;
+
+    /**
+     * \brief Return the estimated variance of the luminance of every pixel
+     *
+     * The result is a tensor of shape <tt>(height, width, 1)</tt>. Only
+     * films with the \ref FilmFlags::Variance flag implement this method,
+     * e.g. to let integrators distribute samples based on the current error.
+     */
+    virtual TensorXf variance() const;
+
     /// dr::schedule() variables that represent the internal film storage
     virtual void schedule_storage() = 0;
 
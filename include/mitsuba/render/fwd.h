@@ -9,17 +9,21 @@ NAMESPACE_BEGIN(mitsuba)
 struct BSDFContext;
 template <typename Float, typename Spectrum> class BSDF;
 template <typename Float, typename Spectrum> class OptixDenoiser;
+template <typename Float, typename Spectrum> class WaveletDenoiser;
 template <typename Float, typename Spectrum> class Emitter;
 template <typename Float, typename Spectrum> class Endpoint;
 template <typename Float, typename Spectrum> class Film;
 template <typename Float, typename Spectrum> class ImageBlock;
 template <typename Float, typename Spectrum> class Integrator;
+template <typename Float, typename Spectrum> class LightGrid;
+template <typename Float, typename Spectrum> class LightTree;
 template <typename Float, typename Spectrum> class SamplingIntegrator;
 template <typename Float, typename Spectrum> class MonteCarloIntegrator;
 template <typename Float, typename Spectrum> class AdjointIntegrator;
 template <typename Float, typename Spectrum> class Medium;
 template <typename Float, typename Spectrum> class Mesh;
 template <typename Float, typename Spectrum> class MicrofacetDistribution;
+template <typename Float, typename Spectrum> class RayBenchmark;
 template <typename Float, typename Spectrum> class ReconstructionFilter;
 template <typename Float, typename Spectrum> class Sampler;
 template <typename Float, typename Spectrum> class Scene;
@@ -29,6 +33,7 @@ template <typename Float, typename Spectrum> class ProjectiveCamera;
 template <typename Float, typename Spectrum> class Shape;
 template <typename Float, typename Spectrum> class ShapeGroup;
 template <typename Float, typename Spectrum> class ShapeKDTree;
+template <typename Float, typename Spectrum> class ShapeBVH;
 template <typename Float, typename Spectrum> class Texture;
 template <typename Float, typename Spectrum> class Volume;
 template <typename Float, typename Spectrum> class VolumeGrid;
@@ -76,13 +81,17 @@ template <typename Float_, typename Spectrum_> struct RenderAliases {
     using Shape                  = mitsuba::Shape<FloatU, SpectrumU>;
     using ShapeGroup             = mitsuba::ShapeGroup<FloatU, SpectrumU>;
     using ShapeKDTree            = mitsuba::ShapeKDTree<FloatU, SpectrumU>;
+    using ShapeBVH               = mitsuba::ShapeBVH<FloatU, SpectrumU>;
     using Mesh                   = mitsuba::Mesh<FloatU, SpectrumU>;
     using Integrator             = mitsuba::Integrator<FloatU, SpectrumU>;
+    using LightGrid              = mitsuba::LightGrid<FloatU, SpectrumU>;
+    using LightTree              = mitsuba::LightTree<FloatU, SpectrumU>;
     using SamplingIntegrator     = mitsuba::SamplingIntegrator<FloatU, SpectrumU>;
     using MonteCarloIntegrator   = mitsuba::MonteCarloIntegrator<FloatU, SpectrumU>;
     using AdjointIntegrator      = mitsuba::AdjointIntegrator<FloatU, SpectrumU>;
     using BSDF                   = mitsuba::BSDF<FloatU, SpectrumU>;
     using OptixDenoiser          = mitsuba::OptixDenoiser<FloatU, SpectrumU>;
+    using WaveletDenoiser        = mitsuba::WaveletDenoiser<FloatU, SpectrumU>;
     using Sensor                 = mitsuba::Sensor<FloatU, SpectrumU>;
     using ProjectiveCamera       = mitsuba::ProjectiveCamera<FloatU, SpectrumU>;
     using Emitter                = mitsuba::Emitter<FloatU, SpectrumU>;
@@ -91,6 +100,7 @@ template <typename Float_, typename Spectrum_> struct RenderAliases {
     using PhaseFunction          = mitsuba::PhaseFunction<FloatU, SpectrumU>;
     using Film                   = mitsuba::Film<FloatU, SpectrumU>;
     using ImageBlock             = mitsuba::ImageBlock<FloatU, SpectrumU>;
+    using RayBenchmark           = mitsuba::RayBenchmark<FloatU, SpectrumU>;
     using ReconstructionFilter   = mitsuba::ReconstructionFilter<FloatU, SpectrumU>;
     using Texture                = mitsuba::Texture<FloatU, SpectrumU>;
     using Volume                 = mitsuba::Volume<FloatU, SpectrumU>;
@@ -163,13 +173,17 @@ template <typename Float_, typename Spectrum_> struct RenderAliases {
     using MicrofacetDistribution = typename RenderAliases::MicrofacetDistribution;                 \
     using Shape                  = typename RenderAliases::Shape;                                  \
     using ShapeKDTree            = typename RenderAliases::ShapeKDTree;                            \
+    using ShapeBVH               = typename RenderAliases::ShapeBVH;                               \
     using Mesh                   = typename RenderAliases::Mesh;                                   \
     using Integrator             = typename RenderAliases::Integrator;                             \
+    using LightGrid              = typename RenderAliases::LightGrid;                              \
+    using LightTree              = typename RenderAliases::LightTree;                              \
     using SamplingIntegrator     = typename RenderAliases::SamplingIntegrator;                     \
     using MonteCarloIntegrator   = typename RenderAliases::MonteCarloIntegrator;                   \
     using AdjointIntegrator      = typename RenderAliases::AdjointIntegrator;                      \
     using BSDF                   = typename RenderAliases::BSDF;                                   \
     using OptixDenoiser          = typename RenderAliases::OptixDenoiser;                          \
+    using WaveletDenoiser        = typename RenderAliases::WaveletDenoiser;                        \
     using Sensor                 = typename RenderAliases::Sensor;                                 \
     using ProjectiveCamera       = typename RenderAliases::ProjectiveCamera;                       \
     using Emitter                = typename RenderAliases::Emitter;                                \
@@ -178,6 +192,7 @@ template <typename Float_, typename Spectrum_> struct RenderAliases {
     using PhaseFunction          = typename RenderAliases::PhaseFunction;                          \
     using Film                   = typename RenderAliases::Film;                                   \
     using ImageBlock             = typename RenderAliases::ImageBlock;                             \
+    using RayBenchmark           = typename RenderAliases::RayBenchmark;                           \
     using ReconstructionFilter   = typename RenderAliases::ReconstructionFilter;                   \
     using Texture                = typename RenderAliases::Texture;                                \
     using Volume                 = typename RenderAliases::Volume;                                 \
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <mitsuba/core/atomic.h>
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/core/vector.h>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Spatio-directional distribution of incident radiance that is
+ * learned online to guide the directions sampled by path tracers
+ *
+ * This class implements the SD-tree of "Practical Path Guiding for Efficient
+ * Light-Transport Simulation" by Müller et al. A binary tree subdivides the
+ * bounding box of the scene (alternating between the x, y and z axes), and
+ * every leaf stores a quadtree over the square of cylindrical coordinates
+ * <tt>((cos(theta) + 1) / 2, phi / (2 pi))</tt>, which maps uniform samples to
+ * uniform directions. The quadtrees are refined adaptively, so that every
+ * node holds at most a fraction of the radiance recorded at the leaf.
+ *
+ * The field is trained in iterations. During an iteration, directions are
+ * sampled from the distribution learned so far while \ref record() gathers
+ * new radiance estimates. \ref refine() then makes these estimates the new
+ * sampling distribution, splits spatial leaves that received many records,
+ * and adapts the quadtrees. Recording only updates atomic counters of a tree
+ * whose structure doesn't change during the iteration, hence \ref sample(),
+ * \ref pdf() and \ref record() are lock-free and may be called from any number
+ * of worker threads. \ref refine() must not run concurrently with them.
+ *
+ * The learned field can be written to a stream and loaded again, e.g. to
+ * reuse it for the following frames of an animation.
+ */
+class MI_EXPORT_LIB GuidingField : public Object {
+public:
+    using Float = float;
+    MI_IMPORT_CORE_TYPES()
+
+    /**
+     * \brief Create an untrained field
+     *
+     * \param bbox
+     *     Region of space covered by the field, points outside are clamped
+     *
+     * \param spatial_threshold
+     *     Number of records that a spatial leaf receives in the first
+     *     iteration before it is split. The threshold grows with the square
+     *     root of the number of samples per pixel, which doubles in every
+     *     training iteration.
+     *
+     * \param directional_threshold
+     *     Fraction of the radiance of a leaf above which a quadtree node is
+     *     subdivided
+     *
+     * \param max_depth
+     *     Maximum depth of the quadtrees
+     */
+    GuidingField(const ScalarBoundingBox3f &bbox,
+                 float spatial_threshold = 12000.f,
+                 float directional_threshold = 0.01f,
+                 uint32_t max_depth = 20);
+
+    /// Load a field that was previously written with \ref write()
+    GuidingField(Stream *stream);
+
+    /// Write the field to a stream
+    void write(Stream *stream) const;
+
+    /**
+     * \brief Sample a direction from the distribution learned at \c p
+     *
+     * \return The sampled direction and its density per unit solid angle.
+     * Directions are distributed uniformly over the sphere if nothing was
+     * learned at \c p yet.
+     */
+    std::pair<ScalarVector3f, float> sample(const ScalarPoint3f &p,
+                                            const ScalarPoint2f &sample) const;
+
+    /// Evaluate the density per unit solid angle of \ref sample()
+    float pdf(const ScalarPoint3f &p, const ScalarVector3f &d) const;
+
+    /**
+     * \brief Record an estimate of the radiance arriving at \c p from
+     * direction \c d
+     *
+     * The estimate should be divided by the density of sampling \c d.
+     * Invalid and negative values are ignored.
+     */
+    void record(const ScalarPoint3f &p, const ScalarVector3f &d,
+                float value) const;
+
+    /// Finish the current training iteration (see the class description)
+    void refine();
+
+    /// Return the number of completed training iterations
+    uint32_t iteration() const { return m_iteration; }
+
+    /// Has the field completed at least one training iteration?
+    bool trained() const { return m_iteration > 0; }
+
+    /// Return the region of space covered by the field
+    const ScalarBoundingBox3f &bbox() const { return m_bbox; }
+
+    /// Return the number of spatial leaves
+    size_t leaf_count() const { return m_leaves.size(); }
+
+    /// Return the total number of quadtree nodes used for sampling
+    size_t node_count() const;
+
+    /// Return the memory footprint of the field in bytes
+    size_t nbytes() const;
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+
+protected:
+    virtual ~GuidingField() = default;
+
+    /// Node of a directional quadtree, children are numbered <tt>x + 2 y</tt>
+    struct QuadNode {
+        mutable AtomicFloat<float> sum[4];
+        /// Indices of the child nodes (zero if the quadrant isn't subdivided)
+        uint32_t child[4];
+
+        QuadNode();
+        QuadNode(const QuadNode &node);
+        QuadNode &operator=(const QuadNode &node);
+
+        float total() const;
+    };
+
+    /// Directional quadtree over the square of cylindrical coordinates
+    struct DTree {
+        std::vector<QuadNode> nodes;
+        /// Number of records
+        mutable AtomicFloat<float> weight;
+
+        DTree();
+        DTree(const DTree &tree);
+        DTree &operator=(const DTree &tree);
+
+        float pdf(ScalarPoint2f u) const;
+        ScalarPoint2f sample(ScalarPoint2f sample) const;
+        void record(ScalarPoint2f u, float value) const;
+        /// Adapt the structure to the radiance recorded in \c tree and clear it
+        void build(const DTree &tree, float threshold, uint32_t max_depth);
+    };
+
+    /// Spatial leaf: the distribution used for sampling and the one being recorded
+    struct Leaf {
+        DTree sampling, building;
+    };
+
+    /// Node of the spatial binary tree
+    struct SpatialNode {
+        /// Index of the first child node (zero for leaves)
+        uint32_t child;
+        /// Index into \ref m_leaves (leaves only)
+        uint32_t leaf;
+        /// Split axis (for leaves, the axis along which they are split next)
+        uint32_t axis;
+    };
+
+    /// Find the leaf containing \c p
+    uint32_t lookup(const ScalarPoint3f &p) const;
+
+    /// Recursively split the leaves below \c node that have too many records
+    void split(uint32_t node, float threshold, uint32_t depth);
+
+protected:
+    ScalarBoundingBox3f m_bbox;
+    float m_spatial_threshold;
+    float m_directional_threshold;
+    uint32_t m_max_depth;
+    uint32_t m_iteration;
+    std::vector<SpatialNode> m_nodes;
+    std::vector<Leaf> m_leaves;
+};
+
+NAMESPACE_END(mitsuba)
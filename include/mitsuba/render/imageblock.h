@@ -197,11 +197,14 @@ public:
         else
             rgb = spec_u;
 
-        Float values[5] = { rgb.x(), rgb.y(), rgb.z(), 0, 0 };
+        Float values[6] = { rgb.x(), rgb.y(), rgb.z(), 0, 0, 0 };
 
-        if (m_channel_count == 4) {
+        // The second moment channel is computed by put()
+        uint32_t channel_count = m_channel_count - (uint32_t) m_second_moment;
+
+        if (channel_count == 4) {
             values[3] = weight;
-        } else if (m_channel_count == 5) {
+        } else if (channel_count == 5) {
             values[3] = alpha;
             values[4] = weight;
         } else {
@@ -254,7 +257,10 @@ public:
      * This corresponds to the offset from the top-left corner of a larger
      * image (e.g. a Film) to the top-left corner of this ImageBlock instance.
      */
-    void set_offset(const ScalarPoint2i &offset) { m_offset = offset; }
+    void set_offset(const ScalarPoint2i &offset) {
+        flush_deferred();
+        m_offset = offset;
+    }
 
     /// Set the block size. This potentially destroys the block's content.
     void set_size(const ScalarVector2u &size);
@@ -301,6 +307,41 @@ public:
     /// Use Kahan-style error-compensated floating point accumulation?
     bool compensate() const { return m_compensate; }
 
+    /**
+     * \brief Defer calls to \ref put() and accumulate them in batches
+     *
+     * When enabled, \ref put() merely records the sample position and
+     * channel values. Once enough samples have been recorded, or when the
+     * block contents are accessed, the recorded samples are sorted by image
+     * tile and accumulated in a single pass with coherent memory accesses.
+     * This is useful for methods like particle tracing that splat samples
+     * to random image positions.
+     *
+     * Only scalar variants defer samples. In JIT variants, this setting has
+     * no effect. Disabled by default.
+     */
+    void set_deferred(bool value);
+
+    /// Defer calls to \ref put() and accumulate them in batches?
+    bool deferred() const { return m_deferred; }
+
+    /**
+     * \brief Accumulate the second moment of the sample luminance
+     *
+     * When enabled, \ref put() ignores the value that is provided for the
+     * last channel and instead accumulates the squared luminance of the
+     * first three (RGB) channels of each sample. Together with the color
+     * and weight channels, this provides a per-pixel variance estimate.
+     * Disabled by default.
+     */
+    void set_second_moment(bool value);
+
+    /// Accumulate the second moment of the sample luminance in the last channel?
+    bool second_moment() const { return m_second_moment; }
+
+    /// Accumulate all samples recorded by deferred calls to \ref put()
+    void flush_deferred();
+
     /// Return the number of channels stored by the image block
     uint32_t channel_count() const { return m_channel_count; }
 
@@ -322,6 +363,9 @@ public:
     //! @}
     // =============================================================
 
+    /// Return the size of the image tensor (and the compensation terms)
+    size_t memory_footprint() const override;
+
     std::string to_string() const override;
 
     MI_DECLARE_CLASS()
@@ -344,6 +388,10 @@ protected:
     bool m_compensate;
     bool m_warn_negative;
     bool m_warn_invalid;
+    bool m_deferred = false;
+    bool m_second_moment = false;
+    std::vector<ScalarPoint2f> m_deferred_pos;
+    std::vector<ScalarFloat> m_deferred_values;
 };
 
 MI_EXTERN_CLASS(ImageBlock)
@@ -4,6 +4,7 @@
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/vector.h>
@@ -13,7 +14,10 @@
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/shape.h>
+#include <mitsuba/render/spiral.h>
 #include <mitsuba/render/medium.h>
+#include <functional>
+#include <map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -92,9 +96,60 @@ public:
                     bool develop = true,
                     bool evaluate = true);
 
+    /**
+     * \brief Render the scene from the viewpoints of several sensors
+     *
+     * This function is equivalent to calling \ref render() for every element
+     * of \c sensors and returns one tensor per sensor (empty tensors when
+     * <tt>develop=false</tt>). Integrators may process all sensors in the
+     * same rendering job, which avoids the overheads of many small jobs, e.g.
+     * when rendering a turntable sequence: a single parallel loop and
+     * progress bar in scalar variants, and a single wavefront (and thus a
+     * single kernel launch) in JIT variants. The default implementation
+     * renders the sensors one after another.
+     *
+     * The remaining parameters have the same meaning as in \ref render().
+     */
+    virtual std::vector<TensorXf> render_sensors(Scene *scene,
+                                                 const std::vector<Sensor *> &sensors,
+                                                 uint32_t seed = 0,
+                                                 uint32_t spp = 0,
+                                                 bool develop = true,
+                                                 bool evaluate = true);
+
     /// \brief Cancel a running render job (e.g. after receiving Ctrl-C)
     virtual void cancel();
 
+    /**
+     * \brief Callback invoked by the render jobs of \ref SamplingIntegrator
+     * after every pass
+     *
+     * Its arguments are the number of passes that were completed and the
+     * total number of passes. When it is called, the film of the sensor holds
+     * the samples of all completed passes and can e.g. be developed to stream
+     * the partial result. Returning \c false cancels the render job, which
+     * then stops without rendering further passes.
+     */
+    using PassCallback = std::function<bool(uint32_t, uint32_t)>;
+
+    /// Set the callback invoked after every rendering pass (or clear it)
+    void set_pass_callback(const PassCallback &callback) {
+        m_pass_callback = callback;
+    }
+
+    /// Return the callback invoked after every rendering pass
+    const PassCallback &pass_callback() const { return m_pass_callback; }
+
+    /**
+     * \brief Return the number of samples per pixel rendered by every pass of
+     * the current (or last) render job
+     *
+     * This accounts for passes that were split further to fit into the
+     * device memory, such that the pass callback can determine how many
+     * samples the film holds.
+     */
+    uint32_t pass_sample_count() const { return m_pass_sample_count; }
+
     /**
      * Indicates whether \ref cancel() or a timeout have occurred. Should be
      * checked regularly in the integrator's main loop so that timeouts are
@@ -115,6 +170,22 @@ public:
      */
     virtual std::vector<std::string> aov_names() const;
 
+    /**
+     * \brief Estimate the memory in bytes that \ref render() allocates to
+     * render the given sensor, in addition to the scene itself
+     *
+     * This can be used to decide whether a render job fits into the memory of
+     * a machine before it is started (see \ref Scene::predicted_peak_memory()).
+     * The default implementation accounts for the film storage and the
+     * developed image.
+     *
+     * \param spp
+     *    Optional parameter to override the number of samples per pixel of
+     *    the sensor's sampler (as in \ref render()).
+     */
+    virtual size_t render_memory_footprint(const Sensor *sensor,
+                                           uint32_t spp = 0) const;
+
     MI_DECLARE_CLASS()
 protected:
     /// Create an integrator
@@ -139,6 +210,12 @@ protected:
 
     /// Flag for disabling direct visibility of emitters
     bool m_hide_emitters;
+
+    /// Callback invoked after every rendering pass
+    PassCallback m_pass_callback;
+
+    /// Samples per pixel of every pass of the current render job
+    uint32_t m_pass_sample_count;
 };
 
 /** \brief Abstract integrator that performs Monte Carlo sampling starting from
@@ -155,7 +232,8 @@ template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB SamplingIntegrator : public Integrator<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(Integrator, should_stop, aov_names,
-                    m_stop, m_timeout, m_render_timer, m_hide_emitters)
+                    m_stop, m_timeout, m_render_timer, m_hide_emitters,
+                    m_pass_callback)
     MI_IMPORT_TYPES(Scene, Sensor, Film, ImageBlock, Medium, Sampler)
 
     /**
@@ -215,6 +293,37 @@ public:
                     bool develop = true,
                     bool evaluate = true) override;
 
+    /**
+     * \brief Render the scene from the viewpoints of several sensors
+     *
+     * In scalar variants, the image blocks of all sensors are distributed
+     * over the worker threads by a single parallel loop. Every sensor keeps
+     * its own sampler, sample count, and film.
+     *
+     * In JIT variants, the samples of all sensors form a single wavefront that
+     * draws its random numbers from the sampler of the first sensor. This
+     * requires the sensors to use the same sample count, medium, and film
+     * type (channels and flags). Otherwise, and when adaptive sampling is
+     * enabled, the sensors are rendered one after another.
+     */
+    std::vector<TensorXf> render_sensors(Scene *scene,
+                                         const std::vector<Sensor *> &sensors,
+                                         uint32_t seed = 0,
+                                         uint32_t spp = 0,
+                                         bool develop = true,
+                                         bool evaluate = true) override;
+
+    /**
+     * \brief Estimate the memory in bytes that \ref render() allocates to
+     * render the given sensor, in addition to the scene itself
+     *
+     * On top of the film storage, this includes the per-thread image blocks
+     * of scalar variants, and the wavefront state of JIT variants, which
+     * grows with the number of samples per pass.
+     */
+    size_t render_memory_footprint(const Sensor *sensor,
+                                   uint32_t spp = 0) const override;
+
     //! @}
     // =========================================================================
 
@@ -231,7 +340,8 @@ protected:
                               uint32_t sample_count,
                               uint32_t seed,
                               uint32_t block_id,
-                              uint32_t block_size) const;
+                              uint32_t block_size,
+                              uint32_t sample_offset) const;
 
     void render_sample(const Scene *scene,
                        const Sensor *sensor,
@@ -242,18 +352,290 @@ protected:
                        ScalarFloat diff_scale_factor,
                        Mask active = true) const;
 
+    /**
+     * \brief Sample the camera ray of a sample at the pixel \c pos (first
+     * half of \ref render_sample())
+     *
+     * Returns the ray, its importance weight and the position of the sample
+     * on the film.
+     */
+    std::tuple<RayDifferential3f, Spectrum, Vector2f>
+    sample_camera_ray(const Sensor *sensor,
+                      Sampler *sampler,
+                      const Vector2f &pos,
+                      ScalarFloat diff_scale_factor,
+                      Mask active = true) const;
+
+    /**
+     * \brief Estimate the radiance along a camera ray and splat it into
+     * \c block (second half of \ref render_sample())
+     */
+    void render_ray(const Scene *scene,
+                    const Sensor *sensor,
+                    Sampler *sampler,
+                    ImageBlock *block,
+                    Float *aovs,
+                    const Vector2f &pos,
+                    const Vector2f &sample_pos,
+                    const RayDifferential3f &ray,
+                    const Spectrum &ray_weight,
+                    Mask active = true) const;
+
+    /**
+     * \brief Variant of \ref render_sample() that handles a wavefront
+     * containing the samples of several sensors (JIT variants)
+     *
+     * Lane \c i belongs to sensor \c j when <tt>masks[j][i]</tt> is set and
+     * is splatted into <tt>blocks[j]</tt>. The films of all sensors must
+     * have the same flags.
+     */
+    void render_sample(const Scene *scene,
+                       const std::vector<Sensor *> &sensors,
+                       const std::vector<Mask> &masks,
+                       Sampler *sampler,
+                       const std::vector<ref<ImageBlock>> &blocks,
+                       Float *aovs,
+                       const Vector2f &pos,
+                       ScalarFloat diff_scale_factor) const;
+
+    /**
+     * \brief Total number of passes that fit into \ref m_time_budget
+     *
+     * Called after \c done passes, the last of which took \c pass_time
+     * seconds. The result never exceeds \c n_passes and includes the passes
+     * that were already rendered.
+     */
+    uint32_t time_budget_passes(uint32_t done, uint32_t n_passes,
+                                ScalarFloat pass_time) const;
+
+    /**
+     * \brief Minimum number of adaptive sampling passes of the pixels
+     * centered at \c pos (in film coordinates) due to the defocus blur of
+     * the sensor
+     *
+     * See \ref m_adaptive_defocus for details.
+     */
+    Float defocus_min_passes(const Scene *scene, const Sensor *sensor,
+                             const Vector2f &pos) const;
+
+    /**
+     * \brief Number of samples per pixel of a pass whose wavefront fits into
+     * the device memory budget (JIT variants)
+     *
+     * Returns the largest divisor of \c spp that does not exceed \c
+     * spp_per_pass and whose wavefront over \c pixel_count pixels fits into
+     * the budget (see \ref m_memory_fraction). When the wavefront may not fit
+     * and the memory per sample is unknown, a calibration wavefront of \c
+     * sensor is rendered first, and the device memory it allocates is
+     * recorded in \ref m_measured_sample_memory.
+     */
+    uint32_t memory_limited_spp(const Scene *scene, const Sensor *sensor,
+                                size_t pixel_count, uint32_t spp,
+                                uint32_t spp_per_pass);
+
+    /// Render a calibration wavefront and return the device memory per sample
+    size_t calibrate_sample_memory(const Scene *scene, const Sensor *sensor);
+
+    /**
+     * \brief Return the primary intersection of a camera ray
+     *
+     * Integrators may call this function instead of tracing the camera ray
+     * passed to \ref sample(). While the primary hit cache is active (see
+     * \ref m_cache_primary), the first call of a render job traces the ray
+     * and records the intersection, and later passes return the recorded
+     * intersection instead of tracing the ray again.
+     */
+    PreliminaryIntersection3f primary_intersection(const Scene *scene,
+                                                   const Ray3f &ray,
+                                                   Mask active = true) const;
+
+    /**
+     * \brief Does \ref primary_intersection() return recorded intersections?
+     *
+     * This is the case while the primary hit cache is active (JIT variants),
+     * and while \ref render_block() shades the samples of a ray packet (see
+     * \ref m_packet_size).
+     */
+    bool primary_cache_active() const;
+
+    /**
+     * \brief Does \ref sample() obtain the intersection of the camera ray
+     * via \ref primary_intersection()?
+     *
+     * The packet mode of \ref render_block() is only used by integrators
+     * that return \c true, since others would trace the camera rays again.
+     */
+    virtual bool uses_primary_intersection() const { return false; }
+
 protected:
 
     /// Size of (square) image blocks to render in parallel (in scalar mode)
     uint32_t m_block_size;
 
+    /**
+     * \brief Order in which the image blocks are rendered (in scalar mode)
+     *
+     * Set via the \c block_order parameter (\c "spiral", \c "hilbert" or
+     * \c "morton", see \ref BlockOrder). Every worker renders contiguous
+     * runs of blocks along this order. The Hilbert and Morton curves keep
+     * those runs compact, which improves the reuse of the acceleration data
+     * structure and textures in the caches of the worker.
+     */
+    BlockOrder m_block_order;
+
+    /**
+     * \brief Number of neighboring pixels whose camera rays are traced
+     * together (in scalar mode).
+     *
+     * When larger than one, \ref render_block() processes the pixels of a
+     * block in groups of this size along the Morton curve. Every pixel of a
+     * group keeps its own sampler, and the camera rays of a sample index are
+     * traced as a packet (see \ref Scene::ray_intersect_preliminary_packet())
+     * before the samples are shaded one by one. The images thus match those
+     * of the default mode up to the order in which samples are accumulated.
+     * Must be a power of two up to 16 and is only used by integrators whose
+     * \ref uses_primary_intersection() returns \c true. Disabled (one) by
+     * default.
+     */
+    uint32_t m_packet_size;
+
     /**
      * \brief Number of samples to compute for each pass over the image blocks.
      *
      * Must be a multiple of the total sample count per pixel.
      * If set to (uint32_t) -1, all the work is done in a single pass (default).
+     * CPU variants then still split the samples of films with fewer image
+     * blocks than threads (e.g. radiance meters) into passes, which are
+     * rendered in parallel.
      */
     uint32_t m_samples_per_pass;
+
+    /**
+     * \brief Target relative error of the adaptive sampling mode.
+     *
+     * When positive, the image is partitioned into tiles of size \ref
+     * m_block_size (or \c MI_BLOCK_SIZE if unspecified). After every pass,
+     * the relative standard error of each pixel is estimated from the
+     * variance of its per-pass estimates, and tiles whose average error is
+     * below this threshold receive no further samples. Requires \ref
+     * m_samples_per_pass to be set. Disabled (zero) by default.
+     */
+    ScalarFloat m_adaptive_threshold;
+
+    /// Number of passes that every tile receives before it may be retired
+    uint32_t m_adaptive_min_passes;
+
+    /**
+     * \brief Increase of the minimum pass count of defocused tiles.
+     *
+     * When positive, a pre-pass traces one ray through the center of every
+     * pixel and the aperture, and the minimum number of passes of every pixel
+     * becomes <tt>m_adaptive_min_passes * (1 + m_adaptive_defocus * r)</tt>,
+     * where \c r is the circle of confusion (in pixels) of the visible
+     * surface (see \ref Sensor::circle_of_confusion()). Tiles use the
+     * average over their pixels. The variance between a few passes
+     * underestimates the error of strongly blurred regions, which hence
+     * receive more passes before they may be retired. Disabled (zero) by
+     * default.
+     */
+    ScalarFloat m_adaptive_defocus;
+
+    /**
+     * \brief Wall-clock budget of a render job in seconds.
+     *
+     * When positive, the first pass calibrates the rendering throughput, and
+     * only as many passes as fit into the budget are rendered. Unlike \ref
+     * m_timeout, all pixels receive the same number of samples, which is
+     * bounded by the sample count of the sampler. Requires \ref
+     * m_samples_per_pass to be set. Disabled (zero) by default.
+     */
+    ScalarFloat m_time_budget;
+
+    /**
+     * \brief Fraction of the free device memory that the wavefront of a pass
+     * may occupy (CUDA variants).
+     *
+     * When \ref m_samples_per_pass is unspecified, the samples per pixel are
+     * split into as few passes as needed for the wavefront of every pass to
+     * fit into this fraction of the free memory of the device. Without this,
+     * large films with many samples per pixel run out of memory long before
+     * reaching the limit of 2^32 samples per pass. Zero disables the split.
+     * Defaults to 0.8.
+     */
+    ScalarFloat m_memory_fraction;
+
+    /**
+     * \brief Memory budget of the wavefront of a pass in bytes.
+     *
+     * Replaces the fraction of the free device memory (\ref
+     * m_memory_fraction) when nonzero. This also enables the split in the
+     * LLVM variants. Zero by default.
+     */
+    size_t m_memory_budget;
+
+    /**
+     * \brief Memory per sample of the wavefront in bytes.
+     *
+     * When zero (the default), the larger of a rough estimate of the path
+     * state and the value measured by a calibration wavefront is used.
+     */
+    size_t m_sample_memory;
+
+    /// Memory per sample measured by \ref calibrate_sample_memory()
+    size_t m_measured_sample_memory = 0;
+
+    /**
+     * \brief Reuse the primary intersections across passes (JIT variants).
+     *
+     * When rendering several passes with a sensor that has neither an
+     * aperture nor a shutter interval, and with a box filter, the first pass
+     * records the primary intersections of its wavefront, and later passes
+     * only trace the subsequent bounces. To this end, every pass places the
+     * samples of a pixel at the same stratified subpixel positions, hence
+     * the antialiasing is limited to the samples of a single pass. Set via
+     * the \c cache_primary parameter and only used by integrators that call
+     * \ref primary_intersection(). Disabled by default.
+     */
+    bool m_cache_primary;
+
+    /// State of the primary hit cache during a render job
+    struct PrimaryHitCache {
+        /// Is the cache used by the current render job?
+        bool active = false;
+        /// Were the intersections recorded by the first pass?
+        bool valid = false;
+        /// Stratified subpixel positions of the lanes of the wavefront
+        Point2f offset;
+        /// Primary intersections of the lanes of the wavefront
+        PreliminaryIntersection3f pi;
+    };
+
+    /// Primary hit cache, see \ref m_cache_primary
+    mutable PrimaryHitCache m_primary_cache;
+};
+
+/// Sampling events counted by \ref MonteCarloIntegrator::event_counts()
+enum class MonteCarloEvent : uint32_t {
+    /// Paths terminated by Russian roulette
+    RussianRoulette,
+
+    /// Emitter samples of next event estimation
+    EmitterSample,
+
+    /// Emitter samples whose shadow ray was occluded
+    EmitterSampleOccluded,
+
+    /// Emitter samples without contribution (zero density or radiance)
+    EmitterSampleZero,
+
+    /// Real scattering events in participating media
+    MediumInteraction,
+
+    /// Null collisions in participating media, including those along shadow rays
+    NullCollision,
+
+    /// Number of event kinds
+    Count
 };
 
 /** \brief Abstract integrator that performs *recursive* Monte Carlo sampling
@@ -270,6 +652,39 @@ class MI_EXPORT_LIB MonteCarloIntegrator
 public:
     MI_IMPORT_BASE(SamplingIntegrator)
 
+    /// Number of bins of \ref path_length_histogram()
+    static constexpr uint32_t PathLengthBins = 64;
+
+    /**
+     * \brief Return how many of the paths traced so far had a given number of
+     * bounces
+     *
+     * Bin \c i counts the paths with \c i bounces, and the last bin also
+     * counts longer paths. Only the \c path integrator in the scalar variants
+     * records path lengths, and only when Mitsuba is compiled with the \c
+     * MI_STATISTICS build option.
+     */
+    std::vector<uint64_t> path_length_histogram() const;
+
+    /// Reset the counts of \ref path_length_histogram()
+    void reset_path_length_histogram();
+
+    /**
+     * \brief Return how often the sampling events of \ref MonteCarloEvent
+     * occurred so far, indexed by name
+     *
+     * The names are \c rr_terminations, \c emitter_samples, \c
+     * emitter_samples_occluded, \c emitter_samples_zero, \c
+     * medium_interactions and \c null_collisions. Like \ref
+     * path_length_histogram(), the events are only counted by the \c path and
+     * \c volpath integrators in the scalar variants when Mitsuba is compiled
+     * with the \c MI_STATISTICS build option.
+     */
+    std::map<std::string, uint64_t> event_counts() const;
+
+    /// Reset \ref path_length_histogram() and \ref event_counts()
+    void reset_statistics();
+
 protected:
     /// Create an integrator
     MonteCarloIntegrator(const Properties &props);
@@ -277,10 +692,22 @@ protected:
     /// Virtual destructor
     virtual ~MonteCarloIntegrator();
 
+    /// Record a path with \c depth bounces in \ref path_length_histogram()
+    void record_path_length(uint32_t depth) const {
+        m_path_lengths[std::min(depth, PathLengthBins - 1)].increment();
+    }
+
+    /// Record \c amount occurrences of a sampling event in \ref event_counts()
+    void record_event(MonteCarloEvent event, uint64_t amount = 1) const {
+        m_events[(uint32_t) event].increment(amount);
+    }
+
     MI_DECLARE_CLASS()
 protected:
     uint32_t m_max_depth;
     uint32_t m_rr_depth;
+    StatisticsCounter m_path_lengths[PathLengthBins];
+    StatisticsCounter m_events[(uint32_t) MonteCarloEvent::Count];
 };
 
 /** \brief Abstract adjoint integrator that performs Monte Carlo sampling
@@ -299,7 +726,7 @@ template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB AdjointIntegrator : public Integrator<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(Integrator, should_stop, aov_names, m_stop, m_timeout,
-                    m_render_timer, m_hide_emitters)
+                    m_render_timer, m_hide_emitters, m_pass_callback)
     MI_IMPORT_TYPES(Scene, Sensor, Film, BSDF, BSDFPtr, ImageBlock, Sampler,
                      EmitterPtr)
 
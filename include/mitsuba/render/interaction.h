@@ -406,6 +406,44 @@ struct SurfaceInteraction : Interaction<Float_, Spectrum_> {
         }
     }
 
+    /**
+     * \brief Applies a Mueller matrix defined in a local frame to a Stokes
+     * vector defined on world-space directions
+     *
+     * Equivalent to <tt>to_world_mueller(M_local, in_forward_local,
+     * out_forward_local) * stokes</tt> for a Stokes vector stored in the
+     * first column of a Mueller matrix (see \ref mueller::apply_stokes()),
+     * but only performs matrix-vector products.
+     *
+     * This expands to a multiplication in non-polarized modes.
+     */
+    Spectrum to_world_mueller_stokes(const Spectrum &M_local,
+                                     const Vector3f &in_forward_local,
+                                     const Vector3f &out_forward_local,
+                                     const Spectrum &stokes) const {
+        if constexpr (is_polarized_v<Spectrum>) {
+            Vector3f in_forward_world  = to_world(in_forward_local),
+                     out_forward_world = to_world(out_forward_local);
+
+            Vector3f in_basis_current = to_world(mueller::stokes_basis(in_forward_local)),
+                     in_basis_target  = mueller::stokes_basis(in_forward_world);
+
+            Vector3f out_basis_current = to_world(mueller::stokes_basis(out_forward_local)),
+                     out_basis_target  = mueller::stokes_basis(out_forward_world);
+
+            Spectrum R_in  = mueller::rotate_stokes_basis(in_forward_world, in_basis_current, in_basis_target),
+                     R_out = mueller::rotate_stokes_basis(out_forward_world, out_basis_current, out_basis_target);
+
+            Spectrum s = mueller::apply_stokes(dr::transpose(R_in), stokes);
+            s = mueller::apply_stokes(M_local, s);
+            return mueller::apply_stokes(R_out, s);
+        } else {
+            DRJIT_MARK_USED(in_forward_local);
+            DRJIT_MARK_USED(out_forward_local);
+            return M_local * stokes;
+        }
+    }
+
     /**
      * \brief Converts a Mueller matrix defined in world space to a local frame
      *
@@ -5,11 +5,13 @@
 
 #include <nanothread/nanothread.h>
 #include <mitsuba/core/bbox.h>
+#include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/math.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/ray.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
@@ -305,6 +307,115 @@ private:
 };
 NAMESPACE_END(detail)
 
+/**
+ * \brief Quality statistics of a kd-tree, which are gathered by \ref
+ * TShapeKDTree::build()
+ *
+ * The expected number of traversal steps, leaf visits and primitive visits
+ * per query are computed from the cost model (e.g. the surface areas of the
+ * nodes relative to the root), hence they describe a query that is
+ * distributed according to the cost model rather than an actual workload. See
+ * \ref ShapeKDTree::measure_traversal() for measurements on sampled rays.
+ */
+struct MI_EXPORT_LIB KDTreeStatistics {
+    /**
+     * \brief Number of stored nodes. This can exceed the number of reachable
+     * inner and leaf nodes, since retracted splits leave unused nodes behind.
+     */
+    size_t node_count = 0;
+
+    /// Number of reachable inner nodes
+    size_t inner_node_count = 0;
+
+    /// Number of reachable leaf nodes
+    size_t leaf_count = 0;
+
+    /// Number of leaf nodes without primitives
+    size_t empty_leaf_count = 0;
+
+    /// Number of primitive references stored in the leaves
+    size_t index_count = 0;
+
+    /// Depth of the deepest leaf
+    uint32_t max_depth = 0;
+
+    /// Number of primitives of the largest leaf
+    uint32_t max_leaf_size = 0;
+
+    /// Cost of the tree according to the cost model of the build
+    double sah_cost = 0.0;
+
+    /// Expected number of inner nodes traversed per query
+    double expected_traversal_steps = 0.0;
+
+    /// Expected number of leaves visited per query
+    double expected_leaf_visits = 0.0;
+
+    /// Expected number of primitives tested per query
+    double expected_primitive_visits = 0.0;
+
+    /// Fraction of the volume of the tree covered by empty leaves
+    double empty_space_ratio = 0.0;
+
+    /**
+     * \brief Number of leaves per primitive count. The last entry counts
+     * all leaves with at least <tt>leaf_size_histogram.size() - 1</tt>
+     * primitives.
+     */
+    std::vector<size_t> leaf_size_histogram;
+
+    /// Number of inner nodes per depth
+    std::vector<size_t> depth_inner_nodes;
+
+    /// Number of leaf nodes per depth
+    std::vector<size_t> depth_leaf_nodes;
+
+    /// Number of primitive references per depth
+    std::vector<size_t> depth_primitives;
+
+    /// Time taken by the build in seconds (excluding the compaction)
+    double build_time = 0.0;
+
+    std::string to_string() const;
+};
+
+/// Counters of a kd-tree traversal, see \ref ShapeKDTree::measure_traversal()
+struct KDTraversalCounters {
+    size_t inner_nodes = 0;
+    size_t leaves = 0;
+    size_t primitives = 0;
+};
+
+/// Traversal cost of a kd-tree measured by \ref ShapeKDTree::measure_traversal()
+struct MI_EXPORT_LIB KDTraversalStatistics {
+    /// Number of traced rays
+    size_t ray_count = 0;
+
+    /// Number of rays that hit a primitive
+    size_t hit_count = 0;
+
+    /// Average number of inner nodes traversed per ray
+    double inner_nodes_per_ray = 0.0;
+
+    /// Average number of (non-empty) leaves visited per ray
+    double leaves_per_ray = 0.0;
+
+    /// Average number of primitive intersection tests per ray
+    double primitives_per_ray = 0.0;
+
+    /// Time taken to trace all rays in seconds (best of several passes)
+    double time = 0.0;
+
+    std::string to_string() const;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const KDTreeStatistics &s) {
+    return os << s.to_string();
+}
+
+inline std::ostream &operator<<(std::ostream &os, const KDTraversalStatistics &s) {
+    return os << s.to_string();
+}
 
 /**
  * \brief Optimized KD-tree acceleration data structure for n-dimensional
@@ -458,6 +569,22 @@ public:
         m_exact_prim_threshold = value;
     }
 
+    /**
+     * \brief Return the number of primitives, above which the O(n log n)
+     * builder constructs the left subtree of a node in a separate task
+     * (0 == never split the O(n log n) build into tasks).
+     */
+    Size parallel_subtree_threshold() const { return m_parallel_subtree_threshold; }
+
+    /**
+     * \brief Set the number of primitives, above which the O(n log n)
+     * builder constructs the left subtree of a node in a separate task
+     * (0 == never split the O(n log n) build into tasks).
+     */
+    void set_parallel_subtree_threshold(Size value) {
+        m_parallel_subtree_threshold = value;
+    }
+
     /// Return the log level of kd-tree status messages
     LogLevel log_level() const { return m_log_level; }
 
@@ -469,6 +596,22 @@ public:
     /// Return the bounding box of the entire kd-tree
     const BoundingBox bbox() const { return m_bbox; }
 
+    /// Return the size of the node and primitive index lists
+    size_t memory_footprint() const override {
+        return m_node_count * sizeof(KDNode) + m_index_count * sizeof(Index);
+    }
+
+    /**
+     * \brief Return the temporary storage used by the last build in bytes
+     *
+     * This includes the chunks of the \ref OrderedChunkAllocator instances
+     * and the node and index lists before they were compacted.
+     */
+    size_t build_temp_storage() const { return m_build_temp_storage; }
+
+    /// Return the quality statistics of the last build
+    const KDTreeStatistics &statistics() const { return m_statistics; }
+
     const Derived& derived() const { return (Derived&) *this; }
     Derived& derived() { return (Derived&) *this; }
 
@@ -663,6 +806,22 @@ protected:
 
     struct BuildContext;
 
+    /**
+     * \brief Edge event arena owned by a subtree task of the O(N log N) builder
+     *
+     * The \ref OrderedChunkAllocator requires memory to be released in the
+     * order in which it was allocated, which does not hold when subtrees are
+     * built concurrently. Each subtree task therefore allocates its edge
+     * events from a dedicated arena that is discarded when the task is done.
+     */
+    struct SubtreeArena {
+        detail::OrderedChunkAllocator left_alloc;
+        detail::OrderedChunkAllocator right_alloc;
+
+        SubtreeArena(size_t min_allocation)
+            : left_alloc(min_allocation), right_alloc(min_allocation) { }
+    };
+
     /// Helper data structure used during tree construction (used by a single thread)
     struct LocalBuildContext {
         ClassificationStorage classification_storage;
@@ -691,13 +850,20 @@ protected:
         std::atomic<size_t> pruned {0};
         std::atomic<size_t> temp_storage {0};
         std::atomic<size_t> work_units {0};
+        std::atomic<size_t> subtree_tasks {0};
         double exp_traversal_steps = 0;
         double exp_leaves_visited = 0;
         double exp_primitives_queried = 0;
         Size max_prims_in_leaf = 0;
         Size nonempty_leaf_count = 0;
+        Size leaf_count = 0;
         Size max_depth = 0;
+        double empty_volume = 0;
         Size prim_buckets[16] { };
+        /* Per-level statistics of the final tree */
+        Size level_inner[MI_KD_MAXDEPTH + 1] { };
+        Size level_leaves[MI_KD_MAXDEPTH + 1] { };
+        size_t level_prims[MI_KD_MAXDEPTH + 1] { };
 
         BuildContext(const Derived &derived) : derived(derived) { }
     };
@@ -1250,7 +1416,10 @@ protected:
         Scalar build_nlogn(Index node, Size prim_count,
                            EdgeEvent *events_start, EdgeEvent *events_end,
                            const BoundingBox &bbox, Size depth,
-                           Size bad_refines, bool left_child = true) {
+                           Size bad_refines,
+                           detail::OrderedChunkAllocator &left_alloc,
+                           detail::OrderedChunkAllocator &right_alloc,
+                           bool left_child = true) {
             const Derived &derived = m_ctx.derived;
 
             /* Initialize the tree cost model */
@@ -1446,9 +1615,6 @@ protected:
 
             Size pruned_left = 0, pruned_right = 0;
 
-            auto &left_alloc  = m_local.left_alloc;
-            auto &right_alloc = m_local.right_alloc;
-
             EdgeEvent *left_events_start, *right_events_start,
                       *left_events_end, *right_events_end;
 
@@ -1636,15 +1802,39 @@ protected:
                       "to store overly large offset to left child node (%i)",
                       left_offset);
 
-            Scalar left_cost =
-                build_nlogn(children, best.left_count - pruned_left,
-                            left_events_start, left_events_end, left_bbox,
-                            depth + 1, bad_refines, true);
+            Size left_prims  = best.left_count - pruned_left,
+                 right_prims = best.right_count - pruned_right,
+                 subtree_threshold = derived.parallel_subtree_threshold();
 
-            Scalar right_cost =
-                build_nlogn(children + 1, best.right_count - pruned_right,
-                            right_events_start, right_events_end, right_bbox,
-                            depth + 1, bad_refines, false);
+            Scalar left_cost = 0.f, right_cost = 0.f;
+
+            if (subtree_threshold > 0 && left_prims > subtree_threshold &&
+                right_prims > subtree_threshold) {
+                /* Both subtrees are large: build the left one in a separate
+                   task while this thread takes care of the right one */
+                Task *left_dr_task = dr::do_async([&]() {
+                    left_cost = build_nlogn_subtree(
+                        children, left_prims, left_events_start,
+                        left_events_end, left_bbox, depth + 1, bad_refines);
+                });
+
+                right_cost =
+                    build_nlogn(children + 1, right_prims, right_events_start,
+                                right_events_end, right_bbox, depth + 1,
+                                bad_refines, left_alloc, right_alloc, false);
+
+                task_wait_and_release(left_dr_task);
+            } else {
+                left_cost =
+                    build_nlogn(children, left_prims, left_events_start,
+                                left_events_end, left_bbox, depth + 1,
+                                bad_refines, left_alloc, right_alloc, true);
+
+                right_cost =
+                    build_nlogn(children + 1, right_prims, right_events_start,
+                                right_events_end, right_bbox, depth + 1,
+                                bad_refines, left_alloc, right_alloc, false);
+            }
 
             /* Release the index lists not needed by the children anymore */
             if (left_child)
@@ -1680,6 +1870,50 @@ protected:
             return final_cost;
         }
 
+        /**
+         * \brief Build a subtree of the O(N log N) builder within a separate
+         * task, using a private edge event arena.
+         *
+         * The provided event list is owned by the parent and remains valid
+         * until the task completes, but it is copied into the arena since the
+         * builder partitions the event list of a left child in place.
+         */
+        Scalar build_nlogn_subtree(Index node, Size prim_count,
+                                   const EdgeEvent *events_start,
+                                   const EdgeEvent *events_end,
+                                   const BoundingBox &bbox, Size depth,
+                                   Size bad_refines) {
+            ScopedSetThreadEnvironment env(m_ctx.env);
+            m_ctx.subtree_tasks++;
+
+            /* The classification storage is only used between two recursive
+               calls, hence it is safe to share it with other tasks running on
+               the same thread */
+            m_local.classification_storage.resize(m_ctx.derived.primitive_count());
+            m_local.ctx = &m_ctx;
+
+            size_t event_count = (size_t) (events_end - events_start);
+
+            /* Each level of the subtree requires at most one additional copy
+               of the event list on each side, use this as a hint for the
+               initial chunk size */
+            SubtreeArena arena(std::max(
+                event_count * sizeof(EdgeEvent) * 4, (size_t) 64 * 1024));
+
+            EdgeEvent *events =
+                arena.left_alloc.template allocate<EdgeEvent>(event_count);
+            std::copy(events_start, events_end, events);
+
+            Scalar cost = build_nlogn(node, prim_count, events,
+                                      events + event_count, bbox, depth,
+                                      bad_refines, arena.left_alloc,
+                                      arena.right_alloc, true);
+
+            m_ctx.temp_storage += arena.left_alloc.size() + arena.right_alloc.size();
+
+            return cost;
+        }
+
         /// Create an initial sorted edge event list and start the O(N log N) builder
         Scalar transition_to_nlogn() {
             const auto &derived = m_ctx.derived;
@@ -1736,7 +1970,8 @@ protected:
             m_local.ctx = &m_ctx;
 
             Scalar cost = build_nlogn(m_node, final_prim_count, events_start,
-                                      events_end, m_bbox, m_depth, 0);
+                                      events_end, m_bbox, m_depth, 0,
+                                      m_local.left_alloc, m_local.right_alloc);
 
             m_local.left_alloc.release(events_start);
 
@@ -1801,6 +2036,9 @@ protected:
 
         if (node->leaf()) {
             auto prim_count = node->primitive_count();
+            ctx.level_leaves[depth]++;
+            ctx.level_prims[depth] += prim_count;
+            ctx.leaf_count++;
             double value = (double) CostModel::eval(bbox);
 
             ctx.exp_leaves_visited += value;
@@ -1811,8 +2049,11 @@ protected:
                 ctx.max_prims_in_leaf = prim_count;
             if (prim_count > 0)
                 ctx.nonempty_leaf_count++;
+            else
+                ctx.empty_volume += (double) bbox.volume();
         } else {
             ctx.exp_traversal_steps += (double) CostModel::eval(bbox);
+            ctx.level_inner[depth]++;
 
             Index axis = node->axis();
             Scalar split = Scalar(node->split());
@@ -1850,6 +2091,8 @@ protected:
         Log(m_log_level, "   Min-max bins             : %i", m_min_max_bins);
         Log(m_log_level, "   O(n log n) method        : use for <= %i primitives",
             m_exact_prim_threshold);
+        Log(m_log_level, "   Parallel subtrees        : use for > %i primitives",
+            m_parallel_subtree_threshold);
         Log(m_log_level, "   Stopping primitive count : %i", m_stop_primitives);
         Log(m_log_level, "   Perfect splits           : %s",
             m_clip_primitives ? "yes" : "no");
@@ -1872,6 +2115,7 @@ protected:
         /*                      Build the tree in parallel                      */
         /* ==================================================================== */
 
+        Timer timer;
         Scalar final_cost = 0;
         if (prim_count == 0) {
             Log(Warn, "kd-tree contains no geometry!");
@@ -1891,6 +2135,8 @@ protected:
             task.execute();
         }
 
+        float build_time = timer.reset();
+
         Log(m_log_level, "Structural kd-tree statistics:");
 
         /* ==================================================================== */
@@ -1899,6 +2145,9 @@ protected:
 
         m_node_count  = (Index) ctx.node_storage.size();
         m_index_count = (Index) ctx.index_storage.size();
+        m_build_temp_storage = ctx.temp_storage +
+                               m_node_count * sizeof(KDNode) +
+                               m_index_count * sizeof(Index);
 
         m_indices.reset(new Index[m_index_count]);
         dr::parallel_for(
@@ -1920,6 +2169,14 @@ protected:
         );
         ctx.node_storage.release();
 
+        // The tree is read by all render workers, spread it over the NUMA nodes
+        if (Thread::numa_aware()) {
+            util::numa_interleave(m_nodes.get(), m_node_count * sizeof(KDNode));
+            util::numa_interleave(m_indices.get(), m_index_count * sizeof(Index));
+        }
+
+        float compaction_time = timer.value();
+
         /* Slightly avoid the bounding box to avoid numerical issues
            involving geometry that exactly lies on the boundary */
         Vector extra = (m_bbox.extents() + 1.f) * dr::Epsilon<Scalar>;
@@ -1930,18 +2187,47 @@ protected:
         /*         Print various tree statistics if requested by the user       */
         /* ==================================================================== */
 
-        if (Thread::thread()->logger()->log_level() <= m_log_level) {
-            compute_statistics(ctx, m_nodes.get(), m_bbox, 0);
+        compute_statistics(ctx, m_nodes.get(), m_bbox, 0);
+
+        double root_value  = (double) CostModel::eval(m_bbox),
+               root_volume = (double) m_bbox.volume();
+        if (root_value > 0.0) {
+            ctx.exp_traversal_steps /= root_value;
+            ctx.exp_leaves_visited /= root_value;
+            ctx.exp_primitives_queried /= root_value;
+        }
 
-            // Trigger per-thread data release
-            // ctx.local.clear(); // TODO is this necessary?
+        KDTreeStatistics &stats = m_statistics;
+        stats = KDTreeStatistics();
+        stats.node_count = m_node_count;
+        stats.leaf_count = ctx.leaf_count;
+        stats.empty_leaf_count = ctx.leaf_count - ctx.nonempty_leaf_count;
+        stats.index_count = m_index_count;
+        stats.max_depth = ctx.max_depth;
+        stats.max_leaf_size = ctx.max_prims_in_leaf;
+        stats.sah_cost = (double) final_cost;
+        stats.expected_traversal_steps = ctx.exp_traversal_steps;
+        stats.expected_leaf_visits = ctx.exp_leaves_visited;
+        stats.expected_primitive_visits = ctx.exp_primitives_queried;
+        stats.empty_space_ratio =
+            root_volume > 0.0 ? ctx.empty_volume / root_volume : 0.0;
+        stats.build_time = build_time / 1000.0;
+
+        size_t bucketed = 0;
+        for (Size count : ctx.prim_buckets) {
+            stats.leaf_size_histogram.push_back(count);
+            bucketed += count;
+        }
+        stats.leaf_size_histogram.push_back(ctx.leaf_count - bucketed);
 
-            ctx.exp_traversal_steps /= (double) CostModel::eval(m_bbox);
-            ctx.exp_leaves_visited /= (double) CostModel::eval(m_bbox);
-            ctx.exp_primitives_queried /= (double) CostModel::eval(m_bbox);
-            ctx.temp_storage += ctx.node_storage.size() * sizeof(KDNode);
-            ctx.temp_storage += ctx.index_storage.size() * sizeof(Index);
+        for (Size i = 0; i <= ctx.max_depth; ++i) {
+            stats.inner_node_count += ctx.level_inner[i];
+            stats.depth_inner_nodes.push_back(ctx.level_inner[i]);
+            stats.depth_leaf_nodes.push_back(ctx.level_leaves[i]);
+            stats.depth_primitives.push_back(ctx.level_prims[i]);
+        }
 
+        if (Thread::thread()->logger()->log_level() <= m_log_level) {
             Log(m_log_level, "   Primitive references        : %i (%s)",
                 m_index_count, util::mem_string(m_index_count * sizeof(Index)));
 
@@ -1952,11 +2238,18 @@ protected:
                 ctx.max_depth);
 
             Log(m_log_level, "   Temporary storage used      : %s",
-                util::mem_string(ctx.temp_storage));
+                util::mem_string(m_build_temp_storage));
 
             Log(m_log_level, "   Parallel work units         : %i",
                 ctx.work_units);
 
+            Log(m_log_level, "   Parallel O(n log n) subtrees: %i",
+                ctx.subtree_tasks);
+
+            Log(m_log_level, "   Build time                  : %s (+ %s compaction, %i threads)",
+                util::time_string(build_time), util::time_string(compaction_time),
+                Thread::thread_count());
+
             std::ostringstream oss;
             Size prim_bucket_count = sizeof(ctx.prim_buckets) / sizeof(Size);
             oss << "   Leaf node histogram         : ";
@@ -1971,6 +2264,13 @@ protected:
             Log(m_log_level, "%s", oss.str().c_str());
             Log(m_log_level, "");
 
+            Log(m_log_level, "Per-level kd-tree statistics:");
+            Log(m_log_level, "   Depth   Inner nodes   Leaf nodes   Prim. references");
+            for (Size i = 0; i <= ctx.max_depth; ++i)
+                Log(m_log_level, "   %5i   %11i   %10i   %16i", i,
+                    ctx.level_inner[i], ctx.level_leaves[i], ctx.level_prims[i]);
+            Log(m_log_level, "");
+
             Log(m_log_level, "Qualitative kd-tree statistics:");
             Log(m_log_level, "   Retracted splits            : %i",
                 ctx.retracted_splits);
@@ -1978,6 +2278,8 @@ protected:
                 ctx.bad_refines);
             Log(m_log_level, "   Pruned                      : %i",
                 ctx.pruned);
+            Log(m_log_level, "   Empty space                 : %.2f%%",
+                stats.empty_space_ratio * 100.0);
             Log(m_log_level, "   Largest leaf node           : %i primitives",
                 ctx.max_prims_in_leaf);
             Log(m_log_level, "   Avg. prims/nonempty leaf    : %.2f",
@@ -1999,6 +2301,8 @@ protected:
     std::unique_ptr<Index[]> m_indices;
     Size m_node_count = 0;
     Size m_index_count = 0;
+    size_t m_build_temp_storage = 0;
+    KDTreeStatistics m_statistics;
 
     CostModel m_cost_model;
     bool m_clip_primitives = true;
@@ -2007,6 +2311,7 @@ protected:
     Size m_stop_primitives = 3;
     Size m_max_bad_refines = 0;
     Size m_exact_prim_threshold = 65536;
+    Size m_parallel_subtree_threshold = 4096;
     Size m_min_max_bins = 128;
     LogLevel m_log_level = Debug;
     BoundingBox m_bbox;
@@ -2147,6 +2452,25 @@ public:
     using Base::m_indices;
     using Base::m_index_count;
     using Base::m_node_count;
+    using Base::m_cost_model;
+    using Base::m_max_depth;
+    using Base::m_statistics;
+
+    /**
+     * \brief Triangle record for intersection tests without indirections
+     *
+     * Stores the affine transformation of Baldwin and Weber ("Fast
+     * Ray-Triangle Intersections by Coordinate Transformation", JCGT 2016),
+     * which maps the vertices of the triangle onto (0, 0, 0), (1, 0, 0) and
+     * (0, 1, 0). The first two rows give the barycentric coordinates of a
+     * point, and the last row its (scaled) distance to the triangle plane.
+     */
+    struct PrecomputedTriangle {
+        ScalarFloat m[3][4];
+
+        /// Does this record refer to a primitive that isn't a static triangle?
+        bool fallback() const { return dr::isnan(m[0][0]); }
+    };
 
     /// Create an empty kd-tree and take build-related parameters from \c props.
     ShapeKDTree(const Properties &props);
@@ -2157,9 +2481,92 @@ public:
     /// Register a new shape with the kd-tree (to be called before \ref build())
     void add_shape(Shape *shape);
 
-    /// Build the kd-tree
+    /**
+     * \brief Build the kd-tree
+     *
+     * When auto-tuning is enabled (via the \c kd_auto_tune parameter), the
+     * tree is built with several cost model parameters, and the one that
+     * traces the rays of \ref measure_traversal() the fastest is kept.
+     *
+     * When a build cache is set (see \ref set_cache_dir()), a tree that was
+     * previously built for the same geometry and parameters is loaded from
+     * the cache instead, and newly built trees are added to it.
+     */
     void build();
 
+    /// Return the directory of the build cache (empty if disabled)
+    const fs::path &cache_dir() const { return m_cache_dir; }
+
+    /**
+     * \brief Set the directory of the build cache (empty to disable it)
+     *
+     * Every file of the directory stores the nodes and primitive indices of
+     * a built tree in a layout that is loaded via a memory mapping. Files
+     * are identified by \ref cache_key(), and they are published
+     * atomically, which allows several processes to share the directory.
+     */
+    void set_cache_dir(const fs::path &path) { m_cache_dir = path; }
+
+    /**
+     * \brief Return the key of the tree in the build cache
+     *
+     * This is a hash of the build parameters and of the registered shapes
+     * (the vertex positions and faces of static meshes, and the bounding
+     * boxes of the primitives of other shapes).
+     */
+    uint64_t cache_key() const;
+
+    /**
+     * \brief Measure the traversal cost of the kd-tree on sampled rays
+     *
+     * The rays start on a sphere enclosing the tree and point towards
+     * uniformly distributed positions within its bounding box. They only
+     * depend on \c ray_count and \c seed, hence different trees of the same
+     * shapes are measured on the same workload. The rays are first traced
+     * once to count the visited nodes and tested primitives, and then \c
+     * passes times (on the calling thread) to measure the time.
+     */
+    KDTraversalStatistics measure_traversal(size_t ray_count = 65536,
+                                            uint32_t seed = 0,
+                                            uint32_t passes = 3) const;
+
+    /// Is auto-tuning of the cost model enabled?
+    bool auto_tune() const { return m_auto_tune; }
+
+    /// Enable or disable auto-tuning of the cost model in \ref build()
+    void set_auto_tune(bool value) { m_auto_tune = value; }
+
+    /// Are triangles precomputed in leaf order for the traversal?
+    bool precompute_triangles() const { return m_precompute_triangles; }
+
+    /**
+     * \brief Enable or disable the precomputed triangle records
+     *
+     * Takes effect upon the next call to \ref build().
+     */
+    void set_precompute_triangles(bool value) { m_precompute_triangles = value; }
+
+    /// Are packets of rays traced together by the LLVM backend?
+    bool packet_traversal() const { return m_packet_traversal; }
+
+    /// Enable or disable the packet traversal of the LLVM backend
+    void set_packet_traversal(bool value) { m_packet_traversal = value; }
+
+    /**
+     * \brief Return the minimum fraction of active lanes, below which
+     * \ref ray_intersect_packet() traces the remaining rays one by one
+     */
+    ScalarFloat packet_utilization() const { return m_packet_utilization; }
+
+    /// Set the minimum fraction of active lanes of the packet traversal
+    void set_packet_utilization(ScalarFloat value) { m_packet_utilization = value; }
+
+    /// Return the size of the node and primitive lists and triangle records
+    size_t memory_footprint() const override {
+        return Base::memory_footprint() +
+               (m_triangles ? m_index_count * sizeof(PrecomputedTriangle) : 0);
+    }
+
     /// Return the number of registered shapes
     Size shape_count() const { return Size(m_shapes.size()); }
 
@@ -2172,6 +2579,36 @@ public:
     /// Return the i-th shape
     Shape *shape(size_t i) { Assert(i < m_shapes.size()); return m_shapes[i]; }
 
+    /// Return the ray mask of the i-th shape
+    uint32_t shape_mask(size_t i) const { Assert(i < m_shape_masks.size()); return m_shape_masks[i]; }
+
+    /**
+     * \brief Set the (nonzero) ray mask of the i-th shape
+     *
+     * The traversal ignores the shape for rays whose mask does not share a
+     * bit with it. Shapes initially have the mask <tt>(uint32_t) -1</tt>.
+     */
+    void set_shape_mask(size_t i, uint32_t mask) {
+        Assert(i < m_shape_masks.size() && mask != 0);
+        m_shape_masks[i] = mask;
+    }
+
+    /// Is the alpha test of the i-th shape evaluated during the traversal?
+    bool shape_alpha_test(size_t i) const { Assert(i < m_shape_alpha_tests.size()); return m_shape_alpha_tests[i]; }
+
+    /**
+     * \brief Enable the alpha test (see \ref Shape::alpha_test()) of the
+     * i-th shape
+     *
+     * The traversal then skips intersections with the shape that fail the
+     * test. The alpha test is only evaluated by the scalar variants.
+     */
+    void set_shape_alpha_test(size_t i, bool value) {
+        Assert(i < m_shape_alpha_tests.size());
+        m_shape_alpha_tests[i] = value;
+        m_alpha_tests |= value;
+    }
+
     /// Return the bounding box of the i-th primitive
     MI_INLINE ScalarBoundingBox3f bbox(Index i) const {
         Index shape_index = find_shape(i);
@@ -2194,9 +2631,20 @@ public:
             Throw("kdtree should only be used in scalar mode");
     }
 
-    template <bool ShadowRay>
+    /**
+     * \brief Intersect a ray against the kd-tree
+     *
+     * When \c Count is set, the visited nodes and tested primitives are
+     * accumulated in \c counters. Shapes whose mask (see \ref
+     * set_shape_mask()) does not share a bit with \c ray_mask are ignored.
+     */
+    template <bool ShadowRay, bool Count = false>
     MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
-    ray_intersect_scalar(ScalarRay3f ray) const {
+    ray_intersect_scalar(ScalarRay3f ray,
+                         KDTraversalCounters *counters = nullptr,
+                         uint32_t ray_mask = (uint32_t) -1) const {
+        DRJIT_MARK_USED(counters);
+
         /// Ray traversal stack entry
         struct KDStackEntry {
             // Ray distance associated with the node entry and exit point
@@ -2223,6 +2671,9 @@ public:
         const KDNode *node = m_nodes.get();
         while (mint <= maxt) {
             if (likely(!node->leaf())) { // Inner node
+                if constexpr (Count)
+                    counters->inner_nodes++;
+
                 const ScalarFloat split = node->split();
                 const uint32_t axis     = node->axis();
 
@@ -2261,11 +2712,20 @@ public:
             } else if (node->primitive_count() > 0) { // Arrived at a leaf node
                 Index prim_start = node->primitive_offset();
                 Index prim_end = prim_start + node->primitive_count();
+                if constexpr (Count)
+                    counters->leaves++;
                 for (Index i = prim_start; i < prim_end; i++) {
+                    if constexpr (Count)
+                        counters->primitives++;
+
                     Index prim_index = m_indices[i];
 
-                    PreliminaryIntersection<ScalarFloat, Shape> prim_pi =
-                        intersect_prim<ShadowRay>(prim_index, ray);
+                    PreliminaryIntersection<ScalarFloat, Shape> prim_pi;
+                    if (m_triangles && !m_triangles[i].fallback())
+                        prim_pi = intersect_triangle<ShadowRay>(
+                            m_triangles[i], prim_index, ray, ray_mask);
+                    else
+                        prim_pi = intersect_prim<ShadowRay>(prim_index, ray, ray_mask);
 
                     if (unlikely(prim_pi.is_valid())) {
                         if constexpr (ShadowRay)
@@ -2292,16 +2752,56 @@ public:
         return pi;
     }
 
-#if 0
-    template <bool ShadowRay>
-    MI_INLINE PreliminaryIntersection3f ray_intersect_packet(Ray3f ray,
-                                                              Mask active) const {
+    /// Intersection record of a ray packet, see \ref ray_intersect_packet()
+    template <typename FloatP> struct PacketIntersection {
+        using UInt32P = dr::uint32_array_t<FloatP>;
+
+        /// Distance to the hit (infinite for lanes without a hit)
+        FloatP t = dr::Infinity<FloatP>;
+        /// Primitive-specific coordinates of the hit
+        Point<FloatP, 2> prim_uv = 0.f;
+        /// Primitive index within the hit shape
+        UInt32P prim_index = 0;
+        /// Index of the hit shape (within the instance, if any)
+        UInt32P shape_index = 0;
+        /// Index of the hit instance in the kd-tree, or <tt>(uint32_t) -1</tt>
+        UInt32P instance_index = (uint32_t) -1;
+
+        dr::mask_t<FloatP> is_valid() const { return dr::neq(t, dr::Infinity<FloatP>); }
+    };
+
+    /**
+     * \brief Intersect a packet of rays against the kd-tree
+     *
+     * All lanes share the traversal of the upper levels of the tree, where
+     * rays of a coherent packet visit the same nodes. Once the fraction of
+     * active lanes drops below \ref packet_utilization(), the remaining
+     * lanes are finished separately with \ref ray_intersect_scalar(), hence
+     * a diverged packet costs at most as much as tracing its rays one by
+     * one (plus the shared work done so far).
+     *
+     * When the lanes disagree on the order of two children, closest hit
+     * queries visit the child that most lanes reach first. Shadow rays may
+     * terminate at any hit, hence they visit the child that the most lanes
+     * overlap first, which terminates the largest number of lanes early.
+     *
+     * The packet width must be 4, 8, or 16.
+     */
+    template <bool ShadowRay, typename FloatP>
+    MI_INLINE PacketIntersection<FloatP>
+    ray_intersect_packet(Ray<Point<FloatP, 3>, Spectrum> ray,
+                         dr::mask_t<FloatP> active) const {
+        using MaskP     = dr::mask_t<FloatP>;
+        using UInt32P   = dr::uint32_array_t<FloatP>;
+        using Vector3fP = Vector<FloatP, 3>;
+        constexpr size_t Width = dr::array_size_v<FloatP>;
+
         /// Ray traversal stack entry
         struct KDStackEntry {
             // Ray distance associated with the node entry and exit point
-            Float mint, maxt;
+            FloatP mint, maxt;
             // Is the corresponding SIMD lane enabled?
-            Mask active;
+            MaskP active;
             // Pointer to the far child
             const KDNode *node;
         };
@@ -2311,35 +2811,86 @@ public:
         int32_t stack_index = 0;
 
         // Resulting intersection struct
-        PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+        PacketIntersection<FloatP> pi;
+
+        // Below this many active lanes, trace the remaining rays one by one
+        const size_t min_lanes = std::max(
+            (size_t) 2, (size_t) std::ceil(m_packet_utilization * Width));
+
+        // Lanes that were already handled by the scalar traversal
+        MaskP finished = false;
+
+        // Record the hit of a single ray in lane i
+        auto record = [&](size_t i, const PreliminaryIntersection<ScalarFloat, Shape> &prim_pi) {
+            if constexpr (ShadowRay) {
+                DRJIT_MARK_USED(prim_pi);
+                pi.t.entry(i) = 0.f;
+            } else {
+                pi.t.entry(i) = prim_pi.t;
+                pi.prim_uv.x().entry(i) = prim_pi.prim_uv.x();
+                pi.prim_uv.y().entry(i) = prim_pi.prim_uv.y();
+                pi.prim_index.entry(i) = prim_pi.prim_index;
+                pi.shape_index.entry(i) = prim_pi.shape_index;
+                pi.instance_index.entry(i) =
+                    prim_pi.instance ? (uint32_t) (size_t) prim_pi.shape // shape_index
+                                     : (uint32_t) -1;
+                ray.maxt.entry(i) = prim_pi.t;
+            }
+        };
+
+        // Extract the ray of lane i
+        auto lane_ray = [&](size_t i) {
+            return ScalarRay3f(
+                ScalarPoint3f(ray.o.x()[i], ray.o.y()[i], ray.o.z()[i]),
+                ScalarVector3f(ray.d.x()[i], ray.d.y()[i], ray.d.z()[i]),
+                ray.maxt[i], ray.time[i], wavelength_t<Spectrum>());
+        };
 
         const KDNode *node = m_nodes.get();
 
         /* Intersect against the scene bounding box */
         auto bbox_result = m_bbox.ray_intersect(ray);
-        Float mint = dr::maximum(ray.mint, std::get<1>(bbox_result));
-        Float maxt = dr::minimum(ray.maxt, std::get<2>(bbox_result));
+        FloatP mint = dr::maximum(0.f, std::get<1>(bbox_result)),
+               maxt = dr::minimum(ray.maxt, std::get<2>(bbox_result));
+
+        Vector3fP d_rcp = dr::rcp(ray.d);
 
         while (true) {
-            active = active && (maxt >= mint);
-            if (ShadowRay)
+            active = active && (maxt >= mint) && !finished;
+            if constexpr (ShadowRay)
                 active = active && !pi.is_valid();
 
-            if (likely(dr::any(active))) {
+            size_t lanes = dr::count(active);
+            if (unlikely(lanes > 0 && lanes < min_lanes)) {
+                /* The packet has diverged: restart the remaining rays from
+                   the root (with their current maximum distance), which
+                   also covers the nodes on the stack */
+                for (size_t i = 0; i < Width; ++i) {
+                    if (!active[i])
+                        continue;
+                    ScalarRay3f ray_i = lane_ray(i);
+                    ray_i.maxt = std::min(ray_i.maxt, pi.t[i]);
+                    auto prim_pi = ray_intersect_scalar<ShadowRay>(ray_i);
+                    if (prim_pi.is_valid())
+                        record(i, prim_pi);
+                }
+                finished = finished || active;
+                active = false;
+            } else if (likely(lanes > 0)) {
                 if (likely(!node->leaf())) { // Inner node
-                    const dr::scalar_t<Float> split = node->split();
+                    const ScalarFloat split = node->split();
                     const uint32_t axis = node->axis();
 
-                    // Compute parametric distance along the rays to the split plane
-                    Float t_plane          = (split - ray.o[axis]) * ray.d_rcp[axis];
-                    Mask left_first        = (ray.o[axis] < split) ||
+                    /* Compute parametric distance along the rays to the split plane */
+                    FloatP t_plane         = (split - ray.o[axis]) * d_rcp[axis];
+                    MaskP left_first       = (ray.o[axis] < split) ||
                                               (dr::eq(ray.o[axis], split) && ray.d[axis] >= 0.f),
-                         start_after       = t_plane < mint,
-                         end_before        = t_plane > maxt || t_plane < 0.f || !dr::isfinite(t_plane),
-                         single_node       = start_after || end_before,
-                         visit_left        = dr::eq(end_before, left_first),
-                         visit_only_left   = single_node &&  visit_left,
-                         visit_only_right  = single_node && !visit_left;
+                          start_after      = t_plane < mint,
+                          end_before       = t_plane > maxt || t_plane < 0.f || !dr::isfinite(t_plane),
+                          single_node      = start_after || end_before,
+                          visit_left       = dr::eq(end_before, left_first),
+                          visit_only_left  = single_node &&  visit_left,
+                          visit_only_right = single_node && !visit_left;
 
                     bool all_visit_only_left  = dr::all(visit_only_left || !active),
                          all_visit_only_right = dr::all(visit_only_right || !active),
@@ -2351,16 +2902,20 @@ public:
                         continue;
                     }
 
-                    size_t left_votes  = count(left_first && active),
-                           right_votes = count(!left_first && active);
-
-                    bool go_left = left_votes >= right_votes;
+                    bool go_left;
+                    if constexpr (ShadowRay) {
+                        go_left = dr::count(active && !visit_only_right) >=
+                                  dr::count(active && !visit_only_left);
+                    } else {
+                        go_left = dr::count(left_first && active) >=
+                                  dr::count(!left_first && active);
+                    }
 
-                    Mask go_left_bcast = Mask(go_left),
-                         correct_order = dr::eq(left_first, go_left_bcast),
-                         visit_both    = !single_node,
-                         visit_cur     = visit_both || eq (visit_left, go_left_bcast),
-                         visit_next    = visit_both || dr::neq(visit_left, go_left_bcast);
+                    MaskP go_left_bcast = MaskP(go_left),
+                          correct_order = dr::eq(left_first, go_left_bcast),
+                          visit_both    = !single_node,
+                          visit_cur     = visit_both || dr::eq(visit_left, go_left_bcast),
+                          visit_next    = visit_both || dr::neq(visit_left, go_left_bcast);
 
                     /* Visit both child nodes in the right order */
                     Index node_offset = go_left ? 0 : 1;
@@ -2369,8 +2924,8 @@ public:
                                  *n_next = left + (1 - node_offset);
 
                     /* Postpone visit to 'n_next' */
-                    Mask sel0 =  correct_order && visit_both,
-                         sel1 = !correct_order && visit_both;
+                    MaskP sel0 =  correct_order && visit_both,
+                          sel1 = !correct_order && visit_both;
                     KDStackEntry& entry = stack[stack_index++];
                     entry.mint = dr::select(sel0, t_plane, mint);
                     entry.maxt = dr::select(sel1, t_plane, maxt);
@@ -2389,16 +2944,51 @@ public:
                     for (Index i = prim_start; i < prim_end; i++) {
                         Index prim_index = m_indices[i];
 
-                        PreliminaryIntersection3f prim_pi =
-                            intersect_prim<ShadowRay>(prim_index, ray, active);
+                        FloatP t;
+                        Point<FloatP, 2> prim_uv;
+                        Index shape_index;
+
+                        if (m_triangles && !m_triangles[i].fallback()) {
+                            MaskP hit;
+                            std::tie(t, prim_uv, hit) =
+                                intersect_triangle_impl(m_triangles[i], ray);
+                            t = dr::select(hit && active, t, dr::Infinity<FloatP>);
+                            if (dr::none(hit && active))
+                                continue;
+                            shape_index = find_shape(prim_index);
+                        } else {
+                            shape_index = find_shape(prim_index);
+                            const Shape *shape = this->shape(shape_index);
+
+                            if (!shape->is_mesh()) {
+                                // Other shapes are intersected one ray at a time
+                                Index global_index = m_indices[i];
+                                for (size_t j = 0; j < Width; ++j) {
+                                    if (!active[j])
+                                        continue;
+                                    auto prim_pi = intersect_prim<ShadowRay>(
+                                        global_index, lane_ray(j));
+                                    if (prim_pi.is_valid())
+                                        record(j, prim_pi);
+                                }
+                                continue;
+                            }
 
-                        dr::masked(pi, prim_pi.is_valid()) = prim_pi;
+                            std::tie(t, prim_uv) =
+                                ((const Mesh *) shape)->ray_intersect_triangle_packet(
+                                    UInt32P(prim_index), ray, active);
+                        }
 
-                        if constexpr (!ShadowRay) {
-                            Assert(dr::all(!prim_pi.is_valid() ||
-                                       (prim_pi.t >= ray.mint &&
-                                        prim_pi.t <= ray.maxt)));
-                            dr::masked(ray.maxt, prim_pi.is_valid()) = prim_pi.t;
+                        MaskP hit = active && dr::neq(t, dr::Infinity<FloatP>);
+                        if constexpr (ShadowRay) {
+                            dr::masked(pi.t, hit) = 0.f;
+                        } else {
+                            dr::masked(pi.t, hit) = t;
+                            dr::masked(pi.prim_uv, hit) = prim_uv;
+                            dr::masked(pi.prim_index, hit) = prim_index;
+                            dr::masked(pi.shape_index, hit) = shape_index;
+                            dr::masked(pi.instance_index, hit) = (uint32_t) -1;
+                            dr::masked(ray.maxt, hit) = t;
                         }
                     }
                 }
@@ -2418,7 +3008,6 @@ public:
 
         return pi;
     }
-#endif
 
     /// Brute force intersection routine for debugging purposes
     template <bool ShadowRay>
@@ -2462,6 +3051,14 @@ protected:
     MI_INLINE Index find_shape(Index &i) const {
         Assert(i < primitive_count());
 
+        /* Scenes made of many instances (or other single-primitive shapes)
+           map primitives to shapes one-to-one */
+        if (m_single_primitive_shapes) {
+            Index shape_index = i;
+            i = 0;
+            return shape_index;
+        }
+
         Index shape_index = math::find_interval<Index>(
             Size(m_primitive_map.size()),
             [&](Index k) DRJIT_INLINE_LAMBDA {
@@ -2487,14 +3084,24 @@ protected:
      */
     template <bool ShadowRay = false>
     MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
-    intersect_prim(Index prim_index, const ScalarRay3f &ray) const {
+    intersect_prim(Index prim_index, const ScalarRay3f &ray,
+                   uint32_t ray_mask = (uint32_t) -1) const {
         Index shape_index  = find_shape(prim_index);
         const Shape *shape = this->shape(shape_index);
         const Mesh *mesh = (const Mesh *) shape;
 
         PreliminaryIntersection<ScalarFloat, Shape> pi;
+        if (unlikely(!(m_shape_masks[shape_index] & ray_mask)))
+            return pi;
 
         if constexpr (ShadowRay) {
+            // The alpha test requires the complete intersection record
+            if (unlikely(m_shape_alpha_tests[shape_index])) {
+                pi = intersect_prim<false>(prim_index, ray, ray_mask);
+                pi.t = dr::select(pi.t != dr::Infinity<ScalarFloat>, 0.f, pi.t);
+                return pi;
+            }
+
             bool hit;
             if (shape->is_mesh())
                 hit = mesh->ray_intersect_triangle_scalar(prim_index, ray).first != dr::Infinity<ScalarFloat>;
@@ -2514,14 +3121,135 @@ protected:
             pi.shape       = hit_inst ? (const Shape *) (size_t) shape_index : shape; // shape_index for LLVM + kdtree
             pi.instance    = hit_inst ? shape : nullptr;
             pi.shape_index = hit_inst ? inst_index : shape_index;
+
+            if (unlikely(m_shape_alpha_tests[shape_index]) &&
+                pi.t != dr::Infinity<ScalarFloat> && !alpha_test(pi, ray))
+                return PreliminaryIntersection<ScalarFloat, Shape>();
+        }
+
+        return pi;
+    }
+
+    /// Evaluate the alpha test of an intersection with an alpha-tested shape
+    MI_INLINE bool alpha_test(const PreliminaryIntersection<ScalarFloat, Shape> &pi,
+                              const ScalarRay3f &ray) const {
+        if constexpr (!dr::is_jit_v<Float>) {
+            return pi.shape->alpha_test(ray, pi);
+        } else {
+            DRJIT_MARK_USED(pi);
+            DRJIT_MARK_USED(ray);
+            return true;
         }
+    }
+
+    /**
+     * \brief Intersect a ray (or a packet of rays) against a precomputed
+     * triangle record
+     *
+     * Returns the distance, the barycentric coordinates of the 2nd and 3rd
+     * vertex, and whether the triangle was hit within <tt>[0, ray.maxt]</tt>.
+     */
+    template <typename Ray>
+    static MI_INLINE auto intersect_triangle_impl(const PrecomputedTriangle &tri,
+                                                  const Ray &ray) {
+        using T = typename Ray::Float;
+        const auto &m = tri.m;
+
+        T t_o = dr::fmadd(m[2][0], ray.o.x(), dr::fmadd(m[2][1], ray.o.y(),
+                dr::fmadd(m[2][2], ray.o.z(), m[2][3]))),
+          t_d = dr::fmadd(m[2][0], ray.d.x(), dr::fmadd(m[2][1], ray.d.y(),
+                m[2][2] * ray.d.z())),
+          t   = -t_o / t_d;
+
+        auto p = ray(t);
+        T u = dr::fmadd(m[0][0], p.x(), dr::fmadd(m[0][1], p.y(),
+              dr::fmadd(m[0][2], p.z(), m[0][3]))),
+          v = dr::fmadd(m[1][0], p.x(), dr::fmadd(m[1][1], p.y(),
+              dr::fmadd(m[1][2], p.z(), m[1][3])));
+
+        auto hit = t >= 0.f && t <= ray.maxt && u >= 0.f && v >= 0.f &&
+                   u + v <= 1.f;
+
+        return std::make_tuple(t, Point<T, 2>(u, v), hit);
+    }
+
+    /**
+     * \brief Intersect a ray against a precomputed triangle record
+     *
+     * Equivalent to \ref intersect_prim() for static triangles, but only
+     * accesses the shape data when the triangle is hit.
+     */
+    template <bool ShadowRay = false>
+    MI_INLINE PreliminaryIntersection<ScalarFloat, Shape>
+    intersect_triangle(const PrecomputedTriangle &tri, Index prim_index,
+                       const ScalarRay3f &ray,
+                       uint32_t ray_mask = (uint32_t) -1) const {
+        PreliminaryIntersection<ScalarFloat, Shape> pi;
+
+        auto [t, prim_uv, hit] = intersect_triangle_impl(tri, ray);
+        if (likely(!hit))
+            return pi;
+
+        /* Shape masks are nonzero, hence the default mask skips this lookup
+           unless some shapes are alpha-tested */
+        Index shape_index = 0;
+        if (!ShadowRay || ray_mask != (uint32_t) -1 || m_alpha_tests) {
+            shape_index = find_shape(prim_index);
+            if (unlikely(!(m_shape_masks[shape_index] & ray_mask)))
+                return pi;
+        }
+
+        bool alpha_tested = m_alpha_tests && m_shape_alpha_tests[shape_index];
+        if (!ShadowRay || unlikely(alpha_tested)) {
+            pi.t           = t;
+            pi.prim_uv     = prim_uv;
+            pi.prim_index  = prim_index;
+            pi.shape       = this->shape(shape_index);
+            pi.instance    = nullptr;
+            pi.shape_index = shape_index;
+
+            if (unlikely(alpha_tested) && !alpha_test(pi, ray))
+                return PreliminaryIntersection<ScalarFloat, Shape>();
+        }
+
+        if constexpr (ShadowRay)
+            pi.t = 0.f;
 
         return pi;
     }
 
+    /// Build the tree with several cost models and keep the fastest one
+    void build_auto_tuned();
+
+    /// Compute the triangle records (if enabled) in the order of \c m_indices
+    void build_triangles();
+
+    /// Load the tree from a file of the build cache (if it matches \c key)
+    bool load_cache(const fs::path &filename, uint64_t key);
+
+    /// Store the built tree in a file of the build cache
+    void store_cache(const fs::path &filename, uint64_t key) const;
+
 protected:
     std::vector<ref<Shape>> m_shapes;
+    /// Ray masks of the registered shapes, see \ref set_shape_mask()
+    std::vector<uint32_t> m_shape_masks;
+    /// Alpha tests of the registered shapes, see \ref set_shape_alpha_test()
+    std::vector<bool> m_shape_alpha_tests;
+    /// Is the alpha test of any shape enabled?
+    bool m_alpha_tests = false;
     std::vector<Size> m_primitive_map;
+    /// Does every shape consist of exactly one primitive?
+    bool m_single_primitive_shapes = true;
+    bool m_auto_tune = false;
+    size_t m_auto_tune_rays = 65536;
+    bool m_precompute_triangles = false;
+    bool m_packet_traversal = false;
+    ScalarFloat m_packet_utilization = .5f;
+    /// Triangle records of the entries of \c m_indices (if enabled)
+    std::unique_ptr<PrecomputedTriangle[]> m_triangles;
+    /// Directory of the build cache, see \ref set_cache_dir()
+    fs::path m_cache_dir;
 };
 
 MI_EXTERN_CLASS(ShapeKDTree)
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/interaction.h>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Regular grid over the scene that stores the point and spot lights
+ * which can noticeably illuminate each of its cells
+ *
+ * Scenes with many point and spot lights (e.g. the street lights of a city at
+ * night) waste most of their shadow rays on lights that are far away from the
+ * shaded point, or on spot lights that don't even point towards it. This
+ * class is enabled by setting the \c emitter_sampling parameter of the scene
+ * to \c "light_grid". For every light with a delta position, it derives an
+ * influence radius beyond which its irradiance falls below a fraction (the
+ * \c light_grid_threshold parameter of the scene) of the average irradiance
+ * of all such lights over the bounding box of the scene. The light is then
+ * inserted into the lists of all cells that intersect this sphere and, for
+ * spot lights, the cone of emitted directions (see \ref
+ * Emitter::emission_cone()). The lights of a cell are chosen proportional
+ * to their power divided by their squared distance to the cell.
+ *
+ * To keep the estimates unbiased, the emitter is chosen with a fixed
+ * probability from a distribution over all emitters of the scene
+ * proportional to their power, and otherwise from the list of the cell that
+ * contains the reference point. The probability of the former is at least
+ * the fraction of the power of emitters that are not stored in the lists
+ * (e.g. area and environment emitters), and it is one for cells with empty
+ * lists. Sampling and evaluating the probability of an emitter both take
+ * time logarithmic in the length of the list.
+ *
+ * The power of every emitter is given by its sampling weight times its
+ * cached flux estimate (see \ref Emitter::flux()), which must be up to date
+ * when the grid is built.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB LightGrid : public Object {
+public:
+    MI_IMPORT_TYPES(Emitter, EmitterPtr)
+
+    /**
+     * \brief Build a light grid over the given list of emitters
+     *
+     * \param bbox
+     *     Bounding box of the scene geometry, which is extended to contain
+     *     the positions of all lights
+     *
+     * \param resolution
+     *     Number of cells along the longest axis of the bounding box
+     *
+     * \param threshold
+     *     Irradiance relative to the average that determines the influence
+     *     radius of every light
+     */
+    LightGrid(const std::vector<ref<Emitter>> &emitters,
+              const ScalarBoundingBox3f &bbox, uint32_t resolution,
+              ScalarFloat threshold);
+
+    /// (Re-)build the grid, e.g. after emitters changed
+    void build(const std::vector<ref<Emitter>> &emitters,
+               const ScalarBoundingBox3f &bbox);
+
+    /**
+     * \brief Sample one emitter for the given reference point and rescale
+     * the input sample for reuse
+     *
+     * \return A tuple <tt>(index, sample, pmf)</tt> with the index of the
+     * chosen emitter, the rescaled sample and the discrete probability of
+     * choosing it.
+     */
+    std::tuple<UInt32, Float, Float>
+    sample_emitter(const Interaction3f &ref, Float sample,
+                   Mask active = true) const;
+
+    /**
+     * \brief Evaluate the discrete probability of choosing \c emitter with
+     * \ref sample_emitter() for the given reference point
+     */
+    Float pdf_emitter(const Interaction3f &ref, const EmitterPtr &emitter,
+                      Mask active = true) const;
+
+    /// Return the number of emitters of the scene
+    uint32_t emitter_count() const { return m_emitter_count; }
+
+    /// Return the number of cells along every axis
+    const ScalarVector3u &resolution() const { return m_resolution; }
+
+    /// Return the total length of the lists of all cells
+    size_t entry_count() const { return m_entry_count; }
+
+    /// Return the length of the longest list of a cell
+    uint32_t max_cell_size() const { return m_max_cell_size; }
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    /// Index of the cell containing \c p (clamped to the grid)
+    UInt32 cell_index(const Point3f &p) const;
+
+    /// Probability of choosing emitter \c index in a cell with the given list
+    Float pdf_index(const UInt32 &index, const UInt32 &begin, const UInt32 &end,
+                    Mask active) const;
+
+    /**
+     * \brief Return the first position <tt>i</tt> in
+     * <tt>[begin, end)</tt> for which \c pred is \c false (or <tt>end -
+     * 1</tt>), where \c pred must be monotonic over the range
+     */
+    template <typename Predicate>
+    UInt32 lower_bound(const UInt32 &begin, const UInt32 &end,
+                       const Predicate &pred, Mask active) const;
+
+    /// Map an emitter pointer to its index in the scene
+    UInt32 emitter_index(const EmitterPtr &emitter, Mask active) const;
+
+protected:
+    /// Offsets of the lists of every cell into \ref m_lights (one more entry)
+    DynamicBuffer<UInt32> m_offsets;
+    /// Emitter indices of the lists (ascending within every cell)
+    DynamicBuffer<UInt32> m_lights;
+    /// Cumulative probabilities of choosing the lights within every cell
+    DynamicBuffer<Float> m_cdf;
+    /// Distribution over all emitters proportional to their power
+    DiscreteDistribution<Float> m_global;
+    /// Registry ID -> emitter index (JIT variants)
+    DynamicBuffer<UInt32> m_registry_index;
+    /// Emitter pointer -> emitter index (scalar variants)
+    std::unordered_map<const Emitter *, uint32_t> m_pointer_index;
+
+    ScalarBoundingBox3f m_bbox;
+    ScalarVector3f m_inv_cell_size;
+    ScalarVector3u m_resolution;
+    uint32_t m_max_resolution;
+    ScalarFloat m_threshold;
+
+    uint32_t m_emitter_count = 0;
+    size_t m_entry_count = 0;
+    uint32_t m_max_cell_size = 0;
+    /// Number of steps of \ref lower_bound() for the longest list
+    uint32_t m_search_steps = 0;
+    /// Probability of choosing from \ref m_global in cells with a list
+    ScalarFloat m_global_prob = 1.f;
+
+    /// Smallest probability of choosing from \ref m_global
+    static constexpr ScalarFloat GlobalProbability = .1f;
+};
+
+MI_EXTERN_CLASS(LightGrid)
+NAMESPACE_END(mitsuba)
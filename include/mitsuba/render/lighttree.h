@@ -0,0 +1,143 @@
+#pragma once
+
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/interaction.h>
+#include <unordered_map>
+
+/// Number of bins per axis used by the light tree builder
+#define MI_LIGHT_TREE_BINS 12u
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Bounding volume hierarchy over the emitters of a scene that is
+ * used to importance sample a single emitter for a given reference point
+ *
+ * Selecting emitters uniformly or proportional to a fixed weight becomes very
+ * inefficient when a scene contains many emitters, most of which contribute
+ * little to any particular point. This class is enabled by setting the \c
+ * emitter_sampling parameter of the scene to \c "light_tree". It stores an
+ * axis-aligned bounding box, a cone bounding the emitted directions, and the
+ * total power for every node of a binary hierarchy. Emitters are selected by
+ * stochastically descending the hierarchy, choosing each child proportional
+ * to a conservative estimate of its contribution to the reference point
+ * ("Importance Sampling of Many Lights With Adaptive Tree Splitting" by
+ * Conty Estevez and Kulla, and the light BVH of PBRT-v4). Sampling and
+ * evaluating the probability of an emitter both take time logarithmic in the
+ * number of emitters.
+ *
+ * Emitters without a valid bounding box (e.g. environment emitters) cannot
+ * be placed in the hierarchy. They are instead sampled uniformly with a
+ * probability proportional to their number.
+ *
+ * The power of every emitter is given by its sampling weight times its
+ * cached flux estimate (see \ref Emitter::flux()), which must be up to date
+ * when the tree is built. The emission cone of area emitters attached to
+ * meshes is computed from the face and vertex normals, while all other
+ * emitters are assumed to emit in all directions.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB LightTree : public Object {
+public:
+    MI_IMPORT_TYPES(Emitter, EmitterPtr, Mesh)
+
+    /// Build a light tree over the given list of emitters
+    LightTree(const std::vector<ref<Emitter>> &emitters);
+
+    /// (Re-)build the hierarchy, e.g. after emitters changed
+    void build(const std::vector<ref<Emitter>> &emitters);
+
+    /**
+     * \brief Sample one emitter for the given reference point and rescale
+     * the input sample for reuse
+     *
+     * \return A tuple <tt>(index, sample, pmf)</tt> with the index of the
+     * chosen emitter, the rescaled sample and the discrete probability of
+     * choosing it. The probability is zero when no emitter can contribute
+     * to the reference point.
+     */
+    std::tuple<UInt32, Float, Float>
+    sample_emitter(const Interaction3f &ref, Float sample,
+                   Mask active = true) const;
+
+    /**
+     * \brief Evaluate the discrete probability of choosing \c emitter with
+     * \ref sample_emitter() for the given reference point
+     */
+    Float pdf_emitter(const Interaction3f &ref, const EmitterPtr &emitter,
+                      Mask active = true) const;
+
+    /// Return the number of emitters stored in the hierarchy
+    uint32_t emitter_count() const { return m_emitter_count; }
+
+    /// Return the number of emitters sampled outside of the hierarchy
+    uint32_t infinite_count() const { return (uint32_t) m_infinite_count; }
+
+    /// Return the number of nodes of the hierarchy
+    uint32_t node_count() const { return m_node_count; }
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+protected:
+    /// Bounds of a subset of the emitters (used during construction)
+    struct LightBounds {
+        ScalarBoundingBox3f bbox;
+        ScalarVector3f axis = ScalarVector3f(0.f, 0.f, 1.f);
+        ScalarFloat cos_theta_o = -1.f;
+        ScalarFloat cos_theta_e = 0.f;
+        ScalarFloat power = 0.f;
+    };
+
+    /// Compute the bounds of an individual emitter
+    LightBounds emitter_bounds(const Emitter *emitter) const;
+
+    /// Recursively build the subtree for <tt>lights[begin..end)</tt> at \c node
+    void build_node(std::vector<std::pair<uint32_t, LightBounds>> &lights,
+                    size_t begin, size_t end, uint32_t node,
+                    std::vector<ScalarFloat> &nodes,
+                    std::vector<uint32_t> &children,
+                    std::vector<uint32_t> &parents,
+                    std::vector<uint32_t> &leaves) const;
+
+    /// Estimate the contribution of a node to a reference point
+    Float importance(const UInt32 &node, const Point3f &p, const Normal3f &n,
+                     Mask active) const;
+
+    /// Map an emitter pointer to its index in the scene
+    UInt32 emitter_index(const EmitterPtr &emitter, Mask active) const;
+
+protected:
+    /// Per-node bounds, direction cone and power (\ref NodeStride values each)
+    DynamicBuffer<Float> m_nodes;
+    /// Index of the left child (inner node) or tagged emitter index (leaf)
+    DynamicBuffer<UInt32> m_children;
+    /// Index of the parent of every node
+    DynamicBuffer<UInt32> m_parents;
+    /// Index of the leaf storing every emitter (invalid for infinite ones)
+    DynamicBuffer<UInt32> m_leaves;
+    /// Indices of emitters without a valid bounding box
+    DynamicBuffer<UInt32> m_infinite;
+    /// Registry ID -> emitter index (JIT variants)
+    DynamicBuffer<UInt32> m_registry_index;
+    /// Emitter pointer -> emitter index (scalar variants)
+    std::unordered_map<const Emitter *, uint32_t> m_pointer_index;
+
+    uint32_t m_emitter_count = 0;
+    uint32_t m_node_count = 0;
+    size_t m_infinite_count = 0;
+    /// Probability of sampling one of the infinite emitters
+    ScalarFloat m_infinite_prob = 0.f;
+
+    static constexpr uint32_t NodeStride = 12;
+    static constexpr uint32_t LeafFlag = 0x80000000u;
+    /// Entries of \ref m_leaves for emitters that are not part of the tree
+    static constexpr uint32_t InfiniteLeaf = 0xFFFFFFFEu;
+    static constexpr uint32_t InvalidLeaf  = 0xFFFFFFFFu;
+};
+
+MI_EXTERN_CLASS(LightTree)
+NAMESPACE_END(mitsuba)
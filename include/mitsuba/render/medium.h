@@ -11,7 +11,7 @@ NAMESPACE_BEGIN(mitsuba)
 template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB Medium : public Object {
 public:
-    MI_IMPORT_TYPES(PhaseFunction, Sampler, Scene, Texture);
+    MI_IMPORT_TYPES(PhaseFunction, Sampler, Scene, Texture, Volume, Emitter);
 
     /// Intersects a ray with the medium's bounding box
     virtual std::tuple<Mask, Float, Float>
@@ -22,6 +22,20 @@ public:
     get_majorant(const MediumInteraction3f &mi,
                  Mask active = true) const = 0;
 
+    /**
+     * \brief Returns the control extinction used by residual ratio tracking
+     *
+     * The control extinction is constant within the bounding box of the
+     * medium and should not exceed the extinction coefficient anywhere, so
+     * that the transmittance due to the control can be computed analytically
+     * and only the residual extinction has to be estimated stochastically. The
+     * default implementation returns zero, which reduces residual ratio
+     * tracking to ratio tracking.
+     */
+    virtual UnpolarizedSpectrum
+    get_control_extinction(const MediumInteraction3f &mi,
+                           Mask active = true) const;
+
     /// Returns the medium coefficients Sigma_s, Sigma_n and Sigma_t evaluated
     /// at a given MediumInteraction mi
     virtual std::tuple<UnpolarizedSpectrum, UnpolarizedSpectrum,
@@ -29,6 +43,18 @@ public:
     get_scattering_coefficients(const MediumInteraction3f &mi,
                                 Mask active = true) const = 0;
 
+    /**
+     * \brief Returns the radiance emitted by the medium at a given
+     * MediumInteraction mi
+     *
+     * The emission term of the radiative transfer equation is the product of
+     * this radiance and the absorption coefficient <tt>sigma_t - sigma_s</tt>.
+     * The radiance vanishes outside of the unit cube of the radiance volume,
+     * and everywhere if the medium has none.
+     */
+    UnpolarizedSpectrum get_radiance(const MediumInteraction3f &mi,
+                                     Mask active = true) const;
+
     /**
      * \brief Sample a free-flight distance in the medium.
      *
@@ -50,6 +76,57 @@ public:
     MediumInteraction3f sample_interaction(const Ray3f &ray, Float sample,
                                            UInt32 channel, Mask active) const;
 
+    /**
+     * \brief Sample a free-flight distance for residual ratio tracking
+     *
+     * This function behaves like \ref sample_interaction(), except that
+     * tentative collisions are sampled according to the residual majorant,
+     * i.e. the majorant minus the control extinction returned by \ref
+     * get_control_extinction(). The \c combined_extinction field of the
+     * returned MediumInteraction stores the residual majorant, and \c sigma_n
+     * remains the difference between the majorant and the extinction, which
+     * is also the difference between the residual majorant and the residual
+     * extinction. The transmittance due to the control extinction must be
+     * accounted for analytically by the caller.
+     *
+     * Media whose control extinction equals their extinction (e.g.
+     * homogeneous media) never produce tentative collisions.
+     */
+    MediumInteraction3f sample_residual_interaction(const Ray3f &ray,
+                                                    Float sample,
+                                                    UInt32 channel,
+                                                    Mask active) const;
+
+    /**
+     * \brief Sample a tentative collision distance along a ray segment
+     *
+     * This function is used by \ref sample_interaction() to sample a distance
+     * proportional to the majorant transmittance along the segment
+     * <tt>[mint, maxt]</tt> of the ray. The default implementation uses the
+     * constant majorant returned by \ref get_majorant(). Media with a
+     * spatially varying majorant override it to step through the regions of
+     * their majorant along the segment.
+     *
+     * \param ray      Ray, along which a distance should be sampled
+     * \param mi       Medium interaction storing the ray's time, wavelengths
+     *                 and direction
+     * \param mint     Start of the segment within the medium
+     * \param maxt     End of the segment within the medium
+     * \param sample   A uniformly distributed random sample
+     * \param channel  The channel according to which the distance is sampled
+     * \param control  Control extinction of the sampled channel, which is
+     *                 subtracted from the majorant (zero unless residual
+     *                 ratio tracking is used)
+     *
+     * \return         A pair containing the sampled distance, which exceeds
+     *                 \c maxt if no collision occurs on the segment, and the
+     *                 majorant at the sampled location.
+     */
+    virtual std::pair<Float, UnpolarizedSpectrum>
+    sample_distance(const Ray3f &ray, const MediumInteraction3f &mi,
+                    Float mint, Float maxt, Float sample, UInt32 channel,
+                    Float control, Mask active) const;
+
     /**
      * \brief Compute the transmittance and PDF
      *
@@ -81,6 +158,23 @@ public:
     /// Returns whether this medium is homogeneous
     MI_INLINE bool is_homogeneous() const { return m_is_homogeneous; }
 
+    /// Returns whether this medium emits light
+    MI_INLINE bool is_emitter() const { return m_radiance.get() != nullptr; }
+
+    /// Return the volume of radiance emitted by the medium (if any)
+    MI_INLINE const Volume *radiance() const { return m_radiance.get(); }
+
+    /**
+     * \brief Return the emitter that samples the emission of the medium
+     *
+     * When it is set, integrators account for the emission on paths that
+     * perform next event estimation through this emitter only.
+     */
+    MI_INLINE const Emitter *emitter() const { return m_emitter; }
+
+    /// Set the emitter that samples the emission of the medium
+    void set_emitter(const Emitter *emitter);
+
     /// Returns whether this medium has a spectrally varying extinction
     MI_INLINE bool has_spectral_extinction() const {
         return m_has_spectral_extinction;
@@ -105,8 +199,17 @@ protected:
     Medium(const Properties &props);
     virtual ~Medium();
 
+    /// Implementation of \ref sample_interaction() and \ref sample_residual_interaction()
+    MediumInteraction3f sample_interaction_impl(const Ray3f &ray, Float sample,
+                                                UInt32 channel, bool residual,
+                                                Mask active) const;
+
 protected:
     ref<PhaseFunction> m_phase_function;
+    /// Emitted radiance (optional)
+    ref<Volume> m_radiance;
+    /// Emitter that samples the emission (not owned by the medium)
+    const Emitter *m_emitter = nullptr;
     bool m_sample_emitters, m_is_homogeneous, m_has_spectral_extinction;
 
     /// Identifier (if available)
@@ -125,11 +228,16 @@ DRJIT_VCALL_TEMPLATE_BEGIN(mitsuba::Medium)
     DRJIT_VCALL_GETTER(use_emitter_sampling, bool)
     DRJIT_VCALL_GETTER(is_homogeneous, bool)
     DRJIT_VCALL_GETTER(has_spectral_extinction, bool)
+    DRJIT_VCALL_GETTER(is_emitter, bool)
+    DRJIT_VCALL_GETTER(emitter, const typename Class::Emitter *)
     DRJIT_VCALL_METHOD(get_majorant)
+    DRJIT_VCALL_METHOD(get_control_extinction)
     DRJIT_VCALL_METHOD(intersect_aabb)
     DRJIT_VCALL_METHOD(sample_interaction)
+    DRJIT_VCALL_METHOD(sample_residual_interaction)
     DRJIT_VCALL_METHOD(transmittance_eval_pdf)
     DRJIT_VCALL_METHOD(get_scattering_coefficients)
+    DRJIT_VCALL_METHOD(get_radiance)
 DRJIT_VCALL_TEMPLATE_END(mitsuba::Medium)
 
 //! @}
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <mitsuba/render/interaction.h>
+#include <mitsuba/render/packedstorage.h>
 #include <mitsuba/render/shape.h>
 #include <mitsuba/render/srgb.h>
+#include <mitsuba/core/assetcache.h>
 #include <mitsuba/core/struct.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/properties.h>
 #include <unordered_map>
 #include <mutex>
@@ -53,6 +56,10 @@ public:
     FloatStorage& vertex_positions_buffer() { return m_vertex_positions; }
     /// Const variant of \ref vertex_positions_buffer.
     const FloatStorage& vertex_positions_buffer() const { return m_vertex_positions; }
+    /// Return vertex positions buffer at the end of the motion (empty for static meshes)
+    FloatStorage& vertex_positions_end_buffer() { return m_vertex_positions_end; }
+    /// Const variant of \ref vertex_positions_end_buffer.
+    const FloatStorage& vertex_positions_end_buffer() const { return m_vertex_positions_end; }
 
     /// Return vertex normals buffer
     FloatStorage& vertex_normals_buffer() { return m_vertex_normals; }
@@ -74,7 +81,15 @@ public:
         auto attribute = m_mesh_attributes.find(name);
         if (attribute == m_mesh_attributes.end())
             Throw("attribute_buffer(): attribute %s doesn't exist.", name.c_str());
-        return attribute->second.buf;
+
+        // Attributes stored with a reduced precision revert to single precision
+        MeshAttribute &attr = attribute->second;
+        if (attr.precision != StoragePrecision::Float) {
+            attr.buf = attr.values();
+            attr.precision = StoragePrecision::Float;
+            attr.packed = PackedStorage<Float>();
+        }
+        return attr.buf;
     }
 
     /// Add an attribute buffer with the given \c name and \c dim
@@ -97,6 +112,27 @@ public:
         return dr::gather<Result>(m_vertex_positions, index, active);
     }
 
+    /**
+     * \brief Returns the world-space position of the vertex with index \c
+     * index at the given time
+     *
+     * The positions of meshes with vertex motion (see \ref
+     * has_vertex_motion()) are interpolated linearly between the key at time
+     * 0 and the key at time 1.
+     */
+    template <typename Index, typename Time>
+    MI_INLINE auto vertex_position_at(Index index, const Time &time,
+                                      dr::mask_t<Index> active = true) const {
+        using Value  = dr::replace_scalar_t<Index, InputFloat>;
+        using Result = Point<Value, 3>;
+        Result p = dr::gather<Result>(m_vertex_positions, index, active);
+        if (has_vertex_motion()) {
+            Result p_end = dr::gather<Result>(m_vertex_positions_end, index, active);
+            p = dr::lerp(p, p_end, dr::clamp(Value(time), 0.f, 1.f));
+        }
+        return p;
+    }
+
     /// Returns the normal direction of the vertex with index \c index
     template <typename Index>
     MI_INLINE auto vertex_normal(Index index,
@@ -116,21 +152,35 @@ public:
     /// Does this mesh have per-vertex normals?
     bool has_vertex_normals() const { return dr::width(m_vertex_normals) != 0; }
 
+    /// Does this mesh move its vertices during the shutter interval?
+    bool has_vertex_motion() const { return dr::width(m_vertex_positions_end) != 0; }
+
+    bool has_motion() const override { return has_vertex_motion(); }
+
     /// Does this mesh have per-vertex texture coordinates?
     bool has_vertex_texcoords() const { return dr::width(m_vertex_texcoords) != 0; }
 
     /// Does this mesh have additional mesh attributes?
     bool has_mesh_attributes() const { return m_mesh_attributes.size() > 0; }
 
+    /// Return the names and dimensions of the mesh attributes, sorted by name
+    std::vector<std::pair<std::string, size_t>> mesh_attribute_dims() const;
+
     /// Does this mesh use face normals?
     bool has_face_normals() const { return m_face_normals; }
 
+    /// Are the normals of this mesh flipped?
+    bool has_flipped_normals() const { return m_flip_normals; }
+
     /// @}
     // =========================================================================
 
     /**
      * Write the mesh to a binary PLY file
      *
+     * The file is memory-mapped at its final size, and the vertex and face
+     * records are assembled into it in parallel.
+     *
      * \param filename
      *    Target file path on disk
      */
@@ -139,6 +189,9 @@ public:
     /**
      * Write the mesh encoded in binary PLY format to a stream
      *
+     * The records are assembled in large batches in parallel, and each batch
+     * is written with a single call while the next one is assembled.
+     *
      * \param stream
      *    Target stream that will receive the encoded output
      */
@@ -147,12 +200,40 @@ public:
     /// Merge two meshes into one
     ref<Mesh> merge(const Mesh *other) const;
 
+    /**
+     * \brief Merge a list of meshes into one
+     *
+     * The meshes must reference the same BSDF, media, emitter and sensor, and
+     * provide the same set of vertex data and mesh attributes. The buffers of
+     * the merged mesh are allocated once, and the inputs are copied to their
+     * offsets in parallel, which makes the cost linear in the total size.
+     */
+    static ref<Mesh> merge(const std::vector<const Mesh *> &meshes);
+
     /// Compute smooth vertex normals and replace the current normal values
     void recompute_vertex_normals();
 
     /// Recompute the bounding box (e.g. after modifying the vertex positions)
     void recompute_bbox();
 
+    /**
+     * \brief Move the vertex, face, and attribute buffers of the mesh into a
+     * memory-mapped file
+     *
+     * The buffers are written into a native storage file and subsequently
+     * reference the mapped memory, which lets the operating system page the
+     * geometry in on demand and evict it under memory pressure. This is only
+     * supported in scalar variants.
+     *
+     * \param filename
+     *    Target file path on disk. When empty, a temporary file is created
+     *    that is deleted once the mesh is destroyed.
+     */
+    void move_to_mmap(const fs::path &filename = fs::path());
+
+    /// Is the storage of this mesh backed by a memory-mapped file?
+    bool is_memory_mapped() const { return m_mmap != nullptr; }
+
     // =============================================================
     //! @{ \name Shape interface implementation
     // =============================================================
@@ -234,13 +315,22 @@ public:
             p0 = dr::gather<InputPoint3f>(m_vertex_positions_ptr, fi[0], active),
             p1 = dr::gather<InputPoint3f>(m_vertex_positions_ptr, fi[1], active),
             p2 = dr::gather<InputPoint3f>(m_vertex_positions_ptr, fi[2], active);
+            if (m_vertex_positions_end_ptr) {
+                T time = dr::clamp(T(ray.time), 0.f, 1.f);
+                p0 = dr::lerp(p0, Point3T(dr::gather<InputPoint3f>(
+                                  m_vertex_positions_end_ptr, fi[0], active)), time);
+                p1 = dr::lerp(p1, Point3T(dr::gather<InputPoint3f>(
+                                  m_vertex_positions_end_ptr, fi[1], active)), time);
+                p2 = dr::lerp(p2, Point3T(dr::gather<InputPoint3f>(
+                                  m_vertex_positions_end_ptr, fi[2], active)), time);
+            }
         } else
 #endif
         {
             fi = face_indices(index, active);
-            p0 = vertex_position(fi[0], active),
-            p1 = vertex_position(fi[1], active),
-            p2 = vertex_position(fi[2], active);
+            p0 = vertex_position_at(fi[0], ray.time, active),
+            p1 = vertex_position_at(fi[1], ray.time, active),
+            p2 = vertex_position_at(fi[2], ray.time, active);
         }
 
         auto [t, uv, hit] = moeller_trumbore(ray, p0, p1, p2, active);
@@ -284,6 +374,9 @@ public:
 #if defined(MI_ENABLE_EMBREE)
     /// Return the Embree version of this shape
     virtual RTCGeometry embree_geometry(RTCDevice device) override;
+
+    /// Update the vertex buffer of an Embree geometry after a change
+    virtual void embree_update_geometry(RTCGeometry geom) override;
 #endif
 
 #if defined(MI_ENABLE_CUDA)
@@ -305,11 +398,80 @@ public:
     size_t vertex_data_bytes() const;
     size_t face_data_bytes() const;
 
+    /**
+     * \brief Return the size of the vertex, face, and attribute buffers and
+     * of the surface area distribution
+     *
+     * Buffers that are backed by a memory-mapped file (see \ref
+     * move_to_mmap()) are paged by the operating system and not included.
+     */
+    size_t memory_footprint() const override;
+
 protected:
     Mesh(const Properties &);
     inline Mesh() {}
     virtual ~Mesh();
 
+    /**
+     * \brief Look up the binary mesh cache entry of a mesh loaded from
+     * \c source
+     *
+     * Mesh plugins call this function before parsing their input file when
+     * the \c cache parameter is set. The cache key combines the contents of
+     * the file, the object-to-world transformation, the normal-related
+     * parameters, and the plugin-specific string \c key.
+     *
+     * \return \c true if the mesh buffers were loaded from the cache, in
+     * which case the plugin should skip parsing and call \ref initialize().
+     * Otherwise, the plugin should call \ref cache_store() once it has
+     * loaded the mesh.
+     */
+    bool cache_load(const fs::path &source, const std::string &key = "");
+
+    /// Store the mesh in the cache entry found missing by \ref cache_load()
+    void cache_store();
+
+    /**
+     * \brief Share the buffers of another instance that loaded \c source in
+     * the same way (see \ref AssetCache)
+     *
+     * The entry is identified by the file, the object-to-world
+     * transformation, the normal-related parameters, and the plugin-specific
+     * string \c key. Scalar variants reference the buffers of the shared
+     * entry, while JIT variants reference the same JIT arrays.
+     *
+     * \return \c true if the buffers are shared, in which case the plugin
+     * should skip loading and call \ref initialize(). Otherwise, the plugin
+     * must call \ref asset_store() once it has loaded the mesh, and other
+     * instances loading the same file wait until then.
+     */
+    bool asset_load(const fs::path &source, const std::string &key = "");
+
+    /// Share the mesh buffers in the entry found missing by \ref asset_load()
+    void asset_store();
+
+    /// Replace the mesh buffers by references to those of a shared entry
+    void share_asset(const MeshAsset *asset);
+
+    /**
+     * \brief Write the vertex, face, and attribute buffers into a native
+     * storage file that can be memory-mapped (temporary if \c filename is
+     * empty)
+     */
+    ref<MemoryMappedFile> write_storage(const fs::path &filename) const;
+
+    /**
+     * \brief Replace the mesh buffers by the contents of a storage file
+     * written by \ref write_storage()
+     *
+     * Scalar variants reference the mapped memory, while JIT variants copy
+     * the data into JIT arrays.
+     */
+    void read_storage(MemoryMappedFile *mmap);
+
+    /// Collect the PLY header and buffers of the mesh and pass them to \c func
+    template <typename Func> void write_ply_impl(Func &&func) const;
+
     /**
      * \brief Build internal tables for sampling uniformly wrt. area.
      *
@@ -319,11 +481,12 @@ protected:
     void build_pmf();
 
     /**
-     * \brief Initialize the \c m_parameterization field for mapping UV
-     * coordinates to positions
+     * \brief Build the uniform grid over the UV triangles that \ref
+     * eval_parameterization() uses to map UV coordinates to positions
      *
-     * Internally, the function creates a nested scene to leverage optimized
-     * ray tracing functionality in \ref eval_parameterization()
+     * The grid has about one cell per triangle, and every cell lists the
+     * triangles whose UV bounding box overlaps it. Thread-safe, since it
+     * uses a mutex.
      */
     void build_parameterization();
 
@@ -391,52 +554,99 @@ protected:
         MeshAttributeType type;
         mutable FloatStorage buf;
 
+        /// Precision of the values (\c buf is empty unless it is \c Float)
+        StoragePrecision precision = StoragePrecision::Float;
+        PackedStorage<Float> packed;
+
+        /// Do the three vertices of every face share the same value?
+        bool face_constant = false;
+
+        /// Return the values in single precision (decoding them if necessary)
+        FloatStorage values() const {
+            if (precision == StoragePrecision::Float)
+                return buf;
+            std::vector<dr::scalar_t<Float>> decoded = packed.decode();
+            std::vector<InputFloat> result(decoded.begin(), decoded.end());
+            return dr::load<FloatStorage>(result.data(), result.size());
+        }
+
+        /// Return the number of stored values
+        size_t value_count() const {
+            return precision == StoragePrecision::Float ? buf.size() : packed.size();
+        }
+
+        /// Return the memory footprint of the stored values in bytes
+        size_t nbytes() const {
+            return precision == StoragePrecision::Float
+                       ? buf.size() * sizeof(InputFloat) : packed.nbytes();
+        }
+
         MeshAttribute migrate(AllocType at) const {
-            return MeshAttribute { size, type, dr::migrate(buf, at) };
+            return MeshAttribute { size, type, dr::migrate(values(), at) };
         }
     };
 
-    template <uint32_t Size, bool Raw>
-    auto interpolate_attribute(MeshAttributeType type,
-                               const FloatStorage &buf,
-                               const SurfaceInteraction3f &si,
-                               Mask active) const {
+    /// Compress a single precision attribute to \ref m_attribute_precision
+    void compress_attribute(const std::string &name, MeshAttribute &attribute);
+
+    /// Compress all single precision attributes to \ref m_attribute_precision
+    void compress_attributes();
+
+    /// Detect vertex attributes that are constant over every face
+    void update_attribute_face_constant();
+
+    template <uint32_t Size>
+    auto fetch_attribute(const MeshAttribute &attr, const UInt32 &index,
+                         Mask active) const {
         using StorageType =
             std::conditional_t<Size == 1,
                                dr::replace_scalar_t<Float, InputFloat>,
                                dr::replace_scalar_t<Color3f, InputFloat>>;
         using ReturnType = std::conditional_t<Size == 1, Float, Color3f>;
 
-        if (type == MeshAttributeType::Vertex) {
-            auto fi = face_indices(si.prim_index, active);
-            Point3f b = barycentric_coordinates(si, active);
+        if (attr.precision == StoragePrecision::Float)
+            return (ReturnType) dr::gather<StorageType>(attr.buf, index, active);
 
-            StorageType v0 = dr::gather<StorageType>(buf, fi[0], active),
-                        v1 = dr::gather<StorageType>(buf, fi[1], active),
-                        v2 = dr::gather<StorageType>(buf, fi[2], active);
+        Float values[Size];
+        attr.packed.fetch(index, values, active);
+        if constexpr (Size == 1)
+            return values[0];
+        else
+            return Color3f(values[0], values[1], values[2]);
+    }
 
-            // Barycentric interpolation
-            if constexpr (is_spectral_v<Spectrum> && Size == 3 && !Raw) {
-                // Evaluate spectral upsampling model from stored coefficients
-                UnpolarizedSpectrum c0, c1, c2;
+    template <uint32_t Size, bool Raw>
+    auto interpolate_attribute(const MeshAttribute &attr,
+                               const SurfaceInteraction3f &si,
+                               Mask active) const {
+        using ReturnType = std::conditional_t<Size == 1, Float, Color3f>;
 
+        auto eval = [&](const ReturnType &v) {
+            if constexpr (is_spectral_v<Spectrum> && Size == 3 && !Raw) {
                 // NOTE this code assumes that mesh attribute data represents
                 // srgb2spec model coefficients and not RGB color values in spectral mode.
-                c0 = srgb_model_eval<UnpolarizedSpectrum>(v0, si.wavelengths);
-                c1 = srgb_model_eval<UnpolarizedSpectrum>(v1, si.wavelengths);
-                c2 = srgb_model_eval<UnpolarizedSpectrum>(v2, si.wavelengths);
-
-                return dr::fmadd(c0, b[0], dr::fmadd(c1, b[1], c2 * b[2]));
-            } else {
-                return (ReturnType) dr::fmadd(v0, b[0], dr::fmadd(v1, b[1], v2 * b[2]));
-            }
-        } else {
-            StorageType v = dr::gather<StorageType>(buf, si.prim_index, active);
-            if constexpr (is_spectral_v<Spectrum> && Size == 3 && !Raw) {
                 return srgb_model_eval<UnpolarizedSpectrum>(v, si.wavelengths);
             } else {
-                return (ReturnType) v;
+                return v;
             }
+        };
+
+        if (attr.type == MeshAttributeType::Vertex && !attr.face_constant) {
+            auto fi = face_indices(si.prim_index, active);
+            Point3f b = barycentric_coordinates(si, active);
+
+            ReturnType v0 = fetch_attribute<Size>(attr, fi[0], active),
+                       v1 = fetch_attribute<Size>(attr, fi[1], active),
+                       v2 = fetch_attribute<Size>(attr, fi[2], active);
+
+            // Barycentric interpolation (of the spectra in spectral variants)
+            return dr::fmadd(eval(v0), b[0], dr::fmadd(eval(v1), b[1], eval(v2) * b[2]));
+        } else if (attr.type == MeshAttributeType::Vertex) {
+            // All vertices of the face share the value, skip the interpolation
+            UInt32 index = dr::gather<UInt32>(m_faces, si.prim_index * 3u, active);
+            return eval(fetch_attribute<Size>(attr, index, active));
+        } else {
+            return eval(fetch_attribute<Size>(attr, si.prim_index, active));
         }
     }
 
@@ -448,6 +658,8 @@ protected:
     ScalarSize m_face_count = 0;
 
     mutable FloatStorage m_vertex_positions;
+    /// Vertex positions at time 1 for meshes with vertex motion (empty otherwise)
+    mutable FloatStorage m_vertex_positions_end;
     mutable FloatStorage m_vertex_normals;
     mutable FloatStorage m_vertex_texcoords;
 
@@ -457,26 +669,59 @@ protected:
     /* Data pointer to ensure triangle intersection routine doesn't rely on
        drjit-core when called from an LLVM kernel */
     float* m_vertex_positions_ptr;
+    float* m_vertex_positions_end_ptr = nullptr;
     uint32_t* m_faces_ptr;
 #endif
 
+    /// Object-to-world transformation at time 1 (\c to_world_end parameter)
+    ScalarTransform4f m_to_world_end;
+    bool m_has_to_world_end = false;
+
     std::unordered_map<std::string, MeshAttribute> m_mesh_attributes;
+    /// Precision of the mesh attributes (\c attribute_storage parameter)
+    StoragePrecision m_attribute_precision = StoragePrecision::Float;
+
+    /// Memory-mapped file backing the buffers (see \ref move_to_mmap())
+    ref<MemoryMappedFile> m_mmap;
+    /// Requested location of the memory-mapped storage (if any)
+    bool m_out_of_core = false;
+    fs::path m_out_of_core_file;
+
+    /// Binary mesh cache settings (see \ref cache_load())
+    bool m_cache = false;
+    fs::path m_cache_dir;
+    fs::path m_cache_file;
+
+    /// Buffers shared with other instances (see \ref asset_load())
+    struct MeshAsset;
+    ref<Object> m_asset;
+    AssetCache::Ticket m_asset_ticket;
 
 #if defined(MI_ENABLE_CUDA)
-    mutable void* m_vertex_buffer_ptr = nullptr;
+    /// Vertex buffers of the two motion keys passed to OptiX
+    mutable void* m_vertex_buffer_ptr[2] = { nullptr, nullptr };
 #endif
 
     /// Flag that can be set by the user to disable loading/computation of vertex normals
     bool m_face_normals = false;
     bool m_flip_normals = false;
+    /// Sample faces using an alias table instead of a binary search?
+    bool m_area_alias_table = false;
 
     /* Surface area distribution -- generated on demand when \ref
        prepare_area_pmf() is first called. */
     DiscreteDistribution<Float> m_area_pmf;
     std::mutex m_mutex;
 
-    /// Optional: used in eval_parameterization()
-    ref<Scene<Float, Spectrum>> m_parameterization;
+    /* Uniform grid over the UV triangles -- generated on demand when \ref
+       eval_parameterization() is first called. Cell \c i lists the entries
+       <tt>[m_uv_grid_cells[i], m_uv_grid_cells[i + 1])</tt> of \c
+       m_uv_grid_faces. */
+    DynamicBuffer<UInt32> m_uv_grid_cells;
+    DynamicBuffer<UInt32> m_uv_grid_faces;
+    ScalarPoint2f m_uv_grid_min, m_uv_grid_max;
+    ScalarVector2f m_uv_grid_scale;
+    ScalarVector2u m_uv_grid_res;
 
     /// Pointer to the scene that owns this mesh
     Scene<Float, Spectrum>* m_scene = nullptr;
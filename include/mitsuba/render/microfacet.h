@@ -227,6 +227,29 @@ public:
         return result;
     }
 
+    /**
+     * \brief Variant of \ref pdf() that reuses the values of \ref eval() and
+     * \ref smith_g1() that were already computed by the caller
+     *
+     * Microfacet BSDFs need both quantities to evaluate the model, hence
+     * their combined evaluation and sampling density queries can avoid
+     * recomputing them.
+     *
+     * \param D
+     *     The value of <tt>eval(m)</tt>
+     *
+     * \param smith_g1_wi
+     *     The value of <tt>smith_g1(wi, m)</tt> (only relevant if visible
+     *     normal sampling is used)
+     */
+    Float pdf(const Vector3f &wi, const Vector3f &m, const Float &D,
+              const Float &smith_g1_wi) const {
+        if (m_sample_visible)
+            return D * smith_g1_wi * dr::abs_dot(wi, m) / Frame3f::cos_theta(wi);
+        else
+            return D * Frame3f::cos_theta(m);
+    }
+
     /**
      * \brief Draw a sample from the microfacet normal distribution
      *  and return the associated probability density
@@ -293,6 +316,37 @@ public:
                          cos_theta),
                 pdf
             };
+        } else if (m_type == MicrofacetType::GGX) {
+            /* Visible normal sampling of GGX using spherical caps (Dupuy and
+               Benyoub, "Sampling Visible GGX Normals with Spherical Caps",
+               2023). Equivalent to the slope space method below but needs
+               a single sincos() and no change of frame. */
+
+            // Step 1: stretch wi
+            Vector3f wi_p = dr::normalize(Vector3f(
+                m_alpha_u * wi.x(),
+                m_alpha_v * wi.y(),
+                wi.z()
+            ));
+
+            // Step 2: uniformly sample the spherical cap z in (-wi_p.z, 1]
+            auto [sin_phi, cos_phi] = dr::sincos((2.f * dr::Pi<Float>) * sample.x());
+            Float z = dr::fmsub(1.f - sample.y(), 1.f + wi_p.z(), wi_p.z()),
+                  sin_theta = dr::safe_sqrt(dr::fnmadd(z, z, 1.f));
+
+            // Step 3: the halfway vector is a visible normal for alpha=1
+            Vector3f h(dr::fmadd(sin_theta, cos_phi, wi_p.x()),
+                       dr::fmadd(sin_theta, sin_phi, wi_p.y()),
+                       z + wi_p.z());
+
+            // Step 4: unstretch & compute PDF
+            Normal3f m = dr::normalize(Vector3f(
+                m_alpha_u * h.x(),
+                m_alpha_v * h.y(),
+                h.z()
+            ));
+
+            return { m, pdf(wi, m, eval(m), smith_g1(wi, m)) };
         } else {
             // Visible normal sampling.
             Float sin_phi, cos_phi, cos_theta;
@@ -318,10 +372,7 @@ public:
             // Step 4: compute normal & PDF
             Normal3f m = dr::normalize(Vector3f(-slope.x(), -slope.y(), 1));
 
-            Float pdf = eval(m) * smith_g1(wi, m) * dr::abs_dot(wi, m) /
-                        Frame3f::cos_theta(wi);
-
-            return { m, pdf };
+            return { m, pdf(wi, m, eval(m), smith_g1(wi, m)) };
         }
     }
 
@@ -567,4 +618,52 @@ Float eval_transmittance(const MicrofaceDistributionP &distr,
     return result;
 }
 
+/**
+ * \brief Precomputed tables of a rough dielectric coating on top of a diffuse
+ * base, as used by the \c roughplastic BSDF
+ */
+template <typename ScalarFloat> struct MicrofacetCoatingTables {
+    /// Transmittance into the coating for equidistant cosines in [0, 1]
+    std::vector<ScalarFloat> external_transmittance;
+    /// Hemispherical average of the reflectance at the inside of the coating
+    ScalarFloat internal_reflectance;
+};
+
+/**
+ * \brief Return the tables of a rough dielectric coating
+ *
+ * The tables are computed on first use and cached in a global, thread-safe
+ * cache keyed by the distribution type, roughness, relative index of
+ * refraction and resolution, so that all BSDF instances with the same
+ * parameters share them.
+ */
+template <typename ScalarFloat>
+std::shared_ptr<const MicrofacetCoatingTables<ScalarFloat>>
+microfacet_coating_tables(MicrofacetType type, ScalarFloat alpha,
+                          ScalarFloat eta, uint32_t res);
+
+extern template MI_EXPORT_LIB std::shared_ptr<const MicrofacetCoatingTables<float>>
+microfacet_coating_tables<float>(MicrofacetType, float, float, uint32_t);
+extern template MI_EXPORT_LIB std::shared_ptr<const MicrofacetCoatingTables<double>>
+microfacet_coating_tables<double>(MicrofacetType, double, double, uint32_t);
+
+/**
+ * \brief Return the directional albedo of a microfacet BRDF with a unit
+ * Fresnel factor (i.e. the energy that remains after single scattering)
+ *
+ * The result is a <tt>res x res</tt> table in row-major order. Rows
+ * correspond to equidistant roughness values in [0, 1] and columns to
+ * equidistant cosines of the incident direction in [0, 1]. Like \ref
+ * microfacet_coating_tables(), the table is computed once per distribution
+ * type and resolution and shared afterwards.
+ */
+template <typename ScalarFloat>
+std::shared_ptr<const std::vector<ScalarFloat>>
+microfacet_albedo_table(MicrofacetType type, uint32_t res);
+
+extern template MI_EXPORT_LIB std::shared_ptr<const std::vector<float>>
+microfacet_albedo_table<float>(MicrofacetType, uint32_t);
+extern template MI_EXPORT_LIB std::shared_ptr<const std::vector<double>>
+microfacet_albedo_table<double>(MicrofacetType, uint32_t);
+
 NAMESPACE_END(mitsuba)
@@ -405,5 +405,27 @@ MuellerMatrix rotate_mueller_basis_collinear(const MuellerMatrix &M,
     return R * M * transpose(R);
 }
 
+/**
+ * \brief Apply a Mueller matrix to a Stokes vector
+ *
+ * The Stokes vector \c s is stored in the first column of a Mueller matrix
+ * (see above), whose other columns are ignored. Hence, this is equivalent to
+ * <tt>M * s</tt> for such vectors, but only computes the first column of the
+ * product (16 instead of 64 multiply-adds per spectral sample). The other
+ * columns of the result are zero.
+ */
+template <typename Float>
+MuellerMatrix<Float> apply_stokes(const MuellerMatrix<Float> &M,
+                                  const MuellerMatrix<Float> &s) {
+    MuellerMatrix<Float> result = dr::zeros<MuellerMatrix<Float>>();
+    for (size_t i = 0; i < 4; ++i) {
+        Float value = M(i, 0) * s(0, 0);
+        for (size_t j = 1; j < 4; ++j)
+            value = dr::fmadd(M(i, j), s(j, 0), value);
+        result(i, 0) = value;
+    }
+    return result;
+}
+
 NAMESPACE_END(mueller)
 NAMESPACE_END(mitsuba)
@@ -16,6 +16,7 @@
 
 #include <drjit-core/optix.h>
 
+#include <mitsuba/core/util.h>
 #include <mitsuba/render/optix/common.h>
 #include <mitsuba/render/optix_api.h>
 #include <mitsuba/render/shape.h>
@@ -80,12 +81,28 @@ struct OptixAccelData {
         OptixTraversableHandle handle = 0ull;
         void* buffer = nullptr;
         uint32_t count = 0u;
+        /// Was the GAS built with \c OPTIX_BUILD_FLAG_ALLOW_UPDATE?
+        bool updatable = false;
+        /// Was the GAS built with two motion keys?
+        bool motion = false;
+        /// Size of the GAS in device memory (after compaction) in bytes
+        size_t size = 0;
+        /// Size of the GAS before compaction in bytes
+        size_t build_size = 0;
+        /// Size of the temporary buffer needed by the last build in bytes
+        size_t temp_size = 0;
     };
     HandleData meshes;
     HandleData bspline_curves;
     HandleData linear_curves;
     HandleData custom_shapes;
 
+    /// Return the summed size of the GAS in device memory in bytes
+    size_t size() const {
+        return meshes.size + bspline_curves.size + linear_curves.size +
+               custom_shapes.size;
+    }
+
     ~OptixAccelData() {
         if (meshes.buffer) jit_free(meshes.buffer);
         if (bspline_curves.buffer) jit_free(bspline_curves.buffer);
@@ -94,6 +111,39 @@ struct OptixAccelData {
     }
 };
 
+/**
+ * Build flags of the GAS containing curves. The built-in intersection modules
+ * of the curves are created with the same flags, hence these GAS don't follow
+ * \ref OptixGASOptions and are always rebuilt instead of being refitted.
+ */
+static constexpr unsigned int OPTIX_CURVE_BUILD_FLAGS =
+    OPTIX_BUILD_FLAG_ALLOW_COMPACTION | OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
+
+/// Options controlling how the geometry acceleration structures are built
+struct OptixGASOptions {
+    /// Prefer a fast build over fast traversal (\c OPTIX_BUILD_FLAG_PREFER_FAST_BUILD)
+    bool fast_build = false;
+    /// Compact the GAS after building them
+    bool compaction = true;
+    /// Build the GAS such that they can be refitted (\c OPTIX_BUILD_FLAG_ALLOW_UPDATE)
+    bool allow_update = false;
+    /// Log the memory footprint of every shape and GAS
+    bool memory_report = false;
+
+    /// Return the OptiX build flags of a GAS
+    unsigned int build_flags(bool curves) const {
+        if (curves)
+            return OPTIX_CURVE_BUILD_FLAGS;
+        unsigned int flags = fast_build ? OPTIX_BUILD_FLAG_PREFER_FAST_BUILD
+                                        : OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
+        if (compaction)
+            flags |= OPTIX_BUILD_FLAG_ALLOW_COMPACTION;
+        if (allow_update)
+            flags |= OPTIX_BUILD_FLAG_ALLOW_UPDATE;
+        return flags;
+    }
+};
+
 /// Creates and appends the HitGroupSbtRecord for a given list of shapes
 template <typename Shape>
 void fill_hitgroup_records(std::vector<ref<Shape>> &shapes,
@@ -130,11 +180,19 @@ void fill_hitgroup_records(std::vector<ref<Shape>> &shapes,
  *
  * Two different GAS will be created for the meshes and the custom shapes. Optix
  * handles to those GAS will be stored in an \ref OptixAccelData.
+ *
+ * The build flags, compaction and memory report are controlled by \c options.
+ * When \c options.allow_update is set, the GAS are built such that they can
+ * later be refitted. If \c update is set, GAS that were built this way and
+ * whose shape count did not change are refitted in place instead of being
+ * rebuilt, and GAS without any dirty shape are left untouched.
  */
 template <typename Shape>
 void build_gas(const OptixDeviceContext &context,
                const std::vector<ref<Shape>> &shapes,
-               OptixAccelData& out_accel) {
+               OptixAccelData& out_accel,
+               const OptixGASOptions &options = {},
+               bool update = false) {
 
     // Separate geometry types
     std::vector<ref<Shape>> meshes, bspline_curves,
@@ -151,23 +209,86 @@ void build_gas(const OptixDeviceContext &context,
     }
 
     // Build a GAS given a subset of shape pointers
-    auto build_single_gas = [&context](const std::vector<ref<Shape>> &shape_subset,
-                                       OptixAccelData::HandleData &handle) {
+    auto build_single_gas = [&context, &options, update](
+                                const std::vector<ref<Shape>> &shape_subset,
+                                OptixAccelData::HandleData &handle,
+                                const char *name, bool curves) {
+
+        bool allow_update = options.allow_update && !curves;
 
         OptixAccelBuildOptions accel_options = {};
-        accel_options.buildFlags = OPTIX_BUILD_FLAG_ALLOW_COMPACTION |
-                                   OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
+        accel_options.buildFlags = options.build_flags(curves);
 
         accel_options.operation  = OPTIX_BUILD_OPERATION_BUILD;
         accel_options.motionOptions.numKeys = 0;
+
+        /* Moving meshes provide the vertex positions at the start and the end
+           of the motion, which OptiX interpolates using the ray time */
+        bool motion = false;
+        for (auto &shape : shape_subset)
+            motion |= shape->has_motion();
+        if (motion) {
+            accel_options.motionOptions.numKeys   = 2;
+            accel_options.motionOptions.flags     = OPTIX_MOTION_FLAG_NONE;
+            accel_options.motionOptions.timeBegin = 0.f;
+            accel_options.motionOptions.timeEnd   = 1.f;
+        }
+
+        size_t shapes_count = shape_subset.size();
+        if (update && allow_update && handle.buffer && handle.updatable &&
+            handle.count == shapes_count && handle.motion == motion) {
+            bool dirty = false;
+            for (auto &shape : shape_subset)
+                dirty |= shape->dirty();
+            if (!dirty)
+                return;
+
+            // Refit the existing GAS in place
+            accel_options.operation = OPTIX_BUILD_OPERATION_UPDATE;
+
+            std::vector<OptixBuildInput> build_inputs(shapes_count);
+            for (size_t i = 0; i < shapes_count; i++)
+                shape_subset[i]->optix_build_input(build_inputs[i]);
+
+            dr::sync_thread();
+
+            OptixAccelBufferSizes buffer_sizes;
+            jit_optix_check(optixAccelComputeMemoryUsage(
+                context, &accel_options, build_inputs.data(),
+                (unsigned int) shapes_count, &buffer_sizes));
+
+            void* d_temp_buffer =
+                jit_malloc(AllocType::Device, buffer_sizes.tempUpdateSizeInBytes);
+
+            jit_optix_check(optixAccelBuild(
+                context,
+                (CUstream) jit_cuda_stream(),
+                &accel_options,
+                build_inputs.data(),
+                (unsigned int) shapes_count,
+                (CUdeviceptr) d_temp_buffer,
+                buffer_sizes.tempUpdateSizeInBytes,
+                (CUdeviceptr) handle.buffer,
+                buffer_sizes.outputSizeInBytes,
+                &handle.handle,
+                nullptr, // emitted property list
+                0        // num emitted properties
+            ));
+
+            jit_free(d_temp_buffer);
+            return;
+        }
+
         if (handle.buffer) {
             jit_free(handle.buffer);
             handle.handle = 0ull;
             handle.buffer = nullptr;
             handle.count = 0;
+            handle.updatable = false;
+            handle.motion = false;
+            handle.size = handle.build_size = handle.temp_size = 0;
         }
 
-        size_t shapes_count = shape_subset.size();
         if (shapes_count == 0)
             return;
 
@@ -187,9 +308,27 @@ void build_gas(const OptixDeviceContext &context,
             &buffer_sizes
         ));
 
+        if (options.memory_report) {
+            /* OptiX only reports the footprint of a whole GAS, estimate the
+               one of every shape by sizing a GAS that only contains it */
+            for (size_t i = 0; i < shapes_count; i++) {
+                OptixAccelBufferSizes shape_sizes;
+                jit_optix_check(optixAccelComputeMemoryUsage(
+                    context, &accel_options, &build_inputs[i], 1, &shape_sizes));
+                Log(Info, "  %s GAS: \"%s\" uses %s (+ %s temporary, before compaction)",
+                    name, shape_subset[i]->id(),
+                    util::mem_string(shape_sizes.outputSizeInBytes),
+                    util::mem_string(shape_sizes.tempSizeInBytes));
+            }
+        }
+
+        bool compact = (accel_options.buildFlags &
+                        OPTIX_BUILD_FLAG_ALLOW_COMPACTION) != 0;
+
         void* d_temp_buffer = jit_malloc(AllocType::Device, buffer_sizes.tempSizeInBytes);
         void* output_buffer = jit_malloc(AllocType::Device, buffer_sizes.outputSizeInBytes);
-        void* compact_size_buffer = jit_malloc(AllocType::Device, 8);
+        void* compact_size_buffer =
+            compact ? jit_malloc(AllocType::Device, 8) : nullptr;
 
         OptixAccelEmitDesc emit_property = {};
         emit_property.type   = OPTIX_PROPERTY_TYPE_COMPACTED_SIZE;
@@ -207,17 +346,20 @@ void build_gas(const OptixDeviceContext &context,
             (CUdeviceptr) output_buffer,
             buffer_sizes.outputSizeInBytes,
             &accel,
-            &emit_property,  // emitted property list
-            1                // num emitted properties
+            compact ? &emit_property : nullptr, // emitted property list
+            compact ? 1 : 0                     // num emitted properties
         ));
 
         jit_free(d_temp_buffer);
 
-        size_t compact_size;
-        jit_memcpy(JitBackend::CUDA,
-                   &compact_size,
-                   (void*)emit_property.result,
-                   sizeof(size_t));
+        size_t compact_size = buffer_sizes.outputSizeInBytes;
+        if (compact) {
+            jit_memcpy(JitBackend::CUDA,
+                       &compact_size,
+                       (void*)emit_property.result,
+                       sizeof(size_t));
+            jit_free(compact_size_buffer);
+        }
         if (compact_size < buffer_sizes.outputSizeInBytes) {
             void* compact_buffer = jit_malloc(AllocType::Device, compact_size);
             // Use handle as input and output
@@ -236,15 +378,27 @@ void build_gas(const OptixDeviceContext &context,
         handle.handle = accel;
         handle.buffer = output_buffer;
         handle.count = (uint32_t) shapes_count;
+        handle.updatable = allow_update;
+        handle.motion = motion;
+        handle.size = compact_size;
+        handle.build_size = buffer_sizes.outputSizeInBytes;
+        handle.temp_size = buffer_sizes.tempSizeInBytes;
+
+        if (options.memory_report)
+            Log(Info, "  %s GAS: %u shapes use %s (%s before compaction, "
+                "%s temporary)", name, (uint32_t) shapes_count,
+                util::mem_string(handle.size),
+                util::mem_string(handle.build_size),
+                util::mem_string(handle.temp_size));
     };
 
     scoped_optix_context guard;
 
     // Order: meshes, b-spline curves, linear curves, other
-    build_single_gas(custom_shapes, out_accel.custom_shapes);
-    build_single_gas(meshes, out_accel.meshes);
-    build_single_gas(bspline_curves, out_accel.bspline_curves);
-    build_single_gas(linear_curves, out_accel.linear_curves);
+    build_single_gas(custom_shapes, out_accel.custom_shapes, "Custom shape", false);
+    build_single_gas(meshes, out_accel.meshes, "Mesh", false);
+    build_single_gas(bspline_curves, out_accel.bspline_curves, "B-spline curve", true);
+    build_single_gas(linear_curves, out_accel.linear_curves, "Linear curve", true);
 }
 
 /// Prepares and fills the \ref OptixInstance array associated with a given list of shapes.
@@ -37,6 +37,7 @@ using OptixDenoiserStructPtr = void*;
 #define OPTIX_BUILD_INPUT_TYPE_INSTANCES         0x2143
 #define OPTIX_BUILD_INPUT_TYPE_CURVES            0x2145
 #define OPTIX_BUILD_OPERATION_BUILD              0x2161
+#define OPTIX_BUILD_OPERATION_UPDATE             0x2162
 
 #define OPTIX_GEOMETRY_FLAG_NONE           0
 #define OPTIX_GEOMETRY_FLAG_DISABLE_ANYHIT 1
@@ -54,11 +55,16 @@ using OptixDenoiserStructPtr = void*;
 #define OPTIX_COMPILE_DEBUG_LEVEL_MODERATE       0x2353
 #define OPTIX_COMPILE_DEBUG_LEVEL_FULL           0x2352
 
+#define OPTIX_BUILD_FLAG_NONE                       0
+#define OPTIX_BUILD_FLAG_ALLOW_UPDATE               1
 #define OPTIX_BUILD_FLAG_ALLOW_COMPACTION           2
 #define OPTIX_BUILD_FLAG_PREFER_FAST_TRACE          4
+#define OPTIX_BUILD_FLAG_PREFER_FAST_BUILD          8
 #define OPTIX_BUILD_FLAG_ALLOW_RANDOM_VERTEX_ACCESS 16
 #define OPTIX_PROPERTY_TYPE_COMPACTED_SIZE          0x2181
 
+#define OPTIX_MOTION_FLAG_NONE 0
+
 #define OPTIX_EXCEPTION_FLAG_NONE           0
 #define OPTIX_EXCEPTION_FLAG_STACK_OVERFLOW 1
 #define OPTIX_EXCEPTION_FLAG_TRACE_DEPTH    2
@@ -369,10 +375,25 @@ D(optixDenoiserInvoke, OptixDenoiserStructPtr, CUstream,
   unsigned int, unsigned int, CUdeviceptr, size_t);
 D(optixDenoiserComputeIntensity, OptixDenoiserStructPtr, CUstream,
   const OptixImage2D *inputImage, CUdeviceptr, CUdeviceptr, size_t);
+D(optixDeviceContextSetCacheEnabled, OptixDeviceContext, int);
+D(optixDeviceContextSetCacheLocation, OptixDeviceContext, const char *);
+D(optixDeviceContextSetCacheDatabaseSizes, OptixDeviceContext, size_t, size_t);
 
 #undef D
 
 NAMESPACE_BEGIN(mitsuba)
+/**
+ * \brief Load the OptiX functions used by Mitsuba and configure the on-disk
+ * cache of compiled OptiX modules
+ *
+ * OptiX keys the cache entries by the driver and OptiX versions, the PTX code
+ * and the module and pipeline compile options, hence a process that creates
+ * the same pipeline configuration as a previous one skips the compilation of
+ * the OptiX modules. The cache is stored in a directory that is specific to
+ * the Mitsuba version, which is given by the \c MI_OPTIX_CACHE_DIR
+ * environment variable (default: <tt>~/.cache/mitsuba/optix-VERSION</tt>).
+ * Setting \c MI_OPTIX_CACHE to \c 0 disables the cache.
+ */
 extern MI_EXPORT_LIB void optix_initialize();
 
 /**
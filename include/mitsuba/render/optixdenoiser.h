@@ -40,10 +40,24 @@ public:
      *      Whether or not shading normals information will also be given to the
      *      Denoiser.
      *
+     * \param temporal
+     *      Whether or not temporal denoising will be used (which requires the
+     *      optical flow and the previous denoised frame).
+     *
+     * \param tile_size
+     *      Resolution of the tiles that are denoised one after the other. The
+     *      memory used by the denoiser is proportional to the tile size rather
+     *      than to the image size, which makes it possible to denoise images
+     *      that are too large to be processed at once. Neighboring tiles
+     *      overlap by the number of pixels that the denoiser needs to avoid
+     *      seams. This parameter is optional, by default (zero) the whole image
+     *      is denoised at once.
+     *
      * \return A callable object which will apply the OptiX denoiser.
      */
     OptixDenoiser(const ScalarVector2u &input_size, bool albedo, bool normals,
-                  bool temporal);
+                  bool temporal,
+                  const ScalarVector2u &tile_size = ScalarVector2u(0));
 
     OptixDenoiser(const OptixDenoiser &other) = delete;
 
@@ -189,6 +203,10 @@ private:
                         const TensorXf &previous_denoised) const;
 
     ScalarVector2u m_input_size;
+    ScalarVector2u m_tile_size;
+    /// Number of pixels by which neighboring tiles overlap
+    uint32_t m_overlap;
+    bool m_tiled;
     CUdeviceptr m_state;
     uint32_t m_state_size;
     CUdeviceptr m_scratch;
@@ -0,0 +1,366 @@
+#pragma once
+
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/object.h>
+#include <drjit/dynamic.h>
+#include <drjit/half.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Precision of the values stored by a \ref PackedStorage instance
+enum class StoragePrecision : uint32_t {
+    /// Single precision (textures only use the storage for swizzled layouts)
+    Float,
+
+    /// IEEE 754 half precision
+    Half,
+
+    /// 8 bit unsigned integers with a per-channel scale and offset
+    UNorm8,
+
+    /// 8 bit unsigned integers holding sRGB-encoded values in [0, 1]
+    UNorm8SRGB,
+
+    /// Blocks of 16 texels with 3 bits per value (BC4 encoding of every channel)
+    BC4,
+
+    /// Like \ref BC4, with the endpoints of the blocks holding sRGB-encoded values
+    BC4SRGB
+};
+
+/**
+ * \brief Parse the \c storage parameter of a texture or volume plugin
+ *
+ * Supported values are \c "float", \c "half", \c "unorm8", \c
+ * "unorm8_srgb", \c "bc4" and \c "bc4_srgb".
+ */
+inline StoragePrecision storage_precision(const std::string &name) {
+    if (name == "float")
+        return StoragePrecision::Float;
+    else if (name == "half")
+        return StoragePrecision::Half;
+    else if (name == "unorm8")
+        return StoragePrecision::UNorm8;
+    else if (name == "unorm8_srgb")
+        return StoragePrecision::UNorm8SRGB;
+    else if (name == "bc4")
+        return StoragePrecision::BC4;
+    else if (name == "bc4_srgb")
+        return StoragePrecision::BC4SRGB;
+    Throw("Invalid storage precision \"%s\", must be one of: \"float\", "
+          "\"half\", \"unorm8\", \"unorm8_srgb\", \"bc4\", or "
+          "\"bc4_srgb\"!", name);
+}
+
+/// Does the precision compress blocks of texels instead of individual values?
+inline bool is_block_compressed(StoragePrecision precision) {
+    return precision == StoragePrecision::BC4 ||
+           precision == StoragePrecision::BC4SRGB;
+}
+
+inline std::ostream &operator<<(std::ostream &os, StoragePrecision precision) {
+    switch (precision) {
+        case StoragePrecision::Float:      os << "float"; break;
+        case StoragePrecision::Half:       os << "half"; break;
+        case StoragePrecision::UNorm8:     os << "unorm8"; break;
+        case StoragePrecision::UNorm8SRGB: os << "unorm8_srgb"; break;
+        case StoragePrecision::BC4:        os << "bc4"; break;
+        case StoragePrecision::BC4SRGB:    os << "bc4_srgb"; break;
+        default:                           os << "unknown"; break;
+    }
+    return os;
+}
+
+/**
+ * \brief Flat array of multi-channel texels that are stored with full or
+ * reduced precision
+ *
+ * Values are packed into 32 bit words (one single precision, two half
+ * precision or four 8 bit values each), and decoded to \c Float when they are
+ * fetched. Reduced precisions halve or quarter the memory footprint and
+ * bandwidth of lookups compared to a texture storing single precision values.
+ * 8 bit values either map linearly to the range of every channel (\ref
+ * StoragePrecision::UNorm8), or hold the sRGB encoding of values in [0, 1],
+ * which are converted back to linear values at fetch time (\ref
+ * StoragePrecision::UNorm8SRGB). The latter is appropriate for colors, e.g.
+ * LDR textures and albedos.
+ *
+ * Block-compressed precisions (\ref StoragePrecision::BC4 and \ref
+ * StoragePrecision::BC4SRGB) split the texels into blocks of 16 consecutive
+ * entries and encode every channel of a block like the BC4 format of GPU
+ * texture hardware: two 8 bit endpoints followed by 3 bit indices into the
+ * eight values interpolated between them, i.e. 64 bits per channel and block.
+ * This is a quarter of the footprint of 8 bit values, or an eighth of single
+ * precision ones. Callers should order the texels such that the blocks are
+ * spatially coherent (e.g. 4x4 texel quads of a Z-order curve).
+ */
+template <typename Float> class PackedStorage {
+public:
+    using ScalarFloat = dr::scalar_t<Float>;
+    using UInt32      = dr::uint32_array_t<Float>;
+    using Float32     = dr::float32_array_t<Float>;
+    using Mask        = dr::mask_t<Float>;
+
+    PackedStorage() = default;
+
+    /**
+     * \brief Pack \c count texels with \c channels channels each
+     *
+     * The values of every texel must be consecutive in memory.
+     */
+    PackedStorage(const ScalarFloat *values, size_t count, uint32_t channels,
+                  StoragePrecision precision)
+        : m_precision(precision), m_channels(channels),
+          m_scale(channels, 1.f), m_offset(channels, 0.f) {
+        size_t size = count * channels;
+        bool single = precision == StoragePrecision::Float,
+             half = precision == StoragePrecision::Half,
+             srgb = precision == StoragePrecision::UNorm8SRGB ||
+                    precision == StoragePrecision::BC4SRGB;
+        size_t per_word = single ? 1 : (half ? 2 : 4);
+        std::vector<uint32_t> words((size + per_word - 1) / per_word, 0u);
+
+        if (precision == StoragePrecision::UNorm8 ||
+            precision == StoragePrecision::BC4) {
+            // Map the range of every channel to [0, 255]
+            std::vector<ScalarFloat> lo(channels, dr::Infinity<ScalarFloat>),
+                                     hi(channels, -dr::Infinity<ScalarFloat>);
+            for (size_t i = 0; i < size; ++i) {
+                lo[i % channels] = dr::minimum(lo[i % channels], values[i]);
+                hi[i % channels] = dr::maximum(hi[i % channels], values[i]);
+            }
+            for (uint32_t c = 0; c < channels; ++c) {
+                if (!(lo[c] <= hi[c]))
+                    lo[c] = hi[c] = 0.f;
+                m_offset[c] = lo[c];
+                m_scale[c] = (hi[c] - lo[c]) / 255.f;
+            }
+        } else if (srgb) {
+            for (size_t i = 0; i < size; ++i) {
+                if (!(values[i] >= 0.f && values[i] <= 1.f)) {
+                    Log(Warn, "PackedStorage: values outside of [0, 1] are "
+                              "clamped for the \"%s\" precision.", precision);
+                    break;
+                }
+            }
+        }
+
+        if (is_block_compressed(precision)) {
+            words = compress_blocks(values, count);
+            m_data = dr::load<DynamicBuffer<UInt32>>(words.data(), words.size());
+            m_size = size;
+            return;
+        }
+
+        for (size_t i = 0; i < size; ++i) {
+            ScalarFloat value = values[i];
+            uint32_t code;
+            if (single) {
+                float value_f = (float) value;
+                memcpy(&words[i], &value_f, sizeof(float));
+            } else if (half) {
+                code = dr::half((float) value).value;
+                words[i >> 1] |= code << ((i & 1) << 4);
+            } else {
+                value = quantize(value, (uint32_t) (i % channels));
+                code = (uint32_t) dr::clamp(std::lround(value), 0l, 255l);
+                words[i >> 2] |= code << ((i & 3) << 3);
+            }
+        }
+
+        m_data = dr::load<DynamicBuffer<UInt32>>(words.data(), words.size());
+        m_size = size;
+    }
+
+    /// Return the precision of the stored values
+    StoragePrecision precision() const { return m_precision; }
+
+    /// Return the number of channels per texel
+    uint32_t channels() const { return m_channels; }
+
+    /// Return the number of stored values (texels times channels)
+    size_t size() const { return m_size; }
+
+    /// Return the memory footprint of the stored values in bytes
+    size_t nbytes() const { return m_data.size() * sizeof(uint32_t); }
+
+    /// Fetch and decode the channels of the texel with the given index
+    void fetch(const UInt32 &texel, Float *out, Mask active = true) const {
+        if (is_block_compressed(m_precision)) {
+            for (uint32_t c = 0; c < m_channels; ++c)
+                out[c] = fetch_block_value(texel, c, active);
+            return;
+        }
+
+        UInt32 index = texel * m_channels;
+        for (uint32_t c = 0; c < m_channels; ++c)
+            out[c] = fetch_value(index + c, c, active);
+    }
+
+    /// Decode all values into a host-side array (e.g. to compute statistics)
+    std::vector<ScalarFloat> decode() const {
+        auto &&data = dr::migrate(m_data, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        const uint32_t *words = data.data();
+
+        std::vector<ScalarFloat> result(m_size);
+        if (is_block_compressed(m_precision)) {
+            for (size_t i = 0; i < m_size; ++i) {
+                size_t texel = i / m_channels;
+                uint32_t c = (uint32_t) (i % m_channels);
+                size_t base = ((texel >> 4) * m_channels + c) << 1;
+                uint64_t bits = (uint64_t) (words[base] >> 16) |
+                                ((uint64_t) words[base + 1] << 16);
+                ScalarFloat lo = (ScalarFloat) (words[base] & 0xFFu),
+                            hi = (ScalarFloat) ((words[base] >> 8) & 0xFFu),
+                            k  = (ScalarFloat) ((bits >> ((texel & 15) * 3)) & 7u);
+                result[i] = dequantize(dr::fmadd(hi - lo, k * (1.f / 7.f), lo), c);
+            }
+            return result;
+        }
+
+        for (size_t i = 0; i < m_size; ++i) {
+            if (m_precision == StoragePrecision::Float) {
+                float value;
+                memcpy(&value, &words[i], sizeof(float));
+                result[i] = (ScalarFloat) value;
+            } else if (m_precision == StoragePrecision::Half) {
+                dr::half h = dr::half::from_binary(
+                    (uint16_t) (words[i >> 1] >> ((i & 1) << 4)));
+                result[i] = (ScalarFloat) (float) h;
+            } else {
+                ScalarFloat v = (ScalarFloat) ((words[i >> 2] >> ((i & 3) << 3)) & 0xFFu);
+                result[i] = dequantize(v, (uint32_t) (i % m_channels));
+            }
+        }
+        return result;
+    }
+
+protected:
+    /// Fetch and decode the value with index \c i of channel \c c
+    Float fetch_value(const UInt32 &i, uint32_t c, const Mask &active) const {
+        if (m_precision == StoragePrecision::Float)
+            return Float(dr::reinterpret_array<Float32>(
+                dr::gather<UInt32>(m_data, i, active)));
+
+        if (m_precision == StoragePrecision::Half) {
+            UInt32 word = dr::gather<UInt32>(m_data, i >> 1, active),
+                   bits = (word >> ((i & 1u) << 4)) & 0xFFFFu;
+
+            /* Move the exponent and mantissa into place and rebias the
+               exponent with a multiplication (also handles denormals) */
+            Float32 value = dr::reinterpret_array<Float32>((bits & 0x7FFFu) << 13) *
+                            Float32(0x1p112f);
+            value = dr::select(dr::eq(bits & 0x7C00u, 0x7C00u),
+                               dr::Infinity<Float32>, value);
+            return Float(dr::select(dr::neq(bits & 0x8000u, 0u), -value, value));
+        }
+
+        UInt32 word = dr::gather<UInt32>(m_data, i >> 2, active);
+        return dequantize(Float((word >> ((i & 3u) << 3)) & 0xFFu), c);
+    }
+
+    /// Fetch and decode channel \c c of a texel from its compressed block
+    Float fetch_block_value(const UInt32 &texel, uint32_t c, const Mask &active) const {
+        using UInt64 = dr::uint64_array_t<Float>;
+
+        UInt32 base = ((texel >> 4) * m_channels + c) << 1,
+               w0   = dr::gather<UInt32>(m_data, base, active),
+               w1   = dr::gather<UInt32>(m_data, base + 1u, active);
+
+        // 16 bits of indices follow the endpoints, the others are in 'w1'
+        UInt64 bits = UInt64(w0 >> 16) | (UInt64(w1) << 16);
+        UInt32 k = UInt32(bits >> UInt64((texel & 15u) * 3u)) & 7u;
+
+        Float lo = Float(w0 & 0xFFu), hi = Float((w0 >> 8) & 0xFFu);
+        return dequantize(dr::fmadd(hi - lo, Float(k) * (1.f / 7.f), lo), c);
+    }
+
+    /// Map a value of channel \c c to the 8 bit range [0, 255] (not rounded)
+    ScalarFloat quantize(ScalarFloat value, uint32_t c) const {
+        if (m_precision == StoragePrecision::UNorm8SRGB ||
+            m_precision == StoragePrecision::BC4SRGB)
+            return srgb_encode(dr::clamp(value, 0.f, 1.f)) * 255.f;
+        else if (m_scale[c] > 0.f)
+            return (value - m_offset[c]) / m_scale[c];
+        return 0.f;
+    }
+
+    /// Inverse of \ref quantize()
+    template <typename Value> Value dequantize(const Value &value, uint32_t c) const {
+        if (m_precision == StoragePrecision::UNorm8SRGB ||
+            m_precision == StoragePrecision::BC4SRGB)
+            return srgb_decode(value * (1.f / 255.f));
+        return dr::fmadd(value, m_scale[c], m_offset[c]);
+    }
+
+    /**
+     * \brief Encode blocks of 16 texels, every channel of which stores the
+     * lower and upper endpoint of the block (8 bits each) followed by 16
+     * indices of 3 bits into the values interpolated between them
+     */
+    std::vector<uint32_t> compress_blocks(const ScalarFloat *values,
+                                          size_t count) const {
+        size_t blocks = (count + 15) / 16;
+        std::vector<uint32_t> words(blocks * m_channels * 2, 0u);
+        ScalarFloat codes[16];
+
+        for (size_t b = 0; b < blocks; ++b) {
+            size_t n = std::min(count - b * 16, (size_t) 16);
+            for (uint32_t c = 0; c < m_channels; ++c) {
+                ScalarFloat q_min = dr::Infinity<ScalarFloat>,
+                            q_max = -dr::Infinity<ScalarFloat>;
+                for (size_t j = 0; j < n; ++j) {
+                    codes[j] = dr::clamp(
+                        quantize(values[(b * 16 + j) * m_channels + c], c), 0.f, 255.f);
+                    q_min = dr::minimum(q_min, codes[j]);
+                    q_max = dr::maximum(q_max, codes[j]);
+                }
+
+                // Endpoints that enclose all values of the block
+                uint32_t lo = (uint32_t) std::floor(q_min),
+                         hi = (uint32_t) std::ceil(q_max);
+                ScalarFloat range = (ScalarFloat) (hi - lo);
+
+                uint64_t bits = 0;
+                for (size_t j = 0; j < n; ++j) {
+                    uint64_t k = 0;
+                    if (range > 0.f)
+                        k = (uint64_t) dr::clamp(
+                            std::lround((codes[j] - lo) / range * 7.f), 0l, 7l);
+                    bits |= k << (j * 3);
+                }
+
+                size_t base = (b * m_channels + c) * 2;
+                words[base]     = lo | (hi << 8) | ((uint32_t) (bits & 0xFFFFu) << 16);
+                words[base + 1] = (uint32_t) (bits >> 16);
+            }
+        }
+
+        return words;
+    }
+
+    template <typename Value> static Value srgb_decode(const Value &v) {
+        return dr::select(v <= 0.04045f, v * (1.f / 12.92f),
+                          dr::pow((v + 0.055f) * (1.f / 1.055f), 2.4f));
+    }
+
+    static ScalarFloat srgb_encode(ScalarFloat v) {
+        return v <= 0.0031308f ? v * 12.92f
+                               : 1.055f * std::pow(v, 1.f / 2.4f) - 0.055f;
+    }
+
+protected:
+    StoragePrecision m_precision = StoragePrecision::Float;
+    uint32_t m_channels = 0;
+    size_t m_size = 0;
+    DynamicBuffer<UInt32> m_data;
+    std::vector<ScalarFloat> m_scale;
+    std::vector<ScalarFloat> m_offset;
+};
+
+NAMESPACE_END(mitsuba)
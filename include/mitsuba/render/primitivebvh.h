@@ -0,0 +1,323 @@
+#pragma once
+
+#include <mitsuba/core/bbox.h>
+#include <mitsuba/core/parallel.h>
+#include <mitsuba/core/ray.h>
+#include <drjit/morton.h>
+#include <algorithm>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(MI_ENABLE_EMBREE)
+    #include <embree3/rtcore.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Binary bounding volume hierarchy over the primitives of a shape
+ *
+ * Shape plugins whose primitives are intersected by the plugin itself (e.g.
+ * clusters of compressed triangles, displaced patches, or instances) use this
+ * class to trace rays in scalar variants. In contrast to \ref ShapeBVH, which
+ * uses the surface area heuristic, this hierarchy is cheap to build: the
+ * primitives are expected to be ordered along a Morton curve (see \ref
+ * morton_order()), and every node splits its range of primitives at the
+ * median. Leaves hence reference contiguous ranges of primitives.
+ */
+class PrimitiveBVH {
+public:
+    using BoundingBox3f = BoundingBox<Point<float, 3>>;
+
+    /// Node: leaves (count > 0) reference primitives, inner nodes their right child
+    struct Node {
+        float bounds[6];
+        uint32_t offset = 0, count = 0;
+    };
+
+    /**
+     * \brief Return the permutation that orders \c count points along a Morton
+     * curve through their bounding box
+     *
+     * \c point(i) returns the i-th point (e.g. the center of a primitive).
+     */
+    template <typename Func>
+    static std::vector<uint32_t> morton_order(uint32_t count, const Func &point) {
+        using Point3 = std::decay_t<decltype(point(0u))>;
+        using Vector3u = dr::Array<uint32_t, 3>;
+
+        BoundingBox<Point3> bbox;
+        for (uint32_t i = 0; i < count; ++i)
+            bbox.expand(point(i));
+        auto extents = dr::maximum(bbox.extents(), 1e-30f);
+
+        std::vector<uint64_t> codes(count);
+        blocked_parallel_for(count, 1 << 16, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                auto rel = dr::clamp((point(i) - bbox.min) / extents, 0.f, 1.f);
+                uint64_t code = dr::morton_encode(Vector3u(rel * 1023.f));
+                codes[i] = (code << 32) | (uint64_t) i;
+            }
+        });
+        std::sort(codes.begin(), codes.end());
+
+        std::vector<uint32_t> order(count);
+        for (uint32_t i = 0; i < count; ++i)
+            order[i] = (uint32_t) (codes[i] & 0xFFFFFFFFu);
+        return order;
+    }
+
+    /**
+     * \brief Build the hierarchy over \c count primitives
+     *
+     * \param leaf_size
+     *     Maximum number of primitives per leaf
+     *
+     * \param bbox
+     *     Callback returning the bounding box of the i-th primitive
+     *
+     * \param leaf
+     *     Callback that receives the range <tt>[begin, end)</tt> of primitives
+     *     of a leaf and returns the pair <tt>(offset, count)</tt> stored in it,
+     *     e.g. to repack the primitives into groups. The count must be
+     *     positive.
+     */
+    template <typename BBoxFunc, typename LeafFunc>
+    void build(uint32_t count, uint32_t leaf_size, const BBoxFunc &bbox,
+               const LeafFunc &leaf) {
+        m_nodes.clear();
+        m_nodes.reserve(2 * (count / leaf_size + 1));
+        if (count > 0)
+            build_node(0, count, leaf_size, bbox, leaf);
+    }
+
+    /// Build the hierarchy, every leaf references its range of primitives
+    template <typename BBoxFunc>
+    void build(uint32_t count, uint32_t leaf_size, const BBoxFunc &bbox) {
+        build(count, leaf_size, bbox, [](uint32_t begin, uint32_t end) {
+            return std::make_pair(begin, end - begin);
+        });
+    }
+
+    /**
+     * \brief Traverse the hierarchy
+     *
+     * The callback receives the index of every leaf entry whose leaf is hit
+     * by the ray along with the current maximum distance, and returns the new
+     * maximum distance (or a negative value to stop the traversal).
+     */
+    template <typename Ray, typename Func>
+    void traverse(const Ray &ray, Func &&func) const {
+        using Value = typename Ray::Float;
+
+        if (m_nodes.empty())
+            return;
+
+        Value t = ray.maxt;
+        typename Ray::Vector d_rcp = dr::rcp(ray.d);
+        uint32_t stack[64];
+        uint32_t stack_size = 0, index = 0;
+
+        while (true) {
+            const Node &node = m_nodes[index];
+
+            if (intersect_bbox(node.bounds, ray, d_rcp, t)) {
+                if (node.count > 0) {
+                    for (uint32_t i = 0; i < node.count; ++i) {
+                        t = func(node.offset + i, t);
+                        if (t < 0.f)
+                            return;
+                    }
+                } else {
+                    Assert(stack_size < 64);
+                    stack[stack_size++] = node.offset;
+                    index = index + 1;
+                    continue;
+                }
+            }
+
+            if (stack_size == 0)
+                break;
+            index = stack[--stack_size];
+        }
+    }
+
+    /**
+     * \brief Slab test of a ray against the box stored in \c bounds (minimum
+     * followed by maximum) up to the distance \c maxt
+     */
+    template <typename Ray>
+    MI_INLINE static bool intersect_bbox(const float *bounds, const Ray &ray,
+                                         const typename Ray::Vector &d_rcp,
+                                         typename Ray::Float maxt) {
+        using Vector3 = typename Ray::Vector;
+        Vector3 t1 = (Vector3(dr::load<dr::Array<float, 3>>(bounds)) - ray.o) * d_rcp,
+                t2 = (Vector3(dr::load<dr::Array<float, 3>>(bounds + 3)) - ray.o) * d_rcp;
+        auto mint = dr::max(dr::minimum(t1, t2)),
+             maxt_ = dr::min(dr::maximum(t1, t2));
+        // Conservative when the ray is parallel to a slab (NaN values)
+        return !(maxt_ < dr::maximum(mint, 0.f)) && !(mint > maxt);
+    }
+
+    /// Return the bounding box of the hierarchy
+    BoundingBox3f bbox() const {
+        if (m_nodes.empty())
+            return BoundingBox3f();
+        return node_bbox(0);
+    }
+
+    /// Return the bounding box of a node
+    BoundingBox3f node_bbox(uint32_t index) const {
+        const float *b = m_nodes[index].bounds;
+        return BoundingBox3f(dr::load<Point<float, 3>>(b),
+                             dr::load<Point<float, 3>>(b + 3));
+    }
+
+    /// Return the number of nodes
+    size_t node_count() const { return m_nodes.size(); }
+
+    /// Return the memory used by the nodes in bytes
+    size_t memory_footprint() const { return m_nodes.size() * sizeof(Node); }
+
+    /// Release the nodes
+    void clear() { m_nodes = std::vector<Node>(); }
+
+private:
+    template <typename BBoxFunc, typename LeafFunc>
+    uint32_t build_node(uint32_t begin, uint32_t end, uint32_t leaf_size,
+                        const BBoxFunc &bbox_func, const LeafFunc &leaf) {
+        using BBox = std::decay_t<decltype(bbox_func(0u))>;
+
+        uint32_t index = (uint32_t) m_nodes.size();
+        m_nodes.emplace_back();
+
+        BBox bbox;
+        if (end - begin <= leaf_size) {
+            for (uint32_t i = begin; i < end; ++i)
+                bbox.expand(bbox_func(i));
+            std::tie(m_nodes[index].offset, m_nodes[index].count) = leaf(begin, end);
+        } else {
+            uint32_t mid = begin + (end - begin) / 2;
+            uint32_t left  = build_node(begin, mid, leaf_size, bbox_func, leaf),
+                     right = build_node(mid, end, leaf_size, bbox_func, leaf);
+            bbox.expand(BBox(node_bbox(left)));
+            bbox.expand(BBox(node_bbox(right)));
+            m_nodes[index].offset = right;
+            m_nodes[index].count  = 0;
+        }
+
+        /* Empty primitives keep an invalid box, which is never intersected */
+        dr::store(m_nodes[index].bounds,     dr::Array<float, 3>(bbox.min));
+        dr::store(m_nodes[index].bounds + 3, dr::Array<float, 3>(bbox.max));
+        return index;
+    }
+
+private:
+    std::vector<Node> m_nodes;
+};
+
+#if defined(MI_ENABLE_EMBREE)
+/// Intersection with a primitive of an \ref EmbreeUserGeometry
+struct EmbreeUserHit {
+    /// Distance along the ray and surface parameterization of the hit
+    float t = 0.f, u = 0.f, v = 0.f;
+    /// Identifiers reported to the scene (default to the intersected primitive)
+    uint32_t geom_id = 0, prim_id = 0, inst_id = 0;
+};
+
+/**
+ * \brief Embree user geometry whose primitives are intersected by a shape
+ *
+ * The shape provides the member functions
+ *
+ * \code
+ * ScalarBoundingBox3f embree_bbox(uint32_t index) const;
+ *
+ * template <bool ShadowRay>
+ * bool embree_intersect(uint32_t index, const ScalarRay3f &ray,
+ *                       EmbreeUserHit &hit) const;
+ * \endcode
+ *
+ * The latter intersects the given primitive up to <tt>ray.maxt</tt> and
+ * fills \c hit when successful.
+ */
+template <typename Shape> struct EmbreeUserGeometry {
+    using ScalarRay3f = typename Shape::ScalarRay3f;
+
+    /// Create and commit the geometry for \c count primitives of \c shape
+    static RTCGeometry create(RTCDevice device, const Shape *shape, uint32_t count) {
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_USER);
+        rtcSetGeometryUserPrimitiveCount(geom, (unsigned int) count);
+        rtcSetGeometryUserData(geom, (void *) shape);
+        rtcSetGeometryBoundsFunction(geom, bounds, nullptr);
+        rtcSetGeometryIntersectFunction(geom, intersect);
+        rtcSetGeometryOccludedFunction(geom, occluded);
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+
+    static void bounds(const RTCBoundsFunctionArguments *args) {
+        const Shape *shape = (const Shape *) args->geometryUserPtr;
+        auto bbox = shape->embree_bbox(args->primID);
+        RTCBounds *bounds = args->bounds_o;
+        bounds->lower_x = (float) bbox.min.x();
+        bounds->lower_y = (float) bbox.min.y();
+        bounds->lower_z = (float) bbox.min.z();
+        bounds->upper_x = (float) bbox.max.x();
+        bounds->upper_y = (float) bbox.max.y();
+        bounds->upper_z = (float) bbox.max.z();
+    }
+
+    // The scalar variants trace individual rays, hence N is always 1
+    static ScalarRay3f ray(const RTCRay &rtc_ray) {
+        ScalarRay3f ray;
+        ray.o    = typename ScalarRay3f::Point(rtc_ray.org_x, rtc_ray.org_y, rtc_ray.org_z);
+        ray.d    = typename ScalarRay3f::Vector(rtc_ray.dir_x, rtc_ray.dir_y, rtc_ray.dir_z);
+        ray.time = rtc_ray.time;
+        ray.o += ray.d * rtc_ray.tnear;
+        ray.maxt = rtc_ray.tfar - rtc_ray.tnear;
+        return ray;
+    }
+
+    static void intersect(const RTCIntersectFunctionNArguments *args) {
+        if (args->N != 1 || !args->valid[0])
+            return;
+
+        const Shape *shape = (const Shape *) args->geometryUserPtr;
+        RTCRayHit *rtc = (RTCRayHit *) args->rayhit;
+
+        EmbreeUserHit hit;
+        hit.geom_id = args->geomID;
+        hit.prim_id = args->primID;
+        hit.inst_id = args->context->instID[0];
+
+        if (shape->template embree_intersect<false>(args->primID, ray(rtc->ray), hit)) {
+            rtc->ray.tfar      = hit.t + rtc->ray.tnear;
+            rtc->hit.u         = hit.u;
+            rtc->hit.v         = hit.v;
+            rtc->hit.Ng_x      = 0.f;
+            rtc->hit.Ng_y      = 0.f;
+            rtc->hit.Ng_z      = 0.f;
+            rtc->hit.geomID    = hit.geom_id;
+            rtc->hit.primID    = hit.prim_id;
+            rtc->hit.instID[0] = hit.inst_id;
+        }
+    }
+
+    static void occluded(const RTCOccludedFunctionNArguments *args) {
+        if (args->N != 1 || !args->valid[0])
+            return;
+
+        const Shape *shape = (const Shape *) args->geometryUserPtr;
+        RTCRay *rtc = (RTCRay *) args->ray;
+
+        EmbreeUserHit hit;
+        if (shape->template embree_intersect<true>(args->primID, ray(*rtc), hit))
+            rtc->tfar = -dr::Infinity<float>;
+    }
+};
+#endif
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <mitsuba/core/object.h>
+#include <mitsuba/render/fwd.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Kind of rays that are traced by a \ref RayBenchmark
+enum class RayBenchmarkType : uint32_t {
+    /// Camera rays through uniformly distributed positions on the film
+    Primary,
+
+    /// Cosine-distributed rays leaving the surfaces hit by primary rays
+    Diffuse,
+
+    /// Rays from the surfaces hit by primary rays towards points on emitters
+    Shadow
+};
+
+/// Measurements of one \ref RayBenchmark::run()
+struct MI_EXPORT_LIB RayBenchmarkResult {
+    /// Kind of the traced rays
+    RayBenchmarkType type = RayBenchmarkType::Primary;
+
+    /// Number of generated rays
+    size_t ray_count = 0;
+
+    /**
+     * \brief Number of traced rays. Diffuse and shadow rays are only traced
+     * from primary rays that hit a surface, hence this can be smaller than
+     * \ref ray_count.
+     */
+    size_t traced_count = 0;
+
+    /// Number of traced rays that hit a surface (or were occluded)
+    size_t hit_count = 0;
+
+    /// Maximal number of rays traced at once
+    uint32_t batch_size = 0;
+
+    /// Number of passes over each batch that were averaged in \ref warm_time
+    uint32_t warm_passes = 0;
+
+    /// Time of the first pass over all batches in seconds
+    double cold_time = 0.0;
+
+    /// Average time of the following passes over all batches in seconds
+    double warm_time = 0.0;
+
+    /// Ray throughput of the first pass
+    double cold_rays_per_second() const {
+        return cold_time > 0.0 ? (double) traced_count / cold_time : 0.0;
+    }
+
+    /// Ray throughput of the following passes
+    double warm_rays_per_second() const {
+        return warm_time > 0.0 ? (double) traced_count / warm_time : 0.0;
+    }
+
+    std::string to_string() const;
+};
+
+inline std::ostream &operator<<(std::ostream &os,
+                                const RayBenchmarkResult &result) {
+    return os << result.to_string();
+}
+
+/**
+ * \brief Harness that measures the ray tracing throughput of a scene
+ *
+ * This class generates batches of primary, diffuse and shadow rays for a
+ * scene and traces them with \ref Scene::ray_intersect_preliminary() (primary
+ * and diffuse rays) or \ref Scene::ray_test() (shadow rays), which allows
+ * comparing acceleration data structures and their build parameters (e.g.
+ * \c kd_intersection_cost, \c kd_stop_prims, \c kd_min_max_bins) independently
+ * of the cost of shading.
+ *
+ * Primary rays are sampled from the first sensor of the scene, or from a
+ * sphere around the scene if it doesn't have a sensor. Diffuse and shadow
+ * rays start on the surfaces hit by primary rays. All rays are determined by
+ * the seed and their index, hence consecutive runs trace the same rays.
+ *
+ * The rays of a batch are generated before the timed passes. The first pass
+ * over a batch measures cold caches (and includes the kernel compilation of
+ * JIT variants, unless the kernel was cached by an earlier run), while the
+ * following passes trace the same batch again with warm caches. Scalar
+ * variants trace the rays of a batch in parallel on all worker threads.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB RayBenchmark : public Object {
+public:
+    MI_IMPORT_TYPES(Scene, Sensor)
+
+    /**
+     * \brief Create a benchmark for the given scene
+     *
+     * \param batch_size
+     *     Maximal number of rays that are generated and traced at once
+     *
+     * \param seed
+     *     Seed of the generated rays
+     */
+    RayBenchmark(const Scene *scene, uint32_t batch_size = 1u << 20,
+                 uint32_t seed = 0);
+
+    /**
+     * \brief Trace \c ray_count rays of the given kind and measure the time
+     *
+     * \param warm_passes
+     *     Number of passes over each batch after the first (cold) one
+     */
+    RayBenchmarkResult run(RayBenchmarkType type, size_t ray_count,
+                           uint32_t warm_passes = 3) const;
+
+    /// Return the maximal number of rays that are traced at once
+    uint32_t batch_size() const { return m_batch_size; }
+
+    /// Set the maximal number of rays that are traced at once
+    void set_batch_size(uint32_t batch_size);
+
+    /// Return the seed of the generated rays
+    uint32_t seed() const { return m_seed; }
+
+    /// Return the scene whose rays are traced
+    const Scene *scene() const { return m_scene.get(); }
+
+    std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+
+protected:
+    virtual ~RayBenchmark() = default;
+
+    /**
+     * \brief Generate the rays with the given global indices
+     *
+     * \return The rays and a mask of the ones that should be traced
+     */
+    std::pair<Ray3f, Mask> generate(RayBenchmarkType type,
+                                    const UInt32 &index) const;
+
+protected:
+    ref<const Scene> m_scene;
+    uint32_t m_batch_size;
+    uint32_t m_seed;
+};
+
+MI_EXTERN_CLASS(RayBenchmark)
+NAMESPACE_END(mitsuba)
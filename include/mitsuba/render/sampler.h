@@ -96,6 +96,20 @@ public:
     virtual void seed(uint32_t seed,
                       uint32_t wavefront_size = (uint32_t) -1);
 
+    /**
+     * \brief Seed the sampler for one pass of a progressive render
+     *
+     * Renderers that split the samples of every pixel into several passes
+     * call this function instead of \ref seed(). The default implementation
+     * forwards \c seed, which differs between passes. Samplers generating a
+     * single sequence per pixel instead use \c sequence_seed, which is the
+     * same in every pass, and skip the \c sample_offset samples taken by the
+     * previous passes. This preserves the stratification of the complete
+     * sequence for any split into passes.
+     */
+    virtual void seed_pass(uint32_t seed, uint32_t sequence_seed,
+                           uint32_t sample_offset);
+
     /**
      * \brief Advance to the next sample.
      *
@@ -122,6 +136,13 @@ public:
     /// Return whether the sampler was seeded
     bool seeded() const { return m_wavefront_size > 0; }
 
+    /**
+     * \brief Return the index of the current sample within its pixel
+     *
+     * The index counts the samples taken since the sampler was last seeded.
+     */
+    UInt32 current_sample_index() const;
+
     /// Set the number of samples per pixel per pass in wavefront modes (default is 1)
     void set_samples_per_wavefront(uint32_t samples_per_wavefront);
 
@@ -140,8 +161,6 @@ protected:
 
     /// Generates a array of seeds where the seed values are unique per sequence
     UInt32 compute_per_sequence_seed(uint32_t seed) const;
-    /// Return the index of the current sample
-    UInt32 current_sample_index() const;
 
 protected:
     /// Base seed value
@@ -3,12 +3,30 @@
 #include <mitsuba/core/distr_1d.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/render/emitter.h>
+#include <mitsuba/render/lightgrid.h>
+#include <mitsuba/render/lighttree.h>
 #include <mitsuba/render/shapegroup.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/sensor.h>
+#include <map>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Strategy used by the \ref Scene to choose an emitter for direct illumination
+enum class EmitterSamplingMode : uint32_t {
+    /// Proportional to the \c sampling_weight of every emitter
+    Weight,
+
+    /// Proportional to the sampling weight times the estimated flux
+    Power,
+
+    /// Using a \ref LightTree that also accounts for the reference point
+    LightTree,
+
+    /// Using a \ref LightGrid of the point and spot lights near the reference point
+    LightGrid
+};
+
 /**
  * \brief Central scene data structure
  *
@@ -37,7 +55,8 @@ template <typename Float, typename Spectrum>
 class MI_EXPORT_LIB Scene : public Object {
 public:
     MI_IMPORT_TYPES(BSDF, Emitter, EmitterPtr, Film, Sampler, Shape, ShapePtr,
-                    ShapeGroup, Sensor, Integrator, Medium, MediumPtr, Mesh)
+                    ShapeGroup, Sensor, Integrator, Medium, MediumPtr, Mesh,
+                    LightGrid, LightTree, Texture)
 
     /// Instantiate a scene from a \ref Properties object
     Scene(const Properties &props);
@@ -230,6 +249,12 @@ public:
      * ray_intersect() method will re-evaluate certain parts of the computation
      * with derivative tracking to rectify this.
      *
+     * Like the other ray tracing functions, this function skips
+     * intersections with alpha-tested shapes that fail their alpha test (see
+     * \ref BSDF::alpha_test()). The scalar variants evaluate the test within
+     * the traversal of the acceleration data structure, while the JIT
+     * variants continue the ray past rejected intersections.
+     *
      * In vectorized variants of Mitsuba (<tt>cuda_*</tt> or <tt>llvm_*</tt>),
      * the function processes arrays of rays and returns arrays of preliminary
      * intersection records following the usual conventions.
@@ -259,6 +284,64 @@ public:
                                                         Mask coherent = false,
                                                         Mask active = true) const;
 
+    /**
+     * \brief Intersect a group of coherent rays (scalar variants only)
+     *
+     * Equivalent to calling \ref ray_intersect_preliminary() for each of the
+     * \c count rays, but the CPU backends trace up to 16 rays at a time as a
+     * packet (the kd-tree via \ref ShapeKDTree::ray_intersect_packet(),
+     * Embree via <tt>rtcIntersect16()</tt>), which shares the traversal of
+     * rays that visit the same nodes, e.g. the primary rays of neighboring
+     * pixels. Scenes with alpha-tested shapes and the BVH trace the rays one
+     * by one.
+     */
+    void ray_intersect_preliminary_packet(const Ray3f *rays,
+                                          PreliminaryIntersection3f *pi,
+                                          size_t count) const;
+
+    /**
+     * \brief Find the first surface along a shadow ray that can change its
+     * transmittance
+     *
+     * Intersections with \a passthrough surfaces, whose BSDF is a pure \c
+     * null BSDF and which do not separate different media, are skipped
+     * without computing their surface interaction or evaluating their BSDF.
+     * The CPU backends skip them within a single traversal of the
+     * acceleration data structure, while the CUDA backend continues the ray
+     * past each of them. The returned record describes the first other
+     * surface (e.g. an opaque occluder, or a null interface of a
+     * participating medium), and its distance \c t is measured from the
+     * origin of \c ray. Hence, it also provides the distance to the nearest
+     * occluder, which is infinite when the ray is unoccluded.
+     *
+     * When the scene contains no passthrough surfaces, this function is
+     * equivalent to \ref ray_intersect().
+     */
+    SurfaceInteraction3f ray_intersect_occluder(const Ray3f &ray,
+                                                uint32_t ray_flags = +RayFlags::All,
+                                                Mask active = true) const;
+
+    /// Does the scene contain surfaces skipped by \ref ray_intersect_occluder()?
+    bool has_passthrough_shapes() const { return m_passthrough_shapes; }
+
+    /// Does the scene contain shapes whose BSDF performs an alpha test?
+    bool has_alpha_tested_shapes() const { return m_alpha_tested_shapes; }
+
+    /**
+     * \brief Return the fields of the surface interaction (as a combination
+     * of \ref RayFlags) that the BSDFs, textures and emitters of the shapes
+     * read
+     *
+     * Always includes \ref RayFlags::Minimal and \ref RayFlags::ShadingFrame.
+     * The UV coordinates are only requested when a texture is not uniform,
+     * and the position partials when a BSDF asks for them (see \ref
+     * BSDF::ray_flags()). Integrators that only pass their surface
+     * interactions on to the plugins of the scene can intersect rays with
+     * these flags instead of \ref RayFlags::All, which skips the remaining
+     * fields. The flags are gathered whenever the shapes change.
+     */
+    uint32_t ray_flags() const { return m_ray_flags; }
+
     /**
      * \brief Ray intersection using a brute force search. Used in
      * unit tests to validate the kdtree-based ray tracer.
@@ -351,6 +434,14 @@ public:
      * the sampled emitter position. However, approximations are acceptable as
      * long as these are reflected in the returned Monte Carlo sampling weight.
      *
+     * By default, the emitter is chosen independently of \c ref (see \ref
+     * sample_emitter()). When the \c emitter_sampling parameter of the scene
+     * is set to \c "light_tree", it is instead chosen using a \ref LightTree
+     * that accounts for the position and orientation of the emitters. When
+     * it is set to \c "light_grid", the emitter is chosen from the point and
+     * spot lights that can illuminate the grid cell of \c ref using a \ref
+     * LightGrid.
+     *
      * \param ref
      *    A 3D reference location within the scene, which may influence the
      *    sampling process.
@@ -485,6 +576,46 @@ public:
     //! @}
     // =============================================================
 
+    // =============================================================
+    //! @{ \name Scene editing
+    // =============================================================
+
+    /**
+     * \brief Insert a shape into the scene
+     *
+     * Area emitters attached to the shape are inserted along with it. Like
+     * other scene modifications, this change only takes effect after the next
+     * call to \ref parameters_changed(), which updates the acceleration data
+     * structure and the emitter sampling data structures of the existing
+     * scene. Several modifications can therefore be applied at once.
+     */
+    void add_shape(Shape *shape);
+
+    /// Remove a shape and its area emitter from the scene (see \ref add_shape())
+    void remove_shape(Shape *shape);
+
+    /**
+     * \brief Insert an emitter that is not attached to a shape (e.g. a point
+     * light or an environment map) into the scene (see \ref add_shape())
+     */
+    void add_emitter(Emitter *emitter);
+
+    /// Remove an emitter from the scene (see \ref add_shape())
+    void remove_emitter(Emitter *emitter);
+
+    /**
+     * \brief Replace a BSDF by another one on all shapes of the scene that
+     * reference it, and return the number of affected shapes
+     *
+     * Shapes within shape groups are included. The change takes effect
+     * immediately, since the acceleration data structure does not depend on
+     * the BSDFs.
+     */
+    size_t replace_bsdf(BSDF *bsdf, BSDF *new_bsdf);
+
+    //! @}
+    // =============================================================
+
     /// Traverse the scene graph and invoke the given callback for each object
     void traverse(TraversalCallback *callback) override;
 
@@ -504,6 +635,76 @@ public:
      */
     bool shapes_grad_enabled() const { return m_shapes_grad_enabled; };
 
+    /**
+     * \brief Collect the distinct shapes, BSDFs and textures that can be
+     * reached from the scene
+     *
+     * These objects carry the hot-path statistics counters (see \ref
+     * StatisticsCounter, \ref Shape::intersection_counter(), \ref
+     * BSDF::eval_counter() and \ref Texture::eval_counter()).
+     */
+    void statistics_objects(std::vector<ref<Shape>> &shapes,
+                            std::vector<ref<BSDF>> &bsdfs,
+                            std::vector<ref<Texture>> &textures) const;
+
+    /**
+     * \brief Reset the statistics counters of the objects returned by \ref
+     * statistics_objects() and the path length histogram of the integrator
+     */
+    void reset_statistics();
+
+    /// Return the size of the acceleration data structure of the scene
+    size_t memory_footprint() const override;
+
+    /**
+     * \brief Return the memory footprint of the scene in bytes, broken down
+     * by the kind of object
+     *
+     * Visits every object that can be reached from the scene once and sums
+     * up the values of \ref Object::memory_footprint() by the name of the
+     * interface the objects implement (e.g. \c "Shape", \c "Texture", \c
+     * "Volume", or \c "Film"). The entry \c "Accel" refers to the
+     * acceleration data structure of the scene. A summary is logged after
+     * the scene was created.
+     */
+    std::map<std::string, size_t> memory_usage() const;
+
+    /**
+     * \brief Predict the peak memory usage of rendering the scene in bytes
+     *
+     * This is the footprint of the scene (see \ref memory_usage()) without
+     * the films, whose storage is allocated anew by every render, plus the
+     * estimate of \ref Integrator::render_memory_footprint() for the given
+     * sensor. The prediction is meant for admission control before a render
+     * job starts, and does not include memory allocated by the JIT compiler
+     * or the temporary storage of acceleration data structure builds.
+     *
+     * \param sensor_index
+     *    Index of the sensor in \ref sensors()
+     *
+     * \param spp
+     *    Optional parameter to override the number of samples per pixel of
+     *    the sensor's sampler (as in \ref Integrator::render()).
+     */
+    size_t predicted_peak_memory(uint32_t sensor_index = 0,
+                                 uint32_t spp = 0) const;
+
+    /**
+     * \brief Return a signature of the JIT kernels that rendering the scene
+     * with the given sensor compiles
+     *
+     * The signature is a hash of the variant, the Dr.Jit compilation flags,
+     * the classes of all objects of the scene (e.g. the types of BSDFs and
+     * textures), the number of emitters (none, one, or several), the film
+     * resolution, the sample count, and the configuration of the integrator
+     * (e.g. its maximum path depth, see \ref Integrator::to_string()). Values
+     * of the parameters of the objects (colors, vertex positions, ..) are not
+     * part of it. Scenes with the same signature usually reuse the kernels of
+     * each other from the kernel cache of Dr.Jit, which allows warming up
+     * the cache with a representative scene of every signature.
+     */
+    std::string kernel_signature(uint32_t sensor_index = 0) const;
+
     /// Return a human-readable string representation of the scene contents.
     virtual std::string to_string() const override;
 
@@ -529,21 +730,106 @@ protected:
     void accel_parameters_changed_cpu();
     void accel_parameters_changed_gpu();
 
+    /// Update backend-specific state after shapes were added or removed
+    void accel_shapes_changed_cpu();
+    void accel_shapes_changed_gpu();
+
+    /// Apply the modifications of \ref add_shape() and related functions
+    void update_scene_structure();
+
+    /**
+     * \brief Check whether any shape is skipped by \ref
+     * ray_intersect_occluder() or alpha-tested
+     */
+    void update_passthrough_shapes();
+
+    /// Gather the surface interaction fields read by the shapes, see \ref ray_flags()
+    void update_ray_flags();
+
+    /// Is \c shape skipped by \ref ray_intersect_occluder()?
+    static bool is_passthrough_shape(const Shape *shape);
+
+    /**
+     * \brief Are intersections with \c shape alpha-tested (see \ref
+     * Shape::alpha_test())?
+     *
+     * Area emitters and sensors and shapes separating different media are
+     * never alpha-tested, since their surfaces must not be skipped.
+     */
+    static bool is_alpha_tested_shape(const Shape *shape);
+
+    /**
+     * \brief Trace a ray and continue it past the intersections that fail
+     * their alpha test
+     *
+     * This is used by the backends that cannot evaluate the alpha test of
+     * some shapes within the traversal. The distance of the returned record
+     * is measured from the origin of \c ray.
+     */
+    PreliminaryIntersection3f ray_intersect_preliminary_alpha_tested(
+        const Ray3f &ray, Mask coherent, Mask active,
+        uint32_t ray_mask = (uint32_t) -1) const;
+
+    /**
+     * \brief Ray mask of passthrough shapes in the CPU backends
+     *
+     * All other shapes have the ray mask <tt>(uint32_t) -1</tt>.
+     * \ref ray_intersect_occluder() traces rays with the complementary mask,
+     * which skips passthrough shapes during the traversal.
+     */
+    static constexpr uint32_t PassthroughRayMask = 0x2;
+
     /// Release the ray-intersection acceleration data structure
     void accel_release_cpu();
     void accel_release_gpu();
 
+    /// Return the size of the ray-intersection acceleration data structure
+    size_t accel_memory_footprint_cpu() const;
+    size_t accel_memory_footprint_gpu() const;
+
+    /**
+     * \brief Can the acceleration data structure be refitted instead of
+     * being rebuilt from scratch?
+     *
+     * This is the case when refitting was enabled via the \c accel_refit
+     * parameter, the acceleration data structure was built at least once,
+     * no shape changed its number of primitives, and no shapes were added
+     * or removed since the last full build.
+     */
+    bool accel_refit_possible() const;
+
+    /**
+     * \brief Estimate how much a refitted acceleration data structure
+     * degraded since the last full build (1 == unchanged).
+     *
+     * Backends without a better quality measure use the growth of the summed
+     * surface area of all shape bounding boxes as an approximation.
+     */
+    ScalarFloat accel_refit_degradation() const;
+
+    /// Record the state of the geometry after a full build
+    void accel_refit_record_build();
+
     static void static_accel_initialization_cpu();
     static void static_accel_initialization_gpu();
     static void static_accel_shutdown_cpu();
     static void static_accel_shutdown_gpu();
 
     /// Trace a ray and only return a preliminary intersection data structure
+    /**
+     * The CPU backends only report intersections with shapes whose ray mask
+     * (see \ref PassthroughRayMask) shares a bit with \c ray_mask.
+     */
     MI_INLINE PreliminaryIntersection3f ray_intersect_preliminary_cpu(
-        const Ray3f &ray, Mask coherent, Mask active) const;
+        const Ray3f &ray, Mask coherent, Mask active,
+        uint32_t ray_mask = (uint32_t) -1) const;
     MI_INLINE PreliminaryIntersection3f ray_intersect_preliminary_gpu(
         const Ray3f &ray, Mask active) const;
 
+    /// Trace up to 16 rays as a packet (scalar variants only)
+    MI_INLINE void ray_intersect_preliminary_packet_cpu(
+        const Ray3f *rays, PreliminaryIntersection3f *pi, size_t count) const;
+
     /// Trace a ray
     MI_INLINE SurfaceInteraction3f ray_intersect_cpu(const Ray3f &ray, uint32_t ray_flags, Mask coherent, Mask active) const;
     MI_INLINE SurfaceInteraction3f ray_intersect_gpu(const Ray3f &ray, uint32_t ray_flags, Mask active) const;
@@ -554,10 +840,14 @@ protected:
     MI_INLINE Mask ray_test_gpu(const Ray3f &ray, Mask active) const;
 
     using ShapeKDTree = mitsuba::ShapeKDTree<Float, Spectrum>;
+    using ShapeBVH = mitsuba::ShapeBVH<Float, Spectrum>;
 
     /// Updates the discrete distribution used to select an emitter
     void update_emitter_sampling_distribution();
 
+    /// Replace the BSDFs of all shapes by their simplified version
+    void simplify_bsdfs();
+
 protected:
     /// Acceleration data structure (IAS) (type depends on implementation)
     void *m_accel = nullptr;
@@ -577,8 +867,52 @@ protected:
     ref<Emitter> m_environment;
     ScalarFloat m_emitter_pmf;
     std::unique_ptr<DiscreteDistribution<Float>> m_emitter_distr = nullptr;
+    /// Light tree used by \ref sample_emitter_direction() (if enabled)
+    ref<LightTree> m_light_tree;
+    /// Light grid used by \ref sample_emitter_direction() (if enabled)
+    ref<LightGrid> m_light_grid;
+    /// Resolution and influence threshold of \ref m_light_grid
+    uint32_t m_light_grid_resolution;
+    ScalarFloat m_light_grid_threshold;
+    EmitterSamplingMode m_emitter_sampling;
+    /// Are the cached emitter flux estimates up to date?
+    bool m_emitter_flux_valid = false;
+    /// Does \ref m_emitter_distr account for the emitter flux estimates?
+    bool m_emitter_distr_flux = false;
+    /// Should \ref m_emitter_distr use an alias table?
+    bool m_emitter_alias_table = false;
 
     bool m_shapes_grad_enabled;
+    /// Were shapes or emitters added or removed since the last update?
+    bool m_structure_changed = false;
+    /// Does the scene contain shapes with a pure null BSDF and no media?
+    bool m_passthrough_shapes = false;
+    /// Does the scene contain alpha-tested shapes?
+    bool m_alpha_tested_shapes = false;
+    /// Surface interaction fields read by the shapes, see \ref ray_flags()
+    uint32_t m_ray_flags = +RayFlags::All;
+    /// Must rays be continued past alpha-tested intersections by the scene?
+    bool m_alpha_test_continuation = false;
+
+    /// Refit the acceleration data structure when shapes change?
+    bool m_accel_refit;
+    /// Trigger a full rebuild when the degradation exceeds this value
+    ScalarFloat m_accel_refit_threshold;
+    /// Primitive count of every shape at the time of the last full build
+    std::vector<uint32_t> m_accel_refit_prim_counts;
+    /// Summed surface area of the shape bounding boxes at the last full build
+    ScalarFloat m_accel_refit_area = 0.f;
+    /// Trade-off between the build and the traversal speed of the acceleration structure
+    enum class AccelBuild : uint32_t { FastTrace, Balanced, FastBuild };
+    AccelBuild m_accel_build;
+    /// Compact the OptiX acceleration structures after building them?
+    bool m_accel_compaction;
+    /// Log the memory footprint of the acceleration structure after a build?
+    bool m_accel_memory_report;
+    /// Build compact Embree acceleration structures?
+    bool m_embree_compact;
+    /// Use the robust traversal mode of Embree?
+    bool m_embree_robust;
 };
 
 /// Dummy function which can be called to ensure that the librender shared library is loaded
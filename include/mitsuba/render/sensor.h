@@ -87,6 +87,17 @@ public:
     sample_wavelengths(const SurfaceInteraction3f &si, Float sample,
                        Mask active = true) const override;
 
+    /**
+     * \brief Return the radius of the circle of confusion of a world-space
+     * point in pixels
+     *
+     * Sensors with a finite aperture image points outside of the focal plane
+     * as disks. Adaptive sampling uses their radius to give defocused image
+     * regions more samples. The default implementation returns zero, i.e. a
+     * pinhole sensor.
+     */
+    virtual Float circle_of_confusion(const Point3f &p, Mask active = true) const;
+
     //! @}
     // =============================================================
 
@@ -6,6 +6,7 @@
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/bbox.h>
 #include <mitsuba/core/field.h>
+#include <mitsuba/core/statistics.h>
 #include <drjit/packet.h>
 #include <unordered_map>
 
@@ -378,6 +379,9 @@ public:
     /// Is this shape a triangle mesh?
     bool is_mesh() const;
 
+    /// Does the geometry of this shape move during the shutter interval?
+    virtual bool has_motion() const;
+
     /// Is this shape a b-spline curve ?
     virtual bool is_bspline_curve() const;
 
@@ -406,6 +410,16 @@ public:
     /// Return the shape's BSDF
     BSDF *bsdf(Mask /*unused*/ = true) { return m_bsdf.get(); }
 
+    /**
+     * \brief Evaluate the alpha test of the shape's BSDF (see \ref
+     * BSDF::alpha_test()) at a preliminary intersection with this shape
+     *
+     * Returns \c false when the intersection should be skipped by the
+     * traversal, and \c true when the BSDF does not perform an alpha test.
+     */
+    Mask alpha_test(const Ray3f &ray, const PreliminaryIntersection3f &pi,
+                    Mask active = true) const;
+
     /// Is this shape also an area emitter?
     bool is_emitter() const { return (bool) m_emitter; }
 
@@ -444,6 +458,16 @@ public:
 #if defined(MI_ENABLE_EMBREE)
     /// Return the Embree version of this shape
     virtual RTCGeometry embree_geometry(RTCDevice device);
+
+    /**
+     * \brief Update a geometry previously created by \ref embree_geometry()
+     * after the parameters of this shape changed
+     *
+     * This is used to refit the Embree acceleration data structure instead
+     * of rebuilding it. The default implementation re-commits the geometry,
+     * which re-evaluates the bounding box of the shape.
+     */
+    virtual void embree_update_geometry(RTCGeometry geom);
 #endif
 
 #if defined(MI_ENABLE_CUDA)
@@ -549,6 +573,25 @@ public:
     /// Return whether any shape's parameters require gradients (default return false)
     virtual bool parameters_grad_enabled() const;
 
+    /**
+     * \brief Select the level of detail of the shape for a sensor
+     *
+     * The scene invokes this function on all of its shapes before building
+     * its acceleration data structure, with its first sensor (or \c nullptr
+     * if it has none). The default implementation does nothing, instances
+     * use it to pick one of several shape groups by their projected size.
+     */
+    virtual void select_lod(const Sensor *sensor);
+
+    /**
+     * \brief Counts the closest-hit ray intersection queries of the scene
+     * that found this shape (requires the \c MI_STATISTICS build option,
+     * scalar variants only)
+     */
+    StatisticsCounter &intersection_counter() const {
+        return m_intersection_counter;
+    }
+
     //! @}
     // =============================================================
 
@@ -578,6 +621,8 @@ protected:
     /// True if the shape is used in a \c ShapeGroup
     bool m_is_instance = false;
 
+    mutable StatisticsCounter m_intersection_counter;
+
 #if defined(MI_ENABLE_CUDA)
     /// OptiX hitgroup data buffer
     void* m_optix_data_ptr = nullptr;
@@ -657,6 +702,7 @@ DRJIT_VCALL_TEMPLATE_BEGIN(mitsuba::Shape)
     DRJIT_VCALL_METHOD(ray_intersect_preliminary)
     DRJIT_VCALL_METHOD(ray_intersect)
     DRJIT_VCALL_METHOD(ray_test)
+    DRJIT_VCALL_METHOD(alpha_test)
     DRJIT_VCALL_METHOD(sample_position)
     DRJIT_VCALL_METHOD(pdf_position)
     DRJIT_VCALL_METHOD(sample_direction)
@@ -28,6 +28,17 @@ public:
 
 #if defined(MI_ENABLE_EMBREE)
     RTCGeometry embree_geometry(RTCDevice device) override;
+
+    /**
+     * \brief Build the Embree scene of the shape group if it is dirty
+     *
+     * This otherwise happens on demand when the first instance requests its
+     * geometry. Building all groups upfront allows the scene to build them
+     * concurrently, with its build quality and scene flags.
+     */
+    void embree_build(RTCDevice device,
+                      RTCBuildQuality quality = RTC_BUILD_QUALITY_HIGH,
+                      RTCSceneFlags flags = RTC_SCENE_FLAG_NONE);
 #else
     std::tuple<ScalarFloat, ScalarPoint2f, ScalarUInt32, ScalarUInt32>
     ray_intersect_preliminary_scalar(const ScalarRay3f &ray) const override;
@@ -60,10 +71,33 @@ public:
     /// Return whether this shapegroup contains other type of shapes
     bool has_others() const { return m_has_others; }
 
+    bool has_motion() const override { return m_has_motion; }
+
+    /// Return the shapes that are part of this group
+    const std::vector<ref<Base>> &shapes() const { return m_shapes; }
+
+    /// Register an instance that references this shape group
+    void add_instance_reference() { m_instance_count++; }
+
+    /// Register this shape group as a level of detail of an instance
+    void add_lod_candidate() { m_is_lod = true; }
+
+    /**
+     * \brief Return whether this shape group is a level of detail that no
+     * instance selected
+     *
+     * The scene does not build the acceleration data structures of such
+     * groups and releases them.
+     */
+    bool unused_lod() const { return m_is_lod && m_instance_count == 0; }
+
     void traverse(TraversalCallback *callback) override;
     void parameters_changed(const std::vector<std::string> &/*keys*/ = {}) override;
     bool parameters_grad_enabled() const override;
 
+    /// Return the size of the acceleration data structure of the group
+    size_t memory_footprint() const override;
+
     std::string to_string() const override;
 
 #if defined(MI_ENABLE_CUDA)
@@ -79,7 +113,11 @@ public:
     void optix_prepare_geometry() override;
 
     /// Build OptiX geometry acceleration structures
-    void optix_build_gas(const OptixDeviceContext& context);
+    void optix_build_gas(const OptixDeviceContext& context,
+                         const OptixGASOptions &options = {});
+
+    /// Return the OptiX geometry acceleration structures of the group
+    const OptixAccelData &optix_accel() const { return m_accel; }
 #endif
 
     MI_DECLARE_CLASS()
@@ -105,6 +143,9 @@ private:
 #endif
 
     bool m_has_meshes, m_has_bspline_curves, m_has_linear_curves, m_has_others;
+    bool m_has_motion;
+    bool m_is_lod = false;
+    uint32_t m_instance_count = 0;
 };
 
 MI_EXTERN_CLASS(ShapeGroup)
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <mitsuba/core/logger.h>
 #include <mitsuba/core/object.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/imageblock.h>
-#include <mutex>
+#include <atomic>
+#include <vector>
 
 #if !defined(MI_BLOCK_SIZE)
 #  define MI_BLOCK_SIZE 32
@@ -12,6 +14,35 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Traversal order of the blocks generated by a \ref Spiral instance
+enum class BlockOrder : uint32_t {
+    /// Spiral outward from the center of the image
+    Spiral,
+
+    /// Hilbert curve starting at the top left corner of the image
+    Hilbert,
+
+    /// Morton (Z-order) curve starting at the top left corner of the image
+    Morton
+};
+
+/**
+ * \brief Parse the \c block_order parameter of an integrator
+ *
+ * Supported values are \c "spiral", \c "hilbert" and \c "morton".
+ */
+inline BlockOrder block_order(const std::string &name) {
+    if (name == "spiral")
+        return BlockOrder::Spiral;
+    else if (name == "hilbert")
+        return BlockOrder::Hilbert;
+    else if (name == "morton")
+        return BlockOrder::Morton;
+    else
+        Throw("Invalid block order \"%s\", must be one of: \"spiral\", "
+              "\"hilbert\", or \"morton\"!", name);
+}
+
 /**
  * \brief Generates a spiral of blocks to be rendered.
  *
@@ -20,6 +51,19 @@ NAMESPACE_BEGIN(mitsuba)
  * RayTracer.java
  * Used with permission.
  * Copyright 2005 Program of Computer Graphics, Cornell University
+ *
+ * The spiral ordering of all blocks is computed once upon construction.
+ * Subsequent calls to \ref next_block() then only need to atomically
+ * increment a counter, which means that many worker threads can fetch blocks
+ * concurrently without contending on a lock.
+ *
+ * Instead of the spiral, the blocks can also be visited along a Hilbert or
+ * Morton curve (see \ref BlockOrder). Consecutive blocks of these curves are
+ * adjacent in the image (always for Hilbert, mostly for Morton), so a worker
+ * that claims a contiguous run of blocks via \ref next_blocks() renders a
+ * compact region whose geometry and textures stay in its caches, whereas the
+ * outer rings of a spiral are spread across the whole image.
+ *
  * \ingroup librender
  */
 class MI_EXPORT_LIB Spiral : public Object {
@@ -32,7 +76,8 @@ public:
     Spiral(const Vector2u &size,
            const Vector2u &offset,
            uint32_t block_size,
-           uint32_t passes = 1);
+           uint32_t passes = 1,
+           BlockOrder order = BlockOrder::Spiral);
 
     /// Return the maximum block size
     uint32_t max_block_size() const { return m_block_size; }
@@ -40,32 +85,55 @@ public:
     /// Return the total number of blocks
     uint32_t block_count() { return m_block_count; }
 
+    /// Return the total number of passes
+    uint32_t pass_count() const { return m_passes; }
+
+    /// Return the traversal order of the blocks
+    BlockOrder order() const { return m_order; }
+
     /// Reset the spiral to its initial state. Does not affect the number of passes.
     void reset();
 
     /**
      * \brief Return the offset, size, and unique identifier of the next block.
      *
-     * A size of zero indicates that the spiral traversal is done.
+     * A size of zero indicates that the spiral traversal is done. This
+     * function is lock-free and can safely be called from multiple threads.
      */
     std::tuple<Vector2i, Vector2u, uint32_t> next_block();
 
+    /**
+     * \brief Claim a contiguous run of up to \c count blocks
+     *
+     * Returns the half-open range of block indices that were claimed, which
+     * is empty once the traversal is done. The blocks are then looked up via
+     * \ref block(). This function is lock-free and can safely be called from
+     * multiple threads.
+     */
+    std::pair<uint32_t, uint32_t> next_blocks(uint32_t count);
+
+    /// Return the offset, size, and unique identifier of a claimed block
+    std::tuple<Vector2i, Vector2u, uint32_t> block(uint32_t counter) const;
+
     MI_DECLARE_CLASS()
 protected:
     enum class Direction { Right, Down, Left, Up };
 
-    std::mutex m_mutex;       //< Protects the state for thread safety
+    /// Precompute the traversal order of all blocks in a single pass
+    void compute_block_order();
+
+    /// Precompute the order of the blocks along a Hilbert or Morton curve
+    void compute_curve_order();
+
     Vector2u m_size;          //< Size of the 2D image (in pixels)
     Vector2u m_offset;        //< Offset to the crop region on the sensor (pixels)
     Vector2u m_blocks;        //< Number of blocks in each direction
-    Point2i  m_position;      //< Relative position of the current block
-    Direction direction;      //< Current spiral direction
-    uint32_t m_block_counter; //< Number of blocks generated so far
+    std::vector<Vector2u> m_block_order; //< Block positions in spiral order
+    std::atomic<uint32_t> m_block_counter; //< Number of blocks generated so far (all passes)
     uint32_t m_block_count;   //< Number of blocks to be generated in pass
-    uint32_t m_passes_left;   //< Remaining spiral passes to be generated
+    uint32_t m_passes;        //< Total number of spiral passes to be generated
     uint32_t m_block_size;    //< Size of the (square) blocks (in pixels)
-    uint32_t m_steps_left;    //< Steps before next change of direction
-    uint32_t m_spiral_size;   //< Current spiral size in blocks
+    BlockOrder m_order;       //< Traversal order of the blocks
 };
 
 NAMESPACE_END(mitsuba)
@@ -41,6 +41,22 @@ MI_INLINE dr::value_t<Array3f> srgb_model_mean(const Array3f &coeff) {
  */
 MI_EXPORT_LIB dr::Array<float, 3> srgb_model_fetch(const Color<float, 3> &);
 
+/**
+ * \brief Look up the model coefficients for an array of sRGB color values
+ *
+ * This function converts \c count colors stored as consecutive RGB triplets.
+ * Large arrays are converted in parallel. The input and output may refer to
+ * the same memory, in which case the conversion happens in place.
+ *
+ * \param rgb   Pointer to <tt>3 * count</tt> color components in [0, 1]
+ * \param coeff Pointer to <tt>3 * count</tt> output coefficients
+ * \param count Number of colors
+ */
+MI_EXPORT_LIB void srgb_model_fetch(const float *rgb, float *coeff, size_t count);
+
+/// Double precision version of the above function
+MI_EXPORT_LIB void srgb_model_fetch(const double *rgb, double *coeff, size_t count);
+
 /// Sanity check: convert the coefficients back to sRGB
 // MI_EXPORT_LIB Color<float, 3> srgb_model_eval_rgb(const dr::Array<float, 3> &);
 
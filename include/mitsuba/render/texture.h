@@ -2,6 +2,7 @@
 
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/statistics.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/shape.h>
@@ -213,6 +214,35 @@ public:
     /// Does this texture evaluation depend on the UV coordinates
     virtual bool is_spatially_varying() const { return false; }
 
+    /**
+     * \brief Does \ref eval() return the same value for every surface
+     * interaction and wavelength?
+     *
+     * The value of a uniform texture can be obtained once by evaluating it at
+     * an arbitrary interaction, which lets BSDFs skip the per-lookup call.
+     */
+    virtual bool is_uniform() const { return false; }
+
+    /**
+     * \brief Can \ref eval() return different values for different
+     * wavelengths (or color channels) of the same interaction?
+     *
+     * Media use this to detect a wavelength-independent extinction, which
+     * allows for a cheaper sampling of the free-flight distance. The default
+     * implementation conservatively returns \c true.
+     */
+    virtual bool is_spectrally_varying() const { return true; }
+
+    /**
+     * \brief Does the texture evaluation use the UV partials (\c duv_dx and
+     * \c duv_dy) of the surface interaction, e.g. to filter its contents?
+     *
+     * BSDFs set \ref BSDFFlags::NeedsDifferentials when one of their
+     * textures requires them, so that the partials are computed from the
+     * ray differentials before the BSDF is evaluated.
+     */
+    virtual bool needs_differentials() const { return false; }
+
     /// Convenience function returning the standard D65 illuminant
     static ref<Texture> D65(ScalarFloat scale = 1.f);
 
@@ -226,6 +256,14 @@ public:
     /// Set a string identifier
     void set_id(const std::string& id) override { m_id = id; };
 
+    /**
+     * \brief Counts the lookups of this texture (requires the \c
+     * MI_STATISTICS build option, scalar variants only)
+     *
+     * Currently, only the \c bitmap texture counts its lookups.
+     */
+    StatisticsCounter &eval_counter() const { return m_eval_counter; }
+
     MI_DECLARE_CLASS()
 
 protected:
@@ -234,6 +272,7 @@ protected:
 
 protected:
     std::string m_id;
+    mutable StatisticsCounter m_eval_counter;
 };
 
 MI_EXTERN_CLASS(Texture)
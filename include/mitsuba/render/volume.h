@@ -60,9 +60,27 @@ public:
      */
     virtual void max_per_channel(ScalarFloat *out) const;
 
+    /**
+     * \brief Compute upper bounds of the volume over the cells of a regular
+     * grid
+     *
+     * The grid subdivides the unit cube of the local coordinate system of the
+     * volume into <tt>res.x() * res.y() * res.z()</tt> cells. The bounds are
+     * returned in a flat array, in which the x coordinate varies fastest. The
+     * bound of a cell at the boundary of the grid must also cover lookups
+     * outside of the unit cube that are closest to that cell. This is used to
+     * construct spatially varying majorants for heterogeneous media.
+     *
+     * The default implementation returns \ref max() for every cell.
+     */
+    virtual std::vector<ScalarFloat> max_grid(const ScalarVector3u &res) const;
+
     /// Returns the bounding box of the volume
     ScalarBoundingBox3f bbox() const { return m_bbox; }
 
+    /// Returns the transformation from world coordinates to local coordinates
+    const ScalarTransform4f &to_local() const { return m_to_local; }
+
     /**
      * \brief Returns the resolution of the volume, assuming that it is based
      * on a discrete representation.
@@ -71,6 +89,14 @@ public:
      */
     virtual ScalarVector3i resolution() const;
 
+    /**
+     * \brief Can \ref eval() return different values for different
+     * wavelengths (or color channels) at the same point?
+     *
+     * The default implementation conservatively returns \c true.
+     */
+    virtual bool is_spectrally_varying() const;
+
     /**
      * \brief Returns the number of channels stored in the volume
      *
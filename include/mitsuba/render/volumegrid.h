@@ -80,6 +80,14 @@ public:
             m_max_per_channel[i] = max[i];
     }
 
+    /**
+     * \brief Recompute the maximum over the volume grid and per channel from
+     * the voxel data
+     *
+     * The reduction is parallelized over blocks of voxels.
+     */
+    void update_max();
+
     /// Return the number bytes of storage used per voxel
     size_t bytes_per_voxel() const { return sizeof(ScalarFloat) * channel_count(); }
 
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/object.h>
+#include <mitsuba/render/fwd.h>
+#include <drjit/tensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Edge-avoiding wavelet denoiser that runs on the CPU
+ *
+ * This denoiser implements the edge-avoiding <em>à-trous</em> wavelet
+ * transform of "Edge-Avoiding À-Trous Wavelet Transform for fast Global
+ * Illumination Filtering" by Dammertz et al. It is a counterpart of the \ref
+ * OptixDenoiser with the same interface that is available in every variant
+ * and runs multithreaded on the CPU (inputs of GPU variants are copied to the
+ * host). The noisy image is repeatedly filtered with a 5x5 B3-spline kernel
+ * whose taps are spread twice as far apart in every iteration, while the
+ * weights of the taps are reduced across edges of the color, albedo and
+ * shading normal images.
+ *
+ * When an albedo is given, the noisy image is divided by it before filtering
+ * and multiplied by it afterwards, such that textures are preserved. As with
+ * the \ref OptixDenoiser, these guiding images are best obtained with the
+ * \c aov integrator, and a \ref Film using the \c box \ref
+ * ReconstructionFilter gives the best results.
+ */
+template <typename Float, typename Spectrum>
+class MI_EXPORT_LIB WaveletDenoiser : public Object {
+public:
+    MI_IMPORT_TYPES()
+
+    /**
+     * \brief Constructs a wavelet denoiser
+     *
+     * \param input_size
+     *      Resolution of noisy images that will be fed to the denoiser.
+     *
+     * \param albedo
+     *      Whether or not albedo information will also be given to the
+     *      denoiser.
+     *
+     * \param normals
+     *      Whether or not shading normals information will also be given to
+     *      the denoiser.
+     *
+     * \param iterations
+     *      Number of filtering iterations. The filter footprint is
+     *      <tt>4 * 2^iterations + 1</tt> pixels wide.
+     *
+     * \param color_sigma
+     *      Tolerance of the filter to color differences, which are measured
+     *      on tone mapped colors in [0, 1]. It is halved in every iteration.
+     *
+     * \return A callable object which will apply the denoiser.
+     */
+    WaveletDenoiser(const ScalarVector2u &input_size, bool albedo = false,
+                    bool normals = false, uint32_t iterations = 5,
+                    float color_sigma = 0.5f);
+
+    /**
+     * \brief Apply denoiser on inputs which are \ref TensorXf objects.
+     *
+     * \param noisy
+     *      The noisy input. (tensor shape: (height, width, 3 | 4))
+     *
+     * \param denoise_alpha
+     *      Whether or not the alpha channel (if specified in the noisy input)
+     *      should be denoised too.
+     *      This parameter is optional, by default it is true.
+     *
+     * \param albedo
+     *      Albedo information of the noisy rendering.
+     *      This parameter is optional unless the denoiser was built with
+     *      albedo support. (tensor shape: (height, width, 3))
+     *
+     * \param normals
+     *      Shading normal information of the noisy rendering. The filter only
+     *      compares neighboring normals, hence they can be given in any
+     *      coordinate frame.
+     *      This parameter is optional unless the denoiser was built with
+     *      normals support. (tensor shape: (height, width, 3))
+     *
+     * \return The denoised input.
+     */
+    TensorXf operator()(const TensorXf &noisy,
+                        bool denoise_alpha = true,
+                        const TensorXf &albedo = TensorXf(),
+                        const TensorXf &normals = TensorXf()) const;
+
+    /**
+     * \brief Apply denoiser on inputs which are \ref Bitmap objects.
+     *
+     * \param noisy
+     *      The noisy input. When passing additional information like albedo or
+     *      normals to the denoiser, this \ref Bitmap object must be a \ref
+     *      MultiChannel bitmap.
+     *
+     * \param denoise_alpha
+     *      Whether or not the alpha channel (if specified in the noisy input)
+     *      should be denoised too.
+     *      This parameter is optional, by default it is true.
+     *
+     * \param albedo_ch
+     *      The name of the channel in the \c noisy parameter which contains
+     *      the albedo information of the noisy rendering.
+     *      This parameter is optional unless the denoiser was built with
+     *      albedo support.
+     *
+     * \param normals_ch
+     *      The name of the channel in the \c noisy parameter which contains
+     *      the shading normal information of the noisy rendering.
+     *      This parameter is optional unless the denoiser was built with
+     *      normals support.
+     *
+     * \param noisy_ch
+     *      The name of the channel in the \c noisy parameter which contains
+     *      the noisy rendering.
+     *
+     * \return The denoised input.
+     */
+    ref<Bitmap> operator()(const ref<Bitmap> &noisy,
+                           bool denoise_alpha = true,
+                           const std::string &albedo_ch = "",
+                           const std::string &normals_ch = "",
+                           const std::string &noisy_ch = "<root>") const;
+
+    virtual std::string to_string() const override;
+
+    MI_DECLARE_CLASS()
+private:
+    /**
+     * \brief Denoise host-side images of size \ref m_input_size
+     *
+     * The \c albedo and \c normals images have three channels and may be
+     * \c nullptr when the denoiser was built without them.
+     */
+    void denoise(const ScalarFloat *noisy, uint32_t channels,
+                 bool denoise_alpha, const ScalarFloat *albedo,
+                 const ScalarFloat *normals, ScalarFloat *output) const;
+
+    ScalarVector2u m_input_size;
+    bool m_albedo;
+    bool m_normals;
+    uint32_t m_iterations;
+    float m_color_sigma;
+};
+
+MI_EXTERN_CLASS(WaveletDenoiser)
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,117 @@
+#!/usr/bin/env python
+"""
+Usage: benchmark_kdtree.py [options]
+
+This script measures the construction time of Mitsuba's kd-tree in the scalar
+variants for increasing numbers of worker threads. The geometry is either
+loaded from a PLY/OBJ file or generated procedurally (a randomly displaced
+height field). Run with ``--help`` for a list of options.
+"""
+
+import argparse
+import os
+import time
+
+import drjit as dr
+import mitsuba as mi
+
+
+def make_heightfield(res, seed):
+    """Create a randomly displaced grid mesh with 2 * res^2 triangles"""
+    import numpy as np
+
+    rng = np.random.default_rng(seed)
+    u, v = np.meshgrid(np.linspace(0, 1, res + 1), np.linspace(0, 1, res + 1))
+    w = rng.uniform(0, 1.0 / res, u.shape)
+    vertices = np.stack([u.ravel(), v.ravel(), w.ravel()], axis=1)
+
+    i = np.arange(res)
+    i, j = np.meshgrid(i, i)
+    k = (j * (res + 1) + i).ravel()
+    faces = np.concatenate([
+        np.stack([k, k + 1, k + res + 1], axis=1),
+        np.stack([k + 1, k + res + 2, k + res + 1], axis=1)
+    ])
+
+    mesh = mi.Mesh("heightfield", len(vertices), len(faces))
+    params = mi.traverse(mesh)
+    params['vertex_positions'] = mi.Float(vertices.ravel().astype(np.float32))
+    params['faces'] = mi.UInt32(faces.ravel().astype(np.uint32))
+    params.update()
+    return mesh
+
+
+def load_mesh(filename):
+    ext = os.path.splitext(filename)[1][1:].lower()
+    return mi.load_dict({ 'type': ext, 'filename': filename })
+
+
+def build_time(shape, props):
+    kdtree = mi.ShapeKDTree(props)
+    kdtree.add_shape(shape)
+    start = time.perf_counter()
+    kdtree.build()
+    return time.perf_counter() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Measure kd-tree construction time against thread count.')
+    parser.add_argument('--variant', default='scalar_rgb',
+                        help='scalar variant to use (default: scalar_rgb)')
+    parser.add_argument('--mesh', help='PLY/OBJ mesh to build the tree for '
+                        '(default: procedural height field)')
+    parser.add_argument('--resolution', type=int, default=1024,
+                        help='grid resolution of the procedural height field')
+    parser.add_argument('--threads', type=int, nargs='+',
+                        help='thread counts to benchmark (default: 1, 2, 4, '
+                        '.., number of cores)')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='number of builds per thread count (the fastest '
+                        'one is reported)')
+    parser.add_argument('--parallel-subtree-threshold', type=int,
+                        help='value of the "kd_parallel_subtree_threshold" '
+                        'parameter (0 == sequential O(n log n) builder)')
+    parser.add_argument('--verbose', action='store_true',
+                        help='print the kd-tree build statistics')
+    args = parser.parse_args()
+
+    mi.set_variant(args.variant)
+    if dr.is_jit_v(mi.Float):
+        parser.error('the kd-tree is only used by the scalar variants')
+
+    if not args.verbose:
+        mi.set_log_level(mi.LogLevel.Warn)
+
+    if args.mesh:
+        shape = load_mesh(args.mesh)
+    else:
+        shape = make_heightfield(args.resolution, seed=0)
+
+    props = mi.Properties()
+    if args.parallel_subtree_threshold is not None:
+        props['kd_parallel_subtree_threshold'] = args.parallel_subtree_threshold
+
+    thread_counts = args.threads
+    if not thread_counts:
+        cores, thread_counts = os.cpu_count(), []
+        n = 1
+        while n < cores:
+            thread_counts.append(n)
+            n *= 2
+        thread_counts.append(cores)
+
+    print('Building kd-tree for %i primitives' % shape.primitive_count())
+    print('%8s  %10s  %8s' % ('Threads', 'Time [s]', 'Speedup'))
+
+    baseline = None
+    for count in thread_counts:
+        mi.Thread.set_thread_count(count)
+        t = min(build_time(shape, props) for _ in range(args.repeat))
+        if baseline is None:
+            baseline = t * thread_counts[0]
+        print('%8i  %10.3f  %7.2fx' % (count, t, baseline / t))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+"""
+Usage: benchmark_texture.py [options]
+
+This script measures the throughput of bitmap texture lookups at random UV
+coordinates (as performed by incoherent secondary rays) for the scanline and
+swizzled texel layouts. The texture is either loaded from a file or generated
+procedurally. Run with ``--help`` for a list of options.
+"""
+
+import argparse
+import time
+
+import drjit as dr
+import mitsuba as mi
+
+
+def make_texture(args, layout):
+    import numpy as np
+
+    props = {
+        'type': 'bitmap',
+        'layout': layout,
+        'storage': args.storage,
+        'filter_type': args.filter_type
+    }
+    if args.filename:
+        props['filename'] = args.filename
+    else:
+        rng = np.random.default_rng(0)
+        data = rng.random((args.resolution, args.resolution, 3), dtype=np.float32)
+        props['bitmap'] = mi.Bitmap(data)
+    return mi.load_dict(props)
+
+
+def lookup_rate(texture, count, repeat):
+    """Return the number of lookups per second (best of several runs)"""
+    import numpy as np
+
+    rng = np.random.default_rng(1)
+    best = None
+    for _ in range(repeat):
+        si = mi.SurfaceInteraction3f()
+        if dr.is_jit_v(mi.Float):
+            si.uv = mi.Point2f(rng.random((2, count), dtype=np.float32))
+            dr.eval(si.uv)
+            dr.sync_thread()
+            start = time.perf_counter()
+            dr.eval(texture.eval(si))
+            dr.sync_thread()
+            elapsed = time.perf_counter() - start
+        else:
+            uv = rng.random((count, 2), dtype=np.float32).tolist()
+            start = time.perf_counter()
+            for u, v in uv:
+                si.uv = mi.Point2f(u, v)
+                texture.eval(si)
+            elapsed = time.perf_counter() - start
+        best = elapsed if best is None else min(best, elapsed)
+    return count / best
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Measure the throughput of random texture lookups.')
+    parser.add_argument('--variant', default='scalar_rgb',
+                        help='variant to use (default: scalar_rgb)')
+    parser.add_argument('--filename', help='texture to load (default: '
+                        'procedural noise texture)')
+    parser.add_argument('--resolution', type=int, default=4096,
+                        help='resolution of the procedural texture')
+    parser.add_argument('--storage', default='float',
+                        help='value of the "storage" parameter')
+    parser.add_argument('--filter-type', default='bilinear',
+                        help='value of the "filter_type" parameter')
+    parser.add_argument('--count', type=int,
+                        help='number of lookups (default: 200000 in scalar '
+                        'variants, 2^24 otherwise)')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='number of runs per layout (the fastest one is '
+                        'reported)')
+    args = parser.parse_args()
+
+    mi.set_variant(args.variant)
+    mi.set_log_level(mi.LogLevel.Warn)
+    count = args.count or (1 << 24 if dr.is_jit_v(mi.Float) else 200000)
+
+    print('%10s  %14s  %8s' % ('Layout', 'Mlookups/s', 'Speedup'))
+    baseline = None
+    for layout in ['scanline', 'swizzled']:
+        rate = lookup_rate(make_texture(args, layout), count, args.repeat)
+        if baseline is None:
+            baseline = rate
+        print('%10s  %14.2f  %7.2fx' % (layout, rate * 1e-6, rate / baseline))
+
+
+if __name__ == '__main__':
+    main()
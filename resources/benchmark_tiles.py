@@ -0,0 +1,203 @@
+#!/usr/bin/env python
+"""
+Usage: benchmark_tiles.py [options]
+
+This script compares the image block orders of the scalar variants
+(``block_order`` parameter of the integrator: spiral, Hilbert and Morton
+curves). The scene is either loaded from a file or generated procedurally (a
+finely tessellated height field with a large texture, seen at a grazing
+angle). For every order, the script reports the render time and, with
+``--perf``, the cache misses measured by the ``perf`` tool of Linux. They
+cover the whole render process, whose scene loading is the same for all
+orders. Run with ``--help`` for a list of options.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+import drjit as dr
+import mitsuba as mi
+
+ORDERS = ['spiral', 'hilbert', 'morton']
+
+
+def write_heightfield(filename, res, seed):
+    """Write a randomly displaced grid mesh with 2 * res^2 triangles"""
+    import numpy as np
+
+    rng = np.random.default_rng(seed)
+    u, v = np.meshgrid(np.linspace(-1, 1, res + 1), np.linspace(-1, 1, res + 1))
+    w = rng.uniform(0, 2.0 / res, u.shape)
+    vertices = np.stack([u.ravel(), v.ravel(), w.ravel()], axis=1)
+    texcoords = np.stack([u.ravel(), v.ravel()], axis=1) * 0.5 + 0.5
+
+    i = np.arange(res)
+    i, j = np.meshgrid(i, i)
+    k = (j * (res + 1) + i).ravel()
+    faces = np.concatenate([
+        np.stack([k, k + 1, k + res + 1], axis=1),
+        np.stack([k + 1, k + res + 2, k + res + 1], axis=1)
+    ])
+
+    mesh = mi.Mesh("heightfield", len(vertices), len(faces),
+                   has_vertex_texcoords=True)
+    params = mi.traverse(mesh)
+    params['vertex_positions'] = mi.Float(vertices.ravel().astype(np.float32))
+    params['vertex_texcoords'] = mi.Float(texcoords.ravel().astype(np.float32))
+    params['faces'] = mi.UInt32(faces.ravel().astype(np.uint32))
+    params.update()
+    mesh.write_ply(filename)
+
+
+def load_scene(args, tmpdir):
+    import numpy as np
+
+    if args.scene:
+        return mi.load_file(args.scene)
+
+    filename = os.path.join(tmpdir, 'heightfield.ply')
+    write_heightfield(filename, args.resolution, seed=0)
+
+    rng = np.random.default_rng(1)
+    texture = rng.random((args.texture_resolution, args.texture_resolution, 3),
+                         dtype=np.float32)
+
+    return mi.load_dict({
+        'type': 'scene',
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(origin=[0, -2.5, 0.8],
+                                                     target=[0, 0, 0],
+                                                     up=[0, 0, 1]),
+            'film': {
+                'type': 'hdrfilm',
+                'width': args.width,
+                'height': args.height
+            },
+        },
+        'emitter': { 'type': 'constant' },
+        'heightfield': {
+            'type': 'ply',
+            'filename': filename,
+            'bsdf': {
+                'type': 'diffuse',
+                'reflectance': {
+                    'type': 'bitmap',
+                    'bitmap': mi.Bitmap(texture)
+                }
+            }
+        }
+    })
+
+
+def render_time(scene, args, order):
+    integrator = {
+        'type': 'path',
+        'max_depth': args.max_depth,
+        'block_order': order
+    }
+    if args.block_size:
+        integrator['block_size'] = args.block_size
+    integrator = mi.load_dict(integrator)
+
+    start = time.perf_counter()
+    mi.render(scene, integrator=integrator, spp=args.spp)
+    return time.perf_counter() - start
+
+
+def perf_counters(args, order):
+    """Run the benchmark of a single order under 'perf stat'"""
+    events = 'cache-references,cache-misses'
+    cmd = ['perf', 'stat', '-x', ',', '-e', events, sys.executable,
+           os.path.abspath(__file__), '--single', order] + args.forward
+    result = subprocess.run(cmd, capture_output=True, text=True, check=True)
+
+    counters = {}
+    for line in result.stderr.splitlines():
+        fields = line.split(',')
+        if len(fields) > 2 and fields[2] in events.split(','):
+            counters[fields[2]] = int(fields[0]) if fields[0].isdigit() else None
+    return float(result.stdout.split()[-1]), counters
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Compare the image block orders of the scalar variants.')
+    parser.add_argument('--variant', default='scalar_rgb',
+                        help='scalar variant to use (default: scalar_rgb)')
+    parser.add_argument('--scene', help='scene file to render (default: '
+                        'procedural height field)')
+    parser.add_argument('--resolution', type=int, default=1024,
+                        help='grid resolution of the procedural height field')
+    parser.add_argument('--texture-resolution', type=int, default=4096,
+                        help='resolution of the texture of the height field')
+    parser.add_argument('--width', type=int, default=1920,
+                        help='width of the procedural scene\'s film')
+    parser.add_argument('--height', type=int, default=1080,
+                        help='height of the procedural scene\'s film')
+    parser.add_argument('--spp', type=int, default=4,
+                        help='samples per pixel (default: 4)')
+    parser.add_argument('--max-depth', type=int, default=3,
+                        help='maximum path depth (default: 3)')
+    parser.add_argument('--block-size', type=int,
+                        help='value of the "block_size" parameter')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='number of renders per order (the fastest one is '
+                        'reported)')
+    parser.add_argument('--perf', action='store_true',
+                        help='measure the cache misses with "perf stat"')
+    parser.add_argument('--single', choices=ORDERS, help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    # Options that are passed on to the child processes of '--perf'
+    args.forward = [a for a in sys.argv[1:] if a != '--perf']
+
+    mi.set_variant(args.variant)
+    if dr.is_jit_v(mi.Float):
+        parser.error('block orders only apply to the scalar variants')
+    mi.set_log_level(mi.LogLevel.Warn)
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        if args.perf:
+            print('%8s  %10s  %14s  %14s  %8s' % ('Order', 'Time [s]',
+                  'References', 'Misses', 'Ratio'))
+            baseline = None
+            for order in ORDERS:
+                t, c = perf_counters(args, order)
+                refs, misses = c.get('cache-references'), c.get('cache-misses')
+                if misses is None:
+                    print('%8s  %10.3f  (counters not supported)' % (order, t))
+                    continue
+                if baseline is None:
+                    baseline = misses
+                print('%8s  %10.3f  %14i  %14i  %7.2fx' %
+                      (order, t, refs or 0, misses, misses / baseline))
+            return
+
+        scene = load_scene(args, tmpdir)
+        orders = [args.single] if args.single else ORDERS
+
+        # Warm up (loads the textures, builds the acceleration data structure)
+        render_time(scene, args, orders[0])
+
+        if args.single:
+            # Child process of '--perf': only print the render time
+            print(min(render_time(scene, args, args.single)
+                      for _ in range(args.repeat)))
+            return
+
+        print('%8s  %10s  %8s' % ('Order', 'Time [s]', 'Speedup'))
+        baseline = None
+        for order in orders:
+            t = min(render_time(scene, args, order) for _ in range(args.repeat))
+            if baseline is None:
+                baseline = t
+            print('%8s  %10.3f  %7.2fx' % (order, t, baseline / t))
+
+
+if __name__ == '__main__':
+    main()
@@ -93,6 +93,10 @@ public:
         if (bsdf_index != 2)
             Throw("BlendBSDF: Two child BSDFs must be specified!");
 
+        update_components();
+    }
+
+    void update_components() {
         m_components.clear();
         for (size_t i = 0; i < 2; ++i)
             for (size_t j = 0; j < m_nested_bsdf[i]->component_count(); ++j)
@@ -102,6 +106,26 @@ public:
         dr::set_attr(this, "flags", m_flags);
     }
 
+    ref<Base> simplify() override {
+        for (size_t i = 0; i < 2; ++i)
+            m_nested_bsdf[i] = m_nested_bsdf[i]->simplify();
+
+        // A constant weight of zero or one only selects one of the BSDFs
+        if (!m_weight->is_spatially_varying()) {
+            ScalarFloat weight = (ScalarFloat) dr::slice(m_weight->mean());
+            if (weight <= 0.f)
+                return m_nested_bsdf[0];
+            else if (weight >= 1.f)
+                return m_nested_bsdf[1];
+        }
+
+        if (m_nested_bsdf[0] == m_nested_bsdf[1])
+            return m_nested_bsdf[0];
+
+        update_components();
+        return this;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("weight", m_weight.get(),          +ParamFlags::Differentiable);
         callback->put_object("bsdf_0", m_nested_bsdf[0].get(),  +ParamFlags::Differentiable);
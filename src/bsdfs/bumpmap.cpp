@@ -107,6 +107,10 @@ public:
 
         m_scale = props.get<ScalarFloat>("scale", 1.f);
 
+        update_components();
+    }
+
+    void update_components() {
         // Add all nested components
         m_components.clear();
         for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i)
@@ -115,6 +119,17 @@ public:
         dr::set_attr(this, "flags", m_flags);
     }
 
+    ref<Base> simplify() override {
+        m_nested_bsdf = m_nested_bsdf->simplify();
+
+        // A constant height field does not perturb the shading frame
+        if (m_scale == 0.f || !m_nested_texture->is_spatially_varying())
+            return m_nested_bsdf;
+
+        update_components();
+        return this;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("nested_bsdf",     m_nested_bsdf.get(),    ParamFlags::Differentiable | ParamFlags::Discontinuous);
         callback->put_object("nested_texture",  m_nested_texture.get(), ParamFlags::Differentiable | ParamFlags::Discontinuous);
@@ -226,6 +241,11 @@ public:
         return m_nested_bsdf->eval_diffuse_reflectance(si, active);
     }
 
+    uint32_t ray_flags() const override {
+        // The perturbed frame is aligned with the position partials
+        return RayFlags::UV | RayFlags::dPdUV;
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "BumpMap[" << std::endl
@@ -90,14 +90,21 @@ public:
     SmoothDiffuse(const Properties &props) : Base(props) {
         m_reflectance = props.texture<Texture>("reflectance", .5f);
         m_flags = BSDFFlags::DiffuseReflection | BSDFFlags::FrontSide;
-        dr::set_attr(this, "flags", m_flags);
         m_components.push_back(m_flags);
+        if (m_reflectance->needs_differentials())
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
+        dr::set_attr(this, "flags", m_flags);
+        update_reflectance_value();
     }
 
     void traverse(TraversalCallback *callback) override {
         callback->put_object("reflectance", m_reflectance.get(), +ParamFlags::Differentiable);
     }
 
+    void parameters_changed(const std::vector<std::string> &/*keys*/) override {
+        update_reflectance_value();
+    }
+
     std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
                                              const SurfaceInteraction3f &si,
                                              Float /* sample1 */,
@@ -119,7 +126,7 @@ public:
         bs.sampled_type = +BSDFFlags::DiffuseReflection;
         bs.sampled_component = 0;
 
-        UnpolarizedSpectrum value = m_reflectance->eval(si, active);
+        UnpolarizedSpectrum value = reflectance(si, active);
 
         return { bs, depolarizer<Spectrum>(value) & (active && bs.pdf > 0.f) };
     }
@@ -137,7 +144,7 @@ public:
         active &= cos_theta_i > 0.f && cos_theta_o > 0.f;
 
         UnpolarizedSpectrum value =
-            m_reflectance->eval(si, active) * dr::InvPi<Float> * cos_theta_o;
+            reflectance(si, active) * dr::InvPi<Float> * cos_theta_o;
 
         return depolarizer<Spectrum>(value) & active;
     }
@@ -172,16 +179,53 @@ public:
         active &= cos_theta_i > 0.f && cos_theta_o > 0.f;
 
         UnpolarizedSpectrum value =
-            m_reflectance->eval(si, active) * dr::InvPi<Float> * cos_theta_o;
+            reflectance(si, active) * dr::InvPi<Float> * cos_theta_o;
 
         Float pdf = warp::square_to_cosine_hemisphere_pdf(wo);
 
         return { depolarizer<Spectrum>(value) & active, dr::select(active, pdf, 0.f) };
     }
 
+    std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>
+    eval_pdf_sample(const BSDFContext &ctx,
+                    const SurfaceInteraction3f &si,
+                    const Vector3f &wo,
+                    Float /* sample1 */,
+                    const Point2f &sample2,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        BSDFSample3f bs = dr::zeros<BSDFSample3f>();
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi),
+              cos_theta_o = Frame3f::cos_theta(wo);
+
+        active &= cos_theta_i > 0.f;
+        if (unlikely(dr::none_or<false>(active) ||
+                     !ctx.is_enabled(BSDFFlags::DiffuseReflection)))
+            return { 0.f, 0.f, bs, 0.f };
+
+        // The reflectance is shared by the evaluation and the sampling step
+        UnpolarizedSpectrum value = reflectance(si, active);
+
+        Mask active_e = active && cos_theta_o > 0.f;
+        Spectrum e_val =
+            depolarizer<Spectrum>(value * dr::InvPi<Float> * cos_theta_o) & active_e;
+        Float pdf = warp::square_to_cosine_hemisphere_pdf(wo);
+
+        bs.wo = warp::square_to_cosine_hemisphere(sample2);
+        bs.pdf = warp::square_to_cosine_hemisphere_pdf(bs.wo);
+        bs.eta = 1.f;
+        bs.sampled_type = +BSDFFlags::DiffuseReflection;
+        bs.sampled_component = 0;
+
+        return { e_val, dr::select(active_e, pdf, 0.f), bs,
+                 depolarizer<Spectrum>(value) & (active && bs.pdf > 0.f) };
+    }
+
     Spectrum eval_diffuse_reflectance(const SurfaceInteraction3f &si,
                                       Mask active) const override {
-        return m_reflectance->eval(si, active);
+        return reflectance(si, active);
     }
 
     std::string to_string() const override {
@@ -193,8 +237,32 @@ public:
     }
 
     MI_DECLARE_CLASS()
+private:
+    /**
+     * Store the value of a uniform reflectance texture, which skips the
+     * texture call in the BSDF methods. Differentiable variants always
+     * evaluate the texture so that gradients reach its parameters.
+     */
+    void update_reflectance_value() {
+        m_reflectance_uniform = !dr::is_diff_v<Float> && m_reflectance->is_uniform();
+        if (m_reflectance_uniform) {
+            m_reflectance_value =
+                m_reflectance->eval(dr::zeros<SurfaceInteraction3f>());
+            dr::make_opaque(m_reflectance_value);
+        }
+    }
+
+    UnpolarizedSpectrum reflectance(const SurfaceInteraction3f &si,
+                                    Mask active) const {
+        if (m_reflectance_uniform)
+            return m_reflectance_value;
+        return m_reflectance->eval(si, active);
+    }
+
 private:
     ref<Texture> m_reflectance;
+    UnpolarizedSpectrum m_reflectance_value;
+    bool m_reflectance_uniform = false;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(SmoothDiffuse, BSDF)
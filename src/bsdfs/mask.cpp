@@ -19,6 +19,13 @@ Opacity mask (:monosp:`mask`)
    - Specifies the opacity (where 1=completely opaque) (Default: 0.5)
    - |exposed|, |differentiable|, |discontinuous|
 
+ * - cutoff
+   - |float|
+   - Alpha-test threshold of the opacity. When positive, the surface is
+     treated as fully opaque where the opacity is at least :monosp:`cutoff`
+     and as fully transparent elsewhere, and the transparent parts are
+     skipped while tracing rays (Default: 0, i.e. disabled)
+
  * - (Nested plugin)
    - |bsdf|
    - A base BSDF model that represents the non-transparent portion of the scattering
@@ -40,6 +47,16 @@ Note that the standard :ref:`path tracer <integrator-path>` does not have a good
 but the (:ref:`volumetric path tracer <integrator-volpath>`) does. It may thus be preferable when rendering
 scenes that contain the :ref:`mask <bsdf-mask>` plugin, even if there is nothing *volumetric* in the scene.
 
+Foliage and other cutout geometry is better described with an alpha test
+(:monosp:`cutoff` parameter). The ray tracing backends then skip the
+intersections with the transparent parts of the surface during the traversal
+of the acceleration data structure instead of reporting them. Rays therefore
+no longer continue (and count against the maximum path depth) at every
+transparent texel. The scalar variants evaluate the opacity within the
+traversal (kd-tree, BVH, and Embree intersection filters), while the JIT
+variants continue the traversal past rejected intersections before returning.
+Alpha tests are only applied to shapes that are not part of an instance.
+
 The following XML snippet describes a material configuration for a transparent leaf:
 
 .. tabs::
@@ -87,12 +104,16 @@ The following XML snippet describes a material configuration for a transparent l
 template <typename Float, typename Spectrum>
 class MaskBSDF final : public BSDF<Float, Spectrum> {
 public:
-    MI_IMPORT_BASE(BSDF, component_count, m_components, m_flags)
+    MI_IMPORT_BASE(BSDF, component_count, m_components, m_flags, m_alpha_test)
     MI_IMPORT_TYPES(Texture)
 
     MaskBSDF(const Properties &props) : Base(props) {
         // Scalar-typed opacity texture
         m_opacity = props.texture<Texture>("opacity", 0.5f);
+        m_cutoff = props.get<ScalarFloat>("cutoff", 0.f);
+        if (m_cutoff < 0.f || m_cutoff > 1.f)
+            Throw("The alpha-test cutoff must be in the range [0, 1]!");
+        m_alpha_test = m_cutoff > 0.f;
 
         for (auto &[name, obj] : props.objects(false)) {
             auto *bsdf = dynamic_cast<Base *>(obj.get());
@@ -106,6 +127,10 @@ public:
         if (!m_nested_bsdf)
            Throw("Child BSDF not specified");
 
+        update_components();
+    }
+
+    void update_components() {
         m_components.clear();
         for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i)
             m_components.push_back(m_nested_bsdf->flags(i));
@@ -116,6 +141,18 @@ public:
         dr::set_attr(this, "flags", m_flags);
     }
 
+    ref<Base> simplify() override {
+        m_nested_bsdf = m_nested_bsdf->simplify();
+
+        // A fully opaque mask never lets light pass through
+        if (!m_opacity->is_spatially_varying() &&
+            (ScalarFloat) dr::slice(m_opacity->mean()) >= 1.f)
+            return m_nested_bsdf;
+
+        update_components();
+        return this;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("opacity",     m_opacity.get(),     ParamFlags::Differentiable | ParamFlags::Discontinuous);
         callback->put_object("nested_bsdf", m_nested_bsdf.get(), +ParamFlags::Differentiable);
@@ -217,7 +254,16 @@ public:
     }
 
     MI_INLINE Float eval_opacity(const SurfaceInteraction3f &si, Mask active) const {
-        return dr::clamp(m_opacity->eval_1(si, active), 0.f, 1.f);
+        Float opacity = dr::clamp(m_opacity->eval_1(si, active), 0.f, 1.f);
+        if (m_alpha_test)
+            opacity = dr::select(opacity >= m_cutoff, 1.f, 0.f);
+        return opacity;
+    }
+
+    Mask alpha_test(const SurfaceInteraction3f &si, Mask active) const override {
+        if (!m_alpha_test)
+            return true;
+        return m_opacity->eval_1(si, active) >= m_cutoff;
     }
 
     Spectrum eval_diffuse_reflectance(const SurfaceInteraction3f &si,
@@ -229,6 +275,7 @@ public:
         std::ostringstream oss;
         oss << "Mask[" << std::endl
             << "  opacity = " << m_opacity << "," << std::endl
+            << "  cutoff = " << m_cutoff << "," << std::endl
             << "  nested_bsdf = " << string::indent(m_nested_bsdf) << std::endl
             << "]";
         return oss.str();
@@ -238,6 +285,7 @@ public:
 private:
     ref<Texture> m_opacity;
     ref<Base> m_nested_bsdf;
+    ScalarFloat m_cutoff;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(MaskBSDF, BSDF)
@@ -1,3 +1,4 @@
+#include <mitsuba/core/assetcache.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/tensor.h>
@@ -78,6 +79,18 @@ public:
     using Warp2D2 = Marginal2D<Float, 2, true>;
     using Warp2D3 = Marginal2D<Float, 3, true>;
 
+    /// Warps of a measurement file that can be shared between several instances
+    struct MeasuredData : Object {
+        Warp2D0 ndf;
+        Warp2D0 sigma;
+        Warp2D2 vndf;
+        Warp2D2 luminance;
+        Warp2D3 spectra;
+        bool isotropic;
+        bool jacobian;
+        int reduction = 0;
+    };
+
     Measured(const Properties &props) : Base(props) {
         m_components.push_back(BSDFFlags::GlossyReflection | BSDFFlags::FrontSide);
         m_flags = m_components[0];
@@ -87,7 +100,23 @@ public:
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name             = file_path.filename().string();
 
+        /* Share the warps with other instances that load the same file,
+           which is common in scenes with many measured materials */
+        std::string key = tfm::format("measured:%s",
+                                      detail::get_variant<Float, Spectrum>());
+        m_data = (MeasuredData *) AssetCache::get(file_path, key, [&]() {
+            return ref<Object>(load(file_path));
+        }).get();
+
+        m_isotropic = m_data->isotropic;
+        m_jacobian  = m_data->jacobian;
+        m_reduction = m_data->reduction;
+    }
+
+    /// Load the warps from a measurement file
+    static ref<MeasuredData> load(const fs::path &file_path) {
         ref<TensorFile> tf = new TensorFile(file_path);
+        ref<MeasuredData> data = new MeasuredData();
         using Field = TensorFile::Field;
 
         const Field &theta_i       = tf->field("theta_i");
@@ -163,31 +192,31 @@ public:
               jacobian.dtype == Struct::Type::UInt8))
               Throw("Invalid file structure: %s", tf);
 
-        m_isotropic = phi_i.shape[0] <= 2;
-        m_jacobian  = ((uint8_t *) jacobian.data)[0];
+        data->isotropic = phi_i.shape[0] <= 2;
+        data->jacobian  = ((uint8_t *) jacobian.data)[0];
 
-        if (!m_isotropic) {
+        if (!data->isotropic) {
             ScalarFloat *phi_i_data = (ScalarFloat *) phi_i.data;
-            m_reduction = (int) std::rint((2 * dr::Pi<ScalarFloat>) /
+            data->reduction = (int) std::rint((2 * dr::Pi<ScalarFloat>) /
                 (phi_i_data[phi_i.shape[0] - 1] - phi_i_data[0]));
         }
 
         // Construct NDF interpolant data structure
-        m_ndf = Warp2D0(
+        data->ndf = Warp2D0(
             (ScalarFloat *) ndf.data,
             ScalarVector2u(ndf.shape[1], ndf.shape[0]),
             { }, { }, false, false
         );
 
         // Construct projected surface area interpolant data structure
-        m_sigma = Warp2D0(
+        data->sigma = Warp2D0(
             (ScalarFloat *) sigma.data,
             ScalarVector2u(sigma.shape[1], sigma.shape[0]),
             { }, { }, false, false
         );
 
         // Construct VNDF warp data structure
-        m_vndf = Warp2D2(
+        data->vndf = Warp2D2(
             (ScalarFloat *) vndf.data,
             ScalarVector2u(vndf.shape[3], vndf.shape[2]),
             {{ (uint32_t) phi_i.shape[0],
@@ -197,7 +226,7 @@ public:
         );
 
         // Construct Luminance warp data structure
-        m_luminance = Warp2D2(
+        data->luminance = Warp2D2(
             (ScalarFloat *) luminance.data,
             ScalarVector2u(luminance.shape[3], luminance.shape[2]),
             {{ (uint32_t) phi_i.shape[0],
@@ -207,7 +236,7 @@ public:
         );
 
         // Construct spectral interpolant
-        m_spectra = Warp2D3(
+        data->spectra = Warp2D3(
             (ScalarFloat *) spectra.data,
             ScalarVector2u(spectra.shape[4], spectra.shape[3]),
             {{ (uint32_t) phi_i.shape[0],
@@ -227,6 +256,8 @@ public:
         Log(Info, "Loaded material \"%s\" (resolution %i x %i x %i x %i x %i)",
             description_str, spectra.shape[0], spectra.shape[1],
             spectra.shape[3], spectra.shape[4], spectra.shape[2]);
+
+        return data;
     }
 
     /**
@@ -276,10 +307,10 @@ public:
         Float pdf = 1.f;
 
         #if MI_SAMPLE_LUMINANCE == 1
-        std::tie(sample, pdf) = m_luminance.sample(sample, params, active);
+        std::tie(sample, pdf) = m_data->luminance.sample(sample, params, active);
         #endif
 
-        auto [u_m, ndf_pdf] = m_vndf.sample(sample, params, active);
+        auto [u_m, ndf_pdf] = m_data->vndf.sample(sample, params, active);
 
         Float phi_m   = u2phi(u_m.y()),
               theta_m = u2theta(u_m.x());
@@ -317,7 +348,7 @@ public:
 
         u_m[1] = u_m[1] - dr::floor(u_m[1]);
 
-    std::tie(sample, std::ignore) = m_vndf.invert(u_m, params, active);
+    std::tie(sample, std::ignore) = m_data->vndf.invert(u_m, params, active);
 #endif // MI_SAMPLE_DIFFUSE
 
         bs.eta               = 1.f;
@@ -328,12 +359,12 @@ public:
         for (size_t i = 0; i < dr::array_size_v<UnpolarizedSpectrum>; ++i) {
             Float params_spec[3] = { phi_i, theta_i,
                 is_spectral_v<Spectrum> ? si.wavelengths[i] : Float((float) i) };
-            spec[i] = m_spectra.eval(sample, params_spec, active);
+            spec[i] = m_data->spectra.eval(sample, params_spec, active);
         }
 
         if (m_jacobian)
-            spec *= m_ndf.eval(u_m, params, active) /
-                    (4 * m_sigma.eval(u_wi, params, active));
+            spec *= m_data->ndf.eval(u_m, params, active) /
+                    (4 * m_data->sigma.eval(u_wi, params, active));
 
         bs.wo.x() = dr::mulsign_neg(bs.wo.x(), sx);
         bs.wo.y() = dr::mulsign_neg(bs.wo.y(), sy);
@@ -381,18 +412,18 @@ public:
         u_m[1] = u_m[1] - dr::floor(u_m[1]);
 
         Float params[2] = { phi_i, theta_i };
-        auto [sample, unused] = m_vndf.invert(u_m, params, active);
+        auto [sample, unused] = m_data->vndf.invert(u_m, params, active);
 
         UnpolarizedSpectrum spec;
         for (size_t i = 0; i < dr::array_size_v<UnpolarizedSpectrum>; ++i) {
             Float params_spec[3] = { phi_i, theta_i,
                 is_spectral_v<Spectrum> ? si.wavelengths[i] : Float((float) i) };
-            spec[i] = m_spectra.eval(sample, params_spec, active);
+            spec[i] = m_data->spectra.eval(sample, params_spec, active);
         }
 
         if (m_jacobian)
-            spec *= m_ndf.eval(u_m, params, active) /
-                    (4 * m_sigma.eval(u_wi, params, active));
+            spec *= m_data->ndf.eval(u_m, params, active) /
+                    (4 * m_data->sigma.eval(u_wi, params, active));
 
         return depolarizer<Spectrum>(spec) & active;
     }
@@ -438,11 +469,11 @@ public:
         u_m[1] = u_m[1] - dr::floor(u_m[1]);
 
         Float params[2] = { phi_i, theta_i };
-        auto [sample, vndf_pdf] = m_vndf.invert(u_m, params, active);
+        auto [sample, vndf_pdf] = m_data->vndf.invert(u_m, params, active);
 
         Float pdf = 1.f;
         #if MI_SAMPLE_LUMINANCE == 1
-        pdf = m_luminance.eval(sample, params, active);
+        pdf = m_data->luminance.eval(sample, params, active);
         #endif
 
         Float jacobian =
@@ -459,11 +490,11 @@ public:
         std::ostringstream oss;
         oss << "Measured[" << std::endl
             << "  filename = \"" << m_name << "\"," << std::endl
-            << "  ndf = " << string::indent(m_ndf.to_string()) << "," << std::endl
-            << "  sigma = " << string::indent(m_sigma.to_string()) << "," << std::endl
-            << "  vndf = " << string::indent(m_vndf.to_string()) << "," << std::endl
-            << "  luminance = " << string::indent(m_luminance.to_string()) << "," << std::endl
-            << "  spectra = " << string::indent(m_spectra.to_string()) << std::endl
+            << "  ndf = " << string::indent(m_data->ndf.to_string()) << "," << std::endl
+            << "  sigma = " << string::indent(m_data->sigma.to_string()) << "," << std::endl
+            << "  vndf = " << string::indent(m_data->vndf.to_string()) << "," << std::endl
+            << "  luminance = " << string::indent(m_data->luminance.to_string()) << "," << std::endl
+            << "  spectra = " << string::indent(m_data->spectra.to_string()) << std::endl
             << "]";
         return oss.str();
     }
@@ -488,11 +519,7 @@ private:
 
 private:
     std::string m_name;
-    Warp2D0 m_ndf;
-    Warp2D0 m_sigma;
-    Warp2D2 m_vndf;
-    Warp2D2 m_luminance;
-    Warp2D3 m_spectra;
+    ref<MeasuredData> m_data;
     bool m_isotropic;
     bool m_jacobian;
     int m_reduction;
@@ -98,7 +98,12 @@ public:
         // TODO: How to assert this is actually a RGBDataTexture?
         m_normalmap = props.texture<Texture>("normalmap");
 
+        update_components();
+    }
+
+    void update_components() {
         // Add all nested components
+        m_components.clear();
         m_flags = (uint32_t) 0;
         for (size_t i = 0; i < m_nested_bsdf->component_count(); ++i) {
             m_components.push_back((m_nested_bsdf->flags(i)));
@@ -107,6 +112,12 @@ public:
         dr::set_attr(this, "flags", m_flags);
     }
 
+    ref<Base> simplify() override {
+        m_nested_bsdf = m_nested_bsdf->simplify();
+        update_components();
+        return this;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("nested_bsdf", m_nested_bsdf.get(), +ParamFlags::Differentiable);
         callback->put_object("normalmap",   m_normalmap.get(),   ParamFlags::Differentiable | ParamFlags::Discontinuous);
@@ -195,6 +206,11 @@ public:
         return result;
     }
 
+    uint32_t ray_flags() const override {
+        // The perturbed frame is aligned with the position partials
+        return RayFlags::UV | RayFlags::dPdUV;
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "NormalMap[" << std::endl
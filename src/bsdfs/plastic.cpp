@@ -177,6 +177,9 @@ public:
         m_components.push_back(BSDFFlags::DeltaReflection | BSDFFlags::FrontSide);
         m_components.push_back(BSDFFlags::DiffuseReflection | BSDFFlags::FrontSide);
         m_flags = m_components[0] | m_components[1];
+        if (m_diffuse_reflectance->needs_differentials() ||
+            (m_specular_reflectance && m_specular_reflectance->needs_differentials()))
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
         dr::set_attr(this, "flags", m_flags);
 
         parameters_changed();
@@ -265,6 +265,8 @@ public:
 
         for (auto c : m_components)
             m_flags |= c;
+        if (m_base_color->needs_differentials())
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
         dr::set_attr(this, "flags", m_flags);
     }
 
@@ -344,22 +346,180 @@ public:
         if (unlikely(dr::none_or<false>(active)))
             return { bs, 0.0f };
 
-        // Store the weights.
-        Float anisotropic = m_has_anisotropic ? m_anisotropic->eval_1(si, active) : 0.0f,
-        roughness = m_roughness->eval_1(si, active),
-        spec_trans = m_has_spec_trans ? m_spec_trans->eval_1(si, active) : 0.0f,
-        metallic = m_has_metallic ? m_metallic->eval_1(si, active) : 0.0f,
-        clearcoat = m_has_clearcoat ? m_clearcoat->eval_1(si, active) : 0.0f;
+        Parameters p = eval_parameters(si, active);
+
+        std::tie(bs, active) = sample_direction(si, p, sample1, sample2, active);
+
+        auto [value, pdf] = eval_pdf_impl(ctx, si, bs.wo, p, true, true, active);
+        bs.pdf = pdf;
+        active &= bs.pdf > 0.0f;
+        return { bs, depolarizer<Spectrum>(value) / bs.pdf & active };
+    }
+
+    Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                  const Vector3f &wo, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi);
+        // Ignore perfectly grazing configurations
+        active &= dr::neq(cos_theta_i, 0.0f);
+
+        if (unlikely(dr::none_or<false>(active)))
+            return 0.0f;
+
+        Parameters p = eval_parameters(si, active);
+        UnpolarizedSpectrum value =
+            eval_pdf_impl(ctx, si, wo, p, true, false, active).first;
+
+        return depolarizer<Spectrum>(value) & active;
+    }
+
+    Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+              const Vector3f &wo, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi);
+        // Ignore perfectly grazing configurations.
+        active &= dr::neq(cos_theta_i, 0.0f);
+
+        if (unlikely(dr::none_or<false>(active)))
+            return 0.0f;
+
+        Parameters p = eval_parameters(si, active, false);
+        return eval_pdf_impl(ctx, si, wo, p, false, true, active).second;
+    }
+
+    std::pair<Spectrum, Float> eval_pdf(const BSDFContext &ctx,
+                                        const SurfaceInteraction3f &si,
+                                        const Vector3f &wo,
+                                        Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi);
+        // Ignore perfectly grazing configurations
+        active &= dr::neq(cos_theta_i, 0.0f);
+
+        if (unlikely(dr::none_or<false>(active)))
+            return { 0.0f, 0.0f };
+
+        Parameters p = eval_parameters(si, active);
+        auto [value, pdf] = eval_pdf_impl(ctx, si, wo, p, true, true, active);
+
+        return { depolarizer<Spectrum>(value) & active, pdf };
+    }
+
+    std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>
+    eval_pdf_sample(const BSDFContext &ctx,
+                    const SurfaceInteraction3f &si,
+                    const Vector3f &wo,
+                    Float sample1,
+                    const Point2f &sample2,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi);
+        BSDFSample3f bs   = dr::zeros<BSDFSample3f>();
+
+        // Ignore perfectly grazing configurations
+        active &= dr::neq(cos_theta_i, 0.0f);
+
+        if (unlikely(dr::none_or<false>(active)))
+            return { 0.0f, 0.0f, bs, 0.0f };
+
+        // The texture lookups are shared by the evaluation and sampling step
+        Parameters p = eval_parameters(si, active);
+
+        auto [e_value, e_pdf] = eval_pdf_impl(ctx, si, wo, p, true, true, active);
+
+        Mask active_s;
+        std::tie(bs, active_s) = sample_direction(si, p, sample1, sample2, active);
+
+        auto [s_value, s_pdf] = eval_pdf_impl(ctx, si, bs.wo, p, true, true, active_s);
+        bs.pdf = s_pdf;
+        active_s &= bs.pdf > 0.0f;
+
+        return { depolarizer<Spectrum>(e_value) & active, e_pdf, bs,
+                 depolarizer<Spectrum>(s_value) / bs.pdf & active_s };
+    }
+
+    Spectrum eval_diffuse_reflectance(const SurfaceInteraction3f &si,
+                                      Mask active) const override {
+        return m_base_color->eval(si, active);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "Principled BSDF :" << std::endl
+            << "base_color: " << m_base_color << "," << std::endl
+            << "spec_trans: " << m_spec_trans << "," << std::endl
+            << "anisotropic: " << m_anisotropic << "," << std::endl
+            << "roughness: " << m_roughness << "," << std::endl
+            << "sheen: " << m_sheen << "," << std::endl
+            << "sheen_tint: " << m_sheen_tint << "," << std::endl
+            << "flatness: " << m_flatness << "," << std::endl;
+        if (m_eta_specular)
+            oss << "eta: " << m_eta << "," << std::endl;
+        else
+            oss << "specular: " << m_specular << "," << std::endl;
+        oss << "clearcoat: " << m_clearcoat << "," << std::endl
+            << "clearcoat_gloss: " << m_clearcoat_gloss << "," << std::endl
+            << "metallic: " << m_metallic << "," << std::endl
+            << "spec_tint: " << m_spec_tint << "," << std::endl;
+
+        return oss.str();
+    }
+    MI_DECLARE_CLASS()
+private:
+    /// Texture lookups at a surface position, shared by all queries of a call
+    struct Parameters {
+        Float anisotropic, roughness, flatness, spec_trans, metallic,
+              clearcoat, clearcoat_gloss, sheen;
+        UnpolarizedSpectrum base_color;
+    };
+
+    /**
+     * \brief Evaluate the textures of the model at the given position
+     *
+     * The textures that only affect the value of the BSDF are skipped when
+     * \c has_value is \c false.
+     */
+    Parameters eval_parameters(const SurfaceInteraction3f &si, Mask active,
+                               bool has_value = true) const {
+        Parameters p;
+        p.anisotropic = m_has_anisotropic ? m_anisotropic->eval_1(si, active) : 0.0f;
+        p.roughness = m_roughness->eval_1(si, active);
+        p.spec_trans = m_has_spec_trans ? m_spec_trans->eval_1(si, active) : 0.0f;
+        p.metallic = m_has_metallic ? m_metallic->eval_1(si, active) : 0.0f;
+        p.clearcoat = m_has_clearcoat ? m_clearcoat->eval_1(si, active) : 0.0f;
+        p.clearcoat_gloss = m_has_clearcoat ? m_clearcoat_gloss->eval_1(si, active) : 0.0f;
+        p.flatness = has_value && m_has_flatness ? m_flatness->eval_1(si, active) : 0.0f;
+        p.sheen = has_value && m_has_sheen ? m_sheen->eval_1(si, active) : 0.0f;
+        p.base_color = has_value ? m_base_color->eval(si, active)
+                                  : UnpolarizedSpectrum(0.0f);
+        return p;
+    }
+
+    /**
+     * \brief Sample a direction from one of the lobes of the model
+     *
+     * Returns the sampled direction (without its density) along with the
+     * mask of the valid samples.
+     */
+    std::pair<BSDFSample3f, Mask>
+    sample_direction(const SurfaceInteraction3f &si, const Parameters &p,
+                     Float sample1, const Point2f &sample2, Mask active) const {
+        Float cos_theta_i = Frame3f::cos_theta(si.wi);
+        BSDFSample3f bs   = dr::zeros<BSDFSample3f>();
 
         // Weights of BSDF and BRDF major lobes
-        Float brdf = (1.0f - metallic) * (1.0f - spec_trans),
-        bsdf = m_has_spec_trans ? (1.0f - metallic) * spec_trans : 0.0f;
+        Float brdf = (1.0f - p.metallic) * (1.0f - p.spec_trans),
+        bsdf = m_has_spec_trans ? (1.0f - p.metallic) * p.spec_trans : 0.0f;
 
         // Mask for incident side. (wi.z<0)
         Mask front_side = cos_theta_i > 0.0f;
 
         // Defining main specular reflection distribution
-        auto [ax, ay] = calc_dist_params(anisotropic, roughness,m_has_anisotropic);
+        auto [ax, ay] = calc_dist_params(p.anisotropic, p.roughness, m_has_anisotropic);
         MicrofacetDistribution spec_distr(MicrofacetType::GGX, ax, ay);
         Normal3f m_spec = std::get<0>(
                 spec_distr.sample(dr::mulsign(si.wi, cos_theta_i), sample2));
@@ -388,7 +548,7 @@ public:
         // Clearcoat has 1/4 of the main specular reflection energy.
         Float prob_clearcoat =
                 m_has_clearcoat
-                ? dr::select(front_side, 0.25f * clearcoat * m_clearcoat_srate,
+                ? dr::select(front_side, 0.25f * p.clearcoat * m_clearcoat_srate,
                              0.0f)
                              : 0.0f;
         Float prob_diffuse = dr::select(front_side, brdf * m_diff_refl_srate, 0.0f);
@@ -454,10 +614,8 @@ public:
         }
         // The secondary specular reflection sampling (clearcoat)
         if (m_has_clearcoat && dr::any_or<true>(sample_clearcoat)) {
-            Float clearcoat_gloss = m_clearcoat_gloss->eval_1(si, active);
-
             // Clearcoat roughness is mapped between 0.1 and 0.001.
-            GTR1 cc_dist(dr::lerp(0.1f, 0.001f, clearcoat_gloss));
+            GTR1 cc_dist(dr::lerp(0.1f, 0.001f, p.clearcoat_gloss));
             Normal3f m_cc                = cc_dist.sample(sample2);
             Vector3f wo                         = reflect(si.wi, m_cc);
             dr::masked(bs.wo, sample_clearcoat) = wo;
@@ -485,38 +643,27 @@ public:
             active &= (!sample_diffuse || reflect);
         }
 
-        bs.pdf = pdf(ctx, si, bs.wo, active);
-        active &= bs.pdf > 0.0f;
-        Spectrum result = eval(ctx, si, bs.wo, active);
-        return { bs, result / bs.pdf & active };
+        return { bs, active };
     }
 
-    Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
-                  const Vector3f &wo, Mask active) const override {
-        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
-
-        Float cos_theta_i = Frame3f::cos_theta(si.wi);
-        // Ignore perfectly grazing configurations
-        active &= dr::neq(cos_theta_i, 0.0f);
-
-        if (unlikely(dr::none_or<false>(active)))
-            return 0.0f;
-
-        // Store the weights.
-        Float anisotropic = m_has_anisotropic ? m_anisotropic->eval_1(si, active) : 0.0f,
-              roughness = m_roughness->eval_1(si, active),
-              flatness = m_has_flatness ? m_flatness->eval_1(si, active) : 0.0f,
-              spec_trans = m_has_spec_trans ? m_spec_trans->eval_1(si, active) : 0.0f,
-              metallic = m_has_metallic ? m_metallic->eval_1(si, active) : 0.0f,
-              clearcoat = m_has_clearcoat ? m_clearcoat->eval_1(si, active) : 0.0f,
-              sheen = m_has_sheen ? m_sheen->eval_1(si, active) : 0.0f;
-        UnpolarizedSpectrum base_color = m_base_color->eval(si, active);
+    /**
+     * \brief Jointly evaluate the model and its sampling density
+     *
+     * Both queries share the half-vector, the Fresnel coefficient and the
+     * microfacet terms. The value and the density are respectively skipped
+     * (and set to zero) when \c has_value or \c has_pdf is \c false. The
+     * returned value is not masked by \c active.
+     */
+    std::pair<UnpolarizedSpectrum, Float>
+    eval_pdf_impl(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                  const Vector3f &wo, const Parameters &p, bool has_value,
+                  bool has_pdf, Mask active) const {
+        Float cos_theta_i = Frame3f::cos_theta(si.wi),
+              cos_theta_o = Frame3f::cos_theta(wo);
 
         // Weights for BRDF and BSDF major lobes.
-        Float brdf = (1.0f - metallic) * (1.0f - spec_trans),
-        bsdf = (1.0f - metallic) * spec_trans;
-
-        Float cos_theta_o = Frame3f::cos_theta(wo);
+        Float brdf = (1.0f - p.metallic) * (1.0f - p.spec_trans),
+        bsdf = (1.0f - p.metallic) * p.spec_trans;
 
         // Reflection and refraction masks.
         Mask reflect = cos_theta_i * cos_theta_o > 0.0f;
@@ -531,7 +678,7 @@ public:
         Float inv_eta_path = dr::select(front_side, inv_eta, m_eta);
 
         // Main specular reflection and transmission lobe
-        auto [ax, ay] = calc_dist_params(anisotropic, roughness,m_has_anisotropic);
+        auto [ax, ay] = calc_dist_params(p.anisotropic, p.roughness, m_has_anisotropic);
         MicrofacetDistribution spec_dist(MicrofacetType::GGX, ax, ay);
 
         // Halfway vector
@@ -549,322 +696,246 @@ public:
                 mac_mic_compatibility(wh, si.wi, wo, cos_theta_i, true);
         Mask refraction_compatibilty =
                 mac_mic_compatibility(wh, si.wi, wo, cos_theta_i, false);
-        // Masks for evaluating the lobes.
-        // Specular reflection mask
-        Mask spec_reflect_active = active && reflect &&
-                reflection_compatibilty &&
-                (F_spec_dielectric > 0.0f);
-
-        // Clearcoat mask
-        Mask clearcoat_active = m_has_clearcoat && active &&
-                (clearcoat > 0.0f) && reflect &&
-                reflection_compatibilty && front_side;
-
-        // Specular transmission mask
-        Mask spec_trans_active = m_has_spec_trans && active && (bsdf > 0.0f) &&
-                refract && refraction_compatibilty &&
-                (F_spec_dielectric < 1.0f);
-
-        // Diffuse, retro and fake subsurface mask
-        Mask diffuse_active = active && (brdf > 0.0f) && reflect && front_side;
-
-        // Sheen mask
-        Mask sheen_active = m_has_sheen && active && (sheen > 0.0f) &&
-                reflect && (1.0f - metallic > 0.0f) && front_side;
 
         // Evaluate the microfacet normal distribution
         Float D = spec_dist.eval(wh);
 
-        // Smith's shadowing-masking function
-        Float G = spec_dist.G(si.wi, wo, wh);
+        // Smith's shadowing-masking function of the incident direction
+        Float smith_g1_wi = spec_dist.smith_g1(si.wi, wh);
 
         // Initialize the final BSDF value.
         UnpolarizedSpectrum value(0.0f);
 
-        // Main specular reflection evaluation
-        if (dr::any_or<true>(spec_reflect_active)) {
-            // No need to calculate luminance if there is no color tint.
-            Float lum = m_has_spec_tint
-                    ? mitsuba::luminance(base_color, si.wavelengths)
-                    : 1.0f;
-            Float spec_tint =
-                    m_has_spec_tint ? m_spec_tint->eval_1(si, active) : 0.0f;
-
-            // Fresnel term
-            UnpolarizedSpectrum F_principled = principled_fresnel(
-                    F_spec_dielectric, metallic, spec_tint, base_color, lum,
-                    dr::dot(si.wi, wh), front_side, bsdf,m_eta,m_has_metallic,
-                    m_has_spec_tint);
-
-            // Adding the specular reflection component
-            dr::masked(value, spec_reflect_active) +=
-                    F_principled * D * G / (4.0f * dr::abs(cos_theta_i));
-        }
-
-        // Main specular transmission evaluation
-        if (m_has_spec_trans && dr::any_or<true>(spec_trans_active)) {
-
-            /* Account for the solid angle compression when tracing
-               radiance. This is necessary for bidirectional methods. */
-            Float scale = (ctx.mode == TransportMode::Radiance)
-                    ? dr::sqr(inv_eta_path)
-                    : Float(1.0f);
-
-            // Adding the specular transmission component
-            dr::masked(value, spec_trans_active) +=
-                    dr::sqrt(base_color) * bsdf *
-                    dr::abs((scale * (1.0f - F_spec_dielectric) * D * G * eta_path *
-                    eta_path * dr::dot(si.wi, wh) * dr::dot(wo, wh)) /
-                    (cos_theta_i * dr::sqr(dr::dot(si.wi, wh) +
-                    eta_path * dr::dot(wo, wh))));
-        }
-
-        // Secondary isotropic specular reflection.
-        if (m_has_clearcoat && dr::any_or<true>(clearcoat_active)) {
-            Float clearcoat_gloss = m_clearcoat_gloss->eval_1(si, active);
+        if (has_value) {
+            // Masks for evaluating the lobes.
+            // Specular reflection mask
+            Mask spec_reflect_active = active && reflect &&
+                    reflection_compatibilty &&
+                    (F_spec_dielectric > 0.0f);
+
+            // Clearcoat mask
+            Mask clearcoat_active = m_has_clearcoat && active &&
+                    (p.clearcoat > 0.0f) && reflect &&
+                    reflection_compatibilty && front_side;
+
+            // Specular transmission mask
+            Mask spec_trans_active = m_has_spec_trans && active && (bsdf > 0.0f) &&
+                    refract && refraction_compatibilty &&
+                    (F_spec_dielectric < 1.0f);
+
+            // Diffuse, retro and fake subsurface mask
+            Mask diffuse_active = active && (brdf > 0.0f) && reflect && front_side;
+
+            // Sheen mask
+            Mask sheen_active = m_has_sheen && active && (p.sheen > 0.0f) &&
+                    reflect && (1.0f - p.metallic > 0.0f) && front_side;
+
+            // Smith's shadowing-masking function
+            Float G = smith_g1_wi * spec_dist.smith_g1(wo, wh);
+
+            // Main specular reflection evaluation
+            if (dr::any_or<true>(spec_reflect_active)) {
+                // No need to calculate luminance if there is no color tint.
+                Float lum = m_has_spec_tint
+                        ? mitsuba::luminance(p.base_color, si.wavelengths)
+                        : 1.0f;
+                Float spec_tint =
+                        m_has_spec_tint ? m_spec_tint->eval_1(si, active) : 0.0f;
+
+                // Fresnel term
+                UnpolarizedSpectrum F_principled = principled_fresnel(
+                        F_spec_dielectric, p.metallic, spec_tint, p.base_color, lum,
+                        dr::dot(si.wi, wh), front_side, bsdf,m_eta,m_has_metallic,
+                        m_has_spec_tint);
+
+                // Adding the specular reflection component
+                dr::masked(value, spec_reflect_active) +=
+                        F_principled * D * G / (4.0f * dr::abs(cos_theta_i));
+            }
 
-            // Clearcoat lobe uses the schlick approximation for Fresnel
-            // term.
-            Float Fcc = calc_schlick<Float>(0.04f, dr::dot(si.wi, wh),m_eta);
+            // Main specular transmission evaluation
+            if (m_has_spec_trans && dr::any_or<true>(spec_trans_active)) {
+
+                /* Account for the solid angle compression when tracing
+                   radiance. This is necessary for bidirectional methods. */
+                Float scale = (ctx.mode == TransportMode::Radiance)
+                        ? dr::sqr(inv_eta_path)
+                        : Float(1.0f);
+
+                // Adding the specular transmission component
+                dr::masked(value, spec_trans_active) +=
+                        dr::sqrt(p.base_color) * bsdf *
+                        dr::abs((scale * (1.0f - F_spec_dielectric) * D * G * eta_path *
+                        eta_path * dr::dot(si.wi, wh) * dr::dot(wo, wh)) /
+                        (cos_theta_i * dr::sqr(dr::dot(si.wi, wh) +
+                        eta_path * dr::dot(wo, wh))));
+            }
 
-            /* Clearcoat lobe uses GTR1 distribution. Roughness is mapped
-             * between 0.1 and 0.001. */
-            GTR1 mfacet_dist(dr::lerp(0.1f, 0.001f, clearcoat_gloss));
-            Float Dcc = mfacet_dist.eval(wh);
+            // Secondary isotropic specular reflection.
+            if (m_has_clearcoat && dr::any_or<true>(clearcoat_active)) {
+                // Clearcoat lobe uses the schlick approximation for Fresnel
+                // term.
+                Float Fcc = calc_schlick<Float>(0.04f, dr::dot(si.wi, wh),m_eta);
 
-            // Shadowing shadowing-masking term
-            Float G_cc = clearcoat_G(si.wi, wo, wh, Float(0.25f));
+                /* Clearcoat lobe uses GTR1 distribution. Roughness is mapped
+                 * between 0.1 and 0.001. */
+                GTR1 mfacet_dist(dr::lerp(0.1f, 0.001f, p.clearcoat_gloss));
+                Float Dcc = mfacet_dist.eval(wh);
 
-            // Adding the clearcoat component.
-            dr::masked(value, clearcoat_active) +=
-                    (clearcoat * 0.25f) * Fcc * Dcc * G_cc * dr::abs(cos_theta_o);
-        }
+                // Shadowing shadowing-masking term
+                Float G_cc = clearcoat_G(si.wi, wo, wh, Float(0.25f));
 
-        // Evaluation of diffuse, retro reflection, fake subsurface and
-        // sheen.
-        if (dr::any_or<true>(diffuse_active)) {
-            Float Fo = schlick_weight(dr::abs(cos_theta_o)),
-            Fi = schlick_weight(dr::abs(cos_theta_i));
-
-            // Diffuse
-            Float f_diff = (1.0f - 0.5f * Fi) * (1.0f - 0.5f * Fo);
-
-            Float cos_theta_d = dr::dot(wh, wo);
-            Float Rr          = 2.0f * roughness * dr::sqr(cos_theta_d);
-
-            // Retro reflection
-            Float f_retro = Rr * (Fo + Fi + Fo * Fi * (Rr - 1.0f));
-
-            if (m_has_flatness) {
-                /* Fake subsurface implementation based on Hanrahan Krueger
-                   Fss90 used to "flatten" retro reflection based on
-                   roughness.*/
-                Float Fss90 = Rr / 2.0f;
-                Float Fss =
-                        dr::lerp(1.0f, Fss90, Fo) * dr::lerp(1.0f, Fss90, Fi);
-
-                Float f_ss = 1.25f * (Fss * (1.0f / (dr::abs(cos_theta_o) +
-                        dr::abs(cos_theta_i)) -
-                                0.5f) +
-                                        0.5f);
-
-                // Adding diffuse, retro and fake subsurface evaluation.
-                dr::masked(value, diffuse_active) +=
-                        brdf * dr::abs(cos_theta_o) * base_color *
-                        dr::InvPi<Float> *
-                        (dr::lerp(f_diff + f_retro, f_ss, flatness));
-            } else {
-                // Adding diffuse, retro evaluation. (no fake ss.)
-                dr::masked(value, diffuse_active) +=
-                        brdf * dr::abs(cos_theta_o) * base_color *
-                        dr::InvPi<Float> * (f_diff + f_retro);
+                // Adding the clearcoat component.
+                dr::masked(value, clearcoat_active) +=
+                        (p.clearcoat * 0.25f) * Fcc * Dcc * G_cc * dr::abs(cos_theta_o);
             }
-            // Sheen evaluation
-            if (m_has_sheen && dr::any_or<true>(sheen_active)) {
-                Float Fd = schlick_weight(dr::abs(cos_theta_d));
-
-                // Tint the sheen evaluation towards the base color.
-                if (m_has_sheen_tint) {
-                    Float sheen_tint = m_sheen_tint->eval_1(si, active);
-
-                    // Luminance evaluation
-                    Float lum = mitsuba::luminance(base_color, si.wavelengths);
-
-                    // Normalize color with luminance and tint the result.
-                    UnpolarizedSpectrum c_tint =
-                            dr::select(lum > 0.0f, base_color / lum, 1.0f);
-                    UnpolarizedSpectrum c_sheen = dr::lerp(1.0f, c_tint, sheen_tint);
-
-                    // Adding sheen evaluation with tint.
-                    dr::masked(value, sheen_active) +=
-                            sheen * (1.0f - metallic) * Fd * c_sheen *
-                            dr::abs(cos_theta_o);
+
+            // Evaluation of diffuse, retro reflection, fake subsurface and
+            // sheen.
+            if (dr::any_or<true>(diffuse_active)) {
+                Float Fo = schlick_weight(dr::abs(cos_theta_o)),
+                Fi = schlick_weight(dr::abs(cos_theta_i));
+
+                // Diffuse
+                Float f_diff = (1.0f - 0.5f * Fi) * (1.0f - 0.5f * Fo);
+
+                Float cos_theta_d = dr::dot(wh, wo);
+                Float Rr          = 2.0f * p.roughness * dr::sqr(cos_theta_d);
+
+                // Retro reflection
+                Float f_retro = Rr * (Fo + Fi + Fo * Fi * (Rr - 1.0f));
+
+                if (m_has_flatness) {
+                    /* Fake subsurface implementation based on Hanrahan Krueger
+                       Fss90 used to "flatten" retro reflection based on
+                       roughness.*/
+                    Float Fss90 = Rr / 2.0f;
+                    Float Fss =
+                            dr::lerp(1.0f, Fss90, Fo) * dr::lerp(1.0f, Fss90, Fi);
+
+                    Float f_ss = 1.25f * (Fss * (1.0f / (dr::abs(cos_theta_o) +
+                            dr::abs(cos_theta_i)) -
+                                    0.5f) +
+                                            0.5f);
+
+                    // Adding diffuse, retro and fake subsurface evaluation.
+                    dr::masked(value, diffuse_active) +=
+                            brdf * dr::abs(cos_theta_o) * p.base_color *
+                            dr::InvPi<Float> *
+                            (dr::lerp(f_diff + f_retro, f_ss, p.flatness));
                 } else {
-                    // Adding sheen evaluation without tint.
-                    dr::masked(value, sheen_active) +=
-                            sheen * (1.0f - metallic) * Fd * dr::abs(cos_theta_o);
+                    // Adding diffuse, retro evaluation. (no fake ss.)
+                    dr::masked(value, diffuse_active) +=
+                            brdf * dr::abs(cos_theta_o) * p.base_color *
+                            dr::InvPi<Float> * (f_diff + f_retro);
+                }
+                // Sheen evaluation
+                if (m_has_sheen && dr::any_or<true>(sheen_active)) {
+                    Float Fd = schlick_weight(dr::abs(cos_theta_d));
+
+                    // Tint the sheen evaluation towards the base color.
+                    if (m_has_sheen_tint) {
+                        Float sheen_tint = m_sheen_tint->eval_1(si, active);
+
+                        // Luminance evaluation
+                        Float lum = mitsuba::luminance(p.base_color, si.wavelengths);
+
+                        // Normalize color with luminance and tint the result.
+                        UnpolarizedSpectrum c_tint =
+                                dr::select(lum > 0.0f, p.base_color / lum, 1.0f);
+                        UnpolarizedSpectrum c_sheen = dr::lerp(1.0f, c_tint, sheen_tint);
+
+                        // Adding sheen evaluation with tint.
+                        dr::masked(value, sheen_active) +=
+                                p.sheen * (1.0f - p.metallic) * Fd * c_sheen *
+                                dr::abs(cos_theta_o);
+                    } else {
+                        // Adding sheen evaluation without tint.
+                        dr::masked(value, sheen_active) +=
+                                p.sheen * (1.0f - p.metallic) * Fd * dr::abs(cos_theta_o);
+                    }
                 }
             }
         }
-        return depolarizer<Spectrum>(value) & active;
-    }
-
-    Float pdf(const BSDFContext &, const SurfaceInteraction3f &si,
-              const Vector3f &wo, Mask active) const override {
-        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
-
-        Float cos_theta_i = Frame3f::cos_theta(si.wi);
-        // Ignore perfectly grazing configurations.
-        active &= dr::neq(cos_theta_i, 0.0f);
-
-        if (unlikely(dr::none_or<false>(active)))
-            return 0.0f;
-
-        // Store the weights.
-        Float anisotropic =
-                m_has_anisotropic ? m_anisotropic->eval_1(si, active) : 0.0f,
-                roughness = m_roughness->eval_1(si, active),
-                spec_trans =
-                        m_has_spec_trans ? m_spec_trans->eval_1(si, active) : 0.0f;
-        Float metallic = m_has_metallic ? m_metallic->eval_1(si, active) : 0.0f,
-        clearcoat =
-                m_has_clearcoat ? m_clearcoat->eval_1(si, active) : 0.0f;
-
-        // BRDF and BSDF major lobe weights
-        Float brdf = (1.0f - metallic) * (1.0f - spec_trans),
-        bsdf = (1.0f - metallic) * spec_trans;
-
-        // Masks if incident direction is inside (wi.z<0)
-        Mask front_side = cos_theta_i > 0.0f;
-
-        // Eta w.r.t. light path.
-        Float eta_path    = dr::select(front_side, m_eta, dr::rcp(m_eta));
-        Float cos_theta_o = Frame3f::cos_theta(wo);
-
-        Mask reflect = cos_theta_i * cos_theta_o > 0.0f;
-        Mask refract = cos_theta_i * cos_theta_o < 0.0f;
-
-        // Halfway vector calculation
-        Vector3f wh = dr::normalize(
-                si.wi + wo * dr::select(reflect, Float(1.0f), eta_path));
-
-        // Make sure that the halfway vector points outwards the object
-        wh = dr::mulsign(wh, Frame3f::cos_theta(wh));
-
-        // Main specular distribution for reflection and transmission.
-        auto [ax, ay] = calc_dist_params(anisotropic, roughness,m_has_anisotropic);
-        MicrofacetDistribution spec_distr(MicrofacetType::GGX, ax, ay);
 
-        // Dielectric Fresnel calculation
-        auto [F_spec_dielectric, cos_theta_t, eta_it, eta_ti] =
-                fresnel(dr::dot(si.wi, wh), m_eta);
-
-        // Defining the probabilities
-        Float prob_spec_reflect = dr::select(
-                front_side,
-                m_spec_srate * (1.0f - bsdf * (1.0f - F_spec_dielectric)),
-                F_spec_dielectric);
-        Float prob_spec_trans =
-                m_has_spec_trans
-                ? dr::select(front_side,
-                             m_spec_srate * bsdf * (1.0f - F_spec_dielectric),
-                             (1.0f - F_spec_dielectric))
-                             : 0.0f;
-        Float prob_clearcoat =
-                m_has_clearcoat
-                ? dr::select(front_side, 0.25f * clearcoat * m_clearcoat_srate,
-                             0.0f)
-                             : 0.0f;
-        Float prob_diffuse =
-                dr::select(front_side, brdf * m_diff_refl_srate, 0.f);
+        // Initializing the final pdf value.
+        Float pdf(0.0f);
 
-        // Normalizing the probabilities.
-        Float rcp_tot_prob = dr::rcp(prob_spec_reflect + prob_spec_trans +
-                prob_clearcoat + prob_diffuse);
-        prob_spec_reflect *= rcp_tot_prob;
-        prob_spec_trans *= rcp_tot_prob;
-        prob_clearcoat *= rcp_tot_prob;
-        prob_diffuse *= rcp_tot_prob;
+        if (has_pdf) {
+            // Defining the probabilities
+            Float prob_spec_reflect = dr::select(
+                    front_side,
+                    m_spec_srate * (1.0f - bsdf * (1.0f - F_spec_dielectric)),
+                    F_spec_dielectric);
+            Float prob_spec_trans =
+                    m_has_spec_trans
+                    ? dr::select(front_side,
+                                 m_spec_srate * bsdf * (1.0f - F_spec_dielectric),
+                                 (1.0f - F_spec_dielectric))
+                                 : 0.0f;
+            Float prob_clearcoat =
+                    m_has_clearcoat
+                    ? dr::select(front_side, 0.25f * p.clearcoat * m_clearcoat_srate,
+                                 0.0f)
+                                 : 0.0f;
+            Float prob_diffuse =
+                    dr::select(front_side, brdf * m_diff_refl_srate, 0.f);
+
+            // Normalizing the probabilities.
+            Float rcp_tot_prob = dr::rcp(prob_spec_reflect + prob_spec_trans +
+                    prob_clearcoat + prob_diffuse);
+            prob_spec_reflect *= rcp_tot_prob;
+            prob_spec_trans *= rcp_tot_prob;
+            prob_clearcoat *= rcp_tot_prob;
+            prob_diffuse *= rcp_tot_prob;
+
+            /* Calculation of dwh/dwo term. Different for reflection and
+             transmission. */
+            Float dwh_dwo_abs;
+            if (m_has_spec_trans) {
+                Float dot_wi_h = dr::dot(si.wi, wh);
+                Float dot_wo_h = dr::dot(wo, wh);
+                dwh_dwo_abs    = dr::abs(
+                        dr::select(reflect, dr::rcp(4.0f * dot_wo_h),
+                                   (dr::sqr(eta_path) * dot_wo_h) /
+                                   dr::sqr(dot_wi_h + eta_path * dot_wo_h)));
+            } else {
+                dwh_dwo_abs = dr::abs(dr::rcp(4.0f * dr::dot(wo, wh)));
+            }
 
-        /* Calculation of dwh/dwo term. Different for reflection and
-         transmission. */
-        Float dwh_dwo_abs;
-        if (m_has_spec_trans) {
-            Float dot_wi_h = dr::dot(si.wi, wh);
-            Float dot_wo_h = dr::dot(wo, wh);
-            dwh_dwo_abs    = dr::abs(
-                    dr::select(reflect, dr::rcp(4.0f * dot_wo_h),
-                               (dr::sqr(eta_path) * dot_wo_h) /
-                               dr::sqr(dot_wi_h + eta_path * dot_wo_h)));
-        } else {
-            dwh_dwo_abs = dr::abs(dr::rcp(4.0f * dr::dot(wo, wh)));
-        }
+            // Visible normal density, reusing D and G1 from above
+            Float spec_pdf = spec_dist.pdf(dr::mulsign(si.wi, cos_theta_i), wh,
+                                           D, smith_g1_wi);
 
-        // Initializing the final pdf value.
-        Float pdf(0.0f);
+            // Macro-micro surface compatibility mask for reflection.
+            Mask mfacet_reflect_macmic = reflection_compatibilty && reflect;
 
-        // Macro-micro surface compatibility mask for reflection.
-        Mask mfacet_reflect_macmic =
-                mac_mic_compatibility(wh, si.wi, wo, cos_theta_i, true) && reflect;
-
-        // Adding main specular reflection pdf
-        dr::masked(pdf, mfacet_reflect_macmic) +=
-                prob_spec_reflect *
-                spec_distr.pdf(dr::mulsign(si.wi, cos_theta_i), wh) * dwh_dwo_abs;
-        // Adding cosine hemisphere reflection pdf
-        dr::masked(pdf, reflect) +=
-                prob_diffuse * warp::square_to_cosine_hemisphere_pdf(wo);
-        // Main specular transmission
-        if (m_has_spec_trans) {
-            // Macro-micro surface mask for transmission.
-            Mask mfacet_trans_macmic =
-                    mac_mic_compatibility(wh, si.wi, wo, cos_theta_i, false) &&
-                    refract;
-
-            // Adding main specular transmission pdf
-            dr::masked(pdf, mfacet_trans_macmic) +=
-                    prob_spec_trans *
-                    spec_distr.pdf(dr::mulsign(si.wi, cos_theta_i), wh) *
-                    dwh_dwo_abs;
-        }
-        // Adding the secondary specular reflection pdf.(clearcoat)
-        if (m_has_clearcoat) {
-            Float clearcoat_gloss = m_clearcoat_gloss->eval_1(si, active);
-            GTR1 cc_dist(dr::lerp(0.1f, 0.001f, clearcoat_gloss));
+            // Adding main specular reflection pdf
             dr::masked(pdf, mfacet_reflect_macmic) +=
-                    prob_clearcoat * cc_dist.pdf(wh) * dwh_dwo_abs;
+                    prob_spec_reflect * spec_pdf * dwh_dwo_abs;
+            // Adding cosine hemisphere reflection pdf
+            dr::masked(pdf, reflect) +=
+                    prob_diffuse * warp::square_to_cosine_hemisphere_pdf(wo);
+            // Main specular transmission
+            if (m_has_spec_trans) {
+                // Macro-micro surface mask for transmission.
+                Mask mfacet_trans_macmic = refraction_compatibilty && refract;
+
+                // Adding main specular transmission pdf
+                dr::masked(pdf, mfacet_trans_macmic) +=
+                        prob_spec_trans * spec_pdf * dwh_dwo_abs;
+            }
+            // Adding the secondary specular reflection pdf.(clearcoat)
+            if (m_has_clearcoat) {
+                GTR1 cc_dist(dr::lerp(0.1f, 0.001f, p.clearcoat_gloss));
+                dr::masked(pdf, mfacet_reflect_macmic) +=
+                        prob_clearcoat * cc_dist.pdf(wh) * dwh_dwo_abs;
+            }
         }
-        return pdf;
-    }
 
-    Spectrum eval_diffuse_reflectance(const SurfaceInteraction3f &si,
-                                      Mask active) const override {
-        return m_base_color->eval(si, active);
+        return { value, pdf };
     }
 
-    std::string to_string() const override {
-        std::ostringstream oss;
-        oss << "Principled BSDF :" << std::endl
-            << "base_color: " << m_base_color << "," << std::endl
-            << "spec_trans: " << m_spec_trans << "," << std::endl
-            << "anisotropic: " << m_anisotropic << "," << std::endl
-            << "roughness: " << m_roughness << "," << std::endl
-            << "sheen: " << m_sheen << "," << std::endl
-            << "sheen_tint: " << m_sheen_tint << "," << std::endl
-            << "flatness: " << m_flatness << "," << std::endl;
-        if (m_eta_specular)
-            oss << "eta: " << m_eta << "," << std::endl;
-        else
-            oss << "specular: " << m_specular << "," << std::endl;
-        oss << "clearcoat: " << m_clearcoat << "," << std::endl
-            << "clearcoat_gloss: " << m_clearcoat_gloss << "," << std::endl
-            << "metallic: " << m_metallic << "," << std::endl
-            << "spec_tint: " << m_spec_tint << "," << std::endl;
-
-        return oss.str();
-    }
-    MI_DECLARE_CLASS()
-private:
     /// Parameters
     ref<Texture> m_base_color;
     ref<Texture> m_roughness;
@@ -6,6 +6,8 @@
 #include <mitsuba/render/microfacet.h>
 #include <mitsuba/render/texture.h>
 
+#define MI_ALBEDO_TABLE_RES 32
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**!
@@ -56,6 +58,13 @@ Rough conductor material (:monosp:`roughconductor`)
      focuses computation on the visible parts of the microfacet normal distribution, considerably
      reducing variance in some cases. (Default: |true|, i.e. use visible normal sampling)
 
+ * - energy_compensation
+   - |bool|
+   - Compensate the energy that the microfacet model loses by ignoring
+     multiple scattering between the microfacets, which otherwise darkens
+     very rough conductors. The required albedo table is computed once per
+     distribution and shared by all instances. (Default: |false|)
+
 This plugin implements a realistic microfacet scattering model for rendering
 rough conducting materials, such as metals.
 
@@ -201,6 +210,14 @@ public:
         if (props.has_property("specular_reflectance"))
             m_specular_reflectance = props.texture<Texture>("specular_reflectance", 1.f);
 
+        m_energy_compensation = props.get<bool>("energy_compensation", false);
+        if (m_energy_compensation) {
+            auto albedo = microfacet_albedo_table<ScalarFloat>(m_type, MI_ALBEDO_TABLE_RES);
+            size_t shape[3] = { MI_ALBEDO_TABLE_RES, MI_ALBEDO_TABLE_RES, 1 };
+            m_albedo = Texture2f(TensorXf(albedo->data(), 3, shape), true, false,
+                                 dr::FilterMode::Linear, dr::WrapMode::Clamp);
+        }
+
         m_flags = BSDFFlags::GlossyReflection | BSDFFlags::FrontSide;
         if (m_alpha_u != m_alpha_v)
             m_flags = m_flags | BSDFFlags::Anisotropic;
@@ -271,36 +288,15 @@ public:
         dr::Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
                                            m_k->eval(si, active));
 
-        Spectrum F;
-        if constexpr (is_polarized_v<Spectrum>) {
-            /* Due to the coordinate system rotations for polarization-aware
-               pBSDFs below we need to know the propagation direction of light.
-               In the following, light arrives along `-wo_hat` and leaves along
-               `+wi_hat`. */
-            Vector3f wo_hat = ctx.mode == TransportMode::Radiance ? bs.wo : si.wi,
-                     wi_hat = ctx.mode == TransportMode::Radiance ? si.wi : bs.wo;
-
-            // Mueller matrix for specular reflection.
-            F = mueller::specular_reflection(UnpolarizedSpectrum(dot(wo_hat, m)), eta_c);
-
-            /* The Stokes reference frame vector of this matrix lies perpendicular
-               to the plane of reflection. */
-            Vector3f s_axis_in  = dr::normalize(dr::cross(m, -wo_hat)),
-                     s_axis_out = dr::normalize(dr::cross(m, wi_hat));
-
-            /* Rotate in/out reference vector of F s.t. it aligns with the implicit
-               Stokes bases of -wo_hat & wi_hat. */
-            F = mueller::rotate_mueller_basis(F,
-                                              -wo_hat, s_axis_in, mueller::stokes_basis(-wo_hat),
-                                               wi_hat, s_axis_out, mueller::stokes_basis(wi_hat));
-        } else {
-            F = fresnel_conductor(UnpolarizedSpectrum(dr::dot(si.wi, m)), eta_c);
-        }
+        Spectrum F = fresnel_term(ctx, si, bs.wo, m, eta_c);
 
         /* If requested, include the specular reflectance component */
         if (m_specular_reflectance)
             weight *= m_specular_reflectance->eval(si, active);
 
+        if (m_energy_compensation)
+            weight *= energy_compensation(si, distr, eta_c, active);
+
         return { bs, (F * weight) & active };
     }
 
@@ -341,36 +337,15 @@ public:
         dr::Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
                                            m_k->eval(si, active));
 
-        Spectrum F;
-        if constexpr (is_polarized_v<Spectrum>) {
-            /* Due to the coordinate system rotations for polarization-aware
-               pBSDFs below we need to know the propagation direction of light.
-               In the following, light arrives along `-wo_hat` and leaves along
-               `+wi_hat`. */
-            Vector3f wo_hat = ctx.mode == TransportMode::Radiance ? wo : si.wi,
-                     wi_hat = ctx.mode == TransportMode::Radiance ? si.wi : wo;
-
-            // Mueller matrix for specular reflection.
-            F = mueller::specular_reflection(UnpolarizedSpectrum(dot(wo_hat, H)), eta_c);
-
-            /* The Stokes reference frame vector of this matrix lies perpendicular
-               to the plane of reflection. */
-            Vector3f s_axis_in  = dr::normalize(dr::cross(H, -wo_hat)),
-                     s_axis_out = dr::normalize(dr::cross(H, wi_hat));
-
-            /* Rotate in/out reference vector of F s.t. it aligns with the implicit
-               Stokes bases of -wo_hat & wi_hat. */
-            F = mueller::rotate_mueller_basis(F,
-                                              -wo_hat, s_axis_in, mueller::stokes_basis(-wo_hat),
-                                               wi_hat, s_axis_out, mueller::stokes_basis(wi_hat));
-        } else {
-            F = fresnel_conductor(UnpolarizedSpectrum(dr::dot(si.wi, H)), eta_c);
-        }
+        Spectrum F = fresnel_term(ctx, si, wo, H, eta_c);
 
         /* If requested, include the specular reflectance component */
         if (m_specular_reflectance)
             result *= m_specular_reflectance->eval(si, active);
 
+        if (m_energy_compensation)
+            result *= energy_compensation(si, distr, eta_c, active);
+
         return (F * result) & active;
     }
 
@@ -456,7 +431,118 @@ public:
         dr::Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
                                            m_k->eval(si, active));
 
-        Spectrum F;
+        Spectrum F = fresnel_term(ctx, si, wo, H, eta_c);
+
+        // If requested, include the specular reflectance component
+        if (m_specular_reflectance)
+            value *= m_specular_reflectance->eval(si, active);
+
+        if (m_energy_compensation)
+            value *= energy_compensation(si, distr, eta_c, active);
+
+        Float pdf;
+        if (likely(m_sample_visible))
+            pdf = D * smith_g1_wi / (4.f * cos_theta_i);
+        else
+            pdf = distr.pdf(si.wi, H, D, smith_g1_wi) / (4.f * dr::dot(wo, H));
+
+        return { F * value & active, dr::select(active, pdf, 0.f) };
+    }
+
+    std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>
+    eval_pdf_sample(const BSDFContext &ctx,
+                    const SurfaceInteraction3f &si,
+                    const Vector3f &wo,
+                    Float /* sample1 */,
+                    const Point2f &sample2,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        BSDFSample3f bs = dr::zeros<BSDFSample3f>();
+        Float cos_theta_i = Frame3f::cos_theta(si.wi),
+              cos_theta_o = Frame3f::cos_theta(wo);
+        active &= cos_theta_i > 0.f;
+
+        if (unlikely(!ctx.is_enabled(BSDFFlags::GlossyReflection) || dr::none_or<false>(active)))
+            return { 0.f, 0.f, bs, 0.f };
+
+        /* The textures only need to be evaluated once for both the
+           evaluation and the sampling step */
+        MicrofacetDistribution distr(m_type,
+                                     m_alpha_u->eval_1(si, active),
+                                     m_alpha_v->eval_1(si, active),
+                                     m_sample_visible);
+
+        dr::Complex<UnpolarizedSpectrum> eta_c(m_eta->eval(si, active),
+                                           m_k->eval(si, active));
+
+        UnpolarizedSpectrum scale(1.f);
+        if (m_specular_reflectance)
+            scale *= m_specular_reflectance->eval(si, active);
+
+        if (m_energy_compensation)
+            scale *= energy_compensation(si, distr, eta_c, active);
+
+        // ---------------------- Evaluate the direction wo --------------------
+
+        Vector3f H = dr::normalize(wo + si.wi);
+
+        Mask active_e = active && cos_theta_o > 0.f &&
+                        dr::dot(si.wi, H) > 0.f && dr::dot(wo, H) > 0.f;
+
+        Float D = distr.eval(H);
+        active_e &= dr::neq(D, 0.f);
+
+        Float smith_g1_wi = distr.smith_g1(si.wi, H),
+              G = smith_g1_wi * distr.smith_g1(wo, H);
+
+        UnpolarizedSpectrum value = D * G / (4.f * cos_theta_i) * scale;
+
+        Float pdf;
+        if (likely(m_sample_visible))
+            pdf = D * smith_g1_wi / (4.f * cos_theta_i);
+        else
+            pdf = distr.pdf(si.wi, H, D, smith_g1_wi) / (4.f * dr::dot(wo, H));
+
+        Spectrum e_val = (fresnel_term(ctx, si, wo, H, eta_c) * value) & active_e;
+
+        // ------------------------ Sample a new direction ---------------------
+
+        Normal3f m;
+        std::tie(m, bs.pdf) = distr.sample(si.wi, sample2);
+
+        bs.wo = reflect(si.wi, m);
+        bs.eta = 1.f;
+        bs.sampled_component = 0;
+        bs.sampled_type = +BSDFFlags::GlossyReflection;
+
+        Mask active_s = active && dr::neq(bs.pdf, 0.f) && Frame3f::cos_theta(bs.wo) > 0.f;
+
+        UnpolarizedSpectrum weight;
+        if (likely(m_sample_visible))
+            weight = distr.smith_g1(bs.wo, m);
+        else
+            weight = distr.G(si.wi, bs.wo, m) * dr::dot(si.wi, m) /
+                     (cos_theta_i * Frame3f::cos_theta(m));
+
+        bs.pdf /= 4.f * dr::dot(bs.wo, m);
+
+        Spectrum bsdf_weight =
+            (fresnel_term(ctx, si, bs.wo, m, eta_c) * (weight * scale)) & active_s;
+
+        return { e_val, dr::select(active_e, pdf, 0.f), bs, bsdf_weight };
+    }
+
+    /**
+     * \brief Fresnel reflectance of the microfacet \c m for the directions
+     * <tt>si.wi</tt> and \c wo
+     *
+     * In polarized variants, this is a Mueller matrix that is expressed in
+     * the implicit Stokes bases of the propagation directions.
+     */
+    Spectrum fresnel_term(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                          const Vector3f &wo, const Vector3f &m,
+                          const dr::Complex<UnpolarizedSpectrum> &eta_c) const {
         if constexpr (is_polarized_v<Spectrum>) {
             /* Due to the coordinate system rotations for polarization-aware
                pBSDFs below we need to know the propagation direction of light.
@@ -466,33 +552,54 @@ public:
                      wi_hat = ctx.mode == TransportMode::Radiance ? si.wi : wo;
 
             // Mueller matrix for specular reflection.
-            F = mueller::specular_reflection(UnpolarizedSpectrum(dot(wo_hat, H)), eta_c);
+            Spectrum F = mueller::specular_reflection(UnpolarizedSpectrum(dot(wo_hat, m)), eta_c);
 
             /* The Stokes reference frame vector of this matrix lies perpendicular
                to the plane of reflection. */
-            Vector3f s_axis_in  = dr::normalize(dr::cross(H, -wo_hat)),
-                     s_axis_out = dr::normalize(dr::cross(H, wi_hat));
+            Vector3f s_axis_in  = dr::normalize(dr::cross(m, -wo_hat)),
+                     s_axis_out = dr::normalize(dr::cross(m, wi_hat));
 
             /* Rotate in/out reference vector of F s.t. it aligns with the implicit
                Stokes bases of -wo_hat & wi_hat. */
-            F = mueller::rotate_mueller_basis(F,
-                                              -wo_hat, s_axis_in, mueller::stokes_basis(-wo_hat),
-                                               wi_hat, s_axis_out, mueller::stokes_basis(wi_hat));
+            return mueller::rotate_mueller_basis(F,
+                                                 -wo_hat, s_axis_in, mueller::stokes_basis(-wo_hat),
+                                                  wi_hat, s_axis_out, mueller::stokes_basis(wi_hat));
         } else {
-            F = fresnel_conductor(UnpolarizedSpectrum(dr::dot(si.wi, H)), eta_c);
+            return fresnel_conductor(UnpolarizedSpectrum(dr::dot(si.wi, m)), eta_c);
         }
+    }
 
-        // If requested, include the specular reflectance component
+    /**
+     * \brief Scale factor that accounts for the energy lost to multiple
+     * scattering between the microfacets
+     *
+     * This follows the approximation by Turquin, which scales the single
+     * scattering lobe by <tt>1 + F0 (1 - E) / E</tt>, where \c E is the
+     * directional albedo of the distribution and \c F0 the reflectance at
+     * normal incidence. Because the factor only depends on the incident
+     * direction, sampling remains unchanged.
+     */
+    UnpolarizedSpectrum energy_compensation(const SurfaceInteraction3f &si,
+                                            const MicrofacetDistribution &distr,
+                                            const dr::Complex<UnpolarizedSpectrum> &eta_c,
+                                            Mask active) const {
+        Float alpha = dr::clamp(dr::sqrt(distr.alpha_u() * distr.alpha_v()), 0.f, 1.f),
+              mu    = dr::clamp(Frame3f::cos_theta(si.wi), 0.f, 1.f);
+
+        // Map the table nodes onto the texel centers
+        constexpr ScalarFloat scale = (MI_ALBEDO_TABLE_RES - 1.f) / MI_ALBEDO_TABLE_RES,
+                              offset = .5f / MI_ALBEDO_TABLE_RES;
+        Point2f uv = dr::fmadd(Point2f(mu, alpha), scale, offset);
+
+        Float albedo;
+        m_albedo.eval(uv, &albedo, active);
+        albedo = dr::maximum(albedo, 1e-3f);
+
+        UnpolarizedSpectrum f0 = fresnel_conductor(UnpolarizedSpectrum(1.f), eta_c);
         if (m_specular_reflectance)
-            value *= m_specular_reflectance->eval(si, active);
+            f0 *= m_specular_reflectance->eval(si, active);
 
-        Float pdf;
-        if (likely(m_sample_visible))
-            pdf = D * smith_g1_wi / (4.f * cos_theta_i);
-        else
-            pdf = distr.pdf(si.wi, H) / (4.f * dr::dot(wo, H));
-
-        return { F * value & active, dr::select(active, pdf, 0.f) };
+        return 1.f + f0 * (1.f - albedo) / albedo;
     }
 
     std::string to_string() const override {
@@ -504,7 +611,8 @@ public:
             << "  alpha_v = " << string::indent(m_alpha_v) << "," << std::endl;
         if (m_specular_reflectance)
            oss << "  specular_reflectance = " << string::indent(m_specular_reflectance) << "," << std::endl;
-        oss << "  eta = " << string::indent(m_eta) << "," << std::endl
+        oss << "  energy_compensation = " << m_energy_compensation << "," << std::endl
+            << "  eta = " << string::indent(m_eta) << "," << std::endl
             << "  k = " << string::indent(m_k) << std::endl
             << "]";
         return oss.str();
@@ -524,6 +632,10 @@ private:
     ref<Texture> m_k;
     /// Specular reflectance component
     ref<Texture> m_specular_reflectance;
+    /// Compensate the energy lost to multiple scattering?
+    bool m_energy_compensation;
+    /// Directional albedo of the distribution as a function of (cos_theta, alpha)
+    Texture2f m_albedo;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(RoughConductor, BSDF)
@@ -549,7 +549,8 @@ public:
         Float F = std::get<0>(fresnel(dot_wi_m, m_eta));
 
         // Smith's shadow-masking function
-        Float G = distr.G(si.wi, wo, m);
+        Float smith_g1_wi = distr.smith_g1(si.wi, m),
+              G = smith_g1_wi * distr.smith_g1(wo, m);
 
         UnpolarizedSpectrum result(0.f);
 
@@ -582,14 +583,19 @@ public:
             result[eval_t] = value;
         }
 
-        /* Trick by Walter et al.: slightly scale the roughness values to
-           reduce importance sampling weights. Not needed for the
-           Heitz and D'Eon sampling technique. */
-        if (unlikely(!m_sample_visible))
+        /* Evaluate the microfacet model sampling density function. Unless
+           the roughness was rescaled for sampling, reuse D and G1(wi) from
+           above (G1 is invariant to flipping wi). */
+        Float pdf;
+        if (likely(m_sample_visible)) {
+            pdf = distr.pdf(dr::mulsign(si.wi, cos_theta_i), m, D, smith_g1_wi);
+        } else {
+            /* Trick by Walter et al.: slightly scale the roughness values to
+               reduce importance sampling weights. Not needed for the
+               Heitz and D'Eon sampling technique. */
             distr.scale_alpha(1.2f - .2f * dr::sqrt(dr::abs(cos_theta_i)));
-
-        // Evaluate the microfacet model sampling density function
-        Float pdf = distr.pdf(dr::mulsign(si.wi, cos_theta_i), m);
+            pdf = distr.pdf(dr::mulsign(si.wi, cos_theta_i), m);
+        }
 
         if (likely(has_transmission && has_reflection))
             pdf *= dr::select(reflect, F, 1.f - F);
@@ -201,6 +201,9 @@ public:
         m_components.push_back(BSDFFlags::GlossyReflection | BSDFFlags::FrontSide);
         m_components.push_back(BSDFFlags::DiffuseReflection | BSDFFlags::FrontSide);
         m_flags =  m_components[0] | m_components[1];
+        if (m_diffuse_reflectance->needs_differentials() ||
+            (m_specular_reflectance && m_specular_reflectance->needs_differentials()))
+            m_flags = m_flags | BSDFFlags::NeedsDifferentials;
         dr::set_attr(this, "flags", m_flags);
 
         parameters_changed();
@@ -228,27 +231,19 @@ public:
 
         m_specular_sampling_weight = s_mean / (d_mean + s_mean);
 
-        // Precompute rough reflectance (vectorized)
+        /* Precompute rough reflectance (vectorized). The tables are shared by
+           all instances with the same distribution, roughness and IOR */
         if (keys.empty() || string::contains(keys, "alpha") || string::contains(keys, "eta")) {
-            using FloatX = DynamicBuffer<ScalarFloat>;
-            using Vector3fX = Vector<FloatX, 3>;
             ScalarFloat eta = dr::slice(m_eta), alpha = dr::slice(m_alpha);
 
-            using FloatP = dr::Packet<dr::scalar_t<Float>>;
-            mitsuba::MicrofacetDistribution<FloatP, Spectrum> distr(m_type, alpha);
-            FloatX mu = dr::maximum(1e-6f, dr::linspace<FloatX>(0, 1, MI_ROUGH_TRANSMITTANCE_RES));
-            FloatX zero = dr::zeros<FloatX>(MI_ROUGH_TRANSMITTANCE_RES);
-
-            Vector3fX wi = Vector3fX(dr::sqrt(1 - mu * mu), zero, mu);
-
-            auto external_transmittance = eval_transmittance(distr, wi, eta);
+            auto tables = microfacet_coating_tables<ScalarFloat>(
+                m_type, alpha, eta, MI_ROUGH_TRANSMITTANCE_RES);
 
             m_external_transmittance = dr::load<DynamicBuffer<Float>>(
-                external_transmittance.data(),
-                dr::width(external_transmittance));
+                tables->external_transmittance.data(),
+                tables->external_transmittance.size());
 
-            m_internal_reflectance =
-                dr::mean(eval_reflectance(distr, wi, 1.f / eta) * wi.z()) * 2.f;
+            m_internal_reflectance = tables->internal_reflectance;
         }
         dr::make_opaque(m_eta, m_inv_eta_2, m_alpha, m_specular_sampling_weight,
                         m_internal_reflectance);
@@ -272,18 +267,10 @@ public:
         if (unlikely((!has_specular && !has_diffuse) || dr::none_or<false>(active)))
             return { bs, result };
 
-        Float t_i = lerp_gather(m_external_transmittance, cos_theta_i,
-                                MI_ROUGH_TRANSMITTANCE_RES, active);
+        auto [t_i, prob_specular, specular, diffuse] =
+            lobe_terms(si, has_specular, has_diffuse, active);
 
-        // Determine which component should be sampled
-        Float prob_specular = (1.f - t_i) * m_specular_sampling_weight,
-              prob_diffuse  = t_i * (1.f - m_specular_sampling_weight);
-
-        if (unlikely(has_specular != has_diffuse))
-            prob_specular = has_specular ? 1.f : 0.f;
-        else
-            prob_specular = prob_specular / (prob_specular + prob_diffuse);
-        prob_diffuse = 1.f - prob_specular;
+        MicrofacetDistribution distr(m_type, m_alpha, m_sample_visible);
 
         Mask sample_specular = active && (sample1 < prob_specular),
              sample_diffuse = active && !sample_specular;
@@ -291,7 +278,6 @@ public:
         bs.eta = 1.f;
 
         if (dr::any_or<true>(sample_specular)) {
-            MicrofacetDistribution distr(m_type, m_alpha, m_sample_visible);
             Normal3f m = std::get<0>(distr.sample(si.wi, sample2));
 
             dr::masked(bs.wo, sample_specular) = reflect(si.wi, m);
@@ -305,11 +291,14 @@ public:
             dr::masked(bs.sampled_type, sample_diffuse) = +BSDFFlags::DiffuseReflection;
         }
 
-        bs.pdf = pdf(ctx, si, bs.wo, active);
-        active &= bs.pdf > 0.f;
-        result = eval(ctx, si, bs.wo, active);
+        auto [value, pdf] = eval_pdf_lobes(si, bs.wo, distr, t_i, prob_specular,
+                                           specular, diffuse, has_specular,
+                                           has_diffuse, active);
+
+        bs.pdf = pdf;
+        active &= Frame3f::cos_theta(bs.wo) > 0.f && bs.pdf > 0.f;
 
-        return { bs, (depolarizer<Spectrum>(result) / bs.pdf) & active };
+        return { bs, (depolarizer<Spectrum>(value) / bs.pdf) & active };
     }
 
     Spectrum eval(const BSDFContext &ctx, const SurfaceInteraction3f &si,
@@ -378,6 +367,96 @@ public:
         return dr::lerp(v0, v1, x - Float(index));
     }
 
+    /**
+     * \brief Compute the direction-independent terms of the model
+     *
+     * Returns the external transmittance of <tt>si.wi</tt>, the probability
+     * of sampling the specular lobe, as well as the specular and the diffuse
+     * reflectance (which accounts for internal reflections).
+     */
+    std::tuple<Float, Float, UnpolarizedSpectrum, UnpolarizedSpectrum>
+    lobe_terms(const SurfaceInteraction3f &si, bool has_specular,
+               bool has_diffuse, Mask active) const {
+        Float t_i = lerp_gather(m_external_transmittance, Frame3f::cos_theta(si.wi),
+                                MI_ROUGH_TRANSMITTANCE_RES, active);
+
+        // Determine which component should be sampled
+        Float prob_specular = (1.f - t_i) * m_specular_sampling_weight,
+              prob_diffuse  = t_i * (1.f - m_specular_sampling_weight);
+
+        if (unlikely(has_specular != has_diffuse))
+            prob_specular = has_specular ? 1.f : 0.f;
+        else
+            prob_specular = prob_specular / (prob_specular + prob_diffuse);
+
+        UnpolarizedSpectrum specular(1.f), diffuse(0.f);
+        if (has_specular && m_specular_reflectance)
+            specular = m_specular_reflectance->eval(si, active);
+
+        if (has_diffuse) {
+            diffuse = m_diffuse_reflectance->eval(si, active);
+            diffuse /= 1.f - (m_nonlinear ? (diffuse * m_internal_reflectance)
+                                          : UnpolarizedSpectrum(m_internal_reflectance));
+        }
+
+        return { t_i, prob_specular, specular, diffuse };
+    }
+
+    /**
+     * \brief Evaluate the model and its sampling density for the direction
+     * \c wo given the terms computed by \ref lobe_terms()
+     *
+     * The returned value is not masked by the validity of \c wo.
+     */
+    std::pair<UnpolarizedSpectrum, Float>
+    eval_pdf_lobes(const SurfaceInteraction3f &si, const Vector3f &wo,
+                   const MicrofacetDistribution &distr, const Float &t_i,
+                   const Float &prob_specular, const UnpolarizedSpectrum &specular,
+                   const UnpolarizedSpectrum &diffuse, bool has_specular,
+                   bool has_diffuse, Mask active) const {
+        Float cos_theta_i = Frame3f::cos_theta(si.wi),
+              cos_theta_o = Frame3f::cos_theta(wo);
+
+        // Calculate the reflection half-vector
+        Vector3f H = dr::normalize(wo + si.wi);
+
+        // Evaluate the microfacet normal distribution
+        Float D = distr.eval(H);
+
+        // Evaluate shadow/masking term for incoming direction
+        Float smith_g1_wi = distr.smith_g1(si.wi, H);
+
+        Float pdf = 0.f;
+        if (m_sample_visible)
+            pdf = D * smith_g1_wi / (4.f * cos_theta_i);
+        else
+            pdf = distr.pdf(si.wi, H, D, smith_g1_wi) / (4.f * dr::dot(wo, H));
+        pdf *= prob_specular;
+
+        pdf += (1.f - prob_specular) * warp::square_to_cosine_hemisphere_pdf(wo);
+
+        UnpolarizedSpectrum value(0.f);
+        if (has_specular) {
+            // Fresnel term
+            Float F = std::get<0>(fresnel(dr::dot(si.wi, H), Float(m_eta)));
+
+            // Smith's shadow-masking function
+            Float G = distr.smith_g1(wo, H) * smith_g1_wi;
+
+            // Calculate the specular reflection component
+            value = specular * (F * D * G / (4.f * cos_theta_i));
+        }
+
+        if (has_diffuse) {
+            Float t_o = lerp_gather(m_external_transmittance, cos_theta_o,
+                                    MI_ROUGH_TRANSMITTANCE_RES, active);
+
+            value += diffuse * (dr::InvPi<Float> * m_inv_eta_2 * cos_theta_o * t_i * t_o);
+        }
+
+        return { value, pdf };
+    }
+
     Float pdf(const BSDFContext &ctx, const SurfaceInteraction3f &si,
               const Vector3f &wo, Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
@@ -439,66 +518,81 @@ public:
         if (unlikely((!has_specular && !has_diffuse) || dr::none_or<false>(active)))
             return { 0.f, 0.f };
 
-        Float t_i = lerp_gather(m_external_transmittance, cos_theta_i,
-                                MI_ROUGH_TRANSMITTANCE_RES, active);
+        auto [t_i, prob_specular, specular, diffuse] =
+            lobe_terms(si, has_specular, has_diffuse, active);
 
-        // Determine which component should be sampled
-        Float prob_specular = (1.f - t_i) * m_specular_sampling_weight,
-              prob_diffuse  = t_i * (1.f - m_specular_sampling_weight);
+        MicrofacetDistribution distr(m_type, m_alpha, m_sample_visible);
 
-        if (unlikely(has_specular != has_diffuse))
-            prob_specular = has_specular ? 1.f : 0.f;
-        else
-            prob_specular = prob_specular / (prob_specular + prob_diffuse);
-        prob_diffuse = 1.f - prob_specular;
+        auto [value, pdf] = eval_pdf_lobes(si, wo, distr, t_i, prob_specular,
+                                           specular, diffuse, has_specular,
+                                           has_diffuse, active);
 
-        // Calculate the reflection half-vector
-        Vector3f H = dr::normalize(wo + si.wi);
+        return { depolarizer<Spectrum>(value) & active, pdf };
+    }
+
+    std::tuple<Spectrum, Float, BSDFSample3f, Spectrum>
+    eval_pdf_sample(const BSDFContext &ctx,
+                    const SurfaceInteraction3f &si,
+                    const Vector3f &wo,
+                    Float sample1,
+                    const Point2f &sample2,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        bool has_specular = ctx.is_enabled(BSDFFlags::GlossyReflection, 0),
+             has_diffuse  = ctx.is_enabled(BSDFFlags::DiffuseReflection, 1);
+
+        Float cos_theta_i = Frame3f::cos_theta(si.wi);
+        active &= cos_theta_i > 0.f;
+
+        BSDFSample3f bs = dr::zeros<BSDFSample3f>();
+        if (unlikely((!has_specular && !has_diffuse) || dr::none_or<false>(active)))
+            return { 0.f, 0.f, bs, 0.f };
+
+        // The textures and tables are shared by the evaluation and sampling step
+        auto [t_i, prob_specular, specular, diffuse] =
+            lobe_terms(si, has_specular, has_diffuse, active);
 
         MicrofacetDistribution distr(m_type, m_alpha, m_sample_visible);
 
-        // Evaluate the microfacet normal distribution
-        Float D = distr.eval(H);
+        // ---------------------- Evaluate the direction wo --------------------
 
-        // Evaluate shadow/masking term for incoming direction
-        Float smith_g1_wi = distr.smith_g1(si.wi, H);
+        Mask active_e = active && Frame3f::cos_theta(wo) > 0.f;
 
-        Float pdf = 0.f;
-        if (m_sample_visible)
-            pdf = D * smith_g1_wi / (4.f * cos_theta_i);
-        else
-            pdf = distr.pdf(si.wi, H) / (4.f * dr::dot(wo, H));
-        pdf *= prob_specular;
+        auto [e_value, e_pdf] = eval_pdf_lobes(si, wo, distr, t_i, prob_specular,
+                                               specular, diffuse, has_specular,
+                                               has_diffuse, active_e);
 
-        pdf += prob_diffuse * warp::square_to_cosine_hemisphere_pdf(wo);
+        // ------------------------ Sample a new direction ---------------------
 
-        UnpolarizedSpectrum value(0.f);
-        if (has_specular) {
-            // Fresnel term
-            Float F = std::get<0>(fresnel(dr::dot(si.wi, H), Float(m_eta)));
+        Mask sample_specular = active && (sample1 < prob_specular),
+             sample_diffuse = active && !sample_specular;
 
-            // Smith's shadow-masking function
-            Float G = distr.smith_g1(wo, H) * smith_g1_wi;
+        bs.eta = 1.f;
 
-            // Calculate the specular reflection component
-            value = F * D * G / (4.f * cos_theta_i);
+        if (dr::any_or<true>(sample_specular)) {
+            Normal3f m = std::get<0>(distr.sample(si.wi, sample2));
 
-            if (m_specular_reflectance)
-                value *= m_specular_reflectance->eval(si, active);
+            dr::masked(bs.wo, sample_specular) = reflect(si.wi, m);
+            dr::masked(bs.sampled_component, sample_specular) = 0;
+            dr::masked(bs.sampled_type, sample_specular) = +BSDFFlags::GlossyReflection;
         }
 
-        if (has_diffuse) {
-            Float t_o = lerp_gather(m_external_transmittance, cos_theta_o,
-                                    MI_ROUGH_TRANSMITTANCE_RES, active);
+        if (dr::any_or<true>(sample_diffuse)) {
+            dr::masked(bs.wo, sample_diffuse) = warp::square_to_cosine_hemisphere(sample2);
+            dr::masked(bs.sampled_component, sample_diffuse) = 1;
+            dr::masked(bs.sampled_type, sample_diffuse) = +BSDFFlags::DiffuseReflection;
+        }
 
-            UnpolarizedSpectrum diff = m_diffuse_reflectance->eval(si, active);
-            diff /= 1.f - (m_nonlinear ? (diff * m_internal_reflectance)
-                                       : UnpolarizedSpectrum(m_internal_reflectance));
+        auto [s_value, s_pdf] = eval_pdf_lobes(si, bs.wo, distr, t_i, prob_specular,
+                                               specular, diffuse, has_specular,
+                                               has_diffuse, active);
 
-            value += diff * (dr::InvPi<Float> * m_inv_eta_2 * cos_theta_o * t_i * t_o);
-        }
+        bs.pdf = s_pdf;
+        Mask active_s = active && Frame3f::cos_theta(bs.wo) > 0.f && bs.pdf > 0.f;
 
-        return { depolarizer<Spectrum>(value) & active, pdf };
+        return { depolarizer<Spectrum>(e_value) & active_e, e_pdf, bs,
+                 (depolarizer<Spectrum>(s_value) / bs.pdf) & active_s };
     }
 
     Spectrum eval_diffuse_reflectance(const SurfaceInteraction3f &si,
@@ -0,0 +1,228 @@
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/fresnel.h>
+#include <mitsuba/render/texture.h>
+#include <mitsuba/render/ior.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _bsdf-subsurface:
+
+Subsurface scattering material (:monosp:`subsurface`)
+-----------------------------------------------------
+
+.. pluginparameters::
+
+ * - int_ior
+   - |float| or |string|
+   - Interior index of refraction specified numerically or using a known material name. (Default: 1.33)
+
+ * - ext_ior
+   - |float| or |string|
+   - Exterior index of refraction specified numerically or using a known material name.  (Default: air / 1.000277)
+
+ * - albedo
+   - |spectrum| or |texture|
+   - Total diffuse reflectance of the material due to subsurface scattering, i.e. the color
+     of a thick and flat slab of the material under uniform illumination. (Default: 0.8)
+   - |exposed|, |differentiable|
+
+ * - mfp
+   - |spectrum| or |texture|
+   - Mean free path of light inside the material in scene units, which controls how far light
+     travels below the surface before it leaves it again. (Default: 0.1)
+   - |exposed|, |differentiable|
+
+ * - eta
+   - |float|
+   - Relative index of refraction from the exterior to the interior
+   - |exposed|
+
+This plugin describes the surface of a dense translucent material like skin, wax, marble or
+milk. Light is reflected by a smooth dielectric interface like the one of the
+:ref:`dielectric <bsdf-dielectric>` plugin. The light refracted into the interior undergoes
+many scattering events and eventually leaves the surface again at some distance of the point
+where it entered.
+
+Rendering this with a :ref:`homogeneous <medium-homogeneous>` interior medium and the
+:ref:`volpath <integrator-volpath>` integrator requires hundreds of volumetric scattering
+events per path in such dense materials. Instead, the :ref:`path <integrator-path>`
+integrator replaces the interior light transport by the normalized diffusion profile of
+"Approximate Reflectance Profiles for Efficient Subsurface Scattering" by Christensen and
+Burley: the position where the light leaves the surface is sampled from the profile by
+projecting probe rays onto the same shape, and the light then leaves the surface into a
+cosine-weighted direction. The profile reproduces the specified :monosp:`albedo` on thick
+and flat surfaces. Thin parts of the shape or curved surfaces whose radius is comparable to
+the mean free path appear darker than the albedo, since some of the light leaves the
+surface on the other side or is not found by the probe rays.
+
+Other integrators treat this material like a smooth dielectric interface without an interior
+medium. The material is only supported by the :monosp:`path` integrator in non-polarized
+variants.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: subsurface-marble
+
+        <bsdf type="subsurface">
+            <rgb name="albedo" value="0.83, 0.79, 0.75"/>
+            <rgb name="mfp" value="0.02, 0.015, 0.01"/>
+            <float name="int_ior" value="1.5"/>
+        </bsdf>
+
+    .. code-tab:: python
+
+        'type': 'subsurface',
+        'albedo': {
+            'type': 'rgb',
+            'value': [0.83, 0.79, 0.75]
+        },
+        'mfp': {
+            'type': 'rgb',
+            'value': [0.02, 0.015, 0.01]
+        },
+        'int_ior': 1.5
+ */
+
+template <typename Float, typename Spectrum>
+class SubsurfaceBSDF final : public BSDF<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(BSDF, m_flags, m_components)
+    MI_IMPORT_TYPES(Texture)
+
+    SubsurfaceBSDF(const Properties &props) : Base(props) {
+
+        // Specifies the internal index of refraction at the interface
+        ScalarFloat int_ior = lookup_ior(props, "int_ior", 1.33f);
+
+        // Specifies the external index of refraction at the interface
+        ScalarFloat ext_ior = lookup_ior(props, "ext_ior", "air");
+
+        if (int_ior < 0 || ext_ior < 0)
+            Throw("The interior and exterior indices of refraction must"
+                  " be positive!");
+
+        m_eta = int_ior / ext_ior;
+
+        m_albedo = props.texture<Texture>("albedo", .8f);
+        m_mfp    = props.texture<Texture>("mfp", .1f);
+
+        m_components.push_back(BSDFFlags::DeltaReflection | BSDFFlags::FrontSide |
+                               BSDFFlags::BackSide);
+        m_components.push_back(BSDFFlags::DeltaTransmission | BSDFFlags::FrontSide |
+                               BSDFFlags::BackSide | BSDFFlags::NonSymmetric);
+
+        m_flags = m_components[0] | m_components[1] | BSDFFlags::Subsurface;
+        if (m_albedo->is_spatially_varying() || m_mfp->is_spatially_varying())
+            m_flags = m_flags | BSDFFlags::SpatiallyVarying;
+        dr::set_attr(this, "flags", m_flags);
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        callback->put_parameter("eta", m_eta, +ParamFlags::NonDifferentiable);
+        callback->put_object("albedo", m_albedo.get(), +ParamFlags::Differentiable);
+        callback->put_object("mfp", m_mfp.get(), +ParamFlags::Differentiable);
+    }
+
+    std::pair<BSDFSample3f, Spectrum> sample(const BSDFContext &ctx,
+                                             const SurfaceInteraction3f &si,
+                                             Float sample1,
+                                             const Point2f & /* sample2 */,
+                                             Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFSample, active);
+
+        bool has_reflection   = ctx.is_enabled(BSDFFlags::DeltaReflection, 0),
+             has_transmission = ctx.is_enabled(BSDFFlags::DeltaTransmission, 1);
+
+        // Evaluate the Fresnel equations for unpolarized illumination
+        Float cos_theta_i = Frame3f::cos_theta(si.wi);
+
+        auto [r_i, cos_theta_t, eta_it, eta_ti] = fresnel(cos_theta_i, Float(m_eta));
+        Float t_i = 1.f - r_i;
+
+        // Lobe selection
+        BSDFSample3f bs = dr::zeros<BSDFSample3f>();
+        Mask selected_r;
+        if (likely(has_reflection && has_transmission)) {
+            selected_r = sample1 <= r_i && active;
+            bs.pdf = dr::detach(dr::select(selected_r, r_i, t_i));
+        } else {
+            if (has_reflection || has_transmission) {
+                selected_r = Mask(has_reflection) && active;
+                bs.pdf = 1.f;
+            } else {
+                return { bs, 0.f };
+            }
+        }
+        Mask selected_t = !selected_r && active;
+
+        bs.sampled_component = dr::select(selected_r, UInt32(0), UInt32(1));
+        bs.sampled_type      = dr::select(selected_r, UInt32(+BSDFFlags::DeltaReflection),
+                                                      UInt32(+BSDFFlags::DeltaTransmission));
+
+        bs.wo = dr::select(selected_r,
+                           reflect(si.wi),
+                           refract(si.wi, cos_theta_t, eta_ti));
+
+        bs.eta = dr::select(selected_r, Float(1.f), eta_it);
+
+        UnpolarizedSpectrum weight = 1.f;
+        if (!(has_reflection && has_transmission))
+            weight = has_reflection ? r_i : t_i;
+
+        if (dr::any_or<true>(selected_t)) {
+            /* For transmission, radiance must be scaled to account for the solid
+               angle compression that occurs when crossing the interface. */
+            Float factor = (ctx.mode == TransportMode::Radiance) ? eta_ti : Float(1.f);
+            weight[selected_t] *= dr::sqr(factor);
+        }
+
+        return { bs, depolarizer<Spectrum>(weight) & active };
+    }
+
+    Spectrum eval(const BSDFContext & /* ctx */, const SurfaceInteraction3f & /* si */,
+                  const Vector3f & /* wo */, Mask /* active */) const override {
+        return 0.f;
+    }
+
+    Float pdf(const BSDFContext & /* ctx */, const SurfaceInteraction3f & /* si */,
+              const Vector3f & /* wo */, Mask /* active */) const override {
+        return 0.f;
+    }
+
+    std::pair<UnpolarizedSpectrum, UnpolarizedSpectrum>
+    eval_subsurface(const SurfaceInteraction3f &si, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::BSDFEvaluate, active);
+
+        UnpolarizedSpectrum albedo = dr::clamp(m_albedo->eval(si, active), 0.f, 1.f),
+                            mfp    = dr::maximum(m_mfp->eval(si, active), 0.f);
+
+        return { albedo & active, mfp & active };
+    }
+
+    Spectrum eval_diffuse_reflectance(const SurfaceInteraction3f &si,
+                                      Mask active) const override {
+        return depolarizer<Spectrum>(m_albedo->eval(si, active));
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SubsurfaceBSDF[" << std::endl
+            << "  albedo = " << string::indent(m_albedo) << "," << std::endl
+            << "  mfp = " << string::indent(m_mfp) << "," << std::endl
+            << "  eta = " << m_eta << "," << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    ScalarFloat m_eta;
+    ref<Texture> m_albedo;
+    ref<Texture> m_mfp;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SubsurfaceBSDF, BSDF)
+MI_EXPORT_PLUGIN(SubsurfaceBSDF, "Subsurface scattering material")
+NAMESPACE_END(mitsuba)
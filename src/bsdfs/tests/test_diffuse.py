@@ -2,6 +2,8 @@ import pytest
 import drjit as dr
 import mitsuba as mi
 
+from .utils import check_eval_pdf_sample
+
 def test01_create(variant_scalar_rgb):
     b = mi.load_dict({'type': 'diffuse'})
     assert b is not None
@@ -48,3 +50,24 @@ def test03_chi2(variants_vec_backends_once_rgb):
     )
 
     assert chi2.run()
+
+
+def test04_uniform_reflectance_update(variant_scalar_rgb):
+    # Uniform reflectances are stored in the BSDF and must follow updates
+    bsdf = mi.load_dict({'type': 'diffuse', 'reflectance': {'type': 'rgb', 'value': 0.2}})
+    assert bsdf.eval_diffuse_reflectance(mi.SurfaceInteraction3f())[0] == 0.2
+
+    si    = mi.SurfaceInteraction3f()
+    si.wi = [0, 0, 1]
+    si.sh_frame = mi.Frame3f([0, 0, 1])
+
+    params = mi.traverse(bsdf)
+    params['reflectance.value'] = [0.8, 0.4, 0.1]
+    params.update()
+
+    value = bsdf.eval(mi.BSDFContext(), si, wo=[0, 0, 1])
+    assert dr.allclose(value, [0.8 / dr.pi, 0.4 / dr.pi, 0.1 / dr.pi])
+
+
+def test05_eval_pdf_sample(variant_scalar_rgb):
+    check_eval_pdf_sample({ 'type': 'diffuse', 'reflectance': { 'type': 'checkerboard' } })
@@ -2,6 +2,8 @@ import pytest
 import drjit as dr
 import mitsuba as mi
 
+from .utils import check_eval_pdf_sample
+
 
 def test00_construction_and_lobes(variant_scalar_rgb):
     # By default the BSDF should only have 2 lobes, no anisotropic / transmission
@@ -194,3 +196,8 @@ def test05_eval_pdf(variant_scalar_rgb):
         wo = [dr.sin(theta), 0, dr.cos(theta)]
         assert dr.allclose(bsdf.pdf(ctx, si, wo=wo), pdf_true[i])
         assert dr.allclose(bsdf.eval(ctx, si, wo=wo)[0], evaluate_true[i])
+
+
+def test06_eval_pdf_sample(variant_scalar_rgb):
+    check_eval_pdf_sample({ 'type': 'principled', 'metallic': 0.3, 'spec_trans': 0.4,
+                             'clearcoat': 0.5, 'sheen': 0.2, 'anisotropic': 0.4 })
@@ -1,6 +1,8 @@
 import drjit as dr
 import mitsuba as mi
 
+from .utils import check_eval_pdf_sample
+
 def test01_chi2_smooth(variants_vec_backends_once_rgb):
     xml = """<float name="alpha" value="0.05"/>"""
     wi = dr.normalize(mi.ScalarVector3f(1.0, 1.0, 1.0))
@@ -115,3 +117,47 @@ def test06_eval_pdf(variant_scalar_rgb):
         v_eval_pdf = bsdf.eval_pdf(ctx, si, wo=wo)
         assert dr.allclose(v_eval, v_eval_pdf[0])
         assert dr.allclose(v_pdf, v_eval_pdf[1])
+
+
+def test07_energy_compensation(variants_vec_rgb):
+    # The default (eta, k) = (0, 1) conductor reflects all light at the
+    # microfacets, hence the compensated albedo should be close to one
+    n = 100000
+    sampler = mi.load_dict({ 'type': 'independent' })
+    sampler.seed(0, n)
+
+    for distribution in ['beckmann', 'ggx']:
+        for alpha in [0.2, 0.6, 1.0]:
+            def albedo(energy_compensation, cos_theta):
+                bsdf = mi.load_dict({
+                    'type': 'roughconductor',
+                    'distribution': distribution,
+                    'alpha': alpha,
+                    'energy_compensation': energy_compensation
+                })
+                si    = dr.zeros(mi.SurfaceInteraction3f, n)
+                si.wi = [dr.sqrt(1 - cos_theta**2), 0, cos_theta]
+                _, weight = bsdf.sample(mi.BSDFContext(), si,
+                                        sampler.next_1d(), sampler.next_2d())
+                return dr.mean(weight[0])[0]
+
+            for cos_theta in [0.2, 0.7, 1.0]:
+                e = albedo(False, cos_theta)
+                e_comp = albedo(True, cos_theta)
+                assert e_comp >= e
+                assert abs(e_comp - 1) < 0.03
+
+    # Sampling and evaluation remain consistent
+    bsdf = mi.load_dict({ 'type': 'roughconductor', 'alpha': 0.5,
+                          'energy_compensation': True })
+    si    = dr.zeros(mi.SurfaceInteraction3f, n)
+    si.wi = dr.normalize(mi.Vector3f(0.3, 0.2, 1))
+    bs, weight = bsdf.sample(mi.BSDFContext(), si, sampler.next_1d(), sampler.next_2d())
+    value, pdf = bsdf.eval_pdf(mi.BSDFContext(), si, bs.wo)
+    valid = pdf > 0
+    assert dr.allclose(dr.select(valid, weight, 0), dr.select(valid, value / pdf, 0), rtol=1e-3)
+    assert dr.allclose(value, bsdf.eval(mi.BSDFContext(), si, bs.wo))
+
+
+def test08_eval_pdf_sample(variant_scalar_rgb):
+    check_eval_pdf_sample({ 'type': 'roughconductor', 'alpha_u': 0.1, 'alpha_v': 0.3, 'material': 'Au' })
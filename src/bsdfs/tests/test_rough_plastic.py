@@ -2,6 +2,8 @@ import pytest
 import drjit as dr
 import mitsuba as mi
 
+from .utils import check_eval_pdf_sample
+
 
 @pytest.mark.slow
 def test01_chi2_smooth(variants_vec_backends_once_rgb):
@@ -59,3 +61,7 @@ def test03_eval_pdf(variant_scalar_rgb):
         v_eval_pdf = bsdf.eval_pdf(ctx, si, wo=wo)
         assert dr.allclose(v_eval, v_eval_pdf[0])
         assert dr.allclose(v_pdf, v_eval_pdf[1])
+
+
+def test04_eval_pdf_sample(variant_scalar_rgb):
+    check_eval_pdf_sample({ 'type': 'roughplastic', 'alpha': 0.2 })
@@ -0,0 +1,92 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+
+
+def test01_create(variant_scalar_rgb):
+    b = mi.load_dict({'type': 'subsurface'})
+    assert b is not None
+    assert b.component_count() == 2
+    assert b.flags(0) == (mi.BSDFFlags.DeltaReflection | mi.BSDFFlags.FrontSide |
+                          mi.BSDFFlags.BackSide)
+    assert b.flags(1) == (mi.BSDFFlags.DeltaTransmission | mi.BSDFFlags.FrontSide |
+                          mi.BSDFFlags.BackSide | mi.BSDFFlags.NonSymmetric)
+    assert b.flags() == b.flags(0) | b.flags(1) | mi.BSDFFlags.Subsurface
+
+    # Should not accept negative IORs
+    with pytest.raises(RuntimeError):
+        mi.load_dict({'type': 'subsurface', 'int_ior': -0.5})
+
+
+def test02_sample(variant_scalar_rgb):
+    si = mi.SurfaceInteraction3f()
+    si.wi = [0, 0, 1]
+    ctx = mi.BSDFContext()
+
+    # The interface behaves like the one of the smooth dielectric
+    bsdf = mi.load_dict({'type': 'subsurface', 'int_ior': 1.5, 'ext_ior': 1.0})
+    ref = mi.load_dict({'type': 'dielectric', 'int_ior': 1.5, 'ext_ior': 1.0})
+    for sample in [0, 0.05, 0.5]:
+        bs, spec = bsdf.sample(ctx, si, sample, [0, 0])
+        bs_ref, spec_ref = ref.sample(ctx, si, sample, [0, 0])
+        assert dr.allclose(spec, spec_ref)
+        assert dr.allclose(bs.pdf, bs_ref.pdf)
+        assert dr.allclose(bs.eta, bs_ref.eta)
+        assert dr.allclose(bs.wo, bs_ref.wo)
+        assert bs.sampled_type == bs_ref.sampled_type
+
+
+def test03_eval_subsurface(variant_scalar_rgb):
+    bsdf = mi.load_dict({
+        'type': 'subsurface',
+        'albedo': {'type': 'rgb', 'value': [0.9, 0.5, 0.2]},
+        'mfp': {'type': 'rgb', 'value': [0.3, 0.2, 0.1]}
+    })
+
+    si = mi.SurfaceInteraction3f()
+    si.wi = [0, 0, 1]
+    albedo, mfp = bsdf.eval_subsurface(si)
+    assert dr.allclose(albedo, [0.9, 0.5, 0.2])
+    assert dr.allclose(mfp, [0.3, 0.2, 0.1])
+
+    params = mi.traverse(bsdf)
+    assert 'albedo.value' in params and 'mfp.value' in params
+
+    # Other BSDFs don't scatter light below the surface
+    albedo, mfp = mi.load_dict({'type': 'dielectric'}).eval_subsurface(si)
+    assert dr.all(albedo == 0) and dr.all(mfp == 0)
+
+
+def test04_render(variants_all_rgb):
+    def render(bsdf):
+        scene = mi.load_dict({
+            'type': 'scene',
+            'integrator': {'type': 'path', 'max_depth': 8},
+            'sensor': {
+                'type': 'perspective',
+                'fov': 10,
+                'to_world': mi.ScalarTransform4f.look_at(origin=[0, 0, 10],
+                                                         target=[0, 0, 0],
+                                                         up=[0, 1, 0]),
+                'film': {
+                    'type': 'hdrfilm',
+                    'width': 8,
+                    'height': 8,
+                    'rfilter': {'type': 'box'}
+                },
+                'sampler': {'type': 'independent', 'sample_count': 256}
+            },
+            'emitter': {'type': 'constant'},
+            'shape': {'type': 'cube', 'bsdf': bsdf}
+        })
+        return np.array(mi.render(scene)).mean()
+
+    # A flat face reflects about as much light as a diffuse surface of the same albedo
+    subsurface = render({'type': 'subsurface', 'albedo': 0.5, 'mfp': 0.01})
+    diffuse = render({'type': 'diffuse', 'reflectance': 0.5})
+    assert np.allclose(subsurface, diffuse, rtol=0.2)
+
+    # With a black albedo, only the Fresnel reflection remains
+    dark = render({'type': 'subsurface', 'albedo': 0, 'mfp': 0.01})
+    assert 0 < dark < 0.5 * subsurface
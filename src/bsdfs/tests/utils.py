@@ -0,0 +1,36 @@
+import drjit as dr
+import mitsuba as mi
+
+
+def check_eval_pdf_sample(bsdf_dict, count=50):
+    """
+    Check that the fused ``eval_pdf_sample()`` query of the BSDF described by
+    ``bsdf_dict`` matches separate calls to ``eval_pdf()`` and ``sample()`` for
+    ``count`` random pairs of directions and samples.
+    """
+    bsdf = mi.load_dict(bsdf_dict)
+
+    si    = mi.SurfaceInteraction3f()
+    si.p  = [0, 0, 0]
+    si.n  = [0, 0, 1]
+    si.uv = [0.3, 0.6]
+    si.sh_frame = mi.Frame3f(si.n)
+    ctx = mi.BSDFContext()
+
+    sampler = mi.load_dict({ 'type': 'independent' })
+    sampler.seed(0)
+    for i in range(count):
+        si.wi = mi.warp.square_to_uniform_hemisphere(sampler.next_2d())
+        wo = mi.warp.square_to_uniform_hemisphere(sampler.next_2d())
+        sample1, sample2 = sampler.next_1d(), sampler.next_2d()
+
+        value, pdf, bs, weight = bsdf.eval_pdf_sample(ctx, si, wo, sample1, sample2)
+        value_ref, pdf_ref = bsdf.eval_pdf(ctx, si, wo)
+        bs_ref, weight_ref = bsdf.sample(ctx, si, sample1, sample2)
+
+        assert dr.allclose(value, value_ref, rtol=1e-4)
+        assert dr.allclose(pdf, pdf_ref, rtol=1e-4)
+        assert dr.allclose(bs.wo, bs_ref.wo)
+        assert dr.allclose(bs.pdf, bs_ref.pdf, rtol=1e-4)
+        assert bs.sampled_component == bs_ref.sampled_component
+        assert dr.allclose(weight, weight_ref, rtol=1e-4)
@@ -85,7 +85,13 @@ public:
         if (!m_brdf[1])
             m_brdf[1] = m_brdf[0];
 
+        update_components();
+    }
+
+    void update_components() {
         // Add all nested components, overwriting any front / back side flag.
+        m_components.clear();
+        m_flags = +BSDFFlags::Empty;
         for (size_t i = 0; i < m_brdf[0]->component_count(); ++i) {
             auto c = (m_brdf[0]->flags(i) & ~BSDFFlags::BackSide);
             m_components.push_back(c | BSDFFlags::FrontSide);
@@ -103,6 +109,15 @@ public:
             Throw("Only materials without a transmission component can be nested!");
     }
 
+    ref<Base> simplify() override {
+        // Keep the fast path for a single BSDF that is shared by both sides
+        bool shared = m_brdf[0] == m_brdf[1];
+        m_brdf[0] = m_brdf[0]->simplify();
+        m_brdf[1] = shared ? m_brdf[0] : m_brdf[1]->simplify();
+        update_components();
+        return this;
+    }
+
     void traverse(TraversalCallback *callback) override {
         callback->put_object("brdf_0", m_brdf[0].get(), +ParamFlags::Differentiable);
         callback->put_object("brdf_1", m_brdf[1].get(), +ParamFlags::Differentiable);
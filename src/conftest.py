@@ -131,6 +131,22 @@ for name, variants in variant_groups.items():
 del generate_fixture_group
 
 
+def pytest_addoption(parser):
+    group = parser.getgroup('benchmark')
+    group.addoption('--benchmark', action='store_true',
+                    help='run the benchmark regression tests')
+    group.addoption('--benchmark-baseline', default='benchmark_baseline.json',
+                    help='file with the baselines of the benchmark tests '
+                         '(default: benchmark_baseline.json)')
+    group.addoption('--benchmark-update', action='store_true',
+                    help='store the benchmark results as the new baselines')
+    group.addoption('--benchmark-threshold', type=float, default=0.1,
+                    help='relative slowdown that fails a benchmark test '
+                         '(default: 0.1)')
+    group.addoption('--benchmark-scale', type=float, default=0.25,
+                    help='complexity of the benchmark scenes (default: 0.25)')
+
+
 def pytest_configure(config):
     markexpr = config.getoption("markexpr", 'False')
     if not 'not slow' in markexpr:
@@ -139,3 +155,16 @@ def pytest_configure(config):
     config.addinivalue_line(
         "markers", "slow: marks tests as slow (deselect with -m 'not slow')"
     )
+    config.addinivalue_line(
+        "markers", "benchmark: marks benchmark regression tests (only run "
+                   "with --benchmark)"
+    )
+
+
+def pytest_collection_modifyitems(config, items):
+    if config.getoption('--benchmark'):
+        return
+    skip = pytest.mark.skip(reason='benchmark tests only run with --benchmark')
+    for item in items:
+        if 'benchmark' in item.keywords:
+            item.add_marker(skip)
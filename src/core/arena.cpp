@@ -0,0 +1,99 @@
+#include <mitsuba/core/arena.h>
+#include <mitsuba/core/logger.h>
+#include <algorithm>
+#include <atomic>
+
+NAMESPACE_BEGIN(mitsuba)
+
+static std::atomic<size_t> heap_allocation_count { 0 };
+
+ScratchArena::ScratchArena(size_t chunk_size)
+    : m_chunk_size(std::max<size_t>(chunk_size, 256)), m_chunk(0), m_ptr(0),
+      m_end(0) { }
+
+ScratchArena::~ScratchArena() = default;
+
+ScratchArena::Chunk ScratchArena::new_chunk(size_t size) {
+    heap_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return Chunk{ std::unique_ptr<uint8_t[]>(new uint8_t[size]), size };
+}
+
+void ScratchArena::activate(size_t chunk, size_t offset) {
+    const Chunk &c = m_chunks[chunk];
+    m_chunk = chunk;
+    m_ptr = (uintptr_t) c.data.get() + offset;
+    m_end = (uintptr_t) c.data.get() + c.size;
+}
+
+void *ScratchArena::allocate_slow(size_t size, size_t align) {
+    if (align == 0 || (align & (align - 1)) != 0)
+        Throw("ScratchArena::allocate(): the alignment (%zu) must be a power "
+              "of two!", align);
+
+    // Chunks following the current one are left over from rewind()
+    size_t next = m_chunks.empty() ? 0 : m_chunk + 1;
+    if (next >= m_chunks.size() || m_chunks[next].size < size + align - 1) {
+        size_t chunk_size = std::max(m_chunk_size, size + align - 1);
+        m_chunks.insert(m_chunks.begin() + next, new_chunk(chunk_size));
+    }
+
+    activate(next, 0);
+    uintptr_t ptr = (m_ptr + (align - 1)) & ~(uintptr_t) (align - 1);
+    m_ptr = ptr + size;
+    return (void *) ptr;
+}
+
+void ScratchArena::reset() {
+    if (m_chunks.size() > 1) {
+        size_t total = capacity();
+        m_chunks.clear();
+        m_chunks.push_back(new_chunk(total));
+    }
+
+    if (m_chunks.empty()) {
+        m_chunk = 0;
+        m_ptr = m_end = 0;
+    } else {
+        activate(0, 0);
+    }
+}
+
+ScratchArena::Marker ScratchArena::mark() const {
+    if (m_chunks.empty())
+        return Marker();
+    return Marker{ m_chunk,
+                   (size_t) (m_ptr - (uintptr_t) m_chunks[m_chunk].data.get()) };
+}
+
+void ScratchArena::rewind(const Marker &marker) {
+    if (m_chunks.empty())
+        return;
+    activate(marker.chunk, marker.offset);
+}
+
+size_t ScratchArena::bytes_used() const {
+    if (m_chunks.empty())
+        return 0;
+    size_t result = m_ptr - (uintptr_t) m_chunks[m_chunk].data.get();
+    for (size_t i = 0; i < m_chunk; ++i)
+        result += m_chunks[i].size;
+    return result;
+}
+
+size_t ScratchArena::capacity() const {
+    size_t result = 0;
+    for (const Chunk &c : m_chunks)
+        result += c.size;
+    return result;
+}
+
+ScratchArena &ScratchArena::thread() {
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+size_t ScratchArena::heap_allocations() {
+    return heap_allocation_count.load(std::memory_order_relaxed);
+}
+
+NAMESPACE_END(mitsuba)
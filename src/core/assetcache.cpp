@@ -0,0 +1,209 @@
+#include <mitsuba/core/assetcache.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/mmap.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+struct AssetCacheEntry {
+    ref<Object> value;
+    bool loading = false;
+};
+
+struct AssetCacheTicket {
+    std::string id;
+    std::shared_ptr<AssetCacheEntry> entry;
+};
+
+static std::mutex asset_cache_mutex;
+static std::condition_variable asset_cache_cv;
+static std::unordered_map<std::string, std::shared_ptr<AssetCacheEntry>> asset_cache;
+static std::atomic<bool> asset_cache_enabled { true };
+
+static fs::path asset_cache_shared_dir_init() {
+    const char *dir = std::getenv("MI_SHARED_ASSET_DIR");
+    return dir ? fs::path(dir) : fs::path();
+}
+
+static std::mutex asset_cache_shared_mutex;
+static fs::path asset_cache_shared_dir = asset_cache_shared_dir_init();
+
+/// Identify an asset by its file and a plugin-specific key (throws if there is no such file)
+static std::string asset_cache_id(const fs::path &path, const std::string &key) {
+    return tfm::format("%s\n%lld:%zu\n%s", fs::absolute(path).string(),
+                       (long long) fs::last_write_time(path),
+                       fs::file_size(path), key);
+}
+
+/// Remove unused entries (the cache mutex must be held)
+static void asset_cache_prune() {
+    for (auto it = asset_cache.begin(); it != asset_cache.end();) {
+        const AssetCacheEntry *entry = it->second.get();
+        if (!entry->loading && (!entry->value || entry->value->ref_count() == 1))
+            it = asset_cache.erase(it);
+        else
+            ++it;
+    }
+}
+
+ref<Object> AssetCache::get(const fs::path &path, const std::string &key,
+                            Ticket &ticket) {
+    ticket.reset();
+    if (!asset_cache_enabled)
+        return nullptr;
+
+    std::string id;
+    try {
+        id = asset_cache_id(path, key);
+    } catch (const std::exception &) {
+        // Assets that don't correspond to a file are never cached
+        return nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(asset_cache_mutex);
+    asset_cache_prune();
+
+    while (true) {
+        std::shared_ptr<AssetCacheEntry> &slot = asset_cache[id];
+        if (!slot)
+            slot = std::make_shared<AssetCacheEntry>();
+        std::shared_ptr<AssetCacheEntry> entry = slot;
+
+        if (entry->value)
+            return entry->value;
+
+        if (!entry->loading) {
+            entry->loading = true;
+            ticket = Ticket(new AssetCacheTicket{ id, entry }, [](void *ptr) {
+                AssetCacheTicket *t = (AssetCacheTicket *) ptr;
+                {
+                    std::lock_guard<std::mutex> guard(asset_cache_mutex);
+                    t->entry->loading = false;
+                    // Let a waiting thread retry if loading failed
+                    auto it = asset_cache.find(t->id);
+                    if (!t->entry->value && it != asset_cache.end() &&
+                        it->second == t->entry)
+                        asset_cache.erase(it);
+                }
+                asset_cache_cv.notify_all();
+                delete t;
+            });
+            return nullptr;
+        }
+
+        // Another thread is loading this asset, wait until it is done
+        asset_cache_cv.wait(lock, [&] { return !entry->loading; });
+    }
+}
+
+void AssetCache::put(Ticket &ticket, Object *value) {
+    if (!ticket)
+        return;
+    {
+        std::lock_guard<std::mutex> guard(asset_cache_mutex);
+        ((AssetCacheTicket *) ticket.get())->entry->value = value;
+    }
+    ticket.reset();
+}
+
+ref<Object> AssetCache::get(const fs::path &path, const std::string &key,
+                            const std::function<ref<Object>()> &load) {
+    Ticket ticket;
+    ref<Object> value = get(path, key, ticket);
+    if (!value) {
+        value = load();
+        put(ticket, value);
+    }
+    return value;
+}
+
+ref<MemoryMappedFile> AssetCache::get_shared(const fs::path &path,
+                                             const std::string &key,
+                                             const std::function<void(Stream *)> &write) {
+    fs::path dir = shared_directory();
+    if (dir.empty())
+        return nullptr;
+
+    std::string id;
+    try {
+        id = asset_cache_id(path, key);
+    } catch (const std::exception &) {
+        return nullptr;
+    }
+
+    uint64_t hash = hash_bytes(id.data(), id.size());
+    fs::path entry = dir / fs::path(tfm::format("%016llx.asset",
+                                                (unsigned long long) hash));
+
+    try {
+        if (fs::exists(entry))
+            return new MemoryMappedFile(entry, false);
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not map shared asset \"%s\": %s", entry.string(), e.what());
+        return nullptr;
+    }
+
+    try {
+        if (!fs::exists(dir))
+            fs::create_directory(dir);
+        /* Processes concurrently loading the same asset never observe a
+           partially written entry */
+        fs::write_atomic(entry, [&](const fs::path &tmp_file) {
+            ref<FileStream> stream = new FileStream(tmp_file, FileStream::ETruncReadWrite);
+            write(stream);
+            stream->close();
+        });
+        Log(Debug, "Stored shared asset \"%s\" for \"%s\"", entry.string(),
+            path.string());
+        return new MemoryMappedFile(entry, false);
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not store shared asset \"%s\": %s", entry.string(), e.what());
+        return nullptr;
+    }
+}
+
+void AssetCache::set_shared_directory(const fs::path &path) {
+    std::lock_guard<std::mutex> guard(asset_cache_shared_mutex);
+    asset_cache_shared_dir = path;
+}
+
+fs::path AssetCache::shared_directory() {
+    std::lock_guard<std::mutex> guard(asset_cache_shared_mutex);
+    return asset_cache_shared_dir;
+}
+
+void AssetCache::prune() {
+    std::lock_guard<std::mutex> guard(asset_cache_mutex);
+    asset_cache_prune();
+}
+
+void AssetCache::clear() {
+    std::lock_guard<std::mutex> guard(asset_cache_mutex);
+    for (auto it = asset_cache.begin(); it != asset_cache.end();) {
+        if (it->second->loading)
+            ++it;
+        else
+            it = asset_cache.erase(it);
+    }
+}
+
+size_t AssetCache::size() {
+    std::lock_guard<std::mutex> guard(asset_cache_mutex);
+    asset_cache_prune();
+    return asset_cache.size();
+}
+
+void AssetCache::set_enabled(bool enabled) {
+    asset_cache_enabled = enabled;
+    if (!enabled)
+        clear();
+}
+
+bool AssetCache::enabled() { return asset_cache_enabled; }
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,267 @@
+#include <mitsuba/core/astream.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/tracer.h>
+#include <mitsuba/core/util.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+#if defined(__linux__) || defined(__APPLE__)
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#elif defined(_WIN32)
+# include <windows.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+
+AsyncFileStream::AsyncFileStream(const fs::path &p, size_t block_size,
+                                 bool read_ahead)
+    : Stream(), m_path(p), m_size(0), m_pos(0),
+      m_block_size(std::max<size_t>(block_size, 4096)),
+      m_read_ahead(read_ahead), m_bytes_read(0),
+      m_trace_start(TraceRecorder::running() ? TraceRecorder::timestamp() : -1.0) {
+#if defined(_WIN32)
+    m_handle = CreateFileW(p.native().c_str(), GENERIC_READ, FILE_SHARE_READ,
+                           nullptr, OPEN_EXISTING,
+                           FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                           nullptr);
+    if (m_handle == INVALID_HANDLE_VALUE)
+        Throw("\"%s\": I/O error while attempting to open file: %s",
+              m_path.string(), util::last_error());
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_handle, &size)) {
+        CloseHandle(m_handle);
+        m_handle = INVALID_HANDLE_VALUE;
+        Throw("\"%s\": unable to determine the file size: %s",
+              m_path.string(), util::last_error());
+    }
+    m_size = (size_t) size.QuadPart;
+#else
+    m_fd = open(p.string().c_str(), O_RDONLY);
+    if (m_fd == -1)
+        Throw("\"%s\": I/O error while attempting to open file: %s",
+              m_path.string(), strerror(errno));
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0) {
+        ::close(m_fd);
+        m_fd = -1;
+        Throw("\"%s\": unable to determine the file size: %s",
+              m_path.string(), strerror(errno));
+    }
+    m_size = (size_t) st.st_size;
+
+# if defined(__linux__)
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+# endif
+#endif
+
+    m_current.data.reset(new uint8_t[m_block_size]);
+    if (m_read_ahead)
+        m_next.data.reset(new uint8_t[m_block_size]);
+}
+
+AsyncFileStream::~AsyncFileStream() {
+    close();
+}
+
+void AsyncFileStream::close() {
+    if (is_closed())
+        return;
+
+    // Wait for the read-ahead task, its errors no longer matter
+    if (m_next.task) {
+        task_wait_and_release(m_next.task);
+        m_next.task = nullptr;
+    }
+
+    if (m_trace_start >= 0.0) {
+        TraceRecorder::add_event(
+            "io", m_path.filename().string(), m_trace_start,
+            TraceRecorder::timestamp() - m_trace_start,
+            tfm::format("\"bytes_read\": %zu", m_bytes_read));
+        m_trace_start = -1.0;
+    }
+
+#if defined(_WIN32)
+    CloseHandle(m_handle);
+    m_handle = INVALID_HANDLE_VALUE;
+#else
+    ::close(m_fd);
+    m_fd = -1;
+#endif
+}
+
+bool AsyncFileStream::is_closed() const {
+#if defined(_WIN32)
+    return m_handle == INVALID_HANDLE_VALUE;
+#else
+    return m_fd == -1;
+#endif
+}
+
+size_t AsyncFileStream::read_some(size_t pos, void *p, size_t size) const {
+    if (unlikely(is_closed()))
+        Throw("\"%s\": attempted to read from a closed stream", m_path.string());
+
+    uint8_t *ptr = (uint8_t *) p;
+    size_t total = 0;
+    while (total < size && pos + total < m_size) {
+        size_t amount = std::min(size - total, m_size - pos - total);
+#if defined(_WIN32)
+        DWORD request = (DWORD) std::min<size_t>(amount, 1u << 30), count = 0;
+        OVERLAPPED overlapped;
+        memset(&overlapped, 0, sizeof(OVERLAPPED));
+        uint64_t offset = (uint64_t) (pos + total);
+        overlapped.Offset = (DWORD) offset;
+        overlapped.OffsetHigh = (DWORD) (offset >> 32);
+        if (!ReadFile(m_handle, ptr + total, request, &count, &overlapped))
+            Throw("\"%s\": I/O error while attempting to read %zu bytes: %s",
+                  m_path.string(), amount, util::last_error());
+        size_t result = (size_t) count;
+#else
+        ssize_t result = pread(m_fd, ptr + total, amount, (off_t) (pos + total));
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            Throw("\"%s\": I/O error while attempting to read %zu bytes: %s",
+                  m_path.string(), amount, strerror(errno));
+        }
+#endif
+        if (result == 0)
+            break;
+        total += (size_t) result;
+    }
+    return total;
+}
+
+void AsyncFileStream::read_at(size_t pos, void *p, size_t size) const {
+    size_t count = read_some(pos, p, size);
+    if (unlikely(count < size))
+        throw EOFException(tfm::format("\"%s\": read %zu out of %zu bytes",
+                                       m_path.string(), count, size), count);
+}
+
+void AsyncFileStream::wait(Buffer &buffer) {
+    if (!buffer.task)
+        return;
+    task_wait_and_release(buffer.task);
+    buffer.task = nullptr;
+    if (buffer.error) {
+        std::exception_ptr error = buffer.error;
+        buffer.error = nullptr;
+        buffer.block = (size_t) -1;
+        std::rethrow_exception(error);
+    }
+}
+
+const AsyncFileStream::Buffer &AsyncFileStream::fetch(size_t block) {
+    if (m_current.block != block) {
+        if (m_next.block == block) {
+            wait(m_next);
+            std::swap(m_current, m_next);
+            m_bytes_read += m_current.size;
+        } else {
+            m_current.block = (size_t) -1;
+            m_current.size = read_some(block * m_block_size,
+                                       m_current.data.get(), m_block_size);
+            m_current.block = block;
+            m_bytes_read += m_current.size;
+        }
+
+        size_t next = block + 1;
+        if (m_read_ahead && next * m_block_size < m_size && m_next.block != next) {
+            wait(m_next);
+            Buffer *buffer = &m_next;
+            buffer->block = next;
+            buffer->task = dr::do_async([this, buffer]() {
+                try {
+                    buffer->size = read_some(buffer->block * m_block_size,
+                                             buffer->data.get(), m_block_size);
+                } catch (...) {
+                    buffer->error = std::current_exception();
+                }
+            });
+        }
+    }
+    return m_current;
+}
+
+void AsyncFileStream::read(void *p, size_t size) {
+    uint8_t *ptr = (uint8_t *) p;
+    size_t total = 0;
+
+    while (total < size && m_pos < m_size) {
+        size_t block = m_pos / m_block_size,
+               offset = m_pos % m_block_size,
+               remainder = size - total;
+
+        if (offset == 0 && remainder >= m_block_size &&
+            m_current.block != block && m_next.block != block) {
+            // Large reads go directly to the destination
+            size_t amount = remainder - remainder % m_block_size;
+            size_t count = read_some(m_pos, ptr + total, amount);
+            m_bytes_read += count;
+            total += count;
+            m_pos += count;
+            if (count < amount)
+                break;
+            continue;
+        }
+
+        const Buffer &buffer = fetch(block);
+        if (offset >= buffer.size)
+            break;
+        size_t amount = std::min(remainder, buffer.size - offset);
+        memcpy(ptr + total, buffer.data.get() + offset, amount);
+        total += amount;
+        m_pos += amount;
+    }
+
+    if (unlikely(total < size))
+        throw EOFException(tfm::format("\"%s\": read %zu out of %zu bytes",
+                                       m_path.string(), total, size), total);
+}
+
+void AsyncFileStream::write(const void *, size_t size) {
+    Throw("\"%s\": attempted to write %zu bytes to a read-only stream",
+          m_path.string(), size);
+}
+
+void AsyncFileStream::seek(size_t pos) {
+    m_pos = pos;
+}
+
+void AsyncFileStream::truncate(size_t) {
+    Throw("\"%s\": attempting to truncate a read-only AsyncFileStream",
+          m_path.string());
+}
+
+std::string AsyncFileStream::to_string() const {
+    std::ostringstream oss;
+
+    oss << class_()->name() << "[" << std::endl;
+    if (is_closed()) {
+        oss << "  closed" << std::endl;
+    } else {
+        oss << "  path = \"" << m_path.string() << "\"" << "," << std::endl
+            << "  host_byte_order = " << host_byte_order() << "," << std::endl
+            << "  byte_order = " << byte_order() << "," << std::endl
+            << "  block_size = " << m_block_size << "," << std::endl
+            << "  read_ahead = " << m_read_ahead << "," << std::endl
+            << "  pos = " << m_pos << "," << std::endl
+            << "  size = " << m_size << std::endl;
+    }
+
+    oss << "]";
+
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS(AsyncFileStream, Stream)
+
+NAMESPACE_END(mitsuba)
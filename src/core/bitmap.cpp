@@ -6,8 +6,12 @@
 #include <mitsuba/core/rfilter.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/mstream.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/tracer.h>
 #include <unordered_map>
+#include <mutex>
 
 #include <nanothread/nanothread.h>
 #include <drjit/half.h>
@@ -39,6 +43,7 @@ extern "C" {
 #include <ImfStandardAttributes.h>
 #include <ImfRgbaYca.h>
 #include <ImfOutputFile.h>
+#include <ImfTiledOutputFile.h>
 #include <ImfChannelList.h>
 #include <ImfStringAttribute.h>
 #include <ImfIntAttribute.h>
@@ -103,7 +108,8 @@ Bitmap::Bitmap(Bitmap &&bitmap)
       m_size(bitmap.m_size),
       m_struct(std::move(bitmap.m_struct)),
       m_srgb_gamma(bitmap.m_srgb_gamma),
-      m_owns_data(bitmap.m_owns_data) {
+      m_owns_data(bitmap.m_owns_data),
+      m_data_owner(std::move(bitmap.m_data_owner)) {
 }
 
 Bitmap::Bitmap(Stream *stream, FileFormat format) {
@@ -313,15 +319,18 @@ resample(Bitmap *target, const Bitmap *source,
         r.set_boundary_condition(bc.second);
         r.set_clamp(clamp);
 
+        /* Process entire rows of the output, which accesses contiguous
+           memory and vectorizes over all pixels and channels of a row */
+        size_t row_size = (size_t) target->width() * channels;
         dr::parallel_for(
-            dr::blocked_range<size_t>(0, source->width(), 100),
+            dr::blocked_range<size_t>(0, target->height(),
+                                      std::max<size_t>(1, 16384 / row_size)),
             [&](const dr::blocked_range<size_t> &range) {
-                for (auto x = range.begin(); x != range.end(); ++x) {
-                    const Scalar *s = (const Scalar *) source->uint8_data() +
-                                      x * channels;
+                for (auto y = range.begin(); y != range.end(); ++y) {
+                    const Scalar *s = (const Scalar *) source->uint8_data();
                     Scalar *t       = (Scalar *) target->uint8_data() +
-                                      x * channels;
-                    r.resample(s, source->width(), t, target->width(), (uint32_t) channels);
+                                      y * row_size;
+                    r.resample_lanes(s, row_size, t, row_size, (uint32_t) y);
                 }
             }
         );
@@ -519,8 +528,12 @@ void Bitmap::convert(Bitmap *target) const {
     }
 
     StructConverter conv(m_struct, target_struct, true);
-    bool rv = conv.convert_2d(m_size.x(), m_size.y(), uint8_data(), target->uint8_data());
-    if (!rv)
+
+    // Large images are converted in parallel by the StructConverter
+    bool success = conv.convert_2d(m_size.x(), m_size.y(), uint8_data(),
+                                   target->uint8_data());
+
+    if (!success)
         Throw("Bitmap::convert(): conversion kernel indicated a failure!");
 }
 
@@ -685,6 +698,10 @@ void Bitmap::read(Stream *stream, FileFormat format) {
     if (format == FileFormat::Auto)
         format = detect_file_format(stream);
 
+    ScopedTraceEvent trace("decode", "Bitmap::read");
+    if (trace.active())
+        trace.set_arg("format", tfm::format("%s", format));
+
     switch (format) {
         case FileFormat::BMP:     read_bmp(stream);   break;
         case FileFormat::JPEG:    read_jpeg(stream);  break;
@@ -697,6 +714,11 @@ void Bitmap::read(Stream *stream, FileFormat format) {
         default:
             Throw("Bitmap: Unknown file format!");
     }
+
+    trace.set_arg("width", width());
+    trace.set_arg("height", height());
+    trace.set_arg("channels", channel_count());
+    trace.set_arg("bytes", buffer_size());
 }
 
 Bitmap::FileFormat Bitmap::detect_file_format(Stream *stream) {
@@ -733,12 +755,84 @@ Bitmap::FileFormat Bitmap::detect_file_format(Stream *stream) {
     return format;
 }
 
-void Bitmap::write(const fs::path &path, FileFormat format, int quality) const {
+void Bitmap::write(const fs::path &path, FileFormat format, int quality,
+                   EXRCompression compression) const {
     ref<FileStream> fs = new FileStream(path, FileStream::ETruncReadWrite);
-    write(fs, format, quality);
+    write(fs, format, quality, compression);
+}
+
+/// Identifies files written by Bitmap::write_raw() ("MIRB")
+static const uint32_t raw_bitmap_magic = 0x4252494d;
+static const uint32_t raw_bitmap_version = 1;
+
+void Bitmap::write_raw(Stream *stream) const {
+    stream->write(raw_bitmap_magic);
+    stream->write(raw_bitmap_version);
+    stream->write((uint32_t) m_pixel_format);
+    stream->write((uint32_t) m_component_format);
+    stream->write((uint32_t) m_size.x());
+    stream->write((uint32_t) m_size.y());
+    stream->write((uint32_t) channel_count());
+    stream->write((uint8_t) m_srgb_gamma);
+    stream->write((uint8_t) m_premultiplied_alpha);
+    for (size_t i = 0; i < channel_count(); ++i)
+        stream->write_string((*m_struct)[i].name);
+
+    // Align the pixels so that they can be accessed in place
+    uint8_t padding[64] = { };
+    stream->write(padding, (64 - stream->tell() % 64) % 64);
+    stream->write(m_data.get(), buffer_size());
+}
+
+ref<Bitmap> Bitmap::map_raw(MemoryMappedFile *mmap) {
+    ref<MemoryStream> stream =
+        new MemoryStream((void *) mmap->data(), mmap->size());
+
+    uint32_t magic, version, pixel_format, component_format, width, height,
+        channels;
+    uint8_t srgb_gamma, premultiplied_alpha;
+    stream->read(magic);
+    stream->read(version);
+    if (magic != raw_bitmap_magic || version != raw_bitmap_version)
+        Throw("Bitmap::map_raw(): \"%s\" is not a raw bitmap!",
+              mmap->filename().string());
+    stream->read(pixel_format);
+    stream->read(component_format);
+    stream->read(width);
+    stream->read(height);
+    stream->read(channels);
+    stream->read(srgb_gamma);
+    stream->read(premultiplied_alpha);
+
+    std::vector<std::string> channel_names(channels);
+    for (uint32_t i = 0; i < channels; ++i)
+        channel_names[i] = stream->read_string();
+
+    size_t offset = (stream->tell() + 63) / 64 * 64;
+    uint8_t *data = (uint8_t *) mmap->data() + offset;
+
+    ref<Bitmap> bitmap = new Bitmap(
+        (PixelFormat) pixel_format, (Struct::Type) component_format,
+        Vector2u(width, height), channels,
+        (PixelFormat) pixel_format == PixelFormat::MultiChannel
+            ? channel_names : std::vector<std::string>(),
+        data);
+
+    if (offset + bitmap->buffer_size() > mmap->size())
+        Throw("Bitmap::map_raw(): \"%s\" is truncated!", mmap->filename().string());
+
+    bitmap->m_srgb_gamma = srgb_gamma != 0;
+    bitmap->m_premultiplied_alpha = premultiplied_alpha != 0;
+    bitmap->rebuild_struct(channels, channel_names);
+    mmap->inc_ref();
+    bitmap->set_data_owner(std::shared_ptr<void>(mmap, [](void *ptr) {
+        ((MemoryMappedFile *) ptr)->dec_ref();
+    }));
+    return bitmap;
 }
 
-void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
+void Bitmap::write(Stream *stream, FileFormat format, int quality,
+                   EXRCompression compression) const {
     auto fs = dynamic_cast<FileStream *>(stream);
 
     if (format == FileFormat::Auto) {
@@ -771,7 +865,7 @@ void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
 
     switch (format) {
         case FileFormat::OpenEXR:
-            write_exr(stream, quality);
+            write_exr(stream, quality, compression);
             break;
 
         case FileFormat::PNG:
@@ -803,10 +897,11 @@ void Bitmap::write(Stream *stream, FileFormat format, int quality) const {
     }
 }
 
-void Bitmap::write_async(const fs::path &path, FileFormat format, int quality) const {
+void Bitmap::write_async(const fs::path &path, FileFormat format, int quality,
+                         EXRCompression compression) const {
     this->inc_ref();
-    Task *task = dr::do_async([path, format, quality, this](){
-        write(path, format, quality);
+    Task *task = dr::do_async([path, format, quality, compression, this](){
+        write(path, format, quality, compression);
         this->dec_ref();
     });
     Thread::register_task(task);
@@ -824,6 +919,10 @@ bool Bitmap::operator==(const Bitmap &bitmap) const {
     return memcmp(uint8_data(), bitmap.uint8_data(), buffer_size()) == 0;
 }
 
+size_t Bitmap::memory_footprint() const {
+    return m_owns_data ? buffer_size() : 0;
+}
+
 std::string Bitmap::to_string() const {
     std::ostringstream oss;
     oss << "Bitmap[" << std::endl
@@ -927,11 +1026,16 @@ public:
     void finish() override { }
 };
 
+/// Number of threads used to encode and decode the scanlines of OpenEXR files
+static int exr_thread_count() {
+    return std::max(1, (int) Thread::thread_count());
+}
+
 void Bitmap::read_exr(Stream *stream) {
     ScopedPhase phase(ProfilerPhase::BitmapRead);
 
     EXRIStream istr(stream);
-    Imf::InputFile file(istr);
+    Imf::InputFile file(istr, exr_thread_count());
 
     const Imf::Header &header = file.header();
     const Imf::ChannelList &channels = header.channels();
@@ -1288,9 +1392,46 @@ void Bitmap::read_exr(Stream *stream) {
     }
 }
 
-void Bitmap::write_exr(Stream *stream, int quality) const {
+/// Map a compression codec to the corresponding OpenEXR enumeration value
+static Imf::Compression exr_compression_codec(Bitmap::EXRCompression compression,
+                                              int quality) {
+    using EXRCompression = Bitmap::EXRCompression;
+
+    switch (compression) {
+        case EXRCompression::Auto:
+            return quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION;
+        case EXRCompression::None:  return Imf::NO_COMPRESSION;
+        case EXRCompression::RLE:   return Imf::RLE_COMPRESSION;
+        case EXRCompression::ZIPS:  return Imf::ZIPS_COMPRESSION;
+        case EXRCompression::ZIP:   return Imf::ZIP_COMPRESSION;
+        case EXRCompression::PIZ:   return Imf::PIZ_COMPRESSION;
+        case EXRCompression::PXR24: return Imf::PXR24_COMPRESSION;
+        case EXRCompression::DWAA:  return Imf::DWAA_COMPRESSION;
+        case EXRCompression::DWAB:  return Imf::DWAB_COMPRESSION;
+        default: Throw("write_exr(): invalid compression codec!");
+    }
+}
+
+/// Map a struct field type to the corresponding OpenEXR pixel type
+static Imf::PixelType exr_pixel_type(Struct::Type type) {
+    switch (type) {
+        case Struct::Type::Float32: return Imf::FLOAT;
+        case Struct::Type::Float16: return Imf::HALF;
+        case Struct::Type::UInt32:  return Imf::UINT;
+        default: Throw("Unexpected field type!");
+    }
+}
+
+void Bitmap::write_exr(Stream *stream, int quality,
+                       EXRCompression compression) const {
     ScopedPhase phase(ProfilerPhase::BitmapWrite);
 
+    Imf::Compression exr_compression =
+        exr_compression_codec(compression, quality);
+
+    bool dwa = exr_compression == Imf::DWAA_COMPRESSION ||
+               exr_compression == Imf::DWAB_COMPRESSION;
+
     PixelFormat pixel_format = m_pixel_format;
 
     Properties metadata(m_metadata);
@@ -1306,10 +1447,10 @@ void Bitmap::write_exr(Stream *stream, int quality) const {
         Imath::V2f(0, 0),  // screenWindowCenter,
         1.f,               // screenWindowWidth
         Imf::INCREASING_Y, // lineOrder
-        quality <= 0 ? Imf::PIZ_COMPRESSION : Imf::DWAB_COMPRESSION // compression
+        exr_compression    // compression
     );
 
-    if (quality > 0)
+    if (dwa && quality > 0)
         Imf::addDwaCompressionLevel(header, float(quality));
 
     for (auto it = keys.begin(); it != keys.end(); ++it) {
@@ -1370,13 +1511,7 @@ void Bitmap::write_exr(Stream *stream, int quality) const {
     Imf::FrameBuffer framebuffer;
     const uint8_t *ptr = uint8_data();
     for (auto field : *m_struct) {
-        Imf::PixelType comp_type;
-        switch (field.type) {
-            case Struct::Type::Float32: comp_type = Imf::FLOAT; break;
-            case Struct::Type::Float16: comp_type = Imf::HALF; break;
-            case Struct::Type::UInt32: comp_type = Imf::UINT; break;
-            default: Throw("Unexpected field type!");
-        }
+        Imf::PixelType comp_type = exr_pixel_type(field.type);
 
         Imf::Slice slice(comp_type, (char *) (ptr + field.offset), pixel_stride, row_stride);
         channels.insert(field.name, Imf::Channel(comp_type));
@@ -1384,7 +1519,7 @@ void Bitmap::write_exr(Stream *stream, int quality) const {
     }
 
     EXROStream ostr(stream);
-    Imf::OutputFile file(ostr, header);
+    Imf::OutputFile file(ostr, header, exr_thread_count());
     file.setFrameBuffer(framebuffer);
     file.writePixels((int) m_size.y());
 }
@@ -2486,6 +2621,22 @@ std::ostream &operator<<(std::ostream &os, Bitmap::FileFormat value) {
     return os;
 }
 
+std::ostream &operator<<(std::ostream &os, Bitmap::EXRCompression value) {
+    switch (value) {
+        case Bitmap::EXRCompression::Auto:  os << "auto";  break;
+        case Bitmap::EXRCompression::None:  os << "none";  break;
+        case Bitmap::EXRCompression::RLE:   os << "rle";   break;
+        case Bitmap::EXRCompression::ZIPS:  os << "zips";  break;
+        case Bitmap::EXRCompression::ZIP:   os << "zip";   break;
+        case Bitmap::EXRCompression::PIZ:   os << "piz";   break;
+        case Bitmap::EXRCompression::PXR24: os << "pxr24"; break;
+        case Bitmap::EXRCompression::DWAA:  os << "dwaa";  break;
+        case Bitmap::EXRCompression::DWAB:  os << "dwab";  break;
+        default: Throw("Unknown EXR compression codec!");
+    }
+    return os;
+}
+
 std::ostream &operator<<(std::ostream &os, Bitmap::AlphaTransform value) {
     switch (value) {
         case Bitmap::AlphaTransform::Empty:    os << "none";    break;
@@ -2505,4 +2656,132 @@ void Bitmap::static_shutdown() { }
 
 MI_IMPLEMENT_CLASS(Bitmap, Object)
 
+// -----------------------------------------------------------------------------
+//   Tiled OpenEXR output
+// -----------------------------------------------------------------------------
+
+struct TiledEXRWriter::TiledEXRWriterPrivate {
+    std::mutex mutex;
+    ref<FileStream> stream;
+    std::unique_ptr<EXROStream> ostr;
+    std::unique_ptr<Imf::TiledOutputFile> file;
+};
+
+TiledEXRWriter::TiledEXRWriter(const fs::path &path,
+                               Bitmap::PixelFormat pixel_format,
+                               const Struct *struct_, const Vector2u &size,
+                               uint32_t tile_size,
+                               Bitmap::EXRCompression compression)
+    : d(new TiledEXRWriterPrivate()), m_path(path), m_struct(struct_),
+      m_size(size), m_tile_size(tile_size) {
+    if (tile_size == 0)
+        Throw("TiledEXRWriter(): the tile size must be positive!");
+    if (dr::any(dr::eq(size, 0u)))
+        Throw("TiledEXRWriter(): the image must not be empty!");
+
+    Imf::Header header(
+        (int) size.x(),    // width
+        (int) size.y(),    // height,
+        1.f,               // pixelAspectRatio
+        Imath::V2f(0, 0),  // screenWindowCenter,
+        1.f,               // screenWindowWidth
+        Imf::RANDOM_Y,     // lineOrder (tiles are stored as they arrive)
+        exr_compression_codec(compression, -1)
+    );
+
+    header.insert("generatedBy",
+                  Imf::StringAttribute("Mitsuba version " MI_VERSION));
+    header.setTileDescription(
+        Imf::TileDescription(tile_size, tile_size, Imf::ONE_LEVEL));
+
+    if (pixel_format == Bitmap::PixelFormat::XYZ ||
+        pixel_format == Bitmap::PixelFormat::XYZA) {
+        Imf::addChromaticities(header, Imf::Chromaticities(
+            Imath::V2f(1.f, 0.f),
+            Imath::V2f(0.f, 1.f),
+            Imath::V2f(0.f, 0.f),
+            Imath::V2f(1.f / 3.f, 1.f / 3.f)));
+    }
+
+    Imf::ChannelList &channels = header.channels();
+    for (auto field : *m_struct)
+        channels.insert(field.name, Imf::Channel(exr_pixel_type(field.type)));
+
+    d->stream = new FileStream(path, FileStream::ETruncReadWrite);
+    d->ostr.reset(new EXROStream(d->stream));
+    d->file.reset(new Imf::TiledOutputFile(*d->ostr, header, exr_thread_count()));
+}
+
+TiledEXRWriter::~TiledEXRWriter() {
+    close();
+}
+
+void TiledEXRWriter::write_tile(const Point2u &tile, const Bitmap *bitmap) {
+    ScopedPhase phase(ProfilerPhase::BitmapWrite);
+
+    Vector2u offset = tile * m_tile_size,
+             expected = dr::minimum(m_size - offset, m_tile_size);
+
+    if (dr::any(tile >= tile_count()))
+        Throw("TiledEXRWriter::write_tile(): tile index %s is out of bounds!", tile);
+    if (bitmap->size() != expected)
+        Throw("TiledEXRWriter::write_tile(): expected a bitmap of size %s, got %s!",
+              expected, bitmap->size());
+
+    const Struct *layout = bitmap->struct_();
+    bool compatible = layout->field_count() == m_struct->field_count();
+    for (size_t i = 0; compatible && i < layout->field_count(); ++i)
+        compatible = (*layout)[i].name == (*m_struct)[i].name &&
+                     (*layout)[i].type == (*m_struct)[i].type;
+    if (!compatible)
+        Throw("TiledEXRWriter::write_tile(): the bitmap does not match the "
+              "channel layout of the file!");
+
+    size_t pixel_stride = layout->size(),
+           row_stride = pixel_stride * bitmap->width();
+
+    /* OpenEXR addresses pixels by their absolute image coordinates, shift
+       the base pointer accordingly */
+    const char *base = (const char *) bitmap->uint8_data() -
+                       offset.x() * pixel_stride - offset.y() * row_stride;
+
+    Imf::FrameBuffer framebuffer;
+    for (auto field : *layout)
+        framebuffer.insert(field.name,
+                           Imf::Slice(exr_pixel_type(field.type),
+                                      (char *) (base + field.offset),
+                                      pixel_stride, row_stride));
+
+    std::lock_guard<std::mutex> guard(d->mutex);
+    if (!d->file)
+        Throw("TiledEXRWriter::write_tile(): the file was already closed!");
+    d->file->setFrameBuffer(framebuffer);
+    d->file->writeTile((int) tile.x(), (int) tile.y());
+    m_tiles_written++;
+}
+
+void TiledEXRWriter::close() {
+    std::lock_guard<std::mutex> guard(d->mutex);
+    d->file.reset();
+    d->ostr.reset();
+    if (d->stream) {
+        d->stream->close();
+        d->stream = nullptr;
+    }
+}
+
+std::string TiledEXRWriter::to_string() const {
+    std::ostringstream oss;
+    oss << "TiledEXRWriter[" << std::endl
+        << "  path = \"" << m_path.string() << "\"," << std::endl
+        << "  size = " << m_size << "," << std::endl
+        << "  tile_size = " << m_tile_size << "," << std::endl
+        << "  tiles_written = " << m_tiles_written << "," << std::endl
+        << "  struct = " << string::indent(m_struct) << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS(TiledEXRWriter, Object)
+
 NAMESPACE_END(mitsuba)
@@ -7,13 +7,18 @@
 #include <codecvt>
 #include <cstdlib>
 #include <cstring>
+#include <iomanip>
 #include <locale>
 #include <stdexcept>
 #include <sstream>
+#include <thread>
 
 #if defined(_WIN32)
 #  include <windows.h>
+#  include <process.h>
+#  define getpid _getpid
 #else
+#  include <dirent.h>
 #  include <unistd.h>
 #  include <sys/stat.h>
 #endif
@@ -133,6 +138,25 @@ size_t file_size(const path& p) {
     return (size_t) sb.st_size;
 }
 
+int64_t last_write_time(const path& p) {
+#if defined(_WIN32)
+    struct _stati64 sb;
+    if (_wstati64(p.native().c_str(), &sb) != 0)
+        throw std::runtime_error("filesystem::last_write_time(): cannot stat file \"" + p.string() + "\"!");
+#else
+    struct stat sb;
+    if (stat(p.native().c_str(), &sb) != 0)
+        throw std::runtime_error("filesystem::last_write_time(): cannot stat file \"" + p.string() + "\"!");
+#endif
+#if defined(__APPLE__)
+    return (int64_t) sb.st_mtimespec.tv_sec * 1000000000 + (int64_t) sb.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+    return (int64_t) sb.st_mtim.tv_sec * 1000000000 + (int64_t) sb.st_mtim.tv_nsec;
+#else
+    return (int64_t) sb.st_mtime * 1000000000;
+#endif
+}
+
 bool equivalent(const path& p1, const path& p2) {
 #if defined(_WIN32)
     struct _stati64 sb1, sb2;
@@ -151,6 +175,32 @@ bool equivalent(const path& p1, const path& p2) {
     return (sb1.st_dev == sb2.st_dev) && (sb1.st_ino == sb2.st_ino);
 }
 
+bool directory_entries(const path& p, std::vector<string_type> &names) {
+#if defined(_WIN32)
+    WIN32_FIND_DATAW data;
+    HANDLE handle = FindFirstFileW((p / NSTR("*")).native().c_str(), &data);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    do {
+        string_type name = data.cFileName;
+        if (name != NSTR(".") && name != NSTR(".."))
+            names.push_back(std::move(name));
+    } while (FindNextFileW(handle, &data));
+    FindClose(handle);
+    return true;
+#else
+    DIR *dir = opendir(p.native().c_str());
+    if (!dir)
+        return false;
+    while (struct dirent *entry = readdir(dir)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0)
+            names.emplace_back(entry->d_name);
+    }
+    closedir(dir);
+    return true;
+#endif
+}
+
 bool create_directory(const path& p) noexcept {
     if (exists(p))
         return is_directory(p);
@@ -205,6 +255,34 @@ bool rename(const path& src, const path &dst) {
 #endif
 }
 
+void write_atomic(const path &p, const std::function<void(const path &)> &write) {
+    /* The name of the temporary file is unique to the calling thread and
+       process, so that concurrent writers never share a temporary file */
+    size_t id = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+                ((size_t) getpid() * 0x9e3779b97f4a7c15ull);
+    std::ostringstream oss;
+    oss << p.filename().string() << "." << std::hex << std::setw(16)
+        << std::setfill('0') << (unsigned long long) id << ".tmp";
+    path tmp = p.parent_path() / path(oss.str());
+
+    try {
+        write(tmp);
+#if !defined(_WIN32)
+        bool success = std::rename(tmp.native().c_str(), p.native().c_str()) == 0;
+#else
+        bool success = MoveFileExW(tmp.native().c_str(), p.native().c_str(),
+                                   MOVEFILE_REPLACE_EXISTING) != 0;
+#endif
+        if (!success)
+            throw std::runtime_error("filesystem::write_atomic(): cannot rename \"" +
+                                     tmp.string() + "\" to \"" + p.string() + "\"!");
+    } catch (...) {
+        if (exists(tmp))
+            remove(tmp);
+        throw;
+    }
+}
+
 // -----------------------------------------------------------------------------
 
 fs::path path::extension() const {
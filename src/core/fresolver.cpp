@@ -1,6 +1,8 @@
 #include <mitsuba/core/fresolver.h>
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <cwctype>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -12,6 +14,7 @@ FileResolver::FileResolver(const FileResolver &fr)
   : Object(), m_paths(fr.m_paths) { }
 
 void FileResolver::erase(const fs::path &p) {
+    clear_cache();
     m_paths.erase(std::remove(m_paths.begin(), m_paths.end(), p), m_paths.end());
 }
 
@@ -23,13 +26,77 @@ fs::path FileResolver::resolve(const fs::path &path) const {
     if (!path.is_absolute()) {
         for (auto const &base : m_paths) {
             fs::path combined = base / path;
-            if (fs::exists(combined))
+            if (exists_cached(combined))
                 return combined;
         }
     }
     return path;
 }
 
+/// Key of a file name in a directory listing
+static fs::string_type listing_key(fs::string_type name) {
+    // These platforms commonly use case-insensitive file systems
+#if defined(_WIN32)
+    for (auto &c : name)
+        c = (wchar_t) std::towlower(c);
+#elif defined(__APPLE__)
+    for (auto &c : name)
+        c = (char) std::tolower((unsigned char) c);
+#endif
+    return name;
+}
+
+bool FileResolver::exists_cached(const fs::path &path) const {
+    fs::string_type name = path.filename().native();
+    if (name.empty() || name == fs::path(".").native() || name == fs::path("..").native())
+        return fs::exists(path);
+
+    fs::path dir = path.parent_path();
+    if (dir.empty() && !dir.is_absolute())
+        dir = fs::path(".");
+    fs::string_type key = dir.native();
+
+    std::unique_lock<std::mutex> guard(m_cache_mutex);
+    auto it = m_cache.find(key);
+    if (it == m_cache.end()) {
+        // List the directory without blocking lookups of other threads
+        guard.unlock();
+        Listing listing;
+        std::vector<fs::string_type> names;
+        if (fs::directory_entries(dir, names)) {
+            listing.valid = true;
+            for (auto &n : names)
+                listing.names.insert(listing_key(std::move(n)));
+        } else {
+            // Nonexistent directories contain no files, others are queried
+            listing.valid = !fs::is_directory(dir);
+        }
+        guard.lock();
+        it = m_cache.emplace(std::move(key), std::move(listing)).first;
+    }
+
+    if (!it->second.valid) {
+        guard.unlock();
+        return fs::exists(path);
+    }
+
+    bool found = it->second.names.count(listing_key(std::move(name))) != 0;
+    guard.unlock();
+
+    // Confirm hits, e.g. in case of dangling symbolic links
+    return found && fs::exists(path);
+}
+
+void FileResolver::clear_cache() {
+    std::lock_guard<std::mutex> guard(m_cache_mutex);
+    m_cache.clear();
+}
+
+size_t FileResolver::cache_size() const {
+    std::lock_guard<std::mutex> guard(m_cache_mutex);
+    return m_cache.size();
+}
+
 std::string FileResolver::to_string() const {
     std::ostringstream oss;
     oss << "FileResolver[" << std::endl;
@@ -1,6 +1,7 @@
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/tracer.h>
 #include <sstream>
 #include <fstream>
 
@@ -25,7 +26,9 @@ inline std::ios::openmode ios_flag(FileStream::EMode mode) {
 NAMESPACE_END(detail)
 
 FileStream::FileStream(const fs::path &p, EMode mode)
-    : Stream(), m_mode(mode), m_path(p), m_file(new std::fstream) {
+    : Stream(), m_mode(mode), m_path(p), m_file(new std::fstream),
+      m_bytes_read(0), m_bytes_written(0),
+      m_trace_start(TraceRecorder::running() ? TraceRecorder::timestamp() : -1.0) {
 
     m_file->open(p.string(), detail::ios_flag(mode));
 
@@ -39,6 +42,14 @@ FileStream::~FileStream() {
 }
 
 void FileStream::close() {
+    if (m_trace_start >= 0.0 && m_file->is_open()) {
+        TraceRecorder::add_event(
+            "io", m_path.filename().string(), m_trace_start,
+            TraceRecorder::timestamp() - m_trace_start,
+            tfm::format("\"bytes_read\": %zu, \"bytes_written\": %zu",
+                        m_bytes_read, m_bytes_written));
+        m_trace_start = -1.0;
+    }
     m_file->close();
 };
 
@@ -48,6 +59,7 @@ bool FileStream::is_closed() const {
 
 void FileStream::read(void *p, size_t size) {
     m_file->read((char *) p, size);
+    m_bytes_read += (size_t) m_file->gcount();
 
     if (unlikely(!m_file->good())) {
         bool eof = m_file->eof();
@@ -64,6 +76,7 @@ void FileStream::read(void *p, size_t size) {
 
 void FileStream::write(const void *p, size_t size) {
     m_file->write((char *) p, size);
+    m_bytes_written += size;
 
     if (unlikely(!m_file->good())) {
         m_file->clear();
@@ -133,6 +146,7 @@ std::string FileStream::read_line() {
     if (!std::getline(*m_file, result))
         Log(Error, "\"%s\": I/O error while attempting to read a line of text: %s", m_path.string(),
             strerror(errno));
+    m_bytes_read += (size_t) m_file->gcount();
     return result;
 }
 
@@ -7,21 +7,210 @@
 #include <thread>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Log or progress message that is queued in asynchronous mode
+struct LogEntry {
+    LogLevel level = Info;
+    std::string text;
+
+    // Fields of progress messages
+    bool progress = false;
+    float value = 0.f;
+    std::string name, eta;
+    const void *ptr = nullptr;
+};
+
+/**
+ * \brief Lock-free ring buffer of the messages of one thread
+ *
+ * Only the owning thread pushes messages, and only one thread at a time
+ * (guarded by <tt>LoggerPrivate::drain_mutex</tt>) pops them.
+ */
+struct LogBuffer {
+    static constexpr size_t Size = 1024;
+
+    LogEntry entries[Size];
+    std::atomic<size_t> head { 0 }, tail { 0 };
+
+    /// Set when the owning thread has exited
+    std::atomic<bool> closed { false };
+
+    bool push(LogEntry &entry) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == Size)
+            return false;
+        entries[t % Size] = std::move(entry);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(LogEntry &entry) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        entry = std::move(entries[h % Size]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) -
+               head.load(std::memory_order_acquire);
+    }
+};
+
+/// Buffers of the current thread, indexed by the unique ID of their logger
+struct ThreadLogBuffers {
+    std::vector<std::pair<uint64_t, std::shared_ptr<LogBuffer>>> buffers;
+
+    ~ThreadLogBuffers() {
+        for (auto &[id, buffer] : buffers)
+            buffer->closed = true;
+    }
+};
+
+static thread_local ThreadLogBuffers thread_log_buffers;
+static std::atomic<uint64_t> logger_counter { 0 };
+
 struct Logger::LoggerPrivate {
     std::mutex mutex;
     LogLevel error_level = Error;
     std::vector<ref<Appender>> appenders;
     ref<Formatter> formatter;
+
+    // Asynchronous mode
+    uint64_t id = logger_counter++;
+    std::atomic<bool> async { false };
+    std::mutex async_mutex;
+    std::mutex buffers_mutex;
+    std::vector<std::shared_ptr<LogBuffer>> buffers;
+    std::mutex drain_mutex;
+    std::thread flusher;
+    std::mutex flusher_mutex;
+    std::condition_variable flusher_cv;
+    bool flusher_stop = false;
+
+    /// Return the buffer of the current thread (creating it if needed)
+    LogBuffer *thread_buffer() {
+        auto &entries = thread_log_buffers.buffers;
+        for (auto &[id_, buffer] : entries) {
+            if (id_ == id)
+                return buffer.get();
+        }
+
+        // Drop the buffers of loggers that no longer exist
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](const auto &e) { return e.second.use_count() == 1; }),
+                      entries.end());
+
+        auto buffer = std::make_shared<LogBuffer>();
+        {
+            std::lock_guard<std::mutex> guard(buffers_mutex);
+            buffers.push_back(buffer);
+        }
+        entries.emplace_back(id, buffer);
+        return buffer.get();
+    }
+
+    /// Queue a message (waits for the flusher thread if the buffer is full)
+    void enqueue(LogEntry &entry) {
+        LogBuffer *buffer = thread_buffer();
+        bool urgent = entry.progress || entry.level >= Warn;
+
+        while (!buffer->push(entry)) {
+            flusher_cv.notify_one();
+            std::this_thread::yield();
+        }
+
+        if (urgent || buffer->size() > LogBuffer::Size / 2)
+            flusher_cv.notify_one();
+    }
+
+    /// Forward all queued messages to the appenders
+    void drain() {
+        std::lock_guard<std::mutex> drain_guard(drain_mutex);
+
+        std::vector<std::shared_ptr<LogBuffer>> pending;
+        {
+            std::lock_guard<std::mutex> guard(buffers_mutex);
+            pending = buffers;
+
+            // Buffers of exited threads receive no further messages
+            buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+                                         [](const auto &b) { return b->closed && b->size() == 0; }),
+                          buffers.end());
+        }
+
+        LogEntry entry;
+        for (auto &buffer : pending) {
+            if (buffer->size() == 0)
+                continue;
+            std::lock_guard<std::mutex> guard(mutex);
+            while (buffer->pop(entry)) {
+                for (auto &appender : appenders) {
+                    if (entry.progress)
+                        appender->log_progress(entry.value, entry.name, entry.text,
+                                               entry.eta, entry.ptr);
+                    else
+                        appender->append(entry.level, entry.text);
+                }
+            }
+        }
+    }
+
+    /// Main loop of the flusher thread
+    void run() {
+        std::unique_lock<std::mutex> lock(flusher_mutex);
+        while (!flusher_stop) {
+            flusher_cv.wait_for(lock, std::chrono::milliseconds(10));
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    }
 };
 
 Logger::Logger(LogLevel log_level)
     : m_log_level(log_level), d(new LoggerPrivate()) { }
 
-Logger::~Logger() { }
+Logger::~Logger() {
+    set_async(false);
+}
+
+void Logger::set_async(bool value) {
+    std::lock_guard<std::mutex> guard(d->async_mutex);
+    if (value == d->async)
+        return;
+
+    if (value) {
+        d->flusher_stop = false;
+        d->flusher = std::thread([p = d.get()]() { p->run(); });
+        d->async = true;
+    } else {
+        d->async = false;
+        {
+            std::lock_guard<std::mutex> guard2(d->flusher_mutex);
+            d->flusher_stop = true;
+        }
+        d->flusher_cv.notify_one();
+        d->flusher.join();
+        d->drain();
+    }
+}
+
+bool Logger::is_async() const {
+    return d->async;
+}
+
+void Logger::flush() {
+    d->drain();
+}
 
 void Logger::set_formatter(Formatter *formatter) {
     std::lock_guard<std::mutex> guard(d->mutex);
@@ -68,6 +257,14 @@ void Logger::log(LogLevel level, const Class *class_, const char *file,
     std::string text = d->formatter->format(level, class_,
         Thread::thread(), file, line, msg);
 
+    if (d->async) {
+        LogEntry entry;
+        entry.level = level;
+        entry.text = std::move(text);
+        d->enqueue(entry);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(d->mutex);
     for (auto entry : d->appenders)
         entry->append(level, text);
@@ -75,6 +272,18 @@ void Logger::log(LogLevel level, const Class *class_, const char *file,
 
 void Logger::log_progress(float progress, const std::string &name,
     const std::string &formatted, const std::string &eta, const void *ptr) {
+    if (d->async) {
+        LogEntry entry;
+        entry.progress = true;
+        entry.value = progress;
+        entry.name = name;
+        entry.text = formatted;
+        entry.eta = eta;
+        entry.ptr = ptr;
+        d->enqueue(entry);
+        return;
+    }
+
     std::lock_guard<std::mutex> guard(d->mutex);
     for (auto entry : d->appenders)
         entry->log_progress(progress, name, formatted, eta, ptr);
@@ -92,6 +301,7 @@ void Logger::remove_appender(Appender *appender) {
 }
 
 std::string Logger::read_log() {
+    flush();
     std::lock_guard<std::mutex> guard(d->mutex);
     for (auto appender: d->appenders) {
         if (appender->class_()->derives_from(MI_CLASS(StreamAppender))) {
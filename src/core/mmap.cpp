@@ -1,4 +1,5 @@
 #include <mitsuba/core/mmap.h>
+#include <mitsuba/core/tracer.h>
 #include <mitsuba/core/util.h>
 
 #if defined(__linux__) || defined(__APPLE__)
@@ -220,8 +221,10 @@ MemoryMappedFile::MemoryMappedFile(const fs::path &filename, size_t size)
 
 MemoryMappedFile::MemoryMappedFile(const fs::path &filename, bool write)
     : d(new MemoryMappedFilePrivate(filename)) {
+    ScopedTraceEvent trace("io", filename.filename().string());
     d->can_write = write;
     d->map();
+    trace.set_arg("bytes_mapped", d->size);
     Log(Trace, "Mapped \"%s\" into memory (%s)..",
         filename.filename().string(), util::mem_string(d->size));
 }
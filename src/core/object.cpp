@@ -6,11 +6,13 @@
 NAMESPACE_BEGIN(mitsuba)
 
 void Object::dec_ref(bool dealloc) const noexcept {
-    uint32_t ref_count = m_ref_count.fetch_sub(1);
+    uint32_t ref_count = m_ref_count.fetch_sub(1, std::memory_order_release);
     if (ref_count <= 0) {
         fprintf(stderr, "Internal error: Object reference count < 0!\n");
         abort();
     } else if (ref_count == 1 && dealloc) {
+        // Make the writes of other threads to the object visible
+        std::atomic_thread_fence(std::memory_order_acquire);
         delete this;
     }
 }
@@ -23,6 +25,8 @@ void Object::traverse(TraversalCallback * /*callback*/) { }
 
 void Object::parameters_changed(const std::vector<std::string> &/*keys*/) { }
 
+size_t Object::memory_footprint() const { return 0; }
+
 std::string Object::id() const { return std::string(); }
 
 void Object::set_id(const std::string&/*id*/) { }
@@ -4,6 +4,9 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/tracer.h>
+#include <nanothread/nanothread.h>
+#include <future>
 #include <mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -86,18 +89,13 @@ private:
 };
 
 struct PluginManager::PluginManagerPrivate {
-    std::unordered_map<std::string, Plugin *> m_plugins;
+    std::unordered_map<std::string, std::shared_future<Plugin *>> m_plugins;
     std::unordered_set<std::string> m_python_plugins;
     std::mutex m_mutex;
+    std::mutex m_init_mutex;
 
-    Plugin *plugin(const std::string &name) {
-        std::lock_guard<std::mutex> guard(m_mutex);
-
-        // Plugin already loaded?
-        auto it = m_plugins.find(name);
-        if (it != m_plugins.end())
-            return it->second;
-
+    /// Look up the shared library of a plugin using the current file resolver
+    fs::path resolve(const std::string &name) {
         // Build the full plugin file name
         fs::path filename = fs::path("plugins") / name;
 
@@ -110,20 +108,72 @@ struct PluginManager::PluginManagerPrivate {
         #endif
 
         const FileResolver *resolver = Thread::thread()->file_resolver();
-        fs::path resolved = resolver->resolve(filename);
-
-        if (fs::exists(resolved)) {
-            Log(Debug, "Loading plugin \"%s\" ..", filename.string());
-            Plugin *plugin = new Plugin(resolved);
-            // New classes must be registered within the class hierarchy
-            Class::static_initialization();
-            // Statistics::instance()->log_plugin(shortName, description()); XXX
-            m_plugins[name] = plugin;
-            return plugin;
+        return resolver->resolve(filename);
+    }
+
+    bool is_loaded(const std::string &name) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        return m_plugins.find(name) != m_plugins.end();
+    }
+
+    /**
+     * \brief Return a plugin, loading it if necessary
+     *
+     * The mutex is only held while looking up the plugin, so that threads
+     * requesting different plugins (or plugins that were already loaded) are
+     * not blocked by a slow load. Concurrent requests for a plugin that is
+     * being loaded wait for the result. The optional \c resolved argument
+     * specifies the path of the shared library when it was already resolved,
+     * e.g. by the thread that invoked \ref PluginManager::preload().
+     */
+    Plugin *plugin(const std::string &name, const fs::path *resolved = nullptr) {
+        std::promise<Plugin *> promise;
+        std::shared_future<Plugin *> future;
+        bool load = false;
+
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+
+            // Plugin already loaded (or being loaded by another thread)?
+            auto it = m_plugins.find(name);
+            if (it != m_plugins.end()) {
+                future = it->second;
+            } else {
+                future = promise.get_future().share();
+                m_plugins.emplace(name, future);
+                load = true;
+            }
         }
 
-        // Plugin not found!
-        Throw("Plugin \"%s\" not found!", name.c_str());
+        if (load) {
+            try {
+                fs::path path = resolved ? *resolved : resolve(name);
+
+                // Plugin not found!
+                if (!fs::exists(path))
+                    Throw("Plugin \"%s\" not found!", name.c_str());
+
+                Log(Debug, "Loading plugin \"%s\" ..", path.filename().string());
+                ScopedTraceEvent trace("plugin", name);
+                Plugin *plugin = new Plugin(path);
+
+                // New classes must be registered within the class hierarchy
+                {
+                    std::lock_guard<std::mutex> guard(m_init_mutex);
+                    Class::static_initialization();
+                }
+                // Statistics::instance()->log_plugin(shortName, description()); XXX
+                promise.set_value(plugin);
+            } catch (...) {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_plugins.erase(name);
+                }
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+        return future.get();
     }
 };
 
@@ -133,14 +183,52 @@ PluginManager::PluginManager() : d(new PluginManagerPrivate()) { }
 
 PluginManager::~PluginManager() {
     std::lock_guard<std::mutex> guard(d->m_mutex);
-    for (auto &pair: d->m_plugins)
-        delete pair.second;
+    for (auto &pair: d->m_plugins) {
+        if (pair.second.wait_for(std::chrono::seconds(0)) ==
+            std::future_status::ready)
+            delete pair.second.get();
+    }
 }
 
 void PluginManager::ensure_plugin_loaded(const std::string &name) {
     (void) d->plugin(name);
 }
 
+void PluginManager::preload(const std::vector<std::string> &names) {
+    // Resolve the plugins here, since file resolvers are specific to a thread
+    std::vector<std::pair<std::string, fs::path>> todo;
+    std::unordered_set<std::string> seen;
+    for (const std::string &name : names) {
+        if (name.empty() || !seen.insert(name).second || d->is_loaded(name))
+            continue;
+        fs::path resolved = d->resolve(name);
+        // Python plugins and typos are reported when the object is created
+        if (fs::exists(resolved))
+            todo.emplace_back(name, resolved);
+    }
+
+    if (todo.empty())
+        return;
+
+    ScopedTraceEvent trace("plugin", "Preload plugins");
+    if (trace.active())
+        trace.set_arg("count", todo.size());
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, todo.size(), 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                try {
+                    (void) d->plugin(todo[i].first, &todo[i].second);
+                } catch (const std::exception &e) {
+                    Log(Warn, "Could not preload plugin \"%s\": %s",
+                        todo[i].first, e.what());
+                }
+            }
+        }
+    );
+}
+
 const Class *PluginManager::get_plugin_class(const std::string &name,
                                              const std::string &variant) {
     const Class *plugin_class;
@@ -160,20 +248,33 @@ const Class *PluginManager::get_plugin_class(const std::string &name,
 std::vector<std::string> PluginManager::loaded_plugins() const {
     std::vector<std::string> list;
     std::lock_guard<std::mutex> guard(d->m_mutex);
-    for (auto const &pair: d->m_plugins)
-        list.push_back(pair.first);
+    for (auto const &pair: d->m_plugins) {
+        // Skip plugins that are still being loaded
+        if (pair.second.wait_for(std::chrono::seconds(0)) ==
+            std::future_status::ready)
+            list.push_back(pair.first);
+    }
     return list;
 }
 
 void PluginManager::register_python_plugin(const std::string &plugin_name,
                                            const std::string &variant) {
     d->m_python_plugins.insert(plugin_name + "@" + variant);
+    std::lock_guard<std::mutex> guard(d->m_init_mutex);
     Class::static_initialization();
 }
 
 ref<Object> PluginManager::create_object(const Properties &props,
                                          const Class *class_) {
     Assert(class_ != nullptr);
+
+    ScopedTraceEvent trace("instantiate",
+                           props.id().empty() ? props.plugin_name() : props.id());
+    if (trace.active()) {
+        trace.set_arg("plugin", props.plugin_name());
+        trace.set_arg("class", class_->name());
+    }
+
     if (class_->name() == "Scene")
        return class_->construct(props);
 
@@ -189,8 +290,10 @@ ref<Object> PluginManager::create_object(const Properties &props,
 #if defined(MI_ENABLE_LLVM) || defined(MI_ENABLE_CUDA)
     // Ensures queued side effects are consistently compiled into cacheable kernels
     if (string::starts_with(variant, "cuda_") ||
-        string::starts_with(variant, "llvm_"))
+        string::starts_with(variant, "llvm_")) {
+        ScopedTraceEvent trace_eval("jit", "dr::eval()");
         dr::eval();
+    }
 #endif
 
     if (!object->class_()->derives_from(class_)) {
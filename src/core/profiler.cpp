@@ -1,6 +1,14 @@
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/util.h>
+#include <atomic>
+#include <cstring>
+#include <sstream>
+
+#if defined(MI_ENABLE_PROFILER)
+#  include <csignal>
+#  include <sys/time.h>
+#endif
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -10,6 +18,58 @@ __itt_string_handle *
     mitsuba_itt_phase[int(ProfilerPhase::ProfilerPhaseCount)] { };
 #endif
 
+#if defined(MI_ENABLE_PROFILER)
+thread_local uint64_t profiler_flags = 0;
+
+/* Histogram of the observed sets of active phases. The signal handler may
+   only use lock-free operations, hence this is an open addressing hash table
+   with linear probing whose keys are claimed via compare-and-swap. */
+static constexpr size_t profiler_table_size = 4096;
+static constexpr uint64_t profiler_key_used = uint64_t(1) << 63;
+
+struct ProfilerEntry {
+    std::atomic<uint64_t> key;
+    std::atomic<uint64_t> count;
+};
+
+static ProfilerEntry profiler_table[profiler_table_size];
+static std::atomic<uint64_t> profiler_samples { 0 };
+static std::atomic<uint64_t> profiler_dropped { 0 };
+static std::atomic<bool> profiler_running { false };
+static float profiler_interval = 1.f;
+
+static void profiler_signal_handler(int) {
+    uint64_t key = profiler_flags | profiler_key_used,
+             index = (key * 0x9E3779B97F4A7C15ull) >> 52;
+
+    for (size_t i = 0; i < profiler_table_size; ++i) {
+        ProfilerEntry &entry = profiler_table[(index + i) % profiler_table_size];
+        uint64_t current = entry.key.load(std::memory_order_relaxed);
+        if (current == 0 &&
+            entry.key.compare_exchange_strong(current, key,
+                                              std::memory_order_relaxed))
+            current = key;
+        if (current == key) {
+            entry.count.fetch_add(1, std::memory_order_relaxed);
+            profiler_samples.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    profiler_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void profiler_set_timer(float interval) {
+    long usec = (long) (interval * 1000.f);
+    itimerval timer;
+    timer.it_interval.tv_sec  = usec / 1000000;
+    timer.it_interval.tv_usec = usec % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0)
+        Throw("Profiler: could not configure the profiling timer!");
+}
+#endif
+
 void Profiler::static_initialization() {
 #if defined(MI_ENABLE_ITTNOTIFY)
     mitsuba_itt_domain = __itt_domain_create("mitsuba");
@@ -18,6 +78,155 @@ void Profiler::static_initialization() {
 #endif
 }
 
-void Profiler::static_shutdown() { }
+void Profiler::static_shutdown() {
+    stop();
+}
+
+bool Profiler::enabled() {
+#if defined(MI_ENABLE_PROFILER)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Profiler::start(float interval) {
+#if defined(MI_ENABLE_PROFILER)
+    if (!(interval > 0.f))
+        Throw("Profiler: the sampling interval must be positive!");
+    if (profiler_running)
+        return;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = profiler_signal_handler;
+    sa.sa_flags = SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGPROF, &sa, nullptr) != 0)
+        Throw("Profiler: could not install the SIGPROF signal handler!");
+
+    profiler_interval = interval;
+    profiler_set_timer(interval);
+    profiler_running = true;
+#else
+    (void) interval;
+    Log(Warn, "Profiler: not available, Mitsuba was compiled without the "
+              "MI_PROFILER_SAMPLING option.");
+#endif
+}
+
+void Profiler::stop() {
+#if defined(MI_ENABLE_PROFILER)
+    if (!profiler_running)
+        return;
+    profiler_set_timer(0.f);
+    /* Keep the handler in place: a signal that is already pending would
+       otherwise terminate the process */
+    profiler_running = false;
+#endif
+}
+
+bool Profiler::running() {
+#if defined(MI_ENABLE_PROFILER)
+    return profiler_running;
+#else
+    return false;
+#endif
+}
+
+void Profiler::reset() {
+#if defined(MI_ENABLE_PROFILER)
+    for (ProfilerEntry &entry : profiler_table) {
+        entry.key = 0;
+        entry.count = 0;
+    }
+    profiler_samples = 0;
+    profiler_dropped = 0;
+#endif
+}
+
+size_t Profiler::sample_count() {
+#if defined(MI_ENABLE_PROFILER)
+    return (size_t) profiler_samples;
+#else
+    return 0;
+#endif
+}
+
+std::string Profiler::report(bool json) {
+    constexpr int n_phases = (int) ProfilerPhase::ProfilerPhaseCount;
+    uint64_t inclusive[n_phases] { }, exclusive[n_phases] { }, idle = 0,
+             total = 0, dropped = 0;
+    float interval = 0.f;
+
+#if defined(MI_ENABLE_PROFILER)
+    /* Due to the partial order of the phases, the highest active phase is the
+       innermost one, which receives the exclusive time */
+    for (const ProfilerEntry &entry : profiler_table) {
+        uint64_t key = entry.key, count = entry.count;
+        if (key == 0 || count == 0)
+            continue;
+        uint64_t flags = key & ~profiler_key_used;
+        total += count;
+        if (flags == 0) {
+            idle += count;
+            continue;
+        }
+        for (int i = 0; i < n_phases; ++i) {
+            if (flags & (uint64_t(1) << i))
+                inclusive[i] += count;
+        }
+        exclusive[63 - __builtin_clzll(flags)] += count;
+    }
+    dropped = profiler_dropped;
+    interval = profiler_interval;
+#endif
+
+    auto percent = [total](uint64_t count) {
+        return total > 0 ? 100.0 * (double) count / (double) total : 0.0;
+    };
+
+    std::ostringstream oss;
+    if (json) {
+        oss << "{" << std::endl
+            << "  \"samples\": " << total << "," << std::endl
+            << "  \"dropped\": " << dropped << "," << std::endl
+            << "  \"interval_ms\": " << interval << "," << std::endl
+            << "  \"untracked\": " << percent(idle) << "," << std::endl
+            << "  \"phases\": [";
+        bool first = true;
+        for (int i = 0; i < n_phases; ++i) {
+            if (inclusive[i] == 0)
+                continue;
+            oss << (first ? "" : ",") << std::endl
+                << "    { \"name\": \"" << profiler_phase_id[i] << "\", "
+                << "\"inclusive\": " << percent(inclusive[i]) << ", "
+                << "\"exclusive\": " << percent(exclusive[i]) << " }";
+            first = false;
+        }
+        oss << std::endl << "  ]" << std::endl << "}";
+        return oss.str();
+    }
+
+    oss << "Profiler report (" << total << " samples";
+    if (total > 0)
+        oss << ", ~" << util::time_string(interval * (float) total)
+            << " of CPU time";
+    oss << "):" << std::endl
+        << "    Inclusive  Exclusive  Phase" << std::endl;
+    for (int i = 0; i < n_phases; ++i) {
+        if (inclusive[i] == 0)
+            continue;
+        oss << tfm::format("    %8.2f%%  %8.2f%%  %s", percent(inclusive[i]),
+                           percent(exclusive[i]), profiler_phase_id[i])
+            << std::endl;
+    }
+    oss << tfm::format("               %8.2f%%  (not in a phase)",
+                       percent(idle));
+    if (dropped > 0)
+        oss << std::endl
+            << "    " << dropped << " samples were dropped (table is full).";
+    return oss.str();
+}
 
 NAMESPACE_END(mitsuba)
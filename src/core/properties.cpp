@@ -5,7 +5,8 @@
 
 #include <cstdlib>
 #include <iostream>
-#include <map>
+#include <algorithm>
+#include <functional>
 #include <sstream>
 #include <cstring>
 
@@ -35,6 +36,8 @@ using VariantType = variant<
 >;
 
 struct alignas(32) Entry {
+    std::string name;
+    size_t hash;
     VariantType data;
     bool queried;
 };
@@ -64,109 +67,198 @@ struct SortKey {
     }
 };
 
+/* Plugins are typically constructed from a handful of properties, which are
+   found faster by a linear scan over the (pre-hashed) entries than through
+   any tree or hash table. Larger property lists (e.g. scenes with millions
+   of children) additionally maintain a hash table of entry indices. */
+static constexpr size_t PropertiesIndexThreshold = 16;
+static constexpr uint32_t PropertiesIndexEmpty = (uint32_t) -1;
+
 struct Properties::PropertiesPrivate {
-    std::map<std::string, Entry, SortKey> entries;
+    /// Entries in the order of their insertion
+    std::vector<Entry> entries;
+    /// Open addressing hash table of entry indices (empty for small lists)
+    std::vector<uint32_t> index;
     std::string id, plugin_name;
-};
 
-using Iterator = typename std::map<std::string, Entry, SortKey>::iterator;
+    static size_t hash(const std::string &name) {
+        return std::hash<std::string>()(name);
+    }
+
+    Entry *find(const std::string &name) {
+        size_t h = hash(name);
+        if (!index.empty()) {
+            size_t mask = index.size() - 1;
+            for (size_t i = h & mask; index[i] != PropertiesIndexEmpty;
+                 i = (i + 1) & mask) {
+                Entry &e = entries[index[i]];
+                if (e.hash == h && e.name == name)
+                    return &e;
+            }
+            return nullptr;
+        }
+        for (Entry &e : entries) {
+            if (e.hash == h && e.name == name)
+                return &e;
+        }
+        return nullptr;
+    }
+
+    const Entry *find(const std::string &name) const {
+        return const_cast<PropertiesPrivate *>(this)->find(name);
+    }
+
+    void index_insert(uint32_t entry) {
+        size_t mask = index.size() - 1, i = entries[entry].hash & mask;
+        while (index[i] != PropertiesIndexEmpty)
+            i = (i + 1) & mask;
+        index[i] = entry;
+    }
+
+    void rebuild_index() {
+        index.clear();
+        if (entries.size() <= PropertiesIndexThreshold)
+            return;
+        size_t size = 64;
+        while (size < 2 * entries.size())
+            size *= 2;
+        index.resize(size, PropertiesIndexEmpty);
+        for (uint32_t i = 0; i < (uint32_t) entries.size(); ++i)
+            index_insert(i);
+    }
+
+    /// Return the entry with the given name, append it if it doesn't exist
+    Entry &insert(const std::string &name, bool error_duplicates = false) {
+        Entry *e = find(name);
+        if (e) {
+            if (error_duplicates)
+                Log(Error, "Property \"%s\" was specified multiple times!", name);
+            return *e;
+        }
+        entries.push_back(Entry{ name, hash(name), VariantType(), false });
+        if (entries.size() > PropertiesIndexThreshold) {
+            if (2 * entries.size() > index.size())
+                rebuild_index();
+            else
+                index_insert((uint32_t) entries.size() - 1);
+        }
+        return entries.back();
+    }
+
+    void erase(const Entry *e) {
+        entries.erase(entries.begin() + (e - entries.data()));
+        rebuild_index();
+    }
+
+    /// Return the entries in the order of their names (see \ref SortKey)
+    std::vector<Entry *> sorted() const {
+        std::vector<Entry *> result;
+        result.reserve(entries.size());
+        for (const Entry &e : entries)
+            result.push_back(const_cast<Entry *>(&e));
+        std::stable_sort(result.begin(), result.end(),
+                         [](const Entry *a, const Entry *b) {
+                             return SortKey()(a->name, b->name);
+                         });
+        return result;
+    }
+};
 
 template <typename T, typename T2 = T>
-T get_impl(const Iterator &it) {
-    if (!it->second.data.template is<T>() && !it->second.data.template is<T2>())
+T get_impl(Entry *e) {
+    if (!e->data.template is<T>() && !e->data.template is<T2>())
         Throw("The property \"%s\" has the wrong type (expected <%s> or <%s>, is <%s>)",
-              it->first, typeid(T).name(), typeid(T2).name(), it->second.data.type().name());
-    it->second.queried = true;
-    if (it->second.data.template is<T2>())
-        return (T const &) (T2 const &) it->second.data;
-    return (T const &) it->second.data;
+              e->name, typeid(T).name(), typeid(T2).name(), e->data.type().name());
+    e->queried = true;
+    if (e->data.template is<T2>())
+        return (T const &) (T2 const &) e->data;
+    return (T const &) e->data;
 }
 
 template <typename T>
-T get_routing(const Iterator &it) {
+T get_routing(Entry *e) {
     if constexpr (dr::is_static_array_v<T>) {
         Assert(T::Size == 3);
         if constexpr (std::is_same_v<T, Color<float, 3>> ||
                       std::is_same_v<T, Color<double, 3>>)
-            return (T) get_impl<Color3f, Array3f>(it);
+            return (T) get_impl<Color3f, Array3f>(e);
         else
-            return (T) get_impl<Array3f>(it);
+            return (T) get_impl<Array3f>(e);
     }
 
     if constexpr (std::is_same_v<T, Transform<Point<float, 4>>> ||
                   std::is_same_v<T, Transform<Point<double, 4>>>)
-        return (T) get_impl<Transform4f>(it);
+        return (T) get_impl<Transform4f>(e);
 
     if constexpr (std::is_floating_point_v<T>)
-        return (T) get_impl<Float, int64_t>(it);
+        return (T) get_impl<Float, int64_t>(e);
 
     if constexpr (std::is_same_v<T, ref<Object>>)
-        return get_impl<ref<Object>>(it);
+        return get_impl<ref<Object>>(e);
 
     if constexpr (std::is_same_v<T, bool>)
-        return get_impl<T>(it);
+        return get_impl<T>(e);
 
     if constexpr (std::is_integral_v<T> && !std::is_pointer_v<T>) {
-        int64_t v = get_impl<int64_t>(it);
+        int64_t v = get_impl<int64_t>(e);
         if constexpr (std::is_unsigned_v<T>) {
             if (v < 0) {
                 Throw("Property \"%s\" has negative value %i, but was queried as a"
-                    " size_t (unsigned).", it->first, v);
+                    " size_t (unsigned).", e->name, v);
             }
         }
         return (T) v;
     }
 
     if constexpr (std::is_same_v<T, std::string>)
-        return get_impl<T>(it);
+        return get_impl<T>(e);
 
     Throw("Unsupported type: <%s>.", typeid(T).name());
 }
 
 template <typename T>
 T Properties::get(const std::string &name) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    Entry *e = d->find(name);
+    if (!e)
         Throw("Property \"%s\" has not been specified!", name);
-    return get_routing<T>(it);
+    return get_routing<T>(e);
 }
 
 template <typename T>
 T Properties::get(const std::string &name, const T &def_val) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    Entry *e = d->find(name);
+    if (!e)
         return def_val;
-    return get_routing<T>(it);
+    return get_routing<T>(e);
 }
 #define DEFINE_PROPERTY_SETTER(Type, SetterName) \
     void Properties::SetterName(const std::string &name, Type const &value, bool error_duplicates) { \
-        if (has_property(name) && error_duplicates) \
-            Log(Error, "Property \"%s\" was specified multiple times!", name); \
-        d->entries[name].data = (Type) value; \
-        d->entries[name].queried = false; \
+        Entry &e = d->insert(name, error_duplicates); \
+        e.data = (Type) value; \
+        e.queried = false; \
     }
 
 #define DEFINE_PROPERTY_ACCESSOR(Type, TagName, SetterName, GetterName) \
     DEFINE_PROPERTY_SETTER(Type, SetterName) \
     \
     Type const & Properties::GetterName(const std::string &name) const { \
-        const auto it = d->entries.find(name); \
-        if (it == d->entries.end()) \
+        Entry *e = d->find(name); \
+        if (!e) \
             Throw("Property \"%s\" has not been specified!", name); \
-        if (!it->second.data.is<Type>()) \
+        if (!e->data.is<Type>()) \
             Throw("The property \"%s\" has the wrong type (expected <" #TagName ">).", name); \
-        it->second.queried = true; \
-        return (Type const &) it->second.data; \
+        e->queried = true; \
+        return (Type const &) e->data; \
     } \
     \
     Type const & Properties::GetterName(const std::string &name, Type const &def_val) const { \
-        const auto it = d->entries.find(name); \
-        if (it == d->entries.end()) \
+        Entry *e = d->find(name); \
+        if (!e) \
             return def_val; \
-        if (!it->second.data.is<Type>()) \
+        if (!e->data.is<Type>()) \
             Throw("The property \"%s\" has the wrong type (expected <" #TagName ">).", name); \
-        it->second.queried = true; \
-        return (Type const &) it->second.data; \
+        e->queried = true; \
+        return (Type const &) e->data; \
     }
 
 DEFINE_PROPERTY_SETTER(bool,         set_bool)
@@ -198,7 +290,15 @@ void Properties::operator=(const Properties &props) {
 }
 
 bool Properties::has_property(const std::string &name) const {
-    return d->entries.find(name) != d->entries.end();
+    return d->find(name) != nullptr;
+}
+
+void Properties::reserve(size_t size) {
+    d->entries.reserve(size);
+}
+
+size_t Properties::size() const {
+    return d->entries.size();
 }
 
 namespace {
@@ -235,33 +335,33 @@ namespace {
 }
 
 Properties::Type Properties::type(const std::string &name) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    const Entry *e = d->find(name);
+    if (!e)
         Throw("type(): Could not find property named \"%s\"!", name);
 
-    return it->second.data.visit(PropertyTypeVisitor());
+    return e->data.visit(PropertyTypeVisitor());
 }
 
 bool Properties::mark_queried(const std::string &name) const {
-    auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    Entry *e = d->find(name);
+    if (!e)
         return false;
-    it->second.queried = true;
+    e->queried = true;
     return true;
 }
 
 bool Properties::was_queried(const std::string &name) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    const Entry *e = d->find(name);
+    if (!e)
         Throw("Could not find property named \"%s\"!", name);
-    return it->second.queried;
+    return e->queried;
 }
 
 bool Properties::remove_property(const std::string &name) {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    const Entry *e = d->find(name);
+    if (!e)
         return false;
-    d->entries.erase(it);
+    d->erase(e);
     return true;
 }
 
@@ -284,29 +384,35 @@ void Properties::set_id(const std::string &id) {
 void Properties::copy_attribute(const Properties &properties,
                                 const std::string &source_name,
                                 const std::string &target_name) {
-    const auto it = properties.d->entries.find(source_name);
-    if (it == properties.d->entries.end())
+    const Entry *e = properties.d->find(source_name);
+    if (!e)
         Throw("copy_attribute(): Could not find parameter \"%s\"!", source_name);
-    d->entries[target_name] = it->second;
+    // Copy first, inserting may reallocate the entries of 'properties'
+    VariantType data = e->data;
+    bool queried = e->queried;
+    Entry &target = d->insert(target_name);
+    target.data = std::move(data);
+    target.queried = queried;
 }
 
 std::vector<std::string> Properties::property_names() const {
     std::vector<std::string> result;
-    for (const auto &e : d->entries)
-        result.push_back(e.first);
+    result.reserve(d->entries.size());
+    for (const Entry *e : d->sorted())
+        result.push_back(e->name);
     return result;
 }
 
 std::vector<std::pair<std::string, NamedReference>> Properties::named_references() const {
     std::vector<std::pair<std::string, NamedReference>> result;
     result.reserve(d->entries.size());
-    for (auto &e : d->entries) {
-        auto type = e.second.data.visit(PropertyTypeVisitor());
+    for (Entry *e : d->sorted()) {
+        auto type = e->data.visit(PropertyTypeVisitor());
         if (type != Type::NamedReference)
             continue;
-        auto const &value = (const NamedReference &) e.second.data;
-        result.push_back(std::make_pair(e.first, value));
-        e.second.queried = true;
+        auto const &value = (const NamedReference &) e->data;
+        result.push_back(std::make_pair(e->name, value));
+        e->queried = true;
     }
     return result;
 }
@@ -314,29 +420,33 @@ std::vector<std::pair<std::string, NamedReference>> Properties::named_references
 std::vector<std::pair<std::string, ref<Object>>> Properties::objects(bool mark_queried) const {
     std::vector<std::pair<std::string, ref<Object>>> result;
     result.reserve(d->entries.size());
-    for (auto &e : d->entries) {
-        auto type = e.second.data.visit(PropertyTypeVisitor());
+    for (Entry *e : d->sorted()) {
+        auto type = e->data.visit(PropertyTypeVisitor());
         if (type != Type::Object)
             continue;
-        result.push_back(std::make_pair(e.first, (const ref<Object> &) e.second));
+        result.push_back(std::make_pair(e->name, (const ref<Object> &) e->data));
         if (mark_queried)
-            e.second.queried = true;
+            e->queried = true;
     }
     return result;
 }
 
 std::vector<std::string> Properties::unqueried() const {
     std::vector<std::string> result;
-    for (const auto &e : d->entries) {
-        if (!e.second.queried)
-            result.push_back(e.first);
+    for (const Entry *e : d->sorted()) {
+        if (!e->queried)
+            result.push_back(e->name);
     }
     return result;
 }
 
 void Properties::merge(const Properties &p) {
-    for (const auto &e : p.d->entries)
-        d->entries[e.first] = e.second;
+    d->entries.reserve(d->entries.size() + p.d->entries.size());
+    for (const Entry &e : p.d->entries) {
+        Entry &target = d->insert(e.name);
+        target.data = e.data;
+        target.queried = e.queried;
+    }
 }
 
 bool Properties::operator==(const Properties &p) const {
@@ -345,11 +455,11 @@ bool Properties::operator==(const Properties &p) const {
         d->entries.size() != p.d->entries.size())
         return false;
 
-    for (const auto &e : d->entries) {
-        auto it = p.d->entries.find(e.first);
-        if (it == p.d->entries.end())
+    for (const Entry &e : d->entries) {
+        const Entry *e2 = p.d->find(e.name);
+        if (!e2)
             return false;
-        if (e.second.data != it->second.data)
+        if (e.data != e2->data)
             return false;
     }
 
@@ -357,46 +467,35 @@ bool Properties::operator==(const Properties &p) const {
 }
 
 std::string Properties::as_string(const std::string &name) const {
+    const Entry *e = d->find(name);
+    if (!e)
+        Throw("Property \"%s\" has not been specified!", name);
     std::ostringstream oss;
-    bool found = false;
-    for (auto &e : d->entries) {
-        if (e.first != name)
-            continue;
-        e.second.data.visit(StreamVisitor(oss));
-        found = true;
-        break;
-    }
-    if (!found)
-        Throw("Property \"%s\" has not been specified!", name); \
+    const_cast<Entry *>(e)->data.visit(StreamVisitor(oss));
     return oss.str();
 }
 
 std::string Properties::as_string(const std::string &name, const std::string &def_val) const {
-    std::ostringstream oss;
-    bool found = false;
-    for (auto &e : d->entries) {
-        if (e.first != name)
-            continue;
-        e.second.data.visit(StreamVisitor(oss));
-        found = true;
-        break;
-    }
-    if (!found)
+    const Entry *e = d->find(name);
+    if (!e)
         return def_val;
+    std::ostringstream oss;
+    const_cast<Entry *>(e)->data.visit(StreamVisitor(oss));
     return oss.str();
 }
 
 std::ostream &operator<<(std::ostream &os, const Properties &p) {
-    auto it = p.d->entries.begin();
+    std::vector<Entry *> entries = p.d->sorted();
+    auto it = entries.begin();
 
     os << "Properties[" << std::endl
        << "  plugin_name = \"" << (p.d->plugin_name) << "\"," << std::endl
        << "  id = \"" << p.d->id << "\"," << std::endl
        << "  elements = {" << std::endl;
-    while (it != p.d->entries.end()) {
-        os << "    \"" << it->first << "\" -> ";
-        it->second.data.visit(StreamVisitor(os));
-        if (++it != p.d->entries.end()) os << ",";
+    while (it != entries.end()) {
+        os << "    \"" << (*it)->name << "\" -> ";
+        (*it)->data.visit(StreamVisitor(os));
+        if (++it != entries.end()) os << ",";
         os << std::endl;
     }
     os << "  }" << std::endl
@@ -411,18 +510,16 @@ std::ostream &operator<<(std::ostream &os, const Properties &p) {
 
 /// Float setter
 void Properties::set_float(const std::string &name, const Float &value, bool error_duplicates) {
-    if (has_property(name) && error_duplicates)
-        Log(Error, "Property \"%s\" was specified multiple times!", name);
-    d->entries[name].data = (Float) value;
-    d->entries[name].queried = false;
+    Entry &e = d->insert(name, error_duplicates);
+    e.data = (Float) value;
+    e.queried = false;
 }
 
 /// Array3f setter
 void Properties::set_array3f(const std::string &name, const Array3f &value, bool error_duplicates) {
-    if (has_property(name) && error_duplicates)
-        Log(Error, "Property \"%s\" was specified multiple times!", name);
-    d->entries[name].data = (Array3f) value;
-    d->entries[name].queried = false;
+    Entry &e = d->insert(name, error_duplicates);
+    e.data = (Array3f) value;
+    e.queried = false;
 }
 
 #if 0
@@ -501,14 +598,14 @@ ref<AnimatedTransform> Properties::animated_transform(
 #endif
 
 ref<Object> Properties::find_object(const std::string &name) const {
-    const auto it = d->entries.find(name);
-    if (it == d->entries.end())
+    const Entry *e = d->find(name);
+    if (!e)
         return ref<Object>();
 
-    if (!it->second.data.is<ref<Object>>())
+    if (!e->data.is<ref<Object>>())
         Throw("The property \"%s\" has the wrong type.", name);
 
-    return it->second.data;
+    return e->data;
 }
 
 #define EXPORT_PROPERTY_ACCESSOR(T) \
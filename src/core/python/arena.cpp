@@ -0,0 +1,27 @@
+#include <mitsuba/core/arena.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(ScratchArena) {
+    py::class_<ScratchArena>(m, "ScratchArena", D(ScratchArena))
+        .def(py::init<size_t>(), "chunk_size"_a = 1 << 16,
+             D(ScratchArena, ScratchArena))
+        .def("allocate",
+             [](ScratchArena &a, size_t size, size_t align) {
+                 return (uintptr_t) a.allocate(size, align);
+             },
+             "size"_a, "align"_a = alignof(std::max_align_t),
+             D(ScratchArena, allocate))
+        .def_method(ScratchArena, reset)
+        .def("mark", [](const ScratchArena &a) {
+                 ScratchArena::Marker marker = a.mark();
+                 return std::make_pair(marker.chunk, marker.offset);
+             }, D(ScratchArena, mark))
+        .def("rewind", [](ScratchArena &a, std::pair<size_t, size_t> marker) {
+                 a.rewind(ScratchArena::Marker{ marker.first, marker.second });
+             }, "marker"_a, D(ScratchArena, rewind))
+        .def_method(ScratchArena, bytes_used)
+        .def_method(ScratchArena, capacity)
+        .def_method(ScratchArena, chunk_count)
+        .def_static("heap_allocations", &ScratchArena::heap_allocations,
+                    D(ScratchArena, heap_allocations));
+}
@@ -0,0 +1,20 @@
+#include <mitsuba/core/assetcache.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/stream.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(AssetCache) {
+    py::class_<AssetCache>(m, "AssetCache", D(AssetCache))
+        .def_static("prune", &AssetCache::prune, D(AssetCache, prune))
+        .def_static("clear", &AssetCache::clear, D(AssetCache, clear))
+        .def_static("size", &AssetCache::size, D(AssetCache, size))
+        .def_static("set_enabled", &AssetCache::set_enabled, "enabled"_a,
+                    D(AssetCache, set_enabled))
+        .def_static("enabled", &AssetCache::enabled, D(AssetCache, enabled))
+        .def_static("get_shared", &AssetCache::get_shared, "path"_a, "key"_a,
+                    "write"_a, D(AssetCache, get_shared))
+        .def_static("set_shared_directory", &AssetCache::set_shared_directory,
+                    "path"_a, D(AssetCache, set_shared_directory))
+        .def_static("shared_directory", &AssetCache::shared_directory,
+                    D(AssetCache, shared_directory));
+}
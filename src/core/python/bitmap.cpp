@@ -4,6 +4,7 @@
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/stream.h>
 #include <mitsuba/core/mstream.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/python/python.h>
 
 MI_PY_EXPORT(Bitmap) {
@@ -44,6 +45,17 @@ MI_PY_EXPORT(Bitmap) {
         .value("Unpremultiply", Bitmap::AlphaTransform::Unpremultiply,
                 D(Bitmap, AlphaTransform, Unpremultiply));
 
+    py::enum_<Bitmap::EXRCompression>(bitmap, "EXRCompression", D(Bitmap, EXRCompression))
+        .value("Auto",  Bitmap::EXRCompression::Auto,  D(Bitmap, EXRCompression, Auto))
+        .value("None",  Bitmap::EXRCompression::None,  D(Bitmap, EXRCompression, None))
+        .value("RLE",   Bitmap::EXRCompression::RLE,   D(Bitmap, EXRCompression, RLE))
+        .value("ZIPS",  Bitmap::EXRCompression::ZIPS,  D(Bitmap, EXRCompression, ZIPS))
+        .value("ZIP",   Bitmap::EXRCompression::ZIP,   D(Bitmap, EXRCompression, ZIP))
+        .value("PIZ",   Bitmap::EXRCompression::PIZ,   D(Bitmap, EXRCompression, PIZ))
+        .value("PXR24", Bitmap::EXRCompression::PXR24, D(Bitmap, EXRCompression, PXR24))
+        .value("DWAA",  Bitmap::EXRCompression::DWAA,  D(Bitmap, EXRCompression, DWAA))
+        .value("DWAB",  Bitmap::EXRCompression::DWAB,  D(Bitmap, EXRCompression, DWAB));
+
     bitmap
         .def(py::init<Bitmap::PixelFormat, Struct::Type, const Vector2u &, size_t, std::vector<std::string>>(),
              "pixel_format"_a, "component_format"_a, "size"_a, "channel_count"_a = 0, "channel_names"_a = std::vector<std::string>(),
@@ -60,6 +72,7 @@ MI_PY_EXPORT(Bitmap) {
         .def_method(Bitmap, bytes_per_pixel)
         .def_method(Bitmap, buffer_size)
         .def_method(Bitmap, srgb_gamma)
+        .def_method(Bitmap, owns_data)
         .def_method(Bitmap, set_srgb_gamma)
         .def_method(Bitmap, premultiplied_alpha)
         .def_method(Bitmap, set_premultiplied_alpha)
@@ -150,20 +163,26 @@ MI_PY_EXPORT(Bitmap) {
             "format"_a = Bitmap::FileFormat::Auto,
             py::call_guard<py::gil_scoped_release>())
         .def("write",
-            py::overload_cast<Stream *, Bitmap::FileFormat, int>(
+            py::overload_cast<Stream *, Bitmap::FileFormat, int, Bitmap::EXRCompression>(
                 &Bitmap::write, py::const_),
             "stream"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+            "compression"_a = Bitmap::EXRCompression::Auto,
             D(Bitmap, write), py::call_guard<py::gil_scoped_release>())
         .def("write",
-            py::overload_cast<const fs::path &, Bitmap::FileFormat, int>(
+            py::overload_cast<const fs::path &, Bitmap::FileFormat, int, Bitmap::EXRCompression>(
                 &Bitmap::write, py::const_),
             "path"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+            "compression"_a = Bitmap::EXRCompression::Auto,
             D(Bitmap, write, 2), py::call_guard<py::gil_scoped_release>())
         .def("write_async",
-            py::overload_cast<const fs::path &, Bitmap::FileFormat, int>(
+            py::overload_cast<const fs::path &, Bitmap::FileFormat, int, Bitmap::EXRCompression>(
                 &Bitmap::write_async, py::const_),
             "path"_a, "format"_a = Bitmap::FileFormat::Auto, "quality"_a = -1,
+            "compression"_a = Bitmap::EXRCompression::Auto,
             D(Bitmap, write_async))
+        .def("write_raw", &Bitmap::write_raw, "stream"_a, D(Bitmap, write_raw),
+            py::call_guard<py::gil_scoped_release>())
+        .def_static("map_raw", &Bitmap::map_raw, "mmap"_a, D(Bitmap, map_raw))
         .def("split", &Bitmap::split, D(Bitmap, split))
         .def_static("detect_file_format", &Bitmap::detect_file_format, D(Bitmap, detect_file_format))
         .def_property_readonly("__array_interface__", [](Bitmap &bitmap) -> py::object {
@@ -224,7 +243,8 @@ MI_PY_EXPORT(Bitmap) {
      * interface protocol.
      */
     bitmap.def(py::init([](PyObjectWrapper obj_wrapper, py::object pixel_format_,
-                           const std::vector<std::string> &channel_names) {
+                           const std::vector<std::string> &channel_names,
+                           bool copy) {
             py::object obj = obj_wrapper.obj;
             if (!py::hasattr(obj, "__array_interface__"))
                 throw py::type_error("Array should define __array_interface__!");
@@ -282,15 +302,13 @@ MI_PY_EXPORT(Bitmap) {
                 pixel_format = pixel_format_.cast<Bitmap::PixelFormat>();
 
             Vector2u size(shape[1].cast<size_t>(), shape[0].cast<size_t>());
-            Bitmap* bitmap = new Bitmap(pixel_format, component_format, size,
-                                     channel_count, channel_names);
 
             bool is_contiguous = true;
             if (interface.contains("strides") && !interface["strides"].is_none()) {
                 auto strides = interface["strides"].template cast<py::tuple>();
 
                 // Stride information might be given although it's contiguous
-                size_t bytes_per_value = bitmap->bytes_per_pixel() / bitmap->channel_count();
+                size_t bytes_per_value = (size_t) std::stoi(typestr.substr(2));
                 int64_t current_stride = bytes_per_value;
                 for (size_t i = ndim; i > 0; --i) {
                     if (current_stride != strides[i - 1].cast<int64_t>()) {
@@ -299,31 +317,55 @@ MI_PY_EXPORT(Bitmap) {
                     }
                     current_stride *= shape[i - 1].cast<size_t>();
                 }
+            }
 
-                // Need to shuffle memory
-                if (!is_contiguous) {
-                    size_t num_values = size.x() * size.y();
-                    if (ndim == 3)
-                        num_values *= shape[2].cast<size_t>();
-
-                    std::unique_ptr<size_t[]> shape_cum = std::make_unique<size_t[]>(ndim);
-                    shape_cum[ndim - 1] = 1;
-                    for (size_t j = ndim - 1; j > 0; --j) {
-                        size_t shape_j = shape[j].cast<size_t>();
-                        shape_cum[j - 1] = shape_j * shape_cum[j];
+            if (!copy) {
+                if (!is_contiguous)
+                    throw py::value_error("Bitmap(): copy=False requires a "
+                                          "C-contiguous array!");
+
+                // Wrap the array memory and keep the array alive
+                Bitmap *bitmap = new Bitmap(pixel_format, component_format, size,
+                                            channel_count, channel_names,
+                                            (uint8_t *) ptr);
+                PyObject *owner = obj.inc_ref().ptr();
+                bitmap->set_data_owner(std::shared_ptr<void>(owner, [](void *o) {
+                    if (Py_IsInitialized()) {
+                        py::gil_scoped_acquire gil;
+                        Py_DECREF((PyObject *) o);
                     }
+                }));
+                return bitmap;
+            }
+
+            Bitmap* bitmap = new Bitmap(pixel_format, component_format, size,
+                                     channel_count, channel_names);
+
+            // Need to shuffle memory
+            if (!is_contiguous) {
+                auto strides = interface["strides"].template cast<py::tuple>();
+                size_t bytes_per_value = bitmap->bytes_per_pixel() / bitmap->channel_count();
+                size_t num_values = size.x() * size.y();
+                if (ndim == 3)
+                    num_values *= shape[2].cast<size_t>();
+
+                std::unique_ptr<size_t[]> shape_cum = std::make_unique<size_t[]>(ndim);
+                shape_cum[ndim - 1] = 1;
+                for (size_t j = ndim - 1; j > 0; --j) {
+                    size_t shape_j = shape[j].cast<size_t>();
+                    shape_cum[j - 1] = shape_j * shape_cum[j];
+                }
 
-                    for (size_t i = 0; i < num_values; ++i) {
-                        unsigned char* src = (unsigned char*) ptr;
-                        for (size_t j = ndim; j > 0; --j) {
-                            int64_t stride_j = strides[j - 1].cast<int64_t>();
-                            size_t shape_j = shape[j - 1].cast<size_t>();
-                            int64_t offset_j = ((i / shape_cum[j - 1]) % shape_j) * stride_j;
-                            src += offset_j;
-                        }
-                        unsigned char *dest = (unsigned char *) bitmap->data() + i * bytes_per_value;
-                        memcpy(dest, src, bytes_per_value);
+                for (size_t i = 0; i < num_values; ++i) {
+                    unsigned char* src = (unsigned char*) ptr;
+                    for (size_t j = ndim; j > 0; --j) {
+                        int64_t stride_j = strides[j - 1].cast<int64_t>();
+                        size_t shape_j = shape[j - 1].cast<size_t>();
+                        int64_t offset_j = ((i / shape_cum[j - 1]) % shape_j) * stride_j;
+                        src += offset_j;
                     }
+                    unsigned char *dest = (unsigned char *) bitmap->data() + i * bytes_per_value;
+                    memcpy(dest, src, bytes_per_value);
                 }
             }
 
@@ -335,7 +377,11 @@ MI_PY_EXPORT(Bitmap) {
         "array"_a,
         "pixel_format"_a = py::none(),
         "channel_names"_a = std::vector<std::string>(),
-        "Initialize a Bitmap from any array that implements ``__array_interface__``");
+        "copy"_a = true,
+        "Initialize a Bitmap from any array that implements ``__array_interface__``. "
+        "When ``copy=False``, the bitmap directly wraps the memory of the "
+        "(C-contiguous) array and keeps the array alive, which avoids "
+        "duplicating large images.");
 
     bitmap.def("_repr_html_", [](const Bitmap &_bitmap) -> py::object {
         if (_bitmap.pixel_format() == Bitmap::PixelFormat::MultiChannel)
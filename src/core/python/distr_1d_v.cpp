@@ -10,11 +10,19 @@ MI_PY_EXPORT(DiscreteDistribution) {
     MI_PY_STRUCT(DiscreteDistribution, py::module_local())
         .def(py::init<>(), D(DiscreteDistribution))
         .def(py::init<const DiscreteDistribution &>(), "Copy constructor")
-        .def(py::init<const FloatStorage &>(), "pmf"_a,
+        .def(py::init<const FloatStorage &, bool>(), "pmf"_a,
+             "alias_table"_a = false,
              D(DiscreteDistribution, DiscreteDistribution, 2))
         .def("__len__", &DiscreteDistribution::size)
         .def("size", &DiscreteDistribution::size, D(DiscreteDistribution, size))
         .def("empty", &DiscreteDistribution::empty, D(DiscreteDistribution, empty))
+        .def_method(DiscreteDistribution, has_alias_table)
+        .def("alias_probability", &DiscreteDistribution::alias_probability,
+             D(DiscreteDistribution, alias_probability),
+             py::return_value_policy::reference_internal)
+        .def("alias_index", &DiscreteDistribution::alias_index,
+             D(DiscreteDistribution, alias_index),
+             py::return_value_policy::reference_internal)
         .def("pmf", py::overload_cast<>(&DiscreteDistribution::pmf),
              D(DiscreteDistribution, pmf), py::return_value_policy::reference_internal)
         .def("cdf", py::overload_cast<>(&DiscreteDistribution::cdf),
@@ -78,6 +86,8 @@ MI_PY_EXPORT(ContinuousDistribution) {
         .def_method(ContinuousDistribution, normalization)
         .def_method(ContinuousDistribution, interval_resolution)
         .def_method(ContinuousDistribution, max)
+        .def("guide", &ContinuousDistribution::guide,
+             D(ContinuousDistribution, guide), py::return_value_policy::reference_internal)
         .def("sample",
             &ContinuousDistribution::sample,
             "value"_a, "active"_a = true, D(ContinuousDistribution, sample))
@@ -81,13 +81,29 @@ template <typename Warp> auto bind_warp(py::module &m,
 }
 
 template <typename Warp> void bind_warp_hierarchical(py::module &m, const char *name) {
-    bind_warp<Warp>(m, name,
+    using ScalarFloat = dr::scalar_t<typename Warp::Float>;
+    using NumPyArray  = py::array_t<ScalarFloat, py::array::c_style | py::array::forcecast>;
+
+    auto warp = bind_warp<Warp>(m, name,
         D(Hierarchical2D),
         D(Hierarchical2D, Hierarchical2D, 2),
         D(Hierarchical2D, sample),
         D(Hierarchical2D, invert),
         D(Hierarchical2D, eval)
     );
+
+    warp.def("update",
+             [](Warp &w, const NumPyArray &data, bool normalize) {
+                 if (data.ndim() != Warp::Dimension + 2)
+                     throw std::domain_error("'data' array has incorrect dimension");
+                 auto res = w.resolution();
+                 if ((uint32_t) data.shape(data.ndim() - 1) != res.x() ||
+                     (uint32_t) data.shape(data.ndim() - 2) != res.y())
+                     throw std::domain_error("'data' array has incorrect resolution");
+                 w.update(data.data(), normalize);
+             },
+             "data"_a, "normalize"_a = true, D(Hierarchical2D, update))
+        .def("resolution", &Warp::resolution, D(Hierarchical2D, resolution));
 }
 
 template <typename Warp> void bind_warp_marginal(py::module &m, const char *name) {
@@ -26,5 +26,7 @@ MI_PY_EXPORT(FileResolver) {
         .def_method(FileResolver, resolve)
         .def_method(FileResolver, clear)
         .def_method(FileResolver, prepend)
-        .def_method(FileResolver, append);
+        .def_method(FileResolver, append)
+        .def_method(FileResolver, clear_cache)
+        .def_method(FileResolver, cache_size);
 }
@@ -28,6 +28,9 @@ static void PyLog(mitsuba::LogLevel level, const std::string &msg) {
     if (!name.empty() && name[0] != '<')
         fmt.insert(2, "()");
 
+    /* Release the GIL, since the flusher thread of an asynchronous logger
+       may need it to call appenders implemented in Python */
+    py::gil_scoped_release release;
     Thread::thread()->logger()->log(
         level, nullptr /* class_ */,
         filename.c_str(), lineno,
@@ -43,14 +46,19 @@ MI_PY_EXPORT(Logger) {
         .def_method(Logger, log_level)
         .def_method(Logger, set_error_level)
         .def_method(Logger, error_level)
-        .def_method(Logger, add_appender, py::keep_alive<1, 2>())
-        .def_method(Logger, remove_appender)
-        .def_method(Logger, clear_appenders)
+        .def_method(Logger, set_async, "value"_a,
+                    py::call_guard<py::gil_scoped_release>())
+        .def_method(Logger, is_async)
+        .def_method(Logger, flush, py::call_guard<py::gil_scoped_release>())
+        .def_method(Logger, add_appender, py::keep_alive<1, 2>(),
+                    py::call_guard<py::gil_scoped_release>())
+        .def_method(Logger, remove_appender, py::call_guard<py::gil_scoped_release>())
+        .def_method(Logger, clear_appenders, py::call_guard<py::gil_scoped_release>())
         .def_method(Logger, appender_count)
         .def("appender", (Appender * (Logger::*)(size_t)) &Logger::appender, D(Logger, appender))
         .def("formatter", (Formatter * (Logger::*)()) &Logger::formatter, D(Logger, formatter))
         .def_method(Logger, set_formatter, py::keep_alive<1, 2>())
-        .def_method(Logger, read_log);
+        .def_method(Logger, read_log, py::call_guard<py::gil_scoped_release>());
 
     m.def("Log", &PyLog, "level"_a, "msg"_a);
 }
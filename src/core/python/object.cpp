@@ -59,6 +59,10 @@ MI_PY_EXPORT(Object) {
              },
              "name"_a, "variant"_a, py::return_value_policy::reference,
              D(PluginManager, get_plugin_class))
+        .def("preload", &PluginManager::preload, "names"_a,
+             py::call_guard<py::gil_scoped_release>(),
+             D(PluginManager, preload))
+        .def_method(PluginManager, loaded_plugins)
         .def("create_object", [](PluginManager &pmgr, const Properties &props) {
             auto mi = py::module_::import("mitsuba");
             std::string variant = py::cast<std::string>(mi.attr("variant")());
@@ -93,6 +97,7 @@ MI_PY_EXPORT(Object) {
         }, D(Object, expand))
         .def_method(Object, traverse, "cb"_a)
         .def_method(Object, parameters_changed, "keys"_a = py::list())
+        .def_method(Object, memory_footprint)
         .def_property_readonly("ptr", [](Object *self) { return (uintptr_t) self; })
         .def("class_", &Object::class_, py::return_value_policy::reference, D(Object, class))
         .def("__repr__", &Object::to_string, D(Object, to_string));
@@ -0,0 +1,16 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(Profiler) {
+    py::class_<Profiler>(m, "Profiler", D(Profiler))
+        .def_static("enabled", &Profiler::enabled, D(Profiler, enabled))
+        .def_static("start", &Profiler::start, "interval"_a = 1.f,
+                    D(Profiler, start))
+        .def_static("stop", &Profiler::stop, D(Profiler, stop))
+        .def_static("running", &Profiler::running, D(Profiler, running))
+        .def_static("reset", &Profiler::reset, D(Profiler, reset))
+        .def_static("sample_count", &Profiler::sample_count,
+                    D(Profiler, sample_count))
+        .def_static("report", &Profiler::report, "json"_a = false,
+                    D(Profiler, report));
+}
@@ -66,6 +66,8 @@ MI_PY_EXPORT(Properties) {
             .def(py::init<const Properties &>(), D(Properties, Properties, 3))
             // Methods
             .def_method(Properties, has_property)
+            .def_method(Properties, reserve, "size"_a)
+            .def("__len__", &Properties::size, D(Properties, size))
             .def_method(Properties, remove_property)
             .def_method(Properties, mark_queried)
             .def_method(Properties, was_queried)
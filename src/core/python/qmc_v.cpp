@@ -13,8 +13,8 @@ MI_PY_EXPORT(qmc) {
         .def("scramble", &RadicalInverse::scramble, D(RadicalInverse, scramble))
         .def("eval", &RadicalInverse::eval<Float>, "base_index"_a, "index"_a,
              D(RadicalInverse, eval))
-        // .def("eval_scrambled", &RadicalInverse::eval_scrambled<Float>, "base_index"_a,
-            //  "index"_a, D(RadicalInverse, eval_scrambled))
+        .def("eval_scrambled", &RadicalInverse::eval_scrambled<Float>, "base_index"_a,
+             "index"_a, D(RadicalInverse, eval_scrambled))
         .def("permutation",
              [](py::object self, uint32_t index) {
                  const RadicalInverse &s = py::cast<const RadicalInverse &>(self);
@@ -22,7 +22,21 @@ MI_PY_EXPORT(qmc) {
              },
              D(RadicalInverse, permutation))
         .def("inverse_permutation", &RadicalInverse::inverse_permutation,
-             D(RadicalInverse, inverse_permutation));
+             D(RadicalInverse, inverse_permutation))
+        .def("digits_per_lookup", &RadicalInverse::digits_per_lookup, "base_index"_a,
+             D(RadicalInverse, digits_per_lookup))
+        .def("digit_table",
+             [](py::object self, size_t base_index, bool scrambled) -> py::object {
+                 const RadicalInverse &s = py::cast<const RadicalInverse &>(self);
+                 const uint16_t *table = s.digit_table(base_index, scrambled);
+                 if (!table)
+                     return py::none();
+                 size_t size = 1;
+                 for (size_t i = 0; i < s.digits_per_lookup(base_index); ++i)
+                     size *= s.base(base_index);
+                 return py::array_t<uint16_t>(size, table, self);
+             },
+             "base_index"_a, "scrambled"_a = false, D(RadicalInverse, digit_table));
 
     m.def("radical_inverse_2", radical_inverse_2<UInt32>,
           "index"_a, "scramble"_a, D(radical_inverse_2));
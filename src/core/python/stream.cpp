@@ -1,7 +1,9 @@
 #include <mitsuba/core/stream.h>
+#include <mitsuba/core/astream.h>
 #include <mitsuba/core/dstream.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/mstream.h>
+#include <mitsuba/core/sstream.h>
 #include <mitsuba/core/zstream.h>
 
 #include <mitsuba/core/filesystem.h>
@@ -89,6 +91,21 @@ MI_PY_EXPORT(FileStream) {
         "p"_a, "mode"_a = FileStream::ERead, D(FileStream, FileStream));
 }
 
+MI_PY_EXPORT(AsyncFileStream) {
+    MI_PY_CLASS(AsyncFileStream, Stream)
+        .def(py::init<const mitsuba::filesystem::path &, size_t, bool>(),
+             "p"_a, "block_size"_a = 1 << 20, "read_ahead"_a = true,
+             D(AsyncFileStream, AsyncFileStream))
+        .def_method(AsyncFileStream, path)
+        .def_method(AsyncFileStream, block_size)
+        .def_method(AsyncFileStream, read_ahead)
+        .def("read_at", [](const AsyncFileStream &s, size_t pos, size_t size) {
+            std::string result(size, '\0');
+            s.read_at(pos, (void *) result.data(), size);
+            return py::bytes(result);
+        }, "pos"_a, "size"_a, D(AsyncFileStream, read_at));
+}
+
 MI_PY_EXPORT(MemoryStream) {
     MI_PY_CLASS(MemoryStream, Stream)
         .def(py::init<size_t>(), D(MemoryStream, MemoryStream),
@@ -100,6 +117,26 @@ MI_PY_EXPORT(MemoryStream) {
         });
 }
 
+MI_PY_EXPORT(SocketStream) {
+    MI_PY_CLASS(SocketStream, Stream)
+        .def(py::init<const std::string &, uint16_t>(), "host"_a, "port"_a,
+             py::call_guard<py::gil_scoped_release>(),
+             D(SocketStream, SocketStream))
+        .def_method(SocketStream, peer)
+        .def_method(SocketStream, is_closed);
+
+    MI_PY_CLASS(SocketListener, Object)
+        .def(py::init<uint16_t, const std::string &>(), "port"_a,
+             "address"_a = "127.0.0.1", D(SocketListener, SocketListener))
+        .def("accept", &SocketListener::accept,
+             py::call_guard<py::gil_scoped_release>(),
+             D(SocketListener, accept))
+        .def_method(SocketListener, port)
+        .def_method(SocketListener, address)
+        .def_method(SocketListener, close)
+        .def_method(SocketListener, is_closed);
+}
+
 MI_PY_EXPORT(ZStream) {
     auto c = MI_PY_CLASS(ZStream, Stream);
 
@@ -115,5 +152,29 @@ MI_PY_EXPORT(ZStream) {
         "level"_a = -1)
         .def("child_stream", [](ZStream &stream) {
             return py::cast(stream.child_stream());
-        }, D(ZStream, child_stream));
+        }, D(ZStream, child_stream))
+        .def_static("compress", [](py::bytes data, ZStream::EStreamType stream_type,
+                                   int level, size_t block_size) {
+            std::string view = data;
+            std::vector<uint8_t> result;
+            {
+                py::gil_scoped_release release;
+                result = ZStream::compress(view.data(), view.size(), stream_type,
+                                           level, block_size);
+            }
+            return py::bytes((const char *) result.data(), result.size());
+        }, "data"_a, "stream_type"_a = ZStream::EDeflateStream, "level"_a = -1,
+           "block_size"_a = 0, D(ZStream, compress))
+        .def_static("decompress", [](py::bytes data, size_t size,
+                                     ZStream::EStreamType stream_type) {
+            std::string view = data;
+            std::string result(size, '\0');
+            {
+                py::gil_scoped_release release;
+                ZStream::decompress(view.data(), view.size(), result.data(),
+                                    size, stream_type);
+            }
+            return py::bytes(result);
+        }, "data"_a, "size"_a, "stream_type"_a = ZStream::EDeflateStream,
+           D(ZStream, decompress));
 }
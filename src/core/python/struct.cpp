@@ -149,9 +149,13 @@ MI_PY_EXPORT(Struct) {
         .def_readwrite("blend", &Struct::Field::blend, D(Struct, Field, blend));
 
     MI_PY_CLASS(StructConverter, Object)
-        .def(py::init<const Struct *, const Struct *, bool>(), "source"_a, "target"_a, "dither"_a = false)
+        .def(py::init<const Struct *, const Struct *, bool, bool>(),
+             "source"_a, "target"_a, "dither"_a = false, "jit"_a = true)
         .def_method(StructConverter, source)
         .def_method(StructConverter, target)
+        .def_method(StructConverter, uses_jit)
+        .def_static_method(StructConverter, parallel_threshold)
+        .def_static_method(StructConverter, set_parallel_threshold, "value"_a)
         .def("convert", [](const StructConverter &c, py::bytes input_) -> py::bytes {
             std::string input(input_);
             size_t count = input.length() / c.source()->size();
@@ -83,6 +83,8 @@ MI_PY_EXPORT(Thread) {
        .def_method(Thread, priority)
        .def_method(Thread, set_core_affinity)
        .def_method(Thread, core_affinity)
+       .def_method(Thread, set_numa_node, "node"_a)
+       .def_method(Thread, numa_node)
        .def_method(Thread, set_critical)
        .def_method(Thread, is_critical)
        .def_method(Thread, set_name)
@@ -98,6 +100,10 @@ MI_PY_EXPORT(Thread) {
        .def_method(Thread, detach)
        .def_method(Thread, join)
        .def_static_method(Thread, sleep)
+       .def_static_method(Thread, thread_count)
+       .def_static_method(Thread, set_thread_count, "count"_a)
+       .def_static_method(Thread, set_numa_aware, "value"_a)
+       .def_static_method(Thread, numa_aware)
        .def_static_method(Thread, wait_for_tasks);
 
     py::class_<ThreadEnvironment>(m, "ThreadEnvironment", D(ThreadEnvironment))
@@ -0,0 +1,30 @@
+#include <mitsuba/core/tilecache.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(TileCache) {
+    MI_PY_CLASS(TiledImage, Object)
+        .def(py::init<const std::vector<ref<Bitmap>> &, uint32_t>(),
+             "levels"_a, "tile_size"_a = MI_TILE_SIZE, D(TiledImage, TiledImage))
+        .def_method(TiledImage, level_count)
+        .def_method(TiledImage, size, "level"_a = 0)
+        .def_method(TiledImage, channel_count)
+        .def_method(TiledImage, tile_size)
+        .def("fetch",
+             [](const TiledImage &image, uint32_t level, uint32_t x, uint32_t y) {
+                 if (level >= image.level_count() || x >= image.size(level).x() ||
+                     y >= image.size(level).y())
+                     throw py::index_error();
+                 std::vector<float> result(image.channel_count());
+                 image.fetch(level, x, y, result.data());
+                 return result;
+             },
+             "level"_a, "x"_a, "y"_a, D(TiledImage, fetch));
+
+    py::class_<TileCache>(m, "TileCache", D(TileCache))
+        .def_static("set_budget", &TileCache::set_budget, "bytes"_a,
+                    D(TileCache, set_budget))
+        .def_static("budget", &TileCache::budget, D(TileCache, budget))
+        .def_static("usage", &TileCache::usage, D(TileCache, usage))
+        .def_static("load_count", &TileCache::load_count, D(TileCache, load_count))
+        .def_static("clear", &TileCache::clear, D(TileCache, clear));
+}
@@ -0,0 +1,23 @@
+#include <mitsuba/core/tracer.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(TraceRecorder) {
+    py::class_<TraceRecorder>(m, "TraceRecorder", D(TraceRecorder))
+        .def_static("start", &TraceRecorder::start, D(TraceRecorder, start))
+        .def_static("stop", &TraceRecorder::stop, D(TraceRecorder, stop))
+        .def_static("running", &TraceRecorder::running,
+                    D(TraceRecorder, running))
+        .def_static("clear", &TraceRecorder::clear, D(TraceRecorder, clear))
+        .def_static("event_count", &TraceRecorder::event_count,
+                    D(TraceRecorder, event_count))
+        .def_static("timestamp", &TraceRecorder::timestamp,
+                    D(TraceRecorder, timestamp))
+        .def_static("add_event", &TraceRecorder::add_event, "category"_a,
+                    "name"_a, "start"_a, "duration"_a, "args"_a = "",
+                    D(TraceRecorder, add_event))
+        .def_static("add_counter", &TraceRecorder::add_counter, "category"_a,
+                    "name"_a, "value"_a, D(TraceRecorder, add_counter))
+        .def_static("json", &TraceRecorder::json, D(TraceRecorder, json))
+        .def_static("write", &TraceRecorder::write, "filename"_a,
+                    D(TraceRecorder, write));
+}
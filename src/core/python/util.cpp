@@ -5,6 +5,8 @@ MI_PY_EXPORT(util) {
     auto util = m.def_submodule("util", "Miscellaneous utility routines");
 
     util.def_method(util, core_count)
+        .def_method(util, numa_node_count)
+        .def_method(util, numa_node_cores, "node"_a)
         .def_method(util, time_string, "time"_a, "precise"_a = false)
         .def_method(util, mem_string, "size"_a, "precise"_a = false)
         .def_method(util, trap_debugger);
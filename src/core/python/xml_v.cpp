@@ -60,7 +60,8 @@ MI_PY_EXPORT(xml) {
 
     m.def(
         "load_file",
-        [](const std::string &name, bool update_scene, bool parallel, py::kwargs kwargs) {
+        [](const std::string &name, bool update_scene, bool parallel,
+           bool skip_unreferenced, py::kwargs kwargs) {
             xml::ParameterList param;
             if (kwargs) {
                 for (auto [k, v] : kwargs)
@@ -74,17 +75,20 @@ MI_PY_EXPORT(xml) {
             std::vector<ref<Object>> objects;
             {
                 py::gil_scoped_release release;
-                objects = xml::load_file(name, GET_VARIANT(), param, update_scene, parallel);
+                objects = xml::load_file(name, GET_VARIANT(), param, update_scene,
+                                         parallel, skip_unreferenced);
             }
 
             return single_object_or_list(objects);
         },
         "path"_a, "update_scene"_a = false, "parallel"_a = true,
+        "skip_unreferenced"_a = false,
         D(xml, load_file));
 
     m.def(
         "load_string",
-        [](const std::string &name, bool parallel, py::kwargs kwargs) {
+        [](const std::string &name, bool parallel, bool skip_unreferenced,
+           py::kwargs kwargs) {
             xml::ParameterList param;
             if (kwargs) {
                 for (auto [k, v] : kwargs)
@@ -98,12 +102,13 @@ MI_PY_EXPORT(xml) {
             std::vector<ref<Object>> objects;
             {
                 py::gil_scoped_release release;
-                objects = xml::load_string(name, GET_VARIANT(), param, parallel);
+                objects = xml::load_string(name, GET_VARIANT(), param, parallel,
+                                           skip_unreferenced);
             }
 
             return single_object_or_list(objects);
         },
-        "string"_a, "parallel"_a = true,
+        "string"_a, "parallel"_a = true, "skip_unreferenced"_a = false,
         D(xml, load_string));
 
     m.def(
@@ -261,6 +266,7 @@ void parse_dictionary(DictParseContext &ctx,
 
     Properties &props = inst.props;
     props.set_plugin_name(type);
+    props.reserve(dict.size());
 
     std::string id;
 
@@ -109,6 +109,59 @@ RadicalInverse::RadicalInverse(size_t max_base, int scramble) : m_scramble(scram
     }
     Log(Debug, "Done (took %s)", util::time_string((float) timer.value()));
 
+    /* Precompute tables that resolve blocks of several digits of the small
+       bases using a single lookup (at most 4096 entries per table) */
+    const uint32_t max_table_size = 4096;
+    while (m_table_count < m_base_count &&
+           (uint32_t) m_base[m_table_count].value * m_base[m_table_count].value <= max_table_size)
+        m_table_count++;
+
+    m_tables = std::unique_ptr<DigitTable[]>(new DigitTable[m_table_count]);
+
+    size_t table_storage_size = 0;
+    for (size_t i = 0; i < m_table_count; ++i) {
+        DigitTable &t = m_tables[i];
+        uint32_t prime = m_base[i].value;
+        t.size = prime;
+        t.digits = 1;
+        while (t.size * prime <= max_table_size) {
+            t.size *= prime;
+            t.digits++;
+        }
+        t.recip = 1.f / (float) t.size;
+        t.divisor = dr::divisor<uint64_t>(t.size);
+        table_storage_size += 2 * t.size;
+    }
+
+    Log(Debug, "Precomputing digit tables for %i bases (%s)", m_table_count,
+        util::mem_string(table_storage_size * sizeof(uint16_t)));
+
+    /* Zero-initialized, with padding for 64bit gather operations */
+    m_table_storage =
+        std::unique_ptr<uint16_t[]>(new uint16_t[table_storage_size + 3]());
+
+    uint16_t *ptr = m_table_storage.get();
+    for (size_t i = 0; i < m_table_count; ++i) {
+        DigitTable &t = m_tables[i];
+        const uint16_t *perm = m_permutations[i];
+        uint32_t prime = m_base[i].value;
+
+        t.values = ptr; ptr += t.size;
+        t.scrambled = ptr; ptr += t.size;
+
+        for (uint32_t j = 0; j < t.size; ++j) {
+            uint32_t index = j, value = 0, scrambled = 0;
+            for (uint32_t k = 0; k < t.digits; ++k) {
+                uint32_t digit = index % prime;
+                value = value * prime + digit;
+                scrambled = scrambled * prime + perm[digit];
+                index /= prime;
+            }
+            t.values[j] = (uint16_t) value;
+            t.scrambled[j] = (uint16_t) scrambled;
+        }
+    }
+
     /* Invert the first two permutations */
     m_inv_permutation_storage = std::unique_ptr<uint16_t[]>(new uint16_t[5]);
     m_inv_permutations = std::unique_ptr<uint16_t*[]>(new uint16_t*[2]);
@@ -124,6 +177,20 @@ size_t RadicalInverse::base(size_t index) const {
     return (size_t) m_base[index].value;
 }
 
+size_t RadicalInverse::digits_per_lookup(size_t base_index) const {
+    if (unlikely(base_index >= m_base_count))
+        Throw("RadicalInverse::digits_per_lookup(): out of bounds");
+    return base_index < m_table_count ? (size_t) m_tables[base_index].digits : 1;
+}
+
+const uint16_t *RadicalInverse::digit_table(size_t base_index, bool scrambled) const {
+    if (unlikely(base_index >= m_base_count))
+        Throw("RadicalInverse::digit_table(): out of bounds");
+    if (base_index >= m_table_count)
+        return nullptr;
+    return scrambled ? m_tables[base_index].scrambled : m_tables[base_index].values;
+}
+
 /**
  * \ref Compute the Faure permutations using dynamic programming
  *
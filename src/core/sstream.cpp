@@ -0,0 +1,292 @@
+#include <mitsuba/core/sstream.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/logger.h>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+
+#if defined(_WIN32)
+#  include <winsock2.h>
+#  include <ws2tcpip.h>
+#else
+#  include <cerrno>
+#  include <netdb.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+NAMESPACE_BEGIN(mitsuba)
+NAMESPACE_BEGIN(detail)
+
+#if defined(_WIN32)
+using socket_t = SOCKET;
+static const socket_t invalid_socket = INVALID_SOCKET;
+
+static void socket_init() {
+    static std::once_flag flag;
+    std::call_once(flag, []() {
+        WSADATA data;
+        if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+            Throw("Could not initialize the Winsock library!");
+    });
+}
+
+static std::string socket_error() {
+    return tfm::format("error %i", WSAGetLastError());
+}
+
+static void socket_close(socket_t s) { closesocket(s); }
+#else
+using socket_t = int;
+static const socket_t invalid_socket = -1;
+
+static void socket_init() { }
+
+static std::string socket_error() { return strerror(errno); }
+
+static void socket_close(socket_t s) { ::close(s); }
+#endif
+
+/// Disable Nagle's algorithm, since messages are flushed explicitly
+static void socket_configure(socket_t s) {
+    int flag = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (const char *) &flag, sizeof(flag));
+#if defined(SO_NOSIGPIPE)
+    // Report broken connections as errors instead of raising SIGPIPE
+    setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, (const char *) &flag, sizeof(flag));
+#endif
+}
+
+NAMESPACE_END(detail)
+
+SocketStream::SocketStream(const std::string &host, uint16_t port)
+    : Stream(), m_socket(-1), m_received(0), m_sent(0) {
+    detail::socket_init();
+    m_peer = tfm::format("%s:%u", host, port);
+
+    addrinfo hints, *info = nullptr;
+    memset(&hints, 0, sizeof(addrinfo));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    int rv = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &info);
+    if (rv != 0)
+        Throw("SocketStream: could not resolve \"%s\": %s", host,
+              gai_strerror(rv));
+
+    // Try all resolved addresses until a connection succeeds
+    detail::socket_t s = detail::invalid_socket;
+    for (addrinfo *it = info; it; it = it->ai_next) {
+        s = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+        if (s == detail::invalid_socket)
+            continue;
+        if (connect(s, it->ai_addr, (int) it->ai_addrlen) == 0)
+            break;
+        detail::socket_close(s);
+        s = detail::invalid_socket;
+    }
+    freeaddrinfo(info);
+
+    if (s == detail::invalid_socket)
+        Throw("SocketStream: could not connect to %s: %s", m_peer,
+              detail::socket_error());
+
+    detail::socket_configure(s);
+    m_socket = (int64_t) s;
+    set_byte_order(EBigEndian);
+}
+
+SocketStream::SocketStream(int64_t socket, const std::string &peer)
+    : Stream(), m_socket(socket), m_peer(peer), m_received(0), m_sent(0) {
+    set_byte_order(EBigEndian);
+}
+
+SocketStream::~SocketStream() {
+    close();
+}
+
+void SocketStream::close() {
+    if (m_socket == -1)
+        return;
+    detail::socket_close((detail::socket_t) m_socket);
+    m_socket = -1;
+}
+
+bool SocketStream::is_closed() const { return m_socket == -1; }
+
+void SocketStream::read(void *p, size_t size) {
+    if (is_closed())
+        Throw("Attempted to read from a closed stream: %s", to_string());
+
+    char *ptr = (char *) p;
+    size_t done = 0;
+    while (done < size) {
+        int chunk = (int) std::min(size - done, (size_t) (1 << 30));
+        auto n = recv((detail::socket_t) m_socket, ptr + done, chunk, 0);
+        if (n == 0)
+            throw EOFException(tfm::format("SocketStream: connection to %s "
+                                           "closed after receiving %zu out of "
+                                           "%zu bytes", m_peer, done, size),
+                               done);
+        if (n < 0)
+            Throw("SocketStream: I/O error while receiving from %s: %s",
+                  m_peer, detail::socket_error());
+        done += (size_t) n;
+    }
+    m_received += size;
+}
+
+void SocketStream::write(const void *p, size_t size) {
+    if (is_closed())
+        Throw("Attempted to write to a closed stream: %s", to_string());
+
+    const char *ptr = (const char *) p;
+    size_t done = 0;
+    while (done < size) {
+        int chunk = (int) std::min(size - done, (size_t) (1 << 30));
+#if defined(MSG_NOSIGNAL)
+        auto n = send((detail::socket_t) m_socket, ptr + done, chunk, MSG_NOSIGNAL);
+#else
+        auto n = send((detail::socket_t) m_socket, ptr + done, chunk, 0);
+#endif
+        if (n <= 0)
+            Throw("SocketStream: I/O error while sending to %s: %s", m_peer,
+                  detail::socket_error());
+        done += (size_t) n;
+    }
+    m_sent += size;
+}
+
+void SocketStream::seek(size_t) {
+    Throw("SocketStream does not support seeking.");
+}
+
+void SocketStream::truncate(size_t) {
+    Throw("SocketStream does not support truncation.");
+}
+
+size_t SocketStream::tell() const { return m_received; }
+size_t SocketStream::size() const { return m_sent; }
+void SocketStream::flush() { /* Data is sent right away */ }
+bool SocketStream::can_write() const { return !is_closed(); }
+bool SocketStream::can_read() const { return !is_closed(); }
+
+std::string SocketStream::to_string() const {
+    std::ostringstream oss;
+    oss << "SocketStream[" << std::endl
+        << "  peer = \"" << m_peer << "\"," << std::endl
+        << "  closed = " << is_closed() << "," << std::endl
+        << "  received = " << m_received << "," << std::endl
+        << "  sent = " << m_sent << std::endl
+        << "]";
+    return oss.str();
+}
+
+SocketListener::SocketListener(uint16_t port, const std::string &address)
+    : Object(), m_socket(-1), m_address(address), m_port(port) {
+    detail::socket_init();
+
+    addrinfo hints, *info = nullptr;
+    memset(&hints, 0, sizeof(addrinfo));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+
+    int rv = getaddrinfo(address.c_str(), std::to_string(port).c_str(), &hints,
+                         &info);
+    if (rv != 0)
+        Throw("SocketListener: could not resolve \"%s\": %s", address,
+              gai_strerror(rv));
+
+    // Listen on the first resolved address that can be bound
+    detail::socket_t s = detail::invalid_socket;
+    std::string error = "no address";
+    for (addrinfo *it = info; it; it = it->ai_next) {
+        s = socket(it->ai_family, it->ai_socktype, it->ai_protocol);
+        if (s == detail::invalid_socket) {
+            error = detail::socket_error();
+            continue;
+        }
+
+        // Allow restarting a server right away on the same port
+        int flag = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char *) &flag,
+                   sizeof(flag));
+
+        if (bind(s, it->ai_addr, (int) it->ai_addrlen) == 0 &&
+            listen(s, SOMAXCONN) == 0)
+            break;
+        error = detail::socket_error();
+        detail::socket_close(s);
+        s = detail::invalid_socket;
+    }
+    freeaddrinfo(info);
+
+    if (s == detail::invalid_socket)
+        Throw("SocketListener: could not listen on %s:%u: %s", address, port,
+              error);
+
+    // Determine the port that was picked by the operating system
+    sockaddr_storage local;
+    socklen_t local_size = sizeof(sockaddr_storage);
+    if (getsockname(s, (sockaddr *) &local, &local_size) == 0) {
+        if (local.ss_family == AF_INET)
+            m_port = ntohs(((sockaddr_in *) &local)->sin_port);
+        else if (local.ss_family == AF_INET6)
+            m_port = ntohs(((sockaddr_in6 *) &local)->sin6_port);
+    }
+
+    m_socket = (int64_t) s;
+}
+
+SocketListener::~SocketListener() {
+    close();
+}
+
+void SocketListener::close() {
+    if (m_socket == -1)
+        return;
+    detail::socket_close((detail::socket_t) m_socket);
+    m_socket = -1;
+}
+
+ref<SocketStream> SocketListener::accept() {
+    if (is_closed())
+        Throw("Attempted to accept a connection on a closed listener: %s",
+              to_string());
+
+    sockaddr_storage remote;
+    socklen_t remote_size = sizeof(sockaddr_storage);
+    detail::socket_t s = ::accept((detail::socket_t) m_socket,
+                                  (sockaddr *) &remote, &remote_size);
+    if (s == detail::invalid_socket)
+        Throw("SocketListener: could not accept a connection on %s:%u: %s",
+              m_address, m_port, detail::socket_error());
+
+    char host[NI_MAXHOST], service[NI_MAXSERV];
+    std::string peer = "unknown";
+    if (getnameinfo((sockaddr *) &remote, remote_size, host, sizeof(host),
+                    service, sizeof(service),
+                    NI_NUMERICHOST | NI_NUMERICSERV) == 0)
+        peer = tfm::format("%s:%s", host, service);
+
+    detail::socket_configure(s);
+    return new SocketStream((int64_t) s, peer);
+}
+
+std::string SocketListener::to_string() const {
+    std::ostringstream oss;
+    oss << "SocketListener[" << std::endl
+        << "  address = \"" << m_address << "\"," << std::endl
+        << "  port = " << m_port << "," << std::endl
+        << "  closed = " << is_closed() << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS(SocketStream, Stream)
+MI_IMPLEMENT_CLASS(SocketListener, Object)
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,153 @@
+#include <mitsuba/core/statistics.h>
+#include <mitsuba/core/logger.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+#if defined(MI_ENABLE_STATISTICS)
+/* Counters are identified by consecutive IDs. Every thread stores its copies
+   in chunks that are allocated when one of their counters is first
+   incremented, and that never move, such that value() can read them while
+   the thread keeps counting. */
+static constexpr uint32_t stats_chunk_size = 4096;
+static constexpr uint32_t stats_max_chunks = 4096;
+
+struct StatisticsThreadData {
+    std::atomic<std::atomic<uint64_t> *> chunks[stats_max_chunks] { };
+
+    std::atomic<uint64_t> &slot(uint32_t id) {
+        std::atomic<uint64_t> *chunk =
+            chunks[id / stats_chunk_size].load(std::memory_order_relaxed);
+        if (unlikely(!chunk)) {
+            chunk = new std::atomic<uint64_t>[stats_chunk_size];
+            for (uint32_t i = 0; i < stats_chunk_size; ++i)
+                chunk[i].store(0, std::memory_order_relaxed);
+            chunks[id / stats_chunk_size].store(chunk, std::memory_order_release);
+        }
+        return chunk[id % stats_chunk_size];
+    }
+
+    ~StatisticsThreadData() {
+        for (auto &chunk : chunks)
+            delete[] chunk.load(std::memory_order_relaxed);
+    }
+};
+
+struct StatisticsRegistry {
+    std::mutex mutex;
+    std::vector<StatisticsThreadData *> threads;
+    /// Counts of threads that have exited
+    StatisticsThreadData retired;
+    std::atomic<uint32_t> next_id { 0 };
+};
+
+static StatisticsRegistry *stats_registry() {
+    // Intentionally leaked: threads may exit during static destruction
+    static StatisticsRegistry *registry = new StatisticsRegistry();
+    return registry;
+}
+
+/// Registers the data of a thread and folds it into 'retired' on exit
+struct StatisticsThreadHandle {
+    StatisticsThreadData *data;
+
+    StatisticsThreadHandle() : data(new StatisticsThreadData()) {
+        StatisticsRegistry *registry = stats_registry();
+        std::lock_guard<std::mutex> guard(registry->mutex);
+        registry->threads.push_back(data);
+    }
+
+    ~StatisticsThreadHandle() {
+        StatisticsRegistry *registry = stats_registry();
+        std::lock_guard<std::mutex> guard(registry->mutex);
+        for (uint32_t i = 0; i < stats_max_chunks; ++i) {
+            std::atomic<uint64_t> *chunk = data->chunks[i].load();
+            if (!chunk)
+                continue;
+            for (uint32_t j = 0; j < stats_chunk_size; ++j) {
+                uint64_t count = chunk[j].load(std::memory_order_relaxed);
+                if (count)
+                    registry->retired.slot(i * stats_chunk_size + j)
+                        .fetch_add(count, std::memory_order_relaxed);
+            }
+        }
+        auto &threads = registry->threads;
+        threads.erase(std::remove(threads.begin(), threads.end(), data),
+                      threads.end());
+        delete data;
+    }
+};
+
+static thread_local StatisticsThreadHandle stats_thread_handle;
+
+static std::atomic<uint64_t> *stats_find(const StatisticsThreadData *data,
+                                         uint32_t id) {
+    std::atomic<uint64_t> *chunk =
+        data->chunks[id / stats_chunk_size].load(std::memory_order_acquire);
+    return chunk ? chunk + id % stats_chunk_size : nullptr;
+}
+#endif
+
+StatisticsCounter::StatisticsCounter() : m_id(0) {
+#if defined(MI_ENABLE_STATISTICS)
+    m_id = stats_registry()->next_id++;
+    if (m_id == stats_chunk_size * stats_max_chunks)
+        Log(Warn, "StatisticsCounter: ran out of counters, further ones "
+                  "will not count!");
+#endif
+}
+
+StatisticsCounter::~StatisticsCounter() {
+    /* IDs are not reused, hence their (stale) counts can stay */
+}
+
+#if defined(MI_ENABLE_STATISTICS)
+void StatisticsCounter::increment(uint64_t amount) const {
+    if (unlikely(m_id >= stats_chunk_size * stats_max_chunks))
+        return;
+    // Only the calling thread writes to this slot, no read-modify-write needed
+    std::atomic<uint64_t> &slot = stats_thread_handle.data->slot(m_id);
+    slot.store(slot.load(std::memory_order_relaxed) + amount,
+               std::memory_order_relaxed);
+}
+#endif
+
+uint64_t StatisticsCounter::value() const {
+#if defined(MI_ENABLE_STATISTICS)
+    if (m_id >= stats_chunk_size * stats_max_chunks)
+        return 0;
+    StatisticsRegistry *registry = stats_registry();
+    std::lock_guard<std::mutex> guard(registry->mutex);
+    uint64_t result = 0;
+    if (auto *slot = stats_find(&registry->retired, m_id))
+        result += slot->load(std::memory_order_relaxed);
+    for (const StatisticsThreadData *data : registry->threads) {
+        if (auto *slot = stats_find(data, m_id))
+            result += slot->load(std::memory_order_relaxed);
+    }
+    return result;
+#else
+    return 0;
+#endif
+}
+
+void StatisticsCounter::reset() {
+#if defined(MI_ENABLE_STATISTICS)
+    if (m_id >= stats_chunk_size * stats_max_chunks)
+        return;
+    StatisticsRegistry *registry = stats_registry();
+    std::lock_guard<std::mutex> guard(registry->mutex);
+    if (auto *slot = stats_find(&registry->retired, m_id))
+        slot->store(0, std::memory_order_relaxed);
+    for (StatisticsThreadData *data : registry->threads) {
+        if (auto *slot = stats_find(data, m_id))
+            slot->store(0, std::memory_order_relaxed);
+    }
+#endif
+}
+
+NAMESPACE_END(mitsuba)
@@ -7,6 +7,9 @@
 #include <drjit/array.h>
 #include <drjit/half.h>
 #include <drjit/color.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
+#include <atomic>
 #include <unordered_map>
 #include <ostream>
 #include <map>
@@ -1243,10 +1246,25 @@ static std::unordered_map<
     hasher<std::pair<ref<const Struct>, ref<const Struct>>>,
     comparator<std::pair<ref<const Struct>, ref<const Struct>>>> __cache;
 
-StructConverter::StructConverter(const Struct *source, const Struct *target, bool dither)
- : m_source(source), m_target(target) {
+StructConverter::StructConverter(const Struct *source, const Struct *target,
+                                 bool dither, bool jit)
+    : m_source(source), m_target(target), m_dither(dither) {
 #if MI_STRUCTCONVERTER_USE_JIT == 1
+    if (jit) {
+        compile();
+        return;
+    }
+#else
+    (void) jit;
+#endif
+    prepare();
+}
+
+#if MI_STRUCTCONVERTER_USE_JIT == 1
+void StructConverter::compile() {
     using namespace asmjit;
+    const Struct *source = m_source.get(), *target = m_target.get();
+    bool dither = m_dither;
 
     // Use the Jit instance to cache structure converters
     auto jit = Jit::get_instance();
@@ -1493,12 +1511,8 @@ StructConverter::StructConverter(const Struct *source, const Struct *target, boo
     #endif
 
     __cache[key] = (void *) m_func;
-#else
-    m_dither = dither;
-#endif
 }
-
-#if MI_STRUCTCONVERTER_USE_JIT == 0
+#endif
 
 bool StructConverter::load(const uint8_t *src, const Struct::Field &f, Value &value) const {
     bool source_swap = m_source->byte_order() != Struct::host_byte_order();
@@ -1752,114 +1766,278 @@ void StructConverter::save(uint8_t *dst, const Struct::Field &f, Value value, si
     }
 }
 
-bool StructConverter::convert_2d(size_t width, size_t height, const void *src_, void *dest_) const {
-    using namespace mitsuba::detail;
-
-    size_t source_size = m_source->size();
-    size_t target_size = m_target->size();
-    Struct::Field weight_field, alpha_field;
-
-    bool has_weight = false, has_alpha = false, has_multiple_alpha_channels = false;
-    std::vector<Struct::Field> assert_fields;
-    for (Struct::Field f : *m_source) {
+void StructConverter::prepare() {
+    for (const Struct::Field &f : *m_source) {
         if (has_flag(f.flags, Struct::Flags::Assert) && !m_target->has_field(f.name))
-            assert_fields.push_back(f);
+            m_assert_fields.push_back(f);
         if (has_flag(f.flags, Struct::Flags::Weight)) {
-            weight_field = f;
-            has_weight = true;
+            m_weight_field = f;
+            m_has_weight = true;
         }
         if (has_flag(f.flags, Struct::Flags::Alpha)) {
-            has_multiple_alpha_channels |= has_alpha;
-            alpha_field = f;
-            has_alpha = true;
+            m_has_multiple_alpha_channels |= m_has_alpha;
+            m_alpha_field = f;
+            m_has_alpha = true;
         }
     }
     for (const Struct::Field &f : *m_target) {
-        if (has_flag(f.flags, Struct::Flags::Weight) && has_weight)
-            has_weight = false;
+        if (has_flag(f.flags, Struct::Flags::Weight) && m_has_weight)
+            m_has_weight = false;
     }
 
+    bool source_swap = m_source->byte_order() != Struct::host_byte_order(),
+         target_swap = m_target->byte_order() != Struct::host_byte_order();
+    uint32_t flag_mask = Struct::Flags::Normalized | Struct::Flags::Gamma,
+             special_channels_mask = Struct::Flags::Weight | Struct::Flags::Alpha;
+    bool uses_alpha = false;
+
+    for (const Struct::Field &f : *m_target) {
+        FieldStep step;
+        step.target = f;
+        step.alpha = FieldStep::Alpha::None;
+
+        // Type and flags of the value before it is saved (see load())
+        Struct::Type type = struct_type_v<Float>;
+        uint32_t flags = +Struct::Flags::Empty;
+        if (!f.blend.empty()) {
+            step.kind = FieldStep::Kind::Blend;
+            for (auto kv : f.blend)
+                step.blend.emplace_back(kv.first, m_source->field(kv.second));
+        } else if (!m_source->has_field(f.name) && has_flag(f.flags, Struct::Flags::Default)) {
+            step.kind = FieldStep::Kind::Default;
+            type = Struct::Type::Float64;
+        } else {
+            step.kind = FieldStep::Kind::Load;
+            step.source = m_source->field(f.name);
+            type = step.source.type == Struct::Type::Float16 ? Struct::Type::Float32
+                                                             : step.source.type;
+            flags = step.source.flags;
+        }
+
+        step.linearize =
+            !((type == f.type || (Struct::is_integer(type) &&
+                                  Struct::is_integer(f.type) &&
+                                  !has_flag(f.flags, Struct::Flags::Normalized))) &&
+              ((flags & flag_mask) == (f.flags & flag_mask))) || m_has_weight;
+
+        bool source_premult = has_flag(flags, Struct::Flags::PremultipliedAlpha);
+        bool target_premult = has_flag(f.flags, Struct::Flags::PremultipliedAlpha);
+        if (m_has_alpha && ((f.flags & special_channels_mask) == 0) &&
+            source_premult != target_premult && f.blend.empty()) {
+            step.alpha = target_premult ? FieldStep::Alpha::Premultiply
+                                        : FieldStep::Alpha::Unpremultiply;
+            step.linearize = true;
+            uses_alpha = true;
+        }
+
+        if (step.kind == FieldStep::Kind::Load &&
+            !has_flag(step.source.flags, Struct::Flags::Assert)) {
+            // Fields that keep their type and encoding are copied
+            if (!step.linearize && step.alpha == FieldStep::Alpha::None &&
+                step.source.type == f.type && source_swap == target_swap) {
+                m_copy_steps.push_back({ step.source.offset, f.offset, f.size });
+                continue;
+            }
+
+            // Tabulate the conversion of all 8-bit values
+            if (step.linearize && step.source.size == 1) {
+                Struct::Field field = step.source;
+                field.offset = 0;
+                step.table.resize(256);
+                for (uint32_t i = 0; i < 256; ++i) {
+                    uint8_t byte = (uint8_t) i;
+                    Value value;
+                    load(&byte, field, value);
+                    linearize(value);
+                    step.table[i] = value.f;
+                }
+            }
+        }
+
+        m_field_steps.push_back(std::move(step));
+    }
+
+    // The alpha value is only needed for (un)premultiplication
+    if (m_has_alpha && !uses_alpha &&
+        !has_flag(m_alpha_field.flags, Struct::Flags::Assert))
+        m_has_alpha = false;
+
+    // Merge the copies of adjacent fields
+    std::sort(m_copy_steps.begin(), m_copy_steps.end(),
+              [](const CopyStep &a, const CopyStep &b) {
+                  return a.target_offset < b.target_offset;
+              });
+    std::vector<CopyStep> copy_steps;
+    for (const CopyStep &c : m_copy_steps) {
+        if (!copy_steps.empty()) {
+            CopyStep &prev = copy_steps.back();
+            if (prev.source_offset + prev.size == c.source_offset &&
+                prev.target_offset + prev.size == c.target_offset) {
+                prev.size += c.size;
+                continue;
+            }
+        }
+        copy_steps.push_back(c);
+    }
+    m_copy_steps = std::move(copy_steps);
+
+    m_copy_records = m_field_steps.empty() && m_assert_fields.empty() &&
+                     !m_has_weight && !m_has_alpha &&
+                     m_source->size() == m_target->size() &&
+                     m_copy_steps.size() == 1 &&
+                     m_copy_steps[0].source_offset == 0 &&
+                     m_copy_steps[0].target_offset == 0 &&
+                     m_copy_steps[0].size == m_source->size();
+}
+
+/* Number of elements that are converted by each task. It is a multiple of
+   the period of the dither matrix for conversions of 1D arrays. */
+static constexpr size_t convert_block_size = 256 * 64;
+
+size_t StructConverter::m_parallel_threshold = 1 << 16;
+
+bool StructConverter::convert_2d(size_t width, size_t height, const void *src_,
+                                 void *dest_) const {
+    size_t count = width * height;
+    if (count < m_parallel_threshold || count <= convert_block_size)
+        return convert_2d_serial(width, height, src_, dest_);
+
+    const uint8_t *src = (const uint8_t *) src_;
+    uint8_t *dest = (uint8_t *) dest_;
+    size_t source_size = m_source->size(),
+           target_size = m_target->size();
+
+    /* Split 1D arrays into blocks of elements, and images into bands of
+       rows. The dither pattern repeats every 256 rows, hence bands of a
+       dithered image must start at a multiple of this height. */
+    size_t block_width = width, block_height = 1;
+    if (height == 1) {
+        block_width = convert_block_size;
+    } else if (m_dither) {
+        block_height = 256;
+    } else {
+        block_height = std::max<size_t>(1, convert_block_size / width);
+    }
+
+    size_t blocks_x = (width + block_width - 1) / block_width,
+           blocks_y = (height + block_height - 1) / block_height,
+           block_count = blocks_x * blocks_y;
+    if (block_count < 2)
+        return convert_2d_serial(width, height, src_, dest_);
+
+    std::atomic<bool> success = true;
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, block_count, 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                size_t x = (i % blocks_x) * block_width,
+                       y = (i / blocks_x) * block_height,
+                       w = std::min(block_width, width - x),
+                       h = std::min(block_height, height - y),
+                       offset = y * width + x;
+                if (!convert_2d_serial(w, h, src + offset * source_size,
+                                       dest + offset * target_size))
+                    success = false;
+            }
+        }
+    );
+
+    return success;
+}
+
+bool StructConverter::convert_2d_portable(size_t width, size_t height,
+                                          const void *src_, void *dest_) const {
+    using namespace mitsuba::detail;
+
+    size_t source_size = m_source->size();
+    size_t target_size = m_target->size();
+
     uint8_t *src  = (uint8_t *) src_;
     uint8_t *dest = (uint8_t *) dest_;
 
+    if (m_copy_records) {
+        memcpy(dest, src, width * height * source_size);
+        return true;
+    }
+
     for (size_t y = 0; y<height; ++y) {
         for (size_t x = 0; x<width; ++x) {
             Float inv_weight = 1.f;
-            for (const Struct::Field &f : assert_fields) {
+            for (const Struct::Field &f : m_assert_fields) {
                 Value value;
                 if (!load(src, f, value))
                     return false;
             }
 
-            if (has_weight) {
+            if (m_has_weight) {
                 Value value;
-                if (!load(src, weight_field, value))
+                if (!load(src, m_weight_field, value))
                     return false;
                 linearize(value);
                 inv_weight = value.f != 0.f ? (1.f / value.f) : 1.f;
             }
 
             Float alpha = 1.f, inv_alpha = 1.f;
-            if (has_alpha) {
+            if (m_has_alpha) {
                 Value value;
-                if (!load(src, alpha_field, value))
+                if (!load(src, m_alpha_field, value))
                     return false;
                 linearize(value);
                 alpha = value.f;
                 inv_alpha = alpha > 0 ? 1.f / alpha : 0.f;
             }
 
-            for (const Struct::Field &f : *m_target) {
+            for (const CopyStep &c : m_copy_steps)
+                memcpy(dest + c.target_offset, src + c.source_offset, c.size);
+
+            for (const FieldStep &step : m_field_steps) {
                 Value value;
 
-                if (f.blend.empty()) {
-                    if (!m_source->has_field(f.name) && has_flag(f.flags, Struct::Flags::Default)) {
-                        value.d = f.default_;
+                switch (step.kind) {
+                    case FieldStep::Kind::Load:
+                        if (!step.table.empty()) {
+                            value.type = struct_type_v<Float>;
+                            value.flags = step.source.flags & ~Struct::Flags::Gamma;
+                            value.f = step.table[src[step.source.offset]];
+                        } else if (!load(src, step.source, value)) {
+                            return false;
+                        }
+                        break;
+
+                    case FieldStep::Kind::Default:
+                        value.d = step.target.default_;
                         value.type = Struct::Type::Float64;
                         value.flags = +Struct::Flags::Empty;
-                    } else {
-                        if (!load(src, m_source->field(f.name), value))
-                            return false;
-                    }
-                } else {
-                    value.type = struct_type_v<Float>;
-                    value.f = 0;
-                    value.flags = +Struct::Flags::Empty;
-                    for (auto kv : f.blend) {
-                        Value value2;
-                        if (!load(src, m_source->field(kv.second), value2))
-                            return false;
-                        linearize(value2);
-                        value.f += (Float) kv.first * value2.f;
-                    }
+                        break;
+
+                    case FieldStep::Kind::Blend:
+                        value.type = struct_type_v<Float>;
+                        value.f = 0;
+                        value.flags = +Struct::Flags::Empty;
+                        for (auto kv : step.blend) {
+                            Value value2;
+                            if (!load(src, kv.second, value2))
+                                return false;
+                            linearize(value2);
+                            value.f += (Float) kv.first * value2.f;
+                        }
+                        break;
                 }
 
-                uint32_t flag_mask = Struct::Flags::Normalized | Struct::Flags::Gamma;
-                if ((!((value.type == f.type || (Struct::is_integer(value.type) &&
-                                                 Struct::is_integer(f.type) &&
-                                                 !has_flag(f.flags, Struct::Flags::Normalized))) &&
-                    ((value.flags & flag_mask) == (f.flags & flag_mask)))) || has_weight)
+                if (step.linearize)
                     linearize(value);
 
-                if (has_weight)
+                if (m_has_weight)
                     value.f *= inv_weight;
 
-                uint32_t special_channels_mask = Struct::Flags::Weight | Struct::Flags::Alpha;
-                bool source_premult = has_flag(value.flags, Struct::Flags::PremultipliedAlpha);
-                bool target_premult = has_flag(f.flags, Struct::Flags::PremultipliedAlpha);
-                if (has_alpha && ((f.flags & special_channels_mask) == 0) &&
-                    source_premult != target_premult && f.blend.empty()) {
-                    linearize(value);
-                    if (has_multiple_alpha_channels)
+                if (step.alpha != FieldStep::Alpha::None) {
+                    if (m_has_multiple_alpha_channels)
                         Throw("Found multiple alpha channels: Alpha (un)premultiplication expects a single alpha channel");
 
-                    if (target_premult && !source_premult) {
-                        value.f *= alpha;
-                    } else if (!target_premult && source_premult) {
-                        value.f *= inv_alpha;
-                    }
+                    value.f *= step.alpha == FieldStep::Alpha::Premultiply
+                                   ? alpha : inv_alpha;
                 }
-                save(dest, f, value, x, y);
+                save(dest, step.target, value, x, y);
             }
 
             src += source_size;
@@ -1868,7 +2046,6 @@ bool StructConverter::convert_2d(size_t width, size_t height, const void *src_,
     }
     return true;
 }
-#endif
 
 std::string StructConverter::to_string() const {
     std::ostringstream oss;
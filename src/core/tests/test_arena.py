@@ -0,0 +1,57 @@
+import pytest
+import mitsuba as mi
+
+
+def test01_allocate(variant_scalar_rgb):
+    arena = mi.ScratchArena(1024)
+    assert arena.chunk_count() == 0 and arena.bytes_used() == 0
+
+    a = arena.allocate(10, 1)
+    b = arena.allocate(16, 64)
+    assert b % 64 == 0 and b >= a + 10
+    assert arena.chunk_count() == 1 and arena.capacity() == 1024
+
+    # Requests exceeding the chunk size get a chunk of their own
+    arena.allocate(4096)
+    assert arena.chunk_count() == 2 and arena.capacity() >= 1024 + 4096
+
+    with pytest.raises(RuntimeError):
+        arena.allocate(1 << 20, 3)
+
+
+def test02_reset_merges_chunks(variant_scalar_rgb):
+    arena = mi.ScratchArena(1024)
+    for i in range(10):
+        arena.allocate(512)
+    assert arena.chunk_count() > 1
+    capacity = arena.capacity()
+
+    arena.reset()
+    assert arena.chunk_count() == 1 and arena.capacity() == capacity
+    assert arena.bytes_used() == 0
+
+    # The same allocations no longer touch the heap
+    allocations = mi.ScratchArena.heap_allocations()
+    for k in range(3):
+        arena.reset()
+        for i in range(10):
+            arena.allocate(512)
+    assert mi.ScratchArena.heap_allocations() == allocations
+
+
+def test03_rewind(variant_scalar_rgb):
+    arena = mi.ScratchArena(1024)
+    arena.allocate(100)
+    marker = arena.mark()
+    used = arena.bytes_used()
+
+    for i in range(10):
+        arena.allocate(512)
+    chunks = arena.chunk_count()
+    arena.rewind(marker)
+    assert arena.bytes_used() == used
+
+    # Rewinding keeps the chunks for subsequent allocations
+    for i in range(10):
+        arena.allocate(512)
+    assert arena.chunk_count() == chunks
@@ -400,3 +400,106 @@ def test_check_weight_division(variant_scalar_rgb):
     assert np.all(x[0, 0, :] == (2, 0, 0, 0))
     assert np.all(x[1, 0, :] == (1, 0, 0, 0))
     assert np.all(x[2, 0, :] == (2, 0, 0, 0))
+
+
+@pytest.mark.parametrize('compression', ['None', 'RLE', 'ZIPS', 'ZIP', 'PIZ', 'PXR24', 'DWAA'])
+def test_write_exr_compression(variant_scalar_rgb, tmpdir, np_rng, compression):
+    b = mi.Bitmap(mi.Bitmap.PixelFormat.RGB, mi.Struct.Type.Float32, [37, 300])
+    ref = np.float32(np_rng.random((300, 37, 3)))
+    np.array(b, copy=False)[:] = ref[...]
+    tmp_file = os.path.join(str(tmpdir), "out_%s.exr" % compression)
+    b.write(tmp_file, compression=getattr(mi.Bitmap.EXRCompression, compression))
+    b2 = np.array(mi.Bitmap(tmp_file))
+    if compression in ['PXR24', 'DWAA']:
+        assert np.abs(np.mean(b2 - ref)) < 1e-2
+    else:
+        assert np.all(b2 == ref)
+
+
+def test_write_async(variant_scalar_rgb, tmpdir, np_rng):
+    b = mi.Bitmap(mi.Bitmap.PixelFormat.RGB, mi.Struct.Type.Float32, [10, 20])
+    ref = np.float32(np_rng.random((20, 10, 3)))
+    np.array(b, copy=False)[:] = ref[...]
+    tmp_file = os.path.join(str(tmpdir), "out.exr")
+    b.write_async(tmp_file, compression=mi.Bitmap.EXRCompression.ZIPS)
+    mi.Thread.wait_for_tasks()
+    assert np.all(np.array(mi.Bitmap(tmp_file)) == ref)
+
+
+@pytest.mark.parametrize('bc', ['Clamp', 'Repeat', 'Mirror', 'Zero', 'One'])
+@pytest.mark.parametrize('res', [7, 45])
+def test_resample_vertical(variant_scalar_rgb, np_rng, bc, res):
+    # The vertical pass processes whole rows, check it against the horizontal one
+    ref = np.float32(np_rng.random((23, 19, 3)))
+    bc = getattr(mi.FilterBoundaryCondition, bc)
+    rfilter = mi.load_dict({'type': 'lanczos'})
+
+    b = mi.Bitmap(ref)
+    b_t = mi.Bitmap(np.ascontiguousarray(ref.transpose(1, 0, 2)))
+
+    b1 = np.array(b.resample([19, res], rfilter, (bc, bc), (-0.5, 2)))
+    b2 = np.array(b_t.resample([res, 19], rfilter, (bc, bc), (-0.5, 2)))
+    assert np.allclose(b1, b2.transpose(1, 0, 2), atol=1e-6)
+
+
+def test_convert_bands(variant_scalar_rgb, np_rng):
+    # Rows are converted in parallel bands, which must not affect the dithering
+    ref = np.float32(np_rng.random((600, 13, 3)))
+    fmt = mi.Bitmap.PixelFormat.RGB
+
+    b1 = np.array(mi.Bitmap(ref).convert(fmt, mi.Struct.Type.UInt8, True))
+    b2 = np.array(mi.Bitmap(np.ascontiguousarray(ref[256:512])).convert(
+        fmt, mi.Struct.Type.UInt8, True))
+    assert np.all(b1[256:512] == b2)
+
+
+def test_zero_copy(variant_scalar_rgb, np_rng):
+    import gc
+    ref = np.float32(np_rng.random((16, 8, 3)))
+    b = mi.Bitmap(ref, copy=False)
+    assert not b.owns_data()
+
+    # The bitmap wraps the array memory
+    assert np.array(b, copy=False).__array_interface__['data'][0] == \
+           ref.__array_interface__['data'][0]
+    ref[2, 3, 1] = 42
+    assert np.array(b)[2, 3, 1] == 42
+
+    # The array outlives the Python reference to it
+    del ref
+    gc.collect()
+    assert np.array(b)[2, 3, 1] == 42
+    assert np.array(b.convert(mi.Bitmap.PixelFormat.Y, mi.Struct.Type.Float32, False)).shape == (16, 8, 1)
+
+    with pytest.raises(ValueError, match='C-contiguous'):
+        mi.Bitmap(np.float32(np_rng.random((16, 8, 3)))[:, ::2], copy=False)
+
+
+def test_map_raw(variant_scalar_rgb, np_rng, tmpdir):
+    import gc
+    ref = np.float32(np_rng.random((5, 7, 4)))
+    b = mi.Bitmap(ref, pixel_format=mi.Bitmap.PixelFormat.MultiChannel,
+                  channel_names=['a', 'b', 'c', 'd'])
+    b.set_premultiplied_alpha(False)
+
+    filename = os.path.join(str(tmpdir), 'image.raw')
+    stream = mi.FileStream(filename, mi.FileStream.ETruncReadWrite)
+    b.write_raw(stream)
+    stream.close()
+
+    # The mapped bitmap references the file contents
+    b2 = mi.Bitmap.map_raw(mi.MemoryMappedFile(filename))
+    assert not b2.owns_data()
+    assert b2.pixel_format() == mi.Bitmap.PixelFormat.MultiChannel
+    assert [f.name for f in b2.struct_()] == ['a', 'b', 'c', 'd']
+    assert not b2.premultiplied_alpha()
+    assert not b2.srgb_gamma()
+
+    # The bitmap keeps the mapping alive
+    gc.collect()
+    assert np.all(np.array(b2) == ref)
+
+    with open(filename, 'r+b') as f:
+        f.write(b'XXXX')
+    with pytest.raises(RuntimeError, match='not a raw bitmap'):
+        mi.Bitmap.map_raw(mi.MemoryMappedFile(filename))
@@ -268,3 +268,81 @@ def test18_irrcont_simple_function(variants_vec_backends_once):
                 0.48734, 0.654313, 0.786607, 0.899653, 1.])
          * d.normalization())
     )
+
+
+def test19_discr_alias_table(variants_vec_backends_once):
+    # The alias table samples the same distribution in constant time
+    pmf = [0, 3, 1, 0, 5, 0, 2, 0]
+    x = mi.DiscreteDistribution(pmf, alias_table=True)
+    assert x.has_alias_table()
+    assert not mi.DiscreteDistribution(pmf).has_alias_table()
+
+    # Every column of the table samples its entry and its alias in proportion
+    prob, alias = x.alias_probability(), x.alias_index()
+    assert len(prob) == len(pmf) and len(alias) == len(pmf)
+    mass = dr.zeros(mi.Float, len(pmf))
+    dr.scatter_reduce(dr.ReduceOp.Add, mass, prob, dr.arange(mi.UInt32, len(pmf)))
+    dr.scatter_reduce(dr.ReduceOp.Add, mass, 1 - prob, alias)
+    assert dr.allclose(mass, mi.Float(pmf) * (len(pmf) / x.sum()), atol=1e-6)
+
+    n = 100000
+    u = (dr.arange(mi.Float, n) + 0.5) / n
+    index, reused, p = x.sample_reuse_pmf(u)
+    assert dr.all(dr.neq(x.eval_pmf(index), 0))
+    assert dr.allclose(p, x.eval_pmf_normalized(index))
+    assert dr.all((reused >= 0) & (reused <= 1))
+
+    counts = dr.zeros(mi.Float, len(pmf))
+    dr.scatter_reduce(dr.ReduceOp.Add, counts, 1.0, index)
+    assert dr.allclose(counts / n, mi.Float(pmf) / x.sum(), atol=1e-3)
+
+    # Out-of-range samples are clamped to entries with probability mass
+    assert dr.all(dr.neq(x.eval_pmf(x.sample([-100, 0, 1, 100])), 0))
+
+
+def test20_discr_large(variants_vec_backends_once):
+    # Large distributions compute the prefix sum over several parallel blocks
+    import numpy as np
+    rng = np.random.default_rng(seed=0)
+    pmf = rng.random(300000).astype(np.float32)
+    pmf[:1000] = 0
+    pmf[-1000:] = 0
+
+    x = mi.DiscreteDistribution(pmf)
+    ref = np.cumsum(pmf.astype(np.float64))
+    assert dr.allclose(x.cdf(), ref, rtol=1e-6)
+    assert dr.allclose(x.sum(), ref[-1], rtol=1e-6)
+
+    index = x.sample([0.0, 1.0])
+    assert index[0] == 1000 and index[1] == len(pmf) - 1001
+
+    pmf[150000] = -1
+    with pytest.raises(RuntimeError, match='entries must be non-negative'):
+        mi.DiscreteDistribution(pmf)
+
+
+def test21_cont_guide_table(variants_vec_backends_once):
+    # The guide table brackets the interval found by a full binary search
+    import numpy as np
+    rng = np.random.default_rng(seed=0)
+    pdf = rng.random(1000).astype(np.float32) ** 8
+    pdf[:100] = 0
+    pdf[500:600] = 0
+    pdf[-100:] = 0
+
+    d = mi.ContinuousDistribution([-1, 3], pdf)
+    guide = np.array(d.guide())
+    assert len(guide) == len(pdf)
+    assert np.all(np.diff(guide) >= 0)
+    assert guide[0] == 99 and guide[-1] == len(pdf) - 101
+
+    n = 100000
+    u = (dr.arange(mi.Float, n) + 0.5) / n
+    x, p = d.sample_pdf(u)
+
+    cdf = np.array(d.cdf())
+    value = np.array(u) * np.float32(d.integral()[0])
+    index = np.clip(np.searchsorted(cdf, value), guide[0], guide[-1])
+    x_ref = -1 + (index + 0.5) * d.interval_resolution()
+    assert np.all(np.abs(np.array(x) - x_ref) <= 0.5 * d.interval_resolution() + 1e-5)
+    assert dr.allclose(p, d.eval_pdf_normalized(x), rtol=1e-3)
@@ -177,3 +177,31 @@ def test05_discrete_distribution_2d(variants_all_backends_once):
     assert allclose(d.sample([1, 0]), ([2, 0], .3, [1, 0]))
     assert allclose(d.sample([0, 6 / 10 - 1e-7]), ([0, 0], .1, [0, 1]))
     assert allclose(d.sample([0, 6 / 10 + 1e-7]), ([1, 1], .1, [0, 0]))
+
+
+@pytest.mark.parametrize("normalize", [True, False])
+def test06_hierarchical_update(variants_all_backends_once, normalize):
+    import numpy as np
+
+    # Large enough to build the levels on the thread pool
+    rng = np.random.default_rng(seed=0)
+    data_a = rng.random((300, 400), dtype=np.float32)
+    data_b = rng.random((300, 400), dtype=np.float32)
+
+    warp = mi.Hierarchical2D0(data_a, normalize=normalize)
+    assert dr.all(warp.resolution() == [400, 300])
+    warp.update(data_b, normalize=normalize)
+    reference = mi.Hierarchical2D0(data_b, normalize=normalize)
+
+    sample = mi.Vector2f(dr.linspace(mi.Float, 0.01, 0.99, 37),
+                         dr.linspace(mi.Float, 0.99, 0.01, 37))
+    pos, pdf = warp.sample(sample)
+    pos_ref, pdf_ref = reference.sample(sample)
+    assert dr.allclose(pos, pos_ref) and dr.allclose(pdf, pdf_ref)
+    assert dr.allclose(warp.eval(pos), reference.eval(pos))
+
+    # The density of the samples matches the interpolant
+    assert dr.allclose(pdf, warp.eval(pos), rtol=1e-4)
+
+    with pytest.raises(Exception):
+        warp.update(np.ones((3, 3), dtype=np.float32))
@@ -153,3 +153,30 @@ def test12_truncate_and_file_size(variant_scalar_rgb):
     assert fs.file_size(p) == 42
     assert fs.remove(p)
     assert not fs.exists(p)
+
+
+def test13_write_atomic(variant_scalar_rgb):
+    p = path_here / 'test_file_for_write_atomic.txt'
+    tmp_files = []
+
+    def write(tmp):
+        assert tmp.parent_path() == p.parent_path()
+        tmp_files.append(tmp)
+        with open(str(tmp), 'w') as f:
+            f.write('contents')
+
+    fs.write_atomic(p, write)
+    assert fs.file_size(p) == 8
+    assert not fs.exists(tmp_files[0])
+
+    # Failures keep the existing file and remove the temporary file
+    def fail(tmp):
+        write(tmp)
+        raise RuntimeError('failed')
+
+    with pytest.raises(RuntimeError):
+        fs.write_atomic(p, fail)
+    assert fs.file_size(p) == 8
+    assert not fs.exists(tmp_files[1])
+
+    assert fs.remove(p)
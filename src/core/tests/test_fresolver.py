@@ -0,0 +1,57 @@
+import pytest
+import mitsuba as mi
+
+
+def test01_resolve(variant_scalar_rgb, tmp_path):
+    (tmp_path / 'a').mkdir()
+    (tmp_path / 'a' / 'mesh.ply').write_text('')
+    (tmp_path / 'b').mkdir()
+    (tmp_path / 'b' / 'mesh.ply').write_text('')
+    (tmp_path / 'b' / 'texture.png').write_text('')
+
+    fr = mi.FileResolver()
+    fr.clear()
+    fr.append(str(tmp_path / 'a'))
+    fr.append(str(tmp_path / 'b'))
+
+    # Search paths are visited in order
+    assert str(fr.resolve('mesh.ply')) == str(tmp_path / 'a' / 'mesh.ply')
+    assert str(fr.resolve('texture.png')) == str(tmp_path / 'b' / 'texture.png')
+    assert str(fr.resolve('missing.exr')) == 'missing.exr'
+
+    # Nested paths and absolute paths
+    assert str(fr.resolve('b/texture.png')) == str(tmp_path / 'b' / 'texture.png')
+    absolute = str(tmp_path / 'c' / 'missing.exr')
+    assert str(fr.resolve(absolute)) == absolute
+
+
+def test02_cache(variant_scalar_rgb, tmp_path):
+    fr = mi.FileResolver()
+    fr.clear()
+    fr.append(str(tmp_path))
+    assert fr.cache_size() == 0
+
+    (tmp_path / 'first.png').write_text('')
+    assert str(fr.resolve('first.png')) == str(tmp_path / 'first.png')
+    assert fr.cache_size() == 1
+
+    # The directory listing is reused, hence new files are not found yet
+    (tmp_path / 'second.png').write_text('')
+    assert str(fr.resolve('second.png')) == 'second.png'
+    fr.clear_cache()
+    assert fr.cache_size() == 0
+    assert str(fr.resolve('second.png')) == str(tmp_path / 'second.png')
+
+    # Modifying the search paths invalidates the cache
+    (tmp_path / 'third.png').write_text('')
+    fr.prepend(str(tmp_path / 'missing'))
+    assert fr.cache_size() == 0
+    assert str(fr.resolve('third.png')) == str(tmp_path / 'third.png')
+    assert fr.cache_size() == 2
+
+    # Copies start with an empty cache
+    assert mi.FileResolver(fr).cache_size() == 0
+
+    # Removed files are no longer found
+    (tmp_path / 'third.png').unlink()
+    assert str(fr.resolve('third.png')) == 'third.png'
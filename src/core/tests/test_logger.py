@@ -39,3 +39,40 @@ def test01_custom(variant_scalar_rgb):
         for app in appenders:
             logger.add_appender(app)
         logger.set_formatter(formatter)
+
+
+def test02_async(variant_scalar_rgb):
+    # Messages are delivered in order by the background thread
+    messages = []
+
+    logger = mi.Logger(mi.LogLevel.Info)
+
+    class MyAppender(mi.Appender):
+        def append(self, level, text):
+            messages.append(text)
+
+        def log_progress(self, progress, name, formatted, eta, ptr=None):
+            messages.append(name)
+
+    logger.set_formatter(mi.DefaultFormatter())
+    logger.add_appender(MyAppender())
+    logger.set_async(True)
+    assert logger.is_async()
+
+    thread = mi.Thread.thread()
+    old_logger = thread.logger()
+    thread.set_logger(logger)
+    try:
+        for i in range(2000):
+            mi.Log(mi.LogLevel.Info, f"message {i}")
+        logger.log_progress(0.5, "progress", "50%", "")
+        logger.flush()
+    finally:
+        thread.set_logger(old_logger)
+        logger.set_async(False)
+
+    assert not logger.is_async()
+    assert len(messages) == 2001
+    for i in range(2000):
+        assert messages[i].endswith(f"message {i}")
+    assert messages[-1] == "progress"
@@ -0,0 +1,20 @@
+import pytest
+import mitsuba as mi
+
+
+def test01_preload(variant_scalar_rgb):
+    pmgr = mi.PluginManager.instance()
+
+    # Unknown plugins and duplicates are skipped without raising an exception
+    pmgr.preload(['independent', 'diffuse', 'diffuse', 'nonexistent_plugin'])
+
+    loaded = pmgr.loaded_plugins()
+    assert 'independent' in loaded and 'diffuse' in loaded
+    assert 'nonexistent_plugin' not in loaded
+
+    # Preloaded plugins are used to instantiate objects
+    sampler = mi.load_dict({ 'type': 'independent' })
+    assert isinstance(sampler, mi.Sampler)
+
+    with pytest.raises(RuntimeError, match='not found'):
+        mi.load_dict({ 'type': 'nonexistent_plugin' })
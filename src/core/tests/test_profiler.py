@@ -0,0 +1,41 @@
+import json
+import pytest
+import mitsuba as mi
+
+
+def test01_profile_render(variant_scalar_rgb):
+    if not mi.Profiler.enabled():
+        pytest.skip('Mitsuba was compiled without the sampling profiler')
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': { 'type': 'path' },
+        'sensor': {
+            'type': 'perspective',
+            'film': { 'type': 'hdrfilm', 'width': 64, 'height': 64 },
+            'sampler': { 'type': 'independent', 'sample_count': 32 }
+        },
+        'shape': { 'type': 'sphere' },
+        'emitter': { 'type': 'constant' }
+    })
+
+    mi.Profiler.reset()
+    mi.Profiler.start(0.5)
+    assert mi.Profiler.running()
+    mi.render(scene)
+    mi.Profiler.stop()
+    assert not mi.Profiler.running()
+
+    assert mi.Profiler.sample_count() > 0
+    report = json.loads(mi.Profiler.report(json=True))
+    assert report['samples'] == mi.Profiler.sample_count()
+
+    phases = { p['name']: p for p in report['phases'] }
+    assert 'Integrator::render()' in phases
+    assert 'Scene::ray_intersect()' in phases
+    for p in phases.values():
+        assert 0 <= p['exclusive'] <= p['inclusive'] <= 100
+    assert 'Integrator::render()' in mi.Profiler.report()
+
+    mi.Profiler.reset()
+    assert mi.Profiler.sample_count() == 0
@@ -194,3 +194,33 @@ def test10_animated_transforms(variant_scalar_rgb):
     assert type(p["trafo"]) is mi.Transform4d
     assert type(p["atrafo"]) is mi.AnimatedTransform
 
+
+
+def test11_many_properties(variant_scalar_rgb):
+    """Large property lists are indexed and keep their (natural) order"""
+    p = mi.Properties()
+    p.reserve(1000)
+    for i in reversed(range(1000)):
+        p['shape_%i' % i] = i
+    assert len(p) == 1000
+
+    for i in range(0, 1000, 7):
+        assert p['shape_%i' % i] == i
+    assert not p.has_property('shape_1000')
+
+    names = p.property_names()
+    assert names == ['shape_%i' % i for i in range(1000)]
+
+    for i in range(0, 1000, 2):
+        assert p.remove_property('shape_%i' % i)
+    assert len(p) == 500
+    assert not p.has_property('shape_10')
+    assert p['shape_11'] == 11
+
+    p['shape_11'] = 'hello'
+    assert p['shape_11'] == 'hello'
+    assert len(p) == 500
+
+    p2 = mi.Properties(p)
+    assert p2 == p
+    assert p2['shape_999'] == 999
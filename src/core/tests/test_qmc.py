@@ -1,3 +1,8 @@
+import time
+import pytest
+import drjit as dr
+import mitsuba as mi
+
 # import drjit as dr
 # import pytest
 # import mitsuba
@@ -112,3 +117,76 @@
 #         result = v_p.eval_scrambled(index, dr.arange(10, dtype=dr.uint64))
 #         for i in range(len(result)):
 #             assert dr.abs(v.eval_scrambled(index, i) - result[i]) < 1e-7
+
+
+def r_inv_ref(divisor, index):
+    factor = 1
+    value = 0
+    while index != 0:
+        factor /= divisor
+        value += (index % divisor) * factor
+        index //= divisor
+    return value
+
+
+def test05_radical_inverse_digit_tables(variant_scalar_rgb):
+    v = mi.RadicalInverse()
+
+    # Small bases resolve several digits per lookup
+    assert v.digits_per_lookup(0) == 12
+    assert v.digits_per_lookup(1) == 7
+    assert v.digits_per_lookup(17) == 2
+    assert v.digits_per_lookup(18) == 1
+    assert v.digit_table(18) is None
+
+    table = v.digit_table(1)
+    assert len(table) == 3 ** 7
+    assert table[1] == 3 ** 6 and table[3] == 3 ** 5 and table[4] == 3 ** 6 + 3 ** 5
+
+    for index in range(40):
+        prime = v.base(index)
+        for i in [0, 1, 2, 3, 17, 1000, 4095, 4096, 123456, 98765432]:
+            assert dr.abs(r_inv_ref(prime, i) - v.eval(index, i)) < 1e-6
+
+
+def test06_scrambled_radical_inverse_digit_tables(variant_scalar_rgb):
+    v = mi.RadicalInverse(200, 3)
+
+    for index in range(v.bases()):
+        prime = v.base(index)
+        perm = v.permutation(index)
+        for i in [0, 1, 5, 4096, 9999, 123456]:
+            # Permute the digits, with an infinite tail of permuted zeros
+            value, factor, j = 0, 1, i
+            for _ in range(40):
+                factor /= prime
+                value += perm[j % prime] * factor
+                j //= prime
+            assert dr.abs(min(value, 1 - 2 ** -24) - v.eval_scrambled(index, i)) < 1e-6
+
+
+@pytest.mark.benchmark
+def test07_halton_benchmark(variants_vec_backends_once):
+    # Throughput of high-dimensional sample generation
+    wavefront, dims = 2 ** 20, 64
+    for owen in [False, True]:
+        sampler = mi.load_dict({
+            'type' : 'halton',
+            'sample_count' : wavefront,
+            'owen' : owen
+        })
+        sampler.seed(0, wavefront)
+
+        values = [sampler.next_1d() for _ in range(dims)]
+        dr.eval(values)
+
+        start = time.perf_counter()
+        sampler.seed(1, wavefront)
+        values = [sampler.next_1d() for _ in range(dims)]
+        dr.eval(values)
+        dr.sync_thread()
+        elapsed = time.perf_counter() - start
+
+        print('halton (owen=%s): %.1f Msamples/s' %
+              (owen, wavefront * dims / elapsed * 1e-6))
+        assert all(dr.all((v >= 0) & (v < 1)) for v in values)
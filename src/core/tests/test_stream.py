@@ -2,7 +2,8 @@ import os
 import pytest
 import drjit as dr
 
-from mitsuba.scalar_rgb import Stream, DummyStream, FileStream, MemoryStream, ZStream
+from mitsuba.scalar_rgb import Stream, DummyStream, FileStream, MemoryStream, ZStream, \
+    AsyncFileStream, SocketStream, SocketListener
 from mitsuba.scalar_rgb.test.util import tmpfile, make_tmpfile
 
 parameters = [
@@ -11,7 +12,8 @@ parameters = [
         (DummyStream, ()),
         (MemoryStream, (64,)),
         (FileStream, (make_tmpfile, FileStream.ERead)),
-        (FileStream, (make_tmpfile, FileStream.ETruncReadWrite))
+        (FileStream, (make_tmpfile, FileStream.ETruncReadWrite)),
+        (AsyncFileStream, (make_tmpfile,))
     ]
 ]
 
@@ -283,3 +285,154 @@ def test08_fstream(rw, tmpfile):
     else:
         with pytest.raises(RuntimeError):
             FileStream(new_name)
+
+
+@pytest.mark.parametrize('read_ahead', [True, False])
+def test09_async_fstream(read_ahead, tmpfile):
+    import numpy as np
+    data = np.random.default_rng(0).integers(0, 256, 50000, dtype=np.uint8).tobytes()
+    with open(tmpfile, 'wb') as f:
+        f.write(data)
+
+    s = AsyncFileStream(tmpfile, block_size=4096, read_ahead=read_ahead)
+    assert s.can_read()
+    assert not s.can_write()
+    assert s.size() == len(data)
+    assert s.block_size() == 4096
+
+    # Small, unaligned and large (unbuffered) reads
+    pos = 0
+    for size in [1, 17, 4000, 4096, 3, 12288, 9000, 19]:
+        assert s.read(size) == data[pos:pos + size]
+        pos += size
+        assert s.tell() == pos
+
+    s.seek(100)
+    assert s.read(5000) == data[100:5100]
+
+    # Positional reads don't change the position
+    assert s.read_at(40000, 1234) == data[40000:41234]
+    assert s.tell() == 5100
+
+    s.seek(len(data) - 10)
+    with pytest.raises(RuntimeError):
+        s.read(11)
+    with pytest.raises(RuntimeError):
+        s.read_at(len(data) - 5, 6)
+    with pytest.raises(RuntimeError):
+        s.write_int32(0)
+    with pytest.raises(RuntimeError):
+        s.truncate(5)
+
+    s.seek(0)
+    assert s.read_int32() == int.from_bytes(data[:4], 'little', signed=True)
+
+    s.close()
+    assert not s.can_read()
+    with pytest.raises(RuntimeError):
+        AsyncFileStream(tmpfile + "_2")
+
+
+def compressible_data(size):
+    import numpy as np
+    rng = np.random.default_rng(0)
+    words = rng.integers(0, 256, (64, 16), dtype=np.uint8)
+    return words[rng.integers(0, 64, size // 16)].tobytes()
+
+
+@pytest.mark.parametrize('stream_type', [ZStream.EDeflateStream, ZStream.EGZipStream])
+@pytest.mark.parametrize('block_size', [0, 40000])
+def test10_zstream_compress(stream_type, block_size):
+    import gzip
+    import zlib
+    data = compressible_data(200000)
+
+    compressed = ZStream.compress(data, stream_type, block_size=block_size)
+    assert len(compressed) < len(data) // 2
+
+    # The (block-parallel) result is a regular zlib or gzip stream
+    if stream_type == ZStream.EGZipStream:
+        assert gzip.decompress(compressed) == data
+    else:
+        assert zlib.decompress(compressed) == data
+    assert ZStream.decompress(compressed, len(data), stream_type) == data
+    assert ZStream.compress(b'', stream_type) != b''
+
+    with pytest.raises(RuntimeError, match='expected'):
+        ZStream.decompress(compressed, len(data) + 1, stream_type)
+    with pytest.raises(RuntimeError, match='larger'):
+        ZStream.decompress(compressed, len(data) - 1, stream_type)
+    with pytest.raises(RuntimeError, match='prematurely'):
+        ZStream.decompress(compressed[:-100], len(data), stream_type)
+
+
+def test11_zstream_small_reads():
+    import zlib
+    data = compressible_data(100000)
+    stream = MemoryStream()
+    stream.write(zlib.compress(data))
+    stream.seek(0)
+
+    # Mixed small and large reads are served from the read-ahead buffer
+    zstream = ZStream(stream)
+    pos = 0
+    for size in [1, 3, 17, 4000, 40000, 2, 33000, 7]:
+        assert zstream.read(size) == data[pos:pos + size]
+        pos += size
+    assert zstream.read(len(data) - pos) == data[pos:]
+    with pytest.raises(RuntimeError, match='past the end'):
+        zstream.read(1)
+
+
+def test12_zstream_small_writes():
+    import zlib
+    stream = MemoryStream()
+    zstream = ZStream(stream)
+    for v in range(10000):
+        zstream.write_int32(v)
+    zstream.close()
+
+    ref = MemoryStream()
+    for v in range(10000):
+        ref.write_int32(v)
+    assert zlib.decompress(stream.raw_buffer()) == ref.raw_buffer()
+
+
+def test13_socket_stream_loopback():
+    import threading
+
+    # Let the operating system pick an unused port on the loopback interface
+    listener = SocketListener(0)
+    assert listener.address() == '127.0.0.1'
+    assert listener.port() != 0
+
+    # The listener keeps accepting connections on the same port
+    def serve(count):
+        for _ in range(count):
+            stream = listener.accept()
+            value = stream.read_uint32()
+            text = stream.read_string()
+            stream.write_uint32(value + 1)
+            stream.write_string(text[::-1])
+            stream.close()
+
+    thread = threading.Thread(target=serve, args=(3,))
+    thread.start()
+    for i in range(3):
+        stream = SocketStream('127.0.0.1', listener.port())
+        assert stream.byte_order() == Stream.EBigEndian
+        stream.write_uint32(41 + i)
+        stream.write_string('socket %i' % i)
+        assert stream.read_uint32() == 42 + i
+        assert stream.read_string() == ('socket %i' % i)[::-1]
+        assert stream.tell() == 4 + 4 + 8 and stream.size() == 4 + 4 + 8
+        with pytest.raises(RuntimeError, match='closed'):
+            stream.read_uint32()
+        stream.close()
+        assert stream.is_closed()
+    thread.join()
+
+    listener.close()
+    assert listener.is_closed()
+    with pytest.raises(RuntimeError):
+        listener.accept()
@@ -443,3 +443,90 @@ def test19_alpha_4():
     dst_data = (src_data_float[0], src_data_float[1], src_data[2])
     check_conversion(s, '@BBB', '@BBB',
                      src_data, dst_data)
+
+
+@pytest.mark.parametrize('param', supported_types)
+def test20_portable_parity(param):
+    """The portable conversion routine matches the JIT-compiled one"""
+    src = Struct() \
+        .append('value', param[1], Struct.Flags.Normalized) \
+        .append('alpha', param[1], Struct.Flags.Normalized | Struct.Flags.Alpha)
+    target = Struct() \
+        .append('alpha', Struct.Type.Float32, Struct.Flags.Alpha) \
+        .append('value', Struct.Type.Float64, Struct.Flags.PremultipliedAlpha) \
+        .append('extra', Struct.Type.Float32, Struct.Flags.Default, 2.0)
+
+    s_jit = StructConverter(src, target)
+    s_portable = StructConverter(src, target, jit=False)
+    assert not s_portable.uses_jit()
+
+    data = (1, 2) if param[0] in 'efd' else (10, 20)
+    src_data = struct.pack('@' + param[0] * 2, *data)
+    out_jit = struct.unpack('@fdf', s_jit.convert(src_data))
+    out_portable = struct.unpack('@fdf', s_portable.convert(src_data))
+    assert np.allclose(out_jit, out_portable, rtol=1e-6)
+    assert out_portable[2] == 2.0
+
+
+def test21_portable_copy():
+    """Fields that keep their representation are copied"""
+    src = Struct() \
+        .append('a', Struct.Type.UInt16) \
+        .append('b', Struct.Type.Float32) \
+        .append('c', Struct.Type.UInt8, Struct.Flags.Normalized | Struct.Flags.Gamma)
+    s = StructConverter(src, src, jit=False)
+    check_conversion(s, '@HfB', '@HfB', (1234, 0.25, 77))
+
+    target = Struct() \
+        .append('c', Struct.Type.UInt8, Struct.Flags.Normalized | Struct.Flags.Gamma) \
+        .append('b', Struct.Type.Float32) \
+        .append('a', Struct.Type.UInt16)
+    s = StructConverter(src, target, jit=False)
+    check_conversion(s, '@HfB', '@BfH', (1234, 0.25, 77), (77, 0.25, 1234))
+
+    src_be = Struct(byte_order=Struct.ByteOrder.BigEndian).append('a', Struct.Type.UInt16)
+    target_le = Struct(byte_order=Struct.ByteOrder.LittleEndian).append('a', Struct.Type.UInt16)
+    s = StructConverter(src_be, target_le, jit=False)
+    check_conversion(s, '>H', '<H', (1234,))
+
+
+def test22_portable_table():
+    """8-bit fields are converted through a lookup table"""
+    src = Struct().append('v', Struct.Type.UInt8, Struct.Flags.Normalized | Struct.Flags.Gamma)
+    target = Struct().append('v', Struct.Type.Float32)
+    s_jit = StructConverter(src, target)
+    s_portable = StructConverter(src, target, jit=False)
+
+    data = bytes(range(256))
+    out_jit = np.frombuffer(s_jit.convert(data), dtype=np.float32)
+    out_portable = np.frombuffer(s_portable.convert(data), dtype=np.float32)
+    ref = np.array([from_srgb(i / 255.0) for i in range(256)])
+    assert np.allclose(out_portable, ref, atol=1e-6)
+    assert np.allclose(out_jit, out_portable, atol=1e-6)
+
+
+@pytest.mark.parametrize('jit', [True, False])
+def test23_parallel(jit):
+    """Large conversions run in parallel and match the serial result"""
+    src = Struct() \
+        .append('a', Struct.Type.Float32) \
+        .append('b', Struct.Type.UInt16, Struct.Flags.Normalized)
+    target = Struct() \
+        .append('b', Struct.Type.Float32) \
+        .append('a', Struct.Type.UInt8, Struct.Flags.Normalized | Struct.Flags.Gamma)
+    s = StructConverter(src, target, dither=True, jit=jit)
+
+    count = 100003
+    rng = np.random.default_rng(0)
+    data = np.zeros(count, dtype=np.dtype([('a', np.float32), ('b', np.uint16)], align=True))
+    data['a'] = rng.random(count)
+    data['b'] = rng.integers(0, 65535, count)
+
+    threshold = StructConverter.parallel_threshold()
+    try:
+        StructConverter.set_parallel_threshold(1 << 40)
+        ref = s.convert(data.tobytes())
+        StructConverter.set_parallel_threshold(1024)
+        assert s.convert(data.tobytes()) == ref
+    finally:
+        StructConverter.set_parallel_threshold(threshold)
@@ -0,0 +1,51 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def test01_fetch(variant_scalar_rgb):
+    import numpy as np
+
+    data = np.arange(70 * 50 * 3, dtype=np.float32).reshape(50, 70, 3)
+    levels = [mi.Bitmap(data), mi.Bitmap(data[::2, ::2].copy())]
+    image = mi.TiledImage(levels, tile_size=16)
+
+    assert image.level_count() == 2
+    assert image.channel_count() == 3
+    assert dr.all(image.size() == [70, 50])
+    assert dr.all(image.size(1) == [35, 25])
+
+    for (x, y) in [(0, 0), (15, 16), (69, 49), (33, 17)]:
+        assert np.all(image.fetch(0, x, y) == data[y, x])
+    assert np.all(image.fetch(1, 34, 24) == data[48, 68])
+
+    with pytest.raises(IndexError):
+        image.fetch(0, 70, 0)
+
+
+def test02_budget(variant_scalar_rgb):
+    import numpy as np
+
+    budget = mi.TileCache.budget()
+    try:
+        data = np.random.rand(64, 64, 1).astype(np.float32)
+        image = mi.TiledImage([mi.Bitmap(data)], tile_size=8)
+        tile_bytes = 8 * 8 * 4
+
+        # Only keep two tiles resident
+        mi.TileCache.clear()
+        mi.TileCache.set_budget(2 * tile_bytes)
+
+        for y in range(0, 64, 8):
+            for x in range(0, 64, 8):
+                assert image.fetch(0, x, y)[0] == data[y, x, 0]
+                assert mi.TileCache.usage() <= 2 * tile_bytes
+
+        # Evicted tiles are read again from the page file
+        loads = mi.TileCache.load_count()
+        for y in range(0, 64, 8):
+            for x in range(0, 64, 8):
+                assert image.fetch(0, x + 1, y + 1)[0] == data[y + 1, x + 1, 0]
+        assert mi.TileCache.load_count() > loads
+    finally:
+        mi.TileCache.set_budget(budget)
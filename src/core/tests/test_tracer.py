@@ -0,0 +1,113 @@
+import json
+import drjit as dr
+import numpy as np
+import mitsuba as mi
+
+
+def test01_record_events(variant_scalar_rgb):
+    mi.TraceRecorder.start()
+    assert mi.TraceRecorder.running()
+    start = mi.TraceRecorder.timestamp()
+    mi.TraceRecorder.add_event('test', 'my "event"', start, 12.5, '"value": 3')
+    mi.TraceRecorder.add_counter('test', 'my counter', 4)
+    mi.TraceRecorder.stop()
+    assert not mi.TraceRecorder.running()
+
+    # Events are ignored while the recorder is stopped
+    mi.TraceRecorder.add_event('test', 'ignored', start, 1.0)
+    assert mi.TraceRecorder.event_count() == 2
+
+    trace = json.loads(mi.TraceRecorder.json())
+    events = [e for e in trace['traceEvents'] if e['ph'] != 'M']
+    assert events[0]['ph'] == 'X'
+    assert events[0]['name'] == 'my "event"'
+    assert events[0]['dur'] == 12.5
+    assert events[0]['args'] == { 'value': 3 }
+    assert events[1]['ph'] == 'C'
+    assert events[1]['args'] == { 'value': 4 }
+
+    mi.TraceRecorder.clear()
+    assert mi.TraceRecorder.event_count() == 0
+
+
+def test02_trace_scene_loading(variant_scalar_rgb, tmp_path):
+    texture = str(tmp_path / 'texture.exr')
+    mi.Bitmap(np.full((16, 16, 3), 0.5, dtype=np.float32)).write(texture)
+
+    mi.TraceRecorder.start()
+    mi.load_string(f'''
+        <scene version="3.0.0">
+            <shape type="sphere" id="my_sphere">
+                <bsdf type="diffuse">
+                    <texture type="bitmap" name="reflectance">
+                        <string name="filename" value="{texture}"/>
+                    </texture>
+                </bsdf>
+            </shape>
+        </scene>
+    ''')
+    mi.TraceRecorder.stop()
+
+    filename = str(tmp_path / 'trace.json')
+    mi.TraceRecorder.write(filename)
+    with open(filename) as f:
+        trace = json.load(f)
+
+    events = trace['traceEvents']
+    categories = set(e.get('cat') for e in events)
+    for cat in ['parse', 'load', 'instantiate', 'io', 'decode', 'accel']:
+        assert cat in categories
+
+    names = [e['name'] for e in events if e.get('cat') == 'instantiate']
+    assert 'my_sphere' in names
+    assert 'Active instantiations' in names
+
+    io = [e for e in events if e.get('cat') == 'io'
+          and e['name'] == 'texture.exr']
+    assert len(io) == 1 and io[0]['args']['bytes_read'] > 0
+
+    decode = [e for e in events if e.get('cat') == 'decode'][0]
+    assert decode['args']['width'] == 16 and decode['args']['channels'] == 3
+
+    # Thread names are reported as metadata
+    assert any(e['ph'] == 'M' and e['name'] == 'thread_name' for e in events)
+
+
+def test03_trace_rendering(variants_all_rgb):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'sphere': { 'type': 'sphere' },
+        'emitter': { 'type': 'constant' },
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(origin=[0, 0, 5],
+                                                     target=[0, 0, 0],
+                                                     up=[0, 1, 0]),
+            'film': { 'type': 'hdrfilm', 'width': 64, 'height': 32 },
+            'sampler': { 'type': 'independent', 'sample_count': 4 }
+        },
+        'integrator': { 'type': 'path', 'samples_per_pass': 2,
+                        'block_size': 16 }
+    })
+
+    mi.TraceRecorder.start()
+    mi.render(scene)
+    mi.TraceRecorder.stop()
+
+    events = json.loads(mi.TraceRecorder.json())['traceEvents']
+    render = [e for e in events if e.get('cat') == 'render']
+    names = set(e['name'] for e in render)
+
+    if mi.variant().startswith('scalar'):
+        # Every block of both passes is reported along with its position
+        blocks = [e for e in render if e['name'] == 'Block']
+        assert len(blocks) == 2 * 4 * 2
+        assert set(e['args']['pass'] for e in blocks) == {0, 1}
+        assert 'put_block' in names
+    else:
+        assert len([e for e in render if e['name'] == 'Pass']) == 2
+        kernels = [e for e in events if e.get('cat') == 'jit']
+        assert any(e['name'] == 'Kernel launch' for e in kernels)
+
+        # The kernel history is only enabled while rendering
+        assert not dr.flag(dr.JitFlag.KernelHistory)
@@ -26,3 +26,15 @@ def test01_mem_string(variant_scalar_rgb):
         assert mem_string(2 * 1024 ** 4, precise=True) == '2 TiB'
         assert mem_string(2 * 1024 ** 5, precise=True) == '2 PiB'
         assert mem_string(2 * 1024 ** 6, precise=True) == '2 EiB'
+
+
+def test02_numa_topology(variant_scalar_rgb):
+    from mitsuba.util import core_count, numa_node_count, numa_node_cores
+
+    count = numa_node_count()
+    assert count >= 1
+
+    cores = [c for node in range(count) for c in numa_node_cores(node)]
+    assert len(cores) >= 1
+    assert len(set(cores)) == len(cores)
+    assert numa_node_cores(count) == []
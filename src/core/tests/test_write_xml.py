@@ -601,3 +601,114 @@ def test16_xml_volume_with_args(variants_all_rgb, tmp_path):
         print(s2)
 
         assert str(s1) == str(s2)
+
+
+def test17_binary_scene(variants_all_rgb, tmp_path):
+    filepath = str(tmp_path / 'test_write_xml-test17_output.mibs')
+
+    scene_dict = {
+        'type': 'scene',
+        'mat': {
+            'type': 'diffuse',
+            'id': 'mat',
+            'reflectance': {
+                'type': 'bitmap',
+                'data': mi.TensorXf(np.full((4, 4, 3), 0.5, dtype=np.float32)),
+                'raw': True
+            }
+        },
+        'sphere': {
+            'type': 'sphere',
+            'to_world': mi.ScalarTransform4f.translate([1, 2, 3]).scale(0.5),
+            'flip_normals': True,
+            'bsdf': { 'type': 'ref', 'id': 'mat' }
+        },
+        'light': {
+            'type': 'point',
+            'position': [0, 5, 0],
+            'intensity': { 'type': 'rgb', 'value': mi.ScalarColor3f(1, 2, 3) }
+        },
+        'sensor': {
+            'type': 'perspective',
+            'fov': 45.0,
+            'film': { 'type': 'hdrfilm', 'width': 16, 'height': 8 }
+        }
+    }
+
+    mi.xml.dict_to_binary(scene_dict, filepath)
+    d = mi.xml.binary_to_dict(filepath)
+    assert d['sensor']['film']['width'] == 16
+    assert d['sensor']['fov'] == 45.0
+    assert d['sphere']['flip_normals'] is True
+    assert d['light']['position'] == [0, 5, 0]
+    assert dr.allclose(d['light']['intensity']['value'], [1, 2, 3])
+    assert dr.allclose(d['mat']['reflectance']['data'], 0.5)
+
+    s1 = mi.load_dict(scene_dict)
+    s2 = mi.xml.load_binary(filepath)
+    assert str(s1) == str(s2)
+
+    with open(filepath, 'wb') as f:
+        f.write(b'\0' * 64)
+    with pytest.raises(Exception, match='not a binary scene'):
+        mi.xml.binary_to_dict(filepath)
+
+
+
+@fresolver_append_path
+def test18_export_meshes(variants_all_rgb, tmp_path):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'box': {
+            'type': 'cube',
+            'id': 'box',
+            'to_world': mi.ScalarTransform4f.translate([-2, 0, 0])
+        },
+        'ball': {
+            'type': 'obj',
+            'filename': 'resources/data/common/meshes/sphere.obj',
+            'face_normals': True
+        },
+        'sphere': {'type': 'sphere'}
+    })
+
+    # Only meshes are exported, meshes without a unique id are numbered
+    meshes = mi.xml.export_meshes(scene, str(tmp_path / 'meshes'))
+    assert 'box' in meshes and len(meshes) == 2
+    assert all(os.path.exists(m['filename']) for m in meshes.values())
+
+    for shape in scene.shapes():
+        if not shape.is_mesh():
+            continue
+        name = shape.id() if shape.id() == 'box' else \
+            [k for k in meshes if k != 'box'][0]
+        exported = mi.load_dict(meshes[name])
+        assert exported.has_face_normals() == shape.has_face_normals()
+        assert dr.allclose(exported.bbox().min, shape.bbox().min)
+
+        p1, p2 = mi.traverse(shape), mi.traverse(exported)
+        assert dr.allclose(p1['vertex_positions'], p2['vertex_positions'])
+        assert dr.all(p1['faces'] == p2['faces'])
+
+
+def test19_export_meshes_unique_names(variant_scalar_rgb, tmp_path):
+    def cube(id_, x):
+        d = {'type': 'cube',
+             'to_world': mi.ScalarTransform4f.translate([x, 0, 0])}
+        if id_:
+            d['id'] = id_
+        return d
+
+    # Sanitized ids and generated names must not overwrite each other
+    shapes = [mi.load_dict(cube('a b', 0)), mi.load_dict(cube('a_b', 3)),
+              mi.load_dict(cube('mesh_0003', 6)), mi.load_dict(cube(None, 9))]
+    meshes = mi.xml.export_meshes(shapes, str(tmp_path / 'meshes'))
+
+    assert len(meshes) == 4
+    filenames = [m['filename'] for m in meshes.values()]
+    assert len(set(f.lower() for f in filenames)) == 4
+    assert all(os.path.exists(f) for f in filenames)
+
+    # Every file holds the geometry of its own mesh
+    x = sorted(mi.load_dict(m).bbox().center().x for m in meshes.values())
+    assert dr.allclose(x, [0, 3, 6, 9])
@@ -425,3 +425,76 @@ def test31_python_plugins_parallel(variants_vec_backends_once_rgb):
         <bsdf type='dummy'/>
     </scene>
     """, parallel=True)
+
+
+def test32_parallel_loading_scalar(variant_scalar_rgb, tmp_path):
+    # A few meshes (instantiated in separate tasks) sharing a BSDF and
+    # textures (instantiated right away)
+    shapes = ''
+    for i in range(8):
+        filename = str(tmp_path / f'mesh_{i}.obj')
+        with open(filename, 'w') as f:
+            f.write(f'v {i} 0 0\nv {i + 1} 0 0\nv {i} 1 0\nf 1 2 3\n')
+        shapes += f"""
+            <shape type="obj" id="mesh_{i}">
+                <string name="filename" value="{filename}"/>
+                <ref id="shared_bsdf"/>
+            </shape>"""
+
+    scene_xml = f"""
+        <scene version="3.0.0">
+            <texture type="checkerboard" id="tex">
+                <rgb name="color0" value="0.2"/>
+            </texture>
+            <bsdf type="diffuse" id="shared_bsdf">
+                <ref name="reflectance" id="tex"/>
+            </bsdf>
+            {shapes}
+        </scene>"""
+
+    scene_serial = mi.load_string(scene_xml, parallel=False)
+    scene_parallel = mi.load_string(scene_xml, parallel=True)
+
+    assert len(scene_parallel.shapes()) == len(scene_serial.shapes()) == 8
+    assert dr.allclose(scene_parallel.bbox().min, scene_serial.bbox().min)
+    assert dr.allclose(scene_parallel.bbox().max, scene_serial.bbox().max)
+
+    assert len(set(s.bsdf().id() for s in scene_parallel.shapes())) == 1
+
+
+def test33_skip_unreferenced_definitions(variant_scalar_rgb):
+    # The unreferenced texture would fail to load its bitmap
+    scene_xml = """
+        <scene version="3.0.0">
+            <texture type="bitmap" id="missing_tex">
+                <string name="filename" value="does_not_exist.exr"/>
+            </texture>
+            <bsdf type="diffuse" id="unused_bsdf">
+                <ref name="reflectance" id="missing_tex"/>
+            </bsdf>
+            <bsdf type="conductor" id="used_bsdf"/>
+            <alias id="used_bsdf" as="used_alias"/>
+            <shape type="sphere">
+                <ref id="used_alias"/>
+            </shape>
+        </scene>"""
+
+    # Top-level definitions are instantiated unless requested otherwise
+    with pytest.raises(RuntimeError, match='does_not_exist'):
+        mi.load_string(scene_xml)
+
+    scene = mi.load_string(scene_xml, skip_unreferenced=True)
+
+    assert len(scene.shapes()) == 1
+    assert scene.shapes()[0].bsdf().id() == 'used_bsdf'
+    params = mi.traverse(scene)
+    assert not any(k.startswith('unused_bsdf') for k in params.keys())
+
+    # Objects that are not used by a scene are instantiated as usual
+    with pytest.raises(RuntimeError, match='does_not_exist'):
+        mi.load_string("""
+            <bsdf version="3.0.0" type="diffuse" id="unused_bsdf">
+                <texture type="bitmap" name="reflectance">
+                    <string name="filename" value="does_not_exist.exr"/>
+                </texture>
+            </bsdf>""", skip_unreferenced=True)
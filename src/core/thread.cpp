@@ -2,12 +2,15 @@
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/profiler.h>
 #include <nanothread/nanothread.h>
+#include <algorithm>
 #include <thread>
 #include <mutex>
 #include <vector>
 #include <sstream>
 #include <chrono>
+#include <cstdio>
 #include <cstring>
 
 // Required for native thread functions
@@ -23,6 +26,8 @@
 NAMESPACE_BEGIN(mitsuba)
 
 static size_t global_thread_count = 0;
+static std::atomic<bool> global_numa_aware { false };
+static std::atomic<uint32_t> numa_worker_ctr { 0 };
 static thread_local Thread *self = nullptr;
 static std::atomic<uint32_t> thread_ctr { 0 };
 #if defined(__linux__) || defined(__APPLE__)
@@ -115,6 +120,7 @@ struct Thread::ThreadPrivate {
     bool external_thread = false;
     bool critical = false;
     int core_affinity = -1;
+    int numa_node = -1;
     Thread::EPriority priority;
     ref<Logger> logger;
     ref<Thread> parent;
@@ -194,6 +200,10 @@ int Thread::core_affinity() const {
     return d->core_affinity;
 }
 
+int Thread::numa_node() const {
+    return d->numa_node;
+}
+
 uint32_t Thread::thread_id() {
 #if defined(_WIN32)
     return this_thread_id;
@@ -365,6 +375,47 @@ void Thread::set_core_affinity(int core_id) {
 #endif
 }
 
+void Thread::set_numa_node(int node) {
+    d->numa_node = node;
+    if (!d->running)
+        return;
+
+#if defined(__linux__)
+    std::vector<int> cores;
+    if (node == -1) {
+        for (int i = 0; i < util::numa_node_count(); ++i) {
+            std::vector<int> node_cores = util::numa_node_cores(i);
+            cores.insert(cores.end(), node_cores.begin(), node_cores.end());
+        }
+    } else {
+        cores = util::numa_node_cores(node);
+    }
+
+    if (cores.empty()) {
+        Log(Warn, "Thread::set_numa_node(): unknown NUMA node %i!", node);
+        return;
+    }
+
+    int max_core = *std::max_element(cores.begin(), cores.end()) + 1;
+    size_t size = CPU_ALLOC_SIZE(max_core);
+    cpu_set_t *cpuset = CPU_ALLOC(max_core);
+    if (!cpuset) {
+        Log(Warn, "Thread::set_numa_node(): could not allocate cpu_set_t");
+        return;
+    }
+
+    CPU_ZERO_S(size, cpuset);
+    for (int core : cores)
+        CPU_SET_S(core, size, cpuset);
+
+    int retval = pthread_setaffinity_np(d->native_handle, size, cpuset);
+    if (retval)
+        Log(Warn, "Thread::set_numa_node(): pthread_setaffinity_np: failed: %s",
+            strerror(retval));
+    CPU_FREE(cpuset);
+#endif
+}
+
 void Thread::start() {
     if (d->running)
         Log(Error, "Thread is already running!");
@@ -418,6 +469,9 @@ void Thread::dispatch() {
     if (d->core_affinity != -1)
         set_core_affinity(d->core_affinity);
 
+    if (d->numa_node != -1)
+        set_numa_node(d->numa_node);
+
     try {
         run();
     } catch (std::exception &e) {
@@ -478,6 +532,11 @@ bool Thread::register_external_thread(const std::string &prefix) {
     self->d->running = true;
     self->d->external_thread = true;
 
+    // Assign the workers of the thread pool to NUMA nodes in turn
+    int numa_nodes = util::numa_node_count();
+    if (global_numa_aware && prefix == "wrk" && numa_nodes > 1)
+        self->set_numa_node((int) (numa_worker_ctr++ % (uint32_t) numa_nodes));
+
     const std::string &thread_name = self->name();
     #if defined(__linux__)
         pthread_setname_np(pthread_self(), thread_name.c_str());
@@ -519,6 +578,27 @@ void Thread::static_initialization() {
 
     global_thread_count = util::core_count();
 
+    /* The MI_MAX_THREADS environment variable limits the size of the shared
+       thread pool, which also runs the LLVM kernels of Dr.Jit, the Embree
+       builds and the OpenEXR I/O. */
+    const char *max_threads = getenv("MI_MAX_THREADS");
+    if (max_threads) {
+        char *end = nullptr;
+        long value = strtol(max_threads, &end, 10);
+        if (end == max_threads || *end != '\0' || value < 1)
+            // The logger is not available yet
+            fprintf(stderr, "Warning: invalid value \"%s\" of the MI_MAX_THREADS "
+                            "environment variable, ignoring it.\n", max_threads);
+        else
+            global_thread_count = std::min(global_thread_count, (size_t) value);
+    }
+
+    /* The default pool of nanothread is sized by the hardware concurrency,
+       which does not account for CPU quotas and affinity masks (the main
+       thread counts as one thread) */
+    if (global_thread_count < std::thread::hardware_concurrency())
+        pool_set_size(nullptr, (uint32_t) (global_thread_count - 1));
+
     self = new MainThread();
     self->d->running = true;
     self->d->fresolver = new FileResolver();
@@ -546,11 +626,32 @@ void Thread::set_thread_count(size_t count) {
     pool_set_size(nullptr, (uint32_t) (count - 1));
 }
 
+void Thread::set_numa_aware(bool value) {
+    if (global_numa_aware == value)
+        return;
+    global_numa_aware = value;
+    numa_worker_ctr = 0;
+
+    /* Workers register (and are pinned) when they first run Mitsuba code.
+       Restart the pool so that existing workers don't keep their affinity. */
+    if (global_thread_count > 1) {
+        pool_set_size(nullptr, 0);
+        pool_set_size(nullptr, (uint32_t) (global_thread_count - 1));
+    }
+}
+
+bool Thread::numa_aware() { return global_numa_aware; }
+
 ThreadEnvironment::ThreadEnvironment() {
     Thread *thread = Thread::thread();
     Assert(thread);
     m_logger = thread->logger();
     m_file_resolver = thread->file_resolver();
+#if defined(MI_ENABLE_PROFILER)
+    m_profiler_flags = profiler_flags;
+#else
+    m_profiler_flags = 0;
+#endif
 }
 
 ScopedSetThreadEnvironment::ScopedSetThreadEnvironment(ThreadEnvironment &env) {
@@ -560,12 +661,21 @@ ScopedSetThreadEnvironment::ScopedSetThreadEnvironment(ThreadEnvironment &env) {
     m_file_resolver = thread->file_resolver();
     thread->set_logger(env.m_logger);
     thread->set_file_resolver(env.m_file_resolver);
+#if defined(MI_ENABLE_PROFILER)
+    m_profiler_flags = profiler_flags;
+    profiler_flags |= env.m_profiler_flags;
+#else
+    m_profiler_flags = 0;
+#endif
 }
 
 ScopedSetThreadEnvironment::~ScopedSetThreadEnvironment() {
     Thread *thread = Thread::thread();
     thread->set_logger(m_logger);
     thread->set_file_resolver(m_file_resolver);
+#if defined(MI_ENABLE_PROFILER)
+    profiler_flags = m_profiler_flags;
+#endif
 }
 
 MI_IMPLEMENT_CLASS(Thread, Object)
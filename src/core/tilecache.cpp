@@ -0,0 +1,253 @@
+#include <mitsuba/core/tilecache.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/util.h>
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+using Tile = std::shared_ptr<const std::vector<float>>;
+
+struct TileCacheEntry {
+    Tile tile;
+    std::list<uint64_t>::iterator lru;
+};
+
+struct TileCacheState {
+    std::mutex mutex;
+    /// Keys of the cached tiles, most recently used first
+    std::list<uint64_t> lru;
+    std::unordered_map<uint64_t, TileCacheEntry> entries;
+    size_t usage = 0;
+    size_t budget = size_t(1) << 30;
+};
+
+/* Intentionally never destroyed: tiled images may still be released while
+   static objects are torn down at exit */
+static TileCacheState &tile_cache_state = *new TileCacheState();
+static std::mutex &tile_cache_mutex = tile_cache_state.mutex;
+static std::list<uint64_t> &tile_cache_lru = tile_cache_state.lru;
+static std::unordered_map<uint64_t, TileCacheEntry> &tile_cache = tile_cache_state.entries;
+static size_t &tile_cache_usage = tile_cache_state.usage;
+static size_t &tile_cache_budget = tile_cache_state.budget;
+static std::atomic<size_t> tile_cache_loads { 0 };
+static std::atomic<uint64_t> tiled_image_id { 0 };
+
+/// Handles to recently used tiles, which avoid locking the cache
+struct TileSlot {
+    uint64_t key = (uint64_t) -1;
+    Tile tile;
+};
+
+static constexpr uint32_t TileSlotCount = 16;
+static thread_local TileSlot tile_slots[TileSlotCount];
+
+static uint64_t tile_key(uint64_t id, uint32_t index) {
+    return (id << 32) | index;
+}
+
+/// Remove tiles until the budget is met (the cache mutex must be held)
+static void tile_cache_evict(size_t budget) {
+    while (tile_cache_usage > budget && !tile_cache_lru.empty()) {
+        auto it = tile_cache.find(tile_cache_lru.back());
+        tile_cache_usage -= it->second.tile->size() * sizeof(float);
+        tile_cache.erase(it);
+        tile_cache_lru.pop_back();
+    }
+}
+
+static bool page_seek(std::FILE *file, uint64_t offset) {
+#if defined(_WIN32)
+    return _fseeki64(file, (__int64) offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t) offset, SEEK_SET) == 0;
+#endif
+}
+
+TiledImage::TiledImage(const std::vector<ref<Bitmap>> &levels,
+                       uint32_t tile_size)
+    : m_tile_size(tile_size), m_id(tiled_image_id++), m_file(nullptr) {
+    if (levels.empty())
+        Throw("TiledImage: at least one level must be specified!");
+    if (tile_size == 0)
+        Throw("TiledImage: the tile size must be positive!");
+
+    m_channel_count = (uint32_t) levels[0]->channel_count();
+
+    uint32_t tile_offset = 0;
+    for (const Bitmap *bitmap : levels) {
+        if (bitmap->channel_count() != m_channel_count)
+            Throw("TiledImage: all levels must have the same number of channels!");
+        Level level;
+        level.size = bitmap->size();
+        level.tile_count = (level.size + tile_size - 1u) / tile_size;
+        level.tile_offset = tile_offset;
+        tile_offset += dr::prod(level.tile_count);
+        m_levels.push_back(level);
+    }
+
+    m_file = std::tmpfile();
+    if (!m_file)
+        Throw("TiledImage: could not create a temporary page file!");
+
+    size_t tile_values = (size_t) tile_size * tile_size * m_channel_count;
+    std::vector<float> tile(tile_values);
+
+    for (size_t l = 0; l < levels.size(); ++l) {
+        ref<Bitmap> bitmap = levels[l];
+        if (bitmap->component_format() != Struct::Type::Float32)
+            bitmap = bitmap->convert(bitmap->pixel_format(),
+                                     Struct::Type::Float32,
+                                     bitmap->srgb_gamma());
+
+        const Level &level = m_levels[l];
+        const float *data = (const float *) bitmap->data();
+
+        // Write the tiles in row-major order
+        for (uint32_t ty = 0; ty < level.tile_count.y(); ++ty) {
+            for (uint32_t tx = 0; tx < level.tile_count.x(); ++tx) {
+                std::fill(tile.begin(), tile.end(), 0.f);
+                uint32_t x0 = tx * tile_size, y0 = ty * tile_size,
+                         w = std::min(tile_size, level.size.x() - x0),
+                         h = std::min(tile_size, level.size.y() - y0);
+
+                for (uint32_t y = 0; y < h; ++y)
+                    std::memcpy(tile.data() + (size_t) y * tile_size * m_channel_count,
+                                data + ((size_t) (y0 + y) * level.size.x() + x0) * m_channel_count,
+                                (size_t) w * m_channel_count * sizeof(float));
+
+                if (std::fwrite(tile.data(), sizeof(float), tile_values,
+                                m_file) != tile_values)
+                    Throw("TiledImage: could not write to the temporary page file!");
+            }
+        }
+    }
+
+    std::fflush(m_file);
+
+    Log(Debug, "Created tiled image with %u level%s of %ux%u pixels (%s page file).",
+        level_count(), level_count() == 1 ? "" : "s", size().x(), size().y(),
+        util::mem_string(tile_offset * tile_values * sizeof(float)));
+}
+
+TiledImage::~TiledImage() {
+    {
+        std::lock_guard<std::mutex> guard(tile_cache_mutex);
+        for (auto it = tile_cache.begin(); it != tile_cache.end();) {
+            if ((it->first >> 32) == m_id) {
+                tile_cache_usage -= it->second.tile->size() * sizeof(float);
+                tile_cache_lru.erase(it->second.lru);
+                it = tile_cache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    if (m_file)
+        std::fclose(m_file);
+}
+
+Tile TiledImage::load_tile(uint32_t index) const {
+    size_t tile_values = (size_t) m_tile_size * m_tile_size * m_channel_count;
+    auto tile = std::make_shared<std::vector<float>>(tile_values);
+
+    {
+        std::lock_guard<std::mutex> guard(m_file_mutex);
+        if (!page_seek(m_file, (uint64_t) index * tile_values * sizeof(float)) ||
+            std::fread(tile->data(), sizeof(float), tile_values, m_file) != tile_values)
+            Throw("TiledImage: could not read tile %u from the page file!", index);
+    }
+
+    tile_cache_loads++;
+    return tile;
+}
+
+void TiledImage::fetch(uint32_t level, uint32_t x, uint32_t y, float *out) const {
+    const Level &l = m_levels[level];
+    uint32_t tx = x / m_tile_size, ty = y / m_tile_size,
+             index = l.tile_offset + ty * l.tile_count.x() + tx;
+    uint64_t key = tile_key(m_id, index);
+
+    TileSlot &slot = tile_slots[(index ^ (uint32_t) (m_id * 0x9E3779B9u)) % TileSlotCount];
+
+    if (slot.key != key) {
+        Tile tile;
+        {
+            std::lock_guard<std::mutex> guard(tile_cache_mutex);
+            auto it = tile_cache.find(key);
+            if (it != tile_cache.end()) {
+                tile_cache_lru.splice(tile_cache_lru.begin(), tile_cache_lru,
+                                      it->second.lru);
+                tile = it->second.tile;
+            }
+        }
+
+        if (!tile) {
+            // Read the tile without holding the cache lock
+            tile = load_tile(index);
+
+            std::lock_guard<std::mutex> guard(tile_cache_mutex);
+            auto [it, inserted] = tile_cache.try_emplace(key);
+            if (inserted) {
+                tile_cache_lru.push_front(key);
+                it->second.tile = tile;
+                it->second.lru = tile_cache_lru.begin();
+                tile_cache_usage += tile->size() * sizeof(float);
+                tile_cache_evict(tile_cache_budget);
+            } else {
+                // Another thread loaded the same tile in the meantime
+                tile = it->second.tile;
+            }
+        }
+
+        slot.key = key;
+        slot.tile = std::move(tile);
+    }
+
+    const float *ptr = slot.tile->data() +
+        ((size_t) (y - ty * m_tile_size) * m_tile_size + (x - tx * m_tile_size)) *
+            m_channel_count;
+    for (uint32_t c = 0; c < m_channel_count; ++c)
+        out[c] = ptr[c];
+}
+
+std::string TiledImage::to_string() const {
+    std::ostringstream oss;
+    oss << "TiledImage[" << std::endl
+        << "  size = " << size() << "," << std::endl
+        << "  level_count = " << level_count() << "," << std::endl
+        << "  channel_count = " << m_channel_count << "," << std::endl
+        << "  tile_size = " << m_tile_size << std::endl
+        << "]";
+    return oss.str();
+}
+
+void TileCache::set_budget(size_t bytes) {
+    std::lock_guard<std::mutex> guard(tile_cache_mutex);
+    tile_cache_budget = bytes;
+    tile_cache_evict(bytes);
+}
+
+size_t TileCache::budget() {
+    std::lock_guard<std::mutex> guard(tile_cache_mutex);
+    return tile_cache_budget;
+}
+
+size_t TileCache::usage() {
+    std::lock_guard<std::mutex> guard(tile_cache_mutex);
+    return tile_cache_usage;
+}
+
+size_t TileCache::load_count() { return tile_cache_loads; }
+
+void TileCache::clear() {
+    std::lock_guard<std::mutex> guard(tile_cache_mutex);
+    tile_cache_evict(0);
+}
+
+MI_IMPLEMENT_CLASS(TiledImage, Object)
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,186 @@
+#include <mitsuba/core/tracer.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/thread.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+struct TraceEvent {
+    /// Event type, 'X' (complete event) or 'C' (counter)
+    char type;
+    std::string category;
+    std::string name;
+    uint32_t thread;
+    double start;
+    double duration;
+    std::string args;
+};
+
+static std::atomic<bool> tracer_running { false };
+static std::mutex tracer_mutex;
+static std::vector<TraceEvent> tracer_events;
+static std::map<uint32_t, std::string> tracer_threads;
+static std::chrono::steady_clock::time_point tracer_start_time =
+    std::chrono::steady_clock::now();
+
+/// Escape a string for use within a JSON document
+static std::string json_escape(const std::string &str) {
+    std::string result;
+    result.reserve(str.size() + 2);
+    result += '"';
+    for (char c : str) {
+        switch (c) {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n"; break;
+            case '\r': result += "\\r"; break;
+            case '\t': result += "\\t"; break;
+            default:
+                if ((unsigned char) c < 0x20)
+                    result += tfm::format("\\u%04x", (int) c);
+                else
+                    result += c;
+        }
+    }
+    result += '"';
+    return result;
+}
+
+/// Register the name of the calling thread (needs the tracer mutex)
+static uint32_t tracer_thread() {
+    uint32_t id = Thread::thread_id();
+    if (tracer_threads.find(id) == tracer_threads.end()) {
+        Thread *thread = Thread::thread();
+        tracer_threads[id] =
+            thread ? thread->name() : tfm::format("thread %u", id);
+    }
+    return id;
+}
+
+void TraceRecorder::start() {
+    std::lock_guard<std::mutex> guard(tracer_mutex);
+    tracer_events.clear();
+    tracer_threads.clear();
+    tracer_start_time = std::chrono::steady_clock::now();
+    tracer_running = true;
+}
+
+void TraceRecorder::stop() {
+    tracer_running = false;
+}
+
+bool TraceRecorder::running() {
+    return tracer_running.load(std::memory_order_relaxed);
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> guard(tracer_mutex);
+    tracer_events.clear();
+    tracer_threads.clear();
+}
+
+size_t TraceRecorder::event_count() {
+    std::lock_guard<std::mutex> guard(tracer_mutex);
+    return tracer_events.size();
+}
+
+double TraceRecorder::timestamp() {
+    return std::chrono::duration<double, std::micro>(
+               std::chrono::steady_clock::now() - tracer_start_time).count();
+}
+
+void TraceRecorder::add_event(const std::string &category,
+                              const std::string &name, double start,
+                              double duration, const std::string &args) {
+    if (!running())
+        return;
+    std::lock_guard<std::mutex> guard(tracer_mutex);
+    tracer_events.push_back(
+        { 'X', category, name, tracer_thread(), start, duration, args });
+}
+
+void TraceRecorder::add_counter(const std::string &category,
+                                const std::string &name, double value) {
+    if (!running())
+        return;
+    double now = timestamp();
+    std::lock_guard<std::mutex> guard(tracer_mutex);
+    tracer_events.push_back({ 'C', category, name, tracer_thread(), now, 0.0,
+                              tfm::format("\"value\": %.17g", value) });
+}
+
+std::string TraceRecorder::json() {
+    std::lock_guard<std::mutex> guard(tracer_mutex);
+    std::ostringstream oss;
+    oss << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [" << std::endl;
+    bool first = true;
+    for (const auto &[id, name] : tracer_threads) {
+        oss << (first ? "" : ",\n")
+            << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 0, "
+            << "\"tid\": " << id << ", \"args\": {\"name\": "
+            << json_escape(name) << "}}";
+        first = false;
+    }
+    for (const TraceEvent &e : tracer_events) {
+        oss << (first ? "" : ",\n") << "{\"ph\": \"" << e.type << "\", "
+            << "\"cat\": " << json_escape(e.category) << ", "
+            << "\"name\": " << json_escape(e.name) << ", "
+            << "\"pid\": 0, \"tid\": " << e.thread << ", "
+            << tfm::format("\"ts\": %.3f", e.start);
+        if (e.type == 'X')
+            oss << tfm::format(", \"dur\": %.3f", e.duration);
+        if (!e.args.empty())
+            oss << ", \"args\": {" << e.args << "}";
+        oss << "}";
+        first = false;
+    }
+    oss << std::endl << "]}" << std::endl;
+    return oss.str();
+}
+
+void TraceRecorder::write(const fs::path &filename) {
+    std::string str = json();
+    ref<FileStream> stream =
+        new FileStream(filename, FileStream::ETruncReadWrite);
+    stream->write(str.data(), str.size());
+    stream->close();
+    Log(Info, "Wrote a trace of %zu events to \"%s\".", event_count(),
+        filename.string());
+}
+
+ScopedTraceEvent::ScopedTraceEvent(const char *category,
+                                   const std::string &name)
+    : m_active(TraceRecorder::running()), m_category(category), m_start(0.0) {
+    if (m_active) {
+        m_name = name;
+        m_start = TraceRecorder::timestamp();
+    }
+}
+
+ScopedTraceEvent::~ScopedTraceEvent() {
+    if (m_active)
+        TraceRecorder::add_event(m_category, m_name, m_start,
+                                 TraceRecorder::timestamp() - m_start, m_args);
+}
+
+void ScopedTraceEvent::set_arg(const char *key, const std::string &value) {
+    if (!m_active)
+        return;
+    if (!m_args.empty())
+        m_args += ", ";
+    m_args += json_escape(key) + ": " + json_escape(value);
+}
+
+void ScopedTraceEvent::set_arg_number(const char *key, double value) {
+    if (!m_args.empty())
+        m_args += ", ";
+    m_args += json_escape(key) + ": " + tfm::format("%.17g", value);
+}
+
+NAMESPACE_END(mitsuba)
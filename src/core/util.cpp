@@ -14,6 +14,7 @@
 #  include <unistd.h>
 #  include <limits.h>
 #  include <sys/ioctl.h>
+#  include <sys/syscall.h>
 #elif defined(__APPLE__)
 #  include <sys/sysctl.h>
 #  include <mach-o/dyld.h>
@@ -48,6 +49,48 @@ std::string last_error() {
 }
 #endif
 
+#if defined(__linux__)
+/**
+ * Return the number of cores granted by the CPU quota of the cgroup of the
+ * process (e.g. a container), or 0 when no quota is set
+ */
+static int cgroup_cpu_quota() {
+    auto read = [](const char *path, long long &a, long long &b) {
+        FILE *f = fopen(path, "r");
+        if (!f)
+            return 0;
+        char buf[64] = { 0 };
+        int count = 0;
+        if (fgets(buf, sizeof(buf), f)) {
+            if (strncmp(buf, "max", 3) == 0)
+                count = -1;
+            else
+                count = sscanf(buf, "%lld %lld", &a, &b);
+        }
+        fclose(f);
+        return count;
+    };
+
+    long long quota = 0, period = 0, unused = 0;
+
+    // cgroup v2: "<quota> <period>" or "max <period>"
+    int count = read("/sys/fs/cgroup/cpu.max", quota, period);
+    if (count < 0)
+        return 0;
+
+    // cgroup v1: separate files, a negative quota denotes no limit
+    if (count != 2 &&
+        (read("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", quota, unused) != 1 ||
+         read("/sys/fs/cgroup/cpu/cpu.cfs_period_us", period, unused) != 1))
+        return 0;
+
+    if (quota <= 0 || period <= 0)
+        return 0;
+
+    return (int) std::max((quota + period - 1) / period, 1ll);
+}
+#endif
+
 static int __cached_core_count = 0;
 
 int core_count() {
@@ -115,11 +158,104 @@ int core_count() {
     }
 
 done:
+    /* Containers may restrict the CPU time of the process to fewer cores
+       than the affinity map suggests, which oversubscribes them otherwise */
+    int quota = cgroup_cpu_quota();
+    if (quota > 0 && quota < ncores)
+        ncores = quota;
+
     __cached_core_count = ncores;
     return ncores;
 #endif
 }
 
+#if defined(__linux__)
+/// Parse a list of ranges of the form "0-3,8,10-11" as used by sysfs
+static std::vector<int> parse_range_list(const std::string &path) {
+    std::vector<int> result;
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f)
+        return result;
+    char buf[4096];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+
+    for (const std::string &range : string::tokenize(buf, ",\n")) {
+        size_t sep = range.find('-');
+        int first = std::atoi(range.c_str()),
+            last  = sep == std::string::npos ? first
+                                             : std::atoi(range.c_str() + sep + 1);
+        for (int i = first; i <= last; ++i)
+            result.push_back(i);
+    }
+    return result;
+}
+
+static const std::vector<int> &numa_nodes() {
+    static std::vector<int> nodes = []() {
+        std::vector<int> result =
+            parse_range_list("/sys/devices/system/node/online");
+        if (result.empty())
+            result.push_back(0);
+        return result;
+    }();
+    return nodes;
+}
+#endif
+
+int numa_node_count() {
+#if defined(__linux__)
+    return (int) numa_nodes().size();
+#else
+    return 1;
+#endif
+}
+
+std::vector<int> numa_node_cores(int node) {
+#if defined(__linux__)
+    if (node >= 0 && node < numa_node_count()) {
+        std::vector<int> cores = parse_range_list(tfm::format(
+            "/sys/devices/system/node/node%i/cpulist", numa_nodes()[node]));
+        if (!cores.empty())
+            return cores;
+    }
+#endif
+    std::vector<int> cores;
+    if (node == 0)
+        for (int i = 0; i < core_count(); ++i)
+            cores.push_back(i);
+    return cores;
+}
+
+void numa_interleave(const void *ptr, size_t size) {
+#if defined(__linux__)
+    const std::vector<int> &nodes = numa_nodes();
+    if (nodes.size() < 2 || size == 0)
+        return;
+
+    // Constants of <numaif.h>, to avoid a dependency on libnuma
+    const int mpol_interleave = 3;
+    const unsigned mpol_mf_move = 1 << 1;
+
+    const size_t bits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask((nodes.back() + bits) / bits, 0ul);
+    for (int node : nodes)
+        mask[node / bits] |= 1ul << (node % bits);
+
+    // mbind() operates on whole pages
+    uintptr_t page  = (uintptr_t) sysconf(_SC_PAGESIZE),
+              start = (uintptr_t) ptr & ~(page - 1),
+              end   = ((uintptr_t) ptr + size + page - 1) & ~(page - 1);
+
+    if (syscall(SYS_mbind, start, end - start, mpol_interleave, mask.data(),
+                mask.size() * bits + 1, mpol_mf_move) != 0)
+        Log(Debug, "numa_interleave(): mbind() failed: %s", strerror(errno));
+#else
+    (void) ptr; (void) size;
+#endif
+}
+
 bool detect_debugger() {
 #if defined(__linux__)
     char exePath[PATH_MAX];
@@ -1,8 +1,9 @@
+#include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <fstream>
 #include <set>
 #include <unordered_map>
-#include <mutex>
 #include <map>
 
 #include <mitsuba/core/class.h>
@@ -16,6 +17,7 @@
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
+#include <mitsuba/core/tracer.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
@@ -224,8 +226,9 @@ struct XMLObject {
     std::function<std::string(ptrdiff_t)> offset;
     size_t location = 0;
     ref<Object> object;
-    std::mutex mutex;
     uint32_t scope = 0;
+    /// Time (in ms) spent in the plugin constructor, or -1 if not instantiated
+    float load_time = -1.f;
 };
 
 enum class ColorMode {
@@ -249,6 +252,7 @@ ColorMode variant_to_color_mode() {
 struct XMLParseContext {
     std::string variant;
     bool parallel;
+    bool skip_unreferenced = false;
 
     std::unordered_map<std::string, XMLObject> instances;
     Transform4f transform;
@@ -670,6 +674,9 @@ static std::pair<std::string, std::string> parse_xml(XMLSource &src, XMLParseCon
                         src.throw_error(node, "included file \"%s\" not found", filename);
 
                     Log(Info, "Loading included XML file \"%s\" ..", filename);
+                    ScopedTraceEvent trace("parse", filename.filename().string());
+                    if (trace.active())
+                        trace.set_arg("bytes", fs::file_size(filename));
 
                     pugi::xml_document doc;
                     pugi::xml_parse_result result = doc.load_file(filename.native().c_str());
@@ -991,6 +998,10 @@ static std::string init_xml_parse_context_from_file(XMLParseContext &ctx,
                                                     bool write_update) {
     fs::path filename = filename_;
 
+    ScopedTraceEvent trace("parse", filename.filename().string());
+    if (trace.active())
+        trace.set_arg("bytes", fs::file_size(filename));
+
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_file(filename.native().c_str(),
         pugi::parse_default |
@@ -1043,6 +1054,41 @@ static std::string init_xml_parse_context_from_file(XMLParseContext &ctx,
     return scene_id;
 }
 
+/**
+ * \brief Should this object be instantiated in a separate task when loading
+ * a scene in parallel?
+ *
+ * Only objects that load data from disk (e.g. meshes, bitmaps and volumes)
+ * or that build acceleration data structures are worth the overhead of a
+ * task. All other objects are created right away, unless they depend on
+ * another object that is still pending.
+ */
+static bool is_heavy_node(const XMLObject &inst) {
+    if (inst.props.has_property("filename"))
+        return true;
+    return inst.props.plugin_name() == "shapegroup";
+}
+
+/// Number of objects that are being instantiated (reported to the tracer)
+static std::atomic<int> active_instantiations { 0 };
+
+/// Reports a running instantiation to the \ref TraceRecorder
+struct ScopedTraceInstantiation {
+    bool traced = TraceRecorder::running();
+
+    ScopedTraceInstantiation() {
+        if (traced)
+            TraceRecorder::add_counter("instantiate", "Active instantiations",
+                                       (double) ++active_instantiations);
+    }
+
+    ~ScopedTraceInstantiation() {
+        if (traced)
+            TraceRecorder::add_counter("instantiate", "Active instantiations",
+                                       (double) --active_instantiations);
+    }
+};
+
 static Task *instantiate_node(XMLParseContext &ctx,
                               const std::string &id,
                               ThreadEnvironment &env,
@@ -1072,12 +1118,17 @@ static Task *instantiate_node(XMLParseContext &ctx,
             Task *task = instantiate_node(ctx, child_id, env, task_map, false);
             task_map.insert({child_id, task});
         }
-        deps.push_back(task_map.find(child_id)->second);
+        // Children that were instantiated right away don't have a task
+        Task *task = task_map.find(child_id)->second;
+        if (task)
+            deps.push_back(task);
     }
 
     auto instantiate = [&ctx, &env, id, scope]() {
         ScopedSetThreadEnvironment set_env(env);
         ScopedSetJITScope set_scope(ctx.parallel ? ctx.backend : 0u, scope);
+        ScopedTraceInstantiation trace;
+        Timer timer;
 
         auto it = ctx.instances.find(id);
         if (it == ctx.instances.end())
@@ -1118,6 +1169,7 @@ static Task *instantiate_node(XMLParseContext &ctx,
                   string::to_lower(inst.class_->name()), props.plugin_name(),
                   e.what());
         }
+        inst.load_time = (float) timer.value();
 
         auto unqueried = props.unqueried();
         if (!unqueried.empty()) {
@@ -1159,7 +1211,7 @@ static Task *instantiate_node(XMLParseContext &ctx,
         instantiate();
         return nullptr;
     } else {
-        if (ctx.parallel) {
+        if (ctx.parallel && (is_heavy_node(inst) || !deps.empty())) {
             // Instantiate object asynchronously
             return dr::do_async(instantiate, deps.data(), deps.size());
         } else {
@@ -1169,10 +1221,149 @@ static Task *instantiate_node(XMLParseContext &ctx,
     }
 }
 
+/// Log the objects that took the longest to instantiate
+static void log_load_times(const XMLParseContext &ctx) {
+    Logger *logger = Thread::thread()->logger();
+    if (!logger || logger->log_level() > LogLevel::Debug)
+        return;
+
+    std::vector<const std::pair<const std::string, XMLObject> *> objects;
+    for (auto &kv : ctx.instances) {
+        if (kv.second.load_time >= 0.f)
+            objects.push_back(&kv);
+    }
+
+    size_t count = std::min(objects.size(), (size_t) 10);
+    std::partial_sort(objects.begin(), objects.begin() + count, objects.end(),
+                      [](auto a, auto b) {
+                          return a->second.load_time > b->second.load_time;
+                      });
+
+    Log(Debug, "Slowest objects during scene instantiation:");
+    for (size_t i = 0; i < count; ++i) {
+        const XMLObject &inst = objects[i]->second;
+        Log(Debug, "  %s (%s plugin of type \"%s\"): %s", objects[i]->first,
+            string::to_lower(inst.class_->name()), inst.props.plugin_name(),
+            util::time_string(inst.load_time, true));
+    }
+}
+
+/// Follow the aliases of an object ID
+static std::string resolve_alias(const XMLParseContext &ctx, std::string id) {
+    for (auto it = ctx.instances.find(id);
+         it != ctx.instances.end() && !it->second.alias.empty();
+         it = ctx.instances.find(id))
+        id = it->second.alias;
+    return id;
+}
+
+/**
+ * \brief Remove unreferenced definitions from the top node of a scene
+ *
+ * Scene files often declare libraries of BSDFs, textures, media, etc. at the
+ * top level, most of which are not referenced by any object of the scene. The
+ * scene itself only uses its shapes, emitters, sensors, integrators and
+ * nested scenes. All other top-level objects with an explicit ID that are not
+ * reachable from these are removed from the scene, so that they (and the data
+ * that they would load from disk) are never instantiated. Since callers may
+ * still rely on these objects being children of the scene, this only happens
+ * when the \c skip_unreferenced flag of the loader is set.
+ *
+ * Returns the IDs of all objects that remain reachable from the top node.
+ */
+static std::set<std::string> prune_unreferenced(XMLParseContext &ctx,
+                                                const std::string &id) {
+    std::set<std::string> reachable;
+    std::vector<std::string> stack;
+    auto visit = [&](const std::string &id_) {
+        stack.push_back(resolve_alias(ctx, id_));
+        while (!stack.empty()) {
+            std::string cur = stack.back();
+            stack.pop_back();
+            auto it = ctx.instances.find(cur);
+            // Unknown objects are reported during instantiation
+            if (it == ctx.instances.end() || !reachable.insert(cur).second)
+                continue;
+            for (auto &kv : it->second.props.named_references())
+                stack.push_back(resolve_alias(ctx, kv.second));
+        }
+    };
+
+    std::string root_id = resolve_alias(ctx, id);
+    auto it = ctx.instances.find(root_id);
+    const Class *scene_class = Class::for_name("Scene", ctx.variant);
+    if (it == ctx.instances.end() || !scene_class ||
+        !it->second.class_->derives_from(scene_class)) {
+        visit(id);
+        return reachable;
+    }
+
+    std::vector<const Class *> used_classes;
+    for (const char *name : { "Shape", "Emitter", "Sensor", "Integrator", "Scene" }) {
+        const Class *class_ = Class::for_name(name, ctx.variant);
+        if (class_)
+            used_classes.push_back(class_);
+    }
+
+    // Gather everything that is reachable from the objects used by the scene
+    Properties &props = it->second.props;
+    std::vector<std::pair<std::string, std::string>> definitions;
+    reachable.insert(root_id);
+    for (auto &kv : props.named_references()) {
+        std::string child_id = resolve_alias(ctx, kv.second);
+        auto it2 = ctx.instances.find(child_id);
+        bool definition =
+            it2 != ctx.instances.end() &&
+            !string::starts_with(child_id, "_") &&
+            std::none_of(used_classes.begin(), used_classes.end(),
+                         [&](const Class *c) { return it2->second.class_->derives_from(c); });
+        if (definition)
+            definitions.emplace_back(kv.first, child_id);
+        else
+            visit(child_id);
+    }
+
+    std::vector<std::string> skipped;
+    for (auto &[name, child_id] : definitions) {
+        if (reachable.find(child_id) != reachable.end())
+            continue;
+        props.remove_property(name);
+        skipped.push_back(child_id);
+    }
+
+    if (!skipped.empty()) {
+        std::sort(skipped.begin(), skipped.end());
+        Log(Info, "Skipping %zu unreferenced object%s: %s", skipped.size(),
+            skipped.size() > 1 ? "s" : "", skipped);
+    }
+
+    return reachable;
+}
+
 static ref<Object> instantiate_top_node(XMLParseContext &ctx, const std::string &id) {
     ThreadEnvironment env;
     std::unordered_map<std::string, Task*> task_map;
+    ScopedTraceEvent trace("load", "Scene instantiation");
+    if (trace.active()) {
+        trace.set_arg("objects", ctx.instances.size());
+        trace.set_arg("parallel", ctx.parallel);
+    }
+
+    // Load the shared libraries of all referenced plugins concurrently
+    std::vector<std::string> plugin_names;
+    if (ctx.skip_unreferenced) {
+        for (const std::string &reachable_id : prune_unreferenced(ctx, id))
+            plugin_names.push_back(ctx.instances.find(reachable_id)->second.props.plugin_name());
+    } else {
+        for (const auto &kv : ctx.instances) {
+            if (kv.second.alias.empty())
+                plugin_names.push_back(kv.second.props.plugin_name());
+        }
+    }
+    PluginManager::instance()->preload(plugin_names);
+
     instantiate_node(ctx, id, env, task_map, true);
+    log_load_times(ctx);
 #if defined(MI_ENABLE_LLVM) || defined(MI_ENABLE_CUDA)
     if (ctx.backend && ctx.parallel)
         jit_new_scope((JitBackend) ctx.backend);
@@ -1359,7 +1550,8 @@ NAMESPACE_END(detail)
 std::vector<ref<Object>> load_string(const std::string &string,
                                      const std::string &variant,
                                      ParameterList param,
-                                     bool parallel) {
+                                     bool parallel,
+                                     bool skip_unreferenced) {
     ScopedPhase sp(ProfilerPhase::InitScene);
     pugi::xml_document doc;
     pugi::xml_parse_result result = doc.load_buffer(string.c_str(), string.length(),
@@ -1381,10 +1573,17 @@ std::vector<ref<Object>> load_string(const std::string &string,
     try {
         pugi::xml_node root = doc.document_element();
         detail::XMLParseContext ctx(variant, parallel);
+        ctx.skip_unreferenced = skip_unreferenced;
         Properties props;
         size_t arg_counter = 0; // Unused
-        auto scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, props,
-                                          param, arg_counter, 0).second;
+        std::string scene_id;
+        {
+            ScopedTraceEvent trace("parse", src.id);
+            if (trace.active())
+                trace.set_arg("bytes", string.length());
+            scene_id = detail::parse_xml(src, ctx, root, Tag::Invalid, props,
+                                         param, arg_counter, 0).second;
+        }
 
         for (const auto& p : param) {
             if (!std::get<2>(p))
@@ -1406,7 +1605,8 @@ std::vector<ref<Object>> load_file(const fs::path &filename,
                                    const std::string &variant,
                                    ParameterList param,
                                    bool write_update,
-                                   bool parallel) {
+                                   bool parallel,
+                                   bool skip_unreferenced) {
     ScopedPhase sp(ProfilerPhase::InitScene);
 
     if (!fs::exists(filename))
@@ -1423,6 +1623,7 @@ std::vector<ref<Object>> load_file(const fs::path &filename,
 
     try {
         detail::XMLParseContext ctx(variant, parallel);
+        ctx.skip_unreferenced = skip_unreferenced;
         auto scene_id = detail::init_xml_parse_context_from_file(ctx, filename, param, write_update);
 
         ref<Object> top_node = detail::instantiate_top_node(ctx, scene_id);
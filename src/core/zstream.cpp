@@ -1,5 +1,8 @@
 #include <mitsuba/core/zstream.h>
+#include <mitsuba/core/mstream.h>
+#include <nanothread/nanothread.h>
 #include <zlib.h>
+#include <limits>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -29,49 +32,126 @@ ZStream::ZStream(Stream *child_stream, EStreamType stream_type, int level)
     retval = inflateInit2(m_inflate_stream.get(), window_bits);
     if (retval != Z_OK)
         Throw("Could not initialize ZLIB: error code %i", retval);
+
+    MemoryStream *memory_stream = dynamic_cast<MemoryStream *>(child_stream);
+    if (memory_stream && !memory_stream->owns_buffer())
+        m_memory_stream = memory_stream;
 }
 
 void ZStream::write(const void *ptr, size_t size) {
     Assert(m_child_stream != nullptr);
 
-    m_deflate_stream->avail_in = (uInt) size;
-    m_deflate_stream->next_in = (uint8_t *) ptr;
+    // Coalesce small writes before handing them to zlib
+    if (m_write_size + size <= sizeof(m_write_buffer)) {
+        memcpy(m_write_buffer + m_write_size, ptr, size);
+        m_write_size += size;
+    } else {
+        deflate_data(m_write_buffer, m_write_size, Z_NO_FLUSH);
+        m_write_size = 0;
+
+        if (size < sizeof(m_write_buffer)) {
+            memcpy(m_write_buffer, ptr, size);
+            m_write_size = size;
+        } else {
+            deflate_data((const uint8_t *) ptr, size, Z_NO_FLUSH);
+        }
+    }
 
-    int output_size = 0;
+    m_did_write = true;
+}
 
+void ZStream::deflate_data(const uint8_t *p, size_t size, int flush) {
     do {
-        m_deflate_stream->avail_out = sizeof(m_deflate_buffer);
-        m_deflate_stream->next_out = m_deflate_buffer;
+        size_t chunk = std::min(size, (size_t) std::numeric_limits<uInt>::max());
+        int chunk_flush = chunk == size ? flush : Z_NO_FLUSH;
+
+        m_deflate_stream->avail_in = (uInt) chunk;
+        m_deflate_stream->next_in = (Bytef *) p;
+
+        do {
+            m_deflate_stream->avail_out = sizeof(m_deflate_buffer);
+            m_deflate_stream->next_out = m_deflate_buffer;
 
-        int retval = deflate(m_deflate_stream.get(), Z_NO_FLUSH);
-        if (retval == Z_STREAM_ERROR)
-            Throw("deflate(): stream error!");
+            int retval = deflate(m_deflate_stream.get(), chunk_flush);
+            if (retval == Z_STREAM_ERROR)
+                Throw("deflate(): stream error!");
 
-        output_size = sizeof(m_deflate_buffer) - m_deflate_stream->avail_out;
+            size_t output_size =
+                sizeof(m_deflate_buffer) - m_deflate_stream->avail_out;
 
-        m_child_stream->write(m_deflate_buffer, output_size);
-    } while (output_size != 0);
+            if (output_size > 0)
+                m_child_stream->write(m_deflate_buffer, output_size);
+        } while (m_deflate_stream->avail_out == 0);
 
-    Assert(m_deflate_stream->avail_in == 0);
-    m_did_write = true;
+        Assert(m_deflate_stream->avail_in == 0);
+        p += chunk;
+        size -= chunk;
+    } while (size > 0);
 }
 
 void ZStream::read(void *ptr, size_t size) {
     Assert(m_child_stream != nullptr);
 
-    uint8_t *targetPtr = (uint8_t *) ptr;
+    uint8_t *target_ptr = (uint8_t *) ptr;
+    while (size > 0) {
+        // Serve the request from previously decompressed data if possible
+        size_t available = std::min(size, m_read_size - m_read_pos);
+        if (available > 0) {
+            memcpy(target_ptr, m_read_buffer + m_read_pos, available);
+            m_read_pos += available;
+            target_ptr += available;
+            size -= available;
+            continue;
+        }
+
+        // Large reads are directly decompressed into the target
+        if (size >= sizeof(m_read_buffer)) {
+            inflate_data(target_ptr, size, false);
+            return;
+        }
+
+        m_read_pos = 0;
+        m_read_size = inflate_data(m_read_buffer, sizeof(m_read_buffer), true);
+        if (m_read_size == 0)
+            Throw("inflate(): attempting to read past the end of the stream!");
+    }
+}
+
+size_t ZStream::inflate_data(uint8_t *p, size_t size, bool partial) {
+    size_t total = 0;
+
     while (size > 0) {
         if (m_inflate_stream->avail_in == 0) {
-            size_t remaining = m_child_stream->size() - m_child_stream->tell();
-            m_inflate_stream->next_in = m_inflate_buffer;
-            m_inflate_stream->avail_in = (uInt) std::min(remaining, sizeof(m_inflate_buffer));
-            if (m_inflate_stream->avail_in == 0)
+            size_t pos = m_child_stream->tell(),
+                   remaining = m_child_stream->size() - pos;
+
+            if (m_memory_stream) {
+                // Decompress directly from the memory of the child stream
+                remaining = std::min(remaining,
+                                     (size_t) std::numeric_limits<uInt>::max());
+                m_inflate_stream->next_in =
+                    (Bytef *) m_memory_stream->raw_buffer() + pos;
+                m_inflate_stream->avail_in = (uInt) remaining;
+                m_memory_stream->seek(pos + remaining);
+            } else {
+                m_inflate_stream->next_in = m_inflate_buffer;
+                m_inflate_stream->avail_in =
+                    (uInt) std::min(remaining, sizeof(m_inflate_buffer));
+                if (m_inflate_stream->avail_in > 0)
+                    m_child_stream->read(m_inflate_buffer,
+                                         m_inflate_stream->avail_in);
+            }
+
+            if (m_inflate_stream->avail_in == 0) {
+                if (partial)
+                    break;
                 Throw("Read less data than expected (%i more bytes required)", size);
-            m_child_stream->read(m_inflate_buffer, m_inflate_stream->avail_in);
+            }
         }
 
-        m_inflate_stream->avail_out = (uInt) size;
-        m_inflate_stream->next_out = targetPtr;
+        size_t chunk = std::min(size, (size_t) std::numeric_limits<uInt>::max());
+        m_inflate_stream->avail_out = (uInt) chunk;
+        m_inflate_stream->next_out = p;
 
         int retval = inflate(m_inflate_stream.get(), Z_NO_FLUSH);
         switch (retval) {
@@ -89,36 +169,27 @@ void ZStream::read(void *ptr, size_t size) {
                 break;
         };
 
-        size_t output_size = size - (size_t) m_inflate_stream->avail_out;
-        targetPtr += output_size;
+        size_t output_size = chunk - (size_t) m_inflate_stream->avail_out;
+        p += output_size;
         size -= output_size;
+        total += output_size;
 
-        if (size > 0 && retval == Z_STREAM_END)
+        if (size > 0 && retval == Z_STREAM_END) {
+            if (partial)
+                break;
             Throw("inflate(): attempting to read past the end of the stream!");
+        }
     }
+
+    return total;
 }
 
 void ZStream::flush() {
     Assert(m_child_stream != nullptr);
 
     if (m_did_write) {
-        m_deflate_stream->avail_in = 0;
-        m_deflate_stream->next_in = NULL;
-        int output_size = 0;
-
-        do {
-            m_deflate_stream->avail_out = sizeof(m_deflate_buffer);
-            m_deflate_stream->next_out = m_deflate_buffer;
-
-            int retval = deflate(m_deflate_stream.get(), Z_FULL_FLUSH);
-            if (retval == Z_STREAM_ERROR)
-                Throw("deflate(): stream error!");
-
-            output_size = sizeof(m_deflate_buffer) - m_deflate_stream->avail_out;
-
-            m_child_stream->write(m_deflate_buffer, output_size);
-        } while (output_size != 0);
-
+        deflate_data(m_write_buffer, m_write_size, Z_FULL_FLUSH);
+        m_write_size = 0;
         m_child_stream->flush();
     }
 }
@@ -128,28 +199,209 @@ void ZStream::close() {
         return;
 
     if (m_did_write) {
-        m_deflate_stream->avail_in = 0;
-        m_deflate_stream->next_in = NULL;
-        int output_size = 0;
+        deflate_data(m_write_buffer, m_write_size, Z_FINISH);
+        m_write_size = 0;
+    }
 
-        do {
-            m_deflate_stream->avail_out = sizeof(m_deflate_buffer);
-            m_deflate_stream->next_out = m_deflate_buffer;
+    deflateEnd(m_deflate_stream.get());
+    inflateEnd(m_inflate_stream.get());
 
-            int retval = deflate(m_deflate_stream.get(), Z_FINISH);
-            if (retval == Z_STREAM_ERROR)
+    m_child_stream = nullptr;
+    m_memory_stream = nullptr;
+}
+
+/// Compress a block of a parallel deflate stream (without header or trailer)
+static std::vector<uint8_t> deflate_block(const uint8_t *data, size_t size,
+                                          const uint8_t *dict, size_t dict_size,
+                                          int level, bool last) {
+    z_stream stream = {};
+    int retval = deflateInit2(&stream, level, Z_DEFLATED, -15, 8,
+                              Z_DEFAULT_STRATEGY);
+    if (retval != Z_OK)
+        Throw("Could not initialize ZLIB: error code %i", retval);
+
+    if (dict_size > 0) {
+        retval = deflateSetDictionary(&stream, dict, (uInt) dict_size);
+        if (retval != Z_OK) {
+            deflateEnd(&stream);
+            Throw("deflateSetDictionary(): error code %i", retval);
+        }
+    }
+
+    /* Non-final blocks end with a sync flush, which byte-aligns the output
+       so that the compressed blocks can simply be concatenated */
+    std::vector<uint8_t> result;
+    size_t offset = 0;
+    do {
+        size_t chunk = std::min(size - offset,
+                                (size_t) std::numeric_limits<uInt>::max());
+        bool end = offset + chunk == size;
+        int flush = !end ? Z_NO_FLUSH : (last ? Z_FINISH : Z_SYNC_FLUSH);
+
+        stream.next_in = (Bytef *) data + offset;
+        stream.avail_in = (uInt) chunk;
+
+        do {
+            size_t used = result.size(),
+                   extra = std::max(deflateBound(&stream, stream.avail_in),
+                                    (uLong) 64);
+            result.resize(used + extra);
+            stream.next_out = result.data() + used;
+            stream.avail_out = (uInt) extra;
+
+            retval = deflate(&stream, flush);
+            result.resize(used + extra - stream.avail_out);
+            if (retval == Z_STREAM_ERROR) {
+                deflateEnd(&stream);
                 Throw("deflate(): stream error!");
+            }
+        } while (stream.avail_out == 0);
+
+        offset += chunk;
+    } while (offset < size);
 
-            output_size = sizeof(m_deflate_buffer) - m_deflate_stream->avail_out;
+    deflateEnd(&stream);
+    return result;
+}
+
+std::vector<uint8_t> ZStream::compress(const void *data_, size_t size,
+                                       EStreamType stream_type, int level,
+                                       size_t block_size) {
+    const uint8_t *data = (const uint8_t *) data_;
+    const size_t window_size = 32768;
+
+    if (block_size == 0 || block_size >= size)
+        block_size = std::max(size, (size_t) 1);
+    block_size = std::max(block_size, window_size);
+    size_t block_count = std::max((size + block_size - 1) / block_size, (size_t) 1);
+
+    std::vector<std::vector<uint8_t>> blocks(block_count);
+    std::vector<uLong> checksums(block_count);
+    bool gzip = stream_type == EGZipStream;
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, block_count, 1),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                size_t offset = i * block_size,
+                       current = std::min(block_size, size - offset),
+                       dict_size = i > 0 ? window_size : 0;
+
+                blocks[i] = deflate_block(data + offset, current,
+                                          data + offset - dict_size, dict_size,
+                                          level, i + 1 == block_count);
+
+                uLong checksum = gzip ? crc32(0, Z_NULL, 0) : adler32(0, Z_NULL, 0);
+                for (size_t j = 0; j < current; ) {
+                    uInt chunk = (uInt) std::min(
+                        current - j, (size_t) std::numeric_limits<uInt>::max());
+                    checksum = gzip ? crc32(checksum, data + offset + j, chunk)
+                                    : adler32(checksum, data + offset + j, chunk);
+                    j += chunk;
+                }
+                checksums[i] = checksum;
+            }
+        }
+    );
 
-            m_child_stream->write(m_deflate_buffer, output_size);
-        } while (output_size != 0);
+    uLong checksum = checksums[0];
+    for (size_t i = 1; i < block_count; ++i) {
+        z_off_t length = (z_off_t) std::min(block_size, size - i * block_size);
+        checksum = gzip ? crc32_combine(checksum, checksums[i], length)
+                        : adler32_combine(checksum, checksums[i], length);
     }
 
-    deflateEnd(m_deflate_stream.get());
-    inflateEnd(m_inflate_stream.get());
+    size_t total = 18;
+    for (const auto &block : blocks)
+        total += block.size();
 
-    m_child_stream = nullptr;
+    std::vector<uint8_t> result;
+    result.reserve(total);
+
+    if (gzip) {
+        // Header without file name and modification time (RFC 1952)
+        uint8_t xfl = level == 9 ? 2 : (level == 1 ? 4 : 0);
+        const uint8_t header[10] = { 0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, xfl, 255 };
+        result.insert(result.end(), header, header + 10);
+    } else {
+        // Header with a 32 KiB window (RFC 1950)
+        int flevel = level < 0 ? 2 : (level < 2 ? 0 : (level < 6 ? 1 : (level == 6 ? 2 : 3)));
+        uint8_t cmf = 0x78, flg = (uint8_t) (flevel << 6);
+        flg += (uint8_t) (31 - (cmf * 256 + flg) % 31);
+        result.push_back(cmf);
+        result.push_back(flg);
+    }
+
+    for (const auto &block : blocks)
+        result.insert(result.end(), block.begin(), block.end());
+
+    if (gzip) {
+        for (int i = 0; i < 4; ++i)
+            result.push_back((uint8_t) (checksum >> (8 * i)));
+        for (int i = 0; i < 4; ++i)
+            result.push_back((uint8_t) ((uint64_t) size >> (8 * i)));
+    } else {
+        for (int i = 3; i >= 0; --i)
+            result.push_back((uint8_t) (checksum >> (8 * i)));
+    }
+
+    return result;
+}
+
+size_t ZStream::decompress(const void *src, size_t src_size, void *dst,
+                           size_t dst_size, EStreamType stream_type) {
+    z_stream stream = {};
+    int window_bits = 15 + (stream_type == EGZipStream ? 16 : 0);
+    int retval = inflateInit2(&stream, window_bits);
+    if (retval != Z_OK)
+        Throw("Could not initialize ZLIB: error code %i", retval);
+
+    const uint8_t *in = (const uint8_t *) src;
+    uint8_t *out = (uint8_t *) dst;
+    size_t in_left = src_size, out_left = dst_size;
+    const size_t max_chunk = std::numeric_limits<uInt>::max();
+
+    do {
+        if (stream.avail_in == 0) {
+            stream.next_in = (Bytef *) in;
+            stream.avail_in = (uInt) std::min(in_left, max_chunk);
+            in += stream.avail_in;
+            in_left -= stream.avail_in;
+        }
+        if (stream.avail_out == 0) {
+            stream.next_out = out;
+            stream.avail_out = (uInt) std::min(out_left, max_chunk);
+            out += stream.avail_out;
+            out_left -= stream.avail_out;
+        }
+
+        size_t avail_in = stream.avail_in, avail_out = stream.avail_out;
+        retval = inflate(&stream, Z_NO_FLUSH);
+        bool progress = avail_in != stream.avail_in ||
+                        avail_out != stream.avail_out;
+
+        if (retval != Z_OK && retval != Z_STREAM_END &&
+            !(retval == Z_BUF_ERROR && progress)) {
+            inflateEnd(&stream);
+            if (retval == Z_BUF_ERROR) {
+                if (stream.avail_in == 0 && in_left == 0)
+                    Throw("decompress(): the stream ended prematurely!");
+                Throw("decompress(): the data is larger than expected (%zu "
+                      "bytes)!", dst_size);
+            }
+            Throw("decompress(): %s", stream.msg ? stream.msg : "stream error!");
+        }
+    } while (retval != Z_STREAM_END);
+
+    size_t consumed = src_size - in_left - stream.avail_in,
+           produced = dst_size - out_left - stream.avail_out;
+    inflateEnd(&stream);
+
+    if (produced != dst_size)
+        Throw("decompress(): expected %zu bytes, but the stream only contains "
+              "%zu bytes!", dst_size, produced);
+
+    return consumed;
 }
 
 ZStream::~ZStream() {
@@ -228,6 +228,14 @@ public:
             si, math::sample_shifted<Wavelength>(sample), active);
     }
 
+    ScalarFloat flux_estimate() const override {
+        if (!m_shape)
+            return 0.f;
+        // Cosine-weighted emission into the hemisphere: pi * area * radiance
+        return (ScalarFloat) dr::slice(dr::Pi<Float> * m_shape->surface_area() *
+                                       m_radiance->mean());
+    }
+
     ScalarBoundingBox3f bbox() const override { return m_shape->bbox(); }
 
     std::string to_string() const override {
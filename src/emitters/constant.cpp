@@ -178,6 +178,12 @@ public:
         }
     }
 
+    ScalarFloat flux_estimate() const override {
+        // Radiance arriving from all directions at a disk of the scene's radius
+        return (ScalarFloat) dr::slice(
+            4.f * dr::sqr(dr::Pi<Float> * m_bsphere.radius) * m_radiance->mean());
+    }
+
     /// This emitter does not occupy any particular region of space, return an invalid bounding box
     ScalarBoundingBox3f bbox() const override {
         return ScalarBoundingBox3f();
@@ -211,6 +211,12 @@ public:
         }
     }
 
+    ScalarFloat flux_estimate() const override {
+        // Irradiance received by a disk covering the scene
+        return (ScalarFloat) dr::slice(dr::Pi<Float> * dr::sqr(m_bsphere.radius) *
+                                       m_irradiance->mean());
+    }
+
     ScalarBoundingBox3f bbox() const override {
         /* This emitter does not occupy any particular region
            of space, return an invalid bounding box */
@@ -10,6 +10,10 @@
 #include <drjit/tensor.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/core/fstream.h>
+#include <nanothread/nanothread.h>
+
+/// Minimum weight of the directions below the horizon in hemisphere warps
+#define MI_ENVMAP_HEMISPHERE_FLOOR 0.05f
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -21,7 +25,7 @@ Environment emitter (:monosp:`envmap`)
 --------------------------------------
 
 .. pluginparameters::
- :extra-rows: 4
+ :extra-rows: 5
 
  * - filename
    - |string|
@@ -49,6 +53,12 @@ Environment emitter (:monosp:`envmap`)
      will be combined using multiple importance sampling (MIS)? This is
      extremely cheap to do and can slightly reduce variance. (Default: false)
 
+ * - hemisphere_res
+   - |int|
+   - Resolution of the octahedral grid of normal directions used to build
+     hemisphere-aware sampling warps (see below). A value of zero disables them.
+     (Default: 0)
+
  * - data
    - |tensor|
    - Tensor array containing the radiance-valued data.
@@ -79,6 +89,20 @@ High quality free light probes are available on
 `Bernhard Vogl's <http://dativ.at/lightprobes/>`_ website or 
 `Polyhaven <https://polyhaven.com/hdris>`_.
 
+By default, emitter sampling draws directions proportionally to the luminance
+of the environment map, independently of the surface being shaded, hence a
+significant fraction of the samples can land below its horizon. When
+:paramtype:`hemisphere_res` is set to :math:`R > 0`, the plugin additionally
+builds :math:`R^2` sampling warps for an octahedral grid of normal directions,
+in which the luminance is weighted by a smooth clamped cosine around the
+normal of the grid cell. The warp of the cell containing the geometric normal
+of the shading point is then used to sample and evaluate directions, which
+concentrates the samples on its visible hemisphere. All directions retain a
+nonzero density, so that transmission through surfaces is still sampled.
+Interactions without a normal (e.g. in media) use the regular warp. The
+additional warps require :math:`R^2` times the memory of the regular warp,
+and values of 4 to 6 work well in practice.
+
 .. tabs::
     .. code-tab:: xml
         :name: envmap-light
@@ -101,6 +125,7 @@ public:
     MI_IMPORT_TYPES(Scene, Shape, Texture)
 
     using Warp = Hierarchical2D<Float, 0>;
+    using HemisphereWarp = Hierarchical2D<Float, 1>;
 
     /* In RGB variants: 3-channel array for R, G, and B components
        In spectral variants: 4-channel array for polynomial coefficients & scale */
@@ -185,6 +210,7 @@ public:
         }
 
         size_t pixel_width = is_spectral_v<Spectrum> ? 4 : 3;
+        double lum_sum = 0.0, weight_sum = 0.0;
         for (size_t y = 0; y < bitmap->size().y(); ++y) {
             ScalarFloat sin_theta = dr::sin(y * theta_scale);
 
@@ -192,6 +218,8 @@ public:
                 ScalarColor3f rgb = dr::load<ScalarVector3f>(in_ptr);
 
                 ScalarFloat lum = mitsuba::luminance(rgb);
+                lum_sum += (double) (lum * sin_theta);
+                weight_sum += (double) sin_theta;
 
                 ScalarPixelData coeff;
                 if constexpr (is_monochromatic_v<Spectrum>) {
@@ -228,9 +256,14 @@ public:
 
         size_t shape[3] = { (size_t) res.y(), (size_t) res.x(), pixel_width };
         m_data = TensorXf(bitmap_2->data(), 3, shape);
+        m_mean_luminance = ScalarFloat(lum_sum / dr::maximum(weight_sum, 1e-8));
 
         m_scale = props.get<ScalarFloat>("scale", 1.f);
         m_warp = Warp(luminance.get(), res);
+
+        m_hemisphere_res = props.get<uint32_t>("hemisphere_res", 0);
+        if (m_hemisphere_res > 0)
+            build_hemisphere_warp(luminance.get(), res);
         m_d65 = Texture::D65(1.f);
         m_flags = EmitterFlags::Infinite | EmitterFlags::SpatiallyVarying;
         dr::set_attr(this, "flags", m_flags);
@@ -272,6 +305,7 @@ public:
             size_t pixel_width = is_spectral_v<Spectrum> ? 4 : 3;
 
             ScalarFloat theta_scale = 1.f / (res.y() - 1) * dr::Pi<Float>;
+            double lum_sum = 0.0, weight_sum = 0.0;
             for (size_t y = 0; y < res.y(); ++y) {
                 ScalarFloat sin_theta = dr::sin(y * theta_scale);
 
@@ -300,10 +334,23 @@ public:
 
                     *lum_ptr++ = lum * sin_theta;
                     ptr += pixel_width;
+
+                    // Skip the duplicated last column
+                    if (x + 1 < res.x()) {
+                        lum_sum += (double) (lum * sin_theta);
+                        weight_sum += (double) sin_theta;
+                    }
                 }
             }
 
-            m_warp = Warp(luminance.get(), res);
+            // Reuse the sampling hierarchy when the resolution is unchanged
+            if (dr::all(m_warp.resolution() == res))
+                m_warp.update(luminance.get());
+            else
+                m_warp = Warp(luminance.get(), res);
+            if (m_hemisphere_res > 0)
+                build_hemisphere_warp(luminance.get(), res);
+            m_mean_luminance = ScalarFloat(lum_sum / dr::maximum(weight_sum, 1e-8));
         }
         Base::parameters_changed(keys);
     }
@@ -320,6 +367,12 @@ public:
         }
     }
 
+    ScalarFloat flux_estimate() const override {
+        // Radiance arriving from all directions at a disk of the scene's radius
+        return (ScalarFloat) dr::slice(4.f * dr::sqr(dr::Pi<Float> * m_bsphere.radius) *
+                                       m_mean_luminance * m_scale);
+    }
+
     Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
 
@@ -386,7 +439,14 @@ public:
                      Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
 
-        auto [uv, pdf] = m_warp.sample(sample, nullptr, active);
+        Point2f uv;
+        Float pdf;
+        if (m_hemisphere_res > 0) {
+            Float param = hemisphere_param(it);
+            std::tie(uv, pdf) = m_hemisphere_warp.sample(sample, &param, active);
+        } else {
+            std::tie(uv, pdf) = m_warp.sample(sample, nullptr, active);
+        }
         uv.x() += .5f / (m_data.shape(1) - 1);
         active &= pdf > 0.f;
 
@@ -427,7 +487,7 @@ public:
         return { ds, weight & active };
     }
 
-    Float pdf_direction(const Interaction3f & /*it*/, const DirectionSample3f &ds,
+    Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
                         Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
 
@@ -442,7 +502,15 @@ public:
         Float inv_sin_theta = dr::safe_rsqrt(dr::maximum(
             dr::sqr(d.x()) + dr::sqr(d.z()), dr::sqr(dr::Epsilon<Float>)));
 
-        return m_warp.eval(uv) * inv_sin_theta * (1.f / (2.f * dr::sqr(dr::Pi<Float>)));
+        Float pdf;
+        if (m_hemisphere_res > 0) {
+            Float param = hemisphere_param(it);
+            pdf = m_hemisphere_warp.eval(uv, &param, active);
+        } else {
+            pdf = m_warp.eval(uv, nullptr, active);
+        }
+
+        return pdf * inv_sin_theta * (1.f / (2.f * dr::sqr(dr::Pi<Float>)));
     }
 
     Spectrum eval_direction(const Interaction3f &it,
@@ -489,6 +557,7 @@ public:
         if (!m_filename.empty())
             oss << "  filename = \"" << m_filename << "\"," << std::endl;
         oss << "  res = \"" << res << "\"," << std::endl
+            << "  hemisphere_res = " << m_hemisphere_res << "," << std::endl
             << "  bsphere = " << string::indent(m_bsphere) << std::endl
             << "]";
         return oss.str();
@@ -555,14 +624,126 @@ protected:
         }
     }
 
+    /// Map a unit vector onto the octahedral parameterization of the sphere
+    template <typename Vector3, typename Point2 = Point<dr::value_t<Vector3>, 2>>
+    static Point2 octahedral_encode(const Vector3 &v) {
+        Point2 p = Point2(v.x(), v.y()) / (dr::abs(v.x()) + dr::abs(v.y()) + dr::abs(v.z()));
+        Point2 folded = (1.f - dr::abs(Point2(p.y(), p.x()))) *
+                        dr::mulsign(Point2(1.f), p);
+        return dr::fmadd(dr::select(v.z() < 0.f, folded, p), .5f, .5f);
+    }
+
+    /// Inverse of \ref octahedral_encode()
+    static ScalarVector3f octahedral_decode(const ScalarPoint2f &uv) {
+        ScalarPoint2f p = dr::fmsub(uv, 2.f, 1.f);
+        ScalarVector3f v(p.x(), p.y(), 1.f - dr::abs(p.x()) - dr::abs(p.y()));
+        ScalarFloat t = dr::maximum(-v.z(), 0.f);
+        v.x() += v.x() >= 0.f ? -t : t;
+        v.y() += v.y() >= 0.f ? -t : t;
+        return dr::normalize(v);
+    }
+
+    /**
+     * \brief Build the hemisphere-aware warps from the luminance image
+     *
+     * Slice \c i of the conditional warp corresponds to cell \c i of the
+     * octahedral grid of normals, whose weights are a clamped cosine around
+     * the cell center. The cosine is shifted by the sine of the angular
+     * radius of the cell, such that the directions above the horizon of
+     * every normal of the cell are favored. The weights never vanish, which
+     * keeps the sampling unbiased. The last slice holds the unweighted
+     * luminance, which is used for interactions without a normal.
+     */
+    void build_hemisphere_warp(const ScalarFloat *luminance, const ScalarVector2u &res) {
+        uint32_t cells = dr::sqr(m_hemisphere_res),
+                 pixels = dr::prod(res);
+
+        std::vector<ScalarVector3f> center(cells);
+        std::vector<ScalarFloat> offset(cells);
+        ScalarFloat cell_size = 1.f / m_hemisphere_res;
+
+        for (uint32_t i = 0; i < cells; ++i) {
+            ScalarPoint2f cell(i % m_hemisphere_res, i / m_hemisphere_res);
+            center[i] = octahedral_decode((cell + .5f) * cell_size);
+
+            // Angular radius of the cell, based on points along its boundary
+            ScalarFloat cos_radius = 1.f;
+            for (uint32_t j = 0; j <= 8; ++j) {
+                ScalarFloat t = j / 8.f;
+                ScalarPoint2f boundary[4] = { { t, 0.f }, { t, 1.f },
+                                              { 0.f, t }, { 1.f, t } };
+                for (const ScalarPoint2f &b : boundary)
+                    cos_radius = dr::minimum(
+                        cos_radius,
+                        dr::dot(center[i], octahedral_decode((cell + b) * cell_size)));
+            }
+            offset[i] = dr::safe_sqrt(1.f - dr::sqr(dr::maximum(cos_radius, 0.f)));
+        }
+
+        std::unique_ptr<ScalarFloat[]> data(new ScalarFloat[(cells + 1) * pixels]);
+        ScalarFloat theta_scale = dr::Pi<ScalarFloat> / (res.y() - 1),
+                    phi_scale   = dr::TwoPi<ScalarFloat> / (res.x() - 1);
+
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(0, res.y(), 1),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                for (uint32_t y = range.begin(); y != range.end(); ++y) {
+                    for (uint32_t x = 0; x < res.x(); ++x) {
+                        // Direction of the pixel (see \ref sample_direction())
+                        ScalarVector3f d = dr::sphdir(y * theta_scale, (x + .5f) * phi_scale);
+                        d = ScalarVector3f(d.y(), d.z(), -d.x());
+
+                        uint32_t index = y * res.x() + x;
+                        ScalarFloat lum = luminance[index];
+                        for (uint32_t i = 0; i < cells; ++i) {
+                            ScalarFloat weight = dr::maximum(
+                                dr::dot(d, center[i]) + offset[i], 0.f);
+                            data[i * pixels + index] =
+                                lum * (weight + MI_ENVMAP_HEMISPHERE_FLOOR);
+                        }
+                        data[cells * pixels + index] = lum;
+                    }
+                }
+            }
+        );
+
+        std::unique_ptr<ScalarFloat[]> param_values(new ScalarFloat[cells + 1]);
+        for (uint32_t i = 0; i <= cells; ++i)
+            param_values[i] = (ScalarFloat) i;
+
+        m_hemisphere_warp = HemisphereWarp(data.get(), res, { { cells + 1 } },
+                                           { { param_values.get() } });
+    }
+
+    /// Index of the hemisphere warp associated with an interaction
+    Float hemisphere_param(const Interaction3f &it) const {
+        Vector3f n = m_to_world.value().inverse().transform_affine(Vector3f(it.n));
+        Float norm = dr::norm(n);
+        Mask valid = norm > 0.f;
+
+        Point2f uv = octahedral_encode(
+            dr::select(valid, n / norm, Vector3f(0.f, 0.f, 1.f)));
+        Point2u cell = dr::minimum(Point2u(uv * (ScalarFloat) m_hemisphere_res),
+                                   m_hemisphere_res - 1u);
+
+        return dr::select(valid,
+                          Float(dr::fmadd(cell.y(), m_hemisphere_res, cell.x())),
+                          Float(dr::sqr(m_hemisphere_res)));
+    }
+
     MI_DECLARE_CLASS()
 protected:
     std::string m_filename;
     ScalarBoundingSphere3f m_bsphere;
     TensorXf m_data;
     Warp m_warp;
+    /// Luminance warps weighted towards the hemisphere of an octahedral grid of normals
+    HemisphereWarp m_hemisphere_warp;
+    uint32_t m_hemisphere_res;
     ref<Texture> m_d65;
     Float m_scale;
+    /// Average luminance of the environment map (used for flux estimates)
+    ScalarFloat m_mean_luminance;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(EnvironmentMapEmitter, Emitter)
@@ -189,6 +189,10 @@ public:
         return 0.f;
     }
 
+    ScalarFloat flux_estimate() const override {
+        return (ScalarFloat) dr::slice(4.f * dr::Pi<Float> * m_intensity->mean());
+    }
+
     ScalarBoundingBox3f bbox() const override {
         return ScalarBoundingBox3f(m_position.scalar());
     }
@@ -254,6 +254,19 @@ public:
         return 0.f;
     }
 
+    ScalarFloat flux_estimate() const override {
+        // Solid angle of the cone, counting the falloff region half
+        Float solid_angle = 2.f * dr::Pi<Float> *
+            (1.f - .5f * (m_cos_beam_width + m_cos_cutoff_angle));
+        return (ScalarFloat) dr::slice(solid_angle * m_intensity->mean() *
+                                       m_texture->mean());
+    }
+
+    std::pair<ScalarVector3f, ScalarFloat> emission_cone() const override {
+        ScalarVector3f axis = m_to_world.scalar() * ScalarVector3f(0.f, 0.f, 1.f);
+        return { dr::normalize(axis), (ScalarFloat) dr::slice(m_cos_cutoff_angle) };
+    }
+
     ScalarBoundingBox3f bbox() const override {
         ScalarPoint3f p = m_to_world.scalar() * ScalarPoint3f(0.f);
         return ScalarBoundingBox3f(p, p);
@@ -116,3 +116,35 @@ def test03_load_bitmap(variants_all_rgb):
     w2 = emitter_2.eval(si)
 
     assert dr.allclose(w1, w2, rtol=1e-3)
+
+
+def test04_hemisphere_warps(variants_vec_backends_once_rgb):
+    rng = mi.PCG32(size=102400)
+    sample = mi.Point2f(rng.next_float32(), rng.next_float32())
+
+    tempdir = tempfile.TemporaryDirectory()
+    fname = os.path.join(tempdir.name, 'out.exr')
+    mi.Bitmap(dr.full(mi.TensorXf, 1, [32, 64])).write(fname)
+
+    emitter = mi.load_dict({ "type" : "envmap", "filename" : fname,
+                             "hemisphere_res" : 4 })
+    emitter_ref = mi.load_dict({ "type" : "envmap", "filename" : fname })
+
+    si = dr.zeros(mi.SurfaceInteraction3f, 102400)
+    si.n = dr.normalize(mi.Vector3f(0.3, 1.0, -0.2))
+    ds, w = emitter.sample_direction(si, sample)
+    assert dr.allclose(emitter.pdf_direction(si, ds), ds.pdf, rtol=1e-3)
+    si.wi = -ds.d
+    assert dr.allclose(w, emitter.eval(si) / ds.pdf, rtol=1e-3)
+
+    # Most samples lie above the horizon, but all directions are reachable
+    ds_ref, _ = emitter_ref.sample_direction(si, sample)
+    above = dr.count(dr.dot(ds.d, si.n) > 0)[0]
+    above_ref = dr.count(dr.dot(ds_ref.d, si.n) > 0)[0]
+    assert above > 1.3 * above_ref
+    assert dr.count(dr.dot(ds.d, si.n) < 0)[0] > 0
+
+    # Interactions without a normal use the regular luminance warp
+    si.n = 0
+    ds, _ = emitter.sample_direction(si, sample)
+    assert dr.allclose(ds.pdf, emitter_ref.pdf_direction(si, ds), rtol=1e-3)
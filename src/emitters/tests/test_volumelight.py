@@ -0,0 +1,107 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+
+
+def make_medium(emitter=True):
+    # Absorbing medium whose emission is concentrated in one corner
+    radiance = np.full((4, 4, 4, 1), 0.5, dtype=np.float32)
+    radiance[3, 3, 3] = 20.0
+    to_world = mi.ScalarTransform4f.translate([-1, -1, -1]).scale(2)
+
+    return mi.load_dict({
+        'type': 'cube',
+        'bsdf': {'type': 'null'},
+        'interior': {
+            'type': 'heterogeneous',
+            'sigma_t': {
+                'type': 'gridvolume',
+                'grid': mi.VolumeGrid(np.full((4, 4, 4, 1), 2.0, dtype=np.float32)),
+                'to_world': to_world
+            },
+            'albedo': 0.5,
+            'radiance': {
+                'type': 'gridvolume',
+                'grid': mi.VolumeGrid(radiance),
+                'to_world': to_world
+            }
+        },
+        **({'emitter': {'type': 'volumelight'}} if emitter else {})
+    })
+
+
+def test01_construct(variant_scalar_rgb):
+    shape = make_medium()
+    emitter = shape.emitter()
+    assert mi.has_flag(emitter.flags(), mi.EmitterFlags.Volume)
+    assert shape.interior_medium().is_emitter()
+    assert shape.interior_medium().emitter() is not None
+    assert dr.allclose(emitter.bbox().min, [-1, -1, -1])
+    assert dr.allclose(emitter.bbox().max, [1, 1, 1])
+
+    # The medium of the shape must be emissive
+    with pytest.raises(RuntimeError, match='radiance'):
+        mi.load_dict({
+            'type': 'cube',
+            'interior': {'type': 'homogeneous'},
+            'emitter': {'type': 'volumelight'}
+        })
+
+
+def test02_sample_direction(variant_scalar_rgb, np_rng):
+    shape = make_medium()
+    emitter, medium = shape.emitter(), shape.interior_medium()
+
+    it = dr.zeros(mi.SurfaceInteraction3f)
+    it.p = [0, 0, 3]
+    it.wavelengths = [550, 550, 550, 550]
+
+    for _ in range(20):
+        ds, weight = emitter.sample_direction(it, np_rng.random(2))
+        assert ds.pdf > 0 and dr.all(dr.abs(ds.p) <= 1)
+        assert dr.allclose(dr.norm(ds.p - it.p), ds.dist)
+        assert dr.allclose(emitter.pdf_direction(it, ds), ds.pdf, rtol=1e-4)
+
+        # The sample is weighted by the emission of the medium
+        mei = dr.zeros(mi.MediumInteraction3f)
+        mei.p = ds.p
+        mei.wavelengths = it.wavelengths
+        sigma_s, _, sigma_t = medium.get_scattering_coefficients(mei)
+        emission = (sigma_t - sigma_s) * medium.get_radiance(mei)
+        assert dr.allclose(weight * ds.pdf, emission, rtol=1e-4)
+        assert dr.allclose(emitter.eval_direction(it, ds), emission, rtol=1e-4)
+
+    # The density of positions is proportional to the radiance bounds
+    ds, _ = emitter.sample_direction(it, [0.999, 0.5])
+    assert dr.all(ds.p > 0.5)
+
+
+def test03_render(variants_vec_rgb):
+    def render(emitter):
+        medium = make_medium(emitter)
+        scene = mi.load_dict({
+            'type': 'scene',
+            'integrator': {'type': 'volpath', 'max_depth': 8},
+            'sensor': {
+                'type': 'perspective',
+                'fov': 60,
+                'to_world': mi.ScalarTransform4f.look_at(origin=[0, 0, 4],
+                                                         target=[0, 0, 0],
+                                                         up=[0, 1, 0]),
+                'film': {
+                    'type': 'hdrfilm',
+                    'width': 8,
+                    'height': 8,
+                    'rfilter': {'type': 'box'}
+                },
+                'sampler': {'type': 'independent', 'sample_count': 256}
+            },
+            'medium': medium
+        })
+        return np.array(mi.render(scene)).mean()
+
+    # Next event estimation of the volume light does not change the result
+    reference, estimate = render(False), render(True)
+    assert reference > 0
+    assert np.allclose(estimate, reference, rtol=0.05)
@@ -0,0 +1,269 @@
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/medium.h>
+#include <mitsuba/render/shape.h>
+#include <mitsuba/render/volume.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _emitter-volumelight:
+
+Volume light (:monosp:`volumelight`)
+------------------------------------
+
+This plugin enables next event estimation of the light emitted by a participating medium,
+such as fire or an explosion. It must be attached to the shape that encloses an emissive
+:ref:`heterogeneous <medium-heterogeneous>` medium, i.e. a medium with a :monosp:`radiance`
+volume. The shape itself does not emit light.
+
+.. tabs::
+    .. code-tab:: python
+
+        'fire': {
+            'type': 'cube',
+            'bsdf': {'type': 'null'},
+            'interior': {
+                'type': 'heterogeneous',
+                'sigma_t': {'type': 'gridvolume', 'filename': 'density.vol'},
+                'albedo': 0.1,
+                'radiance': {'type': 'gridvolume', 'filename': 'temperature.vol'}
+            },
+            'emitter': {'type': 'volumelight'}
+        }
+
+The emitter samples positions proportionally to upper bounds of the radiance over the voxels of
+the radiance volume (see :py:meth:`mitsuba.Volume.max_grid`), using a discrete distribution
+over all voxels followed by a uniform position within the selected voxel. The sample is weighted
+by the emission :math:`\sigma_a L_e` at that position.
+
+Once the emitter is attached, the :ref:`volpath <integrator-volpath>` integrator only accounts
+for the emission at tentative collisions along camera rays and after vertices that did not
+perform next event estimation, and next event estimation of the volume light is not combined
+with phase function or BSDF sampling using multiple importance sampling.
+
+ */
+
+template <typename Float, typename Spectrum>
+class VolumeLight final : public Emitter<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Emitter, m_flags)
+    MI_IMPORT_TYPES(Shape, Medium, Volume)
+
+    VolumeLight(const Properties &props) : Base(props) {
+        if (props.has_property("to_world"))
+            Throw("Found a 'to_world' transformation -- this is not allowed. "
+                  "The volume light inherits the transformation of the "
+                  "radiance volume of its medium.");
+
+        m_flags = EmitterFlags::Volume | EmitterFlags::SpatiallyVarying;
+        dr::set_attr(this, "flags", m_flags);
+    }
+
+    void set_shape(Shape *shape) override {
+        Base::set_shape(shape);
+
+        const Medium *medium = shape->interior_medium();
+        if (!medium || !medium->is_emitter())
+            Throw("A volume light must be attached to a shape whose interior "
+                  "medium has a 'radiance' volume!");
+        m_emitting_medium = medium;
+
+        /* The medium does not own its emitter, the pointer only tells the
+           integrators that the emission is sampled by this emitter */
+        const_cast<Medium *>(medium)->set_emitter(this);
+        update_distribution();
+    }
+
+    void parameters_changed(const std::vector<std::string> &/*keys*/) override {
+        if (m_emitting_medium)
+            update_distribution();
+    }
+
+    /// Build the distribution of positions over the voxels of the radiance volume
+    void update_distribution() {
+        const Volume *radiance = m_emitting_medium->radiance();
+
+        ScalarVector3i res = radiance->resolution();
+        m_resolution = ScalarVector3u(dr::maximum(res, 1));
+        m_to_world = radiance->to_local().inverse();
+
+        std::vector<ScalarFloat> bounds = radiance->max_grid(m_resolution);
+        for (ScalarFloat &b : bounds)
+            b = dr::maximum(b, 0.f);
+        m_distr = DiscreteDistribution<Float>(bounds.data(), bounds.size());
+
+        ScalarFloat volume = dr::abs(dr::dot(
+            dr::cross(m_to_world * ScalarVector3f(1.f, 0.f, 0.f),
+                      m_to_world * ScalarVector3f(0.f, 1.f, 0.f)),
+            m_to_world * ScalarVector3f(0.f, 0.f, 1.f)));
+        m_voxel_volume = volume / dr::prod(ScalarVector3f(m_resolution));
+    }
+
+    std::pair<PositionSample3f, Float>
+    sample_position(Float time, const Point2f &sample,
+                    Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSamplePosition, active);
+
+        auto [index, reused, pmf] = m_distr.sample_reuse_pmf(sample.x(), active);
+
+        /* Split the reused sample into two coordinates within the voxel. The
+           second one only takes the fine digits of the sample, which is
+           uniformly distributed at a resolution of 1/4096 of a voxel. */
+        Float fine = reused * 4096.f;
+        Point3f offset(sample.y(), fine - dr::floor(fine), reused);
+
+        UInt32 x = index % m_resolution.x(),
+               yz = index / m_resolution.x(),
+               y = yz % m_resolution.y(),
+               z = yz / m_resolution.y();
+
+        Point3f local = (Point3f(Float(x), Float(y), Float(z)) +
+                         dr::clamp(offset, 0.f, dr::OneMinusEpsilon<ScalarFloat>)) /
+                        ScalarVector3f(m_resolution);
+
+        PositionSample3f ps = dr::zeros<PositionSample3f>();
+        ps.p = m_to_world * local;
+        ps.time = time;
+        ps.pdf = pmf / m_voxel_volume;
+        ps.delta = false;
+
+        Float weight = dr::select(active && ps.pdf > 0.f, dr::rcp(ps.pdf), 0.f);
+        return { ps, weight };
+    }
+
+    Float pdf_position(const PositionSample3f &ps, Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+
+        Point3f local = m_to_world.inverse() * ps.p;
+        active &= dr::all(local >= 0.f && local < 1.f);
+
+        Point3u voxel = dr::minimum(Point3u(local * ScalarVector3f(m_resolution)),
+                                    m_resolution - 1u);
+        UInt32 index = voxel.x() + m_resolution.x() *
+                       (voxel.y() + m_resolution.y() * voxel.z());
+
+        return dr::select(active, m_distr.eval_pmf_normalized(index, active) /
+                                  m_voxel_volume, 0.f);
+    }
+
+    std::pair<DirectionSample3f, Spectrum>
+    sample_direction(const Interaction3f &it, const Point2f &sample,
+                     Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleDirection, active);
+
+        auto [ps, weight] = sample_position(it.time, sample, active);
+        active &= weight > 0.f;
+
+        DirectionSample3f ds(ps);
+        ds.d = ps.p - it.p;
+        Float dist_squared = dr::squared_norm(ds.d);
+        ds.dist = dr::sqrt(dist_squared);
+        ds.d /= ds.dist;
+        ds.n = -ds.d;
+        ds.pdf = dr::select(active, ps.pdf * dist_squared, 0.f);
+        ds.emitter = this;
+
+        UnpolarizedSpectrum spec = emission(ps.p, it, active) / ds.pdf;
+        return { ds, depolarizer<Spectrum>(spec) & active };
+    }
+
+    Float pdf_direction(const Interaction3f & /* it */,
+                        const DirectionSample3f &ds,
+                        Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        return pdf_position(ds, active) * dr::sqr(ds.dist);
+    }
+
+    Spectrum eval_direction(const Interaction3f &it,
+                            const DirectionSample3f &ds,
+                            Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointEvaluate, active);
+        return depolarizer<Spectrum>(emission(ds.p, it, active));
+    }
+
+    /// The enclosing surface does not emit light
+    Spectrum eval(const SurfaceInteraction3f & /* si */,
+                  Mask /* active */) const override {
+        return 0.f;
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &sample2, const Point2f &sample3,
+                                          Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        // 1. Sample spatial component
+        auto [ps, pos_weight] = sample_position(time, sample2, active);
+
+        // 2. Sample spectral component
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+        si.time = time;
+        auto [wavelengths, wav_weight] =
+            sample_wavelengths(si, wavelength_sample, active);
+        si.wavelengths = wavelengths;
+
+        // 3. Sample directional component (isotropic emission)
+        Vector3f d = warp::square_to_uniform_sphere(sample3);
+
+        UnpolarizedSpectrum weight = emission(ps.p, si, active) * pos_weight *
+                                     unpolarized_spectrum(wav_weight) *
+                                     (4.f * dr::Pi<ScalarFloat>);
+
+        return { Ray3f(ps.p, d, time, wavelengths),
+                 depolarizer<Spectrum>(weight) & active };
+    }
+
+    std::pair<Wavelength, Spectrum>
+    sample_wavelengths(const SurfaceInteraction3f & /* si */, Float sample,
+                       Mask /* active */) const override {
+        return sample_wavelength<Float, Spectrum>(sample);
+    }
+
+    ScalarBoundingBox3f bbox() const override {
+        ScalarBoundingBox3f unit(ScalarPoint3f(0.f), ScalarPoint3f(1.f)), bbox;
+        for (int i = 0; i < 8; ++i)
+            bbox.expand(m_to_world * unit.corner(i));
+        return bbox;
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "VolumeLight[" << std::endl
+            << "  resolution = " << m_resolution << "," << std::endl
+            << "  medium = " << string::indent(m_emitting_medium) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /// Evaluate the emission (absorption times radiance) of the medium at \c p
+    UnpolarizedSpectrum emission(const Point3f &p, const Interaction3f &it,
+                                 Mask active) const {
+        MediumInteraction3f mei = dr::zeros<MediumInteraction3f>();
+        mei.p = p;
+        mei.time = it.time;
+        mei.wavelengths = it.wavelengths;
+        mei.medium = m_emitting_medium;
+
+        auto [sigma_s, sigma_n, sigma_t] =
+            m_emitting_medium->get_scattering_coefficients(mei, active);
+        DRJIT_MARK_USED(sigma_n);
+        return (sigma_t - sigma_s) * m_emitting_medium->get_radiance(mei, active);
+    }
+
+private:
+    const Medium *m_emitting_medium = nullptr;
+    DiscreteDistribution<Float> m_distr;
+    ScalarTransform4f m_to_world;
+    ScalarVector3u m_resolution;
+    ScalarFloat m_voxel_volume;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(VolumeLight, Emitter)
+MI_EXPORT_PLUGIN(VolumeLight, "Volume light")
+NAMESPACE_END(mitsuba)
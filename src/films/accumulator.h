@@ -0,0 +1,324 @@
+#pragma once
+
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/tracer.h>
+#include <mitsuba/render/imageblock.h>
+#include <nanothread/nanothread.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Strategy used by films to merge image blocks into their storage
+enum class AccumulationMode {
+    /// All blocks are merged into one shared ImageBlock under a single lock
+    Shared,
+
+    /// The shared ImageBlock is protected by one lock per band of rows
+    Striped,
+
+    /// Blocks are merged into one of several private film-sized buffers
+    ThreadLocal
+};
+
+/**
+ * \brief Helper class that manages the accumulation storage of a film
+ *
+ * In scalar variants, many worker threads concurrently call \ref put_block()
+ * with small image blocks. Merging all of them into a single shared \ref
+ * ImageBlock under one lock can become a bottleneck on machines with many
+ * cores. This class provides two alternatives that films can expose via the
+ * \c accumulation parameter:
+ *
+ * - \c striped: the shared storage is split into bands of \c stripe_height
+ *   rows, each protected by its own lock. Blocks covering different bands are
+ *   merged concurrently. This mode needs no additional memory.
+ *
+ * - \c thread_local: there is one film-sized accumulation buffer per worker
+ *   thread (allocated lazily). A block is merged into any buffer that is
+ *   currently not in use, which in practice means that workers never wait for
+ *   each other. The buffers are reduced into the shared storage in parallel
+ *   when the film is developed.
+ *
+ * JIT variants only ever merge a single image block, hence they always use
+ * the \c shared strategy.
+ */
+template <typename Float, typename Spectrum>
+class FilmAccumulator {
+public:
+    MI_IMPORT_TYPES(ImageBlock)
+
+    FilmAccumulator(const Properties &props) {
+        std::string mode = string::to_lower(props.string("accumulation", "shared"));
+        if (mode == "shared")
+            m_mode = AccumulationMode::Shared;
+        else if (mode == "striped")
+            m_mode = AccumulationMode::Striped;
+        else if (mode == "thread_local")
+            m_mode = AccumulationMode::ThreadLocal;
+        else
+            Throw("The \"accumulation\" parameter must either be equal to "
+                  "\"shared\", \"striped\", or \"thread_local\". Found %s.",
+                  mode);
+
+        m_stripe_height = props.get<uint32_t>("stripe_height", 16);
+        if (m_stripe_height == 0)
+            Throw("The \"stripe_height\" parameter must be positive!");
+
+        if (dr::is_jit_v<Float> && m_mode != AccumulationMode::Shared) {
+            Log(Warn, "The \"accumulation\" parameter only has an effect in "
+                      "scalar variants, using \"shared\" instead.");
+            m_mode = AccumulationMode::Shared;
+        }
+    }
+
+    /// (Re-)allocate the storage for the given film region and channel count
+    void allocate(const ScalarVector2u &size, const ScalarPoint2u &offset,
+                  uint32_t channel_count) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_storage = new ImageBlock(size, offset, channel_count);
+
+        m_stripes.reset();
+        m_slots.clear();
+
+        if (m_mode == AccumulationMode::Striped) {
+            m_stripe_count = (size.y() + m_stripe_height - 1) / m_stripe_height;
+            m_stripes.reset(new std::mutex[std::max(m_stripe_count, 1u)]);
+        } else if (m_mode == AccumulationMode::ThreadLocal) {
+            size_t slot_count = std::max(Thread::thread_count(), (size_t) 1);
+            m_slots.reserve(slot_count);
+            for (size_t i = 0; i < slot_count; ++i)
+                m_slots.emplace_back(new Slot());
+        }
+    }
+
+    /// Merge an image block into the storage. Thread-safe.
+    void put_block(const ImageBlock *block) {
+        Assert(m_storage != nullptr);
+
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (m_mode == AccumulationMode::Striped) {
+                put_block_striped(block);
+                return;
+            } else if (m_mode == AccumulationMode::ThreadLocal) {
+                put_block_thread_local(block);
+                return;
+            }
+        }
+
+        double wait_start = trace_start();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        trace_wait(wait_start);
+        m_storage->put_block(block);
+    }
+
+    /// Clear the storage and all per-thread buffers
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_storage)
+            m_storage->clear();
+        for (auto &slot : m_slots) {
+            std::lock_guard<std::mutex> slot_lock(slot->mutex);
+            if (slot->block)
+                slot->block->clear();
+            slot->dirty = false;
+        }
+    }
+
+    /**
+     * \brief Return the storage ImageBlock after merging any pending
+     * per-thread buffers into it.
+     *
+     * The caller must hold the lock returned by \ref mutex() while accessing
+     * the block.
+     */
+    ImageBlock *storage() const {
+        flush();
+        return m_storage.get();
+    }
+
+    /**
+     * \brief Return the memory footprint of the storage and per-thread
+     * buffers that \ref allocate() would create for the given arguments
+     */
+    size_t allocation_footprint(const ScalarVector2u &size,
+                                uint32_t channel_count) const {
+        size_t bytes = (size_t) dr::prod(size) * channel_count * sizeof(ScalarFloat);
+        if (m_mode == AccumulationMode::ThreadLocal)
+            bytes *= 1 + std::max(Thread::thread_count(), (size_t) 1);
+        return bytes;
+    }
+
+    /// Return the memory footprint of the storage and per-thread buffers
+    size_t memory_footprint() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t result = m_storage ? m_storage->memory_footprint() : 0;
+        for (auto &slot : m_slots) {
+            std::lock_guard<std::mutex> slot_lock(slot->mutex);
+            if (slot->block)
+                result += slot->block->memory_footprint();
+        }
+        return result;
+    }
+
+    /// Has storage been allocated via \ref allocate()?
+    bool allocated() const { return m_storage != nullptr; }
+
+    /// Lock protecting the storage ImageBlock
+    std::mutex &mutex() const { return m_mutex; }
+
+    AccumulationMode mode() const { return m_mode; }
+
+    std::string mode_string() const {
+        switch (m_mode) {
+            case AccumulationMode::Striped:     return "striped";
+            case AccumulationMode::ThreadLocal: return "thread_local";
+            default:                            return "shared";
+        }
+    }
+
+protected:
+    struct Slot {
+        std::mutex mutex;
+        ref<ImageBlock> block;
+        bool dirty = false;
+    };
+
+    void put_block_striped(const ImageBlock *block) {
+        // Rows of the storage touched by the block (including its border)
+        int32_t y0 = block->offset().y() - (int32_t) block->border_size() -
+                     m_storage->offset().y(),
+                y1 = y0 + (int32_t) (block->size().y() + 2 * block->border_size());
+
+        y0 = std::max(y0, 0);
+        y1 = std::min(y1, (int32_t) m_storage->size().y());
+        if (y0 >= y1)
+            return;
+
+        uint32_t s0 = (uint32_t) y0 / m_stripe_height,
+                 s1 = (uint32_t) (y1 - 1) / m_stripe_height;
+
+        // Always acquire the stripes in increasing order to avoid deadlocks
+        double wait_start = trace_start();
+        for (uint32_t s = s0; s <= s1; ++s)
+            m_stripes[s].lock();
+        trace_wait(wait_start);
+
+        m_storage->put_block(block);
+
+        for (uint32_t s = s0; s <= s1; ++s)
+            m_stripes[s].unlock();
+    }
+
+    void put_block_thread_local(const ImageBlock *block) {
+        size_t n_slots = m_slots.size(),
+               start   = std::hash<std::thread::id>()(std::this_thread::get_id()) % n_slots;
+
+        /* With NUMA-aware scheduling, workers prefer a slot of their own. It
+           is allocated (and thus first written) by its worker and therefore
+           resides in the memory of the worker's node. */
+        if (Thread::numa_aware())
+            start = Thread::thread_id() % n_slots;
+
+        /* There is one slot per worker, hence a free slot can almost always
+           be found without waiting. Only block if every slot is taken. */
+        Slot *slot = nullptr;
+        for (size_t i = 0; i < n_slots; ++i) {
+            Slot *candidate = m_slots[(start + i) % n_slots].get();
+            if (candidate->mutex.try_lock()) {
+                slot = candidate;
+                break;
+            }
+        }
+
+        if (!slot) {
+            double wait_start = trace_start();
+            slot = m_slots[start].get();
+            slot->mutex.lock();
+            trace_wait(wait_start);
+        }
+
+        if (!slot->block) {
+            slot->block = new ImageBlock(m_storage->size(), m_storage->offset(),
+                                         m_storage->channel_count());
+            slot->block->clear();
+        }
+
+        slot->block->put_block(block);
+        slot->dirty = true;
+        slot->mutex.unlock();
+    }
+
+    /// Reduce all dirty per-thread buffers into the storage (in parallel)
+    void flush() const {
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (m_mode != AccumulationMode::ThreadLocal)
+                return;
+
+            std::vector<std::unique_lock<std::mutex>> locks;
+            std::vector<Slot *> dirty;
+            std::vector<const ScalarFloat *> sources;
+            for (auto &slot : m_slots) {
+                std::unique_lock<std::mutex> lock(slot->mutex);
+                if (!slot->dirty)
+                    continue;
+                dirty.push_back(slot.get());
+                sources.push_back(slot->block->tensor().data());
+                locks.push_back(std::move(lock));
+            }
+
+            if (sources.empty())
+                return;
+
+            ScalarFloat *target = m_storage->tensor().data();
+            size_t size = m_storage->tensor().size();
+
+            dr::parallel_for(
+                dr::blocked_range<size_t>(0, size, 1u << 14),
+                [&](const dr::blocked_range<size_t> &range) {
+                    for (const ScalarFloat *source : sources)
+                        for (size_t i = range.begin(); i != range.end(); ++i)
+                            target[i] += source[i];
+                }
+            );
+
+            for (Slot *slot : dirty) {
+                slot->block->clear();
+                slot->dirty = false;
+            }
+        }
+    }
+
+    /// Start time of a lock acquisition, or -1 if the recorder isn't running
+    static double trace_start() {
+        return TraceRecorder::running() ? TraceRecorder::timestamp() : -1.0;
+    }
+
+    /// Record the time spent waiting for a lock (ignoring uncontended locks)
+    static void trace_wait(double start) {
+        if (start < 0.0)
+            return;
+        double duration = TraceRecorder::timestamp() - start;
+        if (duration >= 1.0)
+            TraceRecorder::add_event("render", "put_block wait", start, duration);
+    }
+
+protected:
+    AccumulationMode m_mode;
+    uint32_t m_stripe_height;
+    uint32_t m_stripe_count = 0;
+    /* The storage is updated lazily in \ref flush(), which also happens
+       when a const film is developed */
+    mutable ref<ImageBlock> m_storage;
+    mutable std::mutex m_mutex;
+    std::unique_ptr<std::mutex[]> m_stripes;
+    std::vector<std::unique_ptr<Slot>> m_slots;
+};
+
+NAMESPACE_END(mitsuba)
@@ -3,12 +3,16 @@
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/render/film.h>
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/imageblock.h>
 
 #include <mutex>
 
+#include "accumulator.h"
+#include "tilestream.h"
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**!
@@ -19,7 +23,7 @@ High dynamic range film (:monosp:`hdrfilm`)
 -------------------------------------------
 
 .. pluginparameters::
- :extra-rows: 7
+ :extra-rows: 14
 
  * - width, height
    - |int|
@@ -43,6 +47,22 @@ High dynamic range film (:monosp:`hdrfilm`)
      The options are :monosp:`float16`, :monosp:`float32`, or :monosp:`uint32`.
      (Default: :monosp:`float16`)
 
+ * - compression
+   - |string|
+   - Compression codec used when writing OpenEXR files. The options are :monosp:`none`,
+     :monosp:`rle`, :monosp:`zips`, :monosp:`zip`, :monosp:`piz`, :monosp:`pxr24`,
+     :monosp:`dwaa`, and :monosp:`dwab`. The codecs :monosp:`rle` and :monosp:`zips` are
+     lossless and fastest to encode, which matters when large multi-channel images are
+     written frequently, while :monosp:`dwaa` and :monosp:`dwab` are lossy.
+     (Default: :monosp:`piz`)
+
+ * - write_async
+   - |bool|
+   - If set to |true|, :py:meth:`write()` returns right after developing the film and
+     encodes the image file on a background thread, so that rendering can resume (e.g.
+     with the next frame of an animation) while the file is being written. Pending
+     writes are completed at shutdown. (Default: |false|)
+
  * - crop_offset_x, crop_offset_y, crop_width, crop_height
    - |int|
    - These parameters can optionally be provided to select a sub-rectangle
@@ -64,6 +84,36 @@ High dynamic range film (:monosp:`hdrfilm`)
      in JIT variants and can make sample accumulation quite a bit more expensive.
      (Default: |false|, i.e. disabled)
 
+ * - accumulation
+   - |string|
+   - Strategy used to merge image blocks rendered by worker threads into the film
+     in scalar variants. The options are :monosp:`shared` (a single lock protects
+     the film), :monosp:`striped` (one lock per band of :monosp:`stripe_height` rows),
+     and :monosp:`thread_local` (each worker accumulates into a private, lazily
+     allocated film-sized buffer, and the buffers are summed up in parallel when
+     the film is developed). The latter is fastest on machines with many cores but
+     needs one additional copy of the film per thread. (Default: :monosp:`shared`)
+
+ * - stripe_height
+   - |int|
+   - Height of the bands of rows used by :monosp:`accumulation=striped`. (Default: 16)
+
+ * - variance
+   - |bool|
+   - If set to |true|, the film additionally accumulates the second moment of the
+     luminance of the samples and outputs two extra channels, :monosp:`sample_count`
+     and :monosp:`variance`, see below. (Default: |false|)
+
+ * - stream_file
+   - |string|
+   - If specified, the film does not keep the complete image in memory. It instead writes
+     completed tiles to a tiled OpenEXR file at this path while rendering, see below.
+     (Default: unused)
+
+ * - stream_tile_size
+   - |int|
+   - Size of the tiles written by :monosp:`stream_file` in pixels. (Default: 64)
+
  * - (Nested plugin)
    - :paramtype:`rfilter`
    - Reconstruction filter that should be used by the film. (Default: :monosp:`gaussian`, a windowed
@@ -107,6 +157,37 @@ data. PFM output is restricted to :monosp:`float32`-valued images using the :mon
 :monosp:`luminance` pixel formats. Due to the superior accuracy and adoption of OpenEXR, the use of
 these two alternative formats is discouraged however.
 
+When :monosp:`variance` is enabled, every image block created by the film also
+accumulates the squared luminance of the samples. The developed image then
+contains two additional trailing channels: :monosp:`sample_count` stores the
+accumulated reconstruction filter weight of the pixel (the number of samples
+when using the :ref:`box <rfilter-box>` filter), and :monosp:`variance` provides
+the estimated variance of the luminance of the pixel value, i.e. the sample
+variance divided by :monosp:`sample_count`. These estimates can drive adaptive
+sampling or denoising, and they are also accessible via :py:meth:`variance()`.
+Note that image blocks created by other means do not accumulate the second
+moment.
+
+AOV channels can be accumulated with their own sample budget, e.g. denoiser
+guides that converge after a few samples per pixel (see the
+:monosp:`aov_spp` parameter of the :ref:`aov <integrator-aov>` integrator).
+When the AOVs given to the film include a channel named
+:monosp:`<group>.W`, the other channels named :monosp:`<group>.*` are divided
+by its accumulated value instead of the reconstruction filter weight of the
+pixel. Samples that don't contribute to the group simply put zero into all of
+its channels. To reduce the size of the written guides, combine this with
+:monosp:`component_format=float16`.
+
+For very large output resolutions, the film can stream the image to disk
+instead of storing it in memory: when :monosp:`stream_file` is specified, the
+film only keeps the tiles of the image that are still receiving contributions.
+Once all image blocks whose reconstruction filter support overlaps a tile have
+been merged, the tile is developed, written to the tiled OpenEXR file, and its
+memory is released. Writing the film then completes the file and moves it to
+the requested destination. This mode requires single-pass rendering in a
+scalar variant and the OpenEXR file format. The image cannot be developed in
+memory in this case.
+
 When RGB(A) output is selected, the measured spectral power distributions are
 converted to linear RGB based on the CIE 1931 XYZ color matching curves and
 the ITU-R Rec. BT.709-3 primaries with a D65 white point.
@@ -138,7 +219,8 @@ public:
                    m_filter, m_flags)
     MI_IMPORT_TYPES(ImageBlock)
 
-    HDRFilm(const Properties &props) : Base(props) {
+    HDRFilm(const Properties &props)
+        : Base(props), m_accumulator(props), m_stream(props) {
         std::string file_format = string::to_lower(
             props.string("file_format", "openexr"));
         std::string pixel_format = string::to_lower(
@@ -224,16 +306,62 @@ public:
             }
         }
 
+        std::string compression = string::to_lower(
+            props.string("compression", "piz"));
+        if (compression == "none")
+            m_compression = Bitmap::EXRCompression::None;
+        else if (compression == "rle")
+            m_compression = Bitmap::EXRCompression::RLE;
+        else if (compression == "zips")
+            m_compression = Bitmap::EXRCompression::ZIPS;
+        else if (compression == "zip")
+            m_compression = Bitmap::EXRCompression::ZIP;
+        else if (compression == "piz")
+            m_compression = Bitmap::EXRCompression::PIZ;
+        else if (compression == "pxr24")
+            m_compression = Bitmap::EXRCompression::PXR24;
+        else if (compression == "dwaa")
+            m_compression = Bitmap::EXRCompression::DWAA;
+        else if (compression == "dwab")
+            m_compression = Bitmap::EXRCompression::DWAB;
+        else
+            Throw("The \"compression\" parameter must either be equal to "
+                  "\"none\", \"rle\", \"zips\", \"zip\", \"piz\", "
+                  "\"pxr24\", \"dwaa\", or \"dwab\". Found %s instead.",
+                  compression);
+
+        m_write_async = props.get<bool>("write_async", false);
         m_compensate = props.get<bool>("compensate", false);
 
+        m_variance = props.get<bool>("variance", false);
+        if (m_variance)
+            m_flags |= +FilmFlags::Variance;
+
+        if (m_stream.enabled() && m_file_format != Bitmap::FileFormat::OpenEXR)
+            Throw("The \"stream_file\" parameter requires the OpenEXR file "
+                  "format!");
+
         props.mark_queried("banner"); // no banner in Mitsuba 3
     }
 
+    size_t channel_count(const std::vector<std::string> &aovs) const override {
+        return (has_flag(m_flags, FilmFlags::Alpha) ? 5 : 4) + aovs.size() +
+               (size_t) m_variance;
+    }
+
+    size_t storage_footprint(const std::vector<std::string> &aovs) const override {
+        if (m_stream.enabled())
+            return m_stream.tile_footprint((uint32_t) channel_count(aovs));
+        return m_accumulator.allocation_footprint(
+            m_crop_size, (uint32_t) channel_count(aovs));
+    }
+
     size_t prepare(const std::vector<std::string> &aovs) override {
         bool alpha = has_flag(m_flags, FilmFlags::Alpha);
         size_t base_channels = alpha ? 5 : 4;
 
-        std::vector<std::string> channels(base_channels + aovs.size());
+        std::vector<std::string> channels(base_channels + aovs.size() +
+                                          (size_t) m_variance);
 
         // Add basic RGBAW channels to the film
         const char *base_channel_names = alpha ? "RGBAW" : "RGBW";
@@ -244,172 +372,180 @@ public:
         for (size_t i = 0; i < aovs.size(); ++i)
             channels[base_channels + i] = aovs[i];
 
-        /* locked */ {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_storage = new ImageBlock(m_crop_size, m_crop_offset,
-                                       (uint32_t) channels.size());
-            m_channels = channels;
+        // Second moment of the sample luminance
+        if (m_variance)
+            channels.back() = "M2";
+
+        /* AOV channels named "<group>.*" are normalized by the weight channel
+           "<group>.W" instead of the pixel weight, if there is one */
+        m_aov_weights.assign(aovs.size(), (uint32_t) base_channels - 1);
+        m_weight_groups = false;
+        for (size_t i = 0; i < aovs.size(); ++i) {
+            size_t dot = aovs[i].rfind('.');
+            if (dot == std::string::npos || aovs[i].compare(dot, std::string::npos, ".W") == 0)
+                continue;
+            auto it = std::find(aovs.begin(), aovs.end(), aovs[i].substr(0, dot) + ".W");
+            if (it != aovs.end()) {
+                m_aov_weights[i] = (uint32_t) (base_channels + (it - aovs.begin()));
+                m_weight_groups = true;
+            }
         }
 
+        if (!m_stream.enabled())
+            m_accumulator.allocate(m_crop_size, m_crop_offset,
+                                   (uint32_t) channels.size());
+        m_channels = channels;
+
         std::sort(channels.begin(), channels.end());
         auto it = std::unique(channels.begin(), channels.end());
         if (it != channels.end())
             Throw("Film::prepare(): duplicate channel name \"%s\"", *it);
 
+        if (m_stream.enabled()) {
+            uint32_t border = m_filter->border_size();
+            m_stream.open(m_crop_size, m_crop_offset,
+                          m_sample_border ? border : 0u, border,
+                          (uint32_t) m_channels.size(), m_pixel_format,
+                          m_compression, [this](const ImageBlock *block) {
+                              return convert_component_format(
+                                  develop_bitmap(block, false));
+                          });
+        }
+
         return m_channels.size();
     }
 
     ref<ImageBlock> create_block(const ScalarVector2u &size, bool normalize,
                                  bool border) override {
         bool warn = !dr::is_jit_v<Float> && !is_spectral_v<Spectrum> &&
-                    m_channels.size() <= 5;
+                    m_channels.size() <= 5 + (size_t) m_variance;
 
         bool default_config = size == ScalarVector2u(0);
 
-        return new ImageBlock(default_config ? m_crop_size : size,
-                              default_config ? m_crop_offset : ScalarPoint2u(0),
-                              (uint32_t) m_channels.size(), m_filter.get(),
-                              border /* border */,
-                              normalize /* normalize */,
-                              dr::is_jit_v<Float> /* coalesce */,
-                              m_compensate /* compensate */,
-                              warn /* warn_negative */,
-                              warn /* warn_invalid */);
+        ref<ImageBlock> block = new ImageBlock(
+            default_config ? m_crop_size : size,
+            default_config ? m_crop_offset : ScalarPoint2u(0),
+            (uint32_t) m_channels.size(), m_filter.get(),
+            border /* border */,
+            normalize /* normalize */,
+            dr::is_jit_v<Float> /* coalesce */,
+            m_compensate /* compensate */,
+            warn /* warn_negative */,
+            warn /* warn_invalid */);
+
+        if (m_variance)
+            block->set_second_moment(true);
+
+        return block;
     }
 
     void put_block(const ImageBlock *block) override {
-        Assert(m_storage != nullptr);
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_storage->put_block(block);
+        if (m_stream.enabled())
+            m_stream.put_block(block);
+        else
+            m_accumulator.put_block(block);
     }
 
     void clear() override {
-        if (m_storage)
-            m_storage->clear();
+        if (m_stream.enabled())
+            m_stream.clear();
+        else
+            m_accumulator.clear();
     }
 
     TensorXf develop(bool raw = false) const override {
-        if (!m_storage)
+        check_not_streaming("develop");
+        if (!m_accumulator.allocated())
             Throw("No storage allocated, was prepare() called first?");
 
         if (raw) {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            return m_storage->tensor();
+            std::lock_guard<std::mutex> lock(m_accumulator.mutex());
+            return m_accumulator.storage()->tensor();
         }
 
         if constexpr (dr::is_jit_v<Float>) {
             Float data;
+            ScalarVector2u size;
             uint32_t source_ch;
-            uint32_t pixel_count;
-            ScalarVector2i size;
 
             /* locked */ {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                data        = m_storage->tensor().array();
-                size        = m_storage->size();
-                source_ch   = (uint32_t) m_storage->channel_count();
-                pixel_count = dr::prod(m_storage->size());
-            }
-
-            /* The following code develops weighted image block data into
-               an output image of the desired configuration, while using
-               a minimal number of JIT kernel launches. */
-
-            // Determine what channels are needed
-            bool to_xyz    = m_pixel_format == Bitmap::PixelFormat::XYZ ||
-                             m_pixel_format == Bitmap::PixelFormat::XYZA;
-            bool to_y      = m_pixel_format == Bitmap::PixelFormat::Y ||
-                             m_pixel_format == Bitmap::PixelFormat::YA;
-
-            // Number of arbitrary output variables (AOVs)
-            bool alpha = has_flag(m_flags, FilmFlags::Alpha);
-            uint32_t base_ch = alpha ? 5 : 4,
-                     aovs    = source_ch - base_ch;
-
-            /// Number of desired color components
-            uint32_t color_ch = to_y ? 1 : 3;
-
-            // Number of channels of the target tensor
-            uint32_t target_ch = color_ch + aovs + (uint32_t) alpha;
-
-            // Index vectors referencing pixels & channels of the output image
-            UInt32 idx         = dr::arange<UInt32>(pixel_count * target_ch),
-                   pixel_idx   = idx / target_ch,
-                   channel_idx = dr::fmadd(pixel_idx, uint32_t(-(int) target_ch), idx);
-
-            /* Index vectors referencing source pixels/weights as follows:
-                 values_idx = R1, G1, B1, R2, G2, B2 (for RGB output)
-                 weight_idx = W1, W1, W1, W2, W2, W2 */
-            UInt32 values_idx = dr::fmadd(pixel_idx, source_ch, channel_idx),
-                   weight_idx = dr::fmadd(pixel_idx, source_ch, base_ch - 1);
-
-            // If AOVs are desired, their indices in 'values_idx' must be shifted
-            if (aovs) {
-                // Index of first AOV channel in output image
-                uint32_t first_aov = color_ch + (uint32_t) alpha;
-                values_idx[channel_idx >= first_aov] += base_ch - first_aov;
+                std::lock_guard<std::mutex> lock(m_accumulator.mutex());
+                const ImageBlock *storage = m_accumulator.storage();
+                data      = storage->tensor().array();
+                size      = storage->size();
+                source_ch = (uint32_t) storage->channel_count();
             }
 
-            // If luminance + alpha, shift alpha channel to skip the GB channels
-            if (alpha && to_y)
-                values_idx[dr::eq(channel_idx, color_ch /* alpha */)] += 2;
+            return develop_jit(data, size, source_ch);
+        } else {
+            std::lock_guard<std::mutex> lock(m_accumulator.mutex());
+            const ImageBlock *storage = m_accumulator.storage();
+            ScalarVector2u size = storage->size();
+            uint32_t target_ch = target_channel_count(storage->channel_count());
 
-            Mask value_mask = true;
+            auto data = dr::empty<DynamicBuffer<ScalarFloat>>(
+                (size_t) dr::prod(size) * target_ch);
+            develop_pixels(storage, data.data());
 
-            // XYZ/Y mode: don't gather color, will be computed below
-            if (to_xyz || to_y)
-                value_mask = channel_idx >= color_ch;
+            size_t shape[3] = { (size_t) size.y(), (size_t) size.x(),
+                                target_ch };
 
-            // Gather the pixel values from the image data buffer
-            Float weight = dr::gather<Float>(data, weight_idx),
-                  values = dr::gather<Float>(data, values_idx, value_mask);
+            return TensorXf(data, 3, shape);
+        }
+    }
 
-            // Fill color channels with XYZ/Y data if requested
-            if (to_xyz || to_y) {
-                UInt32 in_idx  = dr::arange<UInt32>(pixel_count) * source_ch,
-                       out_idx = dr::arange<UInt32>(pixel_count) * target_ch;
+    TensorXf variance() const override {
+        check_not_streaming("variance");
+        if (!m_variance)
+            Throw("HDRFilm::variance(): variance estimation is disabled, set "
+                  "\"variance\" to true!");
+        if (!m_accumulator.allocated())
+            Throw("No storage allocated, was prepare() called first?");
 
-                Color3f rgb = Color3f(dr::gather<Float>(data, in_idx),
-                                      dr::gather<Float>(data, in_idx + 1),
-                                      dr::gather<Float>(data, in_idx + 2));
+        std::lock_guard<std::mutex> lock(m_accumulator.mutex());
+        const ImageBlock *storage = m_accumulator.storage();
+        ScalarVector2u size = storage->size();
+        uint32_t source_ch   = storage->channel_count(),
+                 weight_ch   = has_flag(m_flags, FilmFlags::Alpha) ? 4 : 3,
+                 pixel_count = dr::prod(size);
+        size_t shape[3] = { (size_t) size.y(), (size_t) size.x(), 1 };
 
-                if (to_y) {
-                    dr::scatter(values, luminance(rgb), out_idx);
-                } else {
-                    Color3f xyz = srgb_to_xyz(rgb);
-                    dr::scatter(values, xyz[0], out_idx);
-                    dr::scatter(values, xyz[1], out_idx + 1);
-                    dr::scatter(values, xyz[2], out_idx + 2);
-                }
-            }
+        if constexpr (dr::is_jit_v<Float>) {
+            const Float &data = storage->tensor().array();
+            UInt32 idx = dr::arange<UInt32>(pixel_count) * source_ch;
 
-            // Perform the weight division unless the weight is zero
-            values /= dr::select(dr::eq(weight, 0.f), 1.f, weight);
+            Color3f rgb(dr::gather<Float>(data, idx),
+                        dr::gather<Float>(data, idx + 1),
+                        dr::gather<Float>(data, idx + 2));
 
-            size_t shape[3] = { (size_t) size.y(), (size_t) size.x(),
-                                target_ch };
+            Float weight = dr::gather<Float>(data, idx + weight_ch),
+                  m2     = dr::gather<Float>(data, idx + source_ch - 1);
 
-            return TensorXf(values, 3, shape);
+            return TensorXf(pixel_variance(rgb, m2, weight), 3, shape);
         } else {
-            ref<Bitmap> source = bitmap();
-            ScalarVector2i size = source->size();
-            size_t width = source->channel_count() * dr::prod(size);
-            auto data = dr::load<DynamicBuffer<ScalarFloat>>(source->data(), width);
+            const ScalarFloat *s = storage->tensor().data();
+            auto data = dr::empty<DynamicBuffer<ScalarFloat>>(pixel_count);
 
-            size_t shape[3] = { (size_t) source->height(),
-                                (size_t) source->width(),
-                                source->channel_count() };
+            for (uint32_t i = 0; i < pixel_count; ++i, s += source_ch)
+                data[i] = pixel_variance(ScalarColor3f(s[0], s[1], s[2]),
+                                         s[source_ch - 1], s[weight_ch]);
 
             return TensorXf(data, 3, shape);
         }
     }
 
     ref<Bitmap> bitmap(bool raw = false) const override {
-        if (!m_storage)
+        check_not_streaming("bitmap");
+        if (!m_accumulator.allocated())
             Throw("No storage allocated, was prepare() called first?");
 
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto &&storage = dr::migrate(m_storage->tensor().array(), AllocType::Host);
+        std::lock_guard<std::mutex> lock(m_accumulator.mutex());
+        return develop_bitmap(m_accumulator.storage(), raw);
+    }
+
+    /// Develop the contents of an image block into a bitmap
+    ref<Bitmap> develop_bitmap(const ImageBlock *storage, bool raw) const {
+        auto &&data = dr::migrate(storage->tensor().array(), AllocType::Host);
 
         if constexpr (dr::is_jit_v<Float>)
             dr::sync_thread();
@@ -424,8 +560,8 @@ public:
                                      : Bitmap::PixelFormat::MultiChannel;
 
         ref<Bitmap> source = new Bitmap(
-            source_fmt, struct_type_v<ScalarFloat>, m_storage->size(),
-            m_storage->channel_count(), m_channels, (uint8_t *) storage.data());
+            source_fmt, struct_type_v<ScalarFloat>, storage->size(),
+            storage->channel_count(), m_channels, (uint8_t *) data.data());
 
         if (raw)
             return source;
@@ -439,12 +575,11 @@ public:
 
         uint32_t img_ch = to_y ? 1 : 3;
         uint32_t aovs_channel = has_aovs ? (img_ch + (uint32_t) alpha) : 0;
-        uint32_t target_ch =
-            (uint32_t) m_storage->channel_count() - base_ch + aovs_channel;
+        uint32_t target_ch = target_channel_count(storage->channel_count());
 
         ref<Bitmap> target = new Bitmap(
             has_aovs ? Bitmap::PixelFormat::MultiChannel : m_pixel_format,
-            struct_type_v<ScalarFloat>, m_storage->size(),
+            struct_type_v<ScalarFloat>, storage->size(),
             has_aovs ? target_ch : 0);
 
         if (has_aovs) {
@@ -519,18 +654,259 @@ public:
                         [[fallthrough]];
 
                     default:
-                        dest_field.name = m_channels[base_ch + i - aovs_channel];
+                        if (m_variance && i + 2 >= target_ch)
+                            dest_field.name = i + 2 == target_ch
+                                                  ? "sample_count"
+                                                  : "variance";
+                        else
+                            dest_field.name = m_channels[base_ch + i - aovs_channel];
                         break;
                 }
             }
         }
 
-        source->convert(target);
+        if constexpr (!dr::is_jit_v<Float>) {
+            develop_pixels(storage, (ScalarFloat *) target->data());
+        } else if (m_variance || m_weight_groups) {
+            /* The variance channels and the normalization of AOV groups
+               cannot be produced by a Bitmap conversion */
+            TensorXf image = develop_jit(storage->tensor().array(),
+                                         storage->size(),
+                                         storage->channel_count());
+            auto &&values = dr::migrate(image.array(), AllocType::Host);
+            dr::sync_thread();
+            memcpy(target->data(), values.data(),
+                   dr::width(values) * sizeof(ScalarFloat));
+        } else {
+            source->convert(target);
+        }
 
         return target;
     }
 
-    void write(const fs::path &path) const override {
+    /// Develop image block data in JIT variants using few kernel launches
+    TensorXf develop_jit(const Float &data, const ScalarVector2u &size,
+                         uint32_t source_ch) const {
+        uint32_t pixel_count = dr::prod(size);
+
+        /* The following code develops weighted image block data into
+           an output image of the desired configuration, while using
+           a minimal number of JIT kernel launches. */
+
+        // Determine what channels are needed
+        bool to_xyz    = m_pixel_format == Bitmap::PixelFormat::XYZ ||
+                         m_pixel_format == Bitmap::PixelFormat::XYZA;
+        bool to_y      = m_pixel_format == Bitmap::PixelFormat::Y ||
+                         m_pixel_format == Bitmap::PixelFormat::YA;
+
+        // Number of arbitrary output variables (AOVs)
+        bool alpha = has_flag(m_flags, FilmFlags::Alpha);
+        uint32_t base_ch = alpha ? 5 : 4,
+                 aovs    = source_ch - base_ch - (uint32_t) m_variance;
+
+        /// Number of desired color components
+        uint32_t color_ch = to_y ? 1 : 3;
+
+        // Number of channels of the target tensor
+        uint32_t target_ch = target_channel_count(source_ch);
+
+        // Index vectors referencing pixels & channels of the output image
+        UInt32 idx         = dr::arange<UInt32>(pixel_count * target_ch),
+               pixel_idx   = idx / target_ch,
+               channel_idx = dr::fmadd(pixel_idx, uint32_t(-(int) target_ch), idx);
+
+        /* Index vectors referencing source pixels/weights as follows:
+             values_idx = R1, G1, B1, R2, G2, B2 (for RGB output)
+             weight_idx = W1, W1, W1, W2, W2, W2 */
+        UInt32 values_idx = dr::fmadd(pixel_idx, source_ch, channel_idx),
+               weight_idx = dr::fmadd(pixel_idx, source_ch, base_ch - 1);
+
+        // If AOVs are desired, their indices in 'values_idx' must be shifted
+        if (aovs) {
+            // Index of first AOV channel in output image
+            uint32_t first_aov = color_ch + (uint32_t) alpha;
+            values_idx[channel_idx >= first_aov] += base_ch - first_aov;
+
+            // AOV groups with their own sample budget use their own weight
+            if (m_weight_groups) {
+                std::vector<uint32_t> weight_ch(target_ch, base_ch - 1);
+                for (uint32_t i = 0; i < aovs; ++i)
+                    weight_ch[first_aov + i] = m_aov_weights[i];
+                UInt32 weight_table = dr::load<UInt32>(weight_ch.data(), target_ch);
+                weight_idx = dr::fmadd(pixel_idx, source_ch,
+                                       dr::gather<UInt32>(weight_table, channel_idx));
+            }
+        }
+
+        // If luminance + alpha, shift alpha channel to skip the GB channels
+        if (alpha && to_y)
+            values_idx[dr::eq(channel_idx, color_ch /* alpha */)] += 2;
+
+        Mask value_mask = true;
+
+        // XYZ/Y mode: don't gather color, will be computed below
+        if (to_xyz || to_y)
+            value_mask = channel_idx >= color_ch;
+
+        // Variance mode: the last two channels are computed below
+        if (m_variance)
+            value_mask &= channel_idx < target_ch - 2;
+
+        // Gather the pixel values from the image data buffer
+        Float weight = dr::gather<Float>(data, weight_idx),
+              values = dr::gather<Float>(data, values_idx, value_mask);
+
+        // Fill color channels with XYZ/Y data if requested
+        if (to_xyz || to_y) {
+            UInt32 in_idx  = dr::arange<UInt32>(pixel_count) * source_ch,
+                   out_idx = dr::arange<UInt32>(pixel_count) * target_ch;
+
+            Color3f rgb = Color3f(dr::gather<Float>(data, in_idx),
+                                  dr::gather<Float>(data, in_idx + 1),
+                                  dr::gather<Float>(data, in_idx + 2));
+
+            if (to_y) {
+                dr::scatter(values, luminance(rgb), out_idx);
+            } else {
+                Color3f xyz = srgb_to_xyz(rgb);
+                dr::scatter(values, xyz[0], out_idx);
+                dr::scatter(values, xyz[1], out_idx + 1);
+                dr::scatter(values, xyz[2], out_idx + 2);
+            }
+        }
+
+        // Perform the weight division unless the weight is zero
+        values /= dr::select(dr::eq(weight, 0.f), 1.f, weight);
+
+        // Append the sample count and variance channels if requested
+        if (m_variance) {
+            UInt32 in_idx  = dr::arange<UInt32>(pixel_count) * source_ch,
+                   out_idx = dr::arange<UInt32>(pixel_count) * target_ch +
+                             (target_ch - 2);
+
+            Color3f rgb = Color3f(dr::gather<Float>(data, in_idx),
+                                  dr::gather<Float>(data, in_idx + 1),
+                                  dr::gather<Float>(data, in_idx + 2));
+
+            Float pixel_weight = dr::gather<Float>(data, in_idx + (base_ch - 1)),
+                  m2 = dr::gather<Float>(data, in_idx + (source_ch - 1));
+
+            dr::scatter(values, pixel_weight, out_idx);
+            dr::scatter(values, pixel_variance(rgb, m2, pixel_weight),
+                        out_idx + 1);
+        }
+
+        size_t shape[3] = { (size_t) size.y(), (size_t) size.x(),
+                            target_ch };
+
+        return TensorXf(values, 3, shape);
+    }
+
+    /**
+     * \brief Estimate the variance of the luminance of a pixel value from
+     * its accumulated color, second moment, and weight
+     *
+     * The accumulated weight serves as the effective sample count.
+     */
+    template <typename Value, typename Color>
+    static Value pixel_variance(const Color &rgb, const Value &m2,
+                                const Value &weight) {
+        Value w    = dr::select(dr::eq(weight, 0.f), 1.f, weight),
+              mean = luminance(rgb) / w,
+              var  = dr::maximum(m2 / w - dr::sqr(mean), 0.f);
+
+        // Bessel's correction and division by the sample count
+        return var / dr::maximum(weight - 1.f, 1.f);
+    }
+
+    /// Number of channels of the developed image
+    uint32_t target_channel_count(uint32_t source_ch) const {
+        bool alpha = has_flag(m_flags, FilmFlags::Alpha);
+        bool to_y  = m_pixel_format == Bitmap::PixelFormat::Y ||
+                     m_pixel_format == Bitmap::PixelFormat::YA;
+        uint32_t aovs = source_ch - (alpha ? 5 : 4) - (uint32_t) m_variance;
+        return (to_y ? 1 : 3) + (uint32_t) alpha + aovs +
+               (m_variance ? 2 : 0);
+    }
+
+    /**
+     * \brief Develop image block data in a single parallel pass (scalar variants)
+     *
+     * Performs the weight division, color conversion, and the reordering of
+     * the alpha and AOV channels of every pixel at once, and writes the
+     * result in the channel order of the developed image.
+     */
+    void develop_pixels(const ImageBlock *storage, ScalarFloat *target) const {
+        const ScalarFloat *source = storage->tensor().data();
+        ScalarVector2u size = storage->size();
+
+        bool to_xyz = m_pixel_format == Bitmap::PixelFormat::XYZ ||
+                      m_pixel_format == Bitmap::PixelFormat::XYZA;
+        bool to_y   = m_pixel_format == Bitmap::PixelFormat::Y ||
+                      m_pixel_format == Bitmap::PixelFormat::YA;
+        bool alpha  = has_flag(m_flags, FilmFlags::Alpha);
+
+        uint32_t source_ch = storage->channel_count(),
+                 base_ch   = alpha ? 5 : 4,
+                 aovs      = source_ch - base_ch - (uint32_t) m_variance,
+                 target_ch = target_channel_count(source_ch);
+
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(0, size.y(), 16),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                for (uint32_t y = range.begin(); y != range.end(); ++y) {
+                    size_t pixel = (size_t) y * size.x();
+                    const ScalarFloat *s = source + pixel * source_ch;
+                    ScalarFloat *t = target + pixel * target_ch;
+
+                    for (uint32_t x = 0; x < size.x(); ++x) {
+                        // Perform the weight division unless the weight is zero
+                        ScalarFloat weight = s[base_ch - 1],
+                                    inv_weight = weight != 0.f ? 1.f / weight : 1.f;
+
+                        ScalarColor3f rgb(s[0], s[1], s[2]);
+                        rgb *= inv_weight;
+
+                        uint32_t k = 0;
+                        if (to_y) {
+                            t[k++] = luminance(rgb);
+                        } else {
+                            if (to_xyz)
+                                rgb = srgb_to_xyz(rgb);
+                            t[k++] = rgb.x();
+                            t[k++] = rgb.y();
+                            t[k++] = rgb.z();
+                        }
+
+                        if (alpha)
+                            t[k++] = s[3] * inv_weight;
+
+                        if (!m_weight_groups) {
+                            for (uint32_t i = 0; i < aovs; ++i)
+                                t[k++] = s[base_ch + i] * inv_weight;
+                        } else {
+                            for (uint32_t i = 0; i < aovs; ++i) {
+                                ScalarFloat w = s[m_aov_weights[i]];
+                                t[k++] = s[base_ch + i] * (w != 0.f ? 1.f / w : 1.f);
+                            }
+                        }
+
+                        if (m_variance) {
+                            t[k++] = weight;
+                            t[k++] = pixel_variance(
+                                ScalarColor3f(s[0], s[1], s[2]),
+                                s[source_ch - 1], weight);
+                        }
+
+                        s += source_ch;
+                        t += target_ch;
+                    }
+                }
+            }
+        );
+    }
+
+    fs::path output_path(const fs::path &path) const override {
         fs::path filename = path;
         std::string proper_extension;
         if (m_file_format == Bitmap::FileFormat::OpenEXR)
@@ -543,6 +919,23 @@ public:
         std::string extension = string::to_lower(filename.extension().string());
         if (extension != proper_extension)
             filename.replace_extension(proper_extension);
+        return filename;
+    }
+
+    void write(const fs::path &path) const override {
+        fs::path filename = output_path(path);
+
+        if (m_stream.enabled()) {
+            m_stream.finish();
+
+            if (fs::absolute(filename) != fs::absolute(m_stream.path()) &&
+                !fs::rename(m_stream.path(), filename))
+                Throw("HDRFilm::write(): could not move \"%s\" to \"%s\"!",
+                      m_stream.path().string(), filename.string());
+
+            Log(Info, "Finished streaming \"%s\".", filename.string());
+            return;
+        }
 
         #if !defined(_WIN32)
             Log(Info, "\U00002714  Developing \"%s\" ..", filename.string());
@@ -550,31 +943,46 @@ public:
             Log(Info, "Developing \"%s\" ..", filename.string());
         #endif
 
-        ref<Bitmap> source = bitmap();
-        if (m_component_format != struct_type_v<ScalarFloat>) {
-            // Mismatch between the current format and the one expected by the film
-            // Conversion is necessary before saving to disk
-            std::vector<std::string> channel_names;
-            for (size_t i = 0; i < source->channel_count(); i++)
-                channel_names.push_back(source->struct_()->operator[](i).name);
-            ref<Bitmap> target = new Bitmap(
-                source->pixel_format(),
-                m_component_format,
-                source->size(),
-                source->channel_count(),
-                channel_names);
-            source->convert(target);
+        ref<Bitmap> source = convert_component_format(bitmap());
 
-            target->write(filename, m_file_format);
-        } else {
-            source->write(filename, m_file_format);
+        if (!m_write_async) {
+            source->write(filename, m_file_format, -1, m_compression);
+            return;
+        }
+
+        /* The developed bitmap is a private copy, hence it can be encoded while
+           rendering continues. Writes are serialized, and a write is skipped if
+           a more recent one to the same film already finished. */
+        std::shared_ptr<AsyncWriteState> state = m_async_write;
+        uint64_t index;
+        {
+            std::lock_guard<std::mutex> guard(state->mutex);
+            index = ++state->issued;
         }
+
+        Bitmap::FileFormat file_format = m_file_format;
+        Bitmap::EXRCompression compression = m_compression;
+        Task *task = dr::do_async([state, index, source, filename,
+                                   file_format, compression]() {
+            std::lock_guard<std::mutex> guard(state->mutex);
+            if (index < state->written)
+                return;
+            source->write(filename, file_format, -1, compression);
+            state->written = index;
+        });
+        Thread::register_task(task);
     }
 
     void schedule_storage() override {
-        dr::schedule(m_storage->tensor());
+        dr::schedule(m_accumulator.storage()->tensor());
     };
 
+    size_t memory_footprint() const override {
+        if (m_stream.enabled())
+            return m_stream.memory_footprint();
+        return m_accumulator.memory_footprint();
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "HDRFilm[" << std::endl
@@ -583,8 +991,13 @@ public:
             << "  crop_offset = " << m_crop_offset << "," << std::endl
             << "  sample_border = " << m_sample_border << "," << std::endl
             << "  compensate = " << m_compensate << "," << std::endl
+            << "  variance = " << m_variance << "," << std::endl
+            << "  accumulation = " << m_accumulator.mode_string() << "," << std::endl
             << "  filter = " << m_filter << "," << std::endl
             << "  file_format = " << m_file_format << "," << std::endl
+            << "  compression = " << m_compression << "," << std::endl
+            << "  write_async = " << m_write_async << "," << std::endl
+            << "  stream_file = \"" << m_stream.path().string() << "\"," << std::endl
             << "  pixel_format = " << m_pixel_format << "," << std::endl
             << "  component_format = " << m_component_format << "," << std::endl
             << "]";
@@ -593,13 +1006,55 @@ public:
 
     MI_DECLARE_CLASS()
 protected:
+    /// Convert a developed bitmap to the component format of the output file
+    ref<Bitmap> convert_component_format(ref<Bitmap> source) const {
+        if (m_component_format == struct_type_v<ScalarFloat>)
+            return source;
+
+        // Mismatch between the current format and the one expected by the film
+        // Conversion is necessary before saving to disk
+        std::vector<std::string> channel_names;
+        for (size_t i = 0; i < source->channel_count(); i++)
+            channel_names.push_back(source->struct_()->operator[](i).name);
+        ref<Bitmap> target = new Bitmap(
+            source->pixel_format(),
+            m_component_format,
+            source->size(),
+            source->channel_count(),
+            channel_names);
+        source->convert(target);
+        return target;
+    }
+
+    void check_not_streaming(const char *name) const {
+        if (m_stream.enabled())
+            Throw("HDRFilm::%s(): the film is streamed to \"%s\" and cannot "
+                  "be developed in memory!", name, m_stream.path().string());
+    }
+
+    /// Ordering of the pending asynchronous writes
+    struct AsyncWriteState {
+        std::mutex mutex;
+        uint64_t issued = 0;
+        uint64_t written = 0;
+    };
+
     Bitmap::FileFormat m_file_format;
+    Bitmap::EXRCompression m_compression;
+    bool m_write_async;
+    std::shared_ptr<AsyncWriteState> m_async_write =
+        std::make_shared<AsyncWriteState>();
     Bitmap::PixelFormat m_pixel_format;
     Struct::Type m_component_format;
     bool m_compensate;
-    ref<ImageBlock> m_storage;
-    mutable std::mutex m_mutex;
+    bool m_variance;
+    FilmAccumulator<Float, Spectrum> m_accumulator;
+    mutable FilmTileStream<Float, Spectrum> m_stream;
     std::vector<std::string> m_channels;
+    /// Source channel holding the weight of every AOV (see \ref prepare())
+    std::vector<uint32_t> m_aov_weights;
+    /// Do some AOVs have their own weight channel?
+    bool m_weight_groups = false;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(HDRFilm, Film)
@@ -11,6 +11,8 @@
 
 #include <mutex>
 
+#include "accumulator.h"
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**!
@@ -21,7 +23,7 @@ Spectral film (:monosp:`specfilm`)
 ----------------------------------
 
 .. pluginparameters::
- :extra-rows: 6
+ :extra-rows: 8
 
  * - width, height
    - |int|
@@ -53,6 +55,20 @@ Spectral film (:monosp:`specfilm`)
      in JIT variants and can make sample accumulation quite a bit more expensive.
      (Default: |false|, i.e. disabled)
 
+ * - accumulation
+   - |string|
+   - Strategy used to merge image blocks rendered by worker threads into the film
+     in scalar variants. The options are :monosp:`shared` (a single lock protects
+     the film), :monosp:`striped` (one lock per band of :monosp:`stripe_height` rows),
+     and :monosp:`thread_local` (each worker accumulates into a private, lazily
+     allocated film-sized buffer, and the buffers are summed up in parallel when
+     the film is developed). The latter is fastest on machines with many cores but
+     needs one additional copy of the film per thread. (Default: :monosp:`shared`)
+
+ * - stripe_height
+   - |int|
+   - Height of the bands of rows used by :monosp:`accumulation=striped`. (Default: 16)
+
  * - (Nested plugin)
    - :paramtype:`rfilter`
    - Reconstruction filter that should be used by the film. (Default: :monosp:`gaussian`, a windowed
@@ -149,7 +165,7 @@ public:
     MI_IMPORT_TYPES(ImageBlock, Texture)
     using FloatStorage = DynamicBuffer<Float>;
 
-    SpecFilm(const Properties &props) : Base(props) {
+    SpecFilm(const Properties &props) : Base(props), m_accumulator(props) {
         if constexpr (!is_spectral_v<Spectrum>)
             Log(Error, "This film can only be used in Mitsuba variants that "
                        "perform a spectral simulation.");
@@ -198,9 +214,19 @@ public:
             callback->put_object(m_names[i], m_srfs[i].get(), +ParamFlags::NonDifferentiable);
     }
 
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        Base::parameters_changed(keys);
+        bool srf_changed = keys.empty();
+        for (const std::string &name : m_names)
+            srf_changed |= string::contains(keys, name);
+        if (srf_changed)
+            compute_srf_sampling();
+    }
+
     void compute_srf_sampling() {
         ScalarFloat resolution = dr::Infinity<ScalarFloat>;
         // Compute full range of wavelengths and resolution in the film
+        m_range = ScalarVector2f(dr::Infinity<ScalarFloat>, -dr::Infinity<ScalarFloat>);
         for (auto srf : m_srfs) {
             m_range.x() = dr::minimum(m_range.x(), srf->wavelength_range().x());
             m_range.y() = dr::maximum(m_range.y(), srf->wavelength_range().y());
@@ -209,36 +235,65 @@ public:
 
         // Compute resolution of the discretized PDF used for sampling
         size_t n_points = (size_t) dr::ceil((m_range.y() - m_range.x()) / resolution + 1);
-        FloatStorage mis_data = dr::zeros<FloatStorage>(n_points);
-        Float mis_wavelengths = dr::linspace<Float>(m_range.x(), m_range.y(), n_points);
-
-        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
-        si.wavelengths = mis_wavelengths;
-
-        for (auto srf : m_srfs) {
-            UnpolarizedSpectrum values = srf->eval(si);
-            // Each wavelength is duplicated with the size of the Spectrum
-            // (default constructor while initialized with only a number)
-            mis_data += values.x();
+        n_points = std::max(n_points, (size_t) 2);
+        size_t n_bands = m_srfs.size(), stride = n_bands + 1;
+
+        /* Evaluate all SRFs on the discretization. The table stores the
+           weights of the bands of a wavelength next to each other, followed
+           by their sum (which is used to normalize them) */
+        std::vector<ScalarFloat> weights(n_points * stride);
+        for (size_t j = 0; j < n_bands; ++j) {
+            SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+            if constexpr (dr::is_jit_v<Float>) {
+                // Each wavelength is duplicated with the size of the Spectrum
+                // (default constructor while initialized with only a number)
+                si.wavelengths = dr::linspace<Float>(m_range.x(), m_range.y(), n_points);
+                FloatStorage values = m_srfs[j]->eval(si).x();
+                auto &&host = dr::migrate(values, AllocType::Host);
+                dr::sync_thread();
+                for (size_t k = 0; k < n_points; ++k)
+                    weights[k * stride + j] = host.data()[k];
+            } else {
+                for (size_t k = 0; k < n_points; ++k) {
+                    si.wavelengths = dr::lerp(m_range.x(), m_range.y(),
+                                              k / (ScalarFloat) (n_points - 1));
+                    weights[k * stride + j] = m_srfs[j]->eval(si).x();
+                }
+            }
         }
 
-        // Conversion needed because Properties::Float is always double
-        using DoubleStorage = dr::float64_array_t<FloatStorage>;
-        DoubleStorage mis_data_dbl = DoubleStorage(mis_data);
+        // The sampling density is proportional to the sum of the SRFs
+        std::vector<double> mis_data(n_points, 0.0);
+        for (size_t k = 0; k < n_points; ++k) {
+            ScalarFloat *row = weights.data() + k * stride;
+            for (size_t j = 0; j < n_bands; ++j)
+                mis_data[k] += (double) row[j];
+            row[n_bands] = (ScalarFloat) mis_data[k];
+        }
 
-        auto && storage = dr::migrate(mis_data_dbl, AllocType::Host);
-        if constexpr (dr::is_jit_v<Float>)
-            dr::sync_thread();
+        m_weights = dr::load<FloatStorage>(weights.data(), weights.size());
+        m_weights_size = (uint32_t) n_points;
+        m_weights_scale = (n_points - 1) / (m_range.y() - m_range.x());
 
         // Create new spectrum with the sampling information
+        // (conversion needed because Properties::Float is always double)
         auto props = Properties("regular");
-        props.set_pointer("values", storage.data());
+        props.set_pointer("values", mis_data.data());
         props.set_long("size", n_points);
         props.set_float("wavelength_min", (double) m_range.x());
         props.set_float("wavelength_max", (double) m_range.y());
         m_srf = PluginManager::instance()->create_object<Texture>(props);
     }
 
+    size_t channel_count(const std::vector<std::string> &aovs) const override {
+        return m_srfs.size() + aovs.size() + 1;
+    }
+
+    size_t storage_footprint(const std::vector<std::string> &aovs) const override {
+        return m_accumulator.allocation_footprint(
+            m_crop_size, (uint32_t) channel_count(aovs));
+    }
+
     size_t prepare(const std::vector<std::string>& channels) override {
         std::vector<std::string> sorted = channels;
 
@@ -246,12 +301,9 @@ public:
             sorted.insert(sorted.begin() + i, m_names[i]);
         sorted.insert(sorted.end(), "W");  // Add weight channel
 
-        /* locked */ {
-            m_channels = sorted;
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_storage = new ImageBlock(m_crop_size, m_crop_offset,
-                                       (uint32_t) m_channels.size());
-        }
+        m_channels = sorted;
+        m_accumulator.allocate(m_crop_size, m_crop_offset,
+                               (uint32_t) m_channels.size());
 
         std::sort(sorted.begin(), sorted.end());
         auto it = std::unique(sorted.begin(), sorted.end());
@@ -280,43 +332,55 @@ public:
                         Float* aovs, Float weight, Float /* alpha */, Mask /* active */) const override {
         aovs[m_channels.size() - 1] = weight;   // Set sample weight
 
-        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
-        si.wavelengths = wavelengths;
-
-        // The SRF is not necessarily normalized, cancel out multiplicative factors
-        UnpolarizedSpectrum inv_spec = m_srf->eval(si);
-        inv_spec = dr::select(dr::neq(inv_spec, 0.f), dr::rcp(inv_spec), 1.f);
-        UnpolarizedSpectrum values = spec * inv_spec;
-
-        for (size_t j = 0; j < m_srfs.size(); ++j) {
-            UnpolarizedSpectrum weights = m_srfs[j]->eval(si);
+        uint32_t n_bands = (uint32_t) m_srfs.size();
+        for (size_t j = 0; j < n_bands; ++j)
             aovs[j] = dr::zeros<Float>();
 
-            for (size_t i = 0; i<Spectrum::Size; ++i)
-                aovs[j] = dr::fmadd(weights[i], values[i], aovs[j]);
+        /* Interpolate the weights of all bands from the table that was
+           computed by compute_srf_sampling() */
+        uint32_t stride = n_bands + 1;
+        for (size_t i = 0; i < Spectrum::Size; ++i) {
+            Float x = (wavelengths[i] - m_range.x()) * m_weights_scale;
+            Mask valid = x >= 0.f && x <= (ScalarFloat) (m_weights_size - 1);
+
+            UInt32 cell = dr::minimum(UInt32(dr::maximum(x, 0.f)), m_weights_size - 2),
+                   index0 = cell * stride,
+                   index1 = index0 + stride;
+            Float t = x - Float(cell);
+
+            // The SRF is not necessarily normalized, cancel out multiplicative factors
+            Float sum = dr::lerp(dr::gather<Float>(m_weights, index0 + n_bands, valid),
+                                 dr::gather<Float>(m_weights, index1 + n_bands, valid), t);
+            Float value = dr::select(valid && dr::neq(sum, 0.f), spec[i] / sum, 0.f);
+            Float value1 = value * t,
+                  value0 = value - value1;
+
+            for (uint32_t j = 0; j < n_bands; ++j) {
+                Float w0 = dr::gather<Float>(m_weights, index0 + j, valid),
+                      w1 = dr::gather<Float>(m_weights, index1 + j, valid);
+                aovs[j] = dr::fmadd(w0, value0, dr::fmadd(w1, value1, aovs[j]));
+            }
+        }
 
+        for (size_t j = 0; j < n_bands; ++j)
             aovs[j] *= 1.f / Spectrum::Size;
-        }
     }
 
     void put_block(const ImageBlock *block) override {
-        Assert(m_storage != nullptr);
-        std::lock_guard<std::mutex> lock(m_mutex);
-        m_storage->put_block(block);
+        m_accumulator.put_block(block);
     }
     
     void clear() override {
-        if (m_storage)
-            m_storage->clear();
+        m_accumulator.clear();
     }
 
     TensorXf develop(bool raw = false) const override {
-        if (!m_storage)
+        if (!m_accumulator.allocated())
             Throw("No storage allocated, was prepare() called first?");
 
         if (raw) {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            return m_storage->tensor();
+            std::lock_guard<std::mutex> lock(m_accumulator.mutex());
+            return m_accumulator.storage()->tensor();
         }
 
         if constexpr (dr::is_jit_v<Float>) {
@@ -326,11 +390,12 @@ public:
             ScalarVector2i size;
 
             /* locked */ {
-                std::lock_guard<std::mutex> lock(m_mutex);
-                data         = m_storage->tensor().array();
-                size         = m_storage->size();
-                source_ch    = (uint32_t) m_storage->channel_count();
-                pixel_count  = dr::prod(m_storage->size());
+                std::lock_guard<std::mutex> lock(m_accumulator.mutex());
+                const ImageBlock *storage = m_accumulator.storage();
+                data         = storage->tensor().array();
+                size         = storage->size();
+                source_ch    = (uint32_t) storage->channel_count();
+                pixel_count  = dr::prod(storage->size());
             }
 
             // Number of channels of the target tensor
@@ -374,30 +439,31 @@ public:
 
 
     ref<Bitmap> bitmap(bool raw = false) const override {
-        if (!m_storage)
+        if (!m_accumulator.allocated())
             Throw("No storage allocated, was prepare() called first?");
 
-        std::lock_guard<std::mutex> lock(m_mutex);
-        auto &&storage = dr::migrate(m_storage->tensor().array(), AllocType::Host);
+        std::lock_guard<std::mutex> lock(m_accumulator.mutex());
+        const ImageBlock *storage = m_accumulator.storage();
+        auto &&data = dr::migrate(storage->tensor().array(), AllocType::Host);
 
         if constexpr (dr::is_jit_v<Float>)
             dr::sync_thread();
 
         ref<Bitmap> source = new Bitmap(
             Bitmap::PixelFormat::MultiChannel,
-            struct_type_v<ScalarFloat>, m_storage->size(),
-            m_storage->channel_count(), m_channels, (uint8_t *) storage.data());
+            struct_type_v<ScalarFloat>, storage->size(),
+            storage->channel_count(), m_channels, (uint8_t *) data.data());
 
         if (raw)
             return source;
 
         ref<Bitmap> target = new Bitmap(
             Bitmap::PixelFormat::MultiChannel,
-            struct_type_v<ScalarFloat>, m_storage->size(),
-            m_storage->channel_count() - 1);
+            struct_type_v<ScalarFloat>, storage->size(),
+            storage->channel_count() - 1);
 
         source->struct_()->operator[](m_channels.size() - 1).flags |= +Struct::Flags::Weight;
-        for (size_t i = 0; i < m_storage->channel_count() - 1; ++i) {
+        for (size_t i = 0; i < storage->channel_count() - 1; ++i) {
             Struct::Field &dest_field = target->struct_()->operator[](i);
             dest_field.name = m_channels[i];
         }
@@ -407,13 +473,18 @@ public:
         return target;
     }
 
-    void write(const fs::path &path) const override {
+    fs::path output_path(const fs::path &path) const override {
         fs::path filename = path;
         std::string proper_extension = ".exr";
 
         std::string extension = string::to_lower(filename.extension().string());
         if (extension != proper_extension)
             filename.replace_extension(proper_extension);
+        return filename;
+    }
+
+    void write(const fs::path &path) const override {
+        fs::path filename = output_path(path);
 
         #if !defined(_WIN32)
             Log(Info, "\U00002714  Developing \"%s\" ..", filename.string());
@@ -443,9 +514,13 @@ public:
     }
 
     void schedule_storage() override {
-        dr::schedule(m_storage->tensor());
+        dr::schedule(m_accumulator.storage()->tensor());
     };
 
+    size_t memory_footprint() const override {
+        return m_accumulator.memory_footprint();
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "SpecFilm[" << std::endl
@@ -454,6 +529,7 @@ public:
             << "  crop_offset = " << m_crop_offset << "," << std::endl
             << "  sample_border = " << m_sample_border << "," << std::endl
             << "  compensate = " << m_compensate << "," << std::endl
+            << "  accumulation = " << m_accumulator.mode_string() << "," << std::endl
             << "  filter = " << m_filter << "," << std::endl
             << "  file_format = " << m_file_format << "," << std::endl
             << "  pixel_format = " << m_pixel_format << "," << std::endl
@@ -472,12 +548,17 @@ protected:
     Bitmap::PixelFormat m_pixel_format;
     Struct::Type m_component_format;
     bool m_compensate;
-    ref<ImageBlock> m_storage;
-    mutable std::mutex m_mutex;
+    FilmAccumulator<Float, Spectrum> m_accumulator;
     std::vector<std::string> m_channels;
     std::vector<ref<Texture>> m_srfs;
     std::vector<std::string> m_names;
     ScalarVector2f m_range { dr::Infinity<ScalarFloat>, -dr::Infinity<ScalarFloat> };
+    /// SRF weights and their sum, indexed by wavelength (outer) and band (inner)
+    FloatStorage m_weights;
+    /// Number of wavelengths of \ref m_weights
+    uint32_t m_weights_size;
+    /// Scale factor mapping wavelengths to positions in \ref m_weights
+    ScalarFloat m_weights_scale;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(SpecFilm, Film)
@@ -237,3 +237,253 @@ def test07_luminance_alpha_mono(variants_all):
     image = mi.TensorXf(film.bitmap())
 
     assert image.shape[2] == 2
+
+
+@pytest.mark.parametrize('accumulation', ['striped', 'thread_local'])
+def test08_accumulation_modes(variant_scalar_rgb, accumulation):
+    import numpy as np
+
+    def render(**kwargs):
+        scene = mi.load_dict({
+            'type': 'scene',
+            'integrator': {'type': 'path', 'block_size': 8},
+            'sensor': {
+                'type': 'perspective',
+                'film': {
+                    'type': 'hdrfilm',
+                    'width': 45,
+                    'height': 37,
+                    'stripe_height': 4,
+                    **kwargs
+                },
+                'sampler': {'type': 'independent', 'sample_count': 4}
+            },
+            'emitter': {'type': 'constant'},
+            'shape': {'type': 'sphere', 'center': [0, 0, 5]}
+        })
+        return np.array(mi.render(scene, seed=3))
+
+    reference = render()
+    image = render(accumulation=accumulation)
+    assert np.allclose(image, reference, atol=1e-5)
+
+    with pytest.raises(RuntimeError):
+        mi.load_dict({'type': 'hdrfilm', 'accumulation': 'invalid'})
+
+
+def test09_write_async(variant_scalar_rgb, tmpdir):
+    import numpy as np
+
+    film = mi.load_dict({
+        'type': 'hdrfilm',
+        'width': 8,
+        'height': 4,
+        'component_format': 'float32',
+        'compression': 'zips',
+        'write_async': True,
+        'filter': {'type': 'box'}
+    })
+    film.prepare([])
+
+    filename = str(tmpdir.join('test_image.exr'))
+    for value in [1.0, 2.0, 3.0]:
+        block = film.create_block()
+        for x in range(8):
+            for y in range(4):
+                block.put([x + 0.5, y + 0.5], [value, value, value, 1.0])
+        film.clear()
+        film.put_block(block)
+        film.write(filename)
+
+    mi.Thread.wait_for_tasks()
+    image = np.array(mi.Bitmap(filename))
+    assert np.allclose(image, 3.0)
+
+    with pytest.raises(RuntimeError):
+        mi.load_dict({'type': 'hdrfilm', 'compression': 'invalid'})
+
+
+@pytest.mark.parametrize('sample_border', [False, True])
+def test10_stream_file(variant_scalar_rgb, tmpdir, sample_border):
+    import numpy as np
+
+    def load(**kwargs):
+        return mi.load_dict({
+            'type': 'scene',
+            'integrator': {'type': 'path', 'block_size': 8},
+            'sensor': {
+                'type': 'perspective',
+                'film': {
+                    'type': 'hdrfilm',
+                    'width': 45,
+                    'height': 37,
+                    'component_format': 'float32',
+                    'sample_border': sample_border,
+                    **kwargs
+                },
+                'sampler': {'type': 'independent', 'sample_count': 4}
+            },
+            'emitter': {'type': 'constant'},
+            'shape': {'type': 'sphere', 'center': [0, 0, 5]}
+        })
+
+    scene_ref = load()
+    reference = np.array(mi.render(scene_ref, seed=3))
+
+    stream_file = str(tmpdir.join('stream.exr'))
+    scene = load(stream_file=stream_file, stream_tile_size=16)
+    film = scene.sensors()[0].film()
+    scene.integrator().render(scene, scene.sensors()[0], seed=3, develop=False)
+
+    # Every tile was complete and released during rendering
+    assert film.memory_footprint() == 0
+    with pytest.raises(RuntimeError, match='streamed'):
+        film.develop()
+
+    filename = str(tmpdir.join('output.exr'))
+    film.write(filename)
+    image = np.array(mi.Bitmap(filename))
+    assert np.allclose(image, reference, atol=1e-5)
+
+    with pytest.raises(RuntimeError):
+        mi.load_dict({'type': 'hdrfilm', 'stream_file': stream_file,
+                      'file_format': 'pfm'})
+
+
+@pytest.mark.parametrize('pixel_format', ['rgb', 'rgba', 'xyz', 'luminance_alpha'])
+def test11_develop_reference(variant_scalar_rgb, pixel_format):
+    # Compare the developed image against a weight division of the raw data
+    import numpy as np
+
+    film = mi.load_dict({
+        'type': 'hdrfilm',
+        'pixel_format': pixel_format,
+        'width': 37,
+        'height': 41,
+        'rfilter': { 'type': 'box' }
+    })
+    film.prepare(['aov.a', 'aov.b'])
+
+    has_alpha = pixel_format.endswith('a') or pixel_format.endswith('alpha')
+    base_ch = 5 if has_alpha else 4
+
+    rng = np.random.default_rng(0)
+    raw = rng.uniform(0, 1, (41, 37, base_ch + 2)).astype(np.float32)
+    raw[::3, ::5, base_ch - 1] = 0
+    film.put_block(mi.ImageBlock(mi.TensorXf(raw), border=False))
+
+    weight = raw[..., base_ch - 1:base_ch]
+    value = raw / np.where(weight == 0, 1, weight)
+
+    rgb = value[..., :3]
+    if pixel_format == 'xyz':
+        M = np.array([[0.412453, 0.357580, 0.180423],
+                      [0.212671, 0.715160, 0.072169],
+                      [0.019334, 0.119193, 0.950227]])
+        color = rgb @ M.T
+    elif pixel_format == 'luminance_alpha':
+        color = rgb @ np.array([[0.212671], [0.715160], [0.072169]])
+    else:
+        color = rgb
+
+    ref = [color]
+    if has_alpha:
+        ref.append(value[..., 3:4])
+    ref.append(value[..., base_ch:])
+    ref = np.concatenate(ref, axis=2)
+
+    image = np.array(film.develop())
+    assert image.shape == ref.shape
+    assert np.allclose(image, ref, atol=1e-5)
+    assert np.allclose(np.array(film.bitmap()), ref, atol=1e-5)
+
+
+def test12_variance(variants_all_rgb):
+    film = mi.load_dict({
+        'type': 'hdrfilm',
+        'width': 4,
+        'height': 3,
+        'variance': True,
+        'rfilter': { 'type': 'box' }
+    })
+    assert mi.has_flag(film.flags(), mi.FilmFlags.Variance)
+    assert film.prepare([]) == 5
+
+    block = film.create_block()
+    assert block.second_moment()
+
+    # Four gray samples per pixel, the last channel is computed by put()
+    offsets = [0.0, 0.5, 1.0, 1.5]
+    for y in range(3):
+        for x in range(4):
+            for o in offsets:
+                v = x + y + o
+                block.put([x + 0.5, y + 0.5], [v, v, v, 1.0, -1.0])
+    film.put_block(block)
+
+    import numpy as np
+    means = np.add.outer(np.arange(3), np.arange(4)) + np.mean(offsets)
+    var = np.var(offsets, ddof=1) / len(offsets)
+
+    image = np.array(film.develop())
+    assert image.shape == (3, 4, 5)
+    assert np.allclose(image[..., 0], means, atol=1e-5)
+    assert np.allclose(image[..., 3], len(offsets))
+    assert np.allclose(image[..., 4], var, atol=1e-4)
+
+    variance = np.array(film.variance())
+    assert variance.shape == (3, 4, 1)
+    assert np.allclose(variance[..., 0], var, atol=1e-4)
+
+    bitmap = film.bitmap()
+    assert [f.name for f in bitmap.struct_()] == \
+        ['R', 'G', 'B', 'sample_count', 'variance']
+    assert np.allclose(np.array(bitmap), image, atol=1e-5)
+
+
+def test13_weight_groups(variants_all_rgb):
+    film = mi.load_dict({
+        'type': 'hdrfilm',
+        'width': 2,
+        'height': 1,
+        'rfilter': { 'type': 'box' }
+    })
+    assert film.prepare(['g.A', 'g.W']) == 6
+
+    # Only one of the two samples of the first pixel contributes to the group
+    block = film.create_block()
+    block.put([0.5, 0.5], [1.0, 1.0, 1.0, 1.0, 4.0, 1.0])
+    block.put([0.5, 0.5], [1.0, 1.0, 1.0, 1.0, 0.0, 0.0])
+    block.put([1.5, 0.5], [2.0, 2.0, 2.0, 1.0, 0.0, 0.0])
+    film.put_block(block)
+
+    import numpy as np
+    image = np.array(film.develop())
+    assert image.shape == (1, 2, 5)
+    assert np.allclose(image[0, :, 0], [1.0, 2.0])
+    assert np.allclose(image[0, :, 3], [4.0, 0.0])
+    assert np.allclose(image[0, :, 4], [0.5, 0.0])
+    assert np.allclose(np.array(film.bitmap()), image)
+
+
+@pytest.mark.parametrize('file_format, extension', [('openexr', '.exr'),
+                                                     ('rgbe', '.rgbe'),
+                                                     ('pfm', '.pfm')])
+def test14_output_path(variant_scalar_rgb, tmpdir, file_format, extension):
+    film = mi.load_dict({
+        'type': 'hdrfilm',
+        'width': 2,
+        'height': 2,
+        'file_format': file_format,
+        'pixel_format': 'rgb'
+    })
+    film.prepare([])
+
+    # The extension is replaced to match the file format
+    path = str(tmpdir.join('scene.xml'))
+    output = film.output_path(path)
+    assert str(output) == str(tmpdir.join('scene' + extension))
+    assert str(film.output_path(output)) == str(output)
+
+    film.write(path)
+    assert tmpdir.join('scene' + extension).exists()
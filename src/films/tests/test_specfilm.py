@@ -178,3 +178,35 @@ def test06_aovs(variants_all_spectral):
             }
         })
         film.prepare(['AOV', 'AOV'])
+
+
+def test07_prepare_sample(variants_all_spectral):
+    film = mi.load_dict({
+        'type': 'specfilm',
+        'width': 3,
+        'height': 2,
+        'band_a': {
+            'type': 'regular',
+            'wavelength_min': 400,
+            'wavelength_max': 700,
+            'values': '1, 1, 1, 1'
+        },
+        'band_b': {
+            'type': 'regular',
+            'wavelength_min': 400,
+            'wavelength_max': 700,
+            'values': '0, 1, 2, 3'
+        }
+    })
+    channels = film.prepare([])
+
+    Wavelength = type(dr.zeros(mi.Ray3f).wavelengths)
+    wavelengths = Wavelength([450, 550, 600, 650])
+    spec = mi.UnpolarizedSpectrum(1.0)
+    aovs = film.prepare_sample(spec, wavelengths, channels, weight=0.5)
+
+    # The weights of the bands are normalized by their sum
+    a = [1 / 1.5, 1 / 2.5, 1 / 3, 1 / 3.5]
+    assert dr.allclose(aovs[0], sum(a) / 4)
+    assert dr.allclose(aovs[1], (4 - sum(a)) / 4)
+    assert dr.allclose(aovs[2], 0.5)
@@ -0,0 +1,331 @@
+#pragma once
+
+#include <mitsuba/core/bitmap.h>
+#include <mitsuba/core/filesystem.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/render/imageblock.h>
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Helper class that streams the tiles of a film to a tiled OpenEXR file
+ *
+ * Films normally accumulate the complete image in memory and write it at the
+ * end. For very large output resolutions, this class instead keeps only the
+ * tiles that are still receiving contributions. Once every image block whose
+ * reconstruction filter support overlaps a tile has been merged, the tile is
+ * developed, written to disk via \ref TiledEXRWriter, and its memory is
+ * released.
+ *
+ * A tile is complete once the blocks merged so far cover every pixel of the
+ * sampled region within one filter radius of the tile. This criterion does
+ * not depend on the block size or order, but it requires each pixel to be
+ * rendered exactly once, i.e. a single-pass render. Films expose this
+ * functionality via the \c stream_file and \c stream_tile_size parameters.
+ * Streaming is only supported in scalar variants.
+ */
+template <typename Float, typename Spectrum>
+class FilmTileStream {
+public:
+    MI_IMPORT_TYPES(ImageBlock)
+
+    /// Develops a tile into a bitmap with the final channel layout
+    using DevelopFunction = std::function<ref<Bitmap>(const ImageBlock *)>;
+
+    FilmTileStream(const Properties &props) {
+        m_path = props.string("stream_file", "");
+        m_tile_size = props.get<uint32_t>("stream_tile_size", 64);
+
+        if (m_tile_size == 0)
+            Throw("The \"stream_tile_size\" parameter must be positive!");
+
+        if (dr::is_jit_v<Float> && enabled())
+            Throw("The \"stream_file\" parameter is only supported in scalar "
+                  "variants!");
+    }
+
+    /// Should the film be streamed to a file?
+    bool enabled() const { return !m_path.empty(); }
+
+    /// Return the path of the output file
+    const fs::path &path() const { return m_path; }
+
+    /**
+     * \brief Create the output file and prepare to receive image blocks
+     *
+     * \param crop_size
+     *     Size of the image in pixels
+     *
+     * \param crop_offset
+     *     Offset of the image within the film (image blocks use film
+     *     coordinates)
+     *
+     * \param sample_border
+     *     Number of pixels outside of the image that are rendered as well
+     *
+     * \param filter_border
+     *     Border size of the reconstruction filter of the image blocks
+     */
+    void open(const ScalarVector2u &crop_size, const ScalarPoint2u &crop_offset,
+              uint32_t sample_border, uint32_t filter_border,
+              uint32_t channel_count, Bitmap::PixelFormat pixel_format,
+              Bitmap::EXRCompression compression, DevelopFunction develop) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_crop_size = crop_size;
+        m_crop_offset = crop_offset;
+        m_sample_border = sample_border;
+        m_filter_border = filter_border;
+        m_channel_count = channel_count;
+        m_pixel_format = pixel_format;
+        m_compression = compression;
+        m_develop = std::move(develop);
+
+        reset();
+    }
+
+    /// Discard all contributions and start a new output file
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_writer && (m_writer->tiles_written() > 0 || !m_tiles.empty()))
+            reset();
+    }
+
+    /// Merge an image block into the open tiles and write completed ones. Thread-safe.
+    void put_block(const ImageBlock *block) {
+        std::vector<std::pair<uint32_t, ref<ImageBlock>>> done;
+
+        /* locked */ {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_writer)
+                Throw("FilmTileStream::put_block(): the output file \"%s\" was "
+                      "already closed!", m_path.string());
+
+            // Core region and filter support of the block (image coordinates)
+            ScalarPoint2i core_0 = ScalarPoint2i(block->offset()) -
+                                   ScalarPoint2i(m_crop_offset),
+                          core_1 = core_0 + ScalarPoint2i(block->size()),
+                          ext_0  = core_0 - (int) block->border_size(),
+                          ext_1  = core_1 + (int) block->border_size();
+
+            // Tiles whose completion criterion involves the core region
+            ScalarPoint2i region_0 = ScalarPoint2i(-(int) m_sample_border),
+                          region_1 = ScalarPoint2i(m_crop_size) + (int) m_sample_border;
+            core_0 = dr::maximum(core_0, region_0);
+            core_1 = dr::minimum(core_1, region_1);
+
+            auto [cov_0, cov_1] = tile_range(core_0 - (int) m_filter_border,
+                                             core_1 + (int) m_filter_border);
+            auto [put_0, put_1] = tile_range(ext_0, ext_1);
+
+            // Check for contributions to tiles that were already written
+            for (int32_t y = put_0.y(); y < put_1.y(); ++y)
+                for (int32_t x = put_0.x(); x < put_1.x(); ++x)
+                    if (m_written[tile_index(x, y)])
+                        Throw("FilmTileStream::put_block(): received an image "
+                              "block for a tile that was already written to "
+                              "\"%s\". Streaming requires single-pass rendering!",
+                              m_path.string());
+
+            for (int32_t y = put_0.y(); y < put_1.y(); ++y) {
+                for (int32_t x = put_0.x(); x < put_1.x(); ++x) {
+                    ref<ImageBlock> &tile = m_tiles[tile_index(x, y)];
+                    if (!tile)
+                        tile = create_tile(x, y);
+                    tile->put_block(block);
+                }
+            }
+
+            for (int32_t y = cov_0.y(); y < cov_1.y(); ++y) {
+                for (int32_t x = cov_0.x(); x < cov_1.x(); ++x) {
+                    auto [support_0, support_1] = support(x, y);
+                    uint32_t index = tile_index(x, y);
+                    m_coverage[index] +=
+                        area(dr::maximum(core_0, support_0),
+                             dr::minimum(core_1, support_1));
+
+                    uint64_t required = area(support_0, support_1);
+                    if (m_coverage[index] > required)
+                        Throw("FilmTileStream::put_block(): pixels were "
+                              "rendered more than once. Streaming to \"%s\" "
+                              "requires single-pass rendering!",
+                              m_path.string());
+
+                    if (m_coverage[index] == required) {
+                        auto it = m_tiles.find(index);
+                        if (it != m_tiles.end()) {
+                            done.emplace_back(index, it->second);
+                            m_tiles.erase(it);
+                        } else {
+                            done.emplace_back(index, create_tile(x, y));
+                        }
+                        m_written[index] = true;
+                    }
+                }
+            }
+        }
+
+        // Develop and write the completed tiles outside of the lock
+        for (auto &[index, tile] : done)
+            write_tile(index, tile.get());
+    }
+
+    /**
+     * \brief Write all remaining tiles and close the output file
+     *
+     * Tiles that are incomplete (e.g. because rendering was interrupted) are
+     * written with the contributions received so far.
+     */
+    void finish() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_writer)
+            return;
+
+        size_t incomplete = 0;
+        ScalarVector2u tiles = m_writer->tile_count();
+        for (uint32_t y = 0; y < tiles.y(); ++y) {
+            for (uint32_t x = 0; x < tiles.x(); ++x) {
+                uint32_t index = tile_index(x, y);
+                if (m_written[index])
+                    continue;
+
+                auto it = m_tiles.find(index);
+                ref<ImageBlock> tile =
+                    it != m_tiles.end() ? it->second : create_tile(x, y);
+                write_tile(index, tile.get());
+                m_written[index] = true;
+                incomplete++;
+            }
+        }
+
+        if (incomplete > 0)
+            Log(Warn, "FilmTileStream: %zu tile%s of \"%s\" did not receive all "
+                      "contributions and were written as-is.", incomplete,
+                      incomplete == 1 ? "" : "s", m_path.string());
+
+        m_tiles.clear();
+        m_writer->close();
+        m_writer = nullptr;
+    }
+
+    /// Return the number of tiles that are currently held in memory
+    size_t open_tiles() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_tiles.size();
+    }
+
+    /// Return the memory footprint of the tiles held in memory
+    size_t memory_footprint() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t result = 0;
+        for (auto &[index, tile] : m_tiles)
+            result += tile->memory_footprint();
+        return result;
+    }
+
+    /// Return the memory footprint of a single tile
+    size_t tile_footprint(uint32_t channel_count) const {
+        return (size_t) m_tile_size * m_tile_size * channel_count *
+               sizeof(ScalarFloat);
+    }
+
+    uint32_t tile_size() const { return m_tile_size; }
+
+protected:
+    /// (Re-)create the output file. The caller must hold the lock.
+    void reset() {
+        if (m_writer)
+            m_writer->close();
+
+        // Develop an empty pixel to determine the channel layout of the file
+        ref<ImageBlock> pixel = new ImageBlock(ScalarVector2u(1),
+                                               ScalarPoint2i(0), m_channel_count);
+        pixel->clear();
+        ref<Bitmap> layout = m_develop(pixel.get());
+
+        m_writer = new TiledEXRWriter(m_path, m_pixel_format, layout->struct_(),
+                                      m_crop_size, m_tile_size, m_compression);
+
+        ScalarVector2u tiles = m_writer->tile_count();
+        m_tiles.clear();
+        m_coverage.assign(dr::prod(tiles), 0);
+        m_written.assign(dr::prod(tiles), false);
+    }
+
+    uint32_t tile_index(int32_t x, int32_t y) const {
+        return (uint32_t) y * m_writer->tile_count().x() + (uint32_t) x;
+    }
+
+    /// Return the half-open range of tiles overlapping a pixel region
+    std::pair<ScalarPoint2i, ScalarPoint2i>
+    tile_range(const ScalarPoint2i &p0, const ScalarPoint2i &p1) const {
+        ScalarPoint2i tiles = ScalarPoint2i(m_writer->tile_count()),
+                      t0 = dr::maximum(p0, 0) / (int) m_tile_size,
+                      t1 = (dr::minimum(p1, ScalarPoint2i(m_crop_size)) +
+                            ((int) m_tile_size - 1)) / (int) m_tile_size;
+
+        t1 = dr::minimum(t1, tiles);
+        if (dr::any(t0 >= t1))
+            t1 = t0;
+
+        return { t0, t1 };
+    }
+
+    /// Return the sampled pixels that can contribute to a tile
+    std::pair<ScalarPoint2i, ScalarPoint2i> support(int32_t x, int32_t y) const {
+        ScalarPoint2i t0 = ScalarPoint2i(x, y) * (int) m_tile_size,
+                      t1 = dr::minimum(t0 + (int) m_tile_size,
+                                       ScalarPoint2i(m_crop_size));
+
+        return { dr::maximum(t0 - (int) m_filter_border,
+                             ScalarPoint2i(-(int) m_sample_border)),
+                 dr::minimum(t1 + (int) m_filter_border,
+                             ScalarPoint2i(m_crop_size) + (int) m_sample_border) };
+    }
+
+    static uint64_t area(const ScalarPoint2i &p0, const ScalarPoint2i &p1) {
+        if (dr::any(p1 <= p0))
+            return 0;
+        return (uint64_t) (p1.x() - p0.x()) * (uint64_t) (p1.y() - p0.y());
+    }
+
+    ref<ImageBlock> create_tile(int32_t x, int32_t y) const {
+        ScalarPoint2u t0 = ScalarPoint2u(x, y) * m_tile_size;
+        ScalarVector2u size = dr::minimum(m_crop_size - t0, m_tile_size);
+
+        ref<ImageBlock> tile = new ImageBlock(
+            size, ScalarPoint2i(m_crop_offset + t0), m_channel_count);
+        tile->clear();
+        return tile;
+    }
+
+    void write_tile(uint32_t index, const ImageBlock *tile) {
+        uint32_t tiles_x = m_writer->tile_count().x();
+        ScalarPoint2u t(index % tiles_x, index / tiles_x);
+        m_writer->write_tile(t, m_develop(tile).get());
+    }
+
+protected:
+    fs::path m_path;
+    uint32_t m_tile_size;
+    ScalarVector2u m_crop_size;
+    ScalarPoint2u m_crop_offset;
+    uint32_t m_sample_border = 0;
+    uint32_t m_filter_border = 0;
+    uint32_t m_channel_count = 0;
+    Bitmap::PixelFormat m_pixel_format;
+    Bitmap::EXRCompression m_compression;
+    DevelopFunction m_develop;
+    ref<TiledEXRWriter> m_writer;
+    std::unordered_map<uint32_t, ref<ImageBlock>> m_tiles;
+    std::vector<uint64_t> m_coverage;
+    std::vector<bool> m_written;
+    mutable std::mutex m_mutex;
+};
+
+NAMESPACE_END(mitsuba)
@@ -18,6 +18,14 @@ Arbitrary Output Variables integrator (:monosp:`aov`)
    - |string|
    - List of :monosp:`<name>:<type>` pairs denoting the enabled AOVs.
 
+ * - aov_spp
+   - |int|
+   - Number of samples per pixel that evaluate the AOVs given by :paramtype:`aovs`.
+     When it is smaller than the sample count of the sampler, only the first
+     :paramtype:`aov_spp` samples of every pixel trace the AOV ray. Every AOV
+     then also outputs a weight channel :monosp:`<name>.W`, see below. The
+     nested integrators still use every sample. (Default: 0, i.e. all samples)
+
  * - (Nested plugin)
    - :paramtype:`integrator`
    - Sub-integrators (can have more than one) which will be sampled along the AOV integrator. Their
@@ -81,6 +89,18 @@ wide pixel reconstruction filter as it will result in fractional values.
 The :monosp:`albedo` AOV will evaluate the diffuse reflectance
 (\ref BSDF::eval_diffuse_reflectance) of the material. Note that depending on
 the material, this value might only be an approximation.
+
+All AOVs are computed from a single ray intersection, which only computes the
+fields of the surface interaction that the requested AOVs need (and is skipped
+entirely when only nested integrators are given). Their values are written
+along with the outputs of the nested integrators in one image block update.
+With :paramtype:`aov_spp`, expensive AOV setups (e.g. for compositing or
+denoiser guides) can be evaluated at a lower sample rate than the nested
+integrators. The :monosp:`<name>.W` channel of each AOV accumulates the
+weights of the samples that evaluated it, which the :ref:`hdrfilm
+<film-hdrfilm>` film uses to normalize the AOV exactly. The AOV values are
+additionally scaled by the ratio of the sample counts, so that films without
+this feature still produce approximately correct averages.
  */
 
 template <typename Float, typename Spectrum>
@@ -108,6 +128,7 @@ public:
 
     AOVIntegrator(const Properties &props) : Base(props) {
         std::vector<std::string> tokens = string::tokenize(props.string("aovs"));
+        m_aov_spp = props.get<uint32_t>("aov_spp", 0);
 
         for (const std::string &token: tokens) {
             std::vector<std::string> item = string::tokenize(token, ":");
@@ -172,6 +193,10 @@ public:
             } else {
                 Throw("Invalid AOV type \"%s\"!", item[1]);
             }
+
+            // Weight of the samples that evaluated the AOV
+            if (m_aov_spp > 0)
+                m_aov_names.push_back(item[0] + ".W");
         }
 
         for (auto &kv : props.objects()) {
@@ -191,6 +216,36 @@ public:
 
         if (m_aov_names.empty())
             Log(Warn, "No AOVs were specified!");
+
+        // Compute only the surface interaction fields that the AOVs read
+        m_ray_flags = +RayFlags::Empty;
+        for (Type type : m_aov_types) {
+            switch (type) {
+                case Type::Albedo:
+                case Type::dUVdx:
+                case Type::dUVdy:
+                    m_ray_flags |= +RayFlags::All;
+                    break;
+                case Type::UV:
+                    m_ray_flags |= RayFlags::Minimal | RayFlags::UV;
+                    break;
+                case Type::ShadingNormal:
+                    m_ray_flags |= RayFlags::Minimal | RayFlags::ShadingFrame;
+                    break;
+                case Type::BoundaryTest:
+                    m_ray_flags |= RayFlags::Minimal | RayFlags::BoundaryTest;
+                    break;
+                case Type::dPdU:
+                case Type::dPdV:
+                    m_ray_flags |= RayFlags::Minimal | RayFlags::UV | RayFlags::dPdUV;
+                    break;
+                case Type::IntegratorRGBA:
+                    break;
+                default:
+                    m_ray_flags |= +RayFlags::Minimal;
+                    break;
+            }
+        }
     }
 
     std::pair<Spectrum, Mask> sample(const Scene *scene,
@@ -203,9 +258,24 @@ public:
 
         std::pair<Spectrum, Mask> result { 0.f, false };
 
-        SurfaceInteraction3f si = scene->ray_intersect(
-            ray, RayFlags::All | RayFlags::BoundaryTest, true, active);
-        dr::masked(si, !si.is_valid()) = dr::zeros<SurfaceInteraction3f>();
+        /* Only the first 'aov_spp' samples of every pixel evaluate the AOVs,
+           their values are scaled to preserve the pixel averages */
+        Mask aov_active = active;
+        Float aov_scale = 1.f;
+        uint32_t spp = sampler->sample_count();
+        if (m_aov_spp > 0 && m_aov_spp < spp) {
+            aov_active &= sampler->current_sample_index() < m_aov_spp;
+            aov_scale = dr::select(aov_active, (ScalarFloat) spp / m_aov_spp, 0.f);
+        }
+
+        // A single intersection provides the data of all AOVs
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+        Mask valid = false;
+        if (m_ray_flags != +RayFlags::Empty && dr::any_or<true>(aov_active)) {
+            si = scene->ray_intersect(ray, m_ray_flags, true, aov_active);
+            valid = aov_active && si.is_valid();
+            dr::masked(si, !valid) = dr::zeros<SurfaceInteraction3f>();
+        }
         size_t ctr = 0;
 
         auto spectrum_to_color3f = [](const Spectrum& spec, const Ray3f& ray, Mask active) {
@@ -224,85 +294,87 @@ public:
             }
         };
 
+        // The albedo is evaluated once, even if it is requested repeatedly
+        Color3f albedo(0.f);
+        bool albedo_done = false;
+
+        auto put = [&](const Float &value) { *aovs++ = value * aov_scale; };
+
         for (size_t i = 0; i < m_aov_types.size(); ++i) {
             switch (m_aov_types[i]) {
                 case Type::Albedo: {
-                        Color3f rgb(0.f);
-                        if (dr::any_or<true>(si.is_valid()))
-                        {
-                            Mask valid = active && si.is_valid();
-                            BSDFPtr m_bsdf = si.bsdf(ray);
-
-                            Spectrum spec =
-                                m_bsdf->eval_diffuse_reflectance(si, valid);
-                            dr::masked(rgb, valid) =
+                        if (!albedo_done && dr::any_or<true>(valid)) {
+                            BSDFPtr bsdf = si.bsdf(ray);
+                            Spectrum spec = bsdf->eval_diffuse_reflectance(si, valid);
+                            dr::masked(albedo, valid) =
                                 spectrum_to_color3f(spec, ray, valid);
                         }
+                        albedo_done = true;
 
-                        *aovs++ = rgb.r();
-                        *aovs++ = rgb.g();
-                        *aovs++ = rgb.b();
+                        put(albedo.r());
+                        put(albedo.g());
+                        put(albedo.b());
                     }
                     break;
                 case Type::Depth:
-                    *aovs++ = dr::select(si.is_valid(), si.t, 0.f);
+                    put(dr::select(valid, si.t, 0.f));
                     break;
 
                 case Type::Position:
-                    *aovs++ = si.p.x();
-                    *aovs++ = si.p.y();
-                    *aovs++ = si.p.z();
+                    put(si.p.x());
+                    put(si.p.y());
+                    put(si.p.z());
                     break;
 
                 case Type::UV:
-                    *aovs++ = si.uv.x();
-                    *aovs++ = si.uv.y();
+                    put(si.uv.x());
+                    put(si.uv.y());
                     break;
 
                 case Type::GeometricNormal:
-                    *aovs++ = si.n.x();
-                    *aovs++ = si.n.y();
-                    *aovs++ = si.n.z();
+                    put(si.n.x());
+                    put(si.n.y());
+                    put(si.n.z());
                     break;
 
                 case Type::ShadingNormal:
-                    *aovs++ = si.sh_frame.n.x();
-                    *aovs++ = si.sh_frame.n.y();
-                    *aovs++ = si.sh_frame.n.z();
+                    put(si.sh_frame.n.x());
+                    put(si.sh_frame.n.y());
+                    put(si.sh_frame.n.z());
                     break;
 
                 case Type::BoundaryTest:
-                    *aovs++ = dr::select(si.is_valid(), si.boundary_test, 1.f);
+                    put(dr::select(valid, si.boundary_test, 1.f));
                     break;
 
                 case Type::dPdU:
-                    *aovs++ = si.dp_du.x();
-                    *aovs++ = si.dp_du.y();
-                    *aovs++ = si.dp_du.z();
+                    put(si.dp_du.x());
+                    put(si.dp_du.y());
+                    put(si.dp_du.z());
                     break;
 
                 case Type::dPdV:
-                    *aovs++ = si.dp_dv.x();
-                    *aovs++ = si.dp_dv.y();
-                    *aovs++ = si.dp_dv.z();
+                    put(si.dp_dv.x());
+                    put(si.dp_dv.y());
+                    put(si.dp_dv.z());
                     break;
 
                 case Type::dUVdx:
-                    *aovs++ = si.duv_dx.x();
-                    *aovs++ = si.duv_dx.y();
+                    put(si.duv_dx.x());
+                    put(si.duv_dx.y());
                     break;
 
                 case Type::dUVdy:
-                    *aovs++ = si.duv_dy.x();
-                    *aovs++ = si.duv_dy.y();
+                    put(si.duv_dy.x());
+                    put(si.duv_dy.y());
                     break;
 
                 case Type::PrimIndex:
-                    *aovs++ = Float(si.prim_index);
+                    put(Float(si.prim_index));
                     break;
 
                 case Type::ShapeIndex:
-                    *aovs++ = Float(dr::reinterpret_array<UInt32>(si.shape));
+                    put(Float(dr::reinterpret_array<UInt32>(si.shape)));
                     break;
 
                 case Type::IntegratorRGBA: {
@@ -322,6 +394,9 @@ public:
                     }
                     break;
             }
+
+            if (m_aov_spp > 0 && m_aov_types[i] != Type::IntegratorRGBA)
+                put(Float(1.f));
         }
 
         return result;
@@ -342,6 +417,7 @@ public:
         std::ostringstream oss;
         oss << "Scene[" << std::endl
             << "  aovs = " << m_aov_names << "," << std::endl
+            << "  aov_spp = " << m_aov_spp << "," << std::endl
             << "  integrators = [" << std::endl;
         for (size_t i = 0; i < m_integrators.size(); ++i) {
             oss << "    " << string::indent(m_integrators[i].first, 4);
@@ -359,6 +435,10 @@ private:
     std::vector<Type> m_aov_types;
     std::vector<std::string> m_aov_names;
     std::vector<std::pair<ref<Base>, size_t>> m_integrators;
+    /// Number of samples per pixel that evaluate the AOVs (0: all)
+    uint32_t m_aov_spp;
+    /// Surface interaction fields needed by the AOVs
+    uint32_t m_ray_flags;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(AOVIntegrator, SamplingIntegrator)
@@ -0,0 +1,577 @@
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/render/shape.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-bdpt:
+
+Bidirectional path tracer (:monosp:`bdpt`)
+------------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image. A value of 1 will only
+     render directly visible light sources. 2 will lead to single-bounce (direct-only)
+     illumination, and so on. The light subpath is stored, hence the depth must be finite.
+     (Default: 8)
+
+ * - rr_depth
+   - |int|
+   - Specifies the minimum path depth, after which the implementation will start to use the
+     *russian roulette* path termination criterion. (Default: 5)
+
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+
+ * - samples_per_pass
+   - |int|
+   - If specified, divides the workload in successive passes with :paramtype:`samples_per_pass`
+     samples per pixel.
+
+This integrator implements bidirectional path tracing: every sample traces a light subpath
+starting on an area emitter, connects each of its vertices to the sensor (splatting the result
+like the :ref:`ptracer <integrator-ptracer>` integrator), and then traces a camera subpath that
+is connected to the emitters (emitter sampling) and to every vertex of the light subpath. All
+strategies are combined with the power heuristic. The multiple importance sampling weights are
+computed incrementally along both subpaths following "Implementing Vertex Connection and
+Merging" by Georgiev, which only requires a constant amount of work per connection.
+
+In JIT variants, the connections of all samples are evaluated together, so that every
+visibility test is traced as one wavefront.
+
+Light subpaths start on emitters that are attached to shapes (:ref:`area <emitter-area>`),
+whose positions are sampled uniformly by area. Other emitters (e.g. point lights or environment
+maps) are only reached through the camera subpath, i.e. by emitter sampling and by hitting them.
+The weights assume a pinhole camera (e.g. :ref:`perspective <sensor-perspective>`).
+
+.. note:: This integrator does not handle participating media, and it only supports
+    RGB and monochrome variants without polarization.
+
+.. tabs::
+    .. code-tab::  xml
+
+        <integrator type="bdpt">
+            <integer name="max_depth" value="8"/>
+        </integrator>
+
+    .. code-tab:: python
+
+        'type': 'bdpt',
+        'max_depth': 8
+
+ */
+
+template <typename Float, typename Spectrum>
+class BidirectionalPathTracer final : public AdjointIntegrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(AdjointIntegrator, m_hide_emitters, m_rr_depth, m_max_depth)
+    MI_IMPORT_TYPES(Scene, Sensor, Film, Sampler, ImageBlock, Emitter,
+                    EmitterPtr, BSDF, BSDFPtr, ShapePtr)
+
+    /// Vertex of a light subpath along with the partial MIS quantities
+    struct LightVertex {
+        SurfaceInteraction3f si;
+        Spectrum throughput;
+        Float d_vcm, d_vc;
+        Mask valid;
+    };
+
+    BidirectionalPathTracer(const Properties &props) : Base(props) {
+        if constexpr (is_spectral_v<Spectrum> || is_polarized_v<Spectrum>)
+            Throw("The bidirectional path tracer only supports RGB and "
+                  "monochrome variants without polarization!");
+
+        if (!props.has_property("max_depth"))
+            m_max_depth = 8;
+        if (m_max_depth < 0)
+            Throw("The bidirectional path tracer requires a finite 'max_depth'!");
+    }
+
+    using Base::render;
+
+    TensorXf render(Scene *scene, Sensor *sensor, uint32_t seed = 0,
+                    uint32_t spp = 0, bool develop = true,
+                    bool evaluate = true) override {
+        // Gather the emitters from which light subpaths can start
+        std::vector<uint32_t> indices;
+        const auto &emitters = scene->emitters();
+        for (size_t i = 0; i < emitters.size(); ++i) {
+            if (has_flag(emitters[i]->flags(), EmitterFlags::Surface) &&
+                emitters[i]->shape())
+                indices.push_back((uint32_t) i);
+        }
+        m_light_count = (uint32_t) indices.size();
+        m_light_indices =
+            dr::load<DynamicBuffer<UInt32>>(indices.data(), indices.size());
+
+        return Base::render(scene, sensor, seed, spp, develop, evaluate);
+    }
+
+    void sample(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                ImageBlock *block, ScalarFloat sample_scale) const override {
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0)
+            time += sampler->next_1d() * sensor->shutter_open_time();
+
+        std::vector<LightVertex> light_path = trace_light_path(
+            scene, sensor, sampler, time, block, sample_scale);
+
+        trace_camera_path(scene, sensor, sampler, time, light_path, block,
+                          sample_scale);
+    }
+
+    std::string to_string() const override {
+        return tfm::format("BidirectionalPathTracer[\n"
+                           "  max_depth = %i,\n"
+                           "  rr_depth = %i\n"
+                           "]",
+                           m_max_depth, m_rr_depth);
+    }
+
+    MI_DECLARE_CLASS()
+
+protected:
+    /// Power heuristic
+    static Float mis(const Float &value) { return dr::sqr(value); }
+
+    /**
+     * \brief Trace a light subpath, connect its vertices to the sensor, and
+     * return the vertices that can be connected to camera subpaths
+     */
+    std::vector<LightVertex> trace_light_path(const Scene *scene,
+                                              const Sensor *sensor,
+                                              Sampler *sampler, Float time,
+                                              ImageBlock *block,
+                                              ScalarFloat sample_scale) const {
+        std::vector<LightVertex> vertices;
+        if (m_light_count == 0 || m_max_depth < 2)
+            return vertices;
+
+        // Choose an area emitter uniformly and sample a position on its shape
+        UInt32 index = dr::minimum(UInt32(sampler->next_1d() * (ScalarFloat) m_light_count),
+                                   m_light_count - 1);
+        EmitterPtr emitter = dr::gather<EmitterPtr>(
+            scene->emitters_dr(), dr::gather<UInt32>(m_light_indices, index));
+        ShapePtr shape = emitter->shape();
+
+        PositionSample3f ps = shape->sample_position(time, sampler->next_2d());
+        Vector3f local = warp::square_to_cosine_hemisphere(sampler->next_2d());
+
+        SurfaceInteraction3f si_emitter(ps, dr::zeros<Wavelength>());
+        si_emitter.wi = local;
+        si_emitter.shape = shape;
+
+        Mask active = ps.pdf > 0.f;
+        Float pdf_emit = ps.pdf * local.z() * dr::InvPi<Float> / (ScalarFloat) m_light_count;
+        Spectrum throughput = dr::select(
+            active, emitter->eval(si_emitter, active) * local.z() / pdf_emit, 0.f);
+
+        Float d_vcm = 0.f,
+              d_vc  = dr::select(active, mis(local.z() / pdf_emit), 0.f),
+              eta   = 1.f;
+
+        Ray3f ray = si_emitter.spawn_ray(si_emitter.to_world(local));
+        BSDFContext ctx(TransportMode::Importance);
+
+        for (int depth = 1; depth < m_max_depth; ++depth) {
+            SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+            active &= si.is_valid();
+            if (dr::none_or<false>(active))
+                break;
+
+            // Account for the segment that led to this vertex
+            Float cos_in = dr::abs(Frame3f::cos_theta(si.wi));
+            if (depth == 1) {
+                /* The density of emitter sampling depends on this vertex, so
+                   the first MIS quantity is only computed now */
+                DirectionSample3f ds(scene, si_emitter, si);
+                Float pdf_direct = scene->pdf_emitter_direction(si, ds, active);
+                d_vcm = mis(pdf_direct * local.z() / (pdf_emit * cos_in));
+            } else {
+                d_vcm *= mis(dr::sqr(si.t)) / mis(cos_in);
+            }
+            d_vc /= mis(cos_in);
+
+            BSDFPtr bsdf = si.bsdf(ray);
+            Mask connectible = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+            // Connect to the sensor (camera subpaths with a single vertex)
+            if (dr::any_or<true>(connectible))
+                connect_sensor(scene, sensor, sampler, si, bsdf, throughput,
+                               d_vcm, d_vc, block, sample_scale, connectible);
+
+            // Connections to camera subpaths need at least one more segment
+            if (depth + 2 > m_max_depth)
+                break;
+
+            vertices.push_back({ si, throughput, d_vcm, d_vc, connectible });
+
+            // ----------------------- BSDF sampling ------------------------
+
+            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                               sampler->next_2d(active), active);
+
+            Float correction = adjoint_correction(si, bs.wo);
+            active &= correction > 0.f;
+
+            update_mis(ctx, si, bsdf, bs, d_vcm, d_vc, active);
+
+            throughput *= bsdf_val * correction;
+            eta *= bs.eta;
+            active &= dr::any(dr::neq(unpolarized_spectrum(throughput), 0.f));
+
+            ray = si.spawn_ray(si.to_world(bs.wo));
+
+            // Russian roulette
+            if (depth >= m_rr_depth) {
+                Float q = dr::minimum(
+                    dr::max(unpolarized_spectrum(throughput)) * dr::sqr(eta), 0.95f);
+                active &= sampler->next_1d(active) < q;
+                throughput *= dr::rcp(q);
+            }
+        }
+
+        return vertices;
+    }
+
+    /**
+     * \brief Trace a camera subpath and evaluate all strategies that end with
+     * it, accumulating the result at the sampled image position
+     */
+    void trace_camera_path(const Scene *scene, const Sensor *sensor,
+                           Sampler *sampler, Float time,
+                           const std::vector<LightVertex> &light_path,
+                           ImageBlock *block, ScalarFloat sample_scale) const {
+        if (m_max_depth == 0)
+            return;
+
+        // Sample a position on the crop window of the film
+        Float wavelength_sample = sampler->next_1d();
+        Point2f position_sample = sampler->next_2d(),
+                aperture_sample = sampler->next_2d();
+
+        auto [ray, throughput] = sensor->sample_ray(
+            time, wavelength_sample, position_sample, aperture_sample);
+
+        /* Solid angle density of the camera direction, expressed through the
+           importance of a point at unit distance along the ray */
+        Interaction3f it = dr::zeros<Interaction3f>();
+        it.p = ray(1.f);
+        it.time = time;
+        auto [sensor_ds, sensor_weight] = sensor->sample_direction(it, aperture_sample);
+        Float pdf_camera = dr::mean(unpolarized_spectrum(sensor_weight)) *
+                           dr::sqr(sensor_ds.dist) * crop_scale(sensor);
+
+        Mask active = pdf_camera > 0.f;
+        Float d_vcm = dr::select(active, mis(dr::rcp(pdf_camera)), 0.f),
+              d_vc  = 0.f,
+              eta   = 1.f;
+
+        Spectrum result = 0.f;
+        Mask valid_ray = false;
+        SurfaceInteraction3f prev_si = dr::zeros<SurfaceInteraction3f>();
+        BSDFContext ctx;
+
+        for (int depth = 1; depth <= m_max_depth; ++depth) {
+            SurfaceInteraction3f si =
+                scene->ray_intersect(ray, +RayFlags::All, depth == 1, active);
+            if (depth == 1)
+                valid_ray = active && si.is_valid();
+
+            Float cos_in = dr::abs(Frame3f::cos_theta(si.wi)),
+                  d_vcm_hit = d_vcm * mis(dr::sqr(si.t)) / mis(cos_in),
+                  d_vc_hit  = d_vc / mis(cos_in);
+
+            // ------------------ Emitter hit (no light vertex) ------------------
+
+            EmitterPtr emitter = si.emitter(scene, active);
+            Mask active_e = active && dr::neq(emitter, nullptr);
+            if (depth == 1 && m_hide_emitters)
+                active_e = false;
+
+            if (dr::any_or<true>(active_e)) {
+                Float weight = 1.f;
+                if (depth > 1) {
+                    DirectionSample3f ds(scene, si, prev_si);
+                    Float pdf_direct =
+                        scene->pdf_emitter_direction(prev_si, ds, active_e);
+
+                    Mask on_surface = si.is_valid();
+                    Float pdf_emit = emission_pdf(emitter, PositionSample3f(si), cos_in,
+                                                  active_e && on_surface);
+                    Float w_surface = mis(pdf_direct * cos_in / dr::sqr(si.t)) * d_vcm_hit +
+                                      mis(pdf_emit) * d_vc_hit,
+                          w_camera = dr::select(on_surface, w_surface,
+                                                mis(pdf_direct) * d_vcm);
+                    weight = dr::rcp(1.f + w_camera);
+                }
+
+                result += dr::select(active_e, throughput * emitter->eval(si, active_e) * weight, 0.f);
+            }
+
+            active &= si.is_valid();
+            d_vcm = d_vcm_hit;
+            d_vc = d_vc_hit;
+
+            if (depth >= m_max_depth || dr::none_or<false>(active))
+                break;
+
+            BSDFPtr bsdf = si.bsdf(ray);
+            Mask connectible = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+            // --------------------------- Connections ---------------------------
+
+            if (dr::any_or<true>(connectible)) {
+                result += throughput *
+                    connect_emitter(scene, sampler, si, bsdf, d_vcm, d_vc, connectible);
+
+                for (size_t i = 0; i < light_path.size(); ++i) {
+                    // The light vertex 'i' ends a subpath with i + 1 segments
+                    if (depth + (int) i + 2 > m_max_depth)
+                        break;
+                    result += throughput *
+                        connect_vertices(scene, si, bsdf, d_vcm, d_vc,
+                                         light_path[i], connectible);
+                }
+            }
+
+            // -------------------------- BSDF sampling --------------------------
+
+            auto [bs, bsdf_weight] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                                  sampler->next_2d(active), active);
+
+            update_mis(ctx, si, bsdf, bs, d_vcm, d_vc, active);
+
+            throughput *= bsdf_weight;
+            eta *= bs.eta;
+            active &= dr::any(dr::neq(unpolarized_spectrum(throughput), 0.f));
+
+            prev_si = si;
+            ray = si.spawn_ray(si.to_world(bs.wo));
+
+            // Russian roulette
+            if (depth >= m_rr_depth) {
+                Float q = dr::minimum(
+                    dr::max(unpolarized_spectrum(throughput)) * dr::sqr(eta), 0.95f);
+                active &= sampler->next_1d(active) < q;
+                throughput *= dr::rcp(q);
+            }
+        }
+
+        Vector2f position = position_sample * ScalarVector2f(sensor->film()->crop_size()) +
+                            block->offset();
+        block->put(position, ray.wavelengths, result * sample_scale,
+                   dr::select(valid_ray, Float(1.f), Float(0.f)),
+                   /* weight = */ 0.f, true);
+    }
+
+    /**
+     * \brief Ratio of the film size to the size of its crop window
+     *
+     * Camera subpaths only cover the crop window, which increases their
+     * density relative to the importance of the sensor.
+     */
+    static ScalarFloat crop_scale(const Sensor *sensor) {
+        const Film *film = sensor->film();
+        return dr::prod(ScalarVector2f(film->size())) /
+               dr::prod(ScalarVector2f(film->crop_size()));
+    }
+
+    /// Update the partial MIS quantities after sampling the BSDF at \c si
+    void update_mis(const BSDFContext &ctx, const SurfaceInteraction3f &si,
+                    const BSDFPtr &bsdf, const BSDFSample3f &bs, Float &d_vcm,
+                    Float &d_vc, Mask active) const {
+        Mask delta = has_flag(bs.sampled_type, BSDFFlags::Delta);
+        Float cos_out = dr::abs(Frame3f::cos_theta(bs.wo));
+
+        // Density of sampling the reverse direction
+        SurfaceInteraction3f si_rev(si);
+        si_rev.wi = bs.wo;
+        Float pdf_rev = bsdf->pdf(ctx, si_rev, si.wi, active && !delta);
+
+        /* Delta components are sampled with a discrete probability that is
+           the same in both directions, and they can't be connected */
+        Float inv_pdf = dr::select(bs.pdf > 0.f, dr::rcp(bs.pdf), 0.f);
+        d_vc = dr::select(delta, d_vc * mis(cos_out),
+                          mis(cos_out * inv_pdf) * (d_vc * mis(pdf_rev) + d_vcm));
+        d_vcm = dr::select(delta, 0.f, mis(inv_pdf));
+    }
+
+    /**
+     * \brief Density of starting a light subpath at the given emitter
+     * position towards a direction with cosine \c cos_theta
+     */
+    Float emission_pdf(const EmitterPtr &emitter, const PositionSample3f &ps,
+                       Float cos_theta, Mask active) const {
+        if (m_light_count == 0 || dr::none_or<false>(active))
+            return 0.f;
+
+        active &= has_flag(emitter->flags(), EmitterFlags::Surface);
+        ShapePtr shape = emitter->shape();
+        active &= dr::neq(shape, nullptr);
+
+        Float pdf = shape->pdf_position(ps, active) * cos_theta *
+                    dr::InvPi<Float> / (ScalarFloat) m_light_count;
+        return dr::select(active, pdf, 0.f);
+    }
+
+    /**
+     * \brief Adjoint BSDF factor for shading normals -- [Veach, p. 155]
+     *
+     * Returns zero for directions that would leak light through the surface.
+     */
+    Float adjoint_correction(const SurfaceInteraction3f &si, const Vector3f &wo) const {
+        Float wi_dot_geo_n = dr::dot(si.n, si.to_world(si.wi)),
+              wo_dot_geo_n = dr::dot(si.n, si.to_world(wo));
+
+        Mask valid = (wi_dot_geo_n * Frame3f::cos_theta(si.wi) > 0.f) &&
+                     (wo_dot_geo_n * Frame3f::cos_theta(wo) > 0.f);
+
+        return dr::select(valid,
+                          dr::abs((Frame3f::cos_theta(si.wi) * wo_dot_geo_n) /
+                                  (Frame3f::cos_theta(wo) * wi_dot_geo_n)),
+                          0.f);
+    }
+
+    /// Connect a camera subpath vertex to a sampled emitter position
+    Spectrum connect_emitter(const Scene *scene, Sampler *sampler,
+                             const SurfaceInteraction3f &si, const BSDFPtr &bsdf,
+                             const Float &d_vcm, const Float &d_vc,
+                             Mask active) const {
+        BSDFContext ctx;
+        auto [ds, em_weight] = scene->sample_emitter_direction(
+            si, sampler->next_2d(active), true, active);
+        active &= dr::neq(ds.pdf, 0.f);
+
+        Vector3f wo = si.to_local(ds.d);
+        auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active);
+
+        SurfaceInteraction3f si_rev(si);
+        si_rev.wi = wo;
+        Float pdf_rev = bsdf->pdf(ctx, si_rev, si.wi, active);
+
+        // Emitter sampling vs. BSDF sampling and vs. longer light subpaths
+        Float cos_light = dr::abs(dr::dot(ds.n, ds.d)),
+              pdf_emit  = emission_pdf(ds.emitter, ds, cos_light, active && !ds.delta),
+              w_light   = dr::select(ds.delta, 0.f, mis(bsdf_pdf / ds.pdf)),
+              w_camera  = dr::select(
+                  pdf_emit > 0.f,
+                  mis(pdf_emit * dr::abs(Frame3f::cos_theta(wo)) / (ds.pdf * cos_light)) *
+                      (d_vcm + d_vc * mis(pdf_rev)),
+                  0.f);
+
+        Float weight = dr::rcp(w_light + 1.f + w_camera);
+        return dr::select(active, bsdf_val * em_weight * weight, 0.f);
+    }
+
+    /// Connect a camera subpath vertex to a light subpath vertex
+    Spectrum connect_vertices(const Scene *scene, const SurfaceInteraction3f &si,
+                              const BSDFPtr &bsdf, const Float &d_vcm,
+                              const Float &d_vc, const LightVertex &vertex,
+                              Mask active) const {
+        active &= vertex.valid;
+        if (dr::none_or<false>(active))
+            return 0.f;
+
+        Vector3f d = vertex.si.p - si.p;
+        Float dist2 = dr::squared_norm(d);
+        d *= dr::rsqrt(dist2);
+
+        // Camera side
+        BSDFContext ctx;
+        Vector3f wo_camera = si.to_local(d);
+        auto [f_camera, pdf_camera] = bsdf->eval_pdf(ctx, si, wo_camera, active);
+        SurfaceInteraction3f si_rev(si);
+        si_rev.wi = wo_camera;
+        Float pdf_camera_rev = bsdf->pdf(ctx, si_rev, si.wi, active);
+
+        // Light side
+        BSDFContext ctx_light(TransportMode::Importance);
+        BSDFPtr light_bsdf = vertex.si.bsdf();
+        Vector3f wo_light = vertex.si.to_local(-d);
+        auto [f_light, pdf_light] =
+            light_bsdf->eval_pdf(ctx_light, vertex.si, wo_light, active);
+        SurfaceInteraction3f light_rev(vertex.si);
+        light_rev.wi = wo_light;
+        Float pdf_light_rev = light_bsdf->pdf(ctx_light, light_rev, vertex.si.wi, active);
+
+        Float cos_camera = dr::abs(Frame3f::cos_theta(wo_camera)),
+              cos_light  = dr::abs(Frame3f::cos_theta(wo_light)),
+              w_light    = mis(pdf_camera * cos_light / dist2) *
+                           (vertex.d_vcm + vertex.d_vc * mis(pdf_light_rev)),
+              w_camera   = mis(pdf_light * cos_camera / dist2) *
+                           (d_vcm + d_vc * mis(pdf_camera_rev)),
+              weight     = dr::rcp(w_light + 1.f + w_camera);
+
+        // The BSDF values include the cosines of the geometry term
+        Spectrum value = f_camera * f_light * vertex.throughput *
+                         (adjoint_correction(vertex.si, wo_light) * weight / dist2);
+
+        active &= dr::any(dr::neq(unpolarized_spectrum(value), 0.f));
+        if (dr::any_or<true>(active))
+            active &= !scene->ray_test(si.spawn_ray_to(vertex.si.p), active);
+
+        return dr::select(active, value, 0.f);
+    }
+
+    /// Connect a light subpath vertex to the sensor and splat the result
+    void connect_sensor(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                        const SurfaceInteraction3f &si, const BSDFPtr &bsdf,
+                        const Spectrum &throughput, const Float &d_vcm,
+                        const Float &d_vc, ImageBlock *block,
+                        ScalarFloat sample_scale, Mask active) const {
+        auto [sensor_ds, sensor_weight] =
+            sensor->sample_direction(si, sampler->next_2d(active), active);
+        active &= sensor_ds.pdf > 0.f;
+        if (dr::none_or<false>(active))
+            return;
+
+        Ray3f sensor_ray = si.spawn_ray_to(sensor_ds.p);
+        active &= !scene->ray_test(sensor_ray, active);
+        if (dr::none_or<false>(active))
+            return;
+
+        BSDFContext ctx(TransportMode::Importance);
+        Vector3f wo = si.to_local(sensor_ray.d);
+        Spectrum value = bsdf->eval(ctx, si, wo, active) * adjoint_correction(si, wo);
+
+        SurfaceInteraction3f si_rev(si);
+        si_rev.wi = wo;
+        Float pdf_rev = bsdf->pdf(ctx, si_rev, si.wi, active);
+
+        // Density of the camera subpath that would have generated this vertex
+        Float pdf_camera = dr::mean(unpolarized_spectrum(sensor_weight)) *
+                           dr::abs(Frame3f::cos_theta(wo)) * crop_scale(sensor),
+              w_light    = mis(pdf_camera) * (d_vcm + d_vc * mis(pdf_rev)),
+              weight     = dr::rcp(1.f + w_light);
+
+        value *= throughput * sensor_weight * (weight * sample_scale);
+
+        block->put(sensor_ds.uv + block->offset(), si.wavelengths, value,
+                   /* alpha = */ 1.f, /* weight = */ 0.f, active);
+    }
+
+protected:
+    /// Indices of the emitters that start light subpaths
+    DynamicBuffer<UInt32> m_light_indices;
+    uint32_t m_light_count = 0;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(BidirectionalPathTracer, AdjointIntegrator);
+MI_EXPORT_PLUGIN(BidirectionalPathTracer, "Bidirectional path tracer");
+NAMESPACE_END(mitsuba)
@@ -120,7 +120,7 @@ public:
         MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
 
         SurfaceInteraction3f si = scene->ray_intersect(
-            ray, +RayFlags::All, /* coherent = */ true, active);
+            ray, scene->ray_flags(), /* coherent = */ true, active);
         Mask valid_ray = active && si.is_valid();
 
         Spectrum result(0.f);
@@ -161,6 +161,10 @@ public:
                 /* Determine BSDF value and probability of having sampled
                    that same direction using BSDF sampling. */
                 auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo, active_e);
+#if defined(MI_ENABLE_STATISTICS)
+                if constexpr (!dr::is_jit_v<Float>)
+                    bsdf->eval_counter().increment();
+#endif
                 bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
 
                 Float mis = dr::select(ds.delta, Float(1.f), mis_weight(
@@ -174,6 +178,10 @@ public:
         for (size_t i = 0; i < m_bsdf_samples; ++i) {
             auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
                                                sampler->next_2d(active), active);
+#if defined(MI_ENABLE_STATISTICS)
+            if constexpr (!dr::is_jit_v<Float>)
+                bsdf->sample_counter().increment();
+#endif
             bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
 
             Mask active_b = active && dr::any(dr::neq(unpolarized_spectrum(bsdf_val), 0.f));
@@ -0,0 +1,704 @@
+#include <mutex>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <nanothread/nanothread.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-irrcache:
+
+Irradiance cache (:monosp:`irrcache`)
+-------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth in the generated output image (where -1 corresponds to
+     :math:`\infty`). A value of 1 will only render directly visible light sources. 2 will lead
+     to single-bounce (direct-only) illumination, and so on. (Default: -1)
+
+ * - rr_depth
+   - |int|
+   - Specifies the path depth, at which the implementation will begin to use the *russian
+     roulette* path termination criterion. (Default: 5)
+
+ * - record_count
+   - |int|
+   - Number of camera rays that are traced to place irradiance records. A value of zero
+     selects one ray per 64 pixels of the film. (Default: 0)
+
+ * - irradiance_samples
+   - |int|
+   - Number of stratified hemisphere rays that estimate the irradiance of every record.
+     (Default: 256)
+
+ * - max_radius
+   - |float|
+   - Largest radius of influence of a record. A value of zero selects 1/20 of the diagonal
+     of the scene's bounding box. (Default: 0)
+
+ * - min_radius
+   - |float|
+   - Smallest radius of influence of a record. A value of zero selects 1/100 of
+     :paramtype:`max_radius`. (Default: 0)
+
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+
+This integrator accelerates the rendering of scenes dominated by diffuse interreflection,
+such as architectural interiors, by caching the indirect irradiance at a sparse set of
+surface points (Ward et al., "A Ray Tracing Solution for Diffuse Interreflection",
+SIGGRAPH 1988).
+
+Before rendering, :paramtype:`record_count` camera rays find points on purely diffuse
+surfaces. At each of them, :paramtype:`irradiance_samples` stratified cosine-weighted rays
+estimate the incident indirect radiance using the :ref:`path <integrator-path>` integrator.
+The resulting record stores the irradiance, its rotational and translational gradients
+(Ward and Heckbert, "Irradiance Gradients", EGWR 1992), and a radius of influence: the
+harmonic mean distance of the hemisphere rays, limited by the gradient and clamped to
+[:paramtype:`min_radius`, :paramtype:`max_radius`]. Records near contact geometry thus
+only cover a small neighborhood. The records are sorted into a hash grid.
+
+The final gather computes emission and direct illumination (by emitter sampling) at the
+first diffuse camera hit, and extrapolates the indirect illumination from all records
+whose normal is similar and whose radius contains the shading point (Tabellion and Lamorlette,
+"An Approximate Global Illumination System for Computer Generated Films", SIGGRAPH 2004).
+Camera rays that hit non-diffuse surfaces or points without valid records fall back to
+path tracing. The result is biased but smooth; the indirect illumination is consistent
+only in the limit of dense records.
+
+Records are computed in parallel (in scalar variants, by the worker threads, whose records
+are merged under a lock, and as one wavefront in JIT variants). The cache is built on the
+host and uploaded to the device in JIT variants.
+
+.. note:: This integrator does not handle participating media, and it only supports
+    RGB and monochrome variants without polarization.
+
+.. tabs::
+    .. code-tab::  xml
+
+        <integrator type="irrcache">
+            <integer name="irradiance_samples" value="512"/>
+        </integrator>
+
+    .. code-tab:: python
+
+        'type': 'irrcache',
+        'irradiance_samples': 512
+
+ */
+
+template <typename Float, typename Spectrum>
+class IrradianceCacheIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
+    MI_IMPORT_TYPES(Scene, Sensor, Film, Sampler, SamplingIntegrator, Emitter,
+                    EmitterPtr, BSDF, BSDFPtr)
+
+    /// Number of channels of the cached irradiance
+    static constexpr uint32_t Channels = (uint32_t) dr::size_v<UnpolarizedSpectrum>;
+
+    /// Number of values per record: position, normal, radius, irradiance and gradients
+    static constexpr uint32_t RecordStride = 7 + 7 * Channels;
+
+    IrradianceCacheIntegrator(const Properties &props) : Base(props) {
+        if constexpr (is_spectral_v<Spectrum> || is_polarized_v<Spectrum>)
+            Throw("The irradiance cache only supports RGB and monochrome "
+                  "variants without polarization!");
+
+        m_record_count = props.get<uint32_t>("record_count", 0);
+        uint32_t irradiance_samples = props.get<uint32_t>("irradiance_samples", 256);
+        m_max_radius = props.get<ScalarFloat>("max_radius", 0.f);
+        m_min_radius = props.get<ScalarFloat>("min_radius", 0.f);
+
+        if (irradiance_samples < 4)
+            Throw("The 'irradiance_samples' parameter must be at least 4!");
+        if (m_max_radius < 0.f || m_min_radius < 0.f)
+            Throw("The 'min_radius' and 'max_radius' parameters must be non-negative!");
+        if (m_max_radius > 0.f && m_min_radius > m_max_radius)
+            Throw("The 'min_radius' parameter must not exceed 'max_radius'!");
+
+        /* Stratify the hemisphere into M x N cells with N ~ pi M, which gives
+           cells of similar extent in both directions */
+        m_phi_res = std::max(2u, (uint32_t) dr::round(
+            dr::sqrt(dr::Pi<double> * irradiance_samples)));
+        m_theta_res = std::max(2u, irradiance_samples / m_phi_res);
+
+        PluginManager *pmgr = PluginManager::instance();
+        m_record_sampler = static_cast<Sampler *>(
+            pmgr->create_object<Sampler>(Properties("independent")));
+
+        // Path tracer of the fallback and of the hemisphere rays
+        auto path_tracer = [&](uint32_t max_depth, bool hide_emitters) {
+            Properties path_props("path");
+            path_props.set_int("max_depth",
+                               max_depth == (uint32_t) -1 ? -1 : (int) max_depth);
+            path_props.set_int("rr_depth", (int) m_rr_depth);
+            path_props.set_bool("hide_emitters", hide_emitters);
+            return ref<SamplingIntegrator>(static_cast<SamplingIntegrator *>(
+                pmgr->create_object<Integrator<Float, Spectrum>>(path_props)));
+        };
+
+        /* The hemisphere rays start one bounce deeper, and the emitters that
+           they hit directly are accounted for by emitter sampling */
+        m_path = path_tracer(m_max_depth, m_hide_emitters);
+        m_gather = path_tracer(m_max_depth == (uint32_t) -1
+                                   ? m_max_depth
+                                   : std::max(m_max_depth, 1u) - 1, true);
+    }
+
+    using Base::render;
+
+    TensorXf render(Scene *scene, Sensor *sensor, uint32_t seed = 0,
+                    uint32_t spp = 0, bool develop = true,
+                    bool evaluate = true) override {
+        // Indirect illumination requires at least three vertices
+        if (m_max_depth >= 3)
+            build_cache(scene, sensor, dr::sample_tea_32(seed, 1u).first);
+
+        TensorXf result = Base::render(scene, sensor, seed, spp, develop, evaluate);
+
+        // Release the records
+        m_records = DynamicBuffer<Float>();
+        m_cells = DynamicBuffer<UInt32>();
+        m_entries = DynamicBuffer<UInt32>();
+        m_stored_records = 0;
+
+        return result;
+    }
+
+    std::pair<Spectrum, Bool> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray,
+                                     const Medium *medium,
+                                     Float *aovs,
+                                     Bool active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        if (unlikely(m_max_depth == 0))
+            return { 0.f, false };
+
+        Spectrum result = 0.f;
+        Mask cached = false;
+
+        if (m_stored_records > 0) {
+            SurfaceInteraction3f si =
+                scene->ray_intersect(ray, +RayFlags::All, true, active);
+            cached = active && si.is_valid();
+
+            if (dr::any_or<true>(cached)) {
+                BSDFPtr bsdf = si.bsdf(ray);
+                cached &= cacheable(bsdf);
+
+                Float side = dr::sign(Frame3f::cos_theta(si.wi));
+                auto [irradiance, found] =
+                    interpolate(si.p, si.sh_frame.n * side, cached);
+                cached &= found;
+
+                if (dr::any_or<true>(cached))
+                    result[cached] = shade(scene, sampler, si, bsdf, irradiance, cached);
+            }
+        }
+
+        // Path trace all other camera rays
+        Mask fallback = active && !cached;
+        Mask valid_ray = cached;
+        if (dr::any_or<true>(fallback)) {
+            auto [value, valid] = m_path->sample(scene, sampler, ray, medium, aovs, fallback);
+            result[fallback] = value;
+            valid_ray |= fallback && valid;
+        }
+
+        return { result, valid_ray };
+    }
+
+    std::string to_string() const override {
+        return tfm::format("IrradianceCacheIntegrator[\n"
+                           "  max_depth = %u,\n"
+                           "  rr_depth = %u,\n"
+                           "  record_count = %u,\n"
+                           "  irradiance_samples = %u x %u,\n"
+                           "  min_radius = %f,\n"
+                           "  max_radius = %f\n"
+                           "]",
+                           m_max_depth, m_rr_depth, m_record_count, m_theta_res,
+                           m_phi_res, m_min_radius, m_max_radius);
+    }
+
+    MI_DECLARE_CLASS()
+
+protected:
+    /// Hash of a grid cell, must match in \ref build_cache() and \ref interpolate()
+    template <typename Int>
+    static auto cell_hash(const Int &x, const Int &y, const Int &z, uint32_t mask) {
+        using UInt = dr::uint32_array_t<Int>;
+        return ((dr::reinterpret_array<UInt>(x) * 73856093u) ^
+                (dr::reinterpret_array<UInt>(y) * 19349663u) ^
+                (dr::reinterpret_array<UInt>(z) * 83492791u)) & mask;
+    }
+
+    /// Can the indirect illumination of surfaces with this BSDF be cached?
+    static Mask cacheable(const BSDFPtr &bsdf) {
+        UInt32 flags = bsdf->flags();
+        uint32_t excluded = BSDFFlags::Glossy | BSDFFlags::Delta |
+                            BSDFFlags::Delta1D | BSDFFlags::Transmission;
+        return has_flag(flags, BSDFFlags::DiffuseReflection) &&
+               dr::eq(flags & excluded, 0u);
+    }
+
+    /**
+     * \brief Emission, direct illumination and cached indirect illumination
+     * at a diffuse camera hit
+     */
+    Spectrum shade(const Scene *scene, Sampler *sampler,
+                   const SurfaceInteraction3f &si, const BSDFPtr &bsdf,
+                   const UnpolarizedSpectrum &irradiance, Mask active) const {
+        Spectrum result = 0.f;
+
+        if (!m_hide_emitters) {
+            EmitterPtr emitter = si.emitter(scene, active);
+            Mask active_e = active && dr::neq(emitter, nullptr);
+            if (dr::any_or<true>(active_e))
+                result[active_e] += emitter->eval(si, active_e);
+        }
+
+        BSDFContext ctx;
+        if (m_max_depth >= 2) {
+            auto [ds, emitter_val] = scene->sample_emitter_direction(
+                si, sampler->next_2d(active), true, active);
+            Mask active_e = active && dr::neq(ds.pdf, 0.f);
+            Spectrum bsdf_val = bsdf->eval(ctx, si, si.to_local(ds.d), active_e);
+            result[active_e] += bsdf_val * emitter_val;
+        }
+
+        /* Towards the normal of the visible side, the (cosine-weighted) BSDF
+           of a diffuse surface equals its albedo divided by pi */
+        Vector3f normal(0.f, 0.f, dr::sign(Frame3f::cos_theta(si.wi)));
+        result += bsdf->eval(ctx, si, normal, active) * depolarizer<Spectrum>(irradiance);
+
+        return result;
+    }
+
+    /**
+     * \brief Weighted average of the extrapolated irradiance of all records
+     * that are valid at \c p with normal \c n
+     */
+    std::pair<UnpolarizedSpectrum, Mask> interpolate(const Point3f &p,
+                                                     const Normal3f &n,
+                                                     Mask active) const {
+        // Normals that deviate by more than ten degrees invalidate a record
+        const ScalarFloat inv_normal_tolerance =
+            1.f / (1.f - dr::cos(10.f * dr::Pi<ScalarFloat> / 180.f));
+
+        Float inv_cell = dr::opaque<Float>(m_inv_cell);
+        Vector3i cell = dr::floor2int<Vector3i>(p * inv_cell);
+        UInt32 bucket = cell_hash(cell.x(), cell.y(), cell.z(), m_table_mask),
+               index  = dr::gather<UInt32>(m_cells, bucket, active),
+               end    = dr::gather<UInt32>(m_cells, bucket + 1, active);
+        Mask active_l = active && index < end;
+
+        UnpolarizedSpectrum sum = 0.f;
+        Float weight_sum = 0.f;
+
+        dr::Loop<Mask> loop("Irradiance Cache Lookup", index, sum, weight_sum,
+                            active_l);
+        while (loop(active_l)) {
+            UInt32 offset =
+                dr::gather<UInt32>(m_entries, index, active_l) * RecordStride;
+            auto fetch = [&](uint32_t i) {
+                return dr::gather<Float>(m_records, offset + i, active_l);
+            };
+            auto fetch_vector = [&](uint32_t i) {
+                return Vector3f(fetch(i), fetch(i + 1), fetch(i + 2));
+            };
+
+            Vector3f d = p - Point3f(fetch_vector(0));
+            Normal3f n_i = fetch_vector(3);
+            Float radius = fetch(6);
+
+            Float error = dr::maximum(
+                dr::norm(d) / radius,
+                dr::safe_sqrt((1.f - dr::dot(n, n_i)) * inv_normal_tolerance));
+
+            // Skip records that lie in front of the shading point
+            Mask valid = active_l && error < 1.f &&
+                         dr::dot(d, n + n_i) > -1e-3f * radius;
+
+            Vector3f axis = dr::cross(n_i, n);
+            UnpolarizedSpectrum value;
+            for (uint32_t c = 0; c < Channels; ++c)
+                value[c] = fetch(7 + c) +
+                           dr::dot(axis, fetch_vector(7 + Channels + 3 * c)) +
+                           dr::dot(d, fetch_vector(7 + 4 * Channels + 3 * c));
+
+            Float weight = 1.f - error;
+            dr::masked(sum, valid) = dr::fmadd(dr::maximum(value, 0.f), weight, sum);
+            dr::masked(weight_sum, valid) = weight_sum + weight;
+
+            index++;
+            active_l &= index < end;
+        }
+
+        Mask found = active && weight_sum > 0.f;
+        return { dr::select(found, sum / weight_sum, UnpolarizedSpectrum(0.f)), found };
+    }
+
+    /**
+     * \brief Sample a camera ray through a uniformly distributed film position
+     *
+     * Returns the first intersection along with the normal of its visible
+     * side, and whether a record can be placed there.
+     */
+    std::tuple<Interaction3f, Normal3f, Mask>
+    sample_candidate(const Scene *scene, const Sensor *sensor, Sampler *sampler) const {
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += sampler->next_1d() * sensor->shutter_open_time();
+
+        Point2f position_sample = sampler->next_2d(),
+                aperture_sample(.5f);
+        if (sensor->needs_aperture_sample())
+            aperture_sample = sampler->next_2d();
+
+        auto [ray, ray_weight] =
+            sensor->sample_ray(time, 0.f, position_sample, aperture_sample);
+        DRJIT_MARK_USED(ray_weight);
+
+        SurfaceInteraction3f si = scene->ray_intersect(ray);
+        Mask valid = si.is_valid();
+        Normal3f n = si.sh_frame.n * dr::sign(Frame3f::cos_theta(si.wi));
+
+        if (dr::any_or<true>(valid))
+            valid &= cacheable(si.bsdf(ray)) &&
+                     dr::neq(Frame3f::cos_theta(si.wi), 0.f);
+
+        return { Interaction3f(si), n, valid };
+    }
+
+    /**
+     * \brief Trace the hemisphere ray of the stratum (\c j, \c k) above an
+     * interaction with the given visible normal
+     *
+     * Returns the incident indirect radiance and the distance to the closest
+     * surface along the ray (infinite when the ray escapes).
+     */
+    std::pair<UnpolarizedSpectrum, Float>
+    trace_gather_ray(const Scene *scene, Sampler *sampler, const Interaction3f &it,
+                     const Normal3f &n, const UInt32 &j, const UInt32 &k,
+                     Mask active) const {
+        Point2f u = sampler->next_2d(active);
+        Float sin_theta_2 = (Float(j) + u.x()) * (1.f / m_theta_res);
+        auto [sin_phi, cos_phi] = dr::sincos(
+            (Float(k) + u.y()) * (dr::TwoPi<ScalarFloat> / m_phi_res));
+        Float sin_theta = dr::sqrt(sin_theta_2),
+              cos_theta = dr::safe_sqrt(1.f - sin_theta_2);
+
+        Vector3f d = Frame3f(n).to_world(
+            Vector3f(cos_phi * sin_theta, sin_phi * sin_theta, cos_theta));
+        Ray3f ray = it.spawn_ray(d);
+
+        PreliminaryIntersection3f pi =
+            scene->ray_intersect_preliminary(ray, false, active);
+        auto [radiance, valid] =
+            m_gather->sample(scene, sampler, RayDifferential3f(ray), nullptr,
+                             nullptr, active);
+        DRJIT_MARK_USED(valid);
+
+        return { unpolarized_spectrum(radiance),
+                 dr::select(pi.is_valid(), pi.t, dr::Infinity<Float>) };
+    }
+
+    /**
+     * \brief Turn the hemisphere samples of a point into an irradiance record
+     *
+     * \c radiance and \c dist hold \c Channels values and one value per
+     * stratum (j, k) at index <tt>j * m_phi_res + k</tt>.
+     */
+    void append_record(const ScalarPoint3f &p, const ScalarNormal3f &n,
+                       const ScalarFloat *radiance, const ScalarFloat *dist,
+                       std::vector<ScalarFloat> &records) const {
+        using ScalarFrame3f = Frame<ScalarFloat>;
+        const uint32_t M = m_theta_res, N = m_phi_res;
+        auto L = [&](uint32_t j, uint32_t k, uint32_t c) {
+            return radiance[(j * N + k) * Channels + c];
+        };
+        auto R = [&](uint32_t j, uint32_t k) { return dist[j * N + k]; };
+
+        ScalarFloat E[Channels] = { }, inv_dist_sum = 0.f;
+        ScalarVector3f rot[Channels], trans[Channels];
+        for (uint32_t c = 0; c < Channels; ++c)
+            rot[c] = trans[c] = 0.f;
+
+        // Gradients of Ward and Heckbert with the stratification of Krivanek et al.
+        for (uint32_t k = 0; k < N; ++k) {
+            ScalarFloat phi = dr::TwoPi<ScalarFloat> * (k + .5f) / N,
+                        phi_m = dr::TwoPi<ScalarFloat> * k / N;
+            ScalarVector3f u_k(dr::cos(phi), dr::sin(phi), 0.f),
+                           v_k(-dr::sin(phi), dr::cos(phi), 0.f),
+                           v_km(-dr::sin(phi_m), dr::cos(phi_m), 0.f);
+            uint32_t k_prev = (k + N - 1) % N;
+
+            for (uint32_t j = 0; j < M; ++j) {
+                ScalarFloat sin_theta = dr::sqrt((j + .5f) / M),
+                            tan_theta = sin_theta / dr::sqrt(1.f - (j + .5f) / M),
+                            sin_m = dr::sqrt((ScalarFloat) j / M),
+                            cos_m = dr::sqrt(1.f - (ScalarFloat) j / M),
+                            cos_p = dr::safe_sqrt(1.f - (j + 1.f) / M);
+
+                inv_dist_sum += 1.f / R(j, k);
+                ScalarFloat r_phi = dr::minimum(R(j, k), R(j, k_prev)),
+                            r_theta = j > 0 ? dr::minimum(R(j, k), R(j - 1, k))
+                                            : dr::Infinity<ScalarFloat>;
+
+                for (uint32_t c = 0; c < Channels; ++c) {
+                    E[c] += L(j, k, c);
+                    rot[c] -= v_k * (tan_theta * L(j, k, c));
+                    if (j > 0)
+                        trans[c] += u_k * (dr::TwoPi<ScalarFloat> / N * sin_m *
+                                           dr::sqr(cos_m) / r_theta *
+                                           (L(j, k, c) - L(j - 1, k, c)));
+                    trans[c] += v_km * ((cos_m - cos_p) / (sin_theta * r_phi) *
+                                        (L(j, k, c) - L(j, k_prev, c)));
+                }
+            }
+        }
+
+        ScalarFloat scale = dr::Pi<ScalarFloat> / (M * N), E_mean = 0.f;
+        ScalarVector3f grad_mean = 0.f;
+        for (uint32_t c = 0; c < Channels; ++c) {
+            E[c] *= scale;
+            rot[c] *= scale;
+            E_mean += E[c] / Channels;
+            grad_mean += trans[c] / (ScalarFloat) Channels;
+        }
+
+        if (!std::isfinite(E_mean) || !dr::all(dr::isfinite(grad_mean)))
+            return;
+
+        // Harmonic mean distance, limited by the translational gradient
+        ScalarFloat radius = (M * N) / inv_dist_sum,
+                    grad_norm = dr::norm(grad_mean);
+        if (grad_norm > 0.f)
+            radius = dr::minimum(radius, E_mean / grad_norm);
+        radius = dr::clamp(radius, m_min_radius_eff, m_max_radius_eff);
+
+        ScalarFrame3f frame(n);
+        size_t offset = records.size();
+        records.resize(offset + RecordStride);
+        ScalarFloat *r = records.data() + offset;
+        for (uint32_t i = 0; i < 3; ++i) {
+            r[i] = p[i];
+            r[3 + i] = n[i];
+        }
+        r[6] = radius;
+        for (uint32_t c = 0; c < Channels; ++c) {
+            ScalarVector3f rot_w = frame.to_world(rot[c]),
+                           trans_w = frame.to_world(trans[c]);
+            r[7 + c] = E[c];
+            for (uint32_t i = 0; i < 3; ++i) {
+                r[7 + Channels + 3 * c + i] = rot_w[i];
+                r[7 + 4 * Channels + 3 * c + i] = trans_w[i];
+            }
+        }
+    }
+
+    /// Place the irradiance records and sort them into the hash grid
+    void build_cache(const Scene *scene, const Sensor *sensor, uint32_t seed) {
+        ScalarBoundingBox3f bbox = scene->bbox();
+        ScalarFloat diagonal = bbox.valid() ? dr::norm(bbox.extents()) : 1.f;
+        m_max_radius_eff = m_max_radius > 0.f ? m_max_radius : diagonal / 20.f;
+        m_min_radius_eff = m_min_radius > 0.f ? m_min_radius : m_max_radius_eff / 100.f;
+
+        uint32_t candidates = m_record_count;
+        if (candidates == 0)
+            candidates = std::max(1u, dr::prod(sensor->film()->crop_size()) / 64u);
+
+        const uint32_t gather_count = m_theta_res * m_phi_res;
+        std::vector<ScalarFloat> records;
+
+        if constexpr (dr::is_jit_v<Float>) {
+            using FloatD = dr::detached_t<Float>;
+            using UInt32D = dr::detached_t<UInt32>;
+
+            ref<Sampler> sampler = m_record_sampler->clone();
+            sampler->seed(seed, candidates);
+            auto [it, n, valid] = sample_candidate(scene, sensor, sampler);
+
+            UInt32D index = dr::compress(dr::detach(valid));
+            uint32_t count = (uint32_t) dr::width(index);
+            if (count > 0) {
+                // One lane per hemisphere ray of every candidate
+                UInt32 lane = dr::arange<UInt32>(count * gather_count),
+                       candidate = lane / gather_count,
+                       stratum = lane - candidate * gather_count,
+                       j = stratum / m_phi_res,
+                       k = stratum - j * m_phi_res;
+                UInt32 source = dr::gather<UInt32>(UInt32(index), candidate);
+
+                Interaction3f it_g = dr::gather<Interaction3f>(it, source);
+                Normal3f n_g = dr::gather<Normal3f>(n, source);
+
+                sampler->seed(seed + 1, count * gather_count);
+                auto [radiance, dist] =
+                    trace_gather_ray(scene, sampler, it_g, n_g, j, k, true);
+
+                // Transfer everything to the host
+                FloatD host[7 + Channels];
+                for (uint32_t i = 0; i < 3; ++i) {
+                    host[i] = dr::migrate(dr::gather<FloatD>(dr::detach(it.p[i]), index),
+                                          AllocType::Host);
+                    host[3 + i] = dr::migrate(dr::gather<FloatD>(dr::detach(n[i]), index),
+                                              AllocType::Host);
+                }
+                host[6] = dr::migrate(dr::detach(dist), AllocType::Host);
+                for (uint32_t c = 0; c < Channels; ++c)
+                    host[7 + c] = dr::migrate(dr::detach(radiance[c]), AllocType::Host);
+                for (uint32_t i = 0; i < 7 + Channels; ++i)
+                    dr::schedule(host[i]);
+                dr::eval();
+                dr::sync_thread();
+
+                std::vector<ScalarFloat> radiance_host(gather_count * Channels);
+                for (uint32_t i = 0; i < count; ++i) {
+                    for (uint32_t s = 0; s < gather_count; ++s)
+                        for (uint32_t c = 0; c < Channels; ++c)
+                            radiance_host[s * Channels + c] =
+                                host[7 + c].data()[i * gather_count + s];
+
+                    append_record(
+                        ScalarPoint3f(host[0].data()[i], host[1].data()[i], host[2].data()[i]),
+                        ScalarNormal3f(host[3].data()[i], host[4].data()[i], host[5].data()[i]),
+                        radiance_host.data(), host[6].data() + i * gather_count, records);
+                }
+            }
+        } else {
+            constexpr uint32_t BlockSize = 16;
+            uint32_t block_count = (candidates + BlockSize - 1) / BlockSize;
+            std::mutex mutex;
+            ThreadEnvironment env;
+
+            dr::parallel_for(
+                dr::blocked_range<uint32_t>(0, block_count, 1),
+                [&](const dr::blocked_range<uint32_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> sampler = m_record_sampler->clone();
+                    std::vector<ScalarFloat> local, radiance(gather_count * Channels),
+                                             dist(gather_count);
+
+                    for (uint32_t b = range.begin(); b != range.end(); ++b) {
+                        sampler->seed(seed + b);
+                        uint32_t count =
+                            std::min(BlockSize, candidates - b * BlockSize);
+
+                        for (uint32_t i = 0; i < count; ++i, sampler->advance()) {
+                            auto [it, n, valid] = sample_candidate(scene, sensor, sampler);
+                            if (!valid)
+                                continue;
+
+                            for (uint32_t j = 0; j < m_theta_res; ++j) {
+                                for (uint32_t k = 0; k < m_phi_res; ++k) {
+                                    uint32_t s = j * m_phi_res + k;
+                                    auto [value, t] =
+                                        trace_gather_ray(scene, sampler, it, n, j, k, true);
+                                    for (uint32_t c = 0; c < Channels; ++c)
+                                        radiance[s * Channels + c] = value[c];
+                                    dist[s] = t;
+                                }
+                            }
+
+                            append_record(it.p, n, radiance.data(), dist.data(), local);
+                        }
+                    }
+
+                    // Thread-safe insertion of the records of this worker
+                    std::lock_guard<std::mutex> guard(mutex);
+                    records.insert(records.end(), local.begin(), local.end());
+                }
+            );
+        }
+
+        /* Insert every record into the (at most 2x2x2) cells overlapped by its
+           sphere of influence, using a counting sort by the hash of the cell */
+        uint32_t count = (uint32_t) (records.size() / RecordStride);
+        uint32_t table_size = 1;
+        while (table_size < count && table_size < (1u << 30))
+            table_size <<= 1;
+        uint32_t mask = table_size - 1;
+        m_inv_cell = .5f / m_max_radius_eff;
+
+        std::vector<std::pair<uint32_t, uint32_t>> items;
+        for (uint32_t i = 0; i < count; ++i) {
+            const ScalarFloat *r = records.data() + (size_t) i * RecordStride;
+            ScalarPoint3f p(r[0], r[1], r[2]);
+            ScalarVector3i lo = dr::floor2int<ScalarVector3i>((p - r[6]) * m_inv_cell),
+                           hi = dr::floor2int<ScalarVector3i>((p + r[6]) * m_inv_cell);
+
+            size_t first = items.size();
+            for (int z = lo.z(); z <= hi.z(); ++z)
+                for (int y = lo.y(); y <= hi.y(); ++y)
+                    for (int x = lo.x(); x <= hi.x(); ++x) {
+                        uint32_t h = cell_hash(x, y, z, mask);
+                        bool duplicate = false;
+                        for (size_t l = first; l < items.size(); ++l)
+                            duplicate |= items[l].first == h;
+                        if (!duplicate)
+                            items.emplace_back(h, i);
+                    }
+        }
+
+        std::vector<uint32_t> cells(table_size + 1, 0u), entries(items.size());
+        for (auto [h, i] : items)
+            cells[h + 1]++;
+        for (uint32_t i = 0; i < table_size; ++i)
+            cells[i + 1] += cells[i];
+        std::vector<uint32_t> cursor(cells.begin(), cells.end() - 1);
+        for (auto [h, i] : items)
+            entries[cursor[h]++] = i;
+
+        m_stored_records = count;
+        m_table_mask = mask;
+        m_records = dr::load<DynamicBuffer<Float>>(records.data(), records.size());
+        m_cells = dr::load<DynamicBuffer<UInt32>>(cells.data(), cells.size());
+        m_entries = dr::load<DynamicBuffer<UInt32>>(entries.data(), entries.size());
+
+        Log(Debug, "Irradiance cache: %u records from %u camera rays.", count,
+            candidates);
+    }
+
+protected:
+    uint32_t m_record_count;
+    uint32_t m_theta_res, m_phi_res;
+    ScalarFloat m_max_radius, m_min_radius;
+    ref<Sampler> m_record_sampler;
+    ref<SamplingIntegrator> m_path, m_gather;
+
+    /// Radius bounds of the current render job
+    ScalarFloat m_max_radius_eff = 0.f, m_min_radius_eff = 0.f;
+    /// Records, see \ref RecordStride
+    DynamicBuffer<Float> m_records;
+    /// Index of the first entry of every bucket (plus the end of the list)
+    DynamicBuffer<UInt32> m_cells;
+    /// Record indices sorted by bucket
+    DynamicBuffer<UInt32> m_entries;
+    uint32_t m_stored_records = 0;
+    uint32_t m_table_mask = 0;
+    ScalarFloat m_inv_cell = 0.f;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(IrradianceCacheIntegrator, MonteCarloIntegrator)
+MI_EXPORT_PLUGIN(IrradianceCacheIntegrator, "Irradiance cache integrator");
+NAMESPACE_END(mitsuba)
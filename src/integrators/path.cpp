@@ -1,10 +1,15 @@
 #include <tuple>
+#include <mitsuba/core/fstream.h>
 #include <mitsuba/core/ray.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/warp.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/emitter.h>
+#include <mitsuba/render/guiding.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -35,6 +40,45 @@ Path tracer (:monosp:`path`)
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
 
+ * - wavefront
+   - |bool|
+   - Render the bounces of all paths one after the other and shade them in separate passes
+     per material, instead of compiling a single kernel around the loop over the path depth.
+     See below for details. (Default: |false|)
+
+ * - sort_rays
+   - |bool|
+   - In wavefront mode of the LLVM variants, reorder the paths before every bounce so that rays
+     with nearby origins and similar directions are traced together. (Default: |false|)
+
+ * - guiding
+   - |bool|
+   - Learn the distribution of incident radiance in the scene and use it to guide the
+     directions sampled at smooth surfaces. See below for details. (Default: |false|)
+
+ * - guiding_iterations
+   - |int|
+   - Number of training passes that are rendered to learn the guiding distribution
+     before the actual image. The first pass uses one sample per pixel, and every
+     following pass doubles this number. (Default: 5)
+
+ * - guiding_bsdf_fraction
+   - |float|
+   - Probability of sampling directions from the BSDF instead of the guiding
+     distribution. (Default: 0.5)
+
+ * - guiding_spatial_threshold
+   - |float|
+   - Number of radiance estimates after which a region of the guiding distribution is
+     subdivided in the first training pass. (Default: 12000)
+
+ * - guiding_file
+   - |string|
+   - If specified and the file exists, the guiding distribution is loaded from it instead
+     of being trained. Otherwise, the trained distribution is written to this file, so
+     that the following renderings (e.g. the frames of an animation) can reuse it.
+     (Default: none)
+
 This integrator implements a basic path tracer and is a **good default choice**
 when there is no strong reason to prefer another method.
 
@@ -67,6 +111,55 @@ relies on multiple importance sampling to combine BSDF and emitter samples. The
 main difference in comparison to the former plugin is that it considers light
 paths of arbitrary length to compute both direct and indirect illumination.
 
+**Wavefront mode**: in JIT variants, the loop over the path depth is normally compiled into a
+single kernel, in which the BSDFs of all materials are called through virtual function calls.
+When paths hit different materials, these calls diverge and waste most of the SIMD lanes or GPU
+threads, especially at later bounces. With :monosp:`wavefront` enabled, the integrator instead
+launches separate kernels for every bounce. Finished paths are removed before each bounce, and the
+intersections are binned by the registry ID of their BSDF, so that every material is sampled
+and evaluated by its own kernel that only processes the paths hitting it. This adds
+synchronization between bounces, and it pays off for scenes with many complex materials (e.g.
+:monosp:`principled`, :monosp:`measured` or :monosp:`blendbsdf`). The rendered image is the
+same in both modes. Wavefront mode only supports primal rendering, differentiable rendering and
+scalar variants ignore the parameter.
+
+Secondary rays are incoherent, so neighboring rays in a wavefront traverse unrelated parts of
+the acceleration data structure. Enabling :monosp:`sort_rays` additionally sorts the paths that
+are alive by the octant of their direction and the cell of a coarse grid over the scene that
+contains their origin before every bounce. This improves the cache behavior of the ray
+tracing kernels (e.g. the packets traced by Embree on the CPU) in large scenes, at the cost of a
+sorting step on the host. The parameter is only supported by the LLVM variants, whose wavefronts
+already reside in host memory; CUDA variants ignore it, since every bounce would have to wait
+for the GPU.
+
+The scalar variants render the pixels of an image block one after the other. With the
+integer :monosp:`packet_size` parameter (a power of two up to 16), the camera rays of that many
+neighboring pixels are instead traced together as a packet through the kd-tree or Embree, which
+share the traversal of the nodes that all of them visit. The subsequent bounces are traced one
+ray at a time, and the rendered image matches the default mode up to rounding errors.
+
+**Subsurface scattering**: light that is refracted into a :ref:`subsurface <bsdf-subsurface>`
+material is not traced through the interior. Instead, the integrator samples the position
+where it leaves the surface again from the normalized diffusion profile of Christensen and
+Burley. It projects a probe ray through a disk around the entry point onto the same shape,
+where the plane of the disk is chosen perpendicular to the normal (with probability 1/2) or
+to one of the tangents. One of the first four intersections of the probe ray with the shape
+is chosen as exit position, and the densities of the three projections are combined by
+multiple importance sampling. The light leaves the surface into a cosine-weighted direction,
+and emitters are sampled at the exit position. Subsurface scattering is not supported in
+polarized variants, and the wavefront mode is disabled for scenes with such materials.
+
+**Path guiding**: when :monosp:`guiding` is enabled, the integrator renders a number of
+training passes before the actual image. They record the radiance arriving at the path
+vertices in a spatio-directional tree (the SD-tree of "Practical Path Guiding for Efficient
+Light-Transport Simulation" by Müller et al.), which is refined after every pass. Afterwards,
+directions at surfaces without delta components are sampled either from the BSDF or from the
+learned distribution, which are combined by one-sample multiple importance sampling. This
+considerably speeds up the convergence of difficult indirect illumination, e.g. caustics cast
+through glass onto diffuse surfaces. The distribution is learned during the first call to
+:code:`render()` and reused by the following ones. Guiding is only supported in scalar
+variants without polarization, other variants ignore the parameter.
+
 .. note:: This integrator does not handle participating media
 
 .. tabs::
@@ -87,10 +180,114 @@ paths of arbitrary length to compute both direct and indirect illumination.
 template <typename Float, typename Spectrum>
 class PathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 public:
-    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
+    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters,
+                   record_path_length, record_event, primary_intersection,
+                   primary_cache_active)
     MI_IMPORT_TYPES(Scene, Sampler, Medium, Emitter, EmitterPtr, BSDF, BSDFPtr)
 
-    PathIntegrator(const Properties &props) : Base(props) { }
+    /// Path guiding relies on the scalar data structures of \ref GuidingField
+    static constexpr bool GuidingSupported =
+        !dr::is_jit_v<Float> && !is_polarized_v<Spectrum>;
+
+    /// Number of intersections of a subsurface probe ray that are considered
+    static constexpr uint32_t SubsurfaceProbeHits = 4;
+
+    /// Radius of the probe disk relative to the largest profile scale
+    static constexpr ScalarFloat SubsurfaceRadius = 16.f;
+
+    PathIntegrator(const Properties &props) : Base(props) {
+        m_wavefront = props.get<bool>("wavefront", false);
+        m_sort_rays = props.get<bool>("sort_rays", false);
+        if (m_sort_rays && dr::is_cuda_v<Float>) {
+            /* Sorting on the host would synchronize the GPU before every
+               bounce, and the warps of OptiX don't trace packets anyway */
+            Log(Warn, "The \"sort_rays\" parameter is only supported by the "
+                      "LLVM variants and will be ignored.");
+            m_sort_rays = false;
+        }
+        m_guiding = props.get<bool>("guiding", false);
+        m_guiding_iterations = props.get<uint32_t>("guiding_iterations", 5);
+        m_guiding_bsdf_fraction =
+            props.get<ScalarFloat>("guiding_bsdf_fraction", 0.5f);
+        m_guiding_spatial_threshold =
+            props.get<ScalarFloat>("guiding_spatial_threshold", 12000.f);
+        m_guiding_file = props.string("guiding_file", "");
+
+        if (m_guiding_bsdf_fraction < 0.f || m_guiding_bsdf_fraction > 1.f)
+            Throw("The 'guiding_bsdf_fraction' parameter must be in [0, 1]!");
+
+        if (m_guiding && !GuidingSupported) {
+            Log(Warn, "Path guiding is only supported in scalar variants "
+                      "without polarization, ignoring the 'guiding' "
+                      "parameter.");
+            m_guiding = false;
+        }
+
+        if (m_wavefront && !dr::is_jit_v<Float>) {
+            Log(Warn, "The wavefront mode is only supported in JIT variants, "
+                      "ignoring the 'wavefront' parameter.");
+            m_wavefront = false;
+        }
+    }
+
+    using Base::render;
+
+    TensorXf render(Scene *scene, Sensor *sensor, uint32_t seed = 0,
+                    uint32_t spp = 0, bool develop = true,
+                    bool evaluate = true) override {
+        if (m_guiding && !m_guiding_field) {
+            // Train with the sample count of the sensor, render with the requested one
+            if (spp == 0)
+                spp = sensor->sampler()->sample_count();
+            prepare_guiding(scene, sensor, seed);
+        }
+
+        return Base::render(scene, sensor, seed, spp, develop, evaluate);
+    }
+
+    /// Load the guiding field or learn it by rendering a few training passes
+    void prepare_guiding(Scene *scene, Sensor *sensor, uint32_t seed) {
+        if (!m_guiding_file.empty() && fs::exists(m_guiding_file)) {
+            ref<FileStream> stream = new FileStream(m_guiding_file);
+            m_guiding_field = new GuidingField(stream);
+            Log(Info, "Loaded the guiding field from \"%s\" (%zu leaves).",
+                m_guiding_file.string(), m_guiding_field->leaf_count());
+            return;
+        }
+
+        ScalarBoundingBox3f bbox = scene->bbox();
+        if (!bbox.valid()) {
+            Log(Warn, "Path guiding requires a scene with a valid bounding box, "
+                      "disabling it.");
+            m_guiding = false;
+            return;
+        }
+
+        // Slightly enlarge the bounding box to avoid precision issues
+        ScalarVector3f margin = dr::maximum(bbox.extents(), 1e-4f) * 1e-3f;
+        m_guiding_field = new GuidingField(
+            GuidingField::ScalarBoundingBox3f(
+                GuidingField::ScalarPoint3f(bbox.min - margin),
+                GuidingField::ScalarPoint3f(bbox.max + margin)),
+            (float) m_guiding_spatial_threshold);
+
+        Log(Info, "Training the guiding field (%u pass%s) ..",
+            m_guiding_iterations, m_guiding_iterations == 1 ? "" : "es");
+
+        m_guiding_record = true;
+        for (uint32_t i = 0; i < m_guiding_iterations && !this->should_stop(); ++i) {
+            Base::render(scene, sensor, seed + i + 1, 1u << i,
+                         false /* develop */, true /* evaluate */);
+            m_guiding_field->refine();
+        }
+        m_guiding_record = false;
+
+        if (!m_guiding_file.empty()) {
+            ref<FileStream> stream =
+                new FileStream(m_guiding_file, FileStream::ETruncReadWrite);
+            m_guiding_field->write(stream);
+        }
+    }
 
     std::pair<Spectrum, Bool> sample(const Scene *scene,
                                      Sampler *sampler,
@@ -103,6 +300,11 @@ public:
         if (unlikely(m_max_depth == 0))
             return { 0.f, false };
 
+        if constexpr (dr::is_jit_v<Float>) {
+            if (m_wavefront && !dr::grad_enabled(ray_) && !has_subsurface(scene))
+                return sample_wavefront(scene, sampler, ray_, active);
+        }
+
         // --------------------- Configure loop state ----------------------
 
         Ray3f ray                     = Ray3f(ray_);
@@ -120,6 +322,23 @@ public:
         Bool          prev_bsdf_delta = true;
         BSDFContext   bsdf_ctx;
 
+        /* With the primary hit cache or a ray packet, the camera ray is not
+           traced by the first iteration of the loop (see the m_cache_primary
+           and m_packet_size members of SamplingIntegrator) */
+        bool cached_primary = primary_cache_active();
+        PreliminaryIntersection3f primary_pi;
+        if (cached_primary)
+            primary_pi = primary_intersection(scene, ray, active);
+
+        // Only compute the fields read by the BSDFs, textures and emitters
+        uint32_t ray_flags = scene->ray_flags();
+
+        // Path vertices whose incident radiance is recorded for path guiding
+        const GuidingField *guiding_field = nullptr;
+        std::vector<GuidingVertex> guiding_vertices;
+        if constexpr (GuidingSupported)
+            guiding_field = m_guiding_field.get();
+
         /* Set up a Dr.Jit loop. This optimizes away to a normal loop in scalar
            mode, and it generates either a a megakernel (default) or
            wavefront-style renderer in JIT variants. This can be controlled by
@@ -143,10 +362,16 @@ public:
             /* dr::Loop implicitly masks all code in the loop using the 'active'
                flag, so there is no need to pass it to every function */
 
-            SurfaceInteraction3f si =
-                scene->ray_intersect(ray,
-                                     /* ray_flags = */ +RayFlags::All,
-                                     /* coherent = */ dr::eq(depth, 0u));
+            SurfaceInteraction3f si;
+            if (cached_primary) {
+                Mask primary = dr::eq(depth, 0u);
+                si = scene->ray_intersect(ray, ray_flags, false, !primary);
+                dr::masked(si, primary) = primary_pi.compute_surface_interaction(
+                    ray, ray_flags, primary);
+            } else {
+                si = scene->ray_intersect(ray, ray_flags,
+                                          /* coherent = */ dr::eq(depth, 0u));
+            }
 
             // ---------------------- Direct emission ----------------------
 
@@ -181,6 +406,19 @@ public:
 
             BSDFPtr bsdf = si.bsdf(ray);
 
+            /* Guide the sampled direction? Delta components of BSDFs can't
+               be combined with the guiding distribution. */
+            bool guide = false, record = false;
+            if constexpr (GuidingSupported) {
+                if (guiding_field && active_next) {
+                    uint32_t flags = bsdf->flags();
+                    record = has_flag(flags, BSDFFlags::Smooth) &&
+                             !has_flag(flags, BSDFFlags::Delta);
+                    guide = record && guiding_field->trained();
+                    record &= m_guiding_record;
+                }
+            }
+
             // ---------------------- Emitter sampling ----------------------
 
             // Perform emitter sampling?
@@ -191,9 +429,29 @@ public:
             Vector3f wo = dr::zeros<Vector3f>();
 
             if (dr::any_or<true>(active_em)) {
+                bool test_visibility = true;
+#if defined(MI_ENABLE_STATISTICS)
+                // Test the visibility below to tell occluded samples apart
+                test_visibility = dr::is_jit_v<Float>;
+#endif
+
                 // Sample the emitter
                 std::tie(ds, em_weight) = scene->sample_emitter_direction(
-                    si, sampler->next_2d(), true, active_em);
+                    si, sampler->next_2d(), test_visibility, active_em);
+
+#if defined(MI_ENABLE_STATISTICS)
+                if constexpr (!dr::is_jit_v<Float>) {
+                    record_event(MonteCarloEvent::EmitterSample);
+                    if (ds.pdf == 0.f ||
+                        dr::all(dr::eq(unpolarized_spectrum(em_weight), 0.f))) {
+                        record_event(MonteCarloEvent::EmitterSampleZero);
+                    } else if (scene->ray_test(si.spawn_ray_to(ds.p))) {
+                        record_event(MonteCarloEvent::EmitterSampleOccluded);
+                        em_weight = dr::zeros<Spectrum>();
+                        ds.pdf = 0.f;
+                    }
+                }
+#endif
                 active_em &= dr::neq(ds.pdf, 0.f);
 
                 /* Given the detached emitter sample, recompute its contribution
@@ -215,18 +473,68 @@ public:
             auto [bsdf_val, bsdf_pdf, bsdf_sample, bsdf_weight]
                 = bsdf->eval_pdf_sample(bsdf_ctx, si, wo, sample_1, sample_2);
 
+#if defined(MI_ENABLE_STATISTICS)
+            if constexpr (!dr::is_jit_v<Float>) {
+                bsdf->eval_counter().increment();
+                bsdf->sample_counter().increment();
+            }
+#endif
+
+            // --------------------- Path guiding ------------------------
+
+            if constexpr (GuidingSupported) {
+                if (guide) {
+                    /* Combine BSDF and guided sampling by one-sample MIS
+                       (balance heuristic), the mixture density replaces the
+                       BSDF density in the MIS weights of emitter samples */
+                    ScalarFloat alpha = m_guiding_bsdf_fraction;
+                    auto guide_pdf = [&](const Vector3f &d) {
+                        return (Float) guiding_field->pdf(
+                            GuidingField::ScalarPoint3f(si.p),
+                            GuidingField::ScalarVector3f(d));
+                    };
+
+                    if (active_em)
+                        bsdf_pdf = alpha * bsdf_pdf + (1.f - alpha) * guide_pdf(ds.d);
+
+                    if (sampler->next_1d() >= alpha) {
+                        auto [d, pdf] = guiding_field->sample(
+                            GuidingField::ScalarPoint3f(si.p),
+                            GuidingField::ScalarPoint2f(sampler->next_2d()));
+                        Vector3f wo_guide = si.to_local(Vector3f(d));
+                        auto [guide_val, guide_bsdf_pdf] =
+                            bsdf->eval_pdf(bsdf_ctx, si, wo_guide);
+#if defined(MI_ENABLE_STATISTICS)
+                        bsdf->eval_counter().increment();
+#endif
+
+                        bsdf_sample.wo = wo_guide;
+                        bsdf_sample.pdf = alpha * guide_bsdf_pdf + (1.f - alpha) * (Float) pdf;
+                        bsdf_sample.eta = 1.f;
+                        bsdf_sample.sampled_type = +BSDFFlags::Smooth;
+                        bsdf_weight = bsdf_sample.pdf > 0.f ? guide_val / bsdf_sample.pdf
+                                                            : Spectrum(0.f);
+                    } else if (bsdf_sample.pdf > 0.f) {
+                        Float pdf = alpha * bsdf_sample.pdf +
+                                    (1.f - alpha) * guide_pdf(si.to_world(bsdf_sample.wo));
+                        bsdf_weight *= bsdf_sample.pdf / pdf;
+                        bsdf_sample.pdf = pdf;
+                    }
+                }
+            }
+
             // --------------- Emitter sampling contribution ----------------
 
             if (dr::any_or<true>(active_em)) {
-                bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
-
                 // Compute the MIS weight
                 Float mis_em =
                     dr::select(ds.delta, 1.f, mis_weight(ds.pdf, bsdf_pdf));
 
                 // Accumulate, being careful with polarization (see spec_fma)
                 result[active_em] = spec_fma(
-                    throughput, bsdf_val * em_weight * mis_em, result);
+                    throughput,
+                    si.to_world_mueller_stokes(bsdf_val, -wo, si.wi, em_weight * mis_em),
+                    result);
             }
 
             // ---------------------- BSDF sampling ----------------------
@@ -249,10 +557,55 @@ public:
                 bsdf_weight[bsdf_pdf_2 > 0.f] = bsdf_val_2 / dr::detach(bsdf_pdf_2);
             }
 
+            // ------------------- Subsurface scattering -------------------
+
+            if constexpr (!is_polarized_v<Spectrum>) {
+                // Refraction into a translucent material from the outside?
+                Mask active_sss =
+                    active_next && has_flag(bsdf->flags(), BSDFFlags::Subsurface) &&
+                    has_flag(bsdf_sample.sampled_type, BSDFFlags::DeltaTransmission) &&
+                    Frame3f::cos_theta(si.wi) > 0.f;
+
+                if (dr::any_or<true>(active_sss)) {
+                    auto [si_exit, sss_weight] = sample_subsurface(
+                        scene, sampler, si, bsdf, ray_flags, active_sss);
+
+                    /* The light leaves the surface again, undo the scaling of
+                       the radiance by the relative index of refraction */
+                    bsdf_weight[active_sss] *= dr::sqr(bsdf_sample.eta) * sss_weight;
+
+                    // Emitter sampling at the exit position
+                    auto [ds_sss, em_sss] = scene->sample_emitter_direction(
+                        si_exit, sampler->next_2d(), true, active_sss);
+                    Float cos_sss = dr::dot(si_exit.sh_frame.n, ds_sss.d),
+                          pdf_sss = dr::maximum(cos_sss, 0.f) * dr::InvPi<Float>;
+                    Float mis_sss =
+                        dr::select(ds_sss.delta, 1.f, mis_weight(ds_sss.pdf, pdf_sss));
+                    result[active_sss && dr::neq(ds_sss.pdf, 0.f)] = spec_fma(
+                        throughput, bsdf_weight * em_sss * pdf_sss * mis_sss, result);
+
+                    // Leave the surface into a cosine-weighted direction
+                    Vector3f wo_sss = warp::square_to_cosine_hemisphere(sampler->next_2d());
+                    dr::masked(ray, active_sss) = si_exit.spawn_ray(si_exit.to_world(wo_sss));
+                    dr::masked(bsdf_sample.pdf, active_sss) =
+                        warp::square_to_cosine_hemisphere_pdf(wo_sss);
+                    dr::masked(bsdf_sample.eta, active_sss) = 1.f;
+                    dr::masked(bsdf_sample.sampled_type, active_sss) =
+                        UInt32(+BSDFFlags::DiffuseReflection);
+                    dr::masked(si, active_sss) = si_exit;
+                }
+            }
+
             // ------ Update loop variables based on current interaction ------
 
             throughput *= bsdf_weight;
             eta *= bsdf_sample.eta;
+
+            if constexpr (GuidingSupported) {
+                if (record && bsdf_sample.pdf > 0.f)
+                    guiding_vertices.push_back({ si.p, ray.d, bsdf_sample.pdf,
+                                                 throughput, result });
+            }
             valid_ray |= active && si.is_valid() &&
                          !has_flag(bsdf_sample.sampled_type, BSDFFlags::Null);
 
@@ -278,6 +631,31 @@ public:
 
             active = active_next && (!rr_active || rr_continue) &&
                      dr::neq(throughput_max, 0.f);
+
+#if defined(MI_ENABLE_STATISTICS)
+            if constexpr (!dr::is_jit_v<Float>) {
+                if (active_next && rr_active && !rr_continue &&
+                    throughput_max != 0.f)
+                    record_event(MonteCarloEvent::RussianRoulette);
+            }
+#endif
+        }
+
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>)
+            record_path_length(depth);
+#endif
+
+        /* Record the radiance that arrived at the path vertices, i.e. the
+           contributions of the subsequent vertices divided by the throughput */
+        if constexpr (GuidingSupported) {
+            for (const GuidingVertex &v : guiding_vertices) {
+                Spectrum radiance = dr::select(v.throughput > 0.f,
+                                               (result - v.result) / v.throughput, 0.f);
+                guiding_field->record(GuidingField::ScalarPoint3f(v.p),
+                                      GuidingField::ScalarVector3f(v.d),
+                                      (float) (dr::mean(radiance) / v.pdf));
+            }
         }
 
         return {
@@ -286,14 +664,361 @@ public:
         };
     }
 
+    /**
+     * \brief Wavefront version of \ref sample() for JIT variants
+     *
+     * Every bounce is evaluated separately. The state of the paths that are
+     * still alive is compacted before each bounce, and the BSDFs are sampled
+     * by one kernel per material that only processes the intersections with
+     * this material. The sampler is still queried for all lanes of the
+     * wavefront, so that the random numbers (and the rendered image) match
+     * the ones of the megakernel.
+     */
+    std::pair<Spectrum, Bool> sample_wavefront(const Scene *scene,
+                                               Sampler *sampler,
+                                               const RayDifferential3f &ray_,
+                                               Bool active) const {
+        size_t size = dr::width(ray_);
+        Spectrum output = dr::zeros<Spectrum>(size);
+        Bool output_valid = dr::full<Bool>(false, size);
+
+        // Lanes of the wavefront that correspond to the paths alive
+        UInt32 index = dr::compress(active && dr::full<Bool>(true, size));
+
+        Ray3f ray             = dr::gather<Ray3f>(Ray3f(ray_), index);
+        size_t n              = dr::width(index);
+        Spectrum throughput   = dr::full<Spectrum>(1.f, n);
+        Spectrum result       = dr::zeros<Spectrum>(n);
+        Float eta             = dr::full<Float>(1.f, n);
+        Mask valid_ray        = dr::full<Mask>(!m_hide_emitters &&
+                                               scene->environment() != nullptr, n);
+
+        Interaction3f prev_si = dr::zeros<Interaction3f>(n);
+        Float prev_bsdf_pdf   = dr::full<Float>(1.f, n);
+        Bool prev_bsdf_delta  = dr::full<Bool>(true, n);
+        BSDFContext bsdf_ctx;
+
+        auto next_1d = [&]() { return dr::gather<Float>(sampler->next_1d(), index); };
+        auto next_2d = [&]() { return dr::gather<Point2f>(sampler->next_2d(), index); };
+
+        // Write the results of paths that terminate to the output
+        auto retire = [&](const Mask &done) {
+            dr::scatter(output, dr::select(valid_ray, result, 0.f), index, done);
+            dr::scatter(output_valid, valid_ray, index, done);
+        };
+
+        const char *domain = BSDFPtr::CallSupport::Domain;
+        constexpr JitBackend backend = dr::backend_v<Float>;
+
+        for (uint32_t depth = 0; n > 0; ++depth) {
+            SurfaceInteraction3f si =
+                scene->ray_intersect(ray, scene->ray_flags(), depth == 0);
+
+            // ---------------------- Direct emission ----------------------
+
+            DirectionSample3f ds(scene, si, prev_si);
+            Float em_pdf = scene->pdf_emitter_direction(prev_si, ds, !prev_bsdf_delta);
+            result = spec_fma(
+                throughput,
+                ds.emitter->eval(si, prev_bsdf_pdf > 0.f) *
+                    mis_weight(prev_bsdf_pdf, em_pdf),
+                result);
+
+            if (depth + 1 >= m_max_depth) {
+                retire(true);
+                break;
+            }
+
+            Mask active_next = si.is_valid();
+            BSDFPtr bsdf = si.bsdf(ray);
+
+            // ---------------------- Emitter sampling ----------------------
+
+            Mask active_em = active_next && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+            auto [ds_em, em_weight] =
+                scene->sample_emitter_direction(si, next_2d(), true, active_em);
+            active_em &= dr::neq(ds_em.pdf, 0.f);
+            Vector3f wo = si.to_local(ds_em.d);
+
+            Float sample_1 = next_1d();
+            Point2f sample_2 = next_2d();
+
+            // ------------- Shade the intersections per material -------------
+
+            Spectrum bsdf_val    = dr::zeros<Spectrum>(n),
+                     bsdf_weight = dr::zeros<Spectrum>(n);
+            Float bsdf_pdf       = dr::zeros<Float>(n);
+            BSDFSample3f bs      = dr::zeros<BSDFSample3f>(n);
+
+            UInt32 bsdf_id = dr::reinterpret_array<UInt32>(bsdf);
+            dr::eval(si, bsdf_id, wo, sample_1, sample_2, active_em, active_next);
+
+            UInt32 counts = dr::zeros<UInt32>(jit_registry_get_max(backend, domain) + 1);
+            dr::scatter_reduce(ReduceOp::Add, counts, UInt32(1), bsdf_id, active_next);
+            auto &&counts_host = dr::migrate(counts, AllocType::Host);
+            dr::sync_thread();
+
+            for (uint32_t id = 1; id < (uint32_t) dr::width(counts_host); ++id) {
+                if (counts_host.data()[id] == 0)
+                    continue;
+
+                const BSDF *material =
+                    (const BSDF *) jit_registry_get_ptr(backend, domain, id);
+                UInt32 queue = dr::compress(active_next && dr::eq(bsdf_id, id));
+
+                SurfaceInteraction3f si_q = dr::gather<SurfaceInteraction3f>(si, queue);
+                auto [val_q, pdf_q, bs_q, weight_q] = material->eval_pdf_sample(
+                    bsdf_ctx, si_q, dr::gather<Vector3f>(wo, queue),
+                    dr::gather<Float>(sample_1, queue),
+                    dr::gather<Point2f>(sample_2, queue));
+
+                dr::scatter(bsdf_val, val_q, queue);
+                dr::scatter(bsdf_pdf, pdf_q, queue);
+                dr::scatter(bsdf_weight, weight_q, queue);
+                dr::scatter(bs.wo, bs_q.wo, queue);
+                dr::scatter(bs.pdf, bs_q.pdf, queue);
+                dr::scatter(bs.eta, bs_q.eta, queue);
+                dr::scatter(bs.sampled_type, bs_q.sampled_type, queue);
+                dr::scatter(bs.sampled_component, bs_q.sampled_component, queue);
+
+                // Launch one kernel per material
+                dr::eval(bsdf_val, bsdf_pdf, bsdf_weight, bs);
+            }
+
+            // --------------- Emitter sampling contribution ----------------
+
+            Float mis_em = dr::select(ds_em.delta, 1.f, mis_weight(ds_em.pdf, bsdf_pdf));
+            result = dr::select(
+                active_em,
+                spec_fma(throughput,
+                         si.to_world_mueller_stokes(bsdf_val, -wo, si.wi, em_weight * mis_em),
+                         result),
+                result);
+
+            // ---------------------- BSDF sampling ----------------------
+
+            bsdf_weight = si.to_world_mueller(bsdf_weight, -bs.wo, si.wi);
+            ray = si.spawn_ray(si.to_world(bs.wo));
+
+            throughput *= bsdf_weight;
+            eta *= bs.eta;
+            valid_ray |= active_next && !has_flag(bs.sampled_type, BSDFFlags::Null);
+
+            prev_si = si;
+            prev_bsdf_pdf = bs.pdf;
+            prev_bsdf_delta = has_flag(bs.sampled_type, BSDFFlags::Delta);
+
+            // -------------------- Stopping criterion ---------------------
+
+            Float throughput_max = dr::max(unpolarized_spectrum(throughput));
+            Float rr_prob = dr::minimum(throughput_max * dr::sqr(eta), .95f);
+            bool rr_active = depth + 1 >= m_rr_depth;
+            Mask rr_continue = next_1d() < rr_prob;
+            if (rr_active)
+                throughput *= dr::rcp(rr_prob);
+
+            Mask alive = active_next && (!rr_active || rr_continue) &&
+                         dr::neq(throughput_max, 0.f);
+
+            // ------------------ Compact the path state -------------------
+
+            retire(!alive);
+            UInt32 keep = dr::compress(alive);
+            n = dr::width(keep);
+            if (m_sort_rays && n > 1)
+                keep = coherent_order(scene, ray, keep);
+
+            index           = dr::gather<UInt32>(index, keep);
+            ray             = dr::gather<Ray3f>(ray, keep);
+            throughput      = dr::gather<Spectrum>(throughput, keep);
+            result          = dr::gather<Spectrum>(result, keep);
+            eta             = dr::gather<Float>(eta, keep);
+            valid_ray       = dr::gather<Mask>(valid_ray, keep);
+            prev_si         = dr::gather<Interaction3f>(prev_si, keep);
+            prev_bsdf_pdf   = dr::gather<Float>(prev_bsdf_pdf, keep);
+            prev_bsdf_delta = dr::gather<Bool>(prev_bsdf_delta, keep);
+
+            dr::eval(output, output_valid, index, ray, throughput, result, eta,
+                     valid_ray, prev_si, prev_bsdf_pdf, prev_bsdf_delta);
+        }
+
+        return { output, output_valid };
+    }
+
+    /**
+     * \brief Reorder the indices \c keep of rays so that rays with nearby
+     * origins and similar directions are consecutive
+     *
+     * The rays are sorted by the octant of their direction, followed by the
+     * Morton code of the cell of a 16x16x16 grid over the scene bounding box
+     * that contains their origin. Only used by the LLVM variants, where the
+     * counting sort reads the keys in place.
+     */
+    UInt32 coherent_order(const Scene *scene, const Ray3f &ray,
+                          const UInt32 &keep) const {
+        if constexpr (dr::is_cuda_v<Float>)
+            return keep;
+
+        ScalarBoundingBox3f bbox = scene->bbox();
+        if (!bbox.valid())
+            return keep;
+
+        constexpr uint32_t GridBits = 4, GridRes = 1u << GridBits;
+        Ray3f r = dr::gather<Ray3f>(ray, keep);
+        Vector3f p = (r.o - bbox.min) / dr::maximum(bbox.extents(), 1e-6f);
+        Vector3u cell = Vector3u(dr::clamp(p * (ScalarFloat) GridRes, 0.f,
+                                           (ScalarFloat) (GridRes - 1)));
+
+        UInt32 key = dr::select(r.d.x() < 0.f, 1u, 0u) |
+                     dr::select(r.d.y() < 0.f, 2u, 0u) |
+                     dr::select(r.d.z() < 0.f, 4u, 0u);
+        for (int i = (int) GridBits - 1; i >= 0; --i)
+            for (uint32_t j = 0; j < 3; ++j)
+                key = (key << 1) | ((cell[j] >> i) & 1u);
+
+        // Counting sort on the host (LLVM arrays already reside in host memory)
+        dr::eval(key, keep);
+        dr::sync_thread();
+
+        const uint32_t *keys = key.data(), *indices = keep.data();
+        size_t n = dr::width(keep);
+        std::vector<uint32_t> offset((8u << (3 * GridBits)) + 1, 0u), order(n);
+        for (size_t i = 0; i < n; ++i)
+            offset[keys[i] + 1]++;
+        for (size_t i = 1; i < offset.size(); ++i)
+            offset[i] += offset[i - 1];
+        for (size_t i = 0; i < n; ++i)
+            order[offset[keys[i]]++] = indices[i];
+
+        return dr::load<UInt32>(order.data(), n);
+    }
+
     //! @}
     // =============================================================
 
+    bool uses_primary_intersection() const override { return m_max_depth != 0; }
+
     std::string to_string() const override {
         return tfm::format("PathIntegrator[\n"
             "  max_depth = %u,\n"
-            "  rr_depth = %u\n"
-            "]", m_max_depth, m_rr_depth);
+            "  rr_depth = %u,\n"
+            "  wavefront = %s,\n"
+            "  sort_rays = %s,\n"
+            "  guiding = %s,\n"
+            "  guiding_field = %s\n"
+            "]", m_max_depth, m_rr_depth, m_wavefront ? "true" : "false",
+            m_sort_rays ? "true" : "false",
+            m_guiding ? "true" : "false",
+            m_guiding_field ? string::indent(m_guiding_field.get()) : "none");
+    }
+
+    /// Does the scene contain a material with subsurface scattering?
+    bool has_subsurface(const Scene *scene) const {
+        for (const auto &shape : scene->shapes()) {
+            const BSDF *bsdf = shape->bsdf();
+            if (bsdf && has_flag(bsdf->flags(), BSDFFlags::Subsurface))
+                return true;
+        }
+        return false;
+    }
+
+    /// Normalized diffusion profile with the scale \c d, without the albedo
+    UnpolarizedSpectrum subsurface_profile(const UnpolarizedSpectrum &d,
+                                           Float r) const {
+        r = dr::maximum(r, dr::Epsilon<Float>);
+        return (dr::exp(-r / d) + dr::exp(-r / (3.f * d))) /
+               (8.f * dr::Pi<Float> * d * r);
+    }
+
+    /**
+     * \brief Sample the position where light that is refracted into a
+     * translucent material at \c si leaves its surface again
+     *
+     * The distance from the entry point is sampled from the diffusion profile
+     * of a randomly chosen channel, and a probe ray through a disk around the
+     * entry point finds the corresponding positions on the shape. Returns the
+     * exit position and the ratio of the profile and the density of the
+     * position, which is zero when the probe ray did not find an exit.
+     */
+    std::pair<SurfaceInteraction3f, UnpolarizedSpectrum>
+    sample_subsurface(const Scene *scene, Sampler *sampler,
+                      const SurfaceInteraction3f &si, const BSDFPtr &bsdf,
+                      uint32_t ray_flags, Mask active) const {
+        constexpr size_t Channels = dr::array_size_v<UnpolarizedSpectrum>;
+
+        auto [albedo, mfp] = bsdf->eval_subsurface(si, active);
+
+        /* Scale of the profile for a given mean free path, fitted to the
+           results of Monte Carlo simulations by Christensen and Burley */
+        UnpolarizedSpectrum x = dr::abs(albedo - .8f),
+                            d = dr::maximum(mfp / (1.85f - albedo + 7.f * x * x * x),
+                                            dr::Epsilon<Float>);
+        Float r_max = dr::max(d) * SubsurfaceRadius;
+
+        // Choose the axis of the projection
+        const Frame3f &frame = si.sh_frame;
+        Float sample_axis = sampler->next_1d();
+        Mask axis_n = sample_axis < .5f,
+             axis_s = !axis_n && sample_axis < .75f;
+        Vector3f axis = dr::select(axis_n, frame.n, dr::select(axis_s, frame.s, frame.t)),
+                 u    = dr::select(axis_n, frame.s, dr::select(axis_s, frame.t, frame.n)),
+                 v    = dr::select(axis_n, frame.t, dr::select(axis_s, frame.n, frame.s));
+
+        // Choose a channel and sample a radius from its profile
+        UInt32 channel = dr::minimum(UInt32(sampler->next_1d() * (ScalarFloat) Channels),
+                                     (uint32_t) Channels - 1u);
+        Float d_c = d[0];
+        for (size_t i = 1; i < Channels; ++i)
+            d_c = dr::select(dr::eq(channel, (uint32_t) i), d[i], d_c);
+
+        Float sample_r = sampler->next_1d();
+        Mask short_lobe = sample_r < .25f;
+        Float u_r = dr::select(short_lobe, sample_r * 4.f, (sample_r - .25f) * (4.f / 3.f));
+        Float r = -dr::select(short_lobe, d_c, 3.f * d_c) * dr::log(1.f - u_r);
+        auto [sin_phi, cos_phi] = dr::sincos(dr::TwoPi<Float> * sampler->next_1d());
+        active &= r < r_max;
+
+        // Cast the probe ray along the axis through the sampled disk position
+        Float h = dr::safe_sqrt(dr::sqr(r_max) - dr::sqr(r));
+        Ray3f probe(si.p + r * (cos_phi * u + sin_phi * v) + h * axis, -axis,
+                    2.f * h, si.time, si.wavelengths);
+
+        // Choose one of the intersections with the shape (reservoir sampling)
+        SurfaceInteraction3f si_exit = dr::zeros<SurfaceInteraction3f>();
+        Float hits = 0.f;
+        Mask active_probe = active;
+        for (uint32_t i = 0; i < SubsurfaceProbeHits; ++i) {
+            SurfaceInteraction3f si_probe =
+                scene->ray_intersect(probe, ray_flags, false, active_probe);
+            active_probe &= si_probe.is_valid();
+
+            Mask same_shape = active_probe && dr::eq(si_probe.shape, si.shape);
+            dr::masked(hits, same_shape) += 1.f;
+            Mask accept = same_shape && sampler->next_1d() * hits < 1.f;
+            dr::masked(si_exit, accept) = si_probe;
+
+            Ray3f next = si_probe.spawn_ray(probe.d);
+            next.maxt = probe.maxt - si_probe.t;
+            dr::masked(probe, active_probe) = next;
+        }
+        active &= hits > 0.f;
+
+        // Density of the exit position over the three projections
+        Vector3f delta = si_exit.p - si.p;
+        Float pdf = 0.f;
+        for (uint32_t i = 0; i < 3; ++i) {
+            const Vector3f &a = i == 0 ? frame.n : (i == 1 ? frame.s : frame.t);
+            Float r_a = dr::norm(dr::fnmadd(a, dr::dot(delta, a), delta));
+            Float pdf_a = dr::mean(subsurface_profile(d, r_a)) *
+                          dr::abs(dr::dot(si_exit.n, a));
+            pdf += dr::select(r_a < r_max, (i == 0 ? .5f : .25f) * pdf_a, 0.f);
+        }
+
+        active &= pdf > 0.f;
+        UnpolarizedSpectrum weight =
+            albedo * subsurface_profile(d, dr::norm(delta)) * hits / pdf;
+
+        return { si_exit, weight & active };
     }
 
     /// Compute a multiple importance sampling weight using the power heuristic
@@ -307,16 +1032,41 @@ public:
     /**
      * \brief Perform a Mueller matrix multiplication in polarized modes, and a
      * fused multiply-add otherwise.
+     *
+     * In polarized modes, \c b is the Stokes vector of the light arriving at
+     * the current vertex, hence only the first column of the product is
+     * computed (see \ref mueller::apply_stokes()).
      */
     Spectrum spec_fma(const Spectrum &a, const Spectrum &b,
                       const Spectrum &c) const {
         if constexpr (is_polarized_v<Spectrum>)
-            return a * b + c;
+            return mueller::apply_stokes(a, b) + c;
         else
             return dr::fmadd(a, b, c);
     }
 
     MI_DECLARE_CLASS()
+protected:
+    /// Path vertex whose incident radiance is recorded for path guiding
+    struct GuidingVertex {
+        Point3f p;
+        Vector3f d;
+        Float pdf;
+        Spectrum throughput;
+        /// Contribution of the path before leaving the vertex
+        Spectrum result;
+    };
+
+    bool m_wavefront;
+    bool m_sort_rays;
+    bool m_guiding;
+    uint32_t m_guiding_iterations;
+    ScalarFloat m_guiding_bsdf_fraction;
+    ScalarFloat m_guiding_spatial_threshold;
+    fs::path m_guiding_file;
+    ref<GuidingField> m_guiding_field;
+    /// Record radiance estimates in the guiding field (training passes)
+    bool m_guiding_record = false;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(PathIntegrator, MonteCarloIntegrator)
@@ -0,0 +1,557 @@
+#include <mutex>
+#include <mitsuba/core/plugin.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/ray.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <nanothread/nanothread.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-ppm:
+
+Progressive photon mapper (:monosp:`ppm`)
+-----------------------------------------
+
+.. pluginparameters::
+
+ * - max_depth
+   - |int|
+   - Specifies the longest path depth of the photon and camera paths (where -1 corresponds
+     to :math:`\infty`). (Default: -1)
+
+ * - rr_depth
+   - |int|
+   - Specifies the minimum depth of photon paths, after which the implementation will start
+     to use the *russian roulette* path termination criterion. (Default: 5)
+
+ * - photon_count
+   - |int|
+   - Number of photons that are emitted in every pass. (Default: 250000)
+
+ * - initial_radius
+   - |float|
+   - Radius of the photon gathering in the first pass. A value of zero selects 1/200 of the
+     diagonal of the scene's bounding box. (Default: 0)
+
+ * - alpha
+   - |float|
+   - Radius reduction parameter in :math:`(0, 1)`. Smaller values shrink the radius faster,
+     which reduces the bias at the cost of more noise. (Default: 0.7)
+
+ * - samples_per_pass
+   - |int|
+   - Number of samples per pixel that are rendered after every photon pass. The sample count
+     of the sensor determines the total number of samples, and hence the number of passes.
+     (Default: 1)
+
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+
+This integrator implements progressive photon mapping in the probabilistic formulation of
+"Progressive Photon Mapping: A Probabilistic Approach" by Knaus and Zwicker. Every pass traces
+:paramtype:`photon_count` photons from the emitters and stores them at the surfaces with
+non-delta BSDF components. Camera paths then follow the delta components of BSDFs
+(e.g. glass and mirrors) and estimate the radiance scattered by the remaining components from
+the density of the photons within the current radius. The radius shrinks from pass to pass
+following
+
+.. math::
+
+    r_{i+1}^2 = r_i^2 \frac{i + \alpha}{i + 1},
+
+so that the average of the passes converges to the correct solution. This makes it possible to
+render paths that are practically impossible to sample with the :ref:`path
+<integrator-path>` integrator, such as caustics seen through a refractive object
+(specular-diffuse-specular paths).
+
+Photons are traced in parallel (in scalar variants, by the worker threads, and as one wavefront
+in JIT variants) and sorted into a hash grid whose cells have twice the current radius, so that
+gathering only visits eight cells. The photon map is built on the host and uploaded to the
+device in JIT variants.
+
+.. note:: This integrator does not handle participating media, and it only supports
+    RGB and monochrome variants without polarization.
+
+.. tabs::
+    .. code-tab::  xml
+
+        <integrator type="ppm">
+            <integer name="photon_count" value="1000000"/>
+        </integrator>
+
+    .. code-tab:: python
+
+        'type': 'ppm',
+        'photon_count': 1000000
+
+ */
+
+template <typename Float, typename Spectrum>
+class ProgressivePhotonMapper : public MonteCarloIntegrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters,
+                   should_stop)
+    MI_IMPORT_TYPES(Scene, Sensor, Film, Sampler, ImageBlock, Emitter, EmitterPtr,
+                    BSDF, BSDFPtr)
+
+    /// Number of values per photon: position, direction and power
+    static constexpr uint32_t PhotonStride = 6 + (uint32_t) dr::size_v<UnpolarizedSpectrum>;
+
+    ProgressivePhotonMapper(const Properties &props) : Base(props) {
+        if constexpr (is_spectral_v<Spectrum> || is_polarized_v<Spectrum>)
+            Throw("The progressive photon mapper only supports RGB and "
+                  "monochrome variants without polarization!");
+
+        m_photon_count = props.get<uint32_t>("photon_count", 250000);
+        m_initial_radius = props.get<ScalarFloat>("initial_radius", 0.f);
+        m_alpha = props.get<ScalarFloat>("alpha", 0.7f);
+        m_pass_spp = props.get<uint32_t>("samples_per_pass", 1);
+
+        if (m_photon_count == 0)
+            Throw("The 'photon_count' parameter must be positive!");
+        if (m_initial_radius < 0.f)
+            Throw("The 'initial_radius' parameter must be non-negative!");
+        if (!(m_alpha > 0.f && m_alpha < 1.f))
+            Throw("The 'alpha' parameter must be in (0, 1)!");
+        if (m_pass_spp == 0)
+            Throw("The 'samples_per_pass' parameter must be positive!");
+
+        Properties sampler_props("independent");
+        m_photon_sampler = static_cast<Sampler *>(
+            PluginManager::instance()->create_object<Sampler>(sampler_props));
+    }
+
+    using Base::render;
+
+    TensorXf render(Scene *scene, Sensor *sensor, uint32_t seed = 0,
+                    uint32_t spp = 0, bool develop = true,
+                    bool evaluate = true) override {
+        ref<Film> film = sensor->film();
+        ref<Sampler> sampler = sensor->sampler();
+
+        if (spp == 0)
+            spp = sampler->sample_count();
+        uint32_t pass_count = (spp + m_pass_spp - 1) / m_pass_spp;
+
+        ScalarFloat radius = m_initial_radius;
+        if (radius == 0.f) {
+            ScalarBoundingBox3f bbox = scene->bbox();
+            radius = bbox.valid() ? dr::norm(bbox.extents()) / 200.f : 1e-2f;
+        }
+        m_radius2 = dr::sqr(radius);
+
+        Log(Info, "Rendering %u photon mapping pass%s with %u photon%s each ..",
+            pass_count, pass_count == 1 ? "" : "es", m_photon_count,
+            m_photon_count == 1 ? "" : "s");
+
+        /* Every pass renders an independent image with its own photon map.
+           Summing the raw film contents (values and weights) averages them. */
+        TensorXf sum;
+        for (uint32_t pass = 0; pass < pass_count && !should_stop(); ++pass) {
+            build_photon_map(scene, sensor, dr::sample_tea_32(seed, pass).first);
+            Base::render(scene, sensor, seed + pass, m_pass_spp,
+                         false /* develop */, true /* evaluate */);
+
+            TensorXf raw = film->develop(true /* raw */);
+            if (pass == 0)
+                sum = raw;
+            else
+                sum = sum + raw;
+            if constexpr (dr::is_jit_v<Float>)
+                dr::eval(sum);
+
+            m_radius2 *= (pass + 1 + m_alpha) / (pass + 2);
+        }
+
+        // Restore the sample count clobbered by the passes
+        sampler->set_sample_count(spp);
+
+        // Release the photon map of the last pass
+        m_photons = DynamicBuffer<Float>();
+        m_cells = DynamicBuffer<UInt32>();
+        m_stored_photons = 0;
+
+        if (sum.ndim() == 3) {
+            film->clear();
+            ref<ImageBlock> block =
+                new ImageBlock(sum, ScalarPoint2i(film->crop_offset()));
+            film->put_block(block);
+        }
+
+        if (develop) {
+            TensorXf result = film->develop();
+            if (evaluate)
+                dr::eval(result);
+            return result;
+        }
+
+        return {};
+    }
+
+    std::pair<Spectrum, Bool> sample(const Scene *scene,
+                                     Sampler *sampler,
+                                     const RayDifferential3f &ray_,
+                                     const Medium * /* medium */,
+                                     Float * /* aovs */,
+                                     Bool active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::SamplingIntegratorSample, active);
+
+        if (unlikely(m_max_depth == 0))
+            return { 0.f, false };
+
+        Ray3f ray           = Ray3f(ray_);
+        Spectrum throughput = 1.f;
+        Spectrum result     = 0.f;
+        UInt32 depth        = 0;
+        Mask valid_ray      = false;
+
+        /* Follow the delta components of the BSDFs, and estimate the light
+           scattered by the remaining components from the photon map */
+        dr::Loop<Bool> loop("Photon Mapper", sampler, ray, throughput, result,
+                            depth, valid_ray, active);
+        loop.set_max_iterations(m_max_depth);
+
+        while (loop(active)) {
+            SurfaceInteraction3f si =
+                scene->ray_intersect(ray,
+                                     /* ray_flags = */ +RayFlags::All,
+                                     /* coherent = */ dr::eq(depth, 0u));
+            valid_ray |= si.is_valid();
+
+            // ---------------------- Direct emission ----------------------
+
+            EmitterPtr emitter = si.emitter(scene);
+            Mask active_e = dr::neq(emitter, nullptr);
+            if (m_hide_emitters)
+                active_e &= depth > 0u;
+            if (dr::any_or<true>(active_e))
+                result[active_e] += throughput * emitter->eval(si, active_e);
+
+            active &= (depth + 1 < m_max_depth) && si.is_valid();
+            if (dr::none_or<false>(active))
+                break; // early exit for scalar mode
+
+            BSDFPtr bsdf = si.bsdf(ray);
+
+            // ------------------------ Gathering -------------------------
+
+            Mask active_g = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+            if (dr::any_or<true>(active_g))
+                result[active_g] += throughput * gather(si, bsdf, active_g);
+
+            // ---------------------- Delta scattering ----------------------
+
+            active &= has_flag(bsdf->flags(), BSDFFlags::Delta);
+            if (dr::none_or<false>(active))
+                break;
+
+            BSDFContext ctx;
+            ctx.type_mask = +BSDFFlags::Delta;
+            auto [bs, bsdf_weight] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                                  sampler->next_2d(active), active);
+
+            throughput *= bsdf_weight;
+            ray = si.spawn_ray(si.to_world(bs.wo));
+            depth++;
+            active &= dr::any(dr::neq(unpolarized_spectrum(throughput), 0.f));
+        }
+
+        return { result, valid_ray };
+    }
+
+    std::string to_string() const override {
+        return tfm::format("ProgressivePhotonMapper[\n"
+                           "  max_depth = %u,\n"
+                           "  rr_depth = %u,\n"
+                           "  photon_count = %u,\n"
+                           "  initial_radius = %f,\n"
+                           "  alpha = %f,\n"
+                           "  samples_per_pass = %u\n"
+                           "]",
+                           m_max_depth, m_rr_depth, m_photon_count,
+                           m_initial_radius, m_alpha, m_pass_spp);
+    }
+
+    MI_DECLARE_CLASS()
+
+protected:
+    /// Hash of a grid cell, must match in \ref build_photon_map() and \ref gather()
+    template <typename Int>
+    static auto cell_hash(const Int &x, const Int &y, const Int &z, uint32_t mask) {
+        using UInt = dr::uint32_array_t<Int>;
+        return ((dr::reinterpret_array<UInt>(x) * 73856093u) ^
+                (dr::reinterpret_array<UInt>(y) * 19349663u) ^
+                (dr::reinterpret_array<UInt>(z) * 83492791u)) & mask;
+    }
+
+    /// Trace photons for one (scalar) or all (JIT) lanes, appending them to \c photons
+    void trace_photons(const Scene *scene, const Sensor *sensor, Sampler *sampler,
+                       ScalarFloat scale, std::vector<ScalarFloat> &photons) const {
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0)
+            time += sampler->next_1d() * sensor->shutter_open_time();
+
+        Float wavelength_sample  = sampler->next_1d();
+        Point2f direction_sample = sampler->next_2d(),
+                position_sample  = sampler->next_2d();
+
+        auto [ray, throughput, emitter] = scene->sample_emitter_ray(
+            time, wavelength_sample, direction_sample, position_sample);
+        (void) emitter;
+
+        Float eta = 1.f;
+        Mask active = true;
+        BSDFContext ctx(TransportMode::Importance);
+
+        /* Bounces are traced one at a time (wavefront-style in JIT variants),
+           since every one of them appends a variable number of photons */
+        for (uint32_t depth = 0; depth < m_max_depth; ++depth) {
+            SurfaceInteraction3f si = scene->ray_intersect(ray, active);
+            active &= si.is_valid();
+            if (dr::none(active))
+                break;
+
+            BSDFPtr bsdf = si.bsdf(ray);
+            Mask store = active && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+            append_photons(si.p, -ray.d, unpolarized_spectrum(throughput) * scale,
+                           store, photons);
+
+            if (depth + 1 >= m_max_depth)
+                break;
+
+            auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active),
+                                               sampler->next_2d(active), active);
+
+            // Prevent light leaks due to shading normals
+            Float wi_dot_geo_n = dr::dot(si.n, -ray.d),
+                  wo_dot_geo_n = dr::dot(si.n, si.to_world(bs.wo));
+            active &= (wi_dot_geo_n * Frame3f::cos_theta(si.wi) > 0.f) &&
+                      (wo_dot_geo_n * Frame3f::cos_theta(bs.wo) > 0.f);
+
+            // Adjoint BSDF for shading normals -- [Veach, p. 155]
+            Float correction = dr::abs((Frame3f::cos_theta(si.wi) * wo_dot_geo_n) /
+                                       (Frame3f::cos_theta(bs.wo) * wi_dot_geo_n));
+            throughput *= bsdf_val * correction;
+            eta *= bs.eta;
+            active &= dr::any(dr::neq(unpolarized_spectrum(throughput), 0.f));
+
+            ray = si.spawn_ray(si.to_world(bs.wo));
+
+            // Russian roulette
+            if (depth + 1 >= m_rr_depth) {
+                Float q = dr::minimum(
+                    dr::max(unpolarized_spectrum(throughput)) * dr::sqr(eta), 0.95f);
+                active &= sampler->next_1d(active) < q;
+                throughput *= dr::rcp(q);
+            }
+
+            if constexpr (dr::is_jit_v<Float>) {
+                sampler->schedule_state();
+                dr::eval(ray, throughput, eta, active);
+            }
+        }
+    }
+
+    /// Append the photons of the active lanes to a host-side list
+    void append_photons(const Point3f &p, const Vector3f &d,
+                        const UnpolarizedSpectrum &power, const Mask &active,
+                        std::vector<ScalarFloat> &photons) const {
+        Float values[PhotonStride];
+        for (uint32_t i = 0; i < 3; ++i) {
+            values[i] = p[i];
+            values[3 + i] = d[i];
+        }
+        for (uint32_t i = 0; i < PhotonStride - 6; ++i)
+            values[6 + i] = power[i];
+
+        if constexpr (dr::is_jit_v<Float>) {
+            using FloatD = dr::detached_t<Float>;
+            using UInt32D = dr::detached_t<UInt32>;
+
+            UInt32D index = dr::compress(dr::detach(active));
+            size_t count = dr::width(index);
+            if (count == 0)
+                return;
+
+            FloatD host[PhotonStride];
+            for (uint32_t i = 0; i < PhotonStride; ++i) {
+                host[i] = dr::migrate(dr::gather<FloatD>(dr::detach(values[i]), index),
+                                      AllocType::Host);
+                dr::schedule(host[i]);
+            }
+            dr::eval();
+            dr::sync_thread();
+
+            size_t offset = photons.size();
+            photons.resize(offset + count * PhotonStride);
+            for (uint32_t i = 0; i < PhotonStride; ++i) {
+                const ScalarFloat *data = host[i].data();
+                for (size_t j = 0; j < count; ++j)
+                    photons[offset + j * PhotonStride + i] = data[j];
+            }
+        } else {
+            if (active && dr::all(dr::isfinite(power)))
+                photons.insert(photons.end(), values, values + PhotonStride);
+        }
+    }
+
+    /// Trace the photons of a pass and sort them into the hash grid
+    void build_photon_map(const Scene *scene, const Sensor *sensor, uint32_t seed) {
+        std::vector<ScalarFloat> photons;
+        ScalarFloat scale = 1.f / (ScalarFloat) m_photon_count;
+
+        if constexpr (dr::is_jit_v<Float>) {
+            ref<Sampler> sampler = m_photon_sampler->clone();
+            sampler->seed(seed, m_photon_count);
+            trace_photons(scene, sensor, sampler, scale, photons);
+        } else {
+            constexpr uint32_t BlockSize = 4096;
+            uint32_t block_count = (m_photon_count + BlockSize - 1) / BlockSize;
+            std::mutex mutex;
+            ThreadEnvironment env;
+
+            dr::parallel_for(
+                dr::blocked_range<uint32_t>(0, block_count, 1),
+                [&](const dr::blocked_range<uint32_t> &range) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    ref<Sampler> sampler = m_photon_sampler->clone();
+                    std::vector<ScalarFloat> local;
+
+                    for (uint32_t b = range.begin(); b != range.end(); ++b) {
+                        sampler->seed(seed + b);
+                        uint32_t count =
+                            std::min(BlockSize, m_photon_count - b * BlockSize);
+                        for (uint32_t i = 0; i < count; ++i) {
+                            trace_photons(scene, sensor, sampler, scale, local);
+                            sampler->advance();
+                        }
+                    }
+
+                    std::lock_guard<std::mutex> guard(mutex);
+                    photons.insert(photons.end(), local.begin(), local.end());
+                }
+            );
+        }
+
+        // Counting sort of the photons by the hash of their cell
+        size_t count = photons.size() / PhotonStride;
+        uint32_t table_size = 1;
+        while (table_size < count && table_size < (1u << 30))
+            table_size <<= 1;
+        uint32_t mask = table_size - 1;
+
+        ScalarFloat inv_cell = .5f / dr::sqrt(m_radius2);
+        std::vector<uint32_t> hashes(count), cells(table_size + 1, 0u);
+        for (size_t i = 0; i < count; ++i) {
+            const ScalarFloat *photon = photons.data() + i * PhotonStride;
+            uint32_t h = cell_hash((int32_t) dr::floor(photon[0] * inv_cell),
+                                   (int32_t) dr::floor(photon[1] * inv_cell),
+                                   (int32_t) dr::floor(photon[2] * inv_cell), mask);
+            hashes[i] = h;
+            cells[h + 1]++;
+        }
+        for (uint32_t i = 0; i < table_size; ++i)
+            cells[i + 1] += cells[i];
+
+        std::vector<uint32_t> cursor(cells.begin(), cells.end() - 1);
+        std::vector<ScalarFloat> sorted(photons.size());
+        for (size_t i = 0; i < count; ++i)
+            std::copy_n(photons.data() + i * PhotonStride, PhotonStride,
+                        sorted.data() + (size_t) cursor[hashes[i]]++ * PhotonStride);
+
+        m_stored_photons = (uint32_t) count;
+        m_table_mask = mask;
+        m_photons = dr::load<DynamicBuffer<Float>>(sorted.data(), sorted.size());
+        m_cells = dr::load<DynamicBuffer<UInt32>>(cells.data(), cells.size());
+
+        Log(Debug, "Photon map: %u photons, radius %f.", m_stored_photons,
+            dr::sqrt(m_radius2));
+    }
+
+    /// Density estimate of the light scattered by the non-delta BSDF components
+    Spectrum gather(const SurfaceInteraction3f &si, const BSDFPtr &bsdf,
+                    Mask active) const {
+        Spectrum result = 0.f;
+        if (m_stored_photons == 0)
+            return result;
+
+        BSDFContext ctx;
+        ctx.type_mask = +BSDFFlags::Smooth;
+        Float radius2 = dr::opaque<Float>(m_radius2),
+              inv_cell = dr::opaque<Float>(.5f / dr::sqrt(m_radius2));
+
+        // The cells are twice as large as the radius, visit the 2x2x2 nearest ones
+        Vector3i base = dr::floor2int<Vector3i>(si.p * inv_cell - .5f);
+
+        for (uint32_t k = 0; k < 8; ++k) {
+            Vector3i cell = base + Vector3i((int) (k & 1), (int) ((k >> 1) & 1), (int) (k >> 2));
+            UInt32 bucket = cell_hash(cell.x(), cell.y(), cell.z(), m_table_mask),
+                   index  = dr::gather<UInt32>(m_cells, bucket, active),
+                   end    = dr::gather<UInt32>(m_cells, bucket + 1, active);
+            Mask active_k = active && index < end;
+
+            dr::Loop<Mask> loop("Photon Gathering", index, result, active_k);
+            while (loop(active_k)) {
+                UInt32 offset = index * PhotonStride;
+                auto fetch = [&](uint32_t i) {
+                    return dr::gather<Float>(m_photons, offset + i, active_k);
+                };
+
+                Point3f p(fetch(0), fetch(1), fetch(2));
+
+                // Skip photons of other cells that map to the same bucket
+                Mask valid = active_k && dr::squared_norm(p - si.p) < radius2 &&
+                             dr::all(dr::eq(dr::floor2int<Vector3i>(p * inv_cell), cell));
+
+                Vector3f wo = si.to_local(Vector3f(fetch(3), fetch(4), fetch(5)));
+                Float cos_theta = dr::abs(Frame3f::cos_theta(wo));
+                valid &= cos_theta > 0.f;
+
+                UnpolarizedSpectrum power;
+                for (uint32_t i = 0; i < PhotonStride - 6; ++i)
+                    power[i] = fetch(6 + i);
+
+                // bsdf->eval() includes the cosine foreshortening factor
+                Spectrum value = bsdf->eval(ctx, si, wo, valid);
+                result[valid] += value * depolarizer<Spectrum>(power / cos_theta);
+
+                index++;
+                active_k &= index < end;
+            }
+        }
+
+        return result * (dr::InvPi<ScalarFloat> / radius2);
+    }
+
+protected:
+    uint32_t m_photon_count;
+    ScalarFloat m_initial_radius;
+    ScalarFloat m_alpha;
+    uint32_t m_pass_spp;
+    ref<Sampler> m_photon_sampler;
+
+    /// Squared radius of the current pass
+    ScalarFloat m_radius2 = 0.f;
+    /// Photons sorted by the hash of their cell (see \ref PhotonStride)
+    DynamicBuffer<Float> m_photons;
+    /// Index of the first photon of every bucket (plus the end of the list)
+    DynamicBuffer<UInt32> m_cells;
+    uint32_t m_stored_photons = 0;
+    uint32_t m_table_mask = 0;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(ProgressivePhotonMapper, MonteCarloIntegrator)
+MI_EXPORT_PLUGIN(ProgressivePhotonMapper, "Progressive photon mapper");
+NAMESPACE_END(mitsuba)
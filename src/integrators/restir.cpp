@@ -0,0 +1,552 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/bsdf.h>
+#include <mitsuba/render/emitter.h>
+#include <mitsuba/render/film.h>
+#include <mitsuba/render/imageblock.h>
+#include <mitsuba/render/integrator.h>
+#include <mitsuba/render/records.h>
+#include <mitsuba/render/sampler.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _integrator-restir:
+
+Reservoir-based direct illumination (:monosp:`restir`)
+------------------------------------------------------
+
+.. pluginparameters::
+
+ * - candidates
+   - |int|
+   - Number of emitter samples that are resampled per pixel and pass. (Default: 32)
+
+ * - temporal
+   - |bool|
+   - Reuse the reservoirs of the previous pass, including the last pass of the
+     previous call to ``render()`` with the same sensor. (Default: |true|)
+
+ * - max_history
+   - |float|
+   - Limits the number of candidates represented by a reused reservoir to this
+     multiple of :monosp:`candidates`, which lets the reservoirs adapt to
+     changes of the scene. (Default: 20)
+
+ * - spatial_samples
+   - |int|
+   - Number of neighboring pixels whose reservoirs are reused. (Default: 5)
+
+ * - spatial_radius
+   - |float|
+   - Radius in pixels within which the neighbors are chosen. (Default: 30)
+
+ * - hide_emitters
+   - |bool|
+   - Hide directly visible emitters. (Default: no, i.e. |false|)
+
+This integrator computes the direct illumination of the surfaces seen by the
+camera using *reservoir-based spatiotemporal importance resampling*
+(ReSTIR, Bitterli et al. 2020). Every pixel streams :monosp:`candidates`
+samples generated by the emitter sampling routines of the scene through a
+*reservoir*, which retains one of them with a probability proportional to its
+unshadowed contribution. The selected sample is tested for visibility, after
+which the reservoir is combined with the reservoir of the same pixel in the
+previous pass (temporal reuse) and with the reservoirs of a few randomly
+chosen neighboring pixels (spatial reuse). Only a single shadow ray is traced
+to shade the final sample of every pixel. A pixel thus effectively chooses
+among the candidates of many passes and pixels, which greatly reduces noise
+in scenes with many emitters.
+
+Reservoirs are only combined between pixels whose surfaces have similar
+normals and depths. Temporal reuse assumes that the camera does not move
+between passes; the history is discarded when the integrator renders a
+different sensor or film size.
+
+The implementation combines reservoirs with the biased :math:`1/M` weights
+of the original method, trading a slight darkening near shadow boundaries
+and geometric discontinuities for lower variance. Every sample of a pixel
+(see the :monosp:`sample_count` parameter of the sampler) renders one pass.
+
+.. note:: This integrator is only available in the JIT (LLVM and CUDA)
+   variants. It does not handle participating media, indirect illumination or
+   arbitrary output variables, and only shades the first surface visible
+   through every pixel.
+
+.. tabs::
+    .. code-tab::  xml
+        :name: restir-integrator
+
+        <integrator type="restir">
+            <integer name="candidates" value="32"/>
+        </integrator>
+
+    .. code-tab:: python
+
+        'type': 'restir',
+        'candidates': 32
+
+ */
+
+template <typename Float, typename Spectrum>
+class ReSTIRIntegrator : public SamplingIntegrator<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(SamplingIntegrator, m_hide_emitters, m_stop, m_render_timer,
+                   m_pass_callback, should_stop, aov_names)
+    MI_IMPORT_TYPES(Scene, Sensor, Film, Sampler, ImageBlock, Emitter,
+                    EmitterPtr, BSDF, BSDFPtr)
+
+    /// Weighted reservoir holding one light sample per pixel
+    struct Reservoir {
+        /// Selected emitter sample
+        DirectionSample3f sample = dr::zeros<DirectionSample3f>();
+        /// Sum of the resampling weights of all candidates
+        Float weight_sum = 0.f;
+        /// Number of candidates represented by the reservoir
+        Float count = 0.f;
+        /// Target function of the selected sample at the owning pixel
+        Float target = 0.f;
+
+        /// Stream a candidate (or a reservoir representing 'n' candidates)
+        void update(const DirectionSample3f &ds, const Float &weight,
+                    const Float &target_, const Float &n, const Float &u,
+                    Mask active) {
+            dr::masked(weight_sum, active) += weight;
+            dr::masked(count, active) += n;
+            Mask accept = active && weight > 0.f && u * weight_sum < weight;
+            dr::masked(sample, accept) = ds;
+            dr::masked(target, accept) = target_;
+        }
+
+        /// Unbiased contribution weight of the selected sample
+        Float contribution_weight() const {
+            return dr::select(target > 0.f && count > 0.f,
+                              weight_sum / (count * target), 0.f);
+        }
+
+        /// Limit the number of represented candidates to 'max_count'
+        void clamp(ScalarFloat max_count) {
+            Mask clamp = count > max_count;
+            dr::masked(weight_sum, clamp) *= max_count / count;
+            dr::masked(count, clamp) = max_count;
+        }
+
+        void schedule() const {
+            dr::schedule(sample, weight_sum, count, target);
+        }
+    };
+
+    ReSTIRIntegrator(const Properties &props) : Base(props) {
+        if constexpr (!dr::is_jit_v<Float>)
+            Throw("The ReSTIR integrator is only available in JIT variants!");
+
+        m_candidates = props.get<uint32_t>("candidates", 32);
+        m_temporal = props.get<bool>("temporal", true);
+        m_max_history = props.get<ScalarFloat>("max_history", 20.f);
+        m_spatial_samples = props.get<uint32_t>("spatial_samples", 5);
+        m_spatial_radius = props.get<ScalarFloat>("spatial_radius", 30.f);
+
+        if (m_candidates == 0)
+            Throw("The 'candidates' parameter must be positive!");
+        if (!(m_max_history >= 1.f))
+            Throw("The 'max_history' parameter must be at least 1!");
+        if (!(m_spatial_radius >= 0.f))
+            Throw("The 'spatial_radius' parameter must be non-negative!");
+    }
+
+    using Base::render;
+
+    TensorXf render(Scene *scene, Sensor *sensor, uint32_t seed = 0,
+                    uint32_t spp = 0, bool develop = true,
+                    bool evaluate = true) override {
+        if constexpr (!dr::is_jit_v<Float>) {
+            DRJIT_MARK_USED(scene); DRJIT_MARK_USED(sensor);
+            DRJIT_MARK_USED(seed); DRJIT_MARK_USED(spp);
+            DRJIT_MARK_USED(develop); DRJIT_MARK_USED(evaluate);
+            Throw("The ReSTIR integrator is only available in JIT variants!");
+        } else {
+            ScopedPhase sp(ProfilerPhase::Render);
+            m_stop = false;
+
+            Film *film = sensor->film();
+            ScalarVector2u film_size = film->crop_size();
+            uint32_t pixel_count = dr::prod(film_size);
+
+            Sampler *sampler = sensor->sampler();
+            if (spp)
+                sampler->set_sample_count(spp);
+            spp = sampler->sample_count();
+
+            size_t n_channels = film->prepare(aov_names());
+            m_render_timer.reset();
+
+            Log(Info, "Starting render job (%ux%u, %u pass%s)", film_size.x(),
+                film_size.y(), spp, spp == 1 ? "" : "es");
+
+            // The reservoirs of another sensor or image cannot be reused
+            if (!m_temporal || m_history_sensor != sensor ||
+                m_history_size != film_size)
+                m_history_valid = false;
+
+            // Every pass consumes one sample of every pixel
+            sampler->set_samples_per_wavefront(1);
+            sampler->seed(dr::sample_tea_32(seed, m_frame_index).first,
+                          pixel_count);
+
+            ref<ImageBlock> block = film->create_block();
+            block->set_offset(film->crop_offset());
+
+            UInt32 idx = dr::arange<UInt32>(pixel_count);
+            Vector2u pos;
+            pos.y() = idx / film_size[0];
+            pos.x() = dr::fnmadd(film_size[0], pos.y(), idx);
+
+            std::unique_ptr<Float[]> aovs(new Float[n_channels]);
+
+            for (uint32_t pass = 0; pass < spp && !should_stop(); ++pass) {
+                render_pass(scene, sensor, sampler, block, aovs.get(), idx, pos,
+                            dr::rsqrt((ScalarFloat) spp));
+                m_frame_index++;
+
+                sampler->advance();
+                sampler->schedule_state();
+
+                if (m_pass_callback) {
+                    film->put_block(block);
+                    block->clear();
+                    film->schedule_storage();
+                    dr::eval();
+                    if (!should_stop() && !m_pass_callback(pass + 1, spp))
+                        m_stop = true;
+                } else {
+                    dr::eval(block->tensor());
+                }
+            }
+
+            if (!m_pass_callback)
+                film->put_block(block);
+
+            TensorXf result;
+            if (develop) {
+                result = film->develop();
+                dr::schedule(result);
+            } else {
+                film->schedule_storage();
+            }
+
+            if (evaluate) {
+                dr::eval();
+                dr::sync_thread();
+            }
+
+            if (!m_stop)
+                Log(Info, "Rendering finished. (took %s)",
+                    util::time_string((float) m_render_timer.value(), true));
+
+            return result;
+        }
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "ReSTIRIntegrator[" << std::endl
+            << "  candidates = " << m_candidates << "," << std::endl
+            << "  temporal = " << m_temporal << "," << std::endl
+            << "  max_history = " << m_max_history << "," << std::endl
+            << "  spatial_samples = " << m_spatial_samples << "," << std::endl
+            << "  spatial_radius = " << m_spatial_radius << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+protected:
+    /// Render one pass that takes a single sample of every pixel
+    void render_pass(const Scene *scene, const Sensor *sensor,
+                     Sampler *sampler, ImageBlock *block, Float *aovs,
+                     const UInt32 &idx, const Vector2u &pos,
+                     ScalarFloat diff_scale_factor) {
+        const Film *film = sensor->film();
+        const bool has_alpha = has_flag(film->flags(), FilmFlags::Alpha);
+        const bool box_filter = film->rfilter()->is_box_filter();
+        ScalarVector2u film_size = film->crop_size();
+
+        // ----------------------- Primary rays -----------------------
+
+        Point2f jitter = sampler->next_2d();
+        Vector2f pixel_pos = Vector2f(pos) + ScalarVector2f(film->crop_offset()),
+                 sample_pos = pixel_pos + jitter,
+                 adjusted_pos = (Vector2f(pos) + jitter) / ScalarVector2f(film_size);
+
+        Point2f aperture_sample(.5f);
+        if (sensor->needs_aperture_sample())
+            aperture_sample = sampler->next_2d();
+
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += sampler->next_1d() * sensor->shutter_open_time();
+
+        Float wavelength_sample = 0.f;
+        if constexpr (is_spectral_v<Spectrum>)
+            wavelength_sample = sampler->next_1d();
+
+        auto [ray, ray_weight] = sensor->sample_ray_differential(
+            time, wavelength_sample, adjusted_pos, aperture_sample);
+
+        if (ray.has_differentials)
+            ray.scale_differential(diff_scale_factor);
+
+        SurfaceInteraction3f si =
+            scene->ray_intersect(ray, +RayFlags::All, /* coherent = */ true);
+        Mask valid_ray = si.is_valid();
+
+        Spectrum result(0.f);
+        if (!m_hide_emitters) {
+            EmitterPtr emitter_vis = si.emitter(scene);
+            result += emitter_vis->eval(si);
+        }
+
+        BSDFPtr bsdf = si.bsdf(ray);
+        Mask active = valid_ray && has_flag(bsdf->flags(), BSDFFlags::Smooth);
+
+        // Geometry used to decide whether reservoirs may be combined
+        Normal3f normal = dr::select(active, si.sh_frame.n, Normal3f(0.f));
+        Float depth = dr::select(active, si.t, dr::Infinity<Float>);
+
+        // ------------------ Resampling of candidates ------------------
+
+        Reservoir reservoir = sample_candidates(scene, sampler, si, bsdf, active);
+
+        // Discard the selected candidate when it is occluded
+        Mask test = active && reservoir.target > 0.f;
+        Mask occluded =
+            scene->ray_test(si.spawn_ray_to(reservoir.sample.p), test);
+        dr::masked(reservoir.weight_sum, occluded) = 0.f;
+
+        // ----------------------- Temporal reuse -----------------------
+
+        if (m_history_valid) {
+            Mask similar = active && is_similar(normal, depth, m_history_normal,
+                                                m_history_depth);
+            combine(scene, sampler, si, bsdf, reservoir, m_history, similar);
+        }
+
+        // ----------------------- Spatial reuse ------------------------
+
+        if (m_spatial_samples > 0) {
+            // The neighbors read the reservoirs before spatial reuse
+            reservoir.schedule();
+            dr::eval(normal, depth);
+
+            Reservoir input = reservoir;
+            ScalarVector2f max_pos = ScalarVector2f(film_size) - 1.f;
+
+            for (uint32_t i = 0; i < m_spatial_samples; ++i) {
+                Vector2f offset = warp::square_to_uniform_disk_concentric(
+                                      sampler->next_2d(active)) * m_spatial_radius,
+                         p = dr::clamp(Vector2f(pos) + .5f + offset,
+                                       ScalarVector2f(0.f), max_pos);
+                UInt32 neighbor = dr::fmadd(UInt32(p.y()), film_size.x(),
+                                            UInt32(p.x()));
+
+                Mask similar =
+                    active && dr::neq(neighbor, idx) &&
+                    is_similar(normal, depth,
+                               dr::gather<Normal3f>(normal, neighbor, active),
+                               dr::gather<Float>(depth, neighbor, active));
+
+                combine(scene, sampler, si, bsdf, reservoir,
+                        gather(input, neighbor, similar), similar);
+            }
+        }
+
+        // -------------------------- Shading ---------------------------
+
+        DirectionSample3f ds = reservoir.sample;
+        Float weight = reservoir.contribution_weight();
+        Mask shade = active && weight > 0.f;
+
+        auto [value, target, geometry] = eval_target(scene, si, bsdf, ds, shade);
+        DRJIT_MARK_USED(target);
+        DRJIT_MARK_USED(geometry);
+
+        shade &= !scene->ray_test(si.spawn_ray_to(ds.p), shade);
+        result[shade] += value * weight;
+
+        if (m_temporal) {
+            reservoir.clamp(m_max_history * (ScalarFloat) m_candidates);
+            m_history = reservoir;
+            m_history_normal = normal;
+            m_history_depth = depth;
+            m_history.schedule();
+            dr::schedule(m_history_normal, m_history_depth);
+
+            m_history_sensor = sensor;
+            m_history_size = film_size;
+            m_history_valid = true;
+        }
+
+        // ------------------------ Film update -------------------------
+
+        UnpolarizedSpectrum spec_u = unpolarized_spectrum(ray_weight * result);
+
+        if (unlikely(has_flag(film->flags(), FilmFlags::Special))) {
+            film->prepare_sample(spec_u, ray.wavelengths, aovs,
+                                 /*weight*/ 1.f,
+                                 /*alpha */ dr::select(valid_ray, Float(1.f), Float(0.f)),
+                                 true);
+        } else {
+            Color3f rgb;
+            if constexpr (is_spectral_v<Spectrum>)
+                rgb = spectrum_to_srgb(spec_u, ray.wavelengths);
+            else if constexpr (is_monochromatic_v<Spectrum>)
+                rgb = spec_u.x();
+            else
+                rgb = spec_u;
+
+            aovs[0] = rgb.x();
+            aovs[1] = rgb.y();
+            aovs[2] = rgb.z();
+
+            if (likely(has_alpha)) {
+                aovs[3] = dr::select(valid_ray, Float(1.f), Float(0.f));
+                aovs[4] = 1.f;
+            } else {
+                aovs[3] = 1.f;
+            }
+        }
+
+        // With box filter, ignore random offset to prevent numerical instabilities
+        block->put(box_filter ? pixel_pos : sample_pos, aovs);
+    }
+
+    /// Stream the emitter samples of a pixel through a new reservoir
+    Reservoir sample_candidates(const Scene *scene, Sampler *sampler,
+                                const SurfaceInteraction3f &si,
+                                const BSDFPtr &bsdf, Mask active) const {
+        Reservoir r;
+        UInt32 i = 0;
+
+        dr::Loop<Mask> loop("ReSTIR candidates", sampler, i, r.sample,
+                            r.weight_sum, r.count, r.target, active);
+
+        while (loop(active)) {
+            auto [ds, emitter_weight] = scene->sample_emitter_direction(
+                si, sampler->next_2d(active), false, active);
+            DRJIT_MARK_USED(emitter_weight);
+
+            Mask valid = active && dr::neq(ds.pdf, 0.f);
+            auto [value, target, geometry] = eval_target(scene, si, bsdf, ds, valid);
+            DRJIT_MARK_USED(value);
+
+            // Ratio of the target function and the (area) density of the sample
+            Float weight = target / (ds.pdf * geometry);
+            weight = dr::select(valid && dr::isfinite(weight), weight, 0.f);
+
+            r.update(ds, weight, target, 1.f, sampler->next_1d(active), active);
+
+            i++;
+            active &= i < m_candidates;
+        }
+
+        return r;
+    }
+
+    /// Resample the light sample of the reservoir 'other' into 'r'
+    void combine(const Scene *scene, Sampler *sampler,
+                 const SurfaceInteraction3f &si, const BSDFPtr &bsdf,
+                 Reservoir &r, const Reservoir &other, Mask active) const {
+        DirectionSample3f ds = other.sample;
+        active &= other.count > 0.f;
+
+        auto [value, target, geometry] = eval_target(scene, si, bsdf, ds, active);
+        DRJIT_MARK_USED(value);
+        DRJIT_MARK_USED(geometry);
+
+        Float weight = target * other.contribution_weight() * other.count;
+        r.update(ds, weight, target, other.count, sampler->next_1d(active),
+                 active);
+    }
+
+    /**
+     * \brief Point a light sample towards the shading point 'si' and evaluate
+     * its unshadowed contribution
+     *
+     * Light samples are reused in the area measure of the emitter, or in the
+     * solid angle measure for infinite emitters. Besides the contribution and
+     * its scalar target function, the function returns the geometric term
+     * that converts solid angle densities into this measure.
+     */
+    std::tuple<Spectrum, Float, Float>
+    eval_target(const Scene *scene, const SurfaceInteraction3f &si,
+                const BSDFPtr &bsdf, DirectionSample3f &ds, Mask active) const {
+        Mask infinite =
+            has_flag(ds.emitter->flags(active), EmitterFlags::Infinite);
+
+        Vector3f d = ds.p - si.p;
+        Float dist = dr::norm(d);
+        dr::masked(ds.d, !infinite) = d / dist;
+        dr::masked(ds.dist, !infinite) = dist;
+        dr::masked(ds.p, infinite) = dr::fmadd(ds.d, ds.dist, si.p);
+
+        Float geometry = dr::select(
+            infinite || ds.delta, 1.f, dr::abs_dot(ds.n, ds.d) / dr::sqr(ds.dist));
+
+        BSDFContext ctx;
+        Vector3f wo = si.to_local(ds.d);
+        Spectrum bsdf_val = bsdf->eval(ctx, si, wo, active);
+        bsdf_val = si.to_world_mueller(bsdf_val, -wo, si.wi);
+
+        Spectrum value =
+            bsdf_val * scene->eval_emitter_direction(si, ds, active) * geometry;
+
+        Float target = dr::mean(unpolarized_spectrum(value));
+        target = dr::select(active && dr::isfinite(target), target, 0.f);
+
+        return { value, target, geometry };
+    }
+
+    /// Gather the reservoirs of the given pixels
+    static Reservoir gather(const Reservoir &r, const UInt32 &index, Mask active) {
+        Reservoir result;
+        result.sample = dr::gather<DirectionSample3f>(r.sample, index, active);
+        result.weight_sum = dr::gather<Float>(r.weight_sum, index, active);
+        result.count = dr::gather<Float>(r.count, index, active);
+        result.target = dr::gather<Float>(r.target, index, active);
+        return result;
+    }
+
+    /// Check whether the surfaces seen by two pixels are similar enough for reuse
+    static Mask is_similar(const Normal3f &n1, const Float &depth1,
+                           const Normal3f &n2, const Float &depth2) {
+        return dr::dot(n1, n2) >= 0.9f &&
+               dr::abs(depth1 - depth2) <= 0.1f * depth1;
+    }
+
+private:
+    uint32_t m_candidates;
+    bool m_temporal;
+    ScalarFloat m_max_history;
+    uint32_t m_spatial_samples;
+    ScalarFloat m_spatial_radius;
+
+    /// Reservoirs and geometry of the previous pass
+    Reservoir m_history;
+    Normal3f m_history_normal;
+    Float m_history_depth;
+    const Sensor *m_history_sensor = nullptr;
+    ScalarVector2u m_history_size = 0;
+    bool m_history_valid = false;
+
+    /// Number of rendered passes, used to decorrelate subsequent renderings
+    uint32_t m_frame_index = 0;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(ReSTIRIntegrator, SamplingIntegrator)
+MI_EXPORT_PLUGIN(ReSTIRIntegrator, "ReSTIR direct illumination integrator");
+NAMESPACE_END(mitsuba)
@@ -952,6 +952,60 @@ def test04_render_custom_op(variants_all_ad_rgb):
         mi.util.write_bitmap(filename, error)
         assert False
 
+
+def test05_backward_blocks(variants_all_ad_rgb):
+    integrator = mi.load_dict({ 'type': 'prb', 'backward_budget': 1000 })
+
+    # Small problems are differentiated in a single wavefront
+    blocks, passes = integrator.backward_blocks(mi.ScalarVector2u(10, 10), 8)
+    assert len(blocks) == 1 and passes == 1
+
+    # The blocks partition the crop window and respect the budget
+    blocks, passes = integrator.backward_blocks(mi.ScalarVector2u(50, 30), 16)
+    assert passes == 1
+    assert sum(dr.prod(size) for _, size in blocks) == 50 * 30
+    assert all(dr.prod(size) * 16 <= 1000 for _, size in blocks)
+
+    # A single pixel exceeding the budget splits its samples into passes
+    blocks, passes = integrator.backward_blocks(mi.ScalarVector2u(4, 3), 4096)
+    assert passes == 8 and len(blocks) == 12
+
+
+@pytest.mark.slow
+@pytest.mark.skipif(os.name == 'nt', reason='Skip those memory heavy tests on Windows')
+def test06_rendering_backward_blocks(variants_all_ad_rgb):
+    config = DiffuseAlbedoConfig()
+    config.initialize()
+
+    integrator = mi.load_dict({
+        'type': 'prb',
+        'max_depth': config.integrator_dict['max_depth'],
+        'backward_budget': 64 * config.spp
+    })
+
+    filename = join(output_dir, f"test_{config.name}_image_fwd_ref.exr")
+    image_fwd_ref = mi.TensorXf(mi.Bitmap(filename))
+
+    image_adj = mi.TensorXf(1.0, image_fwd_ref.shape)
+
+    theta = mi.Float(0.0)
+    dr.enable_grad(theta)
+    config.update(theta)
+
+    # The blocked backward pass accumulates into the same parameter gradient
+    integrator.render_backward(config.scene, grad_in=image_adj, seed=0,
+                               spp=config.spp, params=theta)
+
+    grad = dr.grad(theta)[0] / dr.width(image_fwd_ref)
+    grad_ref = dr.mean(image_fwd_ref)[0]
+
+    error = dr.abs(grad - grad_ref) / dr.maximum(dr.abs(grad_ref), 1e-3)
+    assert error < config.error_mean_threshold_bwd
+
+    # The crop window of the film is restored afterwards
+    film = config.scene.sensors()[0].film()
+    assert dr.all(film.crop_size() == film.size())
+
 # -------------------------------------------------------------------
 #                      Generate reference images
 # -------------------------------------------------------------------
@@ -1013,3 +1067,38 @@ if __name__ == "__main__":
 
         filename = join(output_dir, f"test_{config.name}_image_fwd_ref.exr")
         mi.util.write_bitmap(filename, image_fd)
+
+
+def test07_grad_enabled(variants_all_ad_rgb):
+    from mitsuba.ad.integrators.common import GradEnabled
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'sphere': {
+            'type': 'sphere',
+            'bsdf': {
+                'type': 'diffuse',
+                'reflectance': { 'type': 'rgb', 'value': [0.5, 0.5, 0.5] }
+            }
+        },
+        'light': { 'type': 'point', 'position': [0, 0, 5] }
+    })
+    params = mi.traverse(scene)
+
+    # Nothing is differentiable by default
+    assert not GradEnabled.from_params(scene, params).any()
+
+    # Parameters of nested objects are attributed to the enclosing BSDF
+    dr.enable_grad(params['sphere.bsdf.reflectance.value'])
+    grad_enabled = GradEnabled.from_params(scene, params)
+    assert grad_enabled.bsdfs
+    assert not (grad_enabled.shapes or grad_enabled.emitters)
+
+    dr.enable_grad(params['light.intensity.value'])
+    grad_enabled = GradEnabled.from_params(scene, params)
+    assert grad_enabled.bsdfs and grad_enabled.emitters
+    assert not grad_enabled.shapes
+
+    # Arbitrary parameter containers conservatively enable everything
+    grad_enabled = GradEnabled.from_params(scene, None)
+    assert grad_enabled.shapes and grad_enabled.bsdfs and grad_enabled.sensors
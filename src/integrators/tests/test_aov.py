@@ -0,0 +1,43 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def create_scene(integrator, spp=16):
+    return mi.load_dict({
+        'type': 'scene',
+        'integrator': integrator,
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(origin=[0, 0, 4],
+                                                     target=[0, 0, 0],
+                                                     up=[0, 1, 0]),
+            'film': {'type': 'hdrfilm', 'width': 16, 'height': 16,
+                     'rfilter': {'type': 'box'}},
+            'sampler': {'type': 'independent', 'sample_count': spp},
+        },
+        'sphere': {'type': 'sphere', 'bsdf': {'type': 'diffuse'}},
+        'light': {'type': 'constant'},
+    })
+
+
+def test01_construct(variants_all_rgb):
+    integrator = mi.load_dict({'type': 'aov', 'aovs': 'dd:depth,nn:sh_normal',
+                               'aov_spp': 4})
+    assert integrator.aov_names() == ['dd.T', 'dd.W', 'nn.X', 'nn.Y', 'nn.Z', 'nn.W']
+    assert 'aov_spp = 4' in str(integrator)
+
+    integrator = mi.load_dict({'type': 'aov', 'aovs': 'dd:depth'})
+    assert integrator.aov_names() == ['dd.T']
+
+
+def test02_aov_spp(variants_all_rgb):
+    # AOVs evaluated at a lower sample rate keep the pixel averages
+    integrator = {'type': 'aov', 'aovs': 'dd:depth,pos:position',
+                  'image': {'type': 'direct'}}
+    full = mi.render(create_scene(integrator))
+    reduced = mi.render(create_scene(dict(integrator, aov_spp=4)))
+    assert full.shape == reduced.shape
+
+    # Depth and position of the sphere barely vary within a pixel
+    assert dr.allclose(dr.mean(full.array), dr.mean(reduced.array), rtol=5e-2)
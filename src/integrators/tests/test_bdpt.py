@@ -0,0 +1,36 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from .utils import create_scene, check_converges
+
+
+def test01_construct(variant_scalar_rgb):
+    integrator = mi.load_dict({'type': 'bdpt'})
+    assert 'max_depth = 8' in str(integrator)
+
+    with pytest.raises(RuntimeError, match='max_depth'):
+        mi.load_dict({'type': 'bdpt', 'max_depth': -1})
+
+
+def compare_path():
+    # Both estimators are unbiased
+    check_converges({'type': 'bdpt', 'max_depth': 4},
+                    {'type': 'path', 'max_depth': 4}, spp=16, ref_spp=64)
+
+
+@pytest.mark.slow
+def test02_compare_path_scalar(variant_scalar_rgb):
+    compare_path()
+
+
+@pytest.mark.slow
+def test03_compare_path_vec(variants_vec_backends_once_rgb):
+    compare_path()
+
+
+def test04_direct_only(variant_scalar_rgb):
+    # The emitter faces away from the sensor, so nothing is directly visible
+    scene = create_scene({'type': 'bdpt', 'max_depth': 1}, spp=4)
+    img = mi.render(scene)
+    assert dr.all(dr.eq(img.array, 0))
@@ -0,0 +1,43 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from .utils import create_scene, check_converges
+
+
+def test01_construct(variant_scalar_rgb):
+    integrator = mi.load_dict({'type': 'irrcache', 'record_count': 100,
+                               'irradiance_samples': 64})
+    assert 'record_count = 100' in str(integrator)
+    assert 'irradiance_samples = 4 x 14' in str(integrator)
+
+    with pytest.raises(RuntimeError, match='irradiance_samples'):
+        mi.load_dict({'type': 'irrcache', 'irradiance_samples': 2})
+
+    with pytest.raises(RuntimeError, match='min_radius'):
+        mi.load_dict({'type': 'irrcache', 'min_radius': 2, 'max_radius': 1})
+
+
+def test02_fallback(variant_scalar_rgb):
+    # Without diffuse surfaces, there are no records and every ray is path traced
+    conductor = {'type': 'roughconductor', 'alpha': 0.3}
+    ref = mi.render(create_scene({'type': 'path'}, spp=4, res=16, bsdf=conductor))
+    img = mi.render(create_scene({'type': 'irrcache'}, spp=4, res=16, bsdf=conductor))
+    assert dr.allclose(ref, img)
+
+
+def compare_path():
+    # The interpolated indirect illumination matches the path traced solution
+    check_converges({'type': 'irrcache', 'max_depth': 4, 'record_count': 256},
+                    {'type': 'path', 'max_depth': 4}, spp=8, ref_spp=64,
+                    rtol=5e-2, res=16)
+
+
+@pytest.mark.slow
+def test03_compare_path_scalar(variant_scalar_rgb):
+    compare_path()
+
+
+@pytest.mark.slow
+def test04_compare_path_vec(variants_vec_backends_once_rgb):
+    compare_path()
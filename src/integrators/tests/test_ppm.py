@@ -0,0 +1,43 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from .utils import create_scene, check_converges
+
+
+def test01_construct(variant_scalar_rgb):
+    integrator = mi.load_dict({'type': 'ppm', 'photon_count': 1000, 'alpha': 0.5})
+    assert 'photon_count = 1000' in str(integrator)
+
+    with pytest.raises(RuntimeError, match='alpha'):
+        mi.load_dict({'type': 'ppm', 'alpha': 1.5})
+
+    with pytest.raises(RuntimeError, match='photon_count'):
+        mi.load_dict({'type': 'ppm', 'photon_count': 0})
+
+
+def compare_path():
+    # The density estimate converges to the path traced solution
+    check_converges({'type': 'ppm', 'max_depth': 3, 'photon_count': 100000,
+                     'initial_radius': 0.05},
+                    {'type': 'path', 'max_depth': 3}, spp=8, ref_spp=64,
+                    rtol=5e-2)
+
+
+@pytest.mark.slow
+def test02_compare_path_scalar(variant_scalar_rgb):
+    compare_path()
+
+
+@pytest.mark.slow
+def test03_compare_path_vec(variants_vec_backends_once_rgb):
+    compare_path()
+
+
+def test04_film_contents(variant_scalar_rgb):
+    # Passes are accumulated into the film, even when it isn't developed
+    scene = create_scene({'type': 'ppm', 'photon_count': 2000}, spp=4)
+    sensor = scene.sensors()[0]
+    img = mi.render(scene)
+    assert dr.allclose(dr.mean(sensor.film().develop().array), dr.mean(img.array))
+    assert sensor.sampler().sample_count() == 4
@@ -0,0 +1,82 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from .utils import create_scene, check_converges
+
+
+def create_lights(light_count=4):
+    # Small emitters of varying brightness above the floor
+    lights = {}
+    for i in range(light_count):
+        x = -0.75 + 1.5 * i / max(light_count - 1, 1)
+        lights[f'light_{i}'] = {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([x, 0.3 * (i % 2), 0.5]) @
+                        mi.ScalarTransform4f.scale(0.05) @
+                        mi.ScalarTransform4f.rotate([1, 0, 0], 180),
+            'emitter': {'type': 'area', 'radiance': 10 * (i + 1)},
+        }
+    return lights
+
+
+def create_restir_scene(integrator, spp=4, light_count=4):
+    return create_scene(integrator, spp=spp, res=32,
+                        lights=create_lights(light_count))
+
+
+def test01_construct(variants_vec_backends_once_rgb):
+    integrator = mi.load_dict({'type': 'restir', 'candidates': 8,
+                               'spatial_samples': 3})
+    assert 'candidates = 8' in str(integrator)
+    assert 'spatial_samples = 3' in str(integrator)
+
+    with pytest.raises(RuntimeError, match='candidates'):
+        mi.load_dict({'type': 'restir', 'candidates': 0})
+
+    with pytest.raises(RuntimeError, match='max_history'):
+        mi.load_dict({'type': 'restir', 'max_history': 0.5})
+
+
+def test02_scalar(variant_scalar_rgb):
+    with pytest.raises(RuntimeError, match='JIT variants'):
+        mi.load_dict({'type': 'restir'})
+
+
+DIRECT = {'type': 'direct', 'emitter_samples': 4, 'bsdf_samples': 0}
+
+
+def render_direct(spp, light_count=4):
+    return mi.render(create_restir_scene(DIRECT, spp=spp, light_count=light_count))
+
+
+def test03_compare_direct(variants_vec_backends_once_rgb):
+    # The resampled direct illumination matches the direct integrator, up to
+    # the bias of the 1/M weights
+    check_converges({'type': 'restir'}, DIRECT, spp=4, ref_spp=16, rtol=5e-2,
+                    block=8, res=32, lights=create_lights())
+
+
+@pytest.mark.slow
+def test04_reuse(variants_vec_backends_once_rgb):
+    # Spatiotemporal reuse reduces the error compared to plain resampling
+    ref = render_direct(spp=512, light_count=16)
+
+    def error(integrator):
+        img = mi.render(create_restir_scene(integrator, spp=4, light_count=16))
+        return dr.mean(dr.abs(img.array - ref.array))[0]
+
+    plain = error({'type': 'restir', 'temporal': False, 'spatial_samples': 0})
+    reuse = error({'type': 'restir'})
+    assert reuse < plain
+
+
+def test05_history(variants_vec_backends_once_rgb):
+    # Subsequent calls with the same sensor continue from the previous reservoirs
+    scene = create_restir_scene({'type': 'restir', 'spatial_samples': 0}, spp=1)
+    first = mi.render(scene, seed=0)
+    second = mi.render(scene, seed=0)
+    assert not dr.allclose(first, second)
+
+    ref = render_direct(spp=256)
+    assert dr.allclose(dr.mean(second.array), dr.mean(ref.array), rtol=0.1)
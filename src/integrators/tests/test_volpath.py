@@ -0,0 +1,123 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+
+
+def create_fog_scene(estimator, medium, integrator='volpath'):
+    # A cube filled with a thin medium in front of a point light
+    integrator = {'type': integrator, 'max_depth': 2}
+    if estimator is not None:
+        integrator['transmittance_estimator'] = estimator
+
+    return mi.load_dict({
+        'type': 'scene',
+        'integrator': integrator,
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=(0, 0, 4), target=(0, 0, 0), up=(0, 1, 0)),
+            'sampler': {'type': 'independent'},
+            'film': {
+                'type': 'hdrfilm',
+                'width': 16, 'height': 16,
+                'rfilter': {'type': 'box'}
+            },
+        },
+        'cube': {
+            'type': 'cube',
+            'bsdf': {'type': 'null'},
+            'interior': medium,
+        },
+        'light': {
+            'type': 'point',
+            'position': (0.0, 3.0, 0.0),
+            'intensity': {'type': 'rgb', 'value': 10.0},
+        },
+    })
+
+
+def test01_invalid_estimator(variant_scalar_rgb):
+    with pytest.raises(Exception, match='transmittance estimator'):
+        create_fog_scene('delta_tracking', {'type': 'homogeneous'})
+
+
+@pytest.mark.parametrize('heterogeneous', [False, True])
+def test02_residual_ratio_tracking(variants_vec_rgb, heterogeneous):
+    if heterogeneous:
+        grid = np.full((8, 8, 8, 1), 0.4, dtype=np.float32)
+        grid[2:5, 3:6, 1:4] = 2.0
+        medium = {
+            'type': 'heterogeneous',
+            'albedo': 0.8,
+            'sigma_t': {
+                'type': 'gridvolume',
+                'data': mi.VolumeGrid(grid),
+                'to_world': mi.ScalarTransform4f.translate(-1).scale(2),
+            },
+            'control_density': 0.4,
+        }
+    else:
+        medium = {'type': 'homogeneous', 'albedo': 0.8, 'sigma_t': 0.5}
+
+    images = []
+    for estimator in ['ratio_tracking', 'residual_ratio_tracking']:
+        scene = create_fog_scene(estimator, medium)
+        images.append(np.array(mi.render(scene, spp=256, seed=1)))
+
+    assert np.mean(images[0]) > 0
+    assert np.allclose(np.mean(images[0]), np.mean(images[1]), rtol=2e-2)
+
+
+def test03_statistics(variant_scalar_rgb):
+    scene = create_fog_scene('ratio_tracking', {
+        'type': 'homogeneous',
+        'sigma_t': 1.0,
+        'albedo': 0.8
+    })
+    scene.reset_statistics()
+    mi.render(scene)
+    stats = scene.statistics()
+
+    if not mi.MI_ENABLE_STATISTICS:
+        assert sum(stats['path_lengths']) == 0
+        return
+
+    # Every path records its length, including the ones that escape
+    spp = scene.sensors()[0].sampler().sample_count()
+    assert sum(stats['path_lengths']) == 16 * 16 * spp
+
+    events = stats['events']
+    assert events['medium_interactions'] > 0
+    assert events['emitter_samples'] > 0
+
+    # Shadow rays evaluate the transmittance of homogeneous media in closed
+    # form, and distance sampling never yields null collisions in them
+    assert events['null_collisions'] == 0
+
+
+@pytest.mark.parametrize('integrator', ['volpath', 'volpathmis'])
+def test04_homogeneous_transmittance(variants_vec_rgb, integrator):
+    # Equivalent media, whose shadow rays are estimated in closed form
+    # (homogeneous) and by ratio tracking (heterogeneous) respectively
+    grid = np.full((2, 2, 2, 1), 0.5, dtype=np.float32)
+    media = [
+        {'type': 'homogeneous', 'albedo': 0.8, 'sigma_t': 0.5},
+        {
+            'type': 'heterogeneous',
+            'albedo': 0.8,
+            'sigma_t': {
+                'type': 'gridvolume',
+                'data': mi.VolumeGrid(grid),
+                'to_world': mi.ScalarTransform4f.translate(-1).scale(2),
+            },
+        }
+    ]
+
+    images = []
+    for medium in media:
+        scene = create_fog_scene(None, medium, integrator)
+        images.append(np.array(mi.render(scene, spp=256, seed=1)))
+
+    assert np.mean(images[0]) > 0
+    assert np.allclose(np.mean(images[0]), np.mean(images[1]), rtol=2e-2)
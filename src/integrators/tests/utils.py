@@ -0,0 +1,83 @@
+import mitsuba as mi
+import numpy as np
+
+
+def create_scene(integrator, spp=64, res=8, bsdf=None, lights=None):
+    """
+    Create a diffuse floor that is lit by a rectangular emitter facing it and
+    seen from above. The emitter faces away from the sensor, so the image only
+    contains light that was reflected at least once.
+
+    Parameter ``bsdf`` replaces the material of the floor and the emitter, and
+    parameter ``lights`` replaces the emitter by a dictionary of other shapes.
+    """
+    scene = {
+        'type': 'scene',
+        'integrator': integrator,
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(origin=[0, 0, 3],
+                                                     target=[0, 0, 0],
+                                                     up=[0, 1, 0]),
+            'film': {'type': 'hdrfilm', 'width': res, 'height': res,
+                     'rfilter': {'type': 'box'}},
+            'sampler': {'type': 'independent', 'sample_count': spp},
+        },
+        'floor': {
+            'type': 'rectangle',
+            'bsdf': bsdf or {'type': 'diffuse'},
+        },
+    }
+
+    if lights is None:
+        lights = {
+            'light': {
+                'type': 'rectangle',
+                'to_world': mi.ScalarTransform4f.translate([0, 0, 1]) @
+                            mi.ScalarTransform4f.scale(0.5) @
+                            mi.ScalarTransform4f.rotate([1, 0, 0], 180),
+                'emitter': {'type': 'area', 'radiance': 1},
+            }
+        }
+        if bsdf is not None:
+            lights['light']['bsdf'] = bsdf
+
+    scene.update(lights)
+    return mi.load_dict(scene)
+
+
+def render_statistics(integrator, passes=16, block=4, seed=0, **kwargs):
+    """
+    Render ``passes`` independent images of the scene returned by
+    ``create_scene()`` and return the mean of every ``block x block`` region of
+    pixels, along with the variance of this mean estimated from the spread of
+    the passes. The scene is created again for every pass, so that integrators
+    which reuse information across calls to ``mi.render()`` stay independent.
+    """
+    values = []
+    for i in range(passes):
+        img = np.array(mi.render(create_scene(integrator, **kwargs), seed=seed + i))
+        h, w, c = img.shape
+        img = img.reshape(h // block, block, w // block, block, c)
+        values.append(img.mean(axis=(1, 3)))
+
+    values = np.stack(values)
+    return values.mean(axis=0), values.var(axis=0, ddof=1) / passes
+
+
+def check_converges(integrator, reference, spp, ref_spp, rtol=0, z=5,
+                    passes=16, block=4, **kwargs):
+    """
+    Check that every region of the images rendered by ``integrator`` matches
+    the one rendered by ``reference`` up to ``z`` standard deviations of their
+    difference. The relative tolerance ``rtol`` additionally accounts for the
+    bias of consistent estimators (e.g. density estimation or interpolation).
+    """
+    mean, var = render_statistics(integrator, passes, block, spp=spp, **kwargs)
+    mean_ref, var_ref = render_statistics(reference, passes, block, seed=passes,
+                                          spp=ref_spp, **kwargs)
+
+    tol = z * np.sqrt(var + var_ref) + rtol * np.abs(mean_ref) + 1e-4
+    err = np.abs(mean - mean_ref)
+    assert np.all(err <= tol), \
+        f'Regions differ from the reference:\n{mean}\nvs\n{mean_ref}\n(tolerance:\n{tol})'
@@ -36,6 +36,11 @@ Volumetric path tracer (:monosp:`volpath`)
    - |bool|
    - Hide directly visible emitters. (Default: no, i.e. |false|)
 
+ * - transmittance_estimator
+   - |string|
+   - Estimator of the transmittance along shadow rays, which is either :monosp:`ratio_tracking`
+     or :monosp:`residual_ratio_tracking`. See below for details. (Default: :monosp:`ratio_tracking`)
+
 This plugin provides a volumetric path tracer that can be used to compute approximate solutions
 of the radiative transfer equation. Its implementation makes use of multiple importance sampling
 to combine BSDF and phase function sampling with direct illumination sampling strategies. On
@@ -48,6 +53,20 @@ has a :ref:`null <bsdf-null>` or :ref:`thin dielectric <bsdf-thindielectric>` BS
 to it (as compared to, say, a :ref:`dielectric <bsdf-dielectric>` or
 :ref:`roughdielectric <bsdf-roughdielectric>` BSDF).
 
+The transmittance along shadow rays is estimated by stepping from one tentative collision to
+the next, which are distributed according to the majorant of the medium. Ratio tracking
+weights the transmittance by the probability of a null collision at every step. Residual ratio
+tracking additionally takes the control extinction of each medium (e.g. the
+:monosp:`control_density` of a :ref:`heterogeneous <medium-heterogeneous>` medium) into account
+analytically, so that tentative collisions only need to be sampled according to the residual
+majorant that remains. Homogeneous media never produce any collisions in this case. This
+considerably reduces the cost of shadow rays through large, optically thin media, such as fog.
+
+Emissive media (e.g. a :ref:`heterogeneous <medium-heterogeneous>` medium with a
+:monosp:`radiance` volume) contribute their emission at every tentative collision along the
+path. When their enclosing shape carries a :ref:`volume light <emitter-volumelight>`, the
+emission is instead estimated by next event estimation after scattering events.
+
 .. note:: This integrator does not implement good sampling strategies to render
     participating media with a spectrally varying extinction coefficient. For these cases,
     it is better to use the more advanced :ref:`volumetric path tracer with
@@ -73,11 +92,22 @@ template <typename Float, typename Spectrum>
 class VolumetricPathIntegrator : public MonteCarloIntegrator<Float, Spectrum> {
 
 public:
-    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters)
+    MI_IMPORT_BASE(MonteCarloIntegrator, m_max_depth, m_rr_depth, m_hide_emitters,
+                   record_path_length, record_event)
     MI_IMPORT_TYPES(Scene, Sampler, Emitter, EmitterPtr, BSDF, BSDFPtr,
                      Medium, MediumPtr, PhaseFunctionContext)
 
     VolumetricPathIntegrator(const Properties &props) : Base(props) {
+        std::string estimator =
+            props.string("transmittance_estimator", "ratio_tracking");
+        if (estimator == "ratio_tracking")
+            m_residual_tracking = false;
+        else if (estimator == "residual_ratio_tracking")
+            m_residual_tracking = true;
+        else
+            Throw("Invalid transmittance estimator \"%s\", must be one of: "
+                  "\"ratio_tracking\" or \"residual_ratio_tracking\"!",
+                  estimator);
     }
 
     MI_INLINE
@@ -144,7 +174,14 @@ public:
             active &= dr::any(dr::neq(unpolarized_spectrum(throughput), 0.f));
             Float q = dr::minimum(dr::max(unpolarized_spectrum(throughput)) * dr::sqr(eta), .95f);
             Mask perform_rr = (depth > (uint32_t) m_rr_depth);
-            active &= sampler->next_1d(active) < q || !perform_rr;
+            Mask rr_continue = sampler->next_1d(active) < q;
+#if defined(MI_ENABLE_STATISTICS)
+            if constexpr (!dr::is_jit_v<Float>) {
+                if (active && perform_rr && !rr_continue)
+                    record_event(MonteCarloEvent::RussianRoulette);
+            }
+#endif
+            active &= rr_continue || !perform_rr;
             dr::masked(throughput, perform_rr) *= dr::rcp(dr::detach(q));
 
             active &= depth < (uint32_t) m_max_depth;
@@ -184,6 +221,24 @@ public:
                 escaped_medium = active_medium && !mei.is_valid();
                 active_medium &= mei.is_valid();
 
+                /* Collision estimator of the emission of the medium: the
+                   throughput of spectral lanes already contains the inverse
+                   of the free-flight pdf, while the remaining lanes must be
+                   divided by the majorant. The emission is skipped when it
+                   was accounted for by sampling a volume light. */
+                Mask emissive = active_medium && medium->is_emitter() &&
+                                !(dr::eq(depth, 0u) && m_hide_emitters);
+                if (dr::any_or<true>(emissive)) {
+                    emissive &= dr::eq(medium->emitter(), nullptr) ||
+                                dr::eq(depth, 0u) || specular_chain;
+                    UnpolarizedSpectrum radiance =
+                        medium->get_radiance(mei, emissive) * (mei.sigma_t - mei.sigma_s);
+                    dr::masked(result, emissive && is_spectral) +=
+                        throughput * depolarizer<Spectrum>(radiance);
+                    dr::masked(result, emissive && not_spectral) +=
+                        throughput * depolarizer<Spectrum>(radiance / mei.combined_extinction);
+                }
+
                 // Handle null and real scatter events
                 Mask null_scatter = sampler->next_1d(active_medium) >= index_spectrum(mei.sigma_t, channel) / index_spectrum(mei.combined_extinction, channel);
 
@@ -197,6 +252,15 @@ public:
 
                 dr::masked(depth, act_medium_scatter) += 1;
                 dr::masked(last_scatter_event, act_medium_scatter) = mei;
+
+#if defined(MI_ENABLE_STATISTICS)
+                if constexpr (!dr::is_jit_v<Float>) {
+                    if (act_null_scatter)
+                        record_event(MonteCarloEvent::NullCollision);
+                    else if (act_medium_scatter)
+                        record_event(MonteCarloEvent::MediumInteraction);
+                }
+#endif
             }
 
             // Dont estimate lighting if we exceeded number of bounces
@@ -229,7 +293,7 @@ public:
                     auto [emitted, ds] = sample_emitter(mei, scene, sampler, medium, channel, active_e);
                     auto [phase_val, phase_pdf] = phase->eval_pdf(phase_ctx, mei, ds.d, active_e);
                     dr::masked(result, active_e) += throughput * phase_val * emitted *
-                                                    mis_weight(ds.pdf, dr::select(ds.delta, 0.f, phase_pdf));
+                                                    mis_weight(ds.pdf, dr::select(is_delta_or_volume(ds), 0.f, phase_pdf));
                 }
 
                 // ------------------ Phase function sampling -----------------
@@ -290,12 +354,20 @@ public:
                     // Determine probability of having sampled that same
                     // direction using BSDF sampling.
                     Float bsdf_pdf = bsdf->pdf(ctx, si, wo, active_e);
-                    result[active_e] += throughput * bsdf_val * mis_weight(ds.pdf, dr::select(ds.delta, 0.f, bsdf_pdf)) * emitted;
+#if defined(MI_ENABLE_STATISTICS)
+                    if constexpr (!dr::is_jit_v<Float>)
+                        bsdf->eval_counter().increment(2);
+#endif
+                    result[active_e] += throughput * bsdf_val * mis_weight(ds.pdf, dr::select(is_delta_or_volume(ds), 0.f, bsdf_pdf)) * emitted;
                 }
 
                 // ----------------------- BSDF sampling ----------------------
                 auto [bs, bsdf_val] = bsdf->sample(ctx, si, sampler->next_1d(active_surface),
                                                    sampler->next_2d(active_surface), active_surface);
+#if defined(MI_ENABLE_STATISTICS)
+                if constexpr (!dr::is_jit_v<Float>)
+                    bsdf->sample_counter().increment();
+#endif
                 bsdf_val = si.to_world_mueller(bsdf_val, -bs.wo, si.wi);
 
                 dr::masked(throughput, active_surface) *= bsdf_val;
@@ -321,10 +393,25 @@ public:
             }
             active &= (active_surface | active_medium);
         }
+
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>)
+            record_path_length(depth);
+#endif
+
         return { result, valid_ray };
     }
 
 
+    /**
+     * Volume lights are not hit by the sampled directions of the path, their
+     * emission is only counted at collisions of paths that did not sample
+     * them: their samples must not be weighted by multiple importance sampling
+     */
+    Mask is_delta_or_volume(const DirectionSample3f &ds) const {
+        return ds.delta || has_flag(ds.emitter->flags(), EmitterFlags::Volume);
+    }
+
     /// Samples an emitter in the scene and evaluates its attenuated contribution
     template <typename Interaction>
     std::tuple<Spectrum, DirectionSample3f>
@@ -337,6 +424,14 @@ public:
         dr::masked(emitter_val, dr::eq(ds.pdf, 0.f)) = 0.f;
         active &= dr::neq(ds.pdf, 0.f);
 
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>) {
+            record_event(MonteCarloEvent::EmitterSample);
+            if (!active || dr::all(dr::eq(unpolarized_spectrum(emitter_val), 0.f)))
+                record_event(MonteCarloEvent::EmitterSampleZero);
+        }
+#endif
+
         if (dr::none_or<false>(active)) {
             return { emitter_val, ds };
         }
@@ -370,16 +465,30 @@ public:
             Mask active_surface = active && !active_medium;
 
             if (dr::any_or<true>(active_medium)) {
-                auto mei = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                dr::masked(ray.maxt, active_medium && medium->is_homogeneous() && mei.is_valid()) = dr::minimum(mei.t, remaining_dist);
+                Float sample = sampler->next_1d(active_medium);
+                MediumInteraction3f mei =
+                    m_residual_tracking
+                        ? medium->sample_residual_interaction(ray, sample, channel, active_medium)
+                        : medium->sample_interaction(ray, sample, channel, active_medium);
+                /* The transmittance of homogeneous media is known in closed
+                   form: ignore the sampled collision and evaluate it up to
+                   the next surface, which avoids the variance of tracking */
+                Mask homogeneous = active_medium && medium->is_homogeneous();
+                dr::masked(mei.t, homogeneous) = dr::Infinity<Float>;
                 Mask intersect = needs_intersection && active_medium;
                 if (dr::any_or<true>(intersect))
-                    dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
+                    dr::masked(si, intersect) = scene->ray_intersect_occluder(ray, +RayFlags::All, intersect);
 
                 dr::masked(mei.t, active_medium && (si.t < mei.t)) = dr::Infinity<Float>;
                 needs_intersection &= !active_medium;
 
-                Mask is_spectral = medium->has_spectral_extinction() && active_medium;
+                if (dr::any_or<true>(homogeneous)) {
+                    Float t = dr::minimum(remaining_dist, si.t) - mei.mint;
+                    UnpolarizedSpectrum tr = dr::exp(-dr::maximum(t, 0.f) * mei.combined_extinction);
+                    dr::masked(transmittance, homogeneous) *= tr;
+                }
+
+                Mask is_spectral = medium->has_spectral_extinction() && active_medium && !homogeneous;
                 Mask not_spectral = !is_spectral && active_medium;
                 if (dr::any_or<true>(is_spectral)) {
                     Float t      = dr::minimum(remaining_dist, dr::minimum(mei.t, si.t)) - mei.mint;
@@ -389,6 +498,18 @@ public:
                     dr::masked(transmittance, is_spectral) *= dr::select(tr_pdf > 0.f, tr / tr_pdf, 0.f);
                 }
 
+                if (m_residual_tracking) {
+                    /* Account for the control extinction analytically up to the
+                       tentative collision, the next surface or the end of the medium */
+                    auto [aabb_its, aabb_mint, aabb_maxt] = medium->intersect_aabb(ray);
+                    DRJIT_MARK_USED(aabb_mint);
+                    Mask inside = active_medium && aabb_its && dr::isfinite(mei.mint);
+                    Float t = dr::minimum(dr::minimum(remaining_dist, aabb_maxt),
+                                          dr::minimum(mei.t, si.t)) - mei.mint;
+                    UnpolarizedSpectrum control = medium->get_control_extinction(mei, inside);
+                    dr::masked(transmittance, inside) *= dr::exp(-dr::maximum(t, 0.f) * control);
+                }
+
                 // Handle exceeding the maximum distance by medium sampling
                 dr::masked(total_dist, active_medium && (mei.t > remaining_dist) && mei.is_valid()) = ds.dist;
                 dr::masked(mei.t, active_medium && (mei.t > remaining_dist)) = dr::Infinity<Float>;
@@ -409,12 +530,19 @@ public:
                     if (dr::any_or<true>(not_spectral))
                         dr::masked(transmittance, not_spectral) *= mei.sigma_n / mei.combined_extinction;
                 }
+
+#if defined(MI_ENABLE_STATISTICS)
+                if constexpr (!dr::is_jit_v<Float>) {
+                    if (active_medium)
+                        record_event(MonteCarloEvent::NullCollision);
+                }
+#endif
             }
 
             // Handle interactions with surfaces
             Mask intersect = active_surface && needs_intersection;
             if (dr::any_or<true>(intersect))
-                dr::masked(si, intersect)    = scene->ray_intersect(ray, intersect);
+                dr::masked(si, intersect)    = scene->ray_intersect_occluder(ray, +RayFlags::All, intersect);
             needs_intersection &= !intersect;
             active_surface |= escaped_medium;
             dr::masked(total_dist, active_surface) += si.t;
@@ -441,6 +569,15 @@ public:
                 dr::masked(medium, has_medium_trans) = si.target_medium(ray.d);
             }
         }
+
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (dr::all(dr::eq(unpolarized_spectrum(transmittance), 0.f)) &&
+                !dr::all(dr::eq(unpolarized_spectrum(emitter_val), 0.f)))
+                record_event(MonteCarloEvent::EmitterSampleOccluded);
+        }
+#endif
+
         return { transmittance * emitter_val, ds };
     }
 
@@ -450,9 +587,12 @@ public:
     std::string to_string() const override {
         return tfm::format("VolumetricSimplePathIntegrator[\n"
                            "  max_depth = %i,\n"
-                           "  rr_depth = %i\n"
+                           "  rr_depth = %i,\n"
+                           "  transmittance_estimator = %s\n"
                            "]",
-                           m_max_depth, m_rr_depth);
+                           m_max_depth, m_rr_depth,
+                           m_residual_tracking ? "residual_ratio_tracking"
+                                               : "ratio_tracking");
     }
 
     Float mis_weight(Float pdf_a, Float pdf_b) const {
@@ -463,6 +603,9 @@ public:
     };
 
     MI_DECLARE_CLASS()
+private:
+    /// Estimate the transmittance of shadow rays with residual ratio tracking?
+    bool m_residual_tracking;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(VolumetricPathIntegrator, MonteCarloIntegrator);
@@ -337,6 +337,10 @@ public:
                     auto [p_over_f_nee_end, p_over_f_end, emitted, ds] = sample_emitter(si, scene, sampler, medium, p_over_f, channel, active_e);
                     Vector3f wo_local       = si.to_local(ds.d);
                     auto [bsdf_val, bsdf_pdf] = bsdf->eval_pdf(ctx, si, wo_local, active_e);
+#if defined(MI_ENABLE_STATISTICS)
+                    if constexpr (!dr::is_jit_v<Float>)
+                        bsdf->eval_counter().increment();
+#endif
                     update_weights(p_over_f_nee_end, 1.0f, unpolarized_spectrum(bsdf_val), channel, active_e);
                     update_weights(p_over_f_end, dr::select(ds.delta, 0.f, bsdf_pdf), unpolarized_spectrum(bsdf_val), channel, active_e);
                     dr::masked(result, active_e) += mis_weight(p_over_f_nee_end, p_over_f_end) * emitted;
@@ -345,6 +349,10 @@ public:
                 // ----------------------- BSDF sampling ----------------------
                 auto [bs, bsdf_weight] = bsdf->sample(ctx, si, sampler->next_1d(active_surface),
                                                    sampler->next_2d(active_surface), active_surface);
+#if defined(MI_ENABLE_STATISTICS)
+                if constexpr (!dr::is_jit_v<Float>)
+                    bsdf->sample_counter().increment();
+#endif
                 Mask invalid_bsdf_sample = active_surface && dr::eq(bs.pdf, 0.f);
                 active_surface &= bs.pdf > 0.f;
                 dr::masked(eta, active_surface) *= bs.eta;
@@ -422,14 +430,25 @@ public:
 
             if (dr::any_or<true>(active_medium)) {
                 auto mei = medium->sample_interaction(ray, sampler->next_1d(active_medium), channel, active_medium);
-                dr::masked(ray.maxt, active_medium && medium->is_homogeneous() && mei.is_valid()) = dr::minimum(mei.t, remaining_dist);
+                /* The transmittance of homogeneous media is known in closed
+                   form: ignore the sampled collision and evaluate it up to
+                   the next surface, which avoids the variance of tracking */
+                Mask homogeneous = active_medium && medium->is_homogeneous();
+                dr::masked(mei.t, homogeneous) = dr::Infinity<Float>;
                 Mask intersect = needs_intersection && active_medium;
                 if (dr::any_or<true>(intersect))
                     dr::masked(si, intersect) = scene->ray_intersect(ray, intersect);
                 dr::masked(mei.t, active_medium && (si.t < mei.t)) = dr::Infinity<Float>;
                 needs_intersection &= !active_medium;
 
-                Mask is_spectral = medium->has_spectral_extinction() && active_medium;
+                if (dr::any_or<true>(homogeneous)) {
+                    Float t = dr::minimum(remaining_dist, si.t) - mei.mint;
+                    UnpolarizedSpectrum tr = dr::exp(-dr::maximum(t, 0.f) * mei.combined_extinction);
+                    update_weights(p_over_f_nee, 1.f, tr, channel, homogeneous);
+                    update_weights(p_over_f_uni, tr, tr, channel, homogeneous);
+                }
+
+                Mask is_spectral = medium->has_spectral_extinction() && active_medium && !homogeneous;
                 Mask not_spectral = !is_spectral && active_medium;
                 if (dr::any_or<true>(is_spectral)) {
                     Float t      = dr::minimum(remaining_dist, dr::minimum(mei.t, si.t)) - mei.mint;
@@ -38,6 +38,41 @@ Heterogeneous medium (:monosp:`heterogeneous`)
      units, or to simply tweak the density of the medium. (Default: 1)
    - |exposed|
 
+ * - majorant_resolution_factor
+   - |int|
+   - If set to a positive value, the medium builds a coarse grid of local majorants
+     whose resolution is that of the :monosp:`sigma_t` volume divided by this factor.
+     Free-flight distances are then sampled by stepping through the cells of this grid
+     along the ray, instead of using a single global majorant. This greatly reduces the
+     number of null collisions in volumes whose density varies strongly.
+     (Default: 0, i.e. use a global majorant)
+
+ * - majorant_factor
+   - |float|
+   - Factor by which the local majorants are scaled to guard against round-off
+     errors (Default: 1.01)
+
+ * - control_density
+   - |float|
+   - Lower bound of the extinction coefficient (before applying :monosp:`scale`) that is
+     used as the control extinction when the integrator estimates transmittance with
+     residual ratio tracking, e.g. the density of a background fog. Only the residual
+     extinction above this value causes tentative collisions along shadow rays.
+     (Default: 0)
+
+ * - has_spectral_extinction
+   - |bool|
+   - Flag to specify whether the extinction coefficient varies across wavelengths
+     (or color channels). Integrators sample the free-flight distance of a medium without
+     spectral extinction using a single channel, which is cheaper. (Default: detected from
+     :monosp:`sigma_t`, which is assumed to vary unless it is a constant gray value
+     or a single-channel grid)
+
+ * - radiance
+   - |float|, |spectrum| or |volume|
+   - Radiance emitted by the medium, e.g. for fire and explosions (see below). (Default: none)
+   - |exposed|, |differentiable|
+
  * - sample_emitters
    - |bool|
    - Flag to specify whether shadow rays should be cast from inside the volume (Default: |true|)
@@ -68,6 +103,30 @@ meters and the coefficients are in inverse millimeters, set scale to 1000.
 Both the albedo and the extinction coefficient can either be constant or textured,
 and both parameters are allowed to be spectrally varying.
 
+Delta tracking uses a majorant, i.e. an upper bound of the extinction coefficient, to
+sample tentative collisions, most of which are rejected as null collisions where the
+actual density is much lower than the majorant. By default, the maximum of the
+:monosp:`sigma_t` volume is used everywhere, which is very inefficient for volumes that
+are mostly thin but contain a few dense regions. Setting
+:monosp:`majorant_resolution_factor` (e.g. to 8) enables a grid of local majorants.
+The majorant is the same for all wavelengths in either case.
+
+Shadow rays traced by the :ref:`volpath <integrator-volpath>` integrator with
+:monosp:`transmittance_estimator` set to :monosp:`residual_ratio_tracking` account for
+the extinction below :monosp:`control_density` analytically. This considerably reduces the
+cost of shadow rays in large, thin media, provided that the control density is close to
+the actual density in most of the medium. The control density must not exceed the density
+anywhere in the medium, the estimated transmittance is biased otherwise.
+
+Emissive media specify a :monosp:`radiance` volume :math:`L_e`: the medium emits
+:math:`\sigma_a L_e` per unit length, where :math:`\sigma_a = \sigma_t - \sigma_s` is the
+absorption coefficient. The emission vanishes outside of the unit cube of the radiance volume
+(i.e. its bounds after applying its ``to_world`` transformation). The
+:ref:`volpath <integrator-volpath>` integrator accounts for it at every tentative collision.
+Attaching a :ref:`volumelight <emitter-volumelight>` emitter to the shape that encloses the
+medium additionally enables next event estimation of the emission, which is essential when the
+emissive region is small or illuminates other objects.
+
 .. tabs::
     .. code-tab:: xml
         :name: lst-heterogeneous
@@ -149,21 +208,33 @@ template <typename Float, typename Spectrum>
 class HeterogeneousMedium final : public Medium<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(Medium, m_is_homogeneous, m_has_spectral_extinction,
-                    m_phase_function)
+                    m_phase_function, m_radiance)
     MI_IMPORT_TYPES(Scene, Sampler, Texture, Volume)
 
     HeterogeneousMedium(const Properties &props) : Base(props) {
         m_is_homogeneous = false;
         m_albedo = props.volume<Volume>("albedo", 0.75f);
         m_sigmat = props.volume<Volume>("sigma_t", 1.f);
+        if (props.has_property("radiance"))
+            m_radiance = props.volume<Volume>("radiance", 0.f);
 
         m_scale = props.get<ScalarFloat>("scale", 1.0f);
-        m_has_spectral_extinction = props.get<bool>("has_spectral_extinction", true);
+        m_detect_spectral_extinction = !props.has_property("has_spectral_extinction");
+        m_has_spectral_extinction = props.get<bool>(
+            "has_spectral_extinction", m_sigmat->is_spectrally_varying());
 
-        m_max_density = dr::opaque<Float>(m_scale * m_sigmat->max());
+        m_majorant_resolution_factor =
+            props.get<int>("majorant_resolution_factor", 0);
+        m_majorant_factor = props.get<ScalarFloat>("majorant_factor", 1.01f);
+        m_control_density = props.get<ScalarFloat>("control_density", 0.f);
+        if (m_control_density < 0.f)
+            Throw("The control density must be non-negative!");
+
+        update_majorant();
 
         dr::set_attr(this, "is_homogeneous", m_is_homogeneous);
         dr::set_attr(this, "has_spectral_extinction", m_has_spectral_extinction);
+        dr::set_attr(this, "is_emitter", m_radiance.get() != nullptr);
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -174,14 +245,129 @@ public:
     }
 
     void parameters_changed(const std::vector<std::string> &/*keys*/ = {}) override {
+        update_majorant();
+        if (m_detect_spectral_extinction) {
+            m_has_spectral_extinction = m_sigmat->is_spectrally_varying();
+            dr::set_attr(this, "has_spectral_extinction", m_has_spectral_extinction);
+        }
+    }
+
+    /// Compute the global majorant and, if enabled, the majorant grid
+    void update_majorant() {
         m_max_density = dr::opaque<Float>(m_scale * m_sigmat->max());
+        if (m_control_density > m_sigmat->max())
+            Throw("The control density (%f) exceeds the maximum density of "
+                  "the medium (%f)!", m_control_density, m_sigmat->max());
+
+        if (m_majorant_resolution_factor <= 0)
+            return;
+
+        ScalarVector3i res = m_sigmat->resolution();
+        for (uint32_t i = 0; i < 3; ++i)
+            m_majorant_res[i] = (uint32_t) std::max(1,
+                (res[i] + m_majorant_resolution_factor - 1) /
+                    m_majorant_resolution_factor);
+
+        std::vector<ScalarFloat> majorants = m_sigmat->max_grid(m_majorant_res);
+        for (ScalarFloat &m : majorants)
+            m *= m_scale * m_majorant_factor;
+
+        m_majorants = dr::load<FloatStorage>(majorants.data(), majorants.size());
+        m_to_grid = ScalarTransform4f::scale(ScalarVector3f(m_majorant_res)) *
+                    m_sigmat->to_local();
     }
 
     UnpolarizedSpectrum
-    get_majorant(const MediumInteraction3f & /* mi */,
+    get_majorant(const MediumInteraction3f &mi,
                  Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
-        return m_max_density;
+        if (m_majorant_resolution_factor <= 0)
+            return m_max_density;
+
+        Vector3i cell = grid_cell(Point3f(m_to_grid * mi.p));
+        return dr::gather<Float>(m_majorants, grid_index(cell), active);
+    }
+
+    std::pair<Float, UnpolarizedSpectrum>
+    sample_distance(const Ray3f &ray, const MediumInteraction3f &mi,
+                    Float mint, Float maxt, Float sample, UInt32 channel,
+                    Float control, Mask active) const override {
+        if (m_majorant_resolution_factor <= 0)
+            return Base::sample_distance(ray, mi, mint, maxt, sample,
+                                         channel, control, active);
+
+        MI_MASKED_FUNCTION(ProfilerPhase::MediumSample, active);
+        DRJIT_MARK_USED(channel);
+
+        /* Digital differential analyzer (Amanatides and Woo) that steps
+           through the cells of the majorant grid until the optical depth
+           of the sampled free-flight distance is reached. The ray is
+           transformed into grid coordinates without normalizing its
+           direction, hence distances are the same in both spaces. */
+        Point3f o  = m_to_grid * ray.o;
+        Vector3f d = m_to_grid * ray.d;
+        ScalarVector3i res_i(m_majorant_res);
+
+        Float t = mint,
+              tau = -dr::log(1 - sample),
+              sampled_t = dr::Infinity<Float>;
+
+        Vector3i cell = grid_cell(o + d * t);
+        Vector3f inv_d = dr::rcp(d),
+                 t_delta = dr::abs(inv_d);
+        auto positive = d > 0.f;
+        Vector3f t_next =
+            (Vector3f(cell) + dr::select(positive, Vector3f(1.f), Vector3f(0.f)) - o) * inv_d;
+        t_next = dr::select(dr::eq(d, 0.f), Vector3f(dr::Infinity<Float>),
+                            dr::maximum(t_next, t));
+
+        Mask done = !active;
+        dr::Loop<Mask> loop("Heterogeneous medium majorant DDA",
+                            t, tau, sampled_t, cell, t_next, done);
+        while (loop(!done)) {
+            Float majorant =
+                dr::gather<Float>(m_majorants, grid_index(cell), !done) - control;
+
+            // Distance to the next cell boundary along the segment
+            Float t_exit = dr::minimum(dr::min(t_next), maxt),
+                  dtau   = majorant * (t_exit - t);
+
+            Mask collide = !done && (tau < dtau);
+            dr::masked(sampled_t, collide) = t + tau / majorant;
+
+            Mask advance = !done && !collide;
+            dr::masked(tau, advance) -= dtau;
+            dr::masked(t, advance)    = t_exit;
+            done |= collide || (advance && (t_exit >= maxt));
+            advance &= !done;
+
+            // Move to the adjacent cell along the axis with the closest boundary
+            for (uint32_t i = 0; i < 3; ++i) {
+                Mask axis = advance && dr::eq(t_next[i], t_exit);
+                advance &= !axis;
+                Int32 next = cell[i] + dr::select(positive[i], Int32(1), Int32(-1));
+                Mask outside = next < 0 || next >= res_i[i];
+                dr::masked(cell[i], axis && !outside) = next;
+                dr::masked(t_next[i], axis) =
+                    dr::select(outside, dr::Infinity<Float>,
+                               t_next[i] + t_delta[i]);
+            }
+        }
+
+        /* Like get_scattering_coefficients(), use the majorant at the sampled
+           position so that both are consistent at cell boundaries */
+        Mask valid = active && (sampled_t <= maxt);
+        MediumInteraction3f mi2 = mi;
+        mi2.p = ray(dr::select(valid, sampled_t, mint));
+        UnpolarizedSpectrum majorant = get_majorant(mi2, valid);
+
+        return { sampled_t, majorant };
+    }
+
+    UnpolarizedSpectrum
+    get_control_extinction(const MediumInteraction3f & /* mi */,
+                           Mask /* active */) const override {
+        return m_scale * m_control_density;
     }
 
     std::tuple<UnpolarizedSpectrum, UnpolarizedSpectrum, UnpolarizedSpectrum>
@@ -194,7 +380,7 @@ public:
             sigmat *= m_phase_function->projected_area(mi, active);
 
         auto sigmas = sigmat * m_albedo->eval(mi, active);
-        auto sigman = m_max_density - sigmat;
+        auto sigman = get_majorant(mi, active) - sigmat;
         return { sigmas, sigman, sigmat };
     }
 
@@ -208,17 +394,47 @@ public:
         oss << "HeterogeneousMedium[" << std::endl
             << "  albedo  = " << string::indent(m_albedo) << std::endl
             << "  sigma_t = " << string::indent(m_sigmat) << std::endl
-            << "  scale   = " << string::indent(m_scale) << std::endl
+            << "  scale   = " << string::indent(m_scale) << "," << std::endl
+            << "  control_density = " << m_control_density << "," << std::endl
+            << "  majorant_resolution = " << (m_majorant_resolution_factor > 0
+                ? m_majorant_res : ScalarVector3u(1)) << std::endl
             << "]";
         return oss.str();
     }
 
     MI_DECLARE_CLASS()
+private:
+    using FloatStorage = DynamicBuffer<Float>;
+
+    /// Index of the majorant grid cell containing a point in grid coordinates
+    Vector3i grid_cell(const Point3f &p) const {
+        return dr::clamp(dr::floor2int<Vector3i>(p), 0,
+                         ScalarVector3i(m_majorant_res) - 1);
+    }
+
+    UInt32 grid_index(const Vector3i &cell) const {
+        return UInt32((cell.z() * (int32_t) m_majorant_res.y() + cell.y()) *
+                          (int32_t) m_majorant_res.x() + cell.x());
+    }
+
 private:
     ref<Volume> m_sigmat, m_albedo;
     ScalarFloat m_scale;
+    /// Whether the spectral extinction flag is detected from 'sigma_t'
+    bool m_detect_spectral_extinction;
 
     Float m_max_density;
+
+    /// Majorant grid (only used if the resolution factor is positive)
+    int m_majorant_resolution_factor;
+    ScalarFloat m_majorant_factor;
+
+    /// Control extinction of residual ratio tracking (before scaling)
+    ScalarFloat m_control_density;
+    ScalarVector3u m_majorant_res = ScalarVector3u(1);
+    FloatStorage m_majorants;
+    /// Transformation from world space to majorant grid coordinates
+    ScalarTransform4f m_to_grid;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(HeterogeneousMedium, Medium)
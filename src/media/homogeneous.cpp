@@ -38,6 +38,14 @@ Homogeneous medium (:monosp:`homogeneous`)
      units, or to simply tweak the density of the medium. (Default: 1)
    - |exposed|
 
+ * - has_spectral_extinction
+   - |bool|
+   - Flag to specify whether the extinction coefficient varies across wavelengths
+     (or color channels). Integrators sample the free-flight distance of a medium without
+     spectral extinction using a single channel, which is cheaper. (Default: detected from
+     :monosp:`sigma_t`, which is assumed to vary unless it is a constant gray value
+     or a single-channel grid)
+
  * - sample_emitters
    - |bool|
    - Flag to specify whether shadow rays should be cast from inside the volume (Default: |true|)
@@ -140,7 +148,9 @@ public:
         m_sigmat = props.volume<Volume>("sigma_t", 1.f);
 
         m_scale = props.get<ScalarFloat>("scale", 1.0f);
-        m_has_spectral_extinction = props.get<bool>("has_spectral_extinction", true);
+        m_detect_spectral_extinction = !props.has_property("has_spectral_extinction");
+        m_has_spectral_extinction = props.get<bool>(
+            "has_spectral_extinction", m_sigmat->is_spectrally_varying());
 
         dr::set_attr(this, "is_homogeneous", m_is_homogeneous);
         dr::set_attr(this, "has_spectral_extinction", m_has_spectral_extinction);
@@ -153,6 +163,13 @@ public:
         Base::traverse(callback);
     }
 
+    void parameters_changed(const std::vector<std::string> &/*keys*/ = {}) override {
+        if (m_detect_spectral_extinction) {
+            m_has_spectral_extinction = m_sigmat->is_spectrally_varying();
+            dr::set_attr(this, "has_spectral_extinction", m_has_spectral_extinction);
+        }
+    }
+
     MI_INLINE auto eval_sigmat(const MediumInteraction3f &mi, Mask active) const {
         auto sigmat = m_sigmat->eval(mi) * m_scale;
         if (has_flag(m_phase_function->flags(), PhaseFunctionFlags::Microflake))
@@ -167,6 +184,13 @@ public:
         return eval_sigmat(mi, active) & active;
     }
 
+    UnpolarizedSpectrum
+    get_control_extinction(const MediumInteraction3f &mi,
+                           Mask active) const override {
+        // The transmittance of a homogeneous medium is known analytically
+        return get_majorant(mi, active);
+    }
+
     std::tuple<UnpolarizedSpectrum, UnpolarizedSpectrum, UnpolarizedSpectrum>
     get_scattering_coefficients(const MediumInteraction3f &mi,
                                 Mask active) const override {
@@ -197,6 +221,8 @@ public:
 private:
     ref<Volume> m_sigmat, m_albedo;
     ScalarFloat m_scale;
+    /// Whether the spectral extinction flag is detected from 'sigma_t'
+    bool m_detect_spectral_extinction;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(HomogeneousMedium, Medium)
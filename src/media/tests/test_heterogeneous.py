@@ -0,0 +1,119 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+import os
+
+
+def make_medium(tmpdir, **kwargs):
+    # Mostly thin medium with a single dense voxel
+    tmp_file = os.path.join(str(tmpdir), "density.vol")
+    grid = np.full((16, 16, 16, 1), 0.1, dtype=np.float32)
+    grid[8, 8, 3] = 40.0
+    mi.VolumeGrid(grid).write(tmp_file)
+
+    return mi.load_dict({
+        'type': 'heterogeneous',
+        'sigma_t': {
+            'type': 'gridvolume',
+            'filename': tmp_file,
+            'to_world': mi.ScalarTransform4f.translate([-1, -1, -1]).scale(2)
+        },
+        'scale': 2.0,
+        **kwargs
+    })
+
+
+def ratio_tracking(medium, n, residual=False):
+    # Estimate the transmittance along rays traversing the medium
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+
+    ray = mi.Ray3f(mi.Point3f(-2, 0.1, 0.05), mi.Vector3f(1, 0, 0))
+    ray.o = dr.zeros(mi.Point3f, n) + ray.o
+    tr = dr.ones(mi.Float, n)
+    active = dr.full(mi.Bool, True, n)
+    collisions = 0
+
+    while dr.any(active):
+        sample = sampler.next_1d(active)
+        if residual:
+            mei = medium.sample_residual_interaction(ray, sample, mi.UInt32(0),
+                                                     active)
+        else:
+            mei = medium.sample_interaction(ray, sample, mi.UInt32(0), active)
+        active &= mei.is_valid()
+        tr[active] *= mei.sigma_n[0] / mei.combined_extinction[0]
+        ray.o[active] = mei.p
+        collisions += dr.count(active)[0]
+
+    return dr.mean(tr)[0], collisions
+
+
+def test01_majorant_grid(variants_vec_rgb, tmpdir):
+    medium = make_medium(tmpdir, majorant_resolution_factor=4)
+
+    # The majorant is local and bounds the extinction
+    mei = dr.zeros(mi.MediumInteraction3f, 2)
+    mei.p = mi.Point3f([0.8, -0.1], [0.8, 0.1], [0.8, 0.1])
+    majorant = medium.get_majorant(mei)[0]
+    assert dr.allclose(majorant, [0.1 * 2 * 1.01, 40 * 2 * 1.01])
+    sigma_t = medium.get_scattering_coefficients(mei)[2][0]
+    assert dr.all(sigma_t <= majorant)
+
+
+def test02_majorant_grid_transmittance(variants_vec_rgb, tmpdir):
+    n = 100000
+    tr_ref, collisions_ref = ratio_tracking(make_medium(tmpdir), n)
+    tr, collisions = ratio_tracking(
+        make_medium(tmpdir, majorant_resolution_factor=4), n)
+
+    assert abs(tr - tr_ref) < 1e-2
+    assert collisions * 5 < collisions_ref
+
+
+def test03_residual_ratio_tracking(variants_vec_rgb, tmpdir):
+    n = 100000
+    tr_ref, collisions_ref = ratio_tracking(
+        make_medium(tmpdir, majorant_resolution_factor=4), n)
+
+    # The control extinction is accounted for analytically
+    medium = make_medium(tmpdir, majorant_resolution_factor=4,
+                         control_density=0.1)
+    mei = dr.zeros(mi.MediumInteraction3f)
+    control = medium.get_control_extinction(mei)[0]
+    assert dr.allclose(control, 0.1 * 2)
+
+    tr, collisions = ratio_tracking(medium, n, residual=True)
+    ray = mi.Ray3f(mi.Point3f(-2, 0.1, 0.05), mi.Vector3f(1, 0, 0))
+    _, mint, maxt = medium.intersect_aabb(ray)
+    tr *= dr.exp(-control * (maxt - mint))[0]
+
+    assert abs(tr - tr_ref) < 1e-2
+    assert collisions < collisions_ref
+
+
+def test04_spectral_extinction_detection(variants_vec_rgb, tmpdir):
+    # A single-channel grid is wavelength-independent
+    assert not make_medium(tmpdir).has_spectral_extinction()
+    assert make_medium(tmpdir, has_spectral_extinction=True).has_spectral_extinction()
+
+    def homogeneous(sigma_t, **kwargs):
+        return mi.load_dict({'type': 'homogeneous', 'sigma_t': sigma_t, **kwargs})
+
+    assert not homogeneous(2.0).has_spectral_extinction()
+    assert not homogeneous({'type': 'rgb', 'value': 0.5}).has_spectral_extinction()
+
+    medium = homogeneous({'type': 'rgb', 'value': [0.5, 0.25, 0.8]})
+    assert medium.has_spectral_extinction()
+
+    # The flag follows updates of the extinction coefficient
+    params = mi.traverse(medium)
+    params['sigma_t.value.value'] = mi.Color3f(0.5)
+    params.update()
+    assert not medium.has_spectral_extinction()
+
+    medium = homogeneous(2.0, has_spectral_extinction=True)
+    params = mi.traverse(medium)
+    params.update()
+    assert medium.has_spectral_extinction()
@@ -1,4 +1,5 @@
 #include <mitsuba/core/argparser.h>
+#include <mitsuba/core/assetcache.h>
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/filesystem.h>
 #include <mitsuba/core/fresolver.h>
@@ -6,13 +7,31 @@
 #include <mitsuba/core/jit.h>
 #include <mitsuba/core/logger.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/progress.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/sstream.h>
 #include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/tracer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/xml.h>
+#include <mitsuba/render/imageblock.h>
 #include <mitsuba/render/integrator.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
+#include <mitsuba/render/spiral.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #if !defined(_WIN32)
 #  include <signal.h>
@@ -45,7 +64,14 @@ Options:
         Be more verbose. (can be specified multiple times)
 
     -t <count>, --threads <count>
-        Render with the specified number of threads.
+        Render with the specified number of threads. (Default: the number
+        of available cores, limited by the CPU quota of the container and
+        by the MI_MAX_THREADS environment variable)
+
+    --numa
+        Pin the rendering threads to the NUMA nodes of the machine and
+        interleave read-mostly scene data (acceleration data structures,
+        meshes and textures) across the nodes.
 
     -D <key>=<value>, --define <key>=<value>
         Define a constant that can referenced as "$key" within the scene
@@ -65,6 +91,96 @@ Options:
     -o <filename>, --output <filename>
         Write the output image to the file "filename".
 
+    -p, --progressive
+        Write the output image after every rendering pass (see the
+        "samples_per_pass" parameter of the integrator), which allows
+        following the progress of long renders with an image viewer.
+
+    -c <seconds>, --checkpoint <seconds>
+        Save the raw film, the number of finished samples and the seed to
+        the file "<output>.checkpoint" at the end of a rendering pass when
+        at least the given time has passed since the last checkpoint, and
+        after the final pass. On SIGTERM, a checkpoint is written at the
+        end of the current pass before Mitsuba exits. Checkpoints require
+        the "samples_per_pass" parameter and cannot be combined with the
+        "time_budget" parameter of the integrator.
+
+    -r, --resume
+        Continue from the checkpoint of an interrupted render job, if it
+        exists. The remaining samples are rendered with a different seed.
+
+    --profile <format>
+        Sample the active profiler phases (ray intersection, BSDF sampling,
+        texture lookups, ..) during rendering and report the inclusive and
+        exclusive share of CPU time of each phase. The format is either
+        "text", which prints a table to the log, or "json", which writes
+        the report to the file "<output>.profile.json". Mainly meaningful
+        for the scalar variants.
+
+    --trace <filename>
+        Record a timeline of scene loading (XML parsing, the instantiation
+        of every object, plugin loading, file I/O, JIT evaluation and the
+        construction of acceleration data structures) and of rendering
+        (render passes, the image blocks processed by every worker thread
+        and their waits in put_block(), and the compilation and launch of
+        JIT kernels), and write it to the given file in the Chrome trace
+        event format, which can be opened with Perfetto
+        (https://ui.perfetto.dev). JIT variants wait for the kernels of
+        every pass to finish while tracing.
+
+    --signature
+        Print the kernel signature of every scene instead of rendering it.
+        Scenes with the same signature (same variant, JIT flags, plugin
+        types, film resolution, sample count and integrator settings)
+        usually share the kernels in the kernel cache of Dr.Jit.
+
+    --warmup
+        Compile the kernels of every scene into the kernel cache of Dr.Jit
+        by rendering it without writing an image, e.g. when provisioning a
+        render node. Scenes whose kernel signature was already warmed up
+        by an earlier file of the same invocation are skipped. Only useful
+        in JIT (CUDA/LLVM) modes.
+
+    --server
+        Run as a render server that reads one job per line from the
+        standard input and keeps loaded scenes (and compiled kernels)
+        resident between jobs. A job is a scene file followed by options:
+
+          -o <filename>       Output image (default: based on the scene)
+          -s <index>          Sensor index
+          --spp <count>       Override the sample count
+          --seed <value>      Seed of the sampler
+          -D <key>=<value>    Definition used when loading the scene
+          -P <key>=<value>    Override a scene parameter (named as by
+                              mitsuba.traverse() in Python)
+
+        Parameter values are comma-separated numbers, or for
+        transformations "lookat:ox,oy,oz,tx,ty,tz,ux,uy,uz". Overrides
+        are reverted before the next job. Scenes are only parsed once per
+        distinct set of definitions. Each job reports "OK <filename>" or
+        "ERROR <message>" on its own line. The commands "clear" and "quit"
+        drop all cached scenes and stop the server, respectively.
+
+    --worker <port>
+        Run as a render worker that accepts connections of coordinators on
+        the given TCP port. Workers load the scenes named by coordinators
+        from the (shared) file system and must use the same variant.
+
+    --bind <address>
+        Local address on which render workers accept connections (default:
+        127.0.0.1, i.e. only from the same machine). Use 0.0.0.0 or :: to
+        accept connections on all network interfaces.
+
+    --token <secret>
+        Shared secret that coordinators must present to render workers
+        (default: the MI_DISTRIBUTED_TOKEN environment variable). Required
+        by both sides of a distributed render job.
+
+    --nodes <host1:port1>,<host2:port2>,..
+        Distribute the rendering of the scene files over the listed render
+        workers. The image is split into tiles that idle workers request
+        one at a time, and tiles of failing workers are re-issued.
+
  === The following options are only relevant for JIT (CUDA/LLVM) modes ===
 
     -O [0-5]
@@ -104,8 +220,119 @@ void scene_static_accel_shutdown() {
     Scene<Float, Spectrum>::static_accel_shutdown();
 }
 
+/// Options of \ref render() that are specified on the command line
+struct RenderOptions {
+    /// Write the output image after every rendering pass
+    bool progressive = false;
+
+    /// Minimum time between two checkpoints in seconds (negative: disabled)
+    float checkpoint_interval = -1.f;
+
+    /// Continue from the checkpoint of an earlier render, if there is one
+    bool resume = false;
+
+    /// Format of the profiler report ("text" or "json", empty: disabled)
+    std::string profile;
+};
+
+/// Is a render job with checkpoints running?
+std::atomic<bool> checkpoint_active { false };
+
+/// Set by SIGTERM: write a checkpoint and stop at the end of the current pass
+std::atomic<bool> checkpoint_requested { false };
+
+/// Identifies the checkpoint files written by the '--checkpoint' option
+static const char *checkpoint_magic = "mitsuba-checkpoint-1";
+
+/**
+ * \brief State of a render job that is needed to resume it
+ *
+ * Besides the raw film storage (weighted sums of all channels including
+ * AOVs, and the sample weights), a checkpoint records how many of the
+ * requested samples per pixel it contains and the seed that was used to
+ * render them. A resumed job renders the remaining samples with a seed that
+ * hashes the previous seed and sample count (see \ref resume_seed()).
+ */
+template <typename Float, typename Spectrum>
+struct Checkpoint {
+    MI_IMPORT_TYPES()
+    using TensorArray = typename TensorXf::Array;
+
+    uint32_t spp = 0, spp_done = 0, seed = 0;
+    TensorXf storage;
+
+    /// Write the checkpoint to a temporary file that then replaces \c path
+    void write(const fs::path &path) const {
+        auto &&host = dr::migrate(storage.array(), AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+
+        std::vector<float> data(host.size());
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = (float) host.data()[i];
+
+        fs::write_atomic(path, [&](const fs::path &tmp_path) {
+            ref<FileStream> fs =
+                new FileStream(tmp_path, FileStream::ETruncReadWrite);
+            fs->write(std::string(checkpoint_magic));
+            fs->write(std::string(detail::get_variant<Float, Spectrum>()));
+            fs->write(spp);
+            fs->write(spp_done);
+            fs->write(seed);
+            for (size_t i = 0; i < 3; ++i)
+                fs->write((uint32_t) storage.shape(i));
+            fs->write_array(data.data(), data.size());
+            fs->close();
+        });
+    }
+
+    static Checkpoint read(const fs::path &path) {
+        ref<FileStream> fs = new FileStream(path, FileStream::ERead);
+        std::string magic, variant;
+        fs->read(magic);
+        if (magic != checkpoint_magic)
+            Throw("\"%s\" is not a checkpoint file!", path.string());
+        fs->read(variant);
+        if (variant != detail::get_variant<Float, Spectrum>())
+            Throw("The checkpoint \"%s\" was written by the variant \"%s\"!",
+                  path.string(), variant);
+
+        Checkpoint result;
+        fs->read(result.spp);
+        fs->read(result.spp_done);
+        fs->read(result.seed);
+
+        uint32_t shape_u32[3];
+        fs->read_array(shape_u32, 3);
+        size_t shape[3] = { shape_u32[0], shape_u32[1], shape_u32[2] };
+
+        std::vector<float> data(shape[0] * shape[1] * shape[2]);
+        fs->read_array(data.data(), data.size());
+        std::vector<ScalarFloat> values(data.begin(), data.end());
+        result.storage = TensorXf(
+            dr::load<TensorArray>(values.data(), values.size()), 3, shape);
+        return result;
+    }
+};
+
+/**
+ * \brief Seed of a render job that continues a checkpoint
+ *
+ * Integrators derive the seeds of all pixels, blocks and passes of a job from
+ * a contiguous range that starts at a multiple of the seed. Incrementing the
+ * seed would thus reuse some of the earlier sample sequences, while a hashed
+ * seed starts at an unrelated position of the 32 bit seed space.
+ */
+inline uint32_t resume_seed(uint32_t seed, uint32_t spp_done) {
+    return sample_tea_32(seed, spp_done).first;
+}
+
 template <typename Float, typename Spectrum>
-void render(Object *scene_, size_t sensor_i, fs::path filename) {
+void render(Object *scene_, size_t sensor_i, fs::path filename,
+            uint32_t seed = 0, uint32_t spp = 0,
+            const RenderOptions &options = RenderOptions()) {
+    MI_IMPORT_TYPES(ImageBlock)
+
     auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
     if (!scene)
         Throw("Root element of the input file must be a <scene> tag!");
@@ -113,31 +340,952 @@ void render(Object *scene_, size_t sensor_i, fs::path filename) {
         Throw("No sensor specified for scene: %s", scene);
     if (sensor_i >= scene->sensors().size())
         Throw("Specified sensor index is out of bounds!");
-    auto film = scene->sensors()[sensor_i]->film();
+    auto sensor = scene->sensors()[sensor_i];
+    auto film = sensor->film();
 
     auto integrator = scene->integrator();
     if (!integrator)
         Throw("No integrator specified for scene: %s", scene);
 
+    bool checkpoints = options.checkpoint_interval >= 0.f;
+    fs::path checkpoint_path = filename;
+    checkpoint_path.replace_extension(".checkpoint");
+
+    uint32_t spp_total = spp ? spp : sensor->sampler()->sample_count();
+    Checkpoint<Float, Spectrum> previous;
+    if (options.resume && fs::exists(checkpoint_path)) {
+        previous = Checkpoint<Float, Spectrum>::read(checkpoint_path);
+        if (previous.spp != spp_total)
+            Throw("The checkpoint \"%s\" contains a render with %u samples "
+                  "per pixel, but %u were requested!", checkpoint_path.string(),
+                  previous.spp, spp_total);
+
+        size_t channels = film->prepare(integrator->aov_names());
+        ScalarVector2u crop_size = film->crop_size();
+        if (previous.storage.shape(0) != crop_size.y() ||
+            previous.storage.shape(1) != crop_size.x() ||
+            previous.storage.shape(2) != channels)
+            Throw("The checkpoint \"%s\" doesn't match the film of the scene!",
+                  checkpoint_path.string());
+
+        Log(Info, "Resuming from checkpoint \"%s\" (%u/%u samples per pixel "
+            "done)", checkpoint_path.string(), previous.spp_done, spp_total);
+        seed = resume_seed(previous.seed, previous.spp_done);
+    } else if (options.resume) {
+        Log(Warn, "No checkpoint found at \"%s\", starting from scratch.",
+            checkpoint_path.string());
+    }
+
+    // Add the samples of the checkpoint once the film has been prepared
+    bool merged = previous.spp_done == 0;
+    auto merge_previous = [&]() {
+        if (merged)
+            return;
+        ref<ImageBlock> block = new ImageBlock(
+            previous.storage, ScalarPoint2i(film->crop_offset()),
+            nullptr /* rfilter */, false /* border */);
+        film->put_block(block);
+        merged = true;
+    };
+
     /* critical section */ {
         std::lock_guard<std::mutex> guard(develop_callback_mutex);
         develop_callback = [&]() { film->write(filename); };
     }
 
-    integrator->render(scene, (uint32_t) sensor_i,
-                       0 /* seed */,
-                       0 /* spp */,
-                       false /* develop */,
-                       true /* evaluate */);
+    uint32_t spp_remaining = spp_total - previous.spp_done;
+    Timer checkpoint_timer;
+    bool stopped = false;
+
+    if (options.progressive || checkpoints)
+        integrator->set_pass_callback([&](uint32_t pass, uint32_t n_passes) {
+            merge_previous();
+
+            if (options.progressive) {
+                std::lock_guard<std::mutex> guard(develop_callback_mutex);
+                film->write(filename);
+            }
+
+            if (!checkpoints)
+                return true;
+
+            stopped = checkpoint_requested;
+            if (stopped || pass == n_passes ||
+                checkpoint_timer.value() >= 1000.f * options.checkpoint_interval) {
+                Checkpoint<Float, Spectrum> checkpoint;
+                checkpoint.spp = spp_total;
+                checkpoint.spp_done =
+                    previous.spp_done + pass * integrator->pass_sample_count();
+                checkpoint.seed = seed;
+                checkpoint.storage = film->develop(true /* raw */);
+                checkpoint.write(checkpoint_path);
+                checkpoint_timer.reset();
+
+                Log(Info, "Wrote checkpoint \"%s\" (%u/%u samples per pixel)",
+                    checkpoint_path.string(), checkpoint.spp_done, spp_total);
+            }
+
+            if (stopped)
+                Log(Warn, "Termination requested, stopping after the checkpoint.");
+            return !stopped;
+        });
+
+    if (spp_remaining > 0) {
+        if (!options.profile.empty()) {
+            Profiler::reset();
+            Profiler::start();
+        }
+        Log(Info, "Predicted peak memory usage: %s",
+            util::mem_string(scene->predicted_peak_memory(
+                (uint32_t) sensor_i, spp_remaining)));
+        checkpoint_active = checkpoints;
+        integrator->render(scene, (uint32_t) sensor_i,
+                           seed,
+                           spp_remaining,
+                           false /* develop */,
+                           true /* evaluate */);
+        checkpoint_active = false;
+        Profiler::stop();
+    }
+
+    if (options.profile == "json") {
+        fs::path profile_path = filename;
+        profile_path.replace_extension(".profile.json");
+        ref<FileStream> fs =
+            new FileStream(profile_path, FileStream::ETruncReadWrite);
+        fs->write_line(Profiler::report(true /* json */));
+        Log(Info, "Wrote the profiler report to \"%s\"", profile_path.string());
+    } else if (options.profile == "text") {
+        Log(Info, "%s", Profiler::report());
+    }
+    merge_previous();
 
     /* critical section */ {
         std::lock_guard<std::mutex> guard(develop_callback_mutex);
         develop_callback = nullptr;
     }
 
+    if (options.progressive || checkpoints)
+        integrator->set_pass_callback(nullptr);
+
+    film->write(filename);
+    if (stopped)
+        Throw("Rendering was stopped, resume it with the '--resume' option.");
+}
+
+/**
+ * \brief Table of the parameters exposed by \ref Object::traverse(), used by
+ * the render server to apply overrides of the form <tt>key=value</tt>
+ *
+ * Parameter names follow the conventions of <tt>mitsuba.traverse()</tt> in
+ * Python. Modified objects and their parents are notified via \ref
+ * Object::parameters_changed() in \ref update(), and \ref restore() reverts
+ * all overrides.
+ */
+/// Return the scene of a parsed file, and check that it can be rendered
+template <typename Float, typename Spectrum>
+Scene<Float, Spectrum> *render_scene(Object *scene_, size_t sensor_i) {
+    auto *scene = dynamic_cast<Scene<Float, Spectrum> *>(scene_);
+    if (!scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+    if (sensor_i >= scene->sensors().size())
+        Throw("Specified sensor index is out of bounds!");
+    if (!scene->integrator())
+        Throw("No integrator specified for scene: %s", scene);
+    return scene;
+}
+
+/// Print the kernel signature of a scene (\c --signature option)
+template <typename Float, typename Spectrum>
+void print_signature(Object *scene_, size_t sensor_i, const fs::path &filename) {
+    auto *scene = render_scene<Float, Spectrum>(scene_, sensor_i);
+    std::cout << scene->kernel_signature((uint32_t) sensor_i) << "  "
+              << filename.string() << std::endl;
+}
+
+/**
+ * \brief Compile the kernels of a scene by rendering it without writing the
+ * image (\c --warmup option)
+ *
+ * Scenes whose signature is in \c signatures are skipped, since their
+ * kernels are most likely already in the kernel cache.
+ */
+template <typename Float, typename Spectrum>
+void warmup(Object *scene_, size_t sensor_i, const fs::path &filename,
+            std::set<std::string> &signatures) {
+    auto *scene = render_scene<Float, Spectrum>(scene_, sensor_i);
+
+    if constexpr (!dr::is_jit_v<Float>) {
+        Log(Warn, "--warmup: scalar variants don't compile kernels, skipping "
+                  "\"%s\".", filename.string());
+    } else {
+        std::string signature = scene->kernel_signature((uint32_t) sensor_i);
+        if (!signatures.insert(signature).second) {
+            Log(Info, "Skipping \"%s\", the kernels of signature %s are "
+                      "already compiled.", filename.string(), signature);
+            return;
+        }
+
+        Timer timer;
+        auto image = scene->integrator()->render(scene, (uint32_t) sensor_i);
+        dr::eval(image);
+        dr::sync_thread();
+        Log(Info, "Compiled the kernels of signature %s for \"%s\" (took %s).",
+            signature, filename.string(), util::time_string((float) timer.value()));
+    }
+}
+
+template <typename Float, typename Spectrum>
+class SceneParameterTable {
+public:
+    MI_IMPORT_TYPES()
+
+    SceneParameterTable(Object *root) { visit(root, nullptr, "", 0); }
+
+    /// Override the parameter \c key by the comma-separated numbers in \c value
+    void set(const std::string &key, const std::string &value) {
+        auto it = m_parameters.find(key);
+        if (it == m_parameters.end())
+            Throw("Unknown scene parameter \"%s\"!", key);
+        Parameter &p = it->second;
+
+        std::string numbers = value;
+        bool look_at = string::starts_with(value, "lookat:");
+        if (look_at)
+            numbers = value.substr(7);
+
+        std::vector<double> values;
+        for (const std::string &token : string::tokenize(numbers, ", "))
+            values.push_back(string::stof<double>(token));
+
+        bool found = assign<Float>(key, p, values, look_at) ||
+                     assign<ScalarFloat>(key, p, values, look_at) ||
+                     assign<Int32>(key, p, values, look_at) ||
+                     assign<UInt32>(key, p, values, look_at) ||
+                     assign<ScalarInt32>(key, p, values, look_at) ||
+                     assign<ScalarUInt32>(key, p, values, look_at) ||
+                     assign<bool>(key, p, values, look_at) ||
+                     assign<Color3f>(key, p, values, look_at) ||
+                     assign<ScalarColor3f>(key, p, values, look_at) ||
+                     assign<UnpolarizedSpectrum>(key, p, values, look_at) ||
+                     assign<Point3f>(key, p, values, look_at) ||
+                     assign<ScalarPoint3f>(key, p, values, look_at) ||
+                     assign<Vector3f>(key, p, values, look_at) ||
+                     assign<ScalarVector3f>(key, p, values, look_at) ||
+                     assign<Transform4f>(key, p, values, look_at) ||
+                     assign<ScalarTransform4f>(key, p, values, look_at);
+        if (!found)
+            Throw("Scene parameter \"%s\" has an unsupported type (%s)!", key,
+                  p.type->name());
+
+        mark_dirty(key, p.node);
+    }
+
+    /// Notify all modified objects, from the bottom of the hierarchy to the top
+    void update() {
+        for (auto it = m_dirty.rbegin(); it != m_dirty.rend(); ++it)
+            it->first.second->parameters_changed(
+                std::vector<std::string>(it->second.begin(), it->second.end()));
+        m_dirty.clear();
+    }
+
+    /**
+     * \brief Revert all overrides applied since the last call
+     *
+     * The affected objects are notified in the next call to \ref update(),
+     * which allows merging the notifications with those of new overrides.
+     */
+    void restore() {
+        for (auto &[key, restore] : m_restore) {
+            restore.first();
+            mark_dirty(key, restore.second);
+        }
+        m_restore.clear();
+    }
+
+protected:
+    struct Parameter {
+        void *ptr;
+        const std::type_info *type;
+        Object *node;
+    };
+
+    struct Node {
+        Object *parent;
+        uint32_t depth;
+    };
+
+    struct Visitor : public TraversalCallback {
+        SceneParameterTable *table;
+        Object *node;
+        std::string name;
+        uint32_t depth;
+
+        void put_parameter_impl(const std::string &key, void *ptr, uint32_t,
+                                const std::type_info &type) override {
+            table->m_parameters[name.empty() ? key : name + "." + key] =
+                Parameter{ ptr, &type, node };
+        }
+
+        void put_object(const std::string &key, Object *obj, uint32_t) override {
+            if (!obj || table->m_nodes.find(obj) != table->m_nodes.end())
+                return;
+            table->visit(obj, node, name.empty() ? key : name + "." + key,
+                         depth + 1);
+        }
+    };
+
+    void visit(Object *obj, Object *parent, std::string name, uint32_t depth) {
+        // Disambiguate repeated names in the same way as mitsuba.traverse()
+        if (!name.empty()) {
+            std::string base = name;
+            for (int ctr = 1; m_prefixes.find(name) != m_prefixes.end(); ++ctr)
+                name = base + "_" + std::to_string(ctr);
+            m_prefixes.insert(name);
+        }
+
+        m_nodes[obj] = Node{ parent, depth };
+        Visitor visitor;
+        visitor.table = this;
+        visitor.node = obj;
+        visitor.name = name;
+        visitor.depth = depth;
+        obj->traverse(&visitor);
+    }
+
+    /// Flag the object owning \c key and all of its parents for an update
+    void mark_dirty(std::string key, Object *node) {
+        while (node) {
+            const Node &n = m_nodes[node];
+            std::string name = key;
+            size_t pos = key.rfind('.');
+            if (n.parent && pos != std::string::npos) {
+                name = key.substr(pos + 1);
+                key = key.substr(0, pos);
+            }
+            m_dirty[{ n.depth, node }].insert(name);
+            node = n.parent;
+        }
+    }
+
+    template <typename T>
+    bool assign(const std::string &key, const Parameter &p,
+                const std::vector<double> &values, bool look_at) {
+        if (*p.type != typeid(T))
+            return false;
+
+        T *target = (T *) p.ptr;
+        if (m_restore.find(key) == m_restore.end()) {
+            T old = *target;
+            m_restore[key] = { [target, old]() { *target = old; }, p.node };
+        }
+
+        assign_value(*target, values, look_at);
+
+        // Avoid recompiling kernels when the value changes in the next job
+        if constexpr (dr::is_jit_v<Float> &&
+                      (dr::is_jit_v<T> || std::is_same_v<T, Transform4f>))
+            dr::make_opaque(*target);
+        return true;
+    }
+
+    template <typename T>
+    static void assign_value(T &target, const std::vector<double> &values,
+                             bool look_at) {
+        if (look_at)
+            Throw("\"lookat\" values can only be assigned to transformations!");
+
+        if constexpr (dr::is_static_array_v<T>) {
+            size_t size = dr::size_v<T>;
+            if (values.size() != 1 && values.size() != size)
+                Throw("Expected 1 or %u values, got %u!", size, values.size());
+            for (size_t i = 0; i < size; ++i)
+                target.entry(i) =
+                    dr::value_t<T>(values[values.size() == 1 ? 0 : i]);
+        } else {
+            if (values.size() != 1)
+                Throw("Expected a single value, got %u!", values.size());
+            target = T(values[0]);
+        }
+    }
+
+    template <typename Point_>
+    static void assign_value(Transform<Point_> &target,
+                             const std::vector<double> &values, bool look_at) {
+        using T = Transform<Point_>;
+        ScalarTransform4f trafo;
+        if (look_at) {
+            if (values.size() != 9)
+                Throw("\"lookat\" expects 9 values (origin, target, up), got %u!",
+                      values.size());
+            trafo = ScalarTransform4f::look_at(
+                ScalarPoint3f(values[0], values[1], values[2]),
+                ScalarPoint3f(values[3], values[4], values[5]),
+                ScalarVector3f(values[6], values[7], values[8]));
+        } else {
+            if (values.size() != 16)
+                Throw("Expected 16 values (row-major matrix), got %u!",
+                      values.size());
+            ScalarMatrix4f m;
+            for (size_t i = 0; i < 4; ++i)
+                for (size_t j = 0; j < 4; ++j)
+                    m(i, j) = (ScalarFloat) values[i * 4 + j];
+            trafo = ScalarTransform4f(m);
+        }
+
+        if constexpr (T::Size == 4)
+            target = T(typename T::Matrix(trafo.matrix),
+                       typename T::Matrix(trafo.inverse_transpose));
+        else
+            Throw("Only 4x4 transformations can be assigned!");
+    }
+
+protected:
+    std::unordered_map<std::string, Parameter> m_parameters;
+    std::unordered_map<Object *, Node> m_nodes;
+    std::unordered_set<std::string> m_prefixes;
+    std::map<std::pair<uint32_t, Object *>, std::set<std::string>> m_dirty;
+    std::unordered_map<std::string, std::pair<std::function<void()>, Object *>> m_restore;
+};
+
+/**
+ * \brief Render server: read one job per line from the standard input and
+ * keep the loaded scenes resident between jobs
+ *
+ * A job consists of a scene file followed by options (see \ref help()).
+ * Scenes are cached by filename and loading-time definitions, hence
+ * subsequent jobs only apply their parameter overrides via \ref
+ * SceneParameterTable and reuse the acceleration data structure and the
+ * kernels compiled by earlier jobs.
+ */
+template <typename Float, typename Spectrum>
+void serve(const std::string &mode, const xml::ParameterList &params,
+           bool update) {
+    struct CachedScene {
+        ref<Object> scene;
+        std::unique_ptr<SceneParameterTable<Float, Spectrum>> table;
+    };
+
+    std::unordered_map<std::string, CachedScene> cache;
+    ref<Thread> thread = Thread::thread();
+    ref<FileResolver> fr = thread->file_resolver();
+
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        line = string::trim(line, " \t\r");
+        if (line.empty() || line[0] == '#')
+            continue;
+        if (line == "quit" || line == "exit")
+            break;
+        if (line == "clear") {
+            cache.clear();
+            std::cout << "OK" << std::endl;
+            continue;
+        }
+
+        try {
+            Timer timer;
+            std::vector<std::string> args = string::tokenize(line, " \t");
+            fs::path scene_file, output;
+            size_t sensor_i = 0;
+            uint32_t seed = 0, spp = 0;
+            xml::ParameterList job_params = params;
+            std::vector<std::pair<std::string, std::string>> overrides;
+
+            for (size_t i = 0; i < args.size(); ++i) {
+                const std::string &arg = args[i];
+                auto next = [&]() -> const std::string & {
+                    if (i + 1 >= args.size())
+                        Throw("Option \"%s\" expects an argument!", arg);
+                    return args[++i];
+                };
+                auto key_value = [&]() {
+                    const std::string &value = next();
+                    size_t sep = value.find('=');
+                    if (sep == std::string::npos)
+                        Throw("Option \"%s\": expected key=value pair!", arg);
+                    return std::make_pair(value.substr(0, sep), value.substr(sep + 1));
+                };
+
+                if (arg == "-o") {
+                    output = next();
+                } else if (arg == "-s") {
+                    sensor_i = (size_t) std::stoul(next());
+                } else if (arg == "--spp") {
+                    spp = (uint32_t) std::stoul(next());
+                } else if (arg == "--seed") {
+                    seed = (uint32_t) std::stoul(next());
+                } else if (arg == "-D") {
+                    auto [key, value] = key_value();
+                    job_params.emplace_back(key, value, false);
+                } else if (arg == "-P") {
+                    overrides.push_back(key_value());
+                } else if (scene_file.empty() && arg[0] != '-') {
+                    scene_file = arg;
+                } else {
+                    Throw("Unexpected argument \"%s\"!", arg);
+                }
+            }
+
+            if (scene_file.empty())
+                Throw("No scene file specified!");
+            if (output.empty())
+                output = scene_file;
+
+            ref<FileResolver> fr2 = new FileResolver(*fr);
+            fs::path scene_dir = scene_file.parent_path();
+            if (!fr2->contains(scene_dir))
+                fr2->append(scene_dir);
+            thread->set_file_resolver(fr2);
+
+            std::string cache_key = scene_file.string();
+            for (const auto &param : job_params)
+                cache_key += "\n" + std::get<0>(param) + "=" + std::get<1>(param);
+
+            auto it = cache.find(cache_key);
+            if (it == cache.end()) {
+                std::vector<ref<Object>> parsed =
+                    xml::load_file(scene_file, mode, job_params, update, true);
+                if (parsed.size() != 1)
+                    Throw("Root element of the input file is expanded into "
+                          "multiple objects, only a single object is expected!");
+
+                CachedScene entry;
+                entry.scene = parsed[0];
+                entry.table = std::make_unique<SceneParameterTable<Float, Spectrum>>(
+                    entry.scene.get());
+                it = cache.emplace(cache_key, std::move(entry)).first;
+            }
+
+            SceneParameterTable<Float, Spectrum> *table = it->second.table.get();
+            try {
+                table->restore();
+                for (const auto &[key, value] : overrides)
+                    table->set(key, value);
+                table->update();
+            } catch (...) {
+                // Don't keep a partially updated scene around
+                cache.erase(it);
+                throw;
+            }
+
+            render<Float, Spectrum>(it->second.scene.get(), sensor_i, output,
+                                    seed, spp);
+            thread->set_file_resolver(fr);
+
+            Log(Info, "Job finished (took %s)",
+                util::time_string((float) timer.value()));
+            // Films may replace the extension to match their file format
+            auto *scene = render_scene<Float, Spectrum>(
+                it->second.scene.get(), sensor_i);
+            fs::path written =
+                scene->sensors()[sensor_i]->film()->output_path(output);
+            std::cout << "OK " << written.string() << std::endl;
+        } catch (const std::exception &e) {
+            thread->set_file_resolver(fr);
+            std::string msg = e.what();
+            std::replace(msg.begin(), msg.end(), '\n', ' ');
+            std::cout << "ERROR " << msg << std::endl;
+        }
+    }
+}
+
+/// Identifies the protocol spoken between render coordinators and workers
+static const char *distributed_protocol = "mitsuba-distributed-2";
+
+/// Size of the tiles that a coordinator distributes to render workers
+static const uint32_t distributed_tile_size = 64;
+
+/// Upper bounds on the sizes of messages received from the remote end
+static const size_t distributed_max_string = 1 << 16;
+static const uint32_t distributed_max_params = 1024;
+
+/**
+ * \brief Read a length-prefixed string written by \ref Stream::write() and
+ * ensure that it does not exceed \c max_length bytes
+ */
+static std::string read_string(Stream *stream, size_t max_length) {
+    uint32_t length;
+    stream->read(length);
+    if (length > max_length)
+        Throw("Received a string of %u bytes, expected at most %zu!", length,
+              max_length);
+    std::string result(length, '\0');
+    stream->read(result.data(), length);
+    return result;
+}
+
+/// Compare two secrets in time that only depends on their lengths
+static bool token_equal(const std::string &a, const std::string &b) {
+    if (a.size() != b.size())
+        return false;
+    uint8_t diff = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        diff |= (uint8_t) (a[i] ^ b[i]);
+    return diff == 0;
+}
+
+/**
+ * \brief Render worker: accept connections of render coordinators on
+ * <tt>address:port</tt>
+ *
+ * Coordinators must first present the shared secret \c token. Connections
+ * that fail to do so are closed without a reply. Every coordinator then
+ * names a scene, which is loaded once from the shared file system (the worker
+ * and the coordinator must use the same variant), and requests regions of
+ * the film that are rendered with their own crop window and seed. The raw
+ * (unnormalized) film storage of every region is sent back to be merged via
+ * \ref Film::put_block().
+ */
+template <typename Float, typename Spectrum>
+void work(const std::string &mode, const std::string &address, uint16_t port,
+          const std::string &token, bool update) {
+    MI_IMPORT_TYPES(Scene, Film, Sensor)
+
+    if (token.empty())
+        Throw("Render workers require a shared secret (see --token)!");
+
+    ref<Thread> thread = Thread::thread();
+    ref<FileResolver> fr = thread->file_resolver();
+
+    ref<SocketListener> listener = new SocketListener(port, address);
+    Log(Info, "Render worker listening on %s:%u", listener->address(),
+        listener->port());
+
+    while (true) {
+        ref<SocketStream> stream = listener->accept();
+        Log(Info, "Accepted a connection from %s", stream->peer());
+
+        try {
+            std::string protocol = read_string(stream, distributed_max_string);
+            if (protocol != distributed_protocol)
+                Throw("Unsupported protocol \"%s\"!", protocol);
+            if (!token_equal(read_string(stream, distributed_max_string), token))
+                Throw("Invalid shared secret!");
+
+            std::string coordinator_mode = read_string(stream, distributed_max_string),
+                        scene_file = read_string(stream, distributed_max_string);
+
+            uint32_t param_count, sensor_i;
+            xml::ParameterList params;
+            stream->read(param_count);
+            if (param_count > distributed_max_params)
+                Throw("Received %u parameters, expected at most %u!",
+                      param_count, distributed_max_params);
+            for (uint32_t i = 0; i < param_count; ++i) {
+                std::string key   = read_string(stream, distributed_max_string),
+                            value = read_string(stream, distributed_max_string);
+                params.emplace_back(key, value, false);
+            }
+            stream->read(sensor_i);
+
+            ref<Scene> scene;
+            try {
+                if (coordinator_mode != mode)
+                    Throw("The coordinator uses the variant \"%s\", but this "
+                          "worker uses \"%s\"!", coordinator_mode, mode);
+
+                ref<FileResolver> fr2 = new FileResolver(*fr);
+                fs::path scene_dir = fs::path(scene_file).parent_path();
+                if (!fr2->contains(scene_dir))
+                    fr2->append(scene_dir);
+                thread->set_file_resolver(fr2);
+
+                std::vector<ref<Object>> parsed =
+                    xml::load_file(scene_file, mode, params, update, true);
+                scene = dynamic_cast<Scene *>(parsed.size() == 1 ? parsed[0].get()
+                                                                 : nullptr);
+                if (!scene)
+                    Throw("Root element of the input file must be a <scene> tag!");
+                if (sensor_i >= scene->sensors().size())
+                    Throw("Specified sensor index is out of bounds!");
+                if (!scene->integrator())
+                    Throw("No integrator specified for scene: %s", scene_file);
+            } catch (const std::exception &e) {
+                stream->write(std::string(e.what()));
+                throw;
+            }
+            stream->write(std::string("OK"));
+            Log(Info, "Loaded scene \"%s\" for %s", scene_file, stream->peer());
+
+            Sensor *sensor = scene->sensors()[sensor_i];
+            Film *film = sensor->film();
+
+            while (true) {
+                uint8_t command;
+                stream->read(command);
+                if (command == 0)
+                    break;
+
+                uint32_t values[6]; // offset, size, seed, spp
+                stream->read_array(values, 6);
+
+                std::vector<float> data;
+                size_t shape[3];
+                try {
+                    ScalarVector2u offset(values[0], values[1]),
+                                   size(values[2], values[3]);
+                    if (dr::any(size == 0u) || values[5] == 0 ||
+                        dr::any(offset >= film->size()) ||
+                        dr::any(size > film->size() - offset))
+                        Throw("Invalid region (offset=%s, size=%s, spp=%u) for "
+                              "a film of size %s!", offset, size, values[5],
+                              film->size());
+
+                    film->set_crop_window(offset, size);
+                    sensor->parameters_changed();
+                    scene->integrator()->render(scene, sensor, values[4],
+                                                values[5], false /* develop */,
+                                                true /* evaluate */);
+
+                    TensorXf raw = film->develop(true /* raw */);
+                    auto &&host = dr::migrate(raw.array(), AllocType::Host);
+                    if constexpr (dr::is_jit_v<Float>)
+                        dr::sync_thread();
+
+                    data.resize(host.size());
+                    for (size_t i = 0; i < data.size(); ++i)
+                        data[i] = (float) host.data()[i];
+                    for (size_t i = 0; i < 3; ++i)
+                        shape[i] = raw.shape(i);
+                } catch (const std::exception &e) {
+                    stream->write(std::string(e.what()));
+                    throw;
+                }
+
+                stream->write(std::string("OK"));
+                for (size_t i = 0; i < 3; ++i)
+                    stream->write((uint32_t) shape[i]);
+                stream->write_array(data.data(), data.size());
+            }
+
+            Log(Info, "Connection to %s closed", stream->peer());
+        } catch (const std::exception &e) {
+            Log(Warn, "Connection to %s failed: %s", stream->peer(), e.what());
+        }
+
+        stream->close();
+        thread->set_file_resolver(fr);
+    }
+}
+
+/**
+ * \brief Render coordinator: distribute the tiles of a render job to the
+ * render workers listed in \c nodes (<tt>host:port</tt>) and merge the
+ * returned film storage
+ *
+ * Tiles are handed out in the spiral order of local renders to whichever
+ * node is idle. When a node fails, its tile is re-issued to the remaining
+ * nodes. Every tile is rendered together with a border of the size of the
+ * reconstruction filter, such that samples near the tile boundaries also
+ * splat into the neighboring tiles. The border pixels are thus sampled by
+ * both tiles.
+ */
+template <typename Float, typename Spectrum>
+void render_distributed(Object *scene_, size_t sensor_i, fs::path filename,
+                        const std::string &mode, const fs::path &scene_file,
+                        const xml::ParameterList &params,
+                        const std::vector<std::string> &nodes,
+                        const std::string &token) {
+    MI_IMPORT_TYPES(Scene, Film, ImageBlock)
+    using TensorArray = typename TensorXf::Array;
+
+    auto *scene = dynamic_cast<Scene *>(scene_);
+    if (!scene)
+        Throw("Root element of the input file must be a <scene> tag!");
+    if (scene->sensors().empty())
+        Throw("No sensor specified for scene: %s", scene);
+    if (sensor_i >= scene->sensors().size())
+        Throw("Specified sensor index is out of bounds!");
+    auto integrator = scene->integrator();
+    if (!integrator)
+        Throw("No integrator specified for scene: %s", scene);
+    if (token.empty())
+        Throw("Distributed rendering requires the shared secret of the render "
+              "workers (see --token)!");
+
+    auto sensor = scene->sensors()[sensor_i];
+    ref<Film> film = sensor->film();
+    size_t channel_count = film->prepare(integrator->aov_names());
+    uint32_t spp = sensor->sampler()->sample_count();
+
+    struct Tile {
+        ScalarVector2i offset;
+        ScalarVector2u size;
+        uint32_t id;
+    };
+
+    // Extend every tile by the border of the filter (within the crop window)
+    ScalarVector2i crop_min = ScalarVector2i(film->crop_offset()),
+                   crop_max = crop_min + ScalarVector2i(film->crop_size());
+    int border = (int) film->rfilter()->border_size();
+
+    Spiral spiral(film->crop_size(), film->crop_offset(), distributed_tile_size);
+    std::deque<Tile> queue;
+    for (uint32_t i = 0; i < spiral.block_count(); ++i) {
+        auto [offset, size, block_id] = spiral.next_block();
+        ScalarVector2i min = dr::maximum(offset - border, crop_min),
+                       max = dr::minimum(offset + ScalarVector2i(size) + border,
+                                         crop_max);
+        queue.push_back(Tile{ min, ScalarVector2u(max - min), block_id });
+    }
+    size_t tile_count = queue.size(), tiles_done = 0, in_flight = 0;
+
+    Log(Info, "Starting distributed render job (%ux%u, %u sample%s, %zu tiles, "
+        "%zu node%s)", film->crop_size().x(), film->crop_size().y(), spp,
+        spp == 1 ? "" : "s", tile_count, nodes.size(),
+        nodes.size() == 1 ? "" : "s");
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::string error;
+    ref<ProgressReporter> progress = new ProgressReporter("Rendering");
+    ThreadEnvironment env;
+    Timer timer;
+
+    auto run_node = [&](const std::string &node) {
+        ref<SocketStream> stream;
+        try {
+            size_t sep = node.rfind(':');
+            if (sep == std::string::npos)
+                Throw("Expected a node of the form host:port, got \"%s\"!", node);
+            stream = new SocketStream(node.substr(0, sep),
+                                      (uint16_t) std::stoul(node.substr(sep + 1)));
+
+            stream->write(std::string(distributed_protocol));
+            stream->write(token);
+            stream->write(mode);
+            stream->write(fs::absolute(scene_file).string());
+            stream->write((uint32_t) params.size());
+            for (const auto &param : params) {
+                stream->write(std::get<0>(param));
+                stream->write(std::get<1>(param));
+            }
+            stream->write((uint32_t) sensor_i);
+
+            std::string status = read_string(stream, distributed_max_string);
+            if (status != "OK")
+                Throw("%s", status);
+            Log(Info, "Node %s is ready", node);
+        } catch (const std::exception &e) {
+            Log(Warn, "Could not use node %s: %s", node, e.what());
+            return;
+        }
+
+        while (true) {
+            Tile tile;
+            /* critical section */ {
+                std::unique_lock<std::mutex> lock(mutex);
+                cv.wait(lock, [&]() {
+                    return !queue.empty() || in_flight == 0 || !error.empty();
+                });
+                if (queue.empty() || !error.empty())
+                    break;
+                tile = queue.front();
+                queue.pop_front();
+                in_flight++;
+            }
+
+            std::string remote_error;
+            bool failed = false;
+            try {
+                uint32_t values[6] = { (uint32_t) tile.offset.x(),
+                                       (uint32_t) tile.offset.y(),
+                                       tile.size.x(), tile.size.y(), tile.id,
+                                       spp };
+                stream->write((uint8_t) 1);
+                stream->write_array(values, 6);
+
+                std::string status = read_string(stream, distributed_max_string);
+                if (status != "OK") {
+                    remote_error = status;
+                } else {
+                    uint32_t shape_u32[3];
+                    stream->read_array(shape_u32, 3);
+                    if (shape_u32[0] != tile.size.y() ||
+                        shape_u32[1] != tile.size.x() ||
+                        shape_u32[2] != channel_count)
+                        Throw("Received storage of shape (%u, %u, %u), expected "
+                              "(%u, %u, %zu)!", shape_u32[0], shape_u32[1],
+                              shape_u32[2], tile.size.y(), tile.size.x(),
+                              channel_count);
+                    size_t shape[3] = { shape_u32[0], shape_u32[1], shape_u32[2] };
+                    std::vector<float> data(shape[0] * shape[1] * shape[2]);
+                    stream->read_array(data.data(), data.size());
+
+                    std::vector<ScalarFloat> values_f(data.begin(), data.end());
+                    std::lock_guard<std::mutex> lock(mutex);
+                    ref<ImageBlock> block =
+                        film->create_block(tile.size, false /* normalize */,
+                                           false /* border */);
+                    block->set_offset(tile.offset);
+                    block->tensor() = TensorXf(
+                        dr::load<TensorArray>(values_f.data(), values_f.size()),
+                        3, shape);
+                    film->put_block(block);
+                }
+            } catch (const std::exception &e) {
+                Log(Warn, "Lost node %s, re-issuing its tile: %s", node, e.what());
+                failed = true;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            in_flight--;
+            if (failed) {
+                queue.push_front(tile);
+                cv.notify_all();
+                return;
+            } else if (!remote_error.empty()) {
+                error = tfm::format("Node %s: %s", node, remote_error);
+                cv.notify_all();
+                return;
+            }
+            tiles_done++;
+            progress->update(tiles_done / (float) tile_count);
+            cv.notify_all();
+        }
+
+        try {
+            stream->write((uint8_t) 0);
+        } catch (...) { }
+    };
+
+    std::vector<std::thread> threads;
+    for (const std::string &node : nodes)
+        threads.emplace_back([&, node]() {
+            Thread::register_external_thread("net");
+            /* scoped */ {
+                ScopedSetThreadEnvironment set_env(env);
+                run_node(node);
+            }
+            Thread::unregister_external_thread();
+
+            // Other nodes may be waiting for this one to finish its tile
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_all();
+        });
+    for (std::thread &thread : threads)
+        thread.join();
+
+    if (!error.empty())
+        Throw("%s", error);
+    if (tiles_done != tile_count)
+        Throw("Distributed rendering failed: %zu of %zu tiles could not be "
+              "rendered by any node!", tile_count - tiles_done, tile_count);
+
+    Log(Info, "Rendering finished. (took %s)",
+        util::time_string((float) timer.value(), true));
     film->write(filename);
 }
 
+/// Shared secret of a distributed render job (option or environment variable)
+std::string distributed_token(const ArgParser::Arg *arg) {
+    if (*arg)
+        return arg->as_string();
+    const char *value = getenv("MI_DISTRIBUTED_TOKEN");
+    return value ? std::string(value) : std::string();
+}
+
 #if !defined(_WIN32)
 // Handle the hang-up signal and write a partially rendered image to disk
 void hup_signal_handler(int signal) {
@@ -147,6 +1295,19 @@ void hup_signal_handler(int signal) {
     if (develop_callback)
         develop_callback();
 }
+
+/* Handle the termination signal: render jobs with checkpoints write one at the
+   end of the current pass and stop. Otherwise, terminate right away. */
+void term_signal_handler(int signal) {
+    if (signal != SIGTERM)
+        return;
+    if (checkpoint_active) {
+        checkpoint_requested = true;
+    } else {
+        ::signal(SIGTERM, SIG_DFL);
+        raise(SIGTERM);
+    }
+}
 #endif
 
 int main(int argc, char *argv[]) {
@@ -162,11 +1323,24 @@ int main(int argc, char *argv[]) {
     ArgParser parser;
     using StringVec    = std::vector<std::string>;
     auto arg_threads   = parser.add(StringVec{ "-t", "--threads" }, true);
+    auto arg_numa      = parser.add(StringVec{ "--numa" }, false);
     auto arg_verbose   = parser.add(StringVec{ "-v", "--verbose" }, false);
     auto arg_define    = parser.add(StringVec{ "-D", "--define" }, true);
     auto arg_sensor_i  = parser.add(StringVec{ "-s", "--sensor" }, true);
     auto arg_output    = parser.add(StringVec{ "-o", "--output" }, true);
     auto arg_update    = parser.add(StringVec{ "-u", "--update" }, false);
+    auto arg_progress  = parser.add(StringVec{ "-p", "--progressive" }, false);
+    auto arg_ckpt      = parser.add(StringVec{ "-c", "--checkpoint" }, true);
+    auto arg_resume    = parser.add(StringVec{ "-r", "--resume" }, false);
+    auto arg_profile   = parser.add(StringVec{ "--profile" }, true);
+    auto arg_trace     = parser.add(StringVec{ "--trace" }, true);
+    auto arg_signature = parser.add(StringVec{ "--signature" }, false);
+    auto arg_warmup    = parser.add(StringVec{ "--warmup" }, false);
+    auto arg_server    = parser.add(StringVec{ "--server" }, false);
+    auto arg_worker    = parser.add(StringVec{ "--worker" }, true);
+    auto arg_nodes     = parser.add(StringVec{ "--nodes" }, true);
+    auto arg_bind      = parser.add(StringVec{ "--bind" }, true);
+    auto arg_token     = parser.add(StringVec{ "--token" }, true);
     auto arg_help      = parser.add(StringVec{ "-h", "--help" });
     auto arg_mode      = parser.add(StringVec{ "-m", "--mode" }, true);
     auto arg_paths     = parser.add(StringVec{ "-a" }, true);
@@ -189,6 +1363,9 @@ int main(int argc, char *argv[]) {
     sa.sa_flags = 0;
     if (sigaction(SIGHUP, &sa, nullptr))
         Log(Warn, "Could not install a custom signal handler!");
+    sa.sa_handler = term_signal_handler;
+    if (sigaction(SIGTERM, &sa, nullptr))
+        Log(Warn, "Could not install a custom signal handler!");
 #endif
 
     try {
@@ -239,6 +1416,8 @@ int main(int argc, char *argv[]) {
             }
         }
         Thread::set_thread_count(thread_count);
+        if (*arg_numa)
+            Thread::set_numa_aware(true);
 
         while (arg_define && *arg_define) {
             std::string value = arg_define->as_string();
@@ -328,7 +1507,7 @@ int main(int argc, char *argv[]) {
             }
         }
 
-        if (!*arg_extra || *arg_help) {
+        if ((!*arg_extra && !*arg_server && !*arg_worker) || *arg_help) {
             help((int) Thread::thread_count());
         } else {
             Log(Info, "%s", util::info_build((int) Thread::thread_count()));
@@ -340,6 +1519,12 @@ int main(int argc, char *argv[]) {
 #endif
         }
 
+        if (*arg_trace)
+            TraceRecorder::start();
+
+        // Kernel signatures of the scenes compiled by '--warmup'
+        std::set<std::string> warmup_signatures;
+
         while (arg_extra && *arg_extra) {
             fs::path filename(arg_extra->as_string());
             ref<FileResolver> fr2 = new FileResolver(*fr);
@@ -362,15 +1547,68 @@ int main(int argc, char *argv[]) {
                 Throw("Root element of the input file is expanded into "
                       "multiple objects, only a single object is expected!");
 
-            MI_INVOKE_VARIANT(mode, render, parsed[0].get(), sensor_i, filename);
+            if (*arg_signature) {
+                MI_INVOKE_VARIANT(mode, print_signature, parsed[0].get(),
+                                  sensor_i, fs::path(arg_extra->as_string()));
+            } else if (*arg_warmup) {
+                MI_INVOKE_VARIANT(mode, warmup, parsed[0].get(), sensor_i,
+                                  fs::path(arg_extra->as_string()),
+                                  warmup_signatures);
+            } else if (*arg_nodes) {
+                std::vector<std::string> nodes =
+                    string::tokenize(arg_nodes->as_string(), ",");
+                fs::path scene_file(arg_extra->as_string());
+                MI_INVOKE_VARIANT(mode, render_distributed, parsed[0].get(),
+                                  sensor_i, filename, mode, scene_file, params,
+                                  nodes, distributed_token(arg_token));
+            } else {
+                RenderOptions options;
+                options.progressive = *arg_progress;
+                options.resume = *arg_resume;
+                if (*arg_ckpt)
+                    options.checkpoint_interval = (float) arg_ckpt->as_float();
+                if (*arg_profile) {
+                    options.profile = arg_profile->as_string();
+                    if (options.profile != "text" && options.profile != "json")
+                        Throw("Invalid profiler report format \"%s\", "
+                              "expected \"text\" or \"json\"!",
+                              options.profile);
+                }
+                ScopedTraceEvent trace("render", filename.filename().string());
+                MI_INVOKE_VARIANT(mode, render, parsed[0].get(), sensor_i,
+                                  filename, 0, 0, options);
+            }
             arg_extra = arg_extra->next();
         }
+
+        if (*arg_server && !*arg_help) {
+            bool update = *arg_update;
+            MI_INVOKE_VARIANT(mode, serve, mode, params, update);
+        }
+
+        if (*arg_worker && !*arg_help) {
+            bool update = *arg_update;
+            uint16_t port = (uint16_t) arg_worker->as_int();
+            std::string address =
+                *arg_bind ? arg_bind->as_string() : std::string("127.0.0.1");
+            MI_INVOKE_VARIANT(mode, work, mode, address, port,
+                              distributed_token(arg_token), update);
+        }
     } catch (const std::exception &e) {
         error_msg = std::string("Caught a critical exception: ") + e.what();
     } catch (...) {
         error_msg = std::string("Caught a critical exception of unknown type!");
     }
 
+    if (*arg_trace && TraceRecorder::running()) {
+        TraceRecorder::stop();
+        try {
+            TraceRecorder::write(arg_trace->as_string());
+        } catch (const std::exception &e) {
+            Log(Warn, "Could not write the trace: %s", e.what());
+        }
+    }
+
     if (!error_msg.empty()) {
         /* Strip zero-width spaces from the message (Mitsuba uses these
            to properly format chains of multiple exceptions) */
@@ -399,6 +1637,7 @@ int main(int argc, char *argv[]) {
     }
 
     MI_INVOKE_VARIANT(mode, scene_static_accel_shutdown);
+    AssetCache::clear();
     color_management_static_shutdown();
     Profiler::static_shutdown();
     Bitmap::static_shutdown();
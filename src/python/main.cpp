@@ -14,6 +14,9 @@ MI_PY_DECLARE(Cast);
 MI_PY_DECLARE(Struct);
 MI_PY_DECLARE(Appender);
 MI_PY_DECLARE(ArgParser);
+MI_PY_DECLARE(ScratchArena);
+MI_PY_DECLARE(AssetCache);
+MI_PY_DECLARE(TileCache);
 MI_PY_DECLARE(Bitmap);
 MI_PY_DECLARE(Formatter);
 MI_PY_DECLARE(FileResolver);
@@ -21,21 +24,28 @@ MI_PY_DECLARE(Logger);
 MI_PY_DECLARE(MemoryMappedFile);
 MI_PY_DECLARE(Stream);
 MI_PY_DECLARE(DummyStream);
+MI_PY_DECLARE(AsyncFileStream);
 MI_PY_DECLARE(FileStream);
 MI_PY_DECLARE(MemoryStream);
+MI_PY_DECLARE(SocketStream);
 MI_PY_DECLARE(ZStream);
+MI_PY_DECLARE(Profiler);
 MI_PY_DECLARE(ProgressReporter);
 MI_PY_DECLARE(rfilter);
 MI_PY_DECLARE(Thread);
 MI_PY_DECLARE(Timer);
+MI_PY_DECLARE(TraceRecorder);
 MI_PY_DECLARE(util);
 
 // render
 MI_PY_DECLARE(BSDFContext);
 MI_PY_DECLARE(EmitterExtras);
 MI_PY_DECLARE(RayFlags);
+MI_PY_DECLARE(KDTreeStatistics);
 MI_PY_DECLARE(MicrofacetType);
 MI_PY_DECLARE(PhaseFunctionExtras);
+MI_PY_DECLARE(RayBenchmarkResult);
+MI_PY_DECLARE(GuidingField);
 MI_PY_DECLARE(Spiral);
 MI_PY_DECLARE(Sensor);
 MI_PY_DECLARE(VolumeGrid);
@@ -72,6 +82,12 @@ PYBIND11_MODULE(mitsuba_ext, m) {
     m.attr("MI_ENABLE_EMBREE") = false;
 #endif
 
+#if defined(MI_ENABLE_STATISTICS)
+    m.attr("MI_ENABLE_STATISTICS") = true;
+#else
+    m.attr("MI_ENABLE_STATISTICS") = false;
+#endif
+
     m.def("set_log_level", [](mitsuba::LogLevel level) {
         Thread::thread()->logger()->set_log_level(level);
     });
@@ -102,27 +118,37 @@ PYBIND11_MODULE(mitsuba_ext, m) {
     MI_PY_IMPORT(Struct);
     MI_PY_IMPORT(Appender);
     MI_PY_IMPORT(ArgParser);
+    MI_PY_IMPORT(ScratchArena);
+    MI_PY_IMPORT(AssetCache);
     MI_PY_IMPORT(rfilter);
     MI_PY_IMPORT(Stream);
     MI_PY_IMPORT(Bitmap);
+    MI_PY_IMPORT(TileCache);
     MI_PY_IMPORT(Formatter);
     MI_PY_IMPORT(FileResolver);
     MI_PY_IMPORT(Logger);
     MI_PY_IMPORT(MemoryMappedFile);
     MI_PY_IMPORT(DummyStream);
+    MI_PY_IMPORT(AsyncFileStream);
     MI_PY_IMPORT(FileStream);
     MI_PY_IMPORT(MemoryStream);
+    MI_PY_IMPORT(SocketStream);
     MI_PY_IMPORT(ZStream);
+    MI_PY_IMPORT(Profiler);
     MI_PY_IMPORT(ProgressReporter);
     MI_PY_IMPORT(Thread);
     MI_PY_IMPORT(Timer);
+    MI_PY_IMPORT(TraceRecorder);
     MI_PY_IMPORT(util);
 
     MI_PY_IMPORT(BSDFContext);
     MI_PY_IMPORT(EmitterExtras);
     MI_PY_IMPORT(RayFlags);
+    MI_PY_IMPORT(KDTreeStatistics);
     MI_PY_IMPORT(MicrofacetType);
     MI_PY_IMPORT(PhaseFunctionExtras);
+    MI_PY_IMPORT(RayBenchmarkResult);
+    MI_PY_IMPORT(GuidingField);
     MI_PY_IMPORT(Spiral);
     MI_PY_IMPORT(Sensor);
     MI_PY_IMPORT(FilmFlags);
@@ -1,3 +1,4 @@
+#include <mitsuba/core/assetcache.h>
 #include <mitsuba/core/vector.h>
 #include <mitsuba/core/spectrum.h>
 
@@ -102,16 +103,19 @@ MI_PY_DECLARE(OptixDenoiser);
 #endif // defined(MI_ENABLE_CUDA)
 MI_PY_DECLARE(PositionSample);
 MI_PY_DECLARE(PhaseFunction);
+MI_PY_DECLARE(RayBenchmark);
 MI_PY_DECLARE(DirectionSample);
 MI_PY_DECLARE(Sampler);
 MI_PY_DECLARE(Scene);
 MI_PY_DECLARE(Sensor);
 MI_PY_DECLARE(Shape);
 MI_PY_DECLARE(ShapeKDTree);
+MI_PY_DECLARE(ShapeBVH);
 MI_PY_DECLARE(srgb);
 MI_PY_DECLARE(Texture);
 MI_PY_DECLARE(Volume);
 MI_PY_DECLARE(VolumeGrid);
+MI_PY_DECLARE(WaveletDenoiser);
 
 #define MODULE_NAME MI_MODULE_NAME(mitsuba, MI_VARIANT_NAME)
 
@@ -198,13 +202,16 @@ PYBIND11_MODULE(MODULE_NAME, m) {
     MI_PY_IMPORT(OptixDenoiser);
 #endif // defined(MI_ENABLE_CUDA)
     MI_PY_IMPORT(PhaseFunction);
+    MI_PY_IMPORT(RayBenchmark);
     MI_PY_IMPORT(Sampler);
     MI_PY_IMPORT(Sensor);
     MI_PY_IMPORT(ShapeKDTree);
+    MI_PY_IMPORT(ShapeBVH);
     MI_PY_IMPORT(srgb);
     MI_PY_IMPORT(Texture);
     MI_PY_IMPORT(Volume);
     MI_PY_IMPORT(VolumeGrid);
+    MI_PY_IMPORT(WaveletDenoiser);
 
     py::object mitsuba_ext = py::module::import("mitsuba.mitsuba_ext");
     cast_object = (Caster) (void *)((py::capsule) mitsuba_ext.attr("cast_object"));
@@ -219,6 +226,8 @@ PYBIND11_MODULE(MODULE_NAME, m) {
         [](py::handle weakref) {
             color_management_static_shutdown();
             Scene::static_accel_shutdown();
+            // Release cached JIT arrays before the JIT is shut down
+            AssetCache::clear();
 
             /* The DrJit python module is responsible for cleaning up the
                JIT state, so jit_shutdown() shouldn't be called here. */
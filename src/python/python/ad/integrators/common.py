@@ -562,6 +562,12 @@ class ADIntegrator(mi.CppADIntegrator):
             This mask array can optionally be used to indicate that some of
             the rays are disabled.
 
+        Parameter ``grad_enabled`` (``GradEnabled``):
+            Optional keyword argument provided to the differential phases of
+            ``RBIntegrator`` subclasses. It specifies which scene components
+            have differentiable parameters, which implementations may use to
+            skip derivative computations that cannot affect the result.
+
         The function returns a tuple ``(spec, valid, state_out)`` where
 
         Output ``spec`` (``mi.Spectrum``):
@@ -582,8 +588,26 @@ class RBIntegrator(ADIntegrator):
     """
     Abstract base class of radiative-backpropagation style differentiable
     integrators.
+
+    .. pluginparameters::
+
+     * - backward_budget
+       - |int|
+       - Memory budget of ``render_backward()``, specified as the maximum
+         number of Monte Carlo samples that are traced at once. Larger
+         problems are split into image blocks (and, if needed, into several
+         passes over the samples of each pixel) that are differentiated one
+         after the other, while the parameter gradients accumulate across
+         blocks. A value of 0 disables the splitting. (Default: 0)
     """
 
+    def __init__(self, props = mi.Properties()):
+        super().__init__(props)
+
+        self.backward_budget = props.get('backward_budget', 0)
+        if self.backward_budget < 0:
+            raise Exception("\"backward_budget\" must be set to a value >= 0!")
+
     def render_forward(self: mi.SamplingIntegrator,
                        scene: mi.Scene,
                        params: Any,
@@ -689,6 +713,9 @@ class RBIntegrator(ADIntegrator):
                 active=mi.Bool(True)
             )
 
+            # Determine which scene components need derivatives
+            grad_enabled = GradEnabled.from_params(scene, params)
+
             # Launch the Monte Carlo sampling process in forward mode (2)
             δL, valid_2, state_out_2 = self.sample(
                 mode=dr.ADMode.Forward,
@@ -699,7 +726,8 @@ class RBIntegrator(ADIntegrator):
                 δL=None,
                 state_in=state_out,
                 reparam=reparam,
-                active=mi.Bool(True)
+                active=mi.Bool(True),
+                grad_enabled=grad_enabled
             )
 
             # Differentiable camera pose parameters or a reparameterization
@@ -841,6 +869,85 @@ class RBIntegrator(ADIntegrator):
         if isinstance(sensor, int):
             sensor = scene.sensors()[sensor]
 
+        if spp == 0:
+            spp = sensor.sampler().sample_count()
+
+        film = sensor.film()
+        crop_offset, crop_size = film.crop_offset(), film.crop_size()
+        blocks, passes = self.backward_blocks(crop_size, spp)
+
+        if len(blocks) == 1 and passes == 1:
+            return self._render_backward_block(scene, params, grad_in,
+                                               sensor, seed, spp)
+
+        # Differentiate the blocks one after the other by temporarily
+        # restricting the crop window of the film to each block
+        pass_spp = spp // passes
+        if passes > 1:
+            grad_in = grad_in / passes
+
+        try:
+            for i, (offset, size) in enumerate(blocks):
+                film.set_crop_window(crop_offset + offset, size)
+                sensor.parameters_changed()
+
+                grad_block = grad_in[offset[1]:offset[1] + size[1],
+                                     offset[0]:offset[0] + size[0]]
+
+                for j in range(passes):
+                    self._render_backward_block(
+                        scene, params, grad_block, sensor,
+                        seed=(seed * len(blocks) + i) * passes + j,
+                        spp=pass_spp
+                    )
+        finally:
+            film.set_crop_window(crop_offset, crop_size)
+            sensor.parameters_changed()
+
+    def backward_blocks(self, crop_size: mi.ScalarVector2u, spp: int):
+        """
+        Partition the crop window into the blocks that ``render_backward()``
+        differentiates one after the other to respect the memory budget
+        (``backward_budget``).
+
+        Returns a list of ``(offset, size)`` pairs relative to the crop window,
+        and the number of passes that split the samples of every pixel. The
+        latter divides ``spp``.
+        """
+
+        budget = self.backward_budget
+        if budget == 0 or dr.prod(crop_size) * spp <= budget:
+            return [(mi.ScalarPoint2u(0), mi.ScalarVector2u(crop_size))], 1
+
+        # Split the samples of every pixel if a single pixel exceeds the budget
+        passes = 1
+        while spp // passes > budget or spp % passes != 0:
+            passes += 1
+
+        pixels = max(budget // (spp // passes), 1)
+        block_size = max(int(pixels ** 0.5), 1)
+
+        blocks = []
+        for y in range(0, crop_size[1], block_size):
+            for x in range(0, crop_size[0], block_size):
+                size = mi.ScalarVector2u(min(block_size, crop_size[0] - x),
+                                         min(block_size, crop_size[1] - y))
+                blocks.append((mi.ScalarPoint2u(x, y), size))
+
+        return blocks, passes
+
+    def _render_backward_block(self: mi.SamplingIntegrator,
+                               scene: mi.Scene,
+                               params: Any,
+                               grad_in: mi.TensorXf,
+                               sensor: mi.Sensor,
+                               seed: int,
+                               spp: int) -> None:
+        """
+        Implementation detail of ``render_backward()``, which differentiates
+        the current crop window of the film in a single wavefront.
+        """
+
         film = sensor.film()
         aovs = self.aovs()
 
@@ -934,6 +1041,9 @@ class RBIntegrator(ADIntegrator):
                 active=mi.Bool(True)
             )
 
+            # Determine which scene components need derivatives
+            grad_enabled = GradEnabled.from_params(scene, params)
+
             # Launch Monte Carlo sampling in backward AD mode (2)
             L_2, valid_2, state_out_2 = self.sample(
                 mode=dr.ADMode.Backward,
@@ -944,7 +1054,8 @@ class RBIntegrator(ADIntegrator):
                 δL=δL,
                 state_in=state_out,
                 reparam=reparam,
-                active=mi.Bool(True)
+                active=mi.Bool(True),
+                grad_enabled=grad_enabled
             )
 
             # Propagate gradient image to sample positions if necessary
@@ -1194,6 +1305,15 @@ class _ReparamWrapper:
                 ]
             )
 
+        # Skip the reparameterization altogether when none of these
+        # parameters are differentiable, since it would only produce zero
+        # derivatives at the cost of tracing the auxiliary rays
+        if isinstance(params, mi.SceneParameters):
+            self.enabled = scene.shapes_grad_enabled() or \
+                any(dr.grad_enabled(params[k]) for k in params.keys())
+        else:
+            self.enabled = True
+
         # Create a uniform random number generator that won't show any
         # correlation with the main sampler. PCG32Sampler.seed() uses
         # the same logic except for the XOR with -1
@@ -1214,6 +1334,9 @@ class _ReparamWrapper:
         active mask as input and returns the reparameterized ray direction and
         the Jacobian determinant of the change of variables.
         """
+        if not self.enabled:
+            return dr.detach(ray.d), mi.Float(1)
+
         return self.reparam(self.scene, self.rng, self.params, ray,
                             depth, active)
 
@@ -1222,6 +1345,78 @@ class _ReparamWrapper:
 #  Helper functions used by various differentiable integrators
 # ---------------------------------------------------------------------------
 
+class GradEnabled:
+    """
+    Summary of the scene components that have differentiable parameters.
+
+    Differentiable integrators receive an instance of this class via the
+    ``grad_enabled`` argument of ``ADIntegrator.sample()``. In the
+    differential phase, they can use it to skip the derivative computation of
+    components that cannot contribute to the gradient (e.g., re-evaluating the
+    BSDF at every vertex when only an emitter is being optimized). All fields
+    default to ``True``, which keeps every computation enabled.
+    """
+
+    def __init__(self, shapes=True, bsdfs=True, emitters=True, media=True,
+                 sensors=True):
+        self.shapes = shapes
+        self.bsdfs = bsdfs
+        self.emitters = emitters
+        self.media = media
+        self.sensors = sensors
+
+    @staticmethod
+    def from_params(scene: mi.Scene, params: Any) -> GradEnabled:
+        """
+        Determine the components whose parameters have gradient tracking
+        enabled. Every differentiable entry of ``params`` is attributed to the
+        nearest shape, BSDF, emitter, medium or sensor among the scene objects
+        that contain it. When this is not possible (e.g. because ``params`` is
+        not a ``mi.SceneParameters`` instance), all components are
+        conservatively assumed to be differentiable.
+        """
+        if not isinstance(params, mi.SceneParameters):
+            return GradEnabled()
+
+        result = GradEnabled(shapes=scene.shapes_grad_enabled(), bsdfs=False,
+                             emitters=False, media=False, sensors=False)
+
+        categories = [
+            (mi.BSDF, 'bsdfs'), (mi.Emitter, 'emitters'),
+            (mi.Shape, 'shapes'), (mi.Medium, 'media'),
+            (mi.Sensor, 'sensors')
+        ]
+
+        for key, (value, value_type, node, _) in params.properties.items():
+            if value_type is not None or not dr.grad_enabled(value):
+                continue
+
+            category = None
+            while node is not None and category is None:
+                for cls, name in categories:
+                    if isinstance(node, cls):
+                        category = name
+                        break
+                else:
+                    node = params.hierarchy[node][0] \
+                        if node in params.hierarchy else None
+
+            if category is None:
+                return GradEnabled()
+            setattr(result, category, True)
+
+        return result
+
+    def any(self) -> bool:
+        return self.shapes or self.bsdfs or self.emitters or \
+            self.media or self.sensors
+
+    def __repr__(self):
+        return 'GradEnabled[shapes=%s, bsdfs=%s, emitters=%s, media=%s, ' \
+               'sensors=%s]' % (self.shapes, self.bsdfs, self.emitters,
+                                self.media, self.sensors)
+
+
 def mis_weight(pdf_a, pdf_b):
     """
     Compute the Multiple Importance Sampling (MIS) weight given the densities
@@ -3,7 +3,7 @@ from __future__ import annotations # Delayed parsing of type annotations
 import drjit as dr
 import mitsuba as mi
 
-from .common import RBIntegrator, mis_weight
+from .common import RBIntegrator, GradEnabled, mis_weight
 
 class PRBIntegrator(RBIntegrator):
     r"""
@@ -64,6 +64,7 @@ class PRBIntegrator(RBIntegrator):
                δL: Optional[mi.Spectrum],
                state_in: Optional[mi.Spectrum],
                active: mi.Bool,
+               grad_enabled: Optional[GradEnabled] = None,
                **kwargs # Absorbs unused arguments
     ) -> Tuple[mi.Spectrum,
                mi.Bool, mi.Spectrum]:
@@ -78,6 +79,14 @@ class PRBIntegrator(RBIntegrator):
         # Standard BSDF evaluation context for path tracing
         bsdf_ctx = mi.BSDFContext()
 
+        # Which terms must be evaluated differentiably? Geometric derivatives
+        # propagate through all of them, since they depend on 'si'
+        if grad_enabled is None:
+            grad_enabled = GradEnabled()
+        diff_shapes = not primal and grad_enabled.shapes
+        diff_bsdfs = not primal and (grad_enabled.bsdfs or diff_shapes)
+        diff_emitters = not primal and (grad_enabled.emitters or diff_shapes)
+
         # --------------------- Configure loop state ----------------------
 
         # Copy input arguments to avoid mutating the caller's state
@@ -108,7 +117,7 @@ class PRBIntegrator(RBIntegrator):
             # from differentiable shape parameters (position, normals, etc.)
             # In primal mode, this is just an ordinary ray tracing operation.
 
-            with dr.resume_grad(when=not primal):
+            with dr.resume_grad(when=diff_shapes):
                 si = scene.ray_intersect(ray,
                                          ray_flags=mi.RayFlags.All,
                                          coherent=dr.eq(depth, 0))
@@ -126,7 +135,7 @@ class PRBIntegrator(RBIntegrator):
                 scene.pdf_emitter_direction(prev_si, ds, ~prev_bsdf_delta)
             )
 
-            with dr.resume_grad(when=not primal):
+            with dr.resume_grad(when=diff_emitters):
                 Le = β * mis * ds.emitter.eval(si)
 
             # ---------------------- Emitter sampling ----------------------
@@ -142,8 +151,8 @@ class PRBIntegrator(RBIntegrator):
                 si, sampler.next_2d(), True, active_em)
             active_em &= dr.neq(ds.pdf, 0.0)
 
-            with dr.resume_grad(when=not primal):
-                if not primal:
+            with dr.resume_grad(when=diff_emitters):
+                if diff_emitters:
                     # Given the detached emitter sample, *recompute* its
                     # contribution with AD to enable light source optimization
                     ds.d = dr.replace_grad(ds.d, dr.normalize(ds.p - si.p))
@@ -151,9 +160,12 @@ class PRBIntegrator(RBIntegrator):
                     em_weight = dr.replace_grad(em_weight, dr.select(dr.neq(ds.pdf, 0), em_val / ds.pdf, 0))
                     dr.disable_grad(ds.d)
 
-                # Evaluate BSDF * cos(theta) differentiably
+            # Evaluate BSDF * cos(theta) differentiably
+            with dr.resume_grad(when=diff_bsdfs):
                 wo = si.to_local(ds.d)
                 bsdf_value_em, bsdf_pdf_em = bsdf.eval_pdf(bsdf_ctx, si, wo, active_em)
+
+            with dr.resume_grad(when=not primal):
                 mis_em = dr.select(ds.delta, 1, mis_weight(ds.pdf, bsdf_pdf_em))
                 Lr_dir = β * mis_em * bsdf_value_em * em_weight
 
@@ -206,24 +218,29 @@ class PRBIntegrator(RBIntegrator):
                     # since there may be a direct component that is weighted
                     # via multiple importance sampling)
 
-                    # Recompute 'wo' to propagate derivatives to cosine term
-                    wo = si.to_local(ray.d)
+                    # The BSDF re-evaluation can be skipped entirely when
+                    # neither BSDFs nor shapes are being differentiated
+                    Lo = Le + Lr_dir
+
+                    if diff_bsdfs:
+                        # Recompute 'wo' to propagate derivatives to cosine term
+                        wo = si.to_local(ray.d)
 
-                    # Re-evaluate BSDF * cos(theta) differentiably
-                    bsdf_val = bsdf.eval(bsdf_ctx, si, wo, active_next)
+                        # Re-evaluate BSDF * cos(theta) differentiably
+                        bsdf_val = bsdf.eval(bsdf_ctx, si, wo, active_next)
 
-                    # Detached version of the above term and inverse
-                    bsdf_val_det = bsdf_weight * bsdf_sample.pdf
-                    inv_bsdf_val_det = dr.select(dr.neq(bsdf_val_det, 0),
-                                                 dr.rcp(bsdf_val_det), 0)
+                        # Detached version of the above term and inverse
+                        bsdf_val_det = bsdf_weight * bsdf_sample.pdf
+                        inv_bsdf_val_det = dr.select(dr.neq(bsdf_val_det, 0),
+                                                     dr.rcp(bsdf_val_det), 0)
 
-                    # Differentiable version of the reflected indirect
-                    # radiance. Minor optional tweak: indicate that the primal
-                    # value of the second term is always 1.
-                    Lr_ind = L * dr.replace_grad(1, inv_bsdf_val_det * bsdf_val)
+                        # Differentiable version of the reflected indirect
+                        # radiance. Minor optional tweak: indicate that the
+                        # primal value of the second term is always 1.
+                        Lr_ind = L * dr.replace_grad(1, inv_bsdf_val_det * bsdf_val)
 
-                    # Differentiable Monte Carlo estimate of all contributions
-                    Lo = Le + Lr_dir + Lr_ind
+                        # Differentiable Monte Carlo estimate of all contributions
+                        Lo += Lr_ind
 
                     if dr.flag(dr.JitFlag.VCallRecord) and not dr.grad_enabled(Lo):
                         raise Exception(
@@ -27,28 +27,148 @@ def mesh_laplacian(n_verts, faces, lambda_):
 
     return idx, values
 
+class ConjugateGradientSolver:
+    """
+    Iterative solver for sparse symmetric positive definite linear systems.
+
+    This class implements the Jacobi-preconditioned conjugate gradient method
+    using Dr.Jit array operations, which makes it usable without external
+    dependencies and keeps all data on the device of the current variant. The
+    matrix is specified in coordinate (COO) format and the three columns of
+    the right hand side (e.g. the X, Y and Z components of vertex positions)
+    are solved for simultaneously.
+
+    By default, every solve starts from the solution of the previous one. In
+    an optimization, consecutive right hand sides are similar, so the solver
+    typically converges in a few iterations.
+    """
+
+    def __init__(self, n_rows, rows, cols, data, tolerance=1e-5,
+                 max_iterations=1000):
+        """
+        Parameter ``n_rows`` (``int``):
+            Dimension of the (square) system matrix.
+
+        Parameter ``rows``, ``cols`` (``mitsuba.TensorXi``):
+            Row and column indices of the nonzero matrix entries.
+
+        Parameter ``data`` (``mitsuba.TensorXf``):
+            Values of the nonzero matrix entries.
+
+        Parameter ``tolerance`` (``float``):
+            Iteration stops once the norm of the residual falls below this
+            fraction of the norm of the right hand side.
+
+        Parameter ``max_iterations`` (``int``):
+            Upper bound on the number of iterations of a single solve.
+        """
+        self.n_rows = n_rows
+        self.rows = mi.UInt(rows.array)
+        self.cols = mi.UInt(cols.array)
+        self.data = mi.Float(data.array)
+        self.tolerance = tolerance
+        self.max_iterations = max_iterations
+        self.iterations = 0
+
+        diag = dr.zeros(mi.Float, n_rows)
+        dr.scatter_reduce(dr.ReduceOp.Add, diag, self.data, self.rows,
+                          dr.eq(self.rows, self.cols))
+        self.inv_diag = dr.select(dr.neq(diag, 0), dr.rcp(diag), 1)
+        self.prev = {}
+
+    def matvec(self, x):
+        """Multiply the system matrix with a ``mitsuba.Point3f`` array"""
+        result = dr.zeros(mi.Point3f, self.n_rows)
+        dr.scatter_reduce(dr.ReduceOp.Add, result,
+                          dr.gather(mi.Point3f, x, self.cols) * self.data,
+                          self.rows)
+        return result
+
+    def solve(self, b, key=None):
+        """
+        Solve the linear system for the right hand side ``b``, a tensor of
+        shape ``(n_rows, 3)``, and return the solution as a tensor of the
+        same shape. Solves sharing the same ``key`` are warm-started from
+        the previous solution.
+        """
+        def dot(a, c):
+            return mi.Point3f(dr.sum(a.x * c.x), dr.sum(a.y * c.y),
+                              dr.sum(a.z * c.z))
+
+        b = dr.unravel(mi.Point3f, mi.Float(b.array))
+        x = self.prev.get(key, None)
+        if key is None or x is None or dr.width(x) != self.n_rows:
+            x = dr.zeros(mi.Point3f, self.n_rows)
+
+        r = b - self.matvec(x)
+        z = r * self.inv_diag
+        p = mi.Point3f(z)
+        rz = dot(r, z)
+        threshold = self.tolerance**2 * \
+            dr.maximum(dr.max(dot(b, b)), dr.epsilon(mi.Float))
+        dr.eval(x, r, p, rz, threshold)
+
+        self.iterations = 0
+        while self.iterations < self.max_iterations:
+            # Check the convergence criterion every few iterations, since
+            # doing so requires a round trip to the host
+            if self.iterations % 8 == 0 and \
+                    dr.max(dot(r, r))[0] <= threshold[0]:
+                break
+
+            Ap = self.matvec(p)
+            pAp = dot(p, Ap)
+            alpha = dr.select(dr.neq(pAp, 0), rz / pAp, 0)
+            x += alpha * p
+            r -= alpha * Ap
+            z = r * self.inv_diag
+            rz_next = dot(r, z)
+            beta = dr.select(dr.neq(rz, 0), rz_next / rz, 0)
+            p = z + beta * p
+            rz = rz_next
+            dr.eval(x, r, p, rz)
+            self.iterations += 1
+
+        if key is not None:
+            self.prev[key] = x
+
+        return mi.TensorXf(dr.ravel(x), (self.n_rows, 3))
+
+
+def solve_linear_system(solver, b, key=None):
+    """
+    Solve a linear system using either a ``ConjugateGradientSolver`` or a
+    Cholesky factorization from the ``cholespy`` package.
+    """
+    if isinstance(solver, ConjugateGradientSolver):
+        return solver.solve(b, key)
+
+    x = dr.empty(mi.TensorXf, shape=b.shape)
+    solver.solve(b, x)
+    return mi.TensorXf(x)
+
+
 class SolveCholesky(dr.CustomOp):
     """
-    DrJIT custom operator to solve a linear system using a Cholesky factorization.
+    DrJIT custom operator to solve a linear system using a Cholesky
+    factorization or the conjugate gradient method.
     """
 
     def eval(self, solver, u):
         self.solver = solver
-        x = dr.empty(mi.TensorXf, shape=u.shape)
-        solver.solve(u, x)
-        return mi.TensorXf(x)
+        return solve_linear_system(solver, u, 'primal')
 
     def forward(self):
-        x = dr.empty(mi.TensorXf, shape=self.grad_in('u').shape)
-        self.solver.solve(self.grad_in('u'), x)
-        self.set_grad_out(x)
+        self.set_grad_out(solve_linear_system(
+            self.solver, self.grad_in('u'), 'forward'))
 
     def backward(self):
-        x = dr.empty(mi.TensorXf, shape=self.grad_out().shape)
-        self.solver.solve(self.grad_out(), x)
-        self.set_grad_in('u', x)
+        self.set_grad_in('u', solve_linear_system(
+            self.solver, self.grad_out(), 'backward'))
 
     def name(self):
+        if isinstance(self.solver, ConjugateGradientSolver):
+            return "Conjugate gradient solve"
         return "Cholesky solve"
 
 
@@ -63,14 +183,19 @@ class LargeSteps():
     diffuse gradients on the surface, which helps fight their sparsity.
 
     This class builds the system matrix (I + λL) for a given mesh and hyper
-    parameter λ, and computes its Cholesky factorization.
+    parameter λ, and computes its Cholesky factorization. When the
+    ``cholespy`` package is not available (or when requested explicitly via
+    ``solver='cg'``), it instead solves the system iteratively using the
+    conjugate gradient method implemented in Dr.Jit. This avoids the
+    dependency and the factorization cost, which become significant for
+    meshes with millions of vertices.
 
     It can then convert vertex coordinates back and forth between their
     cartesian and differential representations. Both transformations are
     differentiable, meshes can therefore be optimized by using the differential
     form as a latent variable.
     """
-    def __init__(self, verts, faces, lambda_=19.0):
+    def __init__(self, verts, faces, lambda_=19.0, solver='auto'):
         """
         Build the system matrix and its Cholesky factorization.
 
@@ -85,13 +210,22 @@ class LargeSteps():
             on the surface. this value should increase with the tesselation of
             the mesh.
 
+        Parameter ``solver`` (``str``):
+            Linear solver used by ``from_differential()``: ``'cholesky'``
+            requires the ``cholespy`` package, ``'cg'`` uses the conjugate
+            gradient method, and ``'auto'`` selects the former when it is
+            available. (Default: ``'auto'``)
         """
-        if mi.variant().endswith('double'):
-            from cholespy import CholeskySolverD as CholeskySolver
-        else:
-            from cholespy import CholeskySolverF as CholeskySolver
+        if solver not in ['auto', 'cholesky', 'cg']:
+            raise Exception("LargeSteps(): unknown solver '%s'!" % solver)
+
+        if solver == 'auto':
+            try:
+                import cholespy
+                solver = 'cholesky'
+            except ImportError:
+                solver = 'cg'
 
-        from cholespy import MatrixType
         import numpy as np
 
         v = verts.numpy().reshape((-1,3))
@@ -116,9 +250,20 @@ class LargeSteps():
 
         dr.scatter_reduce(dr.ReduceOp.Add, data.array, mi.Float64(values), mi.UInt(inverse_idx))
 
-        self.solver = CholeskySolver(self.n_verts, self.rows, self.cols, data, MatrixType.COO)
         self.data = mi.TensorXf(data)
 
+        if solver == 'cholesky':
+            if mi.variant().endswith('double'):
+                from cholespy import CholeskySolverD as CholeskySolver
+            else:
+                from cholespy import CholeskySolverF as CholeskySolver
+
+            from cholespy import MatrixType
+            self.solver = CholeskySolver(self.n_verts, self.rows, self.cols, data, MatrixType.COO)
+        else:
+            self.solver = ConjugateGradientSolver(self.n_verts, self.rows,
+                                                  self.cols, self.data)
+
     def to_differential(self, v):
         """
         Convert vertex coordinates to their differential form: u = (I + λL) v.
@@ -146,7 +291,8 @@ class LargeSteps():
         λL)⁻¹ u.
 
         This is done by solving the linear system (I + λL) v = u using the
-        previously computed Cholesky factorization.
+        previously computed Cholesky factorization or the conjugate gradient
+        method.
 
         This method is typically called at each iteration of the optimization,
         to update the mesh coordinates before rendering.
@@ -0,0 +1,618 @@
+'''
+Render benchmark suite
+
+This module renders a fixed set of procedurally generated reference scenes
+that stress different parts of the renderer, and reports for each of them and
+each requested variant:
+
+- the scene load time (creation of the shapes, textures and media),
+- the acceleration data structure build time,
+- the primary ray throughput in Mrays/s (``depth`` integrator),
+- the sample throughput in samples/s (the integrator of the scene),
+- the peak resident set size of the process.
+
+Every (variant, scene) pair runs in a separate Python process, such that
+the peak memory usage and the JIT kernel caches are not shared between runs.
+The scenes are generated from fixed formulas (no random numbers), hence the
+results of different Mitsuba versions and machines are comparable.
+
+Usage::
+
+    python -m mitsuba.bench [--variants scalar_rgb,llvm_ad_rgb]
+                            [--scenes dense_mesh,hair] [--scale 0.25]
+                            [--output results.json]
+
+The ``--output`` option writes the results as JSON for trend tracking.
+
+Baselines
+---------
+
+:py:class:`BaselineStore` keeps the results of earlier runs in a versioned
+JSON file and flags slowdowns beyond a noise threshold. Results are only
+compared with a baseline that was measured under the same conditions, i.e.
+for the same variant, CPU model, and thread count, and for a scene
+generated by the same code and options (see :py:func:`scene_hash`). The
+commit of every baseline is recorded as well::
+
+    # Record the baseline, e.g. before a Mitsuba upgrade
+    python -m mitsuba.bench --baseline baseline.json --update-baseline
+
+    # Later: exits with an error if a measurement regressed by more than 10%
+    python -m mitsuba.bench --baseline baseline.json --threshold 0.1
+
+The same comparison runs in the opt-in ``benchmark`` tests of the test suite
+(``pytest src/render/tests/test_benchmark.py --benchmark``).
+'''
+
+import argparse
+import hashlib
+import inspect
+import json
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+import time
+
+#: Reference scenes of the benchmark suite
+SCENES = ['dense_mesh', 'many_emitters', 'volume', 'hair', 'textures']
+
+#: Variants that are benchmarked by default (if they are compiled)
+DEFAULT_VARIANTS = ['scalar_rgb', 'llvm_ad_rgb', 'cuda_ad_rgb']
+
+#: Version of the file format of :py:class:`BaselineStore`
+BASELINE_VERSION = 1
+
+#: Measurements compared with a baseline, and whether larger values are better
+METRICS = {
+    'load_time_s': False,
+    'accel_build_time_s': False,
+    'primary_mrays_per_s': True,
+    'samples_per_s': True,
+}
+
+
+def peak_rss():
+    '''Return the peak resident set size of this process in MiB (or None)'''
+    try:
+        import resource
+    except ImportError:
+        return None
+    rss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # Reported in bytes on macOS and in KiB elsewhere
+    return rss / (1024 * 1024) if sys.platform == 'darwin' else rss / 1024
+
+
+def cpu_model():
+    '''Return the model name of the CPU (or the best available description)'''
+    try:
+        if sys.platform.startswith('linux'):
+            with open('/proc/cpuinfo') as f:
+                for line in f:
+                    if line.startswith('model name'):
+                        return line.partition(':')[2].strip()
+        elif sys.platform == 'darwin':
+            return subprocess.check_output(
+                ['/usr/sbin/sysctl', '-n', 'machdep.cpu.brand_string'],
+                text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        pass
+    return platform.processor() or platform.machine()
+
+
+def git_commit():
+    '''
+    Return the commit of the Mitsuba source tree, if the package was built
+    within a git checkout. The ``MI_COMMIT`` environment variable takes
+    precedence (e.g. for installed packages).
+    '''
+    commit = os.environ.get('MI_COMMIT')
+    if commit:
+        return commit
+    try:
+        return subprocess.check_output(
+            ['git', 'rev-parse', 'HEAD'], cwd=os.path.dirname(__file__),
+            stderr=subprocess.DEVNULL, text=True).strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+# -----------------------------------------------------------------------------
+#  Reference scenes. Each function returns the objects of the scene (except
+#  for the sensor) as a dictionary for mitsuba.load_dict().
+# -----------------------------------------------------------------------------
+
+def _write_ply(filename, vertices, faces):
+    '''Write a triangle mesh to a binary PLY file'''
+    import numpy as np
+
+    with open(filename, 'wb') as f:
+        f.write((
+            'ply\nformat binary_little_endian 1.0\n'
+            f'element vertex {len(vertices)}\n'
+            'property float x\nproperty float y\nproperty float z\n'
+            f'element face {len(faces)}\n'
+            'property list uchar int vertex_indices\nend_header\n'
+        ).encode('ascii'))
+        f.write(vertices.astype('<f4').tobytes())
+        records = np.empty(len(faces), dtype=[('n', 'u1'), ('i', '<i4', 3)])
+        records['n'] = 3
+        records['i'] = faces
+        f.write(records.tobytes())
+
+
+def _dense_mesh(mi, tmp_dir, scale):
+    '''A displaced grid with ~2M triangles (at scale 1)'''
+    import numpy as np
+
+    res = max(int(1024 * scale ** 0.5), 16)
+    u, v = np.meshgrid(np.linspace(-1, 1, res), np.linspace(-1, 1, res))
+    h = 0.1 * np.sin(12 * u) * np.cos(9 * v) + 0.05 * np.sin(40 * u * v)
+    vertices = np.stack([u, v, h], axis=-1).reshape(-1, 3)
+
+    idx = np.arange(res * res).reshape(res, res)
+    a, b = idx[:-1, :-1].ravel(), idx[:-1, 1:].ravel()
+    c, d = idx[1:, :-1].ravel(), idx[1:, 1:].ravel()
+    faces = np.concatenate([np.stack([a, b, d], -1), np.stack([a, d, c], -1)])
+
+    filename = os.path.join(tmp_dir, 'dense_mesh.ply')
+    _write_ply(filename, vertices, faces)
+
+    return {
+        'integrator': { 'type': 'path', 'max_depth': 6 },
+        'mesh': {
+            'type': 'ply',
+            'filename': filename,
+            'bsdf': { 'type': 'roughconductor', 'alpha': 0.2 }
+        },
+        'emitter': { 'type': 'constant' }
+    }
+
+
+def _many_emitters(mi, tmp_dir, scale):
+    '''A floor and a few spheres lit by a grid of 4096 point lights'''
+    n = max(int(64 * scale ** 0.5), 2)
+    scene = {
+        'integrator': { 'type': 'path', 'max_depth': 4 },
+        'floor': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.scale(1.5),
+            'bsdf': { 'type': 'diffuse' }
+        }
+    }
+    for i in range(4):
+        scene[f'sphere_{i}'] = {
+            'type': 'sphere',
+            'center': [-0.6 + 0.4 * i, 0.1 * i, 0.2],
+            'radius': 0.15,
+            'bsdf': { 'type': 'plastic' }
+        }
+    for i in range(n):
+        for j in range(n):
+            x, y = -1.2 + 2.4 * i / (n - 1), -1.2 + 2.4 * j / (n - 1)
+            scene[f'light_{i}_{j}'] = {
+                'type': 'point',
+                'position': [x, y, 0.6 + 0.2 * ((i + j) % 3)],
+                'intensity': {
+                    'type': 'rgb',
+                    'value': [(i % 4 + 1) / n, (j % 4 + 1) / n, 2.0 / n]
+                }
+            }
+    return scene
+
+
+def _volume(mi, tmp_dir, scale):
+    '''A heterogeneous medium with a procedural 128^3 density grid'''
+    import numpy as np
+
+    res = max(int(128 * scale ** (1 / 3)), 8)
+    x = np.linspace(0, 1, res)
+    z, y, x = np.meshgrid(x, x, x, indexing='ij')
+    density = (0.5 + 0.5 * np.sin(15 * x) * np.sin(11 * y) * np.sin(13 * z)) * \
+              np.clip(1 - 2 * np.sqrt((x - .5) ** 2 + (y - .5) ** 2 + (z - .5) ** 2), 0, 1)
+    grid = mi.VolumeGrid(4 * density.astype(np.float32)[..., None])
+
+    return {
+        'integrator': { 'type': 'volpath', 'max_depth': 16 },
+        'cube': {
+            'type': 'cube',
+            'bsdf': { 'type': 'null' },
+            'interior': {
+                'type': 'heterogeneous',
+                'albedo': 0.9,
+                'sigma_t': {
+                    'type': 'gridvolume',
+                    'grid': grid,
+                    'to_world': mi.ScalarTransform4f.translate(-1).scale(2)
+                }
+            }
+        },
+        'emitter': { 'type': 'constant' }
+    }
+
+
+def _hair(mi, tmp_dir, scale):
+    '''20000 wavy linear curves with 8 control points each'''
+    import numpy as np
+
+    n = max(int(20000 * scale), 16)
+    k = 8
+    i = np.arange(n)[:, None]
+    t = np.linspace(0, 1, k)[None, :]
+    # Roots on a golden-angle spiral over a disk
+    r, phi = np.sqrt((i + 0.5) / n), i * 2.399963
+    x = r * np.cos(phi) + 0.05 * t * np.sin(7 * t + i)
+    y = r * np.sin(phi) + 0.05 * t * np.cos(5 * t + i)
+    z = 0.8 * t
+    radius = 0.002 * (1 - 0.8 * t)
+
+    filename = os.path.join(tmp_dir, 'hair.txt')
+    with open(filename, 'w') as f:
+        for c in range(n):
+            for p in range(k):
+                f.write(f'{x[c, p]:.6f} {y[c, p]:.6f} {z[c, p]:.6f} {radius[0, p]:.6f}\n')
+            f.write('\n')
+
+    return {
+        'integrator': { 'type': 'path', 'max_depth': 8 },
+        'hair': {
+            'type': 'linearcurve',
+            'filename': filename,
+            'to_world': mi.ScalarTransform4f.translate([0, 0, -0.4]),
+            'bsdf': { 'type': 'roughconductor', 'alpha': 0.3 }
+        },
+        'emitter': { 'type': 'constant' }
+    }
+
+
+def _textures(mi, tmp_dir, scale):
+    '''A grid of 16 spheres with 2048x2048 procedural textures'''
+    import numpy as np
+
+    res = max(int(2048 * scale ** 0.5), 16)
+    u, v = np.meshgrid(np.linspace(0, 1, res), np.linspace(0, 1, res))
+    scene = { 'integrator': { 'type': 'path', 'max_depth': 4 } }
+    for i in range(16):
+        image = np.stack([
+            0.5 + 0.5 * np.sin((i + 3) * 20 * u),
+            0.5 + 0.5 * np.sin((i + 5) * 17 * v),
+            0.5 + 0.5 * np.sin((i + 7) * 13 * (u + v))
+        ], axis=-1).astype(np.float32)
+        scene[f'sphere_{i}'] = {
+            'type': 'sphere',
+            'center': [-0.75 + 0.5 * (i % 4), -0.75 + 0.5 * (i // 4), 0],
+            'radius': 0.22,
+            'bsdf': {
+                'type': 'diffuse',
+                'reflectance': { 'type': 'bitmap', 'bitmap': mi.Bitmap(image) }
+            }
+        }
+    scene['emitter'] = { 'type': 'constant' }
+    return scene
+
+
+_SCENE_FUNCTIONS = {
+    'dense_mesh': _dense_mesh,
+    'many_emitters': _many_emitters,
+    'volume': _volume,
+    'hair': _hair,
+    'textures': _textures,
+}
+
+
+# -----------------------------------------------------------------------------
+#  Benchmark driver
+# -----------------------------------------------------------------------------
+
+def _render_time(mi, dr, scene, integrator, spp, repeats):
+    '''Best time of several renders after a warm-up render (JIT compilation)'''
+    def render():
+        image = mi.render(scene, integrator=integrator, spp=spp)
+        dr.eval(image)
+        dr.sync_thread()
+
+    render()
+    times = []
+    for _ in range(repeats):
+        start = time.perf_counter()
+        render()
+        times.append(time.perf_counter() - start)
+    return min(times)
+
+
+def scene_hash(scene_name, scale=1.0, resolution=256, spp=16):
+    '''
+    Return a hash of the code and options that generate a reference scene.
+    Results with different hashes don't measure the same work.
+    '''
+    h = hashlib.sha256(inspect.getsource(_SCENE_FUNCTIONS[scene_name]).encode())
+    h.update(repr((float(scale), max(int(resolution), 8), int(spp))).encode())
+    return h.hexdigest()[:16]
+
+
+def run(variant, scene_name, scale=1.0, resolution=256, spp=16, repeats=3):
+    '''
+    Benchmark one reference scene in the current process and return the
+    measurements as a dictionary.
+    '''
+    import drjit as dr
+    import mitsuba as mi
+
+    mi.set_variant(variant)
+    width = height = max(int(resolution), 8)
+
+    with tempfile.TemporaryDirectory() as tmp_dir:
+        # Create the objects of the scene on their own, so that the
+        # acceleration data structure build can be timed separately
+        start = time.perf_counter()
+        objects = {}
+        for key, value in _SCENE_FUNCTIONS[scene_name](mi, tmp_dir, scale).items():
+            objects[key] = mi.load_dict(value)
+        load_time = time.perf_counter() - start
+
+        start = time.perf_counter()
+        scene = mi.load_dict({
+            'type': 'scene',
+            **objects,
+            'sensor': {
+                'type': 'perspective',
+                'fov': 45,
+                'to_world': mi.ScalarTransform4f.look_at(
+                    origin=[0, -3, 2.5], target=[0, 0, 0], up=[0, 0, 1]),
+                'film': {
+                    'type': 'hdrfilm',
+                    'width': width,
+                    'height': height,
+                    'rfilter': { 'type': 'box' }
+                },
+                'sampler': { 'type': 'independent' }
+            }
+        })
+        dr.sync_thread()
+        accel_time = time.perf_counter() - start
+
+    samples = width * height * spp
+    ray_time = _render_time(mi, dr, scene, mi.load_dict({ 'type': 'depth' }),
+                            spp, repeats)
+    sample_time = _render_time(mi, dr, scene, scene.integrator(), spp, repeats)
+
+    return {
+        'variant': variant,
+        'scene': scene_name,
+        'scale': scale,
+        'resolution': [width, height],
+        'spp': spp,
+        'load_time_s': load_time,
+        'accel_build_time_s': accel_time,
+        'primary_mrays_per_s': samples / ray_time * 1e-6,
+        'samples_per_s': samples / sample_time,
+        'render_time_s': sample_time,
+        'peak_rss_mib': peak_rss(),
+        'scene_hash': scene_hash(scene_name, scale, resolution, spp),
+        'cpu_model': cpu_model(),
+        'threads': mi.Thread.thread_count(),
+    }
+
+
+def run_process(variant, scene_name, **options):
+    '''
+    Benchmark one reference scene like :py:func:`run`, but in a separate
+    Python process. Raises a ``RuntimeError`` with the error output if it
+    fails.
+    '''
+    command = [sys.executable, '-m', 'mitsuba.bench', '--run',
+               variant, scene_name]
+    for key, value in options.items():
+        command += ['--' + key, str(value)]
+    process = subprocess.run(command, stdout=subprocess.PIPE,
+                             stderr=subprocess.PIPE, text=True)
+    if process.returncode != 0:
+        raise RuntimeError(process.stderr.strip())
+    return json.loads(process.stdout.strip().splitlines()[-1])
+
+
+class BaselineStore:
+    '''
+    Versioned file of benchmark results that later runs are compared with
+
+    Every entry stores the result of :py:func:`run` together with the commit
+    and time of the run. Entries are identified by :py:meth:`key`, hence a
+    new result for the same configuration replaces the previous baseline.
+    '''
+
+    def __init__(self, filename=None):
+        self.filename = filename
+        self.entries = {}
+        if filename is not None and os.path.exists(filename):
+            self.load(filename)
+
+    @staticmethod
+    def key(result):
+        '''Return the configuration of a result that baselines must match'''
+        return '%s/%s/%s/%s/%s threads' % (
+            result['variant'], result['scene'], result['scene_hash'],
+            result['cpu_model'], result['threads'])
+
+    def load(self, filename):
+        with open(filename) as f:
+            data = json.load(f)
+        version = data.get('version')
+        if version != BASELINE_VERSION:
+            raise ValueError('"%s": unsupported baseline file version %s '
+                             '(expected %i)' % (filename, version,
+                                                BASELINE_VERSION))
+        self.entries = data['entries']
+
+    def save(self, filename=None):
+        '''Write the baselines, replacing the file atomically'''
+        filename = filename or self.filename
+        tmp_filename = filename + '.tmp'
+        with open(tmp_filename, 'w') as f:
+            json.dump({ 'version': BASELINE_VERSION, 'entries': self.entries },
+                      f, indent=2, sort_keys=True)
+        os.replace(tmp_filename, filename)
+
+    def get(self, result):
+        '''Return the baseline result for the configuration of ``result``'''
+        entry = self.entries.get(self.key(result))
+        return entry['result'] if entry is not None else None
+
+    def update(self, result, commit=None):
+        '''Make ``result`` the baseline of its configuration'''
+        self.entries[self.key(result)] = {
+            'commit': commit if commit is not None else git_commit(),
+            'timestamp': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+            'result': result,
+        }
+
+    def compare(self, result, threshold=0.1):
+        '''
+        Compare ``result`` with its baseline and return the regressions, i.e.
+        the measurements of :py:data:`METRICS` that are worse than the baseline
+        by more than the relative ``threshold``. Every regression is a
+        dictionary with the ``metric``, the ``baseline`` and ``value``, and the
+        relative ``change`` (negative for slowdowns). Returns ``None`` if there
+        is no baseline.
+        '''
+        baseline = self.get(result)
+        if baseline is None:
+            return None
+        regressions = []
+        for metric, larger_is_better in METRICS.items():
+            old, new = baseline.get(metric), result.get(metric)
+            if not old or new is None:
+                continue
+            # Relative change of the performance, negative if it got worse
+            if larger_is_better:
+                change = new / old - 1
+            else:
+                change = old / new - 1 if new > 0 else float('inf')
+            if change < -threshold:
+                regressions.append({ 'metric': metric, 'baseline': old,
+                                     'value': new, 'change': change })
+        return regressions
+
+
+def _system_info():
+    import drjit as dr
+    import mitsuba as mi
+    return {
+        'mitsuba_version': mi.__version__,
+        'drjit_version': dr.__version__,
+        'python_version': platform.python_version(),
+        'platform': platform.platform(),
+        'processor': platform.processor(),
+        'cpu_count': os.cpu_count(),
+        'cpu_model': cpu_model(),
+        'commit': git_commit(),
+        'timestamp': time.strftime('%Y-%m-%dT%H:%M:%S%z'),
+    }
+
+
+def main(args=None):
+    parser = argparse.ArgumentParser(prog='python -m mitsuba.bench',
+                                     description='Mitsuba render benchmark suite')
+    parser.add_argument('--variants', type=str, default=None,
+                        help='comma-separated list of variants (default: '
+                             'those of %s that are available)' %
+                             ', '.join(DEFAULT_VARIANTS))
+    parser.add_argument('--scenes', type=str, default=','.join(SCENES),
+                        help='comma-separated list of scenes (default: all of '
+                             '%s)' % ', '.join(SCENES))
+    parser.add_argument('--scale', type=float, default=1.0,
+                        help='scale of the scene complexity, e.g. 0.1 for a '
+                             'quick check (default: 1)')
+    parser.add_argument('--resolution', type=int, default=256,
+                        help='width and height of the rendered images')
+    parser.add_argument('--spp', type=int, default=16,
+                        help='samples per pixel of the timed renders')
+    parser.add_argument('--repeats', type=int, default=3,
+                        help='number of timed renders, the best one counts')
+    parser.add_argument('--output', '-o', type=str, default=None,
+                        help='write the results to this JSON file')
+    parser.add_argument('--baseline', type=str, default=None,
+                        help='compare the results with the baselines in this '
+                             'file')
+    parser.add_argument('--update-baseline', action='store_true',
+                        help='store the results as the new baselines instead')
+    parser.add_argument('--threshold', type=float, default=0.1,
+                        help='relative slowdown that counts as a regression '
+                             '(default: 0.1)')
+    parser.add_argument('--run', nargs=2, metavar=('VARIANT', 'SCENE'),
+                        help=argparse.SUPPRESS)
+    args = parser.parse_args(args)
+
+    options = dict(scale=args.scale, resolution=args.resolution,
+                   spp=args.spp, repeats=args.repeats)
+
+    # Worker mode: benchmark a single scene and print the result as JSON
+    if args.run:
+        print(json.dumps(run(*args.run, **options)))
+        return 0
+
+    import mitsuba as mi
+    if args.variants:
+        variants = args.variants.split(',')
+    else:
+        variants = [v for v in DEFAULT_VARIANTS if v in mi.variants()]
+    scenes = args.scenes.split(',')
+    for s in scenes:
+        if s not in SCENES:
+            parser.error('unknown scene "%s"' % s)
+    for v in variants:
+        if v not in mi.variants():
+            parser.error('variant "%s" is not available' % v)
+    if args.update_baseline and not args.baseline:
+        parser.error('--update-baseline requires --baseline')
+    store = BaselineStore(args.baseline) if args.baseline else None
+
+    results, failed, regressed = [], False, False
+    print('%-14s %-14s %9s %9s %10s %12s %9s' % (
+        'variant', 'scene', 'load [s]', 'accel [s]', 'Mrays/s',
+        'samples/s', 'RSS [MiB]'))
+    for variant in variants:
+        for scene in scenes:
+            try:
+                r = run_process(variant, scene, **options)
+            except RuntimeError as e:
+                failed = True
+                print('%-14s %-14s failed:\n%s' % (variant, scene, e))
+                results.append({ 'variant': variant, 'scene': scene,
+                                 'error': str(e) })
+                continue
+            results.append(r)
+            rss = r['peak_rss_mib']
+            print('%-14s %-14s %9.3f %9.3f %10.2f %12.4g %9s' % (
+                variant, scene, r['load_time_s'], r['accel_build_time_s'],
+                r['primary_mrays_per_s'], r['samples_per_s'],
+                '%.1f' % rss if rss is not None else 'n/a'))
+
+            if store is None:
+                continue
+            if args.update_baseline:
+                store.update(r)
+                continue
+            regressions = store.compare(r, args.threshold)
+            if regressions is None:
+                print('%-29s no baseline' % '')
+            for reg in regressions or []:
+                regressed = True
+                print('%-29s regression of %s: %.4g -> %.4g (%+.1f%%)' % (
+                    '', reg['metric'], reg['baseline'], reg['value'],
+                    100 * reg['change']))
+
+    if args.update_baseline:
+        store.save()
+        print('Updated the baselines in "%s".' % args.baseline)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump({ 'system': _system_info(), 'options': options,
+                        'results': results }, f, indent=2)
+
+    return 1 if failed or regressed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,283 @@
+'''
+Incremental re-rendering
+
+This module re-renders only the part of an image that is affected by a change
+of the scene, e.g. when the material of a single object is edited in a
+look-dev session. The affected region is the screen-space footprint of the
+modified shapes: the projection of their bounding boxes (before and after the
+change), or, in JIT variants, the pixels where they are visible according to
+a primary-visibility ID buffer. The region is rendered through the crop window
+of the film and pasted into the cached image.
+
+.. code-block:: python
+
+    from mitsuba import incremental
+    renderer = incremental.IncrementalRenderer(scene, spp=64)
+    image = renderer.render()
+
+    params['my_shape.bsdf.reflectance.value'] = [0.8, 0.2, 0.2]
+    params.update()
+    image = renderer.update([scene_shape])
+
+.. warning:: Only the pixels where the modified shapes are directly visible
+   are updated. Their influence on the rest of the image (reflections,
+   shadows, indirect illumination) is not, so the result is exact for AOVs
+   that only depend on direct visibility and an approximation otherwise. Call
+   :py:meth:`IncrementalRenderer.render` to refresh the complete image.
+'''
+
+import numpy as np
+
+import drjit as dr
+import mitsuba as mi
+
+
+def _film_rect(film):
+    '''Return the region of the film as ``(offset, size)`` numpy arrays'''
+    return (np.array(film.crop_offset(), dtype=np.int64),
+            np.array(film.crop_size(), dtype=np.int64))
+
+
+def _vector(cls, value):
+    '''Convert a numpy array with two entries into a Mitsuba vector type'''
+    return cls(int(value[0]), int(value[1]))
+
+
+def _scalar(value):
+    '''Return the first entry of a Dr.Jit array in JIT variants'''
+    return float(value[0] if dr.is_jit_v(value) else value)
+
+
+def project_bbox(sensor, bbox):
+    '''
+    Compute a conservative footprint of a bounding box on the film of a sensor
+
+    The footprint is the bounding rectangle of the projected corners of the
+    box. Sensors other than ``perspective`` cameras, and boxes that extend
+    behind the near clipping plane, cover the complete film.
+
+    Returns → tuple | None:
+        ``(offset, size)`` of the covered pixels (as numpy arrays), or
+        ``None`` when the box lies outside of the field of view.
+    '''
+    film_size = np.array(sensor.film().size(), dtype=np.int64)
+    full = (np.zeros(2, dtype=np.int64), film_size)
+    if sensor.class_().name() != 'PerspectiveCamera' or not bbox.valid():
+        return full
+
+    size = _vector(mi.ScalarVector2i, film_size)
+    x_fov = _scalar(mi.traverse(sensor)['x_fov'])
+    to_sample = mi.perspective_projection(size, size, mi.ScalarVector2i(0),
+                                          x_fov, sensor.near_clip(),
+                                          sensor.far_clip())
+    to_local = sensor.world_transform().inverse()
+
+    def project(p):
+        p = to_local @ p
+        s = to_sample @ p
+        return _scalar(p.z), np.array([_scalar(s.x), _scalar(s.y)])
+
+    # The projection ignores other camera parameters (e.g. the principal point
+    # offset): make sure that it maps the central ray to the film center
+    ray, _ = sensor.sample_ray(0, 0.5, [0.5, 0.5], [0.5, 0.5])
+    if not np.allclose(project(ray.o + ray.d)[1], 0.5, atol=1e-3):
+        return full
+
+    points = []
+    for i in range(8):
+        z, s = project(mi.Point3f(bbox.corner(i)))
+        if z <= sensor.near_clip():
+            return full
+        points.append(s)
+
+    points = np.array(points) * film_size
+    lower = np.maximum(np.floor(points.min(axis=0)), 0).astype(np.int64)
+    upper = np.minimum(np.ceil(points.max(axis=0)), film_size).astype(np.int64)
+    if np.any(upper <= lower):
+        return None
+    return lower, upper - lower
+
+
+def visibility_ids(scene, sensor, spp=4):
+    '''
+    Trace a primary-visibility ID buffer (JIT variants only)
+
+    Every pixel of the film receives ``spp`` stratified primary rays. The
+    result holds the ID of the shape hit by each ray (zero for misses), with
+    shape ``(height, width, spp)``. The IDs can be compared to
+    ``dr.reinterpret_array_v(mi.UInt32, mi.ShapePtr(shape))``.
+    '''
+    if not dr.is_jit_v(mi.Float):
+        raise RuntimeError('visibility_ids(): only supported in JIT variants!')
+
+    film = sensor.film()
+    width, height = film.size()
+    n = int(np.ceil(np.sqrt(spp)))
+
+    idx = dr.arange(mi.UInt32, width * height * spp)
+    pixel, sub = idx // spp, idx % spp
+    pos = mi.Point2f(mi.Float(pixel % width) + (mi.Float(sub % n) + 0.5) / n,
+                     mi.Float(pixel // width) + (mi.Float(sub // n) + 0.5) / n)
+
+    # The sensor expects positions relative to the crop window
+    offset, size = _film_rect(film)
+    pos = (pos - mi.ScalarVector2f(offset)) / mi.ScalarVector2f(size)
+
+    ray, _ = sensor.sample_ray(0, 0.5, pos, mi.Point2f(0.5))
+    si = scene.ray_intersect(ray)
+    ids = dr.reinterpret_array_v(mi.UInt32, si.shape)
+    return np.array(ids).reshape(height, width, spp)
+
+
+class IncrementalRenderer:
+    '''
+    Re-render the footprint of modified shapes into a cached image
+
+    Parameter ``scene`` (mi.Scene):
+        Scene to render.
+
+    Parameter ``sensor`` (int | mi.Sensor):
+        Sensor (or sensor index) to render.
+
+    Parameter ``spp`` (int):
+        Samples per pixel (default: the sample count of the sensor's sampler).
+
+    Parameter ``seed`` (int):
+        Seed of the renderings.
+
+    Parameter ``visibility`` (bool):
+        Use a primary-visibility ID buffer with ``visibility_spp`` rays per
+        pixel to find the pixels covered by the modified shapes, instead of
+        projecting their bounding boxes. This yields tighter footprints, but
+        can miss features that are smaller than the spacing of the rays. It is
+        only supported by the JIT variants.
+    '''
+
+    def __init__(self, scene, sensor=0, spp=0, seed=0, visibility=False,
+                 visibility_spp=4):
+        if isinstance(sensor, int):
+            sensor = scene.sensors()[sensor]
+        if visibility and not dr.is_jit_v(mi.Float):
+            raise RuntimeError('IncrementalRenderer: the visibility buffer '
+                               'is only supported in JIT variants!')
+
+        self.scene, self.sensor = scene, sensor
+        self.spp, self.seed = spp, seed
+        self.visibility, self.visibility_spp = visibility, visibility_spp
+        self.image = None
+        self.ids = None
+        self.bboxes = []
+
+    def _record_state(self):
+        '''Store the bounding boxes and the visibility of all shapes'''
+        self.bboxes = [mi.ScalarBoundingBox3f(s.bbox())
+                       for s in self.scene.shapes()]
+        if self.visibility:
+            self.ids = visibility_ids(self.scene, self.sensor,
+                                      self.visibility_spp)
+
+    def render(self):
+        '''Render the complete image and cache it'''
+        self.image = np.array(mi.render(self.scene, sensor=self.sensor,
+                                        spp=self.spp, seed=self.seed))
+        self._record_state()
+        return self.image
+
+    def footprint(self, shapes):
+        '''
+        Compute the pixels affected by a change of the given shapes
+
+        The footprint covers the shapes both before the change (from the
+        state recorded by the last rendering) and after it.
+
+        Returns → tuple | None:
+            ``(offset, size)`` of the affected pixels, or ``None``.
+        '''
+        rects = []
+        if self.visibility:
+            ids = [dr.reinterpret_array_v(mi.UInt32, mi.ShapePtr(s))[0]
+                   for s in shapes]
+            covered = np.isin(self.ids, ids).any(axis=2)
+            covered |= np.isin(visibility_ids(self.scene, self.sensor,
+                                              self.visibility_spp), ids).any(axis=2)
+            rows, cols = np.nonzero(covered)
+            if len(rows) > 0:
+                # The rays sample the pixels sparsely, add one pixel of margin
+                lower = np.array([cols.min(), rows.min()]) - 1
+                upper = np.array([cols.max(), rows.max()]) + 2
+                rects.append((lower, upper - lower))
+        else:
+            # The bounding boxes of the last rendering are stored by shape index
+            old = {i for i, s in enumerate(self.scene.shapes())
+                   if any(s is t for t in shapes)}
+            bboxes = [s.bbox() for s in shapes] + \
+                     [b for i, b in enumerate(self.bboxes) if i in old]
+            for bbox in bboxes:
+                rect = project_bbox(self.sensor, bbox)
+                if rect is not None:
+                    rects.append(rect)
+
+        if not rects:
+            return None
+        lower = np.min([r[0] for r in rects], axis=0)
+        upper = np.max([r[0] + r[1] for r in rects], axis=0)
+        return lower, upper - lower
+
+    def update(self, objects):
+        '''
+        Re-render the footprint of modified objects into the cached image
+
+        Parameter ``objects`` (list):
+            Modified shapes. BSDFs are replaced by the shapes that use them.
+
+        Returns → numpy.ndarray:
+            The updated image.
+        '''
+        if self.image is None:
+            return self.render()
+
+        shapes = []
+        for obj in objects:
+            if isinstance(obj, mi.BSDF):
+                shapes += [s for s in self.scene.shapes() if s.bsdf() is obj]
+            else:
+                shapes.append(obj)
+
+        rect = self.footprint(shapes)
+        if rect is not None:
+            self._render_region(*rect)
+        self._record_state()
+        return self.image
+
+    def _render_region(self, lower, size):
+        film = self.sensor.film()
+        film_size = np.array(film.size(), dtype=np.int64)
+        offset, crop_size = _film_rect(film)
+
+        # Pixels within the radius of the reconstruction filter receive
+        # samples from the footprint. They are pasted once their own
+        # neighborhood has been rendered as well.
+        margin = int(np.ceil(film.rfilter().radius() - 0.5))
+        paste_lower = np.maximum(lower - margin, offset)
+        paste_upper = np.minimum(lower + size + margin, offset + crop_size)
+        if np.any(paste_upper <= paste_lower):
+            return
+        render_lower = np.maximum(paste_lower - margin, 0)
+        render_upper = np.minimum(paste_upper + margin, film_size)
+
+        try:
+            film.set_crop_window(_vector(mi.ScalarPoint2u, render_lower),
+                                 _vector(mi.ScalarVector2u, render_upper - render_lower))
+            self.sensor.parameters_changed()
+            region = np.array(mi.render(self.scene, sensor=self.sensor,
+                                        spp=self.spp, seed=self.seed))
+        finally:
+            film.set_crop_window(_vector(mi.ScalarPoint2u, offset),
+                                 _vector(mi.ScalarVector2u, crop_size))
+            self.sensor.parameters_changed()
+
+        # Paste the region, relative to the crop windows of both images
+        a, b = paste_lower - offset, paste_upper - offset
+        r = paste_lower - render_lower
+        self.image[a[1]:b[1], a[0]:b[0]] = \
+            region[r[1]:r[1] + b[1] - a[1], r[0]:r[0] + b[0] - a[0]]
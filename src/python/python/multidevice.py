@@ -0,0 +1,283 @@
+'''
+Multi-device rendering
+
+This module renders a scene file on several devices of the local machine
+(typically the GPUs of a render node) and combines their results into a single
+image. Every device is driven by a worker process that restricts itself to
+its device (through ``CUDA_VISIBLE_DEVICES``), loads the scene and builds its
+acceleration data structure once, and then pulls work items from a shared
+queue until the image is complete. Faster devices thus automatically process
+more work items.
+
+Two ways of splitting the rendering are supported:
+
+- ``passes`` (default): every work item renders the complete image with
+  ``chunk`` samples per pixel and its own seed. The raw film contents
+  (weighted sums of samples and weights) of all items are added, which gives
+  the same estimate as a single rendering with all samples.
+
+- ``regions``: every work item renders a band of ``chunk`` rows of the image
+  with all samples per pixel, using the crop window of the film. The bands
+  are stitched together. Reconstruction filters wider than a pixel do not
+  spread samples across band boundaries.
+
+Usage::
+
+    python -m mitsuba.multidevice scene.xml -o image.exr [--devices 0,1,2,3]
+                                  [--mode passes] [--spp 1024] [--chunk 64]
+
+or from Python:
+
+.. code-block:: python
+
+    from mitsuba import multidevice
+    image = multidevice.render('scene.xml', devices=[0, 1], output='image.exr')
+
+.. note:: The JIT variants drive a single device per process and the scene
+   and its acceleration data structure are replicated by every worker. The
+   scene is however only loaded once per device, and a single command renders
+   and reduces the complete image.
+'''
+
+import argparse
+import multiprocessing
+import os
+import subprocess
+import sys
+import traceback
+
+#: Ways of splitting the rendering across devices
+MODES = ['passes', 'regions']
+
+
+def cuda_device_count():
+    '''Return the number of CUDA devices visible to this process'''
+    visible = os.environ.get('CUDA_VISIBLE_DEVICES')
+    if visible is not None:
+        return len([d for d in visible.split(',') if d.strip()])
+    try:
+        out = subprocess.run(['nvidia-smi', '-L'], capture_output=True,
+                             text=True, check=True).stdout
+    except (OSError, subprocess.CalledProcessError):
+        return 0
+    return len([l for l in out.splitlines() if l.startswith('GPU')])
+
+
+def split_work(mode, spp, height, chunk=None, workers=1):
+    '''
+    Split a rendering into work items
+
+    Returns a list of ``(seed_offset, spp, row_offset, rows)`` tuples. In the
+    ``passes`` mode, the items cover the complete image and their sample
+    counts add up to ``spp``. In the ``regions`` mode, every item renders
+    ``spp`` samples of a band of rows. By default, every worker receives about
+    four items to balance the load.
+    '''
+    if mode not in MODES:
+        raise ValueError('unknown mode "%s"' % mode)
+    total = spp if mode == 'passes' else height
+    if chunk is None:
+        chunk = (total + 4 * workers - 1) // (4 * workers)
+    chunk = max(1, min(chunk, total))
+
+    items = []
+    for i, start in enumerate(range(0, total, chunk)):
+        size = min(chunk, total - start)
+        if mode == 'passes':
+            items.append((i, size, 0, height))
+        else:
+            items.append((i, spp, start, size))
+    return items
+
+
+def _worker(device, variant, filename, params, tasks, results, control):
+    '''Render work items on a single device (runs in a separate process)'''
+    if device is not None:
+        os.environ['CUDA_VISIBLE_DEVICES'] = str(device)
+
+    try:
+        import numpy as np
+        import mitsuba as mi
+        mi.set_variant(variant)
+
+        scene = mi.load_file(filename, **params)
+        sensor = scene.sensors()[0]
+        film = sensor.film()
+        integrator = scene.integrator()
+        offset, size = film.crop_offset(), film.crop_size()
+        results.put(('info', sensor.sampler().sample_count(),
+                     (int(size[0]), int(size[1]))))
+
+        accum, bands = None, []
+        while True:
+            task = tasks.get()
+            if task is None:
+                break
+            mode, seed, (seed_offset, spp, row, rows) = task
+            film.set_crop_window(mi.ScalarPoint2u(offset[0], offset[1] + row),
+                                 mi.ScalarVector2u(size[0], rows))
+            integrator.render(scene, sensor, seed=seed + seed_offset, spp=spp,
+                              develop=False)
+            raw = np.array(film.develop(raw=True))
+            if mode == 'regions':
+                bands.append((row, raw))
+            elif accum is None:
+                accum = raw
+            else:
+                accum += raw
+
+        results.put(('done', accum, bands))
+
+        # The first worker develops the reduced film
+        message = control.get()
+        if message is not None:
+            total, output = message
+            film.set_crop_window(offset, size)
+            film.prepare(integrator.aov_names())
+            film.put_block(mi.ImageBlock(mi.TensorXf(total), offset,
+                                         border=False))
+            if output:
+                film.write(output)
+            results.put(('image', np.array(film.develop())))
+    except Exception:
+        results.put(('error', traceback.format_exc()))
+
+
+def render(filename, devices=None, variant=None, mode='passes', spp=None,
+           chunk=None, seed=0, output=None, params=None):
+    '''
+    Render a scene file on several devices
+
+    Parameter ``filename`` (str):
+        Scene file to render (with its first sensor and its integrator).
+
+    Parameter ``devices`` (list):
+        CUDA device indices of the workers. ``None`` entries start workers
+        that keep the device selection of the environment (e.g. for LLVM
+        variants). Defaults to all visible CUDA devices.
+
+    Parameter ``variant`` (str):
+        Variant of the workers. Defaults to ``cuda_ad_rgb``.
+
+    Parameter ``mode`` (str):
+        Either ``passes`` or ``regions`` (see above).
+
+    Parameter ``spp`` (int):
+        Total number of samples per pixel. Defaults to the sample count of
+        the sampler of the scene.
+
+    Parameter ``chunk`` (int):
+        Samples per work item (``passes``) or rows per work item
+        (``regions``).
+
+    Parameter ``output`` (str):
+        Optional filename of the developed image.
+
+    Parameter ``params`` (dict):
+        Parameters of the scene file (see :py:func:`mitsuba.load_file`).
+
+    Returns → numpy.ndarray:
+        The developed image.
+    '''
+    if mode not in MODES:
+        raise ValueError('unknown mode "%s"' % mode)
+    if variant is None:
+        variant = 'cuda_ad_rgb'
+    if devices is None:
+        devices = list(range(cuda_device_count()))
+        if not devices:
+            raise RuntimeError('render(): no CUDA devices were found!')
+
+    ctx = multiprocessing.get_context('spawn')
+    tasks, results = ctx.Queue(), ctx.Queue()
+    controls = [ctx.Queue() for _ in devices]
+    workers = [ctx.Process(target=_worker, daemon=True,
+                           args=(d, variant, os.path.abspath(filename),
+                                 dict(params or {}), tasks, results, c))
+               for d, c in zip(devices, controls)]
+    for w in workers:
+        w.start()
+
+    def receive(kind):
+        while True:
+            message = results.get()
+            if message[0] == 'error':
+                for w in workers:
+                    w.terminate()
+                raise RuntimeError('render(): a worker failed:\n' + message[1])
+            if message[0] == kind:
+                return message[1:]
+
+    # The work items are created once the first worker loaded the scene
+    scene_spp, (width, height) = receive('info')
+    items = split_work(mode, spp or scene_spp, height, chunk, len(workers))
+    for item in items:
+        tasks.put((mode, seed, item))
+    for _ in workers:
+        tasks.put(None)
+
+    total = None
+    for _ in workers:
+        accum, bands = receive('done')
+        if accum is not None:
+            total = accum if total is None else total + accum
+        for row, band in bands:
+            if total is None:
+                import numpy as np
+                total = np.zeros((height, width, band.shape[2]),
+                                 dtype=band.dtype)
+            total[row:row + band.shape[0]] = band
+
+    controls[0].put((total, output))
+    for c in controls[1:]:
+        c.put(None)
+    image, = receive('image')
+
+    for w in workers:
+        w.join()
+    return image
+
+
+def main(args=None):
+    parser = argparse.ArgumentParser(
+        prog='python -m mitsuba.multidevice',
+        description='Render a scene on several local devices.')
+    parser.add_argument('filename', help='scene file')
+    parser.add_argument('-o', '--output', required=True,
+                        help='filename of the rendered image')
+    parser.add_argument('--devices',
+                        help='comma-separated CUDA device indices '
+                             '(default: all visible devices)')
+    parser.add_argument('--variant', default='cuda_ad_rgb',
+                        help='variant of the workers (default: cuda_ad_rgb)')
+    parser.add_argument('--mode', choices=MODES, default='passes',
+                        help='split the samples or the rows of the image '
+                             'across devices (default: passes)')
+    parser.add_argument('--spp', type=int,
+                        help='samples per pixel (default: from the scene)')
+    parser.add_argument('--chunk', type=int,
+                        help='samples or rows per work item')
+    parser.add_argument('--seed', type=int, default=0, help='seed offset')
+    parser.add_argument('-D', dest='params', action='append', default=[],
+                        metavar='KEY=VALUE', help='scene parameter')
+    args = parser.parse_args(args)
+
+    params = {}
+    for p in args.params:
+        if '=' not in p:
+            parser.error('invalid parameter "%s"' % p)
+        key, value = p.split('=', 1)
+        params[key] = value
+
+    devices = None
+    if args.devices:
+        devices = [int(d) for d in args.devices.split(',')]
+
+    render(args.filename, devices=devices, variant=args.variant,
+           mode=args.mode, spp=args.spp, chunk=args.chunk, seed=args.seed,
+           output=args.output, params=params)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,57 @@
+import pytest
+import mitsuba as mi
+
+from mitsuba import bench
+
+
+@pytest.mark.parametrize('scene', bench.SCENES)
+def test01_run_scene(variant_scalar_rgb, scene):
+    result = bench.run('scalar_rgb', scene, scale=0.001, resolution=8,
+                       spp=1, repeats=1)
+    assert result['variant'] == 'scalar_rgb'
+    assert result['scene'] == scene
+    assert result['resolution'] == [8, 8]
+    assert result['load_time_s'] >= 0
+    assert result['accel_build_time_s'] >= 0
+    assert result['primary_mrays_per_s'] > 0
+    assert result['samples_per_s'] > 0
+
+
+def test02_baseline_store(tmp_path):
+    result = {
+        'variant': 'scalar_rgb', 'scene': 'hair', 'scene_hash': '0123',
+        'cpu_model': 'CPU', 'threads': 8, 'load_time_s': 1.0,
+        'accel_build_time_s': 2.0, 'primary_mrays_per_s': 10.0,
+        'samples_per_s': 1e6
+    }
+    filename = str(tmp_path / 'baseline.json')
+    store = bench.BaselineStore(filename)
+    assert store.compare(result) is None
+    store.update(result, commit='abc')
+    store.save()
+
+    store = bench.BaselineStore(filename)
+    assert store.entries[store.key(result)]['commit'] == 'abc'
+    assert store.compare(result) == []
+
+    # Changes within the noise threshold and speedups aren't regressions
+    assert store.compare(dict(result, samples_per_s=0.95e6,
+                              load_time_s=0.5)) == []
+
+    regressions = store.compare(dict(result, samples_per_s=0.8e6,
+                                     accel_build_time_s=3.0))
+    assert [r['metric'] for r in regressions] == ['accel_build_time_s',
+                                                 'samples_per_s']
+    assert regressions[1]['change'] == pytest.approx(-0.2)
+    assert store.compare(dict(result, samples_per_s=0.8e6),
+                         threshold=0.25) == []
+
+    # Results of other configurations don't share the baseline
+    assert store.compare(dict(result, threads=4)) is None
+    assert store.compare(dict(result, scene_hash='4567')) is None
+
+
+def test03_scene_hash():
+    assert bench.scene_hash('hair') == bench.scene_hash('hair')
+    assert bench.scene_hash('hair') != bench.scene_hash('volume')
+    assert bench.scene_hash('hair') != bench.scene_hash('hair', scale=0.5)
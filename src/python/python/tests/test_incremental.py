@@ -0,0 +1,89 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+
+
+def make_scene():
+    return mi.load_dict({
+        'type': 'scene',
+        'integrator': {'type': 'direct'},
+        'sensor': {
+            'type': 'perspective',
+            'fov': 60,
+            'to_world': mi.ScalarTransform4f.look_at(origin=[0, 0, 5],
+                                                     target=[0, 0, 0],
+                                                     up=[0, 1, 0]),
+            'film': {
+                'type': 'hdrfilm',
+                'width': 32,
+                'height': 16,
+                'rfilter': {'type': 'box'}
+            },
+            'sampler': {'type': 'independent', 'sample_count': 4}
+        },
+        'emitter': {'type': 'constant'},
+        'left': {
+            'type': 'sphere',
+            'center': [-2, 0, 0],
+            'radius': 0.5,
+            'bsdf': {'type': 'diffuse', 'id': 'left_bsdf'}
+        },
+        'right': {
+            'type': 'sphere',
+            'center': [2, 0, 0],
+            'radius': 0.5,
+            'bsdf': {'type': 'diffuse'}
+        }
+    })
+
+
+def test01_project_bbox(variants_all_rgb):
+    from mitsuba.incremental import project_bbox
+
+    scene = make_scene()
+    sensor = scene.sensors()[0]
+
+    # The right sphere lies in the right half of the image
+    bbox = mi.ScalarBoundingBox3f([1.5, -0.5, -0.5], [2.5, 0.5, 0.5])
+    offset, size = project_bbox(sensor, bbox)
+    assert offset[0] >= 16 and size[0] > 0
+    assert offset[1] > 0 and offset[1] + size[1] < 16
+
+    # Boxes behind the camera conservatively cover the complete film
+    bbox = mi.ScalarBoundingBox3f([-1, -1, 4], [1, 1, 6])
+    offset, size = project_bbox(sensor, bbox)
+    assert np.all(offset == 0) and np.all(size == [32, 16])
+
+    # Boxes outside of the field of view cover nothing
+    bbox = mi.ScalarBoundingBox3f([20, -1, -1], [21, 1, 1])
+    assert project_bbox(sensor, bbox) is None
+
+
+@pytest.mark.parametrize('visibility', [False, True])
+def test02_update(variants_all_rgb, visibility):
+    from mitsuba.incremental import IncrementalRenderer
+
+    if visibility and not dr.is_jit_v(mi.Float):
+        pytest.skip('The visibility buffer requires a JIT variant')
+
+    scene = make_scene()
+    renderer = IncrementalRenderer(scene, spp=16, visibility=visibility)
+    before = renderer.render().copy()
+
+    params = mi.traverse(scene)
+    params['left_bsdf.reflectance.value'] = mi.Color3f(0.1, 0.2, 0.9)
+    params.update()
+    bsdf = [s.bsdf() for s in scene.shapes() if s.bsdf().id() == 'left_bsdf'][0]
+
+    offset, size = renderer.footprint([s for s in scene.shapes()
+                                       if s.bsdf() is bsdf])
+    assert offset[0] + size[0] <= 16
+    after = renderer.update([bsdf])
+
+    # The other half of the image is not rendered again
+    assert np.all(after[:, 16:] == before[:, 16:])
+    assert not np.allclose(after[:, :16], before[:, :16])
+
+    reference = np.array(mi.render(scene, spp=16))
+    assert np.allclose(after[:, :16].mean(), reference[:, :16].mean(), rtol=0.05)
@@ -56,3 +56,35 @@ def test03_non_unique_vertices(variants_all_ad_rgb):
     lambda_ = 25
     ls = mi.ad.LargeSteps(params['vertex_positions'], params['faces'], lambda_)
     assert ls.n_verts == 4
+
+
+@fresolver_append_path
+def test04_conjugate_gradient(variants_all_ad_rgb):
+    mesh = mi.load_dict({
+        "type" : "ply",
+        "filename" : "resources/data/tests/ply/triangle.ply",
+    })
+    params = mi.traverse(mesh)
+
+    lambda_ = 25
+    ls = mi.ad.LargeSteps(params['vertex_positions'], params['faces'], lambda_,
+                          solver='cg')
+    assert isinstance(ls.solver, mi.ad.largesteps.ConjugateGradientSolver)
+
+    initial = params['vertex_positions']
+    u = ls.to_differential(initial)
+    assert dr.allclose(initial, ls.from_differential(u), atol=1e-5)
+
+    # Subsequent solves are warm-started from the previous solution
+    assert dr.allclose(initial, ls.from_differential(u), atol=1e-5)
+    assert ls.solver.iterations == 0
+
+    # Derivatives propagate through the iterative solve
+    dr.enable_grad(u)
+    v = ls.from_differential(u)
+    dr.backward(dr.sum(v))
+    Ag = ls.solver.matvec(dr.unravel(mi.Point3f, dr.grad(u)))
+    assert dr.allclose(dr.sum(dr.ravel(Ag)), dr.width(initial), rtol=1e-4)
+
+    with pytest.raises(Exception, match='unknown solver'):
+        mi.ad.LargeSteps(params['vertex_positions'], params['faces'], solver='lu')
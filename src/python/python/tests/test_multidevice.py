@@ -0,0 +1,59 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba import multidevice
+
+SCENE = '''<scene version="3.0.0">
+    <integrator type="direct"/>
+    <sensor type="perspective">
+        <transform name="to_world">
+            <lookat origin="0, 0, 3" target="0, 0, 0" up="0, 1, 0"/>
+        </transform>
+        <film type="hdrfilm">
+            <integer name="width" value="16"/>
+            <integer name="height" value="12"/>
+            <rfilter type="box"/>
+        </film>
+        <sampler type="independent">
+            <integer name="sample_count" value="$spp"/>
+        </sampler>
+    </sensor>
+    <emitter type="constant"/>
+    <shape type="sphere">
+        <bsdf type="diffuse"/>
+    </shape>
+</scene>'''
+
+
+def test01_split_work():
+    items = multidevice.split_work('passes', spp=10, height=5, chunk=4)
+    assert items == [(0, 4, 0, 5), (1, 4, 0, 5), (2, 2, 0, 5)]
+
+    items = multidevice.split_work('regions', spp=10, height=5, chunk=2)
+    assert items == [(0, 10, 0, 2), (1, 10, 2, 2), (2, 10, 4, 1)]
+
+    # By default, every worker receives about four work items
+    assert len(multidevice.split_work('passes', 64, 8, workers=2)) == 8
+    assert len(multidevice.split_work('regions', 64, 100, workers=3)) == 12
+
+    with pytest.raises(ValueError, match='unknown mode'):
+        multidevice.split_work('tiles', 4, 4)
+
+
+@pytest.mark.slow
+@pytest.mark.parametrize('mode', multidevice.MODES)
+def test02_render(variant_scalar_rgb, tmp_path, mode):
+    filename = tmp_path / 'scene.xml'
+    filename.write_text(SCENE)
+    output = str(tmp_path / 'image.exr')
+
+    image = multidevice.render(str(filename), devices=[None, None],
+                               variant='scalar_rgb', mode=mode, spp=64,
+                               output=output, params={'spp': '4'})
+    assert image.shape == (12, 16, 3)
+
+    ref = mi.render(mi.load_file(str(filename), spp='256'))
+    assert dr.allclose(image.mean(), dr.mean(ref.array), rtol=2e-2)
+    import numpy as np
+    assert np.allclose(np.array(mi.Bitmap(output)), image)
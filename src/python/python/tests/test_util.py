@@ -312,3 +312,60 @@ def test06_variant_context():
     except RuntimeError:
         pass
     assert mi.variant() == "scalar_rgb"
+
+
+def test07_prewarm(variants_all_rgb):
+    scene = mi.load_dict(mi.cornell_box())
+    img_ref = mi.render(scene, spp=4)
+
+    # Prewarming doesn't change the result of the following renderings
+    mi.prewarm(scene, spp=4)
+    img = mi.render(scene, spp=4)
+    assert dr.allclose(img, img_ref)
+
+
+def test08_render_concurrent(variants_all_rgb):
+    scenes = [mi.load_dict(mi.cornell_box()) for _ in range(3)]
+    refs = [mi.render(scene, spp=4, seed=i) for i, scene in enumerate(scenes)]
+
+    # Concurrent jobs produce the same images as sequential renderings
+    images = mi.render_concurrent(
+        [{'scene': scene, 'spp': 4, 'seed': i} for i, scene in enumerate(scenes)])
+    assert len(images) == 3
+    for img, ref in zip(images, refs):
+        assert dr.allclose(img, ref)
+
+    assert mi.render_concurrent([]) == []
+    assert dr.allclose(mi.render_concurrent(scenes[:1], max_workers=1)[0],
+                       mi.render(scenes[0]))
+
+
+def test09_scene_parameters_update_modified_only(variants_all_ad_rgb):
+    scene = mi.load_dict({
+        'type': 'scene',
+        **{f'sphere_{i}': {
+            'type': 'sphere',
+            'center': [i, 0, 0],
+            'bsdf': {'type': 'diffuse'}
+        } for i in range(4)}
+    })
+    params = mi.traverse(scene)
+
+    # Reading parameters doesn't mark them as modified
+    for key in params.keys():
+        params[key]
+    assert params.update() == []
+
+    params['sphere_1.bsdf.reflectance.value'] = 0.25
+    params['sphere_2.bsdf.reflectance.value'] = 0.75
+    assert params.dirty_keys == {'sphere_1.bsdf.reflectance.value',
+                                 'sphere_2.bsdf.reflectance.value'}
+    ret = params.update()
+
+    # The textures, BSDFs and shapes are notified once before the scene
+    nodes = [node for node, _ in ret]
+    assert len(nodes) == 7 and nodes[-1] is scene
+    assert len(set(id(n) for n in nodes)) == len(nodes)
+    assert params.dirty_keys == set()
+    assert dr.allclose(params['sphere_2.bsdf.reflectance.value'], 0.75)
+
@@ -29,6 +29,7 @@ class SceneParameters(Mapping):
         self.hierarchy  = hierarchy  if hierarchy  is not None else {}
         self.update_candidates = {}
         self.nodes_to_update = {}
+        self.dirty_keys = set()
 
         self.set_property = mi.set_property
         self.get_property = mi.get_property
@@ -167,6 +168,8 @@ class SceneParameters(Mapping):
                 "gradients enabled, unexpected results may occur!"
             )
 
+        self.dirty_keys.add(key)
+
         node_key = key
         while node is not None:
             parent, depth = self.hierarchy[node]
@@ -214,19 +217,22 @@ class SceneParameters(Mapping):
 
             self.set_dirty(key)
 
-        for key in self.keys():
-            dr.schedule(self.__get_value(key))
+        # Only the modified parameters can have pending computations
+        for key in self.dirty_keys:
+            if key in self.properties:
+                dr.schedule(self.__get_value(key))
 
-        # Notify nodes from bottom to top
-        work_list = [(d, n, k) for (d, n), k in self.nodes_to_update.items()]
-        work_list = reversed(sorted(work_list, key=lambda x: x[0]))
+        # Notify nodes from bottom to top, every node (e.g. the scene and its
+        # acceleration data structure) is only updated once
+        work_list = sorted(self.nodes_to_update.items(), key=lambda x: -x[0][0])
         out = []
-        for _, node, keys in work_list:
+        for (_, node), keys in work_list:
             node.parameters_changed(list(keys))
             out.append((node, keys))
 
         self.nodes_to_update.clear()
         self.update_candidates.clear()
+        self.dirty_keys.clear()
         dr.eval()
 
         return out
@@ -522,6 +528,96 @@ def render(scene: mi.Scene,
     return dr.custom(_RenderOp, scene, sensor, params, integrator,
                      (seed, seed_grad), (spp, spp_grad))
 
+def prewarm(scene: mi.Scene,
+            sensor: Union[int, mi.Sensor] = 0,
+            integrator: mi.Integrator = None,
+            spp: int = 0) -> None:
+    """
+    Compile the kernels needed to render a scene without keeping the image.
+
+    Dr.Jit stores compiled kernels in a cache in memory and on disk, and
+    Mitsuba keeps the compiled OptiX modules in an on-disk cache (see the
+    ``MI_OPTIX_CACHE_DIR`` environment variable). Rendering a scene once
+    therefore fills these caches, and later renderings that produce the same
+    kernels (e.g. in another process) skip the compilation. Kernels are
+    shared by renderings with the same scene signature: the same types of
+    plugins and the same integrator, film size and sample count. Parameter
+    values that are updated with ``mi.traverse()`` don't change the kernels.
+
+    This function does nothing in the scalar variants.
+
+    Parameter ``scene`` (``mi.Scene``):
+        The scene whose kernels should be compiled.
+
+    Parameter ``sensor`` (``int``, ``mi.Sensor``):
+        Sensor (or sensor index) that will be used for rendering.
+
+    Parameter ``integrator`` (``mi.Integrator``):
+        Optional integrator that will be used for rendering instead of the one
+        of the scene.
+
+    Parameter ``spp`` (``int``):
+        Number of samples per pixel that will be used for rendering. The value
+        of the scene description is used if ``spp=0``.
+    """
+
+    if not dr.is_jit_v(mi.Float):
+        return
+
+    with dr.suspend_grad():
+        image = render(scene, sensor=sensor, integrator=integrator, spp=spp)
+        dr.eval(image)
+    dr.sync_thread()
+
+def render_concurrent(jobs: list, max_workers: int = None) -> list:
+    """
+    Render several independent scenes concurrently in this process.
+
+    Every job runs on its own thread, which releases the GIL while rendering.
+    Dr.Jit keeps the state of every thread separate: in CUDA variants, the
+    kernels of every job are launched on their own stream, and in LLVM
+    variants, the kernels of all jobs share the worker threads of Dr.Jit.
+    The scalar variants render the blocks of all jobs on the shared Mitsuba
+    thread pool. Small renderings can thus keep a large GPU or CPU busy.
+
+    Jobs must not share scenes, integrators or sensors with each other or
+    with other threads while they run, since their state (e.g. the films)
+    is modified during rendering.
+
+    Parameter ``jobs`` (``list``):
+        List of scenes, or of dictionaries with the arguments of
+        :py:func:`mitsuba.render` (e.g. ``{'scene': scene, 'spp': 16}``).
+
+    Parameter ``max_workers`` (``int``):
+        Maximal number of jobs that run at the same time. By default, all
+        jobs start immediately.
+
+    Returns → ``list``:
+        The rendered images, in the order of the jobs.
+    """
+
+    import concurrent.futures
+
+    jobs = [{'scene': job} if isinstance(job, mi.Scene) else dict(job)
+            for job in jobs]
+    if not jobs:
+        return []
+
+    # The jobs inherit the logger and file resolver of the calling thread
+    env = mi.ThreadEnvironment()
+
+    def run(job):
+        with mi.ScopedSetThreadEnvironment(env):
+            image = render(**job)
+            dr.eval(image)
+            if dr.is_jit_v(mi.Float):
+                dr.sync_thread()
+            return image
+
+    with concurrent.futures.ThreadPoolExecutor(
+            max_workers=max_workers or len(jobs)) as pool:
+        return list(pool.map(run, jobs))
+
 # ------------------------------------------------------------------------------
 
 def convert_to_bitmap(data, uint8_srgb=True):
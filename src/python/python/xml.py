@@ -737,3 +737,310 @@ def dict_to_xml(scene_dict, filename, split_files=False):
     except Exception as e:
         writer.exit() # Close all files in case of a failure
         raise e
+
+
+# ------------------------------------------------------------------------
+#  Binary scene description
+# ------------------------------------------------------------------------
+
+_BINARY_MAGIC = b'MISCENE\0'
+_BINARY_VERSION = 1
+
+# Entry types of the binary scene format
+_BIN_BOOL, _BIN_INT, _BIN_FLOAT, _BIN_STRING, _BIN_DICT, _BIN_VECTOR, \
+    _BIN_ARRAY = range(7)
+
+# Alignment of binary blobs (allows vectorized access to memory-mapped data)
+_BINARY_ALIGNMENT = 64
+
+
+def _binary_dtypes():
+    header = np.dtype([('magic', 'S8'), ('version', '<u4'), ('nodes', '<u4'),
+                       ('entries', '<u4'), ('pad', '<u4'), ('strings', '<u8'),
+                       ('blobs', '<u8')])
+    node = np.dtype([('first', '<u4'), ('count', '<u4')])
+    entry = np.dtype([('key', '<u4'), ('type', '<u4'), ('cls', '<u4'),
+                      ('pad', '<u4'), ('a', '<u8'), ('b', '<u8')])
+    return header, node, entry
+
+
+def dict_to_binary(scene_dict, filename):
+    '''
+    Converts a Mitsuba dictionary into a compact binary representation that
+    can be loaded with :py:func:`load_binary` without any text parsing.
+
+    The file stores a table of dictionaries, a table of typed entries, a pool
+    of (deduplicated) strings, and the contents of arrays and tensors (e.g.
+    mesh or texture data) as aligned binary blobs. The latter are memory
+    mapped when the file is loaded, so only the parts that are actually
+    accessed are read from disk.
+
+    Supported values are booleans, integers, floats, strings, nested
+    dictionaries, transforms, 3D points/vectors/colors, lists of numbers,
+    NumPy arrays, as well as Dr.Jit arrays and tensors. Object references
+    (``{'type': 'ref', 'id': ...}``) are stored like any other dictionary,
+    so that shared objects are only instantiated once.
+
+    Parameter ``scene_dict``:
+        Mitsuba dictionary
+    Parameter ``filename``:
+        Output filename
+    '''
+    header_t, node_t, entry_t = _binary_dtypes()
+
+    nodes, entries = [], []
+    strings, string_pool = {}, bytearray()
+    blobs = bytearray()
+
+    def string(s):
+        if s not in strings:
+            strings[s] = len(string_pool)
+            encoded = s.encode('utf-8')
+            string_pool.extend(len(encoded).to_bytes(4, 'little'))
+            string_pool.extend(encoded)
+        return strings[s]
+
+    def blob(data):
+        offset = (len(blobs) + _BINARY_ALIGNMENT - 1) // _BINARY_ALIGNMENT * _BINARY_ALIGNMENT
+        blobs.extend(b'\0' * (offset - len(blobs)))
+        blobs.extend(data)
+        return offset
+
+    def vector(values, cls):
+        values = np.asarray(values, dtype=np.float64).ravel()
+        return (_BIN_VECTOR, string(cls), blob(values.tobytes()), values.size)
+
+    def array(values, kind):
+        values = np.ascontiguousarray(values)
+        desc = '%s|%s|%s' % (kind, values.dtype.str,
+                             ','.join(str(s) for s in values.shape))
+        return (_BIN_ARRAY, string(desc), blob(values.tobytes()), values.nbytes)
+
+    def encode(key, value):
+        name = type(value).__name__
+        if isinstance(value, bool):
+            return (_BIN_BOOL, 0, int(value), 0)
+        elif isinstance(value, int):
+            return (_BIN_INT, 0, value & 0xFFFFFFFFFFFFFFFF, 0)
+        elif isinstance(value, float):
+            return (_BIN_FLOAT, 0, int(np.float64(value).view(np.uint64)), 0)
+        elif isinstance(value, str):
+            return (_BIN_STRING, 0, string(value), 0)
+        elif isinstance(value, dict):
+            return (_BIN_DICT, 0, process(value), 0)
+        elif 'Transform4' in name:
+            return vector(np.array(value.matrix), 'ScalarTransform4f')
+        elif isinstance(value, (list, tuple)):
+            return vector(value, 'list')
+        elif isinstance(value, np.ndarray):
+            return array(value, 'numpy')
+        elif dr.is_array_v(value) and value.IsTensor:
+            return array(value.numpy(), 'tensor')
+        elif dr.is_array_v(value) and dr.size_v(value) == 3:
+            return vector(np.array(value), 'Scalar' + name.replace('Scalar', ''))
+        elif dr.is_array_v(value) and dr.depth_v(value) == 1:
+            return array(value.numpy(), 'array:' + name)
+        raise Exception('dict_to_binary(): unsupported value of type "%s" '
+                        'for key "%s"!' % (name, key))
+
+    def process(d):
+        index = len(nodes)
+        nodes.append(None)
+        items = [(string(k), encode(k, v)) for k, v in d.items()]
+        nodes[index] = (len(entries), len(items))
+        for key, (t, cls, a, b) in items:
+            entries.append((key, t, cls, 0, a, b))
+        return index
+
+    process(scene_dict)
+
+    header = np.zeros(1, dtype=header_t)
+    header['magic'] = _BINARY_MAGIC
+    header['version'] = _BINARY_VERSION
+    header['nodes'] = len(nodes)
+    header['entries'] = len(entries)
+    header['strings'] = len(string_pool)
+    header['blobs'] = len(blobs)
+
+    with open(filename, 'wb') as f:
+        f.write(header.tobytes())
+        f.write(np.array(nodes, dtype=node_t).tobytes())
+        f.write(np.array(entries, dtype=entry_t).tobytes())
+        f.write(bytes(string_pool))
+        f.write(b'\0' * (-f.tell() % _BINARY_ALIGNMENT))
+        f.write(bytes(blobs))
+
+
+def binary_to_dict(filename):
+    '''
+    Reads a binary scene description written by :py:func:`dict_to_binary`
+    and returns the corresponding Mitsuba dictionary. Arrays and tensors are
+    memory mapped, and converted to the types of the current variant.
+
+    Parameter ``filename``:
+        Input filename
+    '''
+    import mmap
+    import mitsuba
+
+    header_t, node_t, entry_t = _binary_dtypes()
+
+    with open(filename, 'rb') as f:
+        buf = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+
+    header = np.frombuffer(buf, dtype=header_t, count=1)[0]
+    if header['magic'] != _BINARY_MAGIC.rstrip(b'\0'):
+        raise Exception('binary_to_dict(): "%s" is not a binary scene '
+                        'description!' % filename)
+    if header['version'] != _BINARY_VERSION:
+        raise Exception('binary_to_dict(): unsupported version %i of the '
+                        'binary scene format!' % header['version'])
+
+    offset = header_t.itemsize
+    nodes = np.frombuffer(buf, dtype=node_t, count=int(header['nodes']),
+                          offset=offset).tolist()
+    offset += node_t.itemsize * len(nodes)
+    entries = np.frombuffer(buf, dtype=entry_t, count=int(header['entries']),
+                            offset=offset).tolist()
+    offset += entry_t.itemsize * len(entries)
+    strings_offset = offset
+    offset += int(header['strings'])
+    blobs_offset = offset + (-offset % _BINARY_ALIGNMENT)
+
+    string_cache = {}
+    def string(index):
+        s = string_cache.get(index, None)
+        if s is None:
+            start = strings_offset + index + 4
+            size = int.from_bytes(buf[start - 4:start], 'little')
+            s = buf[start:start + size].decode('utf-8')
+            string_cache[index] = s
+        return s
+
+    def decode(t, cls, a, b):
+        if t == _BIN_BOOL:
+            return bool(a)
+        elif t == _BIN_INT:
+            return a - (1 << 64) if a >= (1 << 63) else a
+        elif t == _BIN_FLOAT:
+            return float(np.uint64(a).view(np.float64))
+        elif t == _BIN_STRING:
+            return string(a)
+        elif t == _BIN_DICT:
+            return build(a)
+        elif t == _BIN_VECTOR:
+            values = np.frombuffer(buf, dtype=np.float64, count=b,
+                                   offset=blobs_offset + a)
+            cls = string(cls)
+            if cls == 'list':
+                return values.tolist()
+            elif cls == 'ScalarTransform4f':
+                return mitsuba.ScalarTransform4f(values.reshape(4, 4).tolist())
+            return getattr(mitsuba, cls)(*values.tolist())
+        elif t == _BIN_ARRAY:
+            kind, dtype, shape = string(cls).split('|')
+            shape = tuple(int(s) for s in shape.split(',') if s)
+            values = np.frombuffer(buf, dtype=np.dtype(dtype),
+                                   count=b // np.dtype(dtype).itemsize,
+                                   offset=blobs_offset + a).reshape(shape)
+            if kind == 'numpy':
+                return values
+            elif kind == 'tensor':
+                return mitsuba.TensorXf(values) if values.dtype.kind == 'f' \
+                    else mitsuba.TensorXi(values)
+            return getattr(mitsuba, kind[len('array:'):])(values)
+        raise Exception('binary_to_dict(): invalid entry type %i!' % t)
+
+    def build(index):
+        first, count = nodes[index]
+        return {
+            string(key): decode(t, cls, a, b)
+            for key, t, cls, _, a, b in entries[first:first + count]
+        }
+
+    return build(0)
+
+
+def load_binary(filename, **kwargs):
+    '''
+    Loads a binary scene description written by :py:func:`dict_to_binary`.
+    Additional keyword arguments are forwarded to ``mitsuba.load_dict()``.
+
+    Parameter ``filename``:
+        Input filename
+    '''
+    import mitsuba
+    return mitsuba.load_dict(binary_to_dict(filename), **kwargs)
+
+
+# ------------------------------------------------------------------------
+#  Mesh export
+# ------------------------------------------------------------------------
+
+def export_meshes(scene, directory, threads=None):
+    '''
+    Writes all meshes of a scene into binary PLY files in a directory.
+
+    The meshes are written concurrently, and every file is assembled in
+    parallel, see :py:meth:`mitsuba.Mesh.write_ply`. Vertex positions are
+    stored in world space. BSDFs, media and emitters attached to the meshes
+    are not exported.
+
+    Parameter ``scene``:
+        Scene (or list of shapes) whose meshes should be exported
+
+    Parameter ``directory``:
+        Output directory, which is created if it does not exist
+
+    Parameter ``threads``:
+        Number of meshes that are written at the same time (default: the
+        number of CPU cores)
+
+    Returns:
+        A dictionary mapping mesh names to ``ply`` shape dictionaries that
+        reference the written files. Meshes are named after their ids when
+        these are unique, and numbered otherwise. Names that would still
+        refer to the same file (e.g. after replacing special characters of
+        the ids) receive a numeric suffix.
+    '''
+    from concurrent.futures import ThreadPoolExecutor
+    from collections import Counter
+    import re
+
+    shapes = scene.shapes() if hasattr(scene, 'shapes') else scene
+    meshes = [s for s in shapes if s.is_mesh()]
+    os.makedirs(directory, exist_ok=True)
+
+    ids = [m.id() for m in meshes]
+    counts = Counter(ids)
+    names, used = [], set()
+    for i, id_ in enumerate(ids):
+        if id_ and counts[id_] == 1:
+            base = re.sub(r'[^A-Za-z0-9_.-]', '_', id_)
+        else:
+            base = 'mesh_%04i' % i
+
+        # File names are compared case-insensitively for portability
+        name, suffix = base, 1
+        while name.lower() in used:
+            name = '%s_%i' % (base, suffix)
+            suffix += 1
+        used.add(name.lower())
+        names.append(name)
+
+    result = {}
+    for mesh, name in zip(meshes, names):
+        result[name] = {
+            'type': 'ply',
+            'filename': os.path.join(directory, name + '.ply'),
+            'face_normals': mesh.has_face_normals(),
+            'flip_normals': mesh.has_flipped_normals()
+        }
+
+    with ThreadPoolExecutor(max_workers=threads) as pool:
+        futures = [pool.submit(mesh.write_ply, result[name]['filename'])
+                   for mesh, name in zip(meshes, names)]
+        for f in futures:
+            f.result()
+
+    return result
@@ -4,7 +4,7 @@
 NAMESPACE_BEGIN(mitsuba)
 
 MI_VARIANT BSDF<Float, Spectrum>::BSDF(const Properties &props)
-    : m_flags(+BSDFFlags::Empty), m_id(props.id()) { }
+    : m_flags(+BSDFFlags::Empty), m_alpha_test(false), m_id(props.id()) { }
 
 MI_VARIANT BSDF<Float, Spectrum>::~BSDF() { }
 
@@ -40,6 +40,32 @@ MI_VARIANT Spectrum BSDF<Float, Spectrum>::eval_diffuse_reflectance(
     return eval(ctx, si, wo, active) * dr::Pi<Float>;
 }
 
+MI_VARIANT typename BSDF<Float, Spectrum>::Mask
+BSDF<Float, Spectrum>::alpha_test(const SurfaceInteraction3f & /* si */,
+                                  Mask /* active */) const {
+    return true;
+}
+
+MI_VARIANT std::pair<typename BSDF<Float, Spectrum>::UnpolarizedSpectrum,
+                     typename BSDF<Float, Spectrum>::UnpolarizedSpectrum>
+BSDF<Float, Spectrum>::eval_subsurface(const SurfaceInteraction3f & /* si */,
+                                       Mask /* active */) const {
+    return { 0.f, 0.f };
+}
+
+MI_VARIANT uint32_t BSDF<Float, Spectrum>::ray_flags() const {
+    uint32_t result = +RayFlags::Empty;
+    if (has_flag(m_flags, BSDFFlags::Anisotropic))
+        result |= +RayFlags::dPdUV;
+    if (has_flag(m_flags, BSDFFlags::NeedsDifferentials))
+        result |= RayFlags::UV | RayFlags::dPdUV;
+    return result;
+}
+
+MI_VARIANT ref<BSDF<Float, Spectrum>> BSDF<Float, Spectrum>::simplify() {
+    return this;
+}
+
 template <typename Index>
 std::string type_mask_to_string(Index type_mask) {
     std::ostringstream oss;
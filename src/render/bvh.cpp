@@ -0,0 +1,646 @@
+#include <mitsuba/render/bvh.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**
+ * \brief Encode the children of a BVH node using quantized bounding boxes
+ *
+ * \c prim_count is zero for inner children, in which case \c child_ref
+ * refers to a node, and otherwise to the first primitive of a leaf.
+ */
+template <typename Node, typename BoundingBox>
+static void bvh_encode_node(Node &node, const BoundingBox *child_bbox,
+                            const uint32_t *child_ref, const uint8_t *prim_count,
+                            uint32_t child_count) {
+    using Float = typename BoundingBox::Value;
+
+    BoundingBox bbox;
+    for (uint32_t i = 0; i < child_count; ++i)
+        bbox.expand(child_bbox[i]);
+
+    std::memset(&node, 0, sizeof(Node));
+    node.child_count = (uint8_t) child_count;
+
+    for (size_t axis = 0; axis < 3; ++axis) {
+        Float extent = bbox.max[axis] - bbox.min[axis];
+
+        /* Smallest power of two, for which 255 steps cover the node */
+        int exponent;
+        std::frexp(extent / 255.f, &exponent);
+        if (!(extent > 0.f))
+            exponent = -126;
+        exponent = std::max(-126, std::min(exponent, 127));
+
+        node.origin[axis]   = bbox.min[axis];
+        node.exponent[axis] = (int8_t) exponent;
+    }
+
+    for (uint32_t i = 0; i < child_count; ++i) {
+        for (size_t axis = 0; axis < 3; ++axis) {
+            Float origin = node.origin[axis],
+                  scale  = node.scale(axis),
+                  lo     = child_bbox[i].min[axis],
+                  hi     = child_bbox[i].max[axis];
+
+            /* Round conservatively so that the decoded box contains the
+               original one */
+            int q_lo = (int) std::floor((lo - origin) / scale),
+                q_hi = (int) std::ceil((hi - origin) / scale);
+            q_lo = std::max(0, std::min(q_lo, 255));
+            q_hi = std::max(0, std::min(q_hi, 255));
+
+            while (q_lo > 0 && dr::fmadd((Float) q_lo, scale, origin) > lo)
+                q_lo--;
+            while (q_hi < 255 && dr::fmadd((Float) q_hi, scale, origin) < hi)
+                q_hi++;
+
+            node.q_min[axis][i] = (uint8_t) q_lo;
+            node.q_max[axis][i] = (uint8_t) q_hi;
+        }
+
+        node.child[i]      = child_ref[i];
+        node.prim_count[i] = prim_count[i];
+    }
+}
+
+/// Contiguous range of primitive references processed by the builder
+MI_VARIANT struct ShapeBVH<Float, Spectrum>::BuildRange {
+    Size begin = 0, end = 0;
+    ScalarBoundingBox3f bbox, centroid_bbox;
+
+    Size size() const { return end - begin; }
+};
+
+/// Shared state of a BVH build
+MI_VARIANT template <size_t Width>
+struct ShapeBVH<Float, Spectrum>::BuildContext {
+    using Node = BVHNode<ScalarFloat, Width>;
+
+    struct Bin {
+        ScalarBoundingBox3f bbox, centroid_bbox;
+        Size count = 0;
+    };
+
+    const ShapeBVH &bvh;
+    ThreadEnvironment env;
+    std::vector<ScalarBoundingBox3f> prim_bbox;
+    std::vector<ScalarPoint3f> prim_centroid;
+    std::vector<Index> indices;
+    std::unique_ptr<Node[]> nodes;
+    std::atomic<Size> node_count { 0 };
+    std::atomic<Size> leaf_count { 0 };
+    std::atomic<Size> max_depth { 0 };
+
+    BuildContext(const ShapeBVH &bvh) : bvh(bvh) { }
+
+    /// Compute the bounding box and centroid bounds of a range
+    void compute_bounds(BuildRange &range) const {
+        range.bbox.reset();
+        range.centroid_bbox.reset();
+        for (Size i = range.begin; i < range.end; ++i) {
+            Index index = indices[i];
+            range.bbox.expand(prim_bbox[index]);
+            range.centroid_bbox.expand(prim_centroid[index]);
+        }
+    }
+
+    /// Split a range at the median of the centroids along its major axis
+    void split_median(const BuildRange &range, BuildRange &left, BuildRange &right) {
+        uint32_t axis = range.centroid_bbox.major_axis();
+        Size mid = range.begin + range.size() / 2;
+
+        std::nth_element(indices.begin() + range.begin,
+                         indices.begin() + mid,
+                         indices.begin() + range.end,
+                         [&](Index a, Index b) {
+                             return prim_centroid[a][axis] < prim_centroid[b][axis];
+                         });
+
+        left.begin = range.begin; left.end = mid;
+        right.begin = mid; right.end = range.end;
+        compute_bounds(left);
+        compute_bounds(right);
+    }
+
+    /**
+     * \brief Split a range using the binned surface area heuristic
+     *
+     * Returns \c false when it is cheaper to turn the range into a leaf.
+     */
+    bool split(const BuildRange &range, BuildRange &left, BuildRange &right,
+               Size depth) {
+        Size count = range.size(),
+             max_leaf_size = bvh.m_max_leaf_size;
+
+        if (count <= 1)
+            return false;
+
+        uint32_t axis = range.centroid_bbox.major_axis();
+        ScalarFloat extent = range.centroid_bbox.extents()[axis];
+
+        /* All centroids coincide: SAH binning cannot separate them */
+        if (!(extent > 0.f)) {
+            if (count <= max_leaf_size)
+                return false;
+            split_median(range, left, right);
+            return true;
+        }
+
+        if (depth >= MI_BVH_MEDIAN_DEPTH) {
+            if (count <= max_leaf_size)
+                return false;
+            split_median(range, left, right);
+            return true;
+        }
+
+        Size bin_count = bvh.m_bin_count;
+        ScalarFloat origin = range.centroid_bbox.min[axis],
+                    scale  = (ScalarFloat) bin_count * (1.f - dr::Epsilon<ScalarFloat>) / extent;
+
+        auto bin_index = [&](Index index) DRJIT_INLINE_LAMBDA {
+            Size b = (Size) ((prim_centroid[index][axis] - origin) * scale);
+            return std::min(b, bin_count - 1);
+        };
+
+        /* Assign all primitives to bins */
+        std::vector<Bin> bins(bin_count);
+        if (count > MI_BVH_PARALLEL_BINNING) {
+            std::mutex mutex;
+            dr::parallel_for(
+                dr::blocked_range<Size>(range.begin, range.end, MI_BVH_PARALLEL_BINNING / 4),
+                [&](const dr::blocked_range<Size> &r) {
+                    std::vector<Bin> local(bin_count);
+                    for (Size i = r.begin(); i != r.end(); ++i) {
+                        Index index = indices[i];
+                        Bin &bin = local[bin_index(index)];
+                        bin.bbox.expand(prim_bbox[index]);
+                        bin.centroid_bbox.expand(prim_centroid[index]);
+                        bin.count++;
+                    }
+
+                    std::lock_guard<std::mutex> guard(mutex);
+                    for (Size i = 0; i < bin_count; ++i) {
+                        bins[i].bbox.expand(local[i].bbox);
+                        bins[i].centroid_bbox.expand(local[i].centroid_bbox);
+                        bins[i].count += local[i].count;
+                    }
+                }
+            );
+        } else {
+            for (Size i = range.begin; i < range.end; ++i) {
+                Index index = indices[i];
+                Bin &bin = bins[bin_index(index)];
+                bin.bbox.expand(prim_bbox[index]);
+                bin.centroid_bbox.expand(prim_centroid[index]);
+                bin.count++;
+            }
+        }
+
+        /* Sweep from the right to compute the cost of the right side */
+        std::vector<ScalarFloat> right_area(bin_count);
+        ScalarBoundingBox3f accum;
+        for (Size i = bin_count - 1; i > 0; --i) {
+            accum.expand(bins[i].bbox);
+            right_area[i] = accum.valid() ? accum.surface_area() : 0.f;
+        }
+
+        /* Sweep from the left and find the cheapest split plane */
+        ScalarFloat best_cost = dr::Infinity<ScalarFloat>;
+        Size best_split = 0, left_count = 0, right_count = count;
+        accum.reset();
+        for (Size i = 0; i < bin_count - 1; ++i) {
+            accum.expand(bins[i].bbox);
+            left_count  += bins[i].count;
+            right_count -= bins[i].count;
+            if (left_count == 0 || right_count == 0)
+                continue;
+
+            ScalarFloat cost = accum.surface_area() * (ScalarFloat) left_count +
+                               right_area[i + 1] * (ScalarFloat) right_count;
+            if (cost < best_cost) {
+                best_cost  = cost;
+                best_split = i + 1;
+            }
+        }
+
+        ScalarFloat area = range.bbox.surface_area(),
+                    inv_area = area > 0.f ? 1.f / area : 0.f;
+        best_cost = bvh.m_traversal_cost +
+                    bvh.m_intersection_cost * best_cost * inv_area;
+        ScalarFloat leaf_cost = bvh.m_intersection_cost * (ScalarFloat) count;
+
+        if (count <= max_leaf_size && !(best_cost < leaf_cost))
+            return false;
+
+        if (best_split == 0) {
+            split_median(range, left, right);
+            return true;
+        }
+
+        Index *mid = std::partition(
+            indices.data() + range.begin, indices.data() + range.end,
+            [&](Index index) { return bin_index(index) < best_split; });
+
+        left.begin  = range.begin;
+        left.end    = right.begin = (Size) (mid - indices.data());
+        right.end   = range.end;
+        left.bbox.reset(); left.centroid_bbox.reset();
+        right.bbox.reset(); right.centroid_bbox.reset();
+        for (Size i = 0; i < bin_count; ++i) {
+            BuildRange &target = i < best_split ? left : right;
+            target.bbox.expand(bins[i].bbox);
+            target.centroid_bbox.expand(bins[i].centroid_bbox);
+        }
+
+        return true;
+    }
+
+    /**
+     * \brief Recursively build a wide node from the two halves of a range
+     * that was split by the caller. Returns the index of the new node.
+     */
+    Size build_node(const BuildRange &left, const BuildRange &right, Size depth) {
+        Size node_index = node_count++;
+
+        Size prev_depth = max_depth;
+        while (depth > prev_depth && !max_depth.compare_exchange_weak(prev_depth, depth))
+            ;
+
+        /* Greedily split the child with the largest surface area until the
+           node is full or no child can be split anymore */
+        BuildRange child[Width];
+        bool is_leaf[Width] { };
+        Size child_count = 0;
+        child[child_count++] = left;
+        child[child_count++] = right;
+
+        while (child_count < Width) {
+            Size best = Width;
+            ScalarFloat best_area = -1.f;
+            for (Size i = 0; i < child_count; ++i) {
+                if (is_leaf[i] || child[i].size() <= 1)
+                    continue;
+                ScalarFloat area = child[i].bbox.surface_area();
+                if (area > best_area) {
+                    best = i;
+                    best_area = area;
+                }
+            }
+
+            if (best == Width)
+                break;
+
+            BuildRange l, r;
+            if (split(child[best], l, r, depth)) {
+                child[best] = l;
+                child[child_count++] = r;
+            } else {
+                is_leaf[best] = true;
+            }
+        }
+
+        /* Recurse into the remaining children (large ones in parallel) */
+        Index child_ref[Width];
+        Task *tasks[Width];
+        Size task_count = 0;
+
+        for (Size i = 0; i < child_count; ++i) {
+            if (!is_leaf[i] && child[i].size() > 1) {
+                BuildRange l, r;
+                if (split(child[i], l, r, depth)) {
+                    if (child[i].size() > bvh.m_parallel_threshold) {
+                        tasks[task_count++] = dr::do_async(
+                            [this, l, r, depth, i, &child_ref]() {
+                                ScopedSetThreadEnvironment scoped(env);
+                                child_ref[i] = build_node(l, r, depth + 1);
+                            });
+                    } else {
+                        child_ref[i] = build_node(l, r, depth + 1);
+                    }
+                    continue;
+                }
+            }
+
+            is_leaf[i] = true;
+            child_ref[i] = child[i].begin;
+            leaf_count++;
+        }
+
+        for (Size i = 0; i < task_count; ++i)
+            task_wait_and_release(tasks[i]);
+
+        write_node(nodes[node_index], child, is_leaf, child_ref, child_count);
+        return node_index;
+    }
+
+    /// Encode the children of a node using quantized bounding boxes
+    void write_node(Node &node, const BuildRange *child, const bool *is_leaf,
+                    const Index *child_ref, Size child_count) {
+        ScalarBoundingBox3f child_bbox[Width];
+        uint8_t prim_count[Width];
+        for (Size i = 0; i < child_count; ++i) {
+            child_bbox[i] = child[i].bbox;
+            prim_count[i] = is_leaf[i] ? (uint8_t) child[i].size() : 0;
+        }
+        bvh_encode_node(node, child_bbox, child_ref, prim_count, child_count);
+    }
+};
+
+/// Shared state of a BVH refit
+MI_VARIANT template <size_t Width>
+struct ShapeBVH<Float, Spectrum>::RefitContext {
+    using Node = BVHNode<ScalarFloat, Width>;
+
+    const ShapeBVH &bvh;
+    Node *nodes;
+    ThreadEnvironment env;
+
+    RefitContext(const ShapeBVH &bvh, Node *nodes) : bvh(bvh), nodes(nodes) { }
+
+    /**
+     * \brief Recompute the bounds of the subtree below the given node
+     *
+     * Returns the (unnormalized) SAH cost of the subtree. The top levels are
+     * processed in parallel.
+     */
+    ScalarFloat refit_node(Index index, Size depth, ScalarBoundingBox3f &bbox) {
+        Node &node = nodes[index];
+        Size child_count = node.child_count;
+
+        ScalarBoundingBox3f child_bbox[Width];
+        ScalarFloat child_cost[Width] { };
+        Index child_ref[Width];
+        uint8_t prim_count[Width];
+        Task *tasks[Width];
+        Size task_count = 0;
+
+        for (Size i = 0; i < child_count; ++i) {
+            child_ref[i]  = node.child[i];
+            prim_count[i] = node.prim_count[i];
+
+            if (prim_count[i] > 0) {
+                for (Index j = child_ref[i]; j < child_ref[i] + prim_count[i]; ++j) {
+                    const PrimRef &ref = bvh.m_prims[j];
+                    child_bbox[i].expand(bvh.m_shapes[ref.shape_index]->bbox(ref.prim_index));
+                }
+                child_cost[i] = bvh.m_intersection_cost * (ScalarFloat) prim_count[i] *
+                                child_bbox[i].surface_area();
+            } else if (depth < 3) {
+                tasks[task_count++] = dr::do_async(
+                    [this, i, depth, &child_ref, &child_bbox, &child_cost]() {
+                        ScopedSetThreadEnvironment scoped(env);
+                        child_cost[i] = refit_node(child_ref[i], depth + 1, child_bbox[i]);
+                    });
+            } else {
+                child_cost[i] = refit_node(child_ref[i], depth + 1, child_bbox[i]);
+            }
+        }
+
+        for (Size i = 0; i < task_count; ++i)
+            task_wait_and_release(tasks[i]);
+
+        bvh_encode_node(node, child_bbox, child_ref, prim_count, child_count);
+
+        bbox.reset();
+        ScalarFloat cost = 0.f;
+        for (Size i = 0; i < child_count; ++i) {
+            bbox.expand(child_bbox[i]);
+            cost += child_cost[i];
+        }
+
+        return cost + bvh.m_traversal_cost * bbox.surface_area();
+    }
+};
+
+MI_VARIANT ShapeBVH<Float, Spectrum>::ShapeBVH(const Properties &props) {
+    /* BVH construction: Number of children per node (4 or 8) */
+    m_width = props.get<uint32_t>("bvh_width", 4);
+    if (m_width != 4 && m_width != 8)
+        Throw("The \"bvh_width\" parameter must be equal to 4 or 8, got %i.", m_width);
+
+    /* BVH construction: Maximum number of primitives per leaf */
+    m_max_leaf_size = props.get<uint32_t>("bvh_max_leaf_size", 4);
+    if (m_max_leaf_size == 0 || m_max_leaf_size > 255)
+        Throw("The \"bvh_max_leaf_size\" parameter must be in the range [1, 255].");
+
+    /* BVH construction: Number of bins used to evaluate the SAH */
+    m_bin_count = props.get<uint32_t>("bvh_bins", 16);
+    if (m_bin_count < 2)
+        Throw("The \"bvh_bins\" parameter must be at least 2.");
+
+    /* BVH construction: Relative cost of a shape intersection operation and
+       of a node traversal step in the surface area heuristic. */
+    m_intersection_cost = props.get<ScalarFloat>("bvh_intersection_cost", 1.f);
+    m_traversal_cost    = props.get<ScalarFloat>("bvh_traversal_cost", 1.f);
+
+    /* BVH construction: Subtrees with more primitives than this are
+       constructed in a separate task */
+    m_parallel_threshold = props.get<uint32_t>("bvh_parallel_threshold", 4096);
+}
+
+MI_VARIANT void ShapeBVH<Float, Spectrum>::clear() {
+    m_shapes.clear();
+    m_shape_masks.clear();
+    m_shape_alpha_tests.clear();
+    m_prims.reset();
+    m_nodes4.reset();
+    m_nodes8.reset();
+    m_bbox.reset();
+    m_primitive_count = 0;
+    m_node_count = 0;
+    m_leaf_count = 0;
+    m_shape_prim_count.clear();
+    m_build_cost = 0.f;
+}
+
+MI_VARIANT void ShapeBVH<Float, Spectrum>::add_shape(Shape *shape) {
+    Assert(!ready());
+    m_primitive_count += shape->primitive_count();
+    m_shapes.push_back(shape);
+    m_shape_masks.push_back((uint32_t) -1);
+    m_shape_alpha_tests.push_back(false);
+    m_bbox.expand(shape->bbox());
+}
+
+MI_VARIANT void ShapeBVH<Float, Spectrum>::build() {
+    Timer timer;
+    Log(Info, "Building a %i-wide SAH BVH (%i primitives) ..",
+        m_width, m_primitive_count);
+
+    if (m_width == 8)
+        build_impl<8>();
+    else
+        build_impl<4>();
+
+    size_t node_size = m_width == 8 ? sizeof(BVHNode<ScalarFloat, 8>)
+                                    : sizeof(BVHNode<ScalarFloat, 4>);
+
+    Log(Info, "Finished. (%s of storage, took %s)",
+        util::mem_string(m_node_count * node_size +
+                         m_primitive_count * sizeof(PrimRef)),
+        util::time_string((float) timer.value())
+    );
+}
+
+MI_VARIANT template <size_t Width> void ShapeBVH<Float, Spectrum>::build_impl() {
+    using Context = BuildContext<Width>;
+    using Node = typename Context::Node;
+
+    Context ctx(*this);
+    Size prim_count = m_primitive_count;
+    m_node_count = m_leaf_count = 0;
+
+    if (prim_count == 0) {
+        Log(Warn, "BVH contains no geometry!");
+        return;
+    }
+
+    /* Compute the bounding boxes and centroids of all primitives */
+    std::unique_ptr<PrimRef[]> refs(new PrimRef[prim_count]);
+    ctx.prim_bbox.resize(prim_count);
+    ctx.prim_centroid.resize(prim_count);
+    ctx.indices.resize(prim_count);
+
+    for (Size shape_index = 0, offset = 0; shape_index < shape_count(); ++shape_index) {
+        const Shape *shape = m_shapes[shape_index];
+        Size count = shape->primitive_count();
+
+        dr::parallel_for(
+            dr::blocked_range<Size>(0, count, 16384),
+            [&](const dr::blocked_range<Size> &range) {
+                for (Size i = range.begin(); i != range.end(); ++i) {
+                    Size index = offset + i;
+                    ScalarBoundingBox3f bbox = shape->bbox(i);
+                    ctx.prim_bbox[index] = bbox;
+                    ctx.prim_centroid[index] = bbox.center();
+                    ctx.indices[index] = index;
+                    refs[index] = PrimRef{ shape_index, i };
+                }
+            }
+        );
+
+        offset += count;
+    }
+
+    /* Each node performs at least one split, which bounds the node count */
+    ctx.nodes.reset(new Node[prim_count]);
+
+    BuildRange root;
+    root.begin = 0;
+    root.end = prim_count;
+    ctx.compute_bounds(root);
+
+    BuildRange left, right;
+    if (ctx.split(root, left, right, 0)) {
+        ctx.build_node(left, right, 0);
+    } else {
+        /* Tiny scene: store everything in a single leaf below the root */
+        ctx.node_count = 1;
+        ctx.leaf_count = 1;
+        bool is_leaf = true;
+        Index child_ref = 0;
+        ctx.write_node(ctx.nodes[0], &root, &is_leaf, &child_ref, 1);
+    }
+
+    m_node_count = ctx.node_count;
+    m_leaf_count = ctx.leaf_count;
+
+    /* Store the primitives in leaf order and compact the node storage */
+    m_prims.reset(new PrimRef[prim_count]);
+    for (Size i = 0; i < prim_count; ++i)
+        m_prims[i] = refs[ctx.indices[i]];
+
+    std::unique_ptr<Node[]> nodes(new Node[m_node_count]);
+    std::copy(ctx.nodes.get(), ctx.nodes.get() + m_node_count, nodes.get());
+
+    if constexpr (Width == 8)
+        m_nodes8 = std::move(nodes);
+    else
+        m_nodes4 = std::move(nodes);
+
+    /* Remember the topology and quality of the hierarchy for refitting */
+    m_shape_prim_count.resize(shape_count());
+    for (Size i = 0; i < shape_count(); ++i)
+        m_shape_prim_count[i] = m_shapes[i]->primitive_count();
+    m_build_cost = refit_impl<Width>();
+
+    Log(Debug, "BVH statistics:");
+    Log(Debug, "   Inner nodes   : %i (%s)", m_node_count,
+        util::mem_string(m_node_count * sizeof(Node)));
+    Log(Debug, "   Leaf nodes    : %i", m_leaf_count);
+    Log(Debug, "   Max. depth    : %i", (Size) ctx.max_depth + 1);
+    Log(Debug, "   Avg. leaf size: %.2f",
+        (double) prim_count / (double) std::max(m_leaf_count, 1u));
+    Log(Debug, "   SAH cost      : %.2f", m_build_cost);
+}
+
+MI_VARIANT typename ShapeBVH<Float, Spectrum>::ScalarFloat
+ShapeBVH<Float, Spectrum>::refit() {
+    if (!ready())
+        Throw("ShapeBVH::refit(): the BVH must be built first!");
+
+    for (Size i = 0; i < shape_count(); ++i) {
+        if (m_shapes[i]->primitive_count() != m_shape_prim_count[i])
+            Throw("ShapeBVH::refit(): the primitive count of shape %i changed "
+                  "since the BVH was built!", i);
+    }
+
+    Timer timer;
+    ScalarFloat cost = m_width == 8 ? refit_impl<8>() : refit_impl<4>(),
+                degradation = m_build_cost > 0.f ? cost / m_build_cost : 1.f;
+
+    Log(Debug, "Refitted the BVH (took %s, relative SAH cost %.2f)",
+        util::time_string((float) timer.value()), degradation);
+
+    return degradation;
+}
+
+MI_VARIANT template <size_t Width>
+typename ShapeBVH<Float, Spectrum>::ScalarFloat
+ShapeBVH<Float, Spectrum>::refit_impl() {
+    BVHNode<ScalarFloat, Width> *nodes;
+    if constexpr (Width == 8)
+        nodes = m_nodes8.get();
+    else
+        nodes = m_nodes4.get();
+
+    RefitContext<Width> ctx(*this, nodes);
+    ScalarFloat cost = ctx.refit_node(0, 0, m_bbox),
+                area = m_bbox.surface_area();
+
+    return area > 0.f ? cost / area : 0.f;
+}
+
+MI_VARIANT size_t ShapeBVH<Float, Spectrum>::memory_footprint() const {
+    size_t node_size = m_width == 8 ? sizeof(BVHNode<ScalarFloat, 8>)
+                                    : sizeof(BVHNode<ScalarFloat, 4>);
+    return m_node_count * node_size + m_primitive_count * sizeof(PrimRef);
+}
+
+MI_VARIANT std::string ShapeBVH<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "ShapeBVH[" << std::endl
+        << "  width = " << m_width << "," << std::endl
+        << "  nodes = " << m_node_count << "," << std::endl
+        << "  shapes = [" << std::endl;
+    for (auto shape : m_shapes)
+        oss << "    " << string::indent(shape, 4)
+            << "," << std::endl;
+    oss << "  ]" << std::endl << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(ShapeBVH, Object)
+MI_INSTANTIATE_CLASS(ShapeBVH)
+NAMESPACE_END(mitsuba)
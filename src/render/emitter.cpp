@@ -11,6 +11,17 @@ MI_VARIANT Emitter<Float, Spectrum>::Emitter(const Properties &props)
     }
 MI_VARIANT Emitter<Float, Spectrum>::~Emitter() { }
 
+MI_VARIANT typename Emitter<Float, Spectrum>::ScalarFloat
+Emitter<Float, Spectrum>::flux_estimate() const {
+    return 1.f;
+}
+
+MI_VARIANT std::pair<typename Emitter<Float, Spectrum>::ScalarVector3f,
+                     typename Emitter<Float, Spectrum>::ScalarFloat>
+Emitter<Float, Spectrum>::emission_cone() const {
+    return { ScalarVector3f(0.f, 0.f, 1.f), -1.f };
+}
+
 MI_VARIANT
 void Emitter<Float, Spectrum>::traverse(TraversalCallback *callback) {
     callback->put_parameter("sampling_weight", m_sampling_weight, +ParamFlags::NonDifferentiable);
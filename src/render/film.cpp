@@ -73,6 +73,22 @@ MI_VARIANT void Film<Float, Spectrum>::parameters_changed(const std::vector<std:
     set_crop_window(crop_offset, crop_size);
 }
 
+MI_VARIANT size_t
+Film<Float, Spectrum>::channel_count(const std::vector<std::string> &aovs) const {
+    return aovs.size() + 5;
+}
+
+MI_VARIANT fs::path
+Film<Float, Spectrum>::output_path(const fs::path &path) const {
+    return path;
+}
+
+MI_VARIANT size_t
+Film<Float, Spectrum>::storage_footprint(const std::vector<std::string> &aovs) const {
+    return (size_t) dr::prod(m_crop_size) * channel_count(aovs) *
+           sizeof(ScalarFloat);
+}
+
 MI_VARIANT void
 Film<Float, Spectrum>::prepare_sample(const UnpolarizedSpectrum & /* spec */,
                                       const Wavelength & /* wavelengths */,
@@ -83,6 +99,11 @@ Film<Float, Spectrum>::prepare_sample(const UnpolarizedSpectrum & /* spec */,
     NotImplementedError("prepare_sample");
 }
 
+MI_VARIANT typename Film<Float, Spectrum>::TensorXf
+Film<Float, Spectrum>::variance() const {
+    NotImplementedError("variance");
+}
+
 MI_VARIANT const typename Film<Float, Spectrum>::Texture *
 Film<Float, Spectrum>::sensor_response_function() {
     return m_srf.get();
@@ -0,0 +1,420 @@
+#include <mitsuba/render/guiding.h>
+#include <mitsuba/core/logger.h>
+#include <mitsuba/core/stream.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/util.h>
+#include <nanothread/nanothread.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Maximum depth of the spatial binary tree
+static constexpr uint32_t MaxSpatialDepth = 48;
+
+using ScalarPoint2f  = GuidingField::ScalarPoint2f;
+using ScalarVector3f = GuidingField::ScalarVector3f;
+
+/// Map a direction to the square of cylindrical coordinates
+static ScalarPoint2f to_canonical(const ScalarVector3f &d) {
+    float cos_theta = dr::clamp(d.z(), -1.f, 1.f),
+          phi       = dr::atan2(d.y(), d.x());
+    if (phi < 0.f)
+        phi += 2.f * dr::Pi<float>;
+    return dr::clamp(ScalarPoint2f((cos_theta + 1.f) * .5f, phi * dr::InvTwoPi<float>),
+                     0.f, dr::OneMinusEpsilon<float>);
+}
+
+/// Inverse of \ref to_canonical()
+static ScalarVector3f from_canonical(const ScalarPoint2f &u) {
+    float cos_theta = 2.f * u.x() - 1.f,
+          sin_theta = dr::safe_sqrt(1.f - dr::sqr(cos_theta));
+    auto [sin_phi, cos_phi] = dr::sincos(2.f * dr::Pi<float> * u.y());
+    return ScalarVector3f(sin_theta * cos_phi, sin_theta * sin_phi, cos_theta);
+}
+
+// =======================================================================
+//! @{ \name Directional quadtree
+// =======================================================================
+
+GuidingField::QuadNode::QuadNode() {
+    for (uint32_t i = 0; i < 4; ++i) {
+        sum[i] = 0.f;
+        child[i] = 0;
+    }
+}
+
+GuidingField::QuadNode::QuadNode(const QuadNode &node) { *this = node; }
+
+GuidingField::QuadNode &GuidingField::QuadNode::operator=(const QuadNode &node) {
+    for (uint32_t i = 0; i < 4; ++i) {
+        sum[i] = (float) node.sum[i];
+        child[i] = node.child[i];
+    }
+    return *this;
+}
+
+float GuidingField::QuadNode::total() const {
+    return (float) sum[0] + (float) sum[1] + (float) sum[2] + (float) sum[3];
+}
+
+GuidingField::DTree::DTree() : nodes(1), weight(0.f) { }
+
+GuidingField::DTree::DTree(const DTree &tree)
+    : nodes(tree.nodes), weight((float) tree.weight) { }
+
+GuidingField::DTree &GuidingField::DTree::operator=(const DTree &tree) {
+    nodes = tree.nodes;
+    weight = (float) tree.weight;
+    return *this;
+}
+
+float GuidingField::DTree::pdf(ScalarPoint2f u) const {
+    float result = 1.f;
+    uint32_t index = 0;
+
+    while (true) {
+        const QuadNode &node = nodes[index];
+        float total = node.total();
+        // Uniform below nodes that didn't receive any radiance
+        if (!(total > 0.f))
+            break;
+
+        uint32_t x = u.x() >= .5f, y = u.y() >= .5f, q = x + 2 * y;
+        result *= 4.f * node.sum[q] / total;
+        if (node.child[q] == 0 || result == 0.f)
+            break;
+
+        u = 2.f * u - ScalarPoint2f((float) x, (float) y);
+        index = node.child[q];
+    }
+
+    return result;
+}
+
+ScalarPoint2f GuidingField::DTree::sample(ScalarPoint2f sample) const {
+    ScalarPoint2f origin(0.f);
+    float size = 1.f;
+    uint32_t index = 0;
+
+    while (true) {
+        const QuadNode &node = nodes[index];
+        float total = node.total();
+        if (!(total > 0.f))
+            break;
+
+        // Choose the column, then the row, and reuse the sample
+        float left = ((float) node.sum[0] + (float) node.sum[2]) / total;
+        uint32_t x = sample.x() >= left;
+        sample.x() = x ? (sample.x() - left) / (1.f - left) : sample.x() / left;
+
+        float column = (float) node.sum[x] + (float) node.sum[x + 2],
+              bottom = node.sum[x] / column;
+        uint32_t y = sample.y() >= bottom;
+        sample.y() = y ? (sample.y() - bottom) / (1.f - bottom) : sample.y() / bottom;
+
+        sample = dr::clamp(sample, 0.f, dr::OneMinusEpsilon<float>);
+        size *= .5f;
+        origin += ScalarPoint2f((float) x, (float) y) * size;
+
+        uint32_t q = x + 2 * y;
+        if (node.child[q] == 0)
+            break;
+        index = node.child[q];
+    }
+
+    return dr::clamp(origin + sample * size, 0.f, dr::OneMinusEpsilon<float>);
+}
+
+void GuidingField::DTree::record(ScalarPoint2f u, float value) const {
+    weight += 1.f;
+
+    uint32_t index = 0;
+    while (true) {
+        const QuadNode &node = nodes[index];
+        uint32_t x = u.x() >= .5f, y = u.y() >= .5f, q = x + 2 * y;
+        node.sum[q] += value;
+        if (node.child[q] == 0)
+            break;
+        u = 2.f * u - ScalarPoint2f((float) x, (float) y);
+        index = node.child[q];
+    }
+}
+
+void GuidingField::DTree::build(const DTree &tree, float threshold,
+                                uint32_t max_depth) {
+    float total = tree.nodes[0].total();
+    weight = 0.f;
+
+    if (!(total > 0.f)) {
+        // Nothing was recorded, keep the current structure
+        nodes = tree.nodes;
+        for (QuadNode &node : nodes)
+            for (uint32_t i = 0; i < 4; ++i)
+                node.sum[i] = 0.f;
+        return;
+    }
+
+    struct Item {
+        uint32_t node;
+        /// Corresponding node of 'tree', if it exists
+        int64_t source;
+        float sum[4];
+        uint32_t depth;
+    };
+
+    std::vector<QuadNode> result(1);
+    std::vector<Item> stack;
+    Item root { 0, 0, {}, 1 };
+    for (uint32_t i = 0; i < 4; ++i)
+        root.sum[i] = tree.nodes[0].sum[i];
+    stack.push_back(root);
+
+    /* Subdivide all quadrants that hold more than the given fraction of the
+       radiance. Quadrants that weren't subdivided before distribute their
+       radiance uniformly over their children. */
+    while (!stack.empty()) {
+        Item item = stack.back();
+        stack.pop_back();
+
+        for (uint32_t q = 0; q < 4; ++q) {
+            if (!(item.sum[q] > total * threshold) || item.depth >= max_depth)
+                continue;
+
+            Item child { (uint32_t) result.size(), -1, {}, item.depth + 1 };
+            result.emplace_back();
+            result[item.node].child[q] = child.node;
+
+            if (item.source >= 0 && tree.nodes[item.source].child[q] != 0) {
+                child.source = tree.nodes[item.source].child[q];
+                for (uint32_t i = 0; i < 4; ++i)
+                    child.sum[i] = tree.nodes[child.source].sum[i];
+            } else {
+                for (uint32_t i = 0; i < 4; ++i)
+                    child.sum[i] = item.sum[q] * .25f;
+            }
+            stack.push_back(child);
+        }
+    }
+
+    nodes = std::move(result);
+}
+
+//! @}
+// =======================================================================
+
+GuidingField::GuidingField(const ScalarBoundingBox3f &bbox,
+                           float spatial_threshold,
+                           float directional_threshold, uint32_t max_depth)
+    : m_bbox(bbox), m_spatial_threshold(spatial_threshold),
+      m_directional_threshold(directional_threshold), m_max_depth(max_depth),
+      m_iteration(0) {
+    if (!bbox.valid())
+        Throw("GuidingField: the bounding box must be valid!");
+    if (!(spatial_threshold > 0.f) || !(directional_threshold > 0.f))
+        Throw("GuidingField: the thresholds must be positive!");
+    if (max_depth == 0)
+        Throw("GuidingField: the maximum depth must be positive!");
+
+    m_nodes.push_back(SpatialNode { 0, 0, 0 });
+    m_leaves.emplace_back();
+}
+
+GuidingField::GuidingField(Stream *stream) {
+    char header[3];
+    stream->read(header, 3);
+    if (header[0] != 'S' || header[1] != 'D' || header[2] != 'T')
+        Throw("GuidingField: invalid file!");
+    uint8_t version;
+    stream->read(version);
+    if (version != 1)
+        Throw("GuidingField: invalid version, currently only version 1 is "
+              "supported (found %d)", version);
+
+    stream->read_array(m_bbox.min.data(), 3);
+    stream->read_array(m_bbox.max.data(), 3);
+    stream->read(m_spatial_threshold);
+    stream->read(m_directional_threshold);
+    stream->read(m_max_depth);
+    stream->read(m_iteration);
+
+    uint32_t node_count, leaf_count;
+    stream->read(node_count);
+    m_nodes.resize(node_count);
+    for (SpatialNode &node : m_nodes) {
+        stream->read(node.child);
+        stream->read(node.leaf);
+        stream->read(node.axis);
+    }
+
+    stream->read(leaf_count);
+    m_leaves.resize(leaf_count);
+    for (Leaf &leaf : m_leaves) {
+        float weight;
+        stream->read(weight);
+        stream->read(node_count);
+        DTree &tree = leaf.sampling;
+        tree.weight = weight;
+        tree.nodes.resize(node_count);
+        for (QuadNode &node : tree.nodes) {
+            float sum[4];
+            stream->read_array(sum, 4);
+            stream->read_array(node.child, 4);
+            for (uint32_t i = 0; i < 4; ++i)
+                node.sum[i] = sum[i];
+        }
+        leaf.building.build(tree, m_directional_threshold, m_max_depth);
+    }
+}
+
+void GuidingField::write(Stream *stream) const {
+    stream->write("SDT", 3);
+    stream->write(uint8_t(1)); // file format version
+    stream->write_array(m_bbox.min.data(), 3);
+    stream->write_array(m_bbox.max.data(), 3);
+    stream->write(m_spatial_threshold);
+    stream->write(m_directional_threshold);
+    stream->write(m_max_depth);
+    stream->write(m_iteration);
+
+    stream->write((uint32_t) m_nodes.size());
+    for (const SpatialNode &node : m_nodes) {
+        stream->write(node.child);
+        stream->write(node.leaf);
+        stream->write(node.axis);
+    }
+
+    // Only the distributions used for sampling are stored
+    stream->write((uint32_t) m_leaves.size());
+    for (const Leaf &leaf : m_leaves) {
+        const DTree &tree = leaf.sampling;
+        stream->write((float) tree.weight);
+        stream->write((uint32_t) tree.nodes.size());
+        for (const QuadNode &node : tree.nodes) {
+            float sum[4];
+            for (uint32_t i = 0; i < 4; ++i)
+                sum[i] = node.sum[i];
+            stream->write_array(sum, 4);
+            stream->write_array(node.child, 4);
+        }
+    }
+}
+
+uint32_t GuidingField::lookup(const ScalarPoint3f &p) const {
+    ScalarVector3f u = dr::clamp((p - m_bbox.min) /
+                                     dr::maximum(m_bbox.extents(), 1e-20f),
+                                 0.f, 1.f);
+    uint32_t index = 0;
+    while (m_nodes[index].child != 0) {
+        const SpatialNode &node = m_nodes[index];
+        float &v = u[node.axis];
+        if (v < .5f) {
+            v *= 2.f;
+            index = node.child;
+        } else {
+            v = 2.f * v - 1.f;
+            index = node.child + 1;
+        }
+    }
+    return m_nodes[index].leaf;
+}
+
+std::pair<ScalarVector3f, float>
+GuidingField::sample(const ScalarPoint3f &p, const ScalarPoint2f &sample) const {
+    const DTree &tree = m_leaves[lookup(p)].sampling;
+    ScalarPoint2f u = tree.sample(sample);
+    return { from_canonical(u), tree.pdf(u) * dr::InvFourPi<float> };
+}
+
+float GuidingField::pdf(const ScalarPoint3f &p, const ScalarVector3f &d) const {
+    return m_leaves[lookup(p)].sampling.pdf(to_canonical(d)) *
+           dr::InvFourPi<float>;
+}
+
+void GuidingField::record(const ScalarPoint3f &p, const ScalarVector3f &d,
+                          float value) const {
+    if (!(value >= 0.f) || !std::isfinite(value))
+        return;
+    m_leaves[lookup(p)].building.record(to_canonical(d), value);
+}
+
+void GuidingField::split(uint32_t node, float threshold, uint32_t depth) {
+    if (m_nodes[node].child != 0) {
+        uint32_t child = m_nodes[node].child;
+        split(child, threshold, depth + 1);
+        split(child + 1, threshold, depth + 1);
+        return;
+    }
+
+    uint32_t leaf = m_nodes[node].leaf;
+    float weight = m_leaves[leaf].building.weight;
+    if (!(weight > threshold) || depth >= MaxSpatialDepth)
+        return;
+
+    // Both children start out with the distributions of their parent
+    m_leaves[leaf].building.weight = weight * .5f;
+    Leaf copy = m_leaves[leaf];
+    m_leaves.push_back(copy);
+
+    uint32_t child = (uint32_t) m_nodes.size(),
+             axis  = (m_nodes[node].axis + 1) % 3;
+    m_nodes.push_back(SpatialNode { 0, leaf, axis });
+    m_nodes.push_back(SpatialNode { 0, (uint32_t) m_leaves.size() - 1, axis });
+    m_nodes[node].child = child;
+
+    split(child, threshold, depth + 1);
+    split(child + 1, threshold, depth + 1);
+}
+
+void GuidingField::refine() {
+    /* The number of samples per pixel doubles in every iteration, the spatial
+       resolution should grow with its square root */
+    float threshold =
+        m_spatial_threshold * std::sqrt(std::pow(2.f, (float) m_iteration));
+    split(0, threshold, 0);
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, m_leaves.size(), 64),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                Leaf &leaf = m_leaves[i];
+                leaf.sampling = leaf.building;
+                leaf.building.build(leaf.sampling, m_directional_threshold,
+                                    m_max_depth);
+            }
+        }
+    );
+
+    m_iteration++;
+    Log(Debug, "Refined the guiding field (iteration %u, %zu leaves, %zu nodes, %s).",
+        m_iteration, leaf_count(), node_count(), util::mem_string(nbytes()));
+}
+
+size_t GuidingField::node_count() const {
+    size_t count = 0;
+    for (const Leaf &leaf : m_leaves)
+        count += leaf.sampling.nodes.size();
+    return count;
+}
+
+size_t GuidingField::nbytes() const {
+    size_t size = m_nodes.size() * sizeof(SpatialNode);
+    for (const Leaf &leaf : m_leaves)
+        size += (leaf.sampling.nodes.size() + leaf.building.nodes.size()) *
+                sizeof(QuadNode);
+    return size;
+}
+
+std::string GuidingField::to_string() const {
+    std::ostringstream oss;
+    oss << "GuidingField[" << std::endl
+        << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+        << "  iteration = " << m_iteration << "," << std::endl
+        << "  leaf_count = " << leaf_count() << "," << std::endl
+        << "  node_count = " << node_count() << "," << std::endl
+        << "  nbytes = " << util::mem_string(nbytes()) << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS(GuidingField, Object)
+
+NAMESPACE_END(mitsuba)
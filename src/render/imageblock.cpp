@@ -1,10 +1,32 @@
 #include <mitsuba/render/imageblock.h>
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/spectrum.h>
 #include <drjit/loop.h>
 
+/// Number of samples recorded by deferred calls to ImageBlock::put() before they are accumulated
+#define MI_IMAGEBLOCK_DEFERRED_SIZE 32768
+
+/// Deferred samples are grouped into square tiles of this size (in pixels)
+#define MI_IMAGEBLOCK_DEFERRED_TILE 16
+
 NAMESPACE_BEGIN(mitsuba)
 
+/// Accumulate \c count weighted channel values, using SIMD packets where possible
+template <typename Value>
+MI_INLINE void accumulate_channels(Value *target, const Value *values,
+                                   Value weight, uint32_t count) {
+    using Packet = dr::Packet<Value>;
+
+    uint32_t k = 0;
+    for (; k + Packet::Size <= count; k += Packet::Size)
+        dr::store(target + k, dr::fmadd(dr::load<Packet>(values + k), weight,
+                                        dr::load<Packet>(target + k)));
+
+    for (; k < count; ++k)
+        target[k] = dr::fmadd(values[k], weight, target[k]);
+}
+
 MI_VARIANT
 ImageBlock<Float, Spectrum>::ImageBlock(const ScalarVector2u &size,
                                         const ScalarPoint2i &offset,
@@ -79,6 +101,9 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::clear() {
 
     if (m_compensate)
         m_tensor_compensation = TensorXf(dr::zeros<Array>(size_flat), 3, shape);
+
+    m_deferred_pos.clear();
+    m_deferred_values.clear();
 }
 
 MI_VARIANT void
@@ -98,10 +123,70 @@ ImageBlock<Float, Spectrum>::set_size(const ScalarVector2u &size) {
     if (m_compensate)
         m_tensor_compensation = TensorXf(dr::zeros<Array>(size_flat), 3, shape);
 
+    m_deferred_pos.clear();
+    m_deferred_values.clear();
+
     m_size = size;
 }
 
+MI_VARIANT void ImageBlock<Float, Spectrum>::set_deferred(bool value) {
+    if (!value)
+        flush_deferred();
+    m_deferred = value;
+}
+
+MI_VARIANT void ImageBlock<Float, Spectrum>::set_second_moment(bool value) {
+    if (value && m_channel_count < 4)
+        Throw("ImageBlock::set_second_moment(): the image block must have "
+              "at least 4 channels (RGB and the second moment)!");
+    flush_deferred();
+    m_second_moment = value;
+}
+
+MI_VARIANT void ImageBlock<Float, Spectrum>::flush_deferred() {
+    if constexpr (!dr::is_jit_v<Float>) {
+        size_t count = m_deferred_pos.size();
+        if (count == 0)
+            return;
+
+        // Bin the samples by tile using a counting sort
+        ScalarVector2u size = m_size + 2 * m_border_size,
+                       tiles = (size + (MI_IMAGEBLOCK_DEFERRED_TILE - 1)) /
+                               MI_IMAGEBLOCK_DEFERRED_TILE;
+
+        std::vector<uint32_t> tile(count), start(dr::prod(tiles) + 1, 0),
+                              order(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            ScalarPoint2i p = dr::floor2int<ScalarPoint2i>(m_deferred_pos[i]) -
+                              m_offset + (int) m_border_size;
+            ScalarPoint2u t = ScalarPoint2u(dr::clamp(
+                p / MI_IMAGEBLOCK_DEFERRED_TILE, 0, ScalarPoint2i(tiles) - 1));
+            tile[i] = t.y() * tiles.x() + t.x();
+            start[tile[i] + 1]++;
+        }
+
+        for (size_t i = 1; i < start.size(); ++i)
+            start[i] += start[i - 1];
+
+        for (size_t i = 0; i < count; ++i)
+            order[start[tile[i]]++] = (uint32_t) i;
+
+        // Accumulate the samples tile by tile
+        m_deferred = false;
+        for (uint32_t i : order)
+            put(m_deferred_pos[i], m_deferred_values.data() +
+                                       (size_t) i * m_channel_count);
+        m_deferred = true;
+
+        m_deferred_pos.clear();
+        m_deferred_values.clear();
+    }
+}
+
 MI_VARIANT typename ImageBlock<Float, Spectrum>::TensorXf &ImageBlock<Float, Spectrum>::tensor() {
+    flush_deferred();
+
     if constexpr (dr::is_jit_v<Float>) {
         if (m_compensate) {
             Float &comp = m_tensor_compensation.array();
@@ -177,6 +262,41 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::put(const Point2f &pos,
     ScopedPhase sp(ProfilerPhase::ImageBlockPut);
     constexpr bool JIT = dr::is_jit_v<Float>;
 
+    // Record the sample, it is accumulated by flush_deferred()
+    if constexpr (!JIT) {
+        if (m_deferred) {
+            if (unlikely(!active))
+                return;
+
+            m_deferred_pos.push_back(pos);
+            m_deferred_values.insert(m_deferred_values.end(), values,
+                                     values + m_channel_count);
+
+            if (m_deferred_pos.size() >= MI_IMAGEBLOCK_DEFERRED_SIZE)
+                flush_deferred();
+            return;
+        }
+    }
+
+    // Store the squared luminance of the sample in the last channel
+    std::unique_ptr<Float[]> moment_storage;
+    if (m_second_moment) {
+        Float *moment_values;
+        if constexpr (!JIT) {
+            moment_values = (Float *) alloca(sizeof(Float) * m_channel_count);
+        } else {
+            moment_storage.reset(new Float[m_channel_count]);
+            moment_values = moment_storage.get();
+        }
+
+        for (uint32_t k = 0; k + 1 < m_channel_count; ++k)
+            moment_values[k] = values[k];
+        moment_values[m_channel_count - 1] =
+            dr::sqr(luminance(Color3f(values[0], values[1], values[2])));
+
+        values = moment_values;
+    }
+
     // Check if all sample values are valid
     if (m_warn_negative || m_warn_invalid) {
         Mask is_valid = true;
@@ -221,9 +341,8 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::put(const Point2f &pos,
             if (unlikely(!active))
                 return;
 
-            ScalarFloat *ptr = m_tensor.array().data() + index;
-            for (uint32_t k = 0; k < m_channel_count; ++k)
-                *ptr++ += values[k];
+            accumulate_channels(m_tensor.array().data() + index, values,
+                                ScalarFloat(1.f), m_channel_count);
         } else {
             for (uint32_t k = 0; k < m_channel_count; ++k)
                 accum(values[k], index++, active);
@@ -290,9 +409,65 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::put(const Point2f &pos,
 
         Point2f rel_f = Point2f(pos_0_u) - pos_f;
 
+        if constexpr (!JIT) {
+            // ===========================================================
+            // 1.0. Scalar mode: separable weights, packet accumulation
+            // ===========================================================
+
+            ScalarFloat *weights_x = (ScalarFloat *) alloca(sizeof(ScalarFloat) * count.x()),
+                        *weights_y = (ScalarFloat *) alloca(sizeof(ScalarFloat) * count.y());
+
+            // Look up the filter weights along the X and Y axes once
+            for (uint32_t x = 0; x < count.x(); ++x) {
+                weights_x[x] = m_rfilter->eval_discretized(rel_f.x());
+                rel_f.x() += 1.f;
+            }
+
+            for (uint32_t y = 0; y < count.y(); ++y) {
+                weights_y[y] = m_rfilter->eval_discretized(rel_f.y());
+                rel_f.y() += 1.f;
+            }
+
+            // Normalize sample contribution if desired
+            if (unlikely(m_normalize)) {
+                ScalarFloat wx = 0.f, wy = 0.f;
+
+                Point2f rel_f2 = dr::ceil(pos_0_f) - pos_f;
+                for (uint32_t i = 0; i < count_max; ++i) {
+                    wx += m_rfilter->eval_discretized(rel_f2.x());
+                    wy += m_rfilter->eval_discretized(rel_f2.y());
+                    rel_f2 += 1.f;
+                }
+
+                ScalarFloat factor = wx * wy;
+                if (unlikely(factor == 0))
+                    return;
+                factor = dr::rcp(factor);
+
+                for (uint32_t i = 0; i < count.x(); ++i)
+                    weights_x[i] *= factor;
+            }
+
+            // Accumulate! Channels of a pixel are contiguous in memory
+            ScalarFloat *row = m_tensor.array().data() + index;
+            for (uint32_t y = 0; y < count.y(); ++y) {
+                ScalarFloat *ptr = row;
+
+                for (uint32_t x = 0; x < count.x(); ++x) {
+                    accumulate_channels(ptr, values, weights_x[x] * weights_y[y],
+                                        m_channel_count);
+                    ptr += m_channel_count;
+                }
+
+                row += size.x() * m_channel_count;
+            }
+
+            return;
+        }
+
         if (!record_loop) {
             // ===========================================================
-            // 1.1. Scalar mode / unroll the complete loop
+            // 1.1. Unroll the complete loop
             // ===========================================================
 
             // Allocate memory for reconstruction filter weights on the stack
@@ -536,6 +711,11 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::read(const Point2f &pos_,
                                                    Mask active) const {
     constexpr bool JIT = dr::is_jit_v<Float>;
 
+    if constexpr (!JIT) {
+        if (unlikely(!m_deferred_pos.empty()))
+            const_cast<ImageBlock &>(*this).flush_deferred();
+    }
+
     // Account for image block offset
     Point2f pos = pos_ - ScalarVector2f(m_offset);
 
@@ -753,6 +933,12 @@ MI_VARIANT void ImageBlock<Float, Spectrum>::read(const Point2f &pos_,
     }
 }
 
+MI_VARIANT size_t ImageBlock<Float, Spectrum>::memory_footprint() const {
+    return (m_tensor.size() + m_tensor_compensation.size() +
+            m_deferred_values.capacity()) * sizeof(ScalarFloat) +
+           m_deferred_pos.capacity() * sizeof(ScalarPoint2f);
+}
+
 MI_VARIANT std::string ImageBlock<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
 
@@ -764,6 +950,7 @@ MI_VARIANT std::string ImageBlock<Float, Spectrum>::to_string() const {
         << "  normalize = " << m_normalize << "," << std::endl
         << "  coalesce = " << m_coalesce << "," << std::endl
         << "  compensate = " << m_compensate << "," << std::endl
+        << "  second_moment = " << m_second_moment << "," << std::endl
         << "  warn_negative = " << m_warn_negative << "," << std::endl
         << "  warn_invalid = " << m_warn_invalid << "," << std::endl
         << "  rfilter = " << (m_rfilter ? string::indent(m_rfilter) : "BoxFilter[]")
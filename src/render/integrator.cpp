@@ -1,11 +1,17 @@
+#include <algorithm>
+#include <atomic>
 #include <mutex>
 
 #include <drjit/morton.h>
+#include <mitsuba/core/arena.h>
 #include <mitsuba/core/fwd.h>
 #include <mitsuba/core/profiler.h>
+#include <mitsuba/core/qmc.h>
 #include <mitsuba/core/progress.h>
+#include <mitsuba/core/random.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/timer.h>
+#include <mitsuba/core/tracer.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/render/film.h>
@@ -17,10 +23,198 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Query the free memory of the CUDA device used by Dr.Jit
+static bool cuda_free_memory(size_t &free_memory) {
+#if defined(MI_ENABLE_CUDA)
+    using MemGetInfo = int (*)(size_t *, size_t *);
+    static MemGetInfo mem_get_info =
+        (MemGetInfo) jit_cuda_lookup("cuMemGetInfo_v2");
+    if (!mem_get_info)
+        return false;
+
+    size_t total_memory = 0;
+    jit_cuda_push_context(jit_cuda_context());
+    int rv = mem_get_info(&free_memory, &total_memory);
+    jit_cuda_pop_context();
+    return rv == 0;
+#else
+    DRJIT_MARK_USED(free_memory);
+    return false;
+#endif
+}
+
+/**
+ * \brief Reports the kernels launched by Dr.Jit to the \ref TraceRecorder
+ *
+ * While the recorder is running, this enables the kernel history of Dr.Jit
+ * for the lifetime of the object. The history only provides the duration of
+ * the code generation, compilation and execution of a kernel, hence \ref
+ * record() waits for the pending kernels and lays out the ones launched since
+ * the previous call back to back, such that the last one ends at the time of
+ * the call. This synchronization only happens while tracing. If the kernel
+ * history was already enabled, its entries are left to whoever enabled it.
+ */
+class KernelTraceRecorder {
+public:
+    KernelTraceRecorder()
+        : m_active(TraceRecorder::running() &&
+                   !jit_flag(JitFlag::KernelHistory)) {
+        if (m_active)
+            jit_set_flag(JitFlag::KernelHistory, 1);
+    }
+
+    ~KernelTraceRecorder() {
+        if (m_active) {
+            record();
+            jit_set_flag(JitFlag::KernelHistory, 0);
+        }
+    }
+
+    /// Is the kernel history being recorded?
+    bool active() const { return m_active; }
+
+    /// Wait for all kernels and record the ones launched since the previous call
+    void record() {
+        if (!m_active)
+            return;
+
+        jit_sync_thread();
+        KernelHistoryEntry *history = jit_kernel_history();
+        if (!history)
+            return;
+
+        size_t count = 0;
+        while ((uint32_t) history[count].backend)
+            ++count;
+
+        // Durations are specified in milliseconds
+        double time = TraceRecorder::timestamp();
+        for (size_t i = count; i-- > 0; ) {
+            KernelHistoryEntry &e = history[i];
+            std::string args = tfm::format(
+                "\"hash\": \"%016llx%016llx\", \"size\": %u",
+                (unsigned long long) e.hash[1], (unsigned long long) e.hash[0],
+                e.size);
+
+            double execution = e.execution_time * 1000.0;
+            time -= execution;
+            TraceRecorder::add_event("jit", "Kernel launch", time, execution,
+                                     args);
+
+            double compilation = (e.codegen_time + e.backend_time) * 1000.0;
+            if (compilation > 0.0) {
+                time -= compilation;
+                TraceRecorder::add_event(
+                    "jit", "Kernel compilation", time, compilation,
+                    args + tfm::format(", \"cache_hit\": %s",
+                                       e.cache_hit ? "true" : "false"));
+            }
+
+            free(e.ir);
+        }
+
+        free(history);
+    }
+
+private:
+    bool m_active;
+};
+
+/**
+ * \brief Pool of per-worker state that is reused between the ranges of a
+ * parallel loop
+ *
+ * Every range of \c dr::parallel_for needs its own sampler and image block.
+ * Creating them per range adds up with small grain sizes and many passes
+ * (e.g. in adaptive or progressive renders). Ranges instead borrow an entry
+ * of the pool and return it when they finish, hence the pool only grows to
+ * the number of concurrently running workers. Samplers are seeded for every
+ * pixel and image blocks are resized for every block, so no state of the
+ * previous range needs to be reset. The adjoint integrators instead keep
+ * accumulating into the crop-sized blocks of the pool, which are committed
+ * to the film after the loop (see \ref for_each()).
+ */
+template <typename T> class WorkerPool {
+public:
+    /// Borrow an entry of the pool, or create a new one using \c create
+    template <typename Func> T acquire(Func &&create) {
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            if (!m_free.empty()) {
+                T value = std::move(m_free.back());
+                m_free.pop_back();
+                return value;
+            }
+        }
+        return create();
+    }
+
+    /// Return an entry to the pool
+    void release(T &&value) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        m_free.push_back(std::move(value));
+    }
+
+    /// Invoke \c func on every entry (once the parallel loop has finished)
+    template <typename Func> void for_each(Func &&func) {
+        std::lock_guard<std::mutex> guard(m_mutex);
+        for (T &value : m_free)
+            func(value);
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<T> m_free;
+};
+
+/**
+ * \brief Location of the color and weight channels within the image blocks
+ * of \c film, as a pair <tt>(color channel count, weight channel)</tt>
+ */
+template <typename Film>
+static std::pair<uint32_t, uint32_t> adaptive_channels(const Film *film,
+                                                       size_t n_channels) {
+    uint32_t weight_ch =
+        has_flag(film->flags(), FilmFlags::Special)
+            ? (uint32_t) n_channels - 1
+            : (has_flag(film->flags(), FilmFlags::Alpha) ? 4u : 3u);
+    return { std::min(weight_ch, 3u), weight_ch };
+}
+
+/**
+ * \brief Estimate of a pixel in the current pass of adaptive sampling, i.e.
+ * the average of its color channels divided by its weight
+ *
+ * \c channel(c) returns channel \c c of the pixel within the image block.
+ */
+template <typename Value, typename Channel>
+static Value adaptive_estimate(const Channel &channel, uint32_t color_ch,
+                               uint32_t weight_ch) {
+    Value value = 0.f;
+    for (uint32_t c = 0; c < color_ch; ++c)
+        value += channel(c);
+    value /= (dr::scalar_t<Value>) color_ch;
+    Value weight = channel(weight_ch);
+    return dr::select(weight > 0.f, value / weight, value);
+}
+
+/**
+ * \brief Relative error of the mean of a pixel after \c k passes of adaptive
+ * sampling, given the sum and sum of squares of its per-pass estimates
+ */
+template <typename Value>
+static Value adaptive_error(const Value &sum, const Value &sum2,
+                            dr::scalar_t<Value> k) {
+    Value mean = sum / k,
+          var  = dr::maximum(sum2 / k - mean * mean, 0.f) *
+                 (k / dr::maximum(k - 1.f, 1.f));
+    return dr::sqrt(var / k) / (mean + 1e-3f);
+}
+
 // -----------------------------------------------------------------------------
 
 MI_VARIANT Integrator<Float, Spectrum>::Integrator(const Properties & props)
-    : m_stop(false) {
+    : m_stop(false), m_pass_sample_count(0) {
     m_timeout = props.get<ScalarFloat>("timeout", -1.f);
 
     // Disable direct visibility of emitters if needed
@@ -41,6 +235,24 @@ Integrator<Float, Spectrum>::render(Scene *scene,
                   seed, spp, develop, evaluate);
 }
 
+MI_VARIANT std::vector<typename Integrator<Float, Spectrum>::TensorXf>
+Integrator<Float, Spectrum>::render_sensors(Scene *scene,
+                                            const std::vector<Sensor *> &sensors,
+                                            uint32_t seed,
+                                            uint32_t spp,
+                                            bool develop,
+                                            bool evaluate) {
+    std::vector<TensorXf> result;
+    result.reserve(sensors.size());
+    for (Sensor *sensor : sensors) {
+        if (m_stop)
+            break;
+        result.push_back(render(scene, sensor, seed, spp, develop, evaluate));
+    }
+    result.resize(sensors.size());
+    return result;
+}
+
 MI_VARIANT std::vector<std::string> Integrator<Float, Spectrum>::aov_names() const {
     return { };
 }
@@ -49,6 +261,16 @@ MI_VARIANT void Integrator<Float, Spectrum>::cancel() {
     m_stop = true;
 }
 
+MI_VARIANT size_t
+Integrator<Float, Spectrum>::render_memory_footprint(const Sensor *sensor,
+                                                     uint32_t /* spp */) const {
+    const Film *film = sensor->film();
+    std::vector<std::string> aovs = aov_names();
+    return film->storage_footprint(aovs) +
+           (size_t) dr::prod(film->crop_size()) * film->channel_count(aovs) *
+               sizeof(ScalarFloat);
+}
+
 // -----------------------------------------------------------------------------
 
 MI_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Properties &props)
@@ -64,8 +286,47 @@ MI_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Propert
         m_block_size = block_size;
     }
 
+    m_block_order = block_order(props.string("block_order", "spiral"));
+
+    m_packet_size = props.get<uint32_t>("packet_size", 1);
+    if (m_packet_size == 0 || m_packet_size > 16 ||
+        !math::is_power_of_two(m_packet_size))
+        Throw("The 'packet_size' parameter must be a power of two between 1 "
+              "and 16.");
+
     m_samples_per_pass = props.get<uint32_t>("samples_per_pass", (uint32_t) -1);
-    if (m_samples_per_pass != (uint32_t) -1) {
+
+    m_adaptive_threshold = props.get<ScalarFloat>("adaptive_threshold", 0.f);
+    m_adaptive_min_passes = props.get<uint32_t>("adaptive_min_passes", 2);
+    m_adaptive_defocus = props.get<ScalarFloat>("adaptive_defocus", 0.f);
+    if (m_adaptive_defocus < 0.f)
+        Throw("The 'adaptive_defocus' parameter must be non-negative.");
+
+    m_time_budget = props.get<ScalarFloat>("time_budget", 0.f);
+
+    m_memory_fraction = props.get<ScalarFloat>("memory_fraction", .8f);
+    if (!(m_memory_fraction >= 0.f && m_memory_fraction <= 1.f))
+        Throw("The 'memory_fraction' parameter must be in the range [0, 1].");
+    m_memory_budget = (size_t) props.get<int64_t>("memory_budget", 0);
+    m_sample_memory = (size_t) props.get<int64_t>("sample_memory", 0);
+
+    m_cache_primary = props.get<bool>("cache_primary", false);
+
+    if (m_time_budget > 0.f) {
+        if (m_adaptive_threshold > 0.f)
+            Throw("The 'time_budget' and 'adaptive_threshold' parameters "
+                  "cannot be combined.");
+        if (m_samples_per_pass == (uint32_t) -1)
+            Throw("Time-budgeted rendering ('time_budget' > 0) requires the "
+                  "'samples_per_pass' parameter to be specified.");
+    } else if (m_adaptive_threshold > 0.f) {
+        if (m_samples_per_pass == (uint32_t) -1)
+            Throw("Adaptive sampling ('adaptive_threshold' > 0) requires the "
+                  "'samples_per_pass' parameter to be specified.");
+        if (m_adaptive_min_passes < 2)
+            Throw("The 'adaptive_min_passes' parameter must be at least 2, since "
+                  "the error estimate is based on the variance between passes.");
+    } else if (m_samples_per_pass != (uint32_t) -1) {
         Log(Warn, "The 'samples_per_pass' is deprecated, as a poor choice of "
                   "this parameter can have a detrimental effect on performance. "
                   "Please leave it undefined; Mitsuba will then automatically "
@@ -75,6 +336,235 @@ MI_VARIANT SamplingIntegrator<Float, Spectrum>::SamplingIntegrator(const Propert
 
 MI_VARIANT SamplingIntegrator<Float, Spectrum>::~SamplingIntegrator() { }
 
+MI_VARIANT size_t
+SamplingIntegrator<Float, Spectrum>::render_memory_footprint(const Sensor *sensor,
+                                                             uint32_t spp) const {
+    const Film *film = sensor->film();
+    size_t result = Base::render_memory_footprint(sensor, spp),
+           channels = film->channel_count(aov_names());
+
+    if constexpr (!dr::is_jit_v<Float>) {
+        // Every worker thread renders into an image block with a border
+        size_t block_size = m_block_size ? m_block_size : MI_BLOCK_SIZE,
+               border = film->rfilter()->border_size();
+        block_size += 2 * border;
+        result += Thread::thread_count() * block_size * block_size *
+                  channels * sizeof(ScalarFloat);
+    } else {
+        if (spp == 0)
+            spp = sensor->sampler()->sample_count();
+        if (m_samples_per_pass != (uint32_t) -1)
+            spp = std::min(spp, m_samples_per_pass);
+
+        /* Rough size of the state of one lane of the wavefront: ray, sampler
+           state, throughput, radiance and AOVs of a path tracer */
+        size_t lane_size = m_sample_memory
+                               ? m_sample_memory
+                               : std::max((32 + channels) * sizeof(ScalarFloat),
+                                          m_measured_sample_memory);
+        result += (size_t) dr::prod(film->crop_size()) * spp * lane_size;
+    }
+
+    return result;
+}
+
+MI_VARIANT uint32_t
+SamplingIntegrator<Float, Spectrum>::time_budget_passes(uint32_t done,
+                                                        uint32_t n_passes,
+                                                        ScalarFloat pass_time) const {
+    ScalarFloat remaining =
+        m_time_budget - (ScalarFloat) m_render_timer.value() / 1000.f;
+    if (remaining <= 0.f || done >= n_passes)
+        return done;
+    if (pass_time <= 0.f)
+        return n_passes;
+
+    // Only plan passes that are expected to finish within the deadline
+    ScalarFloat fit = dr::floor(remaining / pass_time);
+    return (uint32_t) dr::minimum((ScalarFloat) done + fit, (ScalarFloat) n_passes);
+}
+
+MI_VARIANT uint32_t
+SamplingIntegrator<Float, Spectrum>::memory_limited_spp(const Scene *scene,
+                                                        const Sensor *sensor,
+                                                        size_t pixel_count,
+                                                        uint32_t spp,
+                                                        uint32_t spp_per_pass) {
+    if constexpr (dr::is_jit_v<Float>) {
+        if (m_samples_per_pass != (uint32_t) -1 || pixel_count == 0)
+            return spp_per_pass;
+
+        size_t budget = m_memory_budget;
+        if (budget == 0 && m_memory_fraction > 0.f && dr::is_cuda_v<Float>) {
+            size_t free_memory = 0;
+            if (cuda_free_memory(free_memory))
+                budget = (size_t) ((double) m_memory_fraction * (double) free_memory);
+        }
+        if (budget == 0)
+            return spp_per_pass;
+
+        const Film *film = sensor->film();
+        size_t sample_memory = m_sample_memory;
+        if (sample_memory == 0) {
+            size_t channels = film->channel_count(aov_names());
+            sample_memory = std::max((32 + channels) * sizeof(ScalarFloat),
+                                     m_measured_sample_memory);
+
+            /* The estimate does not cover the temporaries of the integrator,
+               measure them when the wavefront might not fit */
+            if (m_measured_sample_memory == 0 && dr::is_cuda_v<Float> &&
+                4 * pixel_count * spp_per_pass * sample_memory > budget) {
+                m_measured_sample_memory = calibrate_sample_memory(scene, sensor);
+                sample_memory = std::max(sample_memory, m_measured_sample_memory);
+            }
+        }
+
+        size_t max_spp = budget / (pixel_count * sample_memory);
+        if (max_spp >= spp_per_pass)
+            return spp_per_pass;
+
+        // The passes must have the same number of samples
+        uint32_t result = (uint32_t) std::max(max_spp, (size_t) 1);
+        while (spp % result != 0)
+            --result;
+
+        Log(Info, "The wavefront of %zu samples would need %s of memory "
+                  "(budget: %s), rendering %u passes of %u sample%s per pixel "
+                  "instead.", pixel_count * spp_per_pass,
+            util::mem_string(pixel_count * spp_per_pass * sample_memory),
+            util::mem_string(budget), spp / result, result,
+            result == 1 ? "" : "s");
+        if (max_spp == 0)
+            Log(Warn, "The wavefront of a single sample per pixel exceeds the "
+                      "memory budget of a pass.");
+
+        return result;
+    } else {
+        DRJIT_MARK_USED(scene);
+        DRJIT_MARK_USED(sensor);
+        DRJIT_MARK_USED(pixel_count);
+        DRJIT_MARK_USED(spp);
+        return spp_per_pass;
+    }
+}
+
+MI_VARIANT size_t
+SamplingIntegrator<Float, Spectrum>::calibrate_sample_memory(const Scene *scene,
+                                                             const Sensor *sensor) {
+    if constexpr (dr::is_jit_v<Float>) {
+        dr::sync_thread();
+        size_t free_before = 0, free_after = 0;
+        if (!cuda_free_memory(free_before))
+            return 0;
+
+        Film *film = sensor->film();
+        ScalarVector2u film_size = film->crop_size();
+        uint32_t count = std::min(dr::prod(film_size), 1u << 20);
+
+        {
+            ScopedTraceEvent trace("render", "Memory calibration");
+
+            // One sample in each of the first 'count' pixels of the film
+            ref<Sampler> sampler = sensor->sampler()->clone();
+            sampler->set_samples_per_wavefront(1);
+            sampler->seed(0, count);
+
+            ref<ImageBlock> block = film->create_block();
+            block->set_offset(film->crop_offset());
+
+            UInt32 idx = dr::arange<UInt32>(count);
+            Vector2u pos;
+            pos.y() = idx / film_size[0];
+            pos.x() = dr::fnmadd(film_size[0], pos.y(), idx);
+            pos += film->crop_offset();
+
+            std::unique_ptr<Float[]> aovs(new Float[film->channel_count(aov_names())]);
+            render_sample(scene, sensor, sampler, block, aovs.get(), pos, 1.f);
+            dr::eval(block->tensor());
+            dr::sync_thread();
+        }
+
+        /* Dr.Jit keeps the released memory in its allocation cache, so the
+           free memory of the device still reflects the peak usage */
+        if (!cuda_free_memory(free_after) || free_after >= free_before)
+            return 0;
+
+        size_t result = (free_before - free_after + count - 1) / count;
+        Log(Debug, "Memory calibration: %s per sample.", util::mem_string(result));
+        return result;
+    } else {
+        DRJIT_MARK_USED(scene);
+        DRJIT_MARK_USED(sensor);
+        return 0;
+    }
+}
+
+/**
+ * Primary intersection of the sample that \ref SamplingIntegrator::render_block()
+ * currently shades on this thread in packet mode (scalar variants)
+ */
+template <typename PreliminaryIntersection3f>
+static const PreliminaryIntersection3f *&packet_primary_hit() {
+    static thread_local const PreliminaryIntersection3f *pi = nullptr;
+    return pi;
+}
+
+MI_VARIANT bool SamplingIntegrator<Float, Spectrum>::primary_cache_active() const {
+    if constexpr (dr::is_jit_v<Float>)
+        return m_primary_cache.active;
+    else
+        return packet_primary_hit<PreliminaryIntersection3f>() != nullptr;
+}
+
+MI_VARIANT typename SamplingIntegrator<Float, Spectrum>::PreliminaryIntersection3f
+SamplingIntegrator<Float, Spectrum>::primary_intersection(const Scene *scene,
+                                                          const Ray3f &ray,
+                                                          Mask active) const {
+    if constexpr (!dr::is_jit_v<Float>) {
+        if (const PreliminaryIntersection3f *pi =
+                packet_primary_hit<PreliminaryIntersection3f>())
+            return *pi;
+    }
+
+    if (!m_primary_cache.active)
+        return scene->ray_intersect_preliminary(ray, /* coherent = */ true, active);
+
+    if (!m_primary_cache.valid) {
+        m_primary_cache.pi =
+            scene->ray_intersect_preliminary(ray, /* coherent = */ true, active);
+        // Evaluated along with the first pass
+        dr::schedule(m_primary_cache.pi);
+        m_primary_cache.valid = true;
+    }
+
+    return m_primary_cache.pi;
+}
+
+MI_VARIANT Float
+SamplingIntegrator<Float, Spectrum>::defocus_min_passes(const Scene *scene,
+                                                        const Sensor *sensor,
+                                                        const Vector2f &pos) const {
+    const Film *film = sensor->film();
+    ScalarVector2f scale = 1.f / ScalarVector2f(film->crop_size()),
+                   offset = -ScalarVector2f(film->crop_offset()) * scale;
+
+    // Ray through the center of the aperture at the middle of the shutter interval
+    Float time = sensor->shutter_open() + .5f * sensor->shutter_open_time();
+    auto [ray, ray_weight] = sensor->sample_ray(
+        time, .5f, dr::fmadd(pos, scale, offset), Point2f(.5f));
+    DRJIT_MARK_USED(ray_weight);
+
+    SurfaceInteraction3f si =
+        scene->ray_intersect(ray, +RayFlags::Minimal, true);
+
+    // Rays that don't hit anything see the far clip plane
+    Mask hit = si.is_valid();
+    Point3f p = dr::select(hit, si.p, ray(ray.maxt));
+    Float coc = sensor->circle_of_confusion(p, hit || dr::isfinite(ray.maxt));
+
+    return (ScalarFloat) m_adaptive_min_passes * dr::fmadd(m_adaptive_defocus, coc, 1.f);
+}
+
 MI_VARIANT typename SamplingIntegrator<Float, Spectrum>::TensorXf
 SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
                                             Sensor *sensor,
@@ -118,14 +608,6 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
         // Render on the CPU using a spiral pattern
         uint32_t n_threads = (uint32_t) Thread::thread_count();
 
-        Log(Info, "Starting render job (%ux%u, %u sample%s,%s %u thread%s)",
-            film_size.x(), film_size.y(), spp, spp == 1 ? "" : "s",
-            n_passes > 1 ? tfm::format(" %u passes,", n_passes) : "", n_threads,
-            n_threads == 1 ? "" : "s");
-
-        if (m_timeout > 0.f)
-            Log(Info, "Timeout specified: %.2f seconds.", m_timeout);
-
         // If no block size was specified, find size that is good for parallelization
         uint32_t block_size = m_block_size;
         if (block_size == 0) {
@@ -139,7 +621,31 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
             }
         }
 
-        Spiral spiral(film_size, film->crop_offset(), block_size, n_passes);
+        /* Tiny films (e.g. radiance meters or small crop windows) have fewer
+           blocks than threads even with a block size of one pixel. Split
+           their samples into passes, whose blocks are rendered in parallel
+           and accumulated by the film. */
+        uint32_t film_blocks = dr::prod((film_size + block_size - 1) / block_size);
+        if (m_samples_per_pass == (uint32_t) -1 && film_blocks < n_threads &&
+            m_adaptive_threshold <= 0.f && m_time_budget <= 0.f && !m_pass_callback) {
+            uint32_t passes = std::min((4 * n_threads + film_blocks - 1) / film_blocks, spp);
+            while (spp % passes != 0)
+                ++passes;
+            n_passes = passes;
+            spp_per_pass = spp / n_passes;
+        }
+        m_pass_sample_count = spp_per_pass;
+
+        Log(Info, "Starting render job (%ux%u, %u sample%s,%s %u thread%s)",
+            film_size.x(), film_size.y(), spp, spp == 1 ? "" : "s",
+            n_passes > 1 ? tfm::format(" %u passes,", n_passes) : "", n_threads,
+            n_threads == 1 ? "" : "s");
+
+        if (m_timeout > 0.f)
+            Log(Info, "Timeout specified: %.2f seconds.", m_timeout);
+
+        Spiral spiral(film_size, film->crop_offset(), block_size, n_passes,
+                      m_block_order);
 
         std::mutex mutex;
         ref<ProgressReporter> progress;
@@ -148,8 +654,8 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
             progress = new ProgressReporter("Rendering");
 
         // Total number of blocks to be handled, including multiple passes.
-        uint32_t total_blocks = spiral.block_count() * n_passes,
-                 blocks_done = 0;
+        uint32_t total_blocks = spiral.block_count() * n_passes;
+        std::atomic<uint32_t> blocks_done(0);
 
         // Grain size for parallelization
         uint32_t grain_size = std::max(total_blocks / (4 * n_threads), 1u);
@@ -158,24 +664,210 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
         seed *= dr::prod(film_size);
 
         ThreadEnvironment env;
-        dr::parallel_for(
-            dr::blocked_range<uint32_t>(0, total_blocks, grain_size),
-            [&](const dr::blocked_range<uint32_t> &range) {
-                ScopedSetThreadEnvironment set_env(env);
-                // Fork a non-overlapping sampler for the current worker
-                ref<Sampler> sampler = sensor->sampler()->fork();
 
-                ref<ImageBlock> block = film->create_block(
-                    ScalarVector2u(block_size) /* size */,
-                    false /* normalize */,
-                    true /* border */);
+        // Samplers and image blocks of the workers, reused by all ranges and passes
+        struct Worker {
+            ref<Sampler> sampler;
+            ref<ImageBlock> block;
+        };
+        WorkerPool<Worker> workers;
+        auto create_worker = [&]() {
+            // Fork a non-overlapping sampler for the new worker
+            return Worker{ sensor->sampler()->fork(),
+                           film->create_block(
+                               ScalarVector2u(block_size) /* size */,
+                               false /* normalize */,
+                               true /* border */) };
+        };
+
+        if (m_adaptive_threshold > 0.f && n_passes > 1) {
+            /* Adaptive sampling: render the image pass by pass and keep track
+               of the per-pass estimates of every pixel. Tiles whose average
+               relative error falls below the threshold receive no further
+               passes. */
+            struct Tile {
+                ScalarPoint2i offset;
+                ScalarVector2u size;
+                std::vector<ScalarFloat> sum, sum2;
+                uint32_t min_passes;
+                bool converged = false;
+            };
+
+            uint32_t tile_count = spiral.block_count();
+            std::vector<Tile> tiles(tile_count);
+            for (uint32_t i = 0; i < tile_count; ++i) {
+                auto [offset, size, block_id] = spiral.next_block();
+                DRJIT_MARK_USED(block_id);
+                tiles[i].offset = offset;
+                tiles[i].size = size;
+                tiles[i].sum.resize(dr::prod(size), 0.f);
+                tiles[i].sum2.resize(dr::prod(size), 0.f);
+                tiles[i].min_passes = m_adaptive_min_passes;
+            }
 
-                std::unique_ptr<Float[]> aovs(new Float[n_channels]);
+            // Defocused tiles receive more passes before they may be retired
+            if (m_adaptive_defocus > 0.f) {
+                dr::parallel_for(
+                    dr::blocked_range<uint32_t>(0, tile_count, 1),
+                    [&](const dr::blocked_range<uint32_t> &range) {
+                        ScopedSetThreadEnvironment set_env(env);
+                        for (uint32_t i = range.begin(); i != range.end(); ++i) {
+                            Tile &tile = tiles[i];
+                            ScalarVector2f origin = ScalarVector2f(tile.offset) + .5f;
+                            if (film->sample_border())
+                                origin -= (ScalarFloat) film->rfilter()->border_size();
+
+                            ScalarFloat sum = 0.f;
+                            for (uint32_t y = 0; y < tile.size.y(); ++y)
+                                for (uint32_t x = 0; x < tile.size.x(); ++x)
+                                    sum += defocus_min_passes(
+                                        scene, sensor,
+                                        origin + ScalarVector2f((ScalarFloat) x,
+                                                                (ScalarFloat) y));
+                            tile.min_passes = (uint32_t) dr::ceil(
+                                sum / (ScalarFloat) dr::prod(tile.size));
+                        }
+                    }
+                );
+            }
 
-                // Render up to 'grain_size' image blocks
-                for (uint32_t i = range.begin();
-                     i != range.end() && !should_stop(); ++i) {
-                    auto [offset, size, block_id] = spiral.next_block();
+            uint32_t color_ch, weight_ch;
+            std::tie(color_ch, weight_ch) = adaptive_channels(film, n_channels);
+
+            std::vector<uint32_t> active(tile_count);
+            for (uint32_t i = 0; i < tile_count; ++i)
+                active[i] = i;
+
+            for (uint32_t pass = 0; pass < n_passes && !active.empty() &&
+                                    !should_stop(); ++pass) {
+                ScalarFloat k = (ScalarFloat) (pass + 1);
+                bool may_retire = pass + 1 >= m_adaptive_min_passes &&
+                                  pass + 1 < n_passes;
+                uint32_t n_active = (uint32_t) active.size();
+
+                ScopedTraceEvent trace_pass("render", "Pass");
+                trace_pass.set_arg("pass", pass);
+                trace_pass.set_arg("blocks", n_active);
+
+                dr::parallel_for(
+                    dr::blocked_range<uint32_t>(
+                        0, n_active, std::max(n_active / (4 * n_threads), 1u)),
+                    [&](const dr::blocked_range<uint32_t> &range) {
+                        ScopedSetThreadEnvironment set_env(env);
+                        Worker worker = workers.acquire(create_worker);
+                        Sampler *sampler = worker.sampler;
+                        ImageBlock *block = worker.block;
+
+                        // Scratch memory of this worker, rewound after every block
+                        ScratchArena &arena = ScratchArena::thread();
+                        arena.reset();
+                        Float *aovs = arena.allocate_array<Float>(n_channels);
+
+                        for (uint32_t i = range.begin();
+                             i != range.end() && !should_stop(); ++i) {
+                            uint32_t tile_id = active[i];
+                            Tile &tile = tiles[tile_id];
+
+                            // Use the same block identifiers as the regular spiral
+                            uint32_t block_id =
+                                tile_id + (n_passes - pass - 1) * tile_count;
+
+                            ScalarPoint2i offset = tile.offset;
+                            if (film->sample_border())
+                                offset -= film->rfilter()->border_size();
+
+                            block->set_size(tile.size);
+                            block->set_offset(offset);
+
+                            ScopedTraceEvent trace("render", "Block");
+                            trace.set_arg("block", block_id);
+                            trace.set_arg("pass", pass);
+                            trace.set_arg("x", tile.offset.x());
+                            trace.set_arg("y", tile.offset.y());
+
+                            render_block(scene, sensor, sampler, block, aovs,
+                                         spp_per_pass, seed, block_id, block_size,
+                                         pass * spp_per_pass);
+
+                            /* Update the per-pixel statistics. The tile is
+                               owned by this worker during the current pass. */
+                            const ScalarFloat *data = block->tensor().data();
+                            uint32_t border = block->border_size(),
+                                     width  = tile.size.x() + 2 * border;
+                            ScalarFloat error = 0.f;
+
+                            for (uint32_t y = 0; y < tile.size.y(); ++y) {
+                                for (uint32_t x = 0; x < tile.size.x(); ++x) {
+                                    const ScalarFloat *pixel =
+                                        data + ((y + border) * width + x + border) * n_channels;
+
+                                    ScalarFloat value = adaptive_estimate<ScalarFloat>(
+                                        [pixel](uint32_t c) { return pixel[c]; },
+                                        color_ch, weight_ch);
+
+                                    uint32_t j = y * tile.size.x() + x;
+                                    tile.sum[j] += value;
+                                    tile.sum2[j] += value * value;
+                                    error += adaptive_error(tile.sum[j], tile.sum2[j], k);
+                                }
+                            }
+
+                            if (may_retire && pass + 1 >= tile.min_passes &&
+                                error < m_adaptive_threshold * dr::prod(tile.size))
+                                tile.converged = true;
+
+                            {
+                                ScopedTraceEvent trace_put("render", "put_block");
+                                film->put_block(block);
+                            }
+
+                            uint32_t increment = tile.converged ? n_passes - pass : 1;
+                            uint32_t done = blocks_done.fetch_add(
+                                increment, std::memory_order_relaxed) + increment;
+                            if (progress) {
+                                std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+                                if (lock.owns_lock())
+                                    progress->update(done / (float) total_blocks);
+                            }
+                        }
+
+                        workers.release(std::move(worker));
+                    }
+                );
+
+                active.erase(std::remove_if(active.begin(), active.end(),
+                                            [&](uint32_t i) { return tiles[i].converged; }),
+                             active.end());
+
+                if (m_pass_callback && !should_stop() &&
+                    !m_pass_callback(pass + 1, n_passes))
+                    m_stop = true;
+            }
+
+            uint32_t converged = 0;
+            for (const Tile &tile : tiles)
+                converged += tile.converged;
+
+            Log(Info, "Adaptive sampling: %u/%u tiles converged before the final "
+                      "pass.", converged, tile_count);
+        } else {
+            auto render_blocks = [&](const dr::blocked_range<uint32_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+                Worker worker = workers.acquire(create_worker);
+                Sampler *sampler = worker.sampler;
+                ImageBlock *block = worker.block;
+
+                // Scratch memory of this worker, rewound after every block
+                ScratchArena &arena = ScratchArena::thread();
+                arena.reset();
+                Float *aovs = arena.allocate_array<Float>(n_channels);
+
+                /* Render up to 'grain_size' image blocks. They are claimed
+                   as one contiguous run, which keeps the blocks of a worker
+                   close to each other in the image. */
+                auto [first, last] = spiral.next_blocks(range.end() - range.begin());
+                for (uint32_t i = first; i != last && !should_stop(); ++i) {
+                    auto [offset, size, block_id] = spiral.block(i);
                     Assert(dr::prod(size) != 0);
 
                     if (film->sample_border())
@@ -184,24 +876,92 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
                     block->set_size(size);
                     block->set_offset(offset);
 
-                    render_block(scene, sensor, sampler, block, aovs.get(),
-                                 spp_per_pass, seed, block_id, block_size);
+                    {
+                        // The spiral numbers the blocks of the last pass first
+                        uint32_t pass = n_passes - 1 - block_id / spiral.block_count();
 
-                    film->put_block(block);
+                        ScopedTraceEvent trace("render", "Block");
+                        trace.set_arg("block", block_id);
+                        trace.set_arg("pass", pass);
+                        trace.set_arg("x", offset.x());
+                        trace.set_arg("y", offset.y());
+
+                        render_block(scene, sensor, sampler, block, aovs,
+                                     spp_per_pass, seed, block_id, block_size,
+                                     pass * spp_per_pass);
+                    }
+
+                    {
+                        ScopedTraceEvent trace("render", "put_block");
+                        film->put_block(block);
+                    }
 
-                    /* Critical section: update progress bar */
+                    /* Update the progress bar. Workers never wait for each
+                       other here: if another thread is currently refreshing
+                       the progress bar, this update is simply skipped. */
+                    uint32_t done = blocks_done.fetch_add(1, std::memory_order_relaxed) + 1;
                     if (progress) {
-                        std::lock_guard<std::mutex> lock(mutex);
-                        blocks_done++;
-                        progress->update(blocks_done / (float) total_blocks);
+                        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+                        if (lock.owns_lock())
+                            progress->update(done / (float) total_blocks);
                     }
                 }
+
+                workers.release(std::move(worker));
+            };
+
+            bool budget = m_time_budget > 0.f && n_passes > 1;
+
+            if (m_pass_callback || budget) {
+                /* Progressive and time-budgeted rendering: finish all blocks
+                   of a pass before handing the film to the callback or
+                   deciding whether another pass fits into the budget */
+                uint32_t block_count = spiral.block_count(),
+                         n_target = n_passes;
+                for (uint32_t pass = 0; pass < n_target && !should_stop(); ++pass) {
+                    ScopedTraceEvent trace_pass("render", "Pass");
+                    trace_pass.set_arg("pass", pass);
+                    Timer pass_timer;
+                    dr::parallel_for(
+                        dr::blocked_range<uint32_t>(
+                            0, block_count,
+                            std::max(block_count / (4 * n_threads), 1u)),
+                        render_blocks);
+
+                    if (budget) {
+                        n_target = time_budget_passes(
+                            pass + 1, n_passes, pass_timer.value() / 1000.f);
+                        if (pass == 0)
+                            Log(Info, "Time budget: planning %u of %u passes.",
+                                n_target, n_passes);
+                    }
+
+                    if (m_pass_callback && !should_stop() &&
+                        !m_pass_callback(pass + 1, n_target))
+                        m_stop = true;
+                }
+
+                if (budget && progress)
+                    total_blocks = blocks_done.load();
+            } else {
+                dr::parallel_for(
+                    dr::blocked_range<uint32_t>(0, total_blocks, grain_size),
+                    render_blocks);
             }
-        );
+        }
+
+        // The last update may have been skipped, make sure it is shown
+        if (progress)
+            progress->update(blocks_done.load() / (float) total_blocks);
 
         if (develop)
             result = film->develop();
     } else {
+        // Split the samples into passes that fit into the device memory
+        spp_per_pass = memory_limited_spp(scene, sensor, dr::prod(film_size),
+                                          spp, spp_per_pass);
+        n_passes = spp / spp_per_pass;
+
         size_t wavefront_size = (size_t) film_size.x() *
                                 (size_t) film_size.y() * (size_t) spp_per_pass,
                wavefront_size_limit = 0xffffffffu;
@@ -221,6 +981,7 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
                 "task into %zu smaller passes to avoid exceeding the limits.",
                 wavefront_size, n_passes);
         }
+        m_pass_sample_count = spp_per_pass;
 
         dr::sync_thread(); // Separate from scene initialization (for timings)
 
@@ -234,6 +995,11 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
             evaluate = true;
         }
 
+        // The film must be evaluated before it is handed to the pass callback
+        bool budget = m_time_budget > 0.f && n_passes > 1;
+        if (m_pass_callback || budget)
+            evaluate = true;
+
         // Inform the sampler about the passes (needed in vectorized modes)
         sampler->set_samples_per_wavefront(spp_per_pass);
 
@@ -273,19 +1039,588 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
         Timer timer;
         std::unique_ptr<Float[]> aovs(new Float[n_channels]);
 
+        /* While tracing, every pass waits for its kernels to finish, such
+           that the pass events cover their execution */
+        KernelTraceRecorder kernel_trace;
+
+        if (m_adaptive_threshold > 0.f && n_passes > 1) {
+            /* Adaptive sampling: every pass only launches the samples of
+               pixels belonging to tiles that have not converged yet. The
+               per-pass estimates of each pixel are tracked to compute the
+               average relative error of every tile. */
+            uint32_t tile_size   = m_block_size ? m_block_size : MI_BLOCK_SIZE,
+                     pixel_count = dr::prod(film_size);
+            ScalarVector2u tile_res = (film_size + tile_size - 1) / tile_size;
+            uint32_t tile_count = dr::prod(tile_res);
+
+            uint32_t color_ch, weight_ch;
+            std::tie(color_ch, weight_ch) = adaptive_channels(film, n_channels);
+
+            UInt32 pixel_idx = dr::arange<UInt32>(pixel_count);
+            Vector2u pixel_pos;
+            pixel_pos.y() = pixel_idx / film_size[0];
+            pixel_pos.x() = dr::fnmadd(film_size[0], pixel_pos.y(), pixel_idx);
+
+            UInt32 tile_idx = dr::fmadd(pixel_pos.y() / tile_size, tile_res.x(),
+                                        pixel_pos.x() / tile_size);
+
+            // Pixels of the sampling grid that lie in the border region reuse
+            // the estimates of the closest pixel of the image block
+            Vector2u block_pos = pixel_pos;
+            if (film->sample_border()) {
+                uint32_t border = film->rfilter()->border_size();
+                block_pos = dr::minimum(
+                    Vector2u(dr::maximum(Vector2i(pixel_pos) - (int) border, 0)),
+                    film->crop_size() - 1u);
+            }
+            UInt32 block_idx = dr::fmadd(block_pos.y(), film->crop_size().x(),
+                                         block_pos.x()) * (uint32_t) n_channels;
+
+            Float tile_pixels = dr::zeros<Float>(tile_count);
+            dr::scatter_reduce(ReduceOp::Add, tile_pixels, Float(1.f), tile_idx);
+
+            // Defocused tiles receive more passes before they may be retired
+            Float tile_passes;
+            if (m_adaptive_defocus > 0.f) {
+                ScalarVector2f origin = ScalarVector2f(film->crop_offset()) + .5f;
+                if (film->sample_border())
+                    origin -= (ScalarFloat) film->rfilter()->border_size();
+
+                tile_passes = dr::zeros<Float>(tile_count);
+                dr::scatter_reduce(
+                    ReduceOp::Add, tile_passes,
+                    defocus_min_passes(scene, sensor, Vector2f(pixel_pos) + origin),
+                    tile_idx);
+                tile_passes = dr::ceil(tile_passes / tile_pixels);
+                dr::eval(tile_passes);
+            }
+
+            Float sum  = dr::zeros<Float>(pixel_count),
+                  sum2 = dr::zeros<Float>(pixel_count);
+            Mask pixel_active = dr::full<Mask>(true, pixel_count);
+            UInt32 active_idx = pixel_idx;
+            dr::eval(tile_pixels, sum, sum2, pixel_active);
+
+            for (uint32_t pass = 0; pass < n_passes && !should_stop(); ++pass) {
+                uint32_t n_active = (uint32_t) dr::width(active_idx);
+                if (n_active == 0)
+                    break;
+
+                ScopedTraceEvent trace_pass("render", "Pass");
+                trace_pass.set_arg("pass", pass);
+                trace_pass.set_arg("pixels", n_active);
+
+                uint32_t pass_size = n_active * spp_per_pass;
+                sampler->seed(seed + pass * (uint32_t) wavefront_size, pass_size);
+
+                UInt32 sample_pixel = dr::gather<UInt32>(
+                    active_idx,
+                    dr::arange<UInt32>(pass_size) / dr::opaque<UInt32>(spp_per_pass));
+
+                Vector2u pass_pos;
+                pass_pos.y() = sample_pixel / film_size[0];
+                pass_pos.x() = dr::fnmadd(film_size[0], pass_pos.y(), sample_pixel);
+
+                if (film->sample_border())
+                    pass_pos -= film->rfilter()->border_size();
+
+                pass_pos += film->crop_offset();
+
+                block->clear();
+                render_sample(scene, sensor, sampler, block, aovs.get(),
+                              pass_pos, diff_scale_factor);
+
+                // Per-pixel estimate of the current pass
+                const Float &data = block->tensor().array();
+                Float value = adaptive_estimate<Float>(
+                    [&](uint32_t c) { return dr::gather<Float>(data, block_idx + c); },
+                    color_ch, weight_ch);
+
+                sum  = dr::select(pixel_active, sum + value, sum);
+                sum2 = dr::select(pixel_active, dr::fmadd(value, value, sum2), sum2);
+
+                film->put_block(block);
+
+                if (pass + 1 >= m_adaptive_min_passes && pass + 1 < n_passes) {
+                    Float error = adaptive_error(sum, sum2, (ScalarFloat) (pass + 1));
+
+                    Float tile_error = dr::zeros<Float>(tile_count);
+                    dr::scatter_reduce(ReduceOp::Add, tile_error, error,
+                                       tile_idx, pixel_active);
+
+                    Mask tile_active =
+                        tile_error >= m_adaptive_threshold * tile_pixels;
+                    if (m_adaptive_defocus > 0.f)
+                        tile_active |= tile_passes > (ScalarFloat) (pass + 1);
+                    pixel_active &= dr::gather<Mask>(tile_active, tile_idx);
+                }
+
+                film->schedule_storage();
+                dr::eval(sum, sum2, pixel_active);
+                active_idx = dr::compress(pixel_active);
+                kernel_trace.record();
+
+                if (m_pass_callback && !should_stop() &&
+                    !m_pass_callback(pass + 1, n_passes))
+                    m_stop = true;
+            }
+
+            Log(Info, "Adaptive sampling: %u/%u pixels converged before the "
+                      "final pass.", pixel_count - (uint32_t) dr::width(active_idx),
+                pixel_count);
+        } else {
+            // Reuse the primary intersections of the first pass
+            if (m_cache_primary && n_passes > 1) {
+                const char *reason = nullptr;
+                if (sensor->needs_aperture_sample())
+                    reason = "the sensor has an aperture";
+                else if (sensor->shutter_open_time() > 0.f)
+                    reason = "the sensor has a shutter interval";
+                else if (!film->rfilter()->is_box_filter())
+                    reason = "the film does not use a box filter";
+
+                if (reason) {
+                    Log(Warn, "render(): not caching the primary intersections, "
+                              "since %s.", reason);
+                } else {
+                    // Hammersley points as the subpixel positions of a pixel
+                    UInt32 sample = dr::fnmadd(
+                        idx, spp_per_pass,
+                        dr::arange<UInt32>((uint32_t) wavefront_size));
+                    m_primary_cache.offset = Point2f(
+                        (Float(sample) + .5f) * (1.f / spp_per_pass),
+                        radical_inverse_2(sample));
+                    dr::eval(m_primary_cache.offset);
+                    m_primary_cache.active = true;
+                }
+            }
+
+            // Potentially render multiple passes
+            uint32_t n_target = n_passes;
+            for (uint32_t pass = 0; pass < n_target && !should_stop(); pass++) {
+                ScopedTraceEvent trace_pass("render", "Pass");
+                trace_pass.set_arg("pass", pass);
+                Timer pass_timer;
+                render_sample(scene, sensor, sampler, block, aovs.get(), pos,
+                              diff_scale_factor);
+
+                if (n_passes > 1) {
+                    sampler->advance(); // Will trigger a kernel launch of size 1
+                    sampler->schedule_state();
+                }
+
+                if (m_pass_callback) {
+                    /* Progressive rendering: accumulate every pass into the
+                       film, such that the callback sees all finished passes */
+                    film->put_block(block);
+                    block->clear();
+                    film->schedule_storage();
+                    dr::eval();
+                } else if (n_passes > 1) {
+                    dr::eval(block->tensor());
+                }
+
+                if (n_passes > 1)
+                    kernel_trace.record();
+
+                if (budget) {
+                    // Wait for the pass to finish to measure its duration
+                    dr::sync_thread();
+                    n_target = time_budget_passes(
+                        pass + 1, n_passes, pass_timer.value() / 1000.f);
+                    if (pass == 0)
+                        Log(Info, "Time budget: planning %u of %u passes.",
+                            n_target, n_passes);
+                }
+
+                if (m_pass_callback && !should_stop() &&
+                    !m_pass_callback(pass + 1, n_target))
+                    m_stop = true;
+            }
+
+            if (!m_pass_callback)
+                film->put_block(block);
+
+            m_primary_cache = PrimaryHitCache();
+        }
+
+        if (n_passes == 1 && jit_flag(JitFlag::VCallRecord) &&
+            jit_flag(JitFlag::LoopRecord)) {
+            Log(Info, "Computation graph recorded. (took %s)",
+                util::time_string((float) timer.reset(), true));
+        }
+
+        if (develop) {
+            result = film->develop();
+            dr::schedule(result);
+        } else {
+            film->schedule_storage();
+        }
+
+        if (evaluate) {
+            ScopedTraceEvent trace_eval("render", "Evaluation");
+            dr::eval();
+
+            if (n_passes == 1 && jit_flag(JitFlag::VCallRecord) &&
+                jit_flag(JitFlag::LoopRecord)) {
+                Log(Info, "Code generation finished. (took %s)",
+                    util::time_string((float) timer.value(), true));
+
+                /* Separate computation graph recording from the actual
+                   rendering time in single-pass mode */
+                m_render_timer.reset();
+            }
+
+            dr::sync_thread();
+            kernel_trace.record();
+        }
+    }
+
+    if (!m_stop && (evaluate || !dr::is_jit_v<Float>))
+        Log(Info, "Rendering finished. (took %s)",
+            util::time_string((float) m_render_timer.value(), true));
+
+    return result;
+}
+
+MI_VARIANT std::vector<typename SamplingIntegrator<Float, Spectrum>::TensorXf>
+SamplingIntegrator<Float, Spectrum>::render_sensors(Scene *scene,
+                                                    const std::vector<Sensor *> &sensors,
+                                                    uint32_t seed,
+                                                    uint32_t spp,
+                                                    bool develop,
+                                                    bool evaluate) {
+    for (Sensor *sensor : sensors) {
+        if (!sensor)
+            Throw("render_sensors(): the list of sensors contains an invalid entry!");
+    }
+
+    // Adaptive sampling tracks per-film statistics, render one sensor at a time
+    if (sensors.size() < 2 || m_adaptive_threshold > 0.f || m_time_budget > 0.f)
+        return Base::render_sensors(scene, sensors, seed, spp, develop, evaluate);
+
+    size_t n_sensors = sensors.size();
+
+    // Per-sensor rendering settings
+    struct SensorJob {
+        Sensor *sensor;
+        Film *film;
+        ScalarVector2u film_size;
+        uint32_t spp, spp_per_pass, n_passes;
+        size_t n_channels;
+    };
+
+    std::vector<SensorJob> jobs(n_sensors);
+    for (size_t i = 0; i < n_sensors; ++i) {
+        SensorJob &job = jobs[i];
+        job.sensor = sensors[i];
+        job.film = job.sensor->film();
+        job.film_size = job.film->crop_size();
+        if (job.film->sample_border())
+            job.film_size += 2 * job.film->rfilter()->border_size();
+
+        Sampler *sampler = job.sensor->sampler();
+        if (spp)
+            sampler->set_sample_count(spp);
+        job.spp = sampler->sample_count();
+
+        job.spp_per_pass = (m_samples_per_pass == (uint32_t) -1)
+                               ? job.spp
+                               : std::min(m_samples_per_pass, job.spp);
+
+        if ((job.spp % job.spp_per_pass) != 0)
+            Throw("sample_count (%d) must be a multiple of spp_per_pass (%d).",
+                  job.spp, job.spp_per_pass);
+
+        job.n_passes = job.spp / job.spp_per_pass;
+        job.n_channels = job.film->prepare(aov_names());
+    }
+
+    if constexpr (dr::is_jit_v<Float>) {
+        // A shared wavefront requires the sensors to agree on these settings
+        const SensorJob &first = jobs[0];
+        for (size_t i = 1; i < n_sensors; ++i) {
+            const SensorJob &job = jobs[i];
+            if (job.spp != first.spp || job.n_channels != first.n_channels ||
+                job.film->flags() != first.film->flags() ||
+                job.sensor->medium() != first.sensor->medium()) {
+                Log(Debug, "render_sensors(): sensors differ in their sample "
+                           "count, medium or film type, rendering them one "
+                           "after another.");
+                return Base::render_sensors(scene, sensors, seed, spp, develop,
+                                            evaluate);
+            }
+        }
+    }
+
+    ScopedPhase sp(ProfilerPhase::Render);
+    m_stop = false;
+
+    uint64_t pixel_count = 0;
+    for (const SensorJob &job : jobs)
+        pixel_count += dr::prod(job.film_size);
+
+    // Start the render timer (used for timeouts & log messages)
+    m_render_timer.reset();
+
+    std::vector<TensorXf> result(n_sensors);
+    if constexpr (!dr::is_jit_v<Float>) {
+        uint32_t n_threads = (uint32_t) Thread::thread_count();
+
+        Log(Info, "Starting render job (%zu sensors, %llu pixels, %u thread%s)",
+            n_sensors, (unsigned long long) pixel_count, n_threads,
+            n_threads == 1 ? "" : "s");
+
+        if (m_timeout > 0.f)
+            Log(Info, "Timeout specified: %.2f seconds.", m_timeout);
+
+        // If no block size was specified, find size that is good for parallelization
+        uint32_t block_size = m_block_size;
+        if (block_size == 0) {
+            block_size = MI_BLOCK_SIZE; // 32x32
+            while (true) {
+                // Ensure that there is a block for every thread
+                uint64_t block_count = 0;
+                for (const SensorJob &job : jobs)
+                    block_count += dr::prod((job.film_size + block_size - 1) /
+                                            block_size);
+                if (block_size == 1 || block_count >= n_threads)
+                    break;
+                block_size /= 2;
+            }
+        }
+
+        /* Every sensor has its own spiral. The blocks of all spirals
+           (including multiple passes) are enumerated one sensor after
+           another by a single parallel loop. */
+        std::vector<ref<Spiral>> spirals(n_sensors);
+        std::vector<uint32_t> block_offset(n_sensors + 1, 0);
+        std::vector<uint32_t> seed_offset(n_sensors + 1, 0);
+        for (size_t i = 0; i < n_sensors; ++i) {
+            const SensorJob &job = jobs[i];
+            spirals[i] = new Spiral(job.film_size, job.film->crop_offset(),
+                                    block_size, job.n_passes, m_block_order);
+            uint32_t block_count = spirals[i]->block_count() * job.n_passes;
+            block_offset[i + 1] = block_offset[i] + block_count;
+            // Avoid overlaps in RNG seeding between the sensors
+            seed_offset[i + 1] = seed_offset[i] + block_count * block_size * block_size;
+        }
+
+        std::mutex mutex;
+        ref<ProgressReporter> progress;
+        Logger* logger = mitsuba::Thread::thread()->logger();
+        if (logger && Info >= logger->log_level())
+            progress = new ProgressReporter("Rendering");
+
+        uint32_t total_blocks = block_offset[n_sensors];
+        std::atomic<uint32_t> blocks_done(0);
+
+        // Grain size for parallelization
+        uint32_t grain_size = std::max(total_blocks / (4 * n_threads), 1u);
+
+        // Avoid overlaps in RNG seeding RNG when a seed is manually specified
+        seed *= seed_offset[n_sensors];
+
+        // Samplers and image blocks of the workers, reused by all ranges
+        struct Worker {
+            ref<Sampler> sampler;
+            ref<ImageBlock> block;
+        };
+        std::vector<WorkerPool<Worker>> pools(n_sensors);
+
+        ThreadEnvironment env;
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(0, total_blocks, grain_size),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                ScopedSetThreadEnvironment set_env(env);
+
+                // Samplers and image blocks are borrowed on demand per sensor
+                std::vector<Worker> workers(n_sensors);
+                size_t max_channels = 0;
+                for (const SensorJob &job : jobs)
+                    max_channels = std::max(max_channels, job.n_channels);
+                ScratchArena &arena = ScratchArena::thread();
+                arena.reset();
+                Float *aovs = arena.allocate_array<Float>(max_channels);
+
+                for (uint32_t i = range.begin();
+                     i != range.end() && !should_stop(); ++i) {
+                    size_t s = (size_t) (std::upper_bound(block_offset.begin(),
+                                                          block_offset.end(), i) -
+                                         block_offset.begin()) - 1;
+                    const SensorJob &job = jobs[s];
+
+                    if (!workers[s].sampler) {
+                        workers[s] = pools[s].acquire([&]() {
+                            // Fork a non-overlapping sampler for the new worker
+                            return Worker{ job.sensor->sampler()->fork(),
+                                           job.film->create_block(
+                                               ScalarVector2u(block_size) /* size */,
+                                               false /* normalize */,
+                                               true /* border */) };
+                        });
+                    }
+
+                    auto [offset, size, block_id] = spirals[s]->next_block();
+                    Assert(dr::prod(size) != 0);
+
+                    if (job.film->sample_border())
+                        offset -= job.film->rfilter()->border_size();
+
+                    ImageBlock *block = workers[s].block;
+                    block->set_size(size);
+                    block->set_offset(offset);
+
+                    // The spiral numbers the blocks of the last pass first
+                    uint32_t pass =
+                        job.n_passes - 1 - block_id / spirals[s]->block_count();
+
+                    render_block(scene, job.sensor, workers[s].sampler, block,
+                                 aovs, job.spp_per_pass,
+                                 seed + seed_offset[s], block_id, block_size,
+                                 pass * job.spp_per_pass);
+
+                    job.film->put_block(block);
+
+                    uint32_t done = blocks_done.fetch_add(1, std::memory_order_relaxed) + 1;
+                    if (progress) {
+                        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+                        if (lock.owns_lock())
+                            progress->update(done / (float) total_blocks);
+                    }
+                }
+
+                for (size_t s = 0; s < n_sensors; ++s) {
+                    if (workers[s].sampler)
+                        pools[s].release(std::move(workers[s]));
+                }
+            }
+        );
+
+        // The last update may have been skipped, make sure it is shown
+        if (progress)
+            progress->update(blocks_done.load() / (float) total_blocks);
+
+        if (develop) {
+            for (size_t i = 0; i < n_sensors; ++i)
+                result[i] = jobs[i].film->develop();
+        }
+    } else {
+        uint32_t spp_all = jobs[0].spp,
+                 spp_per_pass = jobs[0].spp_per_pass,
+                 n_passes = jobs[0].n_passes;
+        size_t n_channels = jobs[0].n_channels;
+
+        // Split the samples into passes that fit into the device memory
+        spp_per_pass = memory_limited_spp(scene, jobs[0].sensor, pixel_count,
+                                          spp_all, spp_per_pass);
+        n_passes = spp_all / spp_per_pass;
+
+        size_t wavefront_size = (size_t) pixel_count * (size_t) spp_per_pass,
+               wavefront_size_limit = 0xffffffffu;
+
+        if (wavefront_size > wavefront_size_limit) {
+            spp_per_pass /=
+                (uint32_t)((wavefront_size + wavefront_size_limit - 1) /
+                           wavefront_size_limit);
+            n_passes       = spp_all / spp_per_pass;
+            wavefront_size = (size_t) pixel_count * (size_t) spp_per_pass;
+
+            Log(Warn,
+                "The requested rendering task involves %zu Monte Carlo "
+                "samples, which exceeds the upper limit of 2^32 = 4294967296 "
+                "for this variant. Mitsuba will instead split the rendering "
+                "task into %zu smaller passes to avoid exceeding the limits.",
+                wavefront_size, n_passes);
+        }
+
+        dr::sync_thread(); // Separate from scene initialization (for timings)
+
+        Log(Info, "Starting render job (%zu sensors, %llu pixels, %u sample%s%s)",
+            n_sensors, (unsigned long long) pixel_count, spp_all,
+            spp_all == 1 ? "" : "s",
+            n_passes > 1 ? tfm::format(", %u passes", n_passes) : "");
+
+        if (n_passes > 1 && !evaluate) {
+            Log(Warn, "render_sensors(): forcing 'evaluate=true' since "
+                      "multi-pass rendering was requested.");
+            evaluate = true;
+        }
+
+        // All sensors draw their samples from the sampler of the first one
+        Sampler *sampler = jobs[0].sensor->sampler();
+        sampler->set_samples_per_wavefront(spp_per_pass);
+        sampler->seed(seed, (uint32_t) wavefront_size);
+
+        UInt32 idx = dr::arange<UInt32>((uint32_t) wavefront_size);
+
+        // Try to avoid a division by an unknown constant if we can help it
+        uint32_t log_spp_per_pass = dr::log2i(spp_per_pass);
+        if ((1u << log_spp_per_pass) == spp_per_pass)
+            idx >>= dr::opaque<UInt32>(log_spp_per_pass);
+        else
+            idx /= dr::opaque<UInt32>(spp_per_pass);
+
+        /* The wavefront stores the pixels of all sensors one after another.
+           Compute the sensor and the position on its image plane for every
+           lane. */
+        std::vector<ref<ImageBlock>> blocks(n_sensors);
+        std::vector<Mask> masks(n_sensors);
+        Vector2f pos = dr::zeros<Vector2f>();
+        uint32_t pixel_offset = 0;
+        for (size_t i = 0; i < n_sensors; ++i) {
+            const SensorJob &job = jobs[i];
+            uint32_t pixels = dr::prod(job.film_size);
+
+            // Allocate a large image block that will receive the entire rendering
+            blocks[i] = job.film->create_block();
+            blocks[i]->set_offset(job.film->crop_offset());
+
+            // Only use the ImageBlock coalescing feature when rendering enough samples
+            blocks[i]->set_coalesce(blocks[i]->coalesce() && spp_per_pass >= 4);
+
+            masks[i] = idx >= pixel_offset && idx < pixel_offset + pixels;
+
+            UInt32 local = idx - pixel_offset,
+                   row   = local / job.film_size[0];
+            Vector2i pos_i(Int32(dr::fnmadd(job.film_size[0], row, local)),
+                           Int32(row));
+
+            if (job.film->sample_border())
+                pos_i -= (int) job.film->rfilter()->border_size();
+
+            pos_i += ScalarVector2i(job.film->crop_offset());
+
+            pos = dr::select(masks[i], Vector2f(pos_i), pos);
+            pixel_offset += pixels;
+        }
+
+        // Scale factor that will be applied to ray differentials
+        ScalarFloat diff_scale_factor = dr::rsqrt((ScalarFloat) spp_all);
+
+        Timer timer;
+        std::unique_ptr<Float[]> aovs(new Float[n_channels]);
+        KernelTraceRecorder kernel_trace;
+
         // Potentially render multiple passes
         for (size_t i = 0; i < n_passes; i++) {
-            render_sample(scene, sensor, sampler, block, aovs.get(), pos,
-                          diff_scale_factor);
+            ScopedTraceEvent trace_pass("render", "Pass");
+            trace_pass.set_arg("pass", i);
+            render_sample(scene, sensors, masks, sampler, blocks, aovs.get(),
+                          pos, diff_scale_factor);
 
             if (n_passes > 1) {
                 sampler->advance(); // Will trigger a kernel launch of size 1
                 sampler->schedule_state();
-                dr::eval(block->tensor());
+                for (ImageBlock *block : blocks)
+                    dr::schedule(block->tensor());
+                dr::eval();
+                kernel_trace.record();
             }
         }
 
-        film->put_block(block);
+        for (size_t i = 0; i < n_sensors; ++i)
+            jobs[i].film->put_block(blocks[i]);
 
         if (n_passes == 1 && jit_flag(JitFlag::VCallRecord) &&
             jit_flag(JitFlag::LoopRecord)) {
@@ -293,14 +1628,17 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
                 util::time_string((float) timer.reset(), true));
         }
 
-        if (develop) {
-            result = film->develop();
-            dr::schedule(result);
-        } else {
-            film->schedule_storage();
+        for (size_t i = 0; i < n_sensors; ++i) {
+            if (develop) {
+                result[i] = jobs[i].film->develop();
+                dr::schedule(result[i]);
+            } else {
+                jobs[i].film->schedule_storage();
+            }
         }
 
         if (evaluate) {
+            ScopedTraceEvent trace_eval("render", "Evaluation");
             dr::eval();
 
             if (n_passes == 1 && jit_flag(JitFlag::VCallRecord) &&
@@ -314,6 +1652,7 @@ SamplingIntegrator<Float, Spectrum>::render(Scene *scene,
             }
 
             dr::sync_thread();
+            kernel_trace.record();
         }
     }
 
@@ -332,13 +1671,17 @@ MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *s
                                                                    uint32_t sample_count,
                                                                    uint32_t seed,
                                                                    uint32_t block_id,
-                                                                   uint32_t block_size) const {
+                                                                   uint32_t block_size,
+                                                                   uint32_t sample_offset) const {
 
     if constexpr (!dr::is_array_v<Float>) {
+        // Release the scratch allocations of the integrator and plugins
+        ScratchArena::Scope scratch(ScratchArena::thread());
+
         uint32_t pixel_count = block_size * block_size;
 
         // Avoid overlaps in RNG seeding RNG when a seed is manually specified
-        seed += block_id * pixel_count;
+        uint32_t block_seed = seed + block_id * pixel_count;
 
         // Scale down ray differentials when tracing multiple rays per pixel
         Float diff_scale_factor = dr::rsqrt((Float) sample_count);
@@ -346,18 +1689,79 @@ MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *s
         // Clear block (it's being reused)
         block->clear();
 
-        for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
-            sampler->seed(seed + i);
+        auto seed_pixel = [&](Sampler *pixel_sampler, uint32_t i, const Point2u &pos) {
+            /* The sequence seed identifies the pixel independently of the
+               pass, so that samplers can continue its sequence */
+            ScalarPoint2i pixel = ScalarPoint2i(pos) + block->offset();
+            uint32_t sequence_seed =
+                sample_tea_32(seed, ((uint32_t) pixel.y() << 16) ^ (uint32_t) pixel.x()).first;
+            pixel_sampler->seed_pass(block_seed + i, sequence_seed, sample_offset);
+        };
+
+        uint32_t packet_size = uses_primary_intersection() ? m_packet_size : 1;
+
+        if (packet_size == 1) {
+            for (uint32_t i = 0; i < pixel_count && !should_stop(); ++i) {
+                Point2u pos = dr::morton_decode<Point2u>(i);
+                if (dr::any(pos >= block->size()))
+                    continue;
+
+                seed_pixel(sampler, i, pos);
+
+                Point2f pos_f = Point2f(Point2i(pos) + block->offset());
+                for (uint32_t j = 0; j < sample_count && !should_stop(); ++j) {
+                    render_sample(scene, sensor, sampler, block, aovs, pos_f,
+                                  diff_scale_factor);
+                    sampler->advance();
+                }
+            }
+            return;
+        }
 
-            Point2u pos = dr::morton_decode<Point2u>(i);
-            if (dr::any(pos >= block->size()))
-                continue;
+        /* Every pixel of a packet draws its samples from its own copy of the
+           sampler, so that the sample sequences match the default mode */
+        ref<Sampler> samplers[16];
+        for (uint32_t k = 0; k < packet_size; ++k)
+            samplers[k] = sampler->clone();
+
+        const PreliminaryIntersection3f *&primary_hit =
+            packet_primary_hit<PreliminaryIntersection3f>();
+
+        Point2f pos_f[16], sample_pos[16];
+        RayDifferential3f rays[16];
+        Ray3f primary_rays[16];
+        Spectrum ray_weight[16];
+        PreliminaryIntersection3f pi[16];
+
+        for (uint32_t i = 0; i < pixel_count && !should_stop();) {
+            // Gather the next pixels of the block along the Morton curve
+            uint32_t count = 0;
+            for (; i < pixel_count && count < packet_size; ++i) {
+                Point2u pos = dr::morton_decode<Point2u>(i);
+                if (dr::any(pos >= block->size()))
+                    continue;
+                seed_pixel(samplers[count], i, pos);
+                pos_f[count++] = Point2f(Point2i(pos) + block->offset());
+            }
 
-            Point2f pos_f = Point2f(Point2i(pos) + block->offset());
             for (uint32_t j = 0; j < sample_count && !should_stop(); ++j) {
-                render_sample(scene, sensor, sampler, block, aovs, pos_f,
-                              diff_scale_factor);
-                sampler->advance();
+                for (uint32_t k = 0; k < count; ++k) {
+                    std::tie(rays[k], ray_weight[k], sample_pos[k]) =
+                        sample_camera_ray(sensor, samplers[k], pos_f[k],
+                                          diff_scale_factor);
+                    primary_rays[k] = rays[k];
+                }
+
+                scene->ray_intersect_preliminary_packet(primary_rays, pi, count);
+
+                // Shade the samples, which obtain their hit via primary_intersection()
+                for (uint32_t k = 0; k < count; ++k) {
+                    primary_hit = &pi[k];
+                    render_ray(scene, sensor, samplers[k], block, aovs,
+                               pos_f[k], sample_pos[k], rays[k], ray_weight[k]);
+                    primary_hit = nullptr;
+                    samplers[k]->advance();
+                }
             }
         }
     } else {
@@ -370,6 +1774,7 @@ MI_VARIANT void SamplingIntegrator<Float, Spectrum>::render_block(const Scene *s
         DRJIT_MARK_USED(seed);
         DRJIT_MARK_USED(block_id);
         DRJIT_MARK_USED(block_size);
+        DRJIT_MARK_USED(sample_offset);
         Throw("Not implemented for JIT arrays.");
     }
 }
@@ -383,15 +1788,31 @@ SamplingIntegrator<Float, Spectrum>::render_sample(const Scene *scene,
                                                    const Vector2f &pos,
                                                    ScalarFloat diff_scale_factor,
                                                    Mask active) const {
+    auto [ray, ray_weight, sample_pos] =
+        sample_camera_ray(sensor, sampler, pos, diff_scale_factor, active);
+    render_ray(scene, sensor, sampler, block, aovs, pos, sample_pos, ray,
+               ray_weight, active);
+}
+
+MI_VARIANT std::tuple<typename SamplingIntegrator<Float, Spectrum>::RayDifferential3f,
+                      Spectrum, typename SamplingIntegrator<Float, Spectrum>::Vector2f>
+SamplingIntegrator<Float, Spectrum>::sample_camera_ray(const Sensor *sensor,
+                                                       Sampler *sampler,
+                                                       const Vector2f &pos,
+                                                       ScalarFloat diff_scale_factor,
+                                                       Mask active) const {
     const Film *film = sensor->film();
-    const bool has_alpha = has_flag(film->flags(), FilmFlags::Alpha);
-    const bool box_filter = film->rfilter()->is_box_filter();
 
     ScalarVector2f scale = 1.f / ScalarVector2f(film->crop_size()),
                    offset = -ScalarVector2f(film->crop_offset()) * scale;
 
-    Vector2f sample_pos   = pos + sampler->next_2d(active),
-             adjusted_pos = dr::fmadd(sample_pos, scale, offset);
+    Vector2f sample_pos = pos + sampler->next_2d(active);
+
+    // The primary hit cache places the samples at fixed subpixel positions
+    if (m_primary_cache.active)
+        sample_pos = pos + m_primary_cache.offset;
+
+    Vector2f adjusted_pos = dr::fmadd(sample_pos, scale, offset);
 
     Point2f aperture_sample(.5f);
     if (sensor->needs_aperture_sample())
@@ -411,6 +1832,24 @@ SamplingIntegrator<Float, Spectrum>::render_sample(const Scene *scene,
     if (ray.has_differentials)
         ray.scale_differential(diff_scale_factor);
 
+    return { ray, ray_weight, sample_pos };
+}
+
+MI_VARIANT void
+SamplingIntegrator<Float, Spectrum>::render_ray(const Scene *scene,
+                                                const Sensor *sensor,
+                                                Sampler *sampler,
+                                                ImageBlock *block,
+                                                Float *aovs,
+                                                const Vector2f &pos,
+                                                const Vector2f &sample_pos,
+                                                const RayDifferential3f &ray,
+                                                const Spectrum &ray_weight,
+                                                Mask active) const {
+    const Film *film = sensor->film();
+    const bool has_alpha = has_flag(film->flags(), FilmFlags::Alpha);
+    const bool box_filter = film->rfilter()->is_box_filter();
+
     const Medium *medium = sensor->medium();
 
     auto [spec, valid] = sample(scene, sampler, ray, medium,
@@ -448,6 +1887,115 @@ SamplingIntegrator<Float, Spectrum>::render_sample(const Scene *scene,
     block->put(box_filter ? pos : sample_pos, aovs, active);
 }
 
+MI_VARIANT void
+SamplingIntegrator<Float, Spectrum>::render_sample(const Scene *scene,
+                                                   const std::vector<Sensor *> &sensors,
+                                                   const std::vector<Mask> &masks,
+                                                   Sampler *sampler,
+                                                   const std::vector<ref<ImageBlock>> &blocks,
+                                                   Float *aovs,
+                                                   const Vector2f &pos,
+                                                   ScalarFloat diff_scale_factor) const {
+    const Film *film = sensors[0]->film();
+    const bool has_alpha = has_flag(film->flags(), FilmFlags::Alpha);
+
+    bool needs_aperture_sample = false, needs_time_sample = false;
+    for (const Sensor *sensor : sensors) {
+        needs_aperture_sample |= sensor->needs_aperture_sample();
+        needs_time_sample |= sensor->shutter_open_time() > 0.f;
+    }
+
+    Vector2f sample_pos = pos + sampler->next_2d();
+
+    Point2f aperture_sample(.5f);
+    if (needs_aperture_sample)
+        aperture_sample = sampler->next_2d();
+
+    Float time_sample = 0.f;
+    if (needs_time_sample)
+        time_sample = sampler->next_1d();
+
+    Float wavelength_sample = 0.f;
+    if constexpr (is_spectral_v<Spectrum>)
+        wavelength_sample = sampler->next_1d();
+
+    // Generate the camera rays of every sensor in the lanes that belong to it
+    RayDifferential3f ray = dr::zeros<RayDifferential3f>();
+    Spectrum ray_weight = dr::zeros<Spectrum>();
+    bool has_differentials = true;
+
+    for (size_t i = 0; i < sensors.size(); ++i) {
+        const Sensor *sensor = sensors[i];
+        const Film *film_i = sensor->film();
+
+        ScalarVector2f scale = 1.f / ScalarVector2f(film_i->crop_size()),
+                       offset = -ScalarVector2f(film_i->crop_offset()) * scale;
+
+        Vector2f adjusted_pos = dr::fmadd(sample_pos, scale, offset);
+
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += time_sample * sensor->shutter_open_time();
+
+        auto [ray_i, ray_weight_i] = sensor->sample_ray_differential(
+            time, wavelength_sample, adjusted_pos, aperture_sample, masks[i]);
+
+        has_differentials &= ray_i.has_differentials;
+        ray[masks[i]] = ray_i;
+        ray_weight[masks[i]] = ray_weight_i;
+    }
+
+    ray.has_differentials = has_differentials;
+    if (ray.has_differentials)
+        ray.scale_differential(diff_scale_factor);
+
+    // A single call to the integrator handles the whole wavefront
+    auto [spec, valid] = sample(scene, sampler, ray, sensors[0]->medium(),
+               aovs + (has_alpha ? 5 : 4) /* skip R,G,B,[A],W */);
+
+    UnpolarizedSpectrum spec_u = unpolarized_spectrum(ray_weight * spec);
+
+    if (unlikely(has_flag(film->flags(), FilmFlags::Special))) {
+        // Every film converts the samples of its own lanes
+        size_t n_channels = blocks[0]->channel_count();
+        std::unique_ptr<Float[]> aovs_i(new Float[n_channels]);
+        for (size_t i = 0; i < sensors.size(); ++i) {
+            std::copy(aovs, aovs + n_channels, aovs_i.get());
+            sensors[i]->film()->prepare_sample(
+                spec_u, ray.wavelengths, aovs_i.get(), /*weight*/ 1.f,
+                /*alpha */ dr::select(valid, Float(1.f), Float(0.f)),
+                valid && masks[i]);
+            for (size_t c = 0; c < n_channels; ++c)
+                aovs[c] = dr::select(masks[i], aovs_i[c], aovs[c]);
+        }
+    } else {
+        Color3f rgb;
+        if constexpr (is_spectral_v<Spectrum>)
+            rgb = spectrum_to_srgb(spec_u, ray.wavelengths);
+        else if constexpr (is_monochromatic_v<Spectrum>)
+            rgb = spec_u.x();
+        else
+            rgb = spec_u;
+
+        aovs[0] = rgb.x();
+        aovs[1] = rgb.y();
+        aovs[2] = rgb.z();
+
+        if (likely(has_alpha)) {
+            aovs[3] = dr::select(valid, Float(1.f), Float(0.f));
+            aovs[4] = 1.f;
+        } else {
+            aovs[3] = 1.f;
+        }
+    }
+
+    for (size_t i = 0; i < sensors.size(); ++i) {
+        // With box filter, ignore random offset to prevent numerical instabilities
+        bool box_filter = sensors[i]->film()->rfilter()->is_box_filter();
+        blocks[i]->put(box_filter ? pos : sample_pos, aovs, masks[i]);
+    }
+}
+
 MI_VARIANT std::pair<Spectrum, typename SamplingIntegrator<Float, Spectrum>::Mask>
 SamplingIntegrator<Float, Spectrum>::sample(const Scene * /* scene */,
                                             Sampler * /* sampler */,
@@ -481,6 +2029,38 @@ MI_VARIANT MonteCarloIntegrator<Float, Spectrum>::MonteCarloIntegrator(const Pro
 
 MI_VARIANT MonteCarloIntegrator<Float, Spectrum>::~MonteCarloIntegrator() { }
 
+MI_VARIANT std::vector<uint64_t>
+MonteCarloIntegrator<Float, Spectrum>::path_length_histogram() const {
+    std::vector<uint64_t> result(PathLengthBins);
+    for (uint32_t i = 0; i < PathLengthBins; ++i)
+        result[i] = m_path_lengths[i].value();
+    return result;
+}
+
+MI_VARIANT void MonteCarloIntegrator<Float, Spectrum>::reset_path_length_histogram() {
+    for (uint32_t i = 0; i < PathLengthBins; ++i)
+        m_path_lengths[i].reset();
+}
+
+MI_VARIANT std::map<std::string, uint64_t>
+MonteCarloIntegrator<Float, Spectrum>::event_counts() const {
+    const char *names[] = { "rr_terminations",          "emitter_samples",
+                            "emitter_samples_occluded", "emitter_samples_zero",
+                            "medium_interactions",      "null_collisions" };
+    static_assert(std::size(names) == (size_t) MonteCarloEvent::Count);
+
+    std::map<std::string, uint64_t> result;
+    for (uint32_t i = 0; i < (uint32_t) MonteCarloEvent::Count; ++i)
+        result[names[i]] = m_events[i].value();
+    return result;
+}
+
+MI_VARIANT void MonteCarloIntegrator<Float, Spectrum>::reset_statistics() {
+    reset_path_length_histogram();
+    for (uint32_t i = 0; i < (uint32_t) MonteCarloEvent::Count; ++i)
+        m_events[i].reset();
+}
+
 // -----------------------------------------------------------------------------
 
 MI_VARIANT AdjointIntegrator<Float, Spectrum>::AdjointIntegrator(const Properties &props)
@@ -581,24 +2161,37 @@ AdjointIntegrator<Float, Spectrum>::render(Scene *scene,
         // Start the render timer (used for timeouts & log messages)
         m_render_timer.reset();
 
+        /* Samplers and crop-sized image blocks of the workers. The blocks
+           accumulate the splats of all ranges processed by a worker and are
+           only committed to the film once the loop has finished. */
+        struct Worker {
+            ref<Sampler> sampler;
+            ref<ImageBlock> block;
+        };
+        WorkerPool<Worker> workers;
+        auto create_worker = [&]() {
+            ref<ImageBlock> block = film->create_block(
+                ScalarVector2u(0) /* use crop size */,
+                true /* normalize */,
+                false /* border */);
+
+            block->set_offset(film->crop_offset());
+            block->clear();
+
+            // Splats land at random positions, accumulate them in batches
+            block->set_deferred(true);
+
+            return Worker{ sensor->sampler()->clone(), block };
+        };
+
         ThreadEnvironment env;
         dr::parallel_for(
             dr::blocked_range<size_t>(0, total_samples, grain_size),
             [&](const dr::blocked_range<size_t> &range) {
                 ScopedSetThreadEnvironment set_env(env);
-
-                // Fork a non-overlapping sampler for the current worker
-                ref<Sampler> sampler = sensor->sampler()->clone();
-
-                ref<ImageBlock> block = film->create_block(
-                    ScalarVector2u(0) /* use crop size */,
-                    true /* normalize */,
-                    false /* border */);
-
-                block->set_offset(film->crop_offset());
-
-                // Clear block (it's being reused)
-                block->clear();
+                Worker worker = workers.acquire(create_worker);
+                Sampler *sampler = worker.sampler;
+                ImageBlock *block = worker.block;
 
                 sampler->seed(seed +
                               (uint32_t) range.begin() / (uint32_t) grain_size);
@@ -618,15 +2211,18 @@ AdjointIntegrator<Float, Spectrum>::render(Scene *scene,
                 }
                 total_samples += ctr;
 
-                // When all samples are done for this range, commit to the film
                 /* locked */ {
                     std::lock_guard<std::mutex> lock(mutex);
                     progress->update(samples_done / (ScalarFloat) total_samples);
-                    film->put_block(block);
                 }
+
+                workers.release(std::move(worker));
             }
         );
 
+        // Commit the blocks of all workers to the film
+        workers.for_each([&](Worker &worker) { film->put_block(worker.block); });
+
         if (develop)
             result = film->develop();
     } else {
@@ -675,13 +2271,17 @@ AdjointIntegrator<Float, Spectrum>::render(Scene *scene,
         block->set_coalesce(false);
 
         Timer timer;
+        KernelTraceRecorder kernel_trace;
         for (size_t i = 0; i < n_passes; i++) {
+            ScopedTraceEvent trace_pass("render", "Pass");
+            trace_pass.set_arg("pass", i);
             sample(scene, sensor, sampler, block, sample_scale);
 
             if (n_passes > 1) {
                 sampler->advance(); // Will trigger a kernel launch of size 1
                 sampler->schedule_state();
                 dr::eval(block->tensor());
+                kernel_trace.record();
             }
         }
 
@@ -695,6 +2295,7 @@ AdjointIntegrator<Float, Spectrum>::render(Scene *scene,
         }
 
         if (evaluate) {
+            ScopedTraceEvent trace_eval("render", "Evaluation");
             dr::eval();
 
             if (n_passes == 1 && jit_flag(JitFlag::VCallRecord) &&
@@ -708,6 +2309,7 @@ AdjointIntegrator<Float, Spectrum>::render(Scene *scene,
             }
 
             dr::sync_thread();
+            kernel_trace.record();
         }
     }
 
@@ -1,9 +1,64 @@
 #include <mitsuba/render/kdtree.h>
 #include <mitsuba/render/mesh.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/warp.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
+std::string KDTreeStatistics::to_string() const {
+    std::ostringstream oss;
+    oss << "KDTreeStatistics[" << std::endl
+        << "  node_count = " << node_count << "," << std::endl
+        << "  inner_node_count = " << inner_node_count << "," << std::endl
+        << "  leaf_count = " << leaf_count << "," << std::endl
+        << "  empty_leaf_count = " << empty_leaf_count << "," << std::endl
+        << "  index_count = " << index_count << "," << std::endl
+        << "  max_depth = " << max_depth << "," << std::endl
+        << "  max_leaf_size = " << max_leaf_size << "," << std::endl
+        << "  sah_cost = " << sah_cost << "," << std::endl
+        << "  expected_traversal_steps = " << expected_traversal_steps << "," << std::endl
+        << "  expected_leaf_visits = " << expected_leaf_visits << "," << std::endl
+        << "  expected_primitive_visits = " << expected_primitive_visits << "," << std::endl
+        << "  empty_space_ratio = " << empty_space_ratio << "," << std::endl
+        << "  build_time = " << util::time_string((float) build_time * 1000.f) << std::endl
+        << "]";
+    return oss.str();
+}
+
+std::string KDTraversalStatistics::to_string() const {
+    std::ostringstream oss;
+    oss << "KDTraversalStatistics[" << std::endl
+        << "  ray_count = " << ray_count << "," << std::endl
+        << "  hit_count = " << hit_count << "," << std::endl
+        << "  inner_nodes_per_ray = " << inner_nodes_per_ray << "," << std::endl
+        << "  leaves_per_ray = " << leaves_per_ray << "," << std::endl
+        << "  primitives_per_ray = " << primitives_per_ray << "," << std::endl
+        << "  time = " << util::time_string((float) time * 1000.f, true) << std::endl
+        << "]";
+    return oss.str();
+}
+
+/// Header of the files of the kd-tree build cache (followed by the node and index lists)
+struct KDTreeCacheHeader {
+    char magic[8];
+    uint64_t key;
+    uint64_t node_count;
+    uint64_t index_count;
+    uint64_t max_depth;
+    double bbox[6];
+    double cost_model[3];
+    double sah_cost;
+};
+
+static const char kdtree_cache_magic[8] = { 'M', 'I', 'K', 'D', 'T', 'R', 'E', 'E' };
+
+/// Version of the build cache, must be increased when the tree layout changes
+static const uint64_t kdtree_cache_version = 1;
+
 template <typename B, typename I, typename C, typename D>
 thread_local typename TShapeKDTree<B, I, C, D>::LocalBuildContext
     TShapeKDTree<B, I, C, D>::BuildTask::m_local = {};
@@ -48,16 +103,58 @@ MI_VARIANT ShapeKDTree<Float, Spectrum>::ShapeKDTree(const Properties &props)
     if (props.has_property("kd_exact_primitive_threshold"))
         set_exact_primitive_threshold(props.get<int>("kd_exact_primitive_threshold"));
 
+    /* kd-tree construction: Specify the number of primitives, above which
+       the O(n log n) builder constructs the left subtree of a node in a
+       separate task (0 == build sequentially). */
+    if (props.has_property("kd_parallel_subtree_threshold"))
+        set_parallel_subtree_threshold(props.get<int>("kd_parallel_subtree_threshold"));
+
+    /* kd-tree construction: Build the tree with several cost model
+       parameters and keep the one that traces a sampled ray workload the
+       fastest. This multiplies the construction time. */
+    m_auto_tune = props.get<bool>("kd_auto_tune", false);
+
+    /* kd-tree construction: Number of rays of the auto-tuning workload */
+    m_auto_tune_rays = props.get<uint32_t>("kd_auto_tune_rays", 65536);
+    if (m_auto_tune_rays == 0)
+        Throw("The number of auto-tuning rays must be greater than zero");
+
+    /* kd-tree construction: Store a precomputed intersection record of
+       every triangle in leaf order, which avoids the indirections through
+       the face and vertex buffers during traversal. This requires 48 bytes
+       (96 bytes in double precision) per primitive reference. */
+    m_precompute_triangles = props.get<bool>("kd_precompute_triangles", false);
+
+    /* kd-tree traversal: Trace the rays of the LLVM backend as packets
+       of the vector width (instead of one by one) */
+    m_packet_traversal = props.get<bool>("kd_packet_traversal", false);
+
+    /* kd-tree traversal: Minimum fraction of active lanes of a packet.
+       Below it, the remaining rays of the packet are traced one by one. */
+    m_packet_utilization = props.get<ScalarFloat>("kd_packet_utilization", .5f);
+    if (!(m_packet_utilization >= 0.f && m_packet_utilization <= 1.f))
+        Throw("The packet utilization must be in the range [0, 1]");
+
+    /* kd-tree construction: Directory of the build cache. Trees that were
+       built before for the same geometry and parameters are loaded from it
+       instead of being built again. */
+    m_cache_dir = props.string("kd_cache_dir", "");
+
     m_primitive_map.push_back(0);
 }
 
 MI_VARIANT void ShapeKDTree<Float, Spectrum>::clear() {
     m_shapes.clear();
+    m_shape_masks.clear();
+    m_shape_alpha_tests.clear();
+    m_alpha_tests = false;
     m_primitive_map.clear();
     m_primitive_map.push_back(0);
+    m_single_primitive_shapes = true;
     m_bbox.reset();
     m_nodes.release();
     m_indices.release();
+    m_triangles.reset();
     m_node_count = 0;
     m_index_count = 0;
 }
@@ -67,20 +164,390 @@ MI_VARIANT void ShapeKDTree<Float, Spectrum>::build() {
     Log(Info, "Building a SAH kd-tree (%i primitives) ..",
         primitive_count());
 
-    Base::build();
+    fs::path cache_file;
+    uint64_t key = 0;
+    if (!m_cache_dir.empty() && primitive_count() > 0) {
+        key = cache_key();
+        cache_file = m_cache_dir / fs::path(tfm::format(
+            "%016llx.kdtree", (unsigned long long) key));
+        if (load_cache(cache_file, key)) {
+            build_triangles();
+            Log(Info, "Loaded the kd-tree from \"%s\". (%s of storage, took %s)",
+                cache_file.string(), util::mem_string(memory_footprint()),
+                util::time_string((float) timer.value()));
+            return;
+        }
+    }
+
+    if (m_auto_tune && primitive_count() > 0) {
+        build_auto_tuned();
+    } else {
+        Base::build();
+        build_triangles();
+    }
 
     Log(Info, "Finished. (%s of storage, took %s)",
-        util::mem_string(m_index_count * sizeof(Index) +
-                        m_node_count * sizeof(KDNode)),
+        util::mem_string(memory_footprint()),
         util::time_string((float) timer.value())
     );
+
+    if (!cache_file.empty())
+        store_cache(cache_file, key);
+}
+
+MI_VARIANT uint64_t ShapeKDTree<Float, Spectrum>::cache_key() const {
+    // The build parameters and the layout of the tree
+    const double params[] = {
+        (double) sizeof(KDNode),
+        (double) sizeof(Index),
+        (double) sizeof(ScalarFloat),
+        (double) m_cost_model.query_cost(),
+        (double) m_cost_model.traversal_cost(),
+        (double) m_cost_model.empty_space_bonus(),
+        (double) this->max_depth(),
+        (double) this->min_max_bins(),
+        (double) this->clip_primitives(),
+        (double) this->retract_bad_splits(),
+        (double) this->max_bad_refines(),
+        (double) this->stop_primitives(),
+        (double) this->exact_primitive_threshold(),
+        (double) m_auto_tune,
+        (double) m_auto_tune_rays,
+        (double) primitive_count(),
+        (double) shape_count()
+    };
+    uint64_t hash = hash_bytes(params, sizeof(params), kdtree_cache_version);
+
+    // The geometry of the shapes, in the order of their primitive indices
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        const Shape *shape = m_shapes[i];
+        const std::string &name = shape->class_()->name();
+        hash = hash_bytes(name.data(), name.size(), hash);
+
+        uint64_t count = shape->primitive_count();
+        const Mesh *mesh = shape->is_mesh() ? (const Mesh *) shape : nullptr;
+        if (mesh && !mesh->has_vertex_motion()) {
+            auto &positions = mesh->vertex_positions_buffer();
+            auto &faces = mesh->faces_buffer();
+            hash = hash_bytes(positions.data(),
+                              positions.size() * sizeof(positions.data()[0]),
+                              hash);
+            hash = hash_bytes(faces.data(),
+                              faces.size() * sizeof(faces.data()[0]), hash);
+        } else {
+            for (uint64_t j = 0; j < count; ++j) {
+                ScalarBoundingBox3f bbox = shape->bbox((uint32_t) j);
+                hash = hash_bytes(&bbox, sizeof(ScalarBoundingBox3f), hash);
+            }
+        }
+        hash = hash_bytes(&count, sizeof(uint64_t), hash);
+    }
+
+    return hash;
+}
+
+MI_VARIANT bool ShapeKDTree<Float, Spectrum>::load_cache(const fs::path &filename,
+                                                         uint64_t key) {
+    if (!fs::exists(filename))
+        return false;
+
+    KDTreeCacheHeader header;
+    try {
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(filename, false);
+        const uint8_t *data = (const uint8_t *) mmap->data();
+
+        if (mmap->size() < sizeof(KDTreeCacheHeader))
+            Throw("the file is truncated");
+        memcpy(&header, data, sizeof(KDTreeCacheHeader));
+
+        if (memcmp(header.magic, kdtree_cache_magic, 8) != 0)
+            Throw("invalid file format");
+        if (header.key != key)
+            Throw("the key does not match");
+        if (mmap->size() != sizeof(KDTreeCacheHeader) +
+                                header.node_count * sizeof(KDNode) +
+                                header.index_count * sizeof(Index))
+            Throw("the file is truncated");
+
+        m_node_count  = (Size) header.node_count;
+        m_index_count = (Size) header.index_count;
+
+        data += sizeof(KDTreeCacheHeader);
+        m_nodes.reset(new KDNode[m_node_count]);
+        memcpy(m_nodes.get(), data, m_node_count * sizeof(KDNode));
+
+        data += m_node_count * sizeof(KDNode);
+        m_indices.reset(new Index[m_index_count]);
+        memcpy(m_indices.get(), data, m_index_count * sizeof(Index));
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not load the kd-tree cache \"%s\": %s",
+            filename.string(), e.what());
+        m_nodes.reset();
+        m_indices.reset();
+        m_node_count = m_index_count = 0;
+        return false;
+    }
+
+    // The tree is read by all render workers, spread it over the NUMA nodes
+    if (Thread::numa_aware()) {
+        util::numa_interleave(m_nodes.get(), m_node_count * sizeof(KDNode));
+        util::numa_interleave(m_indices.get(), m_index_count * sizeof(Index));
+    }
+
+    m_bbox = ScalarBoundingBox3f(
+        ScalarPoint3f(header.bbox[0], header.bbox[1], header.bbox[2]),
+        ScalarPoint3f(header.bbox[3], header.bbox[4], header.bbox[5]));
+    m_cost_model = SurfaceAreaHeuristic3f(
+        (ScalarFloat) header.cost_model[0], (ScalarFloat) header.cost_model[1],
+        (ScalarFloat) header.cost_model[2]);
+    m_max_depth = (Size) header.max_depth;
+
+    m_statistics = KDTreeStatistics();
+    m_statistics.node_count  = m_node_count;
+    m_statistics.index_count = m_index_count;
+    m_statistics.sah_cost    = header.sah_cost;
+
+    return true;
+}
+
+MI_VARIANT void ShapeKDTree<Float, Spectrum>::store_cache(const fs::path &filename,
+                                                          uint64_t key) const {
+    KDTreeCacheHeader header;
+    memcpy(header.magic, kdtree_cache_magic, 8);
+    header.key         = key;
+    header.node_count  = m_node_count;
+    header.index_count = m_index_count;
+    header.max_depth   = m_max_depth;
+    for (size_t i = 0; i < 3; ++i) {
+        header.bbox[i]     = (double) m_bbox.min[i];
+        header.bbox[i + 3] = (double) m_bbox.max[i];
+    }
+    header.cost_model[0] = (double) m_cost_model.query_cost();
+    header.cost_model[1] = (double) m_cost_model.traversal_cost();
+    header.cost_model[2] = (double) m_cost_model.empty_space_bonus();
+    header.sah_cost      = this->statistics().sah_cost;
+
+    fs::path dir = filename.parent_path();
+    try {
+        if (!fs::exists(dir))
+            fs::create_directory(dir);
+        /* Processes concurrently building the same tree never observe a
+           partially written entry */
+        fs::write_atomic(filename, [&](const fs::path &tmp_file) {
+            ref<FileStream> stream = new FileStream(tmp_file, FileStream::ETruncReadWrite);
+            stream->write(&header, sizeof(KDTreeCacheHeader));
+            stream->write(m_nodes.get(), m_node_count * sizeof(KDNode));
+            stream->write(m_indices.get(), m_index_count * sizeof(Index));
+            stream->close();
+        });
+        Log(Debug, "Stored the kd-tree in \"%s\"", filename.string());
+    } catch (const std::exception &e) {
+        Log(Warn, "Could not store the kd-tree cache \"%s\": %s",
+            filename.string(), e.what());
+    }
+}
+
+MI_VARIANT void ShapeKDTree<Float, Spectrum>::build_triangles() {
+    m_triangles.reset();
+    if (!m_precompute_triangles || m_index_count == 0)
+        return;
+
+    m_triangles = std::unique_ptr<PrecomputedTriangle[]>(
+        new PrecomputedTriangle[m_index_count]);
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, m_index_count, 16384),
+        [&](const dr::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i != range.end(); ++i) {
+                PrecomputedTriangle &tri = m_triangles[i];
+                auto &m = tri.m;
+
+                Index prim_index = m_indices[i];
+                const Shape *shape = m_shapes[find_shape(prim_index)];
+
+                // Other shapes and moving triangles use the regular test
+                if (!shape->is_mesh() ||
+                    ((const Mesh *) shape)->has_vertex_motion()) {
+                    for (size_t j = 0; j < 12; ++j)
+                        m[j / 4][j % 4] = dr::NaN<ScalarFloat>;
+                    continue;
+                }
+
+                const Mesh *mesh = (const Mesh *) shape;
+                auto fi = mesh->face_indices(prim_index);
+                ScalarPoint3f p0 = mesh->vertex_position(fi[0]),
+                              p1 = mesh->vertex_position(fi[1]),
+                              p2 = mesh->vertex_position(fi[2]);
+
+                ScalarVector3f e1 = p1 - p0, e2 = p2 - p0,
+                               n = dr::cross(e1, e2),
+                               c1 = dr::cross(p1, p0), c2 = dr::cross(p2, p0);
+                ScalarVector3f n_abs = dr::abs(n);
+
+                // Divide by the largest component of the normal for accuracy
+                size_t k;
+                if (n_abs.x() > n_abs.y() && n_abs.x() > n_abs.z())
+                    k = 0;
+                else if (n_abs.y() > n_abs.z())
+                    k = 1;
+                else
+                    k = 2;
+
+                if (!(n_abs[k] > 0.f)) {
+                    // Degenerate triangle: t = -1 / 0 is never a valid hit
+                    for (size_t j = 0; j < 12; ++j)
+                        m[j / 4][j % 4] = 0.f;
+                    m[2][3] = 1.f;
+                    continue;
+                }
+
+                size_t k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+                ScalarFloat inv_n = dr::rcp(n[k]);
+
+                m[0][k]  = 0.f;
+                m[0][k1] =  e2[k2] * inv_n;
+                m[0][k2] = -e2[k1] * inv_n;
+                m[0][3]  =  c2[k] * inv_n;
+
+                m[1][k]  = 0.f;
+                m[1][k1] = -e1[k2] * inv_n;
+                m[1][k2] =  e1[k1] * inv_n;
+                m[1][3]  = -c1[k] * inv_n;
+
+                m[2][k]  = 1.f;
+                m[2][k1] = n[k1] * inv_n;
+                m[2][k2] = n[k2] * inv_n;
+                m[2][3]  = -dr::dot(p0, n) * inv_n;
+            }
+        }
+    );
+}
+
+MI_VARIANT void ShapeKDTree<Float, Spectrum>::build_auto_tuned() {
+    /* Candidate (intersection cost, traversal cost, empty space bonus)
+       settings. Only the ratio of the first two parameters matters. */
+    const ScalarFloat settings[][3] = {
+        { 20.f, 15.f, .9f }, { 10.f, 15.f, .9f }, { 40.f, 15.f, .9f },
+        { 80.f, 15.f, .9f }, { 20.f, 15.f, .6f }, { 20.f, 15.f, 1.f }
+    };
+
+    std::vector<SurfaceAreaHeuristic3f> candidates{ m_cost_model };
+    for (const auto &c : settings) {
+        if (c[0] != m_cost_model.query_cost() ||
+            c[1] != m_cost_model.traversal_cost() ||
+            c[2] != m_cost_model.empty_space_bonus())
+            candidates.emplace_back(c[0], c[1], c[2]);
+    }
+
+    // Base::build() enlarges the bounding box, restore it before each build
+    ScalarBoundingBox3f bbox = m_bbox;
+    auto build_with = [&](const SurfaceAreaHeuristic3f &model) {
+        m_nodes.reset();
+        m_indices.reset();
+        m_node_count = m_index_count = 0;
+        m_bbox = bbox;
+        m_cost_model = model;
+        Base::build();
+        build_triangles();
+    };
+
+    Log(Info, "Auto-tuning the kd-tree cost model (%zu candidates, %zu rays) ..",
+        candidates.size(), m_auto_tune_rays);
+
+    size_t best = 0;
+    double best_time = dr::Infinity<double>;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const SurfaceAreaHeuristic3f &model = candidates[i];
+        build_with(model);
+        KDTraversalStatistics stats = measure_traversal(m_auto_tune_rays);
+
+        Log(Info, "   (%.3g, %.3g, %.3g): SAH cost %.2f, %.2f primitive "
+                  "tests/ray, %s",
+            model.query_cost(), model.traversal_cost(),
+            model.empty_space_bonus(), this->statistics().sah_cost,
+            stats.primitives_per_ray,
+            util::time_string((float) stats.time * 1000.f, true));
+
+        if (stats.time < best_time) {
+            best = i;
+            best_time = stats.time;
+        }
+    }
+
+    if (best + 1 != candidates.size())
+        build_with(candidates[best]);
+
+    Log(Info, "Selected kd_intersection_cost = %.3g, kd_traversal_cost = %.3g, "
+              "kd_empty_space_bonus = %.3g",
+        m_cost_model.query_cost(), m_cost_model.traversal_cost(),
+        m_cost_model.empty_space_bonus());
+}
+
+MI_VARIANT KDTraversalStatistics
+ShapeKDTree<Float, Spectrum>::measure_traversal(size_t ray_count, uint32_t seed,
+                                                uint32_t passes) const {
+    if (!ready())
+        Throw("measure_traversal(): the kd-tree has not been built yet!");
+    if (passes == 0)
+        Throw("measure_traversal(): the number of passes must be positive!");
+
+    // Rays from a sphere around the tree towards points inside of it
+    ScalarBoundingSphere3f sphere = m_bbox.bounding_sphere();
+    ScalarFloat radius = sphere.radius * 1.01f + dr::Epsilon<ScalarFloat>;
+
+    PCG32<uint32_t> rng;
+    rng.seed(1, PCG32_DEFAULT_STATE, seed);
+
+    std::vector<ScalarRay3f> rays;
+    rays.reserve(ray_count);
+    for (size_t i = 0; i < ray_count; ++i) {
+        ScalarPoint2f sample(rng.next_float32(), rng.next_float32());
+        ScalarPoint3f origin =
+            sphere.center + warp::square_to_uniform_sphere(sample) * radius;
+
+        ScalarPoint3f target;
+        for (size_t j = 0; j < 3; ++j)
+            target[j] = dr::lerp(m_bbox.min[j], m_bbox.max[j], rng.next_float32());
+
+        rays.emplace_back(origin, dr::normalize(target - origin));
+    }
+
+    KDTraversalStatistics result;
+    result.ray_count = ray_count;
+
+    KDTraversalCounters counters;
+    for (const ScalarRay3f &ray : rays) {
+        auto pi = ray_intersect_scalar<false, true>(ray, &counters);
+        result.hit_count += pi.is_valid();
+    }
+
+    if (ray_count > 0) {
+        result.inner_nodes_per_ray = counters.inner_nodes / (double) ray_count;
+        result.leaves_per_ray = counters.leaves / (double) ray_count;
+        result.primitives_per_ray = counters.primitives / (double) ray_count;
+    }
+
+    result.time = dr::Infinity<double>;
+    for (uint32_t pass = 0; pass < passes; ++pass) {
+        Timer timer;
+        size_t hit_count = 0;
+        for (const ScalarRay3f &ray : rays)
+            hit_count += ray_intersect_scalar<false>(ray).is_valid();
+        result.time = std::min(result.time, timer.value() / 1000.0);
+        result.hit_count = hit_count; // Keeps the traversal from being optimized away
+    }
+
+    return result;
 }
 
 MI_VARIANT void ShapeKDTree<Float, Spectrum>::add_shape(Shape *shape) {
     Assert(!ready());
-    m_primitive_map.push_back(m_primitive_map.back() +
-                              shape->primitive_count());
+    Size count = shape->primitive_count();
+    m_primitive_map.push_back(m_primitive_map.back() + count);
+    m_single_primitive_shapes &= count == 1;
     m_shapes.push_back(shape);
+    m_shape_masks.push_back((uint32_t) -1);
+    m_shape_alpha_tests.push_back(false);
     m_bbox.expand(shape->bbox());
 }
 
@@ -0,0 +1,341 @@
+#include <mitsuba/render/lightgrid.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+MI_VARIANT LightGrid<Float, Spectrum>::LightGrid(const std::vector<ref<Emitter>> &emitters,
+                                                 const ScalarBoundingBox3f &bbox,
+                                                 uint32_t resolution,
+                                                 ScalarFloat threshold)
+    : m_max_resolution(std::max(resolution, 1u)), m_threshold(threshold) {
+    build(emitters, bbox);
+}
+
+MI_VARIANT void LightGrid<Float, Spectrum>::build(const std::vector<ref<Emitter>> &emitters,
+                                                  const ScalarBoundingBox3f &bbox) {
+    Timer timer;
+    m_emitter_count = (uint32_t) emitters.size();
+
+    /// Light with a delta position that is stored in the lists of the cells
+    struct Light {
+        uint32_t index;
+        ScalarPoint3f p;
+        ScalarVector3f axis;
+        ScalarFloat cos_cone;
+        ScalarFloat power;
+    };
+
+    std::vector<ScalarFloat> power(m_emitter_count);
+    std::vector<Light> lights;
+    ScalarFloat total_power = 0.f, light_power = 0.f;
+    ScalarBoundingBox3f grid_bbox = bbox;
+
+    for (uint32_t i = 0; i < m_emitter_count; ++i) {
+        const Emitter *emitter = emitters[i];
+        power[i] = std::max(emitter->sampling_weight() * emitter->flux(), 0.f);
+        total_power += power[i];
+
+        ScalarBoundingBox3f emitter_bbox = emitter->bbox();
+        if (has_flag(emitter->flags(), EmitterFlags::DeltaPosition) &&
+            emitter_bbox.valid() && power[i] > 0.f) {
+            auto [axis, cos_cone] = emitter->emission_cone();
+            lights.push_back({ i, emitter_bbox.center(), axis, cos_cone, power[i] });
+            grid_bbox.expand(emitter_bbox.center());
+            light_power += power[i];
+        }
+    }
+
+    if (!(total_power > 0.f)) {
+        // Fall back to the sampling weights (e.g. if all flux estimates are zero)
+        for (uint32_t i = 0; i < m_emitter_count; ++i)
+            power[i] = emitters[i]->sampling_weight();
+        lights.clear();
+        light_power = 0.f;
+    }
+
+    // Slightly enlarge the bounding box to avoid precision issues
+    if (!grid_bbox.valid())
+        grid_bbox = ScalarBoundingBox3f(ScalarPoint3f(0.f));
+    ScalarVector3f margin = dr::maximum(grid_bbox.extents(), 1e-4f) * 1e-3f;
+    m_bbox = ScalarBoundingBox3f(grid_bbox.min - margin, grid_bbox.max + margin);
+
+    // Cells are roughly cubic, with the requested resolution along the longest axis
+    ScalarVector3f extents = m_bbox.extents();
+    ScalarFloat max_extent = dr::max(extents);
+    for (size_t k = 0; k < 3; ++k)
+        m_resolution[k] = dr::clamp(
+            (uint32_t) dr::ceil(m_max_resolution * extents[k] / max_extent), 1u,
+            m_max_resolution);
+    ScalarVector3f cell_size = extents / ScalarVector3f(m_resolution);
+    m_inv_cell_size = dr::rcp(cell_size);
+    ScalarFloat cell_radius = .5f * dr::norm(cell_size);
+
+    /* The influence radius of a light is the distance where its irradiance
+       falls below a fraction of the average irradiance due to all lights on
+       the surface of the bounding box */
+    ScalarFloat min_irradiance =
+        m_threshold * light_power / (ScalarFloat) m_bbox.surface_area();
+
+    // Entries of the lists as (cell, light, weight), in the order of the lights
+    std::vector<uint32_t> entry_cell, entry_light;
+    std::vector<ScalarFloat> entry_weight;
+    std::vector<uint32_t> counts(dr::prod(m_resolution) + 1, 0u);
+
+    for (const Light &light : lights) {
+        ScalarFloat cone_solid_angle = 2.f * dr::Pi<ScalarFloat> * (1.f - light.cos_cone),
+                    intensity = light.power / cone_solid_angle,
+                    radius = min_irradiance > 0.f
+                                 ? dr::sqrt(intensity / min_irradiance)
+                                 : dr::Infinity<ScalarFloat>,
+                    theta_cone = dr::safe_acos(light.cos_cone);
+
+        ScalarVector3f lo = dr::floor((light.p - radius - m_bbox.min) * m_inv_cell_size),
+                       hi = dr::floor((light.p + radius - m_bbox.min) * m_inv_cell_size);
+        ScalarVector3u first, last;
+        for (size_t k = 0; k < 3; ++k) {
+            ScalarFloat max_cell = (ScalarFloat) (m_resolution[k] - 1);
+            first[k] = (uint32_t) dr::clamp(lo[k], 0.f, max_cell);
+            last[k]  = (uint32_t) dr::clamp(hi[k], 0.f, max_cell);
+        }
+
+        for (uint32_t z = first.z(); z <= last.z(); ++z) {
+            for (uint32_t y = first.y(); y <= last.y(); ++y) {
+                for (uint32_t x = first.x(); x <= last.x(); ++x) {
+                    ScalarPoint3f cell_min =
+                        m_bbox.min + ScalarVector3f((ScalarFloat) x, (ScalarFloat) y,
+                                                    (ScalarFloat) z) * cell_size;
+                    ScalarBoundingBox3f cell(cell_min, cell_min + cell_size);
+                    if (cell.squared_distance(light.p) > dr::sqr(radius))
+                        continue;
+
+                    // Skip cells outside of the cone of spot lights
+                    ScalarVector3f d = cell.center() - light.p;
+                    ScalarFloat dist = dr::norm(d);
+                    if (light.cos_cone > -1.f && dist > cell_radius) {
+                        ScalarFloat theta = dr::unit_angle(light.axis, d / dist),
+                                    theta_b = dr::safe_asin(cell_radius / dist);
+                        if (theta - theta_b > theta_cone)
+                            continue;
+                    }
+
+                    uint32_t index = x + m_resolution.x() * (y + m_resolution.y() * z);
+                    entry_cell.push_back(index);
+                    entry_light.push_back(light.index);
+                    entry_weight.push_back(
+                        light.power / std::max(dr::sqr(dist), dr::sqr(cell_radius)));
+                    counts[index + 1]++;
+                }
+            }
+        }
+    }
+
+    // Sort the entries by cell (stable, so that the lights stay ascending)
+    size_t cell_count = dr::prod(m_resolution);
+    m_entry_count = entry_cell.size();
+    m_max_cell_size = 0;
+    for (size_t i = 0; i < cell_count; ++i) {
+        m_max_cell_size = std::max(m_max_cell_size, counts[i + 1]);
+        counts[i + 1] += counts[i];
+    }
+
+    std::vector<uint32_t> offsets(counts.begin(), counts.end()),
+                          cell_lights(m_entry_count);
+    std::vector<ScalarFloat> cdf(m_entry_count);
+    for (size_t i = 0; i < m_entry_count; ++i) {
+        uint32_t j = counts[entry_cell[i]]++;
+        cell_lights[j] = entry_light[i];
+        cdf[j] = entry_weight[i];
+    }
+
+    for (size_t i = 0; i < cell_count; ++i) {
+        uint32_t begin = offsets[i], end = offsets[i + 1];
+        ScalarFloat sum = 0.f;
+        for (uint32_t j = begin; j < end; ++j) {
+            sum += cdf[j];
+            cdf[j] = sum;
+        }
+        for (uint32_t j = begin; j < end; ++j)
+            cdf[j] /= sum;
+        if (end > begin)
+            cdf[end - 1] = 1.f;
+    }
+
+    m_search_steps = 0;
+    while (m_search_steps < 32 && (1ull << m_search_steps) <= m_max_cell_size)
+        m_search_steps++;
+
+    /* Emitters that are not stored in the lists are only chosen by the global
+       distribution, whose probability is at least their fraction of the power */
+    ScalarFloat power_sum = 0.f;
+    for (ScalarFloat p : power)
+        power_sum += p;
+    if (lights.empty() || !(power_sum > 0.f))
+        m_global_prob = 1.f;
+    else
+        m_global_prob = std::max(GlobalProbability, 1.f - light_power / power_sum);
+
+    m_global  = DiscreteDistribution<Float>(power.data(), power.size());
+    m_offsets = dr::load<DynamicBuffer<UInt32>>(offsets.data(), offsets.size());
+    m_lights  = dr::load<DynamicBuffer<UInt32>>(cell_lights.data(), cell_lights.size());
+    m_cdf     = dr::load<DynamicBuffer<Float>>(cdf.data(), cdf.size());
+
+    // Data structures to map emitter pointers back to their index
+    m_pointer_index.clear();
+    if constexpr (dr::is_jit_v<Float>) {
+        std::vector<uint32_t> ids(m_emitter_count);
+        uint32_t max_id = 0;
+        for (uint32_t i = 0; i < m_emitter_count; ++i) {
+            ids[i] = jit_registry_get_id(dr::backend_v<Float>, emitters[i].get());
+            max_id = std::max(max_id, ids[i]);
+        }
+        std::vector<uint32_t> index(max_id + 1, m_emitter_count);
+        for (uint32_t i = 0; i < m_emitter_count; ++i)
+            index[ids[i]] = i;
+        m_registry_index = dr::load<DynamicBuffer<UInt32>>(index.data(), index.size());
+    } else {
+        for (uint32_t i = 0; i < m_emitter_count; ++i)
+            m_pointer_index[emitters[i].get()] = i;
+    }
+
+    Log(Debug, "Built a light grid with %ux%ux%u cells over %u emitters (%zu "
+               "entries, at most %u per cell, took %s)",
+        m_resolution.x(), m_resolution.y(), m_resolution.z(), m_emitter_count,
+        m_entry_count, m_max_cell_size, util::time_string((float) timer.value()));
+}
+
+MI_VARIANT typename LightGrid<Float, Spectrum>::UInt32
+LightGrid<Float, Spectrum>::cell_index(const Point3f &p) const {
+    Vector3f rel = (p - m_bbox.min) * m_inv_cell_size;
+    rel = dr::clamp(dr::select(dr::isnan(rel), 0.f, rel), 0.f,
+                    ScalarVector3f(m_resolution) - 1.f);
+    UInt32 x = UInt32(rel.x()), y = UInt32(rel.y()), z = UInt32(rel.z());
+    return x + m_resolution.x() * (y + m_resolution.y() * z);
+}
+
+MI_VARIANT template <typename Predicate>
+typename LightGrid<Float, Spectrum>::UInt32
+LightGrid<Float, Spectrum>::lower_bound(const UInt32 &begin, const UInt32 &end,
+                                        const Predicate &pred, Mask active) const {
+    UInt32 first = begin, size = dr::select(active && end > begin, end - begin, 0u);
+    for (uint32_t i = 0; i < m_search_steps; ++i) {
+        Mask valid = size > 0u;
+        UInt32 half = size >> 1, middle = first + half;
+        Mask right = valid && pred(middle, valid);
+        first = dr::select(right, middle + 1u, first);
+        size = dr::select(right, size - half - 1u, dr::select(valid, half, size));
+    }
+    return dr::minimum(first, dr::maximum(end, 1u) - 1u);
+}
+
+MI_VARIANT Float LightGrid<Float, Spectrum>::pdf_index(const UInt32 &index,
+                                                       const UInt32 &begin,
+                                                       const UInt32 &end,
+                                                       Mask active) const {
+    Mask has_list = active && end > begin;
+    Float global_prob = dr::select(has_list, m_global_prob, 1.f);
+    Float pmf = global_prob * m_global.eval_pmf_normalized(index, active);
+
+    if (m_entry_count > 0) {
+        UInt32 pos = lower_bound(
+            begin, end,
+            [&](const UInt32 &i, const Mask &m) {
+                return dr::gather<UInt32>(m_lights, i, m) < index;
+            },
+            has_list);
+
+        Mask found = has_list && dr::eq(dr::gather<UInt32>(m_lights, pos, has_list), index),
+             has_prev = found && pos > begin;
+        Float cdf_hi = dr::gather<Float>(m_cdf, pos, found),
+              cdf_lo = dr::gather<Float>(m_cdf, pos - 1u, has_prev);
+        dr::masked(pmf, found) += (1.f - global_prob) * (cdf_hi - cdf_lo);
+    }
+
+    return dr::select(active, pmf, 0.f);
+}
+
+MI_VARIANT typename LightGrid<Float, Spectrum>::UInt32
+LightGrid<Float, Spectrum>::emitter_index(const EmitterPtr &emitter, Mask active) const {
+    if constexpr (dr::is_jit_v<Float>) {
+        UInt32 id = dr::reinterpret_array<UInt32>(emitter);
+        active &= id < (uint32_t) dr::width(m_registry_index);
+        return dr::select(active, dr::gather<UInt32>(m_registry_index, id, active),
+                          m_emitter_count);
+    } else {
+        auto it = m_pointer_index.find(emitter);
+        return (active && it != m_pointer_index.end()) ? it->second : m_emitter_count;
+    }
+}
+
+MI_VARIANT std::tuple<typename LightGrid<Float, Spectrum>::UInt32, Float, Float>
+LightGrid<Float, Spectrum>::sample_emitter(const Interaction3f &ref, Float sample,
+                                           Mask active) const {
+    UInt32 cell  = cell_index(ref.p),
+           begin = dr::gather<UInt32>(m_offsets, cell, active),
+           end   = dr::gather<UInt32>(m_offsets, cell + 1u, active);
+
+    Mask has_list = active && end > begin;
+    Float global_prob = dr::select(has_list, m_global_prob, 1.f);
+    Mask global = active && sample < global_prob,
+         local  = active && !global;
+
+    Float sample_global = dr::minimum(sample / global_prob, dr::OneMinusEpsilon<Float>),
+          sample_local  = dr::minimum((sample - global_prob) / (1.f - global_prob),
+                                      dr::OneMinusEpsilon<Float>);
+    UInt32 index = dr::zeros<UInt32>();
+
+    // Choose from the distribution over all emitters
+    auto [index_global, sample_reused, pmf_global] =
+        m_global.sample_reuse_pmf(sample_global, global);
+    DRJIT_MARK_USED(pmf_global);
+    dr::masked(index, global) = index_global;
+    dr::masked(sample, global) = sample_reused;
+
+    // Choose from the list of the cell
+    if (m_entry_count > 0) {
+        UInt32 pos = lower_bound(
+            begin, end,
+            [&](const UInt32 &i, const Mask &m) {
+                return dr::gather<Float>(m_cdf, i, m) <= sample_local;
+            },
+            local);
+
+        Mask has_prev = local && pos > begin;
+        Float cdf_hi = dr::gather<Float>(m_cdf, pos, local),
+              cdf_lo = dr::gather<Float>(m_cdf, pos - 1u, has_prev);
+        dr::masked(index, local) = dr::gather<UInt32>(m_lights, pos, local);
+        dr::masked(sample, local) = dr::minimum(
+            (sample_local - cdf_lo) / (cdf_hi - cdf_lo), dr::OneMinusEpsilon<Float>);
+    }
+
+    return { index, sample, pdf_index(index, begin, end, active) };
+}
+
+MI_VARIANT Float LightGrid<Float, Spectrum>::pdf_emitter(const Interaction3f &ref,
+                                                         const EmitterPtr &emitter,
+                                                         Mask active) const {
+    UInt32 index = emitter_index(emitter, active);
+    active &= index < m_emitter_count;
+
+    UInt32 cell  = cell_index(ref.p),
+           begin = dr::gather<UInt32>(m_offsets, cell, active),
+           end   = dr::gather<UInt32>(m_offsets, cell + 1u, active);
+
+    return pdf_index(index, begin, end, active);
+}
+
+MI_VARIANT std::string LightGrid<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "LightGrid[" << std::endl
+        << "  emitter_count = " << m_emitter_count << "," << std::endl
+        << "  resolution = " << m_resolution << "," << std::endl
+        << "  threshold = " << m_threshold << "," << std::endl
+        << "  entry_count = " << m_entry_count << "," << std::endl
+        << "  max_cell_size = " << m_max_cell_size << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(LightGrid, Object)
+MI_INSTANTIATE_CLASS(LightGrid)
+NAMESPACE_END(mitsuba)
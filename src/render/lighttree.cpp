@@ -0,0 +1,555 @@
+#include <mitsuba/render/lighttree.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <algorithm>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/// Rotate \c v by \c angle (in radians) around the normalized axis \c k
+template <typename Vector3f, typename Float>
+static Vector3f light_tree_rotate(const Vector3f &v, const Vector3f &k, Float angle) {
+    Float c = dr::cos(angle), s = dr::sin(angle);
+    return v * c + dr::cross(k, v) * s + k * (dr::dot(k, v) * (1.f - c));
+}
+
+/**
+ * \brief Compute a cone that contains the two direction cones
+ * <tt>(w_a, cos_a)</tt> and <tt>(w_b, cos_b)</tt> and store it in the former
+ */
+template <typename Vector3f, typename Float>
+static void light_tree_cone_union(Vector3f &w_a, Float &cos_a,
+                                  const Vector3f &w_b, Float cos_b) {
+    if (cos_a <= -1.f || cos_b <= -1.f) {
+        cos_a = -1.f;
+        return;
+    }
+
+    Float theta_a = dr::safe_acos(cos_a),
+          theta_b = dr::safe_acos(cos_b),
+          theta_d = dr::unit_angle(w_a, w_b);
+
+    // One of the cones already contains the other one
+    if (std::min(theta_d + theta_b, dr::Pi<Float>) <= theta_a)
+        return;
+    if (std::min(theta_d + theta_a, dr::Pi<Float>) <= theta_b) {
+        w_a = w_b;
+        cos_a = cos_b;
+        return;
+    }
+
+    Float theta_o = .5f * (theta_a + theta_d + theta_b);
+    Vector3f w_r = dr::cross(w_a, w_b);
+    if (theta_o >= dr::Pi<Float> || dr::squared_norm(w_r) == 0.f) {
+        cos_a = -1.f;
+        return;
+    }
+
+    // Rotate the axis of the first cone towards the second one
+    w_a = dr::normalize(light_tree_rotate(w_a, dr::normalize(w_r), theta_o - theta_a));
+    cos_a = dr::cos(theta_o);
+}
+
+MI_VARIANT LightTree<Float, Spectrum>::LightTree(const std::vector<ref<Emitter>> &emitters) {
+    build(emitters);
+}
+
+MI_VARIANT typename LightTree<Float, Spectrum>::LightBounds
+LightTree<Float, Spectrum>::emitter_bounds(const Emitter *emitter) const {
+    LightBounds bounds;
+    bounds.bbox = emitter->bbox();
+    bounds.power = emitter->sampling_weight() * emitter->flux();
+
+    // Area emitters only emit into the hemisphere around the surface normal
+    if (has_flag(emitter->flags(), EmitterFlags::Surface))
+        bounds.cos_theta_e = 0.f;
+
+    return bounds;
+}
+
+template <typename LightBounds>
+static LightBounds light_tree_union(const LightBounds &a, const LightBounds &b) {
+    if (!a.bbox.valid())
+        return b;
+    if (!b.bbox.valid())
+        return a;
+
+    LightBounds result = a;
+    result.bbox.expand(b.bbox);
+    light_tree_cone_union(result.axis, result.cos_theta_o, b.axis, b.cos_theta_o);
+    result.cos_theta_e = std::min(a.cos_theta_e, b.cos_theta_e);
+    result.power = a.power + b.power;
+    return result;
+}
+
+/// Surface area orientation heuristic (SAOH) cost of a set of emitters
+template <typename LightBounds>
+static float light_tree_cost(const LightBounds &b, float kr) {
+    using Float = float;
+    Float theta_o = dr::safe_acos(b.cos_theta_o),
+          theta_e = dr::safe_acos(b.cos_theta_e),
+          theta_w = std::min(theta_o + theta_e, dr::Pi<Float>),
+          sin_theta_o = dr::safe_sqrt(1.f - dr::sqr(b.cos_theta_o));
+
+    Float m_omega =
+        2.f * dr::Pi<Float> * (1.f - b.cos_theta_o) +
+        .5f * dr::Pi<Float> *
+            (2.f * theta_w * sin_theta_o - dr::cos(theta_o - 2.f * theta_w) -
+             2.f * theta_o * sin_theta_o + b.cos_theta_o);
+
+    return (float) b.power * m_omega * kr * (float) b.bbox.surface_area();
+}
+
+MI_VARIANT void LightTree<Float, Spectrum>::build(const std::vector<ref<Emitter>> &emitters) {
+    Timer timer;
+    m_emitter_count = (uint32_t) emitters.size();
+
+    std::vector<std::pair<uint32_t, LightBounds>> lights;
+    std::vector<uint32_t> infinite;
+    std::vector<uint32_t> leaves(m_emitter_count, InvalidLeaf);
+
+    for (uint32_t i = 0; i < m_emitter_count; ++i) {
+        LightBounds bounds = emitter_bounds(emitters[i]);
+        if (!bounds.bbox.valid()) {
+            infinite.push_back(i);
+            leaves[i] = InfiniteLeaf;
+        } else if (bounds.power > 0.f) {
+            lights.emplace_back(i, bounds);
+        }
+    }
+
+    /* Bound the emitted directions of area emitters attached to meshes.
+       Copy all buffers to the host first to only synchronize once. */
+    using FloatStorage  = typename Mesh::FloatStorage;
+    using InputFloat    = typename Mesh::InputFloat;
+    using InputVector3f = typename Mesh::InputVector3f;
+    struct MeshData {
+        size_t light;
+        const Mesh *mesh;
+        FloatStorage positions, normals;
+        DynamicBuffer<UInt32> faces;
+    };
+
+    std::vector<MeshData> meshes;
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const Emitter *emitter = emitters[lights[i].first];
+        if (!has_flag(emitter->flags(), EmitterFlags::Surface))
+            continue;
+        const Mesh *mesh = dynamic_cast<const Mesh *>(emitter->shape());
+        if (!mesh || mesh->face_count() == 0)
+            continue;
+
+        MeshData data{ i, mesh,
+                       dr::migrate(mesh->vertex_positions_buffer(), AllocType::Host),
+                       FloatStorage(),
+                       dr::migrate(mesh->faces_buffer(), AllocType::Host) };
+        if (mesh->has_vertex_normals() && !mesh->has_face_normals())
+            data.normals = dr::migrate(mesh->vertex_normals_buffer(), AllocType::Host);
+        meshes.push_back(std::move(data));
+    }
+
+    if constexpr (dr::is_jit_v<Float>) {
+        if (!meshes.empty())
+            dr::sync_thread();
+    }
+
+    for (const MeshData &data : meshes) {
+        const InputFloat *p = data.positions.data(),
+                         *n = data.normals.data();
+        const uint32_t *f = data.faces.data();
+        size_t face_count = data.mesh->face_count(),
+               normal_count = dr::width(data.normals) / 3;
+        ScalarFloat sign = data.mesh->has_flipped_normals() ? -1.f : 1.f;
+
+        auto face_normal = [&](size_t i) {
+            ScalarVector3f p0 = dr::load<InputVector3f>(p + 3 * f[3 * i + 0]),
+                           p1 = dr::load<InputVector3f>(p + 3 * f[3 * i + 1]),
+                           p2 = dr::load<InputVector3f>(p + 3 * f[3 * i + 2]);
+            return ScalarVector3f(dr::cross(p1 - p0, p2 - p0)) * sign;
+        };
+
+        auto vertex_normal = [&](size_t i) {
+            return ScalarVector3f(dr::load<InputVector3f>(n + 3 * i)) * sign;
+        };
+
+        // The axis is the average direction, the angle the maximal deviation
+        ScalarVector3f axis(0.f);
+        for (size_t i = 0; i < face_count; ++i) {
+            ScalarVector3f v = face_normal(i);
+            if (dr::squared_norm(v) > 0.f)
+                axis += dr::normalize(v);
+        }
+        for (size_t i = 0; i < normal_count; ++i) {
+            ScalarVector3f v = vertex_normal(i);
+            if (dr::squared_norm(v) > 0.f)
+                axis += dr::normalize(v);
+        }
+
+        LightBounds &bounds = lights[data.light].second;
+        if (!(dr::norm(axis) > 1e-3f * (face_count + normal_count)))
+            continue;
+
+        axis = dr::normalize(axis);
+        ScalarFloat cos_theta_o = 1.f;
+        for (size_t i = 0; i < face_count; ++i) {
+            ScalarVector3f v = face_normal(i);
+            if (dr::squared_norm(v) > 0.f)
+                cos_theta_o = std::min(cos_theta_o, dr::dot(axis, dr::normalize(v)));
+        }
+        for (size_t i = 0; i < normal_count; ++i) {
+            ScalarVector3f v = vertex_normal(i);
+            if (dr::squared_norm(v) > 0.f)
+                cos_theta_o = std::min(cos_theta_o, dr::dot(axis, dr::normalize(v)));
+        }
+
+        bounds.axis = axis;
+        bounds.cos_theta_o = dr::clamp(cos_theta_o, ScalarFloat(-1.f), ScalarFloat(1.f));
+    }
+
+    // Build the hierarchy (a binary tree with 2n-1 nodes for n emitters)
+    std::vector<ScalarFloat> nodes;
+    std::vector<uint32_t> children, parents;
+    if (!lights.empty()) {
+        size_t node_count = 2 * lights.size() - 1;
+        nodes.resize(node_count * NodeStride);
+        children.reserve(node_count);
+        parents.reserve(node_count);
+        children.push_back(0);
+        parents.push_back(InvalidLeaf);
+        build_node(lights, 0, lights.size(), 0, nodes, children, parents, leaves);
+    }
+    m_node_count = (uint32_t) children.size();
+
+    m_infinite_count = infinite.size();
+    if (m_emitter_count == 0 || lights.empty())
+        m_infinite_prob = m_infinite_count > 0 ? 1.f : 0.f;
+    else
+        m_infinite_prob = (ScalarFloat) m_infinite_count /
+                          (ScalarFloat) (m_infinite_count + lights.size());
+
+    m_nodes    = dr::load<DynamicBuffer<Float>>(nodes.data(), nodes.size());
+    m_children = dr::load<DynamicBuffer<UInt32>>(children.data(), children.size());
+    m_parents  = dr::load<DynamicBuffer<UInt32>>(parents.data(), parents.size());
+    m_leaves   = dr::load<DynamicBuffer<UInt32>>(leaves.data(), leaves.size());
+    m_infinite = dr::load<DynamicBuffer<UInt32>>(infinite.data(), infinite.size());
+
+    // Data structures to map emitter pointers back to their index
+    m_pointer_index.clear();
+    if constexpr (dr::is_jit_v<Float>) {
+        std::vector<uint32_t> ids(m_emitter_count);
+        uint32_t max_id = 0;
+        for (uint32_t i = 0; i < m_emitter_count; ++i) {
+            ids[i] = jit_registry_get_id(dr::backend_v<Float>, emitters[i].get());
+            max_id = std::max(max_id, ids[i]);
+        }
+        std::vector<uint32_t> index(max_id + 1, m_emitter_count);
+        for (uint32_t i = 0; i < m_emitter_count; ++i)
+            index[ids[i]] = i;
+        m_registry_index = dr::load<DynamicBuffer<UInt32>>(index.data(), index.size());
+    } else {
+        for (uint32_t i = 0; i < m_emitter_count; ++i)
+            m_pointer_index[emitters[i].get()] = i;
+    }
+
+    Log(Debug, "Built a light tree over %i emitters (%i infinite, %i nodes, took %s)",
+        m_emitter_count, m_infinite_count, m_node_count,
+        util::time_string((float) timer.value()));
+}
+
+MI_VARIANT void LightTree<Float, Spectrum>::build_node(
+    std::vector<std::pair<uint32_t, LightBounds>> &lights, size_t begin,
+    size_t end, uint32_t node, std::vector<ScalarFloat> &nodes,
+    std::vector<uint32_t> &children, std::vector<uint32_t> &parents,
+    std::vector<uint32_t> &leaves) const {
+    LightBounds bounds;
+    ScalarBoundingBox3f centroids;
+    for (size_t i = begin; i < end; ++i) {
+        bounds = light_tree_union(bounds, lights[i].second);
+        centroids.expand(lights[i].second.bbox.center());
+    }
+
+    ScalarFloat *data = nodes.data() + node * NodeStride;
+    for (size_t k = 0; k < 3; ++k) {
+        data[k]     = bounds.bbox.min[k];
+        data[k + 3] = bounds.bbox.max[k];
+        data[k + 6] = bounds.axis[k];
+    }
+    data[9]  = bounds.cos_theta_o;
+    data[10] = bounds.cos_theta_e;
+    data[11] = bounds.power;
+
+    if (end - begin == 1) {
+        uint32_t index = lights[begin].first;
+        children[node] = index | LeafFlag;
+        leaves[index] = node;
+        return;
+    }
+
+    // Find the best split along any axis using the binned SAOH
+    constexpr uint32_t Bins = MI_LIGHT_TREE_BINS;
+    ScalarVector3f extents = centroids.extents(),
+                   diagonal = bounds.bbox.extents();
+    float best_cost = dr::Infinity<float>;
+    int best_axis = -1;
+    uint32_t best_bin = 0;
+
+    auto bin_index = [&](const LightBounds &b, int axis) {
+        ScalarFloat rel = (b.bbox.center()[axis] - centroids.min[axis]) / extents[axis];
+        return std::min((uint32_t) (rel * Bins), Bins - 1);
+    };
+
+    for (int axis = 0; axis < 3; ++axis) {
+        if (!(extents[axis] > 0.f))
+            continue;
+
+        LightBounds bins[Bins];
+        uint32_t counts[Bins] = { };
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t b = bin_index(lights[i].second, axis);
+            bins[b] = light_tree_union(bins[b], lights[i].second);
+            counts[b]++;
+        }
+
+        float kr = (float) (dr::max(diagonal) / diagonal[axis]);
+
+        for (uint32_t split = 1; split < Bins; ++split) {
+            LightBounds below, above;
+            uint32_t count_below = 0, count_above = 0;
+            for (uint32_t b = 0; b < split; ++b) {
+                below = light_tree_union(below, bins[b]);
+                count_below += counts[b];
+            }
+            for (uint32_t b = split; b < Bins; ++b) {
+                above = light_tree_union(above, bins[b]);
+                count_above += counts[b];
+            }
+            if (count_below == 0 || count_above == 0)
+                continue;
+
+            float cost = light_tree_cost(below, kr) + light_tree_cost(above, kr);
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                best_bin  = split;
+            }
+        }
+    }
+
+    size_t mid;
+    if (best_axis >= 0 && best_cost > 0.f) {
+        auto it = std::partition(
+            lights.begin() + begin, lights.begin() + end,
+            [&](const std::pair<uint32_t, LightBounds> &l) {
+                return bin_index(l.second, best_axis) < best_bin;
+            });
+        mid = it - lights.begin();
+    } else {
+        /* All emitters have the same centroid or zero extent (e.g. point
+           lights): fall back to an object median split */
+        int axis = (int) centroids.major_axis();
+        mid = (begin + end) / 2;
+        std::nth_element(lights.begin() + begin, lights.begin() + mid,
+                         lights.begin() + end,
+                         [axis](const std::pair<uint32_t, LightBounds> &a,
+                                const std::pair<uint32_t, LightBounds> &b) {
+                             return a.second.bbox.center()[axis] <
+                                    b.second.bbox.center()[axis];
+                         });
+    }
+
+    uint32_t left = (uint32_t) children.size();
+    children[node] = left;
+    children.push_back(0);
+    children.push_back(0);
+    parents.push_back(node);
+    parents.push_back(node);
+
+    build_node(lights, begin, mid, left, nodes, children, parents, leaves);
+    build_node(lights, mid, end, left + 1, nodes, children, parents, leaves);
+}
+
+MI_VARIANT Float LightTree<Float, Spectrum>::importance(const UInt32 &node,
+                                                        const Point3f &p,
+                                                        const Normal3f &n,
+                                                        Mask active) const {
+    UInt32 base = node * NodeStride;
+    auto load = [&](uint32_t offset) {
+        return dr::gather<Float>(m_nodes, base + offset, active);
+    };
+
+    Point3f bbox_min(load(0), load(1), load(2)),
+            bbox_max(load(3), load(4), load(5));
+    Vector3f axis(load(6), load(7), load(8));
+    Float cos_theta_o = load(9),
+          cos_theta_e = load(10),
+          power       = load(11);
+
+    auto cos_sub_clamped = [](Float sin_a, Float cos_a, Float sin_b, Float cos_b) {
+        return dr::select(cos_a > cos_b, 1.f, cos_a * cos_b + sin_a * sin_b);
+    };
+    auto sin_sub_clamped = [](Float sin_a, Float cos_a, Float sin_b, Float cos_b) {
+        return dr::select(cos_a > cos_b, 0.f, sin_a * cos_b - cos_a * sin_b);
+    };
+
+    // Direction and (clamped) squared distance from the node to the point
+    Vector3f d = p - .5f * (bbox_min + bbox_max);
+    Float dist2   = dr::squared_norm(d),
+          radius2 = .25f * dr::squared_norm(bbox_max - bbox_min);
+    Vector3f wi = dr::select(dist2 > 0.f, d * dr::rsqrt(dist2), 0.f);
+
+    // Cone of directions subtended by the bounding sphere of the node
+    Float cos_theta_b = dr::select(dist2 > radius2,
+                                   dr::safe_sqrt(1.f - radius2 / dist2), -1.f),
+          sin_theta_b = dr::safe_sqrt(1.f - dr::sqr(cos_theta_b));
+
+    // Smallest angle between 'wi' and any emitted direction
+    Float cos_theta_w = dr::dot(axis, wi),
+          sin_theta_w = dr::safe_sqrt(1.f - dr::sqr(cos_theta_w)),
+          sin_theta_o = dr::safe_sqrt(1.f - dr::sqr(cos_theta_o)),
+          cos_theta_x = cos_sub_clamped(sin_theta_w, cos_theta_w, sin_theta_o, cos_theta_o),
+          sin_theta_x = sin_sub_clamped(sin_theta_w, cos_theta_w, sin_theta_o, cos_theta_o),
+          cos_theta_p = cos_sub_clamped(sin_theta_x, cos_theta_x, sin_theta_b, cos_theta_b);
+
+    Float result = power * cos_theta_p /
+                   dr::maximum(dr::maximum(dist2, radius2), dr::Smallest<Float>);
+
+    // Account for foreshortening at the reference point (if it is a surface)
+    Mask has_normal = dr::any(dr::neq(n, 0.f));
+    Float cos_theta_i = dr::abs(dr::dot(wi, n)),
+          sin_theta_i = dr::safe_sqrt(1.f - dr::sqr(cos_theta_i));
+    dr::masked(result, has_normal) *=
+        cos_sub_clamped(sin_theta_i, cos_theta_i, sin_theta_b, cos_theta_b);
+
+    active &= cos_theta_p > cos_theta_e && power > 0.f;
+    return dr::select(active, dr::maximum(result, 0.f), 0.f);
+}
+
+MI_VARIANT typename LightTree<Float, Spectrum>::UInt32
+LightTree<Float, Spectrum>::emitter_index(const EmitterPtr &emitter, Mask active) const {
+    if constexpr (dr::is_jit_v<Float>) {
+        UInt32 id = dr::reinterpret_array<UInt32>(emitter);
+        active &= id < (uint32_t) dr::width(m_registry_index);
+        return dr::select(active, dr::gather<UInt32>(m_registry_index, id, active),
+                          m_emitter_count);
+    } else {
+        auto it = m_pointer_index.find(emitter);
+        return (active && it != m_pointer_index.end()) ? it->second : m_emitter_count;
+    }
+}
+
+MI_VARIANT std::tuple<typename LightTree<Float, Spectrum>::UInt32, Float, Float>
+LightTree<Float, Spectrum>::sample_emitter(const Interaction3f &ref, Float sample,
+                                           Mask active) const {
+    UInt32 index = dr::zeros<UInt32>();
+    Float pmf = dr::zeros<Float>();
+
+    // Infinite emitters are chosen uniformly in the first part of [0, 1)
+    Mask infinite = active && sample < m_infinite_prob;
+    if (m_infinite_count > 0) {
+        ScalarFloat count = (ScalarFloat) m_infinite_count;
+        Float scaled = sample / m_infinite_prob * count;
+        UInt32 i = dr::minimum(UInt32(scaled), (uint32_t) m_infinite_count - 1u);
+        dr::masked(index, infinite) = dr::gather<UInt32>(m_infinite, i, infinite);
+        dr::masked(sample, infinite) = scaled - Float(i);
+        dr::masked(pmf, infinite) = m_infinite_prob / count;
+    }
+
+    Mask tree = active && !infinite;
+    if (m_node_count > 0) {
+        ScalarFloat tree_prob = 1.f - m_infinite_prob;
+        dr::masked(sample, tree) = dr::minimum(
+            (sample - m_infinite_prob) / tree_prob, dr::OneMinusEpsilon<Float>);
+
+        UInt32 node = dr::zeros<UInt32>(),
+               child = dr::gather<UInt32>(m_children, node, tree);
+        Float tree_pmf = tree_prob;
+        Mask inner = tree && dr::eq(child & LeafFlag, 0u);
+
+        dr::Loop<Mask> loop("LightTree::sample_emitter", node, child, sample,
+                            tree_pmf, tree, inner);
+        while (loop(inner)) {
+            UInt32 left = child, right = child + 1u;
+            Float importance_left  = importance(left, ref.p, ref.n, inner),
+                  importance_right = importance(right, ref.p, ref.n, inner),
+                  importance_sum   = importance_left + importance_right;
+
+            // No emitter in this subtree contributes to the reference point
+            Mask valid = importance_sum > 0.f;
+            dr::masked(tree, inner && !valid) = false;
+            inner &= valid;
+
+            Float prob_left = importance_left / importance_sum;
+            Mask go_left = sample < prob_left;
+            Float rescaled = dr::select(go_left, sample / prob_left,
+                                        (sample - prob_left) / (1.f - prob_left));
+
+            dr::masked(sample, inner) = dr::minimum(rescaled, dr::OneMinusEpsilon<Float>);
+            dr::masked(tree_pmf, inner) *= dr::select(go_left, prob_left, 1.f - prob_left);
+            dr::masked(node, inner) = dr::select(go_left, left, right);
+            dr::masked(child, inner) = dr::gather<UInt32>(m_children, node, inner);
+            inner &= dr::eq(child & LeafFlag, 0u);
+        }
+
+        dr::masked(index, tree) = child & ~LeafFlag;
+        dr::masked(pmf, tree) = tree_pmf;
+    }
+
+    return { index, sample, pmf };
+}
+
+MI_VARIANT Float LightTree<Float, Spectrum>::pdf_emitter(const Interaction3f &ref,
+                                                         const EmitterPtr &emitter,
+                                                         Mask active) const {
+    UInt32 index = emitter_index(emitter, active);
+    active &= index < m_emitter_count;
+
+    UInt32 node = dr::select(active, dr::gather<UInt32>(m_leaves, index, active),
+                             InvalidLeaf);
+    Float pmf = dr::zeros<Float>();
+
+    if (m_infinite_count > 0)
+        dr::masked(pmf, active && dr::eq(node, InfiniteLeaf)) =
+            m_infinite_prob / (ScalarFloat) m_infinite_count;
+
+    Mask tree = active && node < InfiniteLeaf;
+    if (m_node_count > 0) {
+        // Walk up from the leaf and multiply the probabilities of every step
+        Float tree_pmf = 1.f - m_infinite_prob;
+        Mask inner = tree && dr::neq(node, 0u);
+
+        dr::Loop<Mask> loop("LightTree::pdf_emitter", node, tree_pmf, inner);
+        while (loop(inner)) {
+            UInt32 parent = dr::gather<UInt32>(m_parents, node, inner),
+                   left   = dr::gather<UInt32>(m_children, parent, inner);
+
+            Float importance_left  = importance(left, ref.p, ref.n, inner),
+                  importance_right = importance(left + 1u, ref.p, ref.n, inner),
+                  importance_sum   = importance_left + importance_right,
+                  importance_node  = dr::select(dr::eq(node, left),
+                                                importance_left, importance_right);
+
+            dr::masked(tree_pmf, inner) *= dr::select(
+                importance_sum > 0.f, importance_node / importance_sum, 0.f);
+            dr::masked(node, inner) = parent;
+            inner &= dr::neq(node, 0u);
+        }
+
+        dr::masked(pmf, tree) = tree_pmf;
+    }
+
+    return pmf;
+}
+
+MI_VARIANT std::string LightTree<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "LightTree[" << std::endl
+        << "  emitter_count = " << m_emitter_count << "," << std::endl
+        << "  infinite_count = " << m_infinite_count << "," << std::endl
+        << "  node_count = " << m_node_count << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(LightTree, Object)
+MI_INSTANTIATE_CLASS(LightTree)
+NAMESPACE_END(mitsuba)
@@ -4,9 +4,23 @@
 #include <mitsuba/render/phase.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/texture.h>
+#include <mitsuba/render/volume.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Return the channel of a spectrum according to which distances are sampled
+template <typename Spectrum, typename UInt32>
+static auto index_spectrum(const Spectrum &spec, const UInt32 &channel) {
+    auto m = spec[0];
+    if constexpr (is_rgb_v<Spectrum>) { // Handle RGB rendering
+        dr::masked(m, dr::eq(channel, 1u)) = spec[1];
+        dr::masked(m, dr::eq(channel, 2u)) = spec[2];
+    } else {
+        DRJIT_MARK_USED(channel);
+    }
+    return m;
+}
+
 MI_VARIANT Medium<Float, Spectrum>::Medium() : m_is_homogeneous(false), m_has_spectral_extinction(true) {}
 
 MI_VARIANT Medium<Float, Spectrum>::Medium(const Properties &props) : m_id(props.id()) {
@@ -29,18 +43,64 @@ MI_VARIANT Medium<Float, Spectrum>::Medium(const Properties &props) : m_id(props
     m_sample_emitters = props.get<bool>("sample_emitters", true);
     dr::set_attr(this, "use_emitter_sampling", m_sample_emitters);
     dr::set_attr(this, "phase_function", m_phase_function.get());
+    dr::set_attr(this, "is_emitter", false);
+    dr::set_attr(this, "emitter", m_emitter);
 }
 
 MI_VARIANT Medium<Float, Spectrum>::~Medium() {}
 
 MI_VARIANT void Medium<Float, Spectrum>::traverse(TraversalCallback *callback) {
     callback->put_object("phase_function", m_phase_function.get(), +ParamFlags::Differentiable);
+    if (m_radiance)
+        callback->put_object("radiance", m_radiance.get(), +ParamFlags::Differentiable);
+}
+
+MI_VARIANT void Medium<Float, Spectrum>::set_emitter(const Emitter *emitter) {
+    m_emitter = emitter;
+    dr::set_attr(this, "emitter", m_emitter);
+}
+
+MI_VARIANT
+typename Medium<Float, Spectrum>::UnpolarizedSpectrum
+Medium<Float, Spectrum>::get_radiance(const MediumInteraction3f &mi,
+                                      Mask active) const {
+    MI_MASKED_FUNCTION(ProfilerPhase::MediumEvaluate, active);
+    if (!m_radiance)
+        return 0.f;
+
+    Point3f p = m_radiance->to_local() * mi.p;
+    active &= dr::all(p >= 0.f && p <= 1.f);
+    return m_radiance->eval(mi, active) & active;
+}
+
+MI_VARIANT
+typename Medium<Float, Spectrum>::UnpolarizedSpectrum
+Medium<Float, Spectrum>::get_control_extinction(const MediumInteraction3f & /* mi */,
+                                                Mask /* active */) const {
+    return 0.f;
 }
 
 MI_VARIANT
 typename Medium<Float, Spectrum>::MediumInteraction3f
 Medium<Float, Spectrum>::sample_interaction(const Ray3f &ray, Float sample,
                                             UInt32 channel, Mask active) const {
+    return sample_interaction_impl(ray, sample, channel, false, active);
+}
+
+MI_VARIANT
+typename Medium<Float, Spectrum>::MediumInteraction3f
+Medium<Float, Spectrum>::sample_residual_interaction(const Ray3f &ray,
+                                                     Float sample,
+                                                     UInt32 channel,
+                                                     Mask active) const {
+    return sample_interaction_impl(ray, sample, channel, true, active);
+}
+
+MI_VARIANT
+typename Medium<Float, Spectrum>::MediumInteraction3f
+Medium<Float, Spectrum>::sample_interaction_impl(const Ray3f &ray, Float sample,
+                                                 UInt32 channel, bool residual,
+                                                 Mask active) const {
     MI_MASKED_FUNCTION(ProfilerPhase::MediumSample, active);
 
     // initialize basic medium interaction fields
@@ -59,16 +119,13 @@ Medium<Float, Spectrum>::sample_interaction(const Ray3f &ray, Float sample,
     mint = dr::maximum(0.f, mint);
     maxt = dr::minimum(ray.maxt, maxt);
 
-    auto combined_extinction = get_majorant(mei, active);
-    Float m                  = combined_extinction[0];
-    if constexpr (is_rgb_v<Spectrum>) { // Handle RGB rendering
-        dr::masked(m, dr::eq(channel, 1u)) = combined_extinction[1];
-        dr::masked(m, dr::eq(channel, 2u)) = combined_extinction[2];
-    } else {
-        DRJIT_MARK_USED(channel);
-    }
+    UnpolarizedSpectrum control(0.f);
+    if (residual)
+        control = get_control_extinction(mei, active);
 
-    Float sampled_t = mint + (-dr::log(1 - sample) / m);
+    auto [sampled_t, combined_extinction] =
+        sample_distance(ray, mei, mint, maxt, sample, channel,
+                        index_spectrum(control, channel), active);
     Mask valid_mi   = active && (sampled_t <= maxt);
     mei.t           = dr::select(valid_mi, sampled_t, dr::Infinity<Float>);
     mei.p           = ray(sampled_t);
@@ -77,10 +134,24 @@ Medium<Float, Spectrum>::sample_interaction(const Ray3f &ray, Float sample,
 
     std::tie(mei.sigma_s, mei.sigma_n, mei.sigma_t) =
         get_scattering_coefficients(mei, valid_mi);
-    mei.combined_extinction = combined_extinction;
+    mei.combined_extinction = combined_extinction - control;
     return mei;
 }
 
+MI_VARIANT
+std::pair<typename Medium<Float, Spectrum>::Float,
+          typename Medium<Float, Spectrum>::UnpolarizedSpectrum>
+Medium<Float, Spectrum>::sample_distance(const Ray3f & /* ray */,
+                                         const MediumInteraction3f &mi,
+                                         Float mint, Float /* maxt */,
+                                         Float sample, UInt32 channel,
+                                         Float control, Mask active) const {
+    auto combined_extinction = get_majorant(mi, active);
+    Float m = index_spectrum(combined_extinction, channel) - control;
+
+    return { mint + (-dr::log(1 - sample) / m), combined_extinction };
+}
+
 MI_VARIANT
 std::pair<typename Medium<Float, Spectrum>::UnpolarizedSpectrum,
           typename Medium<Float, Spectrum>::UnpolarizedSpectrum>
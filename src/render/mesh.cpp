@@ -1,4 +1,8 @@
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/hash.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/parallel.h>
+#include <mitsuba/core/thread.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/transform.h>
 #include <mitsuba/core/util.h>
@@ -8,6 +12,10 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/records.h>
 #include <mitsuba/render/scene.h>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <list>
 
 #if defined(MI_ENABLE_EMBREE)
     #include <embree3/rtcore.h>
@@ -29,6 +37,49 @@ MI_VARIANT Mesh<Float, Spectrum>::Mesh(const Properties &props) : Base(props) {
 
     m_face_normals = props.get<bool>("face_normals", false);
     m_flip_normals = props.get<bool>("flip_normals", false);
+
+    /* When set to ``true``, faces are sampled in constant time using an alias
+       table instead of a binary search over the cumulative distribution of
+       their areas. Default: ``false`` */
+    m_area_alias_table = props.get<bool>("area_alias_table", false);
+
+    /* When set to ``true``, the mesh buffers are moved into a memory-mapped
+       file once the mesh is loaded (scalar variants only). The file is
+       temporary unless ``out_of_core_file`` specifies its location. */
+    m_out_of_core_file = props.string("out_of_core_file", "");
+    m_out_of_core = props.get<bool>("out_of_core", !m_out_of_core_file.empty());
+
+    /* When set to ``true``, mesh plugins store the loaded buffers in a binary
+       cache file next to the source file (or in ``cache_dir``) and load it
+       instead of parsing the source file on subsequent runs. Meshes are
+       cached in the node-local shared asset directory by default, where
+       scalar variants of other processes map them without copying. */
+    m_cache_dir = props.string("cache_dir",
+                               AssetCache::shared_directory().string());
+    m_cache = props.get<bool>("cache", !m_cache_dir.empty());
+
+    /* Object-to-world transformation at time 1. When specified, the vertices
+       move linearly from their position at time 0 (given by ``to_world``) to
+       the one given by this transformation, which produces motion blur. */
+    if (props.has_property("to_world_end")) {
+        m_to_world_end = props.get<ScalarTransform4f>("to_world_end");
+        m_has_to_world_end = true;
+    }
+
+    /* Precision of the mesh attributes, one of ``float``, ``half``,
+       ``unorm8`` and ``unorm8_srgb``. Reduced precisions decrease the memory
+       footprint of meshes with many attributes. Default: ``float`` */
+    m_attribute_precision =
+        storage_precision(props.string("attribute_storage", "float"));
+    if (is_block_compressed(m_attribute_precision))
+        Throw("The \"%s\" precision is only supported by textures, not by "
+              "mesh attributes!", m_attribute_precision);
+
+    if (m_out_of_core && dr::is_jit_v<Float>) {
+        Log(Warn, "The \"out_of_core\" parameter is only supported in scalar "
+                  "variants and will be ignored.");
+        m_out_of_core = false;
+    }
 }
 
 MI_VARIANT
@@ -52,8 +103,52 @@ Mesh<Float, Spectrum>::Mesh(const std::string &name, ScalarSize vertex_count,
 
 MI_VARIANT
 void Mesh<Float, Spectrum>::initialize() {
+    if (m_has_to_world_end && !has_vertex_motion()) {
+        // Vertex positions at time 1, relative to the ones at time 0
+        ScalarTransform4f trafo = m_to_world_end * m_to_world.scalar().inverse();
+
+        auto&& vertex_positions = dr::migrate(m_vertex_positions, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        const InputFloat *ptr = vertex_positions.data();
+
+        std::vector<InputFloat> positions_end(m_vertex_count * 3);
+        for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+            InputPoint3f p = trafo.transform_affine(
+                ScalarPoint3f(ptr[3 * i + 0], ptr[3 * i + 1], ptr[3 * i + 2]));
+            dr::store(positions_end.data() + 3 * i, p);
+        }
+
+        m_vertex_positions_end =
+            dr::load<FloatStorage>(positions_end.data(), positions_end.size());
+        recompute_bbox();
+    }
+
+    if (m_out_of_core && !m_mmap)
+        move_to_mmap(m_out_of_core_file);
+
+    compress_attributes();
+    update_attribute_face_constant();
+
+    // All render workers read the geometry, spread it over the NUMA nodes
+    if constexpr (!dr::is_jit_v<Float>) {
+        if (Thread::numa_aware() && !m_mmap) {
+            auto interleave = [](const auto &buf) {
+                util::numa_interleave(buf.data(),
+                                      buf.size() * sizeof(*buf.data()));
+            };
+            interleave(m_vertex_positions);
+            interleave(m_vertex_positions_end);
+            interleave(m_vertex_normals);
+            interleave(m_vertex_texcoords);
+            interleave(m_faces);
+        }
+    }
+
 #if defined(MI_ENABLE_LLVM) && !defined(MI_ENABLE_EMBREE)
     m_vertex_positions_ptr = m_vertex_positions.data();
+    m_vertex_positions_end_ptr =
+        has_vertex_motion() ? m_vertex_positions_end.data() : nullptr;
     m_faces_ptr = m_faces.data();
 #endif
     if (m_emitter || m_sensor)
@@ -69,12 +164,15 @@ MI_VARIANT void Mesh<Float, Spectrum>::traverse(TraversalCallback *callback) {
 
     callback->put_parameter("faces",            m_faces,            +ParamFlags::NonDifferentiable);
     callback->put_parameter("vertex_positions", m_vertex_positions, ParamFlags::Differentiable | ParamFlags::Discontinuous);
+    callback->put_parameter("vertex_positions_end", m_vertex_positions_end, +ParamFlags::NonDifferentiable);
     callback->put_parameter("vertex_normals",   m_vertex_normals,   ParamFlags::Differentiable | ParamFlags::Discontinuous);
     callback->put_parameter("vertex_texcoords", m_vertex_texcoords, +ParamFlags::Differentiable);
 
     // We arbitrarily chose to show all attributes as being differentiable here.
+    // Attributes stored with a reduced precision are read-only
     for (auto &[name, attribute]: m_mesh_attributes)
-        callback->put_parameter(name, attribute.buf, +ParamFlags::Differentiable);
+        if (attribute.precision == StoragePrecision::Float)
+            callback->put_parameter(name, attribute.buf, +ParamFlags::Differentiable);
 
 
 }
@@ -92,6 +190,12 @@ MI_VARIANT void Mesh<Float, Spectrum>::parameters_changed(const std::vector<std:
         mesh_attributes_changed = true;
         m_face_count = m_faces.size() / 3;
     }
+    if (has_vertex_motion() && m_vertex_positions_end.size() != m_vertex_count * 3) {
+        Log(Warn, "parameters_changed(): The size of \"vertex_positions_end\" "
+                  "doesn't match the vertex count, disabling the vertex motion.");
+        mesh_attributes_changed = true;
+        m_vertex_positions_end = FloatStorage();
+    }
     if (has_vertex_normals() && m_vertex_normals.size() != m_vertex_count * 3) {
         Log(Debug, "parameters_changed(): Vertex normal count changed, updating it.");
         mesh_attributes_changed = true;
@@ -105,14 +209,21 @@ MI_VARIANT void Mesh<Float, Spectrum>::parameters_changed(const std::vector<std:
     for (auto &[name, attribute]: m_mesh_attributes) {
         size_t expected_size = attribute.size * (attribute.type == MeshAttributeType::Vertex ? m_vertex_count : m_face_count);
 
-        if (attribute.buf.size() != expected_size ) {
+        if (attribute.value_count() != expected_size ) {
             Log(Debug, "parameters_changed(): Vertex or face count changed, but attribute \"%s\" was not updated, resetting it.", name);
             mesh_attributes_changed = true;
             attribute.buf = dr::zeros<FloatStorage>(expected_size);
+            attribute.precision = StoragePrecision::Float;
+            attribute.packed = PackedStorage<Float>();
         }
+        mesh_attributes_changed |= string::contains(keys, name);
     }
 
-    if (keys.empty() || string::contains(keys, "vertex_positions") || mesh_attributes_changed) {
+    if (keys.empty() || string::contains(keys, "faces") || mesh_attributes_changed)
+        update_attribute_face_constant();
+
+    if (keys.empty() || string::contains(keys, "vertex_positions") ||
+        string::contains(keys, "vertex_positions_end") || mesh_attributes_changed) {
         recompute_bbox();
 
         if (has_vertex_normals())
@@ -121,15 +232,19 @@ MI_VARIANT void Mesh<Float, Spectrum>::parameters_changed(const std::vector<std:
         if (!m_area_pmf.empty())
             m_area_pmf = DiscreteDistribution<Float>();
 
-        if (m_parameterization)
-            m_parameterization = nullptr;
-
 #if defined(MI_ENABLE_LLVM) && !defined(MI_ENABLE_EMBREE)
         m_vertex_positions_ptr = m_vertex_positions.data();
+        m_vertex_positions_end_ptr =
+            has_vertex_motion() ? m_vertex_positions_end.data() : nullptr;
         m_faces_ptr = m_faces.data();
 #endif
         mark_dirty();
     }
+
+    if (keys.empty() || string::contains(keys, "vertex_texcoords") ||
+        string::contains(keys, "faces"))
+        m_uv_grid_cells = DynamicBuffer<UInt32>();
+
     Base::parameters_changed();
 }
 
@@ -155,26 +270,90 @@ Mesh<Float, Spectrum>::bbox(ScalarIndex index) const {
                   v1 = vertex_position(fi[1]),
                   v2 = vertex_position(fi[2]);
 
-    return typename Mesh<Float, Spectrum>::ScalarBoundingBox3f(dr::minimum(dr::minimum(v0, v1), v2),
-                                                               dr::maximum(dr::maximum(v0, v1), v2));
+    typename Mesh<Float, Spectrum>::ScalarBoundingBox3f result(
+        dr::minimum(dr::minimum(v0, v1), v2), dr::maximum(dr::maximum(v0, v1), v2));
+
+    // Bound the triangle over the whole motion
+    if (has_vertex_motion()) {
+        for (int i = 0; i < 3; ++i)
+            result.expand(ScalarPoint3f(
+                dr::gather<InputPoint3f>(m_vertex_positions_end, fi[i])));
+    }
+
+    return result;
 }
 
 
-MI_VARIANT void Mesh<Float, Spectrum>::write_ply(const std::string &filename) const {
-    ref<FileStream> stream =
-        new FileStream(filename, FileStream::ETruncReadWrite);
+/// Binary PLY encoder that assembles vertex and face records in parallel
+struct PLYEncoder {
+    /// Flat array of per-vertex or per-face floats
+    struct Array {
+        const float *ptr;
+        size_t dim;
+    };
 
-    Timer timer;
-    Log(Info, "Writing mesh to \"%s\" ..", filename);
-    write_ply(stream);
-    Log(Info, "\"%s\": wrote %i faces, %i vertices (%s in %s)", filename,
-        m_face_count, m_vertex_count,
-        util::mem_string(m_face_count * face_data_bytes() +
-                         m_vertex_count * vertex_data_bytes()),
-        util::time_string((float) timer.value()));
-}
+    std::string header;
+    std::vector<Array> vertex_arrays, face_arrays;
+    const uint32_t *faces = nullptr;
+    size_t vertex_count = 0, face_count = 0;
+    size_t vertex_size = 0, face_size = 1 + 3 * sizeof(uint32_t);
 
-MI_VARIANT void Mesh<Float, Spectrum>::write_ply(Stream *stream) const {
+    /// Records are assembled in blocks of this many elements
+    static constexpr size_t block_size = 1 << 16;
+
+    void add_vertex_array(const float *ptr, size_t dim) {
+        vertex_arrays.push_back({ ptr, dim });
+        vertex_size += dim * sizeof(float);
+    }
+
+    void add_face_array(const float *ptr, size_t dim) {
+        face_arrays.push_back({ ptr, dim });
+        face_size += dim * sizeof(float);
+    }
+
+    /// Total number of records (vertices followed by faces)
+    size_t record_count() const { return vertex_count + face_count; }
+
+    /// Byte offset of the given record relative to the end of the header
+    size_t offset(size_t record) const {
+        return record <= vertex_count
+                   ? record * vertex_size
+                   : vertex_count * vertex_size + (record - vertex_count) * face_size;
+    }
+
+    /// Size of the complete file in bytes
+    size_t size() const { return header.size() + offset(record_count()); }
+
+    /// Encode the records <tt>[begin, end)</tt> into \c dest in parallel
+    void encode(size_t begin, size_t end, uint8_t *dest) const {
+        blocked_parallel_for(end - begin, block_size, [&](size_t b, size_t e) {
+            b += begin;
+            e += begin;
+            uint8_t *ptr = dest + offset(b) - offset(begin);
+
+            for (size_t i = b; i < std::min(e, vertex_count); ++i) {
+                for (const Array &a : vertex_arrays) {
+                    memcpy(ptr, a.ptr + i * a.dim, a.dim * sizeof(float));
+                    ptr += a.dim * sizeof(float);
+                }
+            }
+
+            for (size_t i = std::max(b, vertex_count); i < e; ++i) {
+                size_t f = i - vertex_count;
+                *ptr++ = 3;
+                memcpy(ptr, faces + f * 3, 3 * sizeof(uint32_t));
+                ptr += 3 * sizeof(uint32_t);
+                for (const Array &a : face_arrays) {
+                    memcpy(ptr, a.ptr + f * a.dim, a.dim * sizeof(float));
+                    ptr += a.dim * sizeof(float);
+                }
+            }
+        });
+    }
+};
+
+MI_VARIANT template <typename Func>
+void Mesh<Float, Spectrum>::write_ply_impl(Func &&func) const {
     auto&& vertex_positions = dr::migrate(m_vertex_positions, AllocType::Host);
     auto&& vertex_normals   = dr::migrate(m_vertex_normals, AllocType::Host);
     auto&& vertex_texcoords = dr::migrate(m_vertex_texcoords, AllocType::Host);
@@ -199,94 +378,104 @@ MI_VARIANT void Mesh<Float, Spectrum>::write_ply(Stream *stream) const {
     if constexpr (dr::is_jit_v<Float>)
         dr::sync_thread();
 
-    stream->write_line("ply");
+    std::ostringstream oss;
+    oss << "ply" << std::endl;
     if (Struct::host_byte_order() == Struct::ByteOrder::BigEndian)
-        stream->write_line("format binary_big_endian 1.0");
+        oss << "format binary_big_endian 1.0" << std::endl;
     else
-        stream->write_line("format binary_little_endian 1.0");
+        oss << "format binary_little_endian 1.0" << std::endl;
+
+    PLYEncoder encoder;
+    encoder.vertex_count = m_vertex_count;
+    encoder.face_count = m_face_count;
+    encoder.faces = faces.data();
 
-    stream->write_line(tfm::format("element vertex %i", m_vertex_count));
-    stream->write_line("property float x");
-    stream->write_line("property float y");
-    stream->write_line("property float z");
+    oss << "element vertex " << m_vertex_count << std::endl;
+    oss << "property float x" << std::endl
+        << "property float y" << std::endl
+        << "property float z" << std::endl;
+    encoder.add_vertex_array(vertex_positions.data(), 3);
 
     if (has_vertex_normals()) {
-        stream->write_line("property float nx");
-        stream->write_line("property float ny");
-        stream->write_line("property float nz");
+        oss << "property float nx" << std::endl
+            << "property float ny" << std::endl
+            << "property float nz" << std::endl;
+        encoder.add_vertex_array(vertex_normals.data(), 3);
     }
 
     if (has_vertex_texcoords()) {
-        stream->write_line("property float s");
-        stream->write_line("property float t");
+        oss << "property float s" << std::endl
+            << "property float t" << std::endl;
+        encoder.add_vertex_array(vertex_texcoords.data(), 2);
     }
 
-    for (const auto&[name, attribute]: vertex_attributes)
+    for (const auto&[name, attribute]: vertex_attributes) {
         for (size_t i = 0; i < attribute.size; ++i)
-            stream->write_line(tfm::format("property float %s_%zu", name.c_str(), i));
+            oss << tfm::format("property float %s_%zu", name.c_str(), i) << std::endl;
+        encoder.add_vertex_array(attribute.buf.data(), attribute.size);
+    }
 
-    stream->write_line(tfm::format("element face %i", m_face_count));
-    stream->write_line("property list uchar int vertex_indices");
+    oss << "element face " << m_face_count << std::endl;
+    oss << "property list uchar int vertex_indices" << std::endl;
 
-    for (const auto&[name, attribute]: face_attributes)
+    for (const auto&[name, attribute]: face_attributes) {
         for (size_t i = 0; i < attribute.size; ++i)
-            stream->write_line(tfm::format("property float %s_%zu", name.c_str(), i));
-
-    stream->write_line("end_header");
-
-    // Write vertices data
-    const InputFloat* position_ptr = vertex_positions.data();
-    const InputFloat* normal_ptr   = vertex_normals.data();
-    const InputFloat* texcoord_ptr = vertex_texcoords.data();
-
-    std::vector<const InputFloat*> vertex_attributes_ptr;
-    for (const auto&[name, attribute]: vertex_attributes)
-        vertex_attributes_ptr.push_back(attribute.buf.data());
-
-    for (size_t i = 0; i < m_vertex_count; i++) {
-        // Write positions
-        stream->write(position_ptr, 3 * sizeof(InputFloat));
-        position_ptr += 3;
-        // Write normals
-        if (has_vertex_normals()) {
-            stream->write(normal_ptr, 3 * sizeof(InputFloat));
-            normal_ptr += 3;
-        }
-        // Write texture coordinates
-        if (has_vertex_texcoords()) {
-            stream->write(texcoord_ptr, 2 * sizeof(InputFloat));
-            texcoord_ptr += 2;
-        }
-
-        for (size_t j = 0; j < vertex_attributes_ptr.size(); ++j) {
-            const auto&[name, attribute] = vertex_attributes[j];
-            stream->write(vertex_attributes_ptr[j], attribute.size * sizeof(InputFloat));
-            vertex_attributes_ptr[j] += attribute.size;
-        }
+            oss << tfm::format("property float %s_%zu", name.c_str(), i) << std::endl;
+        encoder.add_face_array(attribute.buf.data(), attribute.size);
     }
 
-    const ScalarIndex* face_ptr = faces.data();
+    oss << "end_header" << std::endl;
+    encoder.header = oss.str();
+
+    func(encoder);
+}
 
-    std::vector<const InputFloat*> face_attributes_ptr;
-    for (const auto&[name, attribute]: face_attributes)
-        face_attributes_ptr.push_back(attribute.buf.data());
+MI_VARIANT void Mesh<Float, Spectrum>::write_ply(const std::string &filename) const {
+    Timer timer;
+    Log(Info, "Writing mesh to \"%s\" ..", filename);
 
-    // Write faces data
-    uint8_t vertex_indices_count = 3;
-    for (size_t i = 0; i < m_face_count; i++) {
-        // Write vertex count
-        stream->write(&vertex_indices_count, sizeof(uint8_t));
+    /* The file is written through a memory mapping of its final size, into
+       which the records are directly assembled in parallel */
+    size_t size = 0;
+    write_ply_impl([&](const PLYEncoder &encoder) {
+        size = encoder.size();
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(filename, size);
+        uint8_t *data = (uint8_t *) mmap->data();
+        memcpy(data, encoder.header.data(), encoder.header.size());
+        encoder.encode(0, encoder.record_count(), data + encoder.header.size());
+    });
 
-        // Write positions
-        stream->write(face_ptr, 3 * sizeof(ScalarIndex));
-        face_ptr += 3;
+    Log(Info, "\"%s\": wrote %i faces, %i vertices (%s in %s)", filename,
+        m_face_count, m_vertex_count, util::mem_string(size),
+        util::time_string((float) timer.value()));
+}
 
-        for (size_t j = 0; j < face_attributes_ptr.size(); ++j) {
-            const auto&[name, attribute] = face_attributes[j];
-            stream->write(face_attributes_ptr[j], attribute.size * sizeof(InputFloat));
-            face_attributes_ptr[j] += attribute.size;
+MI_VARIANT void Mesh<Float, Spectrum>::write_ply(Stream *stream) const {
+    write_ply_impl([&](const PLYEncoder &encoder) {
+        stream->write(encoder.header.data(), encoder.header.size());
+
+        /* Assemble batches of records in parallel. The previous batch is
+           written to the stream in the meantime. */
+        constexpr size_t batch_size = PLYEncoder::block_size * 16;
+        size_t count = encoder.record_count();
+        std::vector<uint8_t> buf[2];
+        std::future<void> pending;
+
+        for (size_t i = 0, k = 0; i < count; i += batch_size, k ^= 1) {
+            size_t end = std::min(i + batch_size, count);
+            buf[k].resize(encoder.offset(end) - encoder.offset(i));
+            encoder.encode(i, end, buf[k].data());
+
+            if (pending.valid())
+                pending.get();
+            pending = std::async(std::launch::async, [stream, &b = buf[k]]() {
+                stream->write(b.data(), b.size());
+            });
         }
-    }
+
+        if (pending.valid())
+            pending.get();
+    });
 }
 
 MI_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
@@ -298,52 +487,98 @@ MI_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
        by Grit Thuermer and Charles A. Wuethrich, JGT 1998, Vol 3 */
 
     if constexpr (!dr::is_dynamic_v<Float>) {
-        size_t invalid_counter = 0;
-        std::vector<InputNormal3f> normals(m_vertex_count, dr::zeros<InputNormal3f>());
-
-        for (ScalarSize i = 0; i < m_face_count; ++i) {
-            auto fi = face_indices(i);
-            Assert(fi[0] < m_vertex_count &&
-                   fi[1] < m_vertex_count &&
-                   fi[2] < m_vertex_count);
-
-            InputPoint3f v[3] = { vertex_position(fi[0]),
-                                  vertex_position(fi[1]),
-                                  vertex_position(fi[2]) };
-
-            InputVector3f side_0 = v[1] - v[0],
-                          side_1 = v[2] - v[0];
-            InputNormal3f n = dr::cross(side_0, side_1);
-            InputFloat length_sqr = dr::squared_norm(n);
-            if (likely(length_sqr > 0)) {
-                n *= dr::rsqrt(length_sqr);
-
-                // Use DrJit to compute the face angles at the same time
-                auto side1 = transpose(dr::Array<dr::Packet<InputFloat, 3>, 3>{ side_0, v[2] - v[1], v[0] - v[2] });
-                auto side2 = transpose(dr::Array<dr::Packet<InputFloat, 3>, 3>{ side_1, v[0] - v[1], v[1] - v[2] });
-                InputVector3f face_angles = unit_angle(dr::normalize(side1), dr::normalize(side2));
-
-                for (size_t j = 0; j < 3; ++j)
-                    normals[fi[j]] += n * face_angles[j];
+        /* Never write into a read-only mapping of the mesh cache or into
+           buffers shared with other instances */
+        if ((m_mmap && !m_mmap->can_write()) || m_asset)
+            m_vertex_normals = dr::zeros<FloatStorage>(m_vertex_count * 3);
+
+        const InputFloat *positions = m_vertex_positions.data();
+        const ScalarIndex *faces = m_faces.data();
+        InputFloat *normals = m_vertex_normals.data();
+        size_t vertex_count = m_vertex_count,
+               corner_count = (size_t) m_face_count * 3;
+
+        /* Build the list of face corners that reference each vertex. Every
+           vertex then accumulates its normal independently, which avoids
+           concurrent updates and makes the result deterministic. */
+        std::unique_ptr<std::atomic<uint32_t>[]> cursor(
+            new std::atomic<uint32_t>[vertex_count + 1]);
+        std::unique_ptr<uint32_t[]> offset(new uint32_t[vertex_count + 1]),
+                                    corners(new uint32_t[corner_count]);
+
+        blocked_parallel_for(vertex_count + 1, 1 << 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                cursor[i].store(0, std::memory_order_relaxed);
+        });
+
+        blocked_parallel_for(corner_count, 1 << 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                Assert(faces[i] < vertex_count);
+                cursor[faces[i] + 1].fetch_add(1, std::memory_order_relaxed);
             }
+        });
+
+        uint32_t sum = 0;
+        for (size_t i = 0; i <= vertex_count; ++i) {
+            sum += cursor[i].load(std::memory_order_relaxed);
+            offset[i] = sum;
+            cursor[i].store(sum, std::memory_order_relaxed);
         }
 
-        for (ScalarSize i = 0; i < m_vertex_count; i++) {
-            InputNormal3f n = normals[i];
-            InputFloat length = dr::norm(n);
-            if (likely(length != 0.f)) {
-                n /= length;
-            } else {
-                n = InputNormal3f(1, 0, 0); // Choose some bogus value
-                invalid_counter++;
+        blocked_parallel_for(corner_count, 1 << 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t slot = cursor[faces[i]].fetch_add(1, std::memory_order_relaxed);
+                corners[slot] = (uint32_t) i;
             }
+        });
 
-            dr::store(m_vertex_normals.data() + 3 * i, n);
-        }
+        // Angle-weighted normal of the face at the given corner
+        auto corner_normal = [&](uint32_t corner) {
+            const ScalarIndex *fi = faces + (corner - corner % 3);
+            InputPoint3f v[3] = { dr::load<InputPoint3f>(positions + 3 * fi[0]),
+                                  dr::load<InputPoint3f>(positions + 3 * fi[1]),
+                                  dr::load<InputPoint3f>(positions + 3 * fi[2]) };
+
+            InputNormal3f n = dr::cross(v[1] - v[0], v[2] - v[0]);
+            InputFloat length_sqr = dr::squared_norm(n);
+            if (unlikely(!(length_sqr > 0)))
+                return dr::zeros<InputNormal3f>();
+
+            uint32_t j = corner % 3;
+            InputVector3f d0 = dr::normalize(v[(j + 1) % 3] - v[j]),
+                          d1 = dr::normalize(v[(j + 2) % 3] - v[j]);
+            return InputNormal3f(n * (dr::rsqrt(length_sqr) * unit_angle(d0, d1)));
+        };
+
+        std::atomic<size_t> invalid_counter { 0 };
+        blocked_parallel_for(vertex_count, 1 << 12, [&](size_t begin, size_t end) {
+            size_t invalid = 0;
+            for (size_t i = begin; i < end; ++i) {
+                // Sum the contributions in a fixed order
+                uint32_t *start = corners.get() + offset[i],
+                         *stop  = corners.get() + offset[i + 1];
+                std::sort(start, stop);
+
+                InputNormal3f n = dr::zeros<InputNormal3f>();
+                for (uint32_t *corner = start; corner != stop; ++corner)
+                    n += corner_normal(*corner);
+
+                InputFloat length = dr::norm(n);
+                if (likely(length != 0.f)) {
+                    n /= length;
+                } else {
+                    n = InputNormal3f(1, 0, 0); // Choose some bogus value
+                    invalid++;
+                }
+
+                dr::store(normals + 3 * i, n);
+            }
+            invalid_counter += invalid;
+        });
 
         if (invalid_counter > 0)
             Log(Warn, "\"%s\": computed vertex normals (%i invalid vertices!)",
-                m_name, invalid_counter);
+                m_name, invalid_counter.load());
     } else {
         // The following is JITed into two separate kernel launches
 
@@ -386,16 +621,33 @@ MI_VARIANT void Mesh<Float, Spectrum>::recompute_vertex_normals() {
 }
 
 MI_VARIANT void Mesh<Float, Spectrum>::recompute_bbox() {
+    std::mutex mutex;
+    auto expand = [&](const InputFloat *ptr) {
+        blocked_parallel_for(m_vertex_count, 1 << 16, [&](size_t begin, size_t end) {
+            ScalarBoundingBox3f bbox;
+            for (size_t i = begin; i < end; ++i)
+                bbox.expand(
+                    ScalarPoint3f(ptr[3 * i + 0], ptr[3 * i + 1], ptr[3 * i + 2]));
+
+            std::lock_guard<std::mutex> guard(mutex);
+            m_bbox.expand(bbox);
+        });
+    };
+
     auto&& vertex_positions = dr::migrate(m_vertex_positions, AllocType::Host);
     if constexpr (dr::is_jit_v<Float>)
         dr::sync_thread();
 
-    const InputFloat *ptr = vertex_positions.data();
-
     m_bbox.reset();
-    for (ScalarSize i = 0; i < m_vertex_count; ++i)
-        m_bbox.expand(
-            ScalarPoint3f(ptr[3 * i + 0], ptr[3 * i + 1], ptr[3 * i + 2]));
+    expand(vertex_positions.data());
+
+    if (has_vertex_motion()) {
+        auto&& vertex_positions_end = dr::migrate(m_vertex_positions_end, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+
+        expand(vertex_positions_end.data());
+    }
 }
 
 MI_VARIANT void Mesh<Float, Spectrum>::build_pmf() {
@@ -416,86 +668,207 @@ MI_VARIANT void Mesh<Float, Spectrum>::build_pmf() {
     const ScalarIndex *idx_p = faces.data();
 
     std::vector<ScalarFloat> table(m_face_count);
-    for (ScalarIndex i = 0; i < m_face_count; i++) {
-        ScalarPoint3u idx = dr::load<ScalarPoint3u>(idx_p + 3 * i);
+    blocked_parallel_for(m_face_count, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            ScalarPoint3u idx = dr::load<ScalarPoint3u>(idx_p + 3 * i);
 
-        ScalarPoint3f p0 = dr::load<InputPoint3f>(pos_p + 3 * idx.x()),
-                      p1 = dr::load<InputPoint3f>(pos_p + 3 * idx.y()),
-                      p2 = dr::load<InputPoint3f>(pos_p + 3 * idx.z());
+            ScalarPoint3f p0 = dr::load<InputPoint3f>(pos_p + 3 * idx.x()),
+                          p1 = dr::load<InputPoint3f>(pos_p + 3 * idx.y()),
+                          p2 = dr::load<InputPoint3f>(pos_p + 3 * idx.z());
 
-        table[i] = .5f * dr::norm(dr::cross(p1 - p0, p2 - p0));
-    }
+            table[i] = .5f * dr::norm(dr::cross(p1 - p0, p2 - p0));
+        }
+    });
 
     m_area_pmf = DiscreteDistribution<Float>(
         table.data(),
-        m_face_count
+        m_face_count,
+        m_area_alias_table
     );
 }
 
 MI_VARIANT
 ref<Mesh<Float, Spectrum>>
 Mesh<Float, Spectrum>::merge(const Mesh *other) const {
-    if (other->emitter() != m_emitter || other->sensor() != m_sensor ||
-        other->bsdf() != m_bsdf ||
-        other->interior_medium() != m_interior_medium ||
-        other->exterior_medium() != m_exterior_medium ||
-        other->has_vertex_normals() != has_vertex_normals() ||
-        other->has_vertex_texcoords() != has_vertex_texcoords() ||
-        other->has_face_normals() != has_face_normals() ||
-        other->has_mesh_attributes() || has_mesh_attributes())
-        Throw("Mesh::merge(): the two meshes are incompatible (%s and %s)!",
-              to_string(), other->to_string());
+    return merge(std::vector<const Mesh *>{ this, other });
+}
 
-    Properties props;
-    if (m_bsdf)
-        props.set_object("bsdf", (Object *) m_bsdf.get());
-    if (m_interior_medium)
-        props.set_object("interior", (Object *) m_interior_medium.get());
-    if (m_exterior_medium)
-        props.set_object("exterior", (Object *) m_exterior_medium.get());
-    if (m_sensor)
-        props.set_object("sensor", (Object *) m_sensor.get());
-    if (m_emitter)
-        props.set_object("emitter", (Object *) m_emitter.get());
-    props.set_bool("face_normals", m_face_normals);
-
-    ref<Mesh> result = new Mesh(
-        m_name + " + " + other->m_name, m_vertex_count + other->vertex_count(),
-        m_face_count + other->face_count(), props, has_vertex_normals(),
-        has_vertex_texcoords());
-
-    result->m_vertex_positions =
-        dr::concat(m_vertex_positions, other->m_vertex_positions);
+MI_VARIANT
+ref<Mesh<Float, Spectrum>>
+Mesh<Float, Spectrum>::merge(const std::vector<const Mesh *> &meshes) {
+    if (meshes.empty())
+        Throw("Mesh::merge(): at least one mesh must be specified!");
+
+    const Mesh *first = meshes[0];
+    size_t n = meshes.size();
+
+    for (const Mesh *mesh : meshes) {
+        bool compatible =
+            mesh->emitter() == first->m_emitter &&
+            mesh->sensor() == first->m_sensor &&
+            mesh->bsdf() == first->m_bsdf &&
+            mesh->interior_medium() == first->m_interior_medium &&
+            mesh->exterior_medium() == first->m_exterior_medium &&
+            mesh->has_vertex_normals() == first->has_vertex_normals() &&
+            mesh->has_vertex_texcoords() == first->has_vertex_texcoords() &&
+            mesh->has_face_normals() == first->has_face_normals() &&
+            mesh->m_mesh_attributes.size() == first->m_mesh_attributes.size();
+
+        for (const auto &[name, attribute] : first->m_mesh_attributes) {
+            auto it = mesh->m_mesh_attributes.find(name);
+            compatible &= it != mesh->m_mesh_attributes.end() &&
+                          it->second.size == attribute.size &&
+                          it->second.type == attribute.type;
+        }
 
-    if (has_vertex_normals())
-        result->m_vertex_normals =
-            dr::concat(m_vertex_normals, other->m_vertex_normals);
+        if (!compatible)
+            Throw("Mesh::merge(): the meshes are incompatible (%s and %s)!",
+                  first->to_string(), mesh->to_string());
+    }
 
-    if (has_vertex_texcoords())
-        result->m_vertex_texcoords =
-            dr::concat(m_vertex_texcoords, other->m_vertex_texcoords);
+    // Offsets of the vertices and faces of each mesh in the merged buffers
+    std::vector<ScalarSize> vertex_offset(n + 1, 0), face_offset(n + 1, 0);
+    bool has_vertex_motion = false;
+    for (size_t i = 0; i < n; ++i) {
+        size_t vertex_count = (size_t) vertex_offset[i] + meshes[i]->m_vertex_count,
+               face_count   = (size_t) face_offset[i] + meshes[i]->m_face_count;
+        if (vertex_count > 0xFFFFFFFFu || face_count * 3 > 0xFFFFFFFFu)
+            Throw("Mesh::merge(): the merged mesh is too large!");
+        vertex_offset[i + 1] = (ScalarSize) vertex_count;
+        face_offset[i + 1]   = (ScalarSize) face_count;
+        has_vertex_motion |= meshes[i]->has_vertex_motion();
+    }
 
-    result->m_faces = dr::concat(m_faces, other->m_faces);
-    result->m_bbox = m_bbox;
-    result->m_bbox.expand(other->m_bbox);
+    Properties props;
+    if (first->m_bsdf)
+        props.set_object("bsdf", (Object *) first->m_bsdf.get());
+    if (first->m_interior_medium)
+        props.set_object("interior", (Object *) first->m_interior_medium.get());
+    if (first->m_exterior_medium)
+        props.set_object("exterior", (Object *) first->m_exterior_medium.get());
+    if (first->m_sensor)
+        props.set_object("sensor", (Object *) first->m_sensor.get());
+    if (first->m_emitter)
+        props.set_object("emitter", (Object *) first->m_emitter.get());
+    props.set_bool("face_normals", first->m_face_normals);
+    props.set_bool("area_alias_table", first->m_area_alias_table);
+
+    ref<Mesh> result = new Mesh(props);
+    result->m_attribute_precision = first->m_attribute_precision;
+    if (n == 1)
+        result->m_name = first->m_name;
+    else if (n == 2)
+        result->m_name = first->m_name + " + " + meshes[1]->m_name;
+    else
+        result->m_name = tfm::format("%s + %zu other meshes", first->m_name, n - 1);
+    result->m_vertex_count = vertex_offset[n];
+    result->m_face_count = face_offset[n];
+
+    /* Concatenate one buffer of every mesh. The output is allocated once, and
+       the inputs are copied in parallel to their offsets. JIT variants copy
+       the data on the host and upload the result in a single step. */
+    auto concat = [&](auto get, const std::vector<ScalarSize> &offset,
+                      size_t dim, bool is_face_buffer) {
+        using Buffer = std::decay_t<decltype(get(first))>;
+        using Value  = dr::scalar_t<Buffer>;
+
+        std::vector<Buffer> host;
+        std::vector<const Value *> src(n);
+        if constexpr (dr::is_jit_v<Float>) {
+            host.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+                host.push_back(dr::migrate(get(meshes[i]), AllocType::Host));
+            dr::sync_thread();
+            for (size_t i = 0; i < n; ++i)
+                src[i] = host[i].data();
+        } else {
+            for (size_t i = 0; i < n; ++i)
+                src[i] = get(meshes[i]).data();
+        }
 
-    if constexpr (dr::is_jit_v<Float>) {
-        UInt32 threshold = dr::opaque<UInt32>(face_count() * 3),
-               offset    = dr::opaque<UInt32>(vertex_count()),
-               index     = dr::arange<UInt32>(result->face_count() * 3);
+        size_t size = (size_t) offset[n] * dim;
+        Buffer output;
+        std::unique_ptr<Value[]> staging;
+        Value *dst;
+        if constexpr (dr::is_jit_v<Float>) {
+            staging = std::unique_ptr<Value[]>(new Value[size]);
+            dst = staging.get();
+        } else {
+            output = dr::empty<Buffer>(size);
+            dst = output.data();
+        }
 
-        result->m_faces = dr::select(index < threshold, result->m_faces,
-                                     result->m_faces + offset);
+        // Aim for blocks of roughly 16K values, regardless of the mesh sizes
+        size_t grain = std::max<size_t>(1, n * 16384 / std::max<size_t>(size, 1));
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, n, (uint32_t) std::min<size_t>(grain, n)),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    size_t start = (size_t) offset[i] * dim,
+                           count = (size_t) (offset[i + 1] - offset[i]) * dim;
+                    if (count == 0)
+                        continue;
+                    memcpy(dst + start, src[i], count * sizeof(Value));
+                    if (is_face_buffer && vertex_offset[i] != 0) {
+                        for (size_t j = 0; j < count; ++j)
+                            dst[start + j] += (Value) vertex_offset[i];
+                    }
+                }
+            }
+        );
 
-        dr::eval(result->m_faces, result->m_vertex_positions,
-                 result->m_vertex_normals, result->m_vertex_texcoords);
-    } else {
-        uint32_t  offset = vertex_count(),
-                 *ptr    = result->m_faces.data() + face_count() * 3;
-        for (size_t i = 0; i < other->face_count() * 3; ++i)
-            *ptr++ += offset;
+        if constexpr (dr::is_jit_v<Float>)
+            output = dr::load<Buffer>(dst, size);
+        return output;
+    };
+
+    result->m_vertex_positions = concat(
+        [](const Mesh *m) -> const FloatStorage & { return m->m_vertex_positions; },
+        vertex_offset, 3, false);
+
+    // Static meshes keep their positions at time 1
+    if (has_vertex_motion)
+        result->m_vertex_positions_end = concat(
+            [](const Mesh *m) -> const FloatStorage & {
+                return m->has_vertex_motion() ? m->m_vertex_positions_end
+                                              : m->m_vertex_positions;
+            }, vertex_offset, 3, false);
+
+    if (first->has_vertex_normals())
+        result->m_vertex_normals = concat(
+            [](const Mesh *m) -> const FloatStorage & { return m->m_vertex_normals; },
+            vertex_offset, 3, false);
+
+    if (first->has_vertex_texcoords())
+        result->m_vertex_texcoords = concat(
+            [](const Mesh *m) -> const FloatStorage & { return m->m_vertex_texcoords; },
+            vertex_offset, 2, false);
+
+    result->m_faces = concat(
+        [](const Mesh *m) -> const DynamicBuffer<UInt32> & { return m->m_faces; },
+        face_offset, 3, true);
+
+    for (const auto &[name, attribute] : first->m_mesh_attributes) {
+        const std::string &key = name;
+        // Attributes with a reduced precision are decoded (std::list keeps references valid)
+        std::list<FloatStorage> decoded;
+        FloatStorage buf = concat(
+            [&key, &decoded](const Mesh *m) -> const FloatStorage & {
+                const MeshAttribute &attr = m->m_mesh_attributes.find(key)->second;
+                if (attr.precision == StoragePrecision::Float)
+                    return attr.buf;
+                return decoded.emplace_back(attr.values());
+            },
+            attribute.type == MeshAttributeType::Vertex ? vertex_offset
+                                                        : face_offset,
+            attribute.size, false);
+        result->m_mesh_attributes.insert(
+            { name, { attribute.size, attribute.type, buf } });
     }
 
+    for (const Mesh *mesh : meshes)
+        result->m_bbox.expand(mesh->m_bbox);
+
     result->initialize();
 
     return result;
@@ -503,45 +876,100 @@ Mesh<Float, Spectrum>::merge(const Mesh *other) const {
 
 MI_VARIANT void Mesh<Float, Spectrum>::build_parameterization() {
     std::lock_guard<std::mutex> lock(m_mutex);
-    if (m_parameterization)
+    if (dr::width(m_uv_grid_cells) != 0)
         return; // already built!
 
     if (!has_vertex_texcoords())
         Throw("eval_parameterization(): mesh does not have UV coordinates!");
 
-    Properties props;
-    ref<Mesh> mesh =
-        new Mesh(m_name + "_param", m_vertex_count, m_face_count,
-                 props, false, false);
-    mesh->m_faces = m_faces;
-
     auto&& vertex_texcoords = dr::migrate(m_vertex_texcoords, AllocType::Host);
+    auto&& faces_host = dr::migrate(m_faces, AllocType::Host);
     if constexpr (dr::is_jit_v<Float>)
         dr::sync_thread();
 
-    const InputFloat *ptr = vertex_texcoords.data();
+    const InputFloat *uv = vertex_texcoords.data();
+    const ScalarIndex *faces = faces_host.data();
+    size_t face_count = m_face_count;
+
+    ScalarBoundingBox2f bbox;
+    for (size_t i = 0; i < m_vertex_count; ++i)
+        bbox.expand(ScalarPoint2f(uv[2 * i + 0], uv[2 * i + 1]));
+
+    // Use about one grid cell per triangle
+    ScalarVector2f extents = dr::maximum(bbox.extents(), dr::Epsilon<ScalarFloat>);
+    ScalarFloat aspect = extents.x() / extents.y();
+    auto cells = [](ScalarFloat value) {
+        return (uint32_t) dr::clamp(dr::round(dr::sqrt(value)),
+                                    (ScalarFloat) 1, (ScalarFloat) 4096);
+    };
+    ScalarVector2u res(cells(face_count * aspect), cells(face_count / aspect));
+    ScalarVector2f scale = ScalarVector2f(res) / extents;
+    size_t cell_count = (size_t) dr::prod(res);
+
+    // Range of grid cells overlapped by the UV bounding box of a triangle
+    auto cell_range = [&](size_t face) {
+        ScalarBoundingBox2f tri;
+        for (size_t k = 0; k < 3; ++k) {
+            ScalarIndex v = faces[3 * face + k];
+            tri.expand(ScalarPoint2f(uv[2 * v + 0], uv[2 * v + 1]));
+        }
+        ScalarVector2i lo = dr::floor2int<ScalarVector2i>((tri.min - bbox.min) * scale),
+                       hi = dr::floor2int<ScalarVector2i>((tri.max - bbox.min) * scale);
+        ScalarVector2i max_cell = ScalarVector2i(res) - 1;
+        return std::make_pair(dr::clamp(lo, 0, max_cell), dr::clamp(hi, 0, max_cell));
+    };
+
+    /* Sort the triangles into the cells they overlap, using the same
+       counting scheme as recompute_vertex_normals() */
+    std::unique_ptr<std::atomic<uint32_t>[]> cursor(
+        new std::atomic<uint32_t>[cell_count + 1]);
+    std::unique_ptr<uint32_t[]> offset(new uint32_t[cell_count + 1]);
+
+    blocked_parallel_for(cell_count + 1, 1 << 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            cursor[i].store(0, std::memory_order_relaxed);
+    });
+
+    blocked_parallel_for(face_count, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            auto [lo, hi] = cell_range(f);
+            for (int32_t y = lo.y(); y <= hi.y(); ++y)
+                for (int32_t x = lo.x(); x <= hi.x(); ++x)
+                    cursor[(size_t) y * res.x() + x + 1].fetch_add(
+                        1, std::memory_order_relaxed);
+        }
+    });
 
-    std::vector<InputFloat> pos_out(m_vertex_count * 3);
-    ScalarBoundingBox3f bbox;
-    for (size_t i = 0; i < m_vertex_count; ++i) {
-        InputFloat u = ptr[2*i + 0],
-                   v = ptr[2*i + 1];
-        pos_out[i*3 + 0] = u;
-        pos_out[i*3 + 1] = v;
-        pos_out[i*3 + 2] = 0.f;
-        bbox.expand(ScalarPoint3f(u, v, 0.f));
+    uint32_t sum = 0;
+    for (size_t i = 0; i <= cell_count; ++i) {
+        sum += cursor[i].load(std::memory_order_relaxed);
+        offset[i] = sum;
+        cursor[i].store(sum, std::memory_order_relaxed);
     }
-    mesh->m_vertex_positions =
-        dr::load<FloatStorage>(pos_out.data(), m_vertex_count * 3);
-    mesh->m_bbox = bbox;
-    mesh->initialize();
-
-    props.set_object("mesh", mesh.get());
 
-    if (m_scene)
-        props.set_object("parent_scene", m_scene);
-
-    m_parameterization = new Scene<Float, Spectrum>(props);
+    std::unique_ptr<uint32_t[]> cell_faces(new uint32_t[std::max(sum, 1u)]);
+    blocked_parallel_for(face_count, 1 << 14, [&](size_t begin, size_t end) {
+        for (size_t f = begin; f < end; ++f) {
+            auto [lo, hi] = cell_range(f);
+            for (int32_t y = lo.y(); y <= hi.y(); ++y)
+                for (int32_t x = lo.x(); x <= hi.x(); ++x)
+                    cell_faces[cursor[(size_t) y * res.x() + x].fetch_add(
+                        1, std::memory_order_relaxed)] = (uint32_t) f;
+        }
+    });
+
+    // Queries return the first triangle that contains them: fix the order
+    blocked_parallel_for(cell_count, 1 << 12, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            std::sort(cell_faces.get() + offset[i], cell_faces.get() + offset[i + 1]);
+    });
+
+    m_uv_grid_faces = dr::load<DynamicBuffer<UInt32>>(cell_faces.get(), std::max(sum, 1u));
+    m_uv_grid_min   = bbox.min;
+    m_uv_grid_max   = bbox.max;
+    m_uv_grid_scale = scale;
+    m_uv_grid_res   = res;
+    m_uv_grid_cells = dr::load<DynamicBuffer<UInt32>>(offset.get(), cell_count + 1);
 }
 
 MI_VARIANT typename Mesh<Float, Spectrum>::ScalarSize
@@ -567,9 +995,9 @@ Mesh<Float, Spectrum>::sample_position(Float time, const Point2f &sample_, Mask
 
     Vector3u fi = face_indices(face_idx, active);
 
-    Point3f p0 = vertex_position(fi[0], active),
-            p1 = vertex_position(fi[1], active),
-            p2 = vertex_position(fi[2], active);
+    Point3f p0 = vertex_position_at(fi[0], time, active),
+            p1 = vertex_position_at(fi[1], time, active),
+            p2 = vertex_position_at(fi[2], time, active);
 
     Vector3f e0 = p1 - p0, e1 = p2 - p0;
     Point2f b = warp::square_to_uniform_triangle(sample);
@@ -616,19 +1044,59 @@ typename Mesh<Float, Spectrum>::SurfaceInteraction3f
 Mesh<Float, Spectrum>::eval_parameterization(const Point2f &uv,
                                              uint32_t ray_flags,
                                              Mask active) const {
-    if (!m_parameterization)
+    if (dr::width(m_uv_grid_cells) == 0)
         const_cast<Mesh *>(this)->build_parameterization();
 
-    Ray3f ray(Point3f(uv.x(), uv.y(), -1), Vector3f(0, 0, 1), 0, Wavelength(0));
+    // Locate the grid cell of every query
+    active &= dr::all(uv >= m_uv_grid_min && uv <= m_uv_grid_max);
+    Vector2i cell = dr::clamp(
+        dr::floor2int<Vector2i>((uv - m_uv_grid_min) * m_uv_grid_scale), 0,
+        ScalarVector2i(m_uv_grid_res) - 1);
+    UInt32 cell_idx = dr::fmadd(UInt32(cell.y()), m_uv_grid_res.x(), UInt32(cell.x()));
+
+    UInt32 index = dr::gather<UInt32>(m_uv_grid_cells, cell_idx, active),
+           end   = dr::gather<UInt32>(m_uv_grid_cells, cell_idx + 1, active);
+
+    // Test the triangles of the cell until one of them contains the query
+    PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+    Mask active_loop = active && index < end;
+
+    dr::Loop<Mask> loop("Mesh::eval_parameterization", active_loop, index, pi);
+    while (loop(active_loop)) {
+        UInt32 face = dr::gather<UInt32>(m_uv_grid_faces, index, active_loop);
+        Vector3u fi = face_indices(face, active_loop);
+
+        Point2f uv0 = vertex_texcoord(fi[0], active_loop),
+                uv1 = vertex_texcoord(fi[1], active_loop),
+                uv2 = vertex_texcoord(fi[2], active_loop);
+
+        Vector2f e1 = uv1 - uv0, e2 = uv2 - uv0, rel = uv - uv0;
+        Float det = dr::fmsub(e1.x(), e2.y(), e1.y() * e2.x()),
+              inv_det = dr::rcp(det),
+              b1 = dr::fmsub(rel.x(), e2.y(), rel.y() * e2.x()) * inv_det,
+              b2 = dr::fmsub(e1.x(), rel.y(), e1.y() * rel.x()) * inv_det;
+
+        // Accept points on the edges shared by neighboring triangles
+        ScalarFloat eps = 1e-6f;
+        Mask hit = active_loop && dr::neq(det, 0.f) && b1 >= -eps &&
+                   b2 >= -eps && b1 + b2 <= 1.f + eps;
+
+        dr::masked(pi.t, hit) = 1.f;
+        dr::masked(pi.prim_uv, hit) = Point2f(b1, b2);
+        dr::masked(pi.prim_index, hit) = face;
+
+        index++;
+        active_loop &= !hit && index < end;
+    }
 
-    PreliminaryIntersection3f pi =
-        m_parameterization->ray_intersect_preliminary(
-            ray, /* coherent = */ true, active);
     active &= pi.is_valid();
+    pi.shape = this;
 
     if (dr::none_or<false>(active))
         return dr::zeros<SurfaceInteraction3f>();
 
+    Ray3f ray(Point3f(uv.x(), uv.y(), -1), Vector3f(0, 0, 1), 0, Wavelength(0));
+
     SurfaceInteraction3f si =
         compute_surface_interaction(ray, pi, ray_flags, 0, active);
     si.finalize_surface_interaction(pi, ray, ray_flags, active);
@@ -646,9 +1114,9 @@ Mesh<Float, Spectrum>::barycentric_coordinates(const SurfaceInteraction3f &si,
                                                Mask active) const {
     Vector3u fi = face_indices(si.prim_index, active);
 
-    Point3f p0 = vertex_position(fi[0], active),
-            p1 = vertex_position(fi[1], active),
-            p2 = vertex_position(fi[2], active);
+    Point3f p0 = vertex_position_at(fi[0], si.time, active),
+            p1 = vertex_position_at(fi[1], si.time, active),
+            p2 = vertex_position_at(fi[2], si.time, active);
 
     Vector3f rel = si.p - p0,
              du  = p1 - p0,
@@ -685,9 +1153,9 @@ Mesh<Float, Spectrum>::compute_surface_interaction(const Ray3f &ray,
 
     Vector3u fi = face_indices(pi.prim_index, active);
 
-    Point3f p0 = vertex_position(fi[0], active),
-            p1 = vertex_position(fi[1], active),
-            p2 = vertex_position(fi[2], active);
+    Point3f p0 = vertex_position_at(fi[0], ray.time, active),
+            p1 = vertex_position_at(fi[1], ray.time, active),
+            p2 = vertex_position_at(fi[2], ray.time, active);
 
     Float t = pi.t;
     Point2f prim_uv = pi.prim_uv;
@@ -921,15 +1389,103 @@ MI_VARIANT void Mesh<Float, Spectrum>::add_attribute(const std::string& name,
     if constexpr (is_spectral_v<Spectrum>) {
         if (dim == 3 && name.find("color") != std::string::npos) {
             InputFloat *ptr = (InputFloat *) data.data();
-            for (size_t i = 0; i < count; ++i) {
-                dr::store(ptr, srgb_model_fetch(dr::load<Color<InputFloat, 3>>(ptr)));
-                ptr += 3;
-            }
+            srgb_model_fetch(ptr, ptr, count);
         }
     }
 
     FloatStorage buffer = dr::load<FloatStorage>(data.data(), count * dim);
-    m_mesh_attributes.insert({ name, { dim, type, buffer } });
+    auto it = m_mesh_attributes.insert({ name, { dim, type, buffer } }).first;
+
+    // Compress right away, so that the single precision values are never shared
+    if (m_attribute_precision != StoragePrecision::Float)
+        compress_attribute(name, it->second);
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::compress_attribute(const std::string &name,
+                                                          MeshAttribute &attribute) {
+    if (attribute.precision != StoragePrecision::Float ||
+        m_attribute_precision == StoragePrecision::Float)
+        return;
+
+    StoragePrecision precision = m_attribute_precision;
+
+    /* Spectral variants store color attributes as coefficients of the
+       spectral upsampling model, which require more than 8 bits */
+    if constexpr (is_spectral_v<Spectrum>) {
+        if (attribute.size == 3 && name.find("color") != std::string::npos &&
+            precision != StoragePrecision::Half) {
+            Log(Debug, "Storing the spectral coefficients of attribute \"%s\" "
+                       "with half precision.", name);
+            precision = StoragePrecision::Half;
+        }
+    }
+
+    auto &&host = dr::migrate(attribute.buf, AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+    const InputFloat *ptr = host.data();
+    size_t size = attribute.buf.size();
+
+    std::vector<ScalarFloat> values(ptr, ptr + size);
+    attribute.packed = PackedStorage<Float>(values.data(), size / attribute.size,
+                                            (uint32_t) attribute.size, precision);
+    attribute.precision = precision;
+    attribute.buf = FloatStorage();
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::compress_attributes() {
+    for (auto &[name, attribute] : m_mesh_attributes)
+        compress_attribute(name, attribute);
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::update_attribute_face_constant() {
+    for (auto &[name, attribute] : m_mesh_attributes) {
+        attribute.face_constant = false;
+        if (attribute.type != MeshAttributeType::Vertex || m_face_count == 0 ||
+            attribute.value_count() != attribute.size * m_vertex_count)
+            continue;
+
+        FloatStorage decoded;
+        if (attribute.precision != StoragePrecision::Float)
+            decoded = attribute.values();
+        const FloatStorage &values =
+            attribute.precision == StoragePrecision::Float ? attribute.buf : decoded;
+
+        auto &&faces = dr::migrate(m_faces, AllocType::Host);
+        auto &&host = dr::migrate(values, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        const ScalarIndex *fi = faces.data();
+        const InputFloat *v = host.data();
+        size_t dim = attribute.size;
+        std::atomic<bool> constant(true);
+
+        blocked_parallel_for(m_face_count, 1 << 14, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end && constant.load(std::memory_order_relaxed); ++i) {
+                const InputFloat *v0 = v + fi[3 * i + 0] * dim,
+                                 *v1 = v + fi[3 * i + 1] * dim,
+                                 *v2 = v + fi[3 * i + 2] * dim;
+                for (size_t c = 0; c < dim; ++c) {
+                    if (v0[c] != v1[c] || v0[c] != v2[c]) {
+                        constant.store(false, std::memory_order_relaxed);
+                        break;
+                    }
+                }
+            }
+        });
+
+        attribute.face_constant = constant.load();
+    }
+}
+
+MI_VARIANT std::vector<std::pair<std::string, size_t>>
+Mesh<Float, Spectrum>::mesh_attribute_dims() const {
+    std::vector<std::pair<std::string, size_t>> result;
+    result.reserve(m_mesh_attributes.size());
+    for (const auto &[name, attribute] : m_mesh_attributes)
+        result.emplace_back(name, attribute.size);
+    std::sort(result.begin(), result.end());
+    return result;
 }
 
 MI_VARIANT typename Mesh<Float, Spectrum>::Mask
@@ -950,9 +1506,9 @@ Mesh<Float, Spectrum>::eval_attribute(const std::string& name,
 
     const auto& attr = it->second;
     if (attr.size == 1)
-        return interpolate_attribute<1, false>(attr.type, attr.buf, si, active);
+        return interpolate_attribute<1, false>(attr, si, active);
     else if (attr.size == 3) {
-        auto result = interpolate_attribute<3, false>(attr.type, attr.buf, si, active);
+        auto result = interpolate_attribute<3, false>(attr, si, active);
         if constexpr (is_monochromatic_v<Spectrum>)
             return luminance(result);
         else
@@ -975,7 +1531,7 @@ Mesh<Float, Spectrum>::eval_attribute_1(const std::string& name,
 
     const auto& attr = it->second;
     if (attr.size == 1) {
-        return interpolate_attribute<1, true>(attr.type, attr.buf, si, active);
+        return interpolate_attribute<1, true>(attr, si, active);
     } else {
         if constexpr (dr::is_jit_v<Float>)
             return 0.f;
@@ -994,7 +1550,7 @@ Mesh<Float, Spectrum>::eval_attribute_3(const std::string& name,
 
     const auto& attr = it->second;
     if (attr.size == 3) {
-        return interpolate_attribute<3, true>(attr.type, attr.buf, si, active);
+        return interpolate_attribute<3, true>(attr, si, active);
     } else {
         if constexpr (dr::is_jit_v<Float>)
             return 0.f;
@@ -1071,6 +1627,13 @@ Mesh<Float, Spectrum>::bbox(ScalarIndex index, const ScalarBoundingBox3f &clip)
     Assert(fi[1] < m_vertex_count);
     Assert(fi[2] < m_vertex_count);
 
+    // Conservatively bound moving triangles over their whole motion
+    if (has_vertex_motion()) {
+        ScalarBoundingBox3f result = bbox(index);
+        result.clip(clip);
+        return result;
+    }
+
     ScalarPoint3f v0 = vertex_position(fi[0]),
                   v1 = vertex_position(fi[1]),
                   v2 = vertex_position(fi[2]);
@@ -1104,6 +1667,387 @@ Mesh<Float, Spectrum>::bbox(ScalarIndex index, const ScalarBoundingBox3f &clip)
     return result;
 }
 
+/// Header of the native storage file written by \ref Mesh::write_storage()
+struct MeshStorageHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertex_count;
+    uint32_t face_count;
+    uint32_t attribute_count;
+    uint32_t reserved;
+    float bbox_min[3];
+    float bbox_max[3];
+    uint64_t vertex_positions;
+    uint64_t vertex_normals;
+    uint64_t vertex_texcoords;
+    uint64_t faces;
+};
+
+/// Descriptor of a mesh attribute, stored after the \ref MeshStorageHeader
+struct MeshStorageAttribute {
+    char name[64];
+    uint32_t type;
+    uint32_t size;
+    uint64_t offset;
+};
+
+static constexpr uint32_t MeshStorageVersion = 1;
+
+MI_VARIANT ref<MemoryMappedFile>
+Mesh<Float, Spectrum>::write_storage(const fs::path &filename) const {
+    /* Every buffer starts on a cache line and is followed by some padding,
+       since Embree reads vertex data using 16 byte loads */
+    auto align = [](size_t value) { return (value + 63) & ~(size_t) 63; };
+    size_t size = align(sizeof(MeshStorageHeader) +
+                        m_mesh_attributes.size() * sizeof(MeshStorageAttribute));
+    auto reserve = [&](size_t bytes) -> uint64_t {
+        if (bytes == 0)
+            return 0;
+        uint64_t offset = size;
+        size = align(size + bytes + 16);
+        return offset;
+    };
+
+    MeshStorageHeader header;
+    memcpy(header.magic, "MIMS", 4);
+    header.version          = MeshStorageVersion;
+    header.vertex_count     = m_vertex_count;
+    header.face_count       = m_face_count;
+    header.attribute_count  = (uint32_t) m_mesh_attributes.size();
+    header.reserved         = 0;
+    for (size_t i = 0; i < 3; ++i) {
+        header.bbox_min[i] = (float) m_bbox.min[i];
+        header.bbox_max[i] = (float) m_bbox.max[i];
+    }
+    header.vertex_positions = reserve(m_vertex_positions.size() * sizeof(InputFloat));
+    header.vertex_normals   = reserve(m_vertex_normals.size() * sizeof(InputFloat));
+    header.vertex_texcoords = reserve(m_vertex_texcoords.size() * sizeof(InputFloat));
+    header.faces            = reserve(m_faces.size() * sizeof(ScalarIndex));
+
+    std::vector<MeshStorageAttribute> attributes;
+    std::vector<FloatStorage> attribute_values;
+    for (const auto &[name, attribute] : m_mesh_attributes) {
+        MeshStorageAttribute desc;
+        if (name.size() >= sizeof(desc.name))
+            Throw("write_storage(): attribute name \"%s\" is too long!", name);
+        memset(desc.name, 0, sizeof(desc.name));
+        memcpy(desc.name, name.data(), name.size());
+        desc.type   = (uint32_t) attribute.type;
+        desc.size   = (uint32_t) attribute.size;
+        desc.offset = reserve(attribute.value_count() * sizeof(InputFloat));
+        attributes.push_back(desc);
+        attribute_values.push_back(attribute.values());
+    }
+
+    ref<MemoryMappedFile> mmap =
+        filename.empty() ? MemoryMappedFile::create_temporary(size)
+                         : new MemoryMappedFile(filename, size);
+    uint8_t *data = (uint8_t *) mmap->data();
+    memset(data, 0, size);
+
+    memcpy(data, &header, sizeof(MeshStorageHeader));
+    if (!attributes.empty())
+        memcpy(data + sizeof(MeshStorageHeader), attributes.data(),
+               attributes.size() * sizeof(MeshStorageAttribute));
+
+    auto write = [data](const auto &buf, uint64_t offset) {
+        using Buffer = std::decay_t<decltype(buf)>;
+        if (offset == 0)
+            return;
+        auto &&host = dr::migrate(buf, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        memcpy(data + offset, host.data(),
+               buf.size() * sizeof(dr::scalar_t<Buffer>));
+    };
+
+    write(m_vertex_positions, header.vertex_positions);
+    write(m_vertex_normals, header.vertex_normals);
+    write(m_vertex_texcoords, header.vertex_texcoords);
+    write(m_faces, header.faces);
+
+    for (size_t i = 0; i < attributes.size(); ++i)
+        write(attribute_values[i], attributes[i].offset);
+
+    return mmap;
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::read_storage(MemoryMappedFile *mmap) {
+    const uint8_t *data = (const uint8_t *) mmap->data();
+    size_t size = mmap->size();
+
+    auto fail = [&](const char *descr) {
+        Throw("Error while reading mesh storage file \"%s\": %s!",
+              mmap->filename().string(), descr);
+    };
+
+    MeshStorageHeader header;
+    if (size < sizeof(MeshStorageHeader))
+        fail("file is truncated");
+    memcpy(&header, data, sizeof(MeshStorageHeader));
+    if (memcmp(header.magic, "MIMS", 4) != 0)
+        fail("invalid file format");
+    if (header.version != MeshStorageVersion)
+        fail("incompatible version");
+
+    size_t attributes_end = sizeof(MeshStorageHeader) +
+                            (size_t) header.attribute_count * sizeof(MeshStorageAttribute);
+    if (attributes_end > size)
+        fail("file is truncated");
+
+    /* Scalar variants reference the mapped memory, JIT variants copy it.
+       Empty buffers are stored with an offset of zero. */
+    auto read = [&](auto &buf, uint64_t offset, size_t count) {
+        using Buffer = std::decay_t<decltype(buf)>;
+        using Value = dr::scalar_t<Buffer>;
+        if (offset == 0 || count == 0) {
+            buf = Buffer();
+            return;
+        }
+        if (offset % 64 != 0 || offset + count * sizeof(Value) > size)
+            fail("invalid buffer offset");
+        void *ptr = (void *) (data + offset);
+        if constexpr (dr::is_jit_v<Float>)
+            buf = dr::load<Buffer>(ptr, count);
+        else
+            buf = Buffer::map_(ptr, count);
+    };
+
+    m_vertex_count = header.vertex_count;
+    m_face_count = header.face_count;
+    for (size_t i = 0; i < 3; ++i) {
+        m_bbox.min[i] = header.bbox_min[i];
+        m_bbox.max[i] = header.bbox_max[i];
+    }
+
+    size_t vertex_data = (size_t) m_vertex_count;
+    read(m_vertex_positions, header.vertex_positions, vertex_data * 3);
+    read(m_vertex_normals, header.vertex_normals, header.vertex_normals ? vertex_data * 3 : 0);
+    read(m_vertex_texcoords, header.vertex_texcoords, header.vertex_texcoords ? vertex_data * 2 : 0);
+    read(m_faces, header.faces, (size_t) m_face_count * 3);
+
+    m_mesh_attributes.clear();
+    for (uint32_t i = 0; i < header.attribute_count; ++i) {
+        MeshStorageAttribute desc;
+        memcpy(&desc, data + sizeof(MeshStorageHeader) + i * sizeof(MeshStorageAttribute),
+               sizeof(MeshStorageAttribute));
+        desc.name[sizeof(desc.name) - 1] = '\0';
+
+        MeshAttributeType type = (MeshAttributeType) desc.type;
+        size_t count = desc.size * (type == MeshAttributeType::Vertex
+                                        ? (size_t) m_vertex_count
+                                        : (size_t) m_face_count);
+        MeshAttribute attribute { desc.size, type, FloatStorage() };
+        read(attribute.buf, desc.offset, count);
+        m_mesh_attributes.insert({ std::string(desc.name), attribute });
+    }
+
+    if constexpr (!dr::is_jit_v<Float>) {
+        m_mmap = mmap;
+#if defined(MI_ENABLE_LLVM) && !defined(MI_ENABLE_EMBREE)
+        m_vertex_positions_ptr = m_vertex_positions.data();
+        m_faces_ptr = m_faces.data();
+#endif
+    }
+
+    // The buffers are no longer shared with other instances
+    m_asset = nullptr;
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::move_to_mmap(const fs::path &filename) {
+    if constexpr (dr::is_jit_v<Float>) {
+        DRJIT_MARK_USED(filename);
+        Throw("move_to_mmap(): memory-mapped storage is only supported in "
+              "scalar variants!");
+    } else {
+        Timer timer;
+        ref<MemoryMappedFile> mmap = write_storage(filename);
+        read_storage(mmap);
+
+        Log(Debug, "\"%s\": moved %s of mesh data into %s (took %s)", m_name,
+            util::mem_string(mmap->size()), mmap->filename(),
+            util::time_string((float) timer.value()));
+    }
+}
+
+MI_VARIANT bool Mesh<Float, Spectrum>::cache_load(const fs::path &source,
+                                                  const std::string &key) {
+    m_cache_file = fs::path();
+    if (!m_cache)
+        return false;
+
+    Timer timer;
+
+    /* The cache key covers the file contents and every parameter that
+       affects the loaded buffers */
+    uint64_t hash;
+    {
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(source);
+        hash = hash_bytes(mmap->data(), mmap->size());
+    }
+    ScalarMatrix4f to_world = m_to_world.scalar().matrix;
+    hash = hash_bytes(&to_world, sizeof(ScalarMatrix4f), hash);
+    hash = hash_bytes(key.data(), key.size(), hash);
+    uint8_t flags[2] = { (uint8_t) m_face_normals, (uint8_t) m_flip_normals };
+    hash = hash_bytes(flags, sizeof(flags), hash);
+
+    fs::path dir = m_cache_dir.empty() ? source.parent_path() : m_cache_dir;
+    m_cache_file = dir / fs::path(tfm::format("%s.%016llx.mimesh",
+                                              source.filename().string(),
+                                              (unsigned long long) hash));
+
+    if (!fs::exists(m_cache_file))
+        return false;
+
+    try {
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(m_cache_file);
+        read_storage(mmap);
+    } catch (const std::exception &e) {
+        Log(Warn, "\"%s\": ignoring invalid mesh cache entry: %s", m_name, e.what());
+        return false;
+    }
+
+    Log(Debug, "\"%s\": loaded %i faces, %i vertices from the mesh cache (took %s)",
+        m_name, m_face_count, m_vertex_count,
+        util::time_string((float) timer.value()));
+
+    // The cache entry is up to date, there is no need to store it again
+    m_cache_file = fs::path();
+    return true;
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::cache_store() {
+    if (m_cache_file.empty())
+        return;
+
+    try {
+        if (!m_cache_dir.empty() && !fs::exists(m_cache_dir))
+            fs::create_directory(m_cache_dir);
+
+        /* Processes concurrently loading the same asset never observe a
+           partially written entry */
+        ref<MemoryMappedFile> mmap;
+        fs::write_atomic(m_cache_file, [&](const fs::path &tmp_file) {
+            mmap = write_storage(tmp_file);
+        });
+
+        /* Scalar variants directly use the written buffers, just like on
+           subsequent runs. The mapping remains valid after the rename. */
+        if constexpr (!dr::is_jit_v<Float>)
+            read_storage(mmap);
+
+        Log(Debug, "\"%s\": stored mesh cache entry \"%s\"", m_name,
+            m_cache_file.string());
+    } catch (const std::exception &e) {
+        Log(Warn, "\"%s\": could not store mesh cache entry: %s", m_name, e.what());
+    }
+
+    m_cache_file = fs::path();
+}
+
+MI_VARIANT struct Mesh<Float, Spectrum>::MeshAsset : Object {
+    ScalarSize vertex_count = 0;
+    ScalarSize face_count = 0;
+    ScalarBoundingBox3f bbox;
+    FloatStorage vertex_positions;
+    FloatStorage vertex_normals;
+    FloatStorage vertex_texcoords;
+    DynamicBuffer<UInt32> faces;
+    std::unordered_map<std::string, MeshAttribute> mesh_attributes;
+    /// Mapping backing the buffers of scalar variants (if any)
+    ref<MemoryMappedFile> mmap;
+};
+
+MI_VARIANT bool Mesh<Float, Spectrum>::asset_load(const fs::path &source,
+                                                  const std::string &key) {
+    ScalarMatrix4f to_world = m_to_world.scalar().matrix;
+    std::string id = tfm::format(
+        "mesh:%s:%s:%i:%i:%i:%i:%s:%016llx", detail::get_variant<Float, Spectrum>(),
+        key, (int) m_face_normals, (int) m_flip_normals, (int) m_cache,
+        (int) m_attribute_precision,
+        m_cache_dir.string(),
+        (unsigned long long) hash_bytes(&to_world, sizeof(ScalarMatrix4f)));
+
+    ref<Object> asset = AssetCache::get(source, id, m_asset_ticket);
+    if (!asset)
+        return false;
+
+    share_asset((const MeshAsset *) asset.get());
+    Log(Debug, "\"%s\": sharing %i faces, %i vertices with another instance",
+        m_name, m_face_count, m_vertex_count);
+    return true;
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::asset_store() {
+    if (!m_asset_ticket)
+        return;
+
+    ref<MeshAsset> asset = new MeshAsset();
+    asset->vertex_count = m_vertex_count;
+    asset->face_count = m_face_count;
+    asset->bbox = m_bbox;
+    asset->vertex_positions = std::move(m_vertex_positions);
+    asset->vertex_normals = std::move(m_vertex_normals);
+    asset->vertex_texcoords = std::move(m_vertex_texcoords);
+    asset->faces = std::move(m_faces);
+    asset->mesh_attributes = std::move(m_mesh_attributes);
+    asset->mmap = m_mmap;
+
+    share_asset(asset);
+    AssetCache::put(m_asset_ticket, asset);
+}
+
+MI_VARIANT void Mesh<Float, Spectrum>::share_asset(const MeshAsset *asset) {
+    /* JIT variants reference the same arrays, while scalar variants
+       create views of the buffers owned by the entry */
+    auto share = [](auto &buf, const auto &source) {
+        using Buffer = std::decay_t<decltype(buf)>;
+        if constexpr (dr::is_jit_v<Float>)
+            buf = source;
+        else if (source.size() == 0)
+            buf = Buffer();
+        else
+            buf = Buffer::map_((void *) source.data(), source.size());
+    };
+
+    m_vertex_count = asset->vertex_count;
+    m_face_count = asset->face_count;
+    m_bbox = asset->bbox;
+    share(m_vertex_positions, asset->vertex_positions);
+    share(m_vertex_normals, asset->vertex_normals);
+    share(m_vertex_texcoords, asset->vertex_texcoords);
+    share(m_faces, asset->faces);
+
+    m_mesh_attributes.clear();
+    for (const auto &[name, attribute] : asset->mesh_attributes) {
+        MeshAttribute copy { attribute.size, attribute.type, FloatStorage() };
+        share(copy.buf, attribute.buf);
+        copy.precision = attribute.precision;
+        copy.packed = attribute.packed;
+        m_mesh_attributes.insert({ name, copy });
+    }
+
+    m_mmap = asset->mmap;
+    m_asset = const_cast<MeshAsset *>(asset);
+}
+
+MI_VARIANT size_t Mesh<Float, Spectrum>::memory_footprint() const {
+    size_t result = (m_area_pmf.pmf().size() + m_area_pmf.cdf().size() +
+                     m_area_pmf.alias_probability().size()) *
+                        sizeof(ScalarFloat) +
+                    m_area_pmf.alias_index().size() * sizeof(uint32_t);
+    if (m_mmap)
+        return result;
+
+    size_t floats = m_vertex_positions.size() + m_vertex_positions_end.size() +
+                    m_vertex_normals.size() + m_vertex_texcoords.size();
+    for (const auto &[name, attribute] : m_mesh_attributes)
+        result += attribute.nbytes();
+
+    return result + floats * sizeof(InputFloat) +
+           m_faces.size() * sizeof(ScalarIndex);
+}
+
 MI_VARIANT std::string Mesh<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
     oss << class_()->name() << "[" << std::endl
@@ -1117,6 +2061,9 @@ MI_VARIANT std::string Mesh<Float, Spectrum>::to_string() const {
     if (!m_area_pmf.empty())
         oss << "  surface_area = " << m_area_pmf.sum() << "," << std::endl;
 
+    if (m_mmap)
+        oss << "  storage = " << m_mmap->filename() << "," << std::endl;
+
     oss << "  face_normals = " << m_face_normals;
 
     if (!m_mesh_attributes.empty()) {
@@ -1125,6 +2072,8 @@ MI_VARIANT std::string Mesh<Float, Spectrum>::to_string() const {
         for(const auto &[name, attribute]: m_mesh_attributes)
             oss << "    " << name << ": " << attribute.size
                 << (attribute.size == 1 ? " float" : " floats")
+                << (attribute.precision != StoragePrecision::Float
+                        ? tfm::format(" (%s)", attribute.precision) : std::string())
                 << (++i == m_mesh_attributes.size() ? "" : ",") << std::endl;
         oss << "  ]" << std::endl;
     } else {
@@ -1144,8 +2093,8 @@ MI_VARIANT size_t Mesh<Float, Spectrum>::vertex_data_bytes() const {
         vertex_data_bytes += 2 * sizeof(InputFloat);
 
     for (const auto&[name, attribute]: m_mesh_attributes)
-        if (attribute.type == MeshAttributeType::Vertex)
-            vertex_data_bytes += attribute.size * sizeof(InputFloat);
+        if (attribute.type == MeshAttributeType::Vertex && m_vertex_count > 0)
+            vertex_data_bytes += attribute.nbytes() / m_vertex_count;
 
     return vertex_data_bytes;
 }
@@ -1154,8 +2103,8 @@ MI_VARIANT size_t Mesh<Float, Spectrum>::face_data_bytes() const {
     size_t face_data_bytes = 3 * sizeof(ScalarIndex);
 
     for (const auto&[name, attribute]: m_mesh_attributes)
-        if (attribute.type == MeshAttributeType::Face)
-            face_data_bytes += attribute.size * sizeof(InputFloat);
+        if (attribute.type == MeshAttributeType::Face && m_face_count > 0)
+            face_data_bytes += attribute.nbytes() / m_face_count;
 
     return face_data_bytes;
 }
@@ -1167,6 +2116,16 @@ MI_VARIANT RTCGeometry Mesh<Float, Spectrum>::embree_geometry(RTCDevice device)
     rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3,
                                m_vertex_positions.data(), 0, 3 * sizeof(InputFloat),
                                m_vertex_count);
+
+    /* Embree interpolates the vertices of moving meshes between the time
+       steps, using the time of the ray in [0, 1] */
+    if (has_vertex_motion()) {
+        rtcSetGeometryTimeStepCount(geom, 2);
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 1, RTC_FORMAT_FLOAT3,
+                                   m_vertex_positions_end.data(), 0,
+                                   3 * sizeof(InputFloat), m_vertex_count);
+    }
+
     rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_INDEX, 0, RTC_FORMAT_UINT3,
                                m_faces.data(), 0, 3 * sizeof(ScalarIndex),
                                m_face_count);
@@ -1174,6 +2133,23 @@ MI_VARIANT RTCGeometry Mesh<Float, Spectrum>::embree_geometry(RTCDevice device)
     rtcCommitGeometry(geom);
     return geom;
 }
+
+MI_VARIANT void Mesh<Float, Spectrum>::embree_update_geometry(RTCGeometry geom) {
+    /* The vertex positions may have been moved to a new buffer, the topology
+       is guaranteed to be unchanged */
+    rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT3,
+                               m_vertex_positions.data(), 0, 3 * sizeof(InputFloat),
+                               m_vertex_count);
+    rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0);
+    if (has_vertex_motion()) {
+        rtcSetGeometryTimeStepCount(geom, 2);
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 1, RTC_FORMAT_FLOAT3,
+                                   m_vertex_positions_end.data(), 0,
+                                   3 * sizeof(InputFloat), m_vertex_count);
+        rtcUpdateGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 1);
+    }
+    rtcCommitGeometry(geom);
+}
 #endif
 
 #if defined(MI_ENABLE_CUDA)
@@ -1182,12 +2158,19 @@ static const uint32_t triangle_input_flags = OPTIX_GEOMETRY_FLAG_DISABLE_ANYHIT;
 MI_VARIANT void Mesh<Float, Spectrum>::optix_prepare_geometry() { }
 
 MI_VARIANT void Mesh<Float, Spectrum>::optix_build_input(OptixBuildInput &build_input) const {
-    m_vertex_buffer_ptr = (void*) m_vertex_positions.data(); // triggers dr::eval()
+    m_vertex_buffer_ptr[0] = (void*) m_vertex_positions.data(); // triggers dr::eval()
+
+    /* One buffer per motion key. Static meshes repeat their positions, so
+       that they can be part of a GAS that is built with two motion keys. */
+    m_vertex_buffer_ptr[1] = has_vertex_motion()
+                                 ? (void*) m_vertex_positions_end.data()
+                                 : m_vertex_buffer_ptr[0];
+
     build_input.type                           = OPTIX_BUILD_INPUT_TYPE_TRIANGLES;
     build_input.triangleArray.vertexFormat     = OPTIX_VERTEX_FORMAT_FLOAT3;
     build_input.triangleArray.indexFormat      = OPTIX_INDICES_FORMAT_UNSIGNED_INT3;
     build_input.triangleArray.numVertices      = m_vertex_count;
-    build_input.triangleArray.vertexBuffers    = (CUdeviceptr*) &m_vertex_buffer_ptr;
+    build_input.triangleArray.vertexBuffers    = (CUdeviceptr*) m_vertex_buffer_ptr;
     build_input.triangleArray.numIndexTriplets = m_face_count;
     build_input.triangleArray.indexBuffer      = (CUdeviceptr) m_faces.data();
     build_input.triangleArray.flags            = &triangle_input_flags;
@@ -1,7 +1,155 @@
 #include <mitsuba/render/microfacet.h>
+#include <future>
+#include <map>
+#include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
 MI_INSTANTIATE_CLASS(MicrofacetDistribution)
 
+/**
+ * \brief Thread-safe cache of lazily computed tables
+ *
+ * Only the first request for a key computes the table. Concurrent requests
+ * for the same key wait for the result, while other keys are not blocked.
+ */
+template <typename Key, typename Value> class TableCache {
+public:
+    using Entry = std::shared_future<std::shared_ptr<const Value>>;
+
+    template <typename Func>
+    std::shared_ptr<const Value> get(const Key &key, Func &&func) {
+        std::promise<std::shared_ptr<const Value>> promise;
+        Entry entry;
+        bool compute = false;
+
+        {
+            std::lock_guard<std::mutex> guard(m_mutex);
+            auto it = m_entries.find(key);
+            if (it == m_entries.end()) {
+                entry = promise.get_future().share();
+                m_entries.emplace(key, entry);
+                compute = true;
+            } else {
+                entry = it->second;
+            }
+        }
+
+        if (compute) {
+            try {
+                promise.set_value(std::make_shared<const Value>(func()));
+            } catch (...) {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_entries.erase(key);
+                }
+                promise.set_exception(std::current_exception());
+            }
+        }
+
+        return entry.get();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::map<Key, Entry> m_entries;
+};
+
+template <typename ScalarFloat>
+std::shared_ptr<const MicrofacetCoatingTables<ScalarFloat>>
+microfacet_coating_tables(MicrofacetType type, ScalarFloat alpha,
+                          ScalarFloat eta, uint32_t res) {
+    using Key = std::tuple<MicrofacetType, ScalarFloat, ScalarFloat, uint32_t>;
+    static TableCache<Key, MicrofacetCoatingTables<ScalarFloat>> cache;
+
+    return cache.get(Key(type, alpha, eta, res), [&]() {
+        using FloatX = dr::DynamicArray<ScalarFloat>;
+        using Vector3fX = Vector<FloatX, 3>;
+        using FloatP = dr::Packet<ScalarFloat>;
+
+        mitsuba::MicrofacetDistribution<FloatP, Color<ScalarFloat, 3>> distr(type, alpha);
+        FloatX mu = dr::maximum(1e-6f, dr::linspace<FloatX>(0, 1, res));
+        FloatX zero = dr::zeros<FloatX>(res);
+
+        Vector3fX wi = Vector3fX(dr::sqrt(1 - mu * mu), zero, mu);
+
+        FloatX transmittance = eval_transmittance(distr, wi, eta);
+
+        MicrofacetCoatingTables<ScalarFloat> tables;
+        tables.external_transmittance.assign(
+            transmittance.data(), transmittance.data() + dr::width(transmittance));
+        tables.internal_reflectance = (ScalarFloat) dr::slice(
+            dr::mean(eval_reflectance(distr, wi, 1.f / eta) * wi.z())) * 2.f;
+        return tables;
+    });
+}
+
+template <typename ScalarFloat>
+std::shared_ptr<const std::vector<ScalarFloat>>
+microfacet_albedo_table(MicrofacetType type, uint32_t res) {
+    using Key = std::pair<MicrofacetType, uint32_t>;
+    static TableCache<Key, std::vector<ScalarFloat>> cache;
+
+    if (res < 2)
+        Throw("microfacet_albedo_table(): the resolution must be at least 2!");
+
+    return cache.get(Key(type, res), [&]() {
+        using FloatX = dr::DynamicArray<ScalarFloat>;
+        using FloatP = dr::Packet<ScalarFloat>;
+        using Vector3fP = Vector<FloatP, 3>;
+        using Normal3fP = Normal<FloatP, 3>;
+        using ScalarVector2f = Vector<ScalarFloat, 2>;
+
+        auto [nodes, weights] = quad::gauss_legendre<FloatX>(32);
+        auto [nodes_x, nodes_y]     = dr::meshgrid(nodes, nodes);
+        auto [weights_x, weights_y] = dr::meshgrid(weights, weights);
+
+        std::vector<ScalarFloat> table(res * res);
+        ScalarFloat scale = 1.f / (res - 1);
+
+        for (uint32_t i = 0; i < res; ++i) {
+            // The distribution degenerates to a mirror as the roughness goes to zero
+            ScalarFloat alpha = dr::maximum(i * scale, ScalarFloat(1e-3f));
+            mitsuba::MicrofacetDistribution<FloatP, Color<ScalarFloat, 3>> distr(type, alpha);
+
+            for (uint32_t j = 0; j < res; j += (uint32_t) FloatP::Size) {
+                FloatP mu = dr::clamp((dr::arange<FloatP>() + (ScalarFloat) j) * scale,
+                                      ScalarFloat(1e-6f), ScalarFloat(1.f));
+                Vector3fP wi(dr::sqrt(1.f - mu * mu), 0.f, mu);
+
+                // Integrate the masking of the sampled reflections (F = 1)
+                FloatP result = 0.f;
+                for (size_t k = 0; k < dr::width(nodes_x); ++k) {
+                    ScalarVector2f node = { nodes_x[k], nodes_y[k] };
+                    ScalarVector2f weight = { weights_x[k], weights_y[k] };
+                    node = dr::fmadd(node, 0.5f, 0.5f);
+
+                    Normal3fP m = std::get<0>(distr.sample(wi, node));
+                    Vector3fP wo = reflect(wi, m);
+                    FloatP smith = distr.smith_g1(wo, m);
+                    dr::masked(smith, wo.z() <= 0.f) = 0.f;
+                    result += smith * dr::prod(weight) * 0.25f;
+                }
+
+                ScalarFloat values[FloatP::Size];
+                dr::store(values, result);
+                for (uint32_t l = 0; l < FloatP::Size && j + l < res; ++l)
+                    table[i * res + j + l] = std::min(values[l], ScalarFloat(1.f));
+            }
+        }
+
+        return table;
+    });
+}
+
+template MI_EXPORT_LIB std::shared_ptr<const MicrofacetCoatingTables<float>>
+microfacet_coating_tables<float>(MicrofacetType, float, float, uint32_t);
+template MI_EXPORT_LIB std::shared_ptr<const MicrofacetCoatingTables<double>>
+microfacet_coating_tables<double>(MicrofacetType, double, double, uint32_t);
+
+template MI_EXPORT_LIB std::shared_ptr<const std::vector<float>>
+microfacet_albedo_table<float>(MicrofacetType, uint32_t);
+template MI_EXPORT_LIB std::shared_ptr<const std::vector<double>>
+microfacet_albedo_table<double>(MicrofacetType, uint32_t);
+
 NAMESPACE_END(mitsuba)
@@ -1,6 +1,9 @@
 #if defined(MI_ENABLE_CUDA)
 
+#include <mitsuba/mitsuba.h>
 #include <mitsuba/core/logger.h>
+#include <cstdlib>
+#include <cstring>
 
 #include <drjit-core/optix.h>
 #define OPTIX_API_IMPL
@@ -9,6 +12,43 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Set up the on-disk cache of compiled OptiX modules (see \ref optix_initialize())
+static void optix_configure_cache() {
+    OptixDeviceContext context = jit_optix_context();
+
+    const char *enabled = std::getenv("MI_OPTIX_CACHE");
+    if (enabled && std::strcmp(enabled, "0") == 0) {
+        optixDeviceContextSetCacheEnabled(context, 0);
+        Log(Debug, "OptiX module cache disabled.");
+        return;
+    }
+
+    std::string location;
+    if (const char *dir = std::getenv("MI_OPTIX_CACHE_DIR")) {
+        location = dir;
+    } else {
+#if defined(_WIN32)
+        const char *home = std::getenv("LOCALAPPDATA");
+#else
+        const char *home = std::getenv("HOME");
+#endif
+        // Keep the default location of OptiX if there is no home directory
+        if (!home)
+            return;
+        location = std::string(home) + "/.cache/mitsuba/optix-" MI_VERSION;
+    }
+
+    /* The cache is keyed by the driver and OptiX versions and by the compile
+       options, so entries of different configurations can share a location */
+    if (optixDeviceContextSetCacheLocation(context, location.c_str()) != 0 ||
+        optixDeviceContextSetCacheEnabled(context, 1) != 0) {
+        Log(Warn, "Could not use \"%s\" as the OptiX module cache, the "
+                  "modules will be compiled again by every process.", location);
+        return;
+    }
+    Log(Debug, "OptiX module cache: \"%s\"", location);
+}
+
 void optix_initialize() {
     if (optixAccelBuild)
         return;
@@ -32,8 +72,13 @@ void optix_initialize() {
     L(optixTaskExecute);
     L(optixProgramGroupCreate);
     L(optixSbtRecordPackHeader);
+    L(optixDeviceContextSetCacheEnabled);
+    L(optixDeviceContextSetCacheLocation);
+    L(optixDeviceContextSetCacheDatabaseSizes);
 
     #undef L
+
+    optix_configure_cache();
 }
 
 scoped_optix_context::scoped_optix_context() {
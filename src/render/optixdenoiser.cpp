@@ -16,8 +16,21 @@ static OptixImage2D optixImage2DfromTensor(
              pixel_format };
 }
 
+/// Restrict an image to the window of size \c w x \c h starting at pixel (\c x, \c y)
+static OptixImage2D optixImage2DCrop(OptixImage2D image, uint32_t x, uint32_t y,
+                                     uint32_t w, uint32_t h) {
+    if (image.data)
+        image.data = (CUdeviceptr) ((uint8_t *) image.data +
+                                    y * image.rowStrideInBytes +
+                                    x * image.pixelStrideInBytes);
+    image.width = w;
+    image.height = h;
+    return image;
+}
+
 MI_VARIANT OptixDenoiser<Float, Spectrum>::OptixDenoiser(
-    const ScalarVector2u &input_size, bool albedo, bool normals, bool temporal)
+    const ScalarVector2u &input_size, bool albedo, bool normals, bool temporal,
+    const ScalarVector2u &tile_size)
     : m_input_size(input_size), m_options({ albedo, normals }),
       m_temporal(temporal) {
     if constexpr (!dr::is_cuda_v<Float>)
@@ -38,17 +51,33 @@ MI_VARIANT OptixDenoiser<Float, Spectrum>::OptixDenoiser(
     jit_optix_check(
         optixDenoiserCreate(context, model_kind, &m_options, &m_denoiser));
 
+    // A zero tile size denoises the whole image at once
+    m_tile_size = input_size;
+    if (tile_size.x() > 0 && tile_size.y() > 0)
+        m_tile_size = dr::minimum(tile_size, input_size);
+    m_tiled = dr::any(m_tile_size < input_size);
+
     OptixDenoiserSizes sizes = {};
     jit_optix_check(optixDenoiserComputeMemoryResources(
-        m_denoiser, input_size.x(), input_size.y(), &sizes));
+        m_denoiser, m_tile_size.x(), m_tile_size.y(), &sizes));
+
+    /* Tiles are extended by an overlapping window of neighboring pixels on
+       every side, such that the seams between tiles aren't visible */
+    ScalarVector2u setup_size = input_size;
+    m_overlap = 0;
+    m_scratch_size = (uint32_t) sizes.withoutOverlapScratchSizeInBytes;
+    if (m_tiled) {
+        m_overlap = sizes.overlapWindowSizeInPixels;
+        setup_size = dr::minimum(m_tile_size + 2 * m_overlap, input_size);
+        m_scratch_size = (uint32_t) sizes.withOverlapScratchSizeInBytes;
+    }
 
     CUstream stream = jit_cuda_stream();
     m_state_size = (uint32_t) sizes.stateSizeInBytes;
     m_state = jit_malloc(AllocType::Device, m_state_size);
-    m_scratch_size = (uint32_t) sizes.withoutOverlapScratchSizeInBytes;
     m_scratch = jit_malloc(AllocType::Device, m_scratch_size);
-    jit_optix_check(optixDenoiserSetup(m_denoiser, stream, input_size.x(),
-                                       input_size.y(), m_state, m_state_size,
+    jit_optix_check(optixDenoiserSetup(m_denoiser, stream, setup_size.x(),
+                                       setup_size.y(), m_state, m_state_size,
                                        m_scratch, m_scratch_size));
     m_hdr_intensity = jit_malloc(AllocType::Device, sizeof(float));
 }
@@ -91,9 +120,21 @@ OptixDenoiser<Float, Spectrum>::operator()(
     params.hdrAverageColor = nullptr;
     params.denoiseAlpha = denoise_alpha;
     params.hdrIntensity = m_hdr_intensity;
+
+    /* The intensity is computed over the entire image, whose scratch memory
+       requirements can exceed the ones of a single tile */
+    size_t intensity_scratch_size =
+        sizeof(int) * (2 + (size_t) m_input_size.x() * m_input_size.y());
+    CUdeviceptr intensity_scratch = m_scratch;
+    if (intensity_scratch_size > m_scratch_size)
+        intensity_scratch = jit_malloc(AllocType::Device, intensity_scratch_size);
+    else
+        intensity_scratch_size = m_scratch_size;
     jit_optix_check(optixDenoiserComputeIntensity(
-        m_denoiser, stream, &layers.input, m_hdr_intensity, m_scratch,
-        m_scratch_size));
+        m_denoiser, stream, &layers.input, m_hdr_intensity, intensity_scratch,
+        intensity_scratch_size));
+    if (intensity_scratch != m_scratch)
+        jit_free(intensity_scratch);
 
     dr::schedule(noisy);
 
@@ -142,9 +183,45 @@ OptixDenoiser<Float, Spectrum>::operator()(
             previous_denoised, input_pixel_format);
     }
 
-    jit_optix_check(optixDenoiserInvoke(m_denoiser, stream, &params, m_state,
-                                        m_state_size, &guide_layer, &layers, 1,
-                                        0, 0, m_scratch, m_scratch_size));
+    if (!m_tiled) {
+        jit_optix_check(optixDenoiserInvoke(m_denoiser, stream, &params, m_state,
+                                            m_state_size, &guide_layer, &layers, 1,
+                                            0, 0, m_scratch, m_scratch_size));
+    } else {
+        uint32_t width = m_input_size.x(), height = m_input_size.y();
+        for (uint32_t y = 0; y < height; y += m_tile_size.y()) {
+            for (uint32_t x = 0; x < width; x += m_tile_size.x()) {
+                uint32_t w = std::min(m_tile_size.x(), width - x),
+                         h = std::min(m_tile_size.y(), height - y);
+
+                // Input window: the tile and its overlap inside the image
+                uint32_t x0 = x > m_overlap ? x - m_overlap : 0,
+                         y0 = y > m_overlap ? y - m_overlap : 0,
+                         x1 = std::min(x + w + m_overlap, width),
+                         y1 = std::min(y + h + m_overlap, height);
+
+                OptixDenoiserLayer tile_layers = {};
+                tile_layers.input =
+                    optixImage2DCrop(layers.input, x0, y0, x1 - x0, y1 - y0);
+                tile_layers.previousOutput = optixImage2DCrop(
+                    layers.previousOutput, x0, y0, x1 - x0, y1 - y0);
+                tile_layers.output = optixImage2DCrop(layers.output, x, y, w, h);
+
+                OptixDenoiserGuideLayer tile_guide_layer = {};
+                tile_guide_layer.albedo = optixImage2DCrop(
+                    guide_layer.albedo, x0, y0, x1 - x0, y1 - y0);
+                tile_guide_layer.normal = optixImage2DCrop(
+                    guide_layer.normal, x0, y0, x1 - x0, y1 - y0);
+                tile_guide_layer.flow = optixImage2DCrop(
+                    guide_layer.flow, x0, y0, x1 - x0, y1 - y0);
+
+                jit_optix_check(optixDenoiserInvoke(
+                    m_denoiser, stream, &params, m_state, m_state_size,
+                    &tile_guide_layer, &tile_layers, 1, x - x0, y - y0,
+                    m_scratch, m_scratch_size));
+            }
+        }
+    }
 
     size_t shape[3] = { noisy.shape(0), noisy.shape(1), noisy.shape(2) };
     return TensorXf(std::move(output_data), 3, shape);
@@ -270,7 +347,8 @@ std::string OptixDenoiser<Float, Spectrum>::to_string() const {
         << "  input_size = " << m_input_size << "," << std::endl
         << "  albedo = " << m_options.guideAlbedo << "," << std::endl
         << "  normals = " << m_options.guideNormal << "," << std::endl
-        << "  temporal = " << m_temporal << std::endl
+        << "  temporal = " << m_temporal << "," << std::endl
+        << "  tile_size = " << m_tile_size << std::endl
         << "]";
     return oss.str();
 }
@@ -28,7 +28,19 @@ MI_VARIANT class PyBSDF : public BSDF<Float, Spectrum> {
 public:
     MI_IMPORT_TYPES(BSDF)
 
-    PyBSDF(const Properties &props) : BSDF(props) { }
+    PyBSDF(const Properties &props) : BSDF(props) {
+        if constexpr (!dr::is_jit_v<Float>) {
+            /* Scalar integrators need the result of every BSDF query before
+               they can trace the next ray, so the queries cannot be batched */
+            static std::once_flag warned;
+            std::call_once(warned, []() {
+                Log(Warn, "BSDFs implemented in Python are invoked once per "
+                          "sample in scalar variants. Use a JIT variant (e.g. "
+                          "\"llvm_rgb\"), which invokes them once per "
+                          "wavefront, to render larger scenes.");
+            });
+        }
+    }
 
     std::pair<BSDFSample3f, Spectrum>
     sample(const BSDFContext &ctx, const SurfaceInteraction3f &si,
@@ -65,12 +77,32 @@ public:
         PYBIND11_OVERRIDE_PURE(Spectrum, BSDF, eval_diffuse_reflectance, si, active);
     }
 
+    Mask alpha_test(const SurfaceInteraction3f &si, Mask active) const override {
+        PYBIND11_OVERRIDE(Mask, BSDF, alpha_test, si, active);
+    }
+
+    std::pair<UnpolarizedSpectrum, UnpolarizedSpectrum>
+    eval_subsurface(const SurfaceInteraction3f &si, Mask active) const override {
+        using Return = std::pair<UnpolarizedSpectrum, UnpolarizedSpectrum>;
+        PYBIND11_OVERRIDE(Return, BSDF, eval_subsurface, si, active);
+    }
+
+    uint32_t ray_flags() const override {
+        // BSDFs implemented in Python may read any field unless they override this
+        py::gil_scoped_acquire gil;
+        py::function ray_flags_override = py::get_override(this, "ray_flags");
+        if (ray_flags_override)
+            return ray_flags_override().template cast<uint32_t>();
+        return +RayFlags::All;
+    }
+
     std::string to_string() const override {
         PYBIND11_OVERRIDE_PURE(std::string, BSDF, to_string,);
     }
 
     using BSDF::m_flags;
     using BSDF::m_components;
+    using BSDF::m_alpha_test;
 };
 
 template <typename Ptr, typename Cls> void bind_bsdf_generic(Cls &cls) {
@@ -103,7 +135,7 @@ template <typename Ptr, typename Cls> void bind_bsdf_generic(Cls &cls) {
                 Mask active) {
                     return bsdf->eval_pdf_sample(ctx, si, wo, sample1, sample2, active);
                 }, "ctx"_a, "si"_a, "wo"_a, "sample1"_a, "sample2"_a, "active"_a = true,
-                D(BSDF, eval_pdf))
+                D(BSDF, eval_pdf_sample))
         .def("eval_null_transmission",
              [](Ptr bsdf, const SurfaceInteraction3f &si, Mask active) {
                  return bsdf->eval_null_transmission(si, active);
@@ -112,6 +144,14 @@ template <typename Ptr, typename Cls> void bind_bsdf_generic(Cls &cls) {
              [](Ptr bsdf, const SurfaceInteraction3f &si, Mask active) {
                  return bsdf->eval_diffuse_reflectance(si, active);
              }, "si"_a, "active"_a = true, D(BSDF, eval_diffuse_reflectance))
+        .def("alpha_test",
+             [](Ptr bsdf, const SurfaceInteraction3f &si, Mask active) {
+                 return bsdf->alpha_test(si, active);
+             }, "si"_a, "active"_a = true, D(BSDF, alpha_test))
+        .def("eval_subsurface",
+             [](Ptr bsdf, const SurfaceInteraction3f &si, Mask active) {
+                 return bsdf->eval_subsurface(si, active);
+             }, "si"_a, "active"_a = true, D(BSDF, eval_subsurface))
         .def("flags", [](Ptr bsdf) { return bsdf->flags(); }, D(BSDF, flags))
         .def("needs_differentials",
              [](Ptr bsdf) { return bsdf->needs_differentials(); },
@@ -139,6 +179,9 @@ MI_PY_EXPORT(BSDF) {
             }
         )
         .def_readwrite("m_components", &PyBSDF::m_components)
+        .def_readwrite("m_alpha_test", &PyBSDF::m_alpha_test)
+        .def_method(BSDF, has_alpha_test)
+        .def_method(BSDF, ray_flags)
         .def("__repr__", &BSDF::to_string);
 
     bind_bsdf_generic<BSDF *>(bsdf);
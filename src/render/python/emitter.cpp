@@ -9,6 +9,7 @@ MI_PY_EXPORT(EmitterExtras) {
         .def_value(EmitterFlags, DeltaDirection)
         .def_value(EmitterFlags, Infinite)
         .def_value(EmitterFlags, Surface)
+        .def_value(EmitterFlags, Volume)
         .def_value(EmitterFlags, SpatiallyVarying)
         .def_value(EmitterFlags, Delta);
 
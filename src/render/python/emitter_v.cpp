@@ -64,6 +64,15 @@ public:
         PYBIND11_OVERRIDE_PURE(ScalarBoundingBox3f, Emitter, bbox,);
     }
 
+    ScalarFloat flux_estimate() const override {
+        PYBIND11_OVERRIDE(ScalarFloat, Emitter, flux_estimate,);
+    }
+
+    std::pair<ScalarVector3f, ScalarFloat> emission_cone() const override {
+        using Return = std::pair<ScalarVector3f, ScalarFloat>;
+        PYBIND11_OVERRIDE(Return, Emitter, emission_cone,);
+    }
+
 
     std::string to_string() const override {
         PYBIND11_OVERRIDE_PURE(std::string, Emitter, to_string,);
@@ -85,6 +94,10 @@ MI_PY_EXPORT(Emitter) {
         .def(py::init<const Properties&>())
         .def_method(Emitter, is_environment)
         .def_method(Emitter, sampling_weight)
+        .def_method(Emitter, flux_estimate)
+        .def_method(Emitter, emission_cone)
+        .def_method(Emitter, flux)
+        .def_method(Emitter, update_flux)
         .def_method(Emitter, flags, "active"_a = true)
         .def_readwrite("m_needs_sample_2", &PyEmitter::m_needs_sample_2)
         .def_readwrite("m_needs_sample_3", &PyEmitter::m_needs_sample_3)
@@ -153,6 +166,7 @@ MI_PY_EXPORT(Emitter) {
         .def("flags", [](EmitterPtr ptr) { return ptr->flags(); }, D(Emitter, flags))
         .def("shape", [](EmitterPtr ptr) { return ptr->shape(); }, D(Endpoint, shape))
         .def("sampling_weight", [](EmitterPtr ptr) { return ptr->sampling_weight(); }, D(Emitter, sampling_weight))
+        .def("flux", [](EmitterPtr ptr) { return ptr->flux(); }, D(Emitter, flux))
         .def("is_environment",
              [](EmitterPtr ptr) { return ptr->is_environment(); },
              D(Emitter, is_environment));
@@ -7,7 +7,8 @@ MI_PY_EXPORT(FilmFlags) {
         .def_value(FilmFlags, Empty)
         .def_value(FilmFlags, Alpha)
         .def_value(FilmFlags, Spectral)
-        .def_value(FilmFlags, Special);
+        .def_value(FilmFlags, Special)
+        .def_value(FilmFlags, Variance);
 
     MI_PY_DECLARE_ENUM_OPERATORS(FilmFlags, e)
 }
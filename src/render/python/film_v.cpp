@@ -18,6 +18,10 @@ public:
         PYBIND11_OVERRIDE_PURE(size_t, Film, prepare, aovs);
     }
 
+    size_t channel_count(const std::vector<std::string> &aovs) const override {
+        PYBIND11_OVERRIDE(size_t, Film, channel_count, aovs);
+    }
+
     void put_block(const ImageBlock *block) override {
         PYBIND11_OVERRIDE_PURE(void, Film, put_block, block);
     }
@@ -38,6 +42,14 @@ public:
         PYBIND11_OVERRIDE_PURE(void, Film, write, path);
     }
 
+    fs::path output_path(const fs::path &path) const override {
+        PYBIND11_OVERRIDE(fs::path, Film, output_path, path);
+    }
+
+    TensorXf variance() const override {
+        PYBIND11_OVERRIDE(TensorXf, Film, variance,);
+    }
+
     void schedule_storage() override {
         PYBIND11_OVERRIDE_PURE(void, Film, schedule_storage,);
     }
@@ -79,11 +91,15 @@ MI_PY_EXPORT(Film) {
     MI_PY_TRAMPOLINE_CLASS(PyFilm, Film, Object)
         .def(py::init<const Properties &>(), "props"_a)
         .def_method(Film, prepare, "aovs"_a)
+        .def_method(Film, channel_count, "aovs"_a)
+        .def_method(Film, storage_footprint, "aovs"_a)
         .def_method(Film, put_block, "block"_a)
         .def_method(Film, clear)
         .def_method(Film, develop, "raw"_a = false)
         .def_method(Film, bitmap, "raw"_a = false)
         .def_method(Film, write, "path"_a)
+        .def_method(Film, output_path, "path"_a)
+        .def_method(Film, variance)
         .def_method(Film, sample_border)
         // Make sure to return a copy of those members as they might also be
         // exposed by-references via `mi.traverse`. In which case the return
@@ -97,6 +113,7 @@ MI_PY_EXPORT(Film) {
         .def("crop_offset",
              [] (const Film *film) { return ScalarPoint2u(film->crop_offset()); },
              D(Film, crop_offset))
+        .def_method(Film, set_crop_window, "crop_offset"_a, "crop_size"_a)
         .def_method(Film, rfilter)
         .def("prepare_sample",
             [] (const Film *film, const UnpolarizedSpectrum &spec,
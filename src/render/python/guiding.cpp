@@ -0,0 +1,25 @@
+#include <mitsuba/core/stream.h>
+#include <mitsuba/render/guiding.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(GuidingField) {
+    using ScalarBoundingBox3f = GuidingField::ScalarBoundingBox3f;
+    MI_PY_CLASS(GuidingField, Object)
+        .def(py::init<const ScalarBoundingBox3f &, float, float, uint32_t>(),
+             "bbox"_a, "spatial_threshold"_a = 12000.f,
+             "directional_threshold"_a = 0.01f, "max_depth"_a = 20,
+             D(GuidingField, GuidingField))
+        .def(py::init<Stream *>(), "stream"_a, D(GuidingField, GuidingField, 2))
+        .def_method(GuidingField, write, "stream"_a)
+        .def_method(GuidingField, sample, "p"_a, "sample"_a)
+        .def_method(GuidingField, pdf, "p"_a, "d"_a)
+        .def_method(GuidingField, record, "p"_a, "d"_a, "value"_a)
+        .def("refine", &GuidingField::refine,
+             py::call_guard<py::gil_scoped_release>(), D(GuidingField, refine))
+        .def_method(GuidingField, iteration)
+        .def_method(GuidingField, trained)
+        .def_method(GuidingField, bbox)
+        .def_method(GuidingField, leaf_count)
+        .def_method(GuidingField, node_count)
+        .def_method(GuidingField, nbytes);
+}
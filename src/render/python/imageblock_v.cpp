@@ -50,6 +50,11 @@ MI_PY_EXPORT(ImageBlock) {
         .def_method(ImageBlock, set_coalesce)
         .def_method(ImageBlock, compensate)
         .def_method(ImageBlock, set_compensate)
+        .def_method(ImageBlock, deferred)
+        .def_method(ImageBlock, set_deferred, "value"_a)
+        .def_method(ImageBlock, flush_deferred)
+        .def_method(ImageBlock, second_moment)
+        .def_method(ImageBlock, set_second_moment, "value"_a)
         .def_method(ImageBlock, width)
         .def_method(ImageBlock, height)
         .def_method(ImageBlock, rfilter)
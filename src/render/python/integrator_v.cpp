@@ -12,40 +12,60 @@
 
 #if MI_HANDLE_SIGINT
 #include <signal.h>
+#include <algorithm>
+#include <mutex>
 
-/// Current signal handler
-static std::function<void()> sigint_handler;
+/// Integrators with an ongoing render job (possibly on different threads)
+static std::vector<ScopedSignalHandler::IntegratorT *> sigint_integrators;
+static std::mutex sigint_mutex;
 
-/// Previously installed signal handler
+/// Previously installed signal handler, if ours is currently installed
 static void (*sigint_handler_prev)(int) = nullptr;
+static bool sigint_installed = false;
 #endif
 
 /// RAII helper to catch Ctrl-C keypresses and cancel an ongoing render job
-ScopedSignalHandler::ScopedSignalHandler(IntegratorT *integrator) {
+ScopedSignalHandler::ScopedSignalHandler(IntegratorT *integrator)
+    : integrator(integrator) {
 #if MI_HANDLE_SIGINT
-    // Install new signal handler
-    sigint_handler = [integrator]() {
-        integrator->cancel();
-    };
-
-    sigint_handler_prev = signal(SIGINT, [](int) {
-        Log(Warn, "Received interrupt signal, winding down..");
-        if (sigint_handler) {
-            sigint_handler();
-            sigint_handler = std::function<void()>();
+    std::lock_guard<std::mutex> guard(sigint_mutex);
+    sigint_integrators.push_back(integrator);
+
+    // Concurrent render jobs share one handler that cancels all of them
+    if (!sigint_installed) {
+        sigint_installed = true;
+        sigint_handler_prev = signal(SIGINT, [](int) {
+            Log(Warn, "Received interrupt signal, winding down..");
+
+            /* The lock is only held while a job starts or finishes. If the
+               interrupted thread holds it, the interrupt is merely forwarded */
+            std::unique_lock<std::mutex> lock(sigint_mutex, std::try_to_lock);
+            if (lock.owns_lock()) {
+                for (IntegratorT *integrator : sigint_integrators)
+                    integrator->cancel();
+            }
+
+            sigint_installed = false;
             signal(SIGINT, sigint_handler_prev);
             raise(SIGINT);
-        }
-    });
-#else
-    (void) integrator;
+        });
+    }
 #endif
 }
 
 ScopedSignalHandler::~ScopedSignalHandler() {
 #if MI_HANDLE_SIGINT
-    // Restore previous signal handler
-    signal(SIGINT, sigint_handler_prev);
+    std::lock_guard<std::mutex> guard(sigint_mutex);
+    auto it = std::find(sigint_integrators.begin(), sigint_integrators.end(),
+                        integrator);
+    if (it != sigint_integrators.end())
+        sigint_integrators.erase(it);
+
+    // Restore the previous signal handler once the last job finished
+    if (sigint_integrators.empty() && sigint_installed) {
+        sigint_installed = false;
+        signal(SIGINT, sigint_handler_prev);
+    }
 #endif
 }
 
@@ -77,6 +97,22 @@ public:
             return SamplingIntegrator::render(scene, sensor, seed, spp, develop, evaluate);
     }
 
+    std::vector<TensorXf> render_sensors(Scene *scene,
+                                         const std::vector<Sensor *> &sensors,
+                                         uint32_t seed,
+                                         uint32_t spp,
+                                         bool develop,
+                                         bool evaluate) override {
+        py::gil_scoped_acquire gil;
+        py::function render_override = py::get_override(this, "render");
+
+        // A custom render() implementation must be invoked for every sensor
+        if (render_override)
+            return Integrator<Float, Spectrum>::render_sensors(scene, sensors, seed, spp, develop, evaluate);
+        else
+            return SamplingIntegrator::render_sensors(scene, sensors, seed, spp, develop, evaluate);
+    }
+
     std::pair<Spectrum, Mask> sample(const Scene *scene,
                                      Sampler *sampler,
                                      const RayDifferential3f &ray,
@@ -204,6 +240,22 @@ public:
         }
     }
 
+    std::vector<TensorXf> render_sensors(Scene *scene,
+                                         const std::vector<Sensor *> &sensors,
+                                         uint32_t seed,
+                                         uint32_t spp,
+                                         bool develop,
+                                         bool evaluate) override {
+        py::gil_scoped_acquire gil;
+        py::function render_override = py::get_override(this, "render");
+
+        // A custom render() implementation must be invoked for every sensor
+        if (render_override)
+            return Integrator<Float, Spectrum>::render_sensors(scene, sensors, seed, spp, develop, evaluate);
+        else
+            return Base::render_sensors(scene, sensors, seed, spp, develop, evaluate);
+    }
+
     std::pair<Spectrum, Mask> sample(const Scene *scene,
                                      Sampler *sampler,
                                      const RayDifferential3f &ray,
@@ -279,9 +331,41 @@ MI_PY_EXPORT(Integrator) {
             },
             D(Integrator, render, 2), "scene"_a, "sensor"_a = 0,
             "seed"_a = 0, "spp"_a = 0, "develop"_a = true, "evaluate"_a = true)
+        .def(
+            "render_sensors",
+            [&](Integrator *integrator, Scene *scene,
+                const std::vector<Sensor *> &sensors, uint32_t seed,
+                uint32_t spp, bool develop, bool evaluate) {
+                py::gil_scoped_release release;
+                ScopedSignalHandler sh(integrator);
+                return integrator->render_sensors(scene, sensors, seed, spp,
+                                                  develop, evaluate);
+            },
+            D(Integrator, render_sensors), "scene"_a, "sensors"_a,
+            "seed"_a = 0, "spp"_a = 0, "develop"_a = true, "evaluate"_a = true)
         .def_method(Integrator, cancel)
         .def_method(Integrator, should_stop)
-        .def_method(Integrator, aov_names);
+        .def(
+            "set_pass_callback",
+            [](Integrator *integrator,
+               const std::function<py::object(uint32_t, uint32_t)> &callback) {
+                if (!callback) {
+                    integrator->set_pass_callback(nullptr);
+                    return;
+                }
+                // Callbacks that don't return anything continue rendering
+                integrator->set_pass_callback(
+                    [callback](uint32_t pass, uint32_t n_passes) {
+                        py::gil_scoped_acquire acquire;
+                        py::object result = callback(pass, n_passes);
+                        return result.is_none() || result.cast<bool>();
+                    });
+            },
+            "callback"_a, D(Integrator, set_pass_callback))
+        .def_method(Integrator, pass_sample_count)
+        .def_method(Integrator, aov_names)
+        .def_method(Integrator, render_memory_footprint, "sensor"_a,
+                    "spp"_a = 0);
 
     MI_PY_TRAMPOLINE_CLASS(PySamplingIntegrator, SamplingIntegrator, Integrator)
         .def(py::init<const Properties &>())
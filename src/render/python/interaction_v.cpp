@@ -62,6 +62,9 @@ MI_PY_EXPORT(SurfaceInteraction) {
         .def("to_local", &SurfaceInteraction3f::to_local, "v"_a, D(SurfaceInteraction, to_local))
         .def("to_world_mueller", &SurfaceInteraction3f::to_world_mueller, "M_local"_a,
             "wi_local"_a, "wo_local"_a, D(SurfaceInteraction, to_world_mueller))
+        .def("to_world_mueller_stokes", &SurfaceInteraction3f::to_world_mueller_stokes,
+            "M_local"_a, "wi_local"_a, "wo_local"_a, "stokes"_a,
+            D(SurfaceInteraction, to_world_mueller_stokes))
         .def("to_local_mueller", &SurfaceInteraction3f::to_local_mueller, "M_world"_a,
             "wi_world"_a, "wo_world"_a, D(SurfaceInteraction, to_local_mueller))
         .def("emitter", &SurfaceInteraction3f::emitter, D(SurfaceInteraction, emitter),
@@ -0,0 +1,35 @@
+#include <mitsuba/render/kdtree.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(KDTreeStatistics) {
+    py::class_<KDTreeStatistics>(m, "KDTreeStatistics", D(KDTreeStatistics))
+        .def(py::init<>())
+        .def_field(KDTreeStatistics, node_count,                D(KDTreeStatistics, node_count))
+        .def_field(KDTreeStatistics, inner_node_count,          D(KDTreeStatistics, inner_node_count))
+        .def_field(KDTreeStatistics, leaf_count,                D(KDTreeStatistics, leaf_count))
+        .def_field(KDTreeStatistics, empty_leaf_count,          D(KDTreeStatistics, empty_leaf_count))
+        .def_field(KDTreeStatistics, index_count,               D(KDTreeStatistics, index_count))
+        .def_field(KDTreeStatistics, max_depth,                 D(KDTreeStatistics, max_depth))
+        .def_field(KDTreeStatistics, max_leaf_size,             D(KDTreeStatistics, max_leaf_size))
+        .def_field(KDTreeStatistics, sah_cost,                  D(KDTreeStatistics, sah_cost))
+        .def_field(KDTreeStatistics, expected_traversal_steps,  D(KDTreeStatistics, expected_traversal_steps))
+        .def_field(KDTreeStatistics, expected_leaf_visits,      D(KDTreeStatistics, expected_leaf_visits))
+        .def_field(KDTreeStatistics, expected_primitive_visits, D(KDTreeStatistics, expected_primitive_visits))
+        .def_field(KDTreeStatistics, empty_space_ratio,         D(KDTreeStatistics, empty_space_ratio))
+        .def_field(KDTreeStatistics, leaf_size_histogram,       D(KDTreeStatistics, leaf_size_histogram))
+        .def_field(KDTreeStatistics, depth_inner_nodes,         D(KDTreeStatistics, depth_inner_nodes))
+        .def_field(KDTreeStatistics, depth_leaf_nodes,          D(KDTreeStatistics, depth_leaf_nodes))
+        .def_field(KDTreeStatistics, depth_primitives,          D(KDTreeStatistics, depth_primitives))
+        .def_field(KDTreeStatistics, build_time,                D(KDTreeStatistics, build_time))
+        .def_repr(KDTreeStatistics);
+
+    py::class_<KDTraversalStatistics>(m, "KDTraversalStatistics", D(KDTraversalStatistics))
+        .def(py::init<>())
+        .def_field(KDTraversalStatistics, ray_count,           D(KDTraversalStatistics, ray_count))
+        .def_field(KDTraversalStatistics, hit_count,           D(KDTraversalStatistics, hit_count))
+        .def_field(KDTraversalStatistics, inner_nodes_per_ray, D(KDTraversalStatistics, inner_nodes_per_ray))
+        .def_field(KDTraversalStatistics, leaves_per_ray,      D(KDTraversalStatistics, leaves_per_ray))
+        .def_field(KDTraversalStatistics, primitives_per_ray,  D(KDTraversalStatistics, primitives_per_ray))
+        .def_field(KDTraversalStatistics, time,                D(KDTraversalStatistics, time))
+        .def_repr(KDTraversalStatistics);
+}
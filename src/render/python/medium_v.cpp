@@ -20,6 +20,10 @@ public:
         PYBIND11_OVERRIDE_PURE(UnpolarizedSpectrum, Medium, get_majorant, mi, active);
     }
 
+    UnpolarizedSpectrum get_control_extinction(const MediumInteraction3f &mi, Mask active = true) const override {
+        PYBIND11_OVERRIDE(UnpolarizedSpectrum, Medium, get_control_extinction, mi, active);
+    }
+
     std::tuple<UnpolarizedSpectrum, UnpolarizedSpectrum, UnpolarizedSpectrum>
     get_scattering_coefficients(const MediumInteraction3f &mi, Mask active = true) const override {
         using Return = std::tuple<UnpolarizedSpectrum, UnpolarizedSpectrum, UnpolarizedSpectrum>;
@@ -50,11 +54,27 @@ template <typename Ptr, typename Cls> void bind_medium_generic(Cls &cls) {
        .def("has_spectral_extinction",
             [](Ptr ptr) { return ptr->has_spectral_extinction(); },
             D(Medium, has_spectral_extinction))
+       .def("is_emitter",
+            [](Ptr ptr) { return ptr->is_emitter(); },
+            D(Medium, is_emitter))
+       .def("emitter",
+            [](Ptr ptr) { return ptr->emitter(); },
+            D(Medium, emitter))
+       .def("get_radiance",
+            [](Ptr ptr, const MediumInteraction3f &mi, Mask active) {
+                return ptr->get_radiance(mi, active); },
+            "mi"_a, "active"_a=true,
+            D(Medium, get_radiance))
        .def("get_majorant",
             [](Ptr ptr, const MediumInteraction3f &mi, Mask active) {
                 return ptr->get_majorant(mi, active); },
             "mi"_a, "active"_a=true,
             D(Medium, get_majorant))
+       .def("get_control_extinction",
+            [](Ptr ptr, const MediumInteraction3f &mi, Mask active) {
+                return ptr->get_control_extinction(mi, active); },
+            "mi"_a, "active"_a=true,
+            D(Medium, get_control_extinction))
        .def("intersect_aabb",
             [](Ptr ptr, const Ray3f &ray) {
                 return ptr->intersect_aabb(ray); },
@@ -65,6 +85,11 @@ template <typename Ptr, typename Cls> void bind_medium_generic(Cls &cls) {
                 return ptr->sample_interaction(ray, sample, channel, active); },
             "ray"_a, "sample"_a, "channel"_a, "active"_a,
             D(Medium, sample_interaction))
+       .def("sample_residual_interaction",
+            [](Ptr ptr, const Ray3f &ray, Float sample, UInt32 channel, Mask active) {
+                return ptr->sample_residual_interaction(ray, sample, channel, active); },
+            "ray"_a, "sample"_a, "channel"_a, "active"_a,
+            D(Medium, sample_residual_interaction))
        .def("transmittance_eval_pdf",
             [](Ptr ptr, const MediumInteraction3f &mi,
                const SurfaceInteraction3f &si, Mask active) {
@@ -28,8 +28,12 @@ MI_PY_EXPORT(MicrofacetDistribution) {
         .def_method(MicrofacetDistribution, scale_alpha, "value"_a)
         .def("eval", &MicrofacetDistribution::eval, "m"_a,
             D(MicrofacetDistribution, eval))
-        .def("pdf", &MicrofacetDistribution::pdf, "wi"_a, "m"_a,
-            D(MicrofacetDistribution, pdf))
+        .def("pdf", py::overload_cast<const Vector3f &, const Vector3f &>(
+                &MicrofacetDistribution::pdf, py::const_),
+            "wi"_a, "m"_a, D(MicrofacetDistribution, pdf))
+        .def("pdf", py::overload_cast<const Vector3f &, const Vector3f &, const Float &,
+                                      const Float &>(&MicrofacetDistribution::pdf, py::const_),
+            "wi"_a, "m"_a, "D"_a, "smith_g1_wi"_a, D(MicrofacetDistribution, pdf, 2))
         .def("smith_g1", &MicrofacetDistribution::smith_g1, "v"_a, "m"_a,
             D(MicrofacetDistribution, smith_g1))
         .def("sample", &MicrofacetDistribution::sample, "wi"_a, "sample"_a,
@@ -86,6 +86,11 @@ MI_PY_EXPORT(mueller) {
           "M"_a, "forward"_a, "basis_current"_a, "basis_target"_a,
           D(mueller, rotate_mueller_basis_collinear));
 
+    m.def("apply_stokes", &mueller::apply_stokes<Float>,
+          "M"_a, "s"_a, D(mueller, apply_stokes));
+    m.def("apply_stokes", &mueller::apply_stokes<UnpolarizedSpectrum>,
+          "M"_a, "s"_a, D(mueller, apply_stokes));
+
     m.def("unit_angle", [](const Vector3f &a, const Vector3f &b) { return dr::unit_angle(a, b); },
           "a"_a, "b"_a);
 }
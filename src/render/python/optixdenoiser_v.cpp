@@ -6,9 +6,11 @@
 MI_PY_EXPORT(OptixDenoiser) {
     MI_PY_IMPORT_TYPES(OptixDenoiser)
     MI_PY_CLASS(OptixDenoiser, Object)
-        .def(py::init<const ScalarVector2u &, bool, bool, bool>(),
+        .def(py::init<const ScalarVector2u &, bool, bool, bool,
+                      const ScalarVector2u &>(),
              "input_size"_a, "albedo"_a = false, "normals"_a = false,
-             "temporal"_a = false, D(OptixDenoiser, OptixDenoiser))
+             "temporal"_a = false, "tile_size"_a = ScalarVector2u(0),
+             D(OptixDenoiser, OptixDenoiser))
         .def(
             "__call__",
             [](const OptixDenoiser &denoiser, const TensorXf &noisy,
@@ -0,0 +1,23 @@
+#include <mitsuba/render/raybench.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(RayBenchmarkResult) {
+    py::enum_<RayBenchmarkType>(m, "RayBenchmarkType", D(RayBenchmarkType))
+        .def_value(RayBenchmarkType, Primary)
+        .def_value(RayBenchmarkType, Diffuse)
+        .def_value(RayBenchmarkType, Shadow);
+
+    py::class_<RayBenchmarkResult>(m, "RayBenchmarkResult", D(RayBenchmarkResult))
+        .def(py::init<>())
+        .def_field(RayBenchmarkResult, type,         D(RayBenchmarkResult, type))
+        .def_field(RayBenchmarkResult, ray_count,    D(RayBenchmarkResult, ray_count))
+        .def_field(RayBenchmarkResult, traced_count, D(RayBenchmarkResult, traced_count))
+        .def_field(RayBenchmarkResult, hit_count,    D(RayBenchmarkResult, hit_count))
+        .def_field(RayBenchmarkResult, batch_size,   D(RayBenchmarkResult, batch_size))
+        .def_field(RayBenchmarkResult, warm_passes,  D(RayBenchmarkResult, warm_passes))
+        .def_field(RayBenchmarkResult, cold_time,    D(RayBenchmarkResult, cold_time))
+        .def_field(RayBenchmarkResult, warm_time,    D(RayBenchmarkResult, warm_time))
+        .def_method(RayBenchmarkResult, cold_rays_per_second)
+        .def_method(RayBenchmarkResult, warm_rays_per_second)
+        .def_repr(RayBenchmarkResult);
+}
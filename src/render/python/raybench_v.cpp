@@ -0,0 +1,23 @@
+#include <mitsuba/render/raybench.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(RayBenchmark) {
+    MI_PY_IMPORT_TYPES(RayBenchmark, Scene)
+    MI_PY_CLASS(RayBenchmark, Object)
+        .def(py::init<const Scene *, uint32_t, uint32_t>(), "scene"_a,
+             "batch_size"_a = 1u << 20, "seed"_a = 0,
+             D(RayBenchmark, RayBenchmark))
+        .def("run",
+             [](const RayBenchmark &bench, RayBenchmarkType type,
+                size_t ray_count, uint32_t warm_passes) {
+                 py::gil_scoped_release release;
+                 return bench.run(type, ray_count, warm_passes);
+             },
+             "type"_a, "ray_count"_a, "warm_passes"_a = 3,
+             D(RayBenchmark, run))
+        .def_method(RayBenchmark, batch_size)
+        .def_method(RayBenchmark, set_batch_size, "batch_size"_a)
+        .def_method(RayBenchmark, seed)
+        .def("scene", &RayBenchmark::scene, D(RayBenchmark, scene));
+}
@@ -19,6 +19,10 @@ public:
         PYBIND11_OVERRIDE(void, Sampler, seed, seed, wavefront_size);
     }
 
+    void seed_pass(uint32_t seed, uint32_t sequence_seed, uint32_t sample_offset) override {
+        PYBIND11_OVERRIDE(void, Sampler, seed_pass, seed, sequence_seed, sample_offset);
+    }
+
     void advance() override { PYBIND11_OVERRIDE(void, Sampler, advance); }
 
     Float next_1d(Mask active = true) override {
@@ -60,6 +64,7 @@ MI_PY_EXPORT(Sampler) {
         .def_method(Sampler, schedule_state)
         .def_method(Sampler, loop_put, "loop"_a)
         .def_method(Sampler, seed, "seed"_a, "wavefront_size"_a = (uint32_t) -1)
+        .def_method(Sampler, seed_pass, "seed"_a, "sequence_seed"_a, "sample_offset"_a)
         .def_method(Sampler, next_1d, "active"_a = true)
         .def_method(Sampler, next_2d, "active"_a = true);
 
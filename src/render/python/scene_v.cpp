@@ -4,9 +4,11 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/sensor.h>
+#include <mitsuba/render/texture.h>
 #include <mitsuba/python/python.h>
 
 #if !defined(MI_ENABLE_EMBREE)
+#  include <mitsuba/render/bvh.h>
 #  include <mitsuba/render/kdtree.h>
 #endif
 
@@ -22,6 +24,10 @@ MI_PY_EXPORT(ShapeKDTree) {
         .def_method(ShapeKDTree, primitive_count)
         .def_method(ShapeKDTree, shape_count)
         .def("shape", (Shape *(ShapeKDTree::*)(size_t)) &ShapeKDTree::shape, D(ShapeKDTree, shape))
+        .def_method(ShapeKDTree, shape_mask, "i"_a)
+        .def_method(ShapeKDTree, set_shape_mask, "i"_a, "mask"_a)
+        .def_method(ShapeKDTree, shape_alpha_test, "i"_a)
+        .def_method(ShapeKDTree, set_shape_alpha_test, "i"_a, "value"_a)
         .def("__getitem__", [](ShapeKDTree &s, size_t i) -> py::object {
             if (i >= s.primitive_count())
                 throw py::index_error();
@@ -34,7 +40,49 @@ MI_PY_EXPORT(ShapeKDTree) {
         .def("__len__", &ShapeKDTree::primitive_count)
         .def("bbox", [] (ShapeKDTree &s) { return s.bbox(); })
         .def_method(ShapeKDTree, build)
-        .def_method(ShapeKDTree, build);
+        .def_method(ShapeKDTree, build_temp_storage)
+        .def_method(ShapeKDTree, statistics)
+        .def_method(ShapeKDTree, measure_traversal, "ray_count"_a = 65536,
+                    "seed"_a = 0, "passes"_a = 3)
+        .def_method(ShapeKDTree, auto_tune)
+        .def_method(ShapeKDTree, set_auto_tune, "value"_a)
+        .def_method(ShapeKDTree, precompute_triangles)
+        .def_method(ShapeKDTree, set_precompute_triangles, "value"_a)
+        .def_method(ShapeKDTree, packet_traversal)
+        .def_method(ShapeKDTree, set_packet_traversal, "value"_a)
+        .def_method(ShapeKDTree, packet_utilization)
+        .def_method(ShapeKDTree, set_packet_utilization, "value"_a)
+        .def_method(ShapeKDTree, memory_footprint)
+        .def_method(ShapeKDTree, parallel_subtree_threshold)
+        .def_method(ShapeKDTree, set_parallel_subtree_threshold)
+        .def_method(ShapeKDTree, cache_dir)
+        .def_method(ShapeKDTree, set_cache_dir, "path"_a)
+        .def_method(ShapeKDTree, cache_key);
+#else
+    DRJIT_MARK_USED(m);
+#endif
+}
+
+MI_PY_EXPORT(ShapeBVH) {
+    MI_PY_IMPORT_TYPES(ShapeBVH, Shape)
+
+#if !defined(MI_ENABLE_EMBREE)
+    MI_PY_CLASS(ShapeBVH, Object)
+        .def(py::init<const Properties &>(), D(ShapeBVH, ShapeBVH))
+        .def_method(ShapeBVH, add_shape)
+        .def_method(ShapeBVH, build)
+        .def_method(ShapeBVH, refit)
+        .def_method(ShapeBVH, ready)
+        .def_method(ShapeBVH, width)
+        .def_method(ShapeBVH, primitive_count)
+        .def_method(ShapeBVH, shape_count)
+        .def_method(ShapeBVH, node_count)
+        .def("shape", (Shape *(ShapeBVH::*)(size_t)) &ShapeBVH::shape, D(ShapeBVH, shape))
+        .def_method(ShapeBVH, shape_mask, "i"_a)
+        .def_method(ShapeBVH, set_shape_mask, "i"_a, "mask"_a)
+        .def_method(ShapeBVH, shape_alpha_test, "i"_a)
+        .def_method(ShapeBVH, set_shape_alpha_test, "i"_a, "value"_a)
+        .def("bbox", [] (ShapeBVH &s) { return s.bbox(); }, D(ShapeBVH, bbox));
 #else
     DRJIT_MARK_USED(m);
 #endif
@@ -59,6 +107,12 @@ MI_PY_EXPORT(Scene) {
         .def("ray_test",
              py::overload_cast<const Ray3f &, Mask, Mask>(&Scene::ray_test, py::const_),
              "ray"_a, "coherent"_a, "active"_a = true, D(Scene, ray_test, 2))
+        .def("ray_intersect_occluder", &Scene::ray_intersect_occluder,
+             "ray"_a, "ray_flags"_a = +RayFlags::All, "active"_a = true,
+             D(Scene, ray_intersect_occluder))
+        .def_method(Scene, has_passthrough_shapes)
+        .def_method(Scene, has_alpha_tested_shapes)
+        .def_method(Scene, ray_flags)
 #if !defined(MI_ENABLE_EMBREE)
         .def("ray_intersect_naive",
             &Scene::ray_intersect_naive,
@@ -126,5 +180,60 @@ MI_PY_EXPORT(Scene) {
              },
              D(Scene, integrator))
         .def_method(Scene, shapes_grad_enabled)
+        .def_method(Scene, add_shape, "shape"_a)
+        .def_method(Scene, remove_shape, "shape"_a)
+        .def_method(Scene, add_emitter, "emitter"_a)
+        .def_method(Scene, remove_emitter, "emitter"_a)
+        .def_method(Scene, replace_bsdf, "bsdf"_a, "new_bsdf"_a)
+        .def("statistics",
+             [](const Scene &scene) {
+                 std::vector<ref<Shape>> shapes;
+                 std::vector<ref<BSDF>> bsdfs;
+                 std::vector<ref<Texture>> textures;
+                 scene.statistics_objects(shapes, bsdfs, textures);
+
+                 py::list shapes_py, bsdfs_py, textures_py;
+                 for (const Shape *s : shapes) {
+                     const Mesh *m = dynamic_cast<const Mesh *>(s);
+                     py::dict entry;
+                     entry["shape"] = m ? py::cast(m) : py::cast(s);
+                     entry["ray_intersections"] = s->intersection_counter().value();
+                     shapes_py.append(entry);
+                 }
+                 for (const BSDF *b : bsdfs) {
+                     py::dict entry;
+                     entry["bsdf"] = py::cast(b);
+                     entry["eval"] = b->eval_counter().value();
+                     entry["sample"] = b->sample_counter().value();
+                     bsdfs_py.append(entry);
+                 }
+                 for (const Texture *t : textures) {
+                     py::dict entry;
+                     entry["texture"] = py::cast(t);
+                     entry["eval"] = t->eval_counter().value();
+                     textures_py.append(entry);
+                 }
+
+                 py::dict result;
+                 result["shapes"] = shapes_py;
+                 result["bsdfs"] = bsdfs_py;
+                 result["textures"] = textures_py;
+                 auto *integrator =
+                     dynamic_cast<const MonteCarloIntegrator *>(scene.integrator());
+                 if (integrator) {
+                     result["path_lengths"] = integrator->path_length_histogram();
+                     result["events"] = integrator->event_counts();
+                 }
+                 return result;
+             },
+             "Return the hot-path statistics counters of the shapes, BSDFs and "
+             "textures of the scene and the path length histogram and sampling "
+             "event counts of its integrator as a dictionary. The counts are zero unless Mitsuba "
+             "was compiled with the ``MI_STATISTICS`` CMake option.")
+        .def_method(Scene, reset_statistics)
+        .def_method(Scene, memory_usage)
+        .def_method(Scene, predicted_peak_memory, "sensor_index"_a = 0,
+                    "spp"_a = 0)
+        .def_method(Scene, kernel_signature, "sensor_index"_a = 0)
         .def("__repr__", &Scene::to_string);
 }
@@ -66,6 +66,10 @@ public:
         PYBIND11_OVERRIDE(Return, Sensor, sample_wavelengths, si, sample, active);
     }
 
+    Float circle_of_confusion(const Point3f &p, Mask active) const override {
+        PYBIND11_OVERRIDE(Float, Sensor, circle_of_confusion, p, active);
+    }
+
     ScalarBoundingBox3f bbox() const override {
         PYBIND11_OVERRIDE_PURE(ScalarBoundingBox3f, Sensor, bbox,);
     }
@@ -88,6 +92,8 @@ MI_PY_EXPORT(Sensor) {
         .def("sample_ray_differential", &Sensor::sample_ray_differential,
              "time"_a, "sample1"_a, "sample2"_a, "sample3"_a, "active"_a = true,
              D(Sensor, sample_ray_differential))
+        .def("circle_of_confusion", &Sensor::circle_of_confusion,
+             "p"_a, "active"_a = true, D(Sensor, circle_of_confusion))
         .def_method(Sensor, shutter_open)
         .def_method(Sensor, shutter_open_time)
         .def_method(Sensor, needs_aperture_sample)
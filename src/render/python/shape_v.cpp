@@ -150,6 +150,7 @@ MI_PY_EXPORT(Shape) {
             &Shape::bbox, py::const_), D(Shape, bbox, 3), "index"_a, "clip"_a)
         .def_method(Shape, id)
         .def_method(Shape, is_mesh)
+        .def_method(Shape, has_motion)
         .def_method(Shape, parameters_grad_enabled)
         .def_method(Shape, primitive_count)
         .def_method(Shape, effective_primitive_count);
@@ -179,17 +180,30 @@ MI_PY_EXPORT(Shape) {
         .def_method(Mesh, face_count)
         .def_method(Mesh, has_vertex_normals)
         .def_method(Mesh, has_vertex_texcoords)
+        .def_method(Mesh, has_vertex_motion)
+        .def_method(Mesh, has_face_normals)
+        .def_method(Mesh, has_flipped_normals)
         .def("write_ply",
              py::overload_cast<const std::string &>(&Mesh::write_ply, py::const_),
-             "filename"_a, D(Mesh, write_ply))
+             "filename"_a, py::call_guard<py::gil_scoped_release>(),
+             D(Mesh, write_ply))
         .def("write_ply",
              py::overload_cast<Stream *>(&Mesh::write_ply, py::const_),
              "stream"_a, D(Mesh, write_ply, 2))
+        .def("move_to_mmap", &Mesh::move_to_mmap,
+             py::arg_v("filename", fs::path(), "fs::path()"), D(Mesh, move_to_mmap))
+        .def_method(Mesh, is_memory_mapped)
+        .def_static("merge",
+             py::overload_cast<const std::vector<const Mesh *> &>(&Mesh::merge),
+             "meshes"_a, D(Mesh, merge, 2))
         .def("add_attribute", &Mesh::add_attribute, "name"_a, "size"_a, "buffer"_a,
              D(Mesh, add_attribute), py::return_value_policy::reference_internal)
         .def("vertex_position", [](const Mesh &m, UInt32 index, Mask active) {
                 return m.vertex_position(index, active);
              }, D(Mesh, vertex_position), "index"_a, "active"_a = true)
+        .def("vertex_position_at", [](const Mesh &m, UInt32 index, Float time, Mask active) {
+                return m.vertex_position_at(index, time, active);
+             }, D(Mesh, vertex_position_at), "index"_a, "time"_a, "active"_a = true)
         .def("vertex_normal", [](const Mesh &m, UInt32 index, Mask active) {
                 return m.vertex_normal(index, active);
              }, D(Mesh, vertex_normal), "index"_a, "active"_a = true)
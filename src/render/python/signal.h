@@ -6,5 +6,7 @@ struct MI_EXPORT ScopedSignalHandler {
     // Defined in integrator_v.cpp
     ScopedSignalHandler(IntegratorT *);
     ~ScopedSignalHandler();
+
+    IntegratorT *integrator;
 };
 
@@ -3,12 +3,22 @@
 
 MI_PY_EXPORT(Spiral) {
     using Vector2u = typename Spiral::Vector2u;
+
+    py::enum_<BlockOrder>(m, "BlockOrder", D(BlockOrder))
+        .def_value(BlockOrder, Spiral)
+        .def_value(BlockOrder, Hilbert)
+        .def_value(BlockOrder, Morton);
+
     MI_PY_CLASS(Spiral, Object)
-        .def(py::init<Vector2u, Vector2u, uint32_t, uint32_t>(),
+        .def(py::init<Vector2u, Vector2u, uint32_t, uint32_t, BlockOrder>(),
             "size"_a, "offset"_a, "block_size"_a = MI_BLOCK_SIZE, "passes"_a = 1,
-            D(Spiral, Spiral))
+            "order"_a = BlockOrder::Spiral, D(Spiral, Spiral))
         .def_method(Spiral, max_block_size)
         .def_method(Spiral, block_count)
+        .def_method(Spiral, pass_count)
+        .def_method(Spiral, order)
         .def_method(Spiral, reset)
-        .def_method(Spiral, next_block);
+        .def_method(Spiral, next_block)
+        .def_method(Spiral, next_blocks, "count"_a)
+        .def_method(Spiral, block, "counter"_a);
 }
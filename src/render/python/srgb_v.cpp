@@ -3,7 +3,20 @@
 
 MI_PY_EXPORT(srgb) {
     MI_PY_IMPORT_TYPES()
-    m.def("srgb_model_fetch", &srgb_model_fetch, D(srgb_model_fetch))
+    m.def("srgb_model_fetch",
+        py::overload_cast<const Color<float, 3> &>(&srgb_model_fetch),
+        D(srgb_model_fetch))
+    .def("srgb_model_fetch",
+        [](py::array_t<float, py::array::c_style | py::array::forcecast> rgb) {
+            if (rgb.ndim() < 1 || rgb.shape(rgb.ndim() - 1) != 3)
+                Throw("srgb_model_fetch(): expected an array whose last "
+                      "dimension has size 3!");
+            py::array_t<float> coeff(std::vector<py::ssize_t>(
+                rgb.shape(), rgb.shape() + rgb.ndim()));
+            srgb_model_fetch(rgb.data(), coeff.mutable_data(),
+                             (size_t) rgb.size() / 3);
+            return coeff;
+        }, "rgb"_a, D(srgb_model_fetch, 2))
     // .def("srgb_model_eval_rgb", &srgb_model_eval_rgb, D(srgb_model_eval_rgb))
     .def("srgb_model_eval",
         &srgb_model_eval<unpolarized_spectrum_t<Spectrum>, dr::Array<Float, 3>>,
@@ -73,6 +73,18 @@ public:
         PYBIND11_OVERRIDE(bool, Texture, is_spatially_varying);
     }
 
+    bool is_uniform() const override {
+        PYBIND11_OVERRIDE(bool, Texture, is_uniform);
+    }
+
+    bool needs_differentials() const override {
+        PYBIND11_OVERRIDE(bool, Texture, needs_differentials);
+    }
+
+    bool is_spectrally_varying() const override {
+        PYBIND11_OVERRIDE(bool, Texture, is_spectrally_varying);
+    }
+
     std::string to_string() const override {
         PYBIND11_OVERRIDE(std::string, Texture, to_string);
     }
@@ -88,6 +100,9 @@ MI_PY_EXPORT(Texture) {
         .def_method(Texture, mean, D(Texture, mean))
         .def_method(Texture, max, D(Texture, max))
         .def_method(Texture, is_spatially_varying)
+        .def_method(Texture, is_uniform)
+        .def_method(Texture, needs_differentials)
+        .def_method(Texture, is_spectrally_varying)
         .def_method(Texture, eval, "si"_a, "active"_a = true)
         .def_method(Texture, eval_1, "si"_a, "active"_a = true)
         .def_method(Texture, eval_1_grad, "si"_a, "active"_a = true)
@@ -43,6 +43,10 @@ public:
         PYBIND11_OVERRIDE(ScalarVector3i, Volume, resolution);
     }
 
+    bool is_spectrally_varying() const override {
+        PYBIND11_OVERRIDE(bool, Volume, is_spectrally_varying);
+    }
+
     std::string to_string() const override {
         PYBIND11_OVERRIDE(std::string, Volume, to_string);
     }
@@ -55,6 +59,7 @@ MI_PY_EXPORT(Volume) {
     MI_PY_TRAMPOLINE_CLASS(PyVolume, Volume, Object)
         .def(py::init<const Properties &>(), "props"_a)
         .def_method(Volume, resolution)
+        .def_method(Volume, is_spectrally_varying)
         .def_method(Volume, bbox)
         .def_method(Volume, channel_count)
         .def_method(Volume, max)
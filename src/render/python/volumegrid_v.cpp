@@ -22,19 +22,13 @@ MI_PY_EXPORT(VolumeGrid) {
             auto volumegrid = new VolumeGrid(size, (uint32_t) channel_count);
             memcpy(volumegrid->data(), obj.data(), volumegrid->buffer_size());
 
-            ScalarFloat max = 0.f;
-            std::vector<ScalarFloat> max_per_channel(channel_count, -dr::Infinity<ScalarFloat>);
             if (compute_max) {
-                size_t ch_index = 0;
-                for (size_t i = 0; i < dr::prod(size) * channel_count; ++i) {
-                    max = dr::maximum(max, volumegrid->data()[i]);
-                    ch_index = i % channel_count;
-                    max_per_channel[ch_index] = dr::maximum(max_per_channel[ch_index], volumegrid->data()[i]);
-                }
+                volumegrid->update_max();
+            } else {
+                std::vector<ScalarFloat> max_per_channel(channel_count, -dr::Infinity<ScalarFloat>);
+                volumegrid->set_max(0.f);
+                volumegrid->set_max_per_channel(max_per_channel.data());
             }
-
-            volumegrid->set_max(max);
-            volumegrid->set_max_per_channel(max_per_channel.data());
             return volumegrid;
         }), "array"_a, "compute_max"_a = true, "Initialize a VolumeGrid from a NumPy array")
 
@@ -49,6 +43,7 @@ MI_PY_EXPORT(VolumeGrid) {
             },
             D(VolumeGrid, max_per_channel))
         .def_method(VolumeGrid, set_max)
+        .def_method(VolumeGrid, update_max, py::call_guard<py::gil_scoped_release>())
         .def("set_max_per_channel",
             [] (VolumeGrid *volgrid, std::vector<ScalarFloat> &max_values) {
                 volgrid->set_max_per_channel(max_values.data());
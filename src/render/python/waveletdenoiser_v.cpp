@@ -0,0 +1,33 @@
+#include <mitsuba/render/waveletdenoiser.h>
+#include <mitsuba/python/python.h>
+
+MI_PY_EXPORT(WaveletDenoiser) {
+    MI_PY_IMPORT_TYPES(WaveletDenoiser)
+    MI_PY_CLASS(WaveletDenoiser, Object)
+        .def(py::init<const ScalarVector2u &, bool, bool, uint32_t, float>(),
+             "input_size"_a, "albedo"_a = false, "normals"_a = false,
+             "iterations"_a = 5, "color_sigma"_a = 0.5f,
+             D(WaveletDenoiser, WaveletDenoiser))
+        .def(
+            "__call__",
+            [](const WaveletDenoiser &denoiser, const TensorXf &noisy,
+               bool denoise_alpha, const TensorXf &albedo,
+               const TensorXf &normals) {
+                py::gil_scoped_release release;
+                return denoiser(noisy, denoise_alpha, albedo, normals);
+            },
+            "noisy"_a, "denoise_alpha"_a = true, "albedo"_a = TensorXf(),
+            "normals"_a = TensorXf(), D(WaveletDenoiser, operator_call))
+        .def(
+            "__call__",
+            [](const WaveletDenoiser &denoiser, const ref<Bitmap> &noisy,
+               bool denoise_alpha, const std::string &albedo_ch,
+               const std::string &normals_ch, const std::string &noisy_ch) {
+                py::gil_scoped_release release;
+                return denoiser(noisy, denoise_alpha, albedo_ch, normals_ch,
+                                noisy_ch);
+            },
+            "noisy"_a, "denoise_alpha"_a = true, "albedo_ch"_a = "",
+            "normals_ch"_a = "", "noisy_ch"_a = "<root>",
+            D(WaveletDenoiser, operator_call, 2));
+}
@@ -0,0 +1,227 @@
+#include <mitsuba/render/raybench.h>
+#include <mitsuba/core/frame.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/scene.h>
+#include <mitsuba/render/sensor.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+NAMESPACE_BEGIN(mitsuba)
+
+static const char *ray_benchmark_type_name(RayBenchmarkType type) {
+    switch (type) {
+        case RayBenchmarkType::Primary: return "primary";
+        case RayBenchmarkType::Diffuse: return "diffuse";
+        case RayBenchmarkType::Shadow:  return "shadow";
+        default:                        return "unknown";
+    }
+}
+
+std::string RayBenchmarkResult::to_string() const {
+    std::ostringstream oss;
+    oss << "RayBenchmarkResult[" << std::endl
+        << "  type = " << ray_benchmark_type_name(type) << "," << std::endl
+        << "  ray_count = " << ray_count << "," << std::endl
+        << "  traced_count = " << traced_count << "," << std::endl
+        << "  hit_count = " << hit_count << "," << std::endl
+        << "  batch_size = " << batch_size << "," << std::endl
+        << "  cold = " << tfm::format("%.3f Mrays/s", cold_rays_per_second() * 1e-6)
+        << "," << std::endl
+        << "  warm = " << tfm::format("%.3f Mrays/s", warm_rays_per_second() * 1e-6)
+        << " (" << warm_passes << " passes)" << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_VARIANT RayBenchmark<Float, Spectrum>::RayBenchmark(const Scene *scene,
+                                                       uint32_t batch_size,
+                                                       uint32_t seed)
+    : m_scene(scene), m_seed(seed) {
+    if (!scene)
+        Throw("RayBenchmark: a scene must be specified!");
+    set_batch_size(batch_size);
+}
+
+MI_VARIANT void RayBenchmark<Float, Spectrum>::set_batch_size(uint32_t batch_size) {
+    if (batch_size == 0)
+        Throw("RayBenchmark: the batch size must be positive!");
+    m_batch_size = batch_size;
+}
+
+MI_VARIANT std::pair<typename RayBenchmark<Float, Spectrum>::Ray3f,
+                     typename RayBenchmark<Float, Spectrum>::Mask>
+RayBenchmark<Float, Spectrum>::generate(RayBenchmarkType type,
+                                        const UInt32 &index) const {
+    auto [v0, v1] = sample_tea_32(UInt32(m_seed), index);
+    PCG32<UInt32> rng;
+    rng.seed(1, v0, v1);
+    auto next_2d = [&rng]() {
+        Float x = rng.template next_float<Float>(),
+              y = rng.template next_float<Float>();
+        return Point2f(x, y);
+    };
+
+    Ray3f ray;
+    if (!m_scene->sensors().empty()) {
+        const Sensor *sensor = m_scene->sensors()[0].get();
+        Float time = sensor->shutter_open();
+        if (sensor->shutter_open_time() > 0.f)
+            time += rng.template next_float<Float>() * sensor->shutter_open_time();
+        Float wavelength_sample = rng.template next_float<Float>();
+        Point2f film_sample = next_2d(), aperture_sample = next_2d();
+        std::tie(ray, std::ignore) =
+            sensor->sample_ray(time, wavelength_sample, film_sample,
+                               aperture_sample);
+    } else {
+        // Rays between two spheres around the scene
+        ScalarBoundingSphere3f bsphere = m_scene->bbox().bounding_sphere();
+        Point3f o = bsphere.center + warp::square_to_uniform_sphere(next_2d()) *
+                                         (2.f * bsphere.radius),
+                t = bsphere.center + warp::square_to_uniform_sphere(next_2d()) *
+                                         (.5f * bsphere.radius);
+        ray = Ray3f(o, dr::normalize(t - o));
+    }
+
+    if (type == RayBenchmarkType::Primary)
+        return { ray, true };
+
+    SurfaceInteraction3f si = m_scene->ray_intersect(ray);
+    Mask active = si.is_valid();
+
+    if (type == RayBenchmarkType::Diffuse) {
+        // Leave the surface on the side of the incident ray
+        Normal3f n = dr::select(dr::dot(si.n, ray.d) < 0.f, si.n, -si.n);
+        Vector3f d =
+            Frame3f(n).to_world(warp::square_to_cosine_hemisphere(next_2d()));
+        return { si.spawn_ray(d), active };
+    }
+
+    Point2f emitter_sample = next_2d();
+    if (!m_scene->emitters().empty()) {
+        DirectionSample3f ds = m_scene->sample_emitter_direction(
+            si, emitter_sample, false, active).first;
+        active &= ds.pdf > 0.f;
+        return { si.spawn_ray_to(ds.p), active };
+    }
+
+    // Without emitters, shadow rays go to points inside the bounding box
+    ScalarBoundingBox3f bbox = m_scene->bbox();
+    Point3f target = bbox.min + bbox.extents() *
+        Point3f(emitter_sample.x(), emitter_sample.y(),
+                rng.template next_float<Float>());
+    return { si.spawn_ray_to(target), active };
+}
+
+MI_VARIANT RayBenchmarkResult
+RayBenchmark<Float, Spectrum>::run(RayBenchmarkType type, size_t ray_count,
+                                   uint32_t warm_passes) const {
+    if (ray_count == 0)
+        Throw("RayBenchmark: the ray count must be positive!");
+
+    RayBenchmarkResult result;
+    result.type = type;
+    result.ray_count = ray_count;
+    result.batch_size = m_batch_size;
+    result.warm_passes = warm_passes;
+
+    using Clock = std::chrono::steady_clock;
+    auto seconds = [](Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    auto trace = [&](const Ray3f &ray, Mask active) -> Mask {
+        if (type == RayBenchmarkType::Shadow)
+            return m_scene->ray_test(ray, false, active);
+        return m_scene
+            ->ray_intersect_preliminary(ray, type == RayBenchmarkType::Primary,
+                                        active)
+            .is_valid();
+    };
+
+    for (size_t offset = 0; offset < ray_count; offset += m_batch_size) {
+        uint32_t size =
+            (uint32_t) std::min(ray_count - offset, (size_t) m_batch_size);
+
+        if constexpr (dr::is_jit_v<Float>) {
+            auto count = [](const Mask &mask) {
+                return (size_t) dr::slice(
+                    dr::sum(dr::select(mask, UInt32(1), UInt32(0))));
+            };
+
+            auto [ray, active] = generate(
+                type, dr::arange<UInt32>(size) + (uint32_t) offset);
+            dr::eval(ray, active);
+            dr::sync_thread();
+            result.traced_count += count(active);
+
+            for (uint32_t pass = 0; pass <= warm_passes; ++pass) {
+                Clock::time_point start = Clock::now();
+                Mask hit = trace(ray, active);
+                dr::eval(hit);
+                dr::sync_thread();
+                double time = seconds(start);
+
+                if (pass == 0) {
+                    result.cold_time += time;
+                    result.hit_count += count(hit);
+                } else {
+                    result.warm_time += time / warm_passes;
+                }
+            }
+        } else {
+            ThreadEnvironment env;
+            std::vector<Ray3f> rays(size);
+            std::unique_ptr<bool[]> active(new bool[size]);
+            dr::blocked_range<uint32_t> range(0, size, 4096);
+
+            dr::parallel_for(range, [&](const dr::blocked_range<uint32_t> &r) {
+                ScopedSetThreadEnvironment set_env(env);
+                for (uint32_t i = r.begin(); i != r.end(); ++i)
+                    std::tie(rays[i], active[i]) =
+                        generate(type, (uint32_t) (offset + i));
+            });
+            result.traced_count +=
+                (size_t) std::count(active.get(), active.get() + size, true);
+
+            for (uint32_t pass = 0; pass <= warm_passes; ++pass) {
+                std::atomic<size_t> hit_count(0);
+                Clock::time_point start = Clock::now();
+                dr::parallel_for(range, [&](const dr::blocked_range<uint32_t> &r) {
+                    ScopedSetThreadEnvironment set_env(env);
+                    size_t hits = 0;
+                    for (uint32_t i = r.begin(); i != r.end(); ++i)
+                        hits += active[i] && trace(rays[i], true);
+                    hit_count += hits;
+                });
+                double time = seconds(start);
+
+                if (pass == 0) {
+                    result.cold_time += time;
+                    result.hit_count += hit_count;
+                } else {
+                    result.warm_time += time / warm_passes;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+MI_VARIANT std::string RayBenchmark<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "RayBenchmark[" << std::endl
+        << "  batch_size = " << m_batch_size << "," << std::endl
+        << "  seed = " << m_seed << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(RayBenchmark, Object)
+MI_INSTANTIATE_CLASS(RayBenchmark)
+NAMESPACE_END(mitsuba)
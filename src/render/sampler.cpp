@@ -49,6 +49,12 @@ MI_VARIANT void Sampler<Float, Spectrum>::seed(uint32_t /* seed */,
     m_sample_index = dr::opaque<UInt32>(0);
 }
 
+MI_VARIANT void Sampler<Float, Spectrum>::seed_pass(uint32_t seed,
+                                                    uint32_t /* sequence_seed */,
+                                                    uint32_t /* sample_offset */) {
+    this->seed(seed);
+}
+
 MI_VARIANT void Sampler<Float, Spectrum>::advance() {
     m_dimension_index = dr::opaque<UInt32>(0);
     m_sample_index++;
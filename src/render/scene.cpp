@@ -1,14 +1,26 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/plugin.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/tracer.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/medium.h>
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/render/scene.h>
 #include <mitsuba/render/integrator.h>
+#include <mitsuba/render/texture.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 #if defined(MI_ENABLE_EMBREE)
 #  include "scene_embree.inl"
 #else
+#  include <mitsuba/core/string.h>
+#  include <mitsuba/render/bvh.h>
 #  include <mitsuba/render/kdtree.h>
 #  include "scene_native.inl"
 #endif
@@ -19,7 +31,74 @@
 
 NAMESPACE_BEGIN(mitsuba)
 
+/// Remove an object from a list of references, returns whether it was found
+template <typename T, typename U>
+static bool remove_reference(std::vector<ref<T>> &list, const U *value) {
+    auto it = std::find_if(list.begin(), list.end(), [value](const ref<T> &r) {
+        return (const Object *) r.get() == (const Object *) value;
+    });
+    if (it == list.end())
+        return false;
+    list.erase(it);
+    return true;
+}
+
 MI_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
+    /* Acceleration data structure: refit instead of rebuilding when shapes
+       change, until the quality degrades by more than the given factor */
+    m_accel_refit = props.get<bool>("accel_refit", false);
+    m_accel_refit_threshold = props.get<ScalarFloat>("accel_refit_threshold", 1.5f);
+    if (!(m_accel_refit_threshold >= 1.f))
+        Throw("The \"accel_refit_threshold\" parameter must be >= 1!");
+
+    /* Build quality of the acceleration data structure: "fast_trace" for the
+       final renders, "balanced" for previews, and "fast_build" for scenes
+       that are rebuilt very often */
+    std::string accel_build =
+        string::to_lower(props.string("accel_build", "fast_trace"));
+    if (accel_build == "fast_trace")
+        m_accel_build = AccelBuild::FastTrace;
+    else if (accel_build == "balanced")
+        m_accel_build = AccelBuild::Balanced;
+    else if (accel_build == "fast_build")
+        m_accel_build = AccelBuild::FastBuild;
+    else
+        Throw("The \"accel_build\" parameter must either be equal to "
+              "\"fast_trace\", \"balanced\" or \"fast_build\". Found %s.",
+              accel_build);
+    m_accel_compaction = props.get<bool>("accel_compaction", true);
+    m_accel_memory_report = props.get<bool>("accel_memory_report", false);
+
+    /* Embree: trade traversal speed for a smaller memory footprint, and
+       handle rays that graze edges and vertices robustly */
+    m_embree_compact = props.get<bool>("embree_compact", false);
+    m_embree_robust = props.get<bool>("embree_robust", false);
+
+    std::string emitter_sampling =
+        string::to_lower(props.string("emitter_sampling", "weight"));
+    if (emitter_sampling == "weight")
+        m_emitter_sampling = EmitterSamplingMode::Weight;
+    else if (emitter_sampling == "power")
+        m_emitter_sampling = EmitterSamplingMode::Power;
+    else if (emitter_sampling == "light_tree")
+        m_emitter_sampling = EmitterSamplingMode::LightTree;
+    else if (emitter_sampling == "light_grid")
+        m_emitter_sampling = EmitterSamplingMode::LightGrid;
+    else
+        Throw("The \"emitter_sampling\" parameter must either be equal to "
+              "\"weight\", \"power\", \"light_tree\", or \"light_grid\". "
+              "Found %s.", emitter_sampling);
+
+    m_light_grid_resolution = props.get<uint32_t>("light_grid_resolution", 32);
+    m_light_grid_threshold = props.get<ScalarFloat>("light_grid_threshold", 0.01f);
+    if (m_light_grid_resolution == 0 || !(m_light_grid_threshold > 0.f))
+        Throw("The \"light_grid_resolution\" and \"light_grid_threshold\" "
+              "parameters must be positive!");
+
+    /* Choose emitters in constant time using an alias table instead of a
+       binary search over the cumulative distribution (many emitters) */
+    m_emitter_alias_table = props.get<bool>("emitter_alias_table", false);
+
     for (auto &[k, v] : props.objects()) {
         Scene *scene           = dynamic_cast<Scene *>(v.get());
         Shape *shape           = dynamic_cast<Shape *>(v.get());
@@ -63,14 +142,80 @@ MI_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
         }
     }
 
+    /* Select the levels of detail of the instances for the first sensor, and
+       release the shape groups that none of them selected */
+    const Sensor *lod_sensor = m_sensors.empty() ? nullptr : m_sensors[0].get();
+    bool has_instances = false;
+    for (Shape *shape : m_shapes) {
+        shape->select_lod(lod_sensor);
+        has_instances |= shape->is_instance();
+    }
+
+    if (has_instances) {
+        m_bbox = ScalarBoundingBox3f();
+        for (Shape *shape : m_shapes)
+            m_bbox.expand(shape->bbox());
+
+        for (auto it = m_shapegroups.begin(); it != m_shapegroups.end();) {
+            if ((*it)->unused_lod()) {
+                remove_reference(m_children, it->get());
+                it = m_shapegroups.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    /* Optionally simplify the BSDF trees of the shapes (e.g. blends with a
+       constant weight or opaque masks), which reduces the depth of nested
+       virtual function calls during shading */
+    if (props.get<bool>("simplify_bsdfs", false))
+        simplify_bsdfs();
+
     // Create sensors' shapes (environment sensors)
     for (Sensor *sensor: m_sensors)
         sensor->set_scene(this);
 
-    if constexpr (dr::is_cuda_v<Float>)
-        accel_init_gpu(props);
-    else
-        accel_init_cpu(props);
+    /* Build the sampling tables of emitting meshes concurrently with the
+       acceleration data structure. This is limited to scalar variants, as
+       JIT variants would have to synchronize with the JIT compiler of the
+       main thread. */
+    Task *emitter_tables = nullptr;
+    if constexpr (!dr::is_jit_v<Float>) {
+        std::vector<Shape *> emitter_meshes;
+        for (Shape *shape : m_shapes) {
+            if (shape->is_emitter() && shape->is_mesh() &&
+                shape->primitive_count() > 0)
+                emitter_meshes.push_back(shape);
+        }
+
+        if (!emitter_meshes.empty()) {
+            ThreadEnvironment env;
+            emitter_tables = dr::do_async([emitter_meshes, env]() mutable {
+                ScopedSetThreadEnvironment set_env(env);
+                dr::parallel_for(
+                    dr::blocked_range<size_t>(0, emitter_meshes.size(), 1),
+                    [&](const dr::blocked_range<size_t> &range) {
+                        ScopedSetThreadEnvironment set_env_inner(env);
+                        for (size_t i = range.begin(); i != range.end(); ++i)
+                            (void) emitter_meshes[i]->surface_area();
+                    }
+                );
+            });
+        }
+    }
+
+    try {
+        if constexpr (dr::is_cuda_v<Float>)
+            accel_init_gpu(props);
+        else
+            accel_init_cpu(props);
+    } catch (...) {
+        task_wait_and_release(emitter_tables);
+        throw;
+    }
+
+    task_wait_and_release(emitter_tables);
 
     if (!m_emitters.empty()) {
         // Inform environment emitters etc. about the scene bounds
@@ -84,32 +229,319 @@ MI_VARIANT Scene<Float, Spectrum>::Scene(const Properties &props) {
     m_emitters_dr = dr::load<DynamicBuffer<EmitterPtr>>(
         m_emitters.data(), m_emitters.size());
 
+    update_passthrough_shapes();
+    update_ray_flags();
     update_emitter_sampling_distribution();
 
     m_shapes_grad_enabled = false;
+
+    std::map<std::string, size_t> usage = memory_usage();
+    size_t total = 0;
+    std::string summary;
+    for (const auto &[category, bytes] : usage) {
+        if (bytes == 0)
+            continue;
+        total += bytes;
+        summary += tfm::format("%s%s: %s", summary.empty() ? "" : ", ",
+                               category, util::mem_string(bytes));
+    }
+    Log(Info, "Scene uses %s of memory%s", util::mem_string(total),
+        summary.empty() ? "" : " (" + summary + ")");
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::simplify_bsdfs() {
+    // BSDFs shared by several shapes are only simplified once
+    std::unordered_map<const BSDF *, ref<BSDF>> simplified;
+    size_t count = 0;
+
+    auto simplify = [&](Shape *shape) {
+        if (!shape->m_bsdf)
+            return;
+        auto it = simplified.find(shape->m_bsdf.get());
+        if (it == simplified.end())
+            it = simplified.emplace(shape->m_bsdf.get(), shape->m_bsdf->simplify()).first;
+        if (it->second != shape->m_bsdf) {
+            shape->m_bsdf = it->second;
+            count++;
+        }
+    };
+
+    for (auto &shape : m_shapes)
+        simplify(shape.get());
+    for (auto &shapegroup : m_shapegroups)
+        for (auto &shape : shapegroup->shapes())
+            simplify(shape.get());
+
+    Log(Debug, "Simplified the BSDFs of %zu shapes.", count);
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::add_shape(Shape *shape) {
+    if (!shape)
+        Throw("add_shape(): the shape must not be null!");
+    if (std::find(m_shapes.begin(), m_shapes.end(), shape) != m_shapes.end() ||
+        std::find(m_shapegroups.begin(), m_shapegroups.end(),
+                  (ShapeGroup *) shape) != m_shapegroups.end())
+        Throw("add_shape(): the shape is already part of the scene!");
+    if (shape->is_sensor())
+        Throw("add_shape(): shapes with an attached sensor cannot be added to "
+              "an existing scene!");
+
+    if (shape->is_shapegroup())
+        m_shapegroups.push_back((ShapeGroup *) shape);
+    else
+        m_shapes.push_back(shape);
+
+    if (shape->is_emitter())
+        m_emitters.push_back(shape->emitter());
+
+    if (Mesh *mesh = dynamic_cast<Mesh *>(shape); mesh)
+        mesh->set_scene(this);
+
+    m_children.push_back(shape);
+    m_structure_changed = true;
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::remove_shape(Shape *shape) {
+    if (!remove_reference(m_shapes, shape) &&
+        !remove_reference(m_shapegroups, shape))
+        Throw("remove_shape(): the shape is not part of the scene!");
+
+    if (shape->is_emitter())
+        remove_reference(m_emitters, shape->emitter());
+
+    remove_reference(m_children, shape);
+    m_structure_changed = true;
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::add_emitter(Emitter *emitter) {
+    if (!emitter)
+        Throw("add_emitter(): the emitter must not be null!");
+    if (has_flag(emitter->flags(), EmitterFlags::Surface))
+        Throw("add_emitter(): area emitters are added along with their shape "
+              "(see add_shape())!");
+    if (std::find(m_emitters.begin(), m_emitters.end(), emitter) != m_emitters.end())
+        Throw("add_emitter(): the emitter is already part of the scene!");
+
+    if (emitter->is_environment()) {
+        if (m_environment)
+            Throw("Only one environment emitter can be specified per scene.");
+        m_environment = emitter;
+    }
+
+    m_emitters.push_back(emitter);
+    m_children.push_back(emitter);
+    m_structure_changed = true;
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::remove_emitter(Emitter *emitter) {
+    if (emitter && has_flag(emitter->flags(), EmitterFlags::Surface))
+        Throw("remove_emitter(): area emitters are removed along with their "
+              "shape (see remove_shape())!");
+    if (!remove_reference(m_emitters, emitter))
+        Throw("remove_emitter(): the emitter is not part of the scene!");
+
+    if (m_environment == emitter)
+        m_environment = nullptr;
+
+    remove_reference(m_children, emitter);
+    m_structure_changed = true;
+}
+
+MI_VARIANT size_t Scene<Float, Spectrum>::replace_bsdf(BSDF *bsdf, BSDF *new_bsdf) {
+    if (!new_bsdf)
+        Throw("replace_bsdf(): the new BSDF must not be null!");
+
+    size_t count = 0;
+    auto replace = [&](Shape *shape) {
+        if (shape->m_bsdf.get() == bsdf) {
+            bool passthrough  = is_passthrough_shape(shape),
+                 alpha_tested = is_alpha_tested_shape(shape);
+            shape->m_bsdf = new_bsdf;
+            // The backends store the ray masks and alpha tests of the shapes
+            if (passthrough != is_passthrough_shape(shape) ||
+                alpha_tested != is_alpha_tested_shape(shape))
+                m_structure_changed = true;
+            count++;
+        }
+    };
+
+    for (auto &shape : m_shapes)
+        replace(shape.get());
+    for (auto &shapegroup : m_shapegroups)
+        for (auto &shape : shapegroup->shapes())
+            replace(shape.get());
+
+    update_passthrough_shapes();
+    update_ray_flags();
+    return count;
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::update_passthrough_shapes() {
+    /* Shapes within instances are not skipped, since the instances are
+       reported as the intersected shapes */
+    m_passthrough_shapes = false;
+    m_alpha_tested_shapes = false;
+    m_alpha_test_continuation = false;
+    for (auto &shape : m_shapes) {
+        if (is_passthrough_shape(shape))
+            m_passthrough_shapes = true;
+
+        if (is_alpha_tested_shape(shape)) {
+            m_alpha_tested_shapes = true;
+
+            /* The native CPU backends evaluate the alpha tests within the
+               traversal, and Embree does so for triangle meshes. The JIT
+               variants cannot evaluate textures within the traversal. */
+#if defined(MI_ENABLE_EMBREE)
+            bool traversal = shape->is_mesh();
+#else
+            bool traversal = true;
+#endif
+            if (dr::is_jit_v<Float> || !traversal)
+                m_alpha_test_continuation = true;
+        }
+    }
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::update_ray_flags() {
+    // Visits the BSDFs, emitters and textures of every shape once
+    struct Collector : TraversalCallback {
+        std::unordered_set<Object *> visited;
+        uint32_t flags = RayFlags::Minimal | RayFlags::ShadingFrame;
+
+        void put_object(const std::string &, Object *obj, uint32_t) override {
+            if (!obj || !visited.insert(obj).second)
+                return;
+            // Media are sampled at the positions of the interactions
+            if (dynamic_cast<Medium *>(obj))
+                return;
+            if (auto *bsdf = dynamic_cast<BSDF *>(obj)) {
+                flags |= bsdf->ray_flags();
+            } else if (auto *texture = dynamic_cast<Texture *>(obj)) {
+                if (!texture->is_uniform())
+                    flags |= +RayFlags::UV;
+                if (texture->needs_differentials())
+                    flags |= RayFlags::UV | RayFlags::dPdUV;
+            }
+            obj->traverse(this);
+        }
+
+        void put_parameter_impl(const std::string &, void *, uint32_t,
+                                const std::type_info &) override { }
+    };
+
+    Collector collector;
+    for (const auto &shape : m_shapes)
+        collector.put_object(shape->id(), shape.get(), 0);
+    for (const auto &shapegroup : m_shapegroups)
+        for (const auto &shape : shapegroup->shapes())
+            collector.put_object(shape->id(), shape.get(), 0);
+    m_ray_flags = collector.flags;
+}
+
+MI_VARIANT bool Scene<Float, Spectrum>::is_passthrough_shape(const Shape *shape) {
+    const BSDF *bsdf = shape->bsdf();
+    return bsdf && bsdf->flags() == +BSDFFlags::Null &&
+           !shape->is_medium_transition();
+}
+
+MI_VARIANT bool Scene<Float, Spectrum>::is_alpha_tested_shape(const Shape *shape) {
+    const BSDF *bsdf = shape->bsdf();
+    return bsdf && bsdf->has_alpha_test() && !shape->is_medium_transition() &&
+           !shape->is_emitter() && !shape->is_sensor();
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::update_scene_structure() {
+    m_bbox.reset();
+    for (auto &shape : m_shapes)
+        m_bbox.expand(shape->bbox());
+
+    m_shapes_dr = dr::load<DynamicBuffer<ShapePtr>>(
+        m_shapes.data(), m_shapes.size());
+
+    m_emitters_dr = dr::load<DynamicBuffer<EmitterPtr>>(
+        m_emitters.data(), m_emitters.size());
+
+    // Inform environment emitters etc. about the new scene bounds
+    for (Emitter *emitter: m_emitters)
+        emitter->set_scene(this);
+
+    update_passthrough_shapes();
+    update_ray_flags();
+
+    if constexpr (dr::is_cuda_v<Float>)
+        accel_shapes_changed_gpu();
+    else
+        accel_shapes_changed_cpu();
+
+    // The flux estimates are re-computed along with the sampling distribution
+    m_emitter_flux_valid = false;
 }
 
 MI_VARIANT
 void Scene<Float, Spectrum>::update_emitter_sampling_distribution() {
+    size_t n_emitters = m_emitters.size();
+
+    // Lazily re-estimate the flux of emitters that have changed
+    m_emitter_distr_flux = m_emitter_sampling != EmitterSamplingMode::Weight;
+    if (m_emitter_distr_flux) {
+        for (auto &e : m_emitters) {
+            if (!m_emitter_flux_valid || e->dirty())
+                e->update_flux();
+        }
+        m_emitter_flux_valid = true;
+    }
+
+    std::unique_ptr<ScalarFloat[]> sample_weights(new ScalarFloat[n_emitters]);
+    ScalarFloat weight_sum = 0.f;
+    for (size_t i = 0; i < n_emitters; ++i) {
+        sample_weights[i] = m_emitters[i]->sampling_weight();
+        if (m_emitter_distr_flux)
+            sample_weights[i] *= m_emitters[i]->flux();
+        weight_sum += sample_weights[i];
+    }
+
+    if (m_emitter_distr_flux && n_emitters > 0 && !(weight_sum > 0.f)) {
+        Log(Warn, "The flux estimates of all emitters are zero, using their "
+                  "sampling weights instead.");
+        m_emitter_distr_flux = false;
+        for (size_t i = 0; i < n_emitters; ++i)
+            sample_weights[i] = m_emitters[i]->sampling_weight();
+    }
+
     // Check if we need to use non-uniform emitter sampling.
     bool non_uniform_sampling = false;
-    for (auto &e : m_emitters) {
-        if (e->sampling_weight() != ScalarFloat(1.0)) {
+    for (size_t i = 0; i < n_emitters; ++i) {
+        if (sample_weights[i] != (m_emitter_distr_flux ? sample_weights[0] : ScalarFloat(1.0))) {
             non_uniform_sampling = true;
             break;
         }
     }
-    size_t n_emitters = m_emitters.size();
+
     if (non_uniform_sampling) {
-        std::unique_ptr<ScalarFloat[]> sample_weights(new ScalarFloat[n_emitters]);
-        for (size_t i = 0; i < n_emitters; ++i)
-            sample_weights[i] = m_emitters[i]->sampling_weight();
         m_emitter_distr = std::make_unique<DiscreteDistribution<Float>>(
-            sample_weights.get(), n_emitters);
+            sample_weights.get(), n_emitters, m_emitter_alias_table);
     } else {
         // By default use uniform sampling with constant PMF
+        m_emitter_distr = nullptr;
         m_emitter_pmf = m_emitters.empty() ? 0.f : (1.f / n_emitters);
     }
+
+    if (m_emitter_sampling == EmitterSamplingMode::LightTree && !m_emitters.empty()) {
+        if (m_light_tree)
+            m_light_tree->build(m_emitters);
+        else
+            m_light_tree = new LightTree(m_emitters);
+    }
+
+    if (m_emitter_sampling == EmitterSamplingMode::LightGrid && !m_emitters.empty()) {
+        if (m_light_grid)
+            m_light_grid->build(m_emitters, m_bbox);
+        else
+            m_light_grid = new LightGrid(m_emitters, m_bbox, m_light_grid_resolution,
+                                         m_light_grid_threshold);
+    }
+
     // Clear emitter's dirty flag
     for (auto &e : m_emitters)
         e->set_dirty(false);
@@ -143,19 +575,79 @@ Scene<Float, Spectrum>::ray_intersect(const Ray3f &ray, uint32_t ray_flags, Mask
     MI_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
     DRJIT_MARK_USED(coherent);
 
-    if constexpr (dr::is_cuda_v<Float>)
+    if (unlikely(m_alpha_test_continuation)) {
+        PreliminaryIntersection3f pi =
+            ray_intersect_preliminary_alpha_tested(ray, coherent, active);
+        return pi.compute_surface_interaction(ray, ray_flags, active);
+    }
+
+    if constexpr (dr::is_cuda_v<Float>) {
         return ray_intersect_gpu(ray, ray_flags, active);
-    else
+    } else {
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>) {
+            SurfaceInteraction3f si =
+                ray_intersect_cpu(ray, ray_flags, coherent, active);
+            if (si.is_valid())
+                si.shape->intersection_counter().increment();
+            return si;
+        }
+#endif
         return ray_intersect_cpu(ray, ray_flags, coherent, active);
+    }
 }
 
 MI_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
 Scene<Float, Spectrum>::ray_intersect_preliminary(const Ray3f &ray, Mask coherent, Mask active) const {
     DRJIT_MARK_USED(coherent);
-    if constexpr (dr::is_cuda_v<Float>)
+    if (unlikely(m_alpha_test_continuation))
+        return ray_intersect_preliminary_alpha_tested(ray, coherent, active);
+
+    if constexpr (dr::is_cuda_v<Float>) {
         return ray_intersect_preliminary_gpu(ray, active);
-    else
+    } else {
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>) {
+            PreliminaryIntersection3f pi =
+                ray_intersect_preliminary_cpu(ray, coherent, active);
+            if (pi.is_valid())
+                pi.shape->intersection_counter().increment();
+            return pi;
+        }
+#endif
         return ray_intersect_preliminary_cpu(ray, coherent, active);
+    }
+}
+
+MI_VARIANT void
+Scene<Float, Spectrum>::ray_intersect_preliminary_packet(const Ray3f *rays,
+                                                         PreliminaryIntersection3f *pi,
+                                                         size_t count) const {
+    if constexpr (dr::is_jit_v<Float>) {
+        DRJIT_MARK_USED(rays);
+        DRJIT_MARK_USED(pi);
+        DRJIT_MARK_USED(count);
+        Throw("ray_intersect_preliminary_packet(): only supported by the "
+              "scalar variants!");
+    } else {
+        // The alpha tests are only evaluated by single ray traversals
+        if (unlikely(m_alpha_tested_shapes || m_alpha_test_continuation)) {
+            for (size_t i = 0; i < count; ++i)
+                pi[i] = ray_intersect_preliminary(rays[i]);
+            return;
+        }
+
+        for (size_t i = 0; i < count; i += 16)
+            ray_intersect_preliminary_packet_cpu(rays + i, pi + i,
+                                                 std::min(count - i, (size_t) 16));
+
+#if defined(MI_ENABLE_STATISTICS)
+        for (size_t i = 0; i < count; ++i) {
+            if (pi[i].is_valid())
+                pi[i].shape->intersection_counter().increment();
+        }
+#endif
+    }
 }
 
 MI_VARIANT typename Scene<Float, Spectrum>::Mask
@@ -163,12 +655,128 @@ Scene<Float, Spectrum>::ray_test(const Ray3f &ray, Mask coherent, Mask active) c
     MI_MASKED_FUNCTION(ProfilerPhase::RayTest, active);
     DRJIT_MARK_USED(coherent);
 
+    if (unlikely(m_alpha_test_continuation))
+        return ray_intersect_preliminary_alpha_tested(ray, coherent, active)
+            .is_valid();
+
     if constexpr (dr::is_cuda_v<Float>)
         return ray_test_gpu(ray, active);
     else
         return ray_test_cpu(ray, coherent, active);
 }
 
+MI_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
+Scene<Float, Spectrum>::ray_intersect_preliminary_alpha_tested(
+    const Ray3f &ray_, Mask coherent, Mask active, uint32_t ray_mask) const {
+    auto trace = [&](const Ray3f &ray, Mask active_) {
+        if constexpr (dr::is_cuda_v<Float>) {
+            DRJIT_MARK_USED(coherent);
+            DRJIT_MARK_USED(ray_mask);
+            return ray_intersect_preliminary_gpu(ray, active_);
+        } else {
+            return ray_intersect_preliminary_cpu(ray, coherent, active_,
+                                                 ray_mask);
+        }
+    };
+
+    Ray3f ray(ray_);
+    Float dist = 0.f;
+    PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+    pi.t = dr::Infinity<Float>;
+    Mask active_loop = Mask(active);
+
+    dr::Loop<Mask> loop("Scene::ray_intersect_preliminary_alpha_tested",
+                        active_loop, ray, dist, pi);
+    while (loop(dr::detach(active_loop))) {
+        PreliminaryIntersection3f pi_seg = trace(ray, active_loop);
+
+        // Shapes within instances are not alpha-tested
+        Mask rejected = active_loop && pi_seg.is_valid() &&
+                        dr::eq(pi_seg.instance, nullptr);
+        if (dr::any_or<true>(rejected)) {
+            ShapePtr shape = pi_seg.shape;
+            rejected &= !shape->alpha_test(ray, pi_seg, rejected);
+        }
+
+        Mask accepted = active_loop && !rejected;
+        dr::masked(pi, accepted) = pi_seg;
+        dr::masked(pi.t, accepted) += dist;
+
+        if (dr::any_or<true>(rejected)) {
+            // Only the position and normal are needed to continue the ray
+            SurfaceInteraction3f si = pi_seg.compute_surface_interaction(
+                ray, +RayFlags::Minimal, rejected);
+            Ray3f ray_next = si.spawn_ray(ray.d);
+            ray_next.maxt = ray.maxt - si.t;
+            dr::masked(dist, rejected) += si.t;
+            dr::masked(ray, rejected) = ray_next;
+        }
+
+        active_loop = rejected;
+    }
+
+    return pi;
+}
+
+MI_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
+Scene<Float, Spectrum>::ray_intersect_occluder(const Ray3f &ray_, uint32_t ray_flags,
+                                               Mask active) const {
+    if (!m_passthrough_shapes)
+        return ray_intersect(ray_, ray_flags, false, active);
+
+    MI_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
+
+    if constexpr (!dr::is_cuda_v<Float>) {
+        // The traversal skips the passthrough shapes via their ray mask
+        PreliminaryIntersection3f pi =
+            m_alpha_test_continuation
+                ? ray_intersect_preliminary_alpha_tested(
+                      ray_, false, active, ~PassthroughRayMask)
+                : ray_intersect_preliminary_cpu(ray_, false, active,
+                                                ~PassthroughRayMask);
+        return pi.compute_surface_interaction(ray_, ray_flags, active);
+    }
+
+    Ray3f ray(ray_);
+    Float dist = 0.f;
+    PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+    Mask active_loop = Mask(active);
+
+    dr::Loop<Mask> loop("Scene::ray_intersect_occluder", active_loop, ray,
+                        dist, pi);
+    while (loop(dr::detach(active_loop))) {
+        PreliminaryIntersection3f pi_seg =
+            ray_intersect_preliminary(ray, false, active_loop);
+
+        Mask passthrough = active_loop && pi_seg.is_valid() &&
+                           dr::eq(pi_seg.instance, nullptr);
+        if (dr::any_or<true>(passthrough)) {
+            ShapePtr shape = pi_seg.shape;
+            passthrough &= dr::eq(shape->bsdf(passthrough)->flags(passthrough),
+                                  (uint32_t) +BSDFFlags::Null) &&
+                           !shape->is_medium_transition();
+        }
+
+        dr::masked(pi, active_loop && !passthrough) = pi_seg;
+
+        if (dr::any_or<true>(passthrough)) {
+            // Only the position and normal are needed to continue the ray
+            SurfaceInteraction3f si = pi_seg.compute_surface_interaction(
+                ray, +RayFlags::Minimal, passthrough);
+            Ray3f ray_next = si.spawn_ray(ray.d);
+            ray_next.maxt = ray.maxt - si.t;
+            dr::masked(dist, passthrough) += si.t;
+            dr::masked(ray, passthrough) = ray_next;
+        }
+
+        active_loop = passthrough;
+    }
+
+    SurfaceInteraction3f si = pi.compute_surface_interaction(ray, ray_flags, active);
+    si.t += dist;
+    return si;
+}
+
 MI_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_naive(const Ray3f &ray, Mask active) const {
     MI_MASKED_FUNCTION(ProfilerPhase::RayIntersect, active);
@@ -273,7 +881,19 @@ Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const
     size_t emitter_count = m_emitters.size();
     if (emitter_count > 1 || (emitter_count == 1 && !vcall_inline)) {
         // Randomly pick an emitter
-        auto [index, emitter_weight, sample_x_re] = sample_emitter(sample.x(), active);
+        UInt32 index;
+        Float emitter_weight, emitter_pmf, sample_x_re;
+        if (m_light_tree || m_light_grid) {
+            std::tie(index, sample_x_re, emitter_pmf) =
+                m_light_tree ? m_light_tree->sample_emitter(ref, sample.x(), active)
+                             : m_light_grid->sample_emitter(ref, sample.x(), active);
+            active &= emitter_pmf > 0.f;
+            emitter_weight = dr::select(active, dr::rcp(emitter_pmf), 0.f);
+        } else {
+            std::tie(index, emitter_weight, sample_x_re) =
+                sample_emitter(sample.x(), active);
+            emitter_pmf = pdf_emitter(index, active);
+        }
         sample.x() = sample_x_re;
 
         // Sample a direction towards the emitter
@@ -281,7 +901,7 @@ Scene<Float, Spectrum>::sample_emitter_direction(const Interaction3f &ref, const
         std::tie(ds, spec) = emitter->sample_direction(ref, sample, active);
 
         // Account for the discrete probability of sampling this emitter
-        ds.pdf *= pdf_emitter(index, active);
+        ds.pdf *= emitter_pmf;
         spec *= emitter_weight;
 
         active &= dr::neq(ds.pdf, 0.f);
@@ -318,8 +938,15 @@ Scene<Float, Spectrum>::pdf_emitter_direction(const Interaction3f &ref,
                                               Mask active) const {
     MI_MASK_ARGUMENT(active);
     Float emitter_pmf;
-    if (m_emitter_distr == nullptr)
+    if (m_light_tree)
+        emitter_pmf = m_light_tree->pdf_emitter(ref, ds.emitter, active);
+    else if (m_light_grid)
+        emitter_pmf = m_light_grid->pdf_emitter(ref, ds.emitter, active);
+    else if (m_emitter_distr == nullptr)
         emitter_pmf = m_emitter_pmf;
+    else if (m_emitter_distr_flux)
+        emitter_pmf = ds.emitter->sampling_weight() * ds.emitter->flux() *
+                      m_emitter_distr->normalization();
     else
         emitter_pmf = ds.emitter->sampling_weight() * m_emitter_distr->normalization();
     return ds.emitter->pdf_direction(ref, ds, active) * emitter_pmf;
@@ -340,11 +967,197 @@ MI_VARIANT void Scene<Float, Spectrum>::traverse(TraversalCallback *callback) {
     }
 }
 
+MI_VARIANT void Scene<Float, Spectrum>::statistics_objects(
+    std::vector<ref<Shape>> &shapes, std::vector<ref<BSDF>> &bsdfs,
+    std::vector<ref<Texture>> &textures) const {
+    // Visits every object of the scene graph once
+    struct Collector : TraversalCallback {
+        std::unordered_set<Object *> visited;
+        std::vector<ref<Shape>> &shapes;
+        std::vector<ref<BSDF>> &bsdfs;
+        std::vector<ref<Texture>> &textures;
+
+        Collector(std::vector<ref<Shape>> &shapes,
+                  std::vector<ref<BSDF>> &bsdfs,
+                  std::vector<ref<Texture>> &textures)
+            : shapes(shapes), bsdfs(bsdfs), textures(textures) { }
+
+        void put_object(const std::string &, Object *obj, uint32_t) override {
+            if (!obj || !visited.insert(obj).second)
+                return;
+            if (auto *shape = dynamic_cast<Shape *>(obj))
+                shapes.push_back(shape);
+            else if (auto *bsdf = dynamic_cast<BSDF *>(obj))
+                bsdfs.push_back(bsdf);
+            else if (auto *texture = dynamic_cast<Texture *>(obj))
+                textures.push_back(texture);
+            obj->traverse(this);
+        }
+
+        void put_parameter_impl(const std::string &, void *, uint32_t,
+                                const std::type_info &) override { }
+    };
+
+    shapes.clear();
+    bsdfs.clear();
+    textures.clear();
+    Collector collector(shapes, bsdfs, textures);
+    for (const auto &shape : m_shapes)
+        collector.put_object(shape->id(), shape.get(), 0);
+    const_cast<Scene *>(this)->traverse(&collector);
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::reset_statistics() {
+    std::vector<ref<Shape>> shapes;
+    std::vector<ref<BSDF>> bsdfs;
+    std::vector<ref<Texture>> textures;
+    statistics_objects(shapes, bsdfs, textures);
+
+    for (auto &shape : shapes)
+        shape->intersection_counter().reset();
+    for (auto &bsdf : bsdfs) {
+        bsdf->eval_counter().reset();
+        bsdf->sample_counter().reset();
+    }
+    for (auto &texture : textures)
+        texture->eval_counter().reset();
+
+    using MonteCarloIntegrator = mitsuba::MonteCarloIntegrator<Float, Spectrum>;
+    if (auto *integrator = dynamic_cast<MonteCarloIntegrator *>(m_integrator.get()))
+        integrator->reset_statistics();
+}
+
+MI_VARIANT size_t Scene<Float, Spectrum>::memory_footprint() const {
+    if constexpr (dr::is_cuda_v<Float>)
+        return accel_memory_footprint_gpu();
+    else
+        return accel_memory_footprint_cpu();
+}
+
+MI_VARIANT std::map<std::string, size_t> Scene<Float, Spectrum>::memory_usage() const {
+    // Visits every object of the scene graph once
+    struct Collector : TraversalCallback {
+        std::unordered_set<Object *> visited;
+        std::map<std::string, size_t> usage;
+
+        void put_object(const std::string &, Object *obj, uint32_t) override {
+            if (!obj || !visited.insert(obj).second)
+                return;
+
+            // Name of the interface, e.g. "Shape" for a "PLYMesh" instance
+            const Class *cls = obj->class_();
+            while (cls->parent() && cls->parent()->parent())
+                cls = cls->parent();
+            usage[cls->name()] += obj->memory_footprint();
+
+            obj->traverse(this);
+        }
+
+        void put_parameter_impl(const std::string &, void *, uint32_t,
+                                const std::type_info &) override { }
+    };
+
+    Collector collector;
+    for (const auto &shape : m_shapes)
+        collector.put_object(shape->id(), shape.get(), 0);
+    for (const auto &sensor : m_sensors)
+        collector.put_object(sensor->id(), sensor.get(), 0);
+    const_cast<Scene *>(this)->traverse(&collector);
+
+    collector.usage["Accel"] = memory_footprint();
+    return collector.usage;
+}
+
+MI_VARIANT size_t
+Scene<Float, Spectrum>::predicted_peak_memory(uint32_t sensor_index,
+                                              uint32_t spp) const {
+    if (sensor_index >= m_sensors.size())
+        Throw("predicted_peak_memory(): sensor index %u is out of bounds "
+              "(the scene has %zu sensors)!", sensor_index, m_sensors.size());
+
+    size_t result = 0;
+    for (const auto &[category, bytes] : memory_usage())
+        if (category != "Film")
+            result += bytes;
+
+    if (m_integrator)
+        result += m_integrator->render_memory_footprint(
+            m_sensors[sensor_index].get(), spp);
+
+    return result;
+}
+
+MI_VARIANT std::string
+Scene<Float, Spectrum>::kernel_signature(uint32_t sensor_index) const {
+    if (sensor_index >= m_sensors.size())
+        Throw("kernel_signature(): sensor index %u is out of bounds "
+              "(the scene has %zu sensors)!", sensor_index, m_sensors.size());
+
+    // Collect the names of the classes of all objects of the scene graph
+    struct Collector : TraversalCallback {
+        std::unordered_set<Object *> visited;
+        std::set<std::string> classes;
+
+        void put_object(const std::string &, Object *obj, uint32_t) override {
+            if (!obj || !visited.insert(obj).second)
+                return;
+            classes.insert(obj->class_()->name());
+            obj->traverse(this);
+        }
+
+        void put_parameter_impl(const std::string &, void *, uint32_t,
+                                const std::type_info &) override { }
+    };
+
+    Collector collector;
+    for (const auto &shape : m_shapes)
+        collector.put_object(shape->id(), shape.get(), 0);
+    for (const auto &sensor : m_sensors)
+        collector.put_object(sensor->id(), sensor.get(), 0);
+    const_cast<Scene *>(this)->traverse(&collector);
+
+    const Sensor *sensor = m_sensors[sensor_index].get();
+    const Film *film = sensor->film();
+
+    std::ostringstream oss;
+    oss << "variant=" << class_()->variant() << std::endl;
+    if constexpr (dr::is_jit_v<Float>)
+        oss << "jit_flags=" << jit_flags() << std::endl;
+    for (const std::string &name : collector.classes)
+        oss << "class=" << name << std::endl;
+
+    /* Scene properties that select different code paths or that end up as
+       literal constants in the kernels */
+    oss << "emitters=" << std::min(m_emitters.size(), (size_t) 2) << std::endl
+        << "environment=" << (m_environment ? 1 : 0) << std::endl
+        << "sensor=" << sensor->class_()->name() << std::endl
+        << "film_size=" << film->crop_size() << std::endl
+        << "sample_count=" << sensor->sampler()->sample_count() << std::endl
+        << "integrator=" << (m_integrator ? m_integrator->to_string() : "none");
+
+    std::string description = oss.str();
+    Log(Debug, "Kernel signature of the scene:\n%s", description);
+
+    // 64 bit FNV-1a hash of the description
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : description) {
+        hash ^= (uint8_t) c;
+        hash *= 0x100000001b3ull;
+    }
+
+    return tfm::format("%016llx", (unsigned long long) hash);
+}
+
 MI_VARIANT void Scene<Float, Spectrum>::parameters_changed(const std::vector<std::string> &/*keys*/) {
+    // Apply shapes and emitters that were added or removed
+    bool structure_changed = m_structure_changed;
+    if (structure_changed)
+        update_scene_structure();
+
     if (m_environment)
         m_environment->set_scene(this); // TODO use parameters_changed({"scene"})
 
-    bool accel_is_dirty = false;
+    bool accel_is_dirty = structure_changed;
     for (auto &s : m_shapes) {
         if (s->dirty()) {
             accel_is_dirty = true;
@@ -374,14 +1187,27 @@ MI_VARIANT void Scene<Float, Spectrum>::parameters_changed(const std::vector<std
             break;
     }
 
+    // BSDFs and textures may have been replaced
+    update_ray_flags();
+
     // Check if emitters were modified and we potentially need to update
-    // the emitter sampling distribution.
+    // the emitter sampling distribution. Flux estimates and the light tree
+    // also depend on the geometry of area emitters.
+    bool emitters_dirty = structure_changed;
+    if (accel_is_dirty && m_emitter_sampling != EmitterSamplingMode::Weight) {
+        m_emitter_flux_valid = false;
+        emitters_dirty = true;
+    }
     for (auto &e : m_emitters) {
         if (e->dirty()) {
-            update_emitter_sampling_distribution();
+            emitters_dirty = true;
             break;
         }
     }
+    if (emitters_dirty)
+        update_emitter_sampling_distribution();
+
+    m_structure_changed = false;
 }
 
 MI_VARIANT std::string Scene<Float, Spectrum>::to_string() const {
@@ -420,6 +1246,36 @@ MI_VARIANT void Scene<Float, Spectrum>::clear_shapes_dirty() {
         s->m_dirty = false;
 }
 
+MI_VARIANT bool Scene<Float, Spectrum>::accel_refit_possible() const {
+    if (!m_accel_refit || m_structure_changed ||
+        m_accel_refit_prim_counts.size() != m_shapes.size())
+        return false;
+
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        if (m_shapes[i]->primitive_count() != m_accel_refit_prim_counts[i])
+            return false;
+    }
+
+    return true;
+}
+
+MI_VARIANT typename Scene<Float, Spectrum>::ScalarFloat
+Scene<Float, Spectrum>::accel_refit_degradation() const {
+    ScalarFloat area = 0.f;
+    for (auto &s : m_shapes)
+        area += s->bbox().surface_area();
+    return m_accel_refit_area > 0.f ? area / m_accel_refit_area : 1.f;
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::accel_refit_record_build() {
+    m_accel_refit_prim_counts.resize(m_shapes.size());
+    m_accel_refit_area = 0.f;
+    for (size_t i = 0; i < m_shapes.size(); ++i) {
+        m_accel_refit_prim_counts[i] = m_shapes[i]->primitive_count();
+        m_accel_refit_area += m_shapes[i]->bbox().surface_area();
+    }
+}
+
 MI_VARIANT void Scene<Float, Spectrum>::static_accel_initialization_cpu() { }
 MI_VARIANT void Scene<Float, Spectrum>::static_accel_shutdown_cpu() { }
 
@@ -432,9 +1288,15 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &) {
 MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
     NotImplementedError("accel_parameters_changed_gpu");
 }
+MI_VARIANT void Scene<Float, Spectrum>::accel_shapes_changed_gpu() {
+    NotImplementedError("accel_shapes_changed_gpu");
+}
 MI_VARIANT void Scene<Float, Spectrum>::accel_release_gpu() {
     NotImplementedError("accel_release_gpu");
 }
+MI_VARIANT size_t Scene<Float, Spectrum>::accel_memory_footprint_gpu() const {
+    NotImplementedError("accel_memory_footprint_gpu");
+}
 MI_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
 Scene<Float, Spectrum>::ray_intersect_preliminary_gpu(const Ray3f &, Mask) const {
     NotImplementedError("ray_intersect_preliminary_gpu");
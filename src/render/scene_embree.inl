@@ -1,5 +1,6 @@
 #include <embree3/rtcore.h>
 #include <nanothread/nanothread.h>
+#include <atomic>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -8,6 +9,9 @@ static_assert(sizeof(RTCIntersectContext) == 24 /* Dr.Jit assumes this */);
 static uint32_t embree_threads = 0;
 static RTCDevice embree_device = nullptr;
 
+/// Memory currently allocated by the Embree device in bytes
+static std::atomic<int64_t> embree_memory_usage { 0 };
+
 template <typename Float>
 struct EmbreeState {
     MI_IMPORT_CORE_TYPES()
@@ -15,12 +19,55 @@ struct EmbreeState {
     std::vector<int> geometries;
     DynamicBuffer<UInt32> shapes_registry_ids;
     bool is_nested_scene = false;
+    /// Memory allocated by Embree while building this scene in bytes
+    int64_t accel_size = 0;
+    /// Build quality and flags of the scene, also used for its shape groups
+    RTCBuildQuality build_quality = RTC_BUILD_QUALITY_HIGH;
+    RTCSceneFlags scene_flags = RTC_SCENE_FLAG_NONE;
 };
 
 static void embree_error_callback(void * /*user_ptr */, RTCError code, const char *str) {
     Log(Warn, "Embree device error %i: %s.", (int) code, str);
 }
 
+static bool embree_memory_monitor(void * /* user_ptr */, ssize_t bytes,
+                                  bool /* post */) {
+    embree_memory_usage += (int64_t) bytes;
+    return true;
+}
+
+/**
+ * Embree filter function rejecting the intersections with alpha-tested
+ * meshes that fail the alpha test (scalar variants only). The potential hit
+ * distance is provided via the \c tfar field of the ray.
+ */
+template <typename Float, typename Spectrum>
+static void embree_alpha_test(const RTCFilterFunctionNArguments *args) {
+    MI_IMPORT_TYPES(Shape)
+
+    const RTCRay *rtc_ray = (const RTCRay *) args->ray;
+    const RTCHit *rtc_hit = (const RTCHit *) args->hit;
+    const Shape *shape = (const Shape *) args->geometryUserPtr;
+
+    if (args->N != 1 || !args->valid[0])
+        return;
+
+    Ray3f ray(Point3f(rtc_ray->org_x, rtc_ray->org_y, rtc_ray->org_z),
+              Vector3f(rtc_ray->dir_x, rtc_ray->dir_y, rtc_ray->dir_z),
+              rtc_ray->time);
+
+    PreliminaryIntersection3f pi;
+    pi.t           = rtc_ray->tfar;
+    pi.prim_uv     = Point2f(rtc_hit->u, rtc_hit->v);
+    pi.prim_index  = rtc_hit->primID;
+    pi.shape_index = rtc_hit->geomID;
+    pi.shape       = shape;
+    pi.instance    = nullptr;
+
+    if (!shape->alpha_test(ray, pi))
+        args->valid[0] = 0;
+}
+
 /// Wraps rtcOccluded16 when Dr.Jit operates on vectors of length 32
 void rtcOccluded32(const int *valid, RTCScene scene,
                    RTCIntersectContext *context, uint32_t *in) {
@@ -88,6 +135,8 @@ Scene<Float, Spectrum>::accel_init_cpu(const Properties &props) {
             "threads=%i,user_threads=%i", embree_threads, embree_threads);
         embree_device = rtcNewDevice(config_str.c_str());
         rtcSetDeviceErrorFunction(embree_device, embree_error_callback, nullptr);
+        rtcSetDeviceMemoryMonitorFunction(embree_device, embree_memory_monitor,
+                                          nullptr);
     }
 
     Timer timer;
@@ -103,17 +152,41 @@ Scene<Float, Spectrum>::accel_init_cpu(const Properties &props) {
         }
     }
 
+    switch (m_accel_build) {
+        case AccelBuild::FastTrace: s.build_quality = RTC_BUILD_QUALITY_HIGH; break;
+        case AccelBuild::Balanced:  s.build_quality = RTC_BUILD_QUALITY_MEDIUM; break;
+        case AccelBuild::FastBuild: s.build_quality = RTC_BUILD_QUALITY_LOW; break;
+    }
+
+    /* Compact scenes use node and primitive layouts that reference the
+       shared vertex buffers instead of copying the triangles */
+    int flags = RTC_SCENE_FLAG_NONE;
+    if (m_embree_compact)
+        flags |= RTC_SCENE_FLAG_COMPACT;
+    if (m_embree_robust)
+        flags |= RTC_SCENE_FLAG_ROBUST;
+    s.scene_flags = (RTCSceneFlags) flags;
+
     s.accel = rtcNewScene(embree_device);
-    rtcSetSceneBuildQuality(s.accel, RTC_BUILD_QUALITY_HIGH);
-    rtcSetSceneFlags(s.accel, RTC_SCENE_FLAG_NONE);
+    rtcSetSceneBuildQuality(s.accel, s.build_quality);
+    rtcSetSceneFlags(s.accel, (RTCSceneFlags) (
+        flags | (m_accel_refit ? RTC_SCENE_FLAG_DYNAMIC : RTC_SCENE_FLAG_NONE)));
 
     ScopedPhase phase(ProfilerPhase::InitAccel);
+    ScopedTraceEvent trace("accel", "Embree build");
+    trace.set_arg("shapes", m_shapes.size());
     accel_parameters_changed_cpu();
 
     Log(Info, "Embree ready. (took %s)",
         util::time_string((float) timer.value()));
 
+    accel_shapes_changed_cpu();
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::accel_shapes_changed_cpu() {
     if constexpr (dr::is_llvm_v<Float>) {
+        EmbreeState<Float> &s = *(EmbreeState<Float> *) m_accel;
+
         // Get shapes registry ids
         if (!m_shapes.empty()) {
             std::unique_ptr<uint32_t[]> data(new uint32_t[m_shapes.size()]);
@@ -133,14 +206,86 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
 
     EmbreeState<Float> &s = *(EmbreeState<Float> *) m_accel;
 
-    for (int geo : s.geometries)
-        rtcDetachGeometry(s.accel, geo);
-    s.geometries.clear();
+    /* The BVH (including the ones of shape groups that are built on demand)
+       is allocated while the geometry is created and the scene is committed */
+    int64_t memory_usage_start = embree_memory_usage;
 
-    for (Shape *shape : m_shapes) {
-        RTCGeometry geom = shape->embree_geometry(embree_device);
-        s.geometries.push_back(rtcAttachGeometry(s.accel, geom));
-        rtcReleaseGeometry(geom);
+    /* Refit the geometry of dirty shapes in place if possible, and rebuild
+       everything once the quality degraded too much */
+    bool refit = !s.geometries.empty() && accel_refit_possible() &&
+                 accel_refit_degradation() <= m_accel_refit_threshold;
+
+    if (refit) {
+        for (size_t i = 0; i < m_shapes.size(); ++i) {
+            if (m_shapes[i]->dirty())
+                m_shapes[i]->embree_update_geometry(
+                    rtcGetGeometry(s.accel, s.geometries[i]));
+        }
+    } else {
+        for (int geo : s.geometries)
+            rtcDetachGeometry(s.accel, geo);
+        s.geometries.clear();
+
+        /* Scalar variants create the geometries on the thread pool. JIT
+           variants stay sequential, since accessing the shape data could
+           require evaluating variables of the main thread. */
+        auto for_each = [&](size_t size, auto &&func) {
+            if (!dr::is_jit_v<Float> && !s.is_nested_scene && size > 1) {
+                dr::parallel_for(
+                    dr::blocked_range<size_t>(0, size, 1),
+                    [&](const dr::blocked_range<size_t> &range) {
+                        for (size_t i = range.begin(); i != range.end(); ++i)
+                            func(i);
+                    }
+                );
+            } else {
+                for (size_t i = 0; i < size; ++i)
+                    func(i);
+            }
+        };
+
+        /* Build the BVHs of the shape groups before the instances reference
+           them, so that different groups are built concurrently */
+        for_each(m_shapegroups.size(), [&](size_t i) {
+            m_shapegroups[i]->embree_build(embree_device, s.build_quality,
+                                           s.scene_flags);
+        });
+
+        std::vector<RTCGeometry> geometries(m_shapes.size());
+        for_each(m_shapes.size(), [&](size_t i) {
+            RTCGeometry geom = m_shapes[i]->embree_geometry(embree_device);
+            bool passthrough = is_passthrough_shape(m_shapes[i]);
+            if (passthrough)
+                rtcSetGeometryMask(geom, PassthroughRayMask);
+            /* Evaluate the alpha tests of meshes in filter functions. Other
+               shapes are continued by the scene (see update_passthrough_shapes()),
+               just like all shapes of the JIT variants. */
+            bool alpha_tested = false;
+            if constexpr (!dr::is_jit_v<Float>) {
+                alpha_tested = m_shapes[i]->is_mesh() &&
+                               is_alpha_tested_shape(m_shapes[i]);
+                if (alpha_tested) {
+                    rtcSetGeometryUserData(geom, (void *) m_shapes[i].get());
+                    rtcSetGeometryIntersectFilterFunction(
+                        geom, embree_alpha_test<Float, Spectrum>);
+                    rtcSetGeometryOccludedFilterFunction(
+                        geom, embree_alpha_test<Float, Spectrum>);
+                }
+            }
+            if (m_accel_refit)
+                rtcSetGeometryBuildQuality(geom, RTC_BUILD_QUALITY_REFIT);
+            if (passthrough || alpha_tested || m_accel_refit)
+                rtcCommitGeometry(geom);
+            geometries[i] = geom;
+        });
+
+        // Attach in order, so that geometry IDs match the shape indices
+        for (RTCGeometry geom : geometries) {
+            s.geometries.push_back(rtcAttachGeometry(s.accel, geom));
+            rtcReleaseGeometry(geom);
+        }
+
+        accel_refit_record_build();
     }
 
     // Ensure shape data pointers are fully evaluated before building the BVH
@@ -159,6 +304,16 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
         );
     }
 
+    s.accel_size = std::max(
+        s.accel_size + (embree_memory_usage - memory_usage_start), (int64_t) 0);
+
+    Log(m_accel_memory_report ? Info : Debug,
+        "Embree acceleration structure uses %s (%s%s%s)",
+        util::mem_string((size_t) s.accel_size),
+        m_accel_build == AccelBuild::FastTrace ? "fast trace" :
+        (m_accel_build == AccelBuild::Balanced ? "balanced" : "fast build"),
+        m_embree_compact ? ", compact" : "", m_embree_robust ? ", robust" : "");
+
     /* Set up a callback on the handle variable to release the Embree
        acceleration data structure (IAS) when this variable is freed. This
        ensures that the lifetime of the IAS goes beyond the one of the Scene
@@ -199,10 +354,17 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
     }
 }
 
+MI_VARIANT size_t Scene<Float, Spectrum>::accel_memory_footprint_cpu() const {
+    if (!m_accel)
+        return 0;
+    return (size_t) ((const EmbreeState<Float> *) m_accel)->accel_size;
+}
+
 MI_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
 Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
                                                       Mask coherent,
-                                                      Mask active) const {
+                                                      Mask active,
+                                                      uint32_t ray_mask) const {
     using Single = dr::float32_array_t<Float>;
     EmbreeState<Float> &s = *(EmbreeState<Float> *) m_accel;
 
@@ -226,7 +388,7 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
         dr::store(&rh.ray.org_x, dr::concat(Vector3s(ray.o), float(0.f)));
         dr::store(&rh.ray.dir_x, dr::concat(Vector3s(ray.d), float(ray.time)));
         rh.ray.tfar = ray_maxt;
-        rh.ray.mask = 0;
+        rh.ray.mask = ray_mask;
         rh.ray.id = 0;
         rh.ray.flags = 0;
         rh.hit.geomID = (uint32_t) -1;
@@ -286,12 +448,14 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
         dr::Array<Single, 3> ray_o(ray.o), ray_d(ray.d);
         Single ray_mint(0.f), ray_time(ray.time);
 
+        UInt32 ray_mask_v(ray_mask);
+
         uint32_t in[14] = { coherent.index(),  active.index(),
                             ray_o.x().index(), ray_o.y().index(),
                             ray_o.z().index(), ray_mint.index(),
                             ray_d.x().index(), ray_d.y().index(),
                             ray_d.z().index(), ray_time.index(),
-                            ray_maxt.index(),  zero.index(),
+                            ray_maxt.index(),  ray_mask_v.index(),
                             zero.index(),      zero.index() };
 
         uint32_t out[6] { };
@@ -328,10 +492,101 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
         DRJIT_MARK_USED(ray);
         DRJIT_MARK_USED(coherent);
         DRJIT_MARK_USED(active);
+        DRJIT_MARK_USED(ray_mask);
         Throw("ray_intersect_preliminary_cpu() should only be called in CPU mode.");
     }
 }
 
+MI_VARIANT void
+Scene<Float, Spectrum>::ray_intersect_preliminary_packet_cpu(
+    const Ray3f *rays, PreliminaryIntersection3f *pi, size_t count) const {
+    if constexpr (!dr::is_jit_v<Float>) {
+        EmbreeState<Float> &s = *(EmbreeState<Float> *) m_accel;
+
+        RTCIntersectContext context;
+        rtcInitIntersectContext(&context);
+        context.flags = RTC_INTERSECT_CONTEXT_FLAG_COHERENT;
+
+        // Trace the rays with one of the RTCRayHit4/8/16 packet layouts
+        auto trace = [&](auto &rh, auto intersect) {
+            constexpr size_t Width = sizeof(rh.ray.tfar) / sizeof(float);
+            alignas(64) int valid[Width];
+            float ray_maxt[Width];
+
+            for (size_t i = 0; i < Width; ++i) {
+                valid[i] = i < count ? -1 : 0;
+                if (i >= count)
+                    continue;
+
+                const Ray3f &ray = rays[i];
+                // Be careful with 'ray.maxt' in double precision variants
+                ray_maxt[i] = (float) std::min((double) ray.maxt,
+                                                (double) dr::Largest<float>);
+
+                rh.ray.org_x[i] = (float) ray.o.x();
+                rh.ray.org_y[i] = (float) ray.o.y();
+                rh.ray.org_z[i] = (float) ray.o.z();
+                rh.ray.tnear[i] = 0.f;
+                rh.ray.dir_x[i] = (float) ray.d.x();
+                rh.ray.dir_y[i] = (float) ray.d.y();
+                rh.ray.dir_z[i] = (float) ray.d.z();
+                rh.ray.time[i]  = (float) ray.time;
+                rh.ray.tfar[i]  = ray_maxt[i];
+                rh.ray.mask[i]  = (uint32_t) -1;
+                rh.ray.id[i]    = (uint32_t) i;
+                rh.ray.flags[i] = 0;
+                rh.hit.geomID[i] = RTC_INVALID_GEOMETRY_ID;
+                rh.hit.instID[0][i] = RTC_INVALID_GEOMETRY_ID;
+            }
+
+            intersect(valid, s.accel, &context, &rh);
+
+            for (size_t i = 0; i < count; ++i) {
+                pi[i] = dr::zeros<PreliminaryIntersection3f>();
+                if (rh.ray.tfar[i] == ray_maxt[i]) {
+                    pi[i].t = dr::Infinity<Float>;
+                    continue;
+                }
+
+                // We get level 0 because we only support one level of instancing
+                uint32_t inst_index = rh.hit.instID[0][i];
+                bool hit_instance = inst_index != RTC_INVALID_GEOMETRY_ID;
+                uint32_t index = hit_instance ? inst_index : rh.hit.geomID[i];
+
+                ShapePtr shape = m_shapes[index];
+                if (hit_instance)
+                    pi[i].instance = shape;
+                else
+                    pi[i].shape = shape;
+
+                pi[i].shape_index = rh.hit.geomID[i];
+                pi[i].t = rh.ray.tfar[i];
+                pi[i].prim_index = rh.hit.primID[i];
+                pi[i].prim_uv = Point2f(rh.hit.u[i], rh.hit.v[i]);
+            }
+        };
+
+        if (count == 1) {
+            pi[0] = ray_intersect_preliminary_cpu(rays[0], true, true);
+        } else if (count <= 4) {
+            RTCRayHit4 rh;
+            trace(rh, rtcIntersect4);
+        } else if (count <= 8) {
+            RTCRayHit8 rh;
+            trace(rh, rtcIntersect8);
+        } else {
+            RTCRayHit16 rh;
+            trace(rh, rtcIntersect16);
+        }
+    } else {
+        DRJIT_MARK_USED(rays);
+        DRJIT_MARK_USED(pi);
+        DRJIT_MARK_USED(count);
+        Throw("ray_intersect_preliminary_packet_cpu() should only be called "
+              "in scalar mode.");
+    }
+}
+
 MI_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, uint32_t ray_flags, Mask coherent, Mask active) const {
     if constexpr (!dr::is_cuda_v<Float>) {
@@ -369,7 +624,7 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask coherent, Mask activ
         dr::store(&ray2.org_x, dr::concat(Vector3s(ray.o), float(0.f)));
         dr::store(&ray2.dir_x, dr::concat(Vector3s(ray.d), float(ray.time)));
         ray2.tfar = (float) ray_maxt;
-        ray2.mask = 0;
+        ray2.mask = (uint32_t) -1;
         ray2.id = 0;
         ray2.flags = 0;
 
@@ -404,12 +659,14 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray, Mask coherent, Mask activ
         dr::Array<Single, 3> ray_o(ray.o), ray_d(ray.d);
         Single ray_mint(0.f), ray_time(ray.time);
 
+        UInt32 ray_mask_v((uint32_t) -1);
+
         uint32_t in[14] = { coherent.index(),  active.index(),
                             ray_o.x().index(), ray_o.y().index(),
                             ray_o.z().index(), ray_mint.index(),
                             ray_d.x().index(), ray_d.y().index(),
                             ray_d.z().index(), ray_time.index(),
-                            ray_maxt.index(),  zero.index(),
+                            ray_maxt.index(),  ray_mask_v.index(),
                             zero.index(),      zero.index() };
 
         uint32_t out[1] { };
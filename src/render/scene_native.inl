@@ -1,36 +1,122 @@
 NAMESPACE_BEGIN(mitsuba)
 
+/**
+ * State of the native CPU ray tracing backend. Exactly one of the two
+ * acceleration data structures (selected via the scene's \c accel parameter)
+ * is allocated.
+ */
 template <typename Float, typename Spectrum>
 struct NativeState {
     MI_IMPORT_CORE_TYPES()
-    ShapeKDTree<Float, Spectrum> *accel;
+    using Shape = mitsuba::Shape<Float, Spectrum>;
+
+    ShapeKDTree<Float, Spectrum> *kdtree = nullptr;
+    ShapeBVH<Float, Spectrum> *bvh = nullptr;
     DynamicBuffer<UInt32> shapes_registry_ids;
+
+    void clear() {
+        if (kdtree)
+            kdtree->clear();
+        else
+            bvh->clear();
+    }
+
+    void add_shape(Shape *shape) {
+        if (kdtree)
+            kdtree->add_shape(shape);
+        else
+            bvh->add_shape(shape);
+    }
+
+    void set_shape_mask(size_t i, uint32_t mask) {
+        if (kdtree)
+            kdtree->set_shape_mask(i, mask);
+        else
+            bvh->set_shape_mask(i, mask);
+    }
+
+    void set_shape_alpha_test(size_t i, bool value) {
+        if (kdtree)
+            kdtree->set_shape_alpha_test(i, value);
+        else
+            bvh->set_shape_alpha_test(i, value);
+    }
+
+    void build() {
+        if (kdtree)
+            kdtree->build();
+        else
+            bvh->build();
+    }
+
+    size_t memory_footprint() const {
+        if (kdtree)
+            return kdtree->memory_footprint();
+        else
+            return bvh->memory_footprint();
+    }
+
+    void release() {
+        if (kdtree)
+            kdtree->dec_ref();
+        if (bvh)
+            bvh->dec_ref();
+        kdtree = nullptr;
+        bvh = nullptr;
+    }
+
+    template <bool ShadowRay, typename Ray>
+    MI_INLINE auto ray_intersect_scalar(const Ray &ray,
+                                        uint32_t ray_mask = (uint32_t) -1) const {
+        if (bvh)
+            return bvh->template ray_intersect_scalar<ShadowRay>(ray, ray_mask);
+        else
+            return kdtree->template ray_intersect_scalar<ShadowRay, false>(
+                ray, nullptr, ray_mask);
+    }
 };
 
 MI_VARIANT void Scene<Float, Spectrum>::accel_init_cpu(const Properties &props) {
-    ShapeKDTree *kdtree = new ShapeKDTree(props);
-    kdtree->inc_ref();
+    NativeState<Float, Spectrum> *s = new NativeState<Float, Spectrum>();
+    m_accel = s;
+
+    std::string accel = string::to_lower(props.string("accel", "kdtree"));
+    if (accel == "kdtree") {
+        s->kdtree = new ShapeKDTree(props);
+        s->kdtree->inc_ref();
+        if (m_accel_refit) {
+            Log(Warn, "The kd-tree cannot be refitted and will be rebuilt "
+                      "whenever the geometry changes. Set \"accel\" to "
+                      "\"bvh\" to enable refitting.");
+            m_accel_refit = false;
+        }
+    } else if (accel == "bvh") {
+        s->bvh = new ShapeBVH(props);
+        s->bvh->inc_ref();
+    } else {
+        Throw("The \"accel\" parameter must either be equal to \"kdtree\" "
+              "or \"bvh\". Found %s.", accel);
+    }
 
+    accel_shapes_changed_cpu();
+    accel_parameters_changed_cpu();
+}
+
+MI_VARIANT void Scene<Float, Spectrum>::accel_shapes_changed_cpu() {
     if constexpr (dr::is_llvm_v<Float>) {
-        m_accel = new NativeState<Float, Spectrum>();
-        NativeState<Float, Spectrum> &s = *(NativeState<Float, Spectrum> *) m_accel;
-        s.accel = kdtree;
+        NativeState<Float, Spectrum> *s = (NativeState<Float, Spectrum> *) m_accel;
 
         // Get shapes registry ids
         if (!m_shapes.empty()) {
             std::unique_ptr<uint32_t[]> data(new uint32_t[m_shapes.size()]);
             for (size_t i = 0; i < m_shapes.size(); i++)
                 data[i] = jit_registry_get_id(JitBackend::LLVM, m_shapes[i]);
-            s.shapes_registry_ids
+            s->shapes_registry_ids
                 = dr::load<DynamicBuffer<UInt32>>(data.get(), m_shapes.size());
         } else {
-            s.shapes_registry_ids = dr::zeros<DynamicBuffer<UInt32>>();
+            s->shapes_registry_ids = dr::zeros<DynamicBuffer<UInt32>>();
         }
-    } else {
-        m_accel = kdtree;
     }
-
-    accel_parameters_changed_cpu();
 }
 
 MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
@@ -38,17 +124,36 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
     if constexpr (dr::is_llvm_v<Float>)
         dr::sync_thread();
 
-    ShapeKDTree *kdtree;
-    if constexpr (dr::is_llvm_v<Float>)
-        kdtree = ((NativeState<Float, Spectrum> *) m_accel)->accel;
-    else
-        kdtree = (ShapeKDTree *) m_accel;
-
-    kdtree->clear();
-    for (Shape *shape : m_shapes)
-        kdtree->add_shape(shape);
+    NativeState<Float, Spectrum> *s = (NativeState<Float, Spectrum> *) m_accel;
     ScopedPhase phase(ProfilerPhase::InitAccel);
-    kdtree->build();
+    ScopedTraceEvent trace("accel", "Native BVH update");
+    trace.set_arg("shapes", m_shapes.size());
+
+    /* Refit the BVH if possible, and rebuild it once its quality degraded
+       too much */
+    bool rebuild = true;
+    if (s->bvh && s->bvh->ready() && accel_refit_possible()) {
+        ScalarFloat degradation = s->bvh->refit();
+        rebuild = degradation > m_accel_refit_threshold;
+        if (rebuild)
+            Log(Debug, "BVH quality degraded by a factor of %.2f, rebuilding ..",
+                degradation);
+    }
+
+    if (rebuild) {
+        s->clear();
+        for (size_t i = 0; i < m_shapes.size(); ++i) {
+            s->add_shape(m_shapes[i]);
+            if (is_passthrough_shape(m_shapes[i]))
+                s->set_shape_mask(i, PassthroughRayMask);
+            // The JIT variants continue the rays past alpha-tested shapes
+            if (!dr::is_jit_v<Float> && is_alpha_tested_shape(m_shapes[i]))
+                s->set_shape_alpha_test(i, true);
+        }
+        s->build();
+        accel_refit_record_build();
+    }
+    trace.set_arg("rebuild", rebuild);
 
     /* Set up a callback on the handle variable to release the Embree
        acceleration data structure (IAS) when this variable is freed. This
@@ -59,18 +164,18 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_cpu() {
         // Prevents the IAS to be released when updating the scene parameters
         if (m_accel_handle.index())
             jit_var_set_callback(m_accel_handle.index(), nullptr, nullptr);
-        m_accel_handle = dr::opaque<UInt64>(kdtree);
+        m_accel_handle = dr::opaque<UInt64>(s);
         jit_var_set_callback(
             m_accel_handle.index(),
             [](uint32_t /* index */, int free, void *payload) {
                 if (free) {
                     // Free KDTree on another thread to avoid deadlock with Dr.Jit mutex
                     Task *task = dr::do_async([payload](){
-                        Log(Debug, "Free KDTree..");
+                        Log(Debug, "Free acceleration data structure..");
                         NativeState<Float, Spectrum> *s =
                             (NativeState<Float, Spectrum> *) payload;
-                        s->accel->clear();
-                        s->accel->dec_ref();
+                        s->clear();
+                        s->release();
                         delete s;
                     });
                     Thread::register_task(task);
@@ -93,12 +198,20 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_release_cpu() {
            ray tracing calls are pending. */
         m_accel_handle = 0;
     } else {
-        ((ShapeKDTree *) m_accel)->dec_ref();
+        NativeState<Float, Spectrum> *s = (NativeState<Float, Spectrum> *) m_accel;
+        s->release();
+        delete s;
     }
 
     m_accel = nullptr;
 }
 
+MI_VARIANT size_t Scene<Float, Spectrum>::accel_memory_footprint_cpu() const {
+    if (!m_accel)
+        return 0;
+    return ((const NativeState<Float, Spectrum> *) m_accel)->memory_footprint();
+}
+
 #if defined(_MSC_VER)
 #  pragma pack(push, 1)
 #endif
@@ -116,17 +229,84 @@ template <typename ScalarFloat> struct RayHitT {
 #  pragma pack(pop)
 #endif
 
+/// Trace the rays of a ray tracing call through the kd-tree as one packet
 template <typename Float, typename Spectrum, bool ShadowRay, size_t Width>
-void kdtree_trace_func_wrapper(const int *valid, void *ptr,
+void native_trace_packet(const int *valid, const NativeState<Float, Spectrum> *s,
+                         uint8_t *args) {
+    MI_IMPORT_TYPES()
+    using RayHit    = RayHitT<ScalarFloat>;
+    using FloatP    = dr::Packet<ScalarFloat, Width>;
+    using MaskP     = dr::mask_t<FloatP>;
+    using Point3fP  = Point<FloatP, 3>;
+    using Vector3fP = Vector<FloatP, 3>;
+    using Ray3fP    = Ray<Point3fP, Spectrum>;
+
+    auto field = [&](size_t offset) -> ScalarFloat * {
+        return (ScalarFloat *) &args[offset * Width];
+    };
+
+    auto gather = [&](size_t offset) {
+        FloatP value;
+        for (size_t i = 0; i < Width; i++)
+            value.entry(i) = field(offset)[i];
+        return value;
+    };
+
+    FloatP valid_p;
+    for (size_t i = 0; i < Width; i++)
+        valid_p.entry(i) = valid[i] != 0 ? 1.f : 0.f;
+    MaskP active = dr::neq(valid_p, 0.f);
+
+    Ray3fP ray(Point3fP(gather(offsetof(RayHit, o_x)), gather(offsetof(RayHit, o_y)),
+                        gather(offsetof(RayHit, o_z))),
+               Vector3fP(gather(offsetof(RayHit, d_x)), gather(offsetof(RayHit, d_y)),
+                         gather(offsetof(RayHit, d_z))),
+               gather(offsetof(RayHit, tfar)), gather(offsetof(RayHit, time)),
+               wavelength_t<Spectrum>());
+
+    auto pi = s->kdtree->template ray_intersect_packet<ShadowRay>(ray, active);
+
+    for (size_t i = 0; i < Width; i++) {
+        if (valid[i] == 0 || pi.t[i] == dr::Infinity<ScalarFloat>)
+            continue;
+
+        ScalarFloat& ray_maxt = field(offsetof(RayHit, tfar))[i];
+        if constexpr (ShadowRay) {
+            ray_maxt = 0.f;
+        } else {
+            // Write outputs
+            ray_maxt = pi.t[i];
+            field(offsetof(RayHit, u))[i] = pi.prim_uv.x()[i];
+            field(offsetof(RayHit, v))[i] = pi.prim_uv.y()[i];
+            ((uint32_t *) &args[offsetof(RayHit, prim_id) * Width])[i] = pi.prim_index[i];
+            ((uint32_t *) &args[offsetof(RayHit, geom_id) * Width])[i] = pi.shape_index[i];
+            ((uint32_t *) &args[offsetof(RayHit, inst_id) * Width])[i] = pi.instance_index[i];
+        }
+    }
+}
+
+template <typename Float, typename Spectrum, bool ShadowRay, size_t Width>
+void native_trace_func_wrapper(const int *valid, void *ptr,
                                void* /* context */, uint8_t *args) {
     MI_IMPORT_TYPES()
     using ScalarRay3f = Ray<ScalarPoint3f, Spectrum>;
-    using ShapeKDTree = ShapeKDTree<Float, Spectrum>;
-
     NativeState<Float, Spectrum> *s = (NativeState<Float, Spectrum> *) ptr;
-    const ShapeKDTree *kdtree = s->accel;
     using RayHit = RayHitT<ScalarFloat>;
 
+    const uint32_t *ray_mask = (const uint32_t *) &args[offsetof(RayHit, mask) * Width];
+
+    if constexpr (Width > 1) {
+        // The packet traversal ignores the ray masks
+        bool default_mask = true;
+        for (size_t i = 0; i < Width; i++)
+            default_mask &= valid[i] == 0 || ray_mask[i] == (uint32_t) -1;
+
+        if (s->kdtree && s->kdtree->packet_traversal() && default_mask) {
+            native_trace_packet<Float, Spectrum, ShadowRay, Width>(valid, s, args);
+            return;
+        }
+    }
+
     for (size_t i = 0; i < Width; i++) {
         if (valid[i] == 0)
             continue;
@@ -147,11 +327,11 @@ void kdtree_trace_func_wrapper(const int *valid, void *ptr,
         ScalarRay3f ray = ScalarRay3f(ray_o, ray_d, ray_maxt, ray_time, wavelength_t<Spectrum>());
 
         if constexpr (ShadowRay) {
-            bool hit = kdtree->template ray_intersect_scalar<true>(ray).is_valid();
+            bool hit = s->template ray_intersect_scalar<true>(ray, ray_mask[i]).is_valid();
             if (hit)
                 ray_maxt = 0.f;
         } else {
-            auto pi = kdtree->template ray_intersect_scalar<false>(ray);
+            auto pi = s->template ray_intersect_scalar<false>(ray, ray_mask[i]);
             if (pi.is_valid()) {
                 ScalarFloat& prim_u = ((ScalarFloat*) &args[offsetof(RayHit, u) * Width])[i];
                 ScalarFloat& prim_v = ((ScalarFloat*) &args[offsetof(RayHit, v) * Width])[i];
@@ -172,14 +352,64 @@ void kdtree_trace_func_wrapper(const int *valid, void *ptr,
     }
 }
 
+/// Trace up to \c Width rays of a scalar variant through the kd-tree as one packet
+template <size_t Width, typename Float, typename Spectrum, typename Ray3f,
+          typename PreliminaryIntersection3f>
+void native_trace_rays(const NativeState<Float, Spectrum> *s, const Ray3f *rays,
+                       PreliminaryIntersection3f *pi, size_t count) {
+    using ScalarFloat = dr::scalar_t<Float>;
+    using Point2f   = Point<Float, 2>;
+    using FloatP    = dr::Packet<ScalarFloat, Width>;
+    using MaskP     = dr::mask_t<FloatP>;
+    using Point3fP  = Point<FloatP, 3>;
+    using Ray3fP    = Ray<Point3fP, Spectrum>;
+
+    // Unused lanes repeat the first ray and are disabled
+    Ray3fP ray;
+    FloatP valid = 0.f;
+    for (size_t i = 0; i < Width; ++i) {
+        const Ray3f &r = rays[i < count ? i : 0];
+        for (size_t j = 0; j < 3; ++j) {
+            ray.o[j].entry(i) = r.o[j];
+            ray.d[j].entry(i) = r.d[j];
+        }
+        ray.maxt.entry(i) = r.maxt;
+        ray.time.entry(i) = r.time;
+        if (i < count)
+            valid.entry(i) = 1.f;
+    }
+    MaskP active = dr::neq(valid, 0.f);
+
+    auto ppi = s->kdtree->template ray_intersect_packet<false>(ray, active);
+
+    for (size_t i = 0; i < count; ++i) {
+        if (ppi.instance_index[i] != (uint32_t) -1) {
+            // Let the single ray traversal set up the instance hit
+            pi[i] = s->template ray_intersect_scalar<false>(rays[i]);
+        } else if (ppi.t[i] != dr::Infinity<ScalarFloat>) {
+            pi[i] = dr::zeros<PreliminaryIntersection3f>();
+            pi[i].t           = ppi.t[i];
+            pi[i].prim_uv     = Point2f(ppi.prim_uv.x()[i], ppi.prim_uv.y()[i]);
+            pi[i].prim_index  = ppi.prim_index[i];
+            pi[i].shape_index = ppi.shape_index[i];
+            pi[i].shape       = s->kdtree->shape(ppi.shape_index[i]);
+        } else {
+            pi[i] = PreliminaryIntersection3f();
+        }
+    }
+}
+
 MI_VARIANT typename Scene<Float, Spectrum>::PreliminaryIntersection3f
 Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
                                                       Mask coherent,
-                                                      Mask active) const {
+                                                      Mask active,
+                                                      uint32_t ray_mask) const {
     if constexpr (!dr::is_array_v<Float>) {
         DRJIT_MARK_USED(coherent);
-        const ShapeKDTree *kdtree = (const ShapeKDTree *) m_accel;
-        return kdtree->template ray_intersect_preliminary<false>(ray, active);
+        DRJIT_MARK_USED(active);
+        const NativeState<Float, Spectrum> *s =
+            (const NativeState<Float, Spectrum> *) m_accel;
+        return s->template ray_intersect_scalar<false>(ray, ray_mask);
     } else {
         NativeState<Float, Spectrum> *s = (NativeState<Float, Spectrum> *) m_accel;
         void *func_ptr = nullptr,
@@ -187,14 +417,14 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
 
         int jit_width = jit_llvm_vector_width();
         switch (jit_width) {
-            case 1:  func_ptr = (void *) kdtree_trace_func_wrapper<Float, Spectrum, false, 1>; break;
-            case 4:  func_ptr = (void *) kdtree_trace_func_wrapper<Float, Spectrum, false, 4>; break;
-            case 8:  func_ptr = (void *) kdtree_trace_func_wrapper<Float, Spectrum, false, 8>; break;
-            case 16: func_ptr = (void *) kdtree_trace_func_wrapper<Float, Spectrum, false, 16>; break;
+            case 1:  func_ptr = (void *) native_trace_func_wrapper<Float, Spectrum, false, 1>; break;
+            case 4:  func_ptr = (void *) native_trace_func_wrapper<Float, Spectrum, false, 4>; break;
+            case 8:  func_ptr = (void *) native_trace_func_wrapper<Float, Spectrum, false, 8>; break;
+            case 16: func_ptr = (void *) native_trace_func_wrapper<Float, Spectrum, false, 16>; break;
             default:
                 Throw("ray_intersect_preliminary_cpu(): Dr.Jit is "
                       "configured for vectors of width %u, which is not "
-                      "supported by the kd-tree ray tracing backend!", jit_width);
+                      "supported by the native ray tracing backend!", jit_width);
         }
 
         UInt64 func_v = UInt64::steal(
@@ -204,13 +434,14 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
 
         UInt32 zero = dr::zeros<UInt32>();
         Float ray_mint = dr::zeros<Float>();
+        UInt32 ray_mask_v(ray_mask);
 
         uint32_t in[14] = { coherent.index(),  active.index(),
                             ray.o.x().index(), ray.o.y().index(),
                             ray.o.z().index(), ray_mint.index(),
                             ray.d.x().index(), ray.d.y().index(),
                             ray.d.z().index(), ray.time.index(),
-                            ray.maxt.index(),  zero.index(),
+                            ray.maxt.index(),  ray_mask_v.index(),
                             zero.index(),      zero.index() };
         uint32_t out[6] { };
 
@@ -245,6 +476,32 @@ Scene<Float, Spectrum>::ray_intersect_preliminary_cpu(const Ray3f &ray,
     }
 }
 
+MI_VARIANT void
+Scene<Float, Spectrum>::ray_intersect_preliminary_packet_cpu(
+    const Ray3f *rays, PreliminaryIntersection3f *pi, size_t count) const {
+    if constexpr (!dr::is_array_v<Float>) {
+        const NativeState<Float, Spectrum> *s =
+            (const NativeState<Float, Spectrum> *) m_accel;
+
+        if (!s->kdtree || count == 1) {
+            for (size_t i = 0; i < count; ++i)
+                pi[i] = s->template ray_intersect_scalar<false>(rays[i]);
+        } else if (count <= 4) {
+            native_trace_rays<4>(s, rays, pi, count);
+        } else if (count <= 8) {
+            native_trace_rays<8>(s, rays, pi, count);
+        } else {
+            native_trace_rays<16>(s, rays, pi, count);
+        }
+    } else {
+        DRJIT_MARK_USED(rays);
+        DRJIT_MARK_USED(pi);
+        DRJIT_MARK_USED(count);
+        Throw("ray_intersect_preliminary_packet_cpu() should only be called "
+              "in scalar mode.");
+    }
+}
+
 MI_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_cpu(const Ray3f &ray, uint32_t ray_flags,
                                           Mask coherent, Mask active) const {
@@ -266,20 +523,22 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray,
                                      Mask coherent, Mask active) const {
     if constexpr (!dr::is_jit_v<Float>) {
         DRJIT_MARK_USED(coherent);
-        const ShapeKDTree *kdtree = (const ShapeKDTree *) m_accel;
-        return kdtree->template ray_intersect_preliminary<true>(ray, active).is_valid();
+        DRJIT_MARK_USED(active);
+        const NativeState<Float, Spectrum> *s =
+            (const NativeState<Float, Spectrum> *) m_accel;
+        return s->template ray_intersect_scalar<true>(ray).is_valid();
     } else {
         void *func_ptr = nullptr, *scene_ptr = m_accel;
 
         int jit_width = jit_llvm_vector_width();
         switch (jit_width) {
-            case 1:  func_ptr = (void *) kdtree_trace_func_wrapper<Float, Spectrum, true, 1>; break;
-            case 4:  func_ptr = (void *) kdtree_trace_func_wrapper<Float, Spectrum, true, 4>; break;
-            case 8:  func_ptr = (void *) kdtree_trace_func_wrapper<Float, Spectrum, true, 8>; break;
-            case 16: func_ptr = (void *) kdtree_trace_func_wrapper<Float, Spectrum, true, 16>; break;
+            case 1:  func_ptr = (void *) native_trace_func_wrapper<Float, Spectrum, true, 1>; break;
+            case 4:  func_ptr = (void *) native_trace_func_wrapper<Float, Spectrum, true, 4>; break;
+            case 8:  func_ptr = (void *) native_trace_func_wrapper<Float, Spectrum, true, 8>; break;
+            case 16: func_ptr = (void *) native_trace_func_wrapper<Float, Spectrum, true, 16>; break;
             default:
                 Throw("ray_test_cpu(): Dr.Jit is configured for vectors of "
-                      "width %u, which is not supported by the kd-tree ray "
+                      "width %u, which is not supported by the native ray "
                       "tracing backend!", jit_width);
         }
 
@@ -290,13 +549,14 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray,
 
         UInt32 zero = dr::zeros<UInt32>();
         Float ray_mint = dr::zeros<Float>();
+        UInt32 ray_mask_v((uint32_t) -1);
 
         uint32_t in[14] = { coherent.index(),  active.index(),
                             ray.o.x().index(), ray.o.y().index(),
                             ray.o.z().index(), ray_mint.index(),
                             ray.d.x().index(), ray.d.y().index(),
                             ray.d.z().index(), ray.time.index(),
-                            ray.maxt.index(),  zero.index(),
+                            ray.maxt.index(),  ray_mask_v.index(),
                             zero.index(),      zero.index() };
         uint32_t out[1] { };
 
@@ -308,14 +568,14 @@ Scene<Float, Spectrum>::ray_test_cpu(const Ray3f &ray,
 
 MI_VARIANT typename Scene<Float, Spectrum>::SurfaceInteraction3f
 Scene<Float, Spectrum>::ray_intersect_naive_cpu(const Ray3f &ray, Mask active) const {
-    const ShapeKDTree *kdtree;
-    if constexpr (dr::is_llvm_v<Float>)
-        kdtree = ((NativeState<Float, Spectrum> *) m_accel)->accel;
-    else
-        kdtree = (const ShapeKDTree *) m_accel;
+    const NativeState<Float, Spectrum> *s =
+        (const NativeState<Float, Spectrum> *) m_accel;
 
-    PreliminaryIntersection3f pi =
-        kdtree->template ray_intersect_naive<false>(ray, active);
+    PreliminaryIntersection3f pi;
+    if (s->bvh)
+        pi = s->bvh->template ray_intersect_naive<false>(ray, active);
+    else
+        pi = s->kdtree->template ray_intersect_naive<false>(ray, active);
 
     return pi.compute_surface_interaction(ray, +RayFlags::All, active);
 }
@@ -1,6 +1,7 @@
 #include <iomanip>
 #include <cstring>
 #include <cstdio>
+#include <mutex>
 
 #include <drjit-core/optix.h>
 
@@ -30,11 +31,75 @@ struct OptixSceneState {
     OptixAccelData accel;
     OptixTraversableHandle ias_handle = 0ull;
     void* ias_buffer = nullptr;
+    /// Size of the IAS in device memory in bytes
+    size_t ias_size = 0;
     size_t config_index;
     uint32_t sbt_jit_index;
     bool own_sbt;
+    /// Host copy of the uploaded hit group records (see \ref upload_hitgroup_records())
+    std::vector<HitGroupSbtRecord> hitgroup_records;
 };
 
+/**
+ * \brief Upload the hit group records of the shader binding table of a scene
+ *
+ * When the number of records did not change, only the ranges of records that
+ * differ from the previous upload are copied into the current device buffer.
+ * Otherwise, a new buffer is allocated, in which case the function returns
+ * \c true, and the new table must be passed to Dr.Jit.
+ */
+static bool upload_hitgroup_records(OptixSceneState &s,
+                                    std::vector<HitGroupSbtRecord> &&records) {
+    size_t count = records.size(),
+           record_size = sizeof(HitGroupSbtRecord);
+
+    if (s.sbt.hitgroupRecordBase && count == s.hitgroup_records.size()) {
+        const HitGroupSbtRecord *prev = s.hitgroup_records.data();
+        size_t updated = 0;
+
+        for (size_t i = 0; i < count;) {
+            if (memcmp(&records[i], &prev[i], record_size) == 0) {
+                ++i;
+                continue;
+            }
+
+            size_t j = i + 1;
+            while (j < count && memcmp(&records[j], &prev[j], record_size) != 0)
+                ++j;
+
+            size_t size = (j - i) * record_size;
+            void *tmp = jit_malloc(AllocType::HostPinned, size);
+            memcpy(tmp, records.data() + i, size);
+            jit_memcpy_async(JitBackend::CUDA,
+                             (uint8_t *) s.sbt.hitgroupRecordBase + i * record_size,
+                             tmp, size);
+            jit_free(tmp);
+
+            updated += j - i;
+            i = j;
+        }
+
+        Log(Debug, "Updated %zu/%zu hit group records of the shader binding table.",
+            updated, count);
+        s.hitgroup_records = std::move(records);
+        return false;
+    }
+
+    s.sbt.hitgroupRecordBase =
+        jit_malloc(AllocType::HostPinned, count * record_size);
+    s.sbt.hitgroupRecordStrideInBytes = (unsigned int) record_size;
+    s.sbt.hitgroupRecordCount = (unsigned int) count;
+
+    jit_memcpy_async(JitBackend::CUDA, s.sbt.hitgroupRecordBase, records.data(),
+                     count * record_size);
+
+    s.sbt.hitgroupRecordBase =
+        jit_malloc_migrate(s.sbt.hitgroupRecordBase, AllocType::Device, 1);
+
+    s.hitgroup_records = std::move(records);
+    return true;
+}
+
 /**
  * \brief Optix configuration data structure
  *
@@ -57,19 +122,32 @@ struct OptixConfig {
 };
 
 // Array storing previously initialized optix configurations
-static constexpr int32_t OPTIX_CONFIG_COUNT = 32;
+static constexpr int32_t OPTIX_CONFIG_COUNT = 64;
 static OptixConfig optix_configs[OPTIX_CONFIG_COUNT] = {};
 
+/// Protects \ref optix_configs when scenes are created by several threads
+static std::mutex optix_configs_mutex;
+
+/// Compute config index in optix_configs based on required set of features
+size_t optix_config_index(bool has_meshes, bool has_others, bool has_instances,
+                          bool has_bspline_curves, bool has_linear_curves,
+                          bool has_motion) {
+    return (has_motion ? 32 : 0) +
+           (has_bspline_curves ? 16 : 0) +
+           (has_linear_curves ? 8 : 0) +
+           (has_instances ? 4 : 0) +
+           (has_meshes ? 2 : 0) +
+           (has_others ? 1 : 0);
+}
+
 size_t init_optix_config(bool has_meshes, bool has_others, bool has_instances,
-                         bool has_bspline_curves, bool has_linear_curves) {
-    // Compute config index in optix_configs based on required set of features
+                         bool has_bspline_curves, bool has_linear_curves,
+                         bool has_motion) {
     size_t config_index =
-        (has_bspline_curves ? 16 : 0) +
-        (has_linear_curves ? 8 : 0) +
-        (has_instances ? 4 : 0) +
-        (has_meshes ? 2 : 0) +
-        (has_others ? 1 : 0);
+        optix_config_index(has_meshes, has_others, has_instances,
+                           has_bspline_curves, has_linear_curves, has_motion);
 
+    std::lock_guard<std::mutex> guard(optix_configs_mutex);
     OptixConfig &config = optix_configs[config_index];
 
     // Initialize Optix config if necessary
@@ -92,7 +170,7 @@ size_t init_optix_config(bool has_meshes, bool has_others, bool has_instances,
         module_compile_options.debugLevel       = OPTIX_COMPILE_DEBUG_LEVEL_MINIMAL;
     #endif
 
-        config.pipeline_compile_options.usesMotionBlur     = false;
+        config.pipeline_compile_options.usesMotionBlur     = has_motion;
         config.pipeline_compile_options.numPayloadValues   = 6;
         config.pipeline_compile_options.numAttributeValues = 2; // the minimum legal value
         config.pipeline_compile_options.pipelineLaunchParamsVariableName = "params";
@@ -207,8 +285,7 @@ size_t init_optix_config(bool has_meshes, bool has_others, bool has_instances,
             options.usesMotionBlur        = false;
             options.curveEndcapFlags      = 0;
             // buildFlags must match the flags used in OptixAccelBuildOptions (shapes.h)
-            options.buildFlags            = OPTIX_BUILD_FLAG_ALLOW_COMPACTION |
-                                            OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
+            options.buildFlags            = OPTIX_CURVE_BUILD_FLAGS;
             jit_optix_check(
                 optixBuiltinISModuleGet(config.context, &module_compile_options,
                                         &config.pipeline_compile_options,
@@ -220,8 +297,7 @@ size_t init_optix_config(bool has_meshes, bool has_others, bool has_instances,
             options.usesMotionBlur      = false;
             options.curveEndcapFlags    = 0;
             // buildFlags must match the flags used in OptixAccelBuildOptions (shapes.h)
-            options.buildFlags          = OPTIX_BUILD_FLAG_ALLOW_COMPACTION |
-                                          OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
+            options.buildFlags          = OPTIX_CURVE_BUILD_FLAGS;
             jit_optix_check(
                 optixBuiltinISModuleGet(config.context, &module_compile_options,
                                         &config.pipeline_compile_options,
@@ -302,6 +378,8 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &props)
     DRJIT_MARK_USED(props);
     if constexpr (dr::is_cuda_v<Float>) {
         ScopedPhase phase(ProfilerPhase::InitAccel);
+        ScopedTraceEvent trace("accel", "OptiX build");
+        trace.set_arg("shapes", m_shapes.size());
         Log(Info, "Building scene in OptiX ..");
         Timer timer;
         optix_initialize();
@@ -327,33 +405,17 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &props)
 
             const OptixConfig &config = optix_configs[s2.config_index];
 
-            HitGroupSbtRecord* prev_data
-                = (HitGroupSbtRecord*) jit_malloc_migrate(s2.sbt.hitgroupRecordBase, AllocType::Host, 1);
-            dr::sync_thread();
-
-            std::vector<HitGroupSbtRecord> hg_sbts;
-            hg_sbts.assign(prev_data, prev_data + s2.sbt.hitgroupRecordCount);
-            jit_free(prev_data);
-
+            // The records of the other scene are taken from its host copy
+            std::vector<HitGroupSbtRecord> hg_sbts = s2.hitgroup_records;
             fill_hitgroup_records(m_shapes, hg_sbts, config.program_groups);
             for (auto& shapegroup: m_shapegroups)
                 shapegroup->optix_fill_hitgroup_records(hg_sbts, config.program_groups);
 
-            size_t shapes_count = hg_sbts.size();
-
-            s2.sbt.hitgroupRecordBase = jit_malloc(
-                AllocType::HostPinned, shapes_count * sizeof(HitGroupSbtRecord));
-            s2.sbt.hitgroupRecordCount = (unsigned int) shapes_count;
-
-            jit_memcpy_async(JitBackend::CUDA, s2.sbt.hitgroupRecordBase, hg_sbts.data(),
-                             shapes_count * sizeof(HitGroupSbtRecord));
-
-            s2.sbt.hitgroupRecordBase =
-                jit_malloc_migrate(s2.sbt.hitgroupRecordBase, AllocType::Device, 1);
-
-            jit_optix_update_sbt(s2.sbt_jit_index, &s2.sbt);
+            if (upload_hitgroup_records(s2, std::move(hg_sbts)))
+                jit_optix_update_sbt(s2.sbt_jit_index, &s2.sbt);
 
             memcpy(&s.sbt, &s2.sbt, sizeof(OptixShaderBindingTable));
+            s.hitgroup_records = s2.hitgroup_records;
             s.sbt_jit_index = s2.sbt_jit_index;
             s.config_index = s2.config_index;
             s.own_sbt = false;
@@ -367,8 +429,10 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &props)
             bool has_instances = false;
             bool has_bspline_curves = false;
             bool has_linear_curves = false;
+            bool has_motion = false;
 
             for (auto& shape : m_shapes) {
+                has_motion           |= shape->has_motion();
                 has_meshes           |= shape->is_mesh();
                 has_others           |= !shape->is_mesh() && !shape->is_instance();
                 has_instances        |= shape->is_instance();
@@ -381,10 +445,12 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &props)
                 has_bspline_curves |= shape->has_bspline_curves();
                 has_linear_curves |= shape->has_linear_curves();
                 has_others |= shape->has_others();
+                has_motion |= shape->has_motion();
             }
 
             s.config_index = init_optix_config(has_meshes, has_others,
-                has_instances, has_bspline_curves, has_linear_curves);
+                has_instances, has_bspline_curves, has_linear_curves,
+                has_motion);
             const OptixConfig &config = optix_configs[s.config_index];
 
             // =====================================================
@@ -403,21 +469,10 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_init_gpu(const Properties &props)
             fill_hitgroup_records(m_shapes, hg_sbts, config.program_groups);
             for (auto& shapegroup: m_shapegroups)
                 shapegroup->optix_fill_hitgroup_records(hg_sbts, config.program_groups);
-
-            size_t shapes_count = hg_sbts.size();
-
-            s.sbt.hitgroupRecordBase = jit_malloc(
-                AllocType::HostPinned, shapes_count * sizeof(HitGroupSbtRecord));
-            s.sbt.hitgroupRecordStrideInBytes = sizeof(HitGroupSbtRecord);
-            s.sbt.hitgroupRecordCount = (unsigned int) shapes_count;
-
-            jit_memcpy_async(JitBackend::CUDA, s.sbt.hitgroupRecordBase, hg_sbts.data(),
-                             shapes_count * sizeof(HitGroupSbtRecord));
+            upload_hitgroup_records(s, std::move(hg_sbts));
 
             s.sbt.missRecordBase =
                 jit_malloc_migrate(s.sbt.missRecordBase, AllocType::Device, 1);
-            s.sbt.hitgroupRecordBase =
-                jit_malloc_migrate(s.sbt.hitgroupRecordBase, AllocType::Device, 1);
 
             s.sbt_jit_index = jit_optix_configure_sbt(&s.sbt, config.pipeline_jit_index);
             s.own_sbt = true;
@@ -440,10 +495,26 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
         const OptixConfig &config = optix_configs[s.config_index];
 
         if (!m_shapes.empty()) {
+            /* Refit the geometry acceleration structures if possible, and
+               rebuild them once their quality degraded too much */
+            bool refit = accel_refit_possible() &&
+                         accel_refit_degradation() <= m_accel_refit_threshold;
+
+            OptixGASOptions gas_options;
+            gas_options.fast_build    = m_accel_build == AccelBuild::FastBuild;
+            gas_options.compaction    = m_accel_compaction;
+            gas_options.allow_update  = m_accel_refit;
+            gas_options.memory_report = m_accel_memory_report;
+
+            if (m_accel_memory_report)
+                Log(Info, "OptiX acceleration structure memory usage:");
+
             // Build geometry acceleration structures for all the shapes
-            build_gas(config.context, m_shapes, s.accel);
+            build_gas(config.context, m_shapes, s.accel, gas_options, refit);
+            if (!refit)
+                accel_refit_record_build();
             for (auto& shapegroup: m_shapegroups)
-                shapegroup->optix_build_gas(config.context);
+                shapegroup->optix_build_gas(config.context, gas_options);
 
             // Gather information about the instance acceleration structures to be built
             std::vector<OptixInstance> ias;
@@ -455,11 +526,14 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
                     Throw("OPTIX_TRAVERSABLE_GRAPH_FLAG_ALLOW_SINGLE_GAS used but found multiple IASs.");
                 s.ias_buffer = nullptr;
                 s.ias_handle = ias[0].traversableHandle;
+                s.ias_size = 0;
             } else {
                 // Build a "master" IAS that contains all the IAS of the scene (meshes,
                 // custom shapes, instances, ...)
                 OptixAccelBuildOptions accel_options = {};
-                accel_options.buildFlags = OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
+                accel_options.buildFlags = m_accel_build == AccelBuild::FastBuild
+                                               ? OPTIX_BUILD_FLAG_PREFER_FAST_BUILD
+                                               : OPTIX_BUILD_FLAG_PREFER_FAST_TRACE;
                 accel_options.operation  = OPTIX_BUILD_OPERATION_BUILD;
                 accel_options.motionOptions.numKeys = 0;
 
@@ -489,6 +563,7 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
                     = jit_malloc(AllocType::Device, buffer_sizes.tempSizeInBytes);
                 s.ias_buffer
                     = jit_malloc(AllocType::Device, buffer_sizes.outputSizeInBytes);
+                s.ias_size = buffer_sizes.outputSizeInBytes;
 
                 scoped_optix_context guard;
 
@@ -508,7 +583,22 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
                 ));
 
                 jit_free(d_temp_buffer);
+
+                if (m_accel_memory_report)
+                    Log(Info, "  IAS: %u instances use %s (%s temporary)",
+                        (uint32_t) ias.size(),
+                        util::mem_string(buffer_sizes.outputSizeInBytes),
+                        util::mem_string(buffer_sizes.tempSizeInBytes));
             }
+
+            // Summed footprint of the GAS of the scene and its shape groups
+            size_t total = s.accel.size();
+            for (auto& shapegroup: m_shapegroups)
+                total += shapegroup->optix_accel().size();
+            Log(m_accel_memory_report ? Info : Debug,
+                "OptiX acceleration structures use %s (GAS: %s, IAS: %s)",
+                util::mem_string(total + s.ias_size), util::mem_string(total),
+                util::mem_string(s.ias_size));
         }
 
         /* Set up a callback on the handle variable to release the OptiX scene
@@ -538,6 +628,79 @@ MI_VARIANT void Scene<Float, Spectrum>::accel_parameters_changed_gpu() {
     }
 }
 
+MI_VARIANT void Scene<Float, Spectrum>::accel_shapes_changed_gpu() {
+    if constexpr (dr::is_cuda_v<Float>) {
+        OptixSceneState &s = *(OptixSceneState *) m_accel;
+
+        if (!s.own_sbt)
+            Throw("Shapes cannot be added to or removed from a scene that "
+                  "shares the shader binding table of another scene!");
+
+        bool has_meshes = false;
+        bool has_others = false;
+        bool has_instances = false;
+        bool has_bspline_curves = false;
+        bool has_linear_curves = false;
+        bool has_motion = false;
+
+        for (auto& shape : m_shapes) {
+            has_motion           |= shape->has_motion();
+            has_meshes           |= shape->is_mesh();
+            has_others           |= !shape->is_mesh() && !shape->is_instance();
+            has_instances        |= shape->is_instance();
+            has_bspline_curves   |= shape->is_bspline_curve();
+            has_linear_curves    |= shape->is_linear_curve();
+        }
+
+        for (auto& shape : m_shapegroups) {
+            has_meshes |= shape->has_meshes();
+            has_bspline_curves |= shape->has_bspline_curves();
+            has_linear_curves |= shape->has_linear_curves();
+            has_others |= shape->has_others();
+            has_motion |= shape->has_motion();
+        }
+
+        /* The pipeline of the scene was compiled for a fixed set of features,
+           which must cover the ones of the modified scene */
+        size_t config_index =
+            optix_config_index(has_meshes, has_others, has_instances,
+                               has_bspline_curves, has_linear_curves, has_motion);
+        if ((config_index & ~s.config_index) != 0)
+            Throw("The modified scene contains kinds of shapes (e.g. instances, "
+                  "curves or moving shapes) that are not supported by the OptiX "
+                  "pipeline of the original scene. Please create a new scene!");
+
+        const OptixConfig &config = optix_configs[s.config_index];
+
+        /* Regenerate the hit group records in the order of the shapes. Only
+           the records of shapes that were added, removed or moved within the
+           table are uploaded when the table keeps its size. */
+        std::vector<HitGroupSbtRecord> hg_sbts;
+        fill_hitgroup_records(m_shapes, hg_sbts, config.program_groups);
+        for (auto& shapegroup: m_shapegroups)
+            shapegroup->optix_fill_hitgroup_records(hg_sbts, config.program_groups);
+
+        if (upload_hitgroup_records(s, std::move(hg_sbts)))
+            jit_optix_update_sbt(s.sbt_jit_index, &s.sbt);
+
+        // An empty scene is not traced against the previous IAS
+        if (m_shapes.empty())
+            s.ias_handle = 0ull;
+    }
+}
+
+MI_VARIANT size_t Scene<Float, Spectrum>::accel_memory_footprint_gpu() const {
+    if constexpr (dr::is_cuda_v<Float>) {
+        if (!m_accel)
+            return 0;
+        // The GAS of shape groups are attributed to the groups
+        const OptixSceneState &s = *(const OptixSceneState *) m_accel;
+        return s.accel.size() + s.ias_size;
+    } else {
+        return 0;
+    }
+}
+
 MI_VARIANT void Scene<Float, Spectrum>::accel_release_gpu() {
     if constexpr (dr::is_cuda_v<Float>) {
         Log(Debug, "Scene GPU acceleration release ..");
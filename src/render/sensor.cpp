@@ -103,6 +103,11 @@ Sensor<Float, Spectrum>::sample_ray_differential(Float time, Float sample1, cons
     return { result_ray, result_spec };
 }
 
+MI_VARIANT Float Sensor<Float, Spectrum>::circle_of_confusion(const Point3f & /*p*/,
+                                                            Mask /*active*/) const {
+    return 0.f;
+}
+
 MI_VARIANT std::pair<typename Sensor<Float, Spectrum>::Wavelength, Spectrum>
 Sensor<Float, Spectrum>::sample_wavelengths(const SurfaceInteraction3f& /*si*/, Float sample,
                                             Mask active) const {
@@ -88,6 +88,10 @@ MI_VARIANT bool Shape<Float, Spectrum>::is_mesh() const {
     return class_()->derives_from(Mesh<Float, Spectrum>::m_class);
 }
 
+MI_VARIANT bool Shape<Float, Spectrum>::has_motion() const {
+    return false;
+}
+
 MI_VARIANT bool Shape<Float, Spectrum>::is_bspline_curve() const {
     return false;
 }
@@ -317,6 +321,10 @@ MI_VARIANT RTCGeometry Shape<Float, Spectrum>::embree_geometry(RTCDevice device)
         Throw("embree_geometry() should only be called in CPU mode.");
     }
 }
+
+MI_VARIANT void Shape<Float, Spectrum>::embree_update_geometry(RTCGeometry geom) {
+    rtcCommitGeometry(geom);
+}
 #endif
 
 #if defined(MI_ENABLE_CUDA)
@@ -454,6 +462,21 @@ Shape<Float, Spectrum>::ray_intersect(const Ray3f &ray, uint32_t ray_flags, Mask
     return pi.compute_surface_interaction(ray, ray_flags, active);
 }
 
+MI_VARIANT typename Shape<Float, Spectrum>::Mask
+Shape<Float, Spectrum>::alpha_test(const Ray3f &ray,
+                                   const PreliminaryIntersection3f &pi,
+                                   Mask active) const {
+    if (!m_bsdf || !m_bsdf->has_alpha_test())
+        return true;
+
+    // The opacity textures only require the UV coordinates
+    uint32_t ray_flags = RayFlags::Minimal | RayFlags::UV;
+    SurfaceInteraction3f si =
+        compute_surface_interaction(ray, pi, ray_flags, 0u, active);
+    si.finalize_surface_interaction(pi, ray, ray_flags, active);
+    return m_bsdf->alpha_test(si, active);
+}
+
 MI_VARIANT typename Shape<Float, Spectrum>::Mask
 Shape<Float, Spectrum>::has_attribute(const std::string& name, Mask /*active*/) const {
     return m_texture_attributes.find(name) != m_texture_attributes.end();
@@ -569,6 +592,8 @@ MI_VARIANT bool Shape<Float, Spectrum>::parameters_grad_enabled() const {
     return false;
 }
 
+MI_VARIANT void Shape<Float, Spectrum>::select_lod(const Sensor * /* sensor */) { }
+
 MI_VARIANT void Shape<Float, Spectrum>::initialize() {
     if constexpr (dr::is_jit_v<Float>) {
         if (!is_mesh() && !is_bspline_curve() && !is_linear_curve()) // to_world/to_object is not used
@@ -15,6 +15,7 @@ MI_VARIANT ShapeGroup<Float, Spectrum>::ShapeGroup(const Properties &props) {
     m_has_others = false;
     m_has_bspline_curves = false;
     m_has_linear_curves = false;
+    m_has_motion = false;
 
     // Add children to the underlying data structure
     for (auto &kv : props.objects()) {
@@ -53,6 +54,8 @@ MI_VARIANT ShapeGroup<Float, Spectrum>::ShapeGroup(const Properties &props) {
 
                 bool is_other = !is_mesh && !is_bspline && !is_linear;
                 m_has_others |= is_other;
+
+                m_has_motion |= shape->has_motion();
             }
         } else {
             Throw("Tried to add an unsupported object of type \"%s\"", kv.second);
@@ -169,9 +172,13 @@ MI_VARIANT void ShapeGroup<Float, Spectrum>::optix_fill_hitgroup_records(std::ve
 
 MI_VARIANT void ShapeGroup<Float, Spectrum>::optix_prepare_geometry() { }
 
-MI_VARIANT void ShapeGroup<Float, Spectrum>::optix_build_gas(const OptixDeviceContext& context) {
+MI_VARIANT void ShapeGroup<Float, Spectrum>::optix_build_gas(const OptixDeviceContext& context,
+                                                             const OptixGASOptions &options) {
     if (m_dirty) {
-        build_gas(context, m_shapes, m_accel);
+        // Shape groups are always rebuilt entirely
+        OptixGASOptions group_options = options;
+        group_options.allow_update = false;
+        build_gas(context, m_shapes, m_accel, group_options);
         for (auto &s : m_shapes)
             s->m_dirty = false;
     }
@@ -179,12 +186,18 @@ MI_VARIANT void ShapeGroup<Float, Spectrum>::optix_build_gas(const OptixDeviceCo
 #endif
 
 #if defined(MI_ENABLE_EMBREE)
-MI_VARIANT RTCGeometry ShapeGroup<Float, Spectrum>::embree_geometry(RTCDevice device) {
+MI_VARIANT void ShapeGroup<Float, Spectrum>::embree_build(RTCDevice device,
+                                                          RTCBuildQuality quality,
+                                                          RTCSceneFlags flags) {
     DRJIT_MARK_USED(device);
+    DRJIT_MARK_USED(quality);
+    DRJIT_MARK_USED(flags);
     if constexpr (!dr::is_cuda_v<Float>) {
         if (m_dirty) {
             if (m_embree_scene == nullptr)
                 m_embree_scene = rtcNewScene(device);
+            rtcSetSceneBuildQuality(m_embree_scene, quality);
+            rtcSetSceneFlags(m_embree_scene, flags);
 
             for (int geo : m_embree_geometries)
                 rtcDetachGeometry(m_embree_scene, geo);
@@ -209,6 +222,16 @@ MI_VARIANT RTCGeometry ShapeGroup<Float, Spectrum>::embree_geometry(RTCDevice de
             // rebuild the BVH once per update.
             m_dirty = false;
         }
+    } else {
+        Throw("embree_build() should only be called in CPU mode.");
+    }
+}
+
+MI_VARIANT RTCGeometry ShapeGroup<Float, Spectrum>::embree_geometry(RTCDevice device) {
+    DRJIT_MARK_USED(device);
+    if constexpr (!dr::is_cuda_v<Float>) {
+        // Shape groups that were not built upfront by the scene are built on demand
+        embree_build(device);
 
         RTCGeometry instance = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_INSTANCE);
         rtcSetGeometryInstancedScene(instance, m_embree_scene);
@@ -243,6 +266,21 @@ MI_VARIANT bool ShapeGroup<Float, Spectrum>::parameters_grad_enabled() const {
     return false;
 }
 
+MI_VARIANT size_t ShapeGroup<Float, Spectrum>::memory_footprint() const {
+#if defined(MI_ENABLE_CUDA)
+    if constexpr (dr::is_cuda_v<Float>)
+        return m_accel.size();
+#endif
+
+#if !defined(MI_ENABLE_EMBREE)
+    if constexpr (!dr::is_cuda_v<Float>)
+        return m_kdtree->memory_footprint();
+#endif
+
+    // The Embree BVH of the group is attributed to the scene that uses it
+    return 0;
+}
+
 MI_VARIANT std::string ShapeGroup<Float, Spectrum>::to_string() const {
     std::ostringstream oss;
         oss << "ShapeGroup[" << std::endl
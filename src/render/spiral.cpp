@@ -1,3 +1,4 @@
+#include <drjit/morton.h>
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/render/spiral.h>
 #include <mitsuba/mitsuba.h>
@@ -5,67 +6,148 @@
 NAMESPACE_BEGIN(mitsuba)
 
 Spiral::Spiral(const Vector2u &size, const Vector2u &offset,
-               uint32_t block_size, uint32_t passes)
-    : m_size(size), m_offset(offset), m_passes_left(passes),
-      m_block_size(block_size) {
+               uint32_t block_size, uint32_t passes, BlockOrder order)
+    : m_size(size), m_offset(offset), m_block_counter(0),
+      m_passes(passes), m_block_size(block_size), m_order(order) {
 
     m_blocks = (size + (block_size - 1)) / block_size;
     m_block_count = dr::prod(m_blocks);
 
-    reset();
+    compute_block_order();
 }
 
-void Spiral::reset() {
-    m_block_counter = 0;
-    direction = Direction::Right;
-    m_position = Vector2u(m_blocks / 2);
-    m_steps_left = 1;
-    m_spiral_size = 1;
-}
-
-std::tuple<Spiral::Vector2i, Spiral::Vector2u, uint32_t> Spiral::next_block() {
+void Spiral::compute_block_order() {
     // Reimplementation of the spiraling block generator by Adam Arbree.
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    if (m_block_counter == m_block_count) {
-        if (m_passes_left > 1) {
-            --m_passes_left;
-            reset();
-        } else {
-            return { 0, 0, (uint32_t) -1 };
-        }
-    }
+    m_block_order.clear();
+    m_block_order.reserve(m_block_count);
 
-    // Calculate a unique identifier per block
-    uint32_t block_id =
-        m_block_counter + (m_passes_left - 1) * m_block_count;
+    if (m_block_count == 0)
+        return;
 
-    Vector2u offset = m_position * m_block_size,
-             size   = dr::minimum(m_block_size, m_size - offset);
+    if (m_order != BlockOrder::Spiral) {
+        compute_curve_order();
+        return;
+    }
 
-    Assert(dr::all(offset <= m_size));
+    Direction direction = Direction::Right;
+    Point2i position = Vector2u(m_blocks / 2);
+    uint32_t steps_left = 1, spiral_size = 1;
+
+    while (true) {
+        m_block_order.push_back(Vector2u(position));
 
-    ++m_block_counter;
+        if (m_block_order.size() == m_block_count)
+            break;
 
-    if (m_block_counter != m_block_count) {
         // Prepare the next block's position along the spiral.
         do {
             switch (direction) {
-                case Direction::Right: ++m_position.x(); break;
-                case Direction::Down:  ++m_position.y(); break;
-                case Direction::Left:  --m_position.x(); break;
-                case Direction::Up:    --m_position.y(); break;
+                case Direction::Right: ++position.x(); break;
+                case Direction::Down:  ++position.y(); break;
+                case Direction::Left:  --position.x(); break;
+                case Direction::Up:    --position.y(); break;
             }
 
-            if (--m_steps_left == 0) {
+            if (--steps_left == 0) {
                 direction = Direction(((int) direction + 1) % 4);
                 if (direction == Direction::Left ||
                     direction == Direction::Right)
-                    ++m_spiral_size;
-                m_steps_left = m_spiral_size;
+                    ++spiral_size;
+                steps_left = spiral_size;
             }
-        } while (dr::any(m_position < 0 || m_position >= m_blocks));
+        } while (dr::any(position < 0 || position >= m_blocks));
+    }
+}
+
+/// Map a distance along a Hilbert curve filling an n x n grid to its cell
+static Spiral::Vector2u hilbert_cell(uint32_t n, uint32_t d) {
+    uint32_t x = 0, y = 0;
+    for (uint32_t s = 1; s < n; s *= 2) {
+        uint32_t rx = 1 & (d / 2),
+                 ry = 1 & (d ^ rx);
+
+        // Rotate the quadrant
+        if (ry == 0) {
+            if (rx == 1) {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+            std::swap(x, y);
+        }
+
+        x += s * rx;
+        y += s * ry;
+        d /= 4;
+    }
+    return { x, y };
+}
+
+void Spiral::compute_curve_order() {
+    /* Traverse the curve of the smallest power-of-two grid that contains all
+       blocks and skip the cells outside of the image */
+    uint32_t n = 1;
+    while (n < dr::max(m_blocks))
+        n *= 2;
+
+    for (uint32_t d = 0; m_block_order.size() < m_block_count; ++d) {
+        Vector2u cell = m_order == BlockOrder::Hilbert
+                            ? hilbert_cell(n, d)
+                            : dr::morton_decode<Vector2u>(d);
+        if (dr::all(cell < m_blocks))
+            m_block_order.push_back(cell);
     }
+}
+
+void Spiral::reset() {
+    /* Rewind to the beginning of the pass that is currently in progress (or
+       that was completed last). Passes that are fully done stay done. */
+    uint32_t counter = m_block_counter.load(std::memory_order_relaxed),
+             pass    = 0;
+
+    if (counter > 0 && m_block_count > 0)
+        pass = std::min((counter - 1) / m_block_count, m_passes - 1);
+
+    m_block_counter.store(pass * m_block_count, std::memory_order_relaxed);
+}
+
+std::tuple<Spiral::Vector2i, Spiral::Vector2u, uint32_t> Spiral::next_block() {
+    auto [begin, end] = next_blocks(1);
+    if (begin == end)
+        return { 0, 0, (uint32_t) -1 };
+    return block(begin);
+}
+
+std::pair<uint32_t, uint32_t> Spiral::next_blocks(uint32_t count) {
+    uint32_t total   = m_block_count * m_passes,
+             counter = m_block_counter.fetch_add(count, std::memory_order_relaxed);
+
+    uint32_t end = std::min(counter + count, total);
+    if (counter + count > total) {
+        /* Don't let the counter wrap around when polled after completion,
+           it ends up at 'total' once all calls have returned */
+        m_block_counter.fetch_sub(counter + count - std::max(counter, total),
+                                  std::memory_order_relaxed);
+    }
+
+    if (counter >= end)
+        return { 0, 0 };
+    return { counter, end };
+}
+
+std::tuple<Spiral::Vector2i, Spiral::Vector2u, uint32_t>
+Spiral::block(uint32_t counter) const {
+    Assert(counter < m_block_count * m_passes);
+
+    uint32_t pass  = counter / m_block_count,
+             index = counter - pass * m_block_count;
+
+    // Calculate a unique identifier per block
+    uint32_t block_id = index + (m_passes - pass - 1) * m_block_count;
+
+    Vector2u offset = m_block_order[index] * m_block_size,
+             size   = dr::minimum(m_block_size, m_size - offset);
+
+    Assert(dr::all(offset <= m_size));
 
     return { offset + m_offset, size, block_id };
 }
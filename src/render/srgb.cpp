@@ -3,37 +3,94 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/srgb.h>
+#include <nanothread/nanothread.h>
 #include <rgb2spec.h>
+#include <atomic>
+#include <limits>
 #include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
-static RGB2Spec *model = nullptr;
+static std::atomic<RGB2Spec *> model { nullptr };
 static std::mutex model_mutex;
 
+/// Number of colors that are converted by a single work unit of the thread pool
+static constexpr size_t fetch_block_size = 4096;
+
+/// Return the upsampling model, loading it upon first use
+static RGB2Spec *srgb_model() {
+    RGB2Spec *result = model.load(std::memory_order_acquire);
+    if (likely(result != nullptr))
+        return result;
+
+    std::lock_guard<std::mutex> lock(model_mutex);
+    result = model.load(std::memory_order_relaxed);
+    if (result == nullptr) {
+        FileResolver *fr = Thread::thread()->file_resolver();
+        std::string fname = fr->resolve("data/srgb.coeff").string();
+        Log(Info, "Loading spectral upsampling model \"data/srgb.coeff\" .. ");
+        result = rgb2spec_load(fname.c_str());
+        if (result == nullptr)
+            Throw("Could not load sRGB-to-spectrum upsampling model ('data/srgb.coeff')");
+        model.store(result, std::memory_order_release);
+        atexit([]{ rgb2spec_free(model.load()); });
+    }
+    return result;
+}
+
 dr::Array<float, 3> srgb_model_fetch(const Color<float, 3> &c) {
     using Array3f = dr::Array<float, 3>;
 
-    if (unlikely(model == nullptr)) {
-        std::lock_guard<std::mutex> lock(model_mutex);
-        if (model == nullptr) {
-            FileResolver *fr = Thread::thread()->file_resolver();
-            std::string fname = fr->resolve("data/srgb.coeff").string();
-            Log(Info, "Loading spectral upsampling model \"data/srgb.coeff\" .. ");
-            model = rgb2spec_load(fname.c_str());
-            if (model == nullptr)
-                Throw("Could not load sRGB-to-spectrum upsampling model ('data/srgb.coeff')");
-            atexit([]{ rgb2spec_free(model); });
-        }
-    }
-
     float rgb[3] = { (float) c.r(), (float) c.g(), (float) c.b() };
     float out[3];
-    rgb2spec_fetch(model, rgb, out);
+    rgb2spec_fetch(srgb_model(), rgb, out);
 
     return Array3f(out[0], out[1], out[2]);
 }
 
+template <typename T>
+static void srgb_model_fetch_impl(const T *rgb, T *coeff, size_t count) {
+    RGB2Spec *m = srgb_model();
+
+    auto fetch = [m](const T *in, T *out, size_t n) {
+        /* Neighboring texels frequently have the same color (e.g. in flat
+           regions of textures), reuse the previous result in this case */
+        const float nan = std::numeric_limits<float>::quiet_NaN();
+        float prev[3] = { nan, nan, nan }, prev_out[3] = { 0.f, 0.f, 0.f };
+        for (size_t i = 0; i < n; ++i, in += 3, out += 3) {
+            float value[3] = { (float) in[0], (float) in[1], (float) in[2] };
+            if (value[0] != prev[0] || value[1] != prev[1] || value[2] != prev[2]) {
+                rgb2spec_fetch(m, value, prev_out);
+                prev[0] = value[0]; prev[1] = value[1]; prev[2] = value[2];
+            }
+            out[0] = (T) prev_out[0];
+            out[1] = (T) prev_out[1];
+            out[2] = (T) prev_out[2];
+        }
+    };
+
+    if (count <= fetch_block_size) {
+        fetch(rgb, coeff, count);
+        return;
+    }
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, count, fetch_block_size),
+        [&](const dr::blocked_range<size_t> &range) {
+            fetch(rgb + range.begin() * 3, coeff + range.begin() * 3,
+                  range.end() - range.begin());
+        }
+    );
+}
+
+void srgb_model_fetch(const float *rgb, float *coeff, size_t count) {
+    srgb_model_fetch_impl(rgb, coeff, count);
+}
+
+void srgb_model_fetch(const double *rgb, double *coeff, size_t count) {
+    srgb_model_fetch_impl(rgb, coeff, count);
+}
+
 #if 0
 Color<float, 3> srgb_model_eval_rgb(const dr::Array<float, 3> &coeff) {
     using Array3f = dr::Array<float, 3>;
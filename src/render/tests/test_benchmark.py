@@ -0,0 +1,38 @@
+import pytest
+import mitsuba as mi
+
+from mitsuba import bench
+
+
+@pytest.fixture(scope='module')
+def baseline_store(pytestconfig):
+    store = bench.BaselineStore(pytestconfig.getoption('--benchmark-baseline'))
+    yield store
+    if pytestconfig.getoption('--benchmark-update'):
+        store.save()
+
+
+@pytest.mark.benchmark
+@pytest.mark.parametrize('variant', bench.DEFAULT_VARIANTS)
+@pytest.mark.parametrize('scene', bench.SCENES)
+def test01_throughput(pytestconfig, baseline_store, variant, scene):
+    if variant not in mi.variants():
+        pytest.skip('Mitsuba variant "%s" is not enabled!' % variant)
+
+    # Runs in a separate process, like the benchmark suite
+    result = bench.run_process(
+        variant, scene, scale=pytestconfig.getoption('--benchmark-scale'))
+
+    if pytestconfig.getoption('--benchmark-update'):
+        baseline_store.update(result)
+        return
+
+    regressions = baseline_store.compare(
+        result, pytestconfig.getoption('--benchmark-threshold'))
+    if regressions is None:
+        pytest.skip('no baseline for "%s" (record one with --benchmark-update)'
+                    % bench.BaselineStore.key(result))
+    assert not regressions, '\n'.join(
+        '%s: %.4g -> %.4g (%+.1f%%)' % (r['metric'], r['baseline'],
+                                        r['value'], 100 * r['change'])
+        for r in regressions)
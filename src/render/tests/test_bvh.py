@@ -0,0 +1,150 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def compare_results(res_a, res_b, atol=0.0):
+    assert dr.all(res_a.is_valid() == res_b.is_valid())
+    if dr.any(res_a.is_valid()):
+        assert dr.allclose(res_a.t, res_b.t, atol=atol), "\n%s\n\n%s" % (res_a.t, res_b.t)
+
+
+@pytest.mark.parametrize('width', [4, 8])
+def test01_bunny_scalar(variant_scalar_rgb, width):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'accel': 'bvh',
+        'bvh_width': width,
+        'bvh_parallel_threshold': 64,
+        'shape': {
+            "type" : "ply",
+            "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+        }
+    })
+    b = scene.bbox()
+
+    n = 50
+    inv_n = 1.0 / (n - 1)
+    wavelengths = []
+
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2] - 1]
+            d = [0, 0, 1]
+            r = mi.Ray3f(o, d, 0.5, wavelengths)
+            r.maxt = 100
+
+            res_naive  = scene.ray_intersect_naive(r)
+            res        = scene.ray_intersect(r)
+            res_shadow = scene.ray_test(r)
+            assert dr.all(res_shadow == res_naive.is_valid())
+            compare_results(res_naive, res)
+
+
+def test02_multiple_shapes(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'accel': 'bvh',
+        'sphere': { 'type': 'sphere', 'center': [0, 0, 0], 'radius': 0.5 },
+        'rect': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([0, 0, -2])
+        },
+        'cube': {
+            'type': 'cube',
+            'to_world': mi.ScalarTransform4f.translate([3, 0, 0]) @ mi.ScalarTransform4f.scale(0.5)
+        }
+    })
+
+    for o, expected in [([0, 0, 5], 4.5), ([0.75, 0.75, 5], 7.0),
+                        ([3, 0, 5], 4.5), ([5, 5, 5], None)]:
+        r = mi.Ray3f(o, [0, 0, -1])
+        si = scene.ray_intersect(r)
+        assert si.is_valid() == (expected is not None)
+        assert scene.ray_test(r) == (expected is not None)
+        if expected is not None:
+            assert dr.allclose(si.t, expected)
+
+
+def test03_standalone(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    mesh = mi.load_dict({
+        "type" : "ply",
+        "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+    })
+
+    props = mi.Properties()
+    props['bvh_width'] = 8
+    bvh = mi.ShapeBVH(props)
+    bvh.add_shape(mesh)
+    bvh.build()
+
+    assert bvh.ready()
+    assert bvh.width() == 8
+    assert bvh.shape_count() == 1
+    assert bvh.primitive_count() == mesh.face_count()
+    assert bvh.node_count() > 0
+    assert dr.allclose(bvh.bbox().min, mesh.bbox().min)
+    assert dr.allclose(bvh.bbox().max, mesh.bbox().max)
+
+
+@pytest.mark.parametrize('threshold', [1.0, 100.0])
+def test04_refit(variant_scalar_rgb, threshold):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'accel': 'bvh',
+        'accel_refit': True,
+        'accel_refit_threshold': threshold,
+        'shape': {
+            "type" : "ply",
+            "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+        }
+    })
+
+    # Shear the mesh, which changes the bounds of most of its triangles
+    params = mi.traverse(scene)
+    key = 'shape.vertex_positions'
+    positions = dr.unravel(mi.Point3f, params[key])
+    positions.x += 0.5 * positions.y
+    params[key] = dr.ravel(positions)
+    params.update()
+
+    b = scene.bbox()
+    n = 30
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] + (b.max[0] - b.min[0]) * x / (n - 1),
+                 b.min[1] + (b.max[1] - b.min[1]) * y / (n - 1),
+                 b.min[2] - 1]
+            r = mi.Ray3f(o, [0, 0, 1])
+            compare_results(scene.ray_intersect_naive(r), scene.ray_intersect(r))
+
+
+def test05_refit_standalone(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    mesh = mi.load_dict({
+        "type" : "ply",
+        "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+    })
+
+    bvh = mi.ShapeBVH(mi.Properties())
+    bvh.add_shape(mesh)
+    bvh.build()
+
+    # Refitting unchanged geometry preserves the quality of the hierarchy
+    assert dr.allclose(bvh.refit(), 1.0)
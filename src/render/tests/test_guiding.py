@@ -0,0 +1,125 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def make_field():
+    return mi.GuidingField(mi.ScalarBoundingBox3f([-1, -1, -1], [1, 1, 1]),
+                           spatial_threshold=1000)
+
+
+def test01_uniform(variant_scalar_rgb):
+    field = make_field()
+    assert not field.trained()
+    assert field.leaf_count() == 1
+
+    # An untrained field samples uniform directions
+    d, pdf = field.sample([0, 0, 0], [0.3, 0.7])
+    assert dr.allclose(dr.norm(d), 1)
+    assert dr.allclose(pdf, dr.inv_four_pi)
+    assert dr.allclose(field.pdf([0.5, 0, 0], [0, 0, 1]), dr.inv_four_pi)
+
+
+def test02_training(variant_scalar_rgb):
+    field = make_field()
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0)
+    target = dr.normalize(mi.ScalarVector3f(1, 1, 1))
+
+    # Radiance arrives from a small cone around 'target'
+    for it in range(3):
+        for i in range(20000):
+            p = 2 * mi.ScalarPoint3f(sampler.next_1d(), sampler.next_1d(),
+                                     sampler.next_1d()) - 1
+            d, pdf = field.sample(p, sampler.next_2d())
+            value = 1 if dr.dot(d, target) > 0.95 else 0
+            field.record(p, d, value / pdf)
+        field.refine()
+
+    assert field.iteration() == 3
+    assert field.leaf_count() > 1
+    assert field.node_count() > field.leaf_count()
+
+    p = mi.ScalarPoint3f(0.2, -0.4, 0.1)
+    assert field.pdf(p, target) > 10 * field.pdf(p, -target)
+
+    # Samples concentrate around the target, and their density is consistent
+    hits = 0
+    for i in range(1000):
+        d, pdf = field.sample(p, sampler.next_2d())
+        assert dr.allclose(pdf, field.pdf(p, d), rtol=1e-3)
+        hits += dr.dot(d, target) > 0.9
+    assert hits > 500
+
+
+def test03_pdf_normalization(variant_scalar_rgb):
+    field = make_field()
+    sampler = mi.load_dict({'type': 'independent'})
+    for i in range(5000):
+        d = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+        field.record([0, 0, 0], d, max(d.z, 0) * 4 * dr.pi)
+    field.refine()
+
+    # Monte Carlo estimate of the integral of the density over the sphere
+    n, integral = 20000, 0
+    for i in range(n):
+        d = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+        integral += field.pdf([0, 0, 0], d) / (n * dr.inv_four_pi)
+    assert dr.allclose(integral, 1, rtol=5e-2)
+
+
+def test04_write_read(variant_scalar_rgb):
+    field = make_field()
+    sampler = mi.load_dict({'type': 'independent'})
+    for i in range(5000):
+        d = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+        field.record([0.5, 0.5, 0.5], d, dr.exp(5 * d.x))
+    field.refine()
+
+    stream = mi.MemoryStream()
+    field.write(stream)
+    stream.seek(0)
+    field2 = mi.GuidingField(stream)
+
+    assert field2.iteration() == field.iteration()
+    assert field2.leaf_count() == field.leaf_count()
+    assert field2.node_count() == field.node_count()
+    for i in range(100):
+        d = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+        assert dr.allclose(field2.pdf([0.5, 0.5, 0.5], d),
+                           field.pdf([0.5, 0.5, 0.5], d))
+
+
+def test05_path_guiding(variant_scalar_rgb):
+    # Diffuse box lit by a small area light, guiding must not bias the result
+    def scene_dict(**kwargs):
+        return mi.load_dict({
+            'type': 'scene',
+            'integrator': dict({'type': 'path', 'max_depth': 4}, **kwargs),
+            'sensor': {
+                'type': 'perspective',
+                'to_world': mi.ScalarTransform4f.look_at(origin=[0, 0, 3],
+                                                         target=[0, 0, 0],
+                                                         up=[0, 1, 0]),
+                'film': {'type': 'hdrfilm', 'width': 8, 'height': 8},
+                'sampler': {'type': 'independent', 'sample_count': 256},
+            },
+            'floor': {
+                'type': 'rectangle',
+                'bsdf': {'type': 'diffuse'},
+            },
+            'light': {
+                'type': 'rectangle',
+                'to_world': mi.ScalarTransform4f.translate([0, 0, 1.5]) @
+                            mi.ScalarTransform4f.scale(0.1) @
+                            mi.ScalarTransform4f.rotate([1, 0, 0], 180),
+                'emitter': {'type': 'area', 'radiance': 10},
+            },
+        })
+
+    ref = mi.render(scene_dict())
+    scene = scene_dict(guiding=True, guiding_iterations=3,
+                       guiding_spatial_threshold=200)
+    img = mi.render(scene)
+    assert 'guiding = true' in str(scene.integrator())
+    assert dr.allclose(dr.mean(img.array), dr.mean(ref.array), rtol=5e-2)
@@ -257,3 +257,58 @@ def test06_error_compensation(variants_any_cuda, compensate):
         print(2**24 + 1024)
         print(2**24)
         assert ib.tensor().array[0] ==  2**24 + (1024 if compensate else 0)
+
+
+@pytest.mark.parametrize("filter_name", ['gaussian', 'tent', 'box'])
+@pytest.mark.parametrize("normalize", [ False, True ])
+def test07_put_many_channels(variants_all_rgb, filter_name, normalize):
+    # Channels beyond the SIMD width are accumulated like the first ones
+    import numpy as np
+    rfilter = mi.load_dict({ 'type' : filter_name })
+    channels = 19
+
+    def make_block(channel_count):
+        return mi.ImageBlock(size=[6, 6], offset=[0, 0],
+                             channel_count=channel_count, rfilter=rfilter,
+                             normalize=normalize, coalesce=False)
+
+    block = make_block(channels)
+    block_ref = make_block(1)
+    for pos in [[3.3, 3.0], [2.7, 1.9], [0.1, 5.4]]:
+        block.put(pos=pos, values=[float(k + 1) for k in range(channels)])
+        block_ref.put(pos=pos, values=[1.0])
+
+    ref = np.array(block_ref.tensor()) * (np.arange(channels) + 1)
+    assert dr.allclose(block.tensor(), ref, rtol=1e-5, atol=1e-6)
+
+
+@pytest.mark.parametrize("filter_name", ['gaussian', 'box'])
+def test08_put_deferred(variants_all_rgb, filter_name):
+    # Deferred splats match immediate ones once the block is accessed
+    rfilter = mi.load_dict({ 'type' : filter_name })
+
+    def make_block(deferred):
+        block = mi.ImageBlock(size=[37, 23], offset=[2, 1], channel_count=3,
+                              rfilter=rfilter, normalize=True, coalesce=False)
+        block.set_deferred(deferred)
+        return block
+
+    block, block_ref = make_block(True), make_block(False)
+    if 'scalar' in mi.variant():
+        assert block.deferred()
+
+    sampler = mi.load_dict({ 'type' : 'independent' })
+    sampler.seed(0)
+    for _ in range(2000):
+        u = sampler.next_2d()
+        pos = mi.Point2f(u.x * 41, u.y * 27)
+        values = [sampler.next_1d(), 1.0, 2.0]
+        block.put(pos=pos, values=values)
+        block_ref.put(pos=pos, values=values)
+
+    assert dr.allclose(block.tensor(), block_ref.tensor(), atol=1e-6)
+
+    # Clearing the block discards pending splats
+    block.put(pos=[10, 10], values=[1, 1, 1])
+    block.clear()
+    assert dr.all(dr.eq(block.tensor().array, 0))
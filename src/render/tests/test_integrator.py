@@ -0,0 +1,435 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def make_scene(integrator):
+    return mi.load_dict({
+        'type': 'scene',
+        'integrator': integrator,
+        'sensor': {
+            'type': 'perspective',
+            'film': {
+                'type': 'hdrfilm',
+                'width': 40,
+                'height': 30,
+                'filter': {'type': 'box'}
+            },
+            'sampler': {'type': 'independent', 'sample_count': 16}
+        },
+        'emitter': {'type': 'constant', 'radiance': 0.5},
+        'shape': {
+            'type': 'sphere',
+            'center': [0, 0, 5],
+            'bsdf': {'type': 'diffuse'}
+        }
+    })
+
+
+def test01_adaptive_requires_samples_per_pass(variants_all_rgb):
+    with pytest.raises(RuntimeError, match='samples_per_pass'):
+        mi.load_dict({'type': 'path', 'adaptive_threshold': 0.01})
+
+    with pytest.raises(RuntimeError, match='adaptive_min_passes'):
+        mi.load_dict({'type': 'path', 'adaptive_threshold': 0.01,
+                      'samples_per_pass': 4, 'adaptive_min_passes': 1})
+
+    # The parameter is only validated when adaptive sampling is enabled
+    mi.load_dict({'type': 'path', 'adaptive_min_passes': 1})
+
+
+def test02_adaptive_constant_background(variants_all_rgb):
+    # Pixels that only see the constant emitter have zero variance and must
+    # converge right after the minimum number of passes, without bias.
+    scene = make_scene({
+        'type': 'path',
+        'samples_per_pass': 2,
+        'adaptive_threshold': 0.05,
+        'block_size': 8
+    })
+    image = mi.render(scene)
+    reference = mi.render(make_scene({'type': 'path'}))
+
+    assert dr.allclose(image[0, 0, :], 0.5)
+    assert dr.allclose(dr.mean(image), dr.mean(reference), rtol=5e-2)
+
+
+def make_turntable(count, width=24):
+    scene = {
+        'type': 'scene',
+        'integrator': {'type': 'path'},
+        'emitter': {'type': 'constant', 'radiance': 0.5},
+        'shape': {'type': 'sphere', 'bsdf': {'type': 'diffuse'}}
+    }
+
+    for i in range(count):
+        angle = 2 * dr.pi * i / count
+        scene[f'sensor_{i}'] = {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[4 * dr.sin(angle), 0, 4 * dr.cos(angle)],
+                target=[0, 0, 0], up=[0, 1, 0]),
+            'film': {
+                'type': 'hdrfilm',
+                'width': width + i,
+                'height': 16,
+                'filter': {'type': 'box'}
+            },
+            'sampler': {'type': 'independent', 'sample_count': 16}
+        }
+
+    return mi.load_dict(scene)
+
+
+def test03_render_sensors(variants_all_rgb):
+    scene = make_turntable(3)
+    integrator = scene.integrator()
+    sensors = scene.sensors()
+
+    images = integrator.render_sensors(scene, sensors)
+    assert len(images) == 3
+
+    for i, sensor in enumerate(sensors):
+        reference = integrator.render(scene, sensor)
+        assert dr.all(dr.shape(images[i]) == dr.shape(reference))
+        assert dr.allclose(dr.mean(images[i]), dr.mean(reference), rtol=5e-2)
+
+    # Without 'develop', the results are left in the film of every sensor
+    integrator.render_sensors(scene, sensors, develop=False)
+    for i, sensor in enumerate(sensors):
+        assert dr.allclose(dr.mean(sensor.film().develop()),
+                           dr.mean(images[i]), rtol=5e-2)
+
+
+def test04_render_sensors_scalar_matches_render(variant_scalar_rgb):
+    # The blocks of the first sensor are seeded like in a regular render
+    scene = make_turntable(2)
+    integrator = scene.integrator()
+
+    images = integrator.render_sensors(scene, scene.sensors())
+    reference = integrator.render(scene, scene.sensors()[0])
+    assert dr.allclose(images[0], reference)
+
+
+def make_materials_scene(wavefront, sort_rays=False):
+    scene = {
+        'type': 'scene',
+        'integrator': {'type': 'path', 'max_depth': 6, 'rr_depth': 2,
+                       'wavefront': wavefront, 'sort_rays': sort_rays},
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(origin=[0, 0, 6],
+                                                     target=[0, 0, 0],
+                                                     up=[0, 1, 0]),
+            'film': {'type': 'hdrfilm', 'width': 32, 'height': 24,
+                     'filter': {'type': 'box'}},
+            'sampler': {'type': 'independent', 'sample_count': 4}
+        },
+        'emitter': {'type': 'constant', 'radiance': 0.5},
+        'light': {'type': 'point', 'position': [0, 3, 3], 'intensity': 5},
+        'floor': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([0, 0, -1]) @
+                        mi.ScalarTransform4f.scale(4),
+            'bsdf': {'type': 'diffuse'}
+        }
+    }
+
+    bsdfs = [{'type': 'roughconductor'}, {'type': 'dielectric'},
+             {'type': 'principled', 'roughness': 0.3},
+             {'type': 'blendbsdf', 'weight': 0.5,
+              'a': {'type': 'diffuse'}, 'b': {'type': 'conductor'}}]
+    for i, bsdf in enumerate(bsdfs):
+        scene[f'sphere_{i}'] = {'type': 'sphere', 'radius': 0.6,
+                                'center': [2 * i - 3, 0, 0], 'bsdf': bsdf}
+
+    return mi.load_dict(scene)
+
+
+def test05_wavefront_matches_megakernel(variants_vec_backends_once_rgb):
+    # Both modes consume the same random numbers and render the same image
+    image = mi.render(make_materials_scene(False))
+    image_wavefront = mi.render(make_materials_scene(True))
+    assert dr.allclose(image, image_wavefront, rtol=1e-3, atol=1e-4)
+
+
+def test06_wavefront_sorted_rays(variants_vec_backends_once_rgb):
+    # Reordering the paths doesn't change their random numbers
+    image = mi.render(make_materials_scene(False))
+    image_sorted = mi.render(make_materials_scene(True, sort_rays=True))
+    assert dr.allclose(image, image_sorted, rtol=1e-3, atol=1e-4)
+
+
+def test07_wavefront_ignored_in_scalar(variant_scalar_rgb):
+    # The parameter has no effect in scalar variants
+    integrator = mi.load_dict({'type': 'path', 'wavefront': True})
+    assert 'wavefront = false' in str(integrator)
+
+
+def test08_pass_callback(variants_all_rgb):
+    scene = make_scene({'type': 'path', 'samples_per_pass': 4})
+    integrator = scene.integrator()
+    reference = mi.render(scene)
+
+    passes, means = [], []
+    def callback(p, n_passes):
+        passes.append((p, n_passes))
+        means.append(dr.mean(scene.sensors()[0].film().develop()))
+
+    integrator.set_pass_callback(callback)
+    image = mi.render(scene)
+    integrator.set_pass_callback(None)
+
+    # The film contains the samples of all completed passes
+    assert passes == [(1, 4), (2, 4), (3, 4), (4, 4)]
+    assert all(dr.allclose(m, dr.mean(reference), rtol=5e-2) for m in means)
+    assert dr.allclose(dr.mean(image), dr.mean(reference), rtol=5e-2)
+
+
+def test09_pass_callback_cancel(variants_all_rgb):
+    scene = make_scene({'type': 'path', 'samples_per_pass': 4})
+    integrator = scene.integrator()
+
+    passes = []
+    def callback(p, n_passes):
+        passes.append(p)
+        return p < 2
+
+    integrator.set_pass_callback(callback)
+    mi.render(scene)
+    integrator.set_pass_callback(None)
+    assert passes == [1, 2]
+
+
+def test10_time_budget_requires_samples_per_pass(variants_all_rgb):
+    with pytest.raises(RuntimeError, match='samples_per_pass'):
+        mi.load_dict({'type': 'path', 'time_budget': 1.0})
+
+    with pytest.raises(RuntimeError, match='cannot be combined'):
+        mi.load_dict({'type': 'path', 'time_budget': 1.0,
+                      'samples_per_pass': 4, 'adaptive_threshold': 0.01})
+
+
+def test11_time_budget(variants_all_rgb):
+    # Every pass renders the whole image, so a tiny budget still gives an
+    # image without holes after the calibration pass
+    scene = make_scene({'type': 'path', 'samples_per_pass': 1,
+                        'time_budget': 1e-6})
+    integrator = scene.integrator()
+
+    passes = []
+    integrator.set_pass_callback(lambda p, n: passes.append(p))
+    image = mi.render(scene)
+    integrator.set_pass_callback(None)
+
+    assert passes == [1]
+    assert dr.all(image.array > 0)
+
+    # A generous budget renders all samples of the sampler
+    scene = make_scene({'type': 'path', 'samples_per_pass': 4,
+                        'time_budget': 1e3})
+    reference = mi.render(make_scene({'type': 'path'}))
+    image = mi.render(scene)
+    assert dr.allclose(dr.mean(image), dr.mean(reference), rtol=5e-2)
+
+
+def test12_numa_aware(variant_scalar_rgb):
+    # Pinning and memory placement don't affect the rendered image
+    scene = make_scene({'type': 'path'})
+    reference = mi.render(scene)
+
+    mi.Thread.set_numa_aware(True)
+    try:
+        assert mi.Thread.numa_aware()
+        image = mi.render(make_scene({'type': 'path'}))
+    finally:
+        mi.Thread.set_numa_aware(False)
+
+    assert dr.allclose(image, reference)
+
+
+def test13_scratch_arena_warm_up(variant_scalar_rgb):
+    # After a warm-up render, the scalar rendering loop doesn't grow the scratch arenas
+    count = mi.Thread.thread_count()
+    mi.Thread.set_thread_count(1)
+    try:
+        scene = make_scene({'type': 'path'})
+        for i in range(3):
+            mi.render(scene)
+        allocations = mi.ScratchArena.heap_allocations()
+        for i in range(3):
+            mi.render(scene)
+        assert mi.ScratchArena.heap_allocations() == allocations
+    finally:
+        mi.Thread.set_thread_count(count)
+
+
+def make_defocus_scene(integrator):
+    return mi.load_dict({
+        'type': 'scene',
+        'integrator': integrator,
+        'sensor': {
+            'type': 'thinlens',
+            'aperture_radius': 0.2,
+            'focus_distance': 5,
+            'film': {
+                'type': 'hdrfilm',
+                'width': 32,
+                'height': 16,
+                'filter': {'type': 'box'}
+            },
+            'sampler': {'type': 'independent', 'sample_count': 16}
+        },
+        'emitter': {'type': 'constant', 'radiance': 0.5},
+        'sharp': {
+            'type': 'sphere',
+            'center': [-1, 0, 5],
+            'radius': 0.8,
+            'bsdf': {'type': 'diffuse'}
+        },
+        'blurry': {
+            'type': 'sphere',
+            'center': [0.5, 0, 2],
+            'radius': 0.3,
+            'bsdf': {'type': 'diffuse'}
+        }
+    })
+
+
+def test14_circle_of_confusion(variants_all_rgb):
+    sensor = make_defocus_scene({'type': 'path'}).sensors()[0]
+
+    # Points on the focal plane are sharp, closer and farther ones are blurred
+    coc = [dr.slice(sensor.circle_of_confusion(mi.Point3f(0, y, z)))
+           for y, z in [(0, 5), (0, 2), (0, 1), (1, 50)]]
+    assert dr.allclose(coc[0], 0, atol=1e-5)
+    assert coc[2] > coc[1] and coc[1] > 0 and coc[3] > 0
+
+    pinhole = mi.load_dict({'type': 'perspective'})
+    assert dr.allclose(pinhole.circle_of_confusion(mi.Point3f(0, 0, 2)), 0)
+
+    with pytest.raises(RuntimeError, match='adaptive_defocus'):
+        mi.load_dict({'type': 'path', 'adaptive_defocus': -1})
+
+
+def test15_adaptive_defocus(variants_all_rgb):
+    # Defocused tiles take more passes but the image stays unbiased
+    scene = make_defocus_scene({
+        'type': 'path',
+        'samples_per_pass': 2,
+        'adaptive_threshold': 0.05,
+        'adaptive_defocus': 0.5,
+        'block_size': 8
+    })
+    image = mi.render(scene)
+    reference = mi.render(make_defocus_scene({'type': 'path'}))
+    assert dr.allclose(dr.mean(image), dr.mean(reference), rtol=5e-2)
+
+
+def test16_memory_budget(variants_vec_rgb):
+    with pytest.raises(RuntimeError, match='memory_fraction'):
+        mi.load_dict({'type': 'path', 'memory_fraction': 1.5})
+
+    # 40x30 pixels with 1000 bytes per sample: the budget fits 4 samples
+    # per pixel, so the 16 samples of the sampler are split into 4 passes
+    scene = make_scene({'type': 'path', 'sample_memory': 1000,
+                        'memory_budget': 40 * 30 * 4 * 1000 + 1})
+    integrator = scene.integrator()
+
+    passes = []
+    integrator.set_pass_callback(lambda p, n: passes.append((p, n)))
+    image = mi.render(scene)
+    integrator.set_pass_callback(None)
+    assert passes == [(1, 4), (2, 4), (3, 4), (4, 4)]
+
+    reference = mi.render(make_scene({'type': 'path'}))
+    assert dr.allclose(dr.mean(image), dr.mean(reference), rtol=5e-2)
+
+    # The split is left to the user when 'samples_per_pass' is specified
+    scene = make_scene({'type': 'path', 'sample_memory': 1000,
+                        'memory_budget': 1, 'samples_per_pass': 8})
+    integrator = scene.integrator()
+    passes = []
+    integrator.set_pass_callback(lambda p, n: passes.append(p))
+    mi.render(scene)
+    integrator.set_pass_callback(None)
+    assert passes == [1, 2]
+
+
+def test17_cache_primary(variants_vec_rgb):
+    # Later passes reuse the primary intersections of the first pass
+    scene = make_scene({'type': 'path', 'samples_per_pass': 4,
+                        'cache_primary': True})
+    reference = mi.render(make_scene({'type': 'path'}), spp=64)
+    image = mi.render(scene, spp=64)
+    assert dr.allclose(dr.mean(image), dr.mean(reference), rtol=5e-2)
+
+    # The sphere covers the same pixels
+    mask = image.array > 0
+    assert dr.all(mask == (reference.array > 0))
+
+
+def test18_packet_size(variant_scalar_rgb):
+    with pytest.raises(RuntimeError, match='packet_size'):
+        mi.load_dict({'type': 'path', 'packet_size': 6})
+
+    # Tracing the camera rays of neighboring pixels as packets leaves the image unchanged
+    reference = mi.render(make_scene({'type': 'path'}), spp=4)
+    for packet_size in [4, 8, 16]:
+        image = mi.render(make_scene({'type': 'path',
+                                      'packet_size': packet_size}), spp=4)
+        assert dr.allclose(image, reference, atol=1e-5)
+
+
+@pytest.mark.parametrize('spp', [1, 97, 1000])
+def test19_tiny_film(variant_scalar_rgb, spp):
+    # The samples of a single pixel are split into passes that are
+    # rendered in parallel and accumulated by the film
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': {'type': 'path'},
+        'sensor': {
+            'type': 'radiancemeter',
+            'film': {
+                'type': 'hdrfilm',
+                'width': 1,
+                'height': 1,
+                'pixel_format': 'rgb',
+                'rfilter': {'type': 'box'}
+            }
+        },
+        'emitter': {
+            'type': 'constant',
+            'radiance': {'type': 'uniform', 'value': 2.0}
+        }
+    })
+
+    image = mi.render(scene, spp=spp)
+    assert image.shape == (1, 1, 3)
+    assert dr.allclose(image.array, 2.0)
+
+
+def test20_resumed_render(variant_scalar_rgb):
+    # Mimics the '--resume' option of the mitsuba executable: the first job
+    # is stopped after one of its two passes, and the remaining samples are
+    # rendered with a seed that hashes the seed and the finished samples
+    reference = mi.render(make_scene({'type': 'path'}), seed=7, spp=256)
+
+    scene = make_scene({'type': 'path', 'samples_per_pass': 4})
+    integrator = scene.integrator()
+    uninterrupted = mi.render(scene, seed=0, spp=8)
+
+    integrator.set_pass_callback(lambda p, n_passes: False)
+    first = mi.render(scene, seed=0, spp=8)
+    integrator.set_pass_callback(None)
+    assert integrator.pass_sample_count() == 4
+
+    seed, _ = mi.sample_tea_32(0, 4)
+    second = mi.render(scene, seed=seed, spp=4)
+    resumed = (first + second) * 0.5
+
+    def error(image):
+        return dr.mean(dr.sqr(image.array - reference.array))
+
+    # Overlapping sample sequences would correlate both halves of the job
+    assert dr.allclose(error(resumed), error(uninterrupted), rtol=0.25)
@@ -162,3 +162,18 @@ def test05_gather_interaction(variants_any_llvm):
     assert(dr.width(si_.shape) == 2)
     assert(dr.allclose(si_.t[0], si.t[0]))
     assert(dr.allclose(si_.t[1], si.t[2]))
+
+
+def test06_mueller_to_world_stokes(variant_scalar_mono_polarized):
+    si = mi.SurfaceInteraction3f()
+    si.sh_frame = mi.Frame3f(dr.normalize(mi.Vector3f(1.0, 1.0, 1.0)))
+
+    M = mi.mueller.rotated_element(0.3, mi.mueller.linear_polarizer(mi.UnpolarizedSpectrum(1.0)))
+    wi_local = dr.normalize(mi.Vector3f(0.2, 0.0, 1.0))
+    wo_local = dr.normalize(mi.Vector3f(0.0, -0.8, 1.0))
+
+    # Linearly polarized light in the first column, the others are ignored
+    s = mi.mueller.linear_polarizer(mi.UnpolarizedSpectrum(1.0))
+
+    ref = si.to_world_mueller(M, wi_local, wo_local) @ mi.mueller.apply_stokes(dr.identity(type(M)), s)
+    assert dr.allclose(si.to_world_mueller_stokes(M, wi_local, wo_local, s), ref, atol=1e-5)
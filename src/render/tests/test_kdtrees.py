@@ -113,3 +113,266 @@ def test02_depth_scalar_bunny(variant_scalar_rgb):
             res_shadow = scene.ray_test(r)
             assert dr.all(res_shadow == res_naive.is_valid())
             compare_results(res_naive, res)
+
+
+def test03_parallel_subtrees(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    # Force the O(n log n) builder to split the construction into many tasks
+    scene = mi.load_dict({
+        'type': 'scene',
+        'kd_exact_primitive_threshold': 256,
+        'kd_parallel_subtree_threshold': 8,
+        'shape': {
+            "type" : "ply",
+            "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+        }
+    })
+    b = scene.bbox()
+
+    n = 50
+    inv_n = 1.0 / (n - 1)
+    wavelengths = []
+
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2]]
+            d = [0, 0, 1]
+            r = mi.Ray3f(o, d, 0.5, wavelengths)
+            r.maxt = 100
+
+            res_naive  = scene.ray_intersect_naive(r)
+            res        = scene.ray_intersect(r)
+            res_shadow = scene.ray_test(r)
+            assert dr.all(res_shadow == res_naive.is_valid())
+            compare_results(res_naive, res)
+
+
+def test04_statistics(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    mesh = mi.load_dict({
+        "type" : "ply",
+        "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+    })
+
+    kdtree = mi.ShapeKDTree(mi.Properties())
+    kdtree.add_shape(mesh)
+    kdtree.build()
+
+    stats = kdtree.statistics()
+    assert stats.node_count >= stats.inner_node_count + stats.leaf_count
+    assert stats.leaf_count == sum(stats.leaf_size_histogram)
+    assert stats.empty_leaf_count == stats.leaf_size_histogram[0]
+    assert stats.leaf_count == sum(stats.depth_leaf_nodes)
+    assert stats.inner_node_count == sum(stats.depth_inner_nodes)
+    assert stats.index_count == sum(stats.depth_primitives)
+    assert len(stats.depth_leaf_nodes) == stats.max_depth + 1
+    assert 0 < stats.empty_space_ratio < 1
+    assert stats.sah_cost > 0
+    assert stats.expected_primitive_visits > 0
+
+    # The sampled rays only depend on the seed
+    traversal = kdtree.measure_traversal(ray_count=1024, seed=1, passes=1)
+    assert traversal.ray_count == 1024
+    assert 0 < traversal.hit_count < 1024
+    assert traversal.primitives_per_ray > 0
+    assert traversal.time > 0
+
+    traversal_2 = kdtree.measure_traversal(ray_count=1024, seed=1, passes=1)
+    assert traversal_2.hit_count == traversal.hit_count
+    assert traversal_2.primitives_per_ray == traversal.primitives_per_ray
+
+
+def test05_auto_tune(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'kd_auto_tune': True,
+        'kd_auto_tune_rays': 1024,
+        'shape': {
+            "type" : "ply",
+            "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+        }
+    })
+    b = scene.bbox()
+
+    # The selected tree must produce the same intersections
+    n = 20
+    inv_n = 1.0 / (n - 1)
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2]]
+            r = mi.Ray3f(o, [0, 0, 1], 0.5, [])
+            r.maxt = 100
+            compare_results(scene.ray_intersect_naive(r), scene.ray_intersect(r))
+
+
+def test06_precompute_triangles(variant_scalar_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    def load(precompute):
+        return mi.load_dict({
+            'type': 'scene',
+            'kd_precompute_triangles': precompute,
+            'mesh': {
+                "type" : "ply",
+                "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+            },
+            'sphere': {
+                'type': 'sphere',
+                'center': [0, 0.1, 0],
+                'radius': 0.03
+            }
+        })
+
+    scene, scene_ref = load(True), load(False)
+    b = scene.bbox()
+
+    # Triangles and other shapes produce the same intersections
+    n = 20
+    inv_n = 1.0 / (n - 1)
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2]]
+            r = mi.Ray3f(o, [0, 0, 1], 0.5, [])
+            r.maxt = 100
+            assert scene.ray_test(r) == scene_ref.ray_test(r)
+            res, res_ref = scene.ray_intersect(r), scene_ref.ray_intersect(r)
+            assert res.is_valid() == res_ref.is_valid()
+            if res_ref.is_valid():
+                assert res.shape.is_mesh() == res_ref.shape.is_mesh()
+                assert res.prim_index == res_ref.prim_index
+                assert dr.allclose(res.t, res_ref.t, rtol=1e-4)
+                assert dr.allclose(res.uv, res_ref.uv, atol=1e-4)
+
+    # The records are only stored when enabled
+    mesh = mi.load_dict({
+        "type" : "ply",
+        "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+    })
+    kdtree = mi.ShapeKDTree(mi.Properties())
+    kdtree.add_shape(mesh)
+    kdtree.build()
+    footprint = kdtree.memory_footprint()
+
+    props = mi.Properties()
+    props['kd_precompute_triangles'] = True
+    kdtree_2 = mi.ShapeKDTree(props)
+    kdtree_2.add_shape(mesh)
+    kdtree_2.build()
+    assert kdtree_2.precompute_triangles()
+    assert kdtree_2.memory_footprint() == \
+        footprint + 48 * kdtree_2.statistics().index_count
+
+
+def test07_packet_traversal(variant_llvm_ad_rgb):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    def load(packets, utilization=0.5):
+        return mi.load_dict({
+            'type': 'scene',
+            'kd_packet_traversal': packets,
+            'kd_packet_utilization': utilization,
+            'mesh': {
+                "type" : "ply",
+                "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+            },
+            'sphere': {
+                'type': 'sphere',
+                'center': [0, 0.1, 0],
+                'radius': 0.03
+            }
+        })
+
+    scene_ref = load(False)
+    b = scene_ref.bbox()
+
+    # Incoherent rays between random points of the bounding box
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, 4096)
+    o = dr.fmadd(b.extents(), mi.Point3f(sampler.next_1d(), sampler.next_1d(),
+                                         sampler.next_1d()), b.min)
+    d = dr.normalize(mi.Vector3f(sampler.next_1d(), sampler.next_1d(),
+                                 sampler.next_1d()) - 0.5)
+    ray = mi.Ray3f(o, d)
+    si_ref = scene_ref.ray_intersect(ray)
+    test_ref = scene_ref.ray_test(ray)
+
+    # A utilization of 1 splits packets as soon as a single lane is done
+    for utilization in [0.0, 0.5, 1.0]:
+        scene = load(True, utilization)
+        si = scene.ray_intersect(ray)
+        assert dr.all(si.is_valid() == si_ref.is_valid())
+        assert dr.all(dr.eq(si.prim_index, si_ref.prim_index) | ~si.is_valid())
+        assert dr.allclose(dr.select(si.is_valid(), si.t, 0),
+                           dr.select(si_ref.is_valid(), si_ref.t, 0))
+        assert dr.all(scene.ray_test(ray) == test_ref)
+
+
+def test08_build_cache(variant_scalar_rgb, tmp_path):
+    if mi.MI_ENABLE_EMBREE:
+        pytest.skip("EMBREE enabled")
+
+    mesh = mi.load_dict({
+        "type" : "ply",
+        "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+    })
+
+    def build(**kwargs):
+        props = mi.Properties()
+        props['kd_cache_dir'] = str(tmp_path)
+        for k, v in kwargs.items():
+            props[k] = v
+        kdtree = mi.ShapeKDTree(props)
+        kdtree.add_shape(mesh)
+        kdtree.build()
+        return kdtree
+
+    # The first build stores the tree, the second one loads it
+    first = build()
+    assert len(list(tmp_path.iterdir())) == 1
+    second = build()
+    assert len(list(tmp_path.iterdir())) == 1
+    assert second.cache_key() == first.cache_key()
+    assert second.statistics().node_count == first.statistics().node_count
+    assert second.statistics().index_count == first.statistics().index_count
+    assert second.memory_footprint() == first.memory_footprint()
+
+    # Different build parameters result in a different entry
+    third = build(kd_stop_prims=2)
+    assert third.cache_key() != first.cache_key()
+    assert len(list(tmp_path.iterdir())) == 2
+
+    # The loaded tree must produce the same intersections
+    scene = mi.load_dict({
+        'type': 'scene',
+        'kd_cache_dir': str(tmp_path),
+        'shape': {
+            "type" : "ply",
+            "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+        }
+    })
+    b = scene.bbox()
+    n = 10
+    inv_n = 1.0 / (n - 1)
+    for x in range(n):
+        for y in range(n):
+            o = [b.min[0] * (1 - x * inv_n) + b.max[0] * x * inv_n,
+                 b.min[1] * (1 - y * inv_n) + b.max[1] * y * inv_n,
+                 b.min[2]]
+            r = mi.Ray3f(o, [0, 0, 1], 0.5, [])
+            r.maxt = 100
+            compare_results(scene.ray_intersect_naive(r), scene.ray_intersect(r))
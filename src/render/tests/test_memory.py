@@ -0,0 +1,65 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def test01_mesh(variants_all_rgb):
+    mesh = mi.Mesh("MyMesh", 100, 50)
+    assert mesh.memory_footprint() >= 100 * 3 * 4 + 50 * 3 * 4
+
+    mesh_normals = mi.Mesh("MyMesh", 100, 50, has_vertex_normals=True)
+    assert mesh_normals.memory_footprint() >= mesh.memory_footprint() + 100 * 3 * 4
+
+    # Objects without storage report nothing
+    assert mi.load_dict({'type': 'diffuse'}).memory_footprint() == 0
+
+
+def test02_bitmap_texture(variants_all_rgb):
+    bitmap = mi.Bitmap(dr.full(mi.TensorXf, 0.5, [32, 64, 3]))
+    texture = mi.load_dict({'type': 'bitmap', 'bitmap': bitmap})
+    assert texture.memory_footprint() >= 32 * 64 * 3 * 4
+
+
+def test03_imageblock(variant_scalar_rgb):
+    block = mi.ImageBlock([16, 8], [0, 0], 5)
+    assert block.memory_footprint() == 16 * 8 * 5 * 4
+
+
+def test04_scene_usage(variants_all_rgb):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'mesh': {
+            'type': 'ply',
+            'filename': 'resources/data/tests/ply/triangle.ply',
+            'bsdf': {
+                'type': 'diffuse',
+                'reflectance': {
+                    'type': 'bitmap',
+                    'bitmap': mi.Bitmap(dr.full(mi.TensorXf, 0.5, [16, 16, 3]))
+                }
+            }
+        },
+        'sensor': {
+            'type': 'perspective',
+            'film': { 'type': 'hdrfilm', 'width': 32, 'height': 16 }
+        },
+        'integrator': { 'type': 'path' }
+    })
+
+    usage = scene.memory_usage()
+    assert usage['Shape'] == scene.shapes()[0].memory_footprint()
+    assert usage['Texture'] >= 16 * 16 * 3 * 4
+    assert usage['Accel'] == scene.memory_footprint()
+    if not mi.variant().startswith('cuda'):
+        assert usage['Accel'] > 0
+
+    # The prediction includes the film storage and grows with the sample count
+    film_storage = scene.sensors()[0].film().storage_footprint([])
+    assert film_storage == 32 * 16 * 5 * 4
+    peak = scene.predicted_peak_memory()
+    assert peak >= sum(v for k, v in usage.items() if k != 'Film') + film_storage
+    if dr.is_jit_v(mi.Float):
+        assert scene.predicted_peak_memory(spp=64) > scene.predicted_peak_memory(spp=1)
+
+    with pytest.raises(RuntimeError):
+        scene.predicted_peak_memory(sensor_index=1)
@@ -1,3 +1,4 @@
+import os
 import pytest
 import drjit as dr
 import mitsuba as mi
@@ -1008,3 +1009,437 @@ def test24_texture_attributes(variants_all_rgb):
 
 
 
+
+
+@fresolver_append_path
+def test25_out_of_core(variant_scalar_rgb, tmp_path):
+    mesh_ref = mi.load_dict({
+        "type" : "ply",
+        "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+    })
+
+    filepath = str(tmp_path / 'test_mesh-test25_out_of_core.bin')
+    for props in [{ 'out_of_core': True }, { 'out_of_core_file': filepath }]:
+        mesh = mi.load_dict({
+            "type" : "ply",
+            "filename" : "resources/data/common/meshes/bunny_lowres.ply",
+            **props
+        })
+        assert mesh.is_memory_mapped()
+        assert not mesh_ref.is_memory_mapped()
+
+        params, params_ref = mi.traverse(mesh), mi.traverse(mesh_ref)
+        for key in ['faces', 'vertex_positions', 'vertex_normals']:
+            assert dr.all(params[key] == params_ref[key])
+
+        # Mapped buffers can still be updated
+        params['vertex_positions'] = params_ref['vertex_positions'] * 2
+        params.update()
+        assert dr.allclose(mesh.bbox().max, mesh_ref.bbox().max * 2)
+
+    assert os.path.exists(filepath)
+
+
+@fresolver_append_path
+@pytest.mark.parametrize('mesh_type', ['ply', 'obj'])
+def test26_mesh_cache(variants_all_rgb, tmp_path, mesh_type):
+    filename = {
+        'ply': 'resources/data/common/meshes/bunny_lowres.ply',
+        'obj': 'resources/data/common/meshes/rectangle.obj'
+    }[mesh_type]
+
+    def load(**kwargs):
+        return mi.load_dict({ "type" : mesh_type, "filename" : filename, **kwargs })
+
+    mesh_ref = load()
+    mesh_1 = load(cache_dir=str(tmp_path))
+    entries = [f for f in os.listdir(tmp_path) if f.endswith('.mimesh')]
+    assert len(entries) == 1
+
+    # The second load is served from the cache
+    mesh_2 = load(cache_dir=str(tmp_path))
+    if dr.is_jit_v(mi.Float):
+        assert not mesh_2.is_memory_mapped()
+    else:
+        assert mesh_1.is_memory_mapped() and mesh_2.is_memory_mapped()
+
+    params_ref = mi.traverse(mesh_ref)
+    for mesh in [mesh_1, mesh_2]:
+        params = mi.traverse(mesh)
+        for key in ['faces', 'vertex_positions', 'vertex_normals', 'vertex_texcoords']:
+            assert dr.all(params[key] == params_ref[key])
+        assert dr.allclose(mesh.bbox().min, mesh_ref.bbox().min)
+        assert dr.allclose(mesh.bbox().max, mesh_ref.bbox().max)
+
+    # Different loading parameters use a different cache entry
+    load(cache_dir=str(tmp_path), to_world=mi.ScalarTransform4f.scale(2))
+    entries = [f for f in os.listdir(tmp_path) if f.endswith('.mimesh')]
+    assert len(entries) == 2
+
+
+def test27_obj_parallel_chunks(variant_scalar_rgb, tmp_path):
+    # Large enough to be split into several chunks that are parsed in parallel
+    import numpy as np
+    n = 300
+    x, y = np.meshgrid(np.arange(n, dtype=np.float32), np.arange(n, dtype=np.float32))
+    positions = np.stack([x.ravel(), y.ravel(), np.zeros(n * n, dtype=np.float32)], axis=1)
+    i = np.arange(n - 1)[None, :] + n * np.arange(n - 1)[:, None]
+    quads = np.stack([i, i + 1, i + n + 1, i + n], axis=-1).reshape(-1, 4) + 1
+
+    filepath = str(tmp_path / 'test_mesh-test27_obj_parallel_chunks.obj')
+    with open(filepath, 'w') as f:
+        for p in positions:
+            f.write('v %f %f %f\n' % tuple(p))
+        f.write('vt 0.5 0.5\n')
+        for q in quads:
+            f.write('f %i/1 %i/1 %i/1 %i/1\n' % tuple(q))
+    assert os.path.getsize(filepath) > 4 * 1024 * 1024
+
+    mesh = mi.load_dict({ 'type': 'obj', 'filename': filepath })
+    assert mesh.vertex_count() == n * n
+    assert mesh.face_count() == 2 * (n - 1) ** 2
+
+    # Vertices are numbered by first appearance, compare the geometry instead
+    params = mi.traverse(mesh)
+    v = np.array(params['vertex_positions']).reshape(-1, 3)
+    faces = np.array(params['faces']).reshape(-1, 2, 3)
+    q = quads - 1
+    assert np.all(v[faces[:, 0]] == positions[q[:, [0, 1, 2]]])
+    assert np.all(v[faces[:, 1]] == positions[q[:, [0, 2, 3]]])
+
+
+def test28_serialized_multiple_shapes(variant_scalar_rgb, tmp_path):
+    import struct, zlib
+
+    # Write a serialized file containing three triangles at different heights
+    filepath = str(tmp_path / 'test_mesh-test28_serialized_multiple_shapes.serialized')
+    offsets = []
+    with open(filepath, 'wb') as f:
+        for i in range(3):
+            offsets.append(f.tell())
+            payload = struct.pack('<I', 0x1000) + (b'tri%i\0' % i)
+            payload += struct.pack('<QQ', 3, 1)
+            payload += struct.pack('<9f', 0, 0, i, 1, 0, i, 0, 1, i)
+            payload += struct.pack('<3I', 0, 1, 2)
+            f.write(struct.pack('<HH', 0x041C, 0x0004))
+            f.write(zlib.compress(payload))
+        f.write(struct.pack('<%iQI' % len(offsets), *offsets, len(offsets)))
+
+    mesh = mi.load_dict({ 'type': 'serialized', 'filename': filepath, 'shape_index': 2 })
+    assert dr.allclose(mesh.bbox().min, [0, 0, 2])
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'shape': {
+            'type': 'serialized',
+            'filename': filepath,
+            'shape_index': 1,
+            'all_shapes': True
+        }
+    })
+    shapes = sorted(scene.shapes(), key=lambda s: s.bbox().min.z)
+    assert len(shapes) == 2
+    for i, shape in enumerate(shapes):
+        assert dr.allclose(shape.bbox().min, [0, 0, i + 1])
+        assert shape.face_count() == 1
+
+
+@fresolver_append_path
+@pytest.mark.parametrize('mesh_type', ['ply', 'obj'])
+def test29_asset_cache(variants_all_rgb, mesh_type):
+    filename = {
+        'ply': 'resources/data/common/meshes/bunny_lowres.ply',
+        'obj': 'resources/data/common/meshes/rectangle.obj'
+    }[mesh_type]
+
+    # Meshes loading the same file with different BSDFs share their buffers
+    mi.AssetCache.clear()
+    scene = mi.load_dict({
+        'type': 'scene',
+        'mesh_1': { 'type': mesh_type, 'filename': filename,
+                    'bsdf': { 'type': 'diffuse' } },
+        'mesh_2': { 'type': mesh_type, 'filename': filename,
+                    'bsdf': { 'type': 'conductor' } },
+        'mesh_3': { 'type': mesh_type, 'filename': filename,
+                    'to_world': mi.ScalarTransform4f.scale(2) }
+    })
+    assert mi.AssetCache.size() == 2
+
+    mesh_1, mesh_2, mesh_3 = sorted(scene.shapes(), key=lambda s: s.id())
+    params_1, params_2, params_3 = [mi.traverse(m) for m in [mesh_1, mesh_2, mesh_3]]
+    for key in ['faces', 'vertex_positions', 'vertex_normals', 'vertex_texcoords']:
+        assert dr.all(params_1[key] == params_2[key])
+    assert dr.allclose(params_3['vertex_positions'], 2 * params_1['vertex_positions'])
+
+    # Updating one instance does not affect the others
+    params_1['vertex_positions'] = 3 * params_1['vertex_positions']
+    params_1.update()
+    assert dr.allclose(mi.traverse(mesh_2)['vertex_positions'], params_2['vertex_positions'])
+    assert dr.allclose(3 * mesh_2.bbox().max, mesh_1.bbox().max)
+
+
+@fresolver_append_path
+def test30_vertex_motion(variants_all_rgb):
+    # The rectangle moves from z=0 at time 0 to z=1 at time 1
+    scene = mi.load_dict({
+        "type" : "scene",
+        "meshes": {
+            "type" : "obj",
+            "id" : "rect",
+            "filename" : "resources/data/common/meshes/rectangle.obj",
+            "to_world_end" : mi.ScalarTransform4f.translate([0, 0, 1])
+        }
+    })
+
+    mesh = scene.shapes()[0]
+    assert mesh.has_vertex_motion() and mesh.has_motion()
+    assert dr.allclose(mesh.bbox().min, [-1, -1, 0])
+    assert dr.allclose(mesh.bbox().max, [1, 1, 1])
+
+    for time in [0.0, 0.25, 1.0]:
+        ray = mi.Ray3f(mi.Vector3f(-0.3, -0.3, -10.0), mi.Vector3f(0.0, 0.0, 1.0))
+        ray.time = time
+        si = scene.ray_intersect(ray)
+        assert dr.allclose(si.t, 10 + time)
+        assert dr.allclose(si.p, [-0.3, -0.3, time])
+        assert dr.allclose(si.n, [0, 0, 1])
+
+        ps = mesh.sample_position(time, [0.5, 0.5])
+        assert dr.allclose(ps.p.z, time)
+
+    # The motion can also be specified through the parameters
+    params = mi.traverse(scene)
+    positions = dr.unravel(mi.Point3f, params['rect.vertex_positions'])
+    positions.x *= 2
+    params['rect.vertex_positions_end'] = dr.ravel(positions)
+    params.update()
+    assert dr.allclose(mesh.bbox().min, [-2, -1, 0])
+
+    ray = mi.Ray3f(mi.Vector3f(1.5, 0.0, -10.0), mi.Vector3f(0.0, 0.0, 1.0))
+    ray.time = 1.0
+    assert scene.ray_test(ray)
+    ray.time = 0.0
+    assert not scene.ray_test(ray)
+
+
+def test31_merge_meshes(variants_all_rgb):
+    def make_mesh(name, offset, value):
+        m = mi.Mesh(name, 3, 1)
+        params = mi.traverse(m)
+        params['vertex_positions'] = [offset, 0.0, 0.0, offset + 1.0, 0.0, 0.0,
+                                      offset, 1.0, 0.0]
+        params['faces'] = [0, 1, 2]
+        params.update()
+        m.add_attribute("vertex_value", 1, [value] * 3)
+        m.add_attribute("face_value", 2, [value, -value])
+        return m
+
+    meshes = [make_mesh(f"mesh_{i}", 2.0 * i, float(i)) for i in range(3)]
+    merged = mi.Mesh.merge(meshes)
+
+    assert merged.vertex_count() == 9 and merged.face_count() == 3
+    assert dr.allclose(merged.bbox().min, [0, 0, 0])
+    assert dr.allclose(merged.bbox().max, [5, 1, 0])
+
+    params = mi.traverse(merged)
+    assert dr.all(params['faces'] == mi.UInt32([0, 1, 2, 3, 4, 5, 6, 7, 8]))
+    assert dr.allclose(params['vertex_value'], [0, 0, 0, 1, 1, 1, 2, 2, 2])
+    assert dr.allclose(params['face_value'], [0, 0, 1, -1, 2, -2])
+    assert dr.allclose(merged.surface_area(), 1.5)
+
+    # Meshes with different attributes cannot be merged
+    other = mi.Mesh("other", 3, 1)
+    with pytest.raises(RuntimeError, match='incompatible'):
+        mi.Mesh.merge([meshes[0], other])
+
+    # The merge plugin groups meshes with the same attributes
+    scene = mi.load_dict({
+        "type": "scene",
+        "merged": {
+            "type": "merge",
+            "a": {"type": "cube"},
+            "b": {"type": "cube",
+                  "to_world": mi.ScalarTransform4f.translate([3, 0, 0])},
+            "c": {"type": "cube",
+                  "to_world": mi.ScalarTransform4f.translate([6, 0, 0])},
+        }
+    })
+    assert len(scene.shapes()) == 1
+    assert scene.shapes()[0].face_count() == 36
+
+
+def test32_large_mesh_normals_bbox(variants_all_rgb):
+    # A mesh large enough to be processed in several parallel blocks
+    import numpy as np
+    res = 200
+    x, y = np.meshgrid(np.linspace(-1, 1, res), np.linspace(-1, 1, res))
+    z = 0.1 * np.sin(3 * x) * np.cos(2 * y)
+    positions = np.stack([x, y, z], axis=-1).astype(np.float32).ravel()
+
+    i = np.arange(res - 1)
+    v00 = (i[:, None] * res + i[None, :]).ravel()
+    faces = np.stack([v00, v00 + 1, v00 + res + 1,
+                      v00, v00 + res + 1, v00 + res], axis=-1)
+    faces = faces.astype(np.uint32).ravel()
+
+    m = mi.Mesh("grid", res * res, len(faces) // 3, has_vertex_normals=True)
+    params = mi.traverse(m)
+    params['vertex_positions'] = positions
+    params['faces'] = faces
+    params.update()
+
+    assert dr.allclose(m.bbox().min, [-1, -1, np.min(z)])
+    assert dr.allclose(m.bbox().max, [1, 1, np.max(z)])
+
+    # Reference: angle-weighted face normals accumulated at the vertices
+    p = positions.reshape(-1, 3).astype(np.float64)
+    f = faces.reshape(-1, 3)
+    n = np.cross(p[f[:, 1]] - p[f[:, 0]], p[f[:, 2]] - p[f[:, 0]])
+    n /= np.linalg.norm(n, axis=1)[:, None]
+    normals = np.zeros_like(p)
+    for j in range(3):
+        d0 = p[f[:, (j + 1) % 3]] - p[f[:, j]]
+        d1 = p[f[:, (j + 2) % 3]] - p[f[:, j]]
+        d0 /= np.linalg.norm(d0, axis=1)[:, None]
+        d1 /= np.linalg.norm(d1, axis=1)[:, None]
+        angle = np.arccos(np.clip(np.sum(d0 * d1, axis=1), -1, 1))
+        np.add.at(normals, f[:, j], n * angle[:, None])
+    normals /= np.linalg.norm(normals, axis=1)[:, None]
+
+    assert dr.allclose(params['vertex_normals'], normals.ravel(), atol=1e-4)
+
+    area = 0.5 * np.sum(np.linalg.norm(np.cross(p[f[:, 1]] - p[f[:, 0]],
+                                                p[f[:, 2]] - p[f[:, 0]]), axis=1))
+    assert dr.allclose(m.surface_area(), area, rtol=1e-5)
+
+
+def test33_attribute_storage(variants_all_rgb):
+    # Two disjoint triangles: the color is constant per face, the value is not
+    def create(storage):
+        props = mi.Properties()
+        props['attribute_storage'] = storage
+        m = mi.Mesh("MyMesh", 6, 2, props=props)
+        params = mi.traverse(m)
+        params['vertex_positions'] = [0, 0, 0, 1, 0, 0, 0, 1, 0,
+                                      1, 1, 0, 0, 1, 0, 1, 0, 0]
+        params['faces'] = [0, 1, 2, 3, 4, 5]
+        params.update()
+        m.add_attribute("vertex_color", 3, [0.2, 0.4, 0.6] * 3 + [0.8, 0.1, 0.3] * 3)
+        m.add_attribute("vertex_value", 1, [0.0, 0.5, 1.0, 0.25, 0.75, 0.125])
+        m.add_attribute("face_value", 1, [0.3, 0.9])
+        params = mi.traverse(m)
+        params.update()
+        return m
+
+    ref = create('float')
+    sampler = mi.load_dict({ 'type' : 'independent' })
+    sampler.seed(0)
+    si = mi.SurfaceInteraction3f()
+    for storage, atol in [('half', 1e-3), ('unorm8', 1e-2)]:
+        m = create(storage)
+        assert f'vertex_color: 3 floats ({storage})' in str(m)
+        assert f'face_value: 1 float ({storage})' in str(m)
+        assert 'vertex_color' not in mi.traverse(m)
+
+        for _ in range(10):
+            si.prim_index = 0 if sampler.next_1d() < 0.5 else 1
+            uv = sampler.next_2d()
+            si.p = mi.Point3f(uv.x, uv.y, 0.0)
+            assert dr.allclose(m.eval_attribute_3('vertex_color', si),
+                               ref.eval_attribute_3('vertex_color', si), atol=atol)
+            for name in ['vertex_value', 'face_value']:
+                assert dr.allclose(m.eval_attribute_1(name, si),
+                                   ref.eval_attribute_1(name, si), atol=atol)
+
+
+def test34_eval_parameterization_grid(variants_all_rgb):
+    # Queries on a mesh with many UV triangles, also after updating the UVs
+    import numpy as np
+    res = 33
+    x, y = np.meshgrid(np.linspace(-1, 1, res), np.linspace(-1, 1, res))
+    positions = np.stack([x, y, 0.2 * x * y], axis=-1).astype(np.float32).ravel()
+    texcoords = np.stack([(x + 1) / 2, (y + 1) / 2], axis=-1).astype(np.float32).ravel()
+
+    i = np.arange(res - 1)
+    v00 = (i[:, None] * res + i[None, :]).ravel()
+    faces = np.stack([v00, v00 + 1, v00 + res + 1,
+                      v00, v00 + res + 1, v00 + res], axis=-1)
+    faces = faces.astype(np.uint32).ravel()
+
+    m = mi.Mesh("grid", res * res, len(faces) // 3, has_vertex_texcoords=True)
+    params = mi.traverse(m)
+    params['vertex_positions'] = positions
+    params['vertex_texcoords'] = texcoords
+    params['faces'] = faces
+    params.update()
+
+    rng = np.random.default_rng(0)
+    uv = rng.random((64, 2))
+
+    def query(uv):
+        if dr.is_jit_v(mi.Float):
+            si = m.eval_parameterization(mi.Point2f(uv[:, 0], uv[:, 1]))
+            return np.array(si.is_valid()), np.array(si.p)
+        result = [m.eval_parameterization(mi.Point2f(u, v)) for u, v in uv]
+        return (np.array([si.is_valid() for si in result]),
+                np.array([[si.p.x, si.p.y, si.p.z] for si in result]))
+
+    valid, p = query(uv)
+    assert np.all(valid)
+    assert np.allclose(p[:, 0], 2 * uv[:, 0] - 1, atol=1e-5)
+    assert np.allclose(p[:, 1], 2 * uv[:, 1] - 1, atol=1e-5)
+
+    valid, _ = query(np.array([[-0.1, 0.5], [0.5, 1.1]]))
+    assert not np.any(valid)
+
+    # Shifting the UVs rebuilds the grid
+    params['vertex_texcoords'] = (texcoords + 1).astype(np.float32)
+    params.update()
+    valid, p = query(uv + 1)
+    assert np.all(valid)
+    assert np.allclose(p[:, 0], 2 * uv[:, 0] - 1, atol=1e-5)
+
+
+@pytest.mark.parametrize('layout', ['native', 'converted'])
+def test35_ply_binary_parallel(variant_scalar_rgb, tmp_path, layout):
+    # Large enough to be decoded in several parallel slices
+    import numpy as np
+    n = 400
+    x, y = np.meshgrid(np.arange(n), np.arange(n))
+    positions = np.stack([x.ravel(), y.ravel(), (x * y).ravel() % 7], axis=1)
+    i = (np.arange(n - 1)[None, :] + n * np.arange(n - 1)[:, None]).ravel()
+    faces = np.stack([i, i + 1, i + n + 1, i, i + n + 1, i + n], axis=1).reshape(-1, 3)
+
+    if layout == 'native':
+        # float32 xyz and uint32 triangles, copied without conversion
+        fmt, vtype, itype = 'binary_little_endian', ('<f4', 'float'), ('<u4', 'uint')
+    else:
+        fmt, vtype, itype = 'binary_big_endian', ('>f8', 'double'), ('>i4', 'int')
+
+    filepath = str(tmp_path / 'test_mesh-test35_ply_binary_parallel.ply')
+    with open(filepath, 'wb') as f:
+        f.write((f'ply\nformat {fmt} 1.0\n'
+                 f'element vertex {len(positions)}\n'
+                 f'property {vtype[1]} x\nproperty {vtype[1]} y\nproperty {vtype[1]} z\n'
+                 f'element face {len(faces)}\n'
+                 f'property list uchar {itype[1]} vertex_indices\n'
+                 'end_header\n').encode())
+        f.write(positions.astype(vtype[0]).tobytes())
+        records = np.zeros(len(faces), dtype=[('n', 'u1'), ('i', itype[0], 3)])
+        records['n'], records['i'] = 3, faces
+        f.write(records.tobytes())
+
+    mesh = mi.load_dict({ 'type': 'ply', 'filename': filepath, 'face_normals': True })
+    assert mesh.vertex_count() == n * n
+    assert mesh.face_count() == len(faces)
+
+    params = mi.traverse(mesh)
+    assert np.all(np.array(params['vertex_positions']).reshape(-1, 3) == positions)
+    assert np.all(np.array(params['faces']).reshape(-1, 3) == faces)
+    assert dr.all(mesh.bbox().max == [n - 1, n - 1, 6])
+
+    # Truncated files are rejected
+    with open(filepath, 'r+b') as f:
+        f.truncate(os.path.getsize(filepath) - 1)
+    with pytest.raises(RuntimeError, match='unexpected end of file'):
+        mi.load_dict({ 'type': 'ply', 'filename': filepath })
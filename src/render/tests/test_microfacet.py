@@ -307,3 +307,21 @@ def test06_chi2(variants_vec_backends_once, md_type_name, alpha, sample_visible,
     )
 
     assert chi2.run()
+
+
+@pytest.mark.parametrize("md_type", [mi.MicrofacetType.GGX, mi.MicrofacetType.Beckmann])
+def test07_sample_visible_pdf(variants_vec_backends_once, md_type):
+    mdf = mi.MicrofacetDistribution(md_type, 0.2, 0.45, True)
+
+    u = dr.linspace(mi.Float, 0.01, 0.99, 16)
+    u1, u2 = dr.meshgrid(u, u)
+    wi = dr.normalize(mi.Vector3f(0.5, -0.3, 0.4))
+    m, pdf = mdf.sample(wi, mi.Point2f(u1, u2))
+
+    # Visible normals face the incident direction
+    assert dr.all(dr.dot(wi, m) > 0)
+    assert dr.allclose(dr.norm(m), 1)
+
+    D, g1 = mdf.eval(m), mdf.smith_g1(wi, m)
+    assert dr.allclose(pdf, mdf.pdf(wi, m), rtol=1e-4)
+    assert dr.allclose(mdf.pdf(wi, m, D, g1), mdf.pdf(wi, m), rtol=1e-5)
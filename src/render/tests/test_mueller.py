@@ -193,3 +193,19 @@ def test09_circular(variant_scalar_rgb):
     # Light that is already circularly polarized is unchanged.
     dr.allclose(L @ Array4f([1, 0, 0, -1]), Array4f([0.5, 0, 0, -1]))
     dr.allclose(R @ Array4f([1, 0, 0, +1]), Array4f([0.5, 0, 0, +1]))
+
+
+def test10_apply_stokes(variant_scalar_rgb):
+    import numpy as np
+    rng = np.random.default_rng(0)
+    M = rng.uniform(-1, 1, (4, 4))
+    S = rng.uniform(-1, 1, (4, 4))
+
+    # Only the first column of 'S' holds the Stokes vector
+    result = mi.mueller.apply_stokes(mi.Matrix4f(M.tolist()), mi.Matrix4f(S.tolist())).numpy()
+    assert dr.allclose(result[:, 0], M @ S[:, 0], atol=1e-5)
+    assert dr.allclose(result[:, 1:], 0)
+
+    # Unpolarized light through a linear polarizer
+    s = mi.mueller.apply_stokes(mi.mueller.linear_polarizer(), mi.mueller.depolarizer(2.0))
+    assert dr.allclose(s.numpy()[:, 0], [1, 1, 0, 0])
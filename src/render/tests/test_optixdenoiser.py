@@ -94,7 +94,8 @@ def test01_denoiser_construct(variants_any_cuda):
 
     assert (
         "OptixDenoiser[\n  input_size = [33, 18],\n  albedo = 0,\n  " +
-        "normals = 0,\n  temporal = 0\n]" == str(mi.OptixDenoiser(input_res))
+        "normals = 0,\n  temporal = 0,\n  tile_size = [33, 18]\n]" ==
+        str(mi.OptixDenoiser(input_res))
     )
 
     with pytest.raises(Exception) as e:
@@ -241,3 +242,19 @@ def test05_denoiser_denoise_multichannel_bitmap_runs(variant_cuda_ad_rgb):
     dr.eval(denoised)
 
     assert True
+
+
+def test06_denoiser_denoise_tiled(variant_cuda_ad_rgb):
+    noisy = mi.TensorXf(mi.Bitmap(find_resource("resources/data/tests/denoiser/noisy.exr")))
+    albedo = mi.TensorXf(mi.Bitmap(find_resource("resources/data/tests/denoiser/albedo.exr")))
+    size = noisy.shape[1], noisy.shape[0]
+
+    denoiser = mi.OptixDenoiser(size, True)
+    tiled_size = [(size[0] + 2) // 3, (size[1] + 1) // 2]
+    tiled_denoiser = mi.OptixDenoiser(size, True, tile_size=tiled_size)
+    assert f"tile_size = [{tiled_size[0]}, {tiled_size[1]}]" in str(tiled_denoiser)
+
+    # The overlap between the tiles hides the seams
+    ref = denoiser(noisy, False, albedo)
+    denoised = tiled_denoiser(noisy, False, albedo)
+    assert dr.allclose(denoised.array, ref.array, rtol=1e-2, atol=1e-2)
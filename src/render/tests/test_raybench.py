@@ -0,0 +1,73 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def make_scene(sensor=True, emitter=True):
+    scene = {
+        'type': 'scene',
+        'floor': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.scale(10)
+        },
+        'sphere': { 'type': 'sphere', 'center': [0, 0, 1] }
+    }
+    if sensor:
+        scene['sensor'] = {
+            'type': 'perspective',
+            'fov': 30,
+            'to_world': mi.ScalarTransform4f.look_at(
+                origin=[0, -8, 4], target=[0, 0, 0], up=[0, 0, 1])
+        }
+    if emitter:
+        scene['emitter'] = { 'type': 'point', 'position': [0, 0, 5] }
+    return mi.load_dict(scene)
+
+
+def test01_construct(variant_scalar_rgb):
+    scene = make_scene()
+    bench = mi.RayBenchmark(scene, batch_size=256, seed=3)
+    assert bench.batch_size() == 256
+    assert bench.seed() == 3
+    bench.set_batch_size(512)
+    assert bench.batch_size() == 512
+
+    with pytest.raises(RuntimeError):
+        bench.set_batch_size(0)
+    with pytest.raises(RuntimeError):
+        bench.run(mi.RayBenchmarkType.Primary, 0)
+
+
+@pytest.mark.parametrize('type', ['Primary', 'Diffuse', 'Shadow'])
+def test02_run(variants_all_rgb, type):
+    type = getattr(mi.RayBenchmarkType, type)
+    bench = mi.RayBenchmark(make_scene(), batch_size=1000)
+    result = bench.run(type, 2500, warm_passes=2)
+
+    assert result.type == type
+    assert result.ray_count == 2500
+    assert result.batch_size == 1000
+    assert result.warm_passes == 2
+    assert 0 < result.traced_count <= result.ray_count
+    assert result.hit_count <= result.traced_count
+    assert result.cold_time > 0 and result.warm_time > 0
+    assert result.warm_rays_per_second() > 0
+
+    if type == mi.RayBenchmarkType.Primary:
+        # Every primary ray of the camera sees the floor or the sphere
+        assert result.traced_count == result.ray_count
+        assert result.hit_count == result.ray_count
+    elif type == mi.RayBenchmarkType.Shadow:
+        # The point light above the sphere is visible from most of the floor
+        assert result.hit_count < result.traced_count
+
+    # Identical rays are traced for the same seed
+    assert bench.run(type, 2500, warm_passes=1).hit_count == result.hit_count
+
+
+def test03_no_sensor_no_emitter(variants_all_rgb):
+    bench = mi.RayBenchmark(make_scene(sensor=False, emitter=False))
+    for type in [mi.RayBenchmarkType.Primary, mi.RayBenchmarkType.Diffuse,
+                 mi.RayBenchmarkType.Shadow]:
+        result = bench.run(type, 1000, warm_passes=1)
+        assert result.traced_count > 0
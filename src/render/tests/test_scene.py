@@ -246,3 +246,567 @@ def test09_test_emitter_sampling_weight_update(variants_all_backends_once):
     assert dr.allclose(scene.pdf_emitter(0), pdf[0])
     assert dr.allclose(scene.pdf_emitter(1), pdf[1])
     assert dr.allclose(scene.pdf_emitter(2), pdf[2])
+
+
+def make_many_lights_scene(emitter_sampling):
+    scene_dict = {
+        'type': 'scene',
+        'emitter_sampling': emitter_sampling,
+        'envmap': {'type': 'constant', 'radiance': {'type': 'rgb', 'value': 0.1}},
+    }
+
+    # A grid of small, downward-facing area lights above the origin
+    for i in range(6):
+        for j in range(6):
+            scene_dict[f'light_{i}_{j}'] = {
+                'type': 'rectangle',
+                'to_world': mi.ScalarTransform4f.translate([2 * i - 5, 2 * j - 5, 3])
+                          @ mi.ScalarTransform4f.scale(0.2)
+                          @ mi.ScalarTransform4f.rotate([1, 0, 0], 180),
+                'emitter': {'type': 'area', 'radiance': {'type': 'rgb', 'value': 1 + i + j}}
+            }
+
+    return mi.load_dict(scene_dict)
+
+
+def test10_light_tree_pdf_consistency(variants_vec_rgb):
+    scene = make_many_lights_scene('light_tree')
+    assert len(scene.emitters()) == 37
+
+    n = 10000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+
+    ref = dr.zeros(mi.Interaction3f, n)
+    ref.p = mi.Point3f(4 * sampler.next_1d() - 2, 4 * sampler.next_1d() - 2, 0)
+    ref.n = mi.Normal3f(0, 0, 1)
+
+    ds, spec = scene.sample_emitter_direction(ref, sampler.next_2d(), False)
+    pdf = scene.pdf_emitter_direction(ref, ds)
+
+    valid = ds.pdf > 0
+    assert dr.all(dr.select(valid, dr.abs(pdf - ds.pdf) <= 1e-3 * ds.pdf, True))
+    assert dr.count(valid) > 0.9 * n
+
+
+def test11_light_tree_irradiance(variants_vec_rgb):
+    n = 100000
+    ref = dr.zeros(mi.Interaction3f, n)
+    ref.p = mi.Point3f(0.5, -0.5, 0)
+    ref.n = mi.Normal3f(0, 0, 1)
+
+    values = []
+    for emitter_sampling in ['weight', 'light_tree']:
+        scene = make_many_lights_scene(emitter_sampling)
+        sampler = mi.load_dict({'type': 'independent'})
+        sampler.seed(0, n)
+
+        ds, spec = scene.sample_emitter_direction(ref, sampler.next_2d(), False)
+        cos_theta = dr.maximum(dr.dot(ds.d, ref.n), 0)
+        values.append(dr.mean(spec.x * cos_theta)[0])
+
+    assert dr.allclose(values[0], values[1], rtol=5e-2)
+
+
+def test12_power_emitter_sampling(variants_all_backends_once):
+    import numpy as np
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'emitter_sampling': 'power',
+        'shape': {'type': 'sphere', 'emitter': {'type': 'area', 'radiance': {'type': 'rgb', 'value': 2.0}}},
+        'emitter_0': {'type': 'point', 'intensity': {'type': 'rgb', 'value': 3.0}},
+        'emitter_1': {'type': 'point', 'intensity': {'type': 'rgb', 'value': 1.0}, 'sampling_weight': 0.5},
+    })
+
+    emitters = scene.emitters()
+    if mi.is_rgb:
+        # 4 pi * intensity for point lights, pi * area * radiance for area lights
+        fluxes = sorted(e.flux() for e in emitters)
+        assert dr.allclose(fluxes, [4 * dr.pi, 12 * dr.pi, 8 * dr.pi**2])
+
+    def check():
+        weights = np.array([e.sampling_weight() * e.flux() for e in emitters])
+        pdf = weights / np.sum(weights)
+        for i in range(len(emitters)):
+            assert dr.allclose(scene.pdf_emitter(i), pdf[i])
+
+    check()
+
+    # Flux estimates are updated when emitters change
+    params = mi.traverse(scene)
+    key = [k for k in params.keys() if k.endswith('intensity.value')][0]
+    flux = [e.flux() for e in emitters]
+    params[key] = 10.0
+    params.update()
+    assert any(not dr.allclose(a, e.flux()) for a, e in zip(flux, emitters))
+    check()
+
+
+def test13_accel_build_options(variants_all_backends_once):
+    def make_scene(**kwargs):
+        return mi.load_dict({
+            'type': 'scene',
+            'shape': {'type': 'sphere'},
+            **kwargs
+        })
+
+    ray = mi.Ray3f(mi.Point3f(0, 0, -3), mi.Vector3f(0, 0, 1))
+    reference = make_scene().ray_intersect(ray).t
+
+    for options in [{'accel_build': 'fast_build'},
+                    {'accel_build': 'balanced'},
+                    {'accel_compaction': False},
+                    {'accel_memory_report': True},
+                    {'embree_compact': True, 'embree_robust': True}]:
+        scene = make_scene(**options)
+        assert dr.allclose(scene.ray_intersect(ray).t, reference)
+
+    with pytest.raises(RuntimeError, match='accel_build'):
+        make_scene(accel_build='fastest')
+
+
+def test14_statistics(variant_scalar_rgb):
+    import numpy as np
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': { 'type': 'path', 'max_depth': 4 },
+        'sensor': {
+            'type': 'perspective',
+            'to_world': mi.ScalarTransform4f.look_at(origin=[0, 0, 5],
+                                                     target=[0, 0, 0],
+                                                     up=[0, 1, 0]),
+            'film': { 'type': 'hdrfilm', 'width': 16, 'height': 16 },
+            'sampler': { 'type': 'independent', 'sample_count': 4 }
+        },
+        'sphere': {
+            'type': 'sphere',
+            'bsdf': {
+                'type': 'diffuse',
+                'reflectance': {
+                    'type': 'bitmap',
+                    'bitmap': mi.Bitmap(np.full((4, 4, 3), 0.5, dtype=np.float32))
+                }
+            }
+        },
+        'rect': {
+            'type': 'rectangle',
+            'to_world': mi.ScalarTransform4f.translate([0, 0, -10]).scale(100)
+        },
+        'emitter': { 'type': 'constant' }
+    })
+
+    scene.reset_statistics()
+    mi.render(scene)
+    stats = scene.statistics()
+
+    assert len(stats['shapes']) == 2
+    assert len(stats['bsdfs']) == 2
+    bitmaps = [t for t in stats['textures']
+               if str(t['texture']).startswith('BitmapTexture')]
+    assert len(bitmaps) == 1
+    assert len(stats['path_lengths']) == 64
+
+    if not mi.MI_ENABLE_STATISTICS:
+        assert all(s['ray_intersections'] == 0 for s in stats['shapes'])
+        return
+
+    hits = sum(s['ray_intersections'] for s in stats['shapes'])
+    assert hits > 0
+    assert all(b['eval'] > 0 and b['sample'] > 0 for b in stats['bsdfs'])
+    assert bitmaps[0]['eval'] > 0
+
+    # Every path that found a surface recorded its number of bounces
+    assert sum(stats['path_lengths'][1:]) == 16 * 16 * 4
+    assert stats['path_lengths'][5] == 0
+
+    # Paths stop at 'max_depth' before Russian roulette and don't meet media
+    events = stats['events']
+    assert events['rr_terminations'] == 0
+    assert events['medium_interactions'] == 0
+    assert events['null_collisions'] == 0
+    assert events['emitter_samples'] > 0
+    assert events['emitter_samples_occluded'] > 0
+    assert events['emitter_samples_occluded'] + \
+        events['emitter_samples_zero'] <= events['emitter_samples']
+
+    scene.reset_statistics()
+    stats = scene.statistics()
+    assert all(s['ray_intersections'] == 0 for s in stats['shapes'])
+    assert all(v == 0 for v in stats['events'].values())
+
+
+def test15_emitter_alias_table(variants_vec_rgb):
+    # Unequally weighted emitters can be chosen using an alias table
+    for alias_table in [False, True]:
+        scene = { 'type': 'scene', 'emitter_alias_table': alias_table }
+        for i in range(16):
+            scene[f'light_{i}'] = {
+                'type': 'point',
+                'position': [i, 0, 1],
+                'sampling_weight': float(i + 1)
+            }
+        scene = mi.load_dict(scene)
+
+        index, weight, _ = scene.sample_emitter(
+            (dr.arange(mi.Float, 1000) + 0.5) / 1000)
+        assert dr.allclose(weight, 136 / mi.Float(index + 1))
+        assert dr.allclose(scene.pdf_emitter(index), (index + 1) / 136)
+
+
+def test16_simplify_bsdfs(variants_all_rgb):
+    diffuse = { 'type': 'diffuse', 'reflectance': { 'type': 'rgb', 'value': [0.2, 0.4, 0.6] } }
+    conductor = { 'type': 'conductor' }
+    shapes = {
+        'blend_0': { 'type': 'blendbsdf', 'weight': 0.0, 'a': diffuse, 'b': conductor },
+        'blend_1': { 'type': 'blendbsdf', 'weight': 1.0, 'a': conductor, 'b': diffuse },
+        'mask': { 'type': 'mask', 'opacity': 1.0, 'nested': diffuse },
+        'bump': { 'type': 'bumpmap', 'height': { 'type': 'uniform', 'value': 0.5 },
+                  'nested': diffuse },
+        'nested': { 'type': 'twosided', 'nested': {
+            'type': 'mask', 'opacity': 1.0, 'nested': {
+                'type': 'blendbsdf', 'weight': 0.0, 'a': diffuse, 'b': conductor } } },
+        'textured': { 'type': 'mask', 'opacity': 0.5, 'nested': diffuse },
+    }
+
+    def load(simplify):
+        scene = { 'type': 'scene', 'simplify_bsdfs': simplify }
+        for name, bsdf in shapes.items():
+            scene[name] = { 'type': 'sphere', 'bsdf': bsdf }
+        return mi.load_dict(scene)
+
+    scene, scene_ref = load(True), load(False)
+    si = dr.zeros(mi.SurfaceInteraction3f)
+    si.wi = mi.Vector3f(0, 0, 1)
+    wo = dr.normalize(mi.Vector3f(0.2, 0.3, 1))
+    ctx = mi.BSDFContext()
+
+    for shape, shape_ref in zip(scene.shapes(), scene_ref.shapes()):
+        bsdf, bsdf_ref = shape.bsdf(), shape_ref.bsdf()
+        name = shape.id()
+        if name in ['blend_0', 'blend_1', 'mask', 'bump']:
+            assert str(bsdf).startswith('SmoothDiffuse')
+        elif name == 'nested':
+            assert str(bsdf).startswith('TwoSided')
+            assert 'SmoothDiffuse' in str(bsdf) and not 'Mask' in str(bsdf)
+        else:
+            assert str(bsdf).startswith('Mask')
+        assert str(bsdf_ref).split('[')[0] != 'SmoothDiffuse'
+        assert dr.allclose(bsdf.eval(ctx, si, wo), bsdf_ref.eval(ctx, si, wo))
+        assert dr.allclose(bsdf.pdf(ctx, si, wo), bsdf_ref.pdf(ctx, si, wo))
+
+
+def test17_scene_editing(variants_all_backends_once):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'sphere': { 'type': 'sphere', 'center': [0, 0, 0], 'radius': 1.0 },
+        'light': { 'type': 'point', 'position': [0, 0, 5] }
+    })
+
+    def t():
+        return [scene.ray_intersect(mi.Ray3f([x, 0, -10], [0, 0, 1])).t
+                for x in [0, 4]]
+
+    assert dr.allclose(t(), [9, dr.inf])
+
+    # Insert a shape with an area emitter
+    rect = mi.load_dict({
+        'type': 'rectangle',
+        'to_world': mi.ScalarTransform4f.translate([4, 0, 0]),
+        'emitter': { 'type': 'area' }
+    })
+    scene.add_shape(rect)
+    scene.parameters_changed()
+    assert len(scene.shapes()) == 2 and len(scene.emitters()) == 2
+    assert dr.allclose(t(), [9, 10])
+    assert dr.allclose(scene.bbox().max, [5, 1, 1])
+    assert dr.width(scene.emitters_dr()) == 2
+
+    # Remove the original shape and the point light
+    scene.remove_shape(scene.shapes()[0])
+    scene.remove_emitter(scene.emitters()[0])
+    scene.parameters_changed()
+    assert len(scene.shapes()) == 1 and len(scene.emitters()) == 1
+    assert dr.allclose(t(), [dr.inf, 10])
+    assert scene.emitters()[0] == rect.emitter()
+
+    # Swap the BSDF
+    bsdf = mi.load_dict({ 'type': 'conductor' })
+    assert scene.replace_bsdf(rect.bsdf(), bsdf) == 1
+    assert rect.bsdf() == bsdf
+
+    with pytest.raises(RuntimeError, match='not part of the scene'):
+        scene.remove_emitter(mi.load_dict({ 'type': 'point' }))
+    with pytest.raises(RuntimeError, match='already part of the scene'):
+        scene.add_shape(rect)
+    with pytest.raises(RuntimeError, match='along with their shape'):
+        scene.add_emitter(rect.emitter())
+
+
+def test18_kernel_signature(variants_all_rgb):
+    def load(bsdf, reflectance=0.5, max_depth=8, width=32):
+        return mi.load_dict({
+            'type': 'scene',
+            'integrator': { 'type': 'path', 'max_depth': max_depth },
+            'sensor': {
+                'type': 'perspective',
+                'film': { 'type': 'hdrfilm', 'width': width, 'height': 16 }
+            },
+            'sphere': {
+                'type': 'sphere',
+                'bsdf': { 'type': bsdf, 'reflectance': { 'type': 'rgb', 'value': reflectance } }
+            },
+            'light': { 'type': 'constant' }
+        })
+
+    sig = load('diffuse').kernel_signature()
+    assert len(sig) == 16
+    assert load('diffuse', reflectance=0.2).kernel_signature() == sig
+    assert load('roughplastic').kernel_signature() != sig
+    assert load('diffuse', max_depth=4).kernel_signature() != sig
+    assert load('diffuse', width=64).kernel_signature() != sig
+
+    with pytest.raises(RuntimeError, match='out of bounds'):
+        load('diffuse').kernel_signature(1)
+
+
+def test19_ray_intersect_occluder(variants_all_rgb):
+    def rectangle(z, bsdf):
+        return { 'type': 'rectangle', 'bsdf': bsdf,
+                 'to_world': mi.ScalarTransform4f.translate([0, 0, z]) }
+
+    null = { 'type': 'null' }
+    scene = mi.load_dict({
+        'type': 'scene',
+        'null_0': rectangle(1, null),
+        'null_1': rectangle(2, null),
+        'opaque': rectangle(3, { 'type': 'diffuse' }),
+    })
+    assert scene.has_passthrough_shapes()
+
+    ray = mi.Ray3f(mi.Point3f([0, 0.5], [0, 0.5], 0), mi.Vector3f(0, 0, 1))
+    si = scene.ray_intersect(ray)
+    assert dr.allclose(si.t, 1)
+
+    # The null interfaces are skipped, the distance is measured from the origin
+    si = scene.ray_intersect_occluder(ray)
+    assert dr.all(si.is_valid())
+    assert dr.allclose(si.t, 3)
+    assert dr.allclose(si.p, [[0, 0.5], [0, 0.5], 3])
+    assert dr.allclose(si.n, [0, 0, 1])
+
+    ray.maxt = 2.5
+    assert dr.none(scene.ray_intersect_occluder(ray).is_valid())
+
+    # Surfaces between different media are not passthrough
+    scene = mi.load_dict({
+        'type': 'scene',
+        'boundary': { 'type': 'sphere',
+                      'bsdf': null,
+                      'interior': { 'type': 'homogeneous' } },
+        'opaque': rectangle(3, { 'type': 'diffuse' }),
+    })
+    assert not scene.has_passthrough_shapes()
+    ray = mi.Ray3f(mi.Point3f(0, 0, -2), mi.Vector3f(0, 0, 1))
+    assert dr.allclose(scene.ray_intersect_occluder(ray).t, 1)
+
+
+@pytest.mark.parametrize('accel', ['kdtree', 'bvh'])
+def test20_occluder_ray_mask(variants_all_rgb, accel):
+    if mi.MI_ENABLE_EMBREE or mi.variant().startswith('cuda'):
+        pytest.skip('Only applies to the native CPU backend')
+
+    def rectangle(z, bsdf):
+        return { 'type': 'rectangle', 'bsdf': bsdf,
+                 'to_world': mi.ScalarTransform4f.translate([0, 0, z]) }
+
+    scene_dict = {
+        'type': 'scene',
+        'accel': accel,
+        'null': rectangle(1, { 'type': 'null' }),
+        'opaque': rectangle(3, { 'type': 'diffuse' }),
+    }
+    if accel == 'kdtree':
+        scene_dict['kd_precompute_triangles'] = True
+    scene = mi.load_dict(scene_dict)
+
+    # The traversal skips the null interface, other queries still report it
+    ray = mi.Ray3f(mi.Point3f(0, 0, 0), mi.Vector3f(0, 0, 1))
+    assert dr.allclose(scene.ray_intersect_occluder(ray).t, 3)
+    assert dr.allclose(scene.ray_intersect(ray).t, 1)
+    assert dr.all(scene.ray_test(mi.Ray3f(ray, 2)))
+
+    # The ray masks follow BSDF replacements
+    null_shape = [s for s in scene.shapes() if s.id() == 'null'][0]
+    assert scene.replace_bsdf(null_shape.bsdf(), mi.load_dict({ 'type': 'diffuse' })) == 1
+    scene.parameters_changed()
+    assert not scene.has_passthrough_shapes()
+    assert dr.allclose(scene.ray_intersect_occluder(ray).t, 1)
+
+
+@pytest.mark.parametrize('shape', ['rectangle', 'mesh'])
+def test21_alpha_test(variants_all_rgb, shape):
+    import numpy as np
+
+    # Cutout whose left half (u < 0.5) is fully transparent
+    cutout = mi.load_dict({
+        'type': 'mask',
+        'cutoff': 0.5,
+        'opacity': {
+            'type': 'bitmap',
+            'bitmap': mi.Bitmap(np.array([[[0.2], [0.8]]], dtype=np.float32)),
+            'filter_type': 'nearest',
+            'raw': True
+        },
+        'bsdf': { 'type': 'diffuse' }
+    })
+    assert cutout.has_alpha_test()
+
+    if shape == 'rectangle':
+        cutout_shape = { 'type': 'rectangle', 'bsdf': cutout,
+                         'to_world': mi.ScalarTransform4f.translate([0, 0, 1]) }
+    else:
+        props = mi.Properties()
+        props['bsdf'] = cutout
+        cutout_shape = mi.Mesh('quad', 4, 2, props=props,
+                               has_vertex_texcoords=True)
+        params = mi.traverse(cutout_shape)
+        params['vertex_positions'] = [-1, -1, 1, 1, -1, 1, 1, 1, 1, -1, 1, 1]
+        params['vertex_texcoords'] = [0, 0, 1, 0, 1, 1, 0, 1]
+        params['faces'] = [0, 1, 2, 0, 2, 3]
+        params.update()
+
+    scene = mi.load_dict({
+        'type': 'scene',
+        'cutout': cutout_shape,
+        'opaque': { 'type': 'rectangle', 'bsdf': { 'type': 'diffuse' },
+                    'to_world': mi.ScalarTransform4f.translate([0, 0, 3]) },
+    })
+    assert scene.has_alpha_tested_shapes()
+
+    # The transparent half is skipped by all ray tracing queries
+    for x, y, t in [(-0.5, 0.2, 3), (0.5, -0.3, 1)]:
+        ray = mi.Ray3f(mi.Point3f(x, y, 0), mi.Vector3f(0, 0, 1))
+        si = scene.ray_intersect(ray)
+        assert dr.allclose(si.t, t)
+        assert dr.allclose(si.p, [x, y, t])
+        assert dr.allclose(scene.ray_intersect_preliminary(ray).t, t)
+        assert dr.all(scene.ray_test(mi.Ray3f(ray, 2)) == (t == 1))
+
+        # The opaque half uses the nested BSDF without any transparency
+        if t == 1:
+            assert dr.allclose(cutout.eval_null_transmission(si), 0)
+
+    with pytest.raises(RuntimeError, match='cutoff'):
+        mi.load_dict({ 'type': 'mask', 'cutoff': 2,
+                       'bsdf': { 'type': 'diffuse' } })
+
+
+def test22_ray_flags(variants_all_rgb):
+    import numpy as np
+
+    def scene_flags(bsdf):
+        return mi.load_dict({
+            'type': 'scene',
+            'shape': { 'type': 'rectangle', 'bsdf': bsdf },
+        }).ray_flags()
+
+    base = mi.RayFlags.Minimal | mi.RayFlags.ShadingFrame
+
+    # Constant materials only need the position and the shading frame
+    assert scene_flags({ 'type': 'diffuse' }) == base
+    assert mi.load_dict({'type': 'roughconductor'}).ray_flags() == 0
+
+    # Textures request the UV coordinates, anisotropic BSDFs the partials
+    texture = { 'type': 'checkerboard' }
+    assert scene_flags({ 'type': 'diffuse', 'reflectance': texture }) == \
+        base | mi.RayFlags.UV
+    assert scene_flags({ 'type': 'roughconductor', 'alpha_u': 0.1,
+                         'alpha_v': 0.3 }) == base | mi.RayFlags.dPdUV
+    assert scene_flags({ 'type': 'normalmap', 'normalmap': {
+                             'type': 'bitmap', 'bitmap': mi.Bitmap(
+                                 np.full((2, 2, 3), 0.5, dtype=np.float32))
+                         }, 'bsdf': { 'type': 'diffuse' } }) == \
+        base | mi.RayFlags.UV | mi.RayFlags.dPdUV
+
+    # Nested BSDFs are visited as well
+    assert scene_flags({ 'type': 'twosided', 'bsdf': {
+                             'type': 'diffuse', 'reflectance': texture } }) == \
+        base | mi.RayFlags.UV
+
+    # The surface interactions provide the requested fields
+    scene = mi.load_dict({
+        'type': 'scene',
+        'shape': { 'type': 'rectangle', 'bsdf': { 'type': 'diffuse' },
+                   'to_world': mi.ScalarTransform4f.translate([0, 0, 1]) },
+    })
+    ray = mi.Ray3f(mi.Point3f(0.2, 0.1, 0), mi.Vector3f(0, 0, 1))
+    si = scene.ray_intersect(ray, scene.ray_flags(), True)
+    ref = scene.ray_intersect(ray)
+    assert dr.allclose(si.p, ref.p)
+    assert dr.allclose(si.sh_frame.n, ref.sh_frame.n)
+
+
+def make_point_lights_scene(emitter_sampling):
+    scene_dict = {
+        'type': 'scene',
+        'emitter_sampling': emitter_sampling,
+        'light_grid_resolution': 16,
+        'envmap': {'type': 'constant', 'radiance': {'type': 'rgb', 'value': 0.01}},
+        'floor': {'type': 'rectangle', 'to_world': mi.ScalarTransform4f.scale(10)},
+    }
+
+    # Street lights above a large floor, every second one is a spot light
+    for i in range(10):
+        for j in range(10):
+            p = [2 * i - 9, 2 * j - 9, 0.5]
+            if (i + j) % 2 == 0:
+                scene_dict[f'light_{i}_{j}'] = {
+                    'type': 'point', 'position': p,
+                    'intensity': {'type': 'rgb', 'value': 1 + i}
+                }
+            else:
+                scene_dict[f'light_{i}_{j}'] = {
+                    'type': 'spot', 'cutoff_angle': 30,
+                    'to_world': mi.ScalarTransform4f.look_at(
+                        origin=p, target=[p[0], p[1], 0], up=[0, 1, 0]),
+                    'intensity': {'type': 'rgb', 'value': 2 + j}
+                }
+
+    return mi.load_dict(scene_dict)
+
+
+def test23_light_grid(variants_vec_rgb):
+    scene = make_point_lights_scene('light_grid')
+    assert len(scene.emitters()) == 101
+
+    # The cone of a spot light points along its axis
+    spot = [e for e in scene.emitters() if 'Spot' in str(e)][0]
+    axis, cos_cone = spot.emission_cone()
+    assert dr.allclose(axis, [0, 0, -1]) and dr.allclose(cos_cone, dr.cos(dr.pi / 6))
+
+    n = 100000
+    sampler = mi.load_dict({'type': 'independent'})
+    sampler.seed(0, n)
+    ref = dr.zeros(mi.Interaction3f, n)
+    ref.p = mi.Point3f(18 * sampler.next_1d() - 9, 18 * sampler.next_1d() - 9, 0)
+    ref.n = mi.Normal3f(0, 0, 1)
+
+    # The sampling density matches the one evaluated for the chosen emitter
+    ds, spec = scene.sample_emitter_direction(ref, sampler.next_2d(), False)
+    pdf = scene.pdf_emitter_direction(ref, ds)
+    valid = ds.pdf > 0
+    assert dr.all(dr.select(valid, dr.abs(pdf - ds.pdf) <= 1e-3 * ds.pdf, True))
+
+    # The estimated irradiance is the same as with the default strategy
+    values = []
+    for emitter_sampling in ['weight', 'light_grid']:
+        scene = make_point_lights_scene(emitter_sampling)
+        sampler.seed(1, n)
+        ref.p = mi.Point3f(0.5, -0.5, 0)
+        ds, spec = scene.sample_emitter_direction(ref, sampler.next_2d(), False)
+        cos_theta = dr.maximum(dr.dot(ds.d, ref.n), 0)
+        values.append(dr.mean(spec.x * cos_theta)[0])
+
+    assert dr.allclose(values[0], values[1], rtol=5e-2)
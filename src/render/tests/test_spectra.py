@@ -139,3 +139,47 @@ def test07_cie1931_srgb_roundtrip(variants_vec_spectral):
 
     assert dr.allclose(mi.xyz_to_srgb(xyz), srgb)
     assert dr.allclose(mi.srgb_to_xyz(srgb), xyz, atol=1e-6)
+
+
+def test08_rgb2spec_fetch_array(variant_scalar_spectral, np_rng):
+    import numpy as np
+
+    # Large arrays (converted in parallel) with runs of identical colors
+    rgb = np_rng.random((3000, 3)).astype(np.float32)
+    rgb = np.repeat(rgb, 3, axis=0)
+    rgb[::7] = 0.5
+    rgb[::11] = [0.0, 1.0, 0.0]
+
+    coeff = mi.srgb_model_fetch(rgb)
+    assert coeff.shape == rgb.shape
+    for i in range(0, len(rgb), 97):
+        assert np.array_equal(coeff[i], np.array(mi.srgb_model_fetch(mi.ScalarColor3f(rgb[i]))))
+
+    with pytest.raises(RuntimeError):
+        mi.srgb_model_fetch(np.zeros((4, 2), dtype=np.float32))
+
+
+@pytest.mark.parametrize('temperature', [1500, 5000, 12000])
+def test09_blackbody_tabulated(variant_scalar_spectral, np_rng, temperature):
+    """The tabulated blackbody spectrum should match Planck's law and sample
+    wavelengths proportionally to its values."""
+
+    tabulated = mi.load_dict({ "type" : "blackbody",
+                               "temperature" : temperature })
+    analytic = mi.load_dict({ "type" : "blackbody",
+                              "temperature" : temperature,
+                              "resolution" : 0 })
+    ps = mi.PositionSample3f()
+
+    for _ in range(10):
+        wavelengths = 360 + np_rng.random(4) * 470
+        si = mi.SurfaceInteraction3f(ps, wavelengths)
+        assert dr.allclose(tabulated.eval(si), analytic.eval(si), rtol=2e-3)
+
+        wavelengths, weight = tabulated.sample_spectrum(si, np_rng.random(4))
+        si = mi.SurfaceInteraction3f(ps, wavelengths)
+        assert dr.allclose(weight, tabulated.eval(si) / tabulated.pdf_spectrum(si),
+                           rtol=1e-3)
+
+    assert dr.allclose(tabulated.mean(), analytic.mean(), rtol=1e-3)
+    assert dr.allclose(tabulated.max(), analytic.max())
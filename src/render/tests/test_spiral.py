@@ -77,3 +77,83 @@ def test03_normal_film(variant_scalar_rgb):
     # Resetting and re-querying the blocks should yield the exact same results.
     s.reset()
     check_first_blocks(extract_blocks(s), expected, n_total=110)
+
+
+def test04_multiple_passes(variant_scalar_rgb):
+    f = make_film(318, 322)
+    s = mi.Spiral(f.size(), f.crop_offset(), passes=3)
+    assert s.pass_count() == 3
+
+    blocks = extract_blocks(s)
+    assert len(blocks) == 3 * s.block_count()
+
+    # Every pass should visit the blocks in the same spiral order
+    n = s.block_count()
+    for i in range(n):
+        assert dr.all(blocks[i][0] == blocks[i + n][0])
+        assert dr.all(blocks[i][0] == blocks[i + 2 * n][0])
+
+    # Block identifiers must be unique across passes
+    ids = [b[2] for b in blocks]
+    assert len(set(ids)) == len(ids)
+    assert max(ids) == 3 * n - 1
+
+    # Querying a finished spiral keeps returning empty blocks
+    assert dr.all(s.next_block()[1] == 0)
+    assert dr.all(s.next_block()[1] == 0)
+
+
+@pytest.mark.parametrize('order', ['Hilbert', 'Morton'])
+def test05_curve_orders(variant_scalar_rgb, order):
+    order = getattr(mi.BlockOrder, order)
+
+    # Every block of a non-square film is visited exactly once
+    f = make_film(318, 322)
+    s = mi.Spiral(f.size(), f.crop_offset(), order=order)
+    assert s.order() == order
+    blocks = extract_blocks(s)
+    assert len(blocks) == s.block_count() == 110
+    offsets = set((int(b[0][0]), int(b[0][1])) for b in blocks)
+    assert len(offsets) == len(blocks)
+
+    # The curves start in the top left corner
+    assert dr.all(blocks[0][0] == [0, 0])
+
+    f = make_film(256, 256)
+    s = mi.Spiral(f.size(), f.crop_offset(), order=order)
+    blocks = extract_blocks(s)
+    w = 32
+    if order == mi.BlockOrder.Morton:
+        expected = [[0, 0], [w, 0], [0, w], [w, w], [2 * w, 0]]
+        for i, e in enumerate(expected):
+            assert dr.all(blocks[i][0] == e)
+    else:
+        # Consecutive blocks of the Hilbert curve are adjacent
+        for a, b in zip(blocks[:-1], blocks[1:]):
+            d = abs(a[0][0] - b[0][0]) + abs(a[0][1] - b[0][1])
+            assert d == w
+
+
+def test06_next_blocks(variant_scalar_rgb):
+    f = make_film(318, 322)
+    s = mi.Spiral(f.size(), f.crop_offset(), passes=2)
+    n = s.block_count()
+
+    # Runs of blocks match the sequence of individual blocks
+    ref = extract_blocks(mi.Spiral(f.size(), f.crop_offset(), passes=2))
+    blocks = []
+    while True:
+        begin, end = s.next_blocks(7)
+        if begin == end:
+            break
+        assert end - begin <= 7
+        blocks += [s.block(i) for i in range(begin, end)]
+    assert len(blocks) == 2 * n
+    for a, b in zip(blocks, ref):
+        assert dr.all(a[0] == b[0]) and a[2] == b[2]
+
+    # The traversal stays finished, and can be restarted
+    assert s.next_blocks(7) == (0, 0)
+    assert dr.all(s.next_block()[1] == 0)
+    s.reset()
+    assert s.next_blocks(n) == (n, 2 * n)
@@ -46,3 +46,21 @@ def test03_max_per_channel(variants_all_scalar, tmpdir, np_rng):
     grid = mi.VolumeGrid(tmp_file)
     mi_max_per_channel = grid.max_per_channel()
     assert dr.allclose(np_max_per_channel, mi_max_per_channel)
+
+
+def test04_large_read(variants_all_scalar, tmpdir, np_rng):
+    # Spans several reduction blocks and an odd number of channels
+    tmp_file = os.path.join(str(tmpdir), "out.vol")
+    data = np_rng.random((40, 48, 64, 3)) - 0.5
+    data[17, 5, 33, 1] = 4.0
+    mi.VolumeGrid(data).write(tmp_file)
+    grid = mi.VolumeGrid(tmp_file)
+    assert dr.allclose(np.array(grid), data)
+    assert dr.allclose(grid.max(), 4.0)
+    assert dr.allclose(grid.max_per_channel(),
+                       [np.max(data[..., c]) for c in range(3)])
+
+    # Recompute the maxima after the data was changed
+    grid = mi.VolumeGrid(data, False)
+    grid.update_max()
+    assert dr.allclose(grid.max(), 4.0)
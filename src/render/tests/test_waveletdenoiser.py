@@ -0,0 +1,61 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def test01_construct(variants_all_rgb):
+    assert str(mi.WaveletDenoiser([33, 18])) == (
+        "WaveletDenoiser[\n  input_size = [33, 18],\n  albedo = 0,\n  "
+        "normals = 0,\n  iterations = 5,\n  color_sigma = 0.5\n]")
+
+    with pytest.raises(Exception) as e:
+        mi.WaveletDenoiser([33, 18], albedo=False, normals=True)
+    e.match("The denoiser cannot use normals to guide its process without "
+            "also providing albedo information!")
+
+
+def test02_denoise_constant(variants_all_rgb):
+    np = pytest.importorskip("numpy")
+    rng = np.random.default_rng(0)
+    noisy = 0.5 + 0.1 * rng.standard_normal((32, 48, 3))
+
+    denoiser = mi.WaveletDenoiser([48, 32])
+    denoised = denoiser(mi.TensorXf(noisy.astype(np.float32)))
+    assert denoised.shape == (32, 48, 3)
+
+    denoised = np.array(denoised)
+    assert abs(np.mean(denoised) - 0.5) < 1e-2
+    assert np.std(denoised) < 0.25 * np.std(noisy)
+
+    with pytest.raises(Exception) as e:
+        denoiser(mi.TensorXf(noisy[:16].astype(np.float32)))
+    e.match("does not have this size")
+
+
+def test03_denoise_albedo_edge(variants_all_rgb):
+    np = pytest.importorskip("numpy")
+    rng = np.random.default_rng(1)
+    albedo = np.full((32, 32, 3), 0.1, dtype=np.float32)
+    albedo[:, 16:] = 0.9
+    noisy = (albedo * (1 + 0.2 * rng.standard_normal((32, 32, 3)))).astype(np.float32)
+    normals = np.zeros((32, 32, 3), dtype=np.float32)
+    normals[..., 2] = 1
+
+    # The albedo guide keeps both sides of the edge apart
+    denoiser = mi.WaveletDenoiser([32, 32], albedo=True, normals=True)
+    denoised = np.array(denoiser(mi.TensorXf(noisy), True,
+                                 mi.TensorXf(albedo), mi.TensorXf(normals)))
+    assert np.allclose(denoised, albedo, rtol=0.1)
+
+
+def test04_denoise_bitmap(variants_all_rgb):
+    np = pytest.importorskip("numpy")
+    rng = np.random.default_rng(2)
+    noisy = (0.5 + 0.1 * rng.standard_normal((16, 24, 4))).astype(np.float32)
+
+    # Bitmaps and tensors give the same result, alpha is kept if requested
+    denoiser = mi.WaveletDenoiser([24, 16], iterations=3)
+    bmp = denoiser(mi.Bitmap(noisy, mi.Bitmap.PixelFormat.RGBA), False)
+    tensor = denoiser(mi.TensorXf(noisy), False)
+    assert np.allclose(np.array(bmp), np.array(tensor), atol=1e-5)
+    assert np.allclose(np.array(bmp)[..., 3], noisy[..., 3])
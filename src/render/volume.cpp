@@ -56,11 +56,20 @@ Volume<Float, Spectrum>::max_per_channel(ScalarFloat * /*out*/) const {
     NotImplementedError("max_per_channel");
 }
 
+MI_VARIANT std::vector<typename Volume<Float, Spectrum>::ScalarFloat>
+Volume<Float, Spectrum>::max_grid(const ScalarVector3u &res) const {
+    return std::vector<ScalarFloat>(dr::prod(res), max());
+}
+
 MI_VARIANT typename Volume<Float, Spectrum>::ScalarVector3i
 Volume<Float, Spectrum>::resolution() const {
     return ScalarVector3i(1, 1, 1);
 }
 
+MI_VARIANT bool Volume<Float, Spectrum>::is_spectrally_varying() const {
+    return true;
+}
+
 //! @}
 // =======================================================================
 
@@ -1,8 +1,11 @@
 #include <mitsuba/render/volumegrid.h>
 #include <mitsuba/core/stream.h>
 #include <mitsuba/core/logger.h>
+#include <mitsuba/core/astream.h>
 #include <mitsuba/core/fstream.h>
 #include <mitsuba/core/util.h>
+#include <nanothread/nanothread.h>
+#include <mutex>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -11,7 +14,7 @@ VolumeGrid<Float, Spectrum>::VolumeGrid(Stream *stream) { read(stream); }
 
 MI_VARIANT
 VolumeGrid<Float, Spectrum>::VolumeGrid(const fs::path &filename) {
-    ref<FileStream> fs = new FileStream(filename);
+    ref<AsyncFileStream> fs = new AsyncFileStream(filename);
     read(fs);
 }
 
@@ -63,25 +66,58 @@ void VolumeGrid<Float, Spectrum>::read(Stream *stream) {
     m_bbox = ScalarBoundingBox3f(ScalarPoint3f(dims[0], dims[1], dims[2]),
                                  ScalarPoint3f(dims[3], dims[4], dims[5]));
 
-    m_max = -dr::Infinity<ScalarFloat>;
-    m_max_per_channel.resize(m_channel_count, -dr::Infinity<ScalarFloat>);
-
-    m_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size * m_channel_count]);
-    size_t k = 0;
-    for (size_t i = 0; i < size; ++i) {
-        for (size_t j = 0; j < m_channel_count; ++j) {
-            float val;
-            stream->read(val);
-            m_data[k] = val;
-            m_max     = dr::maximum(m_max, val);
-            m_max_per_channel[j] = dr::maximum(m_max_per_channel[j], val);
-            ++k;
+    m_max_per_channel.resize(m_channel_count);
+
+    // Read all voxels at once, byte swapping happens in place if needed
+    size_t count = size * m_channel_count;
+    m_data = std::unique_ptr<ScalarFloat[]>(new ScalarFloat[count]);
+    if constexpr (std::is_same<ScalarFloat, float>::value) {
+        stream->read_array(m_data.get(), count);
+    } else {
+        // Need to convert the single precision data on disk
+        const size_t chunk_size = 1 << 20;
+        std::unique_ptr<float[]> chunk(new float[std::min(chunk_size, count)]);
+        for (size_t i = 0; i < count; i += chunk_size) {
+            size_t n = std::min(chunk_size, count - i);
+            stream->read_array(chunk.get(), n);
+            for (size_t j = 0; j < n; ++j)
+                m_data[i + j] = (ScalarFloat) chunk[j];
         }
     }
+
+    update_max();
     Log(Debug, "Loaded grid volume data from file: dimensions %s, max value %f",
         m_size, m_max);
 }
 
+MI_VARIANT
+void VolumeGrid<Float, Spectrum>::update_max() {
+    size_t voxel_count = dr::prod(m_size),
+           block_size  = std::max<size_t>(1, 65536 / m_channel_count);
+
+    std::mutex mutex;
+    m_max = -dr::Infinity<ScalarFloat>;
+    m_max_per_channel.assign(m_channel_count, -dr::Infinity<ScalarFloat>);
+
+    dr::parallel_for(
+        dr::blocked_range<size_t>(0, voxel_count, block_size),
+        [&](const dr::blocked_range<size_t> &range) {
+            std::vector<ScalarFloat> local(m_channel_count,
+                                           -dr::Infinity<ScalarFloat>);
+            const ScalarFloat *ptr = m_data.get() + range.begin() * m_channel_count;
+            for (size_t i = range.begin(); i != range.end(); ++i)
+                for (size_t j = 0; j < m_channel_count; ++j)
+                    local[j] = dr::maximum(local[j], *ptr++);
+
+            std::lock_guard<std::mutex> guard(mutex);
+            for (size_t j = 0; j < m_channel_count; ++j) {
+                m_max_per_channel[j] = dr::maximum(m_max_per_channel[j], local[j]);
+                m_max = dr::maximum(m_max, local[j]);
+            }
+        }
+    );
+}
+
 MI_VARIANT
 void VolumeGrid<Float, Spectrum>::max_per_channel(ScalarFloat *out) const {
     for (size_t i=0; i<m_channel_count; ++i)
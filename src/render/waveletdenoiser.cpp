@@ -0,0 +1,298 @@
+#include <mitsuba/render/waveletdenoiser.h>
+#include <mitsuba/core/struct.h>
+#include <nanothread/nanothread.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+MI_VARIANT WaveletDenoiser<Float, Spectrum>::WaveletDenoiser(
+    const ScalarVector2u &input_size, bool albedo, bool normals,
+    uint32_t iterations, float color_sigma)
+    : m_input_size(input_size), m_albedo(albedo), m_normals(normals),
+      m_iterations(iterations), m_color_sigma(color_sigma) {
+    if (normals && !albedo)
+        Throw("The denoiser cannot use normals to guide its process without "
+              "also providing albedo information!");
+    if (iterations == 0 || iterations > 16)
+        Throw("The number of iterations must be between 1 and 16!");
+    if (!(color_sigma > 0.f))
+        Throw("The color tolerance must be positive!");
+}
+
+MI_VARIANT
+typename WaveletDenoiser<Float, Spectrum>::TensorXf
+WaveletDenoiser<Float, Spectrum>::operator()(const TensorXf &noisy,
+                                             bool denoise_alpha,
+                                             const TensorXf &albedo,
+                                             const TensorXf &normals) const {
+    if ((albedo.ndim() == 0) && m_albedo)
+        Throw("The denoiser was created with albedo guiding enabled. An albedo "
+              "layer must be specified!");
+    if ((normals.ndim() == 0) && m_normals)
+        Throw("The denoiser was created with normals guiding enabled. A normal "
+              "layer must be specified!");
+
+    auto check_shape = [&](const TensorXf &tensor, size_t channels,
+                           const char *name) {
+        if (tensor.ndim() != 3 || tensor.shape(1) != m_input_size.x() ||
+            tensor.shape(0) != m_input_size.y())
+            Throw("The denoiser was created for inputs of size %u x %u (width "
+                  "x height). The %s argument does not have this size!",
+                  m_input_size.x(), m_input_size.y(), name);
+        if (channels != 0 && tensor.shape(2) != channels)
+            Throw("The %s argument must have exactly %zu channels!", name,
+                  channels);
+    };
+    check_shape(noisy, 0, "noisy");
+    if (noisy.shape(2) != 3 && noisy.shape(2) != 4)
+        Throw("The noisy input must have at least 3 channels and at most 4!");
+    if (m_albedo)
+        check_shape(albedo, 3, "albedo");
+    if (m_normals)
+        check_shape(normals, 3, "normals");
+
+    // The filter runs on the host
+    using TensorArray = typename TensorXf::Array;
+    auto &&noisy_host = dr::migrate(noisy.array(), AllocType::Host);
+    TensorArray albedo_host, normals_host;
+    if (m_albedo)
+        albedo_host = dr::migrate(albedo.array(), AllocType::Host);
+    if (m_normals)
+        normals_host = dr::migrate(normals.array(), AllocType::Host);
+    if constexpr (dr::is_jit_v<Float>)
+        dr::sync_thread();
+
+    std::vector<ScalarFloat> output(noisy.size());
+    denoise(noisy_host.data(), (uint32_t) noisy.shape(2), denoise_alpha,
+            m_albedo ? albedo_host.data() : nullptr,
+            m_normals ? normals_host.data() : nullptr, output.data());
+
+    size_t shape[3] = { noisy.shape(0), noisy.shape(1), noisy.shape(2) };
+    return TensorXf(dr::load<TensorArray>(output.data(), output.size()), 3,
+                    shape);
+}
+
+MI_VARIANT
+ref<Bitmap> WaveletDenoiser<Float, Spectrum>::operator()(
+    const ref<Bitmap> &noisy, bool denoise_alpha, const std::string &albedo_ch,
+    const std::string &normals_ch, const std::string &noisy_ch) const {
+    constexpr Struct::Type type = struct_type_v<ScalarFloat>;
+
+    ref<const Bitmap> noisy_bmp, albedo_bmp, normals_bmp;
+    if (noisy->pixel_format() != Bitmap::PixelFormat::MultiChannel) {
+        noisy_bmp = noisy;
+    } else {
+        for (auto &[name, layer] : noisy->split()) {
+            if (!noisy_bmp && name == noisy_ch)
+                noisy_bmp = layer;
+            if (!albedo_bmp && !albedo_ch.empty() && name == albedo_ch)
+                albedo_bmp = layer;
+            if (!normals_bmp && !normals_ch.empty() && name == normals_ch)
+                normals_bmp = layer;
+        }
+
+        auto check_channel = [&](const ref<const Bitmap> &bmp,
+                                 const std::string &channel) {
+            if (!channel.empty() && !bmp)
+                Throw("Could not find layer with channel name '%s' in "
+                      "Bitmap:\n%s", channel, noisy->to_string());
+        };
+        check_channel(noisy_bmp, noisy_ch);
+        check_channel(albedo_bmp, albedo_ch);
+        check_channel(normals_bmp, normals_ch);
+    }
+
+    if (m_albedo && !albedo_bmp)
+        Throw("The denoiser was created with albedo guiding enabled. An albedo "
+              "channel must be specified!");
+    if (m_normals && !normals_bmp)
+        Throw("The denoiser was created with normals guiding enabled. A normal "
+              "channel must be specified!");
+
+    auto prepare = [&](const ref<const Bitmap> &bmp, size_t channels,
+                       const char *name) -> ref<const Bitmap> {
+        if (bmp->width() != m_input_size.x() ||
+            bmp->height() != m_input_size.y())
+            Throw("The denoiser was created for inputs of size %u x %u (width "
+                  "x height). The %s layer does not have this size!",
+                  m_input_size.x(), m_input_size.y(), name);
+        if (channels != 0 && bmp->channel_count() != channels)
+            Throw("The %s layer must have exactly %zu channels!", name,
+                  channels);
+        if (bmp->component_format() == type)
+            return bmp;
+        return bmp->convert(bmp->pixel_format(), type, false);
+    };
+
+    noisy_bmp = prepare(noisy_bmp, 0, "noisy");
+    size_t channels = noisy_bmp->channel_count();
+    if (channels != 3 && channels != 4)
+        Throw("The noisy input must have at least 3 channels and at most 4!");
+    if (m_albedo)
+        albedo_bmp = prepare(albedo_bmp, 3, "albedo");
+    if (m_normals)
+        normals_bmp = prepare(normals_bmp, 3, "normals");
+
+    ref<Bitmap> output = new Bitmap(noisy_bmp->pixel_format(), type,
+                                    noisy_bmp->size(), channels, {});
+    denoise((const ScalarFloat *) noisy_bmp->data(), (uint32_t) channels,
+            denoise_alpha,
+            m_albedo ? (const ScalarFloat *) albedo_bmp->data() : nullptr,
+            m_normals ? (const ScalarFloat *) normals_bmp->data() : nullptr,
+            (ScalarFloat *) output->data());
+    return output;
+}
+
+MI_VARIANT void WaveletDenoiser<Float, Spectrum>::denoise(
+    const ScalarFloat *noisy, uint32_t channels, bool denoise_alpha,
+    const ScalarFloat *albedo, const ScalarFloat *normals,
+    ScalarFloat *output) const {
+    const int width = (int) m_input_size.x(), height = (int) m_input_size.y();
+    const size_t pixels = (size_t) width * height;
+
+    // B3-spline kernel of the à-trous transform
+    const ScalarFloat kernel[5] = { 1.f / 16.f, 1.f / 4.f, 3.f / 8.f,
+                                    1.f / 4.f, 1.f / 16.f };
+    // Tolerance to albedo differences and sharpness of the normal weights
+    const ScalarFloat albedo_sigma = .1f, normal_exponent = 128.f;
+
+    /* Divide by the albedo such that the filter doesn't blur textures (its
+       channels which are almost black are left untouched) */
+    std::vector<ScalarFloat> modulation(3 * pixels, 1.f);
+    if (albedo) {
+        for (size_t i = 0; i < 3 * pixels; ++i) {
+            if (albedo[i] > 1e-3f)
+                modulation[i] = albedo[i];
+        }
+    }
+
+    std::vector<ScalarFloat> current(channels * pixels), next(channels * pixels);
+    for (size_t p = 0; p < pixels; ++p) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            ScalarFloat value = noisy[p * channels + c];
+            current[p * channels + c] =
+                c < 3 ? value / modulation[3 * p + c] : value;
+        }
+    }
+
+    // Unit normals (zero where no surface was hit)
+    std::vector<ScalarFloat> unit_normals;
+    if (normals) {
+        unit_normals.assign(normals, normals + 3 * pixels);
+        for (size_t p = 0; p < pixels; ++p) {
+            ScalarVector3f n(unit_normals[3 * p], unit_normals[3 * p + 1],
+                             unit_normals[3 * p + 2]);
+            ScalarFloat length = dr::norm(n);
+            for (uint32_t c = 0; c < 3; ++c)
+                unit_normals[3 * p + c] =
+                    length > 0.f ? unit_normals[3 * p + c] / length : 0.f;
+        }
+    }
+
+    auto tonemap = [](ScalarFloat value) {
+        value = dr::maximum(value, ScalarFloat(0));
+        return value / (1.f + value);
+    };
+
+    for (uint32_t it = 0; it < m_iterations; ++it) {
+        const int step = 1 << it;
+        const ScalarFloat sigma = m_color_sigma / (ScalarFloat) step,
+                          inv_color_var = 1.f / (sigma * sigma),
+                          inv_albedo_var = 1.f / (albedo_sigma * albedo_sigma);
+
+        dr::parallel_for(
+            dr::blocked_range<int>(0, height, 4),
+            [&](const dr::blocked_range<int> &range) {
+                for (int y = range.begin(); y != range.end(); ++y) {
+                    for (int x = 0; x < width; ++x) {
+                        size_t p = (size_t) y * width + x;
+                        const ScalarFloat *cp = &current[p * channels];
+
+                        ScalarFloat sum[4] = { 0.f, 0.f, 0.f, 0.f },
+                                    weight_sum = 0.f;
+                        for (int j = -2; j <= 2; ++j) {
+                            int yq = y + j * step;
+                            if (yq < 0 || yq >= height)
+                                continue;
+                            for (int i = -2; i <= 2; ++i) {
+                                int xq = x + i * step;
+                                if (xq < 0 || xq >= width)
+                                    continue;
+                                size_t q = (size_t) yq * width + xq;
+                                const ScalarFloat *cq = &current[q * channels];
+
+                                ScalarFloat dist = 0.f;
+                                for (uint32_t c = 0; c < 3; ++c)
+                                    dist += dr::sqr(tonemap(cq[c]) - tonemap(cp[c]));
+                                ScalarFloat weight = kernel[i + 2] * kernel[j + 2] *
+                                                     dr::exp(-dist * inv_color_var);
+
+                                if (albedo) {
+                                    ScalarFloat dist_albedo = 0.f;
+                                    for (uint32_t c = 0; c < 3; ++c)
+                                        dist_albedo += dr::sqr(albedo[3 * q + c] -
+                                                               albedo[3 * p + c]);
+                                    weight *= dr::exp(-dist_albedo * inv_albedo_var);
+                                }
+
+                                if (normals) {
+                                    const ScalarFloat *np = &unit_normals[3 * p],
+                                                      *nq = &unit_normals[3 * q];
+                                    ScalarFloat lp = np[0] * np[0] + np[1] * np[1] + np[2] * np[2],
+                                                lq = nq[0] * nq[0] + nq[1] * nq[1] + nq[2] * nq[2];
+                                    if (lp > 0.f && lq > 0.f) {
+                                        ScalarFloat cos_theta =
+                                            np[0] * nq[0] + np[1] * nq[1] + np[2] * nq[2];
+                                        weight *= dr::pow(dr::maximum(cos_theta, ScalarFloat(0)),
+                                                          normal_exponent);
+                                    } else if (lp > 0.f || lq > 0.f) {
+                                        // Don't mix surfaces and the background
+                                        weight = 0.f;
+                                    }
+                                }
+
+                                for (uint32_t c = 0; c < channels; ++c)
+                                    sum[c] += weight * cq[c];
+                                weight_sum += weight;
+                            }
+                        }
+
+                        // The weight of the center tap is always positive
+                        ScalarFloat *out = &next[p * channels];
+                        for (uint32_t c = 0; c < channels; ++c)
+                            out[c] = sum[c] / weight_sum;
+                        if (channels == 4 && !denoise_alpha)
+                            out[3] = cp[3];
+                    }
+                }
+            }
+        );
+
+        std::swap(current, next);
+    }
+
+    for (size_t p = 0; p < pixels; ++p) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            ScalarFloat value = current[p * channels + c];
+            output[p * channels + c] =
+                c < 3 ? value * modulation[3 * p + c] : value;
+        }
+    }
+}
+
+MI_VARIANT
+std::string WaveletDenoiser<Float, Spectrum>::to_string() const {
+    std::ostringstream oss;
+    oss << "WaveletDenoiser[" << std::endl
+        << "  input_size = " << m_input_size << "," << std::endl
+        << "  albedo = " << m_albedo << "," << std::endl
+        << "  normals = " << m_normals << "," << std::endl
+        << "  iterations = " << m_iterations << "," << std::endl
+        << "  color_sigma = " << m_color_sigma << std::endl
+        << "]";
+    return oss.str();
+}
+
+MI_IMPLEMENT_CLASS_VARIANT(WaveletDenoiser, Object, "denoiser")
+MI_INSTANTIATE_CLASS(WaveletDenoiser)
+
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,294 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/qmc.h>
+#include <mitsuba/render/sampler.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sampler-halton:
+
+Halton sampler (:monosp:`halton`)
+---------------------------------
+
+.. pluginparameters::
+
+ * - sample_count
+   - |int|
+   - Number of samples per pixel. (Default: 4)
+
+ * - seed
+   - |int|
+   - Seed offset (Default: 0)
+
+ * - scramble
+   - |int|
+   - Selects the digit permutations that are applied to the radical inverse:
+     :monosp:`-1` uses the Faure permutations, :monosp:`0` disables them,
+     and any other value builds pseudorandom permutations seeded by it.
+     Ignored when :monosp:`owen` is enabled. (Default: -1)
+
+ * - owen
+   - |bool|
+   - Randomize the sequence of every pixel with a nested scramble of its
+     digits instead of a random shift. (Default: |false|)
+
+This plugin generates samples from the Halton sequence, whose :math:`k`-th
+dimension is the radical inverse of the sample index in the :math:`k`-th prime
+base. The first 256 prime bases are used; higher dimensions wrap around and
+are decorrelated by their randomization.
+
+The radical inverse is evaluated with lookup tables: every table lookup
+reverses a block of several digits (e.g. 12 digits in base 2 or 7 digits in
+base 3), optionally permuted by the Faure or random permutations that
+improve the quality of higher dimensions. Evaluating a dimension thus takes a
+small, fixed number of lookups, which vectorizes well. The sequence of every
+pixel is randomized by a per-pixel and per-dimension Cranley-Patterson
+rotation.
+
+When :monosp:`owen` is enabled, every digit is instead shifted by a random
+offset derived from a hash of the pixel, the dimension, and all more
+significant digits. This nested scrambling retains the stratification of the
+sequence in the elementary intervals of every base and generally reduces
+variance further, but has to process the digits one at a time.
+
+Like the :ref:`sobol <sampler-sobol>` sampler, this sampler generates a
+sequence: samples taken by subsequent passes continue the sequence of the
+previous passes.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: halton-sampler
+
+        <sampler type="halton">
+            <integer name="sample_count" value="64"/>
+        </sampler>
+
+    .. code-tab:: python
+
+        'type': 'halton',
+        'sample_count': '64'
+
+ */
+
+template <typename Float, typename Spectrum>
+class HaltonSampler final : public Sampler<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Sampler, m_sample_count, m_base_seed, seeded,
+                   m_samples_per_wavefront, m_dimension_index,
+                   current_sample_index, compute_per_sequence_seed)
+    MI_IMPORT_TYPES()
+
+    /// Number of prime bases, the largest one is 1619
+    static constexpr uint32_t BaseCount = 256;
+
+    HaltonSampler(const Properties &props) : Base(props) {
+        m_scramble = props.get<int>("scramble", -1);
+        m_owen = props.get<bool>("owen", false);
+
+        ref<RadicalInverse> inv =
+            new RadicalInverse(1619, m_scramble == 0 ? -1 : m_scramble);
+        Assert(inv->bases() == BaseCount);
+        bool scrambled = m_scramble != 0;
+
+        /* Per base: table offset, block size, block division multiplier and
+           shift. A block spans several digits when a table is available. */
+        std::vector<uint32_t> params, table;
+        std::vector<ScalarFloat> recips;
+        m_iterations = 0;
+
+        for (uint32_t i = 0; i < BaseCount; ++i) {
+            uint32_t base = (uint32_t) inv->base(i);
+            const uint16_t *digits =
+                m_owen ? nullptr : inv->digit_table(i, scrambled);
+
+            uint32_t size = base;
+            if (digits) {
+                for (size_t j = 1; j < inv->digits_per_lookup(i); ++j)
+                    size *= base;
+            }
+
+            // Division by 'size' via multiplication (Granlund and Montgomery)
+            uint32_t log2 = 0;
+            while ((1ull << log2) < size)
+                log2++;
+            uint32_t multiplier = (uint32_t) (
+                ((1ull << 32) * ((1ull << log2) - size)) / size + 1);
+
+            params.insert(params.end(),
+                          { (uint32_t) table.size(), size, multiplier, log2 - 1 });
+            recips.push_back(ScalarFloat(1) / ScalarFloat(size));
+
+            if (!m_owen) {
+                const uint16_t *perm = inv->permutation(i);
+                for (uint32_t j = 0; j < size; ++j)
+                    table.push_back(digits ? digits[j] : (scrambled ? perm[j] : j));
+            }
+
+            // Number of blocks of a 32 bit sample index
+            uint32_t iterations = 0;
+            for (uint64_t range = 1; range < (1ull << 32); range *= size)
+                iterations++;
+            m_iterations = std::max(m_iterations, iterations);
+        }
+
+        m_params = dr::load<DynamicBuffer<UInt32>>(params.data(), params.size());
+        m_recips = dr::load<DynamicBuffer<Float>>(recips.data(), recips.size());
+        if (!m_owen)
+            m_table = dr::load<DynamicBuffer<UInt32>>(table.data(), table.size());
+    }
+
+    ref<Sampler<Float, Spectrum>> fork() override {
+        // Shares the precomputed tables, the fork must be seeded before use
+        return new HaltonSampler(*this);
+    }
+
+    ref<Sampler<Float, Spectrum>> clone() override {
+        return new HaltonSampler(*this);
+    }
+
+    void seed(uint32_t seed, uint32_t wavefront_size) override {
+        Base::seed(seed, wavefront_size);
+        m_scramble_seed = compute_per_sequence_seed(seed);
+        m_sample_offset = 0;
+    }
+
+    void seed_pass(uint32_t seed, uint32_t sequence_seed,
+                   uint32_t sample_offset) override {
+        Base::seed(seed, (uint32_t) -1);
+        m_scramble_seed = compute_per_sequence_seed(sequence_seed);
+        m_sample_offset = sample_offset;
+    }
+
+    Float next_1d(Mask /*active*/ = true) override {
+        Assert(seeded());
+        return radical_inverse(m_dimension_index++);
+    }
+
+    Point2f next_2d(Mask /*active*/ = true) override {
+        Assert(seeded());
+        Float x = radical_inverse(m_dimension_index++);
+        Float y = radical_inverse(m_dimension_index++);
+        return Point2f(x, y);
+    }
+
+    void schedule_state() override {
+        Base::schedule_state();
+        dr::schedule(m_scramble_seed);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "HaltonSampler[" << std::endl
+            << "  sample_count = " << m_sample_count << "," << std::endl
+            << "  scramble = " << m_scramble << "," << std::endl
+            << "  owen = " << m_owen << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+private:
+    HaltonSampler(const HaltonSampler &sampler) : Base(sampler) {
+        m_scramble      = sampler.m_scramble;
+        m_owen          = sampler.m_owen;
+        m_iterations    = sampler.m_iterations;
+        m_params        = sampler.m_params;
+        m_recips        = sampler.m_recips;
+        m_table         = sampler.m_table;
+        m_scramble_seed = sampler.m_scramble_seed;
+        m_sample_offset = sampler.m_sample_offset;
+    }
+
+    /// Evaluate the randomized radical inverse of the current sample index
+    Float radical_inverse(const UInt32 &dimension) const {
+        UInt32 base_index = dimension & (BaseCount - 1),
+               seed = sample_tea_32(m_scramble_seed, dimension).first,
+               index = current_sample_index() + m_sample_offset;
+
+        Vector4u params = dr::gather<Vector4u>(m_params, base_index);
+        UInt32 offset = params.x(), size = params.y(),
+               multiplier = params.z(), shift = params.w();
+        Float recip = dr::gather<Float>(m_recips, base_index);
+
+        Float result = 0.f, factor = 1.f;
+        UInt32 prefix = 0;
+
+        /* Blocks past the most significant digit of the index are zero and
+           map to the (permuted) zero digit, which is the correct tail */
+        for (uint32_t i = 0; i < m_iterations; ++i) {
+            UInt32 q = dr::mulhi(index, multiplier),
+                   next = (q + dr::sr<1>(index - q)) >> shift,
+                   block = index - next * size;
+
+            factor *= recip;
+
+            if (m_owen) {
+                // Random shift seeded by all more significant digits
+                UInt32 shift_value = dr::mulhi(hash(prefix ^ seed), size);
+                prefix = prefix * (size + 1u) + block + 1u;
+                block += shift_value;
+                block = dr::select(block >= size, block - size, block);
+            } else {
+                block = dr::gather<UInt32>(m_table, offset + block);
+            }
+
+            result = dr::fmadd(Float(block), factor, result);
+            index = next;
+        }
+
+        if (!m_owen) {
+            // Cranley-Patterson rotation
+            result += to_float(hash(seed));
+            result = dr::select(result >= 1.f, result - 1.f, result);
+        }
+
+        return dr::minimum(result, dr::OneMinusEpsilon<Float>);
+    }
+
+    /// Integer hash function of Wellons ("lowbias32")
+    static UInt32 hash(UInt32 x) {
+        x ^= dr::sr<16>(x);
+        x *= 0x7feb352du;
+        x ^= dr::sr<15>(x);
+        x *= 0x846ca68bu;
+        x ^= dr::sr<16>(x);
+        return x;
+    }
+
+    /// Map a 32 bit fixed point number to a floating point value in [0, 1)
+    static Float to_float(const UInt32 &value) {
+        if constexpr (std::is_same_v<ScalarFloat, double>)
+            return Float(value) * 0x1p-32;
+        else
+            return dr::reinterpret_array<Float>(dr::sr<9>(value) | 0x3f800000u) - 1.f;
+    }
+
+    int m_scramble;
+    bool m_owen;
+
+    /// Number of table lookups (or digits) per radical inverse
+    uint32_t m_iterations;
+
+    /// Per base: table offset, block size, division multiplier and shift
+    DynamicBuffer<UInt32> m_params;
+
+    /// Per base: reciprocal of the block size
+    DynamicBuffer<Float> m_recips;
+
+    /// Concatenated tables of (permuted) reversed digit blocks
+    DynamicBuffer<UInt32> m_table;
+
+    /// Per-sequence scramble seed
+    UInt32 m_scramble_seed;
+
+    /// Number of samples per sequence taken by previous passes
+    uint32_t m_sample_offset = 0;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(HaltonSampler, Sampler)
+MI_EXPORT_PLUGIN(HaltonSampler, "Halton Sampler");
+NAMESPACE_END(mitsuba)
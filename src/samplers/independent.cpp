@@ -1,5 +1,6 @@
 #include <mitsuba/core/profiler.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/render/sampler.h>
 
@@ -22,6 +23,11 @@ Independent sampler (:monosp:`independent`)
    - |int|
    - Seed offset (Default: 0)
 
+ * - rng
+   - |string|
+   - Random number generator, either :monosp:`pcg32` or :monosp:`counter` (see below).
+     (Default: :monosp:`pcg32`)
+
 The independent sampler produces a stream of independent and uniformly
 distributed pseudorandom numbers. Internally, it relies on the
 `PCG32 random number generator <https://www.pcg-random.org/>`_
@@ -34,6 +40,13 @@ are both regions that don't receive many samples (i.e. we don't know much about
 the function there), and regions where many samples are very close together (which likely have very
 similar values), which will result in higher variance in the rendered image.
 
+With :monosp:`rng=counter`, the sampler has no per-lane state: every value is a hash
+(using the Tiny Encryption Algorithm) of the seed, the index of the wavefront lane, the
+sample index and the dimension. Only the sample and dimension indices, which are the
+same for all lanes, are carried through the symbolic loops of the JIT variants instead
+of the 64 bits of PCG32 state per lane, which considerably reduces the memory traffic
+of very large wavefronts. The generated numbers differ from the :monosp:`pcg32` sequence.
+
 This sampler is initialized using a deterministic procedure, which means that subsequent runs
 of Mitsuba should create the same image. In practice, when rendering with multiple threads
 and/or machines, this is not true anymore, since the ordering of samples is influenced by the
@@ -67,17 +80,29 @@ on the order of the machine epsilon (:math:`6\cdot 10^{-8}`) in single precision
 template <typename Float, typename Spectrum>
 class IndependentSampler final : public PCG32Sampler<Float, Spectrum> {
 public:
-    MI_IMPORT_BASE(PCG32Sampler, m_sample_count, m_base_seed, m_rng, seed,
-                   seeded, m_samples_per_wavefront, m_wavefront_size,
-                   schedule_state)
+    MI_IMPORT_BASE(PCG32Sampler, m_sample_count, m_base_seed, m_rng, seeded,
+                   m_samples_per_wavefront, m_wavefront_size, m_dimension_index,
+                   current_sample_index)
     MI_IMPORT_TYPES()
 
-    IndependentSampler(const Properties &props) : Base(props) { }
+    using SamplerBase = Sampler<Float, Spectrum>;
+
+    IndependentSampler(const Properties &props) : Base(props) {
+        std::string rng = props.string("rng", "pcg32");
+        if (rng == "pcg32")
+            m_counter = false;
+        else if (rng == "counter")
+            m_counter = true;
+        else
+            Throw("Invalid random number generator \"%s\", must be one of: "
+                  "\"pcg32\" or \"counter\"!", rng);
+    }
 
     ref<Sampler<Float, Spectrum>> fork() override {
         IndependentSampler *sampler = new IndependentSampler(Properties());
         sampler->m_sample_count = m_sample_count;
         sampler->m_base_seed = m_base_seed;
+        sampler->m_counter = m_counter;
         return sampler;
     }
 
@@ -85,9 +110,44 @@ public:
         return new IndependentSampler(*this);
     }
 
+    void seed(uint32_t seed, uint32_t wavefront_size = (uint32_t) -1) override {
+        if (!m_counter) {
+            Base::seed(seed, wavefront_size);
+            return;
+        }
+
+        // Skip the initialization of the PCG32 state
+        SamplerBase::seed(seed, wavefront_size);
+        m_seed_value = dr::opaque<UInt32>(m_base_seed + seed);
+    }
+
+    void schedule_state() override {
+        if (m_counter)
+            SamplerBase::schedule_state();
+        else
+            Base::schedule_state();
+    }
+
+    void loop_put(dr::Loop<Mask> &loop) override {
+        if (m_counter)
+            SamplerBase::loop_put(loop);
+        else
+            Base::loop_put(loop);
+    }
+
     Float next_1d(Mask active = true) override {
         Assert(seeded());
-        return m_rng.template next_float<Float>(active);
+        if (!m_counter)
+            return m_rng.template next_float<Float>(active);
+
+        /* Derive the key of the current sample of every lane on demand, such
+           that no per-lane state needs to be stored */
+        UInt32 lane = 0;
+        if constexpr (dr::is_array_v<Float>)
+            lane = dr::arange<UInt32>(m_wavefront_size);
+        UInt32 key = sample_tea_32(m_seed_value, lane).first;
+        key = sample_tea_32(key, current_sample_index()).first;
+        return Float(sample_tea_float32(key, m_dimension_index++));
     }
 
     Point2f next_2d(Mask active = true) override {
@@ -102,7 +162,8 @@ public:
             << "  base_seed = " << m_base_seed << std::endl
             << "  sample_count = " << m_sample_count << std::endl
             << "  samples_per_wavefront = " << m_samples_per_wavefront << std::endl
-            << "  wavefront_size = " << m_wavefront_size << std::endl
+            << "  wavefront_size = " << m_wavefront_size << "," << std::endl
+            << "  rng = " << (m_counter ? "counter" : "pcg32") << std::endl
             << "]";
         return oss.str();
     }
@@ -110,7 +171,15 @@ public:
     MI_DECLARE_CLASS()
 
 private:
-    IndependentSampler(const IndependentSampler &sampler) : Base(sampler) {}
+    IndependentSampler(const IndependentSampler &sampler)
+        : Base(sampler), m_counter(sampler.m_counter),
+          m_seed_value(sampler.m_seed_value) { }
+
+private:
+    /// Use the stateless counter-based generator instead of PCG32?
+    bool m_counter = false;
+    /// Seed of the counter-based generator
+    UInt32 m_seed_value;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(IndependentSampler, Sampler)
@@ -0,0 +1,162 @@
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/qmc.h>
+#include <mitsuba/render/sampler.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sampler-sobol:
+
+Owen-scrambled Sobol' sampler (:monosp:`sobol`)
+-----------------------------------------------
+
+.. pluginparameters::
+
+ * - sample_count
+   - |int|
+   - Number of samples per pixel. Powers of two give the best stratification. (Default: 4)
+
+ * - seed
+   - |int|
+   - Seed offset (Default: 0)
+
+This plugin generates every sample dimension from the first two dimensions of
+the Sobol' sequence, which form a (0, 2)-sequence in base 2. Following Burley
+(*Practical Hash-based Owen Scrambling*, JCGT 2020), the sample index of every
+1D or 2D request is shuffled and the resulting coordinates are Owen-scrambled
+with hash functions seeded per pixel and per dimension. This decorrelates the
+dimensions while retaining the stratification of the sequence in all 1D and 2D
+projections.
+
+Unlike the :ref:`ldsampler <sampler-ldsampler>`, this sampler generates a
+*sequence* rather than a fixed point set: the first :math:`2^k` samples of a
+pixel are stratified for every :math:`k`. When the integrator splits the
+samples of a pixel into several passes (e.g. progressive, adaptive or
+time-budgeted rendering), every pass continues the sequence of the previous
+passes instead of starting a new point set, so the complete set of samples
+retains its stratification. The sample count therefore does not need to be
+fixed upfront.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: sobol-sampler
+
+        <sampler type="sobol">
+            <integer name="sample_count" value="64"/>
+        </sampler>
+
+    .. code-tab:: python
+
+        'type': 'sobol',
+        'sample_count': '64'
+
+ */
+
+template <typename Float, typename Spectrum>
+class SobolSampler final : public Sampler<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Sampler, m_sample_count, m_base_seed, seeded,
+                   m_samples_per_wavefront, m_dimension_index,
+                   current_sample_index, compute_per_sequence_seed)
+    MI_IMPORT_TYPES()
+
+    SobolSampler(const Properties &props) : Base(props) { }
+
+    ref<Sampler<Float, Spectrum>> fork() override {
+        SobolSampler *sampler            = new SobolSampler(Properties());
+        sampler->m_sample_count          = m_sample_count;
+        sampler->m_samples_per_wavefront = m_samples_per_wavefront;
+        sampler->m_base_seed             = m_base_seed;
+        return sampler;
+    }
+
+    ref<Sampler<Float, Spectrum>> clone() override {
+        return new SobolSampler(*this);
+    }
+
+    void seed(uint32_t seed, uint32_t wavefront_size) override {
+        Base::seed(seed, wavefront_size);
+        m_scramble_seed = compute_per_sequence_seed(seed);
+        m_sample_offset = 0;
+    }
+
+    void seed_pass(uint32_t seed, uint32_t sequence_seed,
+                   uint32_t sample_offset) override {
+        Base::seed(seed, (uint32_t) -1);
+        m_scramble_seed = compute_per_sequence_seed(sequence_seed);
+        m_sample_offset = sample_offset;
+    }
+
+    Float next_1d(Mask /*active*/ = true) override {
+        Assert(seeded());
+
+        auto [index, seed] = shuffled_index();
+        return to_float(owen_scramble(reverse_bits_32(index), seed));
+    }
+
+    Point2f next_2d(Mask /*active*/ = true) override {
+        Assert(seeded());
+
+        auto [index, seed_x] = shuffled_index();
+
+        // Derive an independent scramble for the second axis
+        UInt32 seed_y = owen_scramble(seed_x, UInt32(0x98bc51abu));
+
+        return Point2f(to_float(owen_scramble(reverse_bits_32(index), seed_x)),
+                       to_float(owen_scramble(sobol_matrix_2(index), seed_y)));
+    }
+
+    void schedule_state() override {
+        Base::schedule_state();
+        dr::schedule(m_scramble_seed);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "SobolSampler[" << std::endl
+            << "  sample_count = " << m_sample_count << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+private:
+    SobolSampler(const SobolSampler &sampler) : Base(sampler) {
+        m_scramble_seed = sampler.m_scramble_seed;
+        m_sample_offset = sampler.m_sample_offset;
+    }
+
+    /**
+     * Return the Owen-scrambled sample index of the current dimension, along
+     * with a seed for scrambling its coordinates
+     */
+    std::pair<UInt32, UInt32> shuffled_index() {
+        auto [seed_index, seed_value] =
+            sample_tea_32(m_scramble_seed, m_dimension_index++);
+
+        UInt32 index = current_sample_index() + m_sample_offset;
+        return { owen_scramble(index, seed_index), seed_value };
+    }
+
+    /// Map a 32 bit fixed point number to a floating point value in [0, 1)
+    static Float to_float(const UInt32 &value) {
+        if constexpr (std::is_same_v<ScalarFloat, double>)
+            return Float(value) * 0x1p-32;
+        else
+            return dr::reinterpret_array<Float>(dr::sr<9>(value) | 0x3f800000u) - 1.f;
+    }
+
+    /// Per-sequence scramble seed
+    UInt32 m_scramble_seed;
+
+    /// Number of samples per sequence taken by previous passes
+    uint32_t m_sample_offset = 0;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SobolSampler, Sampler)
+MI_EXPORT_PLUGIN(SobolSampler, "Owen-scrambled Sobol' Sampler");
+NAMESPACE_END(mitsuba)
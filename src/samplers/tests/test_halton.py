@@ -0,0 +1,129 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from .utils import ( check_uniform_scalar_sampler, check_uniform_wavefront_sampler,
+                     check_deep_copy_sampler_scalar, check_deep_copy_sampler_wavefront )
+
+@pytest.mark.parametrize('owen', [False, True])
+def test01_halton_scalar(variant_scalar_rgb, owen):
+    sampler = mi.load_dict({
+        "type" : "halton",
+        "sample_count" : 1024,
+        "owen" : owen
+    })
+    sampler.seed(0)
+
+    check_uniform_scalar_sampler(sampler, res=8, atol=6)
+
+
+@pytest.mark.parametrize('owen', [False, True])
+def test02_halton_wavefront(variants_vec_backends_once, owen):
+    sampler = mi.load_dict({
+        "type" : "halton",
+        "sample_count" : 1024,
+        "owen" : owen
+    })
+    sampler.seed(0, 1024)
+
+    check_uniform_wavefront_sampler(sampler, res=8, atol=6)
+
+
+@pytest.mark.parametrize('scramble', [-1, 0, 5])
+def test03_halton_radical_inverse(variant_scalar_rgb, scramble):
+    sampler = mi.load_dict({
+        "type" : "halton",
+        "sample_count" : 64,
+        "scramble" : scramble
+    })
+    sampler.seed(0)
+
+    # Up to the per-dimension rotation, dimension k is the (permuted) radical
+    # inverse in the k-th prime base
+    inv = mi.RadicalInverse(1619, -1 if scramble == 0 else scramble)
+    values = []
+    for i in range(64):
+        values.append([sampler.next_1d() for _ in range(40)])
+        sampler.advance()
+
+    for k in range(40):
+        for i in range(64):
+            ref = inv.eval(k, i) if scramble == 0 else inv.eval_scrambled(k, i)
+            shift = (values[i][k] - values[0][k]) - \
+                    (ref - (inv.eval(k, 0) if scramble == 0 else inv.eval_scrambled(k, 0)))
+            assert dr.abs(shift - round(shift)) < 1e-5
+
+
+@pytest.mark.parametrize('owen', [False, True])
+def test04_halton_stratification(variant_scalar_rgb, owen):
+    sampler = mi.load_dict({
+        "type" : "halton",
+        "sample_count" : 243,
+        "owen" : owen
+    })
+    sampler.seed(3)
+
+    values = []
+    for i in range(243):
+        values.append(sampler.next_2d())
+        sampler.advance()
+
+    if owen:
+        # Every block of b^k samples is stratified in base b
+        for k in range(6):
+            assert len(set(int(v.y * 3 ** k) for v in values[:3 ** k])) == 3 ** k
+        for k in range(8):
+            assert len(set(int(v.x * 2 ** k) for v in values[:2 ** k])) == 2 ** k
+    else:
+        # The rotation shifts the strata, but preserves their occupancy
+        for k in range(6):
+            n = 3 ** k
+            counts = {}
+            for v in values[:n]:
+                cell = int(v.y * n)
+                counts[cell] = counts.get(cell, 0) + 1
+            assert max(counts.values()) <= 2
+
+
+def test05_halton_progressive(variant_scalar_rgb):
+    sampler = mi.load_dict({
+        "type" : "halton",
+        "sample_count" : 64,
+        "owen" : True
+    })
+
+    def generate(seed, sequence_seed, offset, count):
+        sampler.seed_pass(seed, sequence_seed, offset)
+        values = []
+        for i in range(count):
+            values.append((sampler.next_1d(), sampler.next_2d()))
+            sampler.advance()
+        return values
+
+    # Passes with distinct seeds continue the same sequence
+    ref = generate(0, 5, 0, 64)
+    passes = generate(1, 5, 0, 16) + generate(2, 5, 16, 16) + generate(3, 5, 32, 32)
+    for (a, b), (c, d) in zip(ref, passes):
+        assert a == c and dr.all(b == d)
+
+    assert len(set(int(a * 64) for a, _ in passes)) == 64
+
+
+def test06_copy_sampler_scalar(variants_any_scalar):
+    sampler = mi.load_dict({
+        "type" : "halton",
+        "sample_count" : 1024,
+    })
+    sampler.seed(0)
+
+    check_deep_copy_sampler_scalar(sampler)
+
+
+def test07_copy_sampler_wavefront(variants_vec_backends_once):
+    sampler = mi.load_dict({
+        "type" : "halton",
+        "sample_count" : 1024,
+    })
+    sampler.seed(0, 1024)
+
+    check_deep_copy_sampler_wavefront(sampler)
@@ -42,3 +42,48 @@ def test04_copy_sampler_wavefront(variants_vec_backends_once):
     })
 
     check_deep_copy_sampler_wavefront(sampler)
+
+
+def test05_counter_based(variants_vec_backends_once):
+    with pytest.raises(RuntimeError, match='random number generator'):
+        mi.load_dict({"type": "independent", "rng": "mt19937"})
+
+    sampler = mi.load_dict({
+        "type": "independent",
+        "sample_count": 16,
+        "rng": "counter"
+    })
+    assert 'rng = counter' in str(sampler)
+
+    def draw(sampler, seed):
+        sampler.seed(seed, 1024)
+        values = []
+        for _ in range(2):
+            values.append(sampler.next_1d())
+            values.append(sampler.next_2d().y)
+            sampler.advance()
+        return values
+
+    values = draw(sampler, 3)
+
+    # The numbers only depend on the seed, lane, sample and dimension
+    assert all(dr.all(a == b) for a, b in zip(values, draw(sampler, 3)))
+    assert all(dr.all(a == b) for a, b in zip(values, draw(sampler.fork(), 3)))
+    assert not dr.all(values[0] == draw(sampler, 4)[0])
+
+    # Lanes, dimensions and samples are uncorrelated and uniformly distributed
+    for v in values:
+        assert dr.all((v >= 0) & (v < 1))
+        assert dr.allclose(dr.mean(v), 0.5, atol=0.05)
+    assert dr.allclose(dr.mean(values[0] * values[1]), 0.25, atol=0.03)
+    assert dr.allclose(dr.mean(values[0] * values[2]), 0.25, atol=0.03)
+
+
+def test06_copy_counter_based(variants_vec_backends_once):
+    sampler = mi.load_dict({
+        "type": "independent",
+        "sample_count": 1024,
+        "rng": "counter"
+    })
+
+    check_deep_copy_sampler_wavefront(sampler)
@@ -0,0 +1,95 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from .utils import ( check_uniform_scalar_sampler, check_uniform_wavefront_sampler,
+                     check_deep_copy_sampler_scalar, check_deep_copy_sampler_wavefront )
+
+def test01_sobol_scalar(variant_scalar_rgb):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+    })
+    sampler.seed(0)
+
+    check_uniform_scalar_sampler(sampler)
+
+
+def test02_sobol_wavefront(variants_vec_backends_once):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+    })
+    sampler.seed(0, 1024)
+
+    check_uniform_wavefront_sampler(sampler)
+
+
+def test03_sobol_stratification(variant_scalar_rgb):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 256,
+    })
+    sampler.seed(3)
+
+    # Every dimension of the first 2^k samples is stratified for every k
+    values = [[] for _ in range(6)]
+    for i in range(256):
+        for d in range(3):
+            values[2 * d].append(sampler.next_1d())
+            v = sampler.next_2d()
+            values[2 * d + 1].append((v.x, v.y))
+        sampler.advance()
+
+    for k in [2, 4, 6, 8]:
+        n = 2 ** k
+        for d in range(3):
+            assert len(set(int(v * n) for v in values[2 * d][:n])) == n
+            # (0, 2)-sequence: elementary intervals of aspect 2^j x 2^(k-j)
+            for j in range(k + 1):
+                cells = set((int(x * 2 ** j), int(y * 2 ** (k - j)))
+                            for x, y in values[2 * d + 1][:n])
+                assert len(cells) == n
+
+
+def test04_sobol_progressive(variant_scalar_rgb):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 64,
+    })
+
+    def generate(seed, sequence_seed, offset, count):
+        sampler.seed_pass(seed, sequence_seed, offset)
+        values = []
+        for i in range(count):
+            values.append((sampler.next_1d(), sampler.next_2d()))
+            sampler.advance()
+        return values
+
+    # Passes with distinct seeds continue the same sequence
+    ref = generate(0, 5, 0, 64)
+    passes = generate(1, 5, 0, 16) + generate(2, 5, 16, 16) + generate(3, 5, 32, 32)
+    for (a, b), (c, d) in zip(ref, passes):
+        assert a == c and dr.all(b == d)
+
+    assert len(set(int(a * 64) for a, _ in passes)) == 64
+
+
+def test05_copy_sampler_scalar(variants_any_scalar):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+    })
+    sampler.seed(0)
+
+    check_deep_copy_sampler_scalar(sampler)
+
+
+def test06_copy_sampler_wavefront(variants_vec_backends_once):
+    sampler = mi.load_dict({
+        "type" : "sobol",
+        "sample_count" : 1024,
+    })
+    sampler.seed(0, 1024)
+
+    check_deep_copy_sampler_wavefront(sampler)
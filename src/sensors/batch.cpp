@@ -57,6 +57,9 @@ public:
             m_sensors[i]->film()->set_size(ScalarPoint2u(sub_size, size.y()));
             m_sensors[i]->parameters_changed();
         }
+
+        m_sensors_dr = dr::load<DynamicBuffer<SensorPtr>>(
+            m_sensors.data(), m_sensors.size());
     }
 
     std::pair<RayDifferential3f, Spectrum>
@@ -67,61 +70,37 @@ public:
 
         MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
 
-        UInt32 index = (UInt32) (position_sample.x() * (ScalarFloat) m_sensors.size());
-        RayDifferential3f result_1 = dr::zeros<RayDifferential3f>();
-        Spectrum result_2 = dr::zeros<Spectrum>();
+        ScalarFloat sensor_count = (ScalarFloat) m_sensors.size();
+        UInt32 index = dr::minimum((UInt32) (position_sample.x() * sensor_count),
+                                   (uint32_t) m_sensors.size() - 1);
+
+        Point2f position_sample_2(
+            dr::fmadd(position_sample.x(), sensor_count, -Float(index)),
+            position_sample.y()
+        );
 
-        for (size_t i = 0; i < m_sensors.size(); ++i) {
-            Mask active_i = active && dr::eq(index, i);
-            Point2f position_sample_2(
-                dr::fmadd(position_sample.x(), (ScalarFloat) m_sensors.size(), -(ScalarFloat) i),
-                position_sample.y()
-            );
-            auto [rv_1, rv_2] = m_sensors[i]->sample_ray_differential(
-                time, wavelength_sample, position_sample_2, aperture_sample,
-                active_i);
-            result_1[active_i] = rv_1;
-            result_2[active_i] = rv_2;
-        }
         m_last_index = index;
 
-        return { result_1, result_2 };
+        return sensor(index, active)->sample_ray_differential(
+            time, wavelength_sample, position_sample_2, aperture_sample,
+            active);
     }
 
     std::pair<DirectionSample3f, Spectrum>
     sample_direction(const Interaction3f &it, const Point2f &sample, Mask active) const override {
-        DirectionSample3f result_1 = dr::zeros<DirectionSample3f>();
-        Spectrum result_2 = dr::zeros<Spectrum>();
-
-        for (size_t i = 0; i < m_sensors.size(); ++i) {
-            Mask active_i = active && dr::eq(m_last_index, i);
-            auto [rv_1, rv_2] =
-                m_sensors[i]->sample_direction(it, sample, active_i);
-            rv_1.uv.x() += i * m_sensors[i]->film()->size().x();
-            result_1[active_i] = rv_1;
-            result_2[active_i] = rv_2;
-        }
-
-        return { result_1, result_2 };
+        auto [ds, weight] =
+            sensor(m_last_index, active)->sample_direction(it, sample, active);
+        ds.uv.x() += Float(m_last_index * m_sensors[0]->film()->size().x());
+        return { ds, weight };
     }
 
     Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
                         Mask active) const override {
-        Float result = dr::zeros<Float>();
-        for (size_t i = 0; i < m_sensors.size(); ++i) {
-            Mask active_i = active && dr::eq(m_last_index, i);
-            dr::masked(result, active_i) = m_sensors[i]->pdf_direction(it, ds, active_i);
-        }
-        return result;
+        return sensor(m_last_index, active)->pdf_direction(it, ds, active);
     }
 
     Spectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
-        Spectrum result = dr::zeros<Spectrum>();
-        for (size_t i = 0; i < m_sensors.size(); ++i) {
-            Mask active_i = active && dr::eq(m_last_index, i);
-            result[active_i] = m_sensors[i]->eval(si, active_i);
-        }
-        return result;
+        return sensor(m_last_index, active)->eval(si, active);
     }
 
     ScalarBoundingBox3f bbox() const override {
@@ -133,7 +112,22 @@ public:
 
     MI_DECLARE_CLASS()
 private:
+    /**
+     * Return the sub-sensor with the given index. JIT variants dispatch
+     * the subsequent method call indirectly, so that its cost does not
+     * depend on the number of sub-sensors.
+     */
+    SensorPtr sensor(const UInt32 &index, Mask active) const {
+        if constexpr (dr::is_jit_v<Float>)
+            return dr::gather<SensorPtr>(m_sensors_dr, index, active);
+        else {
+            DRJIT_MARK_USED(active);
+            return m_sensors[index].get();
+        }
+    }
+
     std::vector<ref<Base>> m_sensors;
+    DynamicBuffer<SensorPtr> m_sensors_dr;
     mutable UInt32 m_last_index;
 };
 
@@ -0,0 +1,338 @@
+#include <mitsuba/core/fwd.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/fwd.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/sensor.h>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _sensor-meterarray:
+
+Meter array (:monosp:`meterarray`)
+----------------------------------
+
+.. pluginparameters::
+
+ * - origins
+   - |string|
+   - Positions of the meters in world coordinates, given as a list of
+     :math:`3N` comma- or space-separated values (x, y, z of every meter).
+   - |exposed|
+
+ * - directions
+   - |string|
+   - Directions in which the meters are pointing in world coordinates, given
+     like :monosp:`origins`. For irradiance meters, this is the normal of the
+     measured surface. The directions are normalized.
+   - |exposed|
+
+ * - measure
+   - |string|
+   - Quantity recorded by the meters: :monosp:`radiance` (along a single
+     ray, like :ref:`radiancemeter <sensor-radiancemeter>`) or
+     :monosp:`irradiance` (over the hemisphere around the direction, like
+     :ref:`irradiancemeter <sensor-irradiancemeter>`).
+     (Default: :monosp:`radiance`, or :monosp:`irradiance` with a nested mesh)
+
+ * - (Nested plugin)
+   - |shape|
+   - Alternative to :monosp:`origins` and :monosp:`directions`: a mesh whose
+     faces are irradiance meters. Every face records the irradiance averaged
+     over its area. The mesh only defines the meters and is not part of the
+     scene geometry.
+
+ * - srf
+   - |spectrum|
+   - Sensor Response Function that defines the :ref:`spectral sensitivity <explanation_srf_sensor>`
+     of the sensor (Default: :monosp:`none`)
+
+This sensor plugin combines many radiance or irradiance meters into a single
+sensor, so that all of them are rendered in one pass. Meter :math:`i` is
+recorded by pixel :math:`i` of the film (in row-major order), whose number of
+pixels must therefore match the number of meters. A film of :math:`N \times 1`
+pixels with a :ref:`box <rfilter-box>` reconstruction filter is the typical
+choice.
+
+Compared to one :monosp:`radiancemeter` or :monosp:`irradiancemeter` per
+measurement, which needs a separate rendering pass (or a :ref:`batch
+<sensor-batch>` sensor that dispatches over all of them), the rays of all
+meters are generated by the same few arithmetic operations and gathers.
+
+.. tabs::
+    .. code-tab:: xml
+
+        <sensor type="meterarray">
+            <string name="origins" value="0 0 0, 1 0 0"/>
+            <string name="directions" value="0 0 1, 0 0 1"/>
+            <film type="hdrfilm">
+                <integer name="width" value="2"/>
+                <integer name="height" value="1"/>
+                <rfilter type="box"/>
+            </film>
+        </sensor>
+
+    .. code-tab:: python
+
+        'type': 'meterarray',
+        'origins': '0 0 0, 1 0 0',
+        'directions': '0 0 1, 0 0 1',
+        'film': {
+            'type': 'hdrfilm',
+            'width': 2,
+            'height': 1,
+            'rfilter': { 'type': 'box' }
+        }
+
+*/
+
+MI_VARIANT class MeterArray final : public Sensor<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Sensor, m_film, m_needs_sample_2, m_needs_sample_3,
+                   sample_wavelengths)
+    MI_IMPORT_TYPES(Mesh, Shape)
+    using FloatStorage = DynamicBuffer<Float>;
+
+    MeterArray(const Properties &props) : Base(props) {
+        if (props.has_property("to_world"))
+            Throw("Found a 'to_world' transformation -- this is not allowed. "
+                  "The meters are specified in world coordinates.");
+
+        for (auto &[name, obj] : props.objects(false)) {
+            Mesh *mesh = dynamic_cast<Mesh *>(obj.get());
+            if (mesh) {
+                if (m_mesh)
+                    Throw("Only a single mesh can be specified!");
+                m_mesh = mesh;
+                props.mark_queried(name);
+            } else if (dynamic_cast<Shape *>(obj.get())) {
+                Throw("The meters can only be defined by mesh shapes!");
+            }
+        }
+
+        std::string measure = props.string("measure", m_mesh ? "irradiance" : "radiance");
+        if (measure == "radiance")
+            m_irradiance = false;
+        else if (measure == "irradiance")
+            m_irradiance = true;
+        else
+            Throw("The \"measure\" parameter must either be equal to "
+                  "\"radiance\" or \"irradiance\". Found %s instead.", measure);
+
+        if (m_mesh) {
+            if (!m_irradiance)
+                Throw("The faces of a mesh can only be irradiance meters!");
+            if (props.has_property("origins") || props.has_property("directions"))
+                Throw("The meters must either be defined by a mesh or by "
+                      "'origins' and 'directions', not both!");
+            m_count = (uint32_t) m_mesh->face_count();
+        } else {
+            std::vector<ScalarFloat> origins    = parse_points(props, "origins"),
+                                     directions = parse_points(props, "directions");
+            if (origins.size() != directions.size())
+                Throw("'origins' and 'directions' must specify the same "
+                      "number of meters (%u vs. %u)!", origins.size() / 3,
+                      directions.size() / 3);
+
+            for (size_t i = 0; i < directions.size(); i += 3) {
+                ScalarVector3f d(directions[i], directions[i + 1], directions[i + 2]);
+                if (dr::all(dr::eq(d, 0.f)))
+                    Throw("The direction of meter %u is zero!", i / 3);
+                d = dr::normalize(d);
+                for (size_t k = 0; k < 3; ++k)
+                    directions[i + k] = d[k];
+            }
+
+            m_count = (uint32_t) origins.size() / 3;
+            m_origins = dr::load<FloatStorage>(origins.data(), origins.size());
+            m_directions = dr::load<FloatStorage>(directions.data(), directions.size());
+        }
+
+        if (m_count == 0)
+            Throw("At least one meter should be defined");
+
+        if (dr::prod(m_film->size()) != m_count)
+            Throw("The film of this sensor must have exactly one pixel per meter "
+                  "(%u), found %u x %u pixels!", m_count, m_film->size().x(),
+                  m_film->size().y());
+
+        if (m_film->rfilter()->radius() > .5f + math::RayEpsilon<Float>)
+            Log(Warn, "This sensor should only be used with a reconstruction filter "
+                      "of radius 0.5 or lower (e.g. default 'box' filter)");
+
+        m_needs_sample_2 = m_irradiance && m_mesh;
+        m_needs_sample_3 = m_irradiance;
+
+        update_bbox();
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        if (!m_mesh) {
+            callback->put_parameter("origins",    m_origins,    +ParamFlags::NonDifferentiable);
+            callback->put_parameter("directions", m_directions, +ParamFlags::NonDifferentiable);
+        }
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        Base::parameters_changed(keys);
+        if (!m_mesh && (keys.empty() || string::contains(keys, "origins") ||
+                        string::contains(keys, "directions"))) {
+            if (dr::width(m_origins) != 3 * m_count ||
+                dr::width(m_directions) != 3 * m_count)
+                Throw("parameters_changed(): the number of meters cannot change!");
+            update_bbox();
+        }
+    }
+
+    std::pair<Ray3f, Spectrum> sample_ray(Float time, Float wavelength_sample,
+                                          const Point2f &position_sample,
+                                          const Point2f &aperture_sample,
+                                          Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+
+        // 1. Find the meter of the pixel that is being sampled
+        ScalarVector2u size = m_film->size();
+        Point2u pixel = Point2u(dr::fmadd(position_sample,
+                                          ScalarVector2f(m_film->crop_size()),
+                                          ScalarVector2f(m_film->crop_offset())));
+        pixel = dr::minimum(pixel, Point2u(size - 1u));
+        UInt32 index = dr::fmadd(pixel.y(), size.x(), pixel.x());
+
+        // 2. Sample spatial and directional components
+        Point3f o;
+        Vector3f d;
+        if (m_mesh) {
+            auto fi = m_mesh->face_indices(index, active);
+            Point3f p0 = Point3f(m_mesh->vertex_position(fi[0], active)),
+                    p1 = Point3f(m_mesh->vertex_position(fi[1], active)),
+                    p2 = Point3f(m_mesh->vertex_position(fi[2], active));
+            Vector3f e0 = p1 - p0, e1 = p2 - p0;
+
+            Point2f b = warp::square_to_uniform_triangle(position_sample_in_pixel(
+                position_sample, pixel));
+            o = dr::fmadd(e0, b.x(), dr::fmadd(e1, b.y(), p0));
+            d = dr::normalize(dr::cross(e0, e1));
+        } else {
+            o = dr::gather<Point3f>(m_origins, index, active);
+            d = dr::gather<Vector3f>(m_directions, index, active);
+        }
+
+        ScalarFloat weight = 1.f;
+        if (m_irradiance) {
+            d = Frame3f(d).to_world(warp::square_to_cosine_hemisphere(aperture_sample));
+            weight = dr::Pi<ScalarFloat>;
+        }
+
+        // 3. Sample spectrum
+        auto [wavelengths, wav_weight] =
+            sample_wavelengths(dr::zeros<SurfaceInteraction3f>(),
+                               wavelength_sample,
+                               active);
+
+        return { Ray3f(o + d * math::RayEpsilon<Float>, d, time, wavelengths),
+                 depolarizer<Spectrum>(wav_weight) * weight };
+    }
+
+    std::pair<RayDifferential3f, Spectrum>
+    sample_ray_differential(Float time, Float wavelength_sample,
+                            const Point2f &position_sample,
+                            const Point2f &aperture_sample,
+                            Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::EndpointSampleRay, active);
+        auto [ray, weight] = sample_ray(time, wavelength_sample, position_sample,
+                                        aperture_sample, active);
+
+        // Every meter covers a single pixel, there are no differentials
+        RayDifferential3f ray_diff(ray);
+        ray_diff.has_differentials = false;
+        return { ray_diff, weight };
+    }
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "MeterArray[" << std::endl
+            << "  count = " << m_count << "," << std::endl
+            << "  measure = " << (m_irradiance ? "irradiance" : "radiance") << "," << std::endl;
+        if (m_mesh)
+            oss << "  mesh = " << string::indent(m_mesh) << "," << std::endl;
+        oss << "  film = " << string::indent(m_film) << "," << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+private:
+    /// Parse a list of 3D points or vectors given as a string
+    static std::vector<ScalarFloat> parse_points(const Properties &props,
+                                                 const std::string &name) {
+        if (!props.has_property(name))
+            Throw("The meters must either be defined by a mesh or by "
+                  "'origins' and 'directions'!");
+
+        std::vector<std::string> tokens = string::tokenize(props.string(name), " ,");
+        std::vector<ScalarFloat> result;
+        result.reserve(tokens.size());
+
+        for (const auto &s : tokens) {
+            try {
+                result.push_back(string::stof<ScalarFloat>(s));
+            } catch (...) {
+                Throw("Could not parse floating point value '%s'", s);
+            }
+        }
+
+        if (result.size() % 3 != 0)
+            Throw("The number of values of '%s' must be a multiple of 3, found "
+                  "%u!", name, result.size());
+        return result;
+    }
+
+    /**
+     * \brief Return the position of the film sample within its pixel
+     *
+     * The pixel of a film sample selects the meter, while its position within
+     * the pixel is (up to the reconstruction filter) uniformly distributed.
+     * This is used to sample the area of the meters of a mesh.
+     */
+    Point2f position_sample_in_pixel(const Point2f &position_sample,
+                                     const Point2u &pixel) const {
+        Point2f p = dr::fmadd(position_sample, ScalarVector2f(m_film->crop_size()),
+                              ScalarVector2f(m_film->crop_offset()));
+        return dr::clamp(p - Point2f(pixel), 0.f, dr::OneMinusEpsilon<ScalarFloat>);
+    }
+
+    void update_bbox() {
+        if (m_mesh) {
+            m_bbox = m_mesh->bbox();
+            return;
+        }
+
+        auto &&origins = dr::migrate(m_origins, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+
+        m_bbox = ScalarBoundingBox3f();
+        const ScalarFloat *ptr = origins.data();
+        for (uint32_t i = 0; i < m_count; ++i, ptr += 3)
+            m_bbox.expand(ScalarPoint3f(ptr[0], ptr[1], ptr[2]));
+    }
+
+private:
+    ref<Mesh> m_mesh;
+    FloatStorage m_origins;
+    FloatStorage m_directions;
+    uint32_t m_count;
+    bool m_irradiance;
+    ScalarBoundingBox3f m_bbox;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(MeterArray, Sensor)
+MI_EXPORT_PLUGIN(MeterArray, "MeterArray");
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,45 @@
+import pytest
+
+import mitsuba as mi
+import drjit as dr
+
+
+def create_sensor(origin):
+    return {
+        'type': 'perspective',
+        'fov': 45,
+        'to_world': mi.ScalarTransform4f.look_at(
+            origin=origin,
+            target=[0, 0, 0],
+            up=[0, 1, 0]
+        )
+    }
+
+
+origins = [[0, 0, 5], [5, 0, 0], [0, 5, 1], [-5, 0, 0]]
+
+
+def test01_sample_ray(variants_vec_rgb):
+    batch = mi.load_dict({
+        'type': 'batch',
+        'film': { 'type': 'hdrfilm', 'width': 16 * len(origins), 'height': 16 },
+        **{ f'sensor_{i}': create_sensor(o) for i, o in enumerate(origins) }
+    })
+
+    n = len(origins)
+    sensors = [mi.load_dict({
+        **create_sensor(o),
+        'film': { 'type': 'hdrfilm', 'width': 16, 'height': 16 }
+    }) for o in origins]
+
+    # Every ray is generated by the sub-sensor that covers its film position
+    x = dr.linspace(mi.Float, 0.01, 0.99, 64)
+    y = dr.linspace(mi.Float, 0.2, 0.8, 64)
+    ray, _ = batch.sample_ray_differential(0, 0.5, mi.Point2f(x, y), 0.5)
+
+    for i, sensor in enumerate(sensors):
+        ray_i, _ = sensor.sample_ray_differential(
+            0, 0.5, mi.Point2f(x * n - i, y), 0.5)
+        active = dr.eq(mi.UInt32(x * n), i)
+        assert dr.allclose(dr.select(active, ray.o, 0), dr.select(active, ray_i.o, 0))
+        assert dr.allclose(dr.select(active, ray.d, 0), dr.select(active, ray_i.d, 0))
@@ -0,0 +1,114 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def make_sensor(width, height=1, **kwargs):
+    return mi.load_dict({
+        'type': 'meterarray',
+        'film': {
+            'type': 'hdrfilm',
+            'width': width,
+            'height': height,
+            'pixel_format': 'rgb',
+            'rfilter': {'type': 'box'}
+        },
+        **kwargs
+    })
+
+
+def make_mesh():
+    # Two triangles of the unit square, facing in +Z and -Z respectively
+    mesh = mi.Mesh('meters', 4, 2)
+    params = mi.traverse(mesh)
+    params['vertex_positions'] = [0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0]
+    params['faces'] = [0, 1, 2, 0, 3, 2]
+    params.update()
+    return mesh
+
+
+def test01_construct(variant_scalar_rgb):
+    sensor = make_sensor(3, origins='0 0 0, 1 2 3, -1 0 0',
+                         directions='0 0 1, 0 1 0, 1 0 0')
+    assert dr.allclose(sensor.bbox().min, [-1, 0, 0])
+    assert dr.allclose(sensor.bbox().max, [1, 2, 3])
+    assert not sensor.needs_aperture_sample()
+
+    with pytest.raises(RuntimeError, match='one pixel per meter'):
+        make_sensor(2, origins='0 0 0, 1 2 3, -1 0 0',
+                    directions='0 0 1, 0 1 0, 1 0 0')
+
+    with pytest.raises(RuntimeError, match='same number of meters'):
+        make_sensor(1, origins='0 0 0', directions='0 0 1, 0 1 0')
+
+    with pytest.raises(RuntimeError, match='multiple of 3'):
+        make_sensor(1, origins='0 0', directions='0 0 1')
+
+    with pytest.raises(RuntimeError, match='can only be irradiance meters'):
+        make_sensor(2, mesh=make_mesh(), measure='radiance')
+
+    sensor = make_sensor(2, mesh=make_mesh())
+    assert sensor.needs_aperture_sample()
+
+
+def test02_sample_ray(variant_scalar_rgb):
+    origins = [[0, 0, 0], [1, 2, 3], [-1, 0, 0], [4, 1, 0]]
+    directions = [[0, 0, 1], [0, 2, 0], [1, 0, 0], [-1, -1, 0]]
+    sensor = make_sensor(2, 2,
+                         origins=', '.join(' '.join(map(str, o)) for o in origins),
+                         directions=', '.join(' '.join(map(str, d)) for d in directions))
+
+    # Pixels are enumerated in row-major order
+    for i, pos in enumerate([[0.2, 0.3], [0.7, 0.1], [0.4, 0.6], [0.9, 0.9]]):
+        ray, weight = sensor.sample_ray(0, 0.5, pos, [0.5, 0.5])
+        assert dr.allclose(ray.o, origins[i], atol=1e-4)
+        assert dr.allclose(ray.d, dr.normalize(mi.Vector3f(directions[i])))
+        assert dr.allclose(weight, 1)
+
+        ray, _ = sensor.sample_ray_differential(0, 0.5, pos, [0.5, 0.5])
+        assert not ray.has_differentials
+
+
+def test03_sample_ray_mesh(variant_scalar_rgb, np_rng):
+    sensor = make_sensor(2, mesh=make_mesh())
+
+    for _ in range(20):
+        pos = np_rng.random(2) * [0.5, 1]
+        ray, weight = sensor.sample_ray(0, 0.5, pos, np_rng.random(2))
+        # The first face lies below the diagonal and faces in +Z
+        assert ray.o.x >= ray.o.y - 1e-4 and ray.d.z > 0
+        assert dr.allclose(weight, dr.pi)
+
+        ray, weight = sensor.sample_ray(0, 0.5, pos + [0.5, 0], np_rng.random(2))
+        assert ray.o.x <= ray.o.y + 1e-4 and ray.d.z < 0
+
+
+@pytest.mark.parametrize('measure', ['radiance', 'irradiance'])
+def test04_render(variants_all_rgb, measure):
+    scene = mi.load_dict({
+        'type': 'scene',
+        'integrator': {'type': 'path'},
+        'sensor': {
+            'type': 'meterarray',
+            'origins': '0 0 0, 1 0 0, 0 5 0',
+            'directions': '0 0 1, 0 1 0, 1 1 1',
+            'measure': measure,
+            'film': {
+                'type': 'hdrfilm',
+                'width': 3,
+                'height': 1,
+                'pixel_format': 'rgb',
+                'rfilter': {'type': 'box'}
+            },
+            'sampler': {'type': 'independent', 'sample_count': 16}
+        },
+        'emitter': {
+            'type': 'constant',
+            'radiance': {'type': 'uniform', 'value': 2.0}
+        }
+    })
+
+    image = mi.render(scene)
+    assert image.shape == (1, 3, 3)
+    expected = 2.0 * (dr.pi if measure == 'irradiance' else 1.0)
+    assert dr.allclose(image.array, expected)
@@ -89,6 +89,11 @@ permits rendering with a specifiable (i.e. non-infinite) depth of field.
 To configure this, it has two extra parameters named :monosp:`aperture_radius`
 and :monosp:`focus_distance`.
 
+Defocused image regions take longer to converge, since their samples are
+spread over the aperture. The sensor reports the circle of confusion of the
+visible surfaces, which the adaptive sampling mode of the integrators uses to
+give such regions more passes (see the :monosp:`adaptive_defocus` parameter).
+
 By default, the camera's field of view is specified using a 35mm film
 equivalent focal length, which is first converted into a diagonal field
 of view and subsequently applied to the camera. This assumes that
@@ -349,6 +354,16 @@ public:
         return { ds, Spectrum(value * inv_dist * inv_dist) };
     }
 
+    Float circle_of_confusion(const Point3f &p, Mask active) const override {
+        Point3f local = m_to_world.value().inverse().transform_affine(p);
+
+        /* Radius of the blur disk on the focal plane, relative to the size
+           of a pixel at the same distance (m_dx lies on the near plane) */
+        Float coc = m_aperture_radius * m_near_clip / dr::abs(m_dx.x()) *
+                    dr::abs(dr::rcp(m_focus_distance) - dr::rcp(local.z()));
+
+        return dr::select(active && local.z() > 0.f, coc, 0.f);
+    }
 
     ScalarBoundingBox3f bbox() const override {
         ScalarPoint3f p = m_to_world.scalar() * ScalarPoint3f(0.f);
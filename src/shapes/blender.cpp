@@ -1,6 +1,10 @@
 #include <mitsuba/render/mesh.h>
+#include <mitsuba/core/parallel.h>
 #include <drjit/color.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <memory>
 
 // Blender Mesh format types for the exporter
 NAMESPACE_BEGIN(blender)
@@ -168,29 +172,12 @@ public:
             }
         }
 
-        // Temporary buffers for vertices, normals, etc.
-        std::vector<std::array<InputFloat, 3>> tmp_vertices; // Store as vector for alignment issues
-        std::vector<std::array<InputFloat, 3>> tmp_normals; // Same here
-        std::vector<InputVector2f> tmp_uvs;
-        std::vector<std::vector<InputFloat>> tmp_cols; // And same here
-        std::vector<ScalarIndex3> tmp_triangles;
-
-        tmp_vertices.reserve(vertex_count);
-        if (!m_face_normals)
-            tmp_normals.reserve(vertex_count);
-        tmp_triangles.reserve(loop_tri_count);
-
-        if (has_uvs)
-            tmp_uvs.reserve(vertex_count);
-        if (has_cols) {
-            tmp_cols.reserve(cols.size());
-            for (size_t p = 0; p < cols.size(); p++) {
-                tmp_cols.push_back(std::vector<InputFloat>());
-                tmp_cols[p].reserve(3 * vertex_count);
-            }
-        }
-
-        ScalarIndex vertex_ctr = 0;
+        // Position of a Blender vertex
+        auto position = [&](size_t index) {
+            const float *co = blender_3 ? verts_blender3[index].co
+                                        : verts_blender2[index].co;
+            return InputPoint3f(co[0], co[1], co[2]);
+        };
 
         // Hash map key to define a unique vertex
         struct Key {
@@ -204,151 +191,282 @@ public:
                 return (smooth ? normal == other.normal : poly == other.poly) &&
                        uv == other.uv;
             }
-            bool operator!=(const Key &other) const {
-                return (smooth ? normal != other.normal : poly != other.poly) ||
-                       uv != other.uv;
-            }
         };
 
-        // Hash map entry
-        struct VertexBinding {
-            Key key;
-            // Index of the vertex in the vertex array
-            ScalarIndex value{ 0 };
-            VertexBinding *next{ nullptr };
-            bool is_init{ false };
-        };
+        /* The conversion runs in parallel over ranges of triangles. It
+           produces the same vertex order as a serial traversal: a vertex is
+           created by the first triangle corner that references it with a
+           given key, in the order of the Blender triangles. */
+        size_t corner_count = 3 * loop_tri_count;
+        std::unique_ptr<Key[]> keys(new Key[corner_count]);
+        std::unique_ptr<uint32_t[]> corner_vertex(new uint32_t[corner_count]);
+        std::unique_ptr<uint8_t[]> tri_valid(new uint8_t[loop_tri_count]);
+        std::atomic<size_t> invalid_vertex{ (size_t) -1 };
+        std::atomic<bool> invalid_normal{ false };
+
+        // 1. Compute the key of every triangle corner of the exported material
+        blocked_parallel_for(loop_tri_count, 1 << 14, [&](size_t begin, size_t end) {
+            for (size_t tri_loop_id = begin; tri_loop_id < end; tri_loop_id++) {
+                const blender::MLoopTri &tri_loop = tri_loops[tri_loop_id];
+                const blender::MPoly &face        = polygons[tri_loop.poly];
+                tri_valid[tri_loop_id] = 0;
+
+                // We only export the part of the mesh corresponding to the given
+                // material id
+                if (face.mat_nr != mat_nr)
+                    continue;
+
+                bool valid = true;
+                for (int i = 0; i < 3; i++) {
+                    const size_t vert_index = loops[tri_loop.tri[i]].v;
+                    if (unlikely(vert_index >= vertex_count)) {
+                        invalid_vertex.store(vert_index, std::memory_order_relaxed);
+                        valid = false;
+                    }
+                    corner_vertex[3 * tri_loop_id + i] = (uint32_t) vert_index;
+                }
+                if (!valid)
+                    continue;
+
+                bool smooth = (blender::ME_SMOOTH & face.flag) || m_face_normals;
+
+                InputNormal3f normal(0.f);
+                if (!smooth) {
+                    // Flat shading, use per face normals (only if the mesh is not globally flat)
+                    InputPoint3f p[3];
+                    for (int i = 0; i < 3; i++)
+                        p[i] = position(corner_vertex[3 * tri_loop_id + i]);
+                    normal = m_to_world.scalar().transform_affine(
+                        dr::cross(p[1] - p[0], p[2] - p[0]));
+                    if (unlikely(dr::all(dr::eq(normal, 0.f))))
+                        continue; // Degenerate triangle, ignore it
+                    else
+                        normal = dr::normalize(normal);
+                }
 
-        // Hash Map to avoid adding duplicate vertices
-        std::vector<VertexBinding> vertex_map(vertex_count);
+                for (int i = 0; i < 3; i++) {
+                    const size_t loop_index = tri_loop.tri[i];
+                    const size_t vert_index = corner_vertex[3 * tri_loop_id + i];
 
-        size_t duplicates_ctr = 0;
-        for (size_t tri_loop_id = 0; tri_loop_id < loop_tri_count; tri_loop_id++) {
-            const blender::MLoopTri &tri_loop = tri_loops[tri_loop_id];
-            const blender::MPoly &face        = polygons[tri_loop.poly];
+                    Key &vert_key = keys[3 * tri_loop_id + i];
+                    vert_key = Key();
+                    if (smooth) {
+                        // Store per vertex normals if the face is smooth or if the mesh is globally flat
+                        if (!blender_3) {
+                            const short *no = verts_blender2[vert_index].no;
+                            normal = m_to_world.scalar().transform_affine(InputNormal3f(no[0], no[1], no[2]));
+                        } else {
+                            const float *no = normals_blender3[vert_index].no;
+                            normal = m_to_world.scalar().transform_affine(InputNormal3f(no[0], no[1], no[2]));
+                        }
+
+                        if (unlikely(dr::all(dr::eq(normal, 0.f))))
+                            invalid_normal.store(true, std::memory_order_relaxed);
+                        else
+                            normal = dr::normalize(normal);
+                        vert_key.smooth = true;
+                    } else {
+                        // vert_key.smooth = false (default), flat shading
+                        // Store the referenced polygon (face)
+                        vert_key.poly = tri_loop.poly;
+                    }
+
+                    vert_key.normal = normal;
+
+                    if (has_uvs) {
+                        const blender::MLoopUV &loop_uv = uvs[loop_index];
+                        vert_key.uv = InputVector2f(loop_uv.uv[0], 1.0f - loop_uv.uv[1]);
+                    }
+                }
 
-            // We only export the part of the mesh corresponding to the given
-            // material id
-            if (face.mat_nr != mat_nr)
-                continue;
-
-            ScalarIndex3 triangle;
-
-            const float *co_0, *co_1, *co_2;
-            if (blender_3) {
-                co_0 = verts_blender3[loops[tri_loop.tri[0]].v].co;
-                co_1 = verts_blender3[loops[tri_loop.tri[1]].v].co;
-                co_2 = verts_blender3[loops[tri_loop.tri[2]].v].co;
-            } else {
-                co_0 = verts_blender2[loops[tri_loop.tri[0]].v].co;
-                co_1 = verts_blender2[loops[tri_loop.tri[1]].v].co;
-                co_2 = verts_blender2[loops[tri_loop.tri[2]].v].co;
+                tri_valid[tri_loop_id] = 1;
             }
+        });
+
+        if (invalid_vertex.load() != (size_t) -1)
+            fail("reference to invalid vertex %i!", invalid_vertex.load());
+        if (invalid_normal.load())
+            fail("invalid normals!");
+
+        /* 2. List the corners that reference each Blender vertex (in corner
+           order), and find the first corner with the same key */
+        std::unique_ptr<std::atomic<uint32_t>[]> cursor(
+            new std::atomic<uint32_t>[vertex_count + 1]);
+        std::unique_ptr<uint32_t[]> offset(new uint32_t[vertex_count + 1]),
+                                    corners(new uint32_t[std::max(corner_count, (size_t) 1)]),
+                                    first(new uint32_t[std::max(corner_count, (size_t) 1)]);
+
+        blocked_parallel_for(vertex_count + 1, 1 << 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                cursor[i].store(0, std::memory_order_relaxed);
+        });
+
+        blocked_parallel_for(loop_tri_count, 1 << 14, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) {
+                if (!tri_valid[t])
+                    continue;
+                for (int i = 0; i < 3; i++)
+                    cursor[corner_vertex[3 * t + i] + 1].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        uint32_t sum = 0;
+        for (size_t i = 0; i <= vertex_count; ++i) {
+            sum += cursor[i].load(std::memory_order_relaxed);
+            offset[i] = sum;
+            cursor[i].store(sum, std::memory_order_relaxed);
+        }
 
-            dr::Array<InputPoint3f, 3> face_points;
-            face_points[0] = InputPoint3f(co_0[0], co_0[1], co_0[2]);
-            face_points[1] = InputPoint3f(co_1[0], co_1[1], co_1[2]);
-            face_points[2] = InputPoint3f(co_2[0], co_2[1], co_2[2]);
-
-            InputNormal3f normal(0.f);
-            if (!(blender::ME_SMOOTH & face.flag) && !m_face_normals) {
-                // Flat shading, use per face normals (only if the mesh is not globally flat)
-                const InputVector3f e1 = face_points[1] - face_points[0];
-                const InputVector3f e2 = face_points[2] - face_points[0];
-                normal = m_to_world.scalar().transform_affine(dr::cross(e1, e2));
-                if(unlikely(dr::all(dr::eq(normal, 0.f))))
-                    continue; // Degenerate triangle, ignore it
-                else
-                    normal = dr::normalize(normal);
+        blocked_parallel_for(loop_tri_count, 1 << 14, [&](size_t begin, size_t end) {
+            for (size_t t = begin; t < end; ++t) {
+                if (!tri_valid[t])
+                    continue;
+                for (uint32_t c = 3 * (uint32_t) t; c < 3 * (uint32_t) t + 3; c++)
+                    corners[cursor[corner_vertex[c]].fetch_add(1, std::memory_order_relaxed)] = c;
             }
+        });
+
+        std::atomic<size_t> unique_counter{ 0 };
+        std::atomic<bool> split{ false };
+        blocked_parallel_for(vertex_count, 1 << 12, [&](size_t begin, size_t end) {
+            size_t unique = 0;
+            bool split_local = false;
+            for (size_t v = begin; v < end; ++v) {
+                uint32_t *start = corners.get() + offset[v],
+                         *stop  = corners.get() + offset[v + 1];
+                std::sort(start, stop);
+
+                // The first corners of the distinct keys of this vertex
+                size_t unique_v = 0;
+                for (uint32_t *c = start; c != stop; ++c) {
+                    first[*c] = *c;
+                    for (uint32_t *u = start; u != c; ++u) {
+                        if (first[*u] == *u && keys[*u] == keys[*c]) {
+                            first[*c] = *u;
+                            break;
+                        }
+                    }
+                    unique_v += first[*c] == *c;
+                }
 
-            InputFloat color_factor = dr::rcp(255.f);
+                // Unreferenced or split vertices change the vertex order
+                split_local |= unique_v != 1;
+                unique += unique_v;
+            }
+            unique_counter.fetch_add(unique, std::memory_order_relaxed);
+            if (split_local)
+                split.store(true, std::memory_order_relaxed);
+        });
 
-            for (int i = 0; i < 3; i++) {
-                const size_t loop_index = tri_loop.tri[i];
-                const size_t vert_index = loops[loop_index].v;
-                if (unlikely((vert_index >= vertex_count)))
-                    fail("reference to invalid vertex %i!", vert_index);
+        size_t vertex_ctr = unique_counter.load();
+        Log(Info, "%s: Removed %i duplicates", m_name, sum - vertex_ctr);
 
-                Key vert_key;
-                if (blender::ME_SMOOTH & face.flag || m_face_normals) {
-                    if (!blender_3) {
-                        const short *no = verts_blender2[vert_index].no;
-                        // Store per vertex normals if the face is smooth or if the mesh is globally flat
-                        normal = m_to_world.scalar().transform_affine(InputNormal3f(no[0], no[1], no[2]));
-                    } else {
-                        const float *no = normals_blender3[vert_index].no;
-                        // Store per vertex normals if the face is smooth or if the mesh is globally flat
-                        normal = m_to_world.scalar().transform_affine(InputNormal3f(no[0], no[1], no[2]));
-                    }
+        if (vertex_ctr == 0)
+            return;
 
-                    if(unlikely(dr::all(dr::eq(normal, 0.f))))
-                        fail("invalid normals!");
-                    else
-                        normal = dr::normalize(normal);
-                    vert_key.smooth = true;
-                } else {
-                    // vert_key.smooth = false (default), flat shading
-                    // Store the referenced polygon (face)
-                    vert_key.poly = tri_loop.poly;
+        /* 3. Number the new vertices and triangles. When every Blender vertex
+              maps to exactly one vertex, the mesh keeps the vertex order of
+              Blender and skips the renumbering. */
+        size_t block_size = 1 << 14,
+               block_count = (loop_tri_count + block_size - 1) / block_size;
+        std::vector<uint32_t> block_vertices(block_count + 1, 0),
+                              block_triangles(block_count + 1, 0);
+
+        blocked_parallel_for(block_count, 1, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                size_t t_end = std::min(loop_tri_count, (b + 1) * block_size);
+                for (size_t t = b * block_size; t < t_end; ++t) {
+                    if (!tri_valid[t])
+                        continue;
+                    block_triangles[b + 1]++;
+                    for (uint32_t c = 3 * (uint32_t) t; c < 3 * (uint32_t) t + 3; c++)
+                        block_vertices[b + 1] += first[c] == c;
                 }
+            }
+        });
 
-                vert_key.normal = normal;
+        for (size_t b = 0; b < block_count; ++b) {
+            block_vertices[b + 1] += block_vertices[b];
+            block_triangles[b + 1] += block_triangles[b];
+        }
 
-                if (has_uvs) {
-                    const blender::MLoopUV &loop_uv = uvs[loop_index];
-                    const InputVector2f uv(loop_uv.uv[0], 1.0f - loop_uv.uv[1]);
-                    vert_key.uv = uv;
-                }
+        std::vector<std::array<InputFloat, 3>> tmp_vertices(vertex_ctr); // Store as vector for alignment issues
+        std::vector<std::array<InputFloat, 3>> tmp_normals; // Same here
+        std::vector<InputVector2f> tmp_uvs;
+        std::vector<std::vector<InputFloat>> tmp_cols(cols.size()); // And same here
+        std::vector<ScalarIndex3> tmp_triangles(block_triangles[block_count]);
+        std::unique_ptr<uint32_t[]> vertex_id(new uint32_t[std::max(corner_count, (size_t) 1)]);
 
-                // Vertex index in the blender mesh is the map index
-                VertexBinding *map_entry = &vertex_map[vert_index];
-                while (vert_key != map_entry->key && map_entry->next != nullptr)
-                    map_entry = map_entry->next;
-
-                if (map_entry->is_init && map_entry->key == vert_key) {
-                    triangle[i] = map_entry->value;
-                    duplicates_ctr++;
-                } else {
-                    if (map_entry->is_init) {
-                        // Add a new entry
-                        map_entry->next = new VertexBinding();
-                        map_entry       = map_entry->next;
-                    }
-                    ScalarSize vert_id = vertex_ctr++;
-                    map_entry->key     = vert_key;
-                    map_entry->value   = vert_id;
-                    map_entry->is_init = true;
-                    // Add stuff to the temporary buffers
-                    InputPoint3f pt = m_to_world.scalar().transform_affine(face_points[i]);
-                    tmp_vertices.push_back({pt.x(), pt.y(), pt.z()});
-                    if (!m_face_normals)
-                        tmp_normals.push_back({normal.x(), normal.y(), normal.z()});
-                    if (has_uvs)
-                        tmp_uvs.push_back(vert_key.uv);
-                    if (has_cols) {
+        if (!m_face_normals)
+            tmp_normals.resize(vertex_ctr);
+        if (has_uvs)
+            tmp_uvs.resize(vertex_ctr);
+        for (size_t p = 0; p < cols.size(); p++)
+            tmp_cols[p].resize(3 * vertex_ctr);
+
+        InputFloat color_factor = dr::rcp(255.f);
+
+        // Fill the vertex buffers from the first corners of every vertex
+        blocked_parallel_for(block_count, 1, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                uint32_t id = block_vertices[b];
+                size_t t_end = std::min(loop_tri_count, (b + 1) * block_size);
+                for (size_t t = b * block_size; t < t_end; ++t) {
+                    if (!tri_valid[t])
+                        continue;
+                    for (int i = 0; i < 3; i++) {
+                        uint32_t c = 3 * (uint32_t) t + i;
+                        if (first[c] != c)
+                            continue;
+
+                        uint32_t vert_id = split.load(std::memory_order_relaxed)
+                                               ? id++ : corner_vertex[c];
+                        const Key &vert_key = keys[c];
+                        vertex_id[c] = vert_id;
+
+                        InputPoint3f pt = m_to_world.scalar().transform_affine(
+                            position(corner_vertex[c]));
+                        tmp_vertices[vert_id] = { pt.x(), pt.y(), pt.z() };
+                        if (!m_face_normals)
+                            tmp_normals[vert_id] = { vert_key.normal.x(),
+                                                     vert_key.normal.y(),
+                                                     vert_key.normal.z() };
+                        if (has_uvs)
+                            tmp_uvs[vert_id] = vert_key.uv;
+
+                        const size_t loop_index = tri_loops[t].tri[i];
                         for (size_t p = 0; p < cols.size(); p++) {
                             const blender::MLoopCol &loop_col = cols[p].second[loop_index];
                             // Blender stores vertex colors in sRGB space
-                            tmp_cols[p].push_back(dr::srgb_to_linear(loop_col.r * color_factor));
-                            tmp_cols[p].push_back(dr::srgb_to_linear(loop_col.g * color_factor));
-                            tmp_cols[p].push_back(dr::srgb_to_linear(loop_col.b * color_factor));
+                            InputFloat *col = tmp_cols[p].data() + 3 * vert_id;
+                            col[0] = dr::srgb_to_linear(loop_col.r * color_factor);
+                            col[1] = dr::srgb_to_linear(loop_col.g * color_factor);
+                            col[2] = dr::srgb_to_linear(loop_col.b * color_factor);
                         }
                     }
-                    triangle[i] = vert_id;
                 }
             }
-            tmp_triangles.push_back(triangle);
-        }
-        Log(Info, "%s: Removed %i duplicates", m_name, duplicates_ctr);
-
-        if (vertex_ctr == 0)
-            return;
+        });
+
+        // Fill the index buffer, duplicate corners reuse the first one
+        blocked_parallel_for(block_count, 1, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; ++b) {
+                uint32_t id = block_triangles[b];
+                size_t t_end = std::min(loop_tri_count, (b + 1) * block_size);
+                for (size_t t = b * block_size; t < t_end; ++t) {
+                    if (!tri_valid[t])
+                        continue;
+                    ScalarIndex3 &triangle = tmp_triangles[id++];
+                    for (int i = 0; i < 3; i++)
+                        triangle[i] = vertex_id[first[3 * t + i]];
+                }
+            }
+        });
 
         m_face_count = (ScalarSize) tmp_triangles.size();
         m_faces = dr::load<DynamicBuffer<UInt32>>(tmp_triangles.data(), m_face_count * 3);
 
-        m_vertex_count = vertex_ctr;
+        m_vertex_count = (ScalarSize) vertex_ctr;
         m_vertex_positions = dr::load<FloatStorage>(tmp_vertices.data(), m_vertex_count * 3);
         if (!m_face_normals)
             m_vertex_normals = dr::load<FloatStorage>(tmp_normals.data(), m_vertex_count * 3);
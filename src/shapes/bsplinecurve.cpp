@@ -10,7 +10,9 @@
 #include <mitsuba/render/fwd.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/shape.h>
+#include <nanothread/nanothread.h>
 #include <iostream>
+#include <mutex>
 
 #include <drjit/texture.h>
 
@@ -32,7 +34,7 @@ B-spline curve (:monosp:`bsplinecurve`)
 
  * - filename
    - |string|
-   - Filename of the curves to be loaded
+   - Filename of the curves to be loaded (text or :monosp:`.hair` file)
 
  * - to_world
    - |transform|
@@ -94,6 +96,12 @@ points and increasing radii::
      4.0 1.0 2.2 5
      4.0 0.0 2.3 6
 
+Files with a :monosp:`.hair` extension are instead read as binary files in the
+`HAIR format <http://www.cemyuksel.com/research/hairmodels/>`_ of Cem Yuksel,
+which loads much faster than the text format for large grooms. Every strand
+becomes a B-spline curve with the strand points as control points and half of
+the thickness as radius. Strands with fewer than four points are skipped.
+
 .. tabs::
     .. code-tab:: xml
         :name: bsplinecurve
@@ -162,149 +170,59 @@ public:
 
         ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
         ScopedPhase phase(ProfilerPhase::LoadGeometry);
-
-        // Temporary buffers for vertices and radius
-        std::vector<InputPoint3f> vertices;
-        std::vector<InputFloat> radius;
-        ScalarSize vertex_guess = (ScalarSize) mmap->size() / 100;
-        vertices.reserve(vertex_guess);
-        radius.reserve(vertex_guess);
-
-        // Load data from the given file
-        const char *ptr = (const char *) mmap->data();
-        const char *eof = ptr + mmap->size();
-        char buf[1025];
         Timer timer;
 
-        size_t segment_count = 0;
-        std::vector<size_t> curve_1st_idx;
-        curve_1st_idx.reserve(vertex_guess / 4);
-        bool new_curve = true;
-
-        auto finish_curve = [&]() {
-            if (!new_curve) {
-                size_t num_control_points = vertices.size() - curve_1st_idx[curve_1st_idx.size() - 1];
-                if (unlikely((num_control_points < 4) && (num_control_points > 0)))
-                    fail("B-spline curves must have at least four control points!");
-                if (likely(num_control_points > 0))
-                    segment_count += (num_control_points - 3);
-            }
-        };
-
-        while (ptr < eof) {
-            // Determine the offset of the next newline
-            const char *next = ptr;
-            advance<false>(&next, eof, "\n");
-
-            // Copy buf into a 0-terminated buffer
-            ScalarSize size = (ScalarSize) (next - ptr);
-            if (size >= sizeof(buf) - 1)
-                fail("file contains an excessively long line! (%i characters)!", size);
-            memcpy(buf, ptr, size);
-            buf[size] = '\0';
-
-            // Skip whitespace(s)
-            const char *cur = buf, *eol = buf + size;
-            advance<true>(&cur, eol, " \t\r");
-            bool parse_error = false;
-
-            // Empty line
-            if (*cur == '\0') {
-                finish_curve();
-                new_curve = true;
-                ptr = next + 1;
-                continue;
-            }
-
-            // Handle current line: v.x v.y v.z radius
-            if (new_curve) {
-                curve_1st_idx.push_back(vertices.size());
-                new_curve = false;
-            }
-
-            // Vertex position
-            InputPoint3f p;
-            for (ScalarSize i = 0; i < 3; ++i) {
-                const char *orig = cur;
-                p[i] = string::strtof<InputFloat>(cur, (char **) &cur);
-                parse_error |= cur == orig;
-            }
-            p = m_to_world.scalar().transform_affine(p);
-
-            // Vertex radius
-            InputFloat r;
-            const char *orig = cur;
-            r = string::strtof<InputFloat>(cur, (char **) &cur);
-            parse_error |= cur == orig;
-
-            if (unlikely(!all(dr::isfinite(p))))
-                fail("B-spline control point contains invalid position data (line: \"%s\")!", buf);
-            if (unlikely(!dr::isfinite(r)))
-                fail("B-spline control point contains invalid radius data (line: \"%s\")!", buf);
+        /* Interleaved control points (position, radius) in object space and
+           the index of the first control point of every curve */
+        std::vector<InputFloat> control_points;
+        std::vector<ScalarIndex> curve_1st_idx;
 
-            vertices.push_back(p);
-            radius.push_back(r);
+        std::string extension = string::to_lower(file_path.extension().string());
+        if (extension == ".hair")
+            load_hair(mmap, control_points, curve_1st_idx, fail);
+        else
+            load_text(mmap, control_points, curve_1st_idx, fail);
 
-            if (unlikely(parse_error))
-                fail("Could not parse line \"%s\"!", buf);
-            ptr = next + 1;
-        }
         if (curve_1st_idx.size() == 0)
             fail("Empty B-spline file: no control points were read!");
-        finish_curve();
 
-        m_control_point_count = (ScalarSize) vertices.size();
+        m_control_point_count = (ScalarSize) (control_points.size() / 4);
 
+        // One segment starts at every control point but the last three of a curve
+        ScalarSize segment_count =
+            m_control_point_count - 3 * (ScalarSize) curve_1st_idx.size();
         std::unique_ptr<ScalarIndex[]> indices = std::make_unique<ScalarIndex[]>(segment_count);
         size_t segment_index = 0;
         for (size_t i = 0; i < curve_1st_idx.size(); ++i) {
-            size_t next_curve_idx = i + 1 < curve_1st_idx.size() ? curve_1st_idx[i + 1] : vertices.size();
-            size_t curve_segment_count = next_curve_idx - curve_1st_idx[i] - 3;
-            for (size_t j = 0; j < curve_segment_count; ++j)
-                indices[segment_index++] = (ScalarIndex) (curve_1st_idx[i] + j);
+            ScalarIndex next_curve_idx = i + 1 < curve_1st_idx.size()
+                                             ? curve_1st_idx[i + 1]
+                                             : (ScalarIndex) m_control_point_count;
+            for (ScalarIndex j = curve_1st_idx[i]; j + 3 < next_curve_idx; ++j)
+                indices[segment_index++] = j;
         }
         m_indices = dr::load<UInt32Storage>(indices.get(), segment_count);
 
-        std::unique_ptr<InputFloat[]> positions =
-            std::make_unique<InputFloat[]>(m_control_point_count * 3);
-        for (ScalarIndex i = 0; i < vertices.size(); i++) {
-            InputFloat *vertex_ptr = positions.get() + i * 3;
-            dr::store(vertex_ptr, vertices[i]);
-        }
-
-        // Merge buffers into m_control_points
-        m_control_points = dr::empty<FloatStorage>(m_control_point_count * 4);
-        FloatStorage vertex_buffer = dr::load<FloatStorage>(positions.get(), m_control_point_count * 3);
-        FloatStorage radius_buffer = dr::load<FloatStorage>(radius.data(), m_control_point_count * 1);
-
-        if constexpr (dr::is_jit_v<Float>) {
-            DynamicBuffer<UInt32> idx = dr::arange<DynamicBuffer<UInt32>>(m_control_point_count);
-            dr::scatter(m_control_points, dr::gather<FloatStorage>(vertex_buffer, idx * 3u + 0u), idx * 4u + 0u);
-            dr::scatter(m_control_points, dr::gather<FloatStorage>(vertex_buffer, idx * 3u + 1u), idx * 4u + 1u);
-            dr::scatter(m_control_points, dr::gather<FloatStorage>(vertex_buffer, idx * 3u + 2u), idx * 4u + 2u);
-            dr::scatter(m_control_points, dr::gather<FloatStorage>(radius_buffer, idx * 1u + 0u), idx * 4u + 3u);
-        } else {
-            for (size_t i = 0; i < m_control_point_count; ++i) {
-                m_control_points[i * 4 + 0] = vertex_buffer[i * 3 + 0];
-                m_control_points[i * 4 + 1] = vertex_buffer[i * 3 + 1];
-                m_control_points[i * 4 + 2] = vertex_buffer[i * 3 + 2];
-                m_control_points[i * 4 + 3] = radius_buffer[i * 1 + 0];
+        // Apply the object-to-world transformation to the positions
+        ScalarTransform4f to_world = m_to_world.scalar();
+        InputFloat *cp = control_points.data();
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, m_control_point_count, 1 << 16),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    InputFloat *ptr = cp + 4 * i;
+                    InputPoint3f p = dr::load<InputPoint3f>(ptr);
+                    p = to_world.transform_affine(p);
+                    if (unlikely(!dr::all(dr::isfinite(p))))
+                        fail("B-spline control point contains invalid position data!");
+                    dr::store(ptr, p);
+                }
             }
-        }
+        );
 
-        // Compute bounding box
-        m_bbox.reset();
-        for (ScalarSize i = 0; i < m_control_point_count; ++i) {
-            ScalarPoint3f p(positions[3 * i + 0], positions[3 * i + 1],
-                            positions[3 * i + 2]);
-            ScalarFloat r(radius[i]);
-            m_bbox.expand(p + r * ScalarVector3f(-1, 0, 0));
-            m_bbox.expand(p + r * ScalarVector3f(1, 0, 0));
-            m_bbox.expand(p + r * ScalarVector3f(0, -1, 0));
-            m_bbox.expand(p + r * ScalarVector3f(0, 1, 0));
-            m_bbox.expand(p + r * ScalarVector3f(0, 0, -1));
-            m_bbox.expand(p + r * ScalarVector3f(0, 0, 1));
-        }
+        // The interleaved layout is already the one expected by Embree and OptiX
+        m_control_points = dr::load<FloatStorage>(control_points.data(),
+                                                  m_control_point_count * 4);
+        recompute_bbox();
 
         ScalarSize control_point_bytes = 4 * sizeof(InputFloat);
         Log(Debug, "\"%s\": read %i control points (%s in %s)",
@@ -312,7 +230,6 @@ public:
             util::mem_string(m_control_point_count * control_point_bytes),
             util::time_string((float) timer.value())
         );
-
         initialize();
     }
 
@@ -603,6 +520,195 @@ public:
     MI_DECLARE_CLASS()
 
 private:
+    /// Parse the text format (one control point per line, curves separated by empty lines)
+    template <typename Fail>
+    void load_text(const MemoryMappedFile *mmap, std::vector<InputFloat> &control_points,
+                   std::vector<ScalarIndex> &curve_1st_idx, const Fail &fail) {
+        size_t vertex_guess = mmap->size() / 100;
+        control_points.reserve(vertex_guess * 4);
+        curve_1st_idx.reserve(vertex_guess / 4);
+
+        const char *ptr = (const char *) mmap->data();
+        const char *eof = ptr + mmap->size();
+        char buf[1025];
+        bool new_curve = true;
+
+        auto finish_curve = [&]() {
+            if (!new_curve) {
+                size_t num_control_points = control_points.size() / 4 - curve_1st_idx.back();
+                if (unlikely(num_control_points < 4))
+                    fail("B-spline curves must have at least four control points!");
+            }
+        };
+
+        while (ptr < eof) {
+            // Determine the offset of the next newline
+            const char *next = ptr;
+            advance<false>(&next, eof, "\n");
+
+            // Copy buf into a 0-terminated buffer
+            ScalarSize size = (ScalarSize) (next - ptr);
+            if (size >= sizeof(buf) - 1)
+                fail("file contains an excessively long line! (%i characters)!", size);
+            memcpy(buf, ptr, size);
+            buf[size] = '\0';
+
+            // Skip whitespace(s)
+            const char *cur = buf, *eol = buf + size;
+            advance<true>(&cur, eol, " \t\r");
+            bool parse_error = false;
+
+            // Empty line
+            if (*cur == '\0') {
+                finish_curve();
+                new_curve = true;
+                ptr = next + 1;
+                continue;
+            }
+
+            // Handle current line: v.x v.y v.z radius
+            if (new_curve) {
+                curve_1st_idx.push_back((ScalarIndex) (control_points.size() / 4));
+                new_curve = false;
+            }
+
+            InputFloat v[4];
+            for (ScalarSize i = 0; i < 4; ++i) {
+                const char *orig = cur;
+                v[i] = string::strtof<InputFloat>(cur, (char **) &cur);
+                parse_error |= cur == orig;
+            }
+
+            if (unlikely(parse_error))
+                fail("Could not parse line \"%s\"!", buf);
+            if (unlikely(!dr::isfinite(v[0]) || !dr::isfinite(v[1]) || !dr::isfinite(v[2])))
+                fail("B-spline control point contains invalid position data (line: \"%s\")!", buf);
+            if (unlikely(!dr::isfinite(v[3])))
+                fail("B-spline control point contains invalid radius data (line: \"%s\")!", buf);
+
+            control_points.insert(control_points.end(), v, v + 4);
+            ptr = next + 1;
+        }
+        finish_curve();
+    }
+
+    /**
+     * \brief Load a binary file in the Cem Yuksel's HAIR format
+     *
+     * Only the segment, point and thickness arrays are read. The thickness
+     * denotes the diameter of a strand, and strands with fewer than four
+     * points cannot be represented by a cubic B-spline and are skipped.
+     */
+    template <typename Fail>
+    void load_hair(const MemoryMappedFile *mmap, std::vector<InputFloat> &control_points,
+                   std::vector<ScalarIndex> &curve_1st_idx, const Fail &fail) {
+        struct Header {
+            char signature[4];
+            uint32_t hair_count, point_count, arrays, d_segments;
+            float d_thickness, d_transparency, d_color[3];
+            char info[88];
+        };
+        static_assert(sizeof(Header) == 128, "Unexpected HAIR header size");
+
+        enum : uint32_t { HasSegments = 1, HasPoints = 2, HasThickness = 4,
+                          HasTransparency = 8, HasColors = 16 };
+
+        const uint8_t *data = (const uint8_t *) mmap->data();
+        size_t size = mmap->size();
+        if (size < sizeof(Header))
+            fail("file is too small to contain a HAIR header!");
+
+        Header header;
+        memcpy(&header, data, sizeof(Header));
+        if (memcmp(header.signature, "HAIR", 4) != 0)
+            fail("invalid HAIR file signature!");
+        if (!(header.arrays & HasPoints))
+            fail("HAIR file does not contain a point array!");
+
+        size_t hair_count = header.hair_count, point_count = header.point_count;
+        size_t expected = sizeof(Header) + point_count * 3 * sizeof(float);
+        if (header.arrays & HasSegments)
+            expected += hair_count * sizeof(uint16_t);
+        if (header.arrays & HasThickness)
+            expected += point_count * sizeof(float);
+        if (size < expected)
+            fail("file is truncated (expected at least %zu bytes, got %zu)!",
+                 expected, size);
+
+        const uint8_t *ptr = data + sizeof(Header);
+        const uint8_t *segments = nullptr, *points = nullptr, *thickness = nullptr;
+        if (header.arrays & HasSegments) {
+            segments = ptr;
+            ptr += hair_count * sizeof(uint16_t);
+        }
+        points = ptr;
+        ptr += point_count * 3 * sizeof(float);
+        if (header.arrays & HasThickness)
+            thickness = ptr;
+
+        // Determine the first point of every strand
+        std::vector<size_t> strand_offset(hair_count + 1);
+        size_t skipped = 0, kept_points = 0;
+        strand_offset[0] = 0;
+        for (size_t i = 0; i < hair_count; ++i) {
+            uint16_t seg = (uint16_t) header.d_segments;
+            if (segments)
+                memcpy(&seg, segments + i * sizeof(uint16_t), sizeof(uint16_t));
+            strand_offset[i + 1] = strand_offset[i] + (size_t) seg + 1;
+            if (seg + 1 < 4)
+                skipped++;
+            else
+                kept_points += (size_t) seg + 1;
+        }
+        if (strand_offset[hair_count] > point_count)
+            fail("segment counts exceed the number of points (%zu > %zu)!",
+                 strand_offset[hair_count], point_count);
+        if (skipped > 0)
+            Log(Warn, "Skipped %zu hair strand(s) with fewer than four points.", skipped);
+
+        curve_1st_idx.reserve(hair_count - skipped);
+        std::vector<size_t> src_offset;
+        src_offset.reserve(hair_count - skipped);
+        size_t cursor = 0;
+        for (size_t i = 0; i < hair_count; ++i) {
+            size_t n = strand_offset[i + 1] - strand_offset[i];
+            if (n < 4)
+                continue;
+            curve_1st_idx.push_back((ScalarIndex) cursor);
+            src_offset.push_back(strand_offset[i]);
+            cursor += n;
+        }
+
+        // Interleave positions and radii, strands are independent of each other
+        control_points.resize(kept_points * 4);
+        InputFloat *out = control_points.data();
+        InputFloat default_radius = header.d_thickness * .5f;
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, curve_1st_idx.size(), 1024),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    size_t dst = curve_1st_idx[i],
+                           end = i + 1 < curve_1st_idx.size() ? curve_1st_idx[i + 1] : kept_points,
+                           src = src_offset[i];
+                    for (; dst < end; ++dst, ++src) {
+                        float v[4];
+                        memcpy(v, points + src * 3 * sizeof(float), 3 * sizeof(float));
+                        if (thickness) {
+                            memcpy(v + 3, thickness + src * sizeof(float), sizeof(float));
+                            v[3] *= .5f;
+                        } else {
+                            v[3] = default_radius;
+                        }
+                        if (unlikely(!dr::isfinite(v[3])))
+                            fail("B-spline control point contains invalid radius data!");
+                        for (int k = 0; k < 4; ++k)
+                            out[dst * 4 + k] = (InputFloat) v[k];
+                    }
+                }
+            }
+        );
+    }
+
     template <bool Negate, size_t N>
     void advance(const char **start_, const char *end, const char (&delim)[N]) {
         const char *start = *start_;
@@ -626,17 +732,22 @@ private:
             dr::sync_thread();
         const InputFloat *ptr = control_points.data();
 
+        std::mutex mutex;
         m_bbox.reset();
-        for (ScalarSize i = 0; i < m_control_point_count; ++i) {
-            ScalarPoint3f p(ptr[4 * i + 0], ptr[4 * i + 1], ptr[4 * i + 2]);
-            ScalarFloat r(ptr[4 * i + 3]);
-            m_bbox.expand(p + r * ScalarVector3f(-1, 0, 0));
-            m_bbox.expand(p + r * ScalarVector3f(1, 0, 0));
-            m_bbox.expand(p + r * ScalarVector3f(0, -1, 0));
-            m_bbox.expand(p + r * ScalarVector3f(0, 1, 0));
-            m_bbox.expand(p + r * ScalarVector3f(0, 0, -1));
-            m_bbox.expand(p + r * ScalarVector3f(0, 0, 1));
-        }
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, m_control_point_count, 1 << 16),
+            [&](const dr::blocked_range<size_t> &range) {
+                ScalarBoundingBox3f bbox;
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    ScalarPoint3f p(ptr[4 * i + 0], ptr[4 * i + 1], ptr[4 * i + 2]);
+                    ScalarFloat r(ptr[4 * i + 3]);
+                    bbox.expand(p - r);
+                    bbox.expand(p + r);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                m_bbox.expand(bbox);
+            }
+        );
     }
 
     std::tuple<Point3f, Vector3f, Vector3f, Vector3f, Float, Float, Float>
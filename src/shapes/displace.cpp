@@ -0,0 +1,810 @@
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/primitivebvh.h>
+#include <mitsuba/render/shape.h>
+#include <mitsuba/render/texture.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-displace:
+
+Displaced mesh (:monosp:`displace`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - (Nested plugin)
+   - |shape|
+   - The base triangle mesh (e.g. a :ref:`ply <shape-ply>` or
+     :ref:`obj <shape-obj>` shape). It must have texture coordinates.
+
+ * - displacement
+   - |texture|
+   - Scalar height texture (e.g. a :ref:`bitmap <texture-bitmap>`), which is
+     looked up using the texture coordinates of the base mesh.
+
+ * - scale
+   - |float|
+   - Scale factor applied to the height values (Default: 1)
+
+ * - offset
+   - |float|
+   - Constant offset added to the scaled height values (Default: 0)
+
+ * - rate
+   - |int|
+   - Number of micro-triangle edges along every edge of a base triangle,
+     i.e. each base triangle is split into :monosp:`rate`:math:`^2`
+     micro-triangles (Default: 16)
+
+ * - cache_size
+   - |float|
+   - Memory budget of the micro-geometry cache in MiB (Default: 256)
+
+This plugin displaces a triangle mesh along its interpolated vertex normals
+(or face normals if the mesh has none) by the values of a height texture:
+
+.. math::
+
+    \mathbf{p}'(u, v) = \mathbf{p}(u, v) + \mathbf{n}(u, v)\,
+    (\texttt{scale}\cdot h(u, v) + \texttt{offset})
+
+The displaced micro-triangles are never stored for the whole mesh. Instead,
+the plugin computes the bounds of every displaced base triangle when the scene
+is loaded and builds a bounding volume hierarchy over them. Once a ray reaches
+a base triangle, its micro-triangles are tessellated on demand and kept in a
+cache with least-recently-used eviction whose size is bounded by
+:monosp:`cache_size`. This provides actual geometric detail (silhouettes,
+occlusion and shadows) at a fraction of the memory of a pre-displaced mesh.
+
+The shading normals correspond to the faceted micro-triangles. The BSDF,
+emitter, sensor and media must be attached to the :monosp:`displace` shape
+itself. This plugin is only supported by the scalar variants.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: displace
+
+        <shape type="displace">
+            <shape type="ply">
+                <string name="filename" value="terrain.ply"/>
+            </shape>
+            <texture type="bitmap" name="displacement">
+                <string name="filename" value="height.exr"/>
+                <boolean name="raw" value="true"/>
+            </texture>
+            <float name="scale" value="0.05"/>
+            <integer name="rate" value="64"/>
+        </shape>
+
+    .. code-tab:: python
+
+        'terrain': {
+            'type': 'displace',
+            'base': {
+                'type': 'ply',
+                'filename': 'terrain.ply'
+            },
+            'displacement': {
+                'type': 'bitmap',
+                'filename': 'height.exr',
+                'raw': True
+            },
+            'scale': 0.05,
+            'rate': 64
+        }
+ */
+
+template <typename Float, typename Spectrum>
+class DisplacedMesh final : public Shape<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Shape, initialize)
+    MI_IMPORT_TYPES(Mesh, Texture)
+
+    using typename Base::ScalarSize;
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarRay3f;
+
+private:
+    /// Vertex data of a base triangle
+    struct BaseTriangle {
+        ScalarPoint3f p[3];
+        ScalarNormal3f n[3];
+        ScalarPoint2f uv[3];
+    };
+
+    /**
+     * \brief Tessellated base triangle
+     *
+     * Micro-vertex <tt>(i, j)</tt> has the barycentric coordinates
+     * <tt>(i / rate, j / rate)</tt>. The rows of micro-triangles between
+     * <tt>j</tt> and <tt>j + 1</tt> have their own bounding boxes.
+     */
+    struct Patch {
+        std::vector<float> positions;
+        std::vector<float> rows;
+
+        size_t size() const {
+            return sizeof(Patch) + (positions.size() + rows.size()) * sizeof(float);
+        }
+    };
+
+    /// Part of the micro-geometry cache with its own lock and LRU list
+    struct CacheShard {
+        using Entry = std::pair<std::shared_ptr<const Patch>, std::list<uint32_t>::iterator>;
+        std::mutex mutex;
+        std::list<uint32_t> lru;
+        std::unordered_map<uint32_t, Entry> entries;
+        size_t bytes = 0;
+    };
+
+    static constexpr uint32_t ShardCount = 64;
+
+public:
+    DisplacedMesh(const Properties &props) : Base(props) {
+        if constexpr (dr::is_jit_v<Float>)
+            Throw("The \"displace\" shape is only supported in scalar variants!");
+
+        for (auto &[name, obj] : props.objects(false)) {
+            Mesh *m = dynamic_cast<Mesh *>(obj.get());
+            if (!m)
+                continue;
+            if (m_mesh)
+                Throw("Only a single mesh can be specified per \"displace\" shape!");
+            m_mesh = m;
+            props.mark_queried(name);
+        }
+
+        if (!m_mesh)
+            Throw("A \"displace\" shape requires a nested triangle mesh!");
+        m_name = m_mesh->id();
+        if (!m_mesh->has_vertex_texcoords())
+            Throw("\"%s\": the base mesh of a \"displace\" shape must have "
+                  "texture coordinates!", m_name);
+        if (m_mesh->face_count() == 0)
+            Throw("\"%s\": the base mesh is empty!", m_name);
+
+        m_displacement = props.texture<Texture>("displacement");
+        m_scale  = props.get<ScalarFloat>("scale", 1.f);
+        m_offset = props.get<ScalarFloat>("offset", 0.f);
+        m_rate   = props.get<ScalarSize>("rate", 16);
+        if (m_rate == 0 || m_rate > 1024)
+            Throw("The \"rate\" parameter must be between 1 and 1024!");
+        m_cache_budget = (size_t) (props.get<ScalarFloat>("cache_size", 256.f) * 1024.f * 1024.f);
+        m_flip_normals = m_mesh->has_flipped_normals();
+        m_vertex_normals = m_mesh->has_vertex_normals() && !m_mesh->has_face_normals();
+
+        m_shards.reset(new CacheShard[ShardCount]);
+
+        if constexpr (!dr::is_jit_v<Float>)
+            build();
+
+        initialize();
+    }
+
+    // =============================================================
+    //! @{ \name Construction of the acceleration data structure
+    // =============================================================
+
+    void build() {
+        Timer timer;
+        ScalarSize count = m_mesh->face_count();
+
+        /* Evaluate the displacement once to compute tight bounds and the
+           surface area of every displaced base triangle */
+        m_bounds.resize(count * 6);
+        std::vector<ScalarFloat> areas(count);
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, count, 64),
+            [&](const dr::blocked_range<size_t> &range) {
+                std::vector<ScalarPoint3f> grid(vertex_count());
+                for (size_t t = range.begin(); t != range.end(); ++t) {
+                    BaseTriangle tri = base_triangle((uint32_t) t);
+                    tessellate(tri, grid.data());
+
+                    ScalarBoundingBox3f bbox;
+                    for (const ScalarPoint3f &p : grid)
+                        bbox.expand(p);
+                    dr::store(m_bounds.data() + 6 * t, ScalarVector3f(bbox.min));
+                    dr::store(m_bounds.data() + 6 * t + 3, ScalarVector3f(bbox.max));
+
+                    double area = 0.0;
+                    for_each_micro_triangle([&](uint32_t, uint32_t i0, uint32_t i1, uint32_t i2) {
+                        area += (double) dr::norm(dr::cross(grid[i1] - grid[i0],
+                                                            grid[i2] - grid[i0]));
+                    });
+                    areas[t] = (ScalarFloat) (area * .5);
+                }
+            }
+        );
+
+        m_area_pmf = DiscreteDistribution<Float>(areas.data(), areas.size());
+
+        build_bvh();
+
+        Log(Debug, "\"%s\": computed the displaced bounds of %u triangles "
+            "(%u micro-triangles each, took %s)", m_name, count,
+            m_rate * m_rate, util::time_string((float) timer.value()));
+    }
+
+    /// Build a bounding volume hierarchy over the Morton-ordered base triangles
+    void build_bvh() {
+        ScalarSize count = m_mesh->face_count();
+        m_order = PrimitiveBVH::morton_order(
+            count, [&](uint32_t i) { return triangle_bbox(i).center(); });
+        m_bvh.build(count, 2, [&](uint32_t i) { return triangle_bbox(m_order[i]); });
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Tessellation
+    // =============================================================
+
+    /// Number of micro-vertices per base triangle
+    uint32_t vertex_count() const { return (m_rate + 1) * (m_rate + 2) / 2; }
+
+    /// Index of micro-vertex <tt>(i, j)</tt>
+    MI_INLINE uint32_t vertex_index(uint32_t i, uint32_t j) const {
+        return j * (m_rate + 1) - j * (j - 1) / 2 + i;
+    }
+
+    /**
+     * \brief Invoke <tt>func(row, i0, i1, i2)</tt> for every micro-triangle
+     *
+     * Every row contains the upward-facing triangles <tt>(i, j), (i+1, j),
+     * (i, j+1)</tt> and the downward-facing ones <tt>(i+1, j+1), (i, j+1),
+     * (i+1, j)</tt>, which preserves the orientation of the base triangle.
+     */
+    template <typename Func> void for_each_micro_triangle(Func &&func) const {
+        for (uint32_t j = 0; j < m_rate; ++j)
+            for_each_micro_triangle_in_row(j, func);
+    }
+
+    template <typename Func>
+    MI_INLINE void for_each_micro_triangle_in_row(uint32_t j, Func &&func) const {
+        uint32_t n = m_rate - j;
+        for (uint32_t i = 0; i < n; ++i) {
+            func(j, vertex_index(i, j), vertex_index(i + 1, j), vertex_index(i, j + 1));
+            if (i + 1 < n)
+                func(j, vertex_index(i + 1, j + 1), vertex_index(i, j + 1),
+                     vertex_index(i + 1, j));
+        }
+    }
+
+    BaseTriangle base_triangle(uint32_t index) const {
+        BaseTriangle tri;
+        ScalarVector3u fi = m_mesh->face_indices(index);
+        for (int k = 0; k < 3; ++k) {
+            tri.p[k]  = m_mesh->vertex_position(fi[k]);
+            tri.uv[k] = m_mesh->vertex_texcoord(fi[k]);
+        }
+        if (m_vertex_normals) {
+            for (int k = 0; k < 3; ++k)
+                tri.n[k] = m_mesh->vertex_normal(fi[k]);
+        } else {
+            ScalarNormal3f n = dr::normalize(dr::cross(tri.p[1] - tri.p[0],
+                                                       tri.p[2] - tri.p[0]));
+            tri.n[0] = tri.n[1] = tri.n[2] = n;
+        }
+        return tri;
+    }
+
+    /// Texture coordinates of a point of a base triangle
+    MI_INLINE ScalarPoint2f base_uv(const BaseTriangle &tri, ScalarFloat b1,
+                                    ScalarFloat b2) const {
+        return dr::fmadd(tri.uv[0], 1.f - b1 - b2,
+                         dr::fmadd(tri.uv[1], b1, tri.uv[2] * b2));
+    }
+
+    /// Displaced position of a point of a base triangle
+    ScalarPoint3f displace(const BaseTriangle &tri, ScalarFloat b1, ScalarFloat b2) const {
+        ScalarFloat b0 = 1.f - b1 - b2;
+        ScalarPoint3f p = dr::fmadd(tri.p[0], b0, dr::fmadd(tri.p[1], b1, tri.p[2] * b2));
+        ScalarNormal3f n = dr::normalize(
+            dr::fmadd(tri.n[0], b0, dr::fmadd(tri.n[1], b1, tri.n[2] * b2)));
+
+        ScalarFloat h = 0.f;
+        if constexpr (!dr::is_jit_v<Float>) {
+            SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+            si.p  = p;
+            si.n  = n;
+            si.uv = base_uv(tri, b1, b2);
+            si.sh_frame.n = n;
+            h = m_displacement->eval_1(si);
+        }
+
+        return dr::fmadd(n, dr::fmadd(h, m_scale, m_offset), p);
+    }
+
+    /// Compute the displaced micro-vertices of a base triangle
+    void tessellate(const BaseTriangle &tri, ScalarPoint3f *out) const {
+        ScalarFloat inv_rate = 1.f / (ScalarFloat) m_rate;
+        for (uint32_t j = 0; j <= m_rate; ++j)
+            for (uint32_t i = 0; i + j <= m_rate; ++i)
+                out[vertex_index(i, j)] = displace(tri, i * inv_rate, j * inv_rate);
+    }
+
+    /// Return the tessellation of a base triangle, computing it if necessary
+    std::shared_ptr<const Patch> patch(uint32_t index) const {
+        CacheShard &shard = m_shards[index % ShardCount];
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.entries.find(index);
+            if (it != shard.entries.end()) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second.second);
+                m_cache_hits.fetch_add(1, std::memory_order_relaxed);
+                return it->second.first;
+            }
+        }
+
+        // Tessellate without holding the lock
+        std::shared_ptr<Patch> patch = std::make_shared<Patch>();
+        std::vector<ScalarPoint3f> grid(vertex_count());
+        tessellate(base_triangle(index), grid.data());
+
+        patch->positions.resize(grid.size() * 3);
+        for (size_t k = 0; k < grid.size(); ++k)
+            dr::store(patch->positions.data() + 3 * k, ScalarVector3f(grid[k]));
+
+        std::vector<ScalarBoundingBox3f> rows(m_rate);
+        for_each_micro_triangle([&](uint32_t row, uint32_t i0, uint32_t i1, uint32_t i2) {
+            rows[row].expand(grid[i0]);
+            rows[row].expand(grid[i1]);
+            rows[row].expand(grid[i2]);
+        });
+        patch->rows.resize(m_rate * 6);
+        for (uint32_t j = 0; j < m_rate; ++j) {
+            dr::store(patch->rows.data() + 6 * j, ScalarVector3f(rows[j].min));
+            dr::store(patch->rows.data() + 6 * j + 3, ScalarVector3f(rows[j].max));
+        }
+        m_cache_misses.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto [it, inserted] = shard.entries.try_emplace(index);
+        if (!inserted) // Another thread was faster
+            return it->second.first;
+
+        shard.lru.push_front(index);
+        it->second = { patch, shard.lru.begin() };
+        shard.bytes += patch->size();
+
+        // Evict the least recently used patches (the new one always stays)
+        size_t budget = m_cache_budget / ShardCount;
+        while (shard.bytes > budget && shard.lru.size() > 1) {
+            auto victim = shard.entries.find(shard.lru.back());
+            shard.bytes -= victim->second.first->size();
+            shard.entries.erase(victim);
+            shard.lru.pop_back();
+        }
+
+        return patch;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    /**
+     * \brief Intersect a ray with the micro-triangles of a base triangle
+     *
+     * Updates \c t and the barycentric coordinates \c b (with respect to the
+     * base triangle) when a closer intersection is found, and returns whether
+     * this was the case.
+     */
+    template <bool ShadowRay>
+    bool intersect_patch(uint32_t index, const ScalarRay3f &ray,
+                         const ScalarVector3f &d_rcp, ScalarFloat &t,
+                         ScalarPoint2f &b) const {
+        std::shared_ptr<const Patch> patch = this->patch(index);
+        const float *pos = patch->positions.data();
+        ScalarFloat inv_rate = 1.f / (ScalarFloat) m_rate;
+        bool found = false;
+
+        auto vertex = [pos](uint32_t k) {
+            return ScalarPoint3f(dr::load<dr::Array<float, 3>>(pos + 3 * k));
+        };
+
+        for (uint32_t j = 0; j < m_rate; ++j) {
+            if (!PrimitiveBVH::intersect_bbox(patch->rows.data() + 6 * j, ray, d_rcp, t))
+                continue;
+
+            uint32_t n = m_rate - j;
+            for (uint32_t i = 0; i < n; ++i) {
+                for (int down = 0; down < 2; ++down) {
+                    if (down && i + 1 == n)
+                        break;
+
+                    uint32_t i0, i1, i2;
+                    if (!down) {
+                        i0 = vertex_index(i, j);
+                        i1 = vertex_index(i + 1, j);
+                        i2 = vertex_index(i, j + 1);
+                    } else {
+                        i0 = vertex_index(i + 1, j + 1);
+                        i1 = vertex_index(i, j + 1);
+                        i2 = vertex_index(i + 1, j);
+                    }
+
+                    ScalarPoint3f p0 = vertex(i0);
+                    ScalarVector3f e1 = vertex(i1) - p0, e2 = vertex(i2) - p0;
+                    ScalarVector3f pvec = dr::cross(ray.d, e2);
+                    ScalarFloat inv_det = dr::rcp(dr::dot(e1, pvec));
+
+                    ScalarVector3f tvec = ray.o - p0;
+                    ScalarFloat u = dr::dot(tvec, pvec) * inv_det;
+                    if (!(u >= 0.f && u <= 1.f))
+                        continue;
+
+                    ScalarVector3f qvec = dr::cross(tvec, e1);
+                    ScalarFloat v = dr::dot(ray.d, qvec) * inv_det;
+                    if (!(v >= 0.f && u + v <= 1.f))
+                        continue;
+
+                    ScalarFloat tt = dr::dot(e2, qvec) * inv_det;
+                    if (!(tt >= 0.f && tt <= t))
+                        continue;
+
+                    t = tt;
+                    // Barycentric coordinates in the base triangle
+                    if (!down)
+                        b = ScalarPoint2f((i + u) * inv_rate, (j + v) * inv_rate);
+                    else
+                        b = ScalarPoint2f((i + 1 - u) * inv_rate, (j + 1 - v) * inv_rate);
+                    found = true;
+
+                    if constexpr (ShadowRay)
+                        return true;
+                }
+            }
+        }
+
+        return found;
+    }
+
+    /// Traverse the hierarchy, returns <tt>(t, b, base triangle)</tt>
+    template <bool ShadowRay>
+    std::tuple<ScalarFloat, ScalarPoint2f, ScalarIndex>
+    intersect_scalar(const ScalarRay3f &ray) const {
+        ScalarFloat t = dr::Infinity<ScalarFloat>;
+        ScalarPoint2f b(0.f);
+        ScalarIndex triangle = (ScalarIndex) -1;
+        ScalarVector3f d_rcp = dr::rcp(ray.d);
+
+        m_bvh.traverse(ray, [&](uint32_t index, ScalarFloat maxt) {
+            uint32_t tri = m_order[index];
+            if (!PrimitiveBVH::intersect_bbox(m_bounds.data() + 6 * tri, ray, d_rcp, maxt) ||
+                !intersect_patch<ShadowRay>(tri, ray, d_rcp, maxt, b))
+                return maxt;
+            t = maxt;
+            triangle = tri;
+            return ShadowRay ? -1.f : maxt;
+        });
+
+        return { t, b, triangle };
+    }
+
+    PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray,
+                                                        Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+        if constexpr (!dr::is_jit_v<Float>) {
+            ScalarIndex triangle;
+            std::tie(pi.t, pi.prim_uv, triangle) = intersect_scalar<false>(ray);
+            pi.prim_index = triangle;
+            pi.shape_index = (ScalarIndex) -1;
+            pi.t = dr::select(active, pi.t, dr::Infinity<Float>);
+            pi.shape = this;
+        } else {
+            DRJIT_MARK_USED(ray);
+            Throw("The \"displace\" shape is only supported in scalar variants!");
+        }
+        return pi;
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        if constexpr (!dr::is_jit_v<Float>) {
+            return active && std::get<2>(intersect_scalar<true>(ray)) != (ScalarIndex) -1;
+        } else {
+            DRJIT_MARK_USED(ray);
+            Throw("The \"displace\" shape is only supported in scalar variants!");
+        }
+    }
+
+    std::tuple<ScalarFloat, ScalarPoint2f, ScalarUInt32, ScalarUInt32>
+    ray_intersect_preliminary_scalar(const ScalarRay3f &ray) const override {
+        auto [t, b, triangle] = intersect_scalar<false>(ray);
+        return { t, b, (ScalarUInt32) -1, triangle };
+    }
+
+    ScalarMask ray_test_scalar(const ScalarRay3f &ray) const override {
+        return std::get<2>(intersect_scalar<true>(ray)) != (ScalarIndex) -1;
+    }
+
+    /**
+     * \brief Return the micro-triangle containing the given point of a base
+     * triangle along with the barycentric coordinates within it
+     */
+    std::tuple<ScalarPoint2f, ScalarPoint2f, ScalarPoint2f, ScalarPoint2f>
+    micro_triangle(const ScalarPoint2f &b) const {
+        ScalarFloat rate = (ScalarFloat) m_rate,
+                    x = dr::clamp(b.x() * rate, 0.f, rate),
+                    y = dr::clamp(b.y() * rate, 0.f, rate);
+        uint32_t j = std::min((uint32_t) y, m_rate - 1),
+                 i = std::min((uint32_t) x, m_rate - 1 - j);
+        ScalarFloat fx = x - i, fy = y - j;
+
+        // Grid coordinates of the vertices, and barycentric coordinates
+        if (fx + fy <= 1.f || i + 1 == m_rate - j)
+            return { ScalarPoint2f(i, j), ScalarPoint2f(i + 1, j),
+                     ScalarPoint2f(i, j + 1), ScalarPoint2f(fx, fy) };
+        else
+            return { ScalarPoint2f(i + 1, j + 1), ScalarPoint2f(i, j + 1),
+                     ScalarPoint2f(i + 1, j), ScalarPoint2f(1.f - fx, 1.f - fy) };
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     const PreliminaryIntersection3f &pi,
+                                                     uint32_t ray_flags,
+                                                     uint32_t recursion_depth,
+                                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        // Early exit when tracing isn't necessary
+        if (!this->m_is_instance && recursion_depth > 0)
+            return dr::zeros<SurfaceInteraction3f>();
+
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (!active)
+                return si;
+
+            BaseTriangle tri = base_triangle(pi.prim_index);
+            auto [g0, g1, g2, w] = micro_triangle(pi.prim_uv);
+
+            ScalarFloat inv_rate = 1.f / (ScalarFloat) m_rate;
+            g0 *= inv_rate; g1 *= inv_rate; g2 *= inv_rate;
+
+            Point3f p0 = displace(tri, g0.x(), g0.y()),
+                    p1 = displace(tri, g1.x(), g1.y()),
+                    p2 = displace(tri, g2.x(), g2.y());
+            Point2f uv0 = base_uv(tri, g0.x(), g0.y()),
+                    uv1 = base_uv(tri, g1.x(), g1.y()),
+                    uv2 = base_uv(tri, g2.x(), g2.y());
+
+            Float b1 = w.x(), b2 = w.y(), b0 = 1.f - b1 - b2;
+            Vector3f dp0 = p1 - p0, dp1 = p2 - p0;
+
+            si.p = dr::fmadd(p0, b0, dr::fmadd(p1, b1, p2 * b2));
+            si.t = pi.t;
+            si.n = dr::normalize(dr::cross(dp0, dp1));
+            si.uv = dr::fmadd(uv2, b2, dr::fmadd(uv1, b1, uv0 * b0));
+
+            std::tie(si.dp_du, si.dp_dv) = coordinate_system(si.n);
+            if (likely(has_flag(ray_flags, RayFlags::dPdUV))) {
+                Vector2f duv0 = uv1 - uv0, duv1 = uv2 - uv0;
+                Float det = dr::fmsub(duv0.x(), duv1.y(), duv0.y() * duv1.x());
+                if (det != 0.f) {
+                    Float inv_det = dr::rcp(det);
+                    si.dp_du = dr::fmsub( duv1.y(), dp0, duv0.y() * dp1) * inv_det;
+                    si.dp_dv = dr::fnmadd(duv1.x(), dp0, duv0.x() * dp1) * inv_det;
+                }
+            }
+
+            if (m_flip_normals)
+                si.n = -si.n;
+            si.sh_frame.n = si.n;
+
+            si.shape    = this;
+            si.instance = nullptr;
+
+            if (unlikely(has_flag(ray_flags, RayFlags::BoundaryTest)))
+                si.boundary_test = dr::abs(dr::dot(si.sh_frame.n, -ray.d));
+        } else {
+            DRJIT_MARK_USED(ray);
+            DRJIT_MARK_USED(pi);
+            DRJIT_MARK_USED(ray_flags);
+            Throw("The \"displace\" shape is only supported in scalar variants!");
+        }
+
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Sampling routines
+    // =============================================================
+
+    PositionSample3f sample_position(Float time, const Point2f &sample_,
+                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        PositionSample3f ps = dr::zeros<PositionSample3f>();
+
+        if constexpr (!dr::is_jit_v<Float>) {
+            Point2f sample = sample_;
+            ScalarIndex triangle;
+            std::tie(triangle, sample.y()) =
+                m_area_pmf.sample_reuse(sample.y(), active);
+
+            // Select a micro-triangle proportionally to its area
+            std::shared_ptr<const Patch> patch = this->patch(triangle);
+            const float *pos = patch->positions.data();
+            auto vertex = [pos](uint32_t k) {
+                return ScalarPoint3f(dr::load<dr::Array<float, 3>>(pos + 3 * k));
+            };
+
+            // The areas of the micro-triangles below are doubled
+            ScalarFloat target = sample.x() * m_area_pmf.eval_pmf(triangle) * 2.f,
+                        sum = 0.f, area = 0.f;
+            uint32_t k0 = 0, k1 = 0, k2 = 0;
+            bool done = false;
+            for_each_micro_triangle([&](uint32_t, uint32_t i0, uint32_t i1, uint32_t i2) {
+                if (done)
+                    return;
+                area = dr::norm(dr::cross(vertex(i1) - vertex(i0),
+                                          vertex(i2) - vertex(i0)));
+                k0 = i0; k1 = i1; k2 = i2;
+                if (sum + area >= target)
+                    done = true;
+                else
+                    sum += area;
+            });
+            sample.x() = area > 0.f ? dr::clamp((target - sum) / area, 0.f,
+                                                dr::OneMinusEpsilon<ScalarFloat>) : 0.f;
+
+            ScalarPoint3f p0 = vertex(k0), p1 = vertex(k1), p2 = vertex(k2);
+            ScalarVector3f e0 = p1 - p0, e1 = p2 - p0;
+            Point2f b = warp::square_to_uniform_triangle(sample);
+
+            ps.p     = dr::fmadd(e0, b.x(), dr::fmadd(e1, b.y(), p0));
+            ps.n     = dr::normalize(dr::cross(e0, e1));
+            ps.uv    = b;
+            ps.time  = time;
+            ps.pdf   = m_area_pmf.normalization();
+            ps.delta = false;
+
+            if (m_flip_normals)
+                ps.n = -ps.n;
+        } else {
+            DRJIT_MARK_USED(time);
+            DRJIT_MARK_USED(sample_);
+            Throw("The \"displace\" shape is only supported in scalar variants!");
+        }
+
+        return ps;
+    }
+
+    Float pdf_position(const PositionSample3f & /*ps*/, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        return m_area_pmf.normalization();
+    }
+
+    Float surface_area() const override { return m_area_pmf.sum(); }
+
+    //! @}
+    // =============================================================
+
+    ScalarBoundingBox3f bbox() const override { return m_bvh.bbox(); }
+
+    ScalarBoundingBox3f triangle_bbox(ScalarIndex index) const {
+        return ScalarBoundingBox3f(dr::load<ScalarPoint3f>(m_bounds.data() + 6 * index),
+                                   dr::load<ScalarPoint3f>(m_bounds.data() + 6 * index + 3));
+    }
+
+    ScalarSize effective_primitive_count() const override {
+        return m_mesh->face_count() * m_rate * m_rate;
+    }
+
+    /// Return the number of bytes used by the micro-geometry cache
+    size_t cache_bytes() const {
+        size_t result = 0;
+        for (uint32_t i = 0; i < ShardCount; ++i) {
+            std::lock_guard<std::mutex> lock(m_shards[i].mutex);
+            result += m_shards[i].bytes;
+        }
+        return result;
+    }
+
+#if defined(MI_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        if constexpr (!dr::is_jit_v<Float>) {
+            return EmbreeUserGeometry<DisplacedMesh>::create(device, this,
+                                                             m_mesh->face_count());
+        } else {
+            DRJIT_MARK_USED(device);
+            Throw("The \"displace\" shape is only supported in scalar variants!");
+        }
+    }
+
+    ScalarBoundingBox3f embree_bbox(uint32_t index) const {
+        return triangle_bbox(index);
+    }
+
+    template <bool ShadowRay>
+    bool embree_intersect(uint32_t index, const ScalarRay3f &ray,
+                          EmbreeUserHit &hit) const {
+        ScalarFloat t = ray.maxt;
+        ScalarPoint2f b;
+        if (!intersect_patch<ShadowRay>(index, ray, dr::rcp(ray.d), t, b))
+            return false;
+        hit.t = (float) t;
+        hit.u = (float) b.x();
+        hit.v = (float) b.y();
+        return true;
+    }
+#endif
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        callback->put_object("displacement", m_displacement.get(), +ParamFlags::NonDifferentiable);
+    }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "DisplacedMesh[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  bbox = " << string::indent(bbox()) << "," << std::endl
+            << "  triangle_count = " << m_mesh->face_count() << "," << std::endl
+            << "  rate = " << m_rate << "," << std::endl
+            << "  scale = " << m_scale << "," << std::endl
+            << "  offset = " << m_offset << "," << std::endl
+            << "  displacement = " << string::indent(m_displacement) << "," << std::endl
+            << "  cache_size = " << util::mem_string(cache_bytes()) << " / "
+            << util::mem_string(m_cache_budget) << "," << std::endl
+            << "  cache_hits = " << m_cache_hits.load() << "," << std::endl
+            << "  cache_misses = " << m_cache_misses.load() << "," << std::endl
+            << "  surface_area = " << m_area_pmf.sum() << "," << std::endl
+            << "  " << string::indent(this->get_children_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+private:
+    std::string m_name;
+    ref<Mesh> m_mesh;
+    ref<Texture> m_displacement;
+    ScalarFloat m_scale, m_offset;
+    ScalarSize m_rate;
+    bool m_flip_normals = false;
+    bool m_vertex_normals = false;
+
+    /// Bounds of the displaced base triangles (6 values per triangle)
+    std::vector<float> m_bounds;
+    /// Base triangles in the order of the BVH leaves
+    std::vector<uint32_t> m_order;
+    PrimitiveBVH m_bvh;
+    DiscreteDistribution<Float> m_area_pmf;
+
+    size_t m_cache_budget;
+    std::unique_ptr<CacheShard[]> m_shards;
+    mutable std::atomic<size_t> m_cache_hits { 0 }, m_cache_misses { 0 };
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(DisplacedMesh, Shape)
+MI_EXPORT_PLUGIN(DisplacedMesh, "Displaced triangle mesh");
+NAMESPACE_END(mitsuba)
@@ -6,6 +6,8 @@
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/render/bsdf.h>
 #include <mitsuba/render/shapegroup.h>
+#include <mitsuba/render/sensor.h>
+#include <mitsuba/render/film.h>
 
 #if defined(MI_ENABLE_EMBREE)
     #include <embree3/rtcore.h>
@@ -31,6 +33,12 @@ Instance (:monosp:`instance`)
    - Specifies a linear object-to-world transformation. (Default: none (i.e. object space = world space))
    - |exposed|, |differentiable|, |discontinuous|
 
+ * - lod_screen_size
+   - |string|
+   - Comma-separated list of projected sizes in pixels, in decreasing order, that select between
+     several levels of detail (see below). It must hold one value less than the number of shape
+     groups. (Default: none)
+
 This plugin implements a geometry instance used to efficiently replicate geometry many times. For
 details on how to create instances, refer to the :ref:`shape-shapegroup` plugin.
 
@@ -48,33 +56,86 @@ details on how to create instances, refer to the :ref:`shape-shapegroup` plugin.
     - Shape groups cannot be used to replicate shapes with attached emitters, sensors, or
       subsurface scattering models.
 
+Levels of detail
+****************
+
+An instance can reference several shape groups that represent the same asset with a varying
+amount of detail. They are ordered by their names (e.g. ``lod_0``, ``lod_1``, ...), starting with
+the most detailed one. When the scene is built, the instance estimates the diameter of its bounding
+box on the film of the first sensor of the scene, and selects the first level whose entry of
+``lod_screen_size`` is exceeded by this size, or the coarsest level otherwise. Only the selected
+level is referenced afterwards: the scene skips the acceleration data structures of shape groups
+that no instance selected and releases them.
+
+.. tabs::
+    .. code-tab:: python
+
+        'tree': {
+            'type': 'instance',
+            'lod_screen_size': '100, 10',
+            'lod_0': {'type': 'ref', 'id': 'tree_high'},
+            'lod_1': {'type': 'ref', 'id': 'tree_medium'},
+            'lod_2': {'type': 'ref', 'id': 'tree_low'}
+        }
+
+The selection happens once per scene, so it does not follow changes of the sensor or of
+``to_world`` afterwards.
+
  */
 
 template <typename Float, typename Spectrum>
 class Instance final: public Shape<Float, Spectrum> {
 public:
     MI_IMPORT_BASE(Shape, m_id, m_to_world, m_to_object, mark_dirty)
-    MI_IMPORT_TYPES(BSDF)
+    MI_IMPORT_TYPES(BSDF, Sensor)
 
     using typename Base::ScalarSize;
+    using typename Base::ScalarIndex;
     using ShapeGroup_ = ShapeGroup<Float, Spectrum>;
 
     Instance(const Properties &props) : Base(props) {
         for (auto &kv : props.objects()) {
             Base *shape = dynamic_cast<Base *>(kv.second.get());
-            if (shape && shape->is_shapegroup()) {
-                if (m_shapegroup)
-                    Throw("Only a single shapegroup can be specified per instance.");
-                m_shapegroup = (ShapeGroup_*) shape;
-            } else {
+            if (shape && shape->is_shapegroup())
+                m_lods.push_back((ShapeGroup_*) shape);
+            else
                 Throw("Only a shapegroup can be specified in an instance.");
-            }
         }
 
-        if (!m_shapegroup)
+        if (m_lods.empty())
             Throw("A reference to a 'shapegroup' must be specified!");
 
+        if (props.has_property("lod_screen_size")) {
+            for (const auto &s : string::tokenize(props.string("lod_screen_size"), " ,")) {
+                try {
+                    m_lod_screen_size.push_back(string::stof<ScalarFloat>(s));
+                } catch (...) {
+                    Throw("Could not parse floating point value '%s'", s);
+                }
+            }
+            for (size_t i = 1; i < m_lod_screen_size.size(); ++i) {
+                if (m_lod_screen_size[i] > m_lod_screen_size[i - 1])
+                    Throw("The values of 'lod_screen_size' must be in decreasing order!");
+            }
+        }
+
+        // Use the most detailed level until the scene selects one
+        m_shapegroup = m_lods[0];
+
+        if (m_lods.size() == 1 && m_lod_screen_size.empty()) {
+            m_shapegroup->add_instance_reference();
+            m_lods.clear();
+        } else if (m_lod_screen_size.size() + 1 != m_lods.size()) {
+            Throw("An instance with %zu levels of detail requires %zu values "
+                  "of 'lod_screen_size', found %zu!", m_lods.size(),
+                  m_lods.size() - 1, m_lod_screen_size.size());
+        } else {
+            for (auto &lod : m_lods)
+                lod->add_lod_candidate();
+        }
+
         dr::make_opaque(m_to_world, m_to_object);
+        update_bbox();
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -86,21 +147,60 @@ public:
             // Update the scalar value of the matrix
             m_to_world = m_to_world.value();
             m_to_object = m_to_world.value().inverse();
+            update_bbox();
             mark_dirty();
         }
         Base::parameters_changed();
     }
 
-    ScalarBoundingBox3f bbox() const override {
-        const ScalarBoundingBox3f &bbox = m_shapegroup->bbox();
+    void select_lod(const Sensor *sensor) override {
+        if (m_lods.empty())
+            return;
 
-        // If the shape group is empty, return the invalid bbox
-        if (!bbox.valid())
-            return bbox;
+        size_t level = 0;
+        if (sensor) {
+            ScalarFloat size = projected_size(sensor);
+            while (level < m_lod_screen_size.size() && size < m_lod_screen_size[level])
+                level++;
+        }
+
+        // Only keep a reference to the selected level
+        m_shapegroup = m_lods[level];
+        m_shapegroup->add_instance_reference();
+        m_lods.clear();
+        update_bbox();
+    }
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    /**
+     * The native acceleration data structures treat each instance as a single
+     * primitive and clip its bounds against their nodes. Bounding the clipped
+     * region in the object space of the shape group first yields tighter
+     * boxes for rotated instances, which reduces the number of nodes that
+     * reference an instance.
+     */
+    ScalarBoundingBox3f bbox(ScalarIndex /* index */,
+                             const ScalarBoundingBox3f &clip) const override {
+        const ScalarBoundingBox3f &group_bbox = m_shapegroup->bbox();
+
+        ScalarBoundingBox3f result = m_bbox;
+        result.clip(clip);
+        if (!result.valid() || !group_bbox.valid())
+            return result;
+
+        // Bounds of the clip box in object space
+        ScalarBoundingBox3f local;
+        for (int i = 0; i < 8; ++i)
+            local.expand(m_to_object.scalar() * result.corner(i));
+        local.clip(group_bbox);
+        if (!local.valid())
+            return ScalarBoundingBox3f();
 
-        ScalarBoundingBox3f result;
+        ScalarBoundingBox3f world;
         for (int i = 0; i < 8; ++i)
-            result.expand(m_to_world.scalar() * bbox.corner(i));
+            world.expand(m_to_world.scalar() * local.corner(i));
+        result.clip(world);
         return result;
     }
 
@@ -290,8 +390,60 @@ public:
     }
 
     MI_DECLARE_CLASS()
+private:
+    /// Cache the world-space bounds, which the native kd-tree queries repeatedly
+    void update_bbox() {
+        const ScalarBoundingBox3f &bbox = m_shapegroup->bbox();
+
+        // If the shape group is empty, keep the invalid bbox
+        m_bbox = ScalarBoundingBox3f();
+        if (!bbox.valid())
+            return;
+
+        for (int i = 0; i < 8; ++i)
+            m_bbox.expand(m_to_world.scalar() * bbox.corner(i));
+    }
+
+    /**
+     * Estimate the diameter in pixels of the bounding box of the instance on
+     * the film of a sensor, from the distance and angle between the primary
+     * rays of two neighboring pixels at the center of the film
+     */
+    ScalarFloat projected_size(const Sensor *sensor) const {
+        if (!m_bbox.valid())
+            return 0.f;
+
+        ScalarFloat width = (ScalarFloat) sensor->film()->crop_size().x();
+        auto [ray0, weight0] = sensor->sample_ray(0.f, .5f, Point2f(.5f), Point2f(.5f));
+        auto [ray1, weight1] = sensor->sample_ray(0.f, .5f, Point2f(.5f + 1.f / width, .5f),
+                                                  Point2f(.5f));
+        DRJIT_MARK_USED(weight0);
+        DRJIT_MARK_USED(weight1);
+
+        ScalarPoint3f o0 = dr::slice(dr::detach(ray0.o)),
+                      o1 = dr::slice(dr::detach(ray1.o));
+        ScalarVector3f d0 = dr::slice(dr::detach(ray0.d)),
+                       d1 = dr::slice(dr::detach(ray1.d));
+
+        ScalarFloat radius   = .5f * dr::norm(m_bbox.extents()),
+                    distance = dr::norm(m_bbox.center() - o0);
+
+        // The sensor lies within the bounding sphere of the instance
+        if (distance <= radius)
+            return dr::Infinity<ScalarFloat>;
+
+        ScalarFloat angle = dr::unit_angle(dr::normalize(d0), dr::normalize(d1)),
+                    pixel = dr::norm(o1 - o0) + distance * angle;
+
+        return pixel > 0.f ? 2.f * radius / pixel : dr::Infinity<ScalarFloat>;
+    }
+
 private:
    ref<ShapeGroup_> m_shapegroup;
+   /// Levels of detail that the instance can select from (until the selection)
+   std::vector<ref<ShapeGroup_>> m_lods;
+   std::vector<ScalarFloat> m_lod_screen_size;
+   ScalarBoundingBox3f m_bbox;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(Instance, Shape)
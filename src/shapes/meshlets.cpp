@@ -0,0 +1,835 @@
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/primitivebvh.h>
+#include <mitsuba/render/shape.h>
+#include <algorithm>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-meshlets:
+
+Compressed mesh (:monosp:`meshlets`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - max_triangles
+   - |int|
+   - Maximum number of triangles per cluster (Default: 128, at most 256)
+
+ * - (Nested plugin)
+   - |shape|
+   - The triangle mesh that should be compressed (e.g. a :ref:`ply <shape-ply>`
+     or :ref:`obj <shape-obj>` shape).
+
+This plugin stores a triangle mesh in a compressed form that requires 3-4x
+less memory than the regular mesh representation. The triangles are ordered
+along a space-filling curve and grouped into clusters of up to
+:monosp:`max_triangles` triangles that reference at most 256 vertices.
+Within a cluster, triangles are stored as three 8-bit local vertex indices.
+Vertex positions and texture coordinates are quantized to 16 bits relative
+to the corner of the cluster. Since all clusters share the same quantization
+grid, vertices that are referenced by multiple clusters decode to exactly the
+same position and the mesh remains watertight. Vertex normals are stored using
+an octahedral encoding with 16 bits per component.
+
+The geometry is decompressed on the fly during ray intersection and when
+computing surface interactions. The plugin builds a bounding volume hierarchy
+over the clusters for the native kd-tree, while the Embree backend sees every
+cluster as a user-defined primitive.
+
+The transformation of the nested mesh is applied before compression, and the
+BSDF, emitter, sensor and media must be attached to the :monosp:`meshlets`
+shape itself. This plugin is only supported by the scalar variants.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: meshlets
+
+        <shape type="meshlets">
+            <shape type="ply">
+                <string name="filename" value="scan.ply"/>
+            </shape>
+            <bsdf type="diffuse"/>
+        </shape>
+
+    .. code-tab:: python
+
+        'scan': {
+            'type': 'meshlets',
+            'mesh': {
+                'type': 'ply',
+                'filename': 'scan.ply'
+            },
+            'bsdf': {
+                'type': 'diffuse'
+            }
+        }
+ */
+
+template <typename Float, typename Spectrum>
+class MeshletShape final : public Shape<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Shape, m_is_instance, initialize, get_children_string)
+    MI_IMPORT_TYPES(Mesh)
+
+    using typename Base::ScalarSize;
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarRay3f;
+
+private:
+    using InputFloat    = float;
+    using InputPoint2f  = Point<InputFloat, 2>;
+    using InputPoint3f  = Point<InputFloat, 3>;
+    using InputNormal3f = Normal<InputFloat, 3>;
+
+    /// Compressed cluster of up to 256 triangles and 256 vertices
+    struct Cluster {
+        /// Position of the cluster's origin on the quantization grid
+        uint32_t origin[3] { 0, 0, 0 };
+        /// Texture coordinates of the origin on the quantization grid
+        uint32_t uv_origin[2] { 0, 0 };
+        /// Extent of the cluster on the quantization grid
+        uint16_t extent[3] { 0, 0, 0 };
+        /// Number of vertices and triangles
+        uint16_t vertex_count = 0, triangle_count = 0;
+        /// Offset of the first vertex and triangle
+        uint32_t vertex_offset = 0, triangle_offset = 0;
+    };
+
+public:
+    MeshletShape(const Properties &props) : Base(props) {
+        if constexpr (dr::is_jit_v<Float>)
+            Throw("The \"meshlets\" shape is only supported in scalar variants!");
+
+        m_max_triangles = props.get<ScalarSize>("max_triangles", 128);
+        if (m_max_triangles == 0 || m_max_triangles > 256)
+            Throw("The \"max_triangles\" parameter must be between 1 and 256!");
+
+        ref<Mesh> mesh;
+        for (auto &[name, obj] : props.objects(false)) {
+            Mesh *m = dynamic_cast<Mesh *>(obj.get());
+            if (!m)
+                continue;
+            if (mesh)
+                Throw("Only a single mesh can be specified per \"meshlets\" shape!");
+            mesh = m;
+            props.mark_queried(name);
+        }
+
+        if (!mesh)
+            Throw("A \"meshlets\" shape requires a nested triangle mesh!");
+
+        m_name = mesh->id();
+        m_flip_normals = mesh->has_flipped_normals();
+
+        if constexpr (!dr::is_jit_v<Float>)
+            build(mesh.get());
+
+        initialize();
+    }
+
+    // =============================================================
+    //! @{ \name Construction of the clusters
+    // =============================================================
+
+    void build(const Mesh *mesh) {
+        Timer timer;
+
+        size_t vertex_count = mesh->vertex_count(),
+               face_count   = mesh->face_count();
+
+        if (face_count == 0)
+            Throw("\"%s\": cannot compress an empty mesh!", m_name);
+
+        const InputFloat *positions = mesh->vertex_positions_buffer().data(),
+                         *normals   = nullptr,
+                         *texcoords = nullptr;
+        const ScalarIndex *faces = mesh->faces_buffer().data();
+
+        if (mesh->has_vertex_normals() && !mesh->has_face_normals())
+            normals = mesh->vertex_normals_buffer().data();
+        if (mesh->has_vertex_texcoords())
+            texcoords = mesh->vertex_texcoords_buffer().data();
+
+        auto position = [&](size_t i) {
+            return ScalarPoint3f(dr::load<InputPoint3f>(positions + 3 * i));
+        };
+
+        ScalarBoundingBox3f bbox = mesh->bbox();
+
+        // Sort the triangles along a Morton curve through their centroids
+        std::vector<uint32_t> order = PrimitiveBVH::morton_order(
+            (uint32_t) face_count, [&](uint32_t i) {
+                const ScalarIndex *fi = faces + 3 * i;
+                return (position(fi[0]) + position(fi[1]) + position(fi[2])) *
+                       (1.f / 3.f);
+            });
+
+        /* Greedily group consecutive triangles into clusters that reference
+           at most 256 vertices. The global index of every cluster vertex is
+           recorded in 'cluster_vertices'. */
+        std::vector<uint32_t> stamp(vertex_count, (uint32_t) -1),
+                              local(vertex_count), cluster_vertices;
+        m_triangles.reserve(face_count * 3);
+        cluster_vertices.reserve(vertex_count + vertex_count / 2);
+
+        Cluster cluster;
+        auto finish_cluster = [&]() {
+            if (cluster.triangle_count > 0)
+                m_clusters.push_back(cluster);
+            cluster = Cluster();
+            cluster.vertex_offset   = (uint32_t) cluster_vertices.size();
+            cluster.triangle_offset = (uint32_t) (m_triangles.size() / 3);
+        };
+        finish_cluster();
+
+        for (size_t k = 0; k < face_count; ++k) {
+            const ScalarIndex *fi = faces + 3 * order[k];
+            uint32_t id = (uint32_t) m_clusters.size();
+
+            uint32_t new_vertices = 0;
+            for (int j = 0; j < 3; ++j)
+                new_vertices += stamp[fi[j]] != id &&
+                                (j < 1 || fi[j] != fi[0]) &&
+                                (j < 2 || fi[j] != fi[1]);
+
+            if (cluster.triangle_count == m_max_triangles ||
+                cluster.vertex_count + new_vertices > 256) {
+                finish_cluster();
+                id = (uint32_t) m_clusters.size();
+            }
+
+            for (int j = 0; j < 3; ++j) {
+                if (stamp[fi[j]] != id) {
+                    stamp[fi[j]] = id;
+                    local[fi[j]] = cluster.vertex_count++;
+                    cluster_vertices.push_back(fi[j]);
+                }
+                m_triangles.push_back((uint8_t) local[fi[j]]);
+            }
+            cluster.triangle_count++;
+        }
+        finish_cluster();
+
+        stamp = std::vector<uint32_t>();
+        local = std::vector<uint32_t>();
+        order = std::vector<uint32_t>();
+
+        size_t cluster_count = m_clusters.size();
+        m_triangle_count = (ScalarSize) face_count;
+
+        /* The quantization grid is shared by all clusters: its resolution is
+           chosen so that the largest cluster spans 65535 steps along every
+           axis. */
+        ScalarVector3f max_extent(0.f);
+        ScalarVector2f max_uv_extent(0.f), uv_min(dr::Infinity<ScalarFloat>);
+        for (const Cluster &c : m_clusters) {
+            ScalarBoundingBox3f cb;
+            ScalarPoint2f uv_lo(dr::Infinity<ScalarFloat>),
+                          uv_hi(-dr::Infinity<ScalarFloat>);
+            for (uint32_t j = 0; j < c.vertex_count; ++j) {
+                uint32_t v = cluster_vertices[c.vertex_offset + j];
+                cb.expand(position(v));
+                if (texcoords) {
+                    ScalarPoint2f uv = dr::load<InputPoint2f>(texcoords + 2 * v);
+                    uv_lo = dr::minimum(uv_lo, uv);
+                    uv_hi = dr::maximum(uv_hi, uv);
+                }
+            }
+            max_extent = dr::maximum(max_extent, cb.extents());
+            if (texcoords) {
+                max_uv_extent = dr::maximum(max_uv_extent, uv_hi - uv_lo);
+                uv_min = dr::minimum(uv_min, uv_lo);
+            }
+        }
+
+        m_position_min  = bbox.min;
+        m_position_step = quantization_step(max_extent);
+
+        m_has_normals   = normals != nullptr;
+        m_has_texcoords = texcoords != nullptr;
+        if (m_has_texcoords) {
+            m_uv_min  = uv_min;
+            m_uv_step = quantization_step(max_uv_extent);
+        }
+
+        size_t stored_vertices = cluster_vertices.size();
+        m_positions.resize(stored_vertices * 3);
+        if (m_has_normals)
+            m_normals.resize(stored_vertices);
+        if (m_has_texcoords)
+            m_texcoords.resize(stored_vertices * 2);
+
+        for (Cluster &c : m_clusters) {
+            std::vector<ScalarVector3u> q(c.vertex_count);
+            std::vector<ScalarPoint2u> q_uv(m_has_texcoords ? c.vertex_count : 0);
+
+            ScalarVector3u lo((uint32_t) -1), hi(0u);
+            ScalarPoint2u uv_lo((uint32_t) -1);
+            for (uint32_t j = 0; j < c.vertex_count; ++j) {
+                uint32_t v = cluster_vertices[c.vertex_offset + j];
+                q[j] = quantize(position(v), m_position_min, m_position_step);
+                lo = dr::minimum(lo, q[j]);
+                hi = dr::maximum(hi, q[j]);
+
+                if (m_has_texcoords) {
+                    ScalarPoint2f uv = dr::load<InputPoint2f>(texcoords + 2 * v);
+                    q_uv[j] = quantize(uv, m_uv_min, m_uv_step);
+                    uv_lo = dr::minimum(uv_lo, q_uv[j]);
+                }
+
+                if (m_has_normals)
+                    m_normals[c.vertex_offset + j] = encode_normal(
+                        ScalarVector3f(dr::load<InputNormal3f>(normals + 3 * v)));
+            }
+
+            for (int a = 0; a < 3; ++a) {
+                c.origin[a] = lo[a];
+                c.extent[a] = (uint16_t) std::min<uint32_t>(hi[a] - lo[a], 65535u);
+            }
+            if (m_has_texcoords) {
+                c.uv_origin[0] = uv_lo[0];
+                c.uv_origin[1] = uv_lo[1];
+            }
+
+            for (uint32_t j = 0; j < c.vertex_count; ++j) {
+                uint16_t *pos = m_positions.data() + 3 * (c.vertex_offset + j);
+                for (int a = 0; a < 3; ++a)
+                    pos[a] = (uint16_t) std::min<uint32_t>(q[j][a] - lo[a], 65535u);
+                if (m_has_texcoords) {
+                    uint16_t *uv = m_texcoords.data() + 2 * (c.vertex_offset + j);
+                    for (int a = 0; a < 2; ++a)
+                        uv[a] = (uint16_t) std::min<uint32_t>(q_uv[j][a] - uv_lo[a], 65535u);
+                }
+            }
+        }
+
+        // The clusters are already in Morton order
+        m_bvh.build((uint32_t) m_clusters.size(), 2,
+                    [&](uint32_t i) { return cluster_bbox(i); });
+
+        // Surface area of the decompressed triangles
+        double area = 0.0;
+        for (ScalarSize i = 0; i < m_triangle_count; ++i)
+            area += (double) triangle_area(i);
+        m_surface_area = (ScalarFloat) area;
+        m_inv_surface_area = (ScalarFloat) (1.0 / area);
+
+        size_t original = vertex_count * (3 + (normals ? 3 : 0) + (texcoords ? 2 : 0)) *
+                              sizeof(InputFloat) + face_count * 3 * sizeof(ScalarIndex);
+        Log(Debug, "\"%s\": compressed %zu triangles into %zu clusters (%s -> %s, took %s)",
+            m_name, face_count, cluster_count, util::mem_string(original),
+            util::mem_string(compressed_size()), util::time_string((float) timer.value()));
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Decompression
+    // =============================================================
+
+    /// Return the cluster containing the given triangle
+    uint32_t find_cluster(ScalarIndex triangle) const {
+        auto it = std::upper_bound(
+            m_clusters.begin(), m_clusters.end(), triangle,
+            [](ScalarIndex t, const Cluster &c) { return t < c.triangle_offset; });
+        return (uint32_t) (it - m_clusters.begin()) - 1;
+    }
+
+    /// Decode the position of a vertex of a cluster
+    MI_INLINE ScalarPoint3f vertex_position(const Cluster &c, uint32_t j) const {
+        const uint16_t *q = m_positions.data() + 3 * (c.vertex_offset + j);
+        ScalarVector3f grid((ScalarFloat) (c.origin[0] + q[0]),
+                            (ScalarFloat) (c.origin[1] + q[1]),
+                            (ScalarFloat) (c.origin[2] + q[2]));
+        return dr::fmadd(grid, m_position_step, m_position_min);
+    }
+
+    /// Decode the texture coordinates of a vertex of a cluster
+    MI_INLINE ScalarPoint2f vertex_texcoord(const Cluster &c, uint32_t j) const {
+        const uint16_t *q = m_texcoords.data() + 2 * (c.vertex_offset + j);
+        ScalarVector2f grid((ScalarFloat) (c.uv_origin[0] + q[0]),
+                            (ScalarFloat) (c.uv_origin[1] + q[1]));
+        return dr::fmadd(grid, m_uv_step, m_uv_min);
+    }
+
+    /// Decode the normal of a vertex of a cluster
+    MI_INLINE ScalarNormal3f vertex_normal(const Cluster &c, uint32_t j) const {
+        return decode_normal(m_normals[c.vertex_offset + j]);
+    }
+
+    /// Return the local vertex indices of triangle \c k of a cluster
+    MI_INLINE const uint8_t *triangle_indices(const Cluster &c, uint32_t k) const {
+        return m_triangles.data() + 3 * (c.triangle_offset + k);
+    }
+
+    /// Bounding box of a cluster (encloses its decoded vertices)
+    ScalarBoundingBox3f cluster_bbox(uint32_t index) const {
+        const Cluster &c = m_clusters[index];
+        ScalarVector3f lo((ScalarFloat) c.origin[0], (ScalarFloat) c.origin[1],
+                          (ScalarFloat) c.origin[2]),
+                       hi((ScalarFloat) (c.origin[0] + c.extent[0]),
+                          (ScalarFloat) (c.origin[1] + c.extent[1]),
+                          (ScalarFloat) (c.origin[2] + c.extent[2]));
+        return ScalarBoundingBox3f(dr::fmadd(lo, m_position_step, m_position_min),
+                                   dr::fmadd(hi, m_position_step, m_position_min));
+    }
+
+    ScalarFloat triangle_area(ScalarIndex triangle) const {
+        const Cluster &c = m_clusters[find_cluster(triangle)];
+        const uint8_t *fi = triangle_indices(c, triangle - c.triangle_offset);
+        ScalarPoint3f p0 = vertex_position(c, fi[0]),
+                      p1 = vertex_position(c, fi[1]),
+                      p2 = vertex_position(c, fi[2]);
+        return .5f * dr::norm(dr::cross(p1 - p0, p2 - p0));
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    /**
+     * \brief Intersect a ray with the triangles of a cluster
+     *
+     * Updates \c t, \c uv and \c triangle when a closer intersection is
+     * found, and returns whether this was the case.
+     */
+    template <bool ShadowRay>
+    bool intersect_cluster(uint32_t index, const ScalarRay3f &ray, ScalarFloat &t,
+                           ScalarPoint2f &uv, ScalarIndex &triangle) const {
+        const Cluster &c = m_clusters[index];
+        bool found = false;
+
+        for (uint32_t k = 0; k < c.triangle_count; ++k) {
+            const uint8_t *fi = triangle_indices(c, k);
+            ScalarPoint3f p0 = vertex_position(c, fi[0]),
+                          p1 = vertex_position(c, fi[1]),
+                          p2 = vertex_position(c, fi[2]);
+
+            ScalarVector3f e1 = p1 - p0, e2 = p2 - p0;
+            ScalarVector3f pvec = dr::cross(ray.d, e2);
+            ScalarFloat inv_det = dr::rcp(dr::dot(e1, pvec));
+
+            ScalarVector3f tvec = ray.o - p0;
+            ScalarFloat u = dr::dot(tvec, pvec) * inv_det;
+            if (!(u >= 0.f && u <= 1.f))
+                continue;
+
+            ScalarVector3f qvec = dr::cross(tvec, e1);
+            ScalarFloat v = dr::dot(ray.d, qvec) * inv_det;
+            if (!(v >= 0.f && u + v <= 1.f))
+                continue;
+
+            ScalarFloat tt = dr::dot(e2, qvec) * inv_det;
+            if (!(tt >= 0.f && tt <= t))
+                continue;
+
+            t = tt;
+            uv = ScalarPoint2f(u, v);
+            triangle = c.triangle_offset + k;
+            found = true;
+
+            if constexpr (ShadowRay)
+                break;
+        }
+
+        return found;
+    }
+
+    /// Traverse the cluster hierarchy, returns <tt>(t, uv, triangle)</tt>
+    template <bool ShadowRay>
+    std::tuple<ScalarFloat, ScalarPoint2f, ScalarIndex>
+    intersect_scalar(const ScalarRay3f &ray) const {
+        ScalarFloat t = dr::Infinity<ScalarFloat>;
+        ScalarPoint2f uv(0.f);
+        ScalarIndex triangle = (ScalarIndex) -1;
+
+        m_bvh.traverse(ray, [&](uint32_t index, ScalarFloat maxt) {
+            if (!intersect_cluster<ShadowRay>(index, ray, maxt, uv, triangle))
+                return maxt;
+            t = maxt;
+            return ShadowRay ? -1.f : maxt;
+        });
+
+        return { t, uv, triangle };
+    }
+
+    PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray,
+                                                        Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+        if constexpr (!dr::is_jit_v<Float>) {
+            ScalarIndex triangle;
+            std::tie(pi.t, pi.prim_uv, triangle) = intersect_scalar<false>(ray);
+            pi.prim_index = triangle;
+            pi.shape_index = (ScalarIndex) -1;
+            pi.t = dr::select(active, pi.t, dr::Infinity<Float>);
+            pi.shape = this;
+        } else {
+            DRJIT_MARK_USED(ray);
+            Throw("The \"meshlets\" shape is only supported in scalar variants!");
+        }
+        return pi;
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        if constexpr (!dr::is_jit_v<Float>) {
+            return active && std::get<2>(intersect_scalar<true>(ray)) != (ScalarIndex) -1;
+        } else {
+            DRJIT_MARK_USED(ray);
+            Throw("The \"meshlets\" shape is only supported in scalar variants!");
+        }
+    }
+
+    std::tuple<ScalarFloat, ScalarPoint2f, ScalarUInt32, ScalarUInt32>
+    ray_intersect_preliminary_scalar(const ScalarRay3f &ray) const override {
+        auto [t, uv, triangle] = intersect_scalar<false>(ray);
+        return { t, uv, (ScalarUInt32) -1, triangle };
+    }
+
+    ScalarMask ray_test_scalar(const ScalarRay3f &ray) const override {
+        return std::get<2>(intersect_scalar<true>(ray)) != (ScalarIndex) -1;
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     const PreliminaryIntersection3f &pi,
+                                                     uint32_t ray_flags,
+                                                     uint32_t recursion_depth,
+                                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        // Early exit when tracing isn't necessary
+        if (!m_is_instance && recursion_depth > 0)
+            return dr::zeros<SurfaceInteraction3f>();
+
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (!active)
+                return si;
+
+            const Cluster &c = m_clusters[find_cluster(pi.prim_index)];
+            const uint8_t *fi = triangle_indices(c, pi.prim_index - c.triangle_offset);
+
+            Point3f p0 = vertex_position(c, fi[0]),
+                    p1 = vertex_position(c, fi[1]),
+                    p2 = vertex_position(c, fi[2]);
+
+            Float b1 = pi.prim_uv.x(),
+                  b2 = pi.prim_uv.y(),
+                  b0 = 1.f - b1 - b2;
+
+            Vector3f dp0 = p1 - p0,
+                     dp1 = p2 - p0;
+
+            // Re-interpolate intersection using barycentric coordinates
+            si.p = dr::fmadd(p0, b0, dr::fmadd(p1, b1, p2 * b2));
+            si.t = pi.t;
+
+            // Face normal
+            si.n = dr::normalize(dr::cross(dp0, dp1));
+
+            si.uv = Point2f(b1, b2);
+            std::tie(si.dp_du, si.dp_dv) = coordinate_system(si.n);
+
+            if (m_has_texcoords &&
+                likely(has_flag(ray_flags, RayFlags::UV) ||
+                       has_flag(ray_flags, RayFlags::dPdUV))) {
+                Point2f uv0 = vertex_texcoord(c, fi[0]),
+                        uv1 = vertex_texcoord(c, fi[1]),
+                        uv2 = vertex_texcoord(c, fi[2]);
+
+                si.uv = dr::fmadd(uv2, b2, dr::fmadd(uv1, b1, uv0 * b0));
+
+                if (likely(has_flag(ray_flags, RayFlags::dPdUV))) {
+                    Vector2f duv0 = uv1 - uv0,
+                             duv1 = uv2 - uv0;
+
+                    Float det = dr::fmsub(duv0.x(), duv1.y(), duv0.y() * duv1.x());
+                    if (det != 0.f) {
+                        Float inv_det = dr::rcp(det);
+                        si.dp_du = dr::fmsub( duv1.y(), dp0, duv0.y() * dp1) * inv_det;
+                        si.dp_dv = dr::fnmadd(duv1.x(), dp0, duv0.x() * dp1) * inv_det;
+                    }
+                }
+            }
+
+            if (m_has_normals &&
+                likely(has_flag(ray_flags, RayFlags::ShadingFrame) ||
+                       has_flag(ray_flags, RayFlags::dNSdUV))) {
+                Normal3f n0 = vertex_normal(c, fi[0]),
+                         n1 = vertex_normal(c, fi[1]),
+                         n2 = vertex_normal(c, fi[2]);
+
+                Normal3f n = dr::fmadd(n2, b2, dr::fmadd(n1, b1, n0 * b0));
+                Float il = dr::rsqrt(dr::squared_norm(n));
+                n *= il;
+
+                si.sh_frame.n = n;
+
+                if (has_flag(ray_flags, RayFlags::dNSdUV)) {
+                    si.dn_du = (n1 - n0) * il;
+                    si.dn_dv = (n2 - n0) * il;
+
+                    si.dn_du = dr::fnmadd(n, dr::dot(n, si.dn_du), si.dn_du);
+                    si.dn_dv = dr::fnmadd(n, dr::dot(n, si.dn_dv), si.dn_dv);
+                }
+            } else {
+                si.sh_frame.n = si.n;
+            }
+
+            if (m_flip_normals) {
+                si.n = -si.n;
+                si.sh_frame.n = -si.sh_frame.n;
+            }
+
+            si.shape    = this;
+            si.instance = nullptr;
+
+            if (unlikely(has_flag(ray_flags, RayFlags::BoundaryTest)))
+                si.boundary_test = dr::abs(dr::dot(si.sh_frame.n, -ray.d));
+        } else {
+            DRJIT_MARK_USED(ray);
+            DRJIT_MARK_USED(pi);
+            DRJIT_MARK_USED(ray_flags);
+            Throw("The \"meshlets\" shape is only supported in scalar variants!");
+        }
+
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Sampling routines
+    // =============================================================
+
+    PositionSample3f sample_position(Float time, const Point2f &sample_,
+                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        PositionSample3f ps = dr::zeros<PositionSample3f>();
+
+        if constexpr (!dr::is_jit_v<Float>) {
+            ensure_pmf_built();
+
+            Point2f sample = sample_;
+            ScalarIndex triangle;
+            std::tie(triangle, sample.y()) =
+                m_area_pmf.sample_reuse(sample.y(), active);
+
+            const Cluster &c = m_clusters[find_cluster(triangle)];
+            const uint8_t *fi = triangle_indices(c, triangle - c.triangle_offset);
+
+            Point3f p0 = vertex_position(c, fi[0]),
+                    p1 = vertex_position(c, fi[1]),
+                    p2 = vertex_position(c, fi[2]);
+
+            Vector3f e0 = p1 - p0, e1 = p2 - p0;
+            Point2f b = warp::square_to_uniform_triangle(sample);
+            Float b0 = 1.f - b.x() - b.y();
+
+            ps.p     = dr::fmadd(e0, b.x(), dr::fmadd(e1, b.y(), p0));
+            ps.time  = time;
+            ps.pdf   = m_area_pmf.normalization();
+            ps.delta = false;
+
+            if (m_has_texcoords)
+                ps.uv = dr::fmadd(vertex_texcoord(c, fi[0]), b0,
+                                  dr::fmadd(vertex_texcoord(c, fi[1]), b.x(),
+                                            vertex_texcoord(c, fi[2]) * b.y()));
+            else
+                ps.uv = b;
+
+            if (m_has_normals)
+                ps.n = dr::fmadd(vertex_normal(c, fi[0]), b0,
+                                 dr::fmadd(vertex_normal(c, fi[1]), b.x(),
+                                           vertex_normal(c, fi[2]) * b.y()));
+            else
+                ps.n = dr::cross(e0, e1);
+
+            ps.n = dr::normalize(ps.n);
+            if (m_flip_normals)
+                ps.n = -ps.n;
+        } else {
+            DRJIT_MARK_USED(time);
+            DRJIT_MARK_USED(sample_);
+            Throw("The \"meshlets\" shape is only supported in scalar variants!");
+        }
+
+        return ps;
+    }
+
+    Float pdf_position(const PositionSample3f & /*ps*/, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        ensure_pmf_built();
+        return m_area_pmf.normalization();
+    }
+
+    Float surface_area() const override { return m_surface_area; }
+
+    //! @}
+    // =============================================================
+
+    ScalarBoundingBox3f bbox() const override { return m_bvh.bbox(); }
+
+    ScalarSize effective_primitive_count() const override {
+        return m_triangle_count;
+    }
+
+    /// Total size of the compressed representation in bytes
+    size_t compressed_size() const {
+        return m_clusters.size() * sizeof(Cluster) + m_bvh.memory_footprint() +
+               m_positions.size() * sizeof(uint16_t) +
+               m_normals.size() * sizeof(uint32_t) +
+               m_texcoords.size() * sizeof(uint16_t) + m_triangles.size();
+    }
+
+#if defined(MI_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        if constexpr (!dr::is_jit_v<Float>) {
+            return EmbreeUserGeometry<MeshletShape>::create(
+                device, this, (uint32_t) m_clusters.size());
+        } else {
+            DRJIT_MARK_USED(device);
+            Throw("The \"meshlets\" shape is only supported in scalar variants!");
+        }
+    }
+
+    ScalarBoundingBox3f embree_bbox(uint32_t index) const {
+        return cluster_bbox(index);
+    }
+
+    template <bool ShadowRay>
+    bool embree_intersect(uint32_t index, const ScalarRay3f &ray,
+                          EmbreeUserHit &hit) const {
+        ScalarFloat t = ray.maxt;
+        ScalarPoint2f uv;
+        ScalarIndex triangle;
+        if (!intersect_cluster<ShadowRay>(index, ray, t, uv, triangle))
+            return false;
+        hit.t       = (float) t;
+        hit.u       = (float) uv.x();
+        hit.v       = (float) uv.y();
+        hit.prim_id = triangle;
+        return true;
+    }
+#endif
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "MeshletShape[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  bbox = " << string::indent(bbox()) << "," << std::endl
+            << "  triangle_count = " << m_triangle_count << "," << std::endl
+            << "  cluster_count = " << m_clusters.size() << "," << std::endl
+            << "  max_triangles = " << m_max_triangles << "," << std::endl
+            << "  vertex_normals = " << m_has_normals << "," << std::endl
+            << "  vertex_texcoords = " << m_has_texcoords << "," << std::endl
+            << "  storage = " << util::mem_string(compressed_size()) << "," << std::endl
+            << "  surface_area = " << m_surface_area << "," << std::endl
+            << "  " << string::indent(get_children_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+private:
+    /// Step of a quantization grid on which the given extent spans 65534 steps
+    template <typename Vector>
+    static Vector quantization_step(const Vector &extent) {
+        Vector step = extent * (1.f / 65534.f);
+        return dr::select(step > 0.f, step, Vector(1.f));
+    }
+
+    template <typename Point, typename Vector>
+    static auto quantize(const Point &p, const Point &min, const Vector &step) {
+        Vector q = dr::round((p - min) / step);
+        return dr::Array<uint32_t, Point::Size>(dr::maximum(q, 0.f));
+    }
+
+    /// Octahedral normal encoding with two 16-bit components
+    static uint32_t encode_normal(ScalarVector3f n) {
+        n /= dr::abs(n.x()) + dr::abs(n.y()) + dr::abs(n.z());
+        ScalarFloat x = n.x(), y = n.y();
+        if (n.z() < 0.f) {
+            x = (1.f - dr::abs(n.y())) * (n.x() >= 0.f ? 1.f : -1.f);
+            y = (1.f - dr::abs(n.x())) * (n.y() >= 0.f ? 1.f : -1.f);
+        }
+        auto pack = [](ScalarFloat v) {
+            return (uint32_t) (uint16_t) (int16_t) dr::round(dr::clamp(v, -1.f, 1.f) * 32767.f);
+        };
+        return pack(x) | (pack(y) << 16);
+    }
+
+    static ScalarNormal3f decode_normal(uint32_t value) {
+        ScalarFloat x = (int16_t) (value & 0xFFFF) * (1.f / 32767.f),
+                    y = (int16_t) (value >> 16) * (1.f / 32767.f),
+                    z = 1.f - dr::abs(x) - dr::abs(y);
+        if (z < 0.f) {
+            ScalarFloat x2 = (1.f - dr::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+            y = (1.f - dr::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+            x = x2;
+        }
+        return dr::normalize(ScalarNormal3f(x, y, z));
+    }
+
+    void ensure_pmf_built() const {
+        if (unlikely(m_area_pmf.empty())) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_area_pmf.empty()) {
+                std::vector<ScalarFloat> table(m_triangle_count);
+                for (ScalarSize i = 0; i < m_triangle_count; ++i)
+                    table[i] = triangle_area(i);
+                m_area_pmf = DiscreteDistribution<Float>(table.data(), table.size());
+            }
+        }
+    }
+
+private:
+    std::string m_name;
+    ScalarSize m_max_triangles;
+    ScalarSize m_triangle_count = 0;
+    bool m_flip_normals = false;
+    bool m_has_normals = false;
+    bool m_has_texcoords = false;
+
+    std::vector<Cluster> m_clusters;
+    PrimitiveBVH m_bvh;
+
+    /// Quantized positions (3 per vertex) and texture coordinates (2 per vertex)
+    std::vector<uint16_t> m_positions, m_texcoords;
+    /// Octahedral normals
+    std::vector<uint32_t> m_normals;
+    /// Local vertex indices (3 per triangle)
+    std::vector<uint8_t> m_triangles;
+
+    ScalarPoint3f m_position_min;
+    ScalarVector3f m_position_step;
+    ScalarPoint2f m_uv_min;
+    ScalarVector2f m_uv_step;
+
+    ScalarFloat m_surface_area = 0.f;
+    ScalarFloat m_inv_surface_area = 0.f;
+    mutable DiscreteDistribution<Float> m_area_pmf;
+    mutable std::mutex m_mutex;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(MeshletShape, Shape)
+MI_EXPORT_PLUGIN(MeshletShape, "Compressed triangle mesh");
+NAMESPACE_END(mitsuba)
@@ -8,6 +8,7 @@
 #include <mitsuba/core/profiler.h>
 
 #include <array>
+#include <atomic>
 
 
 NAMESPACE_BEGIN(mitsuba)
@@ -41,11 +42,51 @@ Wavefront OBJ mesh loader (:monosp:`obj`)
    - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
      the normals point outside)
 
+ * - cache
+   - |bool|
+   - When set to |true|, the loaded mesh is stored in a binary cache file
+     next to the source file, which is memory-mapped instead of parsing the
+     source file on subsequent runs. The cache is keyed by the file contents
+     and the loading parameters. (Default: |false|, unless a node-local shared
+     asset directory is set)
+
+ * - cache_dir
+   - |string|
+   - Directory of the binary mesh cache. Implies ``cache``. (Default: the
+     shared asset directory set via ``MI_SHARED_ASSET_DIR`` or
+     ``mi.AssetCache.set_shared_directory()``, and otherwise the directory of
+     the source file)
+
+ * - out_of_core
+   - |bool|
+   - When set to |true|, the vertex, face, and attribute buffers are moved
+     into a memory-mapped file after loading, which allows the operating
+     system to page the geometry in on demand. Only supported in scalar
+     variants. (Default: |false|)
+
+ * - out_of_core_file
+   - |string|
+   - Location of the memory-mapped file used by ``out_of_core``. Implies
+     ``out_of_core``. (Default: a temporary file)
+
+ * - attribute_storage
+   - |string|
+   - Storage precision of the vertex and face attributes: ``float``,
+     ``half``, ``unorm8``, or ``unorm8_srgb``. Reduced precisions decode
+     attributes when they are evaluated and make them read-only in
+     :py:func:`mitsuba.traverse`. (Default: ``float``)
+
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
      (Default: none, i.e. object space = world space)
 
+ * - to_world_end
+   - |transform|
+   - Object-to-world transformation at time 1. When specified, the vertices move linearly
+     from their position given by ``to_world`` at time 0 to this one, which produces motion
+     blur with a sensor whose shutter is open during this interval. (Default: none, i.e. static)
+
  * - vertex_count
    - |int|
    - Total number of vertices
@@ -66,6 +107,12 @@ Wavefront OBJ mesh loader (:monosp:`obj`)
    - Vertex positions buffer (flatten) pre-multiplied by the object-to-world transformation.
    - |exposed|, |differentiable|, |discontinuous|
 
+ * - vertex_positions_end
+   - :paramtype:`float[]`
+   - Vertex positions buffer (flatten) at time 1, empty for static meshes. Setting it
+     enables deformation motion blur.
+   - |exposed|
+
  * - vertex_normals
    - :paramtype:`float[]`
    - Vertex normals buffer (flatten)  pre-multiplied by the object-to-world transformation.
@@ -83,7 +130,9 @@ Wavefront OBJ mesh loader (:monosp:`obj`)
 
 This plugin implements a simple loader for Wavefront OBJ files. It handles
 meshes containing triangles and quadrilaterals, and it also imports vertex normals
-and texture coordinates.
+and texture coordinates. When several shapes load the same file with the same
+transformation and normal-related parameters, the file is only parsed once and
+the buffers are shared between them (see ``AssetCache``).
 
 Loading an ordinary OBJ file is as simple as writing:
 
@@ -133,7 +182,8 @@ public:
     MI_IMPORT_BASE(Mesh, m_name, m_bbox, m_to_world, m_vertex_count,
                     m_face_count, m_vertex_positions, m_vertex_normals,
                     m_vertex_texcoords, m_faces, m_face_normals,
-                    recompute_vertex_normals, has_vertex_normals, initialize)
+                    recompute_vertex_normals, has_vertex_normals, initialize,
+                    cache_load, cache_store, asset_load, asset_store)
     MI_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -166,180 +216,314 @@ public:
 
         ScopedPhase phase(ProfilerPhase::LoadGeometry);
 
+        std::string key = tfm::format("obj:%i", (int) flip_tex_coords);
+        if (asset_load(file_path, key)) {
+            initialize();
+            return;
+        }
+
+        if (cache_load(file_path, key)) {
+            asset_store();
+            initialize();
+            return;
+        }
+
         using ScalarIndex3 = std::array<ScalarIndex, 3>;
 
-        struct VertexBinding {
-            ScalarIndex3 key {{ 0, 0, 0 }};
-            ScalarIndex value { 0 };
-            VertexBinding *next { nullptr };
+        /// Geometry parsed from one newline-aligned chunk of the file
+        struct Chunk {
+            std::vector<InputVector3f> vertices;
+            std::vector<InputNormal3f> normals;
+            std::vector<InputVector2f> texcoords;
+            /// (position, texcoord, normal) indices of every face corner
+            std::vector<ScalarIndex3> corners;
+            /// Triangles referencing entries of 'corners'
+            std::vector<ScalarIndex3> triangles;
+            ScalarBoundingBox3f bbox;
         };
 
-        /// Temporary buffers for vertices, normals, and texture coordinates
-        std::vector<InputVector3f> vertices;
-        std::vector<InputNormal3f> normals;
-        std::vector<InputVector2f> texcoords;
-        std::vector<ScalarIndex3> triangles;
-        std::vector<VertexBinding> vertex_map;
-
  #if !defined(_WIN32)
         ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
         size_t file_size           = mmap->size();
-        const char *ptr            = (const char *) mmap->data();
+        const char *data           = (const char *) mmap->data();
 #else
         // Memory-mapped IO performs surprisingly poorly on Windows
         ref<FileStream> fs = new FileStream(file_path);
         size_t file_size = fs->size();
         std::unique_ptr<char[]> tmp(new char[file_size]);
         fs->read(tmp.get(), file_size);
-        const char *ptr = tmp.get();
+        const char *data = tmp.get();
 #endif
 
-        size_t vertex_guess = file_size / 100;
-        const char *eof     = ptr + file_size;
-        char buf[1025];
-
-        vertices.reserve(vertex_guess);
-        normals.reserve(vertex_guess);
-        texcoords.reserve(vertex_guess);
-        triangles.reserve(vertex_guess * 2);
-        vertex_map.resize(vertex_guess);
-
-        ScalarIndex vertex_ctr = 0;
-
         Timer timer;
 
-        while (ptr < eof) {
-            // Determine the offset of the next newline
-            const char *next = ptr;
-            advance<false>(&next, eof, "\n");
-
-            // Copy buf into a 0-terminated buffer
-            size_t size = next - ptr;
-            if (size >= sizeof(buf) - 1)
-                fail("file contains an excessively long line! (%i characters)", size);
-            memcpy(buf, ptr, size);
-            buf[size] = '\0';
-
-            // Skip whitespace
-            const char *cur = buf, *eol = buf + size;
-            advance<true>(&cur, eol, " \t\r");
-
-            bool parse_error = false;
-            if (cur[0] == 'v' && (cur[1] == ' ' || cur[1] == '\t')) {
-                // Vertex position
-                InputPoint3f p;
-                cur += 2;
-                for (size_t i = 0; i < 3; ++i) {
-                    const char *orig = cur;
-                    p[i] = string::strtof<InputFloat>(cur, (char **) &cur);
-                    parse_error |= cur == orig;
-                }
-                p = m_to_world.scalar().transform_affine(p);
-                if (unlikely(!all(dr::isfinite(p))))
-                    fail("mesh contains invalid vertex position data");
-                m_bbox.expand(p);
-                vertices.push_back(p);
-            } else if (cur[0] == 'v' && cur[1] == 'n' && (cur[2] == ' ' || cur[2] == '\t')) {
-                if (!m_face_normals) {
-                    cur += 3;
-                    // Vertex normal
-                    InputNormal3f n;
+        auto parse_chunk = [&](const char *ptr, const char *eof, Chunk &chunk) {
+            char buf[1025];
+
+            size_t vertex_guess = (eof - ptr) / 100;
+            chunk.vertices.reserve(vertex_guess);
+            chunk.corners.reserve(vertex_guess * 2);
+            chunk.triangles.reserve(vertex_guess * 2);
+
+            while (ptr < eof) {
+                // Determine the offset of the next newline
+                const char *next = ptr;
+                advance<false>(&next, eof, "\n");
+
+                // Copy buf into a 0-terminated buffer
+                size_t size = next - ptr;
+                if (size >= sizeof(buf) - 1)
+                    fail("file contains an excessively long line! (%i characters)", size);
+                memcpy(buf, ptr, size);
+                buf[size] = '\0';
+
+                // Skip whitespace
+                const char *cur = buf, *eol = buf + size;
+                advance<true>(&cur, eol, " \t\r");
+
+                bool parse_error = false;
+                if (cur[0] == 'v' && (cur[1] == ' ' || cur[1] == '\t')) {
+                    // Vertex position
+                    InputPoint3f p;
+                    cur += 2;
                     for (size_t i = 0; i < 3; ++i) {
                         const char *orig = cur;
-                        n[i] = string::strtof<InputFloat>(cur, (char **) &cur);
+                        p[i] = string::strtof<InputFloat>(cur, (char **) &cur);
                         parse_error |= cur == orig;
                     }
-                    n = dr::normalize(m_to_world.scalar().transform_affine(n));
-                    if (unlikely(!all(dr::isfinite(n))))
-                        fail("mesh contains invalid vertex normal data");
-                    normals.push_back(n);
-                }
-            } else if (cur[0] == 'v' && cur[1] == 't' && (cur[2] == ' ' || cur[2] == '\t')) {
-                // Texture coordinate
-                InputVector2f uv;
-                cur += 3;
-                for (size_t i = 0; i < 2; ++i) {
-                    const char *orig = cur;
-                    uv[i] = string::strtof<InputFloat>(cur, (char **) &cur);
-                    parse_error |= cur == orig;
-                }
-                if (flip_tex_coords)
-                    uv.y() = 1.f - uv.y();
-
-                texcoords.push_back(uv);
-            } else if (cur[0] == 'f' && (cur[1] == ' ' || cur[1] == '\t')) {
-                // Face specification
-                cur += 2;
-                size_t vertex_index = 0;
-                size_t type_index = 0;
-                ScalarIndex3 key {{ (ScalarIndex) 0, (ScalarIndex) 0, (ScalarIndex) 0 }};
-                ScalarIndex3 tri;
-
-                while (true) {
-                    const char *next2;
-                    ScalarIndex value = (ScalarIndex) strtoul(cur, (char **) &next2, 10);
-                    if (cur == next2)
-                        break;
-
-                    if (type_index < 3) {
-                        key[type_index] = value;
-                    } else {
-                        parse_error = true;
-                        break;
+                    p = m_to_world.scalar().transform_affine(p);
+                    if (unlikely(!all(dr::isfinite(p))))
+                        fail("mesh contains invalid vertex position data");
+                    chunk.bbox.expand(p);
+                    chunk.vertices.push_back(p);
+                } else if (cur[0] == 'v' && cur[1] == 'n' && (cur[2] == ' ' || cur[2] == '\t')) {
+                    if (!m_face_normals) {
+                        cur += 3;
+                        // Vertex normal
+                        InputNormal3f n;
+                        for (size_t i = 0; i < 3; ++i) {
+                            const char *orig = cur;
+                            n[i] = string::strtof<InputFloat>(cur, (char **) &cur);
+                            parse_error |= cur == orig;
+                        }
+                        n = dr::normalize(m_to_world.scalar().transform_affine(n));
+                        if (unlikely(!all(dr::isfinite(n))))
+                            fail("mesh contains invalid vertex normal data");
+                        chunk.normals.push_back(n);
                     }
-
-                    while (*next2 == '/') {
-                        type_index++;
-                        next2++;
+                } else if (cur[0] == 'v' && cur[1] == 't' && (cur[2] == ' ' || cur[2] == '\t')) {
+                    // Texture coordinate
+                    InputVector2f uv;
+                    cur += 3;
+                    for (size_t i = 0; i < 2; ++i) {
+                        const char *orig = cur;
+                        uv[i] = string::strtof<InputFloat>(cur, (char **) &cur);
+                        parse_error |= cur == orig;
                     }
+                    if (flip_tex_coords)
+                        uv.y() = 1.f - uv.y();
+
+                    chunk.texcoords.push_back(uv);
+                } else if (cur[0] == 'f' && (cur[1] == ' ' || cur[1] == '\t')) {
+                    // Face specification
+                    cur += 2;
+                    size_t vertex_index = 0;
+                    size_t type_index = 0;
+                    ScalarIndex3 key {{ (ScalarIndex) 0, (ScalarIndex) 0, (ScalarIndex) 0 }};
+                    ScalarIndex3 tri;
+
+                    while (true) {
+                        const char *next2;
+                        ScalarIndex value = (ScalarIndex) strtoul(cur, (char **) &next2, 10);
+                        if (cur == next2)
+                            break;
+
+                        if (type_index < 3) {
+                            key[type_index] = value;
+                        } else {
+                            parse_error = true;
+                            break;
+                        }
 
-                    if (*next2 == ' ' || *next2 == '\t' || *next2 == '\0' || *next2 == '\r') {
-                        type_index = 0;
-                        size_t map_index = key[0] - 1;
+                        while (*next2 == '/') {
+                            type_index++;
+                            next2++;
+                        }
 
-                        if (unlikely(map_index >= vertices.size()))
-                            fail("reference to invalid vertex %i!", key[0]);
-                        if (unlikely(vertex_map.size() < vertices.size()))
-                            vertex_map.resize(vertices.size());
+                        if (*next2 == ' ' || *next2 == '\t' || *next2 == '\0' || *next2 == '\r') {
+                            type_index = 0;
 
-                        // Hash table lookup
-                        VertexBinding *entry = &vertex_map[map_index];
-                        while (entry->key != key && entry->next != nullptr)
-                            entry = entry->next;
+                            // Corners are deduplicated once all chunks are parsed
+                            ScalarIndex corner = (ScalarIndex) chunk.corners.size();
+                            chunk.corners.push_back(key);
 
-                        ScalarIndex id;
-                        if (entry->key == key) {
-                            // Hit
-                            id = entry->value;
-                        } else {
-                            // Miss
-                            if (entry->key != ScalarIndex3{{0, 0, 0}}) {
-                                entry->next = new VertexBinding();
-                                entry = entry->next;
+                            if (vertex_index < 3) {
+                                tri[vertex_index] = corner;
+                            } else {
+                                tri[1] = tri[2];
+                                tri[2] = corner;
                             }
-                            entry->key = key;
-                            id = entry->value = vertex_ctr++;
+                            vertex_index++;
+
+                            if (vertex_index >= 3)
+                                chunk.triangles.push_back(tri);
                         }
 
-                        if (vertex_index < 3) {
-                            tri[vertex_index] = id;
-                        } else {
-                            tri[1] = tri[2];
-                            tri[2] = id;
+                        cur = next2;
+                    }
+                }
+
+                if (unlikely(parse_error))
+                    fail("could not parse line \"%s\"", buf);
+                ptr = next + 1;
+            }
+        };
+
+        // Split the file into newline-aligned chunks that are parsed in parallel
+        const char *eof = data + file_size;
+        size_t chunk_size = std::max(
+            file_size / (4 * std::max(Thread::thread_count(), (size_t) 1)) + 1,
+            (size_t) (1 << 20));
+
+        std::vector<std::pair<const char *, const char *>> ranges;
+        for (const char *start = data; start < eof;) {
+            const char *end = start + std::min(chunk_size, (size_t) (eof - start));
+            advance<false>(&end, eof, "\n");
+            if (end < eof)
+                end++;
+            ranges.emplace_back(start, end);
+            start = end;
+        }
+
+        std::vector<Chunk> chunks(ranges.size());
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, ranges.size(), 1),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                    parse_chunk(ranges[i].first, ranges[i].second, chunks[i]);
+            }
+        );
+
+        // Concatenate the chunks, OBJ indices refer to the whole file
+        size_t n_chunks = chunks.size(), vertex_total = 0, normal_total = 0,
+               texcoord_total = 0, corner_total = 0, triangle_total = 0;
+        std::vector<size_t> vertex_offset(n_chunks), normal_offset(n_chunks),
+            texcoord_offset(n_chunks), corner_offset(n_chunks),
+            triangle_offset(n_chunks);
+
+        for (size_t i = 0; i < n_chunks; ++i) {
+            const Chunk &chunk = chunks[i];
+            vertex_offset[i]   = vertex_total;
+            normal_offset[i]   = normal_total;
+            texcoord_offset[i] = texcoord_total;
+            corner_offset[i]   = corner_total;
+            triangle_offset[i] = triangle_total;
+            vertex_total   += chunk.vertices.size();
+            normal_total   += chunk.normals.size();
+            texcoord_total += chunk.texcoords.size();
+            corner_total   += chunk.corners.size();
+            triangle_total += chunk.triangles.size();
+            m_bbox.expand(chunk.bbox);
+        }
+
+        if (corner_total >= (size_t) 0xFFFFFFFFu)
+            fail("too many face vertices!");
+
+        std::vector<InputVector3f> vertices(vertex_total);
+        std::vector<InputNormal3f> normals(normal_total);
+        std::vector<InputVector2f> texcoords(texcoord_total);
+        std::vector<ScalarIndex3> corners(corner_total);
+        std::vector<ScalarIndex3> triangles(triangle_total);
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, n_chunks, 1),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    Chunk &chunk = chunks[i];
+                    std::copy(chunk.vertices.begin(), chunk.vertices.end(),
+                              vertices.begin() + vertex_offset[i]);
+                    std::copy(chunk.normals.begin(), chunk.normals.end(),
+                              normals.begin() + normal_offset[i]);
+                    std::copy(chunk.texcoords.begin(), chunk.texcoords.end(),
+                              texcoords.begin() + texcoord_offset[i]);
+                    std::copy(chunk.corners.begin(), chunk.corners.end(),
+                              corners.begin() + corner_offset[i]);
+                    ScalarIndex offset = (ScalarIndex) corner_offset[i];
+                    for (size_t j = 0; j < chunk.triangles.size(); ++j) {
+                        const ScalarIndex3 &tri = chunk.triangles[j];
+                        triangles[triangle_offset[i] + j] = {{ tri[0] + offset,
+                                                               tri[1] + offset,
+                                                               tri[2] + offset }};
+                    }
+                    chunk = Chunk();
+                }
+            }
+        );
+
+        /* Deduplicate the face corners using a concurrent open-addressing hash
+           table. Every slot stores one plus the smallest index of all corners
+           sharing its key, hence vertices are numbered by first appearance
+           regardless of how the work was scheduled. */
+        size_t table_size = math::round_to_power_of_two(2 * corner_total + 1),
+               table_mask = table_size - 1;
+        std::unique_ptr<std::atomic<uint32_t>[]> table(
+            new std::atomic<uint32_t>[table_size]);
+        std::vector<uint32_t> corner_slot(corner_total);
+
+        auto hash_key = [](const ScalarIndex3 &key) {
+            uint64_t h = (uint64_t) key[0] * 0x9E3779B97F4A7C15ull ^
+                         (uint64_t) key[1] * 0xC2B2AE3D27D4EB4Full ^
+                         (uint64_t) key[2] * 0x165667B19E3779F9ull;
+            return (size_t) (h ^ (h >> 32));
+        };
+
+        constexpr size_t grain_size = 1 << 16;
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, table_size, grain_size),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                    table[i].store(0, std::memory_order_relaxed);
+            }
+        );
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, corner_total, grain_size),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t c = range.begin(); c != range.end(); ++c) {
+                    const ScalarIndex3 &key = corners[c];
+                    uint32_t id = (uint32_t) c + 1;
+                    size_t slot = hash_key(key) & table_mask;
+                    uint32_t owner = table[slot].load(std::memory_order_acquire);
+
+                    while (true) {
+                        if (owner == 0) {
+                            if (table[slot].compare_exchange_weak(owner, id))
+                                break;
+                            continue; // 'owner' was reloaded
                         }
-                        vertex_index++;
 
-                        if (vertex_index >= 3)
-                            triangles.push_back(tri);
+                        if (corners[owner - 1] == key) {
+                            while (id < owner &&
+                                   !table[slot].compare_exchange_weak(owner, id))
+                                ;
+                            break;
+                        }
+
+                        slot = (slot + 1) & table_mask;
+                        owner = table[slot].load(std::memory_order_acquire);
                     }
 
-                    cur = next2;
+                    corner_slot[c] = (uint32_t) slot;
                 }
             }
+        );
 
-            if (unlikely(parse_error))
-                fail("could not parse line \"%s\"", buf);
-            ptr = next + 1;
+        // Number the vertices in order of their first appearance
+        std::vector<ScalarIndex> corner_vertex(corner_total);
+        ScalarIndex vertex_ctr = 0;
+        for (size_t c = 0; c < corner_total; ++c) {
+            if (table[corner_slot[c]].load(std::memory_order_relaxed) == c + 1)
+                corner_vertex[c] = vertex_ctr++;
         }
 
         m_vertex_count = vertex_ctr;
@@ -349,34 +533,52 @@ public:
         std::unique_ptr<float[]> vertex_normals(new float[m_vertex_count * 3]);
         std::unique_ptr<float[]> vertex_texcoords(new float[m_vertex_count * 2]);
 
-        for (const auto& v_ : vertex_map) {
-            const VertexBinding *v = &v_;
-
-            while (v && v->key != ScalarIndex3{{0, 0, 0}}) {
-                InputFloat* position_ptr = vertex_positions.get() + v->value * 3;
-                InputFloat* normal_ptr   = vertex_normals.get() + v->value * 3;
-                InputFloat* texcoord_ptr = vertex_texcoords.get() + v->value * 2;
-                auto key = v->key;
-
-                dr::store(position_ptr, vertices[key[0] - 1]);
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, corner_total, grain_size),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t c = range.begin(); c != range.end(); ++c) {
+                    if (table[corner_slot[c]].load(std::memory_order_relaxed) != c + 1)
+                        continue;
+
+                    ScalarIndex id = corner_vertex[c];
+                    InputFloat* position_ptr = vertex_positions.get() + id * 3;
+                    InputFloat* normal_ptr   = vertex_normals.get() + id * 3;
+                    InputFloat* texcoord_ptr = vertex_texcoords.get() + id * 2;
+                    const ScalarIndex3 &key = corners[c];
+
+                    size_t map_index = key[0] - 1;
+                    if (unlikely(map_index >= vertices.size()))
+                        fail("reference to invalid vertex %i!", key[0]);
+                    dr::store(position_ptr, vertices[map_index]);
+
+                    if (key[1]) {
+                        map_index = key[1] - 1;
+                        if (unlikely(map_index >= texcoords.size()))
+                            fail("reference to invalid texture coordinate %i!", key[1]);
+                        dr::store(texcoord_ptr, texcoords[map_index]);
+                    }
 
-                if (key[1]) {
-                    size_t map_index = key[1] - 1;
-                    if (unlikely(map_index >= texcoords.size()))
-                        fail("reference to invalid texture coordinate %i!", key[1]);
-                    dr::store(texcoord_ptr, texcoords[map_index]);
+                    if (!m_face_normals && key[2]) {
+                        map_index = key[2] - 1;
+                        if (unlikely(map_index >= normals.size()))
+                            fail("reference to invalid normal %i!", key[2]);
+                        dr::store(normal_ptr, normals[map_index]);
+                    }
                 }
+            }
+        );
 
-                if (!m_face_normals && key[2]) {
-                    size_t map_index = key[2] - 1;
-                    if (unlikely(map_index >= normals.size()))
-                        fail("reference to invalid normal %i!", key[2]);
-                    dr::store(normal_ptr, normals[key[2] - 1]);
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, triangles.size(), grain_size),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    ScalarIndex3 &tri = triangles[i];
+                    for (size_t j = 0; j < 3; ++j)
+                        tri[j] = corner_vertex[table[corner_slot[tri[j]]].load(
+                                     std::memory_order_relaxed) - 1];
                 }
-
-                v = v->next;
             }
-        }
+        );
 
         m_faces = dr::load<DynamicBuffer<UInt32>>(triangles.data(), m_face_count * 3);
         m_vertex_positions = dr::load<FloatStorage>(vertex_positions.get(), m_vertex_count * 3);
@@ -405,6 +607,8 @@ public:
                 util::time_string((float) timer2.value()));
         }
 
+        cache_store();
+        asset_store();
         initialize();
     }
 
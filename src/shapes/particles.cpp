@@ -0,0 +1,565 @@
+#include <mitsuba/core/distr_1d.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/warp.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/primitivebvh.h>
+#include <mitsuba/render/shape.h>
+#include <nanothread/nanothread.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-particles:
+
+Particles (:monosp:`particles`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - filename
+   - |string|
+   - Binary file containing the particles as consecutive single precision
+     records :math:`(x, y, z, r)` of center position and radius.
+
+ * - to_world
+   - |transform|
+   - Specifies a linear object-to-world transformation of the particle
+     centers. Note that the radii are invariant to this transformation!
+
+ * - flip_normals
+   - |bool|
+   - Is the particle inverted, i.e. should the normal vectors point inwards?
+     (Default: |false|)
+
+ * - particle_count
+   - |int|
+   - Total number of particles
+   - |exposed|
+
+ * - particles
+   - :paramtype:`float[]`
+   - Flattened particle buffer pre-multiplied by the object-to-world
+     transformation. Each particle is stored as position_x, position_y,
+     position_z, radius.
+   - |exposed|, |differentiable|, |discontinuous|
+
+This shape plugin describes a large number of spheres (e.g. for particle
+systems or molecular scenes) using a single buffer. Compared to one
+:ref:`sphere <shape-sphere>` shape per particle, this avoids creating a
+plugin object and acceleration data structure entry for every sphere and
+drastically reduces the memory usage and the construction time of the scene.
+
+On the CPU, the spheres are intersected using Embree's built-in sphere
+primitives. When Mitsuba is compiled without Embree, the plugin instead uses
+its own bounding volume hierarchy whose leaves test four spheres at once
+using SIMD instructions. All particles share the BSDF, emitter and media
+attached to this shape. The texture coordinates follow the spherical
+parameterization of the :ref:`sphere <shape-sphere>` shape. This plugin is not
+supported by the CUDA variants yet.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: particles
+
+        <shape type="particles">
+            <string name="filename" value="atoms.bin"/>
+            <bsdf type="diffuse"/>
+        </shape>
+
+    .. code-tab:: python
+
+        'atoms': {
+            'type': 'particles',
+            'filename': 'atoms.bin',
+            'bsdf': {
+                'type': 'diffuse'
+            }
+        }
+ */
+
+template <typename Float, typename Spectrum>
+class Particles final : public Shape<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Shape, m_to_world, m_is_instance, initialize,
+                   mark_dirty, get_children_string, parameters_grad_enabled)
+    MI_IMPORT_TYPES()
+
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarSize;
+    using typename Base::ScalarRay3f;
+
+    using InputFloat = float;
+    using InputPoint3f = dr::replace_scalar_t<ScalarPoint3f, InputFloat>;
+    using FloatStorage = DynamicBuffer<dr::replace_scalar_t<Float, InputFloat>>;
+
+    using FloatP = dr::Packet<float, 4>;
+    using MaskP  = dr::mask_t<FloatP>;
+
+private:
+    /// Four spheres in structure-of-arrays layout (unused slots have a NaN radius)
+    struct alignas(16) Packet {
+        float cx[4], cy[4], cz[4], r2[4];
+        uint32_t index[4];
+    };
+
+    /// Maximum number of spheres per BVH leaf
+    static constexpr uint32_t LeafSize = 8;
+
+public:
+    Particles(const Properties &props) : Base(props) {
+        if constexpr (dr::is_cuda_v<Float>)
+            Throw("The \"particles\" shape is not supported in CUDA variants!");
+
+        m_flip_normals = props.get<bool>("flip_normals", false);
+
+        auto fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(props.string("filename"));
+        m_name = file_path.filename().string();
+
+        auto fail = [&](const char *descr, auto... args) {
+            Throw(("Error while loading particles from \"%s\": " + std::string(descr))
+                      .c_str(), m_name, args...);
+        };
+
+        Log(Debug, "Loading particles from \"%s\" ..", m_name);
+        if (!fs::exists(file_path))
+            fail("file not found!");
+
+        ref<MemoryMappedFile> mmap = new MemoryMappedFile(file_path);
+        ScopedPhase phase(ProfilerPhase::LoadGeometry);
+        Timer timer;
+
+        size_t record_size = 4 * sizeof(InputFloat);
+        if (mmap->size() == 0 || mmap->size() % record_size != 0)
+            fail("the file size must be a nonzero multiple of %zu bytes!", record_size);
+        m_particle_count = (ScalarSize) (mmap->size() / record_size);
+
+        std::unique_ptr<InputFloat[]> particles =
+            std::make_unique<InputFloat[]>(m_particle_count * 4);
+        memcpy(particles.get(), mmap->data(), mmap->size());
+
+        ScalarTransform4f to_world = m_to_world.scalar();
+        InputFloat *ptr = particles.get();
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, m_particle_count, 1 << 16),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    InputPoint3f p = dr::load<InputPoint3f>(ptr + 4 * i);
+                    p = to_world.transform_affine(p);
+                    if (unlikely(!dr::all(dr::isfinite(p)) || !(ptr[4 * i + 3] >= 0.f)))
+                        fail("particle %zu has an invalid position or radius!", i);
+                    dr::store(ptr + 4 * i, p);
+                }
+            }
+        );
+
+        m_particles = dr::load<FloatStorage>(particles.get(), m_particle_count * 4);
+        update();
+
+        Log(Debug, "\"%s\": read %i particles (%s in %s)", m_name, m_particle_count,
+            util::mem_string(m_particle_count * record_size),
+            util::time_string((float) timer.value()));
+
+        initialize();
+    }
+
+    /// Recompute the bounding box and the area distribution after a change of the particles
+    void update() {
+        auto&& particles = dr::migrate(m_particles, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        const InputFloat *ptr = particles.data();
+
+        std::vector<ScalarFloat> areas(m_particle_count);
+        std::mutex mutex;
+        m_bbox.reset();
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, m_particle_count, 1 << 16),
+            [&](const dr::blocked_range<size_t> &range) {
+                ScalarBoundingBox3f bbox;
+                for (size_t i = range.begin(); i != range.end(); ++i) {
+                    ScalarPoint3f p(ptr[4 * i + 0], ptr[4 * i + 1], ptr[4 * i + 2]);
+                    ScalarFloat r(ptr[4 * i + 3]);
+                    bbox.expand(p - r);
+                    bbox.expand(p + r);
+                    areas[i] = 4.f * dr::Pi<ScalarFloat> * dr::sqr(r);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                m_bbox.expand(bbox);
+            }
+        );
+
+        m_area_pmf = DiscreteDistribution<Float>(areas.data(), areas.size());
+
+        // The native hierarchy is (re)built on demand
+        std::lock_guard<std::mutex> lock(m_bvh_mutex);
+        m_bvh_ready = false;
+        m_bvh.clear();
+        m_packets.clear();
+    }
+
+    // =============================================================
+    //! @{ \name Native acceleration data structure
+    // =============================================================
+
+    /// Build the bounding volume hierarchy used when tracing rays without Embree
+    void build_bvh() const {
+        auto&& particles = dr::migrate(m_particles, AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        const InputFloat *ptr = particles.data();
+        ScalarSize count = m_particle_count;
+
+        std::vector<uint32_t> order = PrimitiveBVH::morton_order(
+            count, [&](uint32_t i) {
+                return ScalarPoint3f(dr::load<InputPoint3f>(ptr + 4 * i));
+            });
+
+        auto bbox = [&](uint32_t i) {
+            const InputFloat *p = ptr + 4 * order[i];
+            ScalarPoint3f c(p[0], p[1], p[2]);
+            return ScalarBoundingBox3f(c - p[3], c + p[3]);
+        };
+
+        // Leaves reference the packets of their spheres
+        auto leaf = [&](uint32_t begin, uint32_t end) {
+            uint32_t offset = (uint32_t) m_packets.size();
+            for (uint32_t i = begin; i < end; i += 4) {
+                Packet packet;
+                for (uint32_t k = 0; k < 4; ++k) {
+                    if (i + k < end) {
+                        uint32_t j = order[i + k];
+                        const InputFloat *p = ptr + 4 * j;
+                        packet.cx[k] = p[0];
+                        packet.cy[k] = p[1];
+                        packet.cz[k] = p[2];
+                        packet.r2[k] = dr::sqr(p[3]);
+                        packet.index[k] = j;
+                    } else {
+                        packet.cx[k] = packet.cy[k] = packet.cz[k] = 0.f;
+                        packet.r2[k] = dr::NaN<float>;
+                        packet.index[k] = (uint32_t) -1;
+                    }
+                }
+                m_packets.push_back(packet);
+            }
+            return std::make_pair(offset, (uint32_t) m_packets.size() - offset);
+        };
+
+        m_packets.clear();
+        m_packets.reserve(count / 4 + count / LeafSize + 1);
+        m_bvh.build(count, LeafSize, bbox, leaf);
+    }
+
+    void ensure_bvh() const {
+        if (m_bvh_ready.load(std::memory_order_acquire))
+            return;
+        std::lock_guard<std::mutex> lock(m_bvh_mutex);
+        if (!m_bvh_ready.load(std::memory_order_relaxed)) {
+            Timer timer;
+            build_bvh();
+            m_bvh_ready.store(true, std::memory_order_release);
+            Log(Debug, "\"%s\": built a particle hierarchy with %zu nodes (took %s)",
+                m_name, m_bvh.node_count(), util::time_string((float) timer.value()));
+        }
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    /// Traverse the hierarchy, returns <tt>(t, particle index)</tt>
+    template <bool ShadowRay>
+    std::pair<ScalarFloat, ScalarIndex> intersect_scalar(const ScalarRay3f &ray) const {
+        ensure_bvh();
+
+        ScalarFloat t = ray.maxt;
+        ScalarIndex hit = (ScalarIndex) -1;
+
+        FloatP ox(ray.o.x()), oy(ray.o.y()), oz(ray.o.z()),
+               dx(ray.d.x()), dy(ray.d.y()), dz(ray.d.z());
+        float inv_a = dr::rcp(dr::squared_norm(ray.d));
+
+        m_bvh.traverse(ray, [&](uint32_t index, ScalarFloat) {
+            const Packet &p = m_packets[index];
+
+            FloatP ocx = ox - dr::load<FloatP>(p.cx),
+                   ocy = oy - dr::load<FloatP>(p.cy),
+                   ocz = oz - dr::load<FloatP>(p.cz);
+
+            FloatP b = dr::fmadd(ocx, dx, dr::fmadd(ocy, dy, ocz * dz)),
+                   c = dr::fmadd(ocx, ocx, dr::fmadd(ocy, ocy, ocz * ocz)) -
+                       dr::load<FloatP>(p.r2),
+                   disc = dr::fmsub(b, b, c * (1.f / inv_a));
+
+            FloatP sq = dr::sqrt(dr::maximum(disc, 0.f)),
+                   near_t = (-b - sq) * inv_a,
+                   far_t  = (-b + sq) * inv_a,
+                   tp = dr::select(near_t >= 0.f, near_t, far_t);
+
+            MaskP valid = disc >= 0.f && tp >= 0.f && tp <= t;
+            if (dr::none(valid))
+                return t;
+
+            if constexpr (ShadowRay) {
+                t = 0.f;
+                hit = 0;
+                return (ScalarFloat) -1.f;
+            }
+
+            FloatP tv = dr::select(valid, tp, dr::Infinity<FloatP>);
+            for (uint32_t k = 0; k < 4; ++k) {
+                if (tv[k] <= t && valid[k]) {
+                    t = tv[k];
+                    hit = p.index[k];
+                }
+            }
+            return t;
+        });
+
+        if (hit == (ScalarIndex) -1)
+            t = dr::Infinity<ScalarFloat>;
+
+        return { t, hit };
+    }
+
+    PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray,
+                                                        Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+        if constexpr (!dr::is_jit_v<Float>) {
+            ScalarIndex particle;
+            std::tie(pi.t, particle) = intersect_scalar<false>(ray);
+            pi.prim_index = particle;
+            pi.shape_index = (ScalarIndex) -1;
+            pi.t = dr::select(active, pi.t, dr::Infinity<Float>);
+            pi.shape = this;
+        } else {
+            DRJIT_MARK_USED(ray);
+            Throw("The \"particles\" shape can only be intersected through a "
+                  "scene in vectorized variants!");
+        }
+        return pi;
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        if constexpr (!dr::is_jit_v<Float>) {
+            return active && intersect_scalar<true>(ray).first != dr::Infinity<ScalarFloat>;
+        } else {
+            DRJIT_MARK_USED(ray);
+            Throw("The \"particles\" shape can only be intersected through a "
+                  "scene in vectorized variants!");
+        }
+    }
+
+    std::tuple<ScalarFloat, ScalarPoint2f, ScalarUInt32, ScalarUInt32>
+    ray_intersect_preliminary_scalar(const ScalarRay3f &ray) const override {
+        auto [t, particle] = intersect_scalar<false>(ray);
+        return { t, ScalarPoint2f(0.f), (ScalarUInt32) -1, particle };
+    }
+
+    ScalarMask ray_test_scalar(const ScalarRay3f &ray) const override {
+        return intersect_scalar<true>(ray).first != dr::Infinity<ScalarFloat>;
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     const PreliminaryIntersection3f &pi,
+                                                     uint32_t ray_flags,
+                                                     uint32_t recursion_depth,
+                                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        // Early exit when tracing isn't necessary
+        if (!m_is_instance && recursion_depth > 0)
+            return dr::zeros<SurfaceInteraction3f>();
+
+        bool need_dn_duv  = has_flag(ray_flags, RayFlags::dNSdUV) ||
+                            has_flag(ray_flags, RayFlags::dNGdUV);
+        bool need_dp_duv  = has_flag(ray_flags, RayFlags::dPdUV) || need_dn_duv;
+        bool need_uv      = has_flag(ray_flags, RayFlags::UV) || need_dp_duv;
+        bool detach_shape = has_flag(ray_flags, RayFlags::DetachShape);
+
+        dr::suspend_grad<Float> scope(detach_shape, m_particles);
+
+        Point4f particle = dr::gather<Point4f>(m_particles, pi.prim_index, active);
+        Point3f center(particle.x(), particle.y(), particle.z());
+        Float radius = particle.w();
+
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+        si.t = dr::select(active, pi.t, dr::Infinity<Float>);
+
+        Vector3f local = dr::normalize(ray(pi.t) - center);
+        // Re-project onto the sphere to improve accuracy
+        si.p = dr::fmadd(local, radius, center);
+        si.sh_frame.n = local;
+
+        if (likely(need_uv)) {
+            Float rd_2  = dr::sqr(local.x()) + dr::sqr(local.y()),
+                  theta = unit_angle_z(local),
+                  phi   = dr::atan2(local.y(), local.x());
+
+            dr::masked(phi, phi < 0.f) += 2.f * dr::Pi<Float>;
+
+            si.uv = Point2f(phi * dr::InvTwoPi<Float>, theta * dr::InvPi<Float>);
+            if (likely(need_dp_duv)) {
+                si.dp_du = Vector3f(-local.y(), local.x(), 0.f);
+
+                Float rd      = dr::sqrt(rd_2),
+                      inv_rd  = dr::rcp(rd),
+                      cos_phi = local.x() * inv_rd,
+                      sin_phi = local.y() * inv_rd;
+
+                si.dp_dv = Vector3f(local.z() * cos_phi,
+                                    local.z() * sin_phi,
+                                    -rd);
+
+                Mask singularity_mask = active && dr::eq(rd, 0.f);
+                if (unlikely(dr::any_or<true>(singularity_mask)))
+                    si.dp_dv[singularity_mask] = Vector3f(1.f, 0.f, 0.f);
+
+                si.dp_du *= radius * (2.f * dr::Pi<Float>);
+                si.dp_dv *= radius * dr::Pi<Float>;
+            }
+        }
+
+        if (m_flip_normals)
+            si.sh_frame.n = -si.sh_frame.n;
+        si.n = si.sh_frame.n;
+
+        if (need_dn_duv) {
+            Float inv_radius = (m_flip_normals ? -1.f : 1.f) * dr::rcp(radius);
+            si.dn_du = si.dp_du * inv_radius;
+            si.dn_dv = si.dp_dv * inv_radius;
+        }
+
+        si.shape    = this;
+        si.instance = nullptr;
+
+        if (unlikely(has_flag(ray_flags, RayFlags::BoundaryTest)))
+            si.boundary_test = dr::abs(dr::dot(si.sh_frame.n, -ray.d));
+
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Sampling routines
+    // =============================================================
+
+    PositionSample3f sample_position(Float time, const Point2f &sample_,
+                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        Point2f sample = sample_;
+        UInt32 index;
+        std::tie(index, sample.y()) = m_area_pmf.sample_reuse(sample.y(), active);
+
+        Point4f particle = dr::gather<Point4f>(m_particles, index, active);
+        Point3f center(particle.x(), particle.y(), particle.z());
+        Vector3f local = warp::square_to_uniform_sphere(sample);
+
+        PositionSample3f ps = dr::zeros<PositionSample3f>();
+        ps.p     = dr::fmadd(local, particle.w(), center);
+        ps.n     = m_flip_normals ? -local : local;
+        ps.uv    = Point2f(sample.x(), sample.y());
+        ps.time  = time;
+        ps.pdf   = m_area_pmf.normalization();
+        ps.delta = false;
+
+        return ps;
+    }
+
+    Float pdf_position(const PositionSample3f & /*ps*/, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        return m_area_pmf.normalization();
+    }
+
+    Float surface_area() const override { return m_area_pmf.sum(); }
+
+    //! @}
+    // =============================================================
+
+    void traverse(TraversalCallback *callback) override {
+        Base::traverse(callback);
+        callback->put_parameter("particle_count", m_particle_count, +ParamFlags::NonDifferentiable);
+        callback->put_parameter("particles",      m_particles,       ParamFlags::Differentiable | ParamFlags::Discontinuous);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        if (keys.empty() || string::contains(keys, "particles")) {
+            if (dr::width(m_particles) != m_particle_count * 4)
+                Throw("The number of particles cannot be changed!");
+            update();
+            mark_dirty();
+        }
+        Base::parameters_changed();
+    }
+
+    bool parameters_grad_enabled() const override {
+        return dr::grad_enabled(m_particles);
+    }
+
+#if defined(MI_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        dr::eval(m_particles); // Make sure the buffer is evaluated
+        RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_SPHERE_POINT);
+        rtcSetSharedGeometryBuffer(geom, RTC_BUFFER_TYPE_VERTEX, 0, RTC_FORMAT_FLOAT4,
+                                   m_particles.data(), 0, 4 * sizeof(InputFloat),
+                                   m_particle_count);
+        rtcCommitGeometry(geom);
+        return geom;
+    }
+#endif
+
+    ScalarBoundingBox3f bbox() const override { return m_bbox; }
+
+    ScalarSize effective_primitive_count() const override { return m_particle_count; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "Particles[" << std::endl
+            << "  name = \"" << m_name << "\"," << std::endl
+            << "  particle_count = " << m_particle_count << "," << std::endl
+            << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+            << "  surface_area = " << m_area_pmf.sum() << "," << std::endl
+            << "  " << string::indent(get_children_string()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+private:
+    std::string m_name;
+    ScalarBoundingBox3f m_bbox;
+    ScalarSize m_particle_count = 0;
+    bool m_flip_normals;
+
+    mutable FloatStorage m_particles;
+    DiscreteDistribution<Float> m_area_pmf;
+
+    // Native hierarchy, only built when a ray is traced without Embree
+    mutable PrimitiveBVH m_bvh;
+    mutable std::vector<Packet> m_packets;
+    mutable std::atomic<bool> m_bvh_ready { false };
+    mutable std::mutex m_bvh_mutex;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(Particles, Shape)
+MI_EXPORT_PLUGIN(Particles, "Particles");
+NAMESPACE_END(mitsuba)
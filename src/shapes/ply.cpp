@@ -1,12 +1,16 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/mstream.h>
+#include <mitsuba/core/parallel.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/util.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/profiler.h>
 #include <drjit/half.h>
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include <unordered_set>
 #include <fstream>
@@ -38,11 +42,51 @@ PLY (Stanford Triangle Format) mesh loader (:monosp:`ply`)
    - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
      the normals point outside)
 
+ * - cache
+   - |bool|
+   - When set to |true|, the loaded mesh is stored in a binary cache file
+     next to the source file, which is memory-mapped instead of parsing the
+     source file on subsequent runs. The cache is keyed by the file contents
+     and the loading parameters. (Default: |false|, unless a node-local shared
+     asset directory is set)
+
+ * - cache_dir
+   - |string|
+   - Directory of the binary mesh cache. Implies ``cache``. (Default: the
+     shared asset directory set via ``MI_SHARED_ASSET_DIR`` or
+     ``mi.AssetCache.set_shared_directory()``, and otherwise the directory of
+     the source file)
+
+ * - out_of_core
+   - |bool|
+   - When set to |true|, the vertex, face, and attribute buffers are moved
+     into a memory-mapped file after loading, which allows the operating
+     system to page the geometry in on demand. Only supported in scalar
+     variants. (Default: |false|)
+
+ * - out_of_core_file
+   - |string|
+   - Location of the memory-mapped file used by ``out_of_core``. Implies
+     ``out_of_core``. (Default: a temporary file)
+
+ * - attribute_storage
+   - |string|
+   - Storage precision of the vertex and face attributes: ``float``,
+     ``half``, ``unorm8``, or ``unorm8_srgb``. Reduced precisions decode
+     attributes when they are evaluated and make them read-only in
+     :py:func:`mitsuba.traverse`. (Default: ``float``)
+
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
      (Default: none, i.e. object space = world space)
 
+ * - to_world_end
+   - |transform|
+   - Object-to-world transformation at time 1. When specified, the vertices move linearly
+     from their position given by ``to_world`` at time 0 to this one, which produces motion
+     blur with a sensor whose shutter is open during this interval. (Default: none, i.e. static)
+
  * - vertex_count
    - |int|
    - Total number of vertices
@@ -63,6 +107,12 @@ PLY (Stanford Triangle Format) mesh loader (:monosp:`ply`)
    - Vertex positions buffer (flatten) pre-multiplied by the object-to-world transformation.
    - |exposed|, |differentiable|, |discontinuous|
 
+ * - vertex_positions_end
+   - :paramtype:`float[]`
+   - Vertex positions buffer (flatten) at time 1, empty for static meshes. Setting it
+     enables deformation motion blur.
+   - |exposed|
+
  * - vertex_normals
    - :paramtype:`float[]`
    - Vertex normals buffer (flatten)  pre-multiplied by the object-to-world transformation.
@@ -101,6 +151,10 @@ RGB color attributes can also be defined without a prefix, following the naming
 or ``{red|green|blue|alpha}``. Those attributes will be group together under a single
 multidimensional attribute named ``{vertex|face}_color``.
 
+When several shapes load the same file with the same transformation and
+normal-related parameters (e.g. to assign different BSDFs), the file is only
+parsed once and the buffers are shared between them (see ``AssetCache``).
+
 .. tabs::
     .. code-tab:: xml
         :name: ply
@@ -130,7 +184,8 @@ public:
                    m_vertex_texcoords, m_faces, add_attribute,
                    m_face_normals, has_vertex_normals,
                    has_vertex_texcoords, recompute_vertex_normals,
-                   initialize)
+                   initialize, cache_load, cache_store, asset_load,
+                   asset_store)
     MI_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -162,8 +217,8 @@ public:
     };
 
     PLYMesh(const Properties &props) : Base(props) {
-        /// Process vertex/index records in large batches
-        constexpr size_t elements_per_packet = 1024;
+        /// Process vertex/index records in parallel slices
+        constexpr size_t elements_per_packet = 1 << 15;
 
         auto fs = Thread::thread()->file_resolver();
         fs::path file_path = fs->resolve(props.string("filename"));
@@ -177,25 +232,61 @@ public:
         if (!fs::exists(file_path))
             fail("file not found");
 
-        ref<Stream> stream = new FileStream(file_path);
         ScopedPhase phase(ProfilerPhase::LoadGeometry);
+
+        if (asset_load(file_path, "ply")) {
+            initialize();
+            return;
+        }
+
+        if (cache_load(file_path, "ply")) {
+            asset_store();
+            initialize();
+            return;
+        }
+
+        /* Binary records are mapped into memory and decoded in parallel
+           slices, ASCII records are first parsed into a memory stream */
+        ref<MemoryMappedFile> mapped;
+        ref<MemoryStream> ascii;
+        const uint8_t *data = nullptr;
+        size_t data_size = 0, offset = 0;
         Timer timer;
 
         PLYHeader header;
         try {
-            header = parse_ply_header(stream);
+            ref<FileStream> fs = new FileStream(file_path);
+            header = parse_ply_header(fs);
             if (header.ascii) {
-                if (stream->size() > 100 * 1024)
+                if (fs->size() > 100 * 1024)
                     Log(Warn,
                         "\"%s\": performance warning -- this file uses the ASCII PLY format, which "
                         "is slow to parse. Consider converting it to the binary PLY format.",
                         m_name);
-                stream = parse_ascii((FileStream *) stream.get(), header.elements);
+                ascii = parse_ascii(fs, header.elements);
+                data = ascii->raw_buffer();
+                data_size = ascii->size();
+            } else {
+                offset = fs->tell();
+                fs->close();
+                mapped = new MemoryMappedFile(file_path);
+                data = (const uint8_t *) mapped->data();
+                data_size = mapped->size();
             }
         } catch (const std::exception &e) {
             fail(e.what());
         }
 
+        /// Return a pointer to the records of an element and advance past them
+        auto element_data = [&](const PLYElement &el) {
+            size_t size = el.struct_->size() * el.count;
+            if (offset + size > data_size)
+                fail("unexpected end of file");
+            const uint8_t *ptr = data + offset;
+            offset += size;
+            return ptr;
+        };
+
         bool has_vertex_normals = false;
         bool has_vertex_texcoords = false;
 
@@ -262,33 +353,49 @@ public:
                 std::unique_ptr<float[]> vertex_normals(new float[m_vertex_count * 3]);
                 std::unique_ptr<float[]> vertex_texcoords(new float[m_vertex_count * 2]);
 
-                InputFloat* position_ptr = vertex_positions.get();
-                InputFloat *normal_ptr   = vertex_normals.get();
-                InputFloat *texcoord_ptr = vertex_texcoords.get();
-
-                size_t packet_count     = el.count / elements_per_packet;
-                size_t remainder_count  = el.count % elements_per_packet;
-                size_t i_packet_size    = i_struct_size * elements_per_packet;
-                size_t i_remainder_size = i_struct_size * remainder_count;
-                size_t o_packet_size    = o_struct_size * elements_per_packet;
-
-                std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
-                std::unique_ptr<uint8_t[]> buf_o(new uint8_t[o_packet_size]);
+                /* When only positions are needed, the records are decoded
+                   straight into the position buffer. No conversion is
+                   needed at all when the file stores packed float32 xyz. */
+                bool positions_only = o_struct_size == sizeof(InputFloat) * 3;
+                bool same_layout = positions_only && i_struct_size == o_struct_size &&
+                                   el.struct_->byte_order() == Struct::host_byte_order();
+                for (size_t k = 0; same_layout && k < 3; ++k)
+                    same_layout = (*el.struct_)[k] == (*vertex_struct)[k];
+
+                const uint8_t *src = element_data(el);
+                std::atomic<bool> incompatible = false, invalid = false;
+                std::mutex bbox_mutex;
+
+                blocked_parallel_for(el.count, elements_per_packet, [&](size_t begin, size_t end) {
+                    size_t count = end - begin;
+                    const uint8_t *input = src + begin * i_struct_size;
+                    std::unique_ptr<uint8_t[]> buf_o;
+                    uint8_t *target = (uint8_t *) (vertex_positions.get() + begin * 3);
+
+                    if (same_layout) {
+                        memcpy(target, input, count * o_struct_size);
+                    } else {
+                        if (!positions_only) {
+                            buf_o.reset(new uint8_t[o_struct_size * count]);
+                            target = buf_o.get();
+                        }
+                        if (unlikely(!conv->convert(count, input, target))) {
+                            incompatible = true;
+                            return;
+                        }
+                    }
 
-                for (size_t i = 0; i <= packet_count; ++i) {
-                    uint8_t *target = (uint8_t *) buf_o.get();
-                    size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
-                    size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
-                    stream->read(buf.get(), psize);
-                    if (unlikely(!conv->convert(count, buf.get(), buf_o.get())))
-                        fail("incompatible contents -- is this a triangle mesh?");
+                    InputFloat *position_ptr = vertex_positions.get() + begin * 3;
+                    InputFloat *normal_ptr   = vertex_normals.get() + begin * 3;
+                    InputFloat *texcoord_ptr = vertex_texcoords.get() + begin * 2;
+                    ScalarBoundingBox3f bbox;
 
                     for (size_t j = 0; j < count; ++j) {
                         InputPoint3f p = dr::load<InputPoint3f>(target);
                         p = m_to_world.scalar().transform_affine(p);
                         if (unlikely(!all(dr::isfinite(p))))
-                            fail("mesh contains invalid vertex position data");
-                        m_bbox.expand(p);
+                            invalid = true;
+                        bbox.expand(p);
                         dr::store(position_ptr, p);
                         position_ptr += 3;
 
@@ -317,7 +424,7 @@ public:
 
                         for (size_t k = 0; k < vertex_attributes_descriptors.size(); ++k) {
                             auto& descr = vertex_attributes_descriptors[k];
-                            memcpy(descr.buf.data() + (i * elements_per_packet + j) * descr.dim,
+                            memcpy(descr.buf.data() + (begin + j) * descr.dim,
                                    target + target_offset,
                                    descr.dim * sizeof(InputFloat));
                             target_offset += descr.dim * sizeof(InputFloat);
@@ -325,7 +432,15 @@ public:
 
                         target += o_struct_size;
                     }
-                }
+
+                    std::lock_guard<std::mutex> guard(bbox_mutex);
+                    m_bbox.expand(bbox);
+                });
+
+                if (incompatible)
+                    fail("incompatible contents -- is this a triangle mesh?");
+                if (invalid)
+                    fail("mesh contains invalid vertex position data");
 
                 for (auto& descr: vertex_attributes_descriptors)
                     add_attribute(descr.name, descr.dim, descr.buf);
@@ -374,26 +489,56 @@ public:
                     descr.buf.resize(m_face_count * descr.dim);
 
                 std::unique_ptr<uint32_t[]> faces(new uint32_t[m_face_count * 3]);
-                ScalarIndex* face_ptr = faces.get();
 
-                size_t packet_count     = el.count / elements_per_packet;
-                size_t remainder_count  = el.count % elements_per_packet;
-                size_t i_packet_size    = i_struct_size * elements_per_packet;
-                size_t i_remainder_size = i_struct_size * remainder_count;
-                size_t o_packet_size    = o_struct_size * elements_per_packet;
+                /* Triangles without further attributes are decoded straight
+                   into the index buffer. When the file stores a byte-sized
+                   vertex count followed by uint32 indices, the indices are
+                   copied without conversion. */
+                bool indices_only = o_struct_size == sizeof(ScalarIndex) * 3;
+                bool same_layout =
+                    indices_only && el.struct_->field_count() == 4 &&
+                    i_struct_size == 1 + o_struct_size &&
+                    (*el.struct_)[0].type == Struct::Type::UInt8 &&
+                    el.struct_->byte_order() == Struct::host_byte_order();
+                for (size_t k = 0; same_layout && k < 3; ++k)
+                    same_layout = (*el.struct_)[k + 1].type == struct_type_v<ScalarIndex>;
+
+                const uint8_t *src = element_data(el);
+                std::atomic<bool> incompatible = false;
+
+                blocked_parallel_for(el.count, elements_per_packet, [&](size_t begin, size_t end) {
+                    size_t count = end - begin;
+                    const uint8_t *input = src + begin * i_struct_size;
+                    uint8_t *target = (uint8_t *) (faces.get() + begin * 3);
+
+                    if (same_layout) {
+                        for (size_t j = 0; j < count; ++j) {
+                            if (unlikely(input[0] != 3)) {
+                                incompatible = true;
+                                return;
+                            }
+                            memcpy(target, input + 1, o_struct_size);
+                            input += i_struct_size;
+                            target += o_struct_size;
+                        }
+                        return;
+                    }
 
-                std::unique_ptr<uint8_t[]> buf(new uint8_t[i_packet_size]);
-                std::unique_ptr<uint8_t[]> buf_o(new uint8_t[o_packet_size]);
+                    std::unique_ptr<uint8_t[]> buf_o;
+                    if (!indices_only) {
+                        buf_o.reset(new uint8_t[o_struct_size * count]);
+                        target = buf_o.get();
+                    }
 
-                for (size_t i = 0; i <= packet_count; ++i) {
-                    uint8_t *target = (uint8_t *) buf_o.get();
-                    size_t psize = (i != packet_count) ? i_packet_size : i_remainder_size;
-                    size_t count = (i != packet_count) ? elements_per_packet : remainder_count;
+                    if (unlikely(!conv->convert(count, input, target))) {
+                        incompatible = true;
+                        return;
+                    }
 
-                    stream->read(buf.get(), psize);
-                    if (unlikely(!conv->convert(count, buf.get(), buf_o.get())))
-                        fail("incompatible contents -- is this a triangle mesh?");
+                    if (indices_only)
+                        return;
 
+                    ScalarIndex *face_ptr = faces.get() + begin * 3;
                     for (size_t j = 0; j < count; ++j) {
                         ScalarIndex3 fi = dr::load<ScalarIndex3>(target);
                         dr::store(face_ptr, fi);
@@ -402,7 +547,7 @@ public:
                         size_t target_offset = sizeof(InputFloat) * 3;
                         for (size_t k = 0; k < face_attributes_descriptors.size(); ++k) {
                             auto& descr = face_attributes_descriptors[k];
-                            memcpy(descr.buf.data() + (i * elements_per_packet + j) * descr.dim,
+                            memcpy(descr.buf.data() + (begin + j) * descr.dim,
                                    target + target_offset,
                                    descr.dim * sizeof(InputFloat));
                             target_offset += descr.dim * sizeof(InputFloat);
@@ -410,7 +555,10 @@ public:
 
                         target += o_struct_size;
                     }
-                }
+                });
+
+                if (incompatible)
+                    fail("incompatible contents -- is this a triangle mesh?");
 
                 for (auto& descr: face_attributes_descriptors)
                     add_attribute(descr.name, descr.dim, descr.buf);
@@ -418,11 +566,11 @@ public:
                 m_faces = dr::load<DynamicBuffer<UInt32>>(faces.get(), m_face_count * 3);
             } else {
                 Log(Warn, "\"%s\": skipping unknown element \"%s\"", m_name, el.name);
-                stream->seek(stream->tell() + el.struct_->size() * el.count);
+                element_data(el);
             }
         }
 
-        if (stream->tell() != stream->size())
+        if (offset != data_size)
             fail("invalid file -- trailing content");
 
         Log(Debug, "\"%s\": read %i faces, %i vertices (%s in %s)",
@@ -439,6 +587,8 @@ public:
                 util::time_string((float) timer2.value()));
         }
 
+        cache_store();
+        asset_store();
         initialize();
     }
 
@@ -579,8 +729,8 @@ private:
         return header;
     }
 
-    ref<Stream> parse_ascii(FileStream *in, const std::vector<PLYElement> &elements) {
-        ref<Stream> out = new MemoryStream();
+    ref<MemoryStream> parse_ascii(FileStream *in, const std::vector<PLYElement> &elements) {
+        ref<MemoryStream> out = new MemoryStream();
         std::fstream &is = *in->native();
         for (auto const &el : elements) {
             for (size_t i = 0; i < el.count; ++i) {
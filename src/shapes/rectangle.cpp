@@ -49,6 +49,12 @@ and has a surface normal that points into the positive Z-direction.
 To change the rectangle scale, rotation, or translation, use the
 :monosp:`to_world` parameter.
 
+When the rectangle is used as an area emitter, direct illumination samples are
+distributed uniformly in the solid angle that it subtends at the receiving
+point (Ureña et al., *An Area-Preserving Parametrization for Spherical
+Rectangles*, EGSR 2013). This greatly reduces noise near large emitters, whose
+area sampling densities diverge close to the surface. Tiny and sheared
+rectangles fall back to area sampling.
 
 The following XML snippet showcases a simple example of a textured rectangle:
 
@@ -107,6 +113,14 @@ public:
         m_frame = Frame3f(dp_du, dp_dv, normal);
         m_inv_surface_area = dr::rcp(surface_area());
 
+        /* Solid angle sampling requires perpendicular edges, which is not
+           the case when 'to_world' contains a shear */
+        ScalarTransform4f to_world = m_to_world.scalar();
+        ScalarVector3f ex = to_world * ScalarVector3f(1.f, 0.f, 0.f),
+                       ey = to_world * ScalarVector3f(0.f, 1.f, 0.f);
+        m_solid_angle_sampling =
+            dr::abs(dr::dot(ex, ey)) <= 1e-4f * dr::norm(ex) * dr::norm(ey);
+
         dr::make_opaque(m_frame, m_inv_surface_area);
         mark_dirty();
     }
@@ -170,6 +184,66 @@ public:
         return m_inv_surface_area;
     }
 
+    DirectionSample3f sample_direction(const Interaction3f &it, const Point2f &sample,
+                                       Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        // Area sampling, used when the solid angle is tiny or degenerate
+        DirectionSample3f result = Base::sample_direction(it, sample, active);
+        if (!m_solid_angle_sampling)
+            return result;
+
+        SphericalRectangle sr = spherical_rectangle(it.p);
+        Mask spherical = active && solid_angle_valid(sr.solid_angle);
+
+        if (likely(dr::any_or<true>(spherical))) {
+            /* Sample the spherical rectangle uniformly following Ureña et al.,
+               "An Area-Preserving Parametrization for Spherical Rectangles" */
+            Float au = dr::fmadd(sample.x(), sr.solid_angle, sr.k),
+                  fu = (dr::cos(au) * sr.b0 - sr.b1) / dr::sin(au),
+                  cu = dr::copysign(dr::rsqrt(dr::fmadd(fu, fu, dr::sqr(sr.b0))), fu);
+            cu = dr::clamp(cu, -dr::OneMinusEpsilon<Float>, dr::OneMinusEpsilon<Float>);
+
+            Float xu = dr::clamp(-cu * sr.z0 / dr::safe_sqrt(dr::fnmadd(cu, cu, 1.f)),
+                                 sr.x0, sr.x1),
+                  dist = dr::sqrt(dr::fmadd(xu, xu, dr::sqr(sr.z0))),
+                  h0 = sr.y0 * dr::rsqrt(dr::fmadd(sr.y0, sr.y0, dr::sqr(dist))),
+                  h1 = sr.y1 * dr::rsqrt(dr::fmadd(sr.y1, sr.y1, dr::sqr(dist))),
+                  hv = dr::lerp(h0, h1, sample.y()),
+                  hv2 = dr::sqr(hv),
+                  yv = dr::select(hv2 < 1.f - 1e-6f,
+                                  hv * dist * dr::rsqrt(1.f - hv2), sr.y1);
+
+            DirectionSample3f ds = dr::zeros<DirectionSample3f>();
+            ds.p = it.p + sr.frame.to_world(Vector3f(xu, yv, sr.z0));
+            ds.n = m_frame.n;
+            ds.uv = Point2f((xu - sr.x0) / (sr.x1 - sr.x0),
+                            (yv - sr.y0) / (sr.y1 - sr.y0));
+            ds.time = it.time;
+            ds.d = ds.p - it.p;
+            ds.dist = dr::norm(ds.d);
+            ds.d /= ds.dist;
+            ds.pdf = dr::rcp(sr.solid_angle);
+
+            dr::masked(result, spherical) = ds;
+        }
+
+        return result;
+    }
+
+    Float pdf_direction(const Interaction3f &it, const DirectionSample3f &ds,
+                        Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        Float pdf = Base::pdf_direction(it, ds, active);
+        if (!m_solid_angle_sampling)
+            return pdf;
+
+        Float solid_angle = spherical_rectangle(it.p).solid_angle;
+        return dr::select(solid_angle_valid(solid_angle),
+                          dr::rcp(solid_angle), pdf);
+    }
+
     SurfaceInteraction3f eval_parameterization(const Point2f &uv,
                                                uint32_t ray_flags,
                                                Mask active) const override {
@@ -351,8 +425,71 @@ public:
 
     MI_DECLARE_CLASS()
 private:
+    /// Rectangle as seen from a reference point, in the local frame used to sample it
+    struct SphericalRectangle {
+        Frame3f frame;
+        Float x0, x1, y0, y1, z0;
+        Float b0, b1, k, solid_angle;
+    };
+
+    /// Project the rectangle onto the unit sphere around \c p
+    SphericalRectangle spherical_rectangle(const Point3f &p) const {
+        SphericalRectangle sr;
+
+        Float ex_len = dr::norm(m_frame.s),
+              ey_len = dr::norm(m_frame.t);
+        Vector3f ex = m_frame.s / ex_len,
+                 ey = m_frame.t / ey_len;
+
+        Vector3f d = m_to_world.value().transform_affine(
+            Point3f(-1.f, -1.f, 0.f)) - p;
+
+        // Orient the frame so that the rectangle lies below the reference point
+        Vector3f ez = dr::cross(ex, ey);
+        Float z0 = dr::dot(d, ez);
+        dr::masked(ez, z0 > 0.f) = -ez;
+
+        sr.frame = Frame3f(ex, ey, ez);
+        sr.x0 = dr::dot(d, ex);
+        sr.y0 = dr::dot(d, ey);
+        sr.z0 = -dr::abs(z0);
+        sr.x1 = sr.x0 + ex_len;
+        sr.y1 = sr.y0 + ey_len;
+
+        Vector3f v00(sr.x0, sr.y0, sr.z0), v01(sr.x0, sr.y1, sr.z0),
+                 v10(sr.x1, sr.y0, sr.z0), v11(sr.x1, sr.y1, sr.z0);
+
+        // Normals of the planes through the reference point and each edge
+        Vector3f n0 = dr::normalize(dr::cross(v00, v10)),
+                 n1 = dr::normalize(dr::cross(v10, v11)),
+                 n2 = dr::normalize(dr::cross(v11, v01)),
+                 n3 = dr::normalize(dr::cross(v01, v00));
+
+        // Interior angles of the spherical rectangle
+        Float g0 = dr::safe_acos(-dr::dot(n0, n1)),
+              g1 = dr::safe_acos(-dr::dot(n1, n2)),
+              g2 = dr::safe_acos(-dr::dot(n2, n3)),
+              g3 = dr::safe_acos(-dr::dot(n3, n0));
+
+        sr.b0 = n0.z();
+        sr.b1 = n2.z();
+        sr.k = 2.f * dr::Pi<Float> - g2 - g3;
+        sr.solid_angle = g0 + g1 - sr.k;
+
+        return sr;
+    }
+
+    /**
+     * Can the solid angle be sampled robustly? Tiny and nearly hemispherical
+     * rectangles cause precision issues and use area sampling instead.
+     */
+    static Mask solid_angle_valid(const Float &solid_angle) {
+        return solid_angle > 3e-4f && solid_angle < 6.22f;
+    }
+
     Frame3f m_frame;
     Float m_inv_surface_area;
+    bool m_solid_angle_sampling;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(Rectangle, Shape)
@@ -0,0 +1,643 @@
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/random.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/interaction.h>
+#include <mitsuba/render/kdtree.h>
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/render/primitivebvh.h>
+#include <mitsuba/render/shape.h>
+#include <mitsuba/render/shapegroup.h>
+#include <algorithm>
+#include <limits>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-scatter:
+
+Scattered instances (:monosp:`scatter`)
+-------------------------------------------------
+
+.. pluginparameters::
+
+ * - (Nested plugin)
+   - :paramtype:`shapegroup`
+   - A reference to the shape group that should be instantiated.
+
+ * - filename
+   - |string|
+   - Binary file containing the object-to-world transformation of every
+     instance, stored as consecutive row-major 3x4 matrices of single-precision
+     floating point values (i.e. 48 bytes per instance).
+
+ * - (Nested plugin)
+   - |shape|
+   - Alternatively, a triangle mesh whose surface is used to distribute the
+     instances uniformly with respect to surface area.
+
+ * - count
+   - |int|
+   - Number of instances placed on the nested mesh.
+
+ * - seed
+   - |int|
+   - Seed of the random number generator used to place the instances on the
+     nested mesh (Default: 0)
+
+ * - scale_min, scale_max
+   - |float|
+   - Range of the uniformly distributed scale factor of the instances placed
+     on the nested mesh (Default: 1)
+
+ * - align_to_normal
+   - |bool|
+   - Align the Z axis of the instances placed on the nested mesh with the
+     surface normal instead of the world Z axis (Default: |true|)
+
+ * - to_world
+   - |transform|
+   - Transformation that is applied to all instances (Default: none)
+
+This plugin replicates a shape group many times, similar to a large number of
+:ref:`instance <shape-instance>` shapes. Instead of one plugin object per
+instance, it only stores the world-to-object transformation of each instance
+in a compact array (48 bytes per instance) and builds a bounding volume
+hierarchy over the instances directly from that array. This makes it possible
+to populate scenes with millions of instances (e.g. foliage or crowds) within
+seconds.
+
+The transformations are either read from a binary file or generated by
+randomly distributing the instances over the surface of a nested mesh, where
+each one is rotated randomly about its Z axis.
+
+The native kd-tree sees the shape as a single primitive that is traversed by
+its own hierarchy, while the Embree backend sees every instance as a
+user-defined primitive. This plugin is only supported by the scalar variants.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: scatter
+
+        <shapegroup id="tree">
+            <shape type="ply">
+                <string name="filename" value="tree.ply"/>
+            </shape>
+        </shapegroup>
+
+        <shape type="scatter">
+            <ref id="tree"/>
+            <shape type="ply">
+                <string name="filename" value="terrain.ply"/>
+            </shape>
+            <integer name="count" value="1000000"/>
+            <float name="scale_min" value="0.5"/>
+        </shape>
+
+    .. code-tab:: python
+
+        'forest': {
+            'type': 'scatter',
+            'group': { 'type': 'ref', 'id': 'tree' },
+            'terrain': { 'type': 'ply', 'filename': 'terrain.ply' },
+            'count': 1000000,
+            'scale_min': 0.5
+        }
+ */
+
+template <typename Float, typename Spectrum>
+class Scatter final : public Shape<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Shape, m_id, m_to_world)
+    MI_IMPORT_TYPES(Mesh, ShapeKDTree)
+
+    using typename Base::ScalarSize;
+    using typename Base::ScalarIndex;
+    using typename Base::ScalarRay3f;
+    using ShapeGroup_ = ShapeGroup<Float, Spectrum>;
+
+private:
+    /// World-to-object transformation of an instance (rows of a 3x4 matrix)
+    struct Record {
+        float m[12];
+    };
+
+    /// Result of a ray intersection with the instances
+    struct Hit {
+        ScalarFloat t = dr::Infinity<ScalarFloat>;
+        ScalarPoint2f uv = ScalarPoint2f(0.f);
+        ScalarUInt32 shape_index = (ScalarUInt32) -1,
+                     prim_index  = (ScalarUInt32) -1,
+                     instance    = (ScalarUInt32) -1;
+
+        bool is_valid() const { return instance != (ScalarUInt32) -1; }
+    };
+
+public:
+    Scatter(const Properties &props) : Base(props) {
+        if constexpr (dr::is_jit_v<Float>)
+            Throw("The \"scatter\" shape is only supported in scalar variants!");
+
+        ref<Mesh> mesh;
+        for (auto &[name, obj] : props.objects()) {
+            Base *shape = dynamic_cast<Base *>(obj.get());
+            if (shape && shape->is_shapegroup()) {
+                if (m_shapegroup)
+                    Throw("Only a single shapegroup can be specified per "
+                          "\"scatter\" shape!");
+                m_shapegroup = (ShapeGroup_ *) shape;
+            } else if (shape && shape->is_mesh()) {
+                if (mesh)
+                    Throw("Only a single mesh can be specified per \"scatter\" shape!");
+                mesh = (Mesh *) shape;
+            } else {
+                Throw("Only a shapegroup and a mesh can be specified in a "
+                      "\"scatter\" shape.");
+            }
+        }
+
+        if (!m_shapegroup)
+            Throw("A reference to a 'shapegroup' must be specified!");
+        if (mesh && props.has_property("filename"))
+            Throw("The \"filename\" parameter and a nested mesh cannot be "
+                  "specified at the same time!");
+        if (!mesh && !props.has_property("filename"))
+            Throw("The \"scatter\" shape requires either a \"filename\" "
+                  "parameter or a nested mesh!");
+
+        if constexpr (!dr::is_jit_v<Float>) {
+            Timer timer;
+            m_group_bbox = m_shapegroup->bbox();
+
+#if defined(MI_ENABLE_EMBREE)
+            /* The shape group traces rays with Embree in this configuration,
+               hence build a kd-tree over its shapes to intersect the
+               instances individually */
+            m_kdtree = new ShapeKDTree(Properties("kdtree"));
+            for (auto &shape : m_shapegroup->shapes())
+                m_kdtree->add_shape(shape.get());
+            m_kdtree->build();
+#endif
+
+            if (mesh)
+                distribute(mesh.get(), props);
+            else
+                load(props.string("filename"));
+
+            build_bvh();
+
+            Log(Debug, "\"%s\": created %zu instances (%s, took %s)", m_id,
+                m_records.size(), util::mem_string(memory_footprint()),
+                util::time_string((float) timer.value()));
+        }
+    }
+
+    // =============================================================
+    //! @{ \name Construction of the instances
+    // =============================================================
+
+    /// Append an instance given its object-to-world transformation
+    void add_instance(const ScalarMatrix4f &matrix) {
+        ScalarTransform4f to_world(m_to_world.scalar().matrix * matrix);
+        ScalarMatrix4f to_object = dr::transpose(to_world.inverse_transpose);
+
+        Record r;
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 4; ++j)
+                r.m[i * 4 + j] = (float) to_object(i, j);
+        m_records.push_back(r);
+
+        ScalarBoundingBox3f bbox;
+        if (m_group_bbox.valid()) {
+            for (int i = 0; i < 8; ++i)
+                bbox.expand(to_world * m_group_bbox.corner(i));
+        }
+        m_bboxes.push_back(bbox);
+    }
+
+    /// Read the transformations from a binary file
+    void load(const std::string &filename) {
+        auto fs = Thread::thread()->file_resolver();
+        fs::path file_path = fs->resolve(filename);
+        if (!fs::exists(file_path))
+            Throw("\"%s\": file not found!", file_path.string());
+
+        ref<FileStream> stream = new FileStream(file_path);
+        size_t size = stream->size();
+        if (size % sizeof(Record) != 0)
+            Throw("\"%s\": the file size (%zu bytes) is not a multiple of "
+                  "%zu bytes!", file_path.string(), size, sizeof(Record));
+
+        size_t count = size / sizeof(Record);
+        m_records.reserve(count);
+        m_bboxes.reserve(count);
+
+        std::vector<Record> block(std::min<size_t>(count, 4096));
+        for (size_t i = 0; i < count; i += block.size()) {
+            size_t n = std::min(block.size(), count - i);
+            stream->read_array(block.data()->m, n * 12);
+
+            for (size_t k = 0; k < n; ++k) {
+                ScalarMatrix4f matrix = dr::identity<ScalarMatrix4f>();
+                for (int r = 0; r < 3; ++r)
+                    for (int c = 0; c < 4; ++c)
+                        matrix(r, c) = block[k].m[r * 4 + c];
+                add_instance(matrix);
+            }
+        }
+    }
+
+    /// Distribute the instances over the surface of a mesh
+    void distribute(const Mesh *mesh, const Properties &props) {
+        int64_t count = props.get<int64_t>("count");
+        if (count <= 0)
+            Throw("The \"count\" parameter must be positive!");
+
+        ScalarFloat scale_min = props.get<ScalarFloat>("scale_min", 1.f),
+                    scale_max = props.get<ScalarFloat>("scale_max", 1.f);
+        if (!(scale_min > 0.f && scale_max >= scale_min))
+            Throw("The scale range must satisfy 0 < scale_min <= scale_max!");
+        bool align_to_normal = props.get<bool>("align_to_normal", true);
+
+        PCG32<uint32_t> rng;
+        rng.seed(1, PCG32_DEFAULT_STATE, (uint64_t) props.get<int64_t>("seed", 0));
+
+        m_records.reserve((size_t) count);
+        m_bboxes.reserve((size_t) count);
+
+        for (int64_t i = 0; i < count; ++i) {
+            ScalarPoint2f sample(rng.next_float32(), rng.next_float32());
+            auto ps = mesh->sample_position(0.f, sample);
+
+            ScalarNormal3f n = align_to_normal ? ScalarNormal3f(ps.n)
+                                               : ScalarNormal3f(0.f, 0.f, 1.f);
+            ScalarFrame3f frame(n);
+
+            auto [sin_phi, cos_phi] = dr::sincos(dr::TwoPi<ScalarFloat> * rng.next_float32());
+            ScalarVector3f s = frame.s * cos_phi + frame.t * sin_phi,
+                           t = dr::cross(frame.n, s);
+            ScalarFloat scale = dr::lerp(scale_min, scale_max, rng.next_float32());
+
+            ScalarMatrix4f matrix = dr::identity<ScalarMatrix4f>();
+            for (int r = 0; r < 3; ++r) {
+                matrix(r, 0) = s[r] * scale;
+                matrix(r, 1) = t[r] * scale;
+                matrix(r, 2) = frame.n[r] * scale;
+                matrix(r, 3) = ps.p[r];
+            }
+            add_instance(matrix);
+        }
+    }
+
+    /// Build a bounding volume hierarchy over the Morton-ordered instances
+    void build_bvh() {
+        size_t count = m_records.size();
+        if (count > (size_t) std::numeric_limits<uint32_t>::max())
+            Throw("The \"scatter\" shape supports at most 2^32-1 instances!");
+
+        /* Empty instances (of an empty shape group) keep an invalid box that
+           is never intersected */
+        std::vector<uint32_t> order = PrimitiveBVH::morton_order(
+            (uint32_t) count, [&](uint32_t i) {
+                const ScalarBoundingBox3f &b = m_bboxes[i];
+                return b.valid() ? b.center() : ScalarPoint3f(0.f);
+            });
+
+        std::vector<Record> records(count);
+        std::vector<ScalarBoundingBox3f> bboxes(count);
+        for (size_t i = 0; i < count; ++i) {
+            records[i] = m_records[order[i]];
+            bboxes[i] = m_bboxes[order[i]];
+        }
+        m_records.swap(records);
+        m_bboxes.swap(bboxes);
+        order = std::vector<uint32_t>();
+
+        m_bvh.build((uint32_t) count, 4, [&](uint32_t i) { return m_bboxes[i]; });
+
+        // The instance bounds are only needed during construction
+        m_bboxes = std::vector<ScalarBoundingBox3f>();
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Ray tracing routines
+    // =============================================================
+
+    /// Return the world-to-object transformation of an instance
+    ScalarTransform4f to_object(uint32_t index) const {
+        const float *m = m_records[index].m;
+        ScalarMatrix4f matrix = dr::identity<ScalarMatrix4f>();
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 4; ++j)
+                matrix(i, j) = m[i * 4 + j];
+        return ScalarTransform4f(matrix);
+    }
+
+    /// Transform a ray into the object space of an instance
+    MI_INLINE ScalarRay3f local_ray(uint32_t index, const ScalarRay3f &ray) const {
+        const float *m = m_records[index].m;
+        ScalarRay3f result(ray);
+        for (int i = 0; i < 3; ++i) {
+            const float *row = m + 4 * i;
+            result.o[i] = row[0] * ray.o.x() + row[1] * ray.o.y() +
+                          row[2] * ray.o.z() + row[3];
+            result.d[i] = row[0] * ray.d.x() + row[1] * ray.d.y() +
+                          row[2] * ray.d.z();
+        }
+        return result;
+    }
+
+    /// Intersect a ray (in object space) with the shape group
+    template <bool ShadowRay>
+    MI_INLINE bool intersect_group(const ScalarRay3f &ray, Hit &hit) const {
+#if defined(MI_ENABLE_EMBREE)
+        auto pi = m_kdtree->template ray_intersect_scalar<ShadowRay>(ray);
+        if (!pi.is_valid())
+            return false;
+        if constexpr (!ShadowRay) {
+            hit.t           = pi.t;
+            hit.uv          = pi.prim_uv;
+            hit.shape_index = pi.shape_index;
+            hit.prim_index  = pi.prim_index;
+        }
+        return true;
+#else
+        if constexpr (ShadowRay) {
+            DRJIT_MARK_USED(hit);
+            return m_shapegroup->ray_test_scalar(ray);
+        } else {
+            auto [t, uv, shape_index, prim_index] =
+                m_shapegroup->ray_intersect_preliminary_scalar(ray);
+            if (t == dr::Infinity<ScalarFloat>)
+                return false;
+            hit.t           = t;
+            hit.uv          = uv;
+            hit.shape_index = shape_index;
+            hit.prim_index  = prim_index;
+            return true;
+        }
+#endif
+    }
+
+    template <bool ShadowRay>
+    Hit intersect_scalar(const ScalarRay3f &ray) const {
+        Hit hit;
+        m_bvh.traverse(ray, [&](uint32_t index, ScalarFloat maxt) {
+            ScalarRay3f local = local_ray(index, ray);
+            local.maxt = maxt;
+            Hit h;
+            if (!intersect_group<ShadowRay>(local, h))
+                return maxt;
+            h.instance = index;
+            hit = h;
+            return ShadowRay ? -1.f : h.t;
+        });
+        return hit;
+    }
+
+    /**
+     * \brief Recover the instance that produced a preliminary intersection
+     *
+     * Preliminary intersection records have no room for the instance index,
+     * hence the instances near the hit point are intersected once more, and
+     * the one that reproduces the hit primitive at the closest distance wins.
+     */
+    uint32_t find_instance(const ScalarRay3f &ray_,
+                           const PreliminaryIntersection3f &pi) const {
+        ScalarRay3f ray(ray_);
+        ray.maxt = pi.t * (1.f + 1e-3f) + 1e-5f;
+
+        uint32_t best = (uint32_t) -1;
+        ScalarFloat best_err = dr::Infinity<ScalarFloat>;
+        bool best_match = false;
+
+        m_bvh.traverse(ray, [&](uint32_t index, ScalarFloat maxt) {
+            ScalarRay3f local = local_ray(index, ray);
+            local.maxt = maxt;
+            Hit h;
+            if (intersect_group<false>(local, h)) {
+                bool match = h.shape_index == (ScalarUInt32) pi.shape_index &&
+                             h.prim_index == (ScalarUInt32) pi.prim_index;
+                ScalarFloat err = dr::abs(h.t - pi.t);
+                if ((match && !best_match) || (match == best_match && err < best_err)) {
+                    best = index;
+                    best_err = err;
+                    best_match = match;
+                }
+            }
+            return maxt;
+        });
+
+        return best;
+    }
+
+    PreliminaryIntersection3f ray_intersect_preliminary(const Ray3f &ray,
+                                                        Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        PreliminaryIntersection3f pi = dr::zeros<PreliminaryIntersection3f>();
+        if constexpr (!dr::is_jit_v<Float>) {
+            Hit hit = intersect_scalar<false>(ray);
+            if (active && hit.is_valid()) {
+                pi.t           = hit.t;
+                pi.prim_uv     = hit.uv;
+                pi.prim_index  = hit.prim_index;
+                pi.shape_index = hit.shape_index;
+                pi.instance    = this;
+            }
+        } else {
+            DRJIT_MARK_USED(ray);
+            Throw("The \"scatter\" shape is only supported in scalar variants!");
+        }
+        return pi;
+    }
+
+    Mask ray_test(const Ray3f &ray, Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+        if constexpr (!dr::is_jit_v<Float>) {
+            return active && intersect_scalar<true>(ray).is_valid();
+        } else {
+            DRJIT_MARK_USED(ray);
+            Throw("The \"scatter\" shape is only supported in scalar variants!");
+        }
+    }
+
+    std::tuple<ScalarFloat, ScalarPoint2f, ScalarUInt32, ScalarUInt32>
+    ray_intersect_preliminary_scalar(const ScalarRay3f &ray) const override {
+        Hit hit = intersect_scalar<false>(ray);
+        return { hit.t, hit.uv, hit.shape_index, hit.prim_index };
+    }
+
+    ScalarMask ray_test_scalar(const ScalarRay3f &ray) const override {
+        return intersect_scalar<true>(ray).is_valid();
+    }
+
+    SurfaceInteraction3f compute_surface_interaction(const Ray3f &ray,
+                                                     const PreliminaryIntersection3f &pi,
+                                                     uint32_t ray_flags,
+                                                     uint32_t recursion_depth,
+                                                     Mask active) const override {
+        MI_MASK_ARGUMENT(active);
+
+        // Nested instancing is not supported
+        if (recursion_depth > 0)
+            return dr::zeros<SurfaceInteraction3f>();
+
+        SurfaceInteraction3f si = dr::zeros<SurfaceInteraction3f>();
+
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (!active)
+                return si;
+
+            uint32_t index = find_instance(ray, pi);
+            if (index == (uint32_t) -1)
+                return si;
+
+            ScalarTransform4f to_object = this->to_object(index),
+                              to_world  = to_object.inverse();
+
+            si = m_shapegroup->compute_surface_interaction(
+                to_object.transform_affine(ray), pi, ray_flags,
+                recursion_depth, active);
+
+            si.p = to_world.transform_affine(si.p);
+            si.n = dr::normalize(to_world.transform_affine(si.n));
+            if (likely(has_flag(ray_flags, RayFlags::ShadingFrame))) {
+                si.sh_frame.n = dr::normalize(to_world.transform_affine(si.sh_frame.n));
+                si.initialize_sh_frame();
+            }
+
+            if (likely(has_flag(ray_flags, RayFlags::dPdUV))) {
+                si.dp_du = to_world.transform_affine(si.dp_du);
+                si.dp_dv = to_world.transform_affine(si.dp_dv);
+            }
+
+            if (has_flag(ray_flags, RayFlags::dNGdUV) || has_flag(ray_flags, RayFlags::dNSdUV)) {
+                Normal3f n = has_flag(ray_flags, RayFlags::dNGdUV) ? si.n : si.sh_frame.n;
+
+                // Determine the length of the transformed normal before it was re-normalized
+                Normal3f tn = to_world.transform_affine(dr::normalize(to_object.transform_affine(n)));
+                Float inv_len = dr::rcp(dr::norm(tn));
+                tn *= inv_len;
+
+                // Apply transform to dn_du and dn_dv
+                si.dn_du = to_world.transform_affine(Normal3f(si.dn_du)) * inv_len;
+                si.dn_dv = to_world.transform_affine(Normal3f(si.dn_dv)) * inv_len;
+
+                si.dn_du -= tn * dr::dot(tn, si.dn_du);
+                si.dn_dv -= tn * dr::dot(tn, si.dn_dv);
+            }
+
+            si.instance = this;
+        } else {
+            DRJIT_MARK_USED(ray);
+            DRJIT_MARK_USED(pi);
+            DRJIT_MARK_USED(ray_flags);
+            Throw("The \"scatter\" shape is only supported in scalar variants!");
+        }
+
+        return si;
+    }
+
+    //! @}
+    // =============================================================
+
+    ScalarBoundingBox3f bbox() const override { return m_bvh.bbox(); }
+
+    ScalarSize effective_primitive_count() const override {
+        return (ScalarSize) (m_records.size() * m_shapegroup->primitive_count());
+    }
+
+    /// Return the number of instances
+    size_t instance_count() const { return m_records.size(); }
+
+    size_t memory_footprint() const override {
+        size_t result = m_records.size() * sizeof(Record) +
+                        m_bvh.memory_footprint();
+#if defined(MI_ENABLE_EMBREE)
+        result += m_kdtree->memory_footprint();
+#endif
+        return result;
+    }
+
+#if defined(MI_ENABLE_EMBREE)
+    RTCGeometry embree_geometry(RTCDevice device) override {
+        if constexpr (!dr::is_jit_v<Float>) {
+            return EmbreeUserGeometry<Scatter>::create(device, this,
+                                                       (uint32_t) m_records.size());
+        } else {
+            DRJIT_MARK_USED(device);
+            Throw("The \"scatter\" shape is only supported in scalar variants!");
+        }
+    }
+
+    ScalarBoundingBox3f embree_bbox(uint32_t index) const {
+        ScalarTransform4f to_world = to_object(index).inverse();
+
+        ScalarBoundingBox3f bbox;
+        if (m_group_bbox.valid()) {
+            for (int i = 0; i < 8; ++i)
+                bbox.expand(to_world * m_group_bbox.corner(i));
+        } else {
+            bbox.expand(to_world * ScalarPoint3f(0.f));
+        }
+        return bbox;
+    }
+
+    template <bool ShadowRay>
+    bool embree_intersect(uint32_t index, const ScalarRay3f &ray,
+                          EmbreeUserHit &hit) const {
+        Hit h;
+        if (!intersect_group<ShadowRay>(local_ray(index, ray), h))
+            return false;
+
+        /* Report the hit as an instance hit: the scene then resolves the
+           shape from 'instID' and the shape of the group from 'geomID' */
+        hit.t       = (float) h.t;
+        hit.u       = (float) h.uv.x();
+        hit.v       = (float) h.uv.y();
+        hit.inst_id = hit.geom_id;
+        hit.geom_id = h.shape_index;
+        hit.prim_id = h.prim_index;
+        return true;
+    }
+#endif
+
+    bool parameters_grad_enabled() const override { return false; }
+
+    std::string to_string() const override {
+        std::ostringstream oss;
+        oss << "Scatter[" << std::endl
+            << "  shapegroup = " << string::indent(m_shapegroup) << "," << std::endl
+            << "  bbox = " << string::indent(bbox()) << "," << std::endl
+            << "  instance_count = " << m_records.size() << "," << std::endl
+            << "  storage = " << util::mem_string(memory_footprint()) << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+private:
+    ref<ShapeGroup_> m_shapegroup;
+    ScalarBoundingBox3f m_group_bbox;
+#if defined(MI_ENABLE_EMBREE)
+    ref<ShapeKDTree> m_kdtree;
+#endif
+
+    std::vector<Record> m_records;
+    PrimitiveBVH m_bvh;
+    /// World-space bounds of the instances (only during construction)
+    std::vector<ScalarBoundingBox3f> m_bboxes;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(Scatter, Shape)
+MI_EXPORT_PLUGIN(Scatter, "Scattered instances")
+NAMESPACE_END(mitsuba)
@@ -1,10 +1,15 @@
 #include <mitsuba/render/mesh.h>
 #include <mitsuba/core/fstream.h>
+#include <mitsuba/core/mmap.h>
+#include <mitsuba/core/mstream.h>
 #include <mitsuba/core/zstream.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/timer.h>
 #include <mitsuba/core/profiler.h>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -27,6 +32,12 @@ Serialized mesh loader (:monosp:`serialized`)
    - A :monosp:`.serialized` file may contain several separate meshes. This parameter
      specifies which one should be loaded. (Default: 0, i.e. the first one)
 
+ * - all_shapes
+   - |bool|
+   - When set to |true|, all meshes of the file starting at ``shape_index``
+     are decompressed in parallel, and the plugin expands into one shape per
+     mesh. Cannot be combined with area emitters or sensors. (Default: |false|)
+
  * - face_normals
    - |bool|
    - When set to |true|, any existing or computed vertex normals are
@@ -38,11 +49,29 @@ Serialized mesh loader (:monosp:`serialized`)
    - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
      the normals point outside)
 
+ * - out_of_core
+   - |bool|
+   - When set to |true|, the vertex, face, and attribute buffers are moved
+     into a memory-mapped file after loading, which allows the operating
+     system to page the geometry in on demand. Only supported in scalar
+     variants. (Default: |false|)
+
+ * - out_of_core_file
+   - |string|
+   - Location of the memory-mapped file used by ``out_of_core``. Implies
+     ``out_of_core``. (Default: a temporary file)
+
  * - to_world
    - |transform|
    - Specifies an optional linear object-to-world transformation.
      (Default: none, i.e. object space = world space)
 
+ * - to_world_end
+   - |transform|
+   - Object-to-world transformation at time 1. When specified, the vertices move linearly
+     from their position given by ``to_world`` at time 0 to this one, which produces motion
+     blur with a sensor whose shutter is open during this interval. (Default: none, i.e. static)
+
  * - vertex_count
    - |int|
    - Total number of vertices
@@ -63,6 +92,12 @@ Serialized mesh loader (:monosp:`serialized`)
    - Vertex positions buffer (flatten) pre-multiplied by the object-to-world transformation.
    - |exposed|, |differentiable|, |discontinuous|
 
+ * - vertex_positions_end
+   - :paramtype:`float[]`
+   - Vertex positions buffer (flatten) at time 1, empty for static meshes. Setting it
+     enables deformation motion blur.
+   - |exposed|
+
  * - vertex_normals
    - :paramtype:`float[]`
    - Vertex normals buffer (flatten)  pre-multiplied by the object-to-world transformation.
@@ -207,7 +242,7 @@ public:
                     m_vertex_texcoords, m_faces, m_face_normals,
                     has_vertex_normals, has_vertex_texcoords,
                     recompute_vertex_normals, vertex_position, vertex_normal,
-                    initialize)
+                    initialize, m_emitter, m_sensor, m_out_of_core_file)
     MI_IMPORT_TYPES()
 
     using typename Base::ScalarSize;
@@ -235,10 +270,6 @@ public:
     }
 
     SerializedMesh(const Properties &props) : Base(props) {
-        auto fail = [&](const std::string &descr) {
-            Throw("Error while loading serialized file \"%s\": %s!", m_name, descr);
-        };
-
         auto fs = Thread::thread()->file_resolver();
         fs::path file_path = fs->resolve(props.string("filename"));
         m_name = file_path.filename().string();
@@ -252,120 +283,243 @@ public:
         if (shape_index < 0)
             fail("shape index must be nonnegative!");
 
+        /* When set, all meshes of the file starting at 'shape_index' are
+           loaded in parallel, and the plugin expands into one shape per mesh */
+        bool all_shapes = props.get<bool>("all_shapes", false);
+
         m_name = tfm::format("%s@%i", file_path.filename(), shape_index);
 
-        ref<Stream> stream = new FileStream(file_path);
         ScopedPhase phase(ProfilerPhase::LoadGeometry);
         Timer timer;
+
+        std::shared_ptr<SerializedFile> file = open_file(file_path);
+        size_t count = file->offsets.size();
+
+        if ((size_t) shape_index >= count)
+            fail(tfm::format("Unable to unserialize mesh, shape index is "
+                             "out of range! (requested %i out of 0..%i)",
+                             shape_index, count - 1));
+
+        size_t first = (size_t) shape_index,
+               last  = all_shapes ? count : first + 1;
+
+        if (last - first > 1 && (m_emitter || m_sensor))
+            fail("\"all_shapes\" cannot be combined with an emitter or sensor");
+
+        // Inflate all requested meshes concurrently
+        std::vector<MeshData> meshes(last - first);
+        dr::parallel_for(
+            dr::blocked_range<size_t>(first, last, 1),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                    meshes[i - first] = decode(*file, i);
+            }
+        );
+
+        Log(Debug, "\"%s\": inflated %zu mesh%s (took %s)", file_path.filename(),
+            meshes.size(), meshes.size() > 1 ? "es" : "",
+            util::time_string((float) timer.value()));
+
+        finalize(meshes[0]);
+
+        for (size_t i = 1; i < meshes.size(); ++i) {
+            ref<SerializedMesh> mesh = new SerializedMesh(props, first + i);
+            mesh->finalize(meshes[i]);
+            m_siblings.push_back(mesh.get());
+        }
+    }
+
+    std::vector<ref<Object>> expand() const override {
+        if (m_siblings.empty())
+            return { };
+
+        std::vector<ref<Object>> result;
+        result.push_back(const_cast<SerializedMesh *>(this));
+        for (const ref<Object> &mesh : m_siblings)
+            result.push_back(mesh);
+        return result;
+    }
+
+private:
+    /// Memory-mapped serialized file along with its end-of-file dictionary
+    struct SerializedFile {
+        ref<MemoryMappedFile> mmap;
+        short version;
+        std::vector<uint64_t> offsets;
+    };
+
+    /// Contents of one mesh in CPU memory
+    struct MeshData {
+        std::string name;
+        ScalarSize vertex_count = 0, face_count = 0;
+        std::unique_ptr<uint32_t[]> faces;
+        std::unique_ptr<float[]> vertex_positions;
+        std::unique_ptr<float[]> vertex_normals;
+        std::unique_ptr<float[]> vertex_texcoords;
+        bool has_normals = false, has_texcoords = false;
+        ScalarBoundingBox3f bbox;
+    };
+
+    /// Create a mesh for another shape of the same file (see \c all_shapes)
+    SerializedMesh(const Properties &props, size_t shape_index) : Base(props) {
+        if (!props.id().empty())
+            this->set_id(tfm::format("%s_%zu", props.id(), shape_index));
+        if (!m_out_of_core_file.empty())
+            m_out_of_core_file = m_out_of_core_file.string() +
+                                 tfm::format(".%zu", shape_index);
+    }
+
+    [[noreturn]] void fail(const std::string &descr) const {
+        Throw("Error while loading serialized file \"%s\": %s!", m_name, descr);
+    }
+
+    /**
+     * \brief Map a serialized file and read its end-of-file dictionary
+     *
+     * Meshes loaded concurrently from the same file share the mapping
+     * and the dictionary, which are released once the last one is done.
+     */
+    std::shared_ptr<SerializedFile> open_file(const fs::path &path) const {
+        static std::mutex mutex;
+        static std::unordered_map<std::string, std::weak_ptr<SerializedFile>> files;
+
+        std::lock_guard<std::mutex> guard(mutex);
+        std::shared_ptr<SerializedFile> file = files[path.string()].lock();
+        if (file)
+            return file;
+
+        file = std::make_shared<SerializedFile>();
+        file->mmap = new MemoryMappedFile(path);
+        size_t file_size = file->mmap->size();
+
+        ref<Stream> stream = new MemoryStream(file->mmap->data(), file_size);
         stream->set_byte_order(Stream::ELittleEndian);
 
-        short format = 0, version = 0;
+        short format = 0;
         stream->read(format);
-        stream->read(version);
+        stream->read(file->version);
 
         if (format != MI_FILEFORMAT_HEADER)
             fail("encountered an invalid file format!");
 
-        if (version != MI_FILEFORMAT_VERSION_V3 &&
-            version != MI_FILEFORMAT_VERSION_V4)
+        if (file->version != MI_FILEFORMAT_VERSION_V3 &&
+            file->version != MI_FILEFORMAT_VERSION_V4)
             fail("encountered an incompatible file version!");
 
-        if (shape_index != 0) {
-            size_t file_size = stream->size();
-
-            /* Determine the position of the requested substream. This
-               is stored at the end of the file */
+        /* The dictionary at the end of the file stores the offset of every
+           mesh. Files without a valid dictionary contain a single mesh. */
+        size_t entry_size = file->version == MI_FILEFORMAT_VERSION_V4
+                                ? sizeof(uint64_t) : sizeof(uint32_t);
+        uint32_t count = 0;
+        if (file_size >= 2 * sizeof(short) + sizeof(uint32_t)) {
             stream->seek(file_size - sizeof(uint32_t));
-
-            uint32_t count = 0;
             stream->read(count);
+        }
 
-            if (shape_index > (int) count)
-                fail(tfm::format("Unable to unserialize mesh, shape index is "
-                                 "out of range! (requested %i out of 0..%i)",
-                                 shape_index, count - 1));
-
-            // Seek to the correct position
-            if (version == MI_FILEFORMAT_VERSION_V4) {
-                stream->seek(file_size -
-                             sizeof(uint64_t) * (count - shape_index) -
-                             sizeof(uint32_t));
-                size_t offset = 0;
-                stream->read(offset);
-                stream->seek(offset);
-            } else {
-                Assert(version == MI_FILEFORMAT_VERSION_V3);
-                stream->seek(file_size -
-                             sizeof(uint32_t) * (count - shape_index + 1));
-                uint32_t offset = 0;
-                stream->read(offset);
-                stream->seek(offset);
+        bool valid = count > 0 &&
+            (size_t) count * entry_size + sizeof(uint32_t) <= file_size;
+        if (valid) {
+            stream->seek(file_size - sizeof(uint32_t) - count * entry_size);
+            file->offsets.resize(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                if (file->version == MI_FILEFORMAT_VERSION_V4) {
+                    uint64_t offset = 0;
+                    stream->read(offset);
+                    file->offsets[i] = offset;
+                } else {
+                    uint32_t offset = 0;
+                    stream->read(offset);
+                    file->offsets[i] = offset;
+                }
+                valid &= file->offsets[i] + 2 * sizeof(short) < file_size &&
+                         (i == 0 ? file->offsets[i] == 0
+                                 : file->offsets[i] > file->offsets[i - 1]);
             }
-            stream->skip(sizeof(short) * 2); // Skip the header
         }
 
+        if (!valid)
+            file->offsets = { 0 };
+
+        files[path.string()] = file;
+        return file;
+    }
+
+    /// Decompress one mesh of a serialized file. Thread-safe.
+    MeshData decode(const SerializedFile &file, size_t shape_index) const {
+        uint8_t *data = (uint8_t *) file.mmap->data();
+        size_t offset = file.offsets[shape_index];
+
+        ref<Stream> stream =
+            new MemoryStream(data + offset, file.mmap->size() - offset);
+        stream->set_byte_order(Stream::ELittleEndian);
+        stream->skip(sizeof(short) * 2); // Skip the header
+
         stream = new ZStream(stream);
         stream->set_byte_order(Stream::ELittleEndian);
 
+        MeshData mesh;
         uint32_t flags = 0;
         stream->read(flags);
-        if (version == MI_FILEFORMAT_VERSION_V4) {
+        if (file.version == MI_FILEFORMAT_VERSION_V4) {
             char ch = 0;
-            m_name = "";
             do {
                 stream->read(ch);
                 if (ch == 0)
                     break;
-                m_name += ch;
+                mesh.name += ch;
             } while (true);
+        } else {
+            mesh.name = tfm::format("%s@%zu", file.mmap->filename().filename(),
+                                    shape_index);
         }
 
         size_t vertex_count, face_count;
         stream->read(vertex_count);
         stream->read(face_count);
 
-        m_vertex_count = (ScalarSize) vertex_count;
-        m_face_count   = (ScalarSize) face_count;
+        mesh.vertex_count = (ScalarSize) vertex_count;
+        mesh.face_count   = (ScalarSize) face_count;
 
-        std::unique_ptr<uint32_t[]> faces(new uint32_t[m_face_count * 3]);
-        std::unique_ptr<float[]> vertex_positions(new float[m_vertex_count * 3]);
-        std::unique_ptr<float[]> vertex_normals(new float[m_vertex_count * 3]);
-        std::unique_ptr<float[]> vertex_texcoords(new float[m_vertex_count * 2]);
+        mesh.faces.reset(new uint32_t[mesh.face_count * 3]);
+        mesh.vertex_positions.reset(new float[mesh.vertex_count * 3]);
+        mesh.vertex_normals.reset(new float[mesh.vertex_count * 3]);
+        mesh.vertex_texcoords.reset(new float[mesh.vertex_count * 2]);
 
         bool double_precision = has_flag(flags, TriMeshFlags::DoublePrecision);
-        bool has_normals      = has_flag(flags, TriMeshFlags::HasNormals);
-        bool has_texcoords    = has_flag(flags, TriMeshFlags::HasTexcoords);
+        mesh.has_normals      = has_flag(flags, TriMeshFlags::HasNormals);
+        mesh.has_texcoords    = has_flag(flags, TriMeshFlags::HasTexcoords);
         bool has_colors       = has_flag(flags, TriMeshFlags::HasColors);
 
-        read_helper(stream, double_precision, vertex_positions.get(), 3);
+        size_t n = mesh.vertex_count;
+        read_helper(stream, double_precision, mesh.vertex_positions.get(), n, 3);
 
-        if (has_normals) {
+        if (mesh.has_normals) {
             if (m_face_normals)
                 // Skip over vertex normals provided in the file.
-                advance_helper(stream, double_precision, 3);
+                advance_helper(stream, double_precision, n, 3);
             else
-                read_helper(stream, double_precision, vertex_normals.get(), 3);
+                read_helper(stream, double_precision, mesh.vertex_normals.get(), n, 3);
         }
 
-        if (has_texcoords)
-            read_helper(stream, double_precision, vertex_texcoords.get(), 2);
+        if (mesh.has_texcoords)
+            read_helper(stream, double_precision, mesh.vertex_texcoords.get(), n, 2);
 
         if (has_colors)
-            advance_helper(stream, double_precision, 3); // TODO
+            advance_helper(stream, double_precision, n, 3); // TODO
 
-        stream->read(faces.get(), m_face_count * sizeof(ScalarIndex) * 3);
+        stream->read(mesh.faces.get(), mesh.face_count * sizeof(ScalarIndex) * 3);
 
         // Post-processing
-        InputFloat* position_ptr = vertex_positions.get();
-        InputFloat* normal_ptr   = vertex_normals.get();
-        for (ScalarSize i = 0; i < m_vertex_count; ++i) {
+        InputFloat* position_ptr = mesh.vertex_positions.get();
+        InputFloat* normal_ptr   = mesh.vertex_normals.get();
+        for (ScalarSize i = 0; i < mesh.vertex_count; ++i) {
             InputPoint3f p = m_to_world.scalar().transform_affine(
                 dr::load<InputPoint3f>(position_ptr));
             dr::store(position_ptr, p);
             position_ptr += 3;
-            m_bbox.expand(p);
+            mesh.bbox.expand(p);
 
-            if (has_normals) {
+            if (mesh.has_normals && !m_face_normals) {
                 InputNormal3f n = dr::load<InputNormal3f>(normal_ptr);
                 n = dr::normalize(m_to_world.scalar().transform_affine(n));
                 dr::store(normal_ptr, n);
@@ -373,26 +527,38 @@ public:
             }
         }
 
-        m_faces = dr::load<DynamicBuffer<UInt32>>(faces.get(), m_face_count * 3);
-        m_vertex_positions = dr::load<FloatStorage>(vertex_positions.get(), m_vertex_count * 3);
+        return mesh;
+    }
+
+    /// Upload decompressed mesh data and initialize the mesh
+    void finalize(MeshData &mesh) {
+        m_name         = mesh.name;
+        m_vertex_count = mesh.vertex_count;
+        m_face_count   = mesh.face_count;
+        m_bbox         = mesh.bbox;
+
+        m_faces = dr::load<DynamicBuffer<UInt32>>(mesh.faces.get(), m_face_count * 3);
+        m_vertex_positions = dr::load<FloatStorage>(mesh.vertex_positions.get(), m_vertex_count * 3);
         if (!m_face_normals)
-            m_vertex_normals = dr::load<FloatStorage>(vertex_normals.get(), m_vertex_count * 3);
-        if (has_texcoords)
-            m_vertex_texcoords = dr::load<FloatStorage>(vertex_texcoords.get(), m_vertex_count * 2);
+            m_vertex_normals = dr::load<FloatStorage>(mesh.vertex_normals.get(), m_vertex_count * 3);
+        if (mesh.has_texcoords)
+            m_vertex_texcoords = dr::load<FloatStorage>(mesh.vertex_texcoords.get(), m_vertex_count * 2);
 
         size_t vertex_data_bytes = 3 * sizeof(InputFloat);
         if (!m_face_normals)
             vertex_data_bytes += 3 * sizeof(InputFloat);
-        if (has_texcoords)
+        if (mesh.has_texcoords)
             vertex_data_bytes += 2 * sizeof(InputFloat);
 
-        Log(Debug, "\"%s\": read %i faces, %i vertices (%s in %s)",
+        Log(Debug, "\"%s\": read %i faces, %i vertices (%s)",
             m_name, m_face_count, m_vertex_count,
             util::mem_string(m_face_count * 3 * sizeof(ScalarIndex) +
-                             m_vertex_count * vertex_data_bytes),
-            util::time_string((float) timer.value())
+                             m_vertex_count * vertex_data_bytes)
         );
 
+        bool has_normals = mesh.has_normals;
+        mesh = MeshData();
+
         if (!m_face_normals && !has_normals) {
             Timer timer2;
             recompute_vertex_normals();
@@ -403,16 +569,15 @@ public:
         initialize();
     }
 
-    void read_helper(Stream *stream, bool dp, InputFloat* dst, size_t dim) {
+    static void read_helper(Stream *stream, bool dp, InputFloat* dst,
+                            size_t count, size_t dim) {
         if (dp) {
-            std::unique_ptr<double[]> values(new double[m_vertex_count * dim]);
-            stream->read_array(values.get(), m_vertex_count * dim);
-            for (size_t i = 0; i < m_vertex_count * dim; ++i)
+            std::unique_ptr<double[]> values(new double[count * dim]);
+            stream->read_array(values.get(), count * dim);
+            for (size_t i = 0; i < count * dim; ++i)
                 dst[i] = (float) values[i];
         } else {
-            std::unique_ptr<float[]> values(new float[m_vertex_count * dim]);
-            stream->read_array(values.get(), m_vertex_count * dim);
-            memcpy(dst, values.get(), m_vertex_count * sizeof(InputFloat) * dim);
+            stream->read_array(dst, count * dim);
         }
     }
 
@@ -421,16 +586,20 @@ public:
      * Since compressed streams do not provide `tell` and `seek`
      * implementations, we have to read and discard the data.
      */
-    void advance_helper(Stream *stream, bool dp, size_t dim) {
+    static void advance_helper(Stream *stream, bool dp, size_t count, size_t dim) {
         if (dp) {
-            std::unique_ptr<double[]> values(new double[m_vertex_count * dim]);
-            stream->read_array(values.get(), m_vertex_count * dim);
+            std::unique_ptr<double[]> values(new double[count * dim]);
+            stream->read_array(values.get(), count * dim);
         } else {
-            std::unique_ptr<float[]> values(new float[m_vertex_count * dim]);
-            stream->read_array(values.get(), m_vertex_count * dim);
+            std::unique_ptr<float[]> values(new float[count * dim]);
+            stream->read_array(values.get(), count * dim);
         }
     }
 
+    /// Additional meshes of the same file (see \c all_shapes)
+    std::vector<ref<Object>> m_siblings;
+
+public:
     MI_DECLARE_CLASS()
 };
 
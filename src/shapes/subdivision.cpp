@@ -0,0 +1,574 @@
+#include <mitsuba/render/mesh.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/timer.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/core/profiler.h>
+#include <mitsuba/core/string.h>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+
+.. _shape-subdivision:
+
+Subdivision surface (:monosp:`subdivision`)
+-------------------------------------------
+
+.. pluginparameters::
+
+ * - (Nested plugin)
+   - |shape|
+   - The control mesh of the surface (e.g. a :ref:`ply <shape-ply>` or
+     :ref:`obj <shape-obj>` shape).
+
+ * - level
+   - |int|
+   - Number of subdivision steps when no viewpoint is given (Default: 2)
+
+ * - view_origin
+   - |point|
+   - Position of the sensor. When specified, the number of subdivision steps
+     is chosen so that the edges of the tessellation closest to the sensor
+     span about :monosp:`edge_pixels` pixels.
+
+ * - fov
+   - |float|
+   - Horizontal field of view of the sensor in degrees (Default: 45)
+
+ * - resolution
+   - |int|
+   - Horizontal resolution of the sensor in pixels (Default: 1024)
+
+ * - edge_pixels
+   - |float|
+   - Targeted length of the tessellated edges in pixels (Default: 2)
+
+ * - max_level
+   - |int|
+   - Upper bound on the number of subdivision steps (Default: 5)
+
+ * - face_normals
+   - |bool|
+   - When set to |true|, any existing or computed vertex normals are
+     discarded and *face normals* will instead be used during rendering.
+     This gives the rendered object a faceted appearance. (Default: |false|)
+
+ * - flip_normals
+   - |bool|
+   - Is the mesh inverted, i.e. should the normal vectors be flipped? (Default:|false|, i.e.
+     the normals point outside)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional linear object-to-world transformation. (Default: none, i.e. object space = world space)
+
+This plugin interprets a triangle mesh as the control cage of a Catmull-Clark
+subdivision surface and tessellates it when the scene is loaded. The result
+is a regular triangle mesh, which supports texture coordinates, attributes and
+sampling like any other mesh.
+
+Vertex positions follow the Catmull-Clark rules, where boundary and
+non-manifold edges are treated as sharp creases. Vertices on a seam of the
+texture parameterization (i.e. vertices that only share their position) are
+welded for this purpose. Texture coordinates and ``vertex_`` attributes are
+interpolated linearly within each control face, and ``face_`` attributes are
+inherited from the control face. Vertex normals are recomputed from the
+tessellation.
+
+When :monosp:`view_origin` is specified, the tessellation rate follows the
+screen-space footprint of the surface: faraway objects are subdivided fewer
+times than close-ups, which avoids storing pre-tessellated geometry at a fixed
+rate.
+
+.. tabs::
+    .. code-tab:: xml
+        :name: subdivision
+
+        <shape type="subdivision">
+            <shape type="ply">
+                <string name="filename" value="cage.ply"/>
+            </shape>
+            <point name="view_origin" x="0" y="1" z="10"/>
+            <float name="fov" value="39.3"/>
+        </shape>
+
+    .. code-tab:: python
+
+        'character': {
+            'type': 'subdivision',
+            'cage': {
+                'type': 'ply',
+                'filename': 'cage.ply'
+            },
+            'view_origin': [0, 1, 10],
+            'fov': 39.3
+        }
+ */
+
+template <typename Float, typename Spectrum>
+class SubdivisionMesh final : public Mesh<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Mesh, m_name, m_to_world, m_vertex_count, m_face_count,
+                   m_vertex_positions, m_vertex_normals,
+                   m_vertex_texcoords, m_faces,
+                   m_face_normals, add_attribute, recompute_vertex_normals,
+                   initialize)
+    MI_IMPORT_TYPES()
+
+    using typename Base::ScalarSize;
+    using typename Base::ScalarIndex;
+    using typename Base::InputFloat;
+    using typename Base::FloatStorage;
+
+private:
+    /**
+     * \brief Polygon mesh with per-corner data
+     *
+     * Face \c f consists of the corners <tt>[offsets[f], offsets[f+1])</tt>.
+     * The per-corner data (texture coordinates and vertex attributes) is
+     * stored with a stride of \c m_corner_dim values.
+     */
+    struct PolyMesh {
+        std::vector<ScalarPoint3f> positions;
+        std::vector<uint32_t> offsets { 0 };
+        std::vector<uint32_t> vertices;
+        std::vector<uint32_t> parents;
+        std::vector<InputFloat> data;
+
+        size_t face_count() const { return offsets.size() - 1; }
+    };
+
+    /// Vertex attribute interpolated within the control faces
+    struct Channel {
+        std::string name;
+        size_t dim, offset;
+    };
+
+public:
+    SubdivisionMesh(const Properties &props) : Base(props) {
+        ref<Base> cage;
+        for (auto &[name, obj] : props.objects(false)) {
+            Base *mesh = dynamic_cast<Base *>(obj.get());
+            if (!mesh)
+                continue;
+            if (cage)
+                Throw("Only a single control mesh can be specified per "
+                      "\"subdivision\" shape!");
+            cage = mesh;
+            props.mark_queried(name);
+        }
+
+        if (!cage)
+            Throw("A \"subdivision\" shape requires a nested control mesh!");
+        if (cage->face_count() == 0)
+            Throw("\"%s\": the control mesh is empty!", cage->id());
+
+        m_name = cage->id();
+        ScopedPhase phase(ProfilerPhase::LoadGeometry);
+        Timer timer;
+
+        PolyMesh mesh = load_cage(cage.get());
+
+        m_max_level = props.get<ScalarSize>("max_level", 5);
+        if (props.has_property("view_origin"))
+            m_level = screen_space_level(mesh, props);
+        else
+            m_level = std::min(props.get<ScalarSize>("level", 2), m_max_level);
+
+        for (ScalarSize i = 0; i < m_level; ++i)
+            mesh = subdivide(mesh);
+
+        store(mesh);
+
+        if (!m_face_normals) {
+            m_vertex_normals = dr::zeros<FloatStorage>(m_vertex_count * 3);
+            recompute_vertex_normals();
+        }
+
+        Log(Debug, "\"%s\": subdivided %u control faces %u times into %u "
+            "triangles (took %s)", m_name, cage->face_count(), m_level,
+            m_face_count, util::time_string((float) timer.value()));
+
+        initialize();
+    }
+
+    /// Return the number of subdivision steps that were applied
+    ScalarSize level() const { return m_level; }
+
+    MI_DECLARE_CLASS()
+
+private:
+    // =============================================================
+    //! @{ \name Conversion between meshes
+    // =============================================================
+
+    /// Convert the control mesh into a polygon mesh with welded positions
+    PolyMesh load_cage(Base *cage) {
+        auto&& positions = dr::migrate(cage->vertex_positions_buffer(), AllocType::Host);
+        auto&& texcoords = dr::migrate(cage->vertex_texcoords_buffer(), AllocType::Host);
+        auto&& faces     = dr::migrate(cage->faces_buffer(), AllocType::Host);
+
+        // Per-vertex data that is interpolated within the control faces
+        std::vector<std::pair<FloatStorage, size_t>> sources;
+        m_corner_dim = 0;
+        if (cage->has_vertex_texcoords()) {
+            m_has_texcoords = true;
+            m_corner_dim = 2;
+        }
+        for (auto &[name, dim] : cage->mesh_attribute_dims()) {
+            if (string::starts_with(name, "vertex_")) {
+                m_channels.push_back({ name, dim, m_corner_dim });
+                m_corner_dim += dim;
+                sources.emplace_back(
+                    dr::migrate(cage->attribute_buffer(name), AllocType::Host), dim);
+            } else {
+                m_face_attributes.push_back({ name, dim, 0 });
+                m_face_attribute_data.push_back(
+                    dr::migrate(cage->attribute_buffer(name), AllocType::Host));
+            }
+        }
+
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+
+        size_t vertex_count = cage->vertex_count(),
+               face_count   = cage->face_count();
+        const InputFloat *p  = positions.data();
+        const ScalarIndex *f = faces.data();
+
+        /* Weld vertices with identical positions, which are commonly
+           duplicated along seams of the texture parameterization */
+        std::vector<uint32_t> order(vertex_count), remap(vertex_count);
+        for (uint32_t i = 0; i < vertex_count; ++i)
+            order[i] = i;
+        auto key = [p](uint32_t i) {
+            uint32_t k[3];
+            memcpy(k, p + 3 * i, sizeof(k));
+            return std::make_tuple(k[0], k[1], k[2]);
+        };
+        std::sort(order.begin(), order.end(),
+                  [&](uint32_t a, uint32_t b) { return key(a) < key(b); });
+
+        PolyMesh result;
+        for (size_t k = 0; k < vertex_count; ++k) {
+            uint32_t i = order[k];
+            if (k == 0 || key(order[k - 1]) != key(i))
+                result.positions.push_back(
+                    ScalarPoint3f(p[3 * i], p[3 * i + 1], p[3 * i + 2]));
+            remap[i] = (uint32_t) result.positions.size() - 1;
+        }
+
+        result.offsets.reserve(face_count + 1);
+        result.vertices.reserve(face_count * 3);
+        result.parents.reserve(face_count);
+        result.data.reserve(face_count * 3 * m_corner_dim);
+
+        for (size_t i = 0; i < face_count; ++i) {
+            for (int j = 0; j < 3; ++j) {
+                uint32_t v = f[3 * i + j];
+                result.vertices.push_back(remap[v]);
+                if (m_has_texcoords) {
+                    result.data.push_back(texcoords.data()[2 * v]);
+                    result.data.push_back(texcoords.data()[2 * v + 1]);
+                }
+                for (auto &[buf, dim] : sources)
+                    for (size_t d = 0; d < dim; ++d)
+                        result.data.push_back(buf.data()[dim * v + d]);
+            }
+            result.offsets.push_back((uint32_t) result.vertices.size());
+            result.parents.push_back((uint32_t) i);
+        }
+
+        return result;
+    }
+
+    /// Triangulate a polygon mesh and store it in the mesh buffers
+    void store(const PolyMesh &mesh) {
+        size_t corner_count = mesh.vertices.size();
+
+        // Distinct (position, corner data) pairs become the output vertices
+        std::vector<uint32_t> corner_vertex(corner_count);
+        std::vector<uint32_t> vertex_source;
+        if (m_corner_dim == 0) {
+            for (size_t c = 0; c < corner_count; ++c)
+                corner_vertex[c] = mesh.vertices[c];
+            vertex_source.resize(mesh.positions.size());
+        } else {
+            std::unordered_map<std::string, uint32_t> vertex_map;
+            vertex_map.reserve(corner_count / 2);
+            std::string key(sizeof(uint32_t) + m_corner_dim * sizeof(InputFloat), '\0');
+            for (size_t c = 0; c < corner_count; ++c) {
+                memcpy(&key[0], &mesh.vertices[c], sizeof(uint32_t));
+                memcpy(&key[sizeof(uint32_t)], mesh.data.data() + c * m_corner_dim,
+                       m_corner_dim * sizeof(InputFloat));
+                auto [it, inserted] =
+                    vertex_map.try_emplace(key, (uint32_t) vertex_source.size());
+                if (inserted)
+                    vertex_source.push_back((uint32_t) c);
+                corner_vertex[c] = it->second;
+            }
+        }
+
+        m_vertex_count = (ScalarSize) vertex_source.size();
+
+        std::vector<InputFloat> positions(m_vertex_count * 3),
+                                texcoords(m_has_texcoords ? m_vertex_count * 2 : 0);
+        for (size_t i = 0; i < m_vertex_count; ++i) {
+            uint32_t v = m_corner_dim == 0 ? (uint32_t) i
+                                           : mesh.vertices[vertex_source[i]];
+            ScalarPoint3f p = m_to_world.scalar().transform_affine(mesh.positions[v]);
+            for (int k = 0; k < 3; ++k)
+                positions[3 * i + k] = (InputFloat) p[k];
+            if (m_has_texcoords) {
+                const InputFloat *d = mesh.data.data() + vertex_source[i] * m_corner_dim;
+                texcoords[2 * i]     = d[0];
+                texcoords[2 * i + 1] = d[1];
+            }
+        }
+
+        for (const Channel &ch : m_channels) {
+            std::vector<InputFloat> buf(m_vertex_count * ch.dim);
+            for (size_t i = 0; i < m_vertex_count; ++i) {
+                const InputFloat *d = mesh.data.data() +
+                                      vertex_source[i] * m_corner_dim + ch.offset;
+                std::copy(d, d + ch.dim, buf.data() + i * ch.dim);
+            }
+            add_attribute(ch.name, ch.dim, buf);
+        }
+
+        // Quads are split along their first diagonal
+        std::vector<ScalarIndex> faces;
+        std::vector<uint32_t> parents;
+        faces.reserve(corner_count * 3 / 2);
+        parents.reserve(corner_count / 2);
+        for (size_t f = 0; f < mesh.face_count(); ++f) {
+            uint32_t begin = mesh.offsets[f], end = mesh.offsets[f + 1];
+            for (uint32_t c = begin + 1; c + 1 < end; ++c) {
+                faces.push_back(corner_vertex[begin]);
+                faces.push_back(corner_vertex[c]);
+                faces.push_back(corner_vertex[c + 1]);
+                parents.push_back(mesh.parents[f]);
+            }
+        }
+        m_face_count = (ScalarSize) parents.size();
+
+        for (size_t i = 0; i < m_face_attributes.size(); ++i) {
+            const Channel &ch = m_face_attributes[i];
+            const InputFloat *src = m_face_attribute_data[i].data();
+            std::vector<InputFloat> buf(m_face_count * ch.dim);
+            for (size_t f = 0; f < m_face_count; ++f)
+                std::copy(src + parents[f] * ch.dim, src + (parents[f] + 1) * ch.dim,
+                          buf.data() + f * ch.dim);
+            add_attribute(ch.name, ch.dim, buf);
+        }
+        m_face_attribute_data.clear();
+
+        m_vertex_positions = dr::load<FloatStorage>(positions.data(), m_vertex_count * 3);
+        if (m_has_texcoords)
+            m_vertex_texcoords = dr::load<FloatStorage>(texcoords.data(), m_vertex_count * 2);
+        m_faces = dr::load<DynamicBuffer<UInt32>>(faces.data(), m_face_count * 3);
+    }
+
+    //! @}
+    // =============================================================
+
+    // =============================================================
+    //! @{ \name Subdivision
+    // =============================================================
+
+    /// Number of subdivision steps that match the screen-space footprint
+    ScalarSize screen_space_level(const PolyMesh &mesh, const Properties &props) const {
+        ScalarPoint3f origin = props.get<ScalarPoint3f>("view_origin");
+        ScalarFloat fov = props.get<ScalarFloat>("fov", 45.f),
+                    edge_pixels = props.get<ScalarFloat>("edge_pixels", 2.f);
+        ScalarSize resolution = props.get<ScalarSize>("resolution", 1024);
+        if (!(fov > 0.f && fov < 180.f) || !(edge_pixels > 0.f) || resolution == 0)
+            Throw("\"%s\": invalid screen-space tessellation parameters!", m_name);
+
+        ScalarBoundingBox3f bbox;
+        double edge_length = 0.0;
+        for (size_t f = 0; f < mesh.face_count(); ++f) {
+            uint32_t begin = mesh.offsets[f], end = mesh.offsets[f + 1];
+            for (uint32_t c = begin; c < end; ++c) {
+                uint32_t next = c + 1 == end ? begin : c + 1;
+                ScalarPoint3f p0 = m_to_world.scalar().transform_affine(mesh.positions[mesh.vertices[c]]),
+                              p1 = m_to_world.scalar().transform_affine(mesh.positions[mesh.vertices[next]]);
+                edge_length += (double) dr::norm(p1 - p0);
+                bbox.expand(p0);
+            }
+        }
+        edge_length /= (double) mesh.vertices.size();
+
+        // World-space size of a pixel at the closest point of the surface
+        ScalarFloat distance = dr::maximum(bbox.distance(origin),
+                                           dr::norm(bbox.extents()) * 1e-3f),
+                    pixel = 2.f * distance * dr::tan(dr::deg_to_rad(fov) * .5f) /
+                            (ScalarFloat) resolution;
+
+        // Every subdivision step halves the edge lengths
+        double steps = std::ceil(std::log2(edge_length / (edge_pixels * pixel)));
+        if (!(steps > 0.0))
+            return 0;
+        return (ScalarSize) std::clamp(steps, 0.0, (double) m_max_level);
+    }
+
+    /// Apply one step of Catmull-Clark subdivision
+    PolyMesh subdivide(const PolyMesh &m) const {
+        size_t vertex_count = m.positions.size(),
+               face_count   = m.face_count(),
+               corner_count = m.vertices.size();
+
+        // Face points
+        std::vector<ScalarPoint3f> face_points(face_count);
+        for (size_t f = 0; f < face_count; ++f) {
+            ScalarPoint3f sum(0.f);
+            for (uint32_t c = m.offsets[f]; c < m.offsets[f + 1]; ++c)
+                sum += m.positions[m.vertices[c]];
+            face_points[f] = sum / (ScalarFloat) (m.offsets[f + 1] - m.offsets[f]);
+        }
+
+        // Edges, identified by their sorted vertex pair
+        std::unordered_map<uint64_t, uint32_t> edge_map;
+        edge_map.reserve(corner_count);
+        std::vector<uint32_t> corner_edge(corner_count), edge_faces;
+        std::vector<std::pair<uint32_t, uint32_t>> edges;
+        std::vector<ScalarVector3f> edge_face_sum;
+
+        std::vector<uint32_t> vertex_faces(vertex_count, 0);
+        std::vector<ScalarVector3f> vertex_face_sum(vertex_count, ScalarVector3f(0.f));
+
+        for (size_t f = 0; f < face_count; ++f) {
+            uint32_t begin = m.offsets[f], end = m.offsets[f + 1];
+            for (uint32_t c = begin; c < end; ++c) {
+                uint32_t a = m.vertices[c],
+                         b = m.vertices[c + 1 == end ? begin : c + 1];
+                uint64_t key = ((uint64_t) std::min(a, b) << 32) | std::max(a, b);
+                auto [it, inserted] = edge_map.try_emplace(key, (uint32_t) edges.size());
+                if (inserted) {
+                    edges.emplace_back(a, b);
+                    edge_faces.push_back(0);
+                    edge_face_sum.push_back(ScalarVector3f(0.f));
+                }
+                uint32_t e = it->second;
+                corner_edge[c] = e;
+                edge_faces[e]++;
+                edge_face_sum[e] += face_points[f];
+                vertex_faces[a]++;
+                vertex_face_sum[a] += face_points[f];
+            }
+        }
+        edge_map = std::unordered_map<uint64_t, uint32_t>();
+
+        // Edge points. Boundary and non-manifold edges are sharp creases.
+        size_t edge_count = edges.size();
+        std::vector<ScalarPoint3f> edge_points(edge_count);
+        std::vector<uint32_t> vertex_edges(vertex_count, 0), vertex_creases(vertex_count, 0);
+        std::vector<ScalarVector3f> vertex_mid_sum(vertex_count, ScalarVector3f(0.f)),
+                                    vertex_crease_sum(vertex_count, ScalarVector3f(0.f));
+
+        for (size_t e = 0; e < edge_count; ++e) {
+            auto [a, b] = edges[e];
+            ScalarPoint3f pa = m.positions[a], pb = m.positions[b],
+                          mid = (pa + pb) * .5f;
+            bool crease = edge_faces[e] != 2;
+
+            edge_points[e] = crease ? mid : (pa + pb + edge_face_sum[e]) * .25f;
+
+            vertex_edges[a]++; vertex_edges[b]++;
+            vertex_mid_sum[a] += mid; vertex_mid_sum[b] += mid;
+            if (crease) {
+                vertex_creases[a]++; vertex_creases[b]++;
+                vertex_crease_sum[a] += pb; vertex_crease_sum[b] += pa;
+            }
+        }
+
+        PolyMesh result;
+        result.positions.resize(vertex_count + edge_count + face_count);
+
+        // Vertex points
+        for (size_t v = 0; v < vertex_count; ++v) {
+            ScalarPoint3f p = m.positions[v];
+            if (vertex_creases[v] == 2) {
+                p = ScalarPoint3f(p * .75f + vertex_crease_sum[v] * .125f);
+            } else if (vertex_creases[v] == 0 && vertex_faces[v] > 0) {
+                ScalarFloat n = (ScalarFloat) vertex_faces[v];
+                ScalarVector3f q = vertex_face_sum[v] / n,
+                               r = vertex_mid_sum[v] / (ScalarFloat) vertex_edges[v];
+                p = ScalarPoint3f((q + 2.f * r + (n - 3.f) * p) / n);
+            }
+            // Corners (other crease configurations) and isolated vertices stay put
+            result.positions[v] = p;
+        }
+        std::copy(edge_points.begin(), edge_points.end(),
+                  result.positions.begin() + vertex_count);
+        std::copy(face_points.begin(), face_points.end(),
+                  result.positions.begin() + vertex_count + edge_count);
+
+        // Every face of degree k is split into k quads
+        result.offsets.reserve(corner_count + 1);
+        result.vertices.reserve(corner_count * 4);
+        result.parents.reserve(corner_count);
+        result.data.reserve(corner_count * 4 * m_corner_dim);
+
+        uint32_t edge_base = (uint32_t) vertex_count,
+                 face_base = (uint32_t) (vertex_count + edge_count);
+        std::vector<InputFloat> center(m_corner_dim);
+
+        for (size_t f = 0; f < face_count; ++f) {
+            uint32_t begin = m.offsets[f], end = m.offsets[f + 1], k = end - begin;
+
+            const InputFloat *data = m.data.data();
+            if (m_corner_dim > 0) {
+                std::fill(center.begin(), center.end(), 0.f);
+                for (uint32_t c = begin; c < end; ++c)
+                    for (size_t d = 0; d < m_corner_dim; ++d)
+                        center[d] += data[c * m_corner_dim + d] / (InputFloat) k;
+            }
+
+            for (uint32_t c = begin; c < end; ++c) {
+                uint32_t next = c + 1 == end ? begin : c + 1,
+                         prev = c == begin ? end - 1 : c - 1;
+
+                result.vertices.push_back(m.vertices[c]);
+                result.vertices.push_back(edge_base + corner_edge[c]);
+                result.vertices.push_back(face_base + (uint32_t) f);
+                result.vertices.push_back(edge_base + corner_edge[prev]);
+                result.offsets.push_back((uint32_t) result.vertices.size());
+                result.parents.push_back(m.parents[f]);
+
+                if (m_corner_dim > 0) {
+                    const InputFloat *d_c    = data + c * m_corner_dim,
+                                     *d_next = data + next * m_corner_dim,
+                                     *d_prev = data + prev * m_corner_dim;
+                    for (size_t d = 0; d < m_corner_dim; ++d)
+                        result.data.push_back(d_c[d]);
+                    for (size_t d = 0; d < m_corner_dim; ++d)
+                        result.data.push_back((d_c[d] + d_next[d]) * .5f);
+                    for (size_t d = 0; d < m_corner_dim; ++d)
+                        result.data.push_back(center[d]);
+                    for (size_t d = 0; d < m_corner_dim; ++d)
+                        result.data.push_back((d_prev[d] + d_c[d]) * .5f);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    //! @}
+    // =============================================================
+
+private:
+    ScalarSize m_level = 0, m_max_level = 5;
+    bool m_has_texcoords = false;
+    size_t m_corner_dim = 0;
+    std::vector<Channel> m_channels, m_face_attributes;
+    std::vector<FloatStorage> m_face_attribute_data;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SubdivisionMesh, Mesh)
+MI_EXPORT_PLUGIN(SubdivisionMesh, "Subdivision surface")
+NAMESPACE_END(mitsuba)
@@ -0,0 +1,83 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def create_blender_data(smooth=(True, True), mat_nr=(0, 0)):
+    # Two quads that share an edge, in the memory layout of Blender 3.x
+    import numpy as np
+    positions = np.array([[0, 0, 0], [1, 0, 0], [2, 0, 0],
+                          [0, 1, 0], [1, 1, 0], [2, 1, 0]], dtype=np.float32)
+
+    verts = np.zeros(6, dtype=[('co', '<f4', 3), ('flag', 'i1'),
+                               ('bweight', 'i1'), ('pad', 'i1', 2)])
+    verts['co'] = positions
+    normals = np.tile(np.array([0, 0, 1], dtype=np.float32), (6, 1))
+
+    quads = [[0, 1, 4, 3], [1, 2, 5, 4]]
+    loops = np.zeros(8, dtype=[('v', '<u4'), ('e', '<u4')])
+    loops['v'] = np.array(quads).ravel()
+
+    polys = np.zeros(2, dtype=[('loopstart', '<i4'), ('totloop', '<i4'),
+                               ('mat_nr', '<i2'), ('flag', 'i1'), ('pad', 'i1')])
+    polys['loopstart'] = [0, 4]
+    polys['totloop'] = 4
+    polys['mat_nr'] = mat_nr
+    polys['flag'] = [1 if s else 0 for s in smooth]
+
+    loop_tris = np.zeros(4, dtype=[('tri', '<u4', 3), ('poly', '<u4')])
+    loop_tris['tri'] = [[0, 1, 2], [0, 2, 3], [4, 5, 6], [4, 6, 7]]
+    loop_tris['poly'] = [0, 0, 1, 1]
+
+    uvs = np.zeros(8, dtype=[('uv', '<f4', 2), ('flag', '<i4')])
+    uvs['uv'] = positions[loops['v'], :2] / [2, 1]
+
+    arrays = (verts, normals, loops, polys, loop_tris, uvs)
+    props = {
+        'type': 'blender',
+        'name': 'quads',
+        'mat_nr': 0,
+        'vert_count': 6,
+        'loop_tri_count': 4,
+        'verts': verts.ctypes.data,
+        'normals': normals.ctypes.data,
+        'loops': loops.ctypes.data,
+        'polys': polys.ctypes.data,
+        'loop_tris': loop_tris.ctypes.data,
+        'uvs': uvs.ctypes.data,
+    }
+    return props, positions, arrays
+
+
+def test01_smooth(variant_scalar_rgb):
+    import numpy as np
+    props, positions, arrays = create_blender_data()
+    mesh = mi.load_dict(props)
+
+    # No vertex is split: the mesh keeps the vertex order of Blender
+    assert mesh.vertex_count() == 6
+    assert mesh.face_count() == 4
+    params = mi.traverse(mesh)
+    assert dr.allclose(params['vertex_positions'], positions.ravel())
+    assert dr.allclose(params['vertex_texcoords'],
+                       np.stack([positions[:, 0] / 2,
+                                 1 - positions[:, 1]], axis=-1).ravel())
+    assert dr.allclose(mesh.surface_area(), 2)
+
+
+def test02_split_and_materials(variant_scalar_rgb):
+    props, _, arrays = create_blender_data(smooth=(True, False))
+    mesh = mi.load_dict(props)
+
+    # The vertices of the shared edge are split between the smooth and the
+    # flat quad, the smooth quad's vertices are created first
+    assert mesh.vertex_count() == 8
+    assert mesh.face_count() == 4
+    params = mi.traverse(mesh)
+    assert dr.allclose(params['faces'], [0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7])
+
+    props, _, arrays = create_blender_data(mat_nr=(0, 1))
+    mesh = mi.load_dict(props)
+    assert mesh.vertex_count() == 4
+    assert mesh.face_count() == 2
+    assert dr.allclose(mesh.surface_area(), 1)
@@ -293,3 +293,57 @@ def test08_instancing(variant_llvm_ad_rgb):
 
     assert dr.all(pi1.is_valid())
     assert dr.all(pi2.is_valid())
+
+
+def test09_load_hair_file(variants_all_rgb, tmp_path):
+    pytest.importorskip("numpy")
+    import numpy as np
+
+    # Two strands with 4 and 6 points, and one that is too short
+    strands = [
+        np.array([[-1, 0.1, 0.1], [-0.3, 1.2, 1.0], [0.3, 0.3, 1.1], [1.0, 1.4, 1.2]]),
+        np.array([[-1, 5, 2.2], [-2.3, 4, 2.3], [3.3, 3, 2.2],
+                  [4, 2, 2.3], [4, 1, 2.2], [4, 0, 2.3]]),
+        np.array([[0, 0, 0], [1, 1, 1]])
+    ]
+    thickness = [np.full(len(s), 0.2) for s in strands]
+    thickness[1] = np.linspace(0.2, 1.2, 6)
+
+    header = np.zeros(128, dtype=np.uint8)
+    header[:4] = np.frombuffer(b'HAIR', dtype=np.uint8)
+    header[4:20] = np.frombuffer(np.array(
+        [len(strands), sum(len(s) for s in strands), 1 | 2 | 4, 0],
+        dtype=np.uint32).tobytes(), dtype=np.uint8)
+
+    hair_file = tmp_path / 'strands.hair'
+    with open(hair_file, 'wb') as f:
+        f.write(header.tobytes())
+        f.write(np.array([len(s) - 1 for s in strands], dtype=np.uint16).tobytes())
+        f.write(np.concatenate(strands).astype(np.float32).tobytes())
+        f.write(np.concatenate(thickness).astype(np.float32).tobytes())
+
+    text_file = tmp_path / 'strands.txt'
+    with open(text_file, 'w') as f:
+        for s, t in zip(strands[:2], thickness[:2]):
+            for p, w in zip(s, t):
+                f.write(f'{p[0]} {p[1]} {p[2]} {w / 2}\n')
+            f.write('\n')
+
+    to_world = mi.ScalarTransform4f.translate([1, 2, 3]) @ mi.ScalarTransform4f.scale(2)
+    hair = mi.load_dict({ 'type' : 'bsplinecurve', 'filename' : str(hair_file),
+                          'to_world' : to_world })
+    text = mi.load_dict({ 'type' : 'bsplinecurve', 'filename' : str(text_file),
+                          'to_world' : to_world })
+
+    assert hair.primitive_count() == 1 + 3
+    assert text.primitive_count() == hair.primitive_count()
+    assert dr.allclose(hair.bbox().min, text.bbox().min)
+    assert dr.allclose(hair.bbox().max, text.bbox().max)
+
+    params, params_ref = mi.traverse(hair), mi.traverse(text)
+    assert dr.allclose(params['control_points'], params_ref['control_points'])
+    assert dr.all(params['segment_indices'] == params_ref['segment_indices'])
+
+    hair_file.write_bytes(hair_file.read_bytes()[:200])
+    with pytest.raises(RuntimeError, match='truncated'):
+        mi.load_dict({ 'type' : 'bsplinecurve', 'filename' : str(hair_file) })
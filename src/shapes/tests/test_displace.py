@@ -0,0 +1,139 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def create_grid(res=4, texcoords=True):
+    import numpy as np
+    x, y = np.meshgrid(np.linspace(-1, 1, res + 1), np.linspace(-1, 1, res + 1))
+    positions = np.stack([x.ravel(), y.ravel(), np.zeros(x.size)], axis=1)
+    faces = []
+    for j in range(res):
+        for i in range(res):
+            k = j * (res + 1) + i
+            faces += [[k, k + 1, k + res + 2], [k, k + res + 2, k + res + 1]]
+    faces = np.array(faces, dtype=np.uint32)
+
+    mesh = mi.Mesh('grid', len(positions), len(faces),
+                   has_vertex_texcoords=texcoords)
+    params = mi.traverse(mesh)
+    params['vertex_positions'] = mi.Float(positions.astype(np.float32).ravel())
+    params['faces'] = mi.UInt32(faces.ravel())
+    if texcoords:
+        params['vertex_texcoords'] = mi.Float(
+            (positions[:, :2] * 0.5 + 0.5).astype(np.float32).ravel())
+    params.update()
+    return mesh
+
+
+def checkerboard(v0, v1):
+    return {
+        'type' : 'checkerboard',
+        'color0' : v0,
+        'color1' : v1,
+        'to_uv' : mi.ScalarTransform4f.scale([2, 2, 1])
+    }
+
+
+def test01_constant_displacement(variant_scalar_rgb):
+    shape = mi.load_dict({
+        'type' : 'displace',
+        'base' : create_grid(),
+        'displacement' : checkerboard(0.5, 0.5),
+        'scale' : 2.0,
+        'offset' : 0.25,
+        'rate' : 8
+    })
+
+    assert dr.allclose(shape.bbox().min, [-1, -1, 1.25])
+    assert dr.allclose(shape.bbox().max, [1, 1, 1.25])
+    assert dr.allclose(shape.surface_area(), 4.0, rtol=1e-4)
+    assert shape.effective_primitive_count() == 32 * 64
+
+    scene = mi.load_dict({ 'type' : 'scene', 'shape' : shape })
+    sampler = mi.load_dict({ 'type' : 'independent' })
+    sampler.seed(0)
+    for _ in range(200):
+        xy = sampler.next_2d() * 1.8 - 0.9
+        ray = mi.Ray3f(mi.Point3f(xy.x, xy.y, 5), [0, 0, -1])
+        si = scene.ray_intersect(ray)
+        assert si.is_valid()
+        assert dr.allclose(si.t, 3.75, atol=1e-4)
+        assert dr.allclose(si.p, [xy.x, xy.y, 1.25], atol=1e-4)
+        assert dr.allclose(si.n, [0, 0, 1], atol=1e-4)
+        assert dr.allclose(si.uv, xy * 0.5 + 0.5, atol=1e-4)
+        assert dr.allclose(si.dp_du, [2, 0, 0], atol=1e-3)
+        assert dr.allclose(si.dp_dv, [0, 2, 0], atol=1e-3)
+        assert scene.ray_test(ray)
+
+        ps = shape.sample_position(0, sampler.next_2d())
+        assert dr.allclose(ps.p.z, 1.25, atol=1e-4)
+        assert dr.allclose(ps.pdf, 0.25, rtol=1e-4)
+
+
+def test02_height_field(variant_scalar_rgb):
+    shape = mi.load_dict({
+        'type' : 'displace',
+        'base' : create_grid(),
+        'displacement' : checkerboard(0.0, 1.0),
+        'scale' : 0.5,
+        'rate' : 32
+    })
+
+    # The displacement adds silhouettes: the surface occludes grazing rays
+    scene = mi.load_dict({ 'type' : 'scene', 'shape' : shape })
+    assert dr.allclose(scene.bbox().max.z, 0.5)
+    assert scene.ray_test(mi.Ray3f([-2, 0.3, 0.25], [1, 0, 0]))
+    assert not scene.ray_test(mi.Ray3f([-2, 0.3, 0.75], [1, 0, 0]))
+
+    # Vertical rays hit either plateau away from the checkerboard edges
+    heights = set()
+    for x in [-0.75, -0.25, 0.25, 0.75]:
+        for y in [-0.75, -0.25, 0.25, 0.75]:
+            si = scene.ray_intersect(mi.Ray3f([x, y, 5], [0, 0, -1]))
+            assert si.is_valid()
+            assert dr.allclose(si.n, [0, 0, 1], atol=1e-4)
+            heights.add(round(si.p.z, 4))
+    assert heights == { 0.0, 0.5 }
+
+    assert 'cache_hits' in str(shape)
+
+
+def test03_small_cache(variant_scalar_rgb):
+    # Patches are evicted and recomputed when exceeding the cache budget
+    def load(cache_size):
+        return mi.load_dict({
+            'type' : 'scene',
+            'shape' : {
+                'type' : 'displace',
+                'base' : create_grid(8),
+                'displacement' : checkerboard(0.0, 1.0),
+                'scale' : 0.2,
+                'rate' : 16,
+                'cache_size' : cache_size
+            }
+        })
+
+    scene, scene_ref = load(0.0), load(256.0)
+    sampler = mi.load_dict({ 'type' : 'independent' })
+    sampler.seed(0)
+    for _ in range(500):
+        o = mi.Point3f(*(sampler.next_2d() * 2 - 1), 2)
+        d = dr.normalize(mi.Vector3f(*(sampler.next_2d() - 0.5), -1))
+        si, si_ref = scene.ray_intersect(mi.Ray3f(o, d)), scene_ref.ray_intersect(mi.Ray3f(o, d))
+        assert si.is_valid() == si_ref.is_valid()
+        if si.is_valid():
+            assert dr.allclose(si.p, si_ref.p)
+
+
+def test04_errors(variant_scalar_rgb):
+    with pytest.raises(RuntimeError, match='nested triangle mesh'):
+        mi.load_dict({ 'type' : 'displace', 'displacement' : checkerboard(0.0, 1.0) })
+
+    with pytest.raises(RuntimeError, match='texture coordinates'):
+        mi.load_dict({ 'type' : 'displace', 'base' : create_grid(texcoords=False),
+                       'displacement' : checkerboard(0.0, 1.0) })
+
+    with pytest.raises(RuntimeError, match='rate'):
+        mi.load_dict({ 'type' : 'displace', 'base' : create_grid(),
+                       'displacement' : checkerboard(0.0, 1.0), 'rate' : 0 })
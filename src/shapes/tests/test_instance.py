@@ -216,3 +216,147 @@ def test03_ray_intersect_instance(variants_all_rgb, width):
         assert 'instance = nullptr' in str(pi)
     else:
         assert ('instance = [' + '0x0, ' * (width - 1) + '0x0]') in str(pi)
+
+
+def test04_many_instances(variant_scalar_rgb):
+    """Compare a field of rotated instances against the flattened geometry"""
+
+    from mitsuba import ScalarTransform4f as T
+
+    n = 24
+    transforms = []
+    for i in range(n):
+        for j in range(n):
+            transforms.append(T.translate([3 * i - 1.5 * n, 3 * j - 1.5 * n, 0.0]) @
+                              T.rotate([1, 1, 0], 7.0 * i + 13.0 * j) @
+                              T.scale([1.0, 0.5, 0.25]))
+
+    scene_dict = { 'type' : 'scene' }
+    scene_inst_dict = {
+        'type' : 'scene',
+        'group_0' : {
+            'type' : 'shapegroup',
+            'shape' : { 'type' : 'cube' }
+        }
+    }
+
+    for k, to_world in enumerate(transforms):
+        scene_dict[f'cube_{k}'] = { 'type' : 'cube', 'to_world' : to_world }
+        scene_inst_dict[f'instance_{k}'] = {
+            'type' : 'instance',
+            'group' : { 'type' : 'ref', 'id' : 'group_0' },
+            'to_world' : to_world
+        }
+
+    s = mi.load_dict(scene_dict)
+    s_inst = mi.load_dict(scene_inst_dict)
+    assert dr.allclose(s.bbox().min, s_inst.bbox().min)
+    assert dr.allclose(s.bbox().max, s_inst.bbox().max)
+
+    # Clipped instance bounds must still contain the clipped geometry
+    shapes = s.shapes()
+    shapes_inst = s_inst.shapes()
+    clip = mi.ScalarBoundingBox3f([-2.0, -2.0, -0.1], [2.0, 2.0, 0.1])
+    for shape, shape_inst in zip(shapes, shapes_inst):
+        bbox_inst = shape_inst.bbox(0, clip)
+        for k in range(shape.primitive_count()):
+            bbox = shape.bbox(k, clip)
+            if bbox.valid():
+                assert bbox_inst.valid()
+                assert dr.all(bbox_inst.min <= bbox.min + 1e-4)
+                assert dr.all(bbox_inst.max >= bbox.max - 1e-4)
+
+    sampler = mi.load_dict({ 'type' : 'independent' })
+    sampler.seed(0)
+    hits = 0
+    for _ in range(2000):
+        o = mi.Point3f(*(sampler.next_2d() * (3 * n) - 1.5 * n), -10)
+        d = dr.normalize(mi.Vector3f(*(sampler.next_2d() - 0.5) * 0.2, 1.0))
+        ray = mi.Ray3f(o, d)
+
+        assert s.ray_test(ray) == s_inst.ray_test(ray)
+
+        si = s.ray_intersect(ray)
+        si_inst = s_inst.ray_intersect(ray)
+        assert si.is_valid() == si_inst.is_valid()
+        if si.is_valid():
+            hits += 1
+            assert si_inst.instance is not None
+            assert dr.allclose(si.t, si_inst.t, atol=1e-4)
+            assert dr.allclose(si.p, si_inst.p, atol=1e-4)
+            assert dr.allclose(si.n, si_inst.n, atol=1e-4)
+
+    assert hits > 100
+
+
+@pytest.mark.parametrize("distance", [5.0, 500.0])
+def test05_level_of_detail(variants_all_rgb, distance):
+    from mitsuba import ScalarTransform4f as T
+
+    scene = mi.load_dict({
+        'type' : 'scene',
+        'sensor' : {
+            'type' : 'perspective',
+            'fov' : 40,
+            'to_world' : T.look_at(origin=[0, 0, 0], target=[0, 0, 1], up=[0, 1, 0]),
+            'film' : { 'type' : 'hdrfilm', 'width' : 64, 'height' : 64 }
+        },
+        'group_fine' : {
+            'type' : 'shapegroup',
+            'shape' : { 'type' : 'sphere', 'id' : 'fine' }
+        },
+        'group_coarse' : {
+            'type' : 'shapegroup',
+            'shape' : { 'type' : 'cube', 'id' : 'coarse' }
+        },
+        'instance' : {
+            'type' : 'instance',
+            'lod_screen_size' : '16',
+            'lod_0' : { 'type' : 'ref', 'id' : 'group_fine' },
+            'lod_1' : { 'type' : 'ref', 'id' : 'group_coarse' },
+            'to_world' : T.translate([0, 0, distance])
+        }
+    })
+
+    # The sphere covers ~60 pixels at a distance of 5, and less than one at 500
+    si = scene.ray_intersect(mi.Ray3f([0, 0, 0], [0, 0, 1]))
+    assert dr.all(si.is_valid())
+    assert dr.allclose(si.t, distance - 1, atol=1e-4)
+    assert dr.allclose(si.n, [0, 0, -1], atol=1e-4)
+
+    # The cube and the sphere only differ away from the axis
+    d = dr.normalize(mi.Vector3f(0.5, 0.5, distance))
+    si = scene.ray_intersect(mi.Ray3f([0, 0, 0], d))
+    assert dr.all(si.is_valid())
+    if distance < 100:
+        assert dr.all(dr.abs(si.n.z) < 0.99)
+    else:
+        assert dr.allclose(si.n, [0, 0, -1], atol=1e-4)
+
+
+def test06_level_of_detail_errors(variant_scalar_rgb):
+    groups = {
+        'group_0' : { 'type' : 'shapegroup', 'shape' : { 'type' : 'sphere' } },
+        'group_1' : { 'type' : 'shapegroup', 'shape' : { 'type' : 'cube' } },
+    }
+
+    def load(**kwargs):
+        return mi.load_dict({
+            'type' : 'scene', **groups,
+            'instance' : {
+                'type' : 'instance',
+                'lod_0' : { 'type' : 'ref', 'id' : 'group_0' },
+                'lod_1' : { 'type' : 'ref', 'id' : 'group_1' },
+                **kwargs
+            }
+        })
+
+    with pytest.raises(RuntimeError, match='requires 1 values'):
+        load()
+    with pytest.raises(RuntimeError, match='decreasing order'):
+        load(lod_screen_size='1, 2')
+
+    # Without a sensor, the most detailed level is selected
+    scene = load(lod_screen_size='10')
+    si = scene.ray_intersect(mi.Ray3f([0.9, 0.9, -5], [0, 0, 1]))
+    assert not si.is_valid()
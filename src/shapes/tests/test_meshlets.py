@@ -0,0 +1,90 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def create_sphere_mesh(res=64, texcoords=True):
+    import numpy as np
+    theta, phi = np.meshgrid(np.linspace(0, np.pi, res),
+                             np.linspace(0, 2 * np.pi, 2 * res))
+    p = np.stack([np.sin(theta) * np.cos(phi),
+                  np.sin(theta) * np.sin(phi),
+                  np.cos(theta)], axis=-1).reshape(-1, 3)
+    uv = np.stack([phi / (2 * np.pi), theta / np.pi], axis=-1).reshape(-1, 2)
+
+    i, j = np.meshgrid(np.arange(2 * res - 1), np.arange(res - 1), indexing='ij')
+    v00 = (i * res + j).ravel()
+    faces = np.stack([v00, v00 + res, v00 + res + 1,
+                      v00, v00 + res + 1, v00 + 1], axis=-1).reshape(-1, 3)
+
+    m = mi.Mesh("sphere", len(p), len(faces), has_vertex_normals=True,
+                has_vertex_texcoords=texcoords)
+    params = mi.traverse(m)
+    params['vertex_positions'] = p.astype(np.float32).ravel()
+    params['faces'] = faces.astype(np.uint32).ravel()
+    if texcoords:
+        params['vertex_texcoords'] = uv.astype(np.float32).ravel()
+    params.update()
+    return m
+
+
+def test01_create(variant_scalar_rgb):
+    mesh = create_sphere_mesh()
+    s = mi.load_dict({"type": "meshlets", "max_triangles": 64, "mesh": mesh})
+
+    assert s.effective_primitive_count() == mesh.face_count()
+    assert dr.allclose(s.surface_area(), mesh.surface_area(), rtol=1e-4)
+    assert dr.allclose(s.bbox().min, mesh.bbox().min, atol=1e-4)
+    assert dr.allclose(s.bbox().max, mesh.bbox().max, atol=1e-4)
+    assert "cluster_count" in str(s)
+
+    with pytest.raises(RuntimeError, match='max_triangles'):
+        mi.load_dict({"type": "meshlets", "max_triangles": 1000, "mesh": mesh})
+    with pytest.raises(RuntimeError, match='nested triangle mesh'):
+        mi.load_dict({"type": "meshlets"})
+
+
+def test02_ray_intersect(variant_scalar_rgb):
+    # The compressed shape closely matches the original mesh
+    mesh = create_sphere_mesh()
+    scene_ref = mi.load_dict({"type": "scene", "mesh": create_sphere_mesh()})
+    scene = mi.load_dict({
+        "type": "scene",
+        "shape": {"type": "meshlets", "max_triangles": 32, "mesh": mesh}
+    })
+
+    sampler = mi.load_dict({"type": "independent"})
+    sampler.seed(0)
+    misses = 0
+    for k in range(500):
+        o = mi.warp.square_to_uniform_sphere(sampler.next_2d()) * 3
+        target = mi.warp.square_to_uniform_sphere(sampler.next_2d()) * 0.9
+        ray = mi.Ray3f(o, dr.normalize(target - o))
+
+        si_ref = scene_ref.ray_intersect(ray)
+        si = scene.ray_intersect(ray)
+        assert si.is_valid() == si_ref.is_valid()
+        assert scene.ray_test(ray) == si.is_valid()
+        if not si.is_valid():
+            misses += 1
+            continue
+
+        assert dr.allclose(si.t, si_ref.t, atol=1e-3)
+        assert dr.allclose(si.p, si_ref.p, atol=1e-3)
+        assert dr.allclose(si.n, si_ref.n, atol=1e-2)
+        assert dr.allclose(si.sh_frame.n, si_ref.sh_frame.n, atol=1e-2)
+        assert dr.allclose(si.uv, si_ref.uv, atol=1e-3)
+
+    # All rays point towards the sphere
+    assert misses == 0
+
+
+def test03_sample_position(variant_scalar_rgb):
+    s = mi.load_dict({"type": "meshlets", "mesh": create_sphere_mesh(texcoords=False)})
+    sampler = mi.load_dict({"type": "independent"})
+    sampler.seed(0)
+    for k in range(100):
+        ps = s.sample_position(0.0, sampler.next_2d())
+        assert dr.allclose(dr.norm(ps.p), 1.0, atol=2e-3)
+        assert dr.allclose(ps.n, ps.p, atol=2e-2)
+        assert dr.allclose(ps.pdf, 1.0 / s.surface_area())
@@ -0,0 +1,117 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+
+def write_particles(path, n, seed=0):
+    import numpy as np
+    rng = np.random.default_rng(seed)
+    data = np.zeros((n, 4), dtype=np.float32)
+    data[:, :3] = rng.uniform(-5, 5, (n, 3))
+    data[:, 3] = rng.uniform(0.05, 0.3, n)
+    data.tofile(str(path))
+    return data
+
+
+def test01_create(variants_all_rgb, tmp_path):
+    if mi.variant().startswith('cuda'):
+        pytest.skip('The particles shape is not supported in CUDA variants')
+
+    filename = tmp_path / 'particles.bin'
+    data = write_particles(filename, 100)
+    shape = mi.load_dict({
+        'type' : 'particles',
+        'filename' : str(filename),
+        'to_world' : mi.ScalarTransform4f.translate([1, 2, 3])
+    })
+
+    assert shape.effective_primitive_count() == 100
+    assert dr.allclose(shape.bbox().min, (data[:, :3] - data[:, 3:]).min(axis=0) + [1, 2, 3])
+    assert dr.allclose(shape.bbox().max, (data[:, :3] + data[:, 3:]).max(axis=0) + [1, 2, 3])
+    assert dr.allclose(shape.surface_area(), 4 * dr.pi * (data[:, 3] ** 2).sum(), rtol=1e-4)
+
+    params = mi.traverse(shape)
+    assert params['particle_count'] == 100
+    import numpy as np
+    assert dr.allclose(np.array(params['particles'])[4:8], data[1] + [1, 2, 3, 0])
+
+
+def test02_ray_intersect(variant_scalar_rgb, tmp_path):
+    # Compare against a scene made of individual spheres
+    filename = tmp_path / 'particles.bin'
+    data = write_particles(filename, 300)
+    scene = mi.load_dict({
+        'type' : 'scene',
+        'particles' : { 'type' : 'particles', 'filename' : str(filename) }
+    })
+
+    scene_ref_dict = { 'type' : 'scene' }
+    for k, p in enumerate(data):
+        scene_ref_dict[f'sphere_{k}'] = {
+            'type' : 'sphere',
+            'center' : p[:3].tolist(),
+            'radius' : float(p[3])
+        }
+    scene_ref = mi.load_dict(scene_ref_dict)
+
+    sampler = mi.load_dict({ 'type' : 'independent' })
+    sampler.seed(0)
+    hits = 0
+    for _ in range(1000):
+        o = mi.Point3f(*(sampler.next_2d() * 10 - 5), -8)
+        d = dr.normalize(mi.Vector3f(*(sampler.next_2d() - 0.5) * 0.2, 1.0))
+        ray = mi.Ray3f(o, d)
+
+        assert scene.ray_test(ray) == scene_ref.ray_test(ray)
+        si, si_ref = scene.ray_intersect(ray), scene_ref.ray_intersect(ray)
+        assert si.is_valid() == si_ref.is_valid()
+        if si.is_valid():
+            hits += 1
+            assert dr.allclose(si.t, si_ref.t, atol=1e-4)
+            assert dr.allclose(si.p, si_ref.p, atol=1e-4)
+            assert dr.allclose(si.n, si_ref.n, atol=1e-4)
+            assert dr.allclose(si.uv, si_ref.uv, atol=1e-3)
+            assert dr.allclose(si.dp_du, si_ref.dp_du, atol=1e-3)
+            assert dr.allclose(si.dp_dv, si_ref.dp_dv, atol=1e-3)
+
+    assert hits > 100
+
+
+def test03_sample_position(variant_scalar_rgb, tmp_path):
+    filename = tmp_path / 'particles.bin'
+    data = write_particles(filename, 50)
+    shape = mi.load_dict({ 'type' : 'particles', 'filename' : str(filename) })
+
+    sampler = mi.load_dict({ 'type' : 'independent' })
+    sampler.seed(0)
+    for _ in range(100):
+        ps = shape.sample_position(0, sampler.next_2d())
+        d = ((data[:, :3] - list(ps.p)) ** 2).sum(axis=1) ** 0.5 - data[:, 3]
+        assert abs(d).min() < 1e-4
+        assert dr.allclose(ps.pdf, 1 / shape.surface_area())
+        assert dr.allclose(shape.pdf_position(ps), ps.pdf)
+
+
+def test04_parameters_changed(variant_scalar_rgb, tmp_path):
+    filename = tmp_path / 'particles.bin'
+    write_particles(filename, 10)
+    scene = mi.load_dict({
+        'type' : 'scene',
+        'particles' : { 'type' : 'particles', 'filename' : str(filename) }
+    })
+
+    params = mi.traverse(scene)
+    params['particles.particles'] = mi.Float([0, 0, 0, 1] * 10)
+    params.update()
+
+    assert dr.allclose(scene.bbox().min, [-1, -1, -1])
+    si = scene.ray_intersect(mi.Ray3f([0, 0, -5], [0, 0, 1]))
+    assert dr.allclose(si.t, 4)
+    assert dr.allclose(si.n, [0, 0, -1])
+
+
+def test05_errors(variant_scalar_rgb, tmp_path):
+    filename = tmp_path / 'particles.bin'
+    filename.write_bytes(b'\0' * 20)
+    with pytest.raises(RuntimeError, match='multiple of 16 bytes'):
+        mi.load_dict({ 'type' : 'particles', 'filename' : str(filename) })
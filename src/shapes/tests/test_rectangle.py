@@ -284,3 +284,36 @@ def test09_eval_parameterization(variants_all_ad_rgb):
 
     si_after = shape.eval_parameterization(mi.Point2f(0.3, 0.6))
     assert dr.allclose(si_before.uv, si_after.uv)
+
+
+def test10_sample_direction_solid_angle(variants_vec_rgb):
+    # Unit square at distance 1 subtends a solid angle of 4 π / 6
+    shape = mi.load_dict({'type' : 'rectangle'})
+    solid_angle = 4 * dr.pi / 6
+
+    it = dr.zeros(mi.Interaction3f)
+    it.p = [0, 0, 1]
+
+    sampler = mi.load_dict({'type' : 'independent'})
+    sampler.seed(0, 100000)
+    ds = shape.sample_direction(it, sampler.next_2d())
+
+    # Sampled points lie on the rectangle, with a constant density
+    assert dr.allclose(ds.p.z, 0, atol=1e-5)
+    assert dr.all(dr.abs(ds.p.x) <= 1 + 1e-5) and dr.all(dr.abs(ds.p.y) <= 1 + 1e-5)
+    assert dr.allclose(ds.pdf, 1 / solid_angle, rtol=1e-4)
+    assert dr.allclose(shape.pdf_direction(it, ds), ds.pdf)
+    assert dr.allclose(ds.p.x, ds.uv.x * 2 - 1, atol=1e-5)
+    assert dr.allclose(ds.d, dr.normalize(ds.p - it.p), atol=1e-5)
+
+    # The fraction of samples in [0.5, 1] x [-1, 1] matches its solid angle
+    def corner(a, b):
+        return dr.atan(a * b / dr.sqrt(a * a + b * b + 1))
+    ref = 2 * (corner(1, 1) - corner(0.5, 1)) / solid_angle
+    fraction = dr.mean(dr.select(ds.p.x > 0.5, 1.0, 0.0))
+    assert dr.allclose(fraction, ref, atol=5e-3)
+
+    # Far away, the rectangle is sampled by area
+    it.p = [0, 0, 200]
+    ds = shape.sample_direction(it, sampler.next_2d())
+    assert dr.allclose(ds.pdf, dr.norm(ds.p - it.p)**3 / (4 * 200), rtol=1e-3)
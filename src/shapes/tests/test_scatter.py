@@ -0,0 +1,155 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import fresolver_append_path
+
+
+def random_transforms(n, seed=0):
+    import numpy as np
+    from mitsuba import ScalarTransform4f as T
+    rng = np.random.default_rng(seed)
+    result = []
+    for _ in range(n):
+        t = rng.uniform(-10, 10, 3)
+        t[2] = rng.uniform(-1, 1)
+        angle = rng.uniform(0, 360)
+        axis = rng.normal(size=3)
+        result.append(T.translate(t.tolist()) @
+                      T.rotate(axis.tolist(), angle) @
+                      T.scale(rng.uniform(0.2, 0.6)))
+    return result
+
+
+def write_transforms(path, transforms):
+    import numpy as np
+    data = np.array([np.array(t.matrix, dtype=np.float32)[:3, :] for t in transforms])
+    data.astype(np.float32).tofile(str(path))
+
+
+def test01_ray_intersect_file(variant_scalar_rgb, tmp_path):
+    # Compare against the same geometry expressed with regular instances
+    transforms = random_transforms(200)
+    filename = tmp_path / 'transforms.bin'
+    write_transforms(filename, transforms)
+
+    group = { 'type' : 'shapegroup', 'shape' : { 'type' : 'cube' } }
+    scene = mi.load_dict({
+        'type' : 'scene',
+        'group_0' : group,
+        'scatter' : {
+            'type' : 'scatter',
+            'group' : { 'type' : 'ref', 'id' : 'group_0' },
+            'filename' : str(filename)
+        }
+    })
+
+    scene_ref_dict = { 'type' : 'scene', 'group_0' : group }
+    for k, to_world in enumerate(transforms):
+        scene_ref_dict[f'instance_{k}'] = {
+            'type' : 'instance',
+            'group' : { 'type' : 'ref', 'id' : 'group_0' },
+            'to_world' : to_world
+        }
+    scene_ref = mi.load_dict(scene_ref_dict)
+
+    assert 'instance_count = 200' in str(scene.shapes()[0])
+    assert dr.allclose(scene.bbox().min, scene_ref.bbox().min, atol=1e-4)
+    assert dr.allclose(scene.bbox().max, scene_ref.bbox().max, atol=1e-4)
+
+    sampler = mi.load_dict({ 'type' : 'independent' })
+    sampler.seed(0)
+    hits = 0
+    for _ in range(1000):
+        o = mi.Point3f(*(sampler.next_2d() * 24 - 12), -10)
+        d = dr.normalize(mi.Vector3f(*(sampler.next_2d() - 0.5) * 0.5, 1.0))
+        ray = mi.Ray3f(o, d)
+
+        assert scene.ray_test(ray) == scene_ref.ray_test(ray)
+
+        si = scene.ray_intersect(ray)
+        si_ref = scene_ref.ray_intersect(ray)
+        assert si.is_valid() == si_ref.is_valid()
+        if si.is_valid():
+            hits += 1
+            assert si.instance is not None
+            assert dr.allclose(si.t, si_ref.t, atol=1e-4)
+            assert dr.allclose(si.p, si_ref.p, atol=1e-4)
+            assert dr.allclose(si.n, si_ref.n, atol=1e-4)
+            assert dr.allclose(si.sh_frame.n, si_ref.sh_frame.n, atol=1e-4)
+            assert dr.allclose(si.dp_du, si_ref.dp_du, atol=1e-3)
+
+    assert hits > 100
+
+
+@fresolver_append_path
+def test02_distribute_on_mesh(variant_scalar_rgb):
+    def load(seed):
+        return mi.load_dict({
+            'type' : 'scene',
+            'group_0' : {
+                'type' : 'shapegroup',
+                'shape' : { 'type' : 'sphere', 'radius' : 0.05 }
+            },
+            'scatter' : {
+                'type' : 'scatter',
+                'group' : { 'type' : 'ref', 'id' : 'group_0' },
+                'ground' : {
+                    'type' : 'obj',
+                    'filename' : 'resources/data/common/meshes/rectangle.obj',
+                    'to_world' : mi.ScalarTransform4f.scale(10)
+                },
+                'count' : 5000,
+                'seed' : seed,
+                'scale_min' : 0.5,
+                'scale_max' : 2.0
+            }
+        })
+
+    scene = load(1)
+    assert 'instance_count = 5000' in str(scene.shapes()[0])
+
+    # The instances lie on the rectangle, their centers on its surface
+    bbox = scene.bbox()
+    assert dr.all(bbox.min >= [-10.1, -10.1, -0.11])
+    assert dr.all(bbox.max <= [10.1, 10.1, 0.11])
+    assert bbox.max.x > 9 and bbox.min.x < -9
+
+    # Rays towards the plane hit spheres in about a sixth of the cases
+    # (5000 * pi * 0.05^2 * E[s^2] / 400 ~ 0.17)
+    sampler = mi.load_dict({ 'type' : 'independent' })
+    sampler.seed(0)
+    hits = 0
+    for _ in range(1000):
+        o = mi.Point3f(*(sampler.next_2d() * 20 - 10), 5)
+        si = scene.ray_intersect(mi.Ray3f(o, [0, 0, -1]))
+        if si.is_valid():
+            hits += 1
+            assert si.instance is not None
+            assert dr.abs(si.p.z) < 0.11
+            assert dr.dot(si.n, [0, 0, 1]) > 0
+    assert 80 < hits < 300
+
+    # The placement is deterministic
+    assert str(load(1).bbox()) == str(bbox)
+
+
+@fresolver_append_path
+def test03_errors(variant_scalar_rgb):
+    group = { 'type' : 'shapegroup', 'shape' : { 'type' : 'sphere' } }
+
+    with pytest.raises(RuntimeError, match='shapegroup'):
+        mi.load_dict({ 'type' : 'scatter', 'filename' : 'foo.bin' })
+
+    with pytest.raises(RuntimeError, match='filename'):
+        mi.load_dict({ 'type' : 'scene', 'group_0' : group,
+                       'scatter' : { 'type' : 'scatter',
+                                     'group' : { 'type' : 'ref', 'id' : 'group_0' } } })
+
+    with pytest.raises(RuntimeError, match='count'):
+        mi.load_dict({ 'type' : 'scene', 'group_0' : group,
+                       'scatter' : { 'type' : 'scatter',
+                                     'group' : { 'type' : 'ref', 'id' : 'group_0' },
+                                     'mesh' : { 'type' : 'obj',
+                                                'filename' : 'resources/data/common/meshes/rectangle.obj' },
+                                     'count' : 0 } })
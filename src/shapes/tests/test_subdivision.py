@@ -0,0 +1,77 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+
+from mitsuba.scalar_rgb.test.util import fresolver_append_path
+
+
+def test01_closed_surface(variants_all_rgb):
+    # The cube has duplicated vertices along its texture seams
+    cube = mi.load_dict({ 'type' : 'cube' })
+
+    for level in range(4):
+        s = mi.load_dict({ 'type' : 'subdivision', 'level' : level, 'cage' : cube })
+        expected = 12 if level == 0 else 2 * 3 * 12 * 4 ** (level - 1)
+        assert s.face_count() == expected
+        assert s.has_vertex_normals() and s.has_vertex_texcoords()
+
+        # The limit surface lies inside of the control cage
+        bbox = s.bbox()
+        assert dr.all(bbox.min >= -1.0 - 1e-5) and dr.all(bbox.max <= 1.0 + 1e-5)
+        if level > 0:
+            assert dr.all(bbox.max < 0.95)
+
+    # The tessellation is watertight
+    if mi.variant().startswith('scalar'):
+        scene = mi.load_dict({
+            'type' : 'scene',
+            'shape' : { 'type' : 'subdivision', 'level' : 3, 'cage' : cube }
+        })
+        sampler = mi.load_dict({ 'type' : 'independent' })
+        sampler.seed(0)
+        for _ in range(1000):
+            d = mi.warp.square_to_uniform_sphere(sampler.next_2d())
+            si = scene.ray_intersect(mi.Ray3f([0, 0, 0], d))
+            assert si.is_valid()
+            assert dr.dot(si.n, d) > 0
+
+
+@fresolver_append_path
+def test02_boundary(variant_scalar_rgb):
+    # Boundaries are creases: a flat patch remains flat and keeps its corners
+    s = mi.load_dict({
+        'type' : 'subdivision',
+        'level' : 2,
+        'cage' : {
+            'type' : 'obj',
+            'filename' : 'resources/data/common/meshes/rectangle.obj'
+        }
+    })
+
+    params = mi.traverse(s)
+    p = dr.unravel(mi.Point3f, params['vertex_positions'])
+    uv = dr.unravel(mi.Point2f, params['vertex_texcoords'])
+    assert dr.allclose(p.z, 0.0)
+    assert dr.allclose(dr.min(p.x), -1.0) and dr.allclose(dr.max(p.x), 1.0)
+    assert dr.all(uv.x >= 0.0) and dr.all(uv.x <= 1.0)
+    assert dr.allclose(s.surface_area(), 4.0)
+
+
+def test03_screen_space_level(variant_scalar_rgb):
+    cube = mi.load_dict({ 'type' : 'cube' })
+
+    def level(distance, **kwargs):
+        s = mi.load_dict({ 'type' : 'subdivision', 'cage' : cube,
+                           'view_origin' : [0, 0, distance], **kwargs })
+        return s.face_count()
+
+    # Faraway objects are not subdivided, close-ups are. Reducing the
+    # distance to the cube by a factor of four adds two subdivision steps.
+    assert level(1e5) == 12
+    near, far = level(5.0, edge_pixels=64), level(17.0, edge_pixels=64)
+    assert far > 12
+    assert near == 16 * far
+    assert level(1.5, max_level=2) == 2 * 3 * 12 * 4
+
+    with pytest.raises(RuntimeError, match='control mesh'):
+        mi.load_dict({ 'type' : 'subdivision' })
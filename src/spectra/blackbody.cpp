@@ -1,6 +1,7 @@
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/interaction.h>
 #include <mitsuba/core/properties.h>
+#include <mitsuba/core/distr_1d.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -26,6 +27,11 @@ Blackbody spectrum (:monosp:`blackbody`)
    - Black body temperature in Kelvins.
    - |exposed|
 
+ * - resolution
+   - |float|
+   - Spacing in nanometers of the table that replaces Planck's law during
+     rendering (see below). A value of zero evaluates the law analytically. (Default: 1nm)
+
 This is a black body radiation spectrum for a specified temperature
 And therefore takes a single :monosp:`float`-valued parameter :paramtype:`temperature` (in Kelvins).
 
@@ -63,6 +69,14 @@ Specifically, the black body spectrum has units of power (:math:`W`) per unit ar
 per steradian (:math:`sr^{-1}`) per unit wavelength (:math:`nm^{-1}`). As a consequence,
 your scene should be modeled in meters for this plugin to work properly.
 
+As the temperature is fixed, the spectrum is tabulated on a regular grid of wavelengths
+whenever the temperature changes. Evaluating and sampling it then reduces to a table lookup
+and linear interpolation, instead of exponentials per wavelength (evaluation) and a Newton
+solve (sampling). This matters in scenes with many blackbody emitters, which are evaluated
+for every emitter sample and every emitter hit. The interpolation error scales with the
+square of the resolution and is largest in the steep short-wavelength tail of low
+temperatures. Set ``resolution`` to zero to use the analytic expressions instead.
+
  */
 
 template <typename Float, typename Spectrum>
@@ -86,6 +100,9 @@ public:
             props.get<ScalarFloat>("wavelength_min", MI_CIE_MIN),
             props.get<ScalarFloat>("wavelength_max", MI_CIE_MAX)
         );
+        m_resolution = props.get<ScalarFloat>("resolution", 1.f);
+        if (m_resolution < 0.f)
+            Throw("The 'resolution' parameter must be non-negative!");
         parameters_changed();
     }
 
@@ -96,25 +113,56 @@ public:
     void parameters_changed(const std::vector<std::string> &/*keys*/ = {}) override {
         m_integral_min = cdf_and_pdf(ScalarFloat(m_wavelength_range.x())).first;
         m_integral = cdf_and_pdf(ScalarFloat(m_wavelength_range.y())).first - m_integral_min;
+
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (m_resolution > 0.f)
+                tabulate();
+        }
+    }
+
+    /// Tabulate Planck's law on a regular grid of wavelengths
+    void tabulate() {
+        ScalarFloat range = m_wavelength_range.y() - m_wavelength_range.x();
+        size_t size = std::max((size_t) 2,
+                               (size_t) dr::ceil(range / m_resolution) + 1);
+
+        std::vector<ScalarFloat> values(size);
+        for (size_t i = 0; i < size; ++i) {
+            double lambda = (double) m_wavelength_range.x() +
+                            (double) range * i / (size - 1);
+            values[i] = (ScalarFloat) planck(lambda, (double) m_temperature);
+        }
+
+        m_distr = ContinuousDistribution<Wavelength>(
+            m_wavelength_range, values.data(), size);
+        m_tabulated = true;
+    }
+
+    /// Evaluate Planck's law at a wavelength given in nanometers
+    template <typename Value>
+    static Value planck(const Value &wavelength, ScalarFloat temperature) {
+        /* The scale factors of 1e-9f are needed to perform a conversion between
+           densities per unit nanometer and per unit meter. */
+        Value lambda  = wavelength * 1e-9f,
+              lambda2 = dr::sqr(lambda),
+              lambda5 = dr::sqr(lambda2) * lambda;
+
+        /* Watts per unit surface area (m^-2)
+                 per unit wavelength (nm^-1)
+                 per unit steradian (sr^-1) */
+        return 1e-9f * c0 / (lambda5 * (dr::exp(c1 / (lambda * temperature)) - 1.f));
     }
 
     UnpolarizedSpectrum eval_impl(const Wavelength &wavelengths, Mask active_) const {
         if constexpr (is_spectral_v<Spectrum>) {
-            /* The scale factors of 1e-9f are needed to perform a conversion between
-               densities per unit nanometer and per unit meter. */
-            Wavelength lambda  = wavelengths * 1e-9f,
-                       lambda2 = dr::sqr(lambda),
-                       lambda5 = dr::sqr(lambda2) * lambda;
+            if (m_tabulated)
+                return m_distr.eval_pdf(wavelengths, active_);
 
             dr::mask_t<Wavelength> active = active_;
             active &= wavelengths >= m_wavelength_range.x()
                    && wavelengths <= m_wavelength_range.y();
 
-            /* Watts per unit surface area (m^-2)
-                     per unit wavelength (nm^-1)
-                     per unit steradian (sr^-1) */
-            UnpolarizedSpectrum P = 1e-9f * c0 / (lambda5 *
-                    (dr::exp(c1 / (lambda * m_temperature)) - 1.f));
+            UnpolarizedSpectrum P = planck(wavelengths, m_temperature);
 
             return P & active;
         } else {
@@ -132,6 +180,9 @@ public:
 
     Wavelength pdf_spectrum(const SurfaceInteraction3f &si, Mask active_) const override {
         if constexpr (is_spectral_v<Spectrum>) {
+            if (m_tabulated)
+                return m_distr.eval_pdf_normalized(si.wavelengths, active_);
+
             Wavelength lambda  = si.wavelengths * 1e-9f,
                        lambda2 = dr::sqr(lambda),
                        lambda5 = dr::sqr(lambda2) * lambda;
@@ -187,6 +238,9 @@ public:
         using WavelengthMask = dr::mask_t<Wavelength>;
 
         if constexpr (is_spectral_v<Spectrum>) {
+            if (m_tabulated)
+                return { m_distr.sample(sample_, active_), m_distr.integral() };
+
             WavelengthMask active = active_;
 
             Wavelength sample = dr::fmadd(sample_, Wavelength(m_integral), Wavelength(m_integral_min));
@@ -235,6 +289,8 @@ public:
     }
 
     Float mean() const override {
+        if (m_tabulated)
+            return m_distr.integral() / (m_wavelength_range.y() - m_wavelength_range.x());
         return m_integral / (m_wavelength_range.y() - m_wavelength_range.x());
     }
 
@@ -243,26 +299,21 @@ public:
     }
 
     ScalarFloat spectral_resolution() const override {
-        return 0.f;
+        return m_tabulated ? m_distr.interval_resolution() : 0.f;
     }
 
     ScalarFloat max() const override {
-        ScalarFloat lambda_peak = dr::clamp(b / m_temperature, 
-                                            m_wavelength_range.x() * 1e-9f, 
-                                            m_wavelength_range.y() * 1e-9f),
-                    lambda2_peak = dr::sqr(lambda_peak),
-                    lambda5_peak = dr::sqr(lambda2_peak) * lambda_peak;
-
-        ScalarFloat P = 1e-9f * c0 / (lambda5_peak *
-                    (dr::exp(c1 / (lambda_peak * m_temperature)) - 1.f));
-
-        return P;
+        ScalarFloat lambda_peak = dr::clamp(b / m_temperature * 1e9f,
+                                            m_wavelength_range.x(),
+                                            m_wavelength_range.y());
+        return planck(lambda_peak, m_temperature);
     }
 
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "BlackBodySpectrum[" << std::endl
-            << "  temperature = " << string::indent(m_temperature) << std::endl
+            << "  temperature = " << string::indent(m_temperature) << "," << std::endl
+            << "  resolution = " << m_resolution << std::endl
             << "]";
         return oss.str();
     }
@@ -274,6 +325,10 @@ private:
     ScalarFloat m_integral_min;
     ScalarFloat m_integral;
     ScalarVector2f m_wavelength_range;
+    ScalarFloat m_resolution;
+    /// Tabulated spectrum, used when \c m_resolution is positive
+    ContinuousDistribution<Wavelength> m_distr;
+    bool m_tabulated = false;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(BlackBodySpectrum, Texture)
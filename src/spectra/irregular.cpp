@@ -3,6 +3,9 @@
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/distr_1d.h>
 
+/// Upper bound on the number of entries of the dense evaluation table
+#define MI_IRREGULAR_DENSE_MAX_SIZE 65536
+
 NAMESPACE_BEGIN(mitsuba)
 
 /**!
@@ -24,9 +27,23 @@ Irregular spectrum (:monosp:`irregular`)
    - Values of the spectral function at the specified wavelengths.
    - |exposed|, |differentiable|
 
+ * - resolution
+   - |float|
+   - Spacing (in nanometers) of a dense, regularly sampled table used to evaluate the spectrum.
+     A negative value builds the table only when it represents the spectrum exactly, i.e. when
+     all wavelengths lie on a regular grid. A value of zero always evaluates the spectrum by
+     searching the irregular wavelengths. (Default: -1)
+
 This spectrum returns linearly interpolated reflectance or emission values from *irregularly*
 placed samples.
 
+Looking up a wavelength in the irregular samples requires a binary search. When the
+wavelengths lie on a regular grid (e.g. measured data tabulated every 5 nm), the spectrum
+is therefore resampled into a regularly spaced table whose evaluation is a constant-time
+fetch. Irregular data can also be resampled explicitly by specifying the ``resolution``
+parameter, which approximates features narrower than the resampling interval. Sampling
+and PDF evaluation always use the original irregular samples.
+
 .. tabs::
     .. code-tab:: xml
         :name: irregular
@@ -47,6 +64,8 @@ template <typename Float, typename Spectrum>
 class IrregularSpectrum final : public Texture<Float, Spectrum> {
 public:
     MI_IMPORT_TYPES(Texture)
+    using FloatStorage  = DynamicBuffer<Float>;
+    using UInt32Storage = DynamicBuffer<UInt32>;
 
 public:
     IrregularSpectrum(const Properties &props) : Texture(props) {
@@ -97,6 +116,9 @@ public:
                     wavelengths.data(), values.data(), size);
             }
         }
+
+        m_resolution = props.get<ScalarFloat>("resolution", -1.f);
+        update_dense();
     }
 
     void traverse(TraversalCallback *callback) override {
@@ -106,14 +128,17 @@ public:
 
     void parameters_changed(const std::vector<std::string> &/*keys*/) override {
         m_distr.update();
+        update_dense();
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si, Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
 
-        if constexpr (is_spectral_v<Spectrum>)
+        if constexpr (is_spectral_v<Spectrum>) {
+            if (m_dense_valid)
+                return m_dense.eval_pdf(si.wavelengths, active);
             return m_distr.eval_pdf(si.wavelengths, active);
-        else {
+        } else {
             DRJIT_MARK_USED(si);
             NotImplementedError("eval");
         }
@@ -163,14 +188,89 @@ public:
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "IrregularSpectrum[" << std::endl
-            << "  distr = " << string::indent(m_distr) << std::endl
+            << "  distr = " << string::indent(m_distr) << "," << std::endl
+            << "  dense_size = " << (m_dense_valid ? m_dense.size() : 0) << std::endl
             << "]";
         return oss.str();
     }
 
     MI_DECLARE_CLASS()
+private:
+    /**
+     * \brief Resample the spectrum into a regularly spaced table
+     *
+     * The table entries are linear combinations of the original values, which
+     * keeps them differentiable with respect to the ``values`` parameter.
+     */
+    void update_dense() {
+        m_dense_valid = false;
+        m_dense = ContinuousDistribution<Wavelength>();
+
+        if constexpr (!is_spectral_v<Spectrum>)
+            return;
+
+        // Gradients with respect to the wavelengths require the irregular search
+        if (m_resolution == 0.f || dr::grad_enabled(m_distr.nodes()))
+            return;
+
+        FloatStorage nodes_storage = m_distr.nodes();
+        if constexpr (dr::is_jit_v<Float>) {
+            nodes_storage = dr::migrate(nodes_storage, AllocType::Host);
+            dr::sync_thread();
+        }
+        const ScalarFloat *nodes = nodes_storage.data();
+        size_t size = nodes_storage.size();
+
+        ScalarVector2f range = m_distr.range();
+        ScalarFloat extent = range.y() - range.x(), step = m_resolution;
+
+        if (step < 0.f) {
+            // Only build the table if it reproduces the linear interpolant exactly
+            step = extent;
+            for (size_t i = 0; i + 1 < size; ++i)
+                step = dr::minimum(step, nodes[i + 1] - nodes[i]);
+            if (!(step > 0.f))
+                return;
+            for (size_t i = 0; i < size; ++i) {
+                ScalarFloat k = (nodes[i] - range.x()) / step;
+                if (dr::abs(k - dr::round(k)) > 1e-3f)
+                    return;
+            }
+        }
+
+        ScalarFloat steps = dr::round(extent / step);
+        if (!(steps >= 1.f && steps < MI_IRREGULAR_DENSE_MAX_SIZE))
+            return;
+
+        uint32_t dense_size = (uint32_t) steps + 1;
+        std::vector<uint32_t> index(dense_size);
+        std::vector<ScalarFloat> weight(dense_size);
+
+        for (uint32_t i = 0, j = 0; i < dense_size; ++i) {
+            ScalarFloat x = dr::lerp(range.x(), range.y(), (ScalarFloat) i / (dense_size - 1));
+            while (j + 2 < size && nodes[j + 1] <= x)
+                ++j;
+            index[i] = j;
+            weight[i] = dr::clamp((x - nodes[j]) / (nodes[j + 1] - nodes[j]),
+                                   ScalarFloat(0), ScalarFloat(1));
+        }
+
+        UInt32Storage index_0 = dr::load<UInt32Storage>(index.data(), dense_size);
+        FloatStorage t = dr::load<FloatStorage>(weight.data(), dense_size);
+
+        const FloatStorage &pdf = m_distr.pdf();
+        FloatStorage values = dr::lerp(dr::gather<FloatStorage>(pdf, index_0),
+                                       dr::gather<FloatStorage>(pdf, index_0 + 1u), t);
+
+        m_dense = ContinuousDistribution<Wavelength>(range, values);
+        m_dense_valid = true;
+    }
+
 private:
     IrregularContinuousDistribution<Wavelength> m_distr;
+    ContinuousDistribution<Wavelength> m_dense;
+    ScalarFloat m_resolution;
+    bool m_dense_valid = false;
 };
 
 MI_IMPLEMENT_CLASS_VARIANT(IrregularSpectrum, Texture)
@@ -120,6 +120,21 @@ public:
             return dr::max_nested(m_value);
     }
 
+    bool is_uniform() const override { return !is_spectral_v<Spectrum>; }
+
+    bool is_spectrally_varying() const override {
+        if constexpr (is_monochromatic_v<Spectrum>) {
+            return false;
+        } else {
+            ScalarColor3f value = dr::slice(dr::detach(m_value));
+            // The spectral model is flat when its polynomial is constant
+            if constexpr (is_spectral_v<Spectrum>)
+                return value.x() != 0.f || value.y() != 0.f;
+            else
+                return value.x() != value.y() || value.y() != value.z();
+        }
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "SRGBReflectanceSpectrum[" << std::endl
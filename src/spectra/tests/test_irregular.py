@@ -41,3 +41,32 @@ def test02_sample_spectrum(variant_scalar_spectral, obj):
         obj.sample_spectrum(si, .5),
         [576.777, 212.5]
     )
+
+
+def test03_dense_evaluation(variant_scalar_spectral):
+    def load(wavelengths, resolution=None):
+        props = {
+            "type" : "irregular",
+            "wavelengths" : wavelengths,
+            "values" : "1, 2, .5, 3"
+        }
+        if resolution is not None:
+            props["resolution"] = resolution
+        return mi.load_dict(props)
+
+    si = mi.SurfaceInteraction3f()
+
+    # Wavelengths on a regular grid are resampled exactly
+    obj, obj_ref = load("500, 510, 530, 560"), load("500, 510, 530, 560", 0.0)
+    assert 'dense_size = 7' in str(obj)
+    assert 'dense_size = 0' in str(obj_ref)
+    for w in range(490, 571):
+        si.wavelengths = w + 0.25
+        assert dr.allclose(obj.eval(si), obj_ref.eval(si))
+
+    # Irregular wavelengths are only resampled when requested
+    assert 'dense_size = 0' in str(load("500, 513.7, 530, 560"))
+    obj = load("500, 513.7, 530, 560", 1.0)
+    assert 'dense_size = 61' in str(obj)
+    si.wavelengths = 530
+    assert dr.allclose(obj.eval(si), .5)
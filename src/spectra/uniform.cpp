@@ -113,6 +113,10 @@ public:
         return dr::slice(dr::max(m_value));
     }
 
+    bool is_uniform() const override { return true; }
+
+    bool is_spectrally_varying() const override { return false; }
+
     std::string to_string() const override {
         return tfm::format("UniformSpectrum[value=%f]", m_value);
     }
@@ -1,10 +1,16 @@
+#include <mitsuba/core/assetcache.h>
 #include <mitsuba/core/bitmap.h>
 #include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/mmap.h>
 #include <mitsuba/core/plugin.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/thread.h>
+#include <mitsuba/core/util.h>
 #include <mitsuba/core/distr_2d.h>
+#include <mitsuba/core/tilecache.h>
 #include <mitsuba/render/interaction.h>
+#include <mitsuba/render/packedstorage.h>
 #include <mitsuba/render/texture.h>
 #include <mitsuba/render/srgb.h>
 #include <drjit/tensor.h>
@@ -21,7 +27,7 @@ Bitmap texture (:monosp:`bitmap`)
 ---------------------------------
 
 .. pluginparameters::
- :extra-rows: 7
+ :extra-rows: 9
 
  * - filename
    - |string|
@@ -43,6 +49,10 @@ Bitmap texture (:monosp:`bitmap`)
      - ``nearest``: disable filtering and interpolation. In this mode, the plugin
        performs nearest neighbor lookups of texture values.
 
+     - ``mipmap``: trilinear filtering using a MIP map pyramid. The level is
+       chosen based on the footprint of the lookup given by the UV partials of
+       the surface interaction (see below).
+
  * - wrap_mode
    - |string|
    - Controls the behavior of texture evaluations that fall outside of the
@@ -73,9 +83,48 @@ Bitmap texture (:monosp:`bitmap`)
      cause small differences as hardware interpolation methods typically have a
      loss of precision (not exactly 32-bit arithmetic). (Default: true)
 
+ * - tiled
+   - |bool|
+   - Page the texture data in and out of memory on demand instead of keeping
+     it resident (see below). Only supported in scalar variants. (Default: false)
+
+ * - storage
+   - |string|
+   - Precision of the stored texel values (see below). The following options
+     are currently available:
+
+     - ``float`` (default): full precision, in a Dr.Jit texture.
+
+     - ``half``: half precision floating point values.
+
+     - ``unorm8``: 8 bit values mapped linearly to the range of every channel.
+
+     - ``unorm8_srgb``: 8 bit sRGB-encoded values in :math:`[0, 1]`, which
+       are converted to linear values when they are looked up. Not supported
+       in spectral modes unless :paramtype:`raw` is set.
+
+     - ``bc4``: blocks of 4x4 texels, every channel of which is compressed
+       to 64 bits (see below).
+
+     - ``bc4_srgb``: like ``bc4``, compressing sRGB-encoded values in
+       :math:`[0, 1]` (with the restrictions of ``unorm8_srgb``).
+
+ * - layout
+   - |string|
+   - Order of the texels in memory (see below). The following options are
+     currently available:
+
+     - ``auto`` (default): ``swizzled`` for textures with at least
+       2048x2048 texels in scalar variants, ``scanline`` otherwise.
+
+     - ``scanline``: rows of texels, in a Dr.Jit texture.
+
+     - ``swizzled``: tiles of 8x8 texels with a Z-order curve inside each tile.
+
  * - data
    - |tensor|
-   - Tensor array containing the texture data.
+   - Tensor array containing the texture data (not available with reduced
+     :paramtype:`storage` precision or the ``swizzled`` :paramtype:`layout`).
    - |exposed|, |differentiable|
 
 This plugin provides a bitmap texture that performs interpolated lookups given
@@ -92,7 +141,72 @@ for the renderer:
 
 These conversions can alternatively be disabled with the :paramtype:`raw` flag,
 e.g. when textured data is already in linear space or does not represent colors
-at all.
+at all. Textures that load the same file with the same :paramtype:`raw` flag
+share the converted data, even if their other parameters differ (see
+``AssetCache``).
+
+Processes running on the same machine (e.g. several render jobs per node) can
+additionally share the decoded linear bitmaps of texture files through a
+directory backed by shared memory, which is set by the ``MI_SHARED_ASSET_DIR``
+environment variable (e.g. ``/dev/shm/mitsuba``) or
+``mi.AssetCache.set_shared_directory()``. The first process decodes a file
+and stores the result, while the others map it read-only instead of decoding
+it again. The bitmap retained by the texture then references the shared
+pages. The texel storage used for lookups remains private to every process.
+
+With :monosp:`filter_type=mipmap`, a pyramid of successively halved
+resolutions is generated once at load time with ``Bitmap::resample()`` (using
+a box filter and the boundary condition implied by :paramtype:`wrap_mode`).
+Lookups blend the two levels closest to the size of the texture footprint,
+which is derived from the UV partials ``duv_dx`` and ``duv_dy`` of the surface
+interaction. BSDFs request these partials from the ray differentials of camera
+rays when one of their textures uses this mode. Other lookups (e.g. after
+secondary bounces, which carry no differentials) use the full resolution.
+Distant or minified textures then access far less memory and exhibit less
+aliasing noise. Only the full resolution level is exposed as the
+:paramtype:`data` parameter: the coarser levels are rebuilt from it when it
+changes but do not receive gradients.
+
+When :paramtype:`tiled` is set, the converted data (including the MIP map
+levels) is written to an anonymous temporary page file, split into tiles of
+64x64 pixels. Lookups read the tiles they need into a process-wide cache
+whose memory budget can be set with ``mi.TileCache.set_budget()`` (1 GiB by
+default). This makes it possible to render scenes referencing more texture
+data than fits into memory. Tiled textures don't expose the :paramtype:`data`
+parameter and don't support importance sampling (e.g. as the radiance of an
+area emitter). JIT variants evaluate textures inside compiled kernels, which
+cannot load tiles on demand, and therefore don't support this mode.
+
+With a reduced :paramtype:`storage` precision, the converted texels of all
+levels are packed into two (``half``) or four (``unorm8*``) values per 32 bit
+word. This halves or quarters the memory used by the texture and the
+bandwidth of every lookup, which suits most LDR textures. The values are
+decoded and interpolated in software, so the :paramtype:`accel` parameter has
+no effect and the texture data is not exposed as a differentiable parameter.
+This mode cannot be combined with :paramtype:`tiled`.
+
+The block-compressed ``bc4*`` precisions further reduce the footprint to 4
+bits per channel and texel, an eighth of single precision values. Every
+channel of a block of 4x4 texels is encoded like the BC4 format of GPU
+texture hardware (BC5 for two channels): two 8 bit endpoints and a 3 bit index
+per texel into the eight values interpolated between them. This retains
+smooth gradients and most edges of LDR data like albedos and roughness maps,
+but the error of blocks with a large contrast is visible on close-ups. These
+precisions use the ``swizzled`` layout, whose tiles consist of 4x4 quads, and
+are decoded in software in all variants.
+
+Texels are normally stored row by row. A bilinear lookup then reads two rows
+that are far apart in large textures, and incoherent lookups (e.g. after
+diffuse bounces) touch a new cache line and memory page for almost every
+fetch. The ``swizzled`` :paramtype:`layout` instead stores tiles of 8x8
+texels contiguously, with the texels of every tile ordered along a Z-order
+curve, such that most bilinear footprints lie within a single tile. It is
+selected by default for large textures in scalar variants. The texels are
+then interpolated in software (like with a reduced :paramtype:`storage`
+precision, with which the layout can be combined), hence the texture data is
+not exposed as a parameter. It cannot be combined with :paramtype:`tiled`.
+The script ``resources/benchmark_texture.py`` measures the throughput of
+random lookups with both layouts.
 
 .. tabs::
     .. code-tab:: xml
@@ -111,17 +225,27 @@ at all.
 
 */
 
+/// Order of the texels of a bitmap texture in memory
+enum class TexelLayout { Auto, Scanline, Swizzled };
+
 template <typename Float, typename Spectrum>
 class BitmapTexture final : public Texture<Float, Spectrum> {
 public:
     MI_IMPORT_TYPES(Texture)
 
+    /// Side length of the tiles of the swizzled layout
+    static constexpr uint32_t SwizzleTileSize = 8;
+
+    /// Textures with this many texels are swizzled by default (scalar variants)
+    static constexpr size_t SwizzleThreshold = 2048 * 2048;
+
     BitmapTexture(const Properties &props) : Texture(props) {
         m_transform = props.get<ScalarTransform4f>("to_uv", ScalarTransform4f())
                           .extract();
         if (m_transform != ScalarTransform3f())
             dr::make_opaque(m_transform);
 
+        fs::path file_path;
         if (props.has_property("bitmap")) {
             // Creates a Bitmap texture directly from an existing Bitmap object
             if (props.has_property("filename"))
@@ -136,21 +260,23 @@ public:
         } else {
             // Creates a Bitmap texture by loading an image from the filesystem
             FileResolver* fs = Thread::thread()->file_resolver();
-            fs::path file_path = fs->resolve(props.string("filename"));
+            file_path = fs->resolve(props.string("filename"));
             m_name = file_path.filename().string();
-            Log(Debug, "Loading bitmap texture from \"%s\" ..", m_name);
-            m_bitmap = new Bitmap(file_path);
         }
 
         std::string filter_mode_str = props.string("filter_type", "bilinear");
         dr::FilterMode filter_mode;
+        m_filter_mipmap = false;
         if (filter_mode_str == "nearest")
             filter_mode = dr::FilterMode::Nearest;
         else if (filter_mode_str == "bilinear")
             filter_mode = dr::FilterMode::Linear;
-        else
-            Throw("Invalid filter type \"%s\", must be one of: \"nearest\", or "
-                  "\"bilinear\"!", filter_mode_str);
+        else if (filter_mode_str == "mipmap") {
+            filter_mode = dr::FilterMode::Linear;
+            m_filter_mipmap = true;
+        } else
+            Throw("Invalid filter type \"%s\", must be one of: \"nearest\", "
+                  "\"bilinear\", or \"mipmap\"!", filter_mode_str);
 
         std::string wrap_mode_str = props.string("wrap_mode", "repeat");
         typename dr::WrapMode wrap_mode;
@@ -164,113 +290,121 @@ public:
             Throw("Invalid wrap mode \"%s\", must be one of: \"repeat\", "
                   "\"mirror\", or \"clamp\"!", wrap_mode_str);
 
-        /* Convert to linear RGB float bitmap, will be converted
-           into spectral profile coefficients below (in place) */
-        Bitmap::PixelFormat pixel_format = m_bitmap->pixel_format();
-        switch (pixel_format) {
-            case Bitmap::PixelFormat::Y:
-            case Bitmap::PixelFormat::YA:
-                pixel_format = Bitmap::PixelFormat::Y;
-                break;
-
-            case Bitmap::PixelFormat::RGB:
-            case Bitmap::PixelFormat::RGBA:
-            case Bitmap::PixelFormat::XYZ:
-            case Bitmap::PixelFormat::XYZA:
-                pixel_format = Bitmap::PixelFormat::RGB;
-                break;
-
-            default:
-                Throw("The texture needs to have a known pixel "
-                      "format (Y[A], RGB[A], XYZ[A] are supported).");
-        }
-
         /* Should Mitsuba disable transformations to the stored color data?
            (e.g. sRGB to linear, spectral upsampling, etc.) */
         m_raw = props.get<bool>("raw", false);
-        if (m_raw) {
-            /* Don't undo gamma correction in the conversion below.
-               This is needed, e.g., for normal maps. */
-            m_bitmap->set_srgb_gamma(false);
-        }
-
         m_accel = props.get<bool>("accel", true);
 
-        // Convert the image into the working floating point representation
-        m_bitmap =
-            m_bitmap->convert(pixel_format, struct_type_v<ScalarFloat>, false);
-
-        if (dr::any(m_bitmap->size() < 2)) {
-            Log(Warn,
-                "Image must be at least 2x2 pixels in size, up-sampling..");
-            using ReconstructionFilter = Bitmap::ReconstructionFilter;
-            ref<ReconstructionFilter> rfilter =
-                PluginManager::instance()->create_object<ReconstructionFilter>(
-                    Properties("tent"));
-            m_bitmap =
-                m_bitmap->resample(dr::maximum(m_bitmap->size(), 2), rfilter);
+        m_tiled = props.get<bool>("tiled", false);
+        if (m_tiled && dr::is_jit_v<Float>)
+            Throw("The \"tiled\" option of the bitmap texture is only "
+                  "supported in scalar variants!");
+
+        m_precision = storage_precision(props.string("storage", "float"));
+        if (m_tiled && m_precision != StoragePrecision::Float)
+            Throw("The \"tiled\" and \"storage\" options of the bitmap "
+                  "texture cannot be combined!");
+
+        std::string layout_str = props.string("layout", "auto");
+        if (layout_str == "auto")
+            m_layout = TexelLayout::Auto;
+        else if (layout_str == "scanline")
+            m_layout = TexelLayout::Scanline;
+        else if (layout_str == "swizzled")
+            m_layout = TexelLayout::Swizzled;
+        else
+            Throw("Invalid texel layout \"%s\", must be one of: \"auto\", "
+                  "\"scanline\", or \"swizzled\"!", layout_str);
+        if (m_tiled && m_layout == TexelLayout::Swizzled)
+            Throw("The \"tiled\" option and the \"swizzled\" layout of the "
+                  "bitmap texture cannot be combined!");
+        if (is_block_compressed(m_precision) && m_layout == TexelLayout::Scanline)
+            Throw("The \"%s\" storage precision of the bitmap texture "
+                  "requires the \"swizzled\" layout!", m_precision);
+
+        /* Textures loaded from a file share the converted data with other
+           instances that load the same file in the same way */
+        ref<BitmapData> data;
+        if (m_bitmap) {
+            data = convert_bitmap(linearize_bitmap(m_bitmap), wrap_mode);
+        } else {
+            std::string key = tfm::format(
+                "bitmap:%s:%i", detail::get_variant<Float, Spectrum>(), (int) m_raw);
+            // The pyramid depends on the boundary condition
+            if (m_filter_mipmap)
+                key += ":mipmap:" + wrap_mode_str;
+            if (m_tiled)
+                key += ":tiled";
+            if (m_precision != StoragePrecision::Float)
+                key += tfm::format(":%s", m_precision);
+            if (m_layout != TexelLayout::Scanline)
+                key += ":" + layout_str;
+            data = (BitmapData *) AssetCache::get(file_path, key, [&]() {
+                Log(Debug, "Loading bitmap texture from \"%s\" ..", m_name);
+                return ref<Object>(convert_bitmap(load_bitmap(file_path), wrap_mode));
+            }).get();
         }
 
-        ScalarFloat *ptr = (ScalarFloat *) m_bitmap->data();
-        size_t pixel_count = m_bitmap->pixel_count();
-        bool exceed_unit_range = false;
+        m_bitmap = data->bitmap;
+        m_mean = Float(data->mean);
+        m_swizzled = data->swizzled;
+
+        if (data->tiles) {
+            /* The texture only provides the filter configuration and number
+               of channels, the data is fetched from the tiled image */
+            m_tiles = data->tiles;
+            size_t channels = m_tiles->channel_count();
+            std::vector<ScalarFloat> placeholder(channels, 0.f);
+            size_t shape[3] = { 1, 1, channels };
+            m_texture = Texture2f(TensorXf(placeholder.data(), 3, shape),
+                                  false, false, filter_mode, wrap_mode);
+            return;
+        }
 
-        double mean = 0.0;
-        if (m_bitmap->channel_count() == 3) {
-            if (is_spectral_v<Spectrum> && !m_raw) {
-                for (size_t i = 0; i < pixel_count; ++i) {
-                    ScalarColor3f value = dr::load<ScalarColor3f>(ptr);
-                    if (!all(value >= 0 && value <= 1))
-                        exceed_unit_range = true;
-                    value = srgb_model_fetch(value);
-                    mean += (double) srgb_model_mean(value);
-                    dr::store(ptr, value);
-                    ptr += 3;
-                }
-            } else {
-                for (size_t i = 0; i < pixel_count; ++i) {
-                    ScalarColor3f value = dr::load<ScalarColor3f>(ptr);
-                    if (!all(value >= 0 && value <= 1))
-                        exceed_unit_range = true;
-                    mean += (double) luminance(value);
-                    ptr += 3;
-                }
-            }
-        } else if (m_bitmap->channel_count() == 1) {
-            for (size_t i = 0; i < pixel_count; ++i) {
-                ScalarFloat value = ptr[i];
-                if (!(value >= 0 && value <= 1))
-                    exceed_unit_range = true;
-                mean += (double) value;
-            }
-        } else {
-            Throw("Unsupported channel count: %d (expected 1 or 3)",
-                  m_bitmap->channel_count());
+        if (!data->packed.empty()) {
+            // As above, the texels are fetched from the packed (or swizzled) storage
+            m_packed = data->packed;
+            m_packed_res = data->packed_res;
+            size_t channels = m_packed[0]->channels();
+            std::vector<ScalarFloat> placeholder(channels, 0.f);
+            size_t shape[3] = { 1, 1, channels };
+            m_texture = Texture2f(TensorXf(placeholder.data(), 3, shape),
+                                  false, false, filter_mode, wrap_mode);
+            return;
         }
 
-        if (exceed_unit_range && !m_raw)
-            Log(Warn,
-                "BitmapTexture: texture named \"%s\" contains pixels that "
-                "exceed the [0, 1] range!",
-                m_name);
+        m_texture = Texture2f(data->tensor, m_accel, m_accel, filter_mode,
+                              wrap_mode);
 
-        m_mean = Float(mean / pixel_count);
+        for (const TensorXf &level : data->mipmap)
+            m_mipmap.emplace_back(level, m_accel, m_accel,
+                                  dr::FilterMode::Linear, wrap_mode);
 
-        size_t channels = m_bitmap->channel_count();
-        ScalarVector2i res = ScalarVector2i(m_bitmap->size());
-        size_t shape[3] = { (size_t) res.y(), (size_t) res.x(), channels };
-        m_texture = Texture2f(TensorXf(m_bitmap->data(), 3, shape), m_accel,
-                              m_accel, filter_mode, wrap_mode);
+        // All render workers read the texels, spread them over the NUMA nodes
+        if constexpr (!dr::is_jit_v<Float>) {
+            if (Thread::numa_aware()) {
+                auto interleave = [](const TensorXf &tensor) {
+                    util::numa_interleave(tensor.array().data(),
+                                          tensor.array().size() *
+                                              sizeof(ScalarFloat));
+                };
+                interleave(m_texture.tensor());
+                for (const Texture2f &level : m_mipmap)
+                    interleave(level.tensor());
+            }
+        }
     }
 
     void traverse(TraversalCallback *callback) override {
-        callback->put_parameter("data",  m_texture.tensor(), +ParamFlags::Differentiable);
+        if (!m_tiles && m_packed.empty())
+            callback->put_parameter("data",  m_texture.tensor(), +ParamFlags::Differentiable);
         callback->put_parameter("to_uv", m_transform,        +ParamFlags::NonDifferentiable);
     }
 
     void
     parameters_changed(const std::vector<std::string> &keys = {}) override {
-        if (keys.empty() || string::contains(keys, "data")) {
+        if (!m_tiles && m_packed.empty() &&
+            (keys.empty() || string::contains(keys, "data"))) {
             const size_t channels = m_texture.shape()[2];
             if (channels != 1 && channels != 3)
                 Throw("parameters_changed(): The bitmap texture %s was changed "
@@ -284,12 +418,18 @@ public:
 
             m_texture.set_tensor(m_texture.tensor());
             rebuild_internals(true, m_distr2d != nullptr);
+            if (m_filter_mipmap)
+                rebuild_mipmap();
         }
     }
 
     UnpolarizedSpectrum eval(const SurfaceInteraction3f &si,
                              Mask active) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>)
+            this->m_eval_counter.increment();
+#endif
 
         const size_t channels = m_texture.shape()[2];
         if (channels == 3 && is_spectral_v<Spectrum> && m_raw) {
@@ -324,6 +464,10 @@ public:
     Float eval_1(const SurfaceInteraction3f &si,
                  Mask active = true) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>)
+            this->m_eval_counter.increment();
+#endif
 
         const size_t channels = m_texture.shape()[2];
         if (channels == 3 && is_spectral_v<Spectrum> && !m_raw) {
@@ -346,6 +490,10 @@ public:
     Vector2f eval_1_grad(const SurfaceInteraction3f &si,
                          Mask active = true) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>)
+            this->m_eval_counter.increment();
+#endif
 
         const size_t channels = m_texture.shape()[2];
         if (channels == 3 && is_spectral_v<Spectrum> && !m_raw) {
@@ -373,10 +521,7 @@ public:
                     fetch_values[2] = &f01;
                     fetch_values[3] = &f11;
 
-                    if (m_accel)
-                        m_texture.eval_fetch(uv, fetch_values, active);
-                    else
-                        m_texture.eval_fetch_nonaccel(uv, fetch_values, active);
+                    fetch(uv, fetch_values, active);
                 } else { // 3 channels
                     Color3f v00, v10, v01, v11;
                     dr::Array<Float *, 4> fetch_values;
@@ -385,10 +530,7 @@ public:
                     fetch_values[2] = v01.data();
                     fetch_values[3] = v11.data();
 
-                    if (m_accel)
-                        m_texture.eval_fetch(uv, fetch_values, active);
-                    else
-                        m_texture.eval_fetch_nonaccel(uv, fetch_values, active);
+                    fetch(uv, fetch_values, active);
 
                     f00 = luminance(v00);
                     f10 = luminance(v10);
@@ -425,6 +567,10 @@ public:
     Color3f eval_3(const SurfaceInteraction3f &si,
                    Mask active = true) const override {
         MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+#if defined(MI_ENABLE_STATISTICS)
+        if constexpr (!dr::is_jit_v<Float>)
+            this->m_eval_counter.increment();
+#endif
 
         const size_t channels = m_texture.shape()[2];
         if (channels != 3) {
@@ -505,14 +651,10 @@ public:
             Point2f w1 = uv - Point2f(uv_i),
                     w0 = 1.f - w1;
 
-            Float v00 = m_distr2d->pdf(m_texture.wrap(uv_i + Point2i(0, 0)),
-                                       active),
-                  v10 = m_distr2d->pdf(m_texture.wrap(uv_i + Point2i(1, 0)),
-                                       active),
-                  v01 = m_distr2d->pdf(m_texture.wrap(uv_i + Point2i(0, 1)),
-                                       active),
-                  v11 = m_distr2d->pdf(m_texture.wrap(uv_i + Point2i(1, 1)),
-                                       active);
+            Float v00 = m_distr2d->pdf(wrap(uv_i + Point2i(0, 0)), active),
+                  v10 = m_distr2d->pdf(wrap(uv_i + Point2i(1, 0)), active),
+                  v01 = m_distr2d->pdf(wrap(uv_i + Point2i(0, 1)), active),
+                  v11 = m_distr2d->pdf(wrap(uv_i + Point2i(1, 1)), active);
 
             Float v0 = dr::fmadd(w0.x(), v00, w1.x() * v10),
                   v1 = dr::fmadd(w0.x(), v01, w1.x() * v11);
@@ -523,7 +665,7 @@ public:
             Point2f uv = pos_ * res;
 
             // Integer pixel positions for nearest-neighbor interpolation
-            Vector2i uv_i = m_texture.wrap(dr::floor2int<Vector2i>(uv));
+            Vector2i uv_i = wrap(dr::floor2int<Vector2i>(uv));
 
             return m_distr2d->pdf(uv_i, active) * dr::prod(res);
         }
@@ -550,6 +692,10 @@ public:
     }
 
     ScalarVector2i resolution() const override {
+        if (m_tiles)
+            return ScalarVector2i(m_tiles->size());
+        if (!m_packed.empty())
+            return m_packed_res[0];
         const size_t *shape = m_texture.shape();
         return { (int) shape[1], (int) shape[0] };
     }
@@ -558,12 +704,40 @@ public:
 
     bool is_spatially_varying() const override { return true; }
 
+    bool needs_differentials() const override { return m_filter_mipmap; }
+
+    size_t memory_footprint() const override {
+        auto texels = [](const Texture2f &texture) {
+            const size_t *shape = texture.shape();
+            return shape[0] * shape[1] * shape[2];
+        };
+
+        /* Tiles of tiled textures are stored in the process-wide
+           TileCache, which isn't attributed to individual textures */
+        size_t result = texels(m_texture);
+        for (const Texture2f &level : m_mipmap)
+            result += texels(level);
+        result *= sizeof(ScalarFloat);
+
+        for (const auto &packed : m_packed)
+            result += packed->nbytes();
+        if (m_bitmap)
+            result += m_bitmap->memory_footprint();
+        if (m_distr2d)
+            result += m_distr2d->nbytes();
+        return result;
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "BitmapTexture[" << std::endl
             << "  name = \"" << m_name << "\"," << std::endl
             << "  resolution = \"" << resolution() << "\"," << std::endl
             << "  raw = " << (int) m_raw << "," << std::endl
+            << "  mipmap_levels = " << mipmap_levels() << "," << std::endl
+            << "  tiled = " << (int) (bool) m_tiles << "," << std::endl
+            << "  storage = " << m_precision << "," << std::endl
+            << "  layout = " << (m_swizzled ? "swizzled" : "scanline") << "," << std::endl
             << "  mean = " << m_mean << "," << std::endl
             << "  transform = " << string::indent(m_transform) << std::endl
             << "]";
@@ -584,7 +758,22 @@ protected:
 
         Point2f uv = m_transform.transform_affine(si.uv);
 
-        if (m_texture.filter_mode() == dr::FilterMode::Linear) {
+        auto lookup = [&](uint32_t level, Mask active_) {
+            return lookup_spectral(level, uv, si.wavelengths, active_);
+        };
+
+        if (use_mipmap(si))
+            return eval_mipmap<UnpolarizedSpectrum>(si, active, lookup);
+
+        return lookup(0, active);
+    }
+
+    /// Spectral lookup into one level of the texture
+    MI_INLINE UnpolarizedSpectrum
+    lookup_spectral(uint32_t level, Point2f uv,
+                    const Wavelength &wavelengths, Mask active) const {
+        // Coarser MIP map levels are always interpolated
+        if (level > 0 || m_texture.filter_mode() == dr::FilterMode::Linear) {
             Color3f v00, v10, v01, v11;
             dr::Array<Float *, 4> fetch_values;
             fetch_values[0] = v00.data();
@@ -592,18 +781,15 @@ protected:
             fetch_values[2] = v01.data();
             fetch_values[3] = v11.data();
 
-            if (m_accel)
-                m_texture.eval_fetch(uv, fetch_values, active);
-            else
-                m_texture.eval_fetch_nonaccel(uv, fetch_values, active);
+            fetch(uv, fetch_values, active, level);
 
             UnpolarizedSpectrum c00, c10, c01, c11, c0, c1;
-            c00 = srgb_model_eval<UnpolarizedSpectrum>(v00, si.wavelengths);
-            c10 = srgb_model_eval<UnpolarizedSpectrum>(v10, si.wavelengths);
-            c01 = srgb_model_eval<UnpolarizedSpectrum>(v01, si.wavelengths);
-            c11 = srgb_model_eval<UnpolarizedSpectrum>(v11, si.wavelengths);
+            c00 = srgb_model_eval<UnpolarizedSpectrum>(v00, wavelengths);
+            c10 = srgb_model_eval<UnpolarizedSpectrum>(v10, wavelengths);
+            c01 = srgb_model_eval<UnpolarizedSpectrum>(v01, wavelengths);
+            c11 = srgb_model_eval<UnpolarizedSpectrum>(v11, wavelengths);
 
-            ScalarVector2i res = resolution();
+            ScalarVector2i res = level_resolution(level);
             uv = dr::fmadd(uv, res, -.5f);
             Vector2i uv_i = dr::floor2int<Vector2i>(uv);
 
@@ -616,12 +802,8 @@ protected:
             return dr::fmadd(w0.y(), c0, w1.y() * c1);
         } else {
             Color3f out;
-            if (m_accel)
-                m_texture.eval(uv, out.data(), active);
-            else
-                m_texture.eval_nonaccel(uv, out.data(), active);
-
-            return srgb_model_eval<UnpolarizedSpectrum>(out, si.wavelengths);
+            lookup_level(level, uv, out.data(), active);
+            return srgb_model_eval<UnpolarizedSpectrum>(out, wavelengths);
         }
     }
 
@@ -637,13 +819,16 @@ protected:
 
         Point2f uv = m_transform.transform_affine(si.uv);
 
-        Float out;
-        if (m_accel)
-            m_texture.eval(uv, &out, active);
-        else
-            m_texture.eval_nonaccel(uv, &out, active);
+        auto lookup = [&](uint32_t level, Mask active_) {
+            Float out;
+            lookup_level(level, uv, &out, active_);
+            return out;
+        };
 
-        return out;
+        if (use_mipmap(si))
+            return eval_mipmap<Float>(si, active, lookup);
+
+        return lookup(0, active);
     }
 
     /**
@@ -658,13 +843,333 @@ protected:
 
         Point2f uv = m_transform.transform_affine(si.uv);
 
-        Color3f out;
+        auto lookup = [&](uint32_t level, Mask active_) {
+            Color3f out;
+            lookup_level(level, uv, out.data(), active_);
+            return out;
+        };
+
+        if (use_mipmap(si))
+            return eval_mipmap<Color3f>(si, active, lookup);
+
+        return lookup(0, active);
+    }
+
+    /// Return the number of MIP map levels below the full resolution
+    uint32_t mipmap_levels() const {
+        if (m_tiles)
+            return m_tiles->level_count() - 1;
+        if (!m_packed.empty())
+            return (uint32_t) m_packed.size() - 1;
+        return (uint32_t) m_mipmap.size();
+    }
+
+    /// Return the texture storing a MIP map level (not used in tiled or packed mode)
+    const Texture2f &level_texture(uint32_t level) const {
+        return level == 0 ? m_texture : m_mipmap[level - 1];
+    }
+
+    /// Return the resolution of a MIP map level
+    ScalarVector2i level_resolution(uint32_t level) const {
+        if (m_tiles)
+            return ScalarVector2i(m_tiles->size(level));
+        if (!m_packed.empty())
+            return m_packed_res[level];
+        const size_t *shape = level_texture(level).shape();
+        return { (int) shape[1], (int) shape[0] };
+    }
+
+    /// Interpolated (or nearest neighbor) lookup into a MIP map level
+    MI_INLINE void lookup_level(uint32_t level, const Point2f &uv, Float *out,
+                                Mask active) const {
+        if constexpr (!dr::is_array_v<Float>) {
+            if (m_tiles) {
+                lookup_tiled(level, uv, out);
+                return;
+            }
+        }
+
+        if (!m_packed.empty()) {
+            lookup_packed(level, uv, out, active);
+            return;
+        }
+
+        const Texture2f &texture = level_texture(level);
         if (m_accel)
-            m_texture.eval(uv, out.data(), active);
+            texture.eval(uv, out, active);
         else
-            m_texture.eval_nonaccel(uv, out.data(), active);
+            texture.eval_nonaccel(uv, out, active);
+    }
+
+    /// Fetch the texels of the bilinear footprint of \c uv in a MIP map level
+    MI_INLINE void fetch(const Point2f &uv, const dr::Array<Float *, 4> &out,
+                         Mask active, uint32_t level = 0) const {
+        if constexpr (!dr::is_array_v<Float>) {
+            if (m_tiles) {
+                fetch_tiled(level, uv, out);
+                return;
+            }
+        }
+
+        if (!m_packed.empty()) {
+            fetch_packed(level, uv, out, active);
+            return;
+        }
+
+        const Texture2f &texture = level_texture(level);
+        if (m_accel)
+            texture.eval_fetch(uv, out, active);
+        else
+            texture.eval_fetch_nonaccel(uv, out, active);
+    }
+
+    /// Apply the wrap mode to integer texel coordinates of a MIP map level
+    Vector2i wrap(const Vector2i &p, uint32_t level = 0) const {
+        if (m_packed.empty() && level == 0)
+            return m_texture.wrap(p);
+
+        Vector2i res(level_resolution(level)), q;
+        switch (m_texture.wrap_mode()) {
+            case dr::WrapMode::Repeat:
+                q = p % res;
+                return dr::select(q < 0, q + res, q);
+
+            case dr::WrapMode::Mirror: {
+                    Vector2i period = 2 * res;
+                    q = p % period;
+                    q = dr::select(q < 0, q + period, q);
+                    return dr::select(q < res, q, period - 1 - q);
+                }
 
-        return out;
+            default:
+                return dr::clamp(p, 0, res - 1);
+        }
+    }
+
+    /// Index of the texel at the given coordinates in a packed MIP map level
+    UInt32 texel_index(const Vector2i &p, uint32_t level) const {
+        Vector2i q = wrap(p, level);
+        if (m_swizzled)
+            return swizzled_index(UInt32(q.x()), UInt32(q.y()),
+                                  swizzle_tile_count(m_packed_res[level].x()));
+        return UInt32(q.y() * m_packed_res[level].x() + q.x());
+    }
+
+    /// Number of tiles of the swizzled layout that cover \c size texels
+    static uint32_t swizzle_tile_count(int size) {
+        return ((uint32_t) size + SwizzleTileSize - 1) / SwizzleTileSize;
+    }
+
+    /**
+     * \brief Index of a texel in the swizzled layout
+     *
+     * Tiles of 8x8 texels are stored row by row, and the 64 texels of every
+     * tile are ordered along a Z-order curve.
+     */
+    template <typename UInt>
+    static UInt swizzled_index(const UInt &x, const UInt &y, uint32_t tiles_x) {
+        UInt tile  = (y >> 3) * tiles_x + (x >> 3),
+             inner = (x & 1u) | ((y & 1u) << 1) | ((x & 2u) << 1) |
+                     ((y & 2u) << 2) | ((x & 4u) << 2) | ((y & 4u) << 3);
+        return (tile << 6) | inner;
+    }
+
+    /**
+     * \brief Reorder scanline texels into the swizzled layout
+     *
+     * Partial tiles at the right and bottom edge are padded by replicating
+     * the edge texels, which don't affect the range of 8 bit encodings.
+     */
+    static std::vector<ScalarFloat> swizzle_texels(const ScalarFloat *values,
+                                                   const ScalarVector2i &res,
+                                                   uint32_t channels) {
+        uint32_t tiles_x = swizzle_tile_count(res.x()),
+                 tiles_y = swizzle_tile_count(res.y());
+        std::vector<ScalarFloat> result((size_t) tiles_x * tiles_y *
+                                        SwizzleTileSize * SwizzleTileSize * channels);
+
+        for (uint32_t y = 0; y < tiles_y * SwizzleTileSize; ++y) {
+            uint32_t y_src = std::min(y, (uint32_t) res.y() - 1);
+            for (uint32_t x = 0; x < tiles_x * SwizzleTileSize; ++x) {
+                uint32_t x_src = std::min(x, (uint32_t) res.x() - 1);
+                const ScalarFloat *src =
+                    values + ((size_t) y_src * res.x() + x_src) * channels;
+                ScalarFloat *dst =
+                    result.data() + (size_t) swizzled_index(x, y, tiles_x) * channels;
+                for (uint32_t c = 0; c < channels; ++c)
+                    dst[c] = src[c];
+            }
+        }
+
+        return result;
+    }
+
+    /// Inverse of \ref swizzle_texels() (drops the padding)
+    static std::vector<ScalarFloat> unswizzle_texels(const std::vector<ScalarFloat> &values,
+                                                     const ScalarVector2i &res,
+                                                     uint32_t channels) {
+        uint32_t tiles_x = swizzle_tile_count(res.x());
+        std::vector<ScalarFloat> result((size_t) dr::prod(res) * channels);
+
+        for (uint32_t y = 0; y < (uint32_t) res.y(); ++y) {
+            for (uint32_t x = 0; x < (uint32_t) res.x(); ++x) {
+                const ScalarFloat *src =
+                    values.data() + (size_t) swizzled_index(x, y, tiles_x) * channels;
+                ScalarFloat *dst =
+                    result.data() + ((size_t) y * res.x() + x) * channels;
+                for (uint32_t c = 0; c < channels; ++c)
+                    dst[c] = src[c];
+            }
+        }
+
+        return result;
+    }
+
+    /// Counterpart of \ref fetch() for packed texel data
+    void fetch_packed(uint32_t level, const Point2f &uv,
+                      const dr::Array<Float *, 4> &out, Mask active) const {
+        ScalarVector2f res(m_packed_res[level]);
+        Vector2i pos = dr::floor2int<Vector2i>(dr::fmadd(uv, res, -.5f));
+        for (int k = 0; k < 4; ++k)
+            m_packed[level]->fetch(
+                texel_index(pos + Vector2i(k & 1, k >> 1), level), out[k],
+                active);
+    }
+
+    /// Counterpart of \ref lookup_level() for packed texel data
+    void lookup_packed(uint32_t level, const Point2f &uv, Float *out,
+                       Mask active) const {
+        const PackedStorage<Float> &storage = *m_packed[level];
+        ScalarVector2f res(m_packed_res[level]);
+
+        if (level == 0 && m_texture.filter_mode() == dr::FilterMode::Nearest) {
+            storage.fetch(texel_index(dr::floor2int<Vector2i>(uv * res), 0),
+                          out, active);
+            return;
+        }
+
+        Float values[4][3];
+        fetch_packed(level, uv,
+                     dr::Array<Float *, 4>(values[0], values[1], values[2],
+                                           values[3]),
+                     active);
+
+        Point2f pos = dr::fmadd(uv, res, -.5f),
+                w1  = pos - dr::floor(pos),
+                w0  = 1.f - w1;
+
+        for (uint32_t c = 0; c < storage.channels(); ++c)
+            out[c] = dr::fmadd(w0.y(), dr::fmadd(w0.x(), values[0][c], w1.x() * values[1][c]),
+                               w1.y() * dr::fmadd(w0.x(), values[2][c], w1.x() * values[3][c]));
+    }
+
+    /// Apply the wrap mode to an integer texel coordinate (tiled mode)
+    int wrap_texel(int x, int size) const {
+        switch (m_texture.wrap_mode()) {
+            case dr::WrapMode::Repeat:
+                x %= size;
+                return x < 0 ? x + size : x;
+
+            case dr::WrapMode::Mirror: {
+                    int period = 2 * size;
+                    x %= period;
+                    if (x < 0)
+                        x += period;
+                    return x < size ? x : period - 1 - x;
+                }
+
+            default:
+                return std::min(std::max(x, 0), size - 1);
+        }
+    }
+
+    /// Scalar counterpart of \ref fetch() that reads a tiled image
+    void fetch_tiled(uint32_t level, const ScalarPoint2f &uv,
+                     const dr::Array<ScalarFloat *, 4> &out) const {
+        ScalarVector2i res(m_tiles->size(level));
+        ScalarPoint2i pos = dr::floor2int<ScalarPoint2i>(dr::fmadd(uv, res, -.5f));
+        uint32_t channels = m_tiles->channel_count();
+
+        float value[3];
+        for (uint32_t k = 0; k < 4; ++k) {
+            m_tiles->fetch(level,
+                           (uint32_t) wrap_texel(pos.x() + (int) (k & 1), res.x()),
+                           (uint32_t) wrap_texel(pos.y() + (int) (k >> 1), res.y()),
+                           value);
+            for (uint32_t c = 0; c < channels; ++c)
+                out[k][c] = (ScalarFloat) value[c];
+        }
+    }
+
+    /// Scalar counterpart of \ref lookup_level() that reads a tiled image
+    void lookup_tiled(uint32_t level, const ScalarPoint2f &uv,
+                      ScalarFloat *out) const {
+        ScalarVector2i res(m_tiles->size(level));
+        uint32_t channels = m_tiles->channel_count();
+
+        if (m_texture.filter_mode() == dr::FilterMode::Nearest) {
+            ScalarPoint2i pos = dr::floor2int<ScalarPoint2i>(uv * res);
+            float value[3];
+            m_tiles->fetch(level, (uint32_t) wrap_texel(pos.x(), res.x()),
+                           (uint32_t) wrap_texel(pos.y(), res.y()), value);
+            for (uint32_t c = 0; c < channels; ++c)
+                out[c] = (ScalarFloat) value[c];
+            return;
+        }
+
+        ScalarFloat values[4][3];
+        fetch_tiled(level, uv, dr::Array<ScalarFloat *, 4>(values[0], values[1],
+                                                           values[2], values[3]));
+
+        ScalarPoint2f pos = dr::fmadd(uv, res, -.5f),
+                      w1  = pos - dr::floor(pos),
+                      w0  = 1.f - w1;
+
+        for (uint32_t c = 0; c < channels; ++c)
+            out[c] = dr::fmadd(w0.y(), dr::fmadd(w0.x(), values[0][c], w1.x() * values[1][c]),
+                               w1.y() * dr::fmadd(w0.x(), values[2][c], w1.x() * values[3][c]));
+    }
+
+    /// Should the lookup for the given surface interaction use the MIP map?
+    MI_INLINE bool use_mipmap(const SurfaceInteraction3f &si) const {
+        return mipmap_levels() > 0 && si.has_uv_partials();
+    }
+
+    /**
+     * \brief Trilinear MIP map lookup
+     *
+     * The level is the base-2 logarithm of the larger of the two UV partials
+     * in texels. \c lookup is invoked with the indices of the (at most) two
+     * levels that contribute to each lane.
+     */
+    template <typename Value, typename Lookup>
+    MI_INLINE Value eval_mipmap(const SurfaceInteraction3f &si, Mask active,
+                                const Lookup &lookup) const {
+        ScalarVector2f res(resolution());
+        Vector2f duv_dx = (m_transform * si.duv_dx) * res,
+                 duv_dy = (m_transform * si.duv_dy) * res;
+
+        Float width = dr::maximum(dr::squared_norm(duv_dx),
+                                  dr::squared_norm(duv_dy)),
+              level = dr::clamp(.5f * dr::log2(dr::maximum(width, 1e-8f)), 0.f,
+                                (ScalarFloat) mipmap_levels());
+
+        UInt32 level_i = dr::floor2int<UInt32>(level);
+        Float t = level - Float(level_i);
+
+        Value result = dr::zeros<Value>();
+        for (uint32_t i = 0; i <= mipmap_levels(); ++i) {
+            Float weight = dr::select(dr::eq(level_i, i), 1.f - t,
+                                      dr::select(dr::eq(level_i + 1, i), t, 0.f));
+            Mask active_i = active && weight > 0.f;
+            if (dr::none_or<false>(active_i))
+                continue;
+
+            dr::masked(result, active_i) =
+                dr::fmadd(lookup(i, active_i), weight, result);
+        }
+
+        return result;
     }
 
     /**
@@ -680,7 +1185,14 @@ protected:
         if (m_transform != ScalarTransform3f())
             dr::make_opaque(m_transform);
 
-        const ScalarFloat *ptr = data.data();
+        std::vector<ScalarFloat> decoded;
+        if (!m_packed.empty()) {
+            decoded = m_packed[0]->decode();
+            if (m_swizzled)
+                decoded = unswizzle_texels(decoded, m_packed_res[0],
+                                           m_packed[0]->channels());
+        }
+        const ScalarFloat *ptr = m_packed.empty() ? data.data() : decoded.data();
 
         double mean = 0.0;
         size_t pixel_count = (size_t) dr::prod(resolution());
@@ -733,8 +1245,75 @@ protected:
                 m_name);
     }
 
+    /// Regenerate the coarser MIP map levels following an update of \c data
+    void rebuild_mipmap() {
+        auto&& data = dr::migrate(m_texture.value(), AllocType::Host);
+
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+
+        const size_t *shape = m_texture.shape();
+        ref<Bitmap> bitmap = new Bitmap(
+            shape[2] == 1 ? Bitmap::PixelFormat::Y : Bitmap::PixelFormat::RGB,
+            struct_type_v<ScalarFloat>, ScalarVector2u(shape[1], shape[0]),
+            shape[2], {}, (uint8_t *) data.data());
+
+        m_mipmap.clear();
+        for (const TensorXf &level : bitmap_to_tensors(
+                 build_mipmap(bitmap, m_texture.wrap_mode())))
+            m_mipmap.emplace_back(level, m_accel, m_accel,
+                                  dr::FilterMode::Linear, m_texture.wrap_mode());
+    }
+
+    /**
+     * \brief Generate the levels of a MIP map pyramid below \c bitmap
+     *
+     * Every level halves the resolution of the previous one (rounding down)
+     * until a single pixel remains.
+     */
+    static std::vector<ref<Bitmap>> build_mipmap(const Bitmap *bitmap,
+                                                 dr::WrapMode wrap_mode) {
+        FilterBoundaryCondition bc;
+        switch (wrap_mode) {
+            case dr::WrapMode::Repeat: bc = FilterBoundaryCondition::Repeat; break;
+            case dr::WrapMode::Mirror: bc = FilterBoundaryCondition::Mirror; break;
+            default:                   bc = FilterBoundaryCondition::Clamp; break;
+        }
+
+        using ReconstructionFilter = Bitmap::ReconstructionFilter;
+        ref<ReconstructionFilter> rfilter =
+            PluginManager::instance()->create_object<ReconstructionFilter>(
+                Properties("box"));
+
+        std::vector<ref<Bitmap>> levels;
+        ScalarVector2u size = bitmap->size();
+        while (dr::any(size > 1u)) {
+            size = dr::maximum(size / 2u, 1u);
+            levels.push_back(bitmap->resample(size, rfilter, { bc, bc }));
+            bitmap = levels.back().get();
+        }
+
+        return levels;
+    }
+
+    /// Wrap the contents of a list of bitmaps into tensors
+    static std::vector<TensorXf>
+    bitmap_to_tensors(const std::vector<ref<Bitmap>> &bitmaps) {
+        std::vector<TensorXf> result;
+        for (const Bitmap *bitmap : bitmaps) {
+            size_t shape[3] = { (size_t) bitmap->height(),
+                                (size_t) bitmap->width(),
+                                bitmap->channel_count() };
+            result.emplace_back(bitmap->data(), 3, shape);
+        }
+        return result;
+    }
+
     /// Construct 2D distribution upon first access, avoid races
     MI_INLINE void init_distr() const {
+        if (m_tiles)
+            Throw("The bitmap texture %s is tiled and cannot be importance "
+                  "sampled!", to_string());
         std::lock_guard<std::mutex> lock(m_mutex);
         if (!m_distr2d) {
             auto self = const_cast<BitmapTexture *>(this);
@@ -742,8 +1321,226 @@ protected:
         }
     }
 
+    /// Converted texture data that can be shared between several instances
+    struct BitmapData : Object {
+        ref<Bitmap> bitmap;
+        TensorXf tensor;
+        /// Coarser MIP map levels (only with <tt>filter_type=mipmap</tt>)
+        std::vector<TensorXf> mipmap;
+        /// Paged storage of all levels (replaces the above in tiled mode)
+        ref<TiledImage> tiles;
+        /// All levels with reduced precision or swizzled (replaces the above)
+        std::vector<std::shared_ptr<const PackedStorage<Float>>> packed;
+        std::vector<ScalarVector2i> packed_res;
+        /// Are the texels of \c packed in the swizzled layout?
+        bool swizzled = false;
+        ScalarFloat mean;
+    };
+
+    /// Convert a bitmap into the working representation of the texture
+    /**
+     * Load the linear bitmap of a file. Processes on the same machine share
+     * it through the node-local asset directory, if one is set.
+     */
+    ref<Bitmap> load_bitmap(const fs::path &path) const {
+        std::string key = tfm::format("bitmap:%i:%i", (int) sizeof(ScalarFloat),
+                                      (int) m_raw);
+        ref<MemoryMappedFile> mmap =
+            AssetCache::get_shared(path, key, [&](Stream *stream) {
+                linearize_bitmap(new Bitmap(path))->write_raw(stream);
+            });
+        if (mmap)
+            return Bitmap::map_raw(mmap);
+        return linearize_bitmap(new Bitmap(path));
+    }
+
+    /// Convert a bitmap into the linear floating point working representation
+    ref<Bitmap> linearize_bitmap(ref<Bitmap> bitmap) const {
+        if (m_raw) {
+            /* Don't undo gamma correction in the conversion below.
+               This is needed, e.g., for normal maps. */
+            bitmap->set_srgb_gamma(false);
+        }
+
+        /* Convert to linear RGB float bitmap, will be converted
+           into spectral profile coefficients by convert_bitmap() */
+        Bitmap::PixelFormat pixel_format = bitmap->pixel_format();
+        switch (pixel_format) {
+            case Bitmap::PixelFormat::Y:
+            case Bitmap::PixelFormat::YA:
+                pixel_format = Bitmap::PixelFormat::Y;
+                break;
+
+            case Bitmap::PixelFormat::RGB:
+            case Bitmap::PixelFormat::RGBA:
+            case Bitmap::PixelFormat::XYZ:
+            case Bitmap::PixelFormat::XYZA:
+                pixel_format = Bitmap::PixelFormat::RGB;
+                break;
+
+            default:
+                Throw("The texture needs to have a known pixel "
+                      "format (Y[A], RGB[A], XYZ[A] are supported).");
+        }
+
+        // Convert the image into the working floating point representation
+        bitmap =
+            bitmap->convert(pixel_format, struct_type_v<ScalarFloat>, false);
+
+        if (dr::any(bitmap->size() < 2)) {
+            Log(Warn,
+                "Image must be at least 2x2 pixels in size, up-sampling..");
+            using ReconstructionFilter = Bitmap::ReconstructionFilter;
+            ref<ReconstructionFilter> rfilter =
+                PluginManager::instance()->create_object<ReconstructionFilter>(
+                    Properties("tent"));
+            bitmap =
+                bitmap->resample(dr::maximum(bitmap->size(), 2), rfilter);
+        }
+
+        return bitmap;
+    }
+
+    ref<BitmapData> convert_bitmap(ref<Bitmap> bitmap,
+                                   dr::WrapMode wrap_mode) const {
+        // Shared bitmaps are read-only, work on a copy when converting in place
+        if (!bitmap->owns_data() && bitmap->channel_count() == 3 &&
+            is_spectral_v<Spectrum> && !m_raw)
+            bitmap = new Bitmap(*bitmap);
+
+        /* Filter the linear color values (before a conversion into
+           spectral profile coefficients) */
+        std::vector<ref<Bitmap>> mipmap;
+        if (m_filter_mipmap)
+            mipmap = build_mipmap(bitmap, wrap_mode);
+
+        ScalarFloat *ptr = (ScalarFloat *) bitmap->data();
+        size_t pixel_count = bitmap->pixel_count();
+        bool exceed_unit_range = false;
+
+        double mean = 0.0;
+        if (bitmap->channel_count() == 3) {
+            if (is_spectral_v<Spectrum> && !m_raw) {
+                for (size_t i = 0; i < 3 * pixel_count; ++i) {
+                    if (!(ptr[i] >= 0 && ptr[i] <= 1))
+                        exceed_unit_range = true;
+                }
+
+                // Convert to spectral profile coefficients (in parallel)
+                srgb_model_fetch(ptr, ptr, pixel_count);
+
+                for (size_t i = 0; i < pixel_count; ++i) {
+                    mean += (double) srgb_model_mean(dr::load<ScalarColor3f>(ptr));
+                    ptr += 3;
+                }
+            } else {
+                for (size_t i = 0; i < pixel_count; ++i) {
+                    ScalarColor3f value = dr::load<ScalarColor3f>(ptr);
+                    if (!all(value >= 0 && value <= 1))
+                        exceed_unit_range = true;
+                    mean += (double) luminance(value);
+                    ptr += 3;
+                }
+            }
+        } else if (bitmap->channel_count() == 1) {
+            for (size_t i = 0; i < pixel_count; ++i) {
+                ScalarFloat value = ptr[i];
+                if (!(value >= 0 && value <= 1))
+                    exceed_unit_range = true;
+                mean += (double) value;
+            }
+        } else {
+            Throw("Unsupported channel count: %d (expected 1 or 3)",
+                  bitmap->channel_count());
+        }
+
+        if (exceed_unit_range && !m_raw)
+            Log(Warn,
+                "BitmapTexture: texture named \"%s\" contains pixels that "
+                "exceed the [0, 1] range!",
+                m_name);
+
+        if (bitmap->channel_count() == 3 && is_spectral_v<Spectrum> && !m_raw) {
+            for (Bitmap *level : mipmap) {
+                ScalarFloat *ptr_level = (ScalarFloat *) level->data();
+                srgb_model_fetch(ptr_level, ptr_level, level->pixel_count());
+            }
+        }
+
+        ref<BitmapData> data = new BitmapData();
+        data->mean = ScalarFloat(mean / pixel_count);
+
+        if (m_tiled) {
+            std::vector<ref<Bitmap>> levels = { bitmap };
+            levels.insert(levels.end(), mipmap.begin(), mipmap.end());
+            data->tiles = new TiledImage(levels);
+            return data;
+        }
+
+        /* Large textures are swizzled by default in scalar variants. JIT
+           variants keep hardware/Dr.Jit textures and differentiable data */
+        bool swizzled = m_layout == TexelLayout::Swizzled ||
+                        (m_layout == TexelLayout::Auto &&
+                         (is_block_compressed(m_precision) ||
+                          (!dr::is_jit_v<Float> &&
+                           bitmap->pixel_count() >= SwizzleThreshold)));
+
+        if (m_precision != StoragePrecision::Float || swizzled) {
+            if ((m_precision == StoragePrecision::UNorm8SRGB ||
+                 m_precision == StoragePrecision::BC4SRGB) &&
+                bitmap->channel_count() == 3 && is_spectral_v<Spectrum> && !m_raw)
+                Throw("The \"%s\" storage precision cannot be used for "
+                      "spectral upsampling coefficients (set raw=true)!",
+                      m_precision);
+
+            std::vector<ref<Bitmap>> levels = { bitmap };
+            levels.insert(levels.end(), mipmap.begin(), mipmap.end());
+            for (const Bitmap *level : levels) {
+                uint32_t channels = (uint32_t) level->channel_count();
+                ScalarVector2i res(level->size());
+                const ScalarFloat *values = (const ScalarFloat *) level->data();
+                size_t count = level->pixel_count();
+
+                std::vector<ScalarFloat> swizzled_values;
+                if (swizzled) {
+                    swizzled_values = swizzle_texels(values, res, channels);
+                    values = swizzled_values.data();
+                    count = swizzled_values.size() / channels;
+                }
+
+                data->packed.push_back(std::make_shared<PackedStorage<Float>>(
+                    values, count, channels, m_precision));
+                data->packed_res.push_back(res);
+            }
+            data->swizzled = swizzled;
+            return data;
+        }
+
+        data->bitmap = bitmap;
+        data->mipmap = bitmap_to_tensors(mipmap);
+
+        size_t channels = bitmap->channel_count();
+        ScalarVector2i res = ScalarVector2i(bitmap->size());
+        size_t shape[3] = { (size_t) res.y(), (size_t) res.x(), channels };
+        data->tensor = TensorXf(bitmap->data(), 3, shape);
+        return data;
+    }
+
 protected:
     Texture2f m_texture;
+    /// Coarser MIP map levels (only with <tt>filter_type=mipmap</tt>)
+    std::vector<Texture2f> m_mipmap;
+    bool m_filter_mipmap;
+    /// Paged texture data (only with <tt>tiled=true</tt>)
+    ref<TiledImage> m_tiles;
+    bool m_tiled;
+    /// Texels of all levels with reduced precision or swizzled layout
+    std::vector<std::shared_ptr<const PackedStorage<Float>>> m_packed;
+    std::vector<ScalarVector2i> m_packed_res;
+    StoragePrecision m_precision;
+    TexelLayout m_layout;
+    /// Are the texels of \c m_packed in the swizzled layout?
+    bool m_swizzled = false;
     ScalarTransform3f m_transform;
     bool m_accel;
     bool m_raw;
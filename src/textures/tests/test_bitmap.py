@@ -230,3 +230,266 @@ def test05_eval_spectral(variants_vec_backends_once_spectral):
     expected = 0.5394
     assert dr.allclose(expected, spec, atol=1e-04)
     assert dr.allclose(expected, mono, atol=1e-04)
+
+
+@fresolver_append_path
+def test06_asset_cache(variants_all_rgb):
+    # Instances loading the same file share the converted texture data
+    def load(**kwargs):
+        return mi.load_dict({
+            "type" : "bitmap",
+            "filename" : "resources/data/common/textures/carrot.png",
+            **kwargs
+        })
+
+    mi.AssetCache.clear()
+    bitmap_1 = load(wrap_mode="repeat")
+    bitmap_2 = load(wrap_mode="clamp", filter_type="nearest")
+    assert mi.AssetCache.size() == 1
+
+    data_1 = mi.traverse(bitmap_1)['data']
+    data_2 = mi.traverse(bitmap_2)['data']
+    assert dr.all(data_1.array == data_2.array)
+    assert dr.allclose(bitmap_1.mean(), bitmap_2.mean())
+
+    # Different conversion parameters use a different entry
+    bitmap_3 = load(raw=True)
+    assert mi.AssetCache.size() == 2
+
+    mi.AssetCache.set_enabled(False)
+    bitmap_4 = load()
+    assert mi.AssetCache.size() == 0
+    assert dr.all(mi.traverse(bitmap_4)['data'].array == data_1.array)
+    mi.AssetCache.set_enabled(True)
+
+
+@pytest.mark.parametrize('wrap_mode', ['repeat', 'clamp'])
+def test07_mipmap(variants_all_rgb, wrap_mode):
+    import numpy as np
+
+    # 16x16 checkerboard of alternating black and white texels
+    data = np.indices((16, 16)).sum(axis=0) % 2
+    bitmap = mi.Bitmap(data.astype(np.float32)[..., None])
+
+    def load(filter_type):
+        return mi.load_dict({
+            "type" : "bitmap",
+            "bitmap" : bitmap,
+            "raw" : True,
+            "filter_type" : filter_type,
+            "wrap_mode" : wrap_mode
+        })
+
+    mipmap = load("mipmap")
+    bilinear = load("bilinear")
+    assert mipmap.needs_differentials()
+    assert not bilinear.needs_differentials()
+
+    si = dr.zeros(mi.SurfaceInteraction3f)
+    si.uv = mi.Point2f(0.3, 0.7)
+
+    # Without UV partials, lookups use the full resolution
+    assert dr.allclose(mipmap.eval_1(si), bilinear.eval_1(si))
+
+    # A sub-texel footprint also selects the full resolution
+    si.duv_dx = mi.Vector2f(0.25 / 16, 0)
+    si.duv_dy = mi.Vector2f(0, 0.25 / 16)
+    assert dr.allclose(mipmap.eval_1(si), bilinear.eval_1(si))
+
+    # A footprint covering the whole texture returns the average value
+    si.duv_dx = mi.Vector2f(1, 0)
+    si.duv_dy = mi.Vector2f(0, 1)
+    assert dr.allclose(mipmap.eval_1(si), 0.5, atol=1e-5)
+
+    # Two texels: the first coarser level has the same average everywhere
+    si.duv_dx = mi.Vector2f(2 / 16, 0)
+    si.duv_dy = mi.Vector2f(0, 2 / 16)
+    assert dr.allclose(mipmap.eval_1(si), 0.5, atol=1e-5)
+
+    # BSDFs request UV partials for such textures
+    bsdf = mi.load_dict({"type" : "diffuse", "reflectance" : mipmap})
+    assert dr.all(bsdf.needs_differentials())
+
+
+@fresolver_append_path
+@pytest.mark.parametrize('filter_type', ['nearest', 'bilinear', 'mipmap'])
+@pytest.mark.parametrize('wrap_mode', ['repeat', 'clamp', 'mirror'])
+def test08_tiled(variant_scalar_rgb, np_rng, filter_type, wrap_mode):
+    # Tiled textures return the same values as resident ones
+    def load(**kwargs):
+        return mi.load_dict({
+            "type" : "bitmap",
+            "filename" : "resources/data/common/textures/carrot.png",
+            "filter_type" : filter_type,
+            "wrap_mode" : wrap_mode,
+            **kwargs
+        })
+
+    resident, tiled = load(), load(tiled=True)
+    assert 'data' not in mi.traverse(tiled)
+    assert dr.all(tiled.resolution() == resident.resolution())
+    assert dr.allclose(tiled.mean(), resident.mean())
+
+    si = mi.SurfaceInteraction3f()
+    for uv in np_rng.random((20, 2)) * 3 - 1:
+        si.uv = mi.Point2f(uv)
+        si.duv_dx = mi.Vector2f(uv[0] * 0.1, 0)
+        si.duv_dy = mi.Vector2f(0, uv[1] * 0.1)
+        assert dr.allclose(tiled.eval(si), resident.eval(si), atol=1e-5)
+        assert dr.allclose(tiled.eval_1_grad(si), resident.eval_1_grad(si),
+                           rtol=1e-4, atol=1e-4)
+
+    with pytest.raises(RuntimeError, match='importance sampled'):
+        tiled.sample_position(mi.Point2f(0.5))
+
+
+def test09_tiled_jit(variants_vec_rgb):
+    import numpy as np
+
+    with pytest.raises(RuntimeError, match='scalar variants'):
+        mi.load_dict({
+            "type" : "bitmap",
+            "bitmap" : mi.Bitmap(np.zeros((4, 4, 1), dtype=np.float32)),
+            "tiled" : True
+        })
+
+
+@pytest.mark.parametrize('storage, atol', [('half', 2e-3), ('unorm8', 5e-3),
+                                           ('unorm8_srgb', 5e-3)])
+@pytest.mark.parametrize('filter_type', ['bilinear', 'nearest', 'mipmap'])
+def test10_storage(variants_all_rgb, np_rng, storage, atol, filter_type):
+    # Textures with reduced precision closely match full precision ones
+    def load(**kwargs):
+        return mi.load_dict({
+            "type" : "bitmap",
+            "filename" : "resources/data/common/textures/carrot.png",
+            "filter_type" : filter_type,
+            "wrap_mode" : "mirror",
+            **kwargs
+        })
+
+    full, packed = load(), load(storage=storage)
+    assert 'data' not in mi.traverse(packed)
+    assert dr.all(packed.resolution() == full.resolution())
+    assert f'storage = {storage}' in str(packed)
+
+    si = mi.SurfaceInteraction3f()
+    for uv in np_rng.random((20, 2)) * 3 - 1:
+        si.uv = mi.Point2f(uv)
+        si.duv_dx = mi.Vector2f(uv[0] * 0.1, 0)
+        si.duv_dy = mi.Vector2f(0, uv[1] * 0.1)
+        assert dr.allclose(packed.eval(si), full.eval(si), atol=atol)
+
+    # Importance sampling uses the decoded texels
+    assert dr.allclose(packed.pdf_position(mi.Point2f(0.3, 0.6)),
+                       full.pdf_position(mi.Point2f(0.3, 0.6)), rtol=2e-2)
+
+    with pytest.raises(RuntimeError, match='cannot be combined'):
+        load(storage=storage, tiled=True)
+
+
+@pytest.mark.parametrize('storage', ['float', 'half'])
+@pytest.mark.parametrize('filter_type', ['bilinear', 'nearest', 'mipmap'])
+@pytest.mark.parametrize('wrap_mode', ['repeat', 'clamp', 'mirror'])
+def test11_swizzled_layout(variants_all_rgb, np_rng, storage, filter_type, wrap_mode):
+    import numpy as np
+
+    # The swizzled layout returns the same values as the scanline layout
+    def load(**kwargs):
+        return mi.load_dict({
+            "type" : "bitmap",
+            # Partial tiles along both edges
+            "bitmap" : mi.Bitmap(np_rng.random((21, 37, 3), dtype=np.float32)),
+            "filter_type" : filter_type,
+            "wrap_mode" : wrap_mode,
+            "storage" : storage,
+            **kwargs
+        })
+
+    scanline, swizzled = load(layout="scanline"), load(layout="swizzled")
+    assert 'data' not in mi.traverse(swizzled)
+    assert 'layout = swizzled' in str(swizzled)
+    assert dr.all(swizzled.resolution() == [37, 21])
+    assert dr.allclose(swizzled.mean(), scanline.mean())
+
+    si = mi.SurfaceInteraction3f()
+    for uv in np_rng.random((20, 2)) * 3 - 1:
+        si.uv = mi.Point2f(uv)
+        si.duv_dx = mi.Vector2f(uv[0] * 0.1, 0)
+        si.duv_dy = mi.Vector2f(0, uv[1] * 0.1)
+        assert dr.allclose(swizzled.eval(si), scanline.eval(si), atol=1e-5)
+
+    # Importance sampling uses the texels in scanline order
+    assert dr.allclose(swizzled.pdf_position(mi.Point2f(0.3, 0.6)),
+                       scanline.pdf_position(mi.Point2f(0.3, 0.6)))
+
+    # Small textures use the scanline layout by default
+    if storage == 'float':
+        assert 'data' in mi.traverse(load())
+
+    with pytest.raises(RuntimeError, match='Invalid texel layout'):
+        load(layout="zorder")
+
+
+@fresolver_append_path
+def test12_shared_assets(variants_all_rgb, tmp_path):
+    # Processes on the same node share decoded bitmaps through a directory
+    def load(**kwargs):
+        return mi.load_dict({
+            "type" : "bitmap",
+            "filename" : "resources/data/common/textures/carrot.png",
+            **kwargs
+        })
+
+    mi.AssetCache.clear()
+    ref = mi.traverse(load())['data']
+
+    mi.AssetCache.set_shared_directory(str(tmp_path))
+    try:
+        mi.AssetCache.clear()
+        first = load()
+        assert len(list(tmp_path.glob('*.asset'))) == 1
+
+        # The next "process" maps the entry instead of decoding the file
+        mi.AssetCache.clear()
+        second = load()
+        assert len(list(tmp_path.glob('*.asset'))) == 1
+        assert not list(tmp_path.glob('*.tmp'))
+        for bitmap in [first, second]:
+            assert dr.allclose(mi.traverse(bitmap)['data'], ref)
+
+        # Other conversion parameters are stored separately
+        load(raw=True)
+        assert len(list(tmp_path.glob('*.asset'))) == 2
+    finally:
+        mi.AssetCache.set_shared_directory('')
+        mi.AssetCache.clear()
+
+
+@pytest.mark.parametrize('storage', ['bc4', 'bc4_srgb'])
+def test13_block_compression(variants_all_rgb, np_rng, storage):
+    # Smooth LDR data is reproduced up to the interpolation between endpoints
+    x, y = np.meshgrid(np.linspace(0, 1, 37), np.linspace(0, 1, 21))
+    data = np.stack([x, y, 0.5 * (x + y) ** 2 / 2], axis=-1).astype(np.float32)
+
+    def load(**kwargs):
+        return mi.load_dict({
+            "type" : "bitmap",
+            "bitmap" : mi.Bitmap(data),
+            "raw" : True,
+            **kwargs
+        })
+
+    full, packed = load(), load(storage=storage)
+    assert 'data' not in mi.traverse(packed)
+    assert dr.all(packed.resolution() == full.resolution())
+    assert f'storage = {storage}' in str(packed)
+
+    si = mi.SurfaceInteraction3f()
+    for uv in np_rng.random((20, 2)):
+        si.uv = mi.Point2f(uv)
+        assert dr.allclose(packed.eval(si), full.eval(si), atol=2e-2)
+
+    # Block-compressed textures require the swizzled layout
+    with pytest.raises(RuntimeError, match='swizzled'):
+        load(storage=storage, layout='scanline')
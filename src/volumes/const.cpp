@@ -83,6 +83,10 @@ public:
 
     ScalarFloat max() const override { return m_value->max(); }
 
+    bool is_spectrally_varying() const override {
+        return m_value->is_spectrally_varying();
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "ConstVolume[" << std::endl
@@ -1,13 +1,16 @@
+#include <mitsuba/core/assetcache.h>
 #include <mitsuba/core/fresolver.h>
 #include <mitsuba/core/properties.h>
 #include <mitsuba/core/spectrum.h>
 #include <mitsuba/core/string.h>
 #include <mitsuba/core/transform.h>
+#include <mitsuba/render/packedstorage.h>
 #include <mitsuba/render/srgb.h>
 #include <mitsuba/render/volume.h>
 #include <mitsuba/render/volumegrid.h>
 #include <drjit/dynamic.h>
 #include <drjit/texture.h>
+#include <nanothread/nanothread.h>
 
 NAMESPACE_BEGIN(mitsuba)
 
@@ -19,7 +22,7 @@ Grid-based volume data source (:monosp:`gridvolume`)
 ----------------------------------------------------
 
 .. pluginparameters::
- :extra-rows: 6
+ :extra-rows: 7
 
  * - filename
    - |string|
@@ -69,15 +72,38 @@ Grid-based volume data source (:monosp:`gridvolume`)
      cause small differences as hardware interpolation methods typically have a
      loss of precision (not exactly 32-bit arithmetic). (Default: true)
 
+ * - storage
+   - |string|
+   - Precision of the stored voxel values. The following options are
+     currently available:
+
+     - ``float`` (default): full precision, in a Dr.Jit texture.
+
+     - ``half``: half precision floating point values.
+
+     - ``unorm8``: 8 bit values mapped linearly to the range of every channel.
+
+     - ``unorm8_srgb``: 8 bit sRGB-encoded values in :math:`[0, 1]`, which
+       are converted to linear values when they are looked up.
+
  * - data
    - |tensor|
-   - Tensor array containing the grid data.
+   - Tensor array containing the grid data (not available with reduced
+     :paramtype:`storage` precision).
    - |exposed|, |differentiable|
 
 This class implements access to volume data stored on a 3D grid using a
 simple binary exchange format (compatible with Mitsuba 0.6). When appropriate,
 spectral upsampling is applied at loading time to convert RGB values to
 spectra that can be used in the renderer.
+
+With a reduced :paramtype:`storage` precision, the voxels are packed into
+two (``half``) or four (``unorm8*``) values per 32 bit word, which halves or
+quarters the memory used by the volume and the bandwidth of every lookup.
+The values are decoded and interpolated in software in this case, so the
+:paramtype:`accel` parameter has no effect, and the volume data is not
+exposed as a differentiable parameter.
+
 We provide a small `helper utility <https://github.com/mitsuba-renderer/mitsuba2-vdb-converter>`_
 to convert OpenVDB files to this format. The format uses a
 little endian encoding and is specified as follows:
@@ -175,6 +201,15 @@ public:
                   "\"mirror\", or \"clamp\"!",
                   wrap_mode_st);
 
+        m_raw = props.get<bool>("raw", false);
+
+        m_accel = props.get<bool>("accel", true);
+        m_precision = storage_precision(props.string("storage", "float"));
+        if (is_block_compressed(m_precision))
+            Throw("The \"%s\" storage precision is only supported by bitmap "
+                  "textures!", m_precision);
+
+        ref<GridData> data;
         if (props.has_property("grid")) {
             // Creates a Bitmap texture directly from an existing Bitmap object
             if (props.has_property("filename"))
@@ -185,72 +220,48 @@ public:
             VolumeGrid *volume_grid = dynamic_cast<VolumeGrid *>(other.get());
             if (!volume_grid)
                 Throw("Property \"grid\" must be a VolumeGrid instance.");
-            m_volume_grid = volume_grid;
+            data = convert_grid(volume_grid);
         } else {
             FileResolver *fs = Thread::thread()->file_resolver();
             fs::path file_path = fs->resolve(props.string("filename"));
             if (!fs::exists(file_path))
                 Log(Error, "\"%s\": file does not exist!", file_path);
-            m_volume_grid = new VolumeGrid(file_path);
-        }
-
-        m_raw = props.get<bool>("raw", false);
-
-        m_accel = props.get<bool>("accel", true);
 
-        ScalarVector3i res = m_volume_grid->size();
-        ScalarUInt32 size = dr::prod(res);
-
-        // Apply spectral conversion if necessary
-        if (is_spectral_v<Spectrum> && m_volume_grid->channel_count() == 3 &&
-            !m_raw) {
-            ScalarFloat *ptr = m_volume_grid->data();
-
-            auto scaled_data =
-                std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size * 4]);
-            ScalarFloat *scaled_data_ptr = scaled_data.get();
-            ScalarFloat max = 0.0;
-            for (ScalarUInt32 i = 0; i < size; ++i) {
-                ScalarColor3f rgb = dr::load<ScalarColor3f>(ptr);
-                // TODO: Make this scaling optional if the RGB values are
-                // between 0 and 1
-                ScalarFloat scale = dr::max(rgb) * 2.f;
-                ScalarColor3f rgb_norm =
-                    rgb / dr::maximum((ScalarFloat) 1e-8, scale);
-                ScalarVector3f coeff = srgb_model_fetch(rgb_norm);
-                max = dr::maximum(max, scale);
-                dr::store(scaled_data_ptr,
-                          dr::concat(coeff, dr::Array<ScalarFloat, 1>(scale)));
-                ptr += 3;
-                scaled_data_ptr += 4;
-            }
-            m_max = (float) max;
+            /* Share the converted data with other instances that load the
+               same file in the same way */
+            std::string key = tfm::format(
+                "gridvolume:%s:%i:%s", detail::get_variant<Float, Spectrum>(),
+                (int) m_raw, m_precision);
+            data = (GridData *) AssetCache::get(file_path, key, [&]() {
+                /* The grid is released once its voxels were copied into the
+                   tensor, so that only one copy stays resident */
+                ref<VolumeGrid> grid = new VolumeGrid(file_path);
+                return ref<Object>(convert_grid(grid));
+            }).get();
+        }
 
-            size_t shape[4] = {
-                (size_t) res.z(),
-                (size_t) res.y(),
-                (size_t) res.x(),
-                4
-            };
-            m_texture = Texture3f(TensorXf(scaled_data.get(), 4, shape),
-                                  m_accel, m_accel, filter_mode, wrap_mode);
+        if (data->packed) {
+            /* The texture only provides the filter configuration and number
+               of channels, the voxels are fetched from the packed storage */
+            m_packed = data->packed;
+            m_packed_res = data->packed_res;
+            size_t channels = m_packed->channels();
+            std::vector<ScalarFloat> placeholder(channels, 0.f);
+            size_t shape[4] = { 1, 1, 1, channels };
+            m_texture = Texture3f(TensorXf(placeholder.data(), 4, shape),
+                                  false, false, filter_mode, wrap_mode);
         } else {
-            size_t shape[4] = {
-                (size_t) res.z(),
-                (size_t) res.y(),
-                (size_t) res.x(),
-                m_volume_grid->channel_count()
-            };
-            m_texture = Texture3f(TensorXf(m_volume_grid->data(), 4, shape),
-                                  m_accel, m_accel, filter_mode, wrap_mode);
-            m_max = m_volume_grid->max();
-            m_max_per_channel.resize(m_volume_grid->channel_count());
-            m_volume_grid->max_per_channel(m_max_per_channel.data());
-            m_channel_count = (uint32_t) m_volume_grid->channel_count();
+            m_texture = Texture3f(data->tensor, m_accel, m_accel, filter_mode,
+                                  wrap_mode);
+        }
+        m_max = data->max;
+        if (!data->spectral) {
+            m_max_per_channel = data->max_per_channel;
+            m_channel_count = data->channel_count;
         }
 
         if (props.get<bool>("use_grid_bbox", false)) {
-            m_to_local = m_volume_grid->bbox_transform() * m_to_local;
+            m_to_local = data->bbox_transform * m_to_local;
             update_bbox();
         }
 
@@ -261,12 +272,13 @@ public:
     }
 
     void traverse(TraversalCallback *callback) override {
-        callback->put_parameter("data", m_texture.tensor(), +ParamFlags::Differentiable);
+        if (!m_packed)
+            callback->put_parameter("data", m_texture.tensor(), +ParamFlags::Differentiable);
         Base::traverse(callback);
     }
 
     void parameters_changed(const std::vector<std::string> &keys) override {
-        if (keys.empty() || string::contains(keys, "data")) {
+        if (!m_packed && (keys.empty() || string::contains(keys, "data"))) {
             const size_t channels = nchannels();
             if (channels != 1 && channels != 3 && channels != 6)
                 Throw("parameters_changed(): The volume data %s was changed "
@@ -388,11 +400,101 @@ public:
             out[i] = m_max_per_channel[i];
     }
 
+    bool is_spectrally_varying() const override { return nchannels() != 1; }
+
     ScalarVector3i resolution() const override {
+        if (m_packed)
+            return m_packed_res;
         const size_t *shape = m_texture.shape();
         return { (int) shape[2], (int) shape[1], (int) shape[0] };
     };
 
+    size_t memory_footprint() const override {
+        const size_t *shape = m_texture.shape();
+        size_t result = shape[0] * shape[1] * shape[2] * shape[3] *
+                        sizeof(ScalarFloat);
+        if (m_packed)
+            result += m_packed->nbytes();
+        return result;
+    }
+
+    std::vector<ScalarFloat> max_grid(const ScalarVector3u &res) const override {
+        auto &&data = dr::migrate(m_texture.value(), AllocType::Host);
+        if constexpr (dr::is_jit_v<Float>)
+            dr::sync_thread();
+        std::vector<ScalarFloat> decoded;
+        if (m_packed)
+            decoded = m_packed->decode();
+        const ScalarFloat *ptr = m_packed ? decoded.data() : data.data();
+
+        // Number of stored channels (including the spectral scale factor)
+        const size_t channels = m_texture.shape()[3];
+        ScalarVector3u size(resolution());
+        size_t voxel_count = dr::prod(size);
+
+        /* Spectral volumes store the scale factor of the spectrum in the last
+           channel, all other volumes are bounded by the largest channel */
+        bool spectral = is_spectral_v<Spectrum> && channels == 4 && !m_raw;
+        std::vector<ScalarFloat> values(voxel_count);
+        for (size_t i = 0; i < voxel_count; ++i) {
+            ScalarFloat value = ptr[i * channels + (spectral ? 3 : 0)];
+            if (!spectral)
+                for (size_t c = 1; c < channels; ++c)
+                    value = dr::maximum(value, ptr[i * channels + c]);
+            values[i] = value;
+        }
+
+        /* Range of voxels that contribute to lookups within a cell. Boundary
+           cells cover the complete axis unless the lookups are clamped. */
+        bool clamp = m_texture.wrap_mode() == dr::WrapMode::Clamp;
+        auto voxel_range = [clamp](uint32_t cell, uint32_t cells, uint32_t voxels) {
+            if (!clamp && (cell == 0 || cell == cells - 1))
+                return std::make_pair(0u, voxels - 1);
+            double scale = (double) voxels / (double) cells;
+            int32_t lo = (int32_t) std::floor(cell * scale - 0.5),
+                    hi = (int32_t) std::floor((cell + 1) * scale - 0.5) + 1;
+            return std::make_pair((uint32_t) dr::clamp(lo, 0, (int32_t) voxels - 1),
+                                  (uint32_t) dr::clamp(hi, 0, (int32_t) voxels - 1));
+        };
+
+        // Separable maximum filter, reducing one axis at a time
+        for (uint32_t axis = 0; axis < 3; ++axis) {
+            ScalarVector3u out_size = size;
+            out_size[axis] = res[axis];
+            std::vector<ScalarFloat> out(dr::prod(out_size));
+
+            size_t stride = 1;
+            for (uint32_t i = 0; i < axis; ++i)
+                stride *= size[i];
+
+            dr::parallel_for(
+                dr::blocked_range<uint32_t>(0, out_size.z(), 1),
+                [&](const dr::blocked_range<uint32_t> &range) {
+                    for (uint32_t z = range.begin(); z != range.end(); ++z) {
+                        for (uint32_t y = 0; y < out_size.y(); ++y) {
+                            for (uint32_t x = 0; x < out_size.x(); ++x) {
+                                ScalarVector3u p(x, y, z);
+                                auto [lo, hi] = voxel_range(p[axis], res[axis], size[axis]);
+                                p[axis] = lo;
+                                size_t index = ((size_t) p.z() * size.y() + p.y()) *
+                                                   size.x() + p.x();
+                                ScalarFloat value = 0.f;
+                                for (uint32_t k = lo; k <= hi; ++k, index += stride)
+                                    value = dr::maximum(value, values[index]);
+                                out[((size_t) z * out_size.y() + y) * out_size.x() + x] = value;
+                            }
+                        }
+                    }
+                }
+            );
+
+            values = std::move(out);
+            size = out_size;
+        }
+
+        return values;
+    }
+
     std::string to_string() const override {
         std::ostringstream oss;
         oss << "GridVolume[" << std::endl
@@ -400,7 +502,8 @@ public:
             << "  bbox = " << string::indent(m_bbox) << "," << std::endl
             << "  dimensions = " << resolution() << "," << std::endl
             << "  max = " << m_max << "," << std::endl
-            << "  channels = " << m_texture.shape()[3] << std::endl
+            << "  channels = " << m_texture.shape()[3] << "," << std::endl
+            << "  storage = " << m_precision << std::endl
             << "]";
         return oss.str();
     }
@@ -446,10 +549,7 @@ protected:
             fetch_values[6] = d011.data();
             fetch_values[7] = d111.data();
 
-            if (m_accel)
-                m_texture.eval_fetch(p, fetch_values, active);
-            else
-                m_texture.eval_fetch_nonaccel(p, fetch_values, active);
+            fetch(p, fetch_values, active);
 
             UnpolarizedSpectrum v000, v001, v010, v011, v100, v101, v110, v111;
             v000 = srgb_model_eval<UnpolarizedSpectrum>(dr::head<3>(d000), it.wavelengths);
@@ -490,10 +590,7 @@ protected:
             return result;
         } else {
             dr::Array<Float, 4> v;
-            if (m_accel)
-                m_texture.eval(p, v.data(), active);
-            else
-                m_texture.eval_nonaccel(p, v.data(), active);
+            lookup(p, v.data(), active);
 
             return v.w() * srgb_model_eval<UnpolarizedSpectrum>(dr::head<3>(v), it.wavelengths);
         }
@@ -509,10 +606,7 @@ protected:
 
         Point3f p = m_to_local * it.p;
         Float result;
-        if (m_accel)
-            m_texture.eval(p, &result, active);
-        else
-            m_texture.eval_nonaccel(p, &result, active);
+        lookup(p, &result, active);
 
         return result;
     }
@@ -528,10 +622,7 @@ protected:
 
         Point3f p = m_to_local * it.p;
         Color3f result;
-        if (m_accel)
-            m_texture.eval(p, result.data(), active);
-        else
-            m_texture.eval_nonaccel(p, result.data(), active);
+        lookup(p, result.data(), active);
 
         return result;
     }
@@ -547,10 +638,7 @@ protected:
 
         Point3f p = m_to_local * it.p;
         dr::Array<Float, 6> result;
-        if (m_accel)
-            m_texture.eval(p, result.data(), active);
-        else
-            m_texture.eval_nonaccel(p, result.data(), active);
+        lookup(p, result.data(), active);
 
         return result;
     }
@@ -566,17 +654,208 @@ protected:
         MI_MASK_ARGUMENT(active);
 
         Point3f p = m_to_local * it.p;
-        if (m_accel)
+        lookup(p, out, active);
+    }
+
+    /// Interpolated (or nearest neighbor) lookup of all channels at \c p
+    MI_INLINE void lookup(const Point3f &p, Float *out, Mask active) const {
+        if (m_packed)
+            lookup_packed(p, out, active);
+        else if (m_accel)
             m_texture.eval(p, out, active);
         else
             m_texture.eval_nonaccel(p, out, active);
     }
 
+    /// Fetch the voxels of the trilinear footprint of \c p
+    MI_INLINE void fetch(const Point3f &p, const dr::Array<Float *, 8> &out,
+                         Mask active) const {
+        if (m_packed)
+            fetch_packed(p, out, active);
+        else if (m_accel)
+            m_texture.eval_fetch(p, out, active);
+        else
+            m_texture.eval_fetch_nonaccel(p, out, active);
+    }
+
+    /// Index of the voxel at the given coordinates after applying the wrap mode
+    UInt32 voxel_index(const Vector3i &p) const {
+        Vector3i res(m_packed_res), q;
+        switch (m_texture.wrap_mode()) {
+            case dr::WrapMode::Repeat:
+                q = p % res;
+                q = dr::select(q < 0, q + res, q);
+                break;
+
+            case dr::WrapMode::Mirror: {
+                    Vector3i period = 2 * res;
+                    q = p % period;
+                    q = dr::select(q < 0, q + period, q);
+                    q = dr::select(q < res, q, period - 1 - q);
+                }
+                break;
+
+            default:
+                q = dr::clamp(p, 0, res - 1);
+                break;
+        }
+        return UInt32((q.z() * res.y() + q.y()) * res.x() + q.x());
+    }
+
+    /// Counterpart of \ref fetch() for packed voxel data
+    void fetch_packed(const Point3f &p, const dr::Array<Float *, 8> &out,
+                      Mask active) const {
+        Vector3i p_i = dr::floor2int<Vector3i>(
+            dr::fmadd(p, ScalarVector3f(m_packed_res), -.5f));
+        for (int k = 0; k < 8; ++k)
+            m_packed->fetch(voxel_index(p_i + Vector3i(k & 1, (k >> 1) & 1, k >> 2)),
+                            out[k], active);
+    }
+
+    /// Counterpart of \ref lookup() for packed voxel data
+    void lookup_packed(const Point3f &p, Float *out, Mask active) const {
+        ScalarVector3f res(m_packed_res);
+        if (m_texture.filter_mode() == dr::FilterMode::Nearest) {
+            m_packed->fetch(voxel_index(dr::floor2int<Vector3i>(p * res)), out,
+                            active);
+            return;
+        }
+
+        Point3f p_g = dr::fmadd(p, res, -.5f);
+        Vector3i p_i = dr::floor2int<Vector3i>(p_g);
+        Vector3f w1 = p_g - Point3f(p_i),
+                 w0 = 1.f - w1;
+
+        uint32_t channels = m_packed->channels();
+        std::vector<Float> values(channels);
+        for (uint32_t c = 0; c < channels; ++c)
+            out[c] = 0.f;
+
+        for (int k = 0; k < 8; ++k) {
+            m_packed->fetch(voxel_index(p_i + Vector3i(k & 1, (k >> 1) & 1, k >> 2)),
+                            values.data(), active);
+            Float weight = ((k & 1) ? w1.x() : w0.x()) *
+                           ((k & 2) ? w1.y() : w0.y()) *
+                           ((k & 4) ? w1.z() : w0.z());
+            for (uint32_t c = 0; c < channels; ++c)
+                out[c] = dr::fmadd(weight, values[c], out[c]);
+        }
+    }
+
+    /// Converted volume data that can be shared between several instances
+    struct GridData : Object {
+        TensorXf tensor;
+        /// Voxels with reduced precision (replaces the above)
+        std::shared_ptr<const PackedStorage<Float>> packed;
+        ScalarVector3i packed_res;
+        ScalarTransform4f bbox_transform;
+        uint32_t channel_count;
+        ScalarFloat max;
+        std::vector<ScalarFloat> max_per_channel;
+        bool spectral = false;
+    };
+
+    /// Convert a volume grid into the working representation of the volume
+    ref<GridData> convert_grid(VolumeGrid *grid) const {
+        ref<GridData> data = new GridData();
+        data->bbox_transform = grid->bbox_transform();
+        data->channel_count = (uint32_t) grid->channel_count();
+
+        ScalarVector3i res = grid->size();
+        ScalarUInt32 size = dr::prod(res);
+
+        // Apply spectral conversion if necessary
+        if (is_spectral_v<Spectrum> && grid->channel_count() == 3 &&
+            !m_raw) {
+            ScalarFloat *ptr = grid->data();
+
+            auto scaled_data =
+                std::unique_ptr<ScalarFloat[]>(new ScalarFloat[size * 4]);
+            ScalarFloat *scaled_data_ptr = scaled_data.get();
+            ScalarFloat max = 0.0;
+            for (ScalarUInt32 i = 0; i < size; ++i) {
+                ScalarColor3f rgb = dr::load<ScalarColor3f>(ptr);
+                // TODO: Make this scaling optional if the RGB values are
+                // between 0 and 1
+                ScalarFloat scale = dr::max(rgb) * 2.f;
+                ScalarColor3f rgb_norm =
+                    rgb / dr::maximum((ScalarFloat) 1e-8, scale);
+                ScalarVector3f coeff = srgb_model_fetch(rgb_norm);
+                max = dr::maximum(max, scale);
+                dr::store(scaled_data_ptr,
+                          dr::concat(coeff, dr::Array<ScalarFloat, 1>(scale)));
+                ptr += 3;
+                scaled_data_ptr += 4;
+            }
+            data->max = (float) max;
+            data->spectral = true;
+
+            size_t shape[4] = {
+                (size_t) res.z(),
+                (size_t) res.y(),
+                (size_t) res.x(),
+                4
+            };
+            store(data, scaled_data.get(), shape);
+        } else {
+            size_t shape[4] = {
+                (size_t) res.z(),
+                (size_t) res.y(),
+                (size_t) res.x(),
+                grid->channel_count()
+            };
+            store(data, grid->data(), shape);
+            data->max = grid->max();
+            data->max_per_channel.resize(grid->channel_count());
+            grid->max_per_channel(data->max_per_channel.data());
+        }
+
+        if (data->packed) {
+            // Bound the decoded values, which can slightly exceed the originals
+            std::vector<ScalarFloat> values = data->packed->decode();
+            uint32_t channels = data->packed->channels();
+            data->max = data->spectral ? 0.f : -dr::Infinity<ScalarFloat>;
+            if (!data->spectral)
+                data->max_per_channel.assign(channels, -dr::Infinity<ScalarFloat>);
+            for (size_t i = 0; i < values.size(); ++i) {
+                uint32_t c = (uint32_t) (i % channels);
+                if (data->spectral) {
+                    if (c == 3)
+                        data->max = dr::maximum(data->max, values[i]);
+                } else {
+                    data->max = dr::maximum(data->max, values[i]);
+                    data->max_per_channel[c] =
+                        dr::maximum(data->max_per_channel[c], values[i]);
+                }
+            }
+        }
+
+        return data;
+    }
+
+    /// Store converted voxels in a tensor or with reduced precision
+    void store(GridData *data, const ScalarFloat *values,
+               const size_t shape[4]) const {
+        if (m_precision == StoragePrecision::Float) {
+            data->tensor = TensorXf(values, 4, shape);
+            return;
+        }
+
+        data->packed = std::make_shared<PackedStorage<Float>>(
+            values, shape[0] * shape[1] * shape[2], (uint32_t) shape[3],
+            m_precision);
+        data->packed_res = ScalarVector3i((int) shape[2], (int) shape[1],
+                                          (int) shape[0]);
+    }
+
 protected:
     Texture3f m_texture;
     bool m_accel;
     bool m_raw;
-    ref<VolumeGrid> m_volume_grid;
+    StoragePrecision m_precision;
+    /// Voxels with reduced precision (only with <tt>storage != float</tt>)
+    std::shared_ptr<const PackedStorage<Float>> m_packed;
+    ScalarVector3i m_packed_res;
     bool m_fixed_max = false;
     ScalarFloat m_max;
     std::vector<ScalarFloat> m_max_per_channel;
@@ -0,0 +1,803 @@
+#include <mitsuba/core/assetcache.h>
+#include <mitsuba/core/fresolver.h>
+#include <mitsuba/core/fstream.h>
+#include <mitsuba/core/math.h>
+#include <mitsuba/core/properties.h>
+#include <mitsuba/core/spectrum.h>
+#include <mitsuba/core/string.h>
+#include <mitsuba/core/transform.h>
+#include <mitsuba/core/util.h>
+#include <mitsuba/render/srgb.h>
+#include <mitsuba/render/volume.h>
+#include <mitsuba/render/volumegrid.h>
+#include <drjit/dynamic.h>
+#include <drjit/texture.h>
+#include <nanothread/nanothread.h>
+#include <cstring>
+
+NAMESPACE_BEGIN(mitsuba)
+
+/**!
+.. _volume-sparsegridvolume:
+
+Sparse grid-based volume data source (:monosp:`sparsegridvolume`)
+-----------------------------------------------------------------
+
+.. pluginparameters::
+ :extra-rows: 4
+
+ * - filename
+   - |string|
+   - Filename of the volume to be loaded (in the format of the
+     :ref:`gridvolume <volume-gridvolume>` plugin)
+
+ * - grid
+   - :monosp:`VolumeGrid object`
+   - When creating a sparse grid volume at runtime, e.g. from Python or C++,
+     an existing ``VolumeGrid`` instance can be passed directly rather than
+     loading it from the filesystem with :paramtype:`filename`.
+
+ * - brick_size
+   - |int|
+   - Width, height and depth of the bricks in voxels. Must be a power of two
+     between 2 and 32. (Default: 8)
+
+ * - threshold
+   - |float|
+   - Bricks in which the absolute value of every voxel is less than or equal
+     to this threshold are not stored and evaluate to zero. (Default: 0)
+
+ * - filter_type
+   - |string|
+   - Specifies how voxel values are interpolated. The following options are
+     currently available:
+
+     - ``trilinear`` (default): perform trilinear interpolation.
+
+     - ``nearest``: disable interpolation. In this mode, the plugin
+       performs nearest neighbor lookups of volume values.
+
+ * - wrap_mode
+   - |string|
+   - Controls the behavior of volume evaluations that fall outside of the
+     :math:`[0, 1]` range. The following options are currently available:
+
+     - ``clamp`` (default): clamp coordinates to the edge of the volume.
+
+     - ``repeat``: tile the volume infinitely.
+
+     - ``mirror``: mirror the volume along its boundaries.
+
+ * - raw
+   - |bool|
+   - Should the transformation to the stored color data (e.g. sRGB to linear,
+     spectral upsampling) be disabled? (Default: false)
+
+ * - use_grid_bbox
+   - |bool|
+   - Apply the bounding box stored in the volume file or grid to the volume
+     coordinates. (Default: false)
+
+ * - to_world
+   - |transform|
+   - Specifies an optional 4x4 transformation matrix that will be applied to volume coordinates.
+
+ * - data
+   - |float|
+   - Values of the voxels of all non-empty bricks.
+   - |exposed|, |differentiable|
+
+This plugin is a drop-in replacement of the :ref:`gridvolume <volume-gridvolume>`
+plugin for volumes that are mostly empty, e.g. smoke and clouds. It divides
+the voxel grid into cubic bricks and only stores the bricks that contain
+non-zero values, following the leaf node layout of NanoVDB. A dense table with
+one entry per brick maps the brick coordinates to the position of the brick
+in the voxel storage. Lookups fetch the voxels of a trilinear footprint
+through this table, and voxels of missing bricks evaluate to zero.
+
+Volume files are converted one slab of bricks at a time, so the dense volume
+is never resident in memory. The maximum of every brick is kept and used to
+construct the spatially varying majorants of the :ref:`heterogeneous
+<medium-heterogeneous>` medium, which skips empty regions quickly.
+
+.. tabs::
+    .. code-tab:: xml
+
+        <medium type="heterogeneous">
+            <volume type="sparsegridvolume" name="sigma_t">
+                <string name="filename" value="smoke.vol"/>
+            </volume>
+        </medium>
+
+    .. code-tab:: python
+
+        'type': 'heterogeneous',
+        'sigma_t': {
+            'type': 'sparsegridvolume',
+            'filename': 'smoke.vol'
+        }
+
+*/
+
+template <typename Float, typename Spectrum>
+class SparseGridVolume final : public Volume<Float, Spectrum> {
+public:
+    MI_IMPORT_BASE(Volume, update_bbox, m_to_local, m_bbox, m_channel_count)
+    MI_IMPORT_TYPES(VolumeGrid)
+
+    using FloatStorage = DynamicBuffer<Float>;
+
+    SparseGridVolume(const Properties &props) : Base(props) {
+        std::string filter_type_str = props.string("filter_type", "trilinear");
+        if (filter_type_str == "nearest")
+            m_filter_mode = dr::FilterMode::Nearest;
+        else if (filter_type_str == "trilinear")
+            m_filter_mode = dr::FilterMode::Linear;
+        else
+            Throw("Invalid filter type \"%s\", must be one of: \"nearest\" or "
+                  "\"trilinear\"!", filter_type_str);
+
+        std::string wrap_mode_st = props.string("wrap_mode", "clamp");
+        if (wrap_mode_st == "repeat")
+            m_wrap_mode = dr::WrapMode::Repeat;
+        else if (wrap_mode_st == "mirror")
+            m_wrap_mode = dr::WrapMode::Mirror;
+        else if (wrap_mode_st == "clamp")
+            m_wrap_mode = dr::WrapMode::Clamp;
+        else
+            Throw("Invalid wrap mode \"%s\", must be one of: \"repeat\", "
+                  "\"mirror\", or \"clamp\"!",
+                  wrap_mode_st);
+
+        m_raw = props.get<bool>("raw", false);
+
+        uint32_t brick_size = props.get<uint32_t>("brick_size", 8);
+        if (brick_size < 2 || brick_size > 32 || !math::is_power_of_two(brick_size))
+            Throw("The brick size must be a power of two between 2 and 32 "
+                  "(got %u)!", brick_size);
+        ScalarFloat threshold = props.get<ScalarFloat>("threshold", 0.f);
+
+        ref<SparseData> data;
+        if (props.has_property("grid")) {
+            if (props.has_property("filename"))
+                Throw("Cannot specify both \"grid\" and \"filename\".");
+            ref<Object> other = props.object("grid");
+            VolumeGrid *volume_grid = dynamic_cast<VolumeGrid *>(other.get());
+            if (!volume_grid)
+                Throw("Property \"grid\" must be a VolumeGrid instance.");
+            data = convert_grid(volume_grid, brick_size, threshold);
+        } else {
+            FileResolver *fs = Thread::thread()->file_resolver();
+            fs::path file_path = fs->resolve(props.string("filename"));
+            if (!fs::exists(file_path))
+                Log(Error, "\"%s\": file does not exist!", file_path);
+
+            std::string key = tfm::format(
+                "sparsegridvolume:%s:%i:%u:%f", detail::get_variant<Float, Spectrum>(),
+                (int) m_raw, brick_size, threshold);
+            data = (SparseData *) AssetCache::get(file_path, key, [&]() {
+                return ref<Object>(convert_file(file_path, brick_size, threshold));
+            }).get();
+        }
+
+        m_size             = data->size;
+        m_brick_res        = data->brick_res;
+        m_brick_shift      = dr::log2i(brick_size);
+        m_storage_channels = data->storage_channels;
+        m_channel_count    = data->spectral ? 3 : data->storage_channels;
+        m_brick_index      = data->brick_index;
+        m_brick_slots      = data->brick_slots;
+        m_data             = data->data;
+        m_brick_max        = data->brick_max;
+        m_max              = data->max;
+        m_max_per_channel  = data->max_per_channel;
+
+        if (props.get<bool>("use_grid_bbox", false)) {
+            m_to_local = data->bbox_transform * m_to_local;
+            update_bbox();
+        }
+
+        if (props.has_property("max_value")) {
+            m_fixed_max = true;
+            m_max = props.get<ScalarFloat>("max_value");
+        }
+    }
+
+    void traverse(TraversalCallback *callback) override {
+        callback->put_parameter("data", m_data, +ParamFlags::Differentiable);
+        Base::traverse(callback);
+    }
+
+    void parameters_changed(const std::vector<std::string> &keys) override {
+        if (keys.empty() || string::contains(keys, "data")) {
+            size_t brick_values = brick_voxel_count() * m_storage_channels;
+            if (m_data.size() != m_brick_max.size() * brick_values)
+                Throw("parameters_changed(): The size of the voxel data of %s "
+                      "must not change!", to_string());
+
+            auto &&data = dr::migrate(dr::detach(m_data), AllocType::Host);
+            if constexpr (dr::is_jit_v<Float>)
+                dr::sync_thread();
+
+            ScalarFloat max;
+            compute_maxima(data.data(), m_brick_max.size(), brick_voxel_count(),
+                           m_storage_channels, is_spectral(), m_brick_max, max,
+                           m_max_per_channel);
+            if (m_brick_max.size() < m_brick_slots.size())
+                pad_maxima(max, m_max_per_channel);
+            if (!m_fixed_max)
+                m_max = max;
+        }
+    }
+
+    UnpolarizedSpectrum eval(const Interaction3f &it,
+                             Mask active) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        if (m_channel_count == 3 && is_spectral_v<Spectrum> && m_raw)
+            Throw("The SparseGridVolume texture %s was queried for a spectrum, "
+                  "but texture conversion into spectra was explicitly "
+                  "disabled! (raw=true)",
+                  to_string());
+        else if (m_channel_count != 3 && m_channel_count != 1)
+            Throw("The SparseGridVolume texture %s was queried for a spectrum, "
+                  "but has a number of channels which is not 1 or 3",
+                  to_string());
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<UnpolarizedSpectrum>();
+
+        if (m_channel_count == 1)
+            return interpolate<1>(it, active)[0];
+
+        if constexpr (is_spectral_v<Spectrum>)
+            return interpolate_spectral(it, active);
+        else if constexpr (is_monochromatic_v<Spectrum>)
+            return luminance(Color3f(interpolate<3>(it, active)));
+        else
+            return UnpolarizedSpectrum(interpolate<3>(it, active));
+    }
+
+    Float eval_1(const Interaction3f &it, Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        if (is_spectral())
+            Throw("eval_1(): The SparseGridVolume texture %s was queried for "
+                  "a scalar value, but texture conversion into spectra was "
+                  "requested! (raw=false)",
+                  to_string());
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<Float>();
+
+        if (m_channel_count == 1)
+            return interpolate<1>(it, active)[0];
+        else if (m_channel_count == 3)
+            return luminance(Color3f(interpolate<3>(it, active)));
+        else if (m_channel_count == 6)
+            return dr::mean(interpolate<6>(it, active));
+
+        Throw("eval_1(): The SparseGridVolume texture %s has an unsupported "
+              "number of channels (%u)", to_string(), m_channel_count);
+    }
+
+    void eval_n(const Interaction3f &it, Float *out,
+                Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        interpolate_n(m_to_local * it.p, m_storage_channels, out, active);
+    }
+
+    Vector3f eval_3(const Interaction3f &it,
+                    Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        if (m_channel_count != 3)
+            Throw("eval_3(): The SparseGridVolume texture %s was queried for "
+                  "a 3D vector, but it has %s channel(s)", to_string(),
+                  m_channel_count);
+        else if (is_spectral())
+            Throw("eval_3(): The SparseGridVolume texture %s was queried for "
+                  "a 3D vector, but texture conversion into spectra was "
+                  "requested! (raw=false)", to_string());
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<Vector3f>();
+
+        return Vector3f(interpolate<3>(it, active));
+    }
+
+    dr::Array<Float, 6> eval_6(const Interaction3f &it,
+                               Mask active = true) const override {
+        MI_MASKED_FUNCTION(ProfilerPhase::TextureEvaluate, active);
+
+        if (m_channel_count != 6)
+            Throw("eval_6(): The SparseGridVolume texture %s was queried for "
+                  "a 6D vector, but it has %s channel(s)", to_string(),
+                  m_channel_count);
+
+        if (dr::none_or<false>(active))
+            return dr::zeros<dr::Array<Float, 6>>();
+
+        return interpolate<6>(it, active);
+    }
+
+    ScalarFloat max() const override { return m_max; }
+
+    void max_per_channel(ScalarFloat *out) const override {
+        for (size_t i = 0; i < m_max_per_channel.size(); ++i)
+            out[i] = m_max_per_channel[i];
+    }
+
+    ScalarVector3i resolution() const override {
+        return ScalarVector3i(m_size);
+    }
+
+    std::vector<ScalarFloat> max_grid(const ScalarVector3u &res) const override {
+        /* Range of voxels that contribute to lookups within a cell. Boundary
+           cells cover the complete axis unless the lookups are clamped. */
+        bool clamp = m_wrap_mode == dr::WrapMode::Clamp;
+        auto voxel_range = [clamp](uint32_t cell, uint32_t cells, uint32_t voxels) {
+            if (!clamp && (cell == 0 || cell == cells - 1))
+                return std::make_pair(0u, voxels - 1);
+            double scale = (double) voxels / (double) cells;
+            int32_t lo = (int32_t) std::floor(cell * scale - 0.5),
+                    hi = (int32_t) std::floor((cell + 1) * scale - 0.5) + 1;
+            return std::make_pair((uint32_t) dr::clamp(lo, 0, (int32_t) voxels - 1),
+                                  (uint32_t) dr::clamp(hi, 0, (int32_t) voxels - 1));
+        };
+
+        /* Bound every cell by the maxima of the bricks overlapping its
+           footprint, missing bricks only contain zeros */
+        std::vector<ScalarFloat> values(dr::prod(res));
+        dr::parallel_for(
+            dr::blocked_range<uint32_t>(0, res.z(), 1),
+            [&](const dr::blocked_range<uint32_t> &range) {
+                for (uint32_t z = range.begin(); z != range.end(); ++z) {
+                    for (uint32_t y = 0; y < res.y(); ++y) {
+                        for (uint32_t x = 0; x < res.x(); ++x) {
+                            ScalarVector3u cell(x, y, z), lo, hi;
+                            for (uint32_t i = 0; i < 3; ++i) {
+                                auto [l, h] = voxel_range(cell[i], res[i], m_size[i]);
+                                lo[i] = l >> m_brick_shift;
+                                hi[i] = h >> m_brick_shift;
+                            }
+
+                            ScalarFloat value = 0.f;
+                            for (uint32_t bz = lo.z(); bz <= hi.z(); ++bz)
+                                for (uint32_t by = lo.y(); by <= hi.y(); ++by)
+                                    for (uint32_t bx = lo.x(); bx <= hi.x(); ++bx) {
+                                        uint32_t slot = m_brick_slots[
+                                            ((size_t) bz * m_brick_res.y() + by) *
+                                                m_brick_res.x() + bx];
+                                        if (slot != EmptyBrick)
+                                            value = dr::maximum(value, m_brick_max[slot]);
+                                    }
+                            values[((size_t) z * res.y() + y) * res.x() + x] = value;
+                        }
+                    }
+                }
+            }
+        );
+
+        return values;
+    }
+
+    std::string to_string() const override {
+        size_t brick_count = m_brick_max.size(),
+               total_count = dr::prod(m_brick_res);
+        std::ostringstream oss;
+        oss << "SparseGridVolume[" << std::endl
+            << "  to_local = " << string::indent(m_to_local, 13) << "," << std::endl
+            << "  bbox = " << string::indent(m_bbox) << "," << std::endl
+            << "  dimensions = " << resolution() << "," << std::endl
+            << "  brick_size = " << (1u << m_brick_shift) << "," << std::endl
+            << "  bricks = " << brick_count << " of " << total_count << " ("
+            << util::mem_string(m_data.size() * sizeof(ScalarFloat)) << ")," << std::endl
+            << "  max = " << m_max << "," << std::endl
+            << "  channels = " << m_channel_count << std::endl
+            << "]";
+        return oss.str();
+    }
+
+    MI_DECLARE_CLASS()
+
+protected:
+    /// Converted volume data that can be shared between several instances
+    struct SparseData : Object {
+        ScalarVector3u size, brick_res;
+        ScalarTransform4f bbox_transform;
+        uint32_t storage_channels;
+        bool spectral = false;
+        DynamicBuffer<UInt32> brick_index;
+        std::vector<uint32_t> brick_slots;
+        FloatStorage data;
+        std::vector<ScalarFloat> brick_max;
+        ScalarFloat max;
+        std::vector<ScalarFloat> max_per_channel;
+    };
+
+    /**
+     * \brief Produces the voxels of <tt>depth</tt> consecutive z slices
+     * starting at \c z in the layout of a \ref VolumeGrid
+     */
+    using SliceSource =
+        std::function<void(uint32_t z, uint32_t depth, ScalarFloat *out)>;
+
+    static constexpr uint32_t EmptyBrick = 0xFFFFFFFFu;
+
+    /// Does the volume store spectral upsampling coefficients?
+    bool is_spectral() const {
+        return is_spectral_v<Spectrum> && m_storage_channels == 4 && !m_raw;
+    }
+
+    uint32_t brick_voxel_count() const { return 1u << (3 * m_brick_shift); }
+
+    ref<SparseData> convert_grid(const VolumeGrid *grid, uint32_t brick_size,
+                                 ScalarFloat threshold) const {
+        ScalarVector3u size = grid->size();
+        size_t channels = grid->channel_count();
+        const ScalarFloat *ptr = grid->data();
+        return convert(size, (uint32_t) channels, grid->bbox_transform(),
+                       brick_size, threshold,
+                       [&](uint32_t z, uint32_t depth, ScalarFloat *out) {
+                           size_t slice = (size_t) size.x() * size.y() * channels;
+                           std::memcpy(out, ptr + z * slice,
+                                       depth * slice * sizeof(ScalarFloat));
+                       });
+    }
+
+    ref<SparseData> convert_file(const fs::path &path, uint32_t brick_size,
+                                 ScalarFloat threshold) const {
+        ref<FileStream> stream = new FileStream(path);
+
+        char header[3];
+        stream->read(header, 3);
+        if (header[0] != 'V' || header[1] != 'O' || header[2] != 'L')
+            Throw("Invalid volume file!");
+        uint8_t version;
+        stream->read(version);
+        if (version != 3)
+            Throw("Invalid version, currently only version 3 is supported (found %d)", version);
+        int32_t data_type;
+        stream->read(data_type);
+        if (data_type != 1)
+            Throw("Wrong type, currently only type == 1 (Float32) data is "
+                  "supported (found type = %d)", data_type);
+
+        int32_t size_x, size_y, size_z, channel_count;
+        stream->read(size_x);
+        stream->read(size_y);
+        stream->read(size_z);
+        stream->read(channel_count);
+        ScalarVector3u size((uint32_t) size_x, (uint32_t) size_y,
+                            (uint32_t) size_z);
+
+        float dims[6];
+        stream->read_array(dims, 6);
+        ScalarBoundingBox3f bbox(ScalarPoint3f(dims[0], dims[1], dims[2]),
+                                 ScalarPoint3f(dims[3], dims[4], dims[5]));
+        ScalarTransform4f bbox_transform =
+            ScalarTransform4f::scale(dr::rcp(bbox.extents())) *
+            ScalarTransform4f::translate(-bbox.min);
+
+        // Only one slab of bricks is read into memory at a time
+        std::vector<float> slices;
+        return convert(size, (uint32_t) channel_count, bbox_transform,
+                       brick_size, threshold,
+                       [&](uint32_t, uint32_t depth, ScalarFloat *out) {
+                           size_t count = (size_t) size.x() * size.y() *
+                                          channel_count * depth;
+                           if constexpr (std::is_same_v<ScalarFloat, float>) {
+                               stream->read_array(out, count);
+                           } else {
+                               slices.resize(count);
+                               stream->read_array(slices.data(), count);
+                               for (size_t i = 0; i < count; ++i)
+                                   out[i] = (ScalarFloat) slices[i];
+                           }
+                       });
+    }
+
+    /// Split the voxels produced by \c source into bricks
+    ref<SparseData> convert(const ScalarVector3u &size, uint32_t channels,
+                            const ScalarTransform4f &bbox_transform,
+                            uint32_t brick_size, ScalarFloat threshold,
+                            const SliceSource &source) const {
+        if (dr::any(dr::eq(size, 0u)) || channels == 0)
+            Throw("The volume must contain at least one voxel and channel!");
+
+        ref<SparseData> data = new SparseData();
+        data->size = size;
+        data->bbox_transform = bbox_transform;
+        data->spectral = is_spectral_v<Spectrum> && channels == 3 && !m_raw;
+        data->storage_channels = data->spectral ? 4 : channels;
+        data->brick_res = (size + (brick_size - 1)) / brick_size;
+
+        const uint32_t out_channels = data->storage_channels;
+        const size_t brick_voxels = (size_t) brick_size * brick_size * brick_size,
+                     brick_values = brick_voxels * out_channels,
+                     slice_values = (size_t) size.x() * size.y() * channels;
+        const ScalarVector3u &brick_res = data->brick_res;
+
+        std::vector<uint32_t> brick_index(dr::prod(brick_res), EmptyBrick);
+        std::vector<ScalarFloat> values;
+        std::vector<ScalarFloat> slab((size_t) brick_size * slice_values);
+
+        for (uint32_t bz = 0; bz < brick_res.z(); ++bz) {
+            uint32_t z0 = bz * brick_size,
+                     depth = std::min(brick_size, size.z() - z0);
+            source(z0, depth, slab.data());
+
+            // Extract the non-empty bricks of every row of the slab in parallel
+            std::vector<std::vector<ScalarFloat>> rows(brick_res.y());
+            std::vector<std::vector<uint32_t>> row_bricks(brick_res.y());
+            dr::parallel_for(
+                dr::blocked_range<uint32_t>(0, brick_res.y(), 1),
+                [&](const dr::blocked_range<uint32_t> &range) {
+                    std::vector<ScalarFloat> brick(brick_values);
+                    for (uint32_t by = range.begin(); by != range.end(); ++by) {
+                        for (uint32_t bx = 0; bx < brick_res.x(); ++bx) {
+                            std::fill(brick.begin(), brick.end(), 0.f);
+                            bool occupied = false;
+                            for (uint32_t z = 0; z < depth; ++z) {
+                                for (uint32_t y = 0; y < brick_size; ++y) {
+                                    uint32_t gy = by * brick_size + y;
+                                    if (gy >= size.y())
+                                        break;
+                                    for (uint32_t x = 0; x < brick_size; ++x) {
+                                        uint32_t gx = bx * brick_size + x;
+                                        if (gx >= size.x())
+                                            break;
+                                        const ScalarFloat *in =
+                                            slab.data() + z * slice_values +
+                                            ((size_t) gy * size.x() + gx) * channels;
+                                        ScalarFloat *out =
+                                            brick.data() +
+                                            ((z * brick_size + y) * brick_size + x) *
+                                                out_channels;
+                                        for (uint32_t c = 0; c < channels; ++c)
+                                            occupied |= dr::abs(in[c]) > threshold;
+                                        convert_voxel(in, out, channels, data->spectral);
+                                    }
+                                }
+                            }
+                            if (occupied) {
+                                rows[by].insert(rows[by].end(), brick.begin(), brick.end());
+                                row_bricks[by].push_back(bx);
+                            }
+                        }
+                    }
+                }
+            );
+
+            // Assign storage slots in the order of the bricks
+            for (uint32_t by = 0; by < brick_res.y(); ++by) {
+                for (size_t i = 0; i < row_bricks[by].size(); ++i) {
+                    size_t slot = values.size() / brick_values + i;
+                    if ((slot + 1) * brick_values > (size_t) 0xFFFFFFFFu)
+                        Throw("The volume contains too many non-empty bricks!");
+                    brick_index[((size_t) bz * brick_res.y() + by) *
+                                    brick_res.x() + row_bricks[by][i]] = (uint32_t) slot;
+                }
+                values.insert(values.end(), rows[by].begin(), rows[by].end());
+            }
+        }
+
+        size_t brick_count = values.size() / brick_values;
+        compute_maxima(values.data(), brick_count, brick_voxels, out_channels,
+                       data->spectral, data->brick_max, data->max,
+                       data->max_per_channel);
+        if (brick_count < brick_index.size())
+            pad_maxima(data->max, data->max_per_channel);
+
+        data->brick_index =
+            dr::load<DynamicBuffer<UInt32>>(brick_index.data(), brick_index.size());
+        data->brick_slots = std::move(brick_index);
+        data->data = dr::load<FloatStorage>(values.data(), values.size());
+
+        Log(Debug, "Converted sparse volume: dimensions %s, %zu of %zu bricks "
+            "stored (%s)", size, brick_count, data->brick_slots.size(),
+            util::mem_string(values.size() * sizeof(ScalarFloat)));
+
+        return data;
+    }
+
+    /// Convert a voxel into the representation used for lookups
+    static void convert_voxel(const ScalarFloat *in, ScalarFloat *out,
+                              uint32_t channels, bool spectral) {
+        if (spectral) {
+            ScalarColor3f rgb = dr::load<ScalarColor3f>(in);
+            ScalarFloat scale = dr::max(rgb) * 2.f;
+            ScalarColor3f rgb_norm = rgb / dr::maximum((ScalarFloat) 1e-8, scale);
+            ScalarVector3f coeff = srgb_model_fetch(rgb_norm);
+            dr::store(out, dr::concat(coeff, dr::Array<ScalarFloat, 1>(scale)));
+        } else {
+            for (uint32_t c = 0; c < channels; ++c)
+                out[c] = in[c];
+        }
+    }
+
+    /**
+     * \brief Compute the maximum of every brick, the overall maximum and the
+     * maximum of every channel
+     *
+     * Spectral volumes are bounded by their scale factor, which is stored in
+     * the last channel.
+     */
+    static void compute_maxima(const ScalarFloat *values, size_t brick_count,
+                               size_t brick_voxels, uint32_t channels,
+                               bool spectral, std::vector<ScalarFloat> &brick_max,
+                               ScalarFloat &max,
+                               std::vector<ScalarFloat> &max_per_channel) {
+        const size_t brick_values = brick_voxels * channels;
+        brick_max.resize(brick_count);
+
+        dr::parallel_for(
+            dr::blocked_range<size_t>(0, brick_count, 64),
+            [&](const dr::blocked_range<size_t> &range) {
+                for (size_t b = range.begin(); b != range.end(); ++b) {
+                    const ScalarFloat *ptr = values + b * brick_values;
+                    ScalarFloat value = -dr::Infinity<ScalarFloat>;
+                    for (size_t i = 0; i < brick_voxels; ++i, ptr += channels) {
+                        if (spectral)
+                            value = dr::maximum(value, ptr[3]);
+                        else
+                            for (uint32_t c = 0; c < channels; ++c)
+                                value = dr::maximum(value, ptr[c]);
+                    }
+                    brick_max[b] = value;
+                }
+            }
+        );
+
+        max = spectral ? 0.f : -dr::Infinity<ScalarFloat>;
+        for (ScalarFloat value : brick_max)
+            max = dr::maximum(max, value);
+
+        // Spectral volumes don't report per-channel maxima (as gridvolume)
+        max_per_channel.clear();
+        if (!spectral) {
+            max_per_channel.resize(channels, -dr::Infinity<ScalarFloat>);
+            for (size_t i = 0; i < brick_count * brick_voxels; ++i)
+                for (uint32_t c = 0; c < channels; ++c)
+                    max_per_channel[c] = dr::maximum(max_per_channel[c],
+                                                     values[i * channels + c]);
+        }
+    }
+
+    /// Account for the zero-valued voxels of missing bricks
+    static void pad_maxima(ScalarFloat &max,
+                           std::vector<ScalarFloat> &max_per_channel) {
+        max = dr::maximum(max, 0.f);
+        for (ScalarFloat &m : max_per_channel)
+            m = dr::maximum(m, 0.f);
+    }
+
+    /// Wrap integer voxel coordinates according to the wrap mode
+    Vector3i wrap(const Vector3i &p) const {
+        Vector3i size(ScalarVector3i(m_size));
+        if (m_wrap_mode == dr::WrapMode::Clamp) {
+            return dr::clamp(p, 0, size - 1);
+        } else if (m_wrap_mode == dr::WrapMode::Repeat) {
+            Vector3i r = p % size;
+            return dr::select(r < 0, r + size, r);
+        } else {
+            Vector3i period = 2 * size,
+                     r = p % period;
+            r = dr::select(r < 0, r + period, r);
+            return dr::select(r >= size, period - 1 - r, r);
+        }
+    }
+
+    /// Fetch the channels of the voxel at the given (wrapped) coordinates
+    void fetch(const Vector3i &p, uint32_t channels, Float *out,
+               Mask active) const {
+        Vector3u v(p),
+                 b = v >> m_brick_shift,
+                 l = v & ((1u << m_brick_shift) - 1u);
+        UInt32 brick = (b.z() * m_brick_res.y() + b.y()) * m_brick_res.x() + b.x();
+        UInt32 slot = dr::gather<UInt32>(m_brick_index, brick, active);
+        active &= dr::neq(slot, EmptyBrick);
+
+        UInt32 voxel = (((l.z() << m_brick_shift) + l.y()) << m_brick_shift) + l.x(),
+               offset = ((slot << (3 * m_brick_shift)) + voxel) * m_storage_channels;
+        for (uint32_t c = 0; c < channels; ++c)
+            out[c] = dr::gather<Float>(m_data, offset + c, active);
+    }
+
+    /**
+     * \brief Invoke <tt>func(voxel, weight)</tt> for every voxel that
+     * contributes to a lookup at \c p (in local coordinates)
+     */
+    template <typename Func>
+    MI_INLINE void for_each_voxel(const Point3f &p, Func func) const {
+        ScalarVector3f res(m_size);
+        if (m_filter_mode == dr::FilterMode::Nearest) {
+            func(wrap(dr::floor2int<Vector3i>(p * res)), Float(1.f));
+            return;
+        }
+
+        Point3f p_g = dr::fmadd(p, res, -.5f);
+        Vector3i p_i = dr::floor2int<Vector3i>(p_g);
+        Vector3f w1 = p_g - Point3f(p_i),
+                 w0 = 1.f - w1;
+
+        for (int k = 0; k < 8; ++k) {
+            Vector3i offset(k & 1, (k >> 1) & 1, k >> 2);
+            Float weight = ((k & 1) ? w1.x() : w0.x()) *
+                           ((k & 2) ? w1.y() : w0.y()) *
+                           ((k & 4) ? w1.z() : w0.z());
+            func(wrap(p_i + offset), weight);
+        }
+    }
+
+    /// Interpolate the first \c channels channels at \c p
+    void interpolate_n(const Point3f &p, uint32_t channels, Float *out,
+                       Mask active) const {
+        for (uint32_t c = 0; c < channels; ++c)
+            out[c] = 0.f;
+        std::vector<Float> tmp(channels);
+        for_each_voxel(p, [&](const Vector3i &voxel, const Float &weight) {
+            fetch(voxel, channels, tmp.data(), active);
+            for (uint32_t c = 0; c < channels; ++c)
+                out[c] = dr::fmadd(weight, tmp[c], out[c]);
+        });
+    }
+
+    template <size_t N>
+    MI_INLINE dr::Array<Float, N> interpolate(const Interaction3f &it,
+                                              Mask active) const {
+        dr::Array<Float, N> result;
+        interpolate_n(m_to_local * it.p, (uint32_t) N, result.data(), active);
+        return result;
+    }
+
+    /// Evaluate the volume at the given interaction using spectral upsampling
+    UnpolarizedSpectrum interpolate_spectral(const Interaction3f &it,
+                                             Mask active) const {
+        UnpolarizedSpectrum result(0.f);
+        Float scale(0.f);
+        for_each_voxel(m_to_local * it.p, [&](const Vector3i &voxel,
+                                              const Float &weight) {
+            dr::Array<Float, 4> v;
+            fetch(voxel, 4, v.data(), active);
+            result = dr::fmadd(
+                weight,
+                srgb_model_eval<UnpolarizedSpectrum>(dr::head<3>(v), it.wavelengths),
+                result);
+            scale = dr::fmadd(weight, v.w(), scale);
+        });
+
+        // Interpolate the spectra and the scale factors separately (as gridvolume)
+        return result * scale;
+    }
+
+protected:
+    dr::FilterMode m_filter_mode;
+    dr::WrapMode m_wrap_mode;
+    bool m_raw;
+    bool m_fixed_max = false;
+
+    ScalarVector3u m_size;
+    ScalarVector3u m_brick_res;
+    uint32_t m_brick_shift;
+    uint32_t m_storage_channels;
+
+    /// Storage slot of every brick (or \ref EmptyBrick)
+    DynamicBuffer<UInt32> m_brick_index;
+    /// Voxels of the stored bricks
+    FloatStorage m_data;
+
+    /// Host copy of \ref m_brick_index (used to build majorant grids)
+    std::vector<uint32_t> m_brick_slots;
+    /// Maximum of every stored brick
+    std::vector<ScalarFloat> m_brick_max;
+    ScalarFloat m_max;
+    std::vector<ScalarFloat> m_max_per_channel;
+};
+
+MI_IMPLEMENT_CLASS_VARIANT(SparseGridVolume, Volume)
+MI_EXPORT_PLUGIN(SparseGridVolume, "SparseGridVolume texture")
+
+NAMESPACE_END(mitsuba)
@@ -114,3 +114,47 @@ def test06_eval_per_channel(variants_all_rgb, tmpdir):
     it.p = mi.Point3f(1.0)
     print(vol.eval_n(it))
     assert dr.allclose(vol.eval_n(it), [1.0, 2.0, 3.0, 4.0, 5.0, 6.0])
+
+
+def test06_asset_cache(variants_all_rgb, tmpdir):
+    # Volumes loading the same file share the converted data
+    tmp_file = os.path.join(str(tmpdir), "out.vol")
+    grid = dr.full(mi.TensorXf, 1, [4, 4, 4, 1]) * 0.5
+    grid[2, 2, 2, 0] = 1.0
+    mi.VolumeGrid(grid).write(tmp_file)
+
+    mi.AssetCache.clear()
+    vol_1 = mi.load_dict({ 'type' : 'gridvolume', 'filename' : tmp_file })
+    vol_2 = mi.load_dict({ 'type' : 'gridvolume', 'filename' : tmp_file,
+                           'filter_type' : 'nearest' })
+    assert mi.AssetCache.size() == 1
+    assert dr.all(mi.traverse(vol_1)['data'].array == mi.traverse(vol_2)['data'].array)
+    assert dr.allclose(vol_1.max(), vol_2.max())
+
+
+@pytest.mark.parametrize('storage, atol', [('half', 2e-3), ('unorm8', 1e-2),
+                                           ('unorm8_srgb', 1e-2)])
+@pytest.mark.parametrize('filter_type', ['trilinear', 'nearest'])
+def test09_storage(variants_all_rgb, tmpdir, np_rng, storage, atol, filter_type):
+    # Volumes with reduced precision closely match full precision ones
+    tmp_file = os.path.join(str(tmpdir), "out.vol")
+    mi.VolumeGrid(np_rng.random((5, 6, 7, 3)).astype('float32')).write(tmp_file)
+
+    def load(**kwargs):
+        return mi.load_dict({
+            'type' : 'gridvolume',
+            'filename' : tmp_file,
+            'filter_type' : filter_type,
+            'wrap_mode' : 'repeat',
+            **kwargs
+        })
+
+    full, packed = load(), load(storage=storage)
+    assert 'data' not in mi.traverse(packed)
+    assert dr.all(packed.resolution() == full.resolution())
+    assert packed.max() >= full.max() - atol
+
+    it = dr.zeros(mi.Interaction3f, 1)
+    for p in np_rng.random((20, 3)) * 2 - 0.5:
+        it.p = mi.Point3f(p)
+        assert dr.allclose(packed.eval(it), full.eval(it), atol=atol)
@@ -0,0 +1,91 @@
+import pytest
+import drjit as dr
+import mitsuba as mi
+import numpy as np
+import os
+
+
+def make_grid(np_rng, channels=1):
+    # Mostly empty volume with a few dense blobs and a non-cubic shape
+    data = np.zeros((20, 24, 28, channels), dtype=np.float32)
+    data[2:6, 3:9, 4:7, :] = np_rng.random((4, 6, 3, channels))
+    data[15:19, 20:24, 25:28, :] = np_rng.random((4, 4, 3, channels)) + 1.0
+    return data
+
+
+def load_pair(tmpdir, data, **kwargs):
+    tmp_file = os.path.join(str(tmpdir), "sparse.vol")
+    mi.VolumeGrid(data).write(tmp_file)
+    dense = mi.load_dict({'type': 'gridvolume', 'filename': tmp_file,
+                          'accel': False, **kwargs})
+    sparse = mi.load_dict({'type': 'sparsegridvolume', 'filename': tmp_file,
+                           'brick_size': 4, **kwargs})
+    return dense, sparse
+
+
+def random_interaction(np_rng, n=4096):
+    it = dr.zeros(mi.Interaction3f, n)
+    it.p = mi.Point3f(*[mi.Float(np_rng.uniform(-0.2, 1.2, n).astype(np.float32))
+                        for _ in range(3)])
+    return it
+
+
+@pytest.mark.parametrize('filter_type', ['trilinear', 'nearest'])
+@pytest.mark.parametrize('wrap_mode', ['clamp', 'repeat', 'mirror'])
+def test01_matches_gridvolume(variants_all_rgb, tmpdir, np_rng, filter_type,
+                              wrap_mode):
+    dense, sparse = load_pair(tmpdir, make_grid(np_rng),
+                              filter_type=filter_type, wrap_mode=wrap_mode)
+    it = random_interaction(np_rng)
+    assert dr.allclose(sparse.eval_1(it), dense.eval_1(it), atol=1e-5)
+    assert dr.allclose(sparse.max(), dense.max())
+    assert dr.all(sparse.resolution() == dense.resolution())
+    assert 'bricks = ' in str(sparse)
+
+
+def test02_color(variants_all_rgb, tmpdir, np_rng):
+    dense, sparse = load_pair(tmpdir, make_grid(np_rng, 3))
+    it = random_interaction(np_rng)
+    assert dr.allclose(sparse.eval(it), dense.eval(it), atol=1e-5)
+    assert dr.allclose(sparse.max_per_channel(), dense.max_per_channel())
+
+
+def test03_grid_and_threshold(variant_scalar_rgb, np_rng):
+    data = make_grid(np_rng)
+    data[10, 12, 14, 0] = 1e-3
+    grid = mi.VolumeGrid(data)
+
+    sparse = mi.load_dict({'type': 'sparsegridvolume', 'grid': grid})
+    it = dr.zeros(mi.Interaction3f)
+    it.p = mi.Point3f(14.5 / 28, 12.5 / 24, 10.5 / 20)
+    assert dr.allclose(sparse.eval_1(it), 1e-3)
+
+    # Bricks below the threshold are dropped
+    sparse = mi.load_dict({'type': 'sparsegridvolume', 'grid': grid,
+                           'threshold': 1e-2})
+    assert dr.allclose(sparse.eval_1(it), 0.0)
+
+
+def test04_invalid_brick_size(variant_scalar_rgb, np_rng):
+    grid = mi.VolumeGrid(make_grid(np_rng))
+    with pytest.raises(RuntimeError, match='power of two'):
+        mi.load_dict({'type': 'sparsegridvolume', 'grid': grid,
+                      'brick_size': 6})
+
+
+def test05_heterogeneous_medium(variants_vec_rgb, tmpdir, np_rng):
+    # The sparse volume provides the majorant grid of a medium
+    tmp_file = os.path.join(str(tmpdir), "sparse.vol")
+    mi.VolumeGrid(make_grid(np_rng)).write(tmp_file)
+    medium = mi.load_dict({
+        'type': 'heterogeneous',
+        'sigma_t': {'type': 'sparsegridvolume', 'filename': tmp_file},
+        'majorant_resolution_factor': 2
+    })
+
+    mei = dr.zeros(mi.MediumInteraction3f, 2)
+    mei.p = mi.Point3f([0.2, 0.95], [0.2, 0.9], [0.2, 0.9])
+    majorant = medium.get_majorant(mei)[0]
+    sigma_t = medium.get_scattering_coefficients(mei)[2][0]
+    assert dr.all(sigma_t <= majorant)
+    assert dr.all(majorant[0] < majorant[1])